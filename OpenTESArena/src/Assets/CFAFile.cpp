@@ -9,17 +9,18 @@
 
 #include "components/vfs/manager.hpp"
 
+const int CFAFile::MAX_CACHED_FRAMES = 16;
+
 bool CFAFile::init(const char *filename)
 {
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	VFS::FileView src;
+	if (!VFS::Manager::get().read(filename, &src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.data());
 
 	// Read CFA header. Fortunately, all CFAs have headers, unlike IMGs and CIFs.
 	const uint16_t widthUncompressed = Bytes::getLE16(srcPtr);
@@ -33,9 +34,40 @@ bool CFAFile::init(const char *filename)
 
 	// Adapted from WinArena.
 
-	// Pointer to the look-up conversion table. This is how the packed colors
-	// are converted into useful palette indices.
-	const uint8_t *lookUpTable = srcPtr + 76;
+	// The look-up conversion table is how the packed colors are converted into useful
+	// palette indices. It's everything in the header after the first 76 bytes.
+	this->lookUpTable.fill(0);
+	const uint8_t *lookUpTableBegin = srcPtr + 76;
+	const int lookUpTableSize = std::min(std::max(headerSize - 76, 0),
+		static_cast<int>(this->lookUpTable.size()));
+	std::copy(lookUpTableBegin, lookUpTableBegin + lookUpTableSize, this->lookUpTable.begin());
+
+	// Decompress the RLE data of the CFA images (they're all packed together). The last
+	// run can go past the end, so decompress into a worst-case buffer and trim it after.
+	const int packedSize = widthCompressed * height * frameCount;
+	this->packedPixels = std::vector<uint8_t>(widthCompressed * height * frameCount *
+		sizeof(uint32_t) + (widthUncompressed * 16));
+	Compression::decodeRLE(srcPtr + headerSize, packedSize, this->packedPixels);
+	this->packedPixels.resize(packedSize);
+	this->packedPixels.shrink_to_fit();
+
+	this->width = widthUncompressed;
+	this->height = height;
+	this->widthCompressed = widthCompressed;
+	this->xOffset = xOffset;
+	this->yOffset = yOffset;
+	this->bitsPerPixel = bitsPerPixel;
+	this->frameCount = frameCount;
+	this->frameCache.init(CFAFile::MAX_CACHED_FRAMES);
+	return true;
+}
+
+void CFAFile::decodeFrame(int index, uint8_t *dst) const
+{
+	const uint32_t widthUncompressed = this->width;
+	const uint32_t widthCompressed = this->widthCompressed;
+	const uint32_t height = this->height;
+	const uint8_t *lookUpTable = this->lookUpTable.data();
 
 	// Line buffer (generously over-allocated for demuxing).
 	std::vector<uint8_t> encoded(widthUncompressed + 16, 0);
@@ -44,120 +76,85 @@ bool CFAFile::init(const char *filename)
 	// eventually translated into color indices.
 	std::array<uint8_t, 8> translate;
 
-	// Worse-case buffer for decompressed data (due to possible padding
-	// with demux alignment).
-	std::vector<uint8_t> decomp(widthCompressed * height * frameCount *
-		sizeof(uint32_t) + (widthUncompressed * 16));
-
-	// Decompress the RLE data of the CFA images (they're all packed together).
-	Compression::decodeRLE(srcPtr + headerSize, widthCompressed * height * frameCount, decomp);
-
-	// Temporary buffers for frame palette indices.
-	std::vector<std::vector<uint8_t>> frames;
-
 	// Byte offset into bit-packed data. All frames are packed together,
-	// so this value can simply be incremented by the compressed width.
-	uint32_t offset = 0;
+	// so the frame starts after the lines of the frames before it.
+	uint32_t offset = index * widthCompressed * height;
+	uint32_t dstOffset = 0;
 
-	for (uint32_t frameNum = 0; frameNum < frameCount; frameNum++)
+	for (uint32_t y = 0; y < height; y++)
 	{
-		// Allocate a new output frame.
-		frames.push_back(std::vector<uint8_t>(widthUncompressed * height));
+		uint32_t count = widthUncompressed;
 
-		// Destination buffer for the frame's decompressed palette indices.
-		std::vector<uint8_t> &dst = frames.back();
-		uint32_t dstOffset = 0;
+		// Copy the current line to the scratch buffer.
+		const uint8_t *decompPtr = this->packedPixels.data() + offset;
+		std::copy(decompPtr, decompPtr + widthCompressed, encoded.begin());
 
-		for (uint32_t y = 0; y < height; y++)
+		// Lambda for which demux routine to do, based on bits per pixel.
+		auto runDemux = [dst, dstOffset, &count, &encoded, &translate, lookUpTable](
+			uint32_t end, void(*demux)(const uint8_t*, uint8_t*),
+			uint32_t demuxMultiplier, uint32_t upToMin)
 		{
-			uint32_t count = widthUncompressed;
-
-			// Copy the current line to the scratch buffer.
-			const uint8_t *decompPtr = decomp.data() + offset;
-			std::copy(decompPtr, decompPtr + widthCompressed, encoded.begin());
-
-			// Lambda for which demux routine to do, based on bits per pixel.
-			auto runDemux = [&dst, dstOffset, &count, &encoded, &translate, lookUpTable](
-				uint32_t end, void(*demux)(const uint8_t*, uint8_t*),
-				uint32_t demuxMultiplier, uint32_t upToMin)
+			for (uint32_t x = 0; x < end; x++)
 			{
-				for (uint32_t x = 0; x < end; x++)
-				{
-					demux(encoded.data() + (x * demuxMultiplier), translate.data());
+				demux(encoded.data() + (x * demuxMultiplier), translate.data());
 
-					uint32_t upTo = std::min(upToMin, count);
-					count -= upTo;
-
-					for (uint32_t i = 0; i < upTo; i++)
-					{
-						dst.at((x * upToMin) + i + dstOffset) = lookUpTable[translate.at(i)];
-					}
-				}
-			};
+				uint32_t upTo = std::min(upToMin, count);
+				count -= upTo;
 
-			// Choose the demuxing routine.
-			if (bitsPerPixel == 8)
-			{
-				// No demuxing needed.
-				for (uint32_t x = 0; x < widthCompressed; x++)
+				for (uint32_t i = 0; i < upTo; i++)
 				{
-					dst.at(x + dstOffset) = encoded.at(x);
+					dst[(x * upToMin) + i + dstOffset] = lookUpTable[translate.at(i)];
 				}
 			}
-			else if (bitsPerPixel == 7)
-			{
-				runDemux((widthCompressed + 6) / 7, CFAFile::demux7, 7, 8);
-			}
-			else if (bitsPerPixel == 6)
-			{
-				runDemux((widthCompressed + 2) / 3, CFAFile::demux6, 3, 4);
-			}
-			else if (bitsPerPixel == 5)
-			{
-				runDemux((widthCompressed + 4) / 5, CFAFile::demux5, 5, 8);
-			}
-			else if (bitsPerPixel == 4)
-			{
-				runDemux((widthCompressed + 1) / 2, CFAFile::demux4, 2, 4);
-			}
-			else if (bitsPerPixel == 3)
-			{
-				runDemux((widthCompressed + 2) / 3, CFAFile::demux3, 3, 8);
-			}
-			else if (bitsPerPixel == 2)
-			{
-				runDemux(widthCompressed, CFAFile::demux2, 1, 4);
-			}
-			else if (bitsPerPixel == 1)
+		};
+
+		// Choose the demuxing routine.
+		if (this->bitsPerPixel == 8)
+		{
+			// No demuxing needed.
+			for (uint32_t x = 0; x < std::min(widthCompressed, widthUncompressed); x++)
 			{
-				runDemux(widthCompressed, CFAFile::demux1, 1, 8);
+				dst[x + dstOffset] = encoded.at(x);
 			}
-
-			// Move offsets to the next compressed line of data.
-			offset += widthCompressed;
-			dstOffset += widthUncompressed;
 		}
-	}
-
-	this->width = widthUncompressed;
-	this->height = height;
-	this->xOffset = xOffset;
-	this->yOffset = yOffset;
+		else if (this->bitsPerPixel == 7)
+		{
+			runDemux((widthCompressed + 6) / 7, CFAFile::demux7, 7, 8);
+		}
+		else if (this->bitsPerPixel == 6)
+		{
+			runDemux((widthCompressed + 2) / 3, CFAFile::demux6, 3, 4);
+		}
+		else if (this->bitsPerPixel == 5)
+		{
+			runDemux((widthCompressed + 4) / 5, CFAFile::demux5, 5, 8);
+		}
+		else if (this->bitsPerPixel == 4)
+		{
+			runDemux((widthCompressed + 1) / 2, CFAFile::demux4, 2, 4);
+		}
+		else if (this->bitsPerPixel == 3)
+		{
+			runDemux((widthCompressed + 2) / 3, CFAFile::demux3, 3, 8);
+		}
+		else if (this->bitsPerPixel == 2)
+		{
+			runDemux(widthCompressed, CFAFile::demux2, 1, 4);
+		}
+		else if (this->bitsPerPixel == 1)
+		{
+			runDemux(widthCompressed, CFAFile::demux1, 1, 8);
+		}
 
-	// Store each 8-bit image.
-	for (const auto &frame : frames)
-	{
-		this->pixels.push_back(std::make_unique<uint8_t[]>(this->width * this->height));
-		uint8_t *pixels = this->pixels.back().get();
-		std::copy(frame.begin(), frame.end(), pixels);
+		// Move offsets to the next compressed line of data.
+		offset += widthCompressed;
+		dstOffset += widthUncompressed;
 	}
-
-	return true;
 }
 
 int CFAFile::getImageCount() const
 {
-	return static_cast<int>(this->pixels.size());
+	return this->frameCount;
 }
 
 int CFAFile::getWidth() const
@@ -182,8 +179,18 @@ int CFAFile::getYOffset() const
 
 const uint8_t *CFAFile::getPixels(int index) const
 {
-	DebugAssertIndex(this->pixels, index);
-	return this->pixels[index].get();
+	DebugAssert(index >= 0);
+	DebugAssert(index < this->frameCount);
+
+	const uint8_t *cachedPixels = this->frameCache.find(index);
+	if (cachedPixels != nullptr)
+	{
+		return cachedPixels;
+	}
+
+	uint8_t *pixels = this->frameCache.add(index, this->width * this->height);
+	this->decodeFrame(index, pixels);
+	return pixels;
 }
 
 void CFAFile::demux1(const uint8_t *src, uint8_t *dst)
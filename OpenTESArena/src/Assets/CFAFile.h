@@ -1,17 +1,33 @@
 #ifndef CFA_FILE_H
 #define CFA_FILE_H
 
+#include <array>
 #include <cstdint>
-#include <memory>
 #include <vector>
 
+#include "FrameCache.h"
+
 // A CFA file is for creatures and spell animations.
 
+// Only the RLE data is decompressed when opened. Frames are demuxed the first time they're
+// asked for, and the most recently used ones are kept, so a creature that only ever shows a
+// few of its frames doesn't pay for the rest.
+
 class CFAFile
 {
 private:
-	std::vector<std::unique_ptr<uint8_t[]>> pixels;
-	int width, height, xOffset, yOffset;
+	// Most decoded frames kept at once.
+	static const int MAX_CACHED_FRAMES;
+
+	std::vector<uint8_t> packedPixels; // RLE-decoded but still bit-packed frames.
+	std::array<uint8_t, 256> lookUpTable; // Converts packed values to palette indices.
+
+	mutable FrameCache frameCache;
+
+	int width, height, widthCompressed, xOffset, yOffset, bitsPerPixel, frameCount;
+
+	// Demuxes a frame into 8-bit palette indices.
+	void decodeFrame(int index, uint8_t *dst) const;
 
 	// CFA files have their palette indices compressed into fewer bits depending
 	// on the total number of colors in the file. These demuxing functions
@@ -41,7 +57,8 @@ public:
 	// Gets the Y offset of all images.
 	int getYOffset() const;
 
-	// Gets a pointer to an image's 8-bit pixels.
+	// Gets a pointer to an image's 8-bit pixels, decoding the image if it's not cached. The
+	// pointer is only valid until enough other images are decoded to push it out.
 	const uint8_t *getPixels(int index) const;
 };
 
@@ -24,6 +24,8 @@ namespace
 	};
 }
 
+const int CIFFile::MAX_CACHED_FRAMES = 16;
+
 bool CIFFile::init(const char *filename)
 {
 	// Some filenames (i.e., Arrows.cif) have different casing between the floppy version and
@@ -37,214 +39,183 @@ bool CIFFile::init(const char *filename)
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
-	const uint8_t *srcEnd = srcPtr + srcSize;
+	this->src.setOwned(std::move(src), srcSize);
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(this->src.data());
+	const int headerSize = 12;
 
-	// X and Y offset might be useful for weapon positions on the screen.
-	uint16_t xoff, yoff, width, height, flags, len;
+	this->images.clear();
 
-	// Read header data if it is not a raw file.
+	// Read the images' headers without decoding them.
 	const auto rawOverride = RawCifOverride.find(filename);
 	const bool isRaw = rawOverride != RawCifOverride.end();
 	if (isRaw)
 	{
-		xoff = 0;
-		yoff = 0;
-
+		// Uncompressed raw CIF.
+		const int imageCount = rawOverride->second.first;
 		const Int2 &dims = rawOverride->second.second;
-		width = dims.x;
-		height = dims.y;
+		const uint16_t len = dims.x * dims.y;
+		if ((static_cast<size_t>(imageCount) * len) > srcSize)
+		{
+			DebugLogError("Unexpected end of \"" + std::string(filename) + "\".");
+			return false;
+		}
 
-		flags = 0;
-		len = width * height;
+		for (int i = 0; i < imageCount; i++)
+		{
+			Image image;
+			image.offset = Int2(0, 0);
+			image.dimensions = dims;
+			image.dataOffset = static_cast<uint32_t>(i * len);
+			image.dataLength = len;
+			this->images.push_back(image);
+		}
+
+		this->compression = CompressionType::None;
 	}
 	else
 	{
-		xoff = Bytes::getLE16(srcPtr);
-		yoff = Bytes::getLE16(srcPtr + 2);
-		width = Bytes::getLE16(srcPtr + 4);
-		height = Bytes::getLE16(srcPtr + 6);
-		flags = Bytes::getLE16(srcPtr + 8);
-		len = Bytes::getLE16(srcPtr + 10);
-	}
-
-	const int headerSize = 12;
-
-	if ((flags & 0x00FF) == 0x0002)
-	{
-		// Type 2 CIF.
-		int offset = 0;
-
-		while ((srcPtr + offset) < srcEnd)
+		if (srcSize < headerSize)
 		{
-			const uint8_t *header = srcPtr + offset;
-			xoff = Bytes::getLE16(header);
-			yoff = Bytes::getLE16(header + 2);
-			width = Bytes::getLE16(header + 4);
-			height = Bytes::getLE16(header + 6);
-			flags = Bytes::getLE16(header + 8);
-			len = Bytes::getLE16(header + 10);
-
-			std::vector<uint8_t> decomp(width * height);
-			Compression::decodeRLE(header + 12, width * height, decomp);
-
-			this->pixels.push_back(std::make_unique<uint8_t[]>(width * height));
-			this->offsets.push_back(Int2(xoff, yoff));
-			this->dimensions.push_back(Int2(width, height));
-
-			const uint8_t *srcPixels = decomp.data();
-			uint8_t *dstPixels = this->pixels.back().get();
-			std::copy(srcPixels, srcPixels + (width * height), dstPixels);
-
-			offset += headerSize + len;
+			DebugLogError("Unexpected end of \"" + std::string(filename) + "\".");
+			return false;
 		}
-	}
-	else if ((flags & 0x00FF) == 0x0004)
-	{
-		// Type 4 CIF.
-		int offset = 0;
 
-		while ((srcPtr + offset) < srcEnd)
+		// Every image has the first one's type.
+		const uint16_t flags = Bytes::getLE16(srcPtr + 8);
+		if ((flags & 0x00FF) == 0x0002)
 		{
-			const uint8_t *header = srcPtr + offset;
-			xoff = Bytes::getLE16(header);
-			yoff = Bytes::getLE16(header + 2);
-			width = Bytes::getLE16(header + 4);
-			height = Bytes::getLE16(header + 6);
-			flags = Bytes::getLE16(header + 8);
-			len = Bytes::getLE16(header + 10);
-
-			std::vector<uint8_t> decomp(width * height);
-			Compression::decodeType04(header + 12, header + 12 + len, decomp);
-
-			this->pixels.push_back(std::make_unique<uint8_t[]>(width * height));
-			this->offsets.push_back(Int2(xoff, yoff));
-			this->dimensions.push_back(Int2(width, height));
-
-			const uint8_t *srcPixels = decomp.data();
-			uint8_t *dstPixels = this->pixels.back().get();
-			std::copy(srcPixels, srcPixels + (width * height), dstPixels);
-
-			offset += headerSize + len;
+			this->compression = CompressionType::RLE;
+		}
+		else if ((flags & 0x00FF) == 0x0004)
+		{
+			this->compression = CompressionType::Type04;
+		}
+		else if ((flags & 0x00FF) == 0x0008)
+		{
+			this->compression = CompressionType::Type08;
+		}
+		else if ((flags & 0x00FF) == 0)
+		{
+			this->compression = CompressionType::None;
+		}
+		else
+		{
+			DebugLogError("Unrecognized flags " + std::to_string(flags) + ".");
+			return false;
 		}
-	}
-	else if ((flags & 0x00FF) == 0x0008)
-	{
-		// Type 8 CIF.
-		int offset = 0;
 
-		while ((srcPtr + offset) < srcEnd)
+		// Read image headers until the end of the file.
+		size_t offset = 0;
+		while (offset < srcSize)
 		{
-			const uint8_t *header = srcPtr + offset;
-			xoff = Bytes::getLE16(header);
-			yoff = Bytes::getLE16(header + 2);
-			width = Bytes::getLE16(header + 4);
-			height = Bytes::getLE16(header + 6);
-			flags = Bytes::getLE16(header + 8);
-			len = Bytes::getLE16(header + 10);
+			if ((offset + headerSize) > srcSize)
+			{
+				DebugLogError("Unexpected end of \"" + std::string(filename) + "\".");
+				return false;
+			}
 
-			std::vector<uint8_t> decomp(width * height);
+			const uint8_t *header = srcPtr + offset;
 
-			// Contains a 2 byte decompressed length after the header, so skip that 
-			// (should be equivalent to width * height).
-			Compression::decodeType08(header + 12 + 2, header + 12 + len, decomp);
+			// X and Y offset might be useful for weapon positions on the screen.
+			Image image;
+			image.offset = Int2(Bytes::getLE16(header), Bytes::getLE16(header + 2));
+			image.dimensions = Int2(Bytes::getLE16(header + 4), Bytes::getLE16(header + 6));
+			image.dataOffset = static_cast<uint32_t>(offset + headerSize);
+			image.dataLength = Bytes::getLE16(header + 10);
 
-			this->pixels.push_back(std::make_unique<uint8_t[]>(width * height));
-			this->offsets.push_back(Int2(xoff, yoff));
-			this->dimensions.push_back(Int2(width, height));
+			if ((image.dataOffset + image.dataLength) > srcSize)
+			{
+				DebugLogError("Unexpected end of \"" + std::string(filename) + "\".");
+				return false;
+			}
 
-			const uint8_t *srcPixels = decomp.data();
-			uint8_t *dstPixels = this->pixels.back().get();
-			std::copy(srcPixels, srcPixels + (width * height), dstPixels);
+			this->images.push_back(image);
 
 			// Skip to the next image header.
-			offset += headerSize + len;
+			offset += headerSize + image.dataLength;
 		}
 	}
-	else if (isRaw)
-	{
-		// Uncompressed raw CIF.
-		const int imageCount = rawOverride->second.first;
-
-		for (int i = 0; i < imageCount; i++)
-		{
-			this->pixels.push_back(std::make_unique<uint8_t[]>(width * height));
-			this->offsets.push_back(Int2(xoff, yoff));
-			this->dimensions.push_back(Int2(width, height));
 
-			const uint8_t *srcPixels = srcPtr + (i * len);
-			uint8_t *dstPixels = this->pixels.back().get();
-			std::copy(srcPixels, srcPixels + len, dstPixels);
-		}
-	}
-	else if ((flags & 0x00FF) == 0)
-	{
-		// Uncompressed CIF with headers.
-		int offset = 0;
+	this->frameCache.init(CIFFile::MAX_CACHED_FRAMES);
+	return true;
+}
 
-		// Read uncompressed images until the end of the file.
-		while ((srcPtr + offset) < srcEnd)
-		{
-			const uint8_t *header = srcPtr + offset;
-			xoff = Bytes::getLE16(header);
-			yoff = Bytes::getLE16(header + 2);
-			width = Bytes::getLE16(header + 4);
-			height = Bytes::getLE16(header + 6);
-			flags = Bytes::getLE16(header + 8);
-			len = Bytes::getLE16(header + 10);
+void CIFFile::decodeImage(int index, uint8_t *dst) const
+{
+	const Image &image = this->images[index];
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(this->src.data());
+	const uint8_t *data = srcPtr + image.dataOffset;
+	const uint8_t *dataEnd = data + image.dataLength;
+	const int pixelCount = image.dimensions.x * image.dimensions.y;
 
-			this->pixels.push_back(std::make_unique<uint8_t[]>(width * height));
-			this->offsets.push_back(Int2(xoff, yoff));
-			this->dimensions.push_back(Int2(width, height));
+	if (this->compression == CompressionType::None)
+	{
+		std::copy(data, data + std::min<int>(image.dataLength, pixelCount), dst);
+		return;
+	}
 
-			const uint8_t *srcPixels = header + headerSize;
-			uint8_t *dstPixels = this->pixels.back().get();
-			std::copy(srcPixels, srcPixels + len, dstPixels);
+	if (this->compression == CompressionType::Type08)
+	{
+		// Contains a 2 byte decompressed length after the header, so skip that 
+		// (should be equivalent to width * height).
+		Compression::decodeType08(data + 2, dataEnd, dst, pixelCount);
+		return;
+	}
 
-			// Skip to the next image header.
-			offset += headerSize + len;
-		}
+	std::vector<uint8_t> decomp(pixelCount);
+	if (this->compression == CompressionType::RLE)
+	{
+		Compression::decodeRLE(data, pixelCount, decomp);
 	}
 	else
 	{
-		DebugLogError("Unrecognized flags " + std::to_string(flags) + ".");
-		return false;
+		Compression::decodeType04(data, dataEnd, decomp);
 	}
 
-	return true;
+	std::copy(decomp.begin(), decomp.end(), dst);
 }
 
 int CIFFile::getImageCount() const
 {
-	return static_cast<int>(this->pixels.size());
+	return static_cast<int>(this->images.size());
 }
 
 int CIFFile::getXOffset(int index) const
 {
-	DebugAssertIndex(this->offsets, index);
-	return this->offsets[index].x;
+	DebugAssertIndex(this->images, index);
+	return this->images[index].offset.x;
 }
 
 int CIFFile::getYOffset(int index) const
 {
-	DebugAssertIndex(this->offsets, index);
-	return this->offsets[index].y;
+	DebugAssertIndex(this->images, index);
+	return this->images[index].offset.y;
 }
 
 int CIFFile::getWidth(int index) const
 {
-	DebugAssertIndex(this->dimensions, index);
-	return this->dimensions[index].x;
+	DebugAssertIndex(this->images, index);
+	return this->images[index].dimensions.x;
 }
 
 int CIFFile::getHeight(int index) const
 {
-	DebugAssertIndex(this->dimensions, index);
-	return this->dimensions[index].y;
+	DebugAssertIndex(this->images, index);
+	return this->images[index].dimensions.y;
 }
 
 const uint8_t *CIFFile::getPixels(int index) const
 {
-	DebugAssertIndex(this->pixels, index);
-	return this->pixels[index].get();
+	DebugAssertIndex(this->images, index);
+
+	const uint8_t *cachedPixels = this->frameCache.find(index);
+	if (cachedPixels != nullptr)
+	{
+		return cachedPixels;
+	}
+
+	const Image &image = this->images[index];
+	uint8_t *pixels = this->frameCache.add(index, image.dimensions.x * image.dimensions.y);
+	this->decodeImage(index, pixels);
+	return pixels;
 }
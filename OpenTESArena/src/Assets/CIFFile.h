@@ -2,20 +2,43 @@
 #define CIF_FILE_H
 
 #include <cstdint>
-#include <memory>
 #include <vector>
 
+#include "FrameCache.h"
 #include "../Math/Vector2.h"
 
+#include "components/vfs/manager.hpp"
+
 // A CIF file has one or more images, and each image has some frames associated
 // with it. Examples of CIF images are character faces, cursors, and weapon 
 // animations.
 
+// Only the image headers are read when opened. Each image is decompressed the first time
+// it's asked for, with the most recently used ones kept, so reading the offsets of a
+// weapon's frames doesn't decode any of them.
+
 class CIFFile
 {
 private:
-	std::vector<std::unique_ptr<uint8_t[]>> pixels;
-	std::vector<Int2> offsets, dimensions;
+	enum class CompressionType { None, RLE, Type04, Type08 };
+
+	struct Image
+	{
+		Int2 offset, dimensions;
+		uint32_t dataOffset; // Offset of the image's pixel data in the file.
+		uint16_t dataLength;
+	};
+
+	// Most decoded images kept at once.
+	static const int MAX_CACHED_FRAMES;
+
+	VFS::FileView src;
+	std::vector<Image> images;
+	CompressionType compression;
+	mutable FrameCache frameCache;
+
+	// Writes an image's palette indices.
+	void decodeImage(int index, uint8_t *dst) const;
 public:
 	bool init(const char *filename);
 
@@ -34,7 +57,8 @@ public:
 	// Gets the height of an image.
 	int getHeight(int index) const;
 
-	// Gets a pointer to an image's 8-bit pixels.
+	// Gets a pointer to an image's 8-bit pixels, decoding the image if it's not cached. The
+	// pointer is only valid until enough other images are decoded to push it out.
 	const uint8_t *getPixels(int index) const;
 };
 
@@ -136,7 +136,7 @@ std::string CityDataFile::getDoorVoxelMifName(int x, int y, int menuID,
 	if ((menuType == VoxelData::WallData::MenuType::Palace) &&
 		(provinceID == 8) && (localCityID == 0))
 	{
-		return String::toUppercase(exeData.locations.finalDungeonMifName);
+		return String::toUppercase(exeData.getLocations().finalDungeonMifName);
 	}
 
 	// Get the prefix associated with the menu type.
@@ -211,7 +211,7 @@ std::string CityDataFile::getDoorVoxelMifName(int x, int y, int menuID,
 						}
 					}();
 
-					const auto &prefixes = exeData.locations.menuMifPrefixes;
+					const auto &prefixes = exeData.getLocations().menuMifPrefixes;
 					return prefixes.at(menuMifIndex);
 				}
 				else
@@ -392,10 +392,20 @@ int CityDataFile::getGlobalQuarter(const Int2 &globalPoint) const
 	return globalQuarter;
 }
 
-int CityDataFile::getTravelDays(int startLocationID, int startProvinceID, int endLocationID,
-	int endProvinceID, int month, const std::array<WeatherType, 36> &weathers,
-	ArenaRandom &random, const MiscAssets &miscAssets) const
+CityDataFile::TravelRoute &CityDataFile::getTravelRoute(int startLocationID,
+	int startProvinceID, int endLocationID, int endProvinceID,
+	const MiscAssets &miscAssets) const
 {
+	const int locationCount = 48;
+	const int key = (((((startProvinceID * locationCount) + startLocationID) *
+		CityDataFile::PROVINCE_COUNT) + endProvinceID) * locationCount) + endLocationID;
+
+	auto iter = this->travelRoutes.find(key);
+	if (iter != this->travelRoutes.end())
+	{
+		return iter->second;
+	}
+
 	auto getGlobalPoint = [this](int locationID, int provinceID)
 	{
 		const auto &province = this->getProvinceData(provinceID);
@@ -411,44 +421,77 @@ int CityDataFile::getTravelDays(int startLocationID, int startProvinceID, int en
 	// Get all the points along the line between the two points.
 	const std::vector<Int2> points = Int2::bresenhamLine(startGlobalPoint, endGlobalPoint);
 
-	int totalTime = 0;
+	TravelRoute route;
+	route.steps.reserve(points.size());
+	route.month = -1;
+	route.totalTime = -1;
+
+	const auto &worldMapTerrain = miscAssets.getWorldMapTerrain();
 	for (const Int2 &point : points)
 	{
-		const int monthIndex = (month + (totalTime / 3000)) % 12;
-		const int weatherIndex = [this, &weathers, &point]()
-		{
-			// Find which province quarter the global point is in.
-			const int quarterIndex = this->getGlobalQuarter(point);
-
-			// Convert the weather type to its equivalent index.
-			return static_cast<int>(weathers.at(quarterIndex));
-		}();
+		TravelStep step;
 
 		// The type of terrain at the world map point.
-		const auto &worldMapTerrain = miscAssets.getWorldMapTerrain();
-		const uint8_t terrainIndex = MiscAssets::WorldMapTerrain::getNormalizedIndex(
+		step.terrainIndex = MiscAssets::WorldMapTerrain::getNormalizedIndex(
 			worldMapTerrain.getAt(point.x, point.y));
 
-		// Calculate the travel speed based on climate and weather.
+		// Find which province quarter the global point is in (to determine weather).
+		step.quarterIndex = static_cast<uint8_t>(this->getGlobalQuarter(point));
+
+		route.steps.push_back(step);
+	}
+
+	iter = this->travelRoutes.emplace(key, std::move(route)).first;
+	return iter->second;
+}
+
+int CityDataFile::getTravelDays(int startLocationID, int startProvinceID, int endLocationID,
+	int endProvinceID, int month, const std::array<WeatherType, 36> &weathers,
+	ArenaRandom &random, const MiscAssets &miscAssets) const
+{
+	TravelRoute &route = this->getTravelRoute(startLocationID, startProvinceID,
+		endLocationID, endProvinceID, miscAssets);
+
+	// Only walk the route again if the date or weather changed since last time.
+	if ((route.totalTime < 0) || (route.month != month) || (route.weathers != weathers))
+	{
 		const auto &exeData = miscAssets.getExeData();
-		const auto &climateSpeedTables = exeData.locations.climateSpeedTables;
-		const auto &weatherSpeedTables = exeData.locations.weatherSpeedTables;
-		const int climateSpeed = climateSpeedTables.at(terrainIndex).at(monthIndex);
-		const int weatherMod = [terrainIndex, weatherIndex, &weatherSpeedTables]()
+		const auto &climateSpeedTables = exeData.getLocations().climateSpeedTables;
+		const auto &weatherSpeedTables = exeData.getLocations().weatherSpeedTables;
+
+		int totalTime = 0;
+		for (const TravelStep &step : route.steps)
 		{
-			const int weatherSpeed = weatherSpeedTables.at(terrainIndex).at(weatherIndex);
+			const int monthIndex = (month + (totalTime / 3000)) % 12;
 
-			// Special case: 0 equals 100.
-			return (weatherSpeed == 0) ? 100 : weatherSpeed;
-		}();
+			// Convert the weather type to its equivalent index.
+			const int weatherIndex = static_cast<int>(weathers.at(step.quarterIndex));
+
+			// Calculate the travel speed based on climate and weather.
+			const int climateSpeed = climateSpeedTables.at(step.terrainIndex).at(monthIndex);
+			const int weatherMod = [&step, weatherIndex, &weatherSpeedTables]()
+			{
+				const int weatherSpeed =
+					weatherSpeedTables.at(step.terrainIndex).at(weatherIndex);
+
+				// Special case: 0 equals 100.
+				return (weatherSpeed == 0) ? 100 : weatherSpeed;
+			}();
 
-		const int travelSpeed = (climateSpeed * weatherMod) / 100;
+			const int travelSpeed = (climateSpeed * weatherMod) / 100;
 
-		// Add the pixel's travel time onto the total time.
-		const int pixelTravelTime = 2000 / travelSpeed;
-		totalTime += pixelTravelTime;
+			// Add the pixel's travel time onto the total time.
+			const int pixelTravelTime = 2000 / travelSpeed;
+			totalTime += pixelTravelTime;
+		}
+
+		route.weathers = weathers;
+		route.month = month;
+		route.totalTime = totalTime;
 	}
 
+	const int totalTime = route.totalTime;
+
 	// Calculate the actual travel days based on the total time.
 	const int travelDays = [&random, totalTime]()
 	{
@@ -552,6 +595,9 @@ Int2 CityDataFile::getLocalCityPoint(uint32_t citySeed)
 
 bool CityDataFile::init(const char *filename)
 {
+	// Routes depend on location positions.
+	this->travelRoutes.clear();
+
 	std::unique_ptr<std::byte[]> src;
 	size_t srcSize;
 	if (!VFS::Manager::get().read(filename, &src, &srcSize))
@@ -4,6 +4,8 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "../Math/Rect.h"
 #include "../Math/Vector2.h"
@@ -55,8 +57,32 @@ public:
 		const CityDataFile::ProvinceData::LocationData &getLocationData(int locationID) const;
 	};
 private:
+	// The terrain and province quarter of one world map pixel on the way between two
+	// locations.
+	struct TravelStep
+	{
+		uint8_t terrainIndex, quarterIndex;
+	};
+
+	// The pixels between two locations, which never change, and the travel time from the
+	// last time the route was asked for, which depends on the date and weather.
+	struct TravelRoute
+	{
+		std::vector<TravelStep> steps;
+		std::array<WeatherType, 36> weathers;
+		int month;
+		int totalTime; // -1 if not calculated yet.
+	};
+
 	// These are ordered the same as usual (read left to right, and center is last).
 	std::array<ProvinceData, 9> provinces;
+
+	// Routes between locations, filled in as travel days are asked for.
+	mutable std::unordered_map<int, TravelRoute> travelRoutes;
+
+	// Gets the route between two locations, making it if it's not cached.
+	TravelRoute &getTravelRoute(int startLocationID, int startProvinceID, int endLocationID,
+		int endProvinceID, const MiscAssets &miscAssets) const;
 public:
 	static const int PROVINCE_COUNT;
 
@@ -119,7 +145,9 @@ public:
 	// Gets the quarter within a province (to determine weather).
 	int getGlobalQuarter(const Int2 &globalPoint) const;
 
-	// Gets the number of days required to travel from one location to another.
+	// Gets the number of days required to travel from one location to another. The route
+	// and the time for the given date and weather are cached, but the random variation is
+	// applied every time.
 	int getTravelDays(int startLocationID, int startProvinceID, int endLocationID,
 		int endProvinceID, int month, const std::array<WeatherType, 36> &weathers,
 		ArenaRandom &random, const MiscAssets &miscAssets) const;
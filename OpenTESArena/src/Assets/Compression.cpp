@@ -1,6 +1,189 @@
+#include <cstring>
+
 #include "Compression.h"
 #include "../Utilities/Bytes.h"
 
+namespace
+{
+	// History buffer size for type 4 and type 8 matches, and the value the buffer starts
+	// filled with.
+	const int HistorySize = 4096;
+	const uint8_t HistoryFill = 0x20;
+
+	// LZ sequence limits, and the size of the encoder's table of where each four bytes were
+	// last seen.
+	const int LZMinMatch = 4;
+	const int LZMaxNibble = 15;
+	const int LZMaxOffset = 65535;
+	const int LZHashBits = 12;
+	const int LZHashSize = 1 << LZHashBits;
+
+	// Copies a match from the given distance back in the output (1 to HistorySize). The
+	// history buffer is always the last HistorySize bytes of output, so matches read straight
+	// from the output instead, with anything before the start of it being the initial fill.
+	void copyMatch(uint8_t *out, int pos, int distance, int count)
+	{
+		uint8_t *dst = out + pos;
+		if (pos >= distance)
+		{
+			const uint8_t *src = dst - distance;
+			if (distance >= count)
+			{
+				std::memcpy(dst, src, count);
+			}
+			else if (distance >= 8)
+			{
+				// Overlapping, but each word's source bytes are written by the time it's read.
+				int i = 0;
+				for (; (i + 8) <= count; i += 8)
+				{
+					std::memcpy(dst + i, src + i, 8);
+				}
+
+				for (; i < count; i++)
+				{
+					dst[i] = src[i];
+				}
+			}
+			else
+			{
+				// Short repeating pattern.
+				for (int i = 0; i < count; i++)
+				{
+					dst[i] = src[i];
+				}
+			}
+		}
+		else
+		{
+			for (int i = 0; i < count; i++)
+			{
+				const int srcPos = pos + i - distance;
+				dst[i] = (srcPos >= 0) ? out[srcPos] : HistoryFill;
+			}
+		}
+	}
+
+	// MSB-first bit reader for type 8 data that refills a word at a time. Reading past the
+	// end of the input gives zero bits, like the original decoder.
+	class Type08BitReader
+	{
+	private:
+		const uint8_t *src, *srcEnd;
+		uint64_t bits; // Next bits of input, starting at the top bit.
+		int bitCount; // Number of bits at the top that are valid.
+	public:
+		Type08BitReader(const uint8_t *src, const uint8_t *srcEnd)
+		{
+			this->src = src;
+			this->srcEnd = srcEnd;
+			this->bits = 0;
+			this->bitCount = 0;
+		}
+
+		// Makes sure at least 57 bits are available.
+		void refill()
+		{
+			if ((this->srcEnd - this->src) >= 8)
+			{
+				// Bits past the valid ones are always the next bits of input (or zero), so
+				// or-ing a whole word over them doesn't change them.
+				uint64_t word = 0;
+				for (int i = 0; i < 8; i++)
+				{
+					word = (word << 8) | this->src[i];
+				}
+
+				this->bits |= word >> this->bitCount;
+				const int byteCount = (63 - this->bitCount) >> 3;
+				this->src += byteCount;
+				this->bitCount += byteCount * 8;
+			}
+			else
+			{
+				while (this->bitCount <= 56)
+				{
+					if (this->src != this->srcEnd)
+					{
+						this->bits |= static_cast<uint64_t>(*this->src) << (56 - this->bitCount);
+						this->src++;
+					}
+
+					this->bitCount += 8;
+				}
+			}
+		}
+
+		int readBit()
+		{
+			if (this->bitCount == 0)
+			{
+				this->refill();
+			}
+
+			const int bit = static_cast<int>(this->bits >> 63);
+			this->bits <<= 1;
+			this->bitCount--;
+			return bit;
+		}
+
+		// Reads up to 57 bits.
+		int readBits(int count)
+		{
+			if (this->bitCount < count)
+			{
+				this->refill();
+			}
+
+			const int value = static_cast<int>(this->bits >> (64 - count));
+			this->bits <<= count;
+			this->bitCount -= count;
+			return value;
+		}
+	};
+}
+
+const std::array<uint8_t, 256> Compression::HighOffsetBits =
+{
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+	0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+	0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+	0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
+	0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B,
+	0x0C, 0x0C, 0x0C, 0x0C, 0x0D, 0x0D, 0x0D, 0x0D, 0x0E, 0x0E, 0x0E, 0x0E, 0x0F, 0x0F, 0x0F, 0x0F,
+	0x10, 0x10, 0x10, 0x10, 0x11, 0x11, 0x11, 0x11, 0x12, 0x12, 0x12, 0x12, 0x13, 0x13, 0x13, 0x13,
+	0x14, 0x14, 0x14, 0x14, 0x15, 0x15, 0x15, 0x15, 0x16, 0x16, 0x16, 0x16, 0x17, 0x17, 0x17, 0x17,
+	0x18, 0x18, 0x19, 0x19, 0x1A, 0x1A, 0x1B, 0x1B, 0x1C, 0x1C, 0x1D, 0x1D, 0x1E, 0x1E, 0x1F, 0x1F,
+	0x20, 0x20, 0x21, 0x21, 0x22, 0x22, 0x23, 0x23, 0x24, 0x24, 0x25, 0x25, 0x26, 0x26, 0x27, 0x27,
+	0x28, 0x28, 0x29, 0x29, 0x2A, 0x2A, 0x2B, 0x2B, 0x2C, 0x2C, 0x2D, 0x2D, 0x2E, 0x2E, 0x2F, 0x2F,
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F
+};
+
+const std::array<uint8_t, 256> Compression::LowOffsetBitCounts =
+{
+	0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+	0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+	0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+	0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+	0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+	0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06,
+	0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06,
+	0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06,
+	0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+	0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+	0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
+	0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08
+};
+
+
 void Compression::decodeRLE(const uint8_t *src, int stopCount,
 	std::vector<uint8_t> &out)
 {
@@ -82,3 +265,316 @@ void Compression::decodeRLEWords(const uint8_t *src, int stopCount,
 		}
 	}
 }
+
+void Compression::decodeType04(const uint8_t *src, const uint8_t *srcEnd, std::vector<uint8_t> &out)
+{
+	// Same as decodeType04Reference(), but matches are copied straight from the output. A
+	// match names an absolute history buffer position, which is a fixed distance back from
+	// the current output position for the whole match.
+	uint8_t *dst = out.data();
+	const int outSize = static_cast<int>(out.size());
+	int pos = 0;
+
+	int bitcount = 0;
+	int mask = 0;
+	while (src != srcEnd)
+	{
+		if (!bitcount)
+		{
+			bitcount = 8;
+			mask = *(src++);
+		}
+		else
+		{
+			mask >>= 1;
+		}
+
+		if ((mask & 1))
+		{
+			DebugAssertMsg(src != srcEnd, "Unexpected end of image.");
+			DebugAssertMsg(pos != outSize, "Decoded image overflow.");
+
+			dst[pos++] = *(src++);
+		}
+		else
+		{
+			DebugAssertMsg((srcEnd - src) >= 2, "Unexpected end of image.");
+
+			const uint8_t byte1 = *(src++);
+			const uint8_t byte2 = *(src++);
+			const int tocopy = (byte2 & 0x0F) + 3;
+			const int copypos = (((byte2 & 0xF0) << 4) | byte1) + 18;
+
+			DebugAssertMsg((outSize - pos) >= tocopy, "Decoded image overflow.");
+
+			const int distance = ((pos - copypos - 1) & (HistorySize - 1)) + 1;
+			copyMatch(dst, pos, distance, tocopy);
+			pos += tocopy;
+		}
+
+		bitcount--;
+	}
+
+	std::fill(out.begin() + pos, out.end(), 0);
+}
+
+void Compression::decodeType08(const uint8_t *src, const uint8_t *srcEnd, uint8_t *out, int outSize)
+{
+	// Same as decodeType08Reference(), with input read a word at a time, plain arrays instead
+	// of bounds-checked ones, and matches copied straight from the output. The adaptive
+	// Huffman tree changes after every symbol, so it's still walked one bit at a time.
+	constexpr int LeafCount = 314;
+	constexpr int NodeCount = (LeafCount * 2) - 1;
+	constexpr int RootIndex = NodeCount - 1;
+
+	uint16_t nodeIdxMap[NodeCount + LeafCount];
+	for (int i = 0; i < RootIndex; i++)
+	{
+		nodeIdxMap[i] = (i >> 1) + LeafCount;
+	}
+
+	nodeIdxMap[RootIndex] = 0;
+	for (int i = 0; i < LeafCount; i++)
+	{
+		nodeIdxMap[NodeCount + i] = i;
+	}
+
+	uint16_t nodeTree[NodeCount];
+	for (int i = 0; i < LeafCount; i++)
+	{
+		nodeTree[i] = NodeCount + i;
+	}
+
+	for (int i = LeafCount; i < NodeCount; i++)
+	{
+		nodeTree[i] = (i - LeafCount) * 2;
+	}
+
+	// One extra frequency past the root that nothing is less than, so the search for where
+	// to move an incremented frequency doesn't need a bounds check.
+	uint16_t nodeFreq[NodeCount + 1];
+	for (int i = 0; i < LeafCount; i++)
+	{
+		nodeFreq[i] = 1;
+	}
+
+	for (int i = LeafCount; i < NodeCount; i++)
+	{
+		const int childIndex = (i - LeafCount) * 2;
+		nodeFreq[i] = nodeFreq[childIndex] + nodeFreq[childIndex + 1];
+	}
+
+	nodeFreq[NodeCount] = 0xFFFF;
+
+	Type08BitReader reader(src, srcEnd);
+	uint8_t *dst = out;
+	int pos = 0;
+	while (pos < outSize)
+	{
+		int node = nodeTree[RootIndex];
+		while (node < NodeCount)
+		{
+			node = nodeTree[node + reader.readBit()];
+		}
+
+		// Increment the frequency of the node and its parents, keeping the tree sorted.
+		int freqidx = nodeIdxMap[node];
+		do
+		{
+			const uint16_t freq = ++nodeFreq[freqidx];
+			int nextidx = freqidx + 1;
+			if (nodeFreq[nextidx] < freq)
+			{
+				do
+				{
+					nextidx++;
+				} while (nodeFreq[nextidx] < freq);
+				nextidx--;
+
+				nodeFreq[freqidx] = nodeFreq[nextidx];
+				nodeFreq[nextidx] = freq;
+
+				const uint16_t nextNode = nodeTree[freqidx];
+				const uint16_t prevNode = nodeTree[nextidx];
+				nodeTree[freqidx] = prevNode;
+				nodeTree[nextidx] = nextNode;
+
+				nodeIdxMap[nextNode] = nextidx;
+				if (nextNode < NodeCount)
+				{
+					nodeIdxMap[nextNode + 1] = nextidx;
+				}
+
+				nodeIdxMap[prevNode] = freqidx;
+				if (prevNode < NodeCount)
+				{
+					nodeIdxMap[prevNode + 1] = freqidx;
+				}
+
+				freqidx = nextidx;
+			}
+
+			freqidx = nodeIdxMap[freqidx];
+		} while (freqidx != 0);
+
+		const int codeword = node - NodeCount;
+		if (codeword < 256)
+		{
+			dst[pos++] = static_cast<uint8_t>(codeword);
+		}
+		else
+		{
+			const int tableidx = reader.readBits(8);
+			const int bitcount = LowOffsetBitCounts[tableidx] - 2;
+			const int offsetLow = ((tableidx << bitcount) | reader.readBits(bitcount)) & 0x003F;
+			const int offset = (HighOffsetBits[tableidx] << 6) | offsetLow;
+
+			// Bad data might have a match that runs past the end of the output.
+			const int tocopy = std::min(codeword - 256 + 3, outSize - pos);
+			copyMatch(dst, pos, offset + 1, tocopy);
+			pos += tocopy;
+		}
+	}
+}
+
+void Compression::decodeType08(const uint8_t *src, const uint8_t *srcEnd, std::vector<uint8_t> &out)
+{
+	Compression::decodeType08(src, srcEnd, out.data(), static_cast<int>(out.size()));
+}
+
+void Compression::encodeLZ(const uint8_t *src, int srcSize, std::vector<uint8_t> &out)
+{
+	out.clear();
+
+	// Counts that don't fit in a token's nibble continue in bytes of up to 255.
+	auto writeToken = [&out](int literalCount, int matchCount)
+	{
+		const int literalNibble = std::min(literalCount, LZMaxNibble);
+		const int matchNibble = std::min(matchCount, LZMaxNibble);
+		out.push_back(static_cast<uint8_t>((literalNibble << 4) | matchNibble));
+	};
+
+	auto writeCount = [&out](int count)
+	{
+		if (count < LZMaxNibble)
+		{
+			return;
+		}
+
+		count -= LZMaxNibble;
+		while (count >= 255)
+		{
+			out.push_back(255);
+			count -= 255;
+		}
+
+		out.push_back(static_cast<uint8_t>(count));
+	};
+
+	auto writeLiterals = [&out, src, &writeCount](int start, int count)
+	{
+		writeCount(count);
+		out.insert(out.end(), src + start, src + start + count);
+	};
+
+	// Last position each hash of four bytes was seen at.
+	std::array<int, LZHashSize> positions;
+	positions.fill(-1);
+
+	int anchor = 0; // Start of the literals not written yet.
+	int pos = 0;
+	while ((pos + LZMinMatch) <= srcSize)
+	{
+		uint32_t sequence;
+		std::memcpy(&sequence, src + pos, sizeof(sequence));
+		const int hash = static_cast<int>((sequence * 2654435761u) >> (32 - LZHashBits));
+		const int candidate = positions[hash];
+		positions[hash] = pos;
+
+		if ((candidate < 0) || ((pos - candidate) > LZMaxOffset) ||
+			(std::memcmp(src + candidate, src + pos, LZMinMatch) != 0))
+		{
+			pos++;
+			continue;
+		}
+
+		int matchLength = LZMinMatch;
+		while (((pos + matchLength) < srcSize) &&
+			(src[candidate + matchLength] == src[pos + matchLength]))
+		{
+			matchLength++;
+		}
+
+		const int literalCount = pos - anchor;
+		const int offset = pos - candidate;
+		writeToken(literalCount, matchLength - LZMinMatch);
+		writeLiterals(anchor, literalCount);
+		out.push_back(static_cast<uint8_t>(offset & 0xFF));
+		out.push_back(static_cast<uint8_t>(offset >> 8));
+		writeCount(matchLength - LZMinMatch);
+
+		pos += matchLength;
+		anchor = pos;
+	}
+
+	const int literalCount = srcSize - anchor;
+	writeToken(literalCount, 0);
+	writeLiterals(anchor, literalCount);
+}
+
+void Compression::decodeLZ(const uint8_t *src, const uint8_t *srcEnd, uint8_t *out, int outSize)
+{
+	auto readCount = [&src, srcEnd](int nibble)
+	{
+		int count = nibble;
+		if (nibble == LZMaxNibble)
+		{
+			uint8_t byte;
+			do
+			{
+				DebugAssertMsg(src != srcEnd, "Unexpected end of LZ data.");
+				byte = *(src++);
+				count += byte;
+			} while (byte == 255);
+		}
+
+		return count;
+	};
+
+	int pos = 0;
+	while (src != srcEnd)
+	{
+		const uint8_t token = *(src++);
+		const int literalCount = readCount(token >> 4);
+		DebugAssertMsg((srcEnd - src) >= literalCount, "Unexpected end of LZ data.");
+		DebugAssertMsg((outSize - pos) >= literalCount, "Decoded LZ data overflow.");
+		std::memcpy(out + pos, src, literalCount);
+		src += literalCount;
+		pos += literalCount;
+
+		// The last sequence has no match.
+		if (src == srcEnd)
+		{
+			break;
+		}
+
+		DebugAssertMsg((srcEnd - src) >= 2, "Unexpected end of LZ data.");
+		const int offset = src[0] | (src[1] << 8);
+		src += 2;
+
+		const int matchLength = readCount(token & LZMaxNibble) + LZMinMatch;
+		DebugAssertMsg((offset > 0) && (offset <= pos), "Invalid LZ match offset.");
+		DebugAssertMsg((outSize - pos) >= matchLength, "Decoded LZ data overflow.");
+
+		// Matches can overlap their own output, so they're copied a byte at a time.
+		const uint8_t *matchSrc = out + pos - offset;
+		for (int i = 0; i < matchLength; i++)
+		{
+			out[pos + i] = matchSrc[i];
+		}
+
+		pos += matchLength;
+	}
+
+	DebugAssertMsg(pos == outSize, "Decoded LZ data is too short.");
+}
@@ -15,6 +15,11 @@
 class Compression
 {
 private:
+	// Type 8 tables for the high six bits of a match offset and how many bits the full
+	// offset takes, indexed by the first offset byte.
+	static const std::array<uint8_t, 256> HighOffsetBits;
+	static const std::array<uint8_t, 256> LowOffsetBitCounts;
+
 	Compression() = delete;
 	~Compression() = delete;
 public:
@@ -27,8 +32,24 @@ public:
 		std::vector<uint8_t> &out);
 
 	// Works with .IMG and .CIF type 4 files.
+	static void decodeType04(const uint8_t *src, const uint8_t *srcEnd, std::vector<uint8_t> &out);
+
+	// Works with type 8 .IMG and .CIF files, and voxel data in .MIF files.
+	static void decodeType08(const uint8_t *src, const uint8_t *srcEnd, uint8_t *out, int outSize);
+	static void decodeType08(const uint8_t *src, const uint8_t *srcEnd, std::vector<uint8_t> &out);
+
+	// Fast byte-oriented LZ compression in the style of LZ4, for keeping data the game made
+	// itself smaller in memory. Not an Arena format. Sequences are a token byte with the
+	// literal count and match length, the literals, then a two-byte match offset. The last
+	// sequence is only literals.
+	static void encodeLZ(const uint8_t *src, int srcSize, std::vector<uint8_t> &out);
+	static void decodeLZ(const uint8_t *src, const uint8_t *srcEnd, uint8_t *out, int outSize);
+
+	// The original decoders the ones above replaced, which go through a history buffer one
+	// byte and one bit at a time. They're only kept for checking that the others give the
+	// same output (see the bench).
 	template <typename T>
-	static void decodeType04(T src, T srcend, std::vector<uint8_t> &out)
+	static void decodeType04Reference(T src, T srcend, std::vector<uint8_t> &out)
 	{
 		auto dst = out.begin();
 
@@ -87,47 +108,9 @@ public:
 		std::fill(dst, out.end(), 0);
 	}
 
-	// Works with type 8 .IMG and .CIF files, and voxel data in .MIF files.
 	template <typename T>
-	static void decodeType08(T src, T srcend, std::vector<uint8_t> &out)
+	static void decodeType08Reference(T src, T srcend, std::vector<uint8_t> &out)
 	{
-		static const std::array<uint8_t, 256> highOffsetBits{
-			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-			0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
-			0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
-			0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
-			0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
-			0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
-			0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
-			0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B,
-			0x0C, 0x0C, 0x0C, 0x0C, 0x0D, 0x0D, 0x0D, 0x0D, 0x0E, 0x0E, 0x0E, 0x0E, 0x0F, 0x0F, 0x0F, 0x0F,
-			0x10, 0x10, 0x10, 0x10, 0x11, 0x11, 0x11, 0x11, 0x12, 0x12, 0x12, 0x12, 0x13, 0x13, 0x13, 0x13,
-			0x14, 0x14, 0x14, 0x14, 0x15, 0x15, 0x15, 0x15, 0x16, 0x16, 0x16, 0x16, 0x17, 0x17, 0x17, 0x17,
-			0x18, 0x18, 0x19, 0x19, 0x1A, 0x1A, 0x1B, 0x1B, 0x1C, 0x1C, 0x1D, 0x1D, 0x1E, 0x1E, 0x1F, 0x1F,
-			0x20, 0x20, 0x21, 0x21, 0x22, 0x22, 0x23, 0x23, 0x24, 0x24, 0x25, 0x25, 0x26, 0x26, 0x27, 0x27,
-			0x28, 0x28, 0x29, 0x29, 0x2A, 0x2A, 0x2B, 0x2B, 0x2C, 0x2C, 0x2D, 0x2D, 0x2E, 0x2E, 0x2F, 0x2F,
-			0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F
-		};
-		static const std::array<uint8_t, 256> lowOffsetBitCount{
-			0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
-			0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
-			0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
-			0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
-			0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
-			0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
-			0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
-			0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
-			0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
-			0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06,
-			0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06,
-			0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06,
-			0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
-			0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
-			0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07,
-			0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08
-		};
-
 		std::array<uint8_t, 4096> history;
 		history.fill(0x20);
 		int historypos = 0;
@@ -259,8 +242,8 @@ public:
 				bitmask <<= 8;
 				validbits -= 8;
 
-				uint16_t offsetHigh = highOffsetBits[tableidx] << 6;
-				uint16_t bitcount = lowOffsetBitCount[tableidx] - 2;
+				uint16_t offsetHigh = HighOffsetBits[tableidx] << 6;
+				uint16_t bitcount = LowOffsetBitCounts[tableidx] - 2;
 				uint16_t offsetLow = tableidx;
 				for (uint16_t i = 0; i < bitcount; i++)
 				{
@@ -281,7 +264,7 @@ public:
 
 				uint16_t copypos = historypos - (offsetHigh | (offsetLow & 0x003F)) - 1;
 				uint16_t tocopy = codeword - 256 + 3;
-				for (uint16_t i = 0; i < tocopy; i++)
+				for (uint16_t i = 0; (i < tocopy) && (dst != out.end()); i++)
 				{
 					*dst = history[copypos++ & 0x0FFF];
 					history[historypos++ & 0x0FFF] = *(dst++);
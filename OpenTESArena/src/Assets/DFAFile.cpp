@@ -8,17 +8,18 @@
 
 #include "components/vfs/manager.hpp"
 
+const int DFAFile::MAX_CACHED_FRAMES = 16;
+
 bool DFAFile::init(const char *filename)
 {
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	if (!VFS::Manager::get().read(filename, &this->src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(this->src.data());
+	const size_t srcSize = this->src.size();
 
 	// Read DFA header data.
 	const uint16_t imageCount = Bytes::getLE16(srcPtr);
@@ -28,72 +29,102 @@ bool DFAFile::init(const char *filename)
 	const uint16_t height = Bytes::getLE16(srcPtr + 8);
 	const uint16_t compressedLength = Bytes::getLE16(srcPtr + 10); // First frame.
 
-	// Frame data with palette indices.
-	std::vector<std::vector<uint8_t>> frames;
-
 	// Uncompress the initial frame.
-	frames.push_back(std::vector<uint8_t>(width * height));
-	Compression::decodeRLE(srcPtr + 12, width * height, frames.front());
-
-	// Make copies of the original frame for each update chunk.
-	for (int i = 1; i < imageCount; i++)
-	{
-		frames.push_back(frames.front());
-	}
+	this->firstFrame = std::vector<uint8_t>(width * height);
+	Compression::decodeRLE(srcPtr + 12, width * height, this->firstFrame);
 
-	// Offset to the beginning of the chunk data; advances as the chunk data is read.
+	// Offset to the beginning of the chunk data; advances as the chunk headers are read.
 	uint32_t offset = 12 + compressedLength;
 
-	// Start reading chunks for each update group. Skip the first frame because 
-	// that's the full image.
+	// Find where each update group starts, and check that its updates stay in the image.
+	// Skip the first frame because that's the full image.
+	this->updateOffsets.clear();
 	for (uint32_t frameIndex = 1; frameIndex < imageCount; frameIndex++)
 	{
-		// Select the frame buffer at the current frame index.
-		std::vector<uint8_t> &frame = frames.at(frameIndex);
+		this->updateOffsets.push_back(offset);
+
+		if ((offset + 4) > srcSize)
+		{
+			DebugLogError("Unexpected end of \"" + std::string(filename) + "\".");
+			return false;
+		}
 
-		// Pointer to the beginning of the chunk data. Each update chunk
-		// changes a group of pixels in a copy of the original image.
-		const uint8_t *chunkData = srcPtr + offset;
-		const uint16_t chunkSize = Bytes::getLE16(chunkData);
-		const uint16_t chunkCount = Bytes::getLE16(chunkData + 2);
+		const uint16_t chunkCount = Bytes::getLE16(srcPtr + offset + 2);
 
 		// Move the offset past the chunk header.
 		offset += 4;
 
 		for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
 		{
+			if ((offset + 4) > srcSize)
+			{
+				DebugLogError("Unexpected end of \"" + std::string(filename) + "\".");
+				return false;
+			}
+
 			const uint8_t *updateData = srcPtr + offset;
 			const uint16_t updateOffset = Bytes::getLE16(updateData);
 			const uint16_t updateCount = Bytes::getLE16(updateData + 2);
 
-			// Move the offset past the update header.
-			offset += 4;
-
-			for (uint32_t i = 0; i < updateCount; i++)
+			if ((updateOffset + updateCount) > this->firstFrame.size())
 			{
-				frame.at(updateOffset + i) = *(srcPtr + offset);
-				offset++;
+				DebugLogError("Update out of range in \"" + std::string(filename) + "\".");
+				return false;
 			}
+
+			// Move the offset past the update header and its pixels.
+			offset += 4 + updateCount;
+		}
+
+		if (offset > srcSize)
+		{
+			DebugLogError("Unexpected end of \"" + std::string(filename) + "\".");
+			return false;
 		}
 	}
 
 	this->width = width;
 	this->height = height;
+	this->frameCache.init(DFAFile::MAX_CACHED_FRAMES);
+	return true;
+}
+
+void DFAFile::decodeFrame(int index, uint8_t *dst) const
+{
+	// Start with a copy of the original frame.
+	std::copy(this->firstFrame.begin(), this->firstFrame.end(), dst);
 
-	// Store each 8-bit image.
-	for (const auto &frame : frames)
+	if (index == 0)
 	{
-		this->pixels.push_back(std::make_unique<uint8_t[]>(this->width * this->height));
-		uint8_t *dstPixels = this->pixels.back().get();
-		std::copy(frame.begin(), frame.end(), dstPixels);
+		return;
 	}
 
-	return true;
+	// Each update chunk changes a group of pixels in the copy. The offsets were checked
+	// in init().
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(this->src.data());
+	uint32_t offset = this->updateOffsets[index - 1];
+	const uint16_t chunkCount = Bytes::getLE16(srcPtr + offset + 2);
+
+	// Move the offset past the chunk header.
+	offset += 4;
+
+	for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+	{
+		const uint8_t *updateData = srcPtr + offset;
+		const uint16_t updateOffset = Bytes::getLE16(updateData);
+		const uint16_t updateCount = Bytes::getLE16(updateData + 2);
+
+		// Move the offset past the update header.
+		offset += 4;
+
+		std::copy(srcPtr + offset, srcPtr + offset + updateCount, dst + updateOffset);
+		offset += updateCount;
+	}
 }
 
 int DFAFile::getImageCount() const
 {
-	return static_cast<int>(this->pixels.size());
+	return static_cast<int>(this->updateOffsets.size()) + 1;
 }
 
 int DFAFile::getWidth() const
@@ -108,6 +139,16 @@ int DFAFile::getHeight() const
 
 const uint8_t *DFAFile::getPixels(int index) const
 {
-	DebugAssertIndex(this->pixels, index);
-	return this->pixels[index].get();
+	DebugAssert(index >= 0);
+	DebugAssert(index < this->getImageCount());
+
+	const uint8_t *cachedPixels = this->frameCache.find(index);
+	if (cachedPixels != nullptr)
+	{
+		return cachedPixels;
+	}
+
+	uint8_t *pixels = this->frameCache.add(index, this->width * this->height);
+	this->decodeFrame(index, pixels);
+	return pixels;
 }
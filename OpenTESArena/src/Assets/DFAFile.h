@@ -2,17 +2,33 @@
 #define DFA_FILE_H
 
 #include <cstdint>
-#include <memory>
 #include <vector>
 
+#include "FrameCache.h"
+
+#include "components/vfs/manager.hpp"
+
 // A DFA file contains images for entities that animate but don't move in the world, 
 // like shopkeepers, tavern folk, lamps, fountains, staff pieces, and torches.
 
+// Each image after the first is a set of updates to a copy of the first. Only the first is
+// decompressed when opened, and the others are made the first time they're asked for, with
+// the most recently used ones kept.
+
 class DFAFile
 {
 private:
-	std::vector<std::unique_ptr<uint8_t[]>> pixels;
+	// Most decoded frames kept at once.
+	static const int MAX_CACHED_FRAMES;
+
+	VFS::FileView src;
+	std::vector<uint8_t> firstFrame; // Palette indices of the first image.
+	std::vector<uint32_t> updateOffsets; // Offset of each later image's updates in the file.
+	mutable FrameCache frameCache;
 	int width, height;
+
+	// Writes an image's palette indices.
+	void decodeFrame(int index, uint8_t *dst) const;
 public:
 	bool init(const char *filename);
 
@@ -25,7 +41,8 @@ public:
 	// Gets the height of all images.
 	int getHeight() const;
 
-	// Gets a pointer to an image's 8-bit pixels.
+	// Gets a pointer to an image's 8-bit pixels, decoding the image if it's not cached. The
+	// pointer is only valid until enough other images are decoded to push it out.
 	const uint8_t *getPixels(int index) const;
 };
 
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <sstream>
+#include <string_view>
 
 #include "ExeData.h"
 #include "ExeUnpacker.h"
@@ -7,7 +8,7 @@
 #include "../Utilities/Debug.h"
 #include "../Utilities/KeyValueMap.h"
 #include "../Utilities/Platform.h"
-#include "../Utilities/String.h"
+#include "../Utilities/StringView.h"
 
 namespace
 {
@@ -722,10 +723,10 @@ const char ExeData::PAIR_SEPARATOR = ',';
 int ExeData::get(const std::string &section, const std::string &key,
 	const KeyValueMap &keyValueMap)
 {
-	const std::string &valueStr = keyValueMap.getString(section, key);
+	const std::string_view valueStr = keyValueMap.getString(section, key);
 
 	// Make sure the value only has an offset and isn't an offset + length pair.
-	DebugAssertMsg(valueStr.find(ExeData::PAIR_SEPARATOR) == std::string::npos,
+	DebugAssertMsg(valueStr.find(ExeData::PAIR_SEPARATOR) == std::string_view::npos,
 		"\"" + key + "\" (section \"" + section + "\") should only have an offset.");
 
 	int offset;
@@ -739,15 +740,16 @@ int ExeData::get(const std::string &section, const std::string &key,
 std::pair<int, int> ExeData::getPair(const std::string &section, const std::string &key,
 	const KeyValueMap &keyValueMap)
 {
-	const std::string &valueStr = keyValueMap.getString(section, key);
+	const std::string_view valueStr = keyValueMap.getString(section, key);
 
 	// Make sure the value has a comma-separated offset + length pair.
-	const std::vector<std::string> tokens = String::split(valueStr, ExeData::PAIR_SEPARATOR);
-	DebugAssertMsg(tokens.size() == 2, "\"" + key + "\" (section \"" + section +
+	std::array<std::string_view, 2> tokens;
+	const size_t tokenCount = StringView::split(valueStr, ExeData::PAIR_SEPARATOR, tokens);
+	DebugAssertMsg(tokenCount == tokens.size(), "\"" + key + "\" (section \"" + section +
 		"\") should have an offset and length.");
 
-	const std::string &offsetStr = tokens.front();
-	const std::string &lengthStr = tokens.at(1);
+	const std::string_view offsetStr = tokens[0];
+	const std::string_view lengthStr = tokens[1];
 	int offset, length;
 
 	std::stringstream ss;
@@ -797,6 +799,106 @@ std::string ExeData::readFixedString(const char *data, const std::pair<int, int>
 	return ExeData::readString(data + pair.first, pair.second);
 }
 
+ExeData::ExeData()
+{
+	this->floppyVersion = false;
+}
+
+ExeData::ExeData(ExeData&&) = default;
+
+ExeData::~ExeData() = default;
+
+ExeData &ExeData::operator=(ExeData&&) = default;
+
+template <typename T>
+const T &ExeData::getSection(Section<T> &section) const
+{
+	DebugAssertMsg(this->sections != nullptr, "ExeData not initialized.");
+
+	std::call_once(section.flag, [this, &section]()
+	{
+		const char *data = reinterpret_cast<const char*>(this->exe->getData());
+		section.value.init(data, *this->keyValueMap);
+	});
+
+	return section.value;
+}
+
+const ExeData::Calendar &ExeData::getCalendar() const
+{
+	return this->getSection(this->sections->calendar);
+}
+
+const ExeData::CharacterClasses &ExeData::getCharacterClasses() const
+{
+	return this->getSection(this->sections->charClasses);
+}
+
+const ExeData::CharacterCreation &ExeData::getCharacterCreation() const
+{
+	return this->getSection(this->sections->charCreation);
+}
+
+const ExeData::CityGeneration &ExeData::getCityGeneration() const
+{
+	return this->getSection(this->sections->cityGen);
+}
+
+const ExeData::Entities &ExeData::getEntities() const
+{
+	return this->getSection(this->sections->entities);
+}
+
+const ExeData::Equipment &ExeData::getEquipment() const
+{
+	return this->getSection(this->sections->equipment);
+}
+
+const ExeData::Locations &ExeData::getLocations() const
+{
+	return this->getSection(this->sections->locations);
+}
+
+const ExeData::Logbook &ExeData::getLogbook() const
+{
+	return this->getSection(this->sections->logbook);
+}
+
+const ExeData::Meta &ExeData::getMeta() const
+{
+	return this->getSection(this->sections->meta);
+}
+
+const ExeData::Races &ExeData::getRaces() const
+{
+	return this->getSection(this->sections->races);
+}
+
+const ExeData::Status &ExeData::getStatus() const
+{
+	return this->getSection(this->sections->status);
+}
+
+const ExeData::Travel &ExeData::getTravel() const
+{
+	return this->getSection(this->sections->travel);
+}
+
+const ExeData::UI &ExeData::getUI() const
+{
+	return this->getSection(this->sections->ui);
+}
+
+const ExeData::WallHeightTables &ExeData::getWallHeightTables() const
+{
+	return this->getSection(this->sections->wallHeightTables);
+}
+
+const ExeData::Wilderness &ExeData::getWilderness() const
+{
+	return this->getSection(this->sections->wild);
+}
+
 bool ExeData::isFloppyVersion() const
 {
 	return this->floppyVersion;
@@ -804,40 +906,23 @@ bool ExeData::isFloppyVersion() const
 
 bool ExeData::init(bool floppyVersion)
 {
-	// Load executable.
+	// Load executable. It's kept for decoding sections later.
 	const std::string &exeFilename = floppyVersion ?
 		ExeData::FLOPPY_VERSION_EXE_FILENAME : ExeData::CD_VERSION_EXE_FILENAME;
-	ExeUnpacker exe;
-	if (!exe.init(exeFilename.c_str()))
+	auto exe = std::make_unique<ExeUnpacker>();
+	if (!exe->init(exeFilename.c_str(), Platform::getCachePath()))
 	{
 		DebugLogError("Could not init .EXE unpacker for \"" + exeFilename + "\".");
 		return false;
 	}
 
-	const char *dataPtr = reinterpret_cast<const char*>(exe.getData().data());
-
 	// Load key-value map file.
 	const std::string &mapFilename = floppyVersion ?
 		ExeData::FLOPPY_VERSION_MAP_FILENAME : ExeData::CD_VERSION_MAP_FILENAME;
-	const KeyValueMap keyValueMap(Platform::getBasePath() + mapFilename);
-
-	// Initialize members with the executable mappings.
-	this->calendar.init(dataPtr, keyValueMap);
-	this->charClasses.init(dataPtr, keyValueMap);
-	this->charCreation.init(dataPtr, keyValueMap);
-	this->cityGen.init(dataPtr, keyValueMap);
-	this->entities.init(dataPtr, keyValueMap);
-	this->equipment.init(dataPtr, keyValueMap);
-	this->locations.init(dataPtr, keyValueMap);
-	this->logbook.init(dataPtr, keyValueMap);
-	this->meta.init(dataPtr, keyValueMap);
-	this->races.init(dataPtr, keyValueMap);
-	this->status.init(dataPtr, keyValueMap);
-	this->travel.init(dataPtr, keyValueMap);
-	this->ui.init(dataPtr, keyValueMap);
-	this->wallHeightTables.init(dataPtr, keyValueMap);
-	this->wild.init(dataPtr, keyValueMap);
+	this->keyValueMap = std::make_unique<KeyValueMap>(Platform::getBasePath() + mapFilename);
 
+	this->exe = std::move(exe);
+	this->sections = std::make_unique<Sections>();
 	this->floppyVersion = floppyVersion;
 
 	return true;
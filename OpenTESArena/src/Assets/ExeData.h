@@ -3,6 +3,8 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -11,9 +13,14 @@
 // This class stores data from the Arena executable. In other words, it represents a
 // kind of "view" into the executable's data.
 
+// The unpacked executable stays loaded (memory-mapped when it came from the unpack cache),
+// and each section is only decoded the first time it's asked for, since most are only used
+// by a few panels. Sections can be asked for from any thread.
+
 // When expanding this to work with both A.EXE and ACD.EXE, maybe use a union for
 // members that differ between the two executables, with an _a/_acd suffix.
 
+class ExeUnpacker;
 class KeyValueMap;
 
 class ExeData
@@ -498,6 +505,34 @@ public:
 		void init(const char *data, const KeyValueMap &keyValueMap);
 	};
 private:
+	// A section and whether it's been decoded yet.
+	template <typename T>
+	struct Section
+	{
+		T value;
+		std::once_flag flag;
+	};
+
+	// Every section, remade by each init() so they can be decoded again.
+	struct Sections
+	{
+		Section<Calendar> calendar;
+		Section<CharacterClasses> charClasses;
+		Section<CharacterCreation> charCreation;
+		Section<CityGeneration> cityGen;
+		Section<Entities> entities;
+		Section<Equipment> equipment;
+		Section<Locations> locations;
+		Section<Logbook> logbook;
+		Section<Meta> meta;
+		Section<Races> races;
+		Section<Status> status;
+		Section<Travel> travel;
+		Section<UI> ui;
+		Section<WallHeightTables> wallHeightTables;
+		Section<Wilderness> wild;
+	};
+
 	static const std::string CD_VERSION_MAP_FILENAME;
 	static const std::string FLOPPY_VERSION_MAP_FILENAME;
 	static const char PAIR_SEPARATOR;
@@ -521,31 +556,45 @@ private:
 	// and an offset + length pair.
 	static std::string readFixedString(const char *data, const std::pair<int, int> &pair);
 
+	std::unique_ptr<ExeUnpacker> exe; // Unpacked executable that sections are decoded from.
+	std::unique_ptr<KeyValueMap> keyValueMap; // Offsets of the executable's values.
+	std::unique_ptr<Sections> sections;
 	bool floppyVersion;
+
+	// Decodes the section if this is the first time it's asked for.
+	template <typename T>
+	const T &getSection(Section<T> &section) const;
 public:
 	static const std::string CD_VERSION_EXE_FILENAME;
 	static const std::string FLOPPY_VERSION_EXE_FILENAME;
 
-	Calendar calendar;
-	CharacterClasses charClasses;
-	CharacterCreation charCreation;
-	CityGeneration cityGen;
-	Entities entities;
-	Equipment equipment;
-	Locations locations;
-	Logbook logbook;
-	Meta meta;
-	Races races;
-	Status status;
-	Travel travel;
-	UI ui;
-	WallHeightTables wallHeightTables;
-	Wilderness wild;
+	ExeData();
+	ExeData(ExeData&&);
+	~ExeData();
+
+	ExeData &operator=(ExeData&&);
+
+	const Calendar &getCalendar() const;
+	const CharacterClasses &getCharacterClasses() const;
+	const CharacterCreation &getCharacterCreation() const;
+	const CityGeneration &getCityGeneration() const;
+	const Entities &getEntities() const;
+	const Equipment &getEquipment() const;
+	const Locations &getLocations() const;
+	const Logbook &getLogbook() const;
+	const Meta &getMeta() const;
+	const Races &getRaces() const;
+	const Status &getStatus() const;
+	const Travel &getTravel() const;
+	const UI &getUI() const;
+	const WallHeightTables &getWallHeightTables() const;
+	const Wilderness &getWilderness() const;
 
 	bool isFloppyVersion() const;
 
 	// The floppy version boolean determines which strings file to use, and potentially
-	// how to interpret various data structures in the executable.
+	// how to interpret various data structures in the executable. Sections are decoded
+	// later, when they're first asked for.
 	bool init(bool floppyVersion);
 };
 
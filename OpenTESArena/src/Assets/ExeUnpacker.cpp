@@ -1,17 +1,42 @@
 #include <algorithm>
 #include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <string>
 
 #include "ExeUnpacker.h"
 #include "../Utilities/Bytes.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/Platform.h"
 #include "../Utilities/String.h"
 
 #include "components/vfs/manager.hpp"
 
 namespace
 {
+	// Start of an unpacked executable cache file, followed by the unpacked data.
+	struct CacheHeader
+	{
+		uint32_t magic, version;
+		uint64_t srcHash, srcSize, dataSize;
+	};
+
+	const uint32_t CACHE_MAGIC = 0x4558454F; // "OEXE".
+
+	// FNV-1a, for telling whether a cache file came from the same executable.
+	uint64_t hashBytes(const uint8_t *data, size_t size)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ data[i]) * 1099511628211ULL;
+		}
+
+		return hash;
+	}
+
 	// Performance optimization for bit reading (replaces the unnecessary heap 
 	// allocation of std::vector<bool>). Use BitVector::bitsUsed instead of 
 	// BitVector::bits.size().
@@ -205,18 +230,130 @@ namespace
 	};
 }
 
+const uint32_t ExeUnpacker::CACHE_VERSION = 1;
+
+ExeUnpacker::ExeUnpacker()
+{
+	this->data = nullptr;
+	this->size = 0;
+}
+
+bool ExeUnpacker::tryMapCache(const std::string &cacheFilename, size_t srcSize, uint64_t srcHash)
+{
+	if (!this->cacheFile.init(cacheFilename.c_str()))
+	{
+		return false;
+	}
+
+	CacheHeader header;
+	const uint8_t *cacheData = this->cacheFile.getData();
+	const size_t cacheSize = this->cacheFile.getSize();
+	if (cacheSize >= sizeof(header))
+	{
+		std::memcpy(&header, cacheData, sizeof(header));
+		if ((header.magic == CACHE_MAGIC) && (header.version == ExeUnpacker::CACHE_VERSION) &&
+			(header.srcHash == srcHash) && (header.srcSize == srcSize) &&
+			(header.dataSize == (cacheSize - sizeof(header))))
+		{
+			this->data = cacheData + sizeof(header);
+			this->size = header.dataSize;
+			return true;
+		}
+	}
+
+	DebugLogWarning("Ignoring stale unpacked executable \"" + cacheFilename + "\".");
+	this->cacheFile.clear();
+	return false;
+}
+
+void ExeUnpacker::writeCache(const std::string &cacheFolder, const std::string &cacheFilename,
+	size_t srcSize, uint64_t srcHash) const
+{
+	if (!Platform::directoryExists(cacheFolder))
+	{
+		Platform::createDirectoryRecursively(cacheFolder);
+	}
+
+	CacheHeader header;
+	header.magic = CACHE_MAGIC;
+	header.version = ExeUnpacker::CACHE_VERSION;
+	header.srcHash = srcHash;
+	header.srcSize = static_cast<uint64_t>(srcSize);
+	header.dataSize = static_cast<uint64_t>(this->size);
+
+	// Write to a temporary file first so a half-written file is never mapped.
+	const std::string tempFilename = cacheFilename + ".tmp";
+	{
+		std::ofstream ofs(tempFilename, std::ios::binary);
+		if (!ofs.is_open())
+		{
+			DebugLogWarning("Could not open \"" + tempFilename + "\" for writing.");
+			return;
+		}
+
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(this->data), this->size);
+
+		if (!ofs.good())
+		{
+			DebugLogWarning("Could not write unpacked executable \"" + tempFilename + "\".");
+			ofs.close();
+			std::remove(tempFilename.c_str());
+			return;
+		}
+	}
+
+	std::remove(cacheFilename.c_str());
+	if (std::rename(tempFilename.c_str(), cacheFilename.c_str()) != 0)
+	{
+		DebugLogWarning("Could not rename \"" + tempFilename + "\" to \"" + cacheFilename + "\".");
+		std::remove(tempFilename.c_str());
+	}
+}
+
 bool ExeUnpacker::init(const char *filename)
 {
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	return this->init(filename, std::string());
+}
+
+bool ExeUnpacker::init(const char *filename, const std::string &cacheFolder)
+{
+	VFS::FileView src;
+	if (!VFS::Manager::get().read(filename, &src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.data());
+	const size_t srcSize = src.size();
+	const uint64_t srcHash = hashBytes(srcPtr, srcSize);
+
+	const std::string cacheFilename = cacheFolder.empty() ? std::string() :
+		(String::addTrailingSlashIfMissing(cacheFolder) + filename + ".unpacked");
+	if (!cacheFilename.empty() && this->tryMapCache(cacheFilename, srcSize, srcHash))
+	{
+		return true;
+	}
+
+	if (!this->unpack(srcPtr, srcSize))
+	{
+		return false;
+	}
+
+	this->data = this->exeData.data();
+	this->size = this->exeData.size();
+
+	if (!cacheFilename.empty())
+	{
+		this->writeCache(cacheFolder, cacheFilename, srcSize, srcHash);
+	}
+
+	return true;
+}
 
+bool ExeUnpacker::unpack(const uint8_t *srcPtr, size_t srcSize)
+{
 	// Generate the bit trees for "duplication mode". Since the Duplication1 table has 
 	// a special case at index 11, split the insertions up for the first bit tree.
 	BitTree bitTree1, bitTree2;
@@ -442,7 +579,12 @@ bool ExeUnpacker::init(const char *filename)
 	return true;
 }
 
-const std::vector<uint8_t> &ExeUnpacker::getData() const
+const uint8_t *ExeUnpacker::getData() const
+{
+	return this->data;
+}
+
+size_t ExeUnpacker::getSize() const
 {
-	return this->exeData;
+	return this->size;
 }
@@ -1,21 +1,52 @@
 #ifndef EXE_UNPACKER_H
 #define EXE_UNPACKER_H
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
 #include <vector>
 
+#include "../Utilities/MappedFile.h"
+
 // For decompressing DOS executables compressed with PKLITE.
 
+// Unpacking goes bit by bit, so the unpacked image can be cached in a folder and memory-mapped
+// on later runs instead. The cache file stores a hash of the packed executable, so a different
+// executable with the same name is unpacked again.
+
 class ExeUnpacker
 {
 private:
-	std::vector<uint8_t> exeData;
+	// Incremented whenever the cache file layout or the unpacking changes.
+	static const uint32_t CACHE_VERSION;
+
+	std::vector<uint8_t> exeData; // Unpacked here if it didn't come from the cache.
+	MappedFile cacheFile; // Mapped cache file, if it was usable.
+	const uint8_t *data;
+	size_t size;
+
+	// Decompresses a packed executable into the data buffer.
+	bool unpack(const uint8_t *srcPtr, size_t srcSize);
+
+	// Maps a cache file if it was made from an executable with the given size and hash.
+	bool tryMapCache(const std::string &cacheFilename, size_t srcSize, uint64_t srcHash);
+
+	// Writes the unpacked data to a cache file. Failures are only logged.
+	void writeCache(const std::string &cacheFolder, const std::string &cacheFilename,
+		size_t srcSize, uint64_t srcHash) const;
 public:
+	ExeUnpacker();
+
 	// Reads in a compressed EXE file and decompresses it.
 	bool init(const char *filename);
 
-	// Gets the decompressed executable data.
-	const std::vector<uint8_t> &getData() const;
+	// Same as init() but uses the unpacked image cached in the given folder if it matches the
+	// executable, otherwise unpacks it and caches it there. An empty folder is no cache.
+	bool init(const char *filename, const std::string &cacheFolder);
+
+	// Gets the decompressed executable data. It's only valid as long as the unpacker is.
+	const uint8_t *getData() const;
+	size_t getSize() const;
 };
 
 #endif
@@ -0,0 +1,67 @@
+#ifndef FLC_DECODER_H
+#define FLC_DECODER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../Media/Palette.h"
+
+#include "components/vfs/manager.hpp"
+
+// Decodes the frames of an .FLC or .CEL file one at a time, in order. Each frame is only a
+// change to the previous one, so the decoder keeps the current frame and palette around and
+// updates them in place. See FLCFile for the format.
+
+class FLCDecoder
+{
+private:
+	VFS::FileView src;
+	std::vector<uint8_t> framePixels; // Palette indices of the current frame.
+	Palette palette;
+	double frameDuration;
+	size_t frameOffset; // Offset of the current frame header in the file.
+	uint32_t frameSize; // Size of the current frame, including its header.
+	uint32_t chunkOffset; // Offset of the next chunk relative to the current frame.
+	uint16_t chunkIndex, chunkCount; // Next chunk to read and chunks in the current frame.
+	int width, height, frameCount, framesDecoded, paletteCount;
+
+	// Reads a palette chunk and writes out the results to the reference parameter.
+	static bool readPalette(const uint8_t *chunkData, Palette *dst);
+
+	// Decodes a fullscreen FLC chunk into the current frame.
+	void decodeFullFrame(const uint8_t *chunkData, int chunkSize);
+
+	// Decodes a delta FLC chunk by partially updating the current frame.
+	void decodeDeltaFrame(const uint8_t *chunkData, int chunkSize);
+public:
+	FLCDecoder();
+
+	bool init(const char *filename);
+
+	// Gets the number of frames. This leaves out the last frame in the file, since they all
+	// seem to loop back around to the first one.
+	int getFrameCount() const;
+
+	// Gets the duration of each frame in seconds.
+	double getFrameDuration() const;
+
+	// Gets the width of each frame.
+	int getWidth() const;
+
+	// Gets the height of each frame.
+	int getHeight() const;
+
+	// Gets the number of palettes read so far. It changes when a frame comes with a new one.
+	int getPaletteCount() const;
+
+	// Gets the palette of the last decoded frame.
+	const Palette &getPalette() const;
+
+	// Gets the palette indices of the last decoded frame.
+	const uint8_t *getPixels() const;
+
+	// Decodes the next frame, returning false if there isn't one or it couldn't be read.
+	bool decodeNextFrame();
+};
+
+#endif
@@ -24,6 +24,9 @@
 // - http://www.compuphase.com/flic.htm
 // - http://www.fileformat.info/format/fli/egff.htm
 
+// This class keeps every frame. The decoding itself is in FLCDecoder, which can also be used
+// directly to go through the frames without keeping them (i.e., for movies).
+
 class FLCFile
 {
 private:
@@ -34,18 +37,6 @@ private:
 	int width;
 	int height;
 
-	// Reads a palette chunk and writes out the results to the reference parameter.
-	static bool readPalette(const uint8_t *chunkData, Palette *dst);
-
-	// Decodes a fullscreen FLC chunk by updating the initial frame indices and
-	// returning a complete frame.
-	std::unique_ptr<uint8_t[]> decodeFullFrame(const uint8_t *chunkData, int chunkSize,
-		std::vector<uint8_t> &initialFrame);
-
-	// Decodes a delta FLC chunk by partially updating the initial frame indices and
-	// returning a complete frame.
-	std::unique_ptr<uint8_t[]> decodeDeltaFrame(const uint8_t *chunkData, int chunkSize,
-		std::vector<uint8_t> &initialFrame);
 public:
 	bool init(const char *filename);
 
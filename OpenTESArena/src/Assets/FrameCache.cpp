@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "FrameCache.h"
+#include "../Utilities/Debug.h"
+
+FrameCache::FrameCache()
+{
+	this->maxFrames = 0;
+}
+
+void FrameCache::init(int maxFrames)
+{
+	DebugAssert(maxFrames > 0);
+	this->frames.clear();
+	this->maxFrames = maxFrames;
+}
+
+const uint8_t *FrameCache::find(int index)
+{
+	const auto iter = std::find_if(this->frames.begin(), this->frames.end(),
+		[index](const std::pair<int, std::unique_ptr<uint8_t[]>> &pair)
+	{
+		return pair.first == index;
+	});
+
+	if (iter == this->frames.end())
+	{
+		return nullptr;
+	}
+
+	if (iter != (this->frames.end() - 1))
+	{
+		std::pair<int, std::unique_ptr<uint8_t[]>> pair = std::move(*iter);
+		this->frames.erase(iter);
+		this->frames.push_back(std::move(pair));
+	}
+
+	return this->frames.back().second.get();
+}
+
+uint8_t *FrameCache::add(int index, int pixelCount)
+{
+	DebugAssert(this->maxFrames > 0);
+
+	if (static_cast<int>(this->frames.size()) >= this->maxFrames)
+	{
+		this->frames.pop_front();
+	}
+
+	this->frames.push_back(std::make_pair(index, std::make_unique<uint8_t[]>(pixelCount)));
+	return this->frames.back().second.get();
+}
@@ -0,0 +1,32 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+
+// Keeps the most recently used decoded frames of an animation file, for files that decode
+// their frames on first access instead of all at once.
+
+class FrameCache
+{
+private:
+	// Decoded frames and their indices, least recently used first.
+	std::deque<std::pair<int, std::unique_ptr<uint8_t[]>>> frames;
+	int maxFrames;
+public:
+	FrameCache();
+
+	// Empties the cache and sets how many frames it can hold.
+	void init(int maxFrames);
+
+	// Gets the pixels of a frame if it's cached, marking it as the most recently used.
+	const uint8_t *find(int index);
+
+	// Allocates zeroed pixels for a frame that isn't cached, dropping the least recently
+	// used frame if the cache is full. The caller decodes the frame into them.
+	uint8_t *add(int index, int pixelCount);
+};
+
+#endif
@@ -55,15 +55,15 @@ bool IMGFile::init(const char *filename)
 		return true;
 	}
 
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	VFS::FileView src;
+	if (!VFS::Manager::get().read(filename, &src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.data());
+	const size_t srcSize = src.size();
 	uint16_t xoff, yoff, width, height, flags, len;
 
 	// Read header data if not raw. Wall .IMGs have no header and are 4096 bytes.
@@ -220,15 +220,15 @@ Palette IMGFile::readPalette(const uint8_t *paletteData)
 
 bool IMGFile::extractPalette(const char *filename, Palette &palette)
 {
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	VFS::FileView src;
+	if (!VFS::Manager::get().read(filename, &src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.data());
+	const size_t srcSize = src.size();
 
 	// Read the flags and .IMG file length. Skip the X and Y offsets and dimensions.
 	// No need to check for raw override. All given filenames should point to IMGs
@@ -245,8 +245,16 @@ bool IMGFile::extractPalette(const char *filename, Palette &palette)
 		return false;
 	}
 
+	// The palette is the 768 bytes after the pixels.
+	const size_t paletteOffset = static_cast<size_t>(headerSize + len);
+	if (srcSize < (paletteOffset + 768))
+	{
+		DebugLogError("\"" + std::string(filename) + "\" is too small for its palette.");
+		return false;
+	}
+
 	// Get the palette.
-	palette = IMGFile::readPalette(srcPtr + headerSize + len);
+	palette = IMGFile::readPalette(srcPtr + paletteOffset);
 	return true;
 }
 
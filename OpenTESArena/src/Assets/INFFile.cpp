@@ -1,6 +1,7 @@
 #include <algorithm>
+#include <array>
 #include <cctype>
-#include <sstream>
+#include <charconv>
 #include <string_view>
 #include <unordered_set>
 
@@ -13,6 +14,36 @@
 
 namespace
 {
+	bool isWhitespace(char c)
+	{
+		return (c == ' ') || (c == '\t');
+	}
+
+	// Parses an integer at the start of a token the way std::stoi() does, without making a
+	// string out of the token.
+	int parseInt(std::string_view str)
+	{
+		while (!str.empty() && isWhitespace(str.front()))
+		{
+			str.remove_prefix(1);
+		}
+
+		if (!str.empty() && (str.front() == '+'))
+		{
+			str.remove_prefix(1);
+		}
+
+		int value = 0;
+		const std::from_chars_result result = std::from_chars(
+			str.data(), str.data() + str.size(), value);
+		if (result.ec != std::errc())
+		{
+			DebugCrash("Invalid .INF number \"" + std::string(str) + "\".");
+		}
+
+		return value;
+	}
+
 	// Each '@' section may or may not have some state it currently possesses. They 
 	// also have a mode they can be in, via a tag like *BOXCAP or *TEXT.
 	struct FloorState
@@ -163,6 +194,15 @@ bool INFFile::init(const char *filename)
 	// Check if the .INF is encrypted.
 	const bool isEncrypted = inGlobalBSA;
 
+	// Hash the file before it's decoded in place.
+	this->srcHash = 14695981039346656037ULL;
+	for (auto it = srcPtr; it != srcEnd; ++it)
+	{
+		this->srcHash = (this->srcHash ^ *it) * 1099511628211ULL;
+	}
+
+	this->srcHash = (this->srcHash ^ (isEncrypted ? 1 : 0)) * 1099511628211ULL;
+
 	if (isEncrypted)
 	{
 		// Adapted from BSATool.
@@ -186,12 +226,10 @@ bool INFFile::init(const char *filename)
 
 	this->name = filename;
 
-	// Assign the data (now decoded if it was encoded) to the text member exposed
-	// to the rest of the program.
-	std::string text(reinterpret_cast<char*>(srcPtr), srcSize);
-
-	// Remove carriage returns (newlines are nicer to work with).
-	text = String::replace(text, "\r", "");
+	// Remove carriage returns (newlines are nicer to work with). This is done in place so the
+	// parser can work on views into the file data (now decoded if it was encoded).
+	srcEnd = std::remove(srcPtr, srcEnd, '\r');
+	const std::string_view text(reinterpret_cast<const char*>(srcPtr), srcEnd - srcPtr);
 
 	// The parse mode indicates which '@' section is currently being parsed.
 	enum class ParseMode
@@ -257,7 +295,7 @@ bool INFFile::init(const char *filename)
 	};
 
 	// Lambdas for parsing a line of text.
-	auto parseFloorLine = [this, &floorState](const std::string &line)
+	auto parseFloorLine = [this, &floorState](std::string_view line)
 	{
 		const char TYPE_CHAR = '*';
 
@@ -271,19 +309,20 @@ bool INFFile::init(const char *filename)
 				floorState = FloorState();
 			}
 
-			const std::string BOXCAP_STR = "BOXCAP";
-			const std::string CEILING_STR = "CEILING";
-			const std::string TOP_STR = "TOP"; // Only occurs in LABRNTH{1,2}.INF.
+			const std::string_view BOXCAP_STR = "BOXCAP";
+			const std::string_view CEILING_STR = "CEILING";
+			const std::string_view TOP_STR = "TOP"; // Only occurs in LABRNTH{1,2}.INF.
 
 			// See what the type in the line is.
-			const std::vector<std::string_view> tokens = StringView::split(line);
+			std::array<std::string_view, 4> tokens;
+			const size_t tokenCount = StringView::split(line, ' ', tokens);
 			const std::string_view firstToken = tokens.at(0);
 			const std::string_view firstTokenType = firstToken.substr(1, firstToken.size() - 1);
 
 			if (firstTokenType == BOXCAP_STR)
 			{
 				// Write the *BOXCAP's ID to the floor state.
-				floorState->boxCapID = std::stoi(std::string(tokens.at(1)));
+				floorState->boxCapID = parseInt(tokens.at(1));
 				floorState->mode = FloorState::Mode::BoxCap;
 			}
 			else if (firstTokenType == CEILING_STR)
@@ -294,17 +333,17 @@ bool INFFile::init(const char *filename)
 
 				// Check up to three numbers on the right: ceiling height, box scale,
 				// and indoor/outdoor dungeon boolean. Sometimes there are no numbers.
-				if (tokens.size() >= 2)
+				if (tokenCount >= 2)
 				{
-					floorState->ceilingData->height = std::stoi(std::string(tokens.at(1)));
+					floorState->ceilingData->height = parseInt(tokens.at(1));
 				}
 
-				if (tokens.size() >= 3)
+				if (tokenCount >= 3)
 				{
-					floorState->ceilingData->boxScale = std::stoi(std::string(tokens.at(2)));
+					floorState->ceilingData->boxScale = parseInt(tokens.at(2));
 				}
 
-				if (tokens.size() == 4)
+				if (tokenCount == 4)
 				{
 					floorState->ceilingData->outdoorDungeon = tokens.at(3) == "1";
 				}
@@ -323,18 +362,19 @@ bool INFFile::init(const char *filename)
 		{
 			// No current floor state, so the current line is a loose texture filename
 			// (found in some city .INFs).
-			const std::vector<std::string_view> tokens = StringView::split(line, '#');
+			std::array<std::string_view, 2> tokens;
+			const size_t tokenCount = StringView::split(line, '#', tokens);
 
-			if (tokens.size() == 1)
+			if (tokenCount == 1)
 			{
 				// A regular filename (like an .IMG).
-				this->voxelTextures.push_back(VoxelTextureData(line));
+				this->voxelTextures.push_back(VoxelTextureData(std::string(line)));
 			}
 			else
 			{
 				// A .SET filename. Expand it for each of the .SET indices.
 				const std::string_view textureName = StringView::trimBack(tokens.at(0));
-				const int setSize = std::stoi(std::string(tokens.at(1)));
+				const int setSize = parseInt(tokens.at(1));
 
 				for (int i = 0; i < setSize; i++)
 				{
@@ -349,10 +389,11 @@ bool INFFile::init(const char *filename)
 			const int currentIndex = [this, &floorState, &line]()
 			{
 				// If the line contains a '#', it's a .SET file.
-				const std::vector<std::string_view> tokens = StringView::split(line, '#');
+				std::array<std::string_view, 2> tokens;
+				const size_t tokenCount = StringView::split(line, '#', tokens);
 
 				// Assign texture data depending on whether the line is for a .SET file.
-				if (tokens.size() == 1)
+				if (tokenCount == 1)
 				{
 					// Just a regular texture (like an .IMG).
 					floorState->textureName = line;
@@ -365,7 +406,7 @@ bool INFFile::init(const char *filename)
 				{
 					// Left side is the filename, right side is the .SET size.
 					floorState->textureName = StringView::trimBack(tokens.at(0));
-					const int setSize = std::stoi(std::string(tokens.at(1)));
+					const int setSize = parseInt(tokens.at(1));
 
 					for (int i = 0; i < setSize; i++)
 					{
@@ -399,7 +440,7 @@ bool INFFile::init(const char *filename)
 		}
 	};
 
-	auto parseWallLine = [this, &wallState](const std::string &line)
+	auto parseWallLine = [this, &wallState](std::string_view line)
 	{
 		const char TYPE_CHAR = '*';
 
@@ -414,33 +455,34 @@ bool INFFile::init(const char *filename)
 			}
 
 			// All the different possible '*' sections for walls.
-			const std::string BOXCAP_STR = "BOXCAP";
-			const std::string BOXSIDE_STR = "BOXSIDE";
-			const std::string DOOR_STR = "DOOR"; // *DOOR is ignored.
-			const std::string DRYCHASM_STR = "DRYCHASM";
-			const std::string LAVACHASM_STR = "LAVACHASM";
-			const std::string LEVELDOWN_STR = "LEVELDOWN";
-			const std::string LEVELUP_STR = "LEVELUP";
-			const std::string MENU_STR = "MENU"; // Exterior <-> interior transitions.
-			const std::string TRANS_STR = "TRANS"; // *TRANS is ignored.
-			const std::string TRANSWALKTHRU_STR = "TRANSWALKTHRU"; // *TRANSWALKTHRU is ignored.
-			const std::string WALKTHRU_STR = "WALKTHRU"; // *WALKTHRU is ignored.
-			const std::string WETCHASM_STR = "WETCHASM";
+			const std::string_view BOXCAP_STR = "BOXCAP";
+			const std::string_view BOXSIDE_STR = "BOXSIDE";
+			const std::string_view DOOR_STR = "DOOR"; // *DOOR is ignored.
+			const std::string_view DRYCHASM_STR = "DRYCHASM";
+			const std::string_view LAVACHASM_STR = "LAVACHASM";
+			const std::string_view LEVELDOWN_STR = "LEVELDOWN";
+			const std::string_view LEVELUP_STR = "LEVELUP";
+			const std::string_view MENU_STR = "MENU"; // Exterior <-> interior transitions.
+			const std::string_view TRANS_STR = "TRANS"; // *TRANS is ignored.
+			const std::string_view TRANSWALKTHRU_STR = "TRANSWALKTHRU"; // *TRANSWALKTHRU is ignored.
+			const std::string_view WALKTHRU_STR = "WALKTHRU"; // *WALKTHRU is ignored.
+			const std::string_view WETCHASM_STR = "WETCHASM";
 
 			// See what the type in the line is.
-			const std::vector<std::string_view> tokens = StringView::split(line);
+			std::array<std::string_view, 2> tokens;
+			StringView::split(line, ' ', tokens);
 			const std::string_view firstToken = tokens.at(0);
 			const std::string_view firstTokenType = firstToken.substr(1, firstToken.size() - 1);
 
 			if (firstTokenType == BOXCAP_STR)
 			{
 				wallState->mode = WallState::Mode::BoxCap;
-				wallState->boxCapIDs.push_back(std::stoi(std::string(tokens.at(1))));
+				wallState->boxCapIDs.push_back(parseInt(tokens.at(1)));
 			}
 			else if (firstTokenType == BOXSIDE_STR)
 			{
 				wallState->mode = WallState::Mode::BoxSide;
-				wallState->boxSideIDs.push_back(std::stoi(std::string(tokens.at(1))));
+				wallState->boxSideIDs.push_back(parseInt(tokens.at(1)));
 			}
 			else if (firstTokenType == DOOR_STR)
 			{
@@ -468,7 +510,7 @@ bool INFFile::init(const char *filename)
 			else if (firstTokenType == MENU_STR)
 			{
 				wallState->mode = WallState::Mode::Menu;
-				wallState->menuID = std::stoi(std::string(tokens.at(1)));
+				wallState->menuID = parseInt(tokens.at(1));
 			}
 			else if (firstTokenType == TRANS_STR)
 			{
@@ -498,18 +540,19 @@ bool INFFile::init(const char *filename)
 		else if (!wallState.has_value())
 		{
 			// No existing wall state, so this line contains a "loose" texture name.
-			const std::vector<std::string_view> tokens = StringView::split(line, '#');
+			std::array<std::string_view, 2> tokens;
+			const size_t tokenCount = StringView::split(line, '#', tokens);
 
-			if (tokens.size() == 1)
+			if (tokenCount == 1)
 			{
 				// A regular filename (like an .IMG).
-				this->voxelTextures.push_back(VoxelTextureData(line));
+				this->voxelTextures.push_back(VoxelTextureData(std::string(line)));
 			}
 			else
 			{
 				// A .SET filename. Expand it for each of the .SET indices.
 				const std::string_view textureName = StringView::trimBack(tokens.at(0));
-				const int setSize = std::stoi(std::string(tokens.at(1)));
+				const int setSize = parseInt(tokens.at(1));
 
 				for (int i = 0; i < setSize; i++)
 				{
@@ -524,10 +567,11 @@ bool INFFile::init(const char *filename)
 			const int currentIndex = [this, &wallState, &line]()
 			{
 				// If the line contains a '#', it's a .SET file.
-				const std::vector<std::string_view> tokens = StringView::split(line, '#');
+				std::array<std::string_view, 2> tokens;
+				const size_t tokenCount = StringView::split(line, '#', tokens);
 
 				// Assign texture data depending on whether the line is for a .SET file.
-				if (tokens.size() == 1)
+				if (tokenCount == 1)
 				{
 					// Just a regular texture (like an .IMG).
 					wallState->textureName = line;
@@ -540,7 +584,7 @@ bool INFFile::init(const char *filename)
 				{
 					// Left side is the filename, right side is the .SET size.
 					wallState->textureName = StringView::trimBack(tokens.at(0));
-					const int setSize = std::stoi(std::string(tokens.at(1)));
+					const int setSize = parseInt(tokens.at(1));
 
 					for (int i = 0; i < setSize; i++)
 					{
@@ -598,7 +642,7 @@ bool INFFile::init(const char *filename)
 		}
 	};
 
-	auto parseFlatLine = [this, &flatState](const std::string &line)
+	auto parseFlatLine = [this, &flatState](std::string_view line)
 	{
 		const char TYPE_CHAR = '*';
 
@@ -612,17 +656,18 @@ bool INFFile::init(const char *filename)
 				flatState = FlatState();
 			}
 
-			const std::string ITEM_STR = "ITEM";
+			const std::string_view ITEM_STR = "ITEM";
 
 			// See what the type in the line is.
-			const std::vector<std::string_view> tokens = StringView::split(line);
+			std::array<std::string_view, 2> tokens;
+			StringView::split(line, ' ', tokens);
 			const std::string_view firstToken = tokens.at(0);
 			const std::string_view firstTokenType = firstToken.substr(1, firstToken.size() - 1);
 
 			if (firstTokenType == ITEM_STR)
 			{
 				flatState->mode = FlatState::Mode::Item;
-				flatState->itemID = std::stoi(std::string(tokens.at(1)));
+				flatState->itemID = parseInt(tokens.at(1));
 			}
 			else
 			{
@@ -638,27 +683,40 @@ bool INFFile::init(const char *filename)
 			// modifiers on the right. Each token might be split by tabs or spaces, so always 
 			// check for both cases. The texture name always has a tab on the right though 
 			// (if there's any whitespace).
-			const std::vector<std::string> tokens = [&line, MODIFIER_SEPARATOR]()
+			std::array<std::string_view, 8> tokens;
+			size_t tokenCount = 0;
+
+			// Special case at *ITEM 55 in CRYSTAL3.INF: do not split on whitespace,
+			// because there are no modifiers.
+			if (line.find(MODIFIER_SEPARATOR) == std::string_view::npos)
 			{
-				// Trim any extra whitespace (so there are no adjacent duplicates).
-				const std::string trimmedStr = String::trimExtra(line);
+				tokens[0] = line;
+				tokenCount = 1;
+			}
+			else
+			{
+				// Split on runs of whitespace.
+				size_t i = 0;
+				while (i < line.size())
+				{
+					if (isWhitespace(line[i]))
+					{
+						i++;
+						continue;
+					}
 
-				// Replace tabs with spaces.
-				const std::string replacedStr = String::replace(trimmedStr, '\t', ' ');
+					const size_t tokenStart = i;
+					while ((i < line.size()) && !isWhitespace(line[i]))
+					{
+						i++;
+					}
 
-				// Special case at *ITEM 55 in CRYSTAL3.INF: do not split on whitespace,
-				// because there are no modifiers.
-				if (replacedStr.find(MODIFIER_SEPARATOR) == std::string::npos)
-				{
-					return std::vector<std::string>{ replacedStr };
+					DebugAssertMsg(tokenCount < tokens.size(), "Too many .INF flat modifiers in \"" +
+						std::string(line) + "\".");
+					tokens[tokenCount] = line.substr(tokenStart, i - tokenStart);
+					tokenCount++;
 				}
-				else
-				{
-					// @todo: refine String::split() to account for whitespace in general so
-					// we can avoid doing the extra steps above.
-					return String::split(replacedStr);
-				}
-			}();
+			}
 
 			// Creature flats are between *ITEM 32 and *ITEM 54. These do not need their
 			// texture line parsed.
@@ -669,18 +727,33 @@ bool INFFile::init(const char *filename)
 			// string instead; they are obtained later as .CFAs).
 			const std::string textureName = [&tokens, isCreatureFlat]()
 			{
-				if (isCreatureFlat)
+				std::string name;
+				if (!isCreatureFlat)
 				{
-					return std::string();
-				}
-				else
-				{
-					// It's not a creature flat. Return the string, excluding any dash.
-					const std::string &firstToken = tokens.at(0);
-					const bool hasDash = firstToken.at(0) == '-'; // @todo: not sure what this is.
-					return String::toUppercase(hasDash ? 
-						firstToken.substr(1, firstToken.size() - 1) : firstToken);
+					// It's not a creature flat. Uppercase the name, excluding any dash, and with
+					// each run of whitespace (only in the no modifiers case) as one space.
+					std::string_view firstToken = tokens[0];
+					if (firstToken.at(0) == '-') // @todo: not sure what this is.
+					{
+						firstToken.remove_prefix(1);
+					}
+
+					name.reserve(firstToken.size());
+					for (size_t i = 0; i < firstToken.size(); i++)
+					{
+						const char c = firstToken[i];
+						if (!isWhitespace(c))
+						{
+							name += static_cast<char>(std::toupper(c));
+						}
+						else if ((i == 0) || !isWhitespace(firstToken[i - 1]))
+						{
+							name += ' ';
+						}
+					}
 				}
+
+				return name;
 			}();
 
 			// Add the flat's texture name to the textures vector.
@@ -705,9 +778,9 @@ bool INFFile::init(const char *filename)
 
 			// If the flat is not a creature and has modifiers, then check each modifier and
 			// mutate the flat accordingly.
-			if (!isCreatureFlat && (tokens.size() >= 2))
+			if (!isCreatureFlat && (tokenCount >= 2))
 			{
-				for (size_t i = 1; i < tokens.size(); i++)
+				for (size_t i = 1; i < tokenCount; i++)
 				{
 					const char FLAT_PROPERTIES_MODIFIER = 'F';
 					const char LIGHT_MODIFIER = 'S';
@@ -717,9 +790,9 @@ bool INFFile::init(const char *filename)
 					const char modifierType = std::toupper(modifierStr.at(0));
 
 					// The modifier value comes after the modifier separator.
-					const std::vector<std::string_view> modifierTokens =
-						StringView::split(modifierStr, MODIFIER_SEPARATOR);
-					const int modifierValue = std::stoi(std::string(modifierTokens.at(1)));
+					std::array<std::string_view, 2> modifierTokens;
+					StringView::split(modifierStr, MODIFIER_SEPARATOR, modifierTokens);
+					const int modifierValue = parseInt(modifierTokens.at(1));
 
 					if (modifierType == FLAT_PROPERTIES_MODIFIER)
 					{
@@ -754,17 +827,19 @@ bool INFFile::init(const char *filename)
 		}
 	};
 
-	auto parseSoundLine = [this](const std::string &line)
+	auto parseSoundLine = [this](std::string_view line)
 	{
 		// Split into the filename and ID. Make sure the filename is all caps.
-		const std::vector<std::string_view> tokens = StringView::split(line);
-		const std::string vocFilename = String::toUppercase(std::string(tokens.front()));
-		const int vocID = std::stoi(std::string(tokens.at(1)));
+		std::array<std::string_view, 2> tokens;
+		StringView::split(line, ' ', tokens);
+		std::string vocFilename(tokens.front());
+		String::toUppercaseInPlace(vocFilename);
+		const int vocID = parseInt(tokens.at(1));
 
 		this->sounds.insert(std::make_pair(vocID, vocFilename));
 	};
 
-	auto parseTextLine = [this, &textState, &flushTextState](const std::string &line)
+	auto parseTextLine = [this, &textState, &flushTextState](std::string_view line)
 	{
 		// Start a new text state after each *TEXT tag.
 		const char TEXT_CHAR = '*';
@@ -776,10 +851,11 @@ bool INFFile::init(const char *filename)
 		// Otherwise, parse the line based on the current mode.
 		if (line.front() == TEXT_CHAR)
 		{
-			const std::vector<std::string_view> tokens = StringView::split(line);
+			std::array<std::string_view, 2> tokens;
+			StringView::split(line, ' ', tokens);
 
 			// Get the ID after *TEXT.
-			const int textID = std::stoi(std::string(tokens.at(1)));
+			const int textID = parseInt(tokens.at(1));
 
 			// If there is existing text state present, save it.
 			if (textState.has_value())
@@ -794,7 +870,7 @@ bool INFFile::init(const char *filename)
 		{
 			// Get key number. No need for a key section here since it's only one line.
 			const std::string_view keyStr = StringView::substr(line, 1, line.size() - 1);
-			const int keyNumber = std::stoi(std::string(keyStr));
+			const int keyNumber = parseInt(keyStr);
 
 			textState->mode = TextState::Mode::Key;
 			textState->keyData = KeyData(keyNumber);
@@ -803,9 +879,10 @@ bool INFFile::init(const char *filename)
 		{
 			// Get riddle numbers.
 			const std::string_view numbers = StringView::substr(line, 1, line.size() - 1);
-			const std::vector<std::string_view> tokens = StringView::split(numbers);
-			const int firstNumber = std::stoi(std::string(tokens.at(0)));
-			const int secondNumber = std::stoi(std::string(tokens.at(1)));
+			std::array<std::string_view, 2> tokens;
+			StringView::split(numbers, ' ', tokens);
+			const int firstNumber = parseInt(tokens.at(0));
+			const int secondNumber = parseInt(tokens.at(1));
 
 			textState->mode = TextState::Mode::Riddle;
 			textState->riddleState = TextState::RiddleState(firstNumber, secondNumber);
@@ -818,7 +895,8 @@ bool INFFile::init(const char *filename)
 			textState->textData = TextData(displayedOnce);
 
 			// Append the rest of the line to the text data.
-			textState->textData->text += line.substr(1, line.size() - 1) + '\n';
+			textState->textData->text.append(line.substr(1, line.size() - 1));
+			textState->textData->text += '\n';
 		}
 		else if (textState->mode == TextState::Mode::Riddle)
 		{
@@ -834,8 +912,8 @@ bool INFFile::init(const char *filename)
 			else if (line.front() == RESPONSE_SECTION_CHAR)
 			{
 				// Change riddle mode based on the response section.
-				const std::string CORRECT_STR = "CORRECT";
-				const std::string WRONG_STR = "WRONG";
+				const std::string_view CORRECT_STR = "CORRECT";
+				const std::string_view WRONG_STR = "WRONG";
 				const std::string_view responseSection = StringView::substr(line, 1, line.size() - 1);
 
 				if (responseSection == CORRECT_STR)
@@ -850,23 +928,27 @@ bool INFFile::init(const char *filename)
 			else if (textState->riddleState->mode == TextState::RiddleState::Mode::Riddle)
 			{
 				// Read the line into the riddle text.
-				textState->riddleState->data.riddle += line + '\n';
+				textState->riddleState->data.riddle.append(line);
+				textState->riddleState->data.riddle += '\n';
 			}
 			else if (textState->riddleState->mode == TextState::RiddleState::Mode::Correct)
 			{
 				// Read the line into the correct text.
-				textState->riddleState->data.correct += line + '\n';
+				textState->riddleState->data.correct.append(line);
+				textState->riddleState->data.correct += '\n';
 			}
 			else if (textState->riddleState->mode == TextState::RiddleState::Mode::Wrong)
 			{
 				// Read the line into the wrong text.
-				textState->riddleState->data.wrong += line + '\n';
+				textState->riddleState->data.wrong.append(line);
+				textState->riddleState->data.wrong += '\n';
 			}
 		}
 		else if (textState->mode == TextState::Mode::Text)
 		{
 			// Read the line into the text data.
-			textState->textData->text += line + '\n';
+			textState->textData->text.append(line);
+			textState->textData->text += '\n';
 		}
 		else
 		{
@@ -889,7 +971,8 @@ bool INFFile::init(const char *filename)
 			}
 
 			// Read the line into the text data.
-			textState->textData->text += line + '\n';
+			textState->textData->text.append(line);
+			textState->textData->text += '\n';
 		}
 	};
 
@@ -897,11 +980,15 @@ bool INFFile::init(const char *filename)
 	// tag even when it's needed.
 	ParseMode parseMode = ParseMode::Floors;
 
-	std::stringstream ss(text);
-	std::string line;
-
-	while (std::getline(ss, line))
+	// Go through the text line by line. The lines are views into the file data, so they
+	// only become strings when something keeps them.
+	size_t lineStart = 0;
+	while (lineStart < text.size())
 	{
+		const size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+		const std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
 		const char SECTION_SEPARATOR = '@';
 
 		// First check if the line is empty. Then check the first character for any changes 
@@ -923,23 +1010,29 @@ bool INFFile::init(const char *filename)
 		}
 		else if (line.front() == SECTION_SEPARATOR)
 		{
-			const std::unordered_map<std::string, ParseMode> Sections =
+			const std::array<std::pair<std::string_view, ParseMode>, 5> Sections =
 			{
-				{ "@FLOORS", ParseMode::Floors },
-				{ "@WALLS", ParseMode::Walls },
-				{ "@FLATS", ParseMode::Flats },
-				{ "@SOUND", ParseMode::Sound },
-				{ "@TEXT", ParseMode::Text }
+				std::make_pair("@FLOORS", ParseMode::Floors),
+				std::make_pair("@WALLS", ParseMode::Walls),
+				std::make_pair("@FLATS", ParseMode::Flats),
+				std::make_pair("@SOUND", ParseMode::Sound),
+				std::make_pair("@TEXT", ParseMode::Text)
 			};
 
 			// Separate the '@' token from other things in the line (like @FLATS NOSHOW).
-			const std::vector<std::string_view> tokens = StringView::split(line);
-			line = std::string(tokens.front());
+			std::array<std::string_view, 1> tokens;
+			StringView::split(line, ' ', tokens);
+			const std::string_view sectionName = tokens.front();
 
 			// See which token the section is.
-			const auto sectionIter = Sections.find(line);
+			const auto sectionIter = std::find_if(Sections.begin(), Sections.end(),
+				[sectionName](const std::pair<std::string_view, ParseMode> &pair)
+			{
+				return pair.first == sectionName;
+			});
+
 			DebugAssertMsg(sectionIter != Sections.end(),
-				"Unrecognized .INF section \"" + line + "\".");
+				"Unrecognized .INF section \"" + std::string(sectionName) + "\".");
 
 			// Flush any existing state.
 			flushAllStates();
@@ -1063,6 +1156,11 @@ const std::string &INFFile::getSound(int index) const
 	}
 }
 
+const std::unordered_map<int, std::string> &INFFile::getSounds() const
+{
+	return this->sounds;
+}
+
 bool INFFile::hasKeyIndex(int index) const
 {
 	return this->keys.find(index) != this->keys.end();
@@ -1098,6 +1196,11 @@ const std::string &INFFile::getName() const
 	return this->name;
 }
 
+uint64_t INFFile::getSourceHash() const
+{
+	return this->srcHash;
+}
+
 const int *INFFile::getDryChasmIndex() const
 {
 	return this->dryChasmIndex.has_value() ? &this->dryChasmIndex.value() : nullptr;
@@ -138,6 +138,10 @@ private:
 
 	std::string name;
 
+	// FNV-1a hash of the file's bytes as read and whether they came from the global BSA, so
+	// caches of things built from the .INF can tell when it changed.
+	uint64_t srcHash;
+
 	// References into the textures vector (if any).
 	std::optional<int> dryChasmIndex, lavaChasmIndex, levelDownIndex, levelUpIndex, wetChasmIndex;
 
@@ -155,6 +159,7 @@ public:
 	const FlatData &getFlat(int index) const;
 	const FlatData &getItem(int index) const;
 	const std::string &getSound(int index) const;
+	const std::unordered_map<int, std::string> &getSounds() const;
 	bool hasKeyIndex(int index) const;
 	bool hasRiddleIndex(int index) const;
 	bool hasTextIndex(int index) const;
@@ -162,6 +167,7 @@ public:
 	const RiddleData &getRiddle(int index) const;
 	const TextData &getText(int index) const;
 	const std::string &getName() const;
+	uint64_t getSourceHash() const;
 	const int *getDryChasmIndex() const;
 	const int *getLavaChasmIndex() const;
 	const int *getLevelDownIndex() const;
@@ -0,0 +1,369 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+
+#include "ImagePack.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/File.h"
+#include "../Utilities/String.h"
+
+namespace
+{
+	// Start of a pack file. Each table and stored image starts on an aligned offset.
+	struct PackHeader
+	{
+		uint32_t magic, version;
+		uint64_t srcHash;
+		uint32_t entryCount, imageCount;
+		uint64_t entriesOffset, imagesOffset, namesOffset, namesSize;
+	};
+
+	struct PackEntry
+	{
+		uint32_t nameOffset, nameLength;
+		uint32_t firstImage, imageCount;
+	};
+
+	struct PackImage
+	{
+		uint32_t width, height;
+		uint64_t pixelsOffset;
+		uint64_t paletteOffset; // Zero if the image has no palette.
+		uint32_t usesOwnPalette, padding;
+	};
+
+	const uint32_t PACK_MAGIC = 0x474D494F; // "OIMG".
+
+	// Cache line size, so rows can be read with aligned loads.
+	const uint64_t PACK_ALIGNMENT = 64;
+
+	uint64_t alignOffset(uint64_t offset)
+	{
+		return (offset + (PACK_ALIGNMENT - 1)) & ~(PACK_ALIGNMENT - 1);
+	}
+
+	const PackEntry &getEntry(const uint8_t *entries, int index)
+	{
+		return reinterpret_cast<const PackEntry*>(entries)[index];
+	}
+
+	const PackImage &getPackImage(const uint8_t *images, int index)
+	{
+		return reinterpret_cast<const PackImage*>(images)[index];
+	}
+}
+
+const int ImagePack::PALETTE_BYTES = 256 * 4;
+const uint32_t ImagePack::VERSION = 1;
+
+ImagePack::Writer::Writer()
+{
+	this->offset = 0;
+}
+
+void ImagePack::Writer::align()
+{
+	const uint64_t alignedOffset = alignOffset(this->offset);
+	const char zeroes[PACK_ALIGNMENT] = { };
+	this->stream.write(zeroes, alignedOffset - this->offset);
+	this->offset = alignedOffset;
+}
+
+bool ImagePack::Writer::init(const std::string &filename)
+{
+	this->filename = filename;
+	this->tempFilename = filename + ".tmp";
+	this->images.clear();
+	this->entries.clear();
+
+	this->stream.open(this->tempFilename, std::ios::binary | std::ios::trunc);
+	if (!this->stream.is_open())
+	{
+		DebugLogWarning("Could not open \"" + this->tempFilename + "\" for writing.");
+		return false;
+	}
+
+	// The header is written last, once the table offsets are known.
+	const PackHeader header = { };
+	this->stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	this->offset = sizeof(header);
+	return true;
+}
+
+void ImagePack::Writer::add(const std::string &name, const std::vector<Image> &images)
+{
+	WrittenEntry entry;
+	entry.name = String::toUppercase(name);
+	entry.firstImage = static_cast<int>(this->images.size());
+	entry.imageCount = static_cast<int>(images.size());
+	this->entries.push_back(std::move(entry));
+
+	for (const Image &image : images)
+	{
+		WrittenImage writtenImage;
+		writtenImage.width = image.width;
+		writtenImage.height = image.height;
+		writtenImage.usesOwnPalette = image.usesOwnPalette;
+
+		this->align();
+		writtenImage.pixelsOffset = this->offset;
+		const uint64_t pixelCount = static_cast<uint64_t>(image.width) * image.height;
+		this->stream.write(reinterpret_cast<const char*>(image.pixels), pixelCount);
+		this->offset += pixelCount;
+
+		writtenImage.paletteOffset = 0;
+		if (image.paletteColors != nullptr)
+		{
+			this->align();
+			writtenImage.paletteOffset = this->offset;
+			this->stream.write(reinterpret_cast<const char*>(image.paletteColors),
+				ImagePack::PALETTE_BYTES);
+			this->offset += ImagePack::PALETTE_BYTES;
+		}
+
+		this->images.push_back(writtenImage);
+	}
+}
+
+bool ImagePack::Writer::finish(uint64_t srcHash)
+{
+	std::sort(this->entries.begin(), this->entries.end(),
+		[](const WrittenEntry &a, const WrittenEntry &b)
+	{
+		return a.name < b.name;
+	});
+
+	// Names go in one block after the tables.
+	PackHeader header;
+	header.magic = PACK_MAGIC;
+	header.version = ImagePack::VERSION;
+	header.srcHash = srcHash;
+	header.entryCount = static_cast<uint32_t>(this->entries.size());
+	header.imageCount = static_cast<uint32_t>(this->images.size());
+
+	this->align();
+	header.entriesOffset = this->offset;
+	uint32_t nameOffset = 0;
+	for (const WrittenEntry &entry : this->entries)
+	{
+		PackEntry packEntry;
+		packEntry.nameOffset = nameOffset;
+		packEntry.nameLength = static_cast<uint32_t>(entry.name.size());
+		packEntry.firstImage = static_cast<uint32_t>(entry.firstImage);
+		packEntry.imageCount = static_cast<uint32_t>(entry.imageCount);
+		this->stream.write(reinterpret_cast<const char*>(&packEntry), sizeof(packEntry));
+		this->offset += sizeof(packEntry);
+		nameOffset += packEntry.nameLength;
+	}
+
+	this->align();
+	header.imagesOffset = this->offset;
+	for (const WrittenImage &image : this->images)
+	{
+		PackImage packImage;
+		packImage.width = static_cast<uint32_t>(image.width);
+		packImage.height = static_cast<uint32_t>(image.height);
+		packImage.pixelsOffset = image.pixelsOffset;
+		packImage.paletteOffset = image.paletteOffset;
+		packImage.usesOwnPalette = image.usesOwnPalette ? 1 : 0;
+		packImage.padding = 0;
+		this->stream.write(reinterpret_cast<const char*>(&packImage), sizeof(packImage));
+		this->offset += sizeof(packImage);
+	}
+
+	header.namesOffset = this->offset;
+	header.namesSize = nameOffset;
+	for (const WrittenEntry &entry : this->entries)
+	{
+		this->stream.write(entry.name.data(), entry.name.size());
+	}
+
+	this->stream.seekp(0);
+	this->stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	const bool success = this->stream.good();
+	this->stream.close();
+	this->images.clear();
+	this->entries.clear();
+
+	if (!success)
+	{
+		DebugLogWarning("Could not write image pack \"" + this->tempFilename + "\".");
+		std::remove(this->tempFilename.c_str());
+		return false;
+	}
+
+	if (!File::replaceWithTemporary(this->tempFilename, this->filename))
+	{
+		DebugLogWarning("Could not replace \"" + this->filename + "\" with \"" +
+			this->tempFilename + "\".");
+		std::remove(this->tempFilename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+ImagePack::ImagePack()
+{
+	this->entries = nullptr;
+	this->images = nullptr;
+	this->names = nullptr;
+	this->entryCount = 0;
+}
+
+bool ImagePack::init(const std::string &filename, uint64_t srcHash)
+{
+	this->clear();
+
+	if (!this->file.init(filename.c_str()))
+	{
+		return false;
+	}
+
+	const uint8_t *data = this->file.getData();
+	const uint64_t size = this->file.getSize();
+
+	// Everything the lookups read has to be inside the file, so a truncated or damaged pack
+	// is baked again instead of read out of bounds.
+	auto isValid = [data, size, srcHash]()
+	{
+		PackHeader header;
+		if (size < sizeof(header))
+		{
+			return false;
+		}
+
+		std::memcpy(&header, data, sizeof(header));
+		if ((header.magic != PACK_MAGIC) || (header.version != ImagePack::VERSION) ||
+			(header.srcHash != srcHash))
+		{
+			return false;
+		}
+
+		const uint64_t entriesEnd = header.entriesOffset +
+			(static_cast<uint64_t>(header.entryCount) * sizeof(PackEntry));
+		const uint64_t imagesEnd = header.imagesOffset +
+			(static_cast<uint64_t>(header.imageCount) * sizeof(PackImage));
+		if ((entriesEnd > size) || (imagesEnd > size) ||
+			((header.namesOffset + header.namesSize) > size) ||
+			((header.entriesOffset % PACK_ALIGNMENT) != 0) ||
+			((header.imagesOffset % PACK_ALIGNMENT) != 0))
+		{
+			return false;
+		}
+
+		const uint8_t *entries = data + header.entriesOffset;
+		for (uint32_t i = 0; i < header.entryCount; i++)
+		{
+			const PackEntry &entry = getEntry(entries, i);
+			const uint64_t nameEnd = static_cast<uint64_t>(entry.nameOffset) + entry.nameLength;
+			const uint64_t imageEnd = static_cast<uint64_t>(entry.firstImage) + entry.imageCount;
+			if ((nameEnd > header.namesSize) || (imageEnd > header.imageCount))
+			{
+				return false;
+			}
+		}
+
+		const uint8_t *images = data + header.imagesOffset;
+		for (uint32_t i = 0; i < header.imageCount; i++)
+		{
+			const PackImage &image = getPackImage(images, i);
+			const uint64_t pixelCount = static_cast<uint64_t>(image.width) * image.height;
+			if (((image.pixelsOffset + pixelCount) > size) || ((image.paletteOffset != 0) &&
+				((image.paletteOffset + ImagePack::PALETTE_BYTES) > size)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	if (!isValid())
+	{
+		DebugLogWarning("Ignoring stale image pack \"" + filename + "\".");
+		this->file.clear();
+		return false;
+	}
+
+	PackHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	this->entries = data + header.entriesOffset;
+	this->images = data + header.imagesOffset;
+	this->names = reinterpret_cast<const char*>(data + header.namesOffset);
+	this->entryCount = static_cast<int>(header.entryCount);
+	return true;
+}
+
+bool ImagePack::isMapped() const
+{
+	return this->file.isMapped();
+}
+
+bool ImagePack::find(const std::string &name, int *outFirstImage, int *outImageCount) const
+{
+	if (!this->isMapped())
+	{
+		return false;
+	}
+
+	const std::string foldedName = String::toUppercase(name);
+	auto getEntryName = [this](int index)
+	{
+		const PackEntry &entry = getEntry(this->entries, index);
+		return std::string_view(this->names + entry.nameOffset, entry.nameLength);
+	};
+
+	int low = 0;
+	int high = this->entryCount;
+	while (low < high)
+	{
+		const int middle = low + ((high - low) / 2);
+		if (getEntryName(middle) < foldedName)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	if ((low == this->entryCount) || (getEntryName(low) != foldedName))
+	{
+		return false;
+	}
+
+	const PackEntry &entry = getEntry(this->entries, low);
+	*outFirstImage = static_cast<int>(entry.firstImage);
+	*outImageCount = static_cast<int>(entry.imageCount);
+	return true;
+}
+
+ImagePack::Image ImagePack::getImage(int index) const
+{
+	DebugAssert(this->isMapped());
+
+	const uint8_t *data = this->file.getData();
+	const PackImage &packImage = getPackImage(this->images, index);
+
+	Image image;
+	image.width = static_cast<int>(packImage.width);
+	image.height = static_cast<int>(packImage.height);
+	image.pixels = data + packImage.pixelsOffset;
+	image.paletteColors = (packImage.paletteOffset != 0) ? (data + packImage.paletteOffset) :
+		nullptr;
+	image.usesOwnPalette = packImage.usesOwnPalette != 0;
+	return image;
+}
+
+void ImagePack::clear()
+{
+	this->file.clear();
+	this->entries = nullptr;
+	this->images = nullptr;
+	this->names = nullptr;
+	this->entryCount = 0;
+}
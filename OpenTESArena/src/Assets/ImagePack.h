@@ -0,0 +1,98 @@
+#ifndef IMAGE_PACK_H
+#define IMAGE_PACK_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Utilities/MappedFile.h"
+
+// Decoded 8-bit images of GLOBAL.BSA entries, baked once into a file and memory-mapped on
+// later runs, so loading one of those images is a page-in instead of a decode. The file
+// stores the hash of the archive it was baked from, so another copy of the game bakes its own.
+
+// Pixels and palettes are stored uncompressed and aligned for reading straight from the
+// mapping. The file is in the machine's byte order since it's only read where it was written.
+
+class ImagePack
+{
+public:
+	// Bytes of a stored palette (256 RGBA colors).
+	static const int PALETTE_BYTES;
+
+	// One image of an entry. Pixels are palette indices, row by row.
+	struct Image
+	{
+		int width, height;
+		const uint8_t *pixels;
+		const uint8_t *paletteColors; // Built-in palette, or null if the image has none.
+		bool usesOwnPalette; // Ignores any requested palette.
+	};
+
+	// Writes a new pack one entry at a time.
+	class Writer
+	{
+	private:
+		struct WrittenImage
+		{
+			int width, height;
+			uint64_t pixelsOffset, paletteOffset;
+			bool usesOwnPalette;
+		};
+
+		struct WrittenEntry
+		{
+			std::string name;
+			int firstImage, imageCount;
+		};
+
+		std::ofstream stream;
+		std::string filename, tempFilename;
+		std::vector<WrittenImage> images;
+		std::vector<WrittenEntry> entries;
+		uint64_t offset;
+
+		// Pads the file to the pack's alignment.
+		void align();
+	public:
+		Writer();
+
+		// Starts writing to a temporary file next to the given one. Returns false if it
+		// can't be opened.
+		bool init(const std::string &filename);
+
+		// Adds an entry's images. Entries can be added in any order.
+		void add(const std::string &name, const std::vector<Image> &images);
+
+		// Writes the lookup tables and moves the temporary file over the pack. Returns
+		// whether the pack was written.
+		bool finish(uint64_t srcHash);
+	};
+private:
+	// Incremented whenever the file layout or any image decoding changes.
+	static const uint32_t VERSION;
+
+	MappedFile file;
+	const uint8_t *entries; // Sorted by name.
+	const uint8_t *images;
+	const char *names;
+	int entryCount;
+public:
+	ImagePack();
+
+	// Maps a pack if it was baked from an archive with the given hash and looks intact.
+	bool init(const std::string &filename, uint64_t srcHash);
+
+	bool isMapped() const;
+
+	// Gets the images of an entry, ignoring case. Returns false if it isn't in the pack.
+	bool find(const std::string &name, int *outFirstImage, int *outImageCount) const;
+
+	// Gets an image found with find(). Its pointers are valid while the pack is mapped.
+	Image getImage(int index) const;
+
+	void clear();
+};
+
+#endif
@@ -30,19 +30,53 @@ namespace
 	const std::unordered_map<std::string, int(*)(MIFFile::Level&, const uint8_t*)> MIFLevelTags =
 	{
 		{ Tag_FLAT, MIFFile::Level::loadFLAT },
-		{ Tag_FLOR, MIFFile::Level::loadFLOR },
 		{ Tag_INFO, MIFFile::Level::loadINFO },
 		{ Tag_INNS, MIFFile::Level::loadINNS },
 		{ Tag_LOCK, MIFFile::Level::loadLOCK },
 		{ Tag_LOOT, MIFFile::Level::loadLOOT },
-		{ Tag_MAP1, MIFFile::Level::loadMAP1 },
-		{ Tag_MAP2, MIFFile::Level::loadMAP2 },
 		{ Tag_NAME, MIFFile::Level::loadNAME },
 		{ Tag_NUMF, MIFFile::Level::loadNUMF },
 		{ Tag_STOR, MIFFile::Level::loadSTOR },
 		{ Tag_TARG, MIFFile::Level::loadTARG },
 		{ Tag_TRIG, MIFFile::Level::loadTRIG }
 	};
+
+	// Mappings of .MIF voxel tags to the level views they're decompressed for.
+	const std::unordered_map<std::string, BufferView<const uint16_t> MIFFile::Level::*> MIFVoxelTags =
+	{
+		{ Tag_FLOR, &MIFFile::Level::flor },
+		{ Tag_MAP1, &MIFFile::Level::map1 },
+		{ Tag_MAP2, &MIFFile::Level::map2 }
+	};
+
+	// Gets how many voxel IDs all the FLOR, MAP1, and MAP2 tags in the .MIF decompress to.
+	// Every tag's size is at the same place, so the levels can be walked without decoding.
+	size_t getVoxelCount(const uint8_t *srcPtr, size_t srcSize, int levelOffset)
+	{
+		size_t count = 0;
+		while (levelOffset < srcSize)
+		{
+			const uint8_t *levelStart = srcPtr + levelOffset;
+			const uint16_t levelSize = Bytes::getLE16(levelStart + 4);
+			const uint8_t *tagStart = levelStart + 6;
+			const uint8_t *levelEnd = tagStart + levelSize;
+			while (tagStart < levelEnd)
+			{
+				const std::string tag(tagStart, tagStart + 4);
+				if (MIFVoxelTags.find(tag) != MIFVoxelTags.end())
+				{
+					count += Bytes::getLE16(tagStart + 6) / 2;
+				}
+
+				tagStart += Bytes::getLE16(tagStart + 4) + 6;
+			}
+
+			// Same as Level::load(), go by the last tag instead of the level size.
+			levelOffset += static_cast<int>(std::distance(levelStart, tagStart));
+		}
+
+		return count;
+	}
 }
 
 MIFFile::Level::Level()
@@ -56,15 +90,15 @@ const uint8_t MIFFile::LAVA_CHASM = 0xE;
 
 bool MIFFile::init(const char *filename)
 {
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	VFS::FileView src;
+	if (!VFS::Manager::get().read(filename, &src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.data());
+	const size_t srcSize = src.size();
 	const uint16_t headerSize = Bytes::getLE16(srcPtr + 4);
 
 	// Get data from the header (after "MHDR"). Constant for all levels. The header 
@@ -95,6 +129,11 @@ bool MIFFile::init(const char *filename)
 	// so this needs to be in a loop.
 	int levelOffset = headerSize + 6;
 
+	// All the levels' voxels are decompressed into one allocation.
+	const size_t voxelCount = getVoxelCount(srcPtr, srcSize, levelOffset);
+	this->voxels = std::make_unique<uint16_t[]>(voxelCount);
+	uint16_t *voxelDst = this->voxels.get();
+
 	// The level count is unused since it's inferred by this level loading loop.
 	while (levelOffset < srcSize)
 	{
@@ -103,12 +142,14 @@ bool MIFFile::init(const char *filename)
 		// Begin loading the level data at the current LEVL, and get the offset
 		// to the next LEVL.
 		const uint8_t *levelStart = srcPtr + levelOffset;
-		levelOffset += level.load(levelStart);
+		levelOffset += level.load(levelStart, voxelDst);
 
 		// Add to list of levels.
 		this->levels.push_back(std::move(level));
 	}
 
+	DebugAssert(voxelDst == (this->voxels.get() + voxelCount));
+
 	this->width = mifHeader.mapWidth;
 	this->depth = mifHeader.mapHeight;
 	this->startingLevelIndex = mifHeader.startingLevelIndex;
@@ -159,7 +200,7 @@ const std::vector<MIFFile::Level> &MIFFile::getLevels() const
 	return this->levels;
 }
 
-int MIFFile::Level::load(const uint8_t *levelStart)
+int MIFFile::Level::load(const uint8_t *levelStart, uint16_t *&voxelDst)
 {
 	// Get the size of the level data.
 	const uint16_t levelSize = Bytes::getLE16(levelStart + 4);
@@ -173,8 +214,14 @@ int MIFFile::Level::load(const uint8_t *levelStart)
 		const std::string tag(tagStart, tagStart + 4);
 
 		// Find the function associated with the tag.
+		const auto voxelTagIter = MIFVoxelTags.find(tag);
 		const auto tagIter = MIFLevelTags.find(tag);
-		if (tagIter != MIFLevelTags.end())
+		if (voxelTagIter != MIFVoxelTags.end())
+		{
+			BufferView<const uint16_t> &voxels = this->*(voxelTagIter->second);
+			tagStart += MIFFile::Level::loadVoxels(voxels, tagStart, voxelDst);
+		}
+		else if (tagIter != MIFLevelTags.end())
 		{
 			// Load the data and move the offset to the beginning of the next tag.
 			auto *loadingFn = tagIter->second;
@@ -197,7 +244,7 @@ int MIFFile::Level::load(const uint8_t *levelStart)
 int MIFFile::Level::getHeight() const
 {
 	// If there is MAP2 data, then check through each voxel to find the highest point.
-	if (this->map2.size() > 0)
+	if (this->map2.getCount() > 0)
 	{
 		// @todo: look at MAP2 voxels and determine highest column.
 		return 6;
@@ -221,28 +268,6 @@ int MIFFile::Level::loadFLAT(MIFFile::Level &level, const uint8_t *tagStart)
 	return size + 6;
 }
 
-int MIFFile::Level::loadFLOR(MIFFile::Level &level, const uint8_t *tagStart)
-{
-	// Compressed size is in chunks and contains a 2 byte decompressed length after it, which
-	// should not be included when determining the end of the compressed range.
-	const uint16_t compressedSize = Bytes::getLE16(tagStart + 4);
-	const uint16_t uncompressedSize = Bytes::getLE16(tagStart + 6);
-
-	// Allocate space for this floor, using 2 bytes per voxel.
-	std::vector<uint8_t> decomp(uncompressedSize, 0);
-
-	// Decode the data with type 8 decompression.
-	const uint8_t *tagDataStart = tagStart + 8;
-	const uint8_t *tagDataEnd = tagStart + 6 + compressedSize;
-	Compression::decodeType08(tagDataStart, tagDataEnd, decomp);
-
-	// Write into 16-bit vector (in little-endian).
-	level.flor.resize(decomp.size() / 2);
-	std::copy(decomp.begin(), decomp.end(), reinterpret_cast<uint8_t*>(level.flor.data()));
-
-	return compressedSize + 6;
-}
-
 int MIFFile::Level::loadINFO(MIFFile::Level &level, const uint8_t *tagStart)
 {
 	const uint16_t size = Bytes::getLE16(tagStart + 4);
@@ -299,46 +324,6 @@ int MIFFile::Level::loadLOOT(MIFFile::Level &level, const uint8_t *tagStart)
 	return size + 6;
 }
 
-int MIFFile::Level::loadMAP1(MIFFile::Level &level, const uint8_t *tagStart)
-{
-	const uint16_t compressedSize = Bytes::getLE16(tagStart + 4);
-	const uint16_t uncompressedSize = Bytes::getLE16(tagStart + 6);
-
-	// Allocate space for this floor, using 2 bytes per voxel.
-	std::vector<uint8_t> decomp(uncompressedSize, 0);
-
-	// Decode the data with type 8 decompression.
-	const uint8_t *tagDataStart = tagStart + 8;
-	const uint8_t *tagDataEnd = tagStart + 6 + compressedSize;
-	Compression::decodeType08(tagDataStart, tagDataEnd, decomp);
-
-	// Write into 16-bit vector (in little-endian).
-	level.map1.resize(decomp.size() / 2);
-	std::copy(decomp.begin(), decomp.end(), reinterpret_cast<uint8_t*>(level.map1.data()));
-
-	return compressedSize + 6;
-}
-
-int MIFFile::Level::loadMAP2(MIFFile::Level &level, const uint8_t *tagStart)
-{
-	const uint16_t compressedSize = Bytes::getLE16(tagStart + 4);
-	const uint16_t uncompressedSize = Bytes::getLE16(tagStart + 6);
-
-	// Allocate space for this floor, using 2 bytes per voxel.
-	std::vector<uint8_t> decomp(uncompressedSize, 0);
-
-	// Decode the data with type 8 decompression.
-	const uint8_t *tagDataStart = tagStart + 8;
-	const uint8_t *tagDataEnd = tagStart + 6 + compressedSize;
-	Compression::decodeType08(tagDataStart, tagDataEnd, decomp);
-
-	// Write into 16-bit vector (in little-endian).
-	level.map2.resize(decomp.size() / 2);
-	std::copy(decomp.begin(), decomp.end(), reinterpret_cast<uint8_t*>(level.map2.data()));
-
-	return compressedSize + 6;
-}
-
 int MIFFile::Level::loadNAME(MIFFile::Level &level, const uint8_t *tagStart)
 {
 	const uint16_t size = Bytes::getLE16(tagStart + 4);
@@ -414,3 +399,24 @@ int MIFFile::Level::loadTRIG(MIFFile::Level &level, const uint8_t *tagStart)
 
 	return size + 6;
 }
+
+int MIFFile::Level::loadVoxels(BufferView<const uint16_t> &voxels, const uint8_t *tagStart,
+	uint16_t *&voxelDst)
+{
+	// Compressed size is in chunks and contains a 2 byte decompressed length after it, which
+	// should not be included when determining the end of the compressed range.
+	const uint16_t compressedSize = Bytes::getLE16(tagStart + 4);
+	const uint16_t uncompressedSize = Bytes::getLE16(tagStart + 6);
+
+	// Decode the data with type 8 decompression, using 2 bytes per voxel (in little-endian).
+	const uint8_t *tagDataStart = tagStart + 8;
+	const uint8_t *tagDataEnd = tagStart + 6 + compressedSize;
+	const int voxelCount = uncompressedSize / 2;
+	Compression::decodeType08(tagDataStart, tagDataEnd,
+		reinterpret_cast<uint8_t*>(voxelDst), voxelCount * 2);
+
+	voxels = BufferView<const uint16_t>(voxelDst, voxelCount);
+	voxelDst += voxelCount;
+
+	return compressedSize + 6;
+}
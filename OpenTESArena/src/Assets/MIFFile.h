@@ -3,11 +3,13 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "ArenaTypes.h"
 #include "../Math/Vector2.h"
+#include "../Utilities/BufferView.h"
 
 // A MIF file contains map information. It defines the dimensions of a particular area 
 // and which voxels have which IDs, as well as some other data. It is normally paired with 
@@ -24,8 +26,10 @@ public:
 		int numf; // Number of floor textures.
 
 		// Various data, not always present. FLOR and MAP1 are probably always present.
+		// The voxel tags are decompressed into the .MIF's voxel buffer, so these views are
+		// only valid while the MIFFile they came from is.
 		// - @todo: maybe store MAP2 data with each voxel's extended height?
-		std::vector<uint16_t> flor, map1, map2;
+		BufferView<const uint16_t> flor, map1, map2;
 		std::vector<uint8_t> flat, inns, loot, stor;
 		std::vector<ArenaTypes::MIFTarget> targ;
 		std::vector<ArenaTypes::MIFLock> lock;
@@ -34,9 +38,10 @@ public:
 		Level();
 
 		// Primary method for decoding .MIF level tag data. This method calls all the lower-
-		// level loading methods for each tag as needed. The return value is the offset from 
+		// level loading methods for each tag as needed. Voxel tags are decompressed to the
+		// given pointer, which is advanced past them. The return value is the offset from 
 		// the current LEVL tag to where the next LEVL tag would be.
-		int load(const uint8_t *levelStart);
+		int load(const uint8_t *levelStart, uint16_t *&voxelDst);
 
 		// Gets the height of the level in voxels. This value depends on extended blocks
 		// in the MAP2 data, otherwise it drops back to a default value.
@@ -45,20 +50,25 @@ public:
 		// Loading methods for each .MIF level tag (FLOR, MAP1, etc.), called by Level::load(). 
 		// The return value is the offset from the current tag to where the next tag would be.
 		static int loadFLAT(MIFFile::Level &level, const uint8_t *tagStart);
-		static int loadFLOR(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadINFO(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadINNS(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadLOCK(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadLOOT(MIFFile::Level &level, const uint8_t *tagStart);
-		static int loadMAP1(MIFFile::Level &level, const uint8_t *tagStart);
-		static int loadMAP2(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadNAME(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadNUMF(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadSTOR(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadTARG(MIFFile::Level &level, const uint8_t *tagStart);
 		static int loadTRIG(MIFFile::Level &level, const uint8_t *tagStart);
+
+		// Decompresses a FLOR, MAP1, or MAP2 tag to the given pointer and advances it.
+		static int loadVoxels(BufferView<const uint16_t> &voxels, const uint8_t *tagStart,
+			uint16_t *&voxelDst);
 	};
 private:
+	// Decompressed FLOR, MAP1, and MAP2 data of every level, sized up front so the
+	// levels' views into it stay valid.
+	std::unique_ptr<uint16_t[]> voxels;
+
 	int width, depth;
 	int startingLevelIndex;
 	std::array<Double2, 4> startPoints; // Entrance locations for the level (not always full).
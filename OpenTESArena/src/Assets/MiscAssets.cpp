@@ -1,5 +1,8 @@
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <numeric>
 #include <sstream>
 
@@ -10,8 +13,11 @@
 #include "../Math/Random.h"
 #include "../Utilities/Bytes.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/MemoryReport.h"
 #include "../Utilities/Platform.h"
 #include "../Utilities/String.h"
+#include "../Utilities/StringView.h"
 #include "../World/ClimateType.h"
 #include "../World/Location.h"
 #include "../World/LocationType.h"
@@ -20,6 +26,13 @@
 
 namespace
 {
+	// Dimensions of the world map in pixels, for the world map mask lookup.
+	const int WorldMapWidth = 320;
+	const int WorldMapHeight = 200;
+
+	// Value in the world map mask lookup for pixels without a mask.
+	const uint8_t NoWorldMapMask = 0xFF;
+
 	// Discriminated union for name composition rules used with NAMECHNK.DAT.
 	// Each rule is either:
 	// - Index
@@ -286,6 +299,25 @@ const MiscAssets::TemplateDat::Entry &MiscAssets::TemplateDat::getTilesetEntry(
 	return *iter;
 }
 
+size_t MiscAssets::TemplateDat::getByteCount() const
+{
+	size_t byteCount = MemoryReport::getVectorBytes(this->entryLists);
+	for (const std::vector<Entry> &entryList : this->entryLists)
+	{
+		byteCount += MemoryReport::getVectorBytes(entryList);
+		for (const Entry &entry : entryList)
+		{
+			byteCount += MemoryReport::getVectorBytes(entry.values);
+			for (const std::string &value : entry.values)
+			{
+				byteCount += MemoryReport::getStringBytes(value);
+			}
+		}
+	}
+
+	return byteCount;
+}
+
 bool MiscAssets::TemplateDat::init()
 {
 	const char *filename = "TEMPLATE.DAT";
@@ -354,7 +386,10 @@ bool MiscAssets::TemplateDat::init()
 		}
 	};
 
-	auto flushState = [this, &value, &key, &letter]()
+	// Reused between entries so splitting values doesn't allocate each time.
+	std::vector<std::string_view> valueTokens;
+
+	auto flushState = [this, &value, &key, &letter, &valueTokens]()
 	{
 		// If no entries yet, create a new vector.
 		if (this->entryLists.size() == 0)
@@ -416,17 +451,17 @@ bool MiscAssets::TemplateDat::init()
 			return str;
 		}();
 
-		// Trim front and back.
-		String::trimFrontInPlace(trimmedValue);
-		String::trimBackInPlace(trimmedValue);
+		StringView::split(StringView::trimEnds(trimmedValue), '&', valueTokens);
 
+		// Leave out the unused text after the last ampersand.
 		Entry entry;
 		entry.key = key;
 		entry.letter = letter;
-		entry.values = String::split(trimmedValue, '&');
-
-		// Remove unused text after the last ampersand.
-		entry.values.pop_back();
+		entry.values.reserve(valueTokens.size() - 1);
+		for (size_t i = 0; (i + 1) < valueTokens.size(); i++)
+		{
+			entry.values.emplace_back(valueTokens[i]);
+		}
 
 		// Add entry to the entry list.
 		this->entryLists.at(index).push_back(std::move(entry));
@@ -632,48 +667,116 @@ bool MiscAssets::init(bool floppyVersion)
 {
 	DebugLog("Initializing.");
 
-	// Load the executable data.
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	auto getSecondsSince = [](const std::chrono::high_resolution_clock::time_point &time)
+	{
+		const auto now = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double>(now - time).count();
+	};
+
+	// Tables that are only needed deep into a session are loaded the first time they're
+	// asked for.
+	this->dungeonTxtInit.init("DUNGEON.TXT", [this]() { return this->initDungeonTxt(); });
+	this->artifactTextInit.init("ARTFACT1.DAT and ARTFACT2.DAT",
+		[this]() { return this->initArtifactText(); });
+	this->tradeTextInit.init("trade text", [this]() { return this->initTradeText(); });
+	this->nameChunksInit.init("NAMECHNK.DAT", [this]() { return this->initNameChunks(); });
+	this->standardSpellsInit.init("SPELLSG.65", [this]() { return this->initStandardSpells(); });
+	this->spellMakerDescriptionsInit.init("SPELLMKR.TXT",
+		[this]() { return this->initSpellMakerDescriptions(); });
+	this->wildernessChunksInit.init("wilderness chunks",
+		[this]() { return this->initWildernessChunks(); });
+
+	// Load the executable data first since class data also comes from it.
 	bool success = this->initExecutableData(floppyVersion);
+	const double exeSeconds = getSecondsSince(startTime);
 
-	// Read in TEMPLATE.DAT, using "#..." as keys and the text as values.
-	success &= this->templateDat.init();
+	// Each of the rest only reads its own files into its own members (and reads the
+	// executable data), so they all run at once.
+	struct InitTask
+	{
+		const char *name;
+		std::function<bool()> function;
+		std::future<bool> result;
+		double seconds;
 
-	// Read in QUESTION.TXT and create character question objects.
-	success &= this->initQuestionTxt();
+		InitTask(const char *name, std::function<bool()> &&function)
+			: name(name), function(std::move(function))
+		{
+			this->seconds = 0.0;
+		}
+	};
 
-	// Read in CLASSES.DAT.
-	success &= this->initClasses(this->getExeData());
+	InitTask tasks[] =
+	{
+		// Read in TEMPLATE.DAT, using "#..." as keys and the text as values.
+		{ "TEMPLATE.DAT", [this]() { return this->templateDat.init(); } },
 
-	// Read in DUNGEON.TXT and pair each dungeon name with its description.
-	success &= this->initDungeonTxt();
+		// Read in QUESTION.TXT and create character question objects.
+		{ "QUESTION.TXT", [this]() { return this->initQuestionTxt(); } },
 
-	// Read in ARTFACT1.DAT and ARTFACT2.DAT.
-	success &= this->initArtifactText();
+		// Read in CLASSES.DAT.
+		{ "CLASSES.DAT", [this]() { return this->initClasses(this->getExeData()); } },
 
-	// Read in EQUIP.DAT, MUGUILD.DAT, SELLING.DAT, and TAVERN.DAT.
-	success &= this->initTradeText();
+		// Read city data file and index its location names for searching.
+		{ "CITYDATA.65", [this]()
+		{
+			if (!this->cityDataFile.init("CITYDATA.65"))
+			{
+				return false;
+			}
 
-	// Read in NAMECHNK.DAT.
-	success &= this->initNameChunks();
+			this->locationSearchIndex.init(this->cityDataFile);
+			return true;
+		} },
 
-	// Read in SPELLSG.65.
-	success &= this->initStandardSpells();
+		// Read in the world map mask data from TAMRIEL.MNU.
+		{ "TAMRIEL.MNU", [this]() { return this->initWorldMapMasks(); } },
 
-	// Read in SPELLMKR.TXT.
-	success &= this->initSpellMakerDescriptions();
+		// Read in the terrain map from TERRAIN.IMG.
+		{ "TERRAIN.IMG", [this]() { return this->worldMapTerrain.init("TERRAIN.IMG"); } }
+	};
 
-	// Read city data file.
-	success &= this->cityDataFile.init("CITYDATA.65");
+	for (InitTask &task : tasks)
+	{
+		task.result = JobSystem::submit(JobSystem::Priority::Streaming,
+			[&task, &getSecondsSince]()
+		{
+			const auto taskStartTime = std::chrono::high_resolution_clock::now();
+			const bool taskSuccess = task.function();
+			task.seconds = getSecondsSince(taskStartTime);
+			return taskSuccess;
+		});
+	}
 
-	// Read in the world map mask data from TAMRIEL.MNU.
-	success &= this->initWorldMapMasks();
+	// Wait for all of them even if one fails, like when they ran one after another.
+	for (InitTask &task : tasks)
+	{
+		success &= task.result.get();
+	}
 
-	// Read in the wilderness chunks to have them cached when exploring wilderness.
-	success &= this->initWildernessChunks();
+	std::string timingsText = "Initialized in " +
+		String::fixedPrecision(getSecondsSince(startTime) * 1000.0, 1) + "ms (.EXE data " +
+		String::fixedPrecision(exeSeconds * 1000.0, 1) + "ms";
+	for (const InitTask &task : tasks)
+	{
+		timingsText += ", " + std::string(task.name) + ' ' +
+			String::fixedPrecision(task.seconds * 1000.0, 1) + "ms";
+	}
 
-	// Read in the terrain map from TERRAIN.IMG.
-	success &= this->worldMapTerrain.init("TERRAIN.IMG");
+	DebugLog(timingsText + ").");
+	return success;
+}
 
+bool MiscAssets::loadLazyData() const
+{
+	bool success = this->dungeonTxtInit.get();
+	success &= this->artifactTextInit.get();
+	success &= this->tradeTextInit.get();
+	success &= this->nameChunksInit.get();
+	success &= this->standardSpellsInit.get();
+	success &= this->spellMakerDescriptionsInit.get();
+	success &= this->wildernessChunksInit.get();
 	return success;
 }
 
@@ -861,17 +964,17 @@ bool MiscAssets::initClasses(const ExeData &exeData)
 
 	// Now read in the character class data from A.EXE. Some of it also depends on
 	// data from CLASSES.DAT.
-	const auto &classNameStrs = exeData.charClasses.classNames;
-	const auto &allowedArmorsValues = exeData.charClasses.allowedArmors;
-	const auto &allowedShieldsLists = exeData.charClasses.allowedShieldsLists;
-	const auto &allowedShieldsIndices = exeData.charClasses.allowedShieldsIndices;
-	const auto &allowedWeaponsLists = exeData.charClasses.allowedWeaponsLists;
-	const auto &allowedWeaponsIndices = exeData.charClasses.allowedWeaponsIndices;
-	const auto &preferredAttributesStrs = exeData.charClasses.preferredAttributes;
-	const auto &classNumbersToIDsValues = exeData.charClasses.classNumbersToIDs;
-	const auto &initialExpCapValues = exeData.charClasses.initialExperienceCaps;
-	const auto &healthDiceValues = exeData.charClasses.healthDice;
-	const auto &lockpickingDivisorValues = exeData.charClasses.lockpickingDivisors;
+	const auto &classNameStrs = exeData.getCharacterClasses().classNames;
+	const auto &allowedArmorsValues = exeData.getCharacterClasses().allowedArmors;
+	const auto &allowedShieldsLists = exeData.getCharacterClasses().allowedShieldsLists;
+	const auto &allowedShieldsIndices = exeData.getCharacterClasses().allowedShieldsIndices;
+	const auto &allowedWeaponsLists = exeData.getCharacterClasses().allowedWeaponsLists;
+	const auto &allowedWeaponsIndices = exeData.getCharacterClasses().allowedWeaponsIndices;
+	const auto &preferredAttributesStrs = exeData.getCharacterClasses().preferredAttributes;
+	const auto &classNumbersToIDsValues = exeData.getCharacterClasses().classNumbersToIDs;
+	const auto &initialExpCapValues = exeData.getCharacterClasses().initialExperienceCaps;
+	const auto &healthDiceValues = exeData.getCharacterClasses().healthDice;
+	const auto &lockpickingDivisorValues = exeData.getCharacterClasses().lockpickingDivisors;
 
 	const int classCount = 18;
 	for (int i = 0; i < classCount; i++)
@@ -1372,6 +1475,27 @@ bool MiscAssets::initWorldMapMasks()
 		offset += byteCount;
 	}
 
+	// Resolve every pixel to its mask ahead of time so a hit test is one lookup. Masks
+	// overlap in places, and the lowest mask ID wins like when they were checked in order.
+	this->worldMapMaskIDs.assign(WorldMapWidth * WorldMapHeight, NoWorldMapMask);
+	for (int i = static_cast<int>(this->worldMapMasks.size()) - 1; i >= 0; i--)
+	{
+		const WorldMapMask &mask = this->worldMapMasks[i];
+		const Rect &rect = mask.getRect();
+		const int xEnd = std::min(rect.getRight(), WorldMapWidth);
+		const int yEnd = std::min(rect.getBottom(), WorldMapHeight);
+		for (int y = rect.getTop(); y < yEnd; y++)
+		{
+			for (int x = rect.getLeft(); x < xEnd; x++)
+			{
+				if (mask.get(x, y))
+				{
+					this->worldMapMaskIDs[x + (y * WorldMapWidth)] = static_cast<uint8_t>(i);
+				}
+			}
+		}
+	}
+
 	return true;
 }
 
@@ -1402,21 +1526,25 @@ const std::vector<CharacterClass> &MiscAssets::getClassDefinitions() const
 
 const std::vector<std::pair<std::string, std::string>> &MiscAssets::getDungeonTxtDungeons() const
 {
+	this->dungeonTxtInit.get();
 	return this->dungeonTxt;
 }
 
 const std::array<MiscAssets::ArtifactTavernText, 16> &MiscAssets::getArtifactTavernText1() const
 {
+	this->artifactTextInit.get();
 	return this->artifactTavernText1;
 }
 
 const std::array<MiscAssets::ArtifactTavernText, 16> &MiscAssets::getArtifactTavernText2() const
 {
+	this->artifactTextInit.get();
 	return this->artifactTavernText2;
 }
 
 const MiscAssets::TradeText &MiscAssets::getTradeText() const
 {
+	this->tradeTextInit.get();
 	return this->tradeText;
 }
 
@@ -1446,11 +1574,13 @@ const std::string &MiscAssets::getRulerTitle(int provinceID, LocationType locati
 		}
 	}();
 
-	return this->exeData.locations.rulerTitles.at(titleIndex);
+	return this->exeData.getLocations().rulerTitles.at(titleIndex);
 }
 
 std::string MiscAssets::generateNpcName(int raceID, bool isMale, ArenaRandom &random) const
 {
+	this->nameChunksInit.get();
+
 	// Get the rules associated with the race and gender.
 	const auto &chunkRules = NameRules.at((raceID * 2) + (isMale ? 0 : 1));
 
@@ -1499,22 +1629,83 @@ const CityDataFile &MiscAssets::getCityDataFile() const
 	return this->cityDataFile;
 }
 
+const LocationSearchIndex &MiscAssets::getLocationSearchIndex() const
+{
+	return this->locationSearchIndex;
+}
+
 const ArenaTypes::Spellsg &MiscAssets::getStandardSpells() const
 {
+	this->standardSpellsInit.get();
 	return this->standardSpells;
 }
 
 const std::array<std::string, 43> &MiscAssets::getSpellMakerDescriptions() const
 {
+	this->spellMakerDescriptionsInit.get();
 	return this->spellMakerDescriptions;
 }
 
+const std::vector<RMDFile> &MiscAssets::getWildernessChunks() const
+{
+	this->wildernessChunksInit.get();
+	return this->wildernessChunks;
+}
+
 const std::array<WorldMapMask, 10> &MiscAssets::getWorldMapMasks() const
 {
 	return this->worldMapMasks;
 }
 
+int MiscAssets::getWorldMapMaskID(const Int2 &point) const
+{
+	if ((point.x < 0) || (point.x >= WorldMapWidth) || (point.y < 0) ||
+		(point.y >= WorldMapHeight))
+	{
+		return -1;
+	}
+
+	const uint8_t maskID = this->worldMapMaskIDs[point.x + (point.y * WorldMapWidth)];
+	return (maskID != NoWorldMapMask) ? static_cast<int>(maskID) : -1;
+}
+
 const MiscAssets::WorldMapTerrain &MiscAssets::getWorldMapTerrain() const
 {
 	return this->worldMapTerrain;
 }
+
+void MiscAssets::reportMemory(MemoryReport &report) const
+{
+	report.add("Assets/Template text", this->templateDat.getByteCount());
+
+	if (this->nameChunksInit.isDone())
+	{
+		size_t byteCount = MemoryReport::getVectorBytes(this->nameChunks);
+		for (const std::vector<std::string> &chunks : this->nameChunks)
+		{
+			byteCount += MemoryReport::getVectorBytes(chunks);
+			for (const std::string &chunk : chunks)
+			{
+				byteCount += MemoryReport::getStringBytes(chunk);
+			}
+		}
+
+		report.add("Assets/Name chunks", byteCount);
+	}
+
+	if (this->wildernessChunksInit.isDone())
+	{
+		size_t byteCount = MemoryReport::getVectorBytes(this->wildernessChunks);
+		for (const RMDFile &rmd : this->wildernessChunks)
+		{
+			byteCount += MemoryReport::getVectorBytes(rmd.getFLOR()) +
+				MemoryReport::getVectorBytes(rmd.getMAP1()) +
+				MemoryReport::getVectorBytes(rmd.getMAP2());
+		}
+
+		report.add("Assets/Wilderness chunks", byteCount);
+	}
+
+	report.add("Assets/World map", MemoryReport::getVectorBytes(this->worldMapMaskIDs) +
+		sizeof(this->worldMapTerrain));
+}
@@ -14,13 +14,17 @@
 #include "../Entities/CharacterClass.h"
 #include "../Game/CharacterClassGeneration.h"
 #include "../Game/CharacterQuestion.h"
+#include "../Utilities/LazyInit.h"
+#include "../World/LocationSearchIndex.h"
 
 // This class stores various miscellaneous data from Arena assets.
 
 // All relevant text files (TEMPLATE.DAT, QUESTION.TXT, etc.) should be read in 
-// when this object is created.
+// when this object is created, except for ones that are rarely needed (artifact and trade
+// text, name chunks, spells, etc.), which are read the first time their getter is called.
 
 class ArenaRandom;
+class MemoryReport;
 
 enum class ClimateType;
 enum class LocationType;
@@ -68,6 +72,9 @@ public:
 		const Entry &getEntry(int key, char letter) const;
 		const Entry &getTilesetEntry(int tileset, int key, char letter) const;
 
+		// Gets the heap bytes held by the entries and their strings.
+		size_t getByteCount() const;
+
 		bool init();
 	};
 
@@ -127,12 +134,18 @@ private:
 	TradeText tradeText;
 	std::vector<std::vector<std::string>> nameChunks;
 	CityDataFile cityDataFile;
+	LocationSearchIndex locationSearchIndex;
 	ArenaTypes::Spellsg standardSpells; // From SPELLSG.65.
 	std::array<std::string, 43> spellMakerDescriptions; // From SPELLMKR.TXT.
 	std::vector<RMDFile> wildernessChunks; // WILD001 to WILD070.
 	std::array<WorldMapMask, 10> worldMapMasks;
+	std::vector<uint8_t> worldMapMaskIDs; // Mask ID at each world map pixel.
 	WorldMapTerrain worldMapTerrain;
 
+	// Loaders for the tables that aren't read until they're needed.
+	LazyInit dungeonTxtInit, artifactTextInit, tradeTextInit, nameChunksInit,
+		standardSpellsInit, spellMakerDescriptionsInit, wildernessChunksInit;
+
 	// Loads the executable associated with the current Arena data path (either A.EXE
 	// for the floppy version or ACD.EXE for the CD version).
 	bool initExecutableData(bool floppyVersion);
@@ -203,20 +216,40 @@ public:
 	// Gets the data object for world map locations.
 	const CityDataFile &getCityDataFile() const;
 
+	// Gets the lookup tables for searching location names on province maps.
+	const LocationSearchIndex &getLocationSearchIndex() const;
+
 	// Gets the spells list for spell and effect definitions.
 	const ArenaTypes::Spellsg &getStandardSpells() const;
 
 	// Gets the list of spell maker description strings.
 	const std::array<std::string, 43> &getSpellMakerDescriptions() const;
 
+	// Gets the wilderness chunk definitions (WILD001.RMD to WILD070.RMD).
+	const std::vector<RMDFile> &getWildernessChunks() const;
+
 	// Gets the mask rectangles used for registering clicks on the world map. There are
 	// ten entries -- the first nine are provinces and the last is the "Exit" button.
 	const std::array<WorldMapMask, 10> &getWorldMapMasks() const;
 
+	// Gets the ID of the world map mask set at the given point in 320x200 space, or -1 if
+	// there isn't one. Where masks overlap, the lowest ID is returned.
+	int getWorldMapMaskID(const Int2 &point) const;
+
 	// Gets the world map terrain used with climate and travel calculations.
 	const WorldMapTerrain &getWorldMapTerrain() const;
 
+	// Adds the bytes of the larger tables to the report. Tables that are read when first
+	// needed are only counted once they've been read.
+	void reportMemory(MemoryReport &report) const;
+
+	// Loads the executable data, then everything else that isn't loaded on demand at once
+	// on worker threads, and logs how long each part took.
 	bool init(bool floppyVersion);
+
+	// Loads every table that's otherwise loaded on demand (i.e., for benchmarking a full
+	// load). Returns whether they all loaded.
+	bool loadLazyData() const;
 };
 
 #endif
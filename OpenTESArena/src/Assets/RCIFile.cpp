@@ -1,4 +1,3 @@
-#include <algorithm>
 #include <string>
 
 #include "RCIFile.h"
@@ -12,39 +11,27 @@ const int RCIFile::FRAME_SIZE = RCIFile::WIDTH * RCIFile::HEIGHT;
 
 bool RCIFile::init(const char *filename)
 {
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	if (!VFS::Manager::get().read(filename, &this->src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
-
 	// Number of uncompressed frames packed in the .RCI.
-	const int frameCount = static_cast<int>(srcSize) / RCIFile::FRAME_SIZE;
-
-	// Create an image for each uncompressed frame using the given palette.
-	for (int i = 0; i < frameCount; i++)
-	{
-		this->pixels.push_back(std::make_unique<uint8_t[]>(RCIFile::FRAME_SIZE));
-
-		const uint8_t *srcPixels = srcPtr + (RCIFile::FRAME_SIZE * i);
-		uint8_t *dstPixels = this->pixels.back().get();
-		std::copy(srcPixels, srcPixels + RCIFile::FRAME_SIZE, dstPixels);
-	}
-
+	this->frameCount = static_cast<int>(this->src.size()) / RCIFile::FRAME_SIZE;
 	return true;
 }
 
 int RCIFile::getImageCount() const
 {
-	return static_cast<int>(this->pixels.size());
+	return this->frameCount;
 }
 
 const uint8_t *RCIFile::getPixels(int index) const
 {
-	DebugAssertIndex(this->pixels, index);
-	return this->pixels[index].get();
+	DebugAssert(index >= 0);
+	DebugAssert(index < this->frameCount);
+
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(this->src.data());
+	return srcPtr + (RCIFile::FRAME_SIZE * index);
 }
@@ -2,17 +2,20 @@
 #define RCI_FILE_H
 
 #include <cstdint>
-#include <memory>
-#include <vector>
+
+#include "components/vfs/manager.hpp"
 
 // An RCI file is for screen-space animations like water and lava. It is packed 
 // with five uncompressed 320x100 images.
 
+// The frames are used straight from the file's bytes, so opening one doesn't copy anything
+// (or read anything at all if it's in a memory-mapped GLOBAL.BSA).
+
 class RCIFile
 {
 private:
-	// One unique_ptr for each frame.
-	std::vector<std::unique_ptr<uint8_t[]>> pixels;
+	VFS::FileView src;
+	int frameCount;
 
 	// Number of bytes in a 320x100 frame (should be 32000).
 	static const int FRAME_SIZE;
@@ -24,15 +24,15 @@ enum class BlockType : uint8_t
 
 bool VOCFile::init(const char *filename)
 {
-	std::unique_ptr<std::byte[]> src;
-	size_t srcSize;
-	if (!VFS::Manager::get().read(filename, &src, &srcSize))
+	VFS::FileView src;
+	if (!VFS::Manager::get().read(filename, &src))
 	{
 		DebugLogError("Could not read \"" + std::string(filename) + "\".");
 		return false;
 	}
 
-	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.get());
+	const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.data());
+	const size_t srcSize = src.size();
 
 	// Read part of the .VOC header. Bytes 0 to 18 contain "Creative Voice File",
 	// and byte 19 prevents the whole file from being printed by accident.
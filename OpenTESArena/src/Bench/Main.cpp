@@ -0,0 +1,1517 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+#include "../Assets/CFAFile.h"
+#include "../Assets/CIFFile.h"
+#include "../Assets/CityDataFile.h"
+#include "../Assets/Compression.h"
+#include "../Assets/DFAFile.h"
+#include "../Assets/ExeData.h"
+#include "../Assets/FLCFile.h"
+#include "../Assets/IMGFile.h"
+#include "../Assets/INFFile.h"
+#include "../Assets/MIFFile.h"
+#include "../Assets/MiscAssets.h"
+#include "../Assets/RCIFile.h"
+#include "../Assets/RMDFile.h"
+#include "../Assets/SETFile.h"
+#include "../Assets/VOCFile.h"
+#include "../Entities/Player.h"
+#include "../Game/Clock.h"
+#include "../Game/GameData.h"
+#include "../Game/Physics.h"
+#include "../Math/Constants.h"
+#include "../Math/Matrix4.h"
+#include "../Math/Vector3.h"
+#include "../Media/TextureManager.h"
+#include "../Rendering/Renderer.h"
+#include "../Rendering/RenderTimings.h"
+#include "../Utilities/Bytes.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/MemoryReport.h"
+#include "../Utilities/String.h"
+#include "../World/DistantSky.h"
+#include "../World/LevelData.h"
+#include "../World/Location.h"
+#include "../World/WeatherType.h"
+#include "../World/WorldData.h"
+#include "../World/VoxelGrid.h"
+#include "../World/WorldType.h"
+
+#include "components/vfs/manager.hpp"
+
+// Headless benchmark of the game world renderer. It loads one level straight through the
+// game data loaders, renders a camera path into an offscreen buffer with no window or audio,
+// and prints frames per second, per-phase timings, and a checksum of the frames so changes
+// to the renderer can be compared between builds.
+//
+// Usage: TESArenaBench <arena path> <level> [options]
+// - Level is one of "interior:<name>.MIF", "city:<name>.MIF" (premade city), or
+//   "wild:<TR>,<TL>,<BR>,<BL>" (wilderness .RMD IDs).
+// - Options are "-width N", "-height N", "-frames N", "-threads N" (render threads mode),
+//   "-path <file>" (camera path), "-timings <file>" (per-frame timings output), and
+//   "-raycasts N" (also times N physics ray casts fanned out around the start point, with
+//   and without empty block skipping), "-opens N" (also times N passes of opening every
+//   file the VFS lists), "-eagerassets N" (if N isn't 0, the asset tables that are
+//   normally loaded on demand are loaded at startup instead), "-decompress N" (also
+//   times N passes of decoding every compressed .IMG with the type 4 and type 8 decoders and
+//   their reference versions, and checks they match on those and on random input),
+//   "-infs N" (also times N passes of parsing every .INF), "-decodes N" (also times N
+//   passes of decoding every asset with its loader, per format and per file), and
+//   "-matrices N" (also times N passes of 4x4 matrix products against their reference
+//   versions, and checks they match), "-voxeltypes N" (also times N frames of a
+//   made-up level filled with each voxel type on its own), and "-worldgen N" (also
+//   generates every city and named dungeon in every province plus N wilderness and N
+//   wilderness dungeon samples, and prints load time percentiles, peak memory, and a
+//   checksum of the voxels per location type).
+// - Scene options are "-hour N" (time of day, noon by default) and "-weather N" (index of the
+//   weather type, clear by default), so night and fog can be covered too.
+// - Check options are "-golden <file>" (compares a few frames along the path against the
+//   ones saved in the file, within "-tolerance N" per color channel), and "-baseline <file>"
+//   (compares FPS against the one saved in the file, allowing "-maxslowdown N" percent
+//   slower). Either file is written instead if it doesn't exist yet. If a check fails, the
+//   bench exits with an error after printing everything else.
+//
+// A camera path file has one "x y z dirX dirY dirZ" point per line ('#' starts a comment).
+// The camera moves through the points at a constant rate over all frames. Without a path,
+// the camera turns in a full circle at the level's start point.
+
+namespace
+{
+	struct BenchArgs
+	{
+		std::string arenaPath, level, pathFilename, timingsFilename, goldenFilename,
+			baselineFilename;
+		int width, height, frameCount, renderThreadsMode, rayCastCount, openPassCount,
+			decompressPassCount, infPassCount, decodePassCount, matrixPassCount,
+			voxelTypeFrameCount, worldGenSampleCount, hour,
+			weatherIndex, goldenTolerance;
+		double maxSlowdownPercent;
+		bool eagerAssets;
+
+		BenchArgs()
+		{
+			this->width = 640;
+			this->height = 400;
+			this->frameCount = 300;
+			this->renderThreadsMode = 3;
+			this->rayCastCount = 0;
+			this->openPassCount = 0;
+			this->decompressPassCount = 0;
+			this->infPassCount = 0;
+			this->decodePassCount = 0;
+			this->matrixPassCount = 0;
+			this->voxelTypeFrameCount = 0;
+			this->worldGenSampleCount = 0;
+			this->hour = 12;
+			this->weatherIndex = 0;
+			this->goldenTolerance = 0;
+			this->maxSlowdownPercent = 10.0;
+			this->eagerAssets = false;
+		}
+	};
+
+	struct CameraPoint
+	{
+		Double3 position, direction;
+	};
+
+	const std::string InteriorPrefix = "interior:";
+	const std::string CityPrefix = "city:";
+	const std::string WildernessPrefix = "wild:";
+
+	BenchArgs parseArgs(int argc, char *argv[])
+	{
+		if (argc < 3)
+		{
+			throw DebugException("Usage: TESArenaBench <arena path> <level> [-width N] "
+				"[-height N] [-frames N] [-threads N] [-path file] [-timings file] "
+				"[-raycasts N] [-opens N] [-eagerassets N] [-decompress N] [-infs N] "
+				"[-decodes N] [-matrices N] [-voxeltypes N] [-worldgen N] [-hour N] "
+				"[-weather N] "
+				"[-golden file] "
+				"[-tolerance N] [-baseline file] [-maxslowdown N]");
+		}
+
+		BenchArgs args;
+		args.arenaPath = argv[1];
+		args.level = argv[2];
+
+		for (int i = 3; i < argc; i += 2)
+		{
+			const std::string name = argv[i];
+			if ((i + 1) >= argc)
+			{
+				throw DebugException("Missing value for \"" + name + "\".");
+			}
+
+			const std::string value = argv[i + 1];
+			if (name == "-width")
+			{
+				args.width = std::stoi(value);
+			}
+			else if (name == "-height")
+			{
+				args.height = std::stoi(value);
+			}
+			else if (name == "-frames")
+			{
+				args.frameCount = std::stoi(value);
+			}
+			else if (name == "-threads")
+			{
+				args.renderThreadsMode = std::stoi(value);
+			}
+			else if (name == "-path")
+			{
+				args.pathFilename = value;
+			}
+			else if (name == "-timings")
+			{
+				args.timingsFilename = value;
+			}
+			else if (name == "-raycasts")
+			{
+				args.rayCastCount = std::stoi(value);
+			}
+			else if (name == "-opens")
+			{
+				args.openPassCount = std::stoi(value);
+			}
+			else if (name == "-eagerassets")
+			{
+				args.eagerAssets = std::stoi(value) != 0;
+			}
+			else if (name == "-decompress")
+			{
+				args.decompressPassCount = std::stoi(value);
+			}
+			else if (name == "-infs")
+			{
+				args.infPassCount = std::stoi(value);
+			}
+			else if (name == "-decodes")
+			{
+				args.decodePassCount = std::stoi(value);
+			}
+			else if (name == "-matrices")
+			{
+				args.matrixPassCount = std::stoi(value);
+			}
+			else if (name == "-voxeltypes")
+			{
+				args.voxelTypeFrameCount = std::stoi(value);
+			}
+			else if (name == "-worldgen")
+			{
+				args.worldGenSampleCount = std::stoi(value);
+			}
+			else if (name == "-hour")
+			{
+				args.hour = std::stoi(value);
+			}
+			else if (name == "-weather")
+			{
+				args.weatherIndex = std::stoi(value);
+			}
+			else if (name == "-golden")
+			{
+				args.goldenFilename = value;
+			}
+			else if (name == "-tolerance")
+			{
+				args.goldenTolerance = std::stoi(value);
+			}
+			else if (name == "-baseline")
+			{
+				args.baselineFilename = value;
+			}
+			else if (name == "-maxslowdown")
+			{
+				args.maxSlowdownPercent = std::stod(value);
+			}
+			else
+			{
+				throw DebugException("Unrecognized option \"" + name + "\".");
+			}
+		}
+
+		if ((args.width <= 0) || (args.height <= 0) || (args.frameCount <= 0))
+		{
+			throw DebugException("Width, height, and frames must be positive.");
+		}
+
+		if ((args.hour < 0) || (args.hour > 23))
+		{
+			throw DebugException("Hour must be from 0 to 23.");
+		}
+
+		if ((args.weatherIndex < 0) ||
+			(args.weatherIndex > static_cast<int>(WeatherType::SnowOvercast2)))
+		{
+			throw DebugException("Unrecognized weather index " +
+				std::to_string(args.weatherIndex) + ".");
+		}
+
+		return args;
+	}
+
+	// Same check as the game uses for which version the Arena path points to. The VFS must
+	// be initialized first.
+	bool isFloppyVersion(const std::string &arenaPath)
+	{
+		if (VFS::Manager::get().exists(ExeData::CD_VERSION_EXE_FILENAME.c_str()))
+		{
+			return false;
+		}
+		else if (VFS::Manager::get().exists(ExeData::FLOPPY_VERSION_EXE_FILENAME.c_str()))
+		{
+			return true;
+		}
+		else
+		{
+			throw DebugException("\"" + String::addTrailingSlashIfMissing(arenaPath) +
+				"\" does not have an Arena executable.");
+		}
+	}
+
+	std::vector<CameraPoint> loadCameraPath(const std::string &filename)
+	{
+		std::ifstream ifs(filename);
+		if (!ifs.is_open())
+		{
+			throw DebugException("Could not open camera path \"" + filename + "\".");
+		}
+
+		std::vector<CameraPoint> points;
+		std::string line;
+		while (std::getline(ifs, line))
+		{
+			line = String::trim(line.substr(0, line.find('#')));
+			if (line.empty())
+			{
+				continue;
+			}
+
+			std::stringstream ss(line);
+			CameraPoint point;
+			if (!(ss >> point.position.x >> point.position.y >> point.position.z >>
+				point.direction.x >> point.direction.y >> point.direction.z))
+			{
+				throw DebugException("Bad camera path line \"" + line + "\".");
+			}
+
+			point.direction = point.direction.normalized();
+			points.push_back(point);
+		}
+
+		if (points.empty())
+		{
+			throw DebugException("Camera path \"" + filename + "\" has no points.");
+		}
+
+		return points;
+	}
+
+	// Turns in a full circle at the given point while keeping its pitch.
+	std::vector<CameraPoint> makeTurnaroundPath(const Double3 &position, const Double3 &direction)
+	{
+		const int pointCount = 9;
+		const double angle = std::atan2(direction.x, direction.z);
+		const double groundLength = std::sqrt((direction.x * direction.x) +
+			(direction.z * direction.z));
+
+		std::vector<CameraPoint> points(pointCount);
+		for (int i = 0; i < pointCount; i++)
+		{
+			const double pointAngle = angle + ((Constants::TwoPi * static_cast<double>(i)) /
+				static_cast<double>(pointCount - 1));
+
+			CameraPoint &point = points[i];
+			point.position = position;
+			point.direction = Double3(std::sin(pointAngle) * groundLength, direction.y,
+				std::cos(pointAngle) * groundLength).normalized();
+		}
+
+		return points;
+	}
+
+	CameraPoint getCameraPoint(const std::vector<CameraPoint> &points, int frame, int frameCount)
+	{
+		if ((points.size() == 1) || (frameCount == 1))
+		{
+			return points.front();
+		}
+
+		const double percent = static_cast<double>(frame) / static_cast<double>(frameCount - 1);
+		const double pointValue = percent * static_cast<double>(points.size() - 1);
+		const int index = std::min(static_cast<int>(pointValue),
+			static_cast<int>(points.size()) - 2);
+		const double t = pointValue - static_cast<double>(index);
+
+		const CameraPoint &p0 = points[index];
+		const CameraPoint &p1 = points[index + 1];
+
+		CameraPoint point;
+		point.position = p0.position.lerp(p1.position, t);
+		point.direction = p0.direction.lerp(p1.direction, t).normalized();
+		return point;
+	}
+
+	void loadLevel(const std::string &level, WeatherType weatherType, GameData &gameData,
+		const MiscAssets &miscAssets, TextureManager &textureManager, Renderer &renderer)
+	{
+		const int localCityID = 0;
+		const int provinceID = 0;
+		const int starCount = DistantSky::getStarCountFromDensity(0);
+
+		auto startsWith = [&level](const std::string &prefix)
+		{
+			return level.compare(0, prefix.size(), prefix) == 0;
+		};
+
+		auto loadMIF = [](const std::string &mifName)
+		{
+			MIFFile mif;
+			if (!mif.init(mifName.c_str()))
+			{
+				throw DebugException("Could not init .MIF file \"" + mifName + "\".");
+			}
+
+			return mif;
+		};
+
+		if (startsWith(InteriorPrefix))
+		{
+			const MIFFile mif = loadMIF(level.substr(InteriorPrefix.size()));
+			gameData.loadInterior(mif, Location::makeCity(localCityID, provinceID),
+				miscAssets.getExeData(), textureManager, renderer);
+		}
+		else if (startsWith(CityPrefix))
+		{
+			const MIFFile mif = loadMIF(level.substr(CityPrefix.size()));
+			gameData.loadPremadeCity(mif, weatherType, starCount, miscAssets,
+				textureManager, renderer);
+		}
+		else if (startsWith(WildernessPrefix))
+		{
+			const std::vector<std::string> ids =
+				String::split(level.substr(WildernessPrefix.size()), ',');
+			if (ids.size() != 4)
+			{
+				throw DebugException("Wilderness needs four .RMD IDs (\"" + level + "\").");
+			}
+
+			gameData.loadWilderness(localCityID, provinceID, std::stoi(ids[0]),
+				std::stoi(ids[1]), std::stoi(ids[2]), std::stoi(ids[3]), weatherType,
+				starCount, miscAssets, textureManager, renderer);
+		}
+		else
+		{
+			throw DebugException("Unrecognized level \"" + level + "\".");
+		}
+	}
+
+	// Frames kept for the golden image check, spread evenly along the path.
+	const int GoldenFrameCount = 8;
+
+	bool isGoldenFrame(int frame, int frameCount)
+	{
+		const int interval = std::max(frameCount / GoldenFrameCount, 1);
+		return (frame % interval) == 0;
+	}
+
+	// Compares the kept frames against the golden file, or writes the file if there isn't
+	// one. The file is a "width height count" line followed by the ARGB of each frame.
+	// Returns false if any pixel is off by more than the tolerance in a color channel.
+	bool checkGoldenFrames(const std::string &filename, int width, int height,
+		const std::vector<std::vector<uint32_t>> &frames, int tolerance)
+	{
+		std::ifstream ifs(filename, std::ios::binary);
+		if (!ifs.is_open())
+		{
+			std::ofstream ofs(filename, std::ios::binary);
+			if (!ofs.is_open())
+			{
+				throw DebugException("Could not write golden file \"" + filename + "\".");
+			}
+
+			ofs << width << ' ' << height << ' ' << frames.size() << '\n';
+			for (const std::vector<uint32_t> &frame : frames)
+			{
+				ofs.write(reinterpret_cast<const char*>(frame.data()),
+					frame.size() * sizeof(uint32_t));
+			}
+
+			std::cout << "Golden: saved " << frames.size() << " frames to " << filename << '\n';
+			return true;
+		}
+
+		int goldenWidth, goldenHeight;
+		size_t goldenCount;
+		ifs >> goldenWidth >> goldenHeight >> goldenCount;
+		ifs.get();
+		if ((goldenWidth != width) || (goldenHeight != height) ||
+			(goldenCount != frames.size()))
+		{
+			std::cout << "Golden: FAILED, file is " << goldenWidth << 'x' << goldenHeight <<
+				" with " << goldenCount << " frames" << '\n';
+			return false;
+		}
+
+		auto channelDiff = [](uint32_t a, uint32_t b, int shift)
+		{
+			return std::abs(static_cast<int>((a >> shift) & 0xFF) -
+				static_cast<int>((b >> shift) & 0xFF));
+		};
+
+		bool success = true;
+		std::vector<uint32_t> golden(width * height);
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			if (!ifs.read(reinterpret_cast<char*>(golden.data()),
+				golden.size() * sizeof(uint32_t)))
+			{
+				std::cout << "Golden: FAILED, file ends at frame " << i << '\n';
+				return false;
+			}
+
+			const std::vector<uint32_t> &frame = frames[i];
+			int diffCount = 0;
+			int maxDiff = 0;
+			for (size_t j = 0; j < frame.size(); j++)
+			{
+				const int diff = std::max({ channelDiff(frame[j], golden[j], 16),
+					channelDiff(frame[j], golden[j], 8), channelDiff(frame[j], golden[j], 0) });
+				if (diff > tolerance)
+				{
+					diffCount++;
+				}
+
+				maxDiff = std::max(maxDiff, diff);
+			}
+
+			if (diffCount > 0)
+			{
+				std::cout << "Golden: frame " << i << " has " << diffCount <<
+					" pixels off (max " << maxDiff << ")" << '\n';
+				success = false;
+			}
+		}
+
+		std::cout << "Golden: " << (success ? "passed" : "FAILED") << '\n';
+		return success;
+	}
+
+	// Compares FPS against the baseline file, or writes the file if there isn't one. Returns
+	// false if it's more than the given percent slower.
+	bool checkBaseline(const std::string &filename, double fps, double maxSlowdownPercent)
+	{
+		std::ifstream ifs(filename);
+		if (!ifs.is_open())
+		{
+			std::ofstream ofs(filename);
+			if (!ofs.is_open())
+			{
+				throw DebugException("Could not write baseline file \"" + filename + "\".");
+			}
+
+			ofs << String::fixedPrecision(fps, 2) << '\n';
+			std::cout << "Baseline: saved to " << filename << '\n';
+			return true;
+		}
+
+		double baselineFPS = 0.0;
+		if (!(ifs >> baselineFPS) || (baselineFPS <= 0.0))
+		{
+			throw DebugException("Invalid baseline file \"" + filename + "\".");
+		}
+
+		const double slowdownPercent = ((baselineFPS - fps) / baselineFPS) * 100.0;
+		const bool success = slowdownPercent <= maxSlowdownPercent;
+		std::cout << "Baseline: " << String::fixedPrecision(baselineFPS, 2) << " FPS, " <<
+			String::fixedPrecision(-slowdownPercent, 1) << "% change, " <<
+			(success ? "passed" : "FAILED") << '\n';
+		return success;
+	}
+
+	// Times ray casts in every direction around a point with and without empty block
+	// skipping, and checks that both hit the same things.
+	void benchmarkRayCasts(const Double3 &point, int count, const LevelData &level)
+	{
+		const double ceilingHeight = level.getCeilingHeight();
+		const VoxelGrid &voxelGrid = level.getVoxelGrid();
+
+		auto castRays = [&point, count, ceilingHeight, &voxelGrid](bool skipEmptyBlocks,
+			std::vector<Physics::Hit> &hits, std::vector<bool> &hitSomething)
+		{
+			hits.resize(count);
+			hitSomething.resize(count);
+
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < count; i++)
+			{
+				const double angle = (Constants::TwoPi * static_cast<double>(i)) /
+					static_cast<double>(count);
+				const Double3 direction(std::cos(angle), 0.0, std::sin(angle));
+				Physics::Hit &hit = hits[i];
+				hitSomething[i] = skipEmptyBlocks ?
+					Physics::rayCast(point, direction, ceilingHeight, voxelGrid, hit) :
+					Physics::rayCastEveryVoxel(point, direction, ceilingHeight, voxelGrid, hit);
+			}
+
+			const auto endTime = std::chrono::high_resolution_clock::now();
+			return std::chrono::duration<double>(endTime - startTime).count();
+		};
+
+		std::vector<Physics::Hit> hits, referenceHits;
+		std::vector<bool> hitSomething, referenceHitSomething;
+		const double seconds = castRays(true, hits, hitSomething);
+		const double referenceSeconds = castRays(false, referenceHits, referenceHitSomething);
+
+		int mismatchCount = 0;
+		for (int i = 0; i < count; i++)
+		{
+			const bool matches = (hitSomething[i] == referenceHitSomething[i]) &&
+				(!hitSomething[i] || ((hits[i].t == referenceHits[i].t) &&
+				(hits[i].voxel == referenceHits[i].voxel)));
+
+			if (!matches)
+			{
+				mismatchCount++;
+			}
+		}
+
+		std::cout << "Ray casts: " << count << " (skipping " <<
+			String::fixedPrecision(seconds * 1000.0, 3) << " ms, every voxel " <<
+			String::fixedPrecision(referenceSeconds * 1000.0, 3) << " ms, " <<
+			mismatchCount << " mismatches)" << '\n';
+	}
+
+	// Times looking up and opening every file the VFS has, i.e., every GLOBAL.BSA entry plus
+	// the loose files in the Arena folder.
+	void benchmarkOpens(int passCount)
+	{
+		VFS::Manager &manager = VFS::Manager::get();
+		const std::vector<std::string> names = manager.list();
+
+		int failCount = 0;
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < passCount; i++)
+		{
+			for (const std::string &name : names)
+			{
+				if (!manager.exists(name.c_str()) || (manager.open(name.c_str()) == nullptr))
+				{
+					failCount++;
+				}
+			}
+		}
+
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+		const int openCount = passCount * static_cast<int>(names.size());
+
+		std::cout << "Opens: " << names.size() << " files x " << passCount << " (" <<
+			String::fixedPrecision(seconds * 1000.0, 3) << " ms, " <<
+			String::fixedPrecision((openCount > 0) ? ((seconds * 1000000.0) / openCount) : 0.0, 3) <<
+			" us each, " << failCount << " failed)" << '\n';
+	}
+
+	// Times the type 4 and type 8 decoders against their reference versions on every
+	// compressed .IMG the VFS has, and checks that both give the same output for those and
+	// for random input.
+	void benchmarkDecompression(int passCount)
+	{
+		struct CompressedImage
+		{
+			std::vector<uint8_t> data;
+			int outSize;
+			bool isType08;
+		};
+
+		VFS::Manager &manager = VFS::Manager::get();
+		std::vector<CompressedImage> images;
+		for (const std::string &name : manager.list("*.IMG"))
+		{
+			VFS::FileView src;
+			if (!manager.read(name.c_str(), &src))
+			{
+				continue;
+			}
+
+			// Wall .IMGs are 4096 bytes with no header.
+			const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src.data());
+			const int headerSize = 12;
+			if ((src.size() == 4096) || (src.size() < headerSize))
+			{
+				continue;
+			}
+
+			const int width = Bytes::getLE16(srcPtr + 4);
+			const int height = Bytes::getLE16(srcPtr + 6);
+			const int compression = Bytes::getLE16(srcPtr + 8) & 0x00FF;
+			const int len = Bytes::getLE16(srcPtr + 10);
+			if (((compression != 0x0004) && (compression != 0x0008)) ||
+				((headerSize + len) > static_cast<int>(src.size())))
+			{
+				continue;
+			}
+
+			// Type 8 has a 2 byte decompressed length before the data.
+			CompressedImage image;
+			image.isType08 = compression == 0x0008;
+			const int dataOffset = headerSize + (image.isType08 ? 2 : 0);
+			image.data = std::vector<uint8_t>(srcPtr + dataOffset, srcPtr + headerSize + len);
+			image.outSize = width * height;
+			images.push_back(std::move(image));
+		}
+
+		auto decode = [](const CompressedImage &image, bool reference, std::vector<uint8_t> &out)
+		{
+			out.resize(image.outSize);
+			const uint8_t *begin = image.data.data();
+			const uint8_t *end = begin + image.data.size();
+			if (image.isType08)
+			{
+				reference ? Compression::decodeType08Reference(begin, end, out) :
+					Compression::decodeType08(begin, end, out);
+			}
+			else
+			{
+				reference ? Compression::decodeType04Reference(begin, end, out) :
+					Compression::decodeType04(begin, end, out);
+			}
+		};
+
+		int mismatchCount = 0;
+		std::vector<uint8_t> out, referenceOut;
+		auto checkImage = [&decode, &mismatchCount, &out, &referenceOut](const CompressedImage &image)
+		{
+			decode(image, false, out);
+			decode(image, true, referenceOut);
+			if (out != referenceOut)
+			{
+				mismatchCount++;
+			}
+		};
+
+		for (const CompressedImage &image : images)
+		{
+			checkImage(image);
+		}
+
+		// Random type 8 input is always decodable. Random type 4 input is built from whole
+		// literals and matches so it doesn't run out early, with enough room for the output.
+		const int randomCount = 1000;
+		std::mt19937 random(0x0A7E);
+		for (int i = 0; i < randomCount; i++)
+		{
+			CompressedImage image;
+			image.isType08 = (i % 2) == 0;
+
+			const int tokenCount = 1 + static_cast<int>(random() % 2000);
+			if (image.isType08)
+			{
+				image.data.resize(tokenCount);
+				for (uint8_t &value : image.data)
+				{
+					value = static_cast<uint8_t>(random());
+				}
+
+				image.outSize = 1 + static_cast<int>(random() % 32000);
+			}
+			else
+			{
+				image.outSize = static_cast<int>(random() % 100);
+				int mask = 0;
+				for (int j = 0; j < tokenCount; j++)
+				{
+					if ((j % 8) == 0)
+					{
+						mask = static_cast<uint8_t>(random());
+						image.data.push_back(static_cast<uint8_t>(mask));
+					}
+
+					image.data.push_back(static_cast<uint8_t>(random()));
+					if (((mask >> (j % 8)) & 1) != 0)
+					{
+						image.outSize++;
+					}
+					else
+					{
+						image.data.push_back(static_cast<uint8_t>(random()));
+						image.outSize += 18;
+					}
+				}
+			}
+
+			checkImage(image);
+		}
+
+		auto timeDecode = [passCount, &images, &decode, &out](bool reference)
+		{
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < passCount; i++)
+			{
+				for (const CompressedImage &image : images)
+				{
+					decode(image, reference, out);
+				}
+			}
+
+			const auto endTime = std::chrono::high_resolution_clock::now();
+			return std::chrono::duration<double>(endTime - startTime).count();
+		};
+
+		size_t outBytes = 0;
+		for (const CompressedImage &image : images)
+		{
+			outBytes += image.outSize;
+		}
+
+		const double seconds = timeDecode(false);
+		const double referenceSeconds = timeDecode(true);
+		const double megabytes = static_cast<double>(outBytes * passCount) / (1024.0 * 1024.0);
+
+		std::cout << "Decompression: " << images.size() << " images x " << passCount <<
+			" (" << String::fixedPrecision(megabytes / seconds, 2) << " MB/s, reference " <<
+			String::fixedPrecision(megabytes / referenceSeconds, 2) << " MB/s, " <<
+			mismatchCount << " mismatches)" << '\n';
+	}
+
+	// Times the matrix-vector and matrix-matrix products the renderer uses per flat, distant
+	// object, and sky object against their reference versions on random input, in float and
+	// double, and checks that both give the same results.
+	template <typename T>
+	void benchmarkMatrices(int passCount, const std::string &typeName)
+	{
+		const int matrixCount = 256;
+		const int vectorCount = 4096;
+		std::mt19937 random(0x0A7E);
+		std::uniform_real_distribution<T> dist(static_cast<T>(-100.0), static_cast<T>(100.0));
+		auto makeVector = [&random, &dist]()
+		{
+			return Vector4f<T>(dist(random), dist(random), dist(random), dist(random));
+		};
+
+		std::vector<Matrix4<T>> matrices(matrixCount);
+		for (Matrix4<T> &matrix : matrices)
+		{
+			matrix = Matrix4<T>(makeVector(), makeVector(), makeVector(), makeVector());
+		}
+
+		std::vector<Vector4f<T>> vectors(vectorCount);
+		for (Vector4f<T> &vector : vectors)
+		{
+			vector = makeVector();
+		}
+
+		auto matrixEquals = [](const Matrix4<T> &a, const Matrix4<T> &b)
+		{
+			return (a.x == b.x) && (a.y == b.y) && (a.z == b.z) && (a.w == b.w);
+		};
+
+		int mismatchCount = 0;
+		for (int i = 0; i < matrixCount; i++)
+		{
+			const Matrix4<T> &a = matrices[i];
+			const Matrix4<T> &b = matrices[(i + 1) % matrixCount];
+			if (!matrixEquals(a * b, a.multiplyReference(b)))
+			{
+				mismatchCount++;
+			}
+
+			for (const Vector4f<T> &vector : vectors)
+			{
+				if ((a * vector) != a.multiplyReference(vector))
+				{
+					mismatchCount++;
+				}
+			}
+		}
+
+		// The sums keep the products from being optimized out.
+		T sum = static_cast<T>(0.0);
+		auto timeProducts = [passCount, &matrices, &vectors, &sum](bool reference)
+		{
+			const Matrix4<T> &transform = matrices.front();
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < passCount; i++)
+			{
+				for (const Vector4f<T> &vector : vectors)
+				{
+					const Vector4f<T> p = reference ?
+						transform.multiplyReference(vector) : (transform * vector);
+					sum += p.w;
+				}
+
+				for (size_t j = 1; j < matrices.size(); j++)
+				{
+					const Matrix4<T> p = reference ?
+						matrices[j - 1].multiplyReference(matrices[j]) :
+						(matrices[j - 1] * matrices[j]);
+					sum += p.w.w;
+				}
+			}
+
+			const auto endTime = std::chrono::high_resolution_clock::now();
+			return std::chrono::duration<double>(endTime - startTime).count();
+		};
+
+		const double seconds = timeProducts(false);
+		const double referenceSeconds = timeProducts(true);
+		const double productCount = static_cast<double>(passCount) *
+			static_cast<double>(vectorCount + matrixCount - 1);
+
+		std::cout << "Matrices (" << typeName << "): " << passCount << " passes (" <<
+			String::fixedPrecision((seconds * 1000000000.0) / productCount, 2) <<
+			" ns per product, reference " <<
+			String::fixedPrecision((referenceSeconds * 1000000000.0) / productCount, 2) <<
+			" ns, " << mismatchCount << " mismatches, sum " << sum << ")" << '\n';
+	}
+
+	// Times parsing every .INF the VFS has, i.e., every level's texture, flat, sound, and text
+	// definitions. Interior transitions parse one each time.
+	void benchmarkINFs(int passCount)
+	{
+		const std::vector<std::string> names = VFS::Manager::get().list("*.INF");
+
+		int failCount = 0;
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < passCount; i++)
+		{
+			for (const std::string &name : names)
+			{
+				INFFile inf;
+				if (!inf.init(name.c_str()))
+				{
+					failCount++;
+				}
+			}
+		}
+
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+		const int parseCount = passCount * static_cast<int>(names.size());
+
+		std::cout << "INFs: " << names.size() << " files x " << passCount << " (" <<
+			String::fixedPrecision(seconds * 1000.0, 3) << " ms, " <<
+			String::fixedPrecision((parseCount > 0) ? ((seconds * 1000000.0) / parseCount) : 0.0, 3) <<
+			" us each, " << failCount << " failed)" << '\n';
+	}
+
+	// Gets every frame of an image set so loaders that decode frames on first access are
+	// timed the same as the others.
+	template <typename T>
+	bool touchFrames(const T &file)
+	{
+		bool success = true;
+		for (int i = 0; i < file.getImageCount(); i++)
+		{
+			success &= file.getPixels(i) != nullptr;
+		}
+
+		return success;
+	}
+
+	// Times decoding every asset the VFS has with the loader for its extension, end to end
+	// (read, decompress, and parse). Prints the throughput of each format and the slowest
+	// files, as a baseline for decoder changes.
+	void benchmarkDecoding(int passCount)
+	{
+		struct Format
+		{
+			std::string extension;
+			std::function<bool(const char*)> decode;
+			int fileCount, failCount;
+			size_t byteCount;
+			double seconds;
+		};
+
+		struct FileTiming
+		{
+			std::string name;
+			double seconds;
+		};
+
+		auto makeFormat = [](const std::string &extension, std::function<bool(const char*)> &&decode)
+		{
+			Format format;
+			format.extension = extension;
+			format.decode = std::move(decode);
+			format.fileCount = 0;
+			format.failCount = 0;
+			format.byteCount = 0;
+			format.seconds = 0.0;
+			return format;
+		};
+
+		std::vector<Format> formats;
+		formats.push_back(makeFormat("CFA", [](const char *name)
+		{
+			CFAFile file;
+			return file.init(name) && touchFrames(file);
+		}));
+
+		formats.push_back(makeFormat("CIF", [](const char *name)
+		{
+			CIFFile file;
+			return file.init(name);
+		}));
+
+		formats.push_back(makeFormat("DFA", [](const char *name)
+		{
+			DFAFile file;
+			return file.init(name) && touchFrames(file);
+		}));
+
+		auto decodeFLC = [](const char *name)
+		{
+			FLCFile file;
+			return file.init(name);
+		};
+
+		formats.push_back(makeFormat("FLC", decodeFLC));
+		formats.push_back(makeFormat("CEL", decodeFLC));
+
+		formats.push_back(makeFormat("IMG", [](const char *name)
+		{
+			IMGFile file;
+			return file.init(name);
+		}));
+
+		formats.push_back(makeFormat("INF", [](const char *name)
+		{
+			INFFile file;
+			return file.init(name);
+		}));
+
+		formats.push_back(makeFormat("MIF", [](const char *name)
+		{
+			MIFFile file;
+			return file.init(name);
+		}));
+
+		formats.push_back(makeFormat("RCI", [](const char *name)
+		{
+			RCIFile file;
+			return file.init(name);
+		}));
+
+		formats.push_back(makeFormat("RMD", [](const char *name)
+		{
+			RMDFile file;
+			return file.init(name);
+		}));
+
+		formats.push_back(makeFormat("SET", [](const char *name)
+		{
+			SETFile file;
+			return file.init(name);
+		}));
+
+		formats.push_back(makeFormat("VOC", [](const char *name)
+		{
+			VOCFile file;
+			return file.init(name);
+		}));
+
+		VFS::Manager &manager = VFS::Manager::get();
+		std::vector<FileTiming> fileTimings;
+		for (Format &format : formats)
+		{
+			const std::string pattern = "*." + format.extension;
+			for (const std::string &name : manager.list(pattern.c_str()))
+			{
+				VFS::FileView src;
+				if (!manager.read(name.c_str(), &src))
+				{
+					format.failCount++;
+					continue;
+				}
+
+				bool success = true;
+				const auto startTime = std::chrono::high_resolution_clock::now();
+				for (int i = 0; i < passCount; i++)
+				{
+					success &= format.decode(name.c_str());
+				}
+
+				const auto endTime = std::chrono::high_resolution_clock::now();
+				const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+				format.fileCount++;
+				format.failCount += success ? 0 : 1;
+				format.byteCount += src.size();
+				format.seconds += seconds;
+
+				FileTiming fileTiming;
+				fileTiming.name = name;
+				fileTiming.seconds = seconds / passCount;
+				fileTimings.push_back(std::move(fileTiming));
+			}
+		}
+
+		std::cout << "Decodes (x" << passCount << "):" << '\n';
+		for (const Format &format : formats)
+		{
+			const double megabytes = static_cast<double>(format.byteCount * passCount) / (1024.0 * 1024.0);
+			std::cout << "- " << format.extension << ": " << format.fileCount << " files, " <<
+				String::fixedPrecision(static_cast<double>(format.byteCount) / 1024.0, 1) << " KB (" <<
+				String::fixedPrecision((format.seconds * 1000.0) / passCount, 3) << " ms per pass, " <<
+				String::fixedPrecision((format.seconds > 0.0) ? (megabytes / format.seconds) : 0.0, 2) <<
+				" MB/s, " << format.failCount << " failed)" << '\n';
+		}
+
+		const int slowestCount = std::min(20, static_cast<int>(fileTimings.size()));
+		std::partial_sort(fileTimings.begin(), fileTimings.begin() + slowestCount, fileTimings.end(),
+			[](const FileTiming &a, const FileTiming &b)
+		{
+			return a.seconds > b.seconds;
+		});
+
+		std::cout << "Slowest decodes:" << '\n';
+		for (int i = 0; i < slowestCount; i++)
+		{
+			const FileTiming &fileTiming = fileTimings[i];
+			std::cout << "- " << fileTiming.name << ": " <<
+				String::fixedPrecision(fileTiming.seconds * 1000000.0, 3) << " us" << '\n';
+		}
+	}
+
+	// Times frames of a small made-up level for each voxel type, with the voxels spread out
+	// so rays pass several of them, to see what each type's column drawing costs. The
+	// camera turns a little every frame so no frame is skipped as unchanged.
+	void benchmarkVoxelTypes(int frameCount, Renderer &renderer, int width, int height)
+	{
+		struct VoxelTypeCase
+		{
+			const char *name;
+			VoxelData voxelData;
+			int voxelY;
+		};
+
+		const int textureID = 0;
+		const std::vector<VoxelTypeCase> cases =
+		{
+			{ "Wall", VoxelData::makeWall(textureID, textureID, textureID, nullptr,
+				VoxelData::WallData::Type::Solid), 1 },
+			{ "Floor", VoxelData::makeFloor(textureID), 0 },
+			{ "Ceiling", VoxelData::makeCeiling(textureID), 2 },
+			{ "Raised", VoxelData::makeRaised(textureID, textureID, textureID, 0.25, 0.50,
+				0.0, 1.0), 1 },
+			{ "Diagonal", VoxelData::makeDiagonal(textureID, true), 1 },
+			{ "TransparentWall", VoxelData::makeTransparentWall(textureID, true), 1 },
+			{ "Edge", VoxelData::makeEdge(textureID, 0.0, true, false,
+				VoxelData::Facing::PositiveX), 1 },
+			{ "Chasm", VoxelData::makeChasm(textureID, true, true, true, true,
+				VoxelData::ChasmData::Type::Dry), 0 },
+			{ "Door", VoxelData::makeDoor(textureID, VoxelData::DoorData::Type::Swinging), 1 }
+		};
+
+		const int gridWidth = 32;
+		const int gridHeight = 3;
+		const int gridDepth = 32;
+		const double ceilingHeight = 1.0;
+		const Double3 eye(16.50, 1.50, 16.50);
+		const LevelData::OpenDoors openDoors;
+		std::vector<uint32_t> colorBuffer(width * height);
+
+		std::cout << "Voxel types (" << frameCount << " frames):" << '\n';
+		for (const VoxelTypeCase &voxelTypeCase : cases)
+		{
+			VoxelGrid voxelGrid(gridWidth, gridHeight, gridDepth);
+			const uint16_t voxelID = voxelGrid.addVoxelData(voxelTypeCase.voxelData);
+			for (int z = 0; z < gridDepth; z++)
+			{
+				for (int x = 0; x < gridWidth; x++)
+				{
+					const bool isEyeVoxel = (x == static_cast<int>(eye.x)) &&
+						(z == static_cast<int>(eye.z));
+					if (!isEyeVoxel && (((x + z) % 3) == 0))
+					{
+						voxelGrid.setVoxel(x, voxelTypeCase.voxelY, z, voxelID);
+					}
+				}
+			}
+
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			for (int frame = 0; frame < frameCount; frame++)
+			{
+				const double angle = (Constants::TwoPi * static_cast<double>(frame)) /
+					static_cast<double>(frameCount);
+				const Double3 direction(std::cos(angle), 0.0, std::sin(angle));
+				renderer.renderWorldOffscreen(eye, direction, 60.0, 1.0, 0.50, 0.0, false,
+					ceilingHeight, openDoors, voxelGrid, false, false, colorBuffer.data());
+			}
+
+			const auto endTime = std::chrono::high_resolution_clock::now();
+			const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+			std::cout << "- " << voxelTypeCase.name << ": " <<
+				String::fixedPrecision((seconds * 1000.0) / static_cast<double>(frameCount), 3) <<
+				" ms per frame" << '\n';
+		}
+	}
+
+	// Load times, memory, and a voxel checksum for every level of one location type.
+	struct WorldGenStats
+	{
+		std::string typeName;
+		std::vector<double> seconds;
+		size_t peakBytes;
+		uint64_t checksum;
+
+		WorldGenStats(const std::string &typeName)
+			: typeName(typeName)
+		{
+			this->peakBytes = 0;
+			this->checksum = 14695981039346656037ULL;
+		}
+	};
+
+	// Times one level load through the game data loaders, including waiting for its chunks,
+	// then adds the active level's voxels to the checksum and updates the peak memory.
+	void measureWorldGen(WorldGenStats &stats, GameData &gameData,
+		const TextureManager &textureManager, const Renderer &renderer,
+		const std::function<void()> &load)
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		load();
+		LevelData &level = gameData.getWorldData().getActiveLevel();
+		level.waitForChunks();
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		stats.seconds.push_back(std::chrono::duration<double>(endTime - startTime).count());
+
+		// FNV-1a over the grid dimensions and voxel IDs, so generation that isn't the same
+		// from run to run (i.e., from threading or uninitialized data) changes the checksum.
+		const VoxelGrid &voxelGrid = level.getVoxelGrid();
+		auto addToChecksum = [&stats](uint32_t value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				stats.checksum ^= (value >> (i * 8)) & 0xFF;
+				stats.checksum *= 1099511628211ULL;
+			}
+		};
+
+		addToChecksum(static_cast<uint32_t>(voxelGrid.getWidth()));
+		addToChecksum(static_cast<uint32_t>(voxelGrid.getHeight()));
+		addToChecksum(static_cast<uint32_t>(voxelGrid.getDepth()));
+
+		const uint16_t *voxels = voxelGrid.getVoxels();
+		const int voxelCount = voxelGrid.getWidth() * voxelGrid.getHeight() *
+			voxelGrid.getDepth();
+		for (int i = 0; i < voxelCount; i++)
+		{
+			addToChecksum(voxels[i]);
+		}
+
+		MemoryReport report;
+		textureManager.reportMemory(report);
+		renderer.reportMemory(report);
+		report.add("World/Voxels", voxelGrid.getByteCount());
+		stats.peakBytes = std::max(stats.peakBytes, report.getTotalBytes());
+	}
+
+	// Generates every city and named dungeon in every province, plus a fixed sample of
+	// wilderness and wilderness dungeons, and prints the load time percentiles, peak memory,
+	// and voxel checksum of each location type. The same build and data should always print
+	// the same checksums.
+	void benchmarkWorldGen(int sampleCount, WeatherType weatherType, GameData &gameData,
+		const MiscAssets &miscAssets, TextureManager &textureManager, Renderer &renderer)
+	{
+		const int starCount = DistantSky::getStarCountFromDensity(0);
+		const auto &exeData = miscAssets.getExeData();
+		const int provinceCount = Location::CENTER_PROVINCE_ID;
+		const int cityCount = 32;
+		const int firstNamedDungeonID = 2;
+		const int dungeonCount = 16;
+
+		// A fixed seed so the wilderness samples are the same on every run.
+		std::mt19937 rng(12345);
+		std::uniform_int_distribution<int> provinceDist(0, provinceCount - 1);
+		std::uniform_int_distribution<int> cityDist(0, cityCount - 1);
+		std::uniform_int_distribution<int> rmdDist(5, 70); // WILD005.RMD to WILD070.RMD.
+		std::uniform_int_distribution<int> blockXDist(0, RMDFile::WIDTH - 1);
+		std::uniform_int_distribution<int> blockYDist(0, RMDFile::DEPTH - 1);
+
+		std::vector<WorldGenStats> statsList;
+		statsList.push_back(WorldGenStats("City"));
+		for (int provinceID = 0; provinceID < provinceCount; provinceID++)
+		{
+			for (int localCityID = 0; localCityID < cityCount; localCityID++)
+			{
+				measureWorldGen(statsList.back(), gameData, textureManager, renderer,
+					[&]()
+				{
+					gameData.loadCity(localCityID, provinceID, weatherType, starCount,
+						miscAssets, textureManager, renderer);
+				});
+			}
+		}
+
+		statsList.push_back(WorldGenStats("Named dungeon"));
+		for (int provinceID = 0; provinceID < provinceCount; provinceID++)
+		{
+			for (int localDungeonID = firstNamedDungeonID; localDungeonID < dungeonCount;
+				localDungeonID++)
+			{
+				measureWorldGen(statsList.back(), gameData, textureManager, renderer,
+					[&]()
+				{
+					const bool isArtifactDungeon = false;
+					gameData.loadNamedDungeon(localDungeonID, provinceID, isArtifactDungeon,
+						exeData, textureManager, renderer);
+				});
+			}
+		}
+
+		statsList.push_back(WorldGenStats("Wilderness"));
+		for (int i = 0; i < sampleCount; i++)
+		{
+			const int provinceID = provinceDist(rng);
+			const int localCityID = cityDist(rng);
+			const int rmdTR = rmdDist(rng);
+			const int rmdTL = rmdDist(rng);
+			const int rmdBR = rmdDist(rng);
+			const int rmdBL = rmdDist(rng);
+			measureWorldGen(statsList.back(), gameData, textureManager, renderer, [&]()
+			{
+				gameData.loadWilderness(localCityID, provinceID, rmdTR, rmdTL, rmdBR, rmdBL,
+					weatherType, starCount, miscAssets, textureManager, renderer);
+			});
+		}
+
+		statsList.push_back(WorldGenStats("Wilderness dungeon"));
+		for (int i = 0; i < sampleCount; i++)
+		{
+			const int provinceID = provinceDist(rng);
+			const int wildBlockX = blockXDist(rng);
+			const int wildBlockY = blockYDist(rng);
+			measureWorldGen(statsList.back(), gameData, textureManager, renderer, [&]()
+			{
+				gameData.loadWildernessDungeon(provinceID, wildBlockX, wildBlockY,
+					gameData.getCityDataFile(), exeData, textureManager, renderer);
+			});
+		}
+
+		auto getPercentile = [](const std::vector<double> &sorted, double percent)
+		{
+			const int index = static_cast<int>(
+				std::ceil((percent / 100.0) * static_cast<double>(sorted.size()))) - 1;
+			return sorted[std::max(index, 0)];
+		};
+
+		std::cout << "World gen: count p50 p95 p99 max (ms), peak MB, checksum" << '\n';
+		for (WorldGenStats &stats : statsList)
+		{
+			if (stats.seconds.empty())
+			{
+				continue;
+			}
+
+			std::sort(stats.seconds.begin(), stats.seconds.end());
+			std::cout << "  " << stats.typeName << ": " << stats.seconds.size() << ' ' <<
+				String::fixedPrecision(getPercentile(stats.seconds, 50.0) * 1000.0, 3) << ' ' <<
+				String::fixedPrecision(getPercentile(stats.seconds, 95.0) * 1000.0, 3) << ' ' <<
+				String::fixedPrecision(getPercentile(stats.seconds, 99.0) * 1000.0, 3) << ' ' <<
+				String::fixedPrecision(stats.seconds.back() * 1000.0, 3) << ", " <<
+				String::fixedPrecision(static_cast<double>(stats.peakBytes) /
+					(1024.0 * 1024.0), 2) << ", " <<
+				String::toHexString(stats.checksum) << '\n';
+		}
+	}
+
+	void printTimings(const RenderTimings &timings)
+	{
+		std::cout << "Phase: min avg p99 (ms)" << '\n';
+		for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+		{
+			const RenderTimings::Phase phase = static_cast<RenderTimings::Phase>(i);
+			const RenderTimings::Stats stats = timings.getStats(phase);
+			if (stats.p99 > 0.0)
+			{
+				std::cout << "  " << RenderTimings::getPhaseName(phase) << ": " <<
+					String::fixedPrecision(stats.min * 1000.0, 3) << ' ' <<
+					String::fixedPrecision(stats.avg * 1000.0, 3) << ' ' <<
+					String::fixedPrecision(stats.p99 * 1000.0, 3) << '\n';
+			}
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	try
+	{
+		const BenchArgs args = parseArgs(argc, argv);
+
+		// Only the assets and the software renderer are needed, so SDL video and audio
+		// are never initialized.
+		VFS::Manager::get().initialize(std::string(args.arenaPath));
+
+		auto textureManager = std::make_unique<TextureManager>();
+		textureManager->init();
+
+		auto miscAssets = std::make_unique<MiscAssets>();
+		miscAssets->init(isFloppyVersion(args.arenaPath));
+		if (args.eagerAssets)
+		{
+			miscAssets->loadLazyData();
+		}
+
+		auto renderer = std::make_unique<Renderer>();
+		renderer->initializeOffscreenWorldRendering(args.width, args.height,
+			args.renderThreadsMode);
+
+		auto gameData = std::make_unique<GameData>(Player::makeRandom(
+			miscAssets->getClassDefinitions(), miscAssets->getExeData()), *miscAssets);
+		loadLevel(args.level, static_cast<WeatherType>(args.weatherIndex), *gameData,
+			*miscAssets, *textureManager, *renderer);
+
+		// Don't benchmark placeholder chunks.
+		gameData->getWorldData().getActiveLevel().waitForChunks();
+
+		// A fixed time of day, so exteriors are lit the same on every run.
+		gameData->getClock() = Clock(args.hour, 0, 0);
+
+		const Player &player = gameData->getPlayer();
+		const std::vector<CameraPoint> cameraPath = args.pathFilename.empty() ?
+			makeTurnaroundPath(player.getPosition(), player.getDirection()) :
+			loadCameraPath(args.pathFilename);
+
+		const WorldData &worldData = gameData->getWorldData();
+		const LevelData &level = worldData.getActiveLevel();
+		const double ambientPercent = (worldData.getActiveWorldType() == WorldType::Interior) ?
+			1.0 : gameData->getAmbientPercent();
+		const double latitude = gameData->getLocation().getLatitude(
+			gameData->getCityDataFile());
+		const double fovY = 60.0;
+
+		std::vector<uint32_t> colorBuffer(args.width * args.height);
+		std::vector<std::vector<uint32_t>> goldenFrames;
+
+		// FNV-1a over the RGB of every frame, so any pixel difference along the path
+		// changes the checksum.
+		uint64_t checksum = 14695981039346656037ULL;
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < args.frameCount; frame++)
+		{
+			const CameraPoint point = getCameraPoint(cameraPath, frame, args.frameCount);
+			renderer->renderWorldOffscreen(point.position, point.direction, fovY,
+				ambientPercent, gameData->getDaytimePercent(), latitude, false,
+				level.getCeilingHeight(), level.getOpenDoors(), level.getVoxelGrid(),
+				false, false, colorBuffer.data());
+
+			for (const uint32_t color : colorBuffer)
+			{
+				checksum ^= color & 0x00FFFFFF;
+				checksum *= 1099511628211ULL;
+			}
+
+			if (!args.goldenFilename.empty() && isGoldenFrame(frame, args.frameCount))
+			{
+				goldenFrames.push_back(colorBuffer);
+			}
+		}
+
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+		std::cout << "Level: " << args.level << " (" << args.width << 'x' << args.height <<
+			", " << args.frameCount << " frames)" << '\n';
+		const double fps = static_cast<double>(args.frameCount) / seconds;
+		std::cout << "FPS: " << String::fixedPrecision(fps, 2) << '\n';
+		printTimings(renderer->getRenderTimings());
+		std::cout << "Checksum: " << String::toHexString(checksum) << '\n';
+
+		bool checksPassed = true;
+		if (!args.goldenFilename.empty())
+		{
+			checksPassed &= checkGoldenFrames(args.goldenFilename, args.width, args.height,
+				goldenFrames, args.goldenTolerance);
+		}
+
+		if (!args.baselineFilename.empty())
+		{
+			checksPassed &= checkBaseline(args.baselineFilename, fps, args.maxSlowdownPercent);
+		}
+
+		if (!args.timingsFilename.empty())
+		{
+			renderer->getRenderTimings().save(args.timingsFilename);
+		}
+
+		if (args.rayCastCount > 0)
+		{
+			benchmarkRayCasts(player.getPosition(), args.rayCastCount, level);
+		}
+
+		if (args.openPassCount > 0)
+		{
+			benchmarkOpens(args.openPassCount);
+		}
+
+		if (args.decompressPassCount > 0)
+		{
+			benchmarkDecompression(args.decompressPassCount);
+		}
+
+		if (args.infPassCount > 0)
+		{
+			benchmarkINFs(args.infPassCount);
+		}
+
+		if (args.decodePassCount > 0)
+		{
+			benchmarkDecoding(args.decodePassCount);
+		}
+
+		if (args.matrixPassCount > 0)
+		{
+			benchmarkMatrices<float>(args.matrixPassCount, "float");
+			benchmarkMatrices<double>(args.matrixPassCount, "double");
+		}
+
+		if (args.voxelTypeFrameCount > 0)
+		{
+			benchmarkVoxelTypes(args.voxelTypeFrameCount, *renderer, args.width, args.height);
+		}
+
+		// Last since it replaces the benchmarked level.
+		if (args.worldGenSampleCount > 0)
+		{
+			benchmarkWorldGen(args.worldGenSampleCount,
+				static_cast<WeatherType>(args.weatherIndex), *gameData, *miscAssets,
+				*textureManager, *renderer);
+		}
+
+		if (!checksPassed)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Exception! " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -1,10 +1,30 @@
 #include "Doodad.h"
+#include "EntityPool.h"
 #include "EntityType.h"
 
+namespace
+{
+	EntityPool &getDoodadPool()
+	{
+		static EntityPool pool(sizeof(Doodad));
+		return pool;
+	}
+}
+
 Doodad::Doodad(const Animation &animation, const Double3 &position,
 	EntityManager &entityManager)
 	: Entity(entityManager), animation(animation), position(position) { }
 
+void *Doodad::operator new(size_t size)
+{
+	return getDoodadPool().allocate(size);
+}
+
+void Doodad::operator delete(void *ptr)
+{
+	getDoodadPool().deallocate(ptr);
+}
+
 std::unique_ptr<Entity> Doodad::clone(EntityManager &entityManager) const
 {
 	return std::make_unique<Doodad>(this->animation, this->position, entityManager);
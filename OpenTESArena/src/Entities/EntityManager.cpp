@@ -1,75 +1,471 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "Entity.h"
 #include "EntityManager.h"
 #include "EntityType.h"
 #include "../Utilities/Debug.h"
 
+const int EntityManager::SLOT_BITS = 20;
+const double EntityManager::CELL_SIZE = 4.0;
+const double EntityManager::ENTITY_RADIUS = 0.25;
+const double EntityManager::ENTITY_HEIGHT = 1.0;
+const int EntityManager::HIDDEN_FRAME_INTERVAL = 8;
+const int EntityManager::TICK_BATCH_SIZE = 64;
+
+static_assert(static_cast<int>(EntityType::Transition) == 4,
+	"EntityManager::TYPE_COUNT must match the number of entity types.");
+
+EntityManager::TickBand::TickBand(double maxDistance, int frameInterval)
+{
+	this->maxDistance = maxDistance;
+	this->frameInterval = frameInterval;
+}
+
+EntityManager::Slot::Slot()
+{
+	this->generation = 0;
+	this->index = -1;
+	this->pendingDt = 0.0;
+}
+
 EntityManager::EntityManager()
 {
+	// Every frame near the player, then every other frame, then every fourth.
+	this->tickBands.push_back(TickBand(16.0, 1));
+	this->tickBands.push_back(TickBand(48.0, 2));
+	this->tickBands.push_back(TickBand(std::numeric_limits<double>::infinity(), 4));
+
+	this->entityCount = 0;
+	this->tickFrame = 0;
+}
+
+int EntityManager::getSlotIndex(int id)
+{
+	return id & ((1 << EntityManager::SLOT_BITS) - 1);
+}
+
+int EntityManager::getGeneration(int id)
+{
+	return id >> EntityManager::SLOT_BITS;
+}
+
+int EntityManager::nextGeneration(int generation)
+{
+	// Wraps within the ID bits left after the slot index, keeping IDs positive.
+	return (generation + 1) & ((1 << ((sizeof(int) * 8) - 1 - EntityManager::SLOT_BITS)) - 1);
+}
 
+int EntityManager::makeID(int slotIndex, int generation)
+{
+	return slotIndex | (generation << EntityManager::SLOT_BITS);
+}
+
+const EntityManager::Slot *EntityManager::getSlot(int id) const
+{
+	if (id < 0)
+	{
+		return nullptr;
+	}
+
+	const int slotIndex = EntityManager::getSlotIndex(id);
+	if (slotIndex >= static_cast<int>(this->slots.size()))
+	{
+		return nullptr;
+	}
+
+	const Slot &slot = this->slots[slotIndex];
+	if ((slot.entity == nullptr) || (slot.generation != EntityManager::getGeneration(id)))
+	{
+		return nullptr;
+	}
+
+	return &slot;
+}
+
+Int2 EntityManager::getCell(const Double2 &point)
+{
+	return Int2(
+		static_cast<int>(std::floor(point.x / EntityManager::CELL_SIZE)),
+		static_cast<int>(std::floor(point.y / EntityManager::CELL_SIZE)));
+}
+
+void EntityManager::addToCells(Entity *entity, const Int2 &cellMin, const Int2 &cellMax)
+{
+	for (int z = cellMin.y; z <= cellMax.y; z++)
+	{
+		for (int x = cellMin.x; x <= cellMax.x; x++)
+		{
+			this->cellEntities[Int2(x, z)].push_back(entity);
+		}
+	}
+}
+
+void EntityManager::removeFromCells(Entity *entity, const Int2 &cellMin, const Int2 &cellMax)
+{
+	for (int z = cellMin.y; z <= cellMax.y; z++)
+	{
+		for (int x = cellMin.x; x <= cellMax.x; x++)
+		{
+			const auto cellIter = this->cellEntities.find(Int2(x, z));
+			DebugAssert(cellIter != this->cellEntities.end());
+
+			std::vector<Entity*> &entities = cellIter->second;
+			const auto iter = std::find(entities.begin(), entities.end(), entity);
+			DebugAssert(iter != entities.end());
+			*iter = entities.back();
+			entities.pop_back();
+
+			// Empty cells are kept so entities coming back to them don't reallocate.
+		}
+	}
 }
 
 Entity *EntityManager::at(int id) const
 {
-	const auto entityIter = this->entities.find(id);
-	return (entityIter != this->entities.end()) ?
-		entityIter->second.get() : nullptr;
+	const Slot *slot = this->getSlot(id);
+	return (slot != nullptr) ? slot->entity.get() : nullptr;
+}
+
+int EntityManager::getEntityCount() const
+{
+	return this->entityCount;
 }
 
 std::vector<Entity*> EntityManager::getAllEntities() const
 {
 	std::vector<Entity*> entityPtrs;
+	entityPtrs.reserve(this->entityCount);
 
-	for (const auto &pair : this->entities)
+	for (const auto &entities : this->typeEntities)
 	{
-		Entity *entity = pair.second.get();
-		entityPtrs.push_back(entity);
+		entityPtrs.insert(entityPtrs.end(), entities.begin(), entities.end());
 	}
 
 	return entityPtrs;
 }
 
-std::vector<Entity*> EntityManager::getEntities(EntityType entityType) const
+const std::vector<Entity*> &EntityManager::getEntities(EntityType entityType) const
 {
-	std::vector<Entity*> entityPtrs;
+	const int typeIndex = static_cast<int>(entityType);
+	DebugAssert((typeIndex >= 0) && (typeIndex < EntityManager::TYPE_COUNT));
+	return this->typeEntities[typeIndex];
+}
 
-	// Gather up entities whose type matches the given type.
-	for (const auto &pair : this->entities)
+void EntityManager::getEntitiesInRadius(const Double2 &point, double radius,
+	std::vector<Entity*> &entities) const
+{
+	const Int2 queryMin = EntityManager::getCell(point - Double2(radius, radius));
+	const Int2 queryMax = EntityManager::getCell(point + Double2(radius, radius));
+	const double radiusSquared = radius * radius;
+
+	for (int z = queryMin.y; z <= queryMax.y; z++)
 	{
-		Entity *entity = pair.second.get();
-		if (entity->getEntityType() == entityType)
+		for (int x = queryMin.x; x <= queryMax.x; x++)
 		{
-			entityPtrs.push_back(entity);
+			const auto cellIter = this->cellEntities.find(Int2(x, z));
+			if (cellIter == this->cellEntities.end())
+			{
+				continue;
+			}
+
+			for (Entity *entity : cellIter->second)
+			{
+				// An entity in several of the queried cells is only checked in the first one.
+				const Slot &slot = this->slots[EntityManager::getSlotIndex(entity->getID())];
+				if ((x != std::max(slot.cellMin.x, queryMin.x)) ||
+					(z != std::max(slot.cellMin.y, queryMin.y)))
+				{
+					continue;
+				}
+
+				const Double3 &position = entity->getPosition();
+				const Double2 diff = Double2(position.x, position.z) - point;
+				if (((diff.x * diff.x) + (diff.y * diff.y)) <= radiusSquared)
+				{
+					entities.push_back(entity);
+				}
+			}
 		}
 	}
+}
 
-	return entityPtrs;
+void EntityManager::getEntitiesOnRay(const Double2 &rayStart, const Double2 &direction,
+	double maxDistance, std::vector<Entity*> &entities) const
+{
+	DebugAssert(std::isfinite(maxDistance));
+	const size_t firstIndex = entities.size();
+
+	// Walk the grid cells the ray passes through, in cell units.
+	const Double2 start(rayStart.x / EntityManager::CELL_SIZE,
+		rayStart.y / EntityManager::CELL_SIZE);
+	const double maxT = maxDistance / EntityManager::CELL_SIZE;
+	Int2 cell = EntityManager::getCell(rayStart);
+
+	const int stepX = (direction.x >= 0.0) ? 1 : -1;
+	const int stepZ = (direction.y >= 0.0) ? 1 : -1;
+	const double infinity = std::numeric_limits<double>::infinity();
+	const double deltaX = (direction.x != 0.0) ? std::abs(1.0 / direction.x) : infinity;
+	const double deltaZ = (direction.y != 0.0) ? std::abs(1.0 / direction.y) : infinity;
+	double nextX = (direction.x != 0.0) ?
+		((static_cast<double>(cell.x + ((stepX > 0) ? 1 : 0)) - start.x) / direction.x) : infinity;
+	double nextZ = (direction.y != 0.0) ?
+		((static_cast<double>(cell.y + ((stepZ > 0) ? 1 : 0)) - start.y) / direction.y) : infinity;
+
+	while (true)
+	{
+		const auto cellIter = this->cellEntities.find(cell);
+		if (cellIter != this->cellEntities.end())
+		{
+			for (Entity *entity : cellIter->second)
+			{
+				// Entities in several cells along the ray are only added once.
+				const auto begin = entities.begin() + firstIndex;
+				if (std::find(begin, entities.end(), entity) == entities.end())
+				{
+					entities.push_back(entity);
+				}
+			}
+		}
+
+		if (std::min(nextX, nextZ) > maxT)
+		{
+			break;
+		}
+
+		if (nextX < nextZ)
+		{
+			cell.x += stepX;
+			nextX += deltaX;
+		}
+		else
+		{
+			cell.y += stepZ;
+			nextZ += deltaZ;
+		}
+	}
+}
+
+void EntityManager::updateCells(int id)
+{
+	DebugAssert(this->getSlot(id) != nullptr);
+
+	Slot &slot = this->slots[EntityManager::getSlotIndex(id)];
+	const Double3 &position = slot.entity->getPosition();
+	const Double2 positionXZ(position.x, position.z);
+	const Double2 extent(EntityManager::ENTITY_RADIUS, EntityManager::ENTITY_RADIUS);
+	const Int2 cellMin = EntityManager::getCell(positionXZ - extent);
+	const Int2 cellMax = EntityManager::getCell(positionXZ + extent);
+
+	if ((cellMin != slot.cellMin) || (cellMax != slot.cellMax))
+	{
+		this->removeFromCells(slot.entity.get(), slot.cellMin, slot.cellMax);
+		this->addToCells(slot.entity.get(), cellMin, cellMax);
+		slot.cellMin = cellMin;
+		slot.cellMax = cellMax;
+	}
+}
+
+void EntityManager::setTickBands(const std::vector<TickBand> &tickBands)
+{
+	DebugAssert(tickBands.size() > 0);
+	this->tickBands = tickBands;
+}
+
+void EntityManager::tick(Game &game, double dt, const Double2 &playerPosition,
+	const std::function<bool(const Entity&)> &isVisible,
+	const std::function<void(Entity&)> &ticked, const ParallelFunction &runParallel)
+{
+	// Find which entities are due this frame.
+	this->dueSlots.clear();
+	for (int slotIndex = 0; slotIndex < static_cast<int>(this->slots.size()); slotIndex++)
+	{
+		Slot &slot = this->slots[slotIndex];
+		if (slot.entity == nullptr)
+		{
+			continue;
+		}
+
+		const Entity &entity = *slot.entity;
+		slot.pendingDt += dt;
+
+		const Double3 &position = entity.getPosition();
+		const Double2 diff = Double2(position.x, position.z) - playerPosition;
+		const double distanceSquared = (diff.x * diff.x) + (diff.y * diff.y);
+		int frameInterval = [this, distanceSquared]()
+		{
+			for (const TickBand &band : this->tickBands)
+			{
+				if (distanceSquared <= (band.maxDistance * band.maxDistance))
+				{
+					return band.frameInterval;
+				}
+			}
+
+			return this->tickBands.back().frameInterval;
+		}();
+
+		if (!isVisible(entity))
+		{
+			frameInterval = std::max(frameInterval, EntityManager::HIDDEN_FRAME_INTERVAL);
+		}
+
+		// Offset by slot so entities in the same band don't all tick on the same frame.
+		if (((this->tickFrame + slotIndex) % std::max(frameInterval, 1)) == 0)
+		{
+			this->dueSlots.push_back(slotIndex);
+		}
+	}
+
+	// Tick the due entities in batches. Each batch only writes its own entities.
+	const int dueCount = static_cast<int>(this->dueSlots.size());
+	const int batchCount = (dueCount + EntityManager::TICK_BATCH_SIZE - 1) /
+		EntityManager::TICK_BATCH_SIZE;
+	const std::function<void(int)> tickBatch = [this, &game, dueCount](int batchIndex)
+	{
+		const int begin = batchIndex * EntityManager::TICK_BATCH_SIZE;
+		const int end = std::min(begin + EntityManager::TICK_BATCH_SIZE, dueCount);
+		for (int i = begin; i < end; i++)
+		{
+			Slot &slot = this->slots[this->dueSlots[i]];
+			slot.entity->tick(game, slot.pendingDt);
+			slot.pendingDt = 0.0;
+		}
+	};
+
+	if (runParallel && (batchCount > 1))
+	{
+		runParallel(batchCount, tickBatch);
+	}
+	else
+	{
+		for (int i = 0; i < batchCount; i++)
+		{
+			tickBatch(i);
+		}
+	}
+
+	// Merge the results in slot order now that no entity is changing.
+	for (const int slotIndex : this->dueSlots)
+	{
+		Entity &entity = *this->slots[slotIndex].entity;
+		this->updateCells(entity.getID());
+		ticked(entity);
+	}
+
+	this->tickFrame++;
 }
 
 int EntityManager::nextID() const
 {
-	// Iterate through IDs from 0 to infinity until one is available.
-	int id = 0;
-	while (this->entities.find(id) != this->entities.end())
+	// Reuse the most recently freed slot if there is one.
+	if (this->freeSlots.size() > 0)
 	{
-		id++;
+		const int slotIndex = this->freeSlots.back();
+		return EntityManager::makeID(slotIndex, this->slots[slotIndex].generation);
 	}
 
-	return id;
+	const int slotIndex = static_cast<int>(this->slots.size());
+	DebugAssert(slotIndex < (1 << EntityManager::SLOT_BITS));
+	return EntityManager::makeID(slotIndex, 0);
 }
 
 void EntityManager::add(std::unique_ptr<Entity> entity)
 {
 	DebugAssert(entity.get() != nullptr);
 
-	// Programmer error if two entities have the same ID.
-	DebugAssert(this->entities.find(entity->getID()) == this->entities.end());
+	// Programmer error if the entity's ID wasn't the next one.
+	const int id = entity->getID();
+	DebugAssert(id == this->nextID());
 
-	// Add the pair to the entities map.
-	int entityID = entity->getID();
-	this->entities.insert(std::make_pair(entityID, std::move(entity)));
+	const int slotIndex = EntityManager::getSlotIndex(id);
+	if (this->freeSlots.size() > 0)
+	{
+		this->freeSlots.pop_back();
+	}
+	else
+	{
+		this->slots.push_back(Slot());
+	}
+
+	// Add the entity to the end of its type's list.
+	const int typeIndex = static_cast<int>(entity->getEntityType());
+	std::vector<Entity*> &entities = this->typeEntities[typeIndex];
+
+	Slot &slot = this->slots[slotIndex];
+	slot.index = static_cast<int>(entities.size());
+	entities.push_back(entity.get());
+	slot.entity = std::move(entity);
+	this->entityCount++;
+
+	// Put the entity in the grid cells its bounding circle touches.
+	const Double3 &position = slot.entity->getPosition();
+	const Double2 positionXZ(position.x, position.z);
+	const Double2 extent(EntityManager::ENTITY_RADIUS, EntityManager::ENTITY_RADIUS);
+	slot.cellMin = EntityManager::getCell(positionXZ - extent);
+	slot.cellMax = EntityManager::getCell(positionXZ + extent);
+	this->addToCells(slot.entity.get(), slot.cellMin, slot.cellMax);
 }
 
 void EntityManager::remove(int id)
 {
-	this->entities.erase(id);
+	if (this->getSlot(id) == nullptr)
+	{
+		return;
+	}
+
+	const int slotIndex = EntityManager::getSlotIndex(id);
+	Slot &slot = this->slots[slotIndex];
+
+	// Move the last entity of the same type into the removed entity's place.
+	const int typeIndex = static_cast<int>(slot.entity->getEntityType());
+	std::vector<Entity*> &entities = this->typeEntities[typeIndex];
+	Entity *lastEntity = entities.back();
+	entities[slot.index] = lastEntity;
+	this->slots[EntityManager::getSlotIndex(lastEntity->getID())].index = slot.index;
+	entities.pop_back();
+
+	this->removeFromCells(slot.entity.get(), slot.cellMin, slot.cellMax);
+
+	// A new generation makes any copies of the old ID stale.
+	slot.entity = nullptr;
+	slot.index = -1;
+	slot.pendingDt = 0.0;
+	slot.generation = EntityManager::nextGeneration(slot.generation);
+	this->freeSlots.push_back(slotIndex);
+	this->entityCount--;
+}
+
+void EntityManager::clear()
+{
+	// Free every slot with a new generation so old IDs stay stale. Each list keeps its memory
+	// for the next level's entities.
+	this->freeSlots.clear();
+	for (int slotIndex = static_cast<int>(this->slots.size()) - 1; slotIndex >= 0; slotIndex--)
+	{
+		Slot &slot = this->slots[slotIndex];
+		if (slot.entity != nullptr)
+		{
+			slot.entity = nullptr;
+			slot.index = -1;
+			slot.pendingDt = 0.0;
+			slot.generation = EntityManager::nextGeneration(slot.generation);
+		}
+
+		this->freeSlots.push_back(slotIndex);
+	}
+
+	for (auto &entities : this->typeEntities)
+	{
+		entities.clear();
+	}
+
+	for (auto &pair : this->cellEntities)
+	{
+		pair.second.clear();
+	}
+
+	this->entityCount = 0;
+	this->tickFrame = 0;
 }
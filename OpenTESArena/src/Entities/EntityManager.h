@@ -1,19 +1,106 @@
 #ifndef ENTITY_MANAGER_H
 #define ENTITY_MANAGER_H
 
+#include <array>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "../Entities/Entity.h"
+#include "../Math/Vector2.h"
+
+// Entities are kept in a dense list for each entity type so ticking or drawing all entities
+// of a type is a walk over one contiguous array. An entity's ID is a slot index plus a
+// generation that changes each time the slot is reused, so a stale ID never finds the
+// entity that took its slot.
+
+// Entities are also bucketed in a uniform XZ grid of cells so radius and ray queries only
+// look at entities near them. Each entity is in every cell its bounding circle touches.
+// Entities don't know about the grid, so whatever moves an entity must call
+// updateCells() afterwards.
+
+// Entities far from the player are ticked less often, with the time since their last tick,
+// so a big city population doesn't cost a full simulation every frame.
+
+class Game;
 
 enum class EntityType;
 
 class EntityManager
 {
+public:
+	// Entities within a distance of the player (in voxels) are ticked once every so many
+	// frames. Entities past the last band use its interval.
+	struct TickBand
+	{
+		double maxDistance;
+		int frameInterval;
+
+		TickBand(double maxDistance, int frameInterval);
+	};
+
+	// Runs a function once for each batch index, possibly on other threads, and returns when
+	// every batch is done (i.e., Renderer::runParallel()).
+	typedef std::function<void(int batchCount, const std::function<void(int)> &batchFunction)>
+		ParallelFunction;
 private:
-	std::unordered_map<int, std::unique_ptr<Entity>> entities;
+	// Bits of an ID used for the slot index. The rest are for the generation.
+	static const int SLOT_BITS;
+
+	// Number of entity types.
+	static constexpr int TYPE_COUNT = 5;
+
+	// Most entities ticked by one batch in tick().
+	static const int TICK_BATCH_SIZE;
+
+	struct Slot
+	{
+		std::unique_ptr<Entity> entity; // Null if the slot is free.
+		int generation;
+		int index; // Position in its type's dense list.
+		Int2 cellMin, cellMax; // Range of grid cells the entity is in.
+		double pendingDt; // Time since the entity was last ticked.
+
+		Slot();
+	};
+
+	std::vector<Slot> slots;
+	std::vector<int> freeSlots; // Indices of free slots, most recently freed last.
+	std::array<std::vector<Entity*>, TYPE_COUNT> typeEntities; // Dense list of each type's entities.
+	std::unordered_map<Int2, std::vector<Entity*>> cellEntities; // Entities in each grid cell.
+	std::vector<TickBand> tickBands; // Nearest first.
+	std::vector<int> dueSlots; // Slots of the entities being ticked this frame.
+	int entityCount;
+	int tickFrame; // Number of tick() calls, for spreading out far entity ticks.
+
+	static int getSlotIndex(int id);
+	static int getGeneration(int id);
+	static int makeID(int slotIndex, int generation);
+	static int nextGeneration(int generation);
+
+	// Gets the slot for an ID, or null if the ID is stale or out of range.
+	const Slot *getSlot(int id) const;
+
+	// Gets the grid cell an XZ point is in.
+	static Int2 getCell(const Double2 &point);
+
+	// Adds or removes an entity in each grid cell of a range.
+	void addToCells(Entity *entity, const Int2 &cellMin, const Int2 &cellMax);
+	void removeFromCells(Entity *entity, const Int2 &cellMin, const Int2 &cellMax);
 public:
+	// Width of a grid cell in voxels.
+	static const double CELL_SIZE;
+
+	// Size of every entity for spatial queries until entities have their own. The radius is
+	// in the XZ plane and the height goes up from the entity's position.
+	static const double ENTITY_RADIUS;
+	static const double ENTITY_HEIGHT;
+
+	// Entities the caller says aren't visible are ticked at most this often, so off-screen
+	// animations mostly stop.
+	static const int HIDDEN_FRAME_INTERVAL;
+
 	EntityManager();
 	EntityManager(EntityManager &&entityManager) = default;
 
@@ -22,20 +109,86 @@ public:
 	// Gets an entity pointer, given their ID. Returns null if no ID matches.
 	Entity *at(int id) const;
 
-	// Gets all entities of all types.
+	// Gets the number of entities of all types.
+	int getEntityCount() const;
+
+	// Gets a copy of the list of all entities of all types, grouped by type. Prefer forEach()
+	// for just visiting them.
 	std::vector<Entity*> getAllEntities() const;
 
-	// Gets all entities of the given type.
-	std::vector<Entity*> getEntities(EntityType entityType) const;
+	// Gets all entities of the given type. The list is only valid until an entity is added
+	// or removed.
+	const std::vector<Entity*> &getEntities(EntityType entityType) const;
 
-	// Obtains an available ID to be assigned to a new entity.
+	// Calls a function with each entity in place, without building a list. Entities must not
+	// be added or removed by the function.
+	template <typename FunctionType>
+	void forEach(FunctionType &&function) const;
+	template <typename FunctionType>
+	void forEach(EntityType entityType, FunctionType &&function) const;
+
+	// Obtains an available ID to be assigned to a new entity. The ID stays available until
+	// an entity is added.
 	int nextID() const;
-	
+
 	// Adds an entity. The entity must get their ID from "nextID()" beforehand.
 	void add(std::unique_ptr<Entity> entity);
 
-	// Deletes an entity.
+	// Gets the entities whose position is within a distance of an XZ point. They're added to
+	// the end of the output list.
+	void getEntitiesInRadius(const Double2 &point, double radius,
+		std::vector<Entity*> &entities) const;
+
+	// Gets the entities whose bounding circle might be touched by an XZ ray (with normalized
+	// direction) up to a finite max distance, roughly nearest first. They're added to the end of the output list.
+	void getEntitiesOnRay(const Double2 &rayStart, const Double2 &direction, double maxDistance,
+		std::vector<Entity*> &entities) const;
+
+	// Updates which grid cells an entity is in. Must be called after an entity moves.
+	void updateCells(int id);
+
+	// Sets the distance bands for ticking entities, nearest first. There must be at least one.
+	void setTickBands(const std::vector<TickBand> &tickBands);
+
+	// Ticks the entities that are due this frame by their distance to the player and whether
+	// they're visible, then updates their grid cells and calls the ticked function with them
+	// (i.e., for updating their flats in the renderer). Entities must not be added or removed
+	// by either function. If the parallel function is set, entity ticks are split into batches
+	// that run through it, so an entity's tick may only change that entity and read the rest
+	// of the world. Anything affecting other entities or the world belongs in the ticked
+	// function, which is only called from this thread once every tick is done.
+	void tick(Game &game, double dt, const Double2 &playerPosition,
+		const std::function<bool(const Entity&)> &isVisible,
+		const std::function<void(Entity&)> &ticked, const ParallelFunction &runParallel);
+
+	// Deletes an entity. The last entity of its type takes its place in the type's list.
 	void remove(int id);
+
+	// Deletes all entities (i.e., when unloading a level). Their memory goes back to their
+	// type's pool and the manager's lists keep their capacity, so populating the next level
+	// doesn't allocate as much.
+	void clear();
 };
 
+template <typename FunctionType>
+void EntityManager::forEach(FunctionType &&function) const
+{
+	for (const auto &entities : this->typeEntities)
+	{
+		for (Entity *entity : entities)
+		{
+			function(*entity);
+		}
+	}
+}
+
+template <typename FunctionType>
+void EntityManager::forEach(EntityType entityType, FunctionType &&function) const
+{
+	for (Entity *entity : this->getEntities(entityType))
+	{
+		function(*entity);
+	}
+}
+
 #endif
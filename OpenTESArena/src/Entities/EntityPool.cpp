@@ -0,0 +1,52 @@
+#include <cstddef>
+
+#include "EntityPool.h"
+#include "../Utilities/Debug.h"
+
+const int EntityPool::BLOCKS_PER_CHUNK = 64;
+
+EntityPool::EntityPool(size_t blockSize)
+{
+	// Round the block size up so every block is aligned for any type.
+	const size_t alignment = alignof(std::max_align_t);
+	this->blockSize = ((blockSize + alignment - 1) / alignment) * alignment;
+}
+
+int EntityPool::getUsedCount() const
+{
+	const int blockCount = static_cast<int>(this->chunks.size()) * EntityPool::BLOCKS_PER_CHUNK;
+	return blockCount - static_cast<int>(this->freeBlocks.size());
+}
+
+void *EntityPool::allocate(size_t size)
+{
+	DebugAssertMsg(size <= this->blockSize, "Object too big for entity pool.");
+
+	if (this->freeBlocks.size() == 0)
+	{
+		// Add a chunk of blocks, pushed in reverse so they're handed out in address order.
+		const size_t chunkSize = this->blockSize * EntityPool::BLOCKS_PER_CHUNK;
+		this->chunks.push_back(std::make_unique<unsigned char[]>(chunkSize));
+
+		unsigned char *chunk = this->chunks.back().get();
+		this->freeBlocks.reserve(this->chunks.size() * EntityPool::BLOCKS_PER_CHUNK);
+		for (int i = EntityPool::BLOCKS_PER_CHUNK - 1; i >= 0; i--)
+		{
+			this->freeBlocks.push_back(chunk + (this->blockSize * i));
+		}
+	}
+
+	void *block = this->freeBlocks.back();
+	this->freeBlocks.pop_back();
+	return block;
+}
+
+void EntityPool::deallocate(void *ptr)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	this->freeBlocks.push_back(ptr);
+}
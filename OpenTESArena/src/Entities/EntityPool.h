@@ -0,0 +1,41 @@
+#ifndef ENTITY_POOL_H
+#define ENTITY_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// A pool of same-sized memory blocks for one derived entity type, so spawning and despawning
+// entities (i.e., populating a city, then leaving it) reuses memory instead of going through
+// the heap for each one. Blocks are allocated in chunks and never given back, so the pool
+// grows to the most entities of its type that were alive at once.
+
+// Entity types route their operator new and delete through their pool. Pools aren't thread-
+// safe, so entities must be created and destroyed on the main thread.
+
+class EntityPool
+{
+private:
+	// Number of blocks allocated at a time when the pool runs out.
+	static const int BLOCKS_PER_CHUNK;
+
+	std::vector<std::unique_ptr<unsigned char[]>> chunks;
+	std::vector<void*> freeBlocks; // Most recently freed last.
+	size_t blockSize;
+public:
+	EntityPool(size_t blockSize);
+	EntityPool(const EntityPool&) = delete;
+
+	EntityPool &operator=(const EntityPool&) = delete;
+
+	// Gets the number of blocks currently in use.
+	int getUsedCount() const;
+
+	// Gets a block for an object of the given size, which must fit in the pool's blocks.
+	void *allocate(size_t size);
+
+	// Returns a block from allocate() to the pool.
+	void deallocate(void *ptr);
+};
+
+#endif
@@ -1,7 +1,17 @@
+#include "EntityPool.h"
 #include "EntityType.h"
 #include "NonPlayer.h"
 #include "../Math/Constants.h"
 
+namespace
+{
+	EntityPool &getNonPlayerPool()
+	{
+		static EntityPool pool(sizeof(NonPlayer));
+		return pool;
+	}
+}
+
 NonPlayer::NonPlayer(const Double3 &position, const Double2 &direction,
 	const std::vector<Animation> &idleAnimations,
 	const std::vector<Animation> &moveAnimations,
@@ -11,6 +21,16 @@ NonPlayer::NonPlayer(const Double3 &position, const Double2 &direction,
 	attackAnimation(attackAnimation), deathAnimation(deathAnimation),
 	camera(position, direction), velocity(0.0, 0.0) { }
 
+void *NonPlayer::operator new(size_t size)
+{
+	return getNonPlayerPool().allocate(size);
+}
+
+void NonPlayer::operator delete(void *ptr)
+{
+	getNonPlayerPool().deallocate(ptr);
+}
+
 std::unique_ptr<Entity> NonPlayer::clone(EntityManager &entityManager) const
 {
 	return std::make_unique<NonPlayer>(this->camera.position, this->camera.direction,
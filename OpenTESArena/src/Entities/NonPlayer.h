@@ -40,6 +40,10 @@ public:
 		EntityManager &entityManager);
 	virtual ~NonPlayer() = default;
 
+	// Non-players come from a pool instead of the heap.
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr);
+
 	virtual std::unique_ptr<Entity> clone(EntityManager &entityManager) const override;
 
 	virtual EntityType getEntityType() const override;
@@ -9,6 +9,7 @@
 #include "../Game/Game.h"
 #include "../Game/GameData.h"
 #include "../Game/Options.h"
+#include "../Game/Physics.h"
 #include "../Math/Constants.h"
 #include "../Math/Random.h"
 #include "../Utilities/Debug.h"
@@ -23,6 +24,7 @@ const double Player::HEIGHT = 60.0 / MIFFile::ARENA_UNITS;
 const double Player::DEFAULT_WALK_SPEED = 2.0;
 const double Player::DEFAULT_RUN_SPEED = 8.0;
 const double Player::STEPPING_HEIGHT = 0.25;
+const double Player::COLLIDER_HALF_WIDTH = 0.15;
 const double Player::JUMP_VELOCITY = 3.0;
 const double Player::GRAVITY = 9.81;
 const double Player::FRICTION = 4.0;
@@ -190,6 +192,14 @@ void Player::rotate(double dx, double dy, double hSensitivity, double vSensitivi
 		dy * (100.0 * vSensitivity), pitchLimit);
 }
 
+Double3 Player::getRotatedDirection(const Double3 &direction, double dx, double dy,
+	double hSensitivity, double vSensitivity, double pitchLimit)
+{
+	Camera3D camera(Double3::Zero, direction);
+	camera.rotate(dx * (100.0 * hSensitivity), dy * (100.0 * vSensitivity), pitchLimit);
+	return camera.getDirection();
+}
+
 void Player::lookAt(const Double3 &point)
 {
 	this->camera.lookAt(point);
@@ -198,56 +208,21 @@ void Player::lookAt(const Double3 &point)
 void Player::handleCollision(const WorldData &worldData, double dt)
 {
 	const LevelData &activeLevel = worldData.getActiveLevel();
-
-	auto getVoxelData = [&activeLevel](const Int3 &voxel) -> VoxelData
-	{
-		const VoxelGrid &voxelGrid = activeLevel.getVoxelGrid();
-
-		// Voxels outside the world are air.
-		if ((voxel.x < 0) || (voxel.x >= voxelGrid.getWidth()) ||
-			(voxel.y < 0) || (voxel.y >= voxelGrid.getHeight()) ||
-			(voxel.z < 0) || (voxel.z >= voxelGrid.getDepth()))
-		{
-			return VoxelData();
-		}
-		else
-		{
-			const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, voxel.y, voxel.z);
-			return voxelGrid.getVoxelData(voxelID);
-		}
-	};
+	const VoxelGrid &voxelGrid = activeLevel.getVoxelGrid();
 
 	// Coordinates of the base of the voxel the feet are in.
 	// - @todo: add delta velocity Y?
 	const int feetVoxelY = static_cast<int>(std::floor(
 		this->getFeetY() / activeLevel.getCeilingHeight()));
 
-	// Get the voxel data for each voxel the player would touch on each axis.
-	const Int3 playerVoxel = this->getVoxelPosition();
-	const Int3 xVoxel(
-		static_cast<int>(std::floor(this->camera.position.x + (this->velocity.x * dt))),
-		feetVoxelY,
-		playerVoxel.z);
-	const Int3 yVoxel(
-		playerVoxel.x,
-		feetVoxelY,
-		playerVoxel.z);
-	const Int3 zVoxel(
-		playerVoxel.x,
-		feetVoxelY,
-		static_cast<int>(std::floor(this->camera.position.z + (this->velocity.z * dt))));
-
-	const VoxelData &xVoxelData = getVoxelData(xVoxel);
-	const VoxelData &yVoxelData = getVoxelData(yVoxel);
-	const VoxelData &zVoxelData = getVoxelData(zVoxel);
-
-	// Check horizontal collisions.
-
 	// -- Temp hack until Y collision detection is implemented --
 	// - @todo: formalize the collision calculation and get rid of this hack.
 	//   We should be able to cover all collision cases in Arena now.
-	auto wouldCollideWithVoxel = [&activeLevel](const Int3 &voxel, const VoxelData &voxelData)
+	auto wouldCollideWithVoxel = [&activeLevel, &voxelGrid](const Int3 &voxel)
 	{
+		const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, voxel.y, voxel.z);
+		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+
 		if (voxelData.dataType == VoxelDataType::TransparentWall)
 		{
 			// Transparent wall collision.
@@ -270,20 +245,9 @@ void Player::handleCollision(const WorldData &worldData, double dt)
 				if (voxelData.dataType == VoxelDataType::Door)
 				{
 					const auto &openDoors = activeLevel.getOpenDoors();
-					const VoxelData::DoorData &doorData = voxelData.door;
 
 					// Only collide with a door voxel if the door is closed.
-					const bool isClosed = [&voxel, &openDoors]()
-					{
-						const Int2 voxelXZ(voxel.x, voxel.z);
-						const auto iter = std::find_if(openDoors.begin(), openDoors.end(),
-							[&voxelXZ](const LevelData::DoorState &openDoor)
-						{
-							return openDoor.getVoxel() == voxelXZ;
-						});
-
-						return iter == openDoors.end();
-					}();
+					const bool isClosed = openDoors.find(Int2(voxel.x, voxel.z)) == nullptr;
 
 					return !isClosed;
 				}
@@ -294,7 +258,7 @@ void Player::handleCollision(const WorldData &worldData, double dt)
 			}();
 
 			// -- Temporary hack for "on voxel enter" transitions --
-			// - @todo: replace with "on would enter voxel" event and near facing check.			
+			// - @todo: replace with "on would enter voxel" event and near facing check.
 			const bool isLevelUpDown = [&voxelData]()
 			{
 				if (voxelData.dataType == VoxelDataType::Wall)
@@ -313,20 +277,22 @@ void Player::handleCollision(const WorldData &worldData, double dt)
 		}
 	};
 
-	if (wouldCollideWithVoxel(xVoxel, xVoxelData))
+	// Sweep the player's footprint through the voxels at their feet for this frame's
+	// movement, and keep whatever velocity is left after sliding along walls. This covers
+	// the whole movement at once, so high speeds or long frames can't skip past a wall.
+	if (dt > 0.0)
 	{
-		this->velocity.x = 0.0;
-	}
+		const Double2 position(this->camera.position.x, this->camera.position.z);
+		const Double2 delta(this->velocity.x * dt, this->velocity.z * dt);
+		const Double2 moved = Physics::sweepBox(position, Player::COLLIDER_HALF_WIDTH, delta,
+			feetVoxelY, voxelGrid, wouldCollideWithVoxel);
 
-	if (wouldCollideWithVoxel(zVoxel, zVoxelData))
-	{
-		this->velocity.z = 0.0;
+		this->velocity.x = moved.x / dt;
+		this->velocity.z = moved.y / dt;
 	}
 
 	this->velocity.y = 0.0;
 	// -- end hack --
-
-	// @todo: use an axis-aligned bounding box or cylinder instead of a point?
 }
 
 void Player::setVelocityToZero()
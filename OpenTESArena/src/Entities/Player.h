@@ -15,6 +15,7 @@ class Player
 {
 private:
 	static const double STEPPING_HEIGHT; // Allowed change in height for stepping on stairs.
+	static const double COLLIDER_HALF_WIDTH; // Half the width of the player's XZ footprint.
 	static const double JUMP_VELOCITY; // Instantaneous change in Y velocity when jumping.
 	
 	// Magnitude of -Y acceleration in the air.
@@ -94,6 +95,11 @@ public:
 	// Rotates the player's camera based on some change in X (left/right) and Y (up/down).
 	void rotate(double dx, double dy, double hSensitivity, double vSensitivity, double pitchLimit);
 
+	// Gets the direction a camera facing the given direction would face after rotate() with
+	// the same values (i.e., for drawing mouse motion the next tick will apply).
+	static Double3 getRotatedDirection(const Double3 &direction, double dx, double dy,
+		double hSensitivity, double vSensitivity, double pitchLimit);
+
 	// Recalculates the player's view so they look at a point.
 	void lookAt(const Double3 &point);
 
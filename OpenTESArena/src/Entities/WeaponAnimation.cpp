@@ -86,7 +86,7 @@ WeaponAnimation::WeaponAnimation(int weaponID, const ExeData &exeData)
 		const int index = (weaponID != WeaponAnimation::FISTS_ID) ?
 			WeaponFilenameIndices.at(weaponID) : fistsFilenameIndex;
 
-		const auto &animationList = exeData.equipment.weaponAnimationFilenames;
+		const auto &animationList = exeData.getEquipment().weaponAnimationFilenames;
 		const std::string &filename = animationList.at(index);
 		return String::toUppercase(filename);
 	}();
@@ -0,0 +1,303 @@
+#include <array>
+#include <cmath>
+
+#include "Benchmark.h"
+#include "Clock.h"
+#include "Game.h"
+#include "GameData.h"
+#include "Options.h"
+#include "../Assets/CityDataFile.h"
+#include "../Assets/MIFFile.h"
+#include "../Assets/MiscAssets.h"
+#include "../Entities/Player.h"
+#include "../Interface/GameWorldPanel.h"
+#include "../Math/Constants.h"
+#include "../Math/Random.h"
+#include "../Media/MusicName.h"
+#include "../Rendering/Renderer.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/String.h"
+#include "../World/DistantSky.h"
+#include "../World/LevelData.h"
+#include "../World/Location.h"
+#include "../World/WeatherType.h"
+#include "../World/WorldData.h"
+#include "../World/WorldType.h"
+
+namespace
+{
+	enum class ScenarioType { PremadeCity, Wilderness, StaffDungeon, NamedDungeon };
+
+	struct Scenario
+	{
+		const char *name;
+		ScenarioType type;
+		WeatherType weatherType;
+		int hours, minutes;
+		double turnSeconds, moveSeconds; // Time spent on each part of the path.
+		double moveDistance; // How far forward the camera goes after turning around.
+	};
+
+	const std::array<Scenario, 4> Scenarios =
+	{
+		{
+			{ "imperial-city-noon-clear", ScenarioType::PremadeCity, WeatherType::Clear,
+				12, 0, 10.0, 20.0, 40.0 },
+			{ "wilderness-night-snow", ScenarioType::Wilderness, WeatherType::Snow,
+				22, 0, 10.0, 20.0, 60.0 },
+			{ "fang-lair", ScenarioType::StaffDungeon, WeatherType::Clear,
+				12, 0, 10.0, 10.0, 8.0 },
+			{ "named-dungeon", ScenarioType::NamedDungeon, WeatherType::Clear,
+				12, 0, 10.0, 10.0, 8.0 }
+		}
+	};
+
+	// Fixed places for the scenarios that would otherwise be random.
+	const int WildernessProvinceID = 0;
+	const int WildernessLocalCityID = 0;
+	const std::array<int, 4> WildernessRMDs = { 10, 20, 30, 40 }; // TR, TL, BR, BL.
+	const int NamedDungeonProvinceID = 0;
+	const int NamedDungeonLocalID = 2;
+	const std::string FangLairName = "Fang Lair";
+
+	// Side to side pan while moving forward, in radians.
+	const double MovePanAngle = Constants::Pi / 4.0;
+
+	// Finds the staff dungeon with the given name. Returns -1 if no province has it.
+	int findStaffDungeonProvince(const std::string &name, const CityDataFile &cityData)
+	{
+		const std::string target = String::toUppercase(name);
+		for (int provinceID = 0; provinceID < Location::CENTER_PROVINCE_ID; provinceID++)
+		{
+			const auto &provinceData = cityData.getProvinceData(provinceID);
+			const std::string dungeonName = String::toUppercase(
+				provinceData.getLocationData(Location::dungeonToLocationID(0)).name);
+			if (dungeonName == target)
+			{
+				return provinceID;
+			}
+		}
+
+		return -1;
+	}
+
+	// Loads the scenario's level into the game data. Returns the .MIF name for choosing
+	// interior music, if any.
+	std::string loadScenario(const Scenario &scenario, GameData &gameData,
+		const MiscAssets &miscAssets, const Options &options, TextureManager &textureManager,
+		Renderer &renderer)
+	{
+		const int starCount = DistantSky::getStarCountFromDensity(options.getMisc_StarDensity());
+		const auto &exeData = miscAssets.getExeData();
+
+		auto loadMIF = [](const std::string &mifName)
+		{
+			MIFFile mif;
+			if (!mif.init(mifName.c_str()))
+			{
+				DebugCrash("Could not init .MIF file \"" + mifName + "\".");
+			}
+
+			return mif;
+		};
+
+		if (scenario.type == ScenarioType::PremadeCity)
+		{
+			const MIFFile mif = loadMIF("IMPERIAL.MIF");
+			gameData.loadPremadeCity(mif, scenario.weatherType, starCount, miscAssets,
+				textureManager, renderer);
+			return std::string();
+		}
+		else if (scenario.type == ScenarioType::Wilderness)
+		{
+			// The weather isn't filtered by climate so every run gets what it asked for.
+			gameData.loadWilderness(WildernessLocalCityID, WildernessProvinceID,
+				WildernessRMDs[0], WildernessRMDs[1], WildernessRMDs[2], WildernessRMDs[3],
+				scenario.weatherType, starCount, miscAssets, textureManager, renderer);
+			return std::string();
+		}
+		else if (scenario.type == ScenarioType::StaffDungeon)
+		{
+			const auto &cityData = miscAssets.getCityDataFile();
+			const int provinceID = findStaffDungeonProvince(FangLairName, cityData);
+			if (provinceID < 0)
+			{
+				DebugCrash("No staff dungeon named \"" + FangLairName + "\".");
+			}
+
+			const int localDungeonID = 0;
+			const uint32_t dungeonSeed = cityData.getDungeonSeed(localDungeonID, provinceID);
+			const std::string mifName = CityDataFile::getMainQuestDungeonMifName(dungeonSeed);
+			const MIFFile mif = loadMIF(mifName);
+			gameData.loadInterior(mif, Location::makeDungeon(localDungeonID, provinceID),
+				exeData, textureManager, renderer);
+			return mifName;
+		}
+		else if (scenario.type == ScenarioType::NamedDungeon)
+		{
+			const bool isArtifactDungeon = false;
+			gameData.loadNamedDungeon(NamedDungeonLocalID, NamedDungeonProvinceID,
+				isArtifactDungeon, exeData, textureManager, renderer);
+			return std::string();
+		}
+		else
+		{
+			DebugCrash("Unrecognized scenario type \"" +
+				std::to_string(static_cast<int>(scenario.type)) + "\".");
+			return std::string();
+		}
+	}
+}
+
+const double Benchmark::WARMUP_SECONDS = 2.0;
+
+Benchmark::Benchmark()
+{
+	this->seconds = 0.0;
+	this->scenarioIndex = -1;
+}
+
+std::string Benchmark::getScenarioNames()
+{
+	std::string names;
+	for (const Scenario &scenario : Scenarios)
+	{
+		if (!names.empty())
+		{
+			names += ", ";
+		}
+
+		names += scenario.name;
+	}
+
+	return names;
+}
+
+bool Benchmark::isRunning() const
+{
+	return this->scenarioIndex >= 0;
+}
+
+bool Benchmark::isWarmingUp() const
+{
+	return this->isRunning() && (this->seconds < 0.0);
+}
+
+const std::string &Benchmark::getScenarioName() const
+{
+	return this->scenarioName;
+}
+
+bool Benchmark::start(const std::string &scenarioName, Game &game)
+{
+	int index = -1;
+	for (int i = 0; i < static_cast<int>(Scenarios.size()); i++)
+	{
+		if (scenarioName == Scenarios[i].name)
+		{
+			index = i;
+			break;
+		}
+	}
+
+	if (index < 0)
+	{
+		DebugLogWarning("No benchmark scenario \"" + scenarioName + "\" (try " +
+			Benchmark::getScenarioNames() + ").");
+		return false;
+	}
+
+	const Scenario &scenario = Scenarios[index];
+
+	// Initialize 3D renderer.
+	auto &renderer = game.getRenderer();
+	const auto &options = game.getOptions();
+	const bool fullGameWindow = options.getGraphics_ModernInterface();
+	renderer.initializeWorldRendering(options.getGraphics_ResolutionScale(),
+		fullGameWindow, options.getGraphics_RenderThreadsMode());
+
+	const auto &miscAssets = game.getMiscAssets();
+	auto gameData = std::make_unique<GameData>(Player::makeRandom(
+		miscAssets.getClassDefinitions(), miscAssets.getExeData()), miscAssets);
+	const std::string mifName = loadScenario(scenario, *gameData, miscAssets, options,
+		game.getTextureManager(), renderer);
+
+	// Start with the whole level in place since the path begins right away.
+	gameData->getWorldData().getActiveLevel().waitForChunks();
+	gameData->getClock() = Clock(scenario.hours, scenario.minutes, 0);
+
+	const MusicName musicName = [&mifName, &gameData]()
+	{
+		const WorldType worldType = gameData->getWorldData().getActiveWorldType();
+		if (worldType != WorldType::Interior)
+		{
+			return gameData->getClock().nightMusicIsActive() ?
+				MusicName::Night : GameData::getExteriorMusicName(gameData->getWeatherType());
+		}
+		else
+		{
+			Random random;
+			return GameData::getInteriorMusicName(mifName, random);
+		}
+	}();
+
+	const Player &player = gameData->getPlayer();
+	this->startPosition = player.getPosition();
+	this->startDirection = player.getDirection();
+	this->seconds = -Benchmark::WARMUP_SECONDS;
+	this->scenarioName = scenarioName;
+	this->scenarioIndex = index;
+
+	// Set the game data before constructing the game world panel.
+	game.setGameData(std::move(gameData));
+	game.setPanel<GameWorldPanel>(game);
+	game.setMusic(musicName);
+
+	DebugLog("Running benchmark \"" + scenarioName + "\".");
+	return true;
+}
+
+void Benchmark::update(double dt, Game &game)
+{
+	DebugAssert(this->isRunning());
+
+	const Scenario &scenario = Scenarios[this->scenarioIndex];
+	this->seconds += dt;
+
+	const double pathSeconds = scenario.turnSeconds + scenario.moveSeconds;
+	if (this->seconds >= pathSeconds)
+	{
+		this->scenarioIndex = -1;
+		return;
+	}
+
+	// Turn all the way around first, then move forward while panning side to side.
+	const double t = std::fmax(this->seconds, 0.0);
+	const double startAngle = std::atan2(this->startDirection.x, this->startDirection.z);
+	double angle, distance;
+	if (t < scenario.turnSeconds)
+	{
+		angle = startAngle + (Constants::TwoPi * (t / scenario.turnSeconds));
+		distance = 0.0;
+	}
+	else
+	{
+		const double percent = (t - scenario.turnSeconds) / scenario.moveSeconds;
+		angle = startAngle + (MovePanAngle * std::sin(Constants::TwoPi * percent));
+		distance = scenario.moveDistance * percent;
+	}
+
+	const Double3 forward = Double3(this->startDirection.x, 0.0,
+		this->startDirection.z).normalized();
+	const Double3 position = this->startPosition + (forward * distance);
+	const Double3 direction(std::sin(angle), 0.0, std::cos(angle));
+
+	auto &gameData = game.getGameData();
+	Player &player = gameData.getPlayer();
+	player.teleport(position);
+	player.lookAt(position + direction);
+	player.setVelocityToZero();
+
+	// Hold the time of day so lighting is the same at every frame rate.
+	gameData.getClock() = Clock(scenario.hours, scenario.minutes, 0);
+}
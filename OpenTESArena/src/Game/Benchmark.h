@@ -0,0 +1,49 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+
+#include "../Math/Vector3.h"
+
+// Runs the game straight into a built-in scenario (a level at a fixed time of day and
+// weather) and moves the camera along a canned path, so frame times can be compared
+// between machines and builds. Unlike the headless bench, it goes through the whole game
+// loop with a window, audio, and the UI.
+
+// The path turns the camera in a full circle at the level's start point, then moves it
+// forward while panning side to side. It's timed by game time, so every frame rate sees the
+// same path. The camera holds still for a moment first while textures finish uploading,
+// and those frames aren't counted.
+
+class Game;
+
+class Benchmark
+{
+private:
+	static const double WARMUP_SECONDS;
+
+	std::string scenarioName;
+	Double3 startPosition, startDirection;
+	double seconds; // Time spent on the path so far. Negative while warming up.
+	int scenarioIndex; // Index into the built-in scenarios, or -1 if not running.
+public:
+	Benchmark();
+
+	// Gets the names of the built-in scenarios, comma-separated.
+	static std::string getScenarioNames();
+
+	bool isRunning() const;
+	bool isWarmingUp() const;
+
+	const std::string &getScenarioName() const;
+
+	// Makes new game data with the given scenario's level and sets the game world panel.
+	// Returns false if there is no scenario with that name.
+	bool start(const std::string &scenarioName, Game &game);
+
+	// Moves the camera along the path by delta time and holds the scenario's time of day.
+	// Stops running once the path is done.
+	void update(double dt, Game &game);
+};
+
+#endif
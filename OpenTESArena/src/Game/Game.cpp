@@ -1,10 +1,13 @@
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <sstream>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <stdexcept>
 #include <string>
-#include <thread>
 
 #include "SDL.h"
 
@@ -19,13 +22,34 @@
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Surface.h"
+#include "../World/DistantSky.h"
+#include "../World/LevelCache.h"
 #include "../Utilities/Debug.h"
 #include "../Utilities/File.h"
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/KernelDispatch.h"
+#include "../Utilities/Metrics.h"
 #include "../Utilities/Platform.h"
+#include "../Utilities/Profiler.h"
 #include "../Utilities/String.h"
 
 #include "components/vfs/manager.hpp"
 
+namespace
+{
+	// Whether an event is the player doing something, for input latency.
+	bool isInputEvent(const SDL_Event &e)
+	{
+		return (e.type == SDL_KEYDOWN) || (e.type == SDL_KEYUP) ||
+			(e.type == SDL_TEXTINPUT) || (e.type == SDL_MOUSEMOTION) ||
+			(e.type == SDL_MOUSEBUTTONDOWN) || (e.type == SDL_MOUSEBUTTONUP) ||
+			(e.type == SDL_MOUSEWHEEL);
+	}
+}
+
+const int Game::IDLE_WAIT_MILLISECONDS = 100;
+const double Game::MEMORY_REPORT_SECONDS = 1.0;
+
 Game::Game()
 {
 	DebugLog("Initializing (Platform: " + Platform::getPlatform() + ").");
@@ -47,39 +71,47 @@ Game::Game()
 	VFS::Manager::get().initialize(std::string(
 		(arenaPathIsRelative ? this->basePath : "") + this->options.getMisc_ArenaPath()));
 
-	// Initialize the OpenAL Soft audio manager.
-	const bool midiPathIsRelative = File::pathIsRelative(this->options.getAudio_MidiConfig());
-	const std::string midiPath = (midiPathIsRelative ? this->basePath : "") +
-		this->options.getAudio_MidiConfig();
+	// Pin render threads if requested. This runs before the audio manager starts its
+	// threads so they begin off the render thread cores, like the main thread.
+	this->renderer.setRenderThreadsAffinity(this->options.getGraphics_RenderThreadsMode(),
+		this->options.getGraphics_RenderThreadsAffinity(),
+		this->options.getGraphics_RenderThreadsCores(),
+		this->options.getGraphics_RenderThreadsHighPriority());
 
-	this->audioManager.init(this->options.getAudio_MusicVolume(),
-		this->options.getAudio_SoundVolume(), this->options.getAudio_SoundChannels(),
-		this->options.getAudio_SoundResampling(), midiPath);
-
-	// Initialize the SDL renderer and window with the given settings.
-	this->renderer.init(this->options.getGraphics_ScreenWidth(),
-		this->options.getGraphics_ScreenHeight(), this->options.getGraphics_Fullscreen(),
-		this->options.getGraphics_LetterboxMode());
+	// A tuned render thread count from a CPU with more threads is measured again.
+	if (this->options.getGraphics_RenderThreadsAutoCount() > Platform::getThreadCount())
+	{
+		this->options.setGraphics_RenderThreadsAutoCount(0);
+	}
 
-	// Initialize the texture manager.
-	this->textureManager.init();
+	this->renderer.setAutoRenderThreadCount(this->options.getGraphics_RenderThreadsAutoCount());
 
-	// Determine which version of the game the Arena path is pointing to.
-	const bool isFloppyVersion = [this, arenaPathIsRelative]()
+	// Select the kernel versions for this CPU before anything runs them.
+	const std::string &cpuIsaLimit = this->options.getMisc_CpuIsaLimit();
+	if (!String::caseInsensitiveEquals(cpuIsaLimit, "auto"))
 	{
-		// Path to the Arena folder.
-		const std::string fullArenaPath = [this, arenaPathIsRelative]()
+		Platform::CpuIsa maxIsa;
+		if (Platform::tryParseCpuIsa(cpuIsaLimit, &maxIsa))
+		{
+			KernelDispatch::setMaxIsa(maxIsa);
+		}
+		else
 		{
-			// Include the base path if the ArenaPath is relative.
-			const std::string path = (arenaPathIsRelative ? this->basePath : "") +
-				this->options.getMisc_ArenaPath();
-			return String::addTrailingSlashIfMissing(path);
-		}();
+			DebugLogWarning("Unrecognized CPU instruction set \"" + cpuIsaLimit + "\".");
+		}
+	}
+
+	DebugLog("Best CPU instruction set: " +
+		std::string(Platform::getCpuIsaName(Platform::getBestCpuIsa())) + ", kernels: " +
+		KernelDispatch::getSelectionsText() + ".");
 
+	// Determine which version of the game the Arena path is pointing to. The executables are
+	// looked up through the VFS's file index so their casing doesn't matter.
+	const bool isFloppyVersion = [this, arenaPathIsRelative]()
+	{
 		// Check for the CD version first.
 		const std::string &acdExeName = ExeData::CD_VERSION_EXE_FILENAME;
-		const std::string acdExePath = fullArenaPath + acdExeName;
-		if (File::exists(acdExePath))
+		if (VFS::Manager::get().exists(acdExeName.c_str()))
 		{
 			DebugLog("CD version.");
 			return false;
@@ -87,19 +119,87 @@ Game::Game()
 
 		// If that's not there, check for the floppy disk version.
 		const std::string &aExeName = ExeData::FLOPPY_VERSION_EXE_FILENAME;
-		const std::string aExePath = fullArenaPath + aExeName;
-		if (File::exists(aExePath))
+		if (VFS::Manager::get().exists(aExeName.c_str()))
 		{
 			DebugLog("Floppy disk version.");
 			return true;
 		}
 
 		// If neither exist, it's not a valid Arena directory.
+		const std::string fullArenaPath = String::addTrailingSlashIfMissing(
+			(arenaPathIsRelative ? this->basePath : "") + this->options.getMisc_ArenaPath());
 		throw DebugException("\"" + fullArenaPath + "\" does not have an Arena executable.");
 	}();
 
+	// The subsystems that don't depend on each other start on their own threads while this
+	// one creates the window, since SDL wants that on the main thread. Each stage returns how
+	// many milliseconds it took.
+	const auto startupStartTime = std::chrono::steady_clock::now();
+	auto startStage = [](std::function<void()> stage)
+	{
+		return std::async(std::launch::async, [stage = std::move(stage)]()
+		{
+			const auto startTime = std::chrono::steady_clock::now();
+			stage();
+			const std::chrono::duration<double, std::milli> duration =
+				std::chrono::steady_clock::now() - startTime;
+			return duration.count();
+		});
+	};
+
+	// Initialize the OpenAL Soft audio manager. This includes loading the MIDI patches.
+	const bool midiPathIsRelative = File::pathIsRelative(this->options.getAudio_MidiConfig());
+	const std::string midiPath = (midiPathIsRelative ? this->basePath : "") +
+		this->options.getAudio_MidiConfig();
+
+	// Options are read here so the stage doesn't share them with this thread.
+	const double musicVolume = this->options.getAudio_MusicVolume();
+	const double soundVolume = this->options.getAudio_SoundVolume();
+	const int soundChannels = this->options.getAudio_SoundChannels();
+	const int soundResampling = this->options.getAudio_SoundResampling();
+	const size_t musicCacheBudget = static_cast<size_t>(
+		this->options.getAudio_MusicCacheMegabytes()) * 1024 * 1024;
+	const int soundLoadResampling = this->options.getAudio_SoundLoadResampling();
+
+	std::future<double> audioStage = startStage([this, musicVolume, soundVolume, soundChannels,
+		soundResampling, midiPath, musicCacheBudget, soundLoadResampling]()
+	{
+		this->audioManager.init(musicVolume, soundVolume, soundChannels, soundResampling,
+			midiPath);
+		this->audioManager.setMusicCacheBudget(musicCacheBudget);
+		this->audioManager.setSoundLoadResampling(soundLoadResampling);
+	});
+
 	// Load various miscellaneous assets.
-	this->miscAssets.init(isFloppyVersion);
+	std::future<double> miscAssetsStage = startStage([this, isFloppyVersion]()
+	{
+		this->miscAssets.init(isFloppyVersion);
+	});
+
+	// Decode the fonts' surfaces. Their textures are still made on this thread when needed.
+	std::future<double> fontsStage = startStage([this]()
+	{
+		this->fontManager.preloadFonts();
+	});
+
+	const auto rendererStartTime = std::chrono::steady_clock::now();
+
+	// Initialize the SDL renderer and window with the given settings.
+	this->renderer.init(this->options.getGraphics_ScreenWidth(),
+		this->options.getGraphics_ScreenHeight(), this->options.getGraphics_Fullscreen(),
+		this->options.getGraphics_LetterboxMode());
+	this->renderer.setOriginalUIScale(this->options.getGraphics_OriginalUIScale());
+
+	// Initialize the texture manager.
+	this->textureManager.init();
+	this->textureManager.setMemoryBudget(static_cast<size_t>(
+		this->options.getMisc_TextureCacheMegabytes()) * 1024 * 1024);
+
+	// Decoded images are only packed on disk if the player opts in.
+	if (this->options.getMisc_ImagePack())
+	{
+		this->textureManager.initImagePack(Platform::getCachePath());
+	}
 
 	// Load and set window icon.
 	const Surface icon = [this]()
@@ -116,6 +216,23 @@ Game::Game()
 
 	this->renderer.setWindowIcon(icon);
 
+	const std::chrono::duration<double, std::milli> rendererTime =
+		std::chrono::steady_clock::now() - rendererStartTime;
+
+	// Everything after this point can use any subsystem. Errors from a stage are rethrown
+	// here.
+	const double audioTime = audioStage.get();
+	const double miscAssetsTime = miscAssetsStage.get();
+	const double fontsTime = fontsStage.get();
+	const std::chrono::duration<double, std::milli> startupTime =
+		std::chrono::steady_clock::now() - startupStartTime;
+
+	DebugLog("Startup took " + String::fixedPrecision(startupTime.count(), 1) +
+		"ms (renderer " + String::fixedPrecision(rendererTime.count(), 1) +
+		"ms, audio " + String::fixedPrecision(audioTime, 1) +
+		"ms, misc assets " + String::fixedPrecision(miscAssetsTime, 1) +
+		"ms, fonts " + String::fixedPrecision(fontsTime, 1) + "ms).");
+
 	// Initialize panel and music to default.
 	this->panel = Panel::defaultPanel(*this);
 	this->setMusic(MusicName::PercIntro);
@@ -123,18 +240,76 @@ Game::Game()
 	// Use a texture as the cursor instead.
 	SDL_ShowCursor(SDL_FALSE);
 
+	// Screenshots and captured frames are written on their own thread.
+	this->screenshotWriter.init(Platform::getScreenshotPath());
+	this->captureFrameCount = 0;
+	this->frozenPanel = nullptr;
+	this->frozenSubPanel = nullptr;
+	this->tickCount = 0;
+	this->tickPercent = 1.0;
+	this->memoryReportSeconds = Game::MEMORY_REPORT_SECONDS; // Made on the first frame.
+	this->memoryDumpSeconds = 0.0;
+	this->metricsSeconds = 0.0;
+	Metrics::addCollector([this]() { this->collectMetrics(); });
+
+	// Frame times that count as hitches, given in milliseconds.
+	const std::vector<double> hitchThresholds = [this]()
+	{
+		std::vector<double> thresholds;
+		for (const std::string &str : String::split(this->options.getMisc_HitchThresholds(), ','))
+		{
+			const std::string trimmed = String::trim(str);
+			if (trimmed.empty())
+			{
+				continue;
+			}
+
+			try
+			{
+				thresholds.push_back(std::stod(trimmed) / 1000.0);
+			}
+			catch (const std::exception&)
+			{
+				DebugLogWarning("Invalid hitch threshold \"" + trimmed + "\".");
+			}
+		}
+
+		return thresholds;
+	}();
+
+	this->fpsCounter.setHitchThresholds(hitchThresholds);
+
+	// Stars are generated in parallel chunks unless the original sequence is wanted.
+	DistantSky::setClassicStarSequence(this->options.getMisc_ClassicStarSequence());
+
+	// Built levels are only cached on disk if the player opts in.
+	if (this->options.getMisc_LevelCache())
+	{
+		LevelCache::setFolder(Platform::getCachePath());
+	}
+
 	// Leave some members null for now. The game data is initialized when the player 
 	// enters the game world, and the "next panel" is a temporary used by the game
 	// to avoid corruption between panel events which change the panel.
 	this->gameData = nullptr;
 	this->nextPanel = nullptr;
 	this->nextSubPanel = nullptr;
+	this->suspendedPanel = nullptr;
+	this->requestedPanelResume = false;
 
 	// This keeps the programmer from deleting a sub-panel the same frame it's in use.
 	// The pop is delayed until the beginning of the next frame.
 	this->requestedSubPanelPop = false;
 }
 
+Game::~Game()
+{
+	Metrics::clearCollectors();
+
+	// Jobs can point into the members (the assets, panels, etc.), so they're finished first.
+	JobSystem::shutdown();
+}
+
 Panel *Game::getActivePanel() const
 {
 	return (this->subPanels.size() > 0) ?
@@ -151,11 +326,21 @@ InputManager &Game::getInputManager()
 	return this->inputManager;
 }
 
+const InputRecording &Game::getInputRecording() const
+{
+	return this->inputRecording;
+}
+
 FontManager &Game::getFontManager()
 {
 	return this->fontManager;
 }
 
+TextBoxCache &Game::getTextBoxCache()
+{
+	return this->textBoxCache;
+}
+
 bool Game::gameDataIsActive() const
 {
 	return this->gameData.get() != nullptr;
@@ -194,6 +379,36 @@ const FPSCounter &Game::getFPSCounter() const
 	return this->fpsCounter;
 }
 
+const FramePacer &Game::getFramePacer() const
+{
+	return this->framePacer;
+}
+
+FrameArena &Game::getFrameArena()
+{
+	return this->frameArena;
+}
+
+const MemoryReport &Game::getMemoryReport() const
+{
+	return this->memoryReport;
+}
+
+QuickSave &Game::getQuickSave()
+{
+	return this->quickSave;
+}
+
+uint64_t Game::getTickCount() const
+{
+	return this->tickCount;
+}
+
+double Game::getTickPercent() const
+{
+	return this->tickPercent;
+}
+
 void Game::setPanel(std::unique_ptr<Panel> nextPanel)
 {
 	this->nextPanel = std::move(nextPanel);
@@ -225,6 +440,7 @@ void Game::setMusic(MusicName name)
 
 void Game::setGameData(std::unique_ptr<GameData> gameData)
 {
+	this->suspendedPanel = nullptr;
 	this->gameData = std::move(gameData);
 }
 
@@ -248,6 +464,9 @@ void Game::initOptions(const std::string &basePath, const std::string &optionsPa
 		// Read in any key-value pairs in the "changes" options file.
 		this->options.loadChanges(changesOptionsPath);
 	}
+
+	Debug::setMinimumType(static_cast<Debug::MessageType>(this->options.getMisc_LogLevel()));
+	Debug::setRateLimit(this->options.getMisc_LogRateLimit());
 }
 
 void Game::resizeWindow(int width, int height)
@@ -258,52 +477,26 @@ void Game::resizeWindow(int width, int height)
 		this->options.getGraphics_ResolutionScale(), fullGameWindow);
 }
 
-void Game::saveScreenshot(const Surface &surface)
-{
-	// Get the path + filename to use for the new screenshot.
-	const std::string screenshotPath = []()
-	{
-		const std::string screenshotFolder = Platform::getScreenshotPath();
-		const std::string screenshotPrefix("screenshot");
-		int imageIndex = 0;
-
-		auto getNextAvailablePath = [&screenshotFolder, &screenshotPrefix, &imageIndex]()
-		{
-			std::stringstream ss;
-			ss << std::setw(3) << std::setfill('0') << imageIndex;
-			imageIndex++;
-			return screenshotFolder + screenshotPrefix + ss.str() + ".bmp";
-		};
-
-		std::string path = getNextAvailablePath();
-		while (File::exists(path))
-		{
-			path = getNextAvailablePath();
-		}
-
-		return path;
-	}();
-
-	const int status = SDL_SaveBMP(surface.get(), screenshotPath.c_str());
-
-	if (status == 0)
-	{
-		DebugLog("Screenshot saved to \"" + screenshotPath + "\".");
-	}
-	else
-	{
-		DebugCrash("Failed to save screenshot to \"" + screenshotPath + "\": " +
-			std::string(SDL_GetError()));
-	}
-}
-
 void Game::handlePanelChanges()
 {
 	// If a sub-panel pop was requested, then pop the top of the sub-panel stack.
 	if (this->requestedSubPanelPop)
 	{
+		// A new sub-panel can be allocated where this one was, so forget its frozen frame.
+		if (this->subPanels.back().get() == this->frozenSubPanel)
+		{
+			this->frozenSubPanel = nullptr;
+		}
+
 		this->subPanels.pop_back();
 		this->requestedSubPanelPop = false;
+
+		// Whatever the sub-panel covered has to be drawn again.
+		this->panel->invalidate();
+		for (auto &subPanel : this->subPanels)
+		{
+			subPanel->invalidate();
+		}
 		
 		// Unpause the panel that is now the top-most one.
 		const bool paused = false;
@@ -324,61 +517,235 @@ void Game::handlePanelChanges()
 	// (i.e., there are no sub-panels), then subsequent events will be sent to it.
 	if (this->nextPanel.get() != nullptr)
 	{
+		// A new suspendable panel takes the place of any kept one.
+		if (!this->requestedPanelResume && this->nextPanel->isSuspendable())
+		{
+			this->suspendedPanel = nullptr;
+		}
+
+		// Keep the old panel for resuming if it allows it. It's paused until then.
+		std::unique_ptr<Panel> oldPanel = std::move(this->panel);
 		this->panel = std::move(this->nextPanel);
+		if ((oldPanel.get() != nullptr) && oldPanel->isSuspendable())
+		{
+			const bool paused = true;
+			oldPanel->onPauseChanged(paused);
+			this->suspendedPanel = std::move(oldPanel);
+		}
+
+		if (this->requestedPanelResume)
+		{
+			// The window might have changed size while it was suspended.
+			const Int2 windowDimensions = this->renderer.getWindowDimensions();
+			this->panel->resize(windowDimensions.x, windowDimensions.y);
+			this->panel->invalidate();
+
+			const bool paused = false;
+			this->panel->onPauseChanged(paused);
+			this->requestedPanelResume = false;
+		}
 	}
 }
 
+int Game::getFrozenSubPanelIndex() const
+{
+	for (int i = 0; i < static_cast<int>(this->subPanels.size()); i++)
+	{
+		if (this->subPanels[i]->usesFrozenBackground())
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+bool Game::isFrozenFrameCurrent(int subPanelIndex) const
+{
+	return (subPanelIndex >= 0) && this->renderer.isFrameFrozen() &&
+		(this->frozenPanel == this->panel.get()) &&
+		(this->frozenSubPanel == this->subPanels[subPanelIndex].get());
+}
+
+bool Game::panelsNeedRender() const
+{
+	// Panels under a frozen background aren't drawn, so their changes don't count.
+	const int frozenIndex = this->getFrozenSubPanelIndex();
+	const bool frozen = this->isFrozenFrameCurrent(frozenIndex);
+	if (!frozen && this->panel->needsRender())
+	{
+		return true;
+	}
+
+	for (int i = frozen ? frozenIndex : 0; i < static_cast<int>(this->subPanels.size()); i++)
+	{
+		if (this->subPanels[i]->needsRender())
+		{
+			return true;
+		}
+	}
+
+	return !frozen && (frozenIndex >= 0);
+}
+
+void Game::handleEvent(const SDL_Event &e, bool &running)
+{
+	// Application events and window resizes are handled here.
+	bool applicationExit = this->inputManager.applicationExit(e);
+	bool resized = this->inputManager.windowResized(e);
+	bool takeScreenshot = this->inputManager.keyPressed(e, SDLK_PRINTSCREEN);
+
+	if (applicationExit)
+	{
+		running = false;
+	}
+
+	if (resized)
+	{
+		int width = e.window.data1;
+		int height = e.window.data2;
+		this->resizeWindow(width, height);
+
+		// Call each panel's resize method. The panels should not be listening for
+		// resize events themselves because it's more of an "application event" than
+		// a panel event.
+		this->panel->resize(width, height);
+
+		for (auto &subPanel : this->subPanels)
+		{
+			subPanel->resize(width, height);
+		}
+	}
+
+	if (takeScreenshot)
+	{
+		// Save a screenshot to the local folder. The file is written in the background.
+		const auto &renderer = this->getRenderer();
+		this->screenshotWriter.addScreenshot(renderer.getScreenshot());
+	}
+
+	// Any event might change what's on screen (the cursor moving, a button being hovered,
+	// the window being exposed), so every visible panel is drawn again.
+	this->panel->invalidate();
+	for (auto &subPanel : this->subPanels)
+	{
+		subPanel->invalidate();
+	}
+
+	// Panel-specific events are handled by the active panel.
+	this->getActivePanel()->handleEvent(e);
+
+	// See if the event requested any changes in active panels.
+	this->handlePanelChanges();
+}
+
 void Game::handleEvents(bool &running)
 {
-	// Handle events for the current game state.
-	SDL_Event e;
-	while (SDL_PollEvent(&e) != 0)
+	ProfilerZone("Events");
+
+	if (this->inputRecording.isReplaying())
+	{
+		// Only quitting is taken from the live events, so a replay can be stopped early.
+		SDL_Event e;
+		while (SDL_PollEvent(&e) != 0)
+		{
+			if (this->inputManager.applicationExit(e))
+			{
+				running = false;
+			}
+		}
+
+		this->inputRecording.replayInput(this->inputManager);
+
+		for (const SDL_Event &replayedEvent : this->inputRecording.getFrameEvents())
+		{
+			this->handleEvent(replayedEvent, running);
+		}
+
+		return;
+	}
+
+	// Sample the input state once SDL has taken in this frame's events so it agrees with
+	// the events handled below.
+	SDL_PumpEvents();
+	this->inputManager.update();
+
+	const bool recording = this->inputRecording.isRecording();
+	if (recording)
 	{
-		// Application events and window resizes are handled here.
-		bool applicationExit = this->inputManager.applicationExit(e);
-		bool resized = this->inputManager.windowResized(e);
-		bool takeScreenshot = this->inputManager.keyPressed(e, SDLK_PRINTSCREEN);
+		this->inputRecording.recordInput(this->inputManager);
+	}
 
-		if (applicationExit)
+	auto dispatchEvent = [this, recording, &running](const SDL_Event &e)
+	{
+		if (recording)
 		{
-			running = false;
+			this->inputRecording.recordEvent(e);
 		}
 
-		if (resized)
+		this->handleEvent(e, running);
+	};
+
+	// Handle events for the current game state. A run of mouse motion events is merged into
+	// one since a fast mouse can send several per frame, and panels only need where it ended
+	// up. Camera turning uses the relative mouse state instead.
+	SDL_Event e;
+	SDL_Event motionEvent;
+	bool hasMotionEvent = false;
+	while (SDL_PollEvent(&e) != 0)
+	{
+		if (isInputEvent(e))
 		{
-			int width = e.window.data1;
-			int height = e.window.data2;
-			this->resizeWindow(width, height);
+			this->inputManager.markInput(e.common.timestamp);
+		}
 
-			// Call each panel's resize method. The panels should not be listening for
-			// resize events themselves because it's more of an "application event" than
-			// a panel event.
-			this->panel->resize(width, height);
+		if (e.type == SDL_MOUSEMOTION)
+		{
+			if (hasMotionEvent && (motionEvent.motion.windowID == e.motion.windowID))
+			{
+				const int xrel = motionEvent.motion.xrel + e.motion.xrel;
+				const int yrel = motionEvent.motion.yrel + e.motion.yrel;
+				motionEvent = e;
+				motionEvent.motion.xrel = xrel;
+				motionEvent.motion.yrel = yrel;
+				continue;
+			}
 
-			for (auto &subPanel : this->subPanels)
+			if (hasMotionEvent)
 			{
-				subPanel->resize(width, height);
+				dispatchEvent(motionEvent);
 			}
+
+			motionEvent = e;
+			hasMotionEvent = true;
+			continue;
 		}
 
-		if (takeScreenshot)
+		// Keep the motion in order with the other events.
+		if (hasMotionEvent)
 		{
-			// Save a screenshot to the local folder.
-			const auto &renderer = this->getRenderer();
-			const Surface screenshot = renderer.getScreenshot();
-			this->saveScreenshot(screenshot);
+			dispatchEvent(motionEvent);
+			hasMotionEvent = false;
 		}
 
-		// Panel-specific events are handled by the active panel.
-		this->getActivePanel()->handleEvent(e);
+		dispatchEvent(e);
+	}
 
-		// See if the event requested any changes in active panels.
-		this->handlePanelChanges();
+	if (hasMotionEvent)
+	{
+		dispatchEvent(motionEvent);
 	}
 }
 
 void Game::tick(double dt)
 {
+	ProfilerZone("Tick");
+
+	this->tickCount++;
+
+	// Let the UI know about a quicksave that finished in the background.
+	this->quickSave.update();
+
 	// Tick the active panel.
 	this->getActivePanel()->tick(dt);
 
@@ -388,13 +755,41 @@ void Game::tick(double dt)
 
 void Game::render()
 {
-	// Draw the panel's main content.
-	this->panel->render(this->renderer);
+	ProfilerZone("Render");
+
+	// Draw the panel's main content and any sub-panels back to front. Everything under a
+	// sub-panel with a frozen background is drawn once and then shown as it was, so the
+	// game world isn't rendered again behind a pop-up.
+	const int frozenIndex = this->getFrozenSubPanelIndex();
+	const int subPanelCount = static_cast<int>(this->subPanels.size());
+	int firstSubPanelIndex = 0;
+	if (frozenIndex < 0)
+	{
+		this->renderer.clearFrozenFrame();
+		this->panel->render(this->renderer);
+	}
+	else if (this->isFrozenFrameCurrent(frozenIndex))
+	{
+		this->renderer.drawFrozenFrame();
+		firstSubPanelIndex = frozenIndex;
+	}
+	else
+	{
+		this->panel->render(this->renderer);
+		for (int i = 0; i < frozenIndex; i++)
+		{
+			this->subPanels[i]->render(this->renderer);
+		}
 
-	// Draw any sub-panels back to front.
-	for (auto &subPanel : this->subPanels)
+		this->renderer.freezeFrame();
+		this->frozenPanel = this->panel.get();
+		this->frozenSubPanel = this->subPanels[frozenIndex].get();
+		firstSubPanelIndex = frozenIndex;
+	}
+
+	for (int i = firstSubPanelIndex; i < subPanelCount; i++)
 	{
-		subPanel->render(this->renderer);
+		this->subPanels[i]->render(this->renderer);
 	}
 
 	// Call the active panel's secondary render method. Secondary render items are those
@@ -415,30 +810,329 @@ void Game::render()
 			this->inputManager.getMousePosition(), this->options.getGraphics_CursorScale());
 	}
 
+	// Capture every Nth frame if continuous capture is on. The frame is dropped instead of
+	// read back when the writer is behind, so rendering doesn't wait on it.
+	const int captureInterval = this->options.getMisc_FrameCaptureInterval();
+	if (captureInterval > 0)
+	{
+		this->captureFrameCount++;
+		if ((this->captureFrameCount >= captureInterval) && !this->screenshotWriter.isFull())
+		{
+			this->captureFrameCount = 0;
+			this->screenshotWriter.addCapture(this->renderer.getScreenshot());
+		}
+	}
+
 	this->renderer.present();
+
+	// Measure how long the oldest input since the last frame took to get on screen.
+	double inputLatency;
+	if (this->inputManager.finishInputLatency(SDL_GetTicks(), &inputLatency))
+	{
+		this->fpsCounter.updateInputLatency(inputLatency);
+	}
+
+	this->panel->clearInvalidated();
+	for (auto &subPanel : this->subPanels)
+	{
+		subPanel->clearInvalidated();
+	}
+}
+
+std::string Game::exportFrameStats(const std::string &name)
+{
+	const std::string logPath = Platform::getLogPath();
+	if (!Platform::directoryExists(logPath))
+	{
+		Platform::createDirectoryRecursively(logPath);
+	}
+
+	const bool json = this->options.getMisc_FrameStatsFormat() == 1;
+	const std::string filename = logPath + name + (json ? ".json" : ".csv");
+	this->fpsCounter.exportStats(filename, json);
+	return filename;
+}
+
+void Game::exportReplayStats()
+{
+	const std::string filename = this->exportFrameStats("replay-stats");
+	DebugLog("Saved replay frame stats to \"" + filename + "\".");
+}
+
+void Game::finishBenchmark()
+{
+	const FPSCounter::Stats stats = this->fpsCounter.getStats();
+	const double averageFPS = (stats.seconds > 0.0) ?
+		(static_cast<double>(stats.frameCount) / stats.seconds) : 0.0;
+
+	DebugLog("Benchmark \"" + this->benchmark.getScenarioName() + "\": " +
+		std::to_string(stats.frameCount) + " frames, " +
+		String::fixedPrecision(averageFPS, 1) + " FPS average, " +
+		String::fixedPrecision(stats.low1Percent, 1) + " 1% low, " +
+		String::fixedPrecision(stats.low01Percent, 1) + " 0.1% low, p50/p95/p99 " +
+		String::fixedPrecision(stats.p50 * 1000.0, 2) + "/" +
+		String::fixedPrecision(stats.p95 * 1000.0, 2) + "/" +
+		String::fixedPrecision(stats.p99 * 1000.0, 2) + " ms.");
+
+	const std::string filename = this->exportFrameStats("benchmark-stats");
+	DebugLog("Saved benchmark frame stats to \"" + filename + "\".");
+}
+
+bool Game::shouldTuneRenderThreads() const
+{
+	// Benchmarks and replays should measure the count they were started with.
+	const bool isAutoMode =
+		this->options.getGraphics_RenderThreadsMode() == Options::AUTO_RENDER_THREADS_MODE;
+	const bool needsCount = this->renderThreadTuner.isRunning() ||
+		(this->options.getGraphics_RenderThreadsAutoCount() == 0);
+	return isAutoMode && needsCount && this->gameDataIsActive() && this->subPanels.empty() &&
+		!this->benchmark.isRunning() && !this->inputRecording.isReplaying();
+}
+
+void Game::updateMemoryReport(double dt)
+{
+	this->memoryReportSeconds += dt;
+	this->memoryDumpSeconds += dt;
+
+	const int dumpInterval = this->options.getMisc_MemoryReportInterval();
+	const bool dumping = (dumpInterval > 0) &&
+		(this->memoryDumpSeconds >= static_cast<double>(dumpInterval));
+	const bool refreshing = this->options.getMisc_ShowDebug() &&
+		(this->memoryReportSeconds >= Game::MEMORY_REPORT_SECONDS);
+	if (!dumping && !refreshing)
+	{
+		return;
+	}
+
+	this->refreshMemoryReport();
+
+	if (!dumping)
+	{
+		return;
+	}
+
+	this->memoryDumpSeconds = 0.0;
+
+	const std::string logPath = Platform::getLogPath();
+	if (!Platform::directoryExists(logPath))
+	{
+		Platform::createDirectoryRecursively(logPath);
+	}
+
+	const double totalMegabytes =
+		static_cast<double>(this->memoryReport.getTotalBytes()) / (1024.0 * 1024.0);
+	const std::string filename = logPath + "memory-report.txt";
+	std::ofstream ofs(filename, std::ios::app);
+	if (!ofs.is_open())
+	{
+		DebugLogWarning("Could not open \"" + filename + "\" for writing.");
+		return;
+	}
+
+	ofs << "Tick " << this->tickCount << ":\n" << this->memoryReport.toString() << '\n';
+
+	// The biggest few are usually all that's interesting.
+	const std::vector<MemoryReport::Entry> &entries = this->memoryReport.getEntries();
+	std::string biggest;
+	for (size_t i = 0; i < std::min<size_t>(entries.size(), 3); i++)
+	{
+		biggest += ((i > 0) ? ", " : "") + entries[i].name + " " + String::fixedPrecision(
+			static_cast<double>(entries[i].bytes) / (1024.0 * 1024.0), 2) + " MB";
+	}
+
+	DebugLog("Memory: " + String::fixedPrecision(totalMegabytes, 2) + " MB (" + biggest + ").");
+}
+
+void Game::refreshMemoryReport()
+{
+	this->memoryReportSeconds = 0.0;
+	this->memoryReport.clear();
+	this->textureManager.reportMemory(this->memoryReport);
+	this->renderer.reportMemory(this->memoryReport);
+	this->audioManager.reportMemory(this->memoryReport);
+	this->miscAssets.reportMemory(this->memoryReport);
+	this->memoryReport.add("Game/Frame arena", this->frameArena.getCapacity());
+
+	if (this->gameDataIsActive())
+	{
+		const LevelData &level = this->gameData->getWorldData().getActiveLevel();
+		this->memoryReport.add("World/Voxel grid", level.getVoxelGrid().getByteCount());
+	}
+}
+
+void Game::collectMetrics()
+{
+	const FPSCounter::Stats frameStats = this->fpsCounter.getStats();
+	const std::string frameHelp = "Frame time percentiles in seconds since the last reset.";
+	const std::string frameName = "opentesarena_frame_seconds";
+	Metrics::getGauge(frameName + "{quantile=\"0.5\"}", frameHelp).set(frameStats.p50);
+	Metrics::getGauge(frameName + "{quantile=\"0.95\"}", frameHelp).set(frameStats.p95);
+	Metrics::getGauge(frameName + "{quantile=\"0.99\"}", frameHelp).set(frameStats.p99);
+	Metrics::getGauge("opentesarena_fps", "Frames per second.").set(this->fpsCounter.getFPS());
+	Metrics::getGauge("opentesarena_fps_low{percent=\"1\"}",
+		"Average FPS of the slowest frames since the last reset.").set(frameStats.low1Percent);
+	Metrics::getGauge("opentesarena_input_latency_seconds",
+		"Average time from input to the frame showing it being presented.").set(
+		this->fpsCounter.getAverageInputLatency());
+
+	// Phases that haven't run recently are zero, which is still worth seeing.
+	const RenderTimings &renderTimings = this->renderer.getRenderTimings();
+	for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+	{
+		const RenderTimings::Phase phase = static_cast<RenderTimings::Phase>(i);
+		const RenderTimings::Stats stats = renderTimings.getStats(phase);
+		Metrics::getGauge("opentesarena_render_phase_p99_seconds{phase=\"" +
+			RenderTimings::getPhaseName(phase) + "\"}",
+			"99th percentile of each render phase over recent frames.").set(stats.p99);
+	}
+
+	this->refreshMemoryReport();
+	for (const MemoryReport::Entry &entry : this->memoryReport.getEntries())
+	{
+		Metrics::getGauge("opentesarena_memory_bytes{name=\"" + entry.name + "\"}",
+			"Bytes held by each subsystem's big buffers.").set(
+			static_cast<double>(entry.bytes));
+	}
+
+	const TextureManager::CacheStats &cacheStats = this->textureManager.getCacheStats();
+	Metrics::getCounter("opentesarena_texture_cache_hits_total",
+		"Texture lookups that were already loaded.").setTotal(cacheStats.hitCount);
+	Metrics::getCounter("opentesarena_texture_cache_misses_total",
+		"Texture lookups that had to be loaded.").setTotal(cacheStats.missCount);
+	Metrics::getCounter("opentesarena_texture_cache_evictions_total",
+		"Textures freed to stay under the cache budget.").setTotal(cacheStats.evictionCount);
+	Metrics::getCounter("opentesarena_texture_cache_compressions_total",
+		"Surfaces compressed after going unused.").setTotal(cacheStats.compressionCount);
+	Metrics::getGauge("opentesarena_texture_cache_cold_bytes",
+		"Bytes of compressed surfaces.").set(static_cast<double>(cacheStats.coldBytes));
+	Metrics::getGauge("opentesarena_texture_cache_resident_bytes",
+		"Bytes of textures loaded.").set(static_cast<double>(cacheStats.residentBytes));
+
+	// What happened each time a sound asked for a channel from the voice pool.
+	const AudioManager::SoundStats &soundStats = this->audioManager.getSoundStats();
+	const std::array<std::pair<const char*, int>, 4> soundResults =
+	{
+		{
+			{ "played", soundStats.playedCount },
+			{ "dropped", soundStats.droppedCount },
+			{ "stolen", soundStats.stolenCount },
+			{ "culled", soundStats.culledCount }
+		}
+	};
+
+	for (const auto &pair : soundResults)
+	{
+		Metrics::getCounter("opentesarena_sounds_total{result=\"" + std::string(pair.first) +
+			"\"}", "Sounds by what happened when they asked for a channel.").setTotal(
+			static_cast<uint64_t>(pair.second));
+	}
+
+	const AudioManager::MusicStats musicStats = this->audioManager.getMusicStats();
+	Metrics::getCounter("opentesarena_music_underruns_total",
+		"Times the music source ran out of queued audio.").setTotal(
+		static_cast<uint64_t>(musicStats.underrunCount));
+}
+
+std::string Game::saveMetrics()
+{
+	const std::string logPath = Platform::getLogPath();
+	if (!Platform::directoryExists(logPath))
+	{
+		Platform::createDirectoryRecursively(logPath);
+	}
+
+	const std::string filename = logPath + "metrics.prom";
+	return Metrics::save(filename) ? filename : std::string();
+}
+
+void Game::tuneRenderThreads(double renderSeconds)
+{
+	if (!this->renderThreadTuner.isRunning())
+	{
+		// This frame was drawn with the old count, so it's only used to start.
+		this->renderThreadTuner.start();
+		this->renderer.setAutoRenderThreadCount(this->renderThreadTuner.getThreadCount());
+		return;
+	}
+
+	if (!this->renderThreadTuner.update(renderSeconds))
+	{
+		return;
+	}
+
+	if (this->renderThreadTuner.isRunning())
+	{
+		this->renderer.setAutoRenderThreadCount(this->renderThreadTuner.getThreadCount());
+	}
+	else
+	{
+		const int threadCount = this->renderThreadTuner.getBestThreadCount();
+		this->options.setGraphics_RenderThreadsAutoCount(threadCount);
+		this->options.saveChanges();
+		this->renderer.setAutoRenderThreadCount(threadCount);
+		DebugLog("Using " + std::to_string(threadCount) + " render thread(s).");
+	}
+}
+
+bool Game::startBenchmark(const std::string &scenarioName)
+{
+	if (!this->benchmark.start(scenarioName, *this))
+	{
+		return false;
+	}
+
+	// Switch to the game world panel now instead of after the first event.
+	this->handlePanelChanges();
+	return true;
+}
+
+void Game::recordInput(const std::string &filename)
+{
+	const Int2 windowDimensions = this->renderer.getWindowDimensions();
+	this->inputRecording.startRecording(filename, this->options.getMisc_TickRate(),
+		this->options.getMisc_TimeScale(), windowDimensions.x, windowDimensions.y);
+}
+
+bool Game::replayInput(const std::string &filename)
+{
+	const Int2 windowDimensions = this->renderer.getWindowDimensions();
+	return this->inputRecording.startReplay(filename, windowDimensions.x, windowDimensions.y);
 }
 
 void Game::loop()
 {
 	// Nanoseconds per second. Only using this much precision because it's what
-	// high_resolution_clock gives back. Microseconds would be fine too.
+	// steady_clock gives back. Microseconds would be fine too.
 	constexpr int64_t timeUnits = 1000000000;
 
 	// Longest allowed frame time.
 	const std::chrono::duration<int64_t, std::nano> maxFrameTime(timeUnits / Options::MIN_FPS);
 
-	// On some platforms, thread sleeping takes longer than it should, so include a value to
-	// help compensate.
-	std::chrono::nanoseconds sleepBias(0);
+	// Frame time not yet simulated when ticking at a fixed rate.
+	std::chrono::nanoseconds tickAccumulator(0);
+
+	// Steady so the frame pacer's deadlines aren't moved by wall clock changes.
+	auto thisTime = FramePacer::Clock::now();
 
-	auto thisTime = std::chrono::high_resolution_clock::now();
+	Profiler::setThreadName("Main");
+
+	// Whether the last frame had nothing new to draw, so this one can wait for input.
+	bool wasIdle = false;
+
+	// When the audio manager was last updated, for updating it less often in the background.
+	auto lastAudioTime = thisTime;
 
 	// Primary game loop.
 	bool running = true;
 	while (running)
 	{
+		ProfilerZone("Frame");
+
+		// Nothing from the last frame's arena allocations is used anymore.
+		this->frameArena.reset();
+
 		const auto lastTime = thisTime;
-		thisTime = std::chrono::high_resolution_clock::now();
+		thisTime = FramePacer::Clock::now();
 
 		// Shortest allowed frame time.
 		const std::chrono::duration<int64_t, std::nano> minFrameTime(
@@ -446,37 +1140,102 @@ void Game::loop()
 
 		// Delay the current frame if the previous one was too fast.
 		auto frameTime = thisTime - lastTime;
-		if (frameTime < minFrameTime)
-		{
-			const auto sleepTime = minFrameTime - frameTime + sleepBias;
 
-			std::this_thread::sleep_for(sleepTime);
+		// Time spent on the previous frame before any sleeping.
+		const auto busyTime = frameTime;
 
-			// Compensate for sleeping too long. Thread sleeping has questionable accuracy.
-			const auto tempTime = std::chrono::high_resolution_clock::now();
-			const auto unnecessarySleepTime = [thisTime, sleepTime, tempTime]()
-			{
-				const auto tempFrameTime = tempTime - thisTime;
-				return tempFrameTime - sleepTime;
-			}();
+		// While the window is unfocused or minimized, frames are throttled to the background
+		// frame rate, or the game is paused if it's zero. Replays and benchmarks always run
+		// at full speed.
+		const bool inBackground = this->renderer.isWindowInBackground() &&
+			!this->inputRecording.isReplaying() && !this->benchmark.isRunning();
+		const int backgroundFPS = this->options.getGraphics_BackgroundFPS();
+		const std::chrono::milliseconds backgroundAudioInterval(
+			this->options.getAudio_BackgroundUpdateInterval());
+		const bool paused = inBackground && (backgroundFPS == 0);
 
-			sleepBias = -unnecessarySleepTime;
-			thisTime = tempTime;
+		if (inBackground)
+		{
+			// A paused game still wakes up for audio updates and focus changes.
+			const std::chrono::nanoseconds backgroundFrameTime = (backgroundFPS > 0) ?
+				std::chrono::nanoseconds(timeUnits / backgroundFPS) :
+				std::chrono::duration_cast<std::chrono::nanoseconds>(backgroundAudioInterval);
+
+			if (frameTime < backgroundFrameTime)
+			{
+				this->framePacer.waitUntil(lastTime + backgroundFrameTime);
+				thisTime = FramePacer::Clock::now();
+				frameTime = thisTime - lastTime;
+			}
+		}
+		else if (wasIdle)
+		{
+			// Nothing on screen changed last frame, so sleep until there's input instead of
+			// drawing the same frame again. The event stays queued for handleEvents().
+			SDL_WaitEventTimeout(nullptr, Game::IDLE_WAIT_MILLISECONDS);
+			thisTime = FramePacer::Clock::now();
+			frameTime = thisTime - lastTime;
+		}
+		else if ((frameTime < minFrameTime) && !this->benchmark.isRunning())
+		{
+			// Benchmarks run unlimited so they measure the hardware rather than the limit.
+			this->framePacer.waitUntil(lastTime + minFrameTime);
+			thisTime = FramePacer::Clock::now();
 			frameTime = thisTime - lastTime;
 		}
 
 		// Clamp the delta time to at most the maximum frame time.
 		const double dt = std::fmin(frameTime.count(), maxFrameTime.count()) /
 			static_cast<double>(timeUnits);
+		const double busyDt = std::fmin(busyTime.count(), maxFrameTime.count()) /
+			static_cast<double>(timeUnits);
+
+		// A replay steps the game by the recorded frame times so it reaches the same states,
+		// though the frame times it measures are its own.
+		double gameDt = dt;
+		ArenaRandom *arenaRandom = this->gameDataIsActive() ?
+			&this->gameData->getRandom() : nullptr;
+		if (this->inputRecording.isReplaying())
+		{
+			if (!this->inputRecording.nextFrame())
+			{
+				this->exportReplayStats();
+				break;
+			}
 
-		// Update the input manager's state.
-		this->inputManager.update();
+			this->inputRecording.checkRandom(arenaRandom);
+			gameDt = this->inputRecording.getFrameDt();
+		}
+		else if (this->inputRecording.isRecording())
+		{
+			this->inputRecording.beginFrame(dt, arenaRandom);
+		}
 
 		// Update the audio manager, checking for finished sounds.
-		this->audioManager.update();
+		if (!inBackground || ((thisTime - lastAudioTime) >= backgroundAudioInterval))
+		{
+			this->audioManager.update();
+			lastAudioTime = thisTime;
+		}
+
+		// Update FPS counter. Frames after idle or background ones are left out since their
+		// time is mostly waiting.
+		if (!wasIdle && !inBackground)
+		{
+			const double unclampedDt = static_cast<double>(frameTime.count()) /
+				static_cast<double>(timeUnits);
+			this->fpsCounter.updateFrameTime(dt, busyDt, unclampedDt);
+		}
 
-		// Update FPS counter.
-		this->fpsCounter.updateFrameTime(dt);
+		// Append the frame stats to the log folder every so often, then start them over. A
+		// benchmark keeps its stats for the whole run.
+		const int frameStatsInterval = this->options.getMisc_FrameStatsInterval();
+		if ((frameStatsInterval > 0) && !this->benchmark.isRunning() &&
+			(this->fpsCounter.getStatsSeconds() >= static_cast<double>(frameStatsInterval)))
+		{
+			this->exportFrameStats("frame-stats");
+			this->fpsCounter.resetStats();
+		}
 
 		// Listen for input events.
 		try
@@ -488,32 +1247,126 @@ void Game::loop()
 			DebugCrash("handleEvents() exception! " + std::string(e.what()));
 		}
 
+		// A paused game keeps its last frame on screen and is only listening for events.
+		if (paused)
+		{
+			continue;
+		}
+
 		// Animate the current game state by delta time.
 		try
 		{
 			// Multiply delta time by the time scale. I settled on having the effects of this
 			// be application-wide rather than just in the game world since it's intended to
 			// simulate lower DOSBox cycles.
-			const double timeScaledDt = dt * this->options.getMisc_TimeScale();
-			this->tick(timeScaledDt);
+			const bool replaying = this->inputRecording.isReplaying();
+			const double timeScale = replaying ?
+				this->inputRecording.getTimeScale() : this->options.getMisc_TimeScale();
+			const int tickRate = replaying ?
+				this->inputRecording.getTickRate() : this->options.getMisc_TickRate();
+			if (tickRate > 0)
+			{
+				// Run as many fixed ticks as the frame time covers. The frame time is
+				// already clamped, so a long frame can't cause a burst of catch-up ticks.
+				const std::chrono::nanoseconds tickTime(timeUnits / tickRate);
+				const double tickDt = static_cast<double>(tickTime.count()) /
+					static_cast<double>(timeUnits);
+				tickAccumulator += std::chrono::nanoseconds(static_cast<int64_t>(
+					gameDt * static_cast<double>(timeUnits)));
+
+				while (running && (tickAccumulator >= tickTime))
+				{
+					this->tick(tickDt * timeScale);
+					this->inputManager.clearMouseDelta();
+					tickAccumulator -= tickTime;
+				}
+
+				this->tickPercent = static_cast<double>(tickAccumulator.count()) /
+					static_cast<double>(tickTime.count());
+			}
+			else
+			{
+				tickAccumulator = std::chrono::nanoseconds(0);
+				this->tick(gameDt * timeScale);
+				this->inputManager.clearMouseDelta();
+				this->tickPercent = 1.0;
+			}
 		}
 		catch (const std::exception &e)
 		{
 			DebugCrash("tick() exception! " + std::string(e.what()));
 		}
 
-		// Draw to the screen.
-		try
+		// Move the benchmark camera after the tick so the panel's movement doesn't override it.
+		if (this->benchmark.isRunning())
 		{
-			this->render();
+			const bool wasWarmingUp = this->benchmark.isWarmingUp();
+			this->benchmark.update(dt, *this);
+
+			if (wasWarmingUp && !this->benchmark.isWarmingUp())
+			{
+				// Only count frames from the start of the path.
+				this->fpsCounter.resetStats();
+			}
+			else if (!this->benchmark.isRunning())
+			{
+				this->finishBenchmark();
+				running = false;
+			}
 		}
-		catch (const std::exception &e)
+
+		// Upload any textures that finished decoding in the background. Done once per frame
+		// rather than per tick since it also advances the texture cache's frame count.
+		this->textureManager.update(this->renderer);
+		this->updateMemoryReport(dt);
+
+		const int metricsInterval = this->options.getMisc_MetricsInterval();
+		this->metricsSeconds += dt;
+		if ((metricsInterval > 0) && (this->metricsSeconds >= static_cast<double>(metricsInterval)))
 		{
-			DebugCrash("render() exception! " + std::string(e.what()));
+			this->metricsSeconds = 0.0;
+			this->saveMetrics();
+		}
+
+		// Draw to the screen, unless every visible panel is static and unchanged. A replay
+		// never waits for input since its events are already known.
+		const bool needsRender = this->panelsNeedRender();
+		wasIdle = !needsRender && !this->inputRecording.isReplaying();
+		if (needsRender)
+		{
+			try
+			{
+				// Take in mouse motion from while the frame was ticking, so the view drawn
+				// is as recent as it can be. Replays only use recorded input.
+				if (!this->inputRecording.isReplaying())
+				{
+					this->inputManager.sampleMouseDelta();
+				}
+
+				const bool tuning = this->shouldTuneRenderThreads();
+				const auto renderStartTime = std::chrono::steady_clock::now();
+				this->render();
+
+				if (tuning)
+				{
+					const std::chrono::duration<double> renderTime =
+						std::chrono::steady_clock::now() - renderStartTime;
+					this->tuneRenderThreads(renderTime.count());
+				}
+			}
+			catch (const std::exception &e)
+			{
+				DebugCrash("render() exception! " + std::string(e.what()));
+			}
 		}
 	}
 
 	// At this point, the program has received an exit signal, and is now 
 	// quitting peacefully.
+	if (this->inputRecording.isRecording())
+	{
+		this->inputRecording.stopRecording();
+	}
+
 	this->options.saveChanges();
 }
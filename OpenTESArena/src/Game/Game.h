@@ -1,20 +1,30 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "Benchmark.h"
 #include "GameData.h"
 #include "InputManager.h"
+#include "InputRecording.h"
 #include "Options.h"
+#include "QuickSave.h"
+#include "RenderThreadTuner.h"
 #include "../Assets/MiscAssets.h"
 #include "../Interface/FPSCounter.h"
 #include "../Interface/Panel.h"
+#include "../Interface/TextBoxCache.h"
 #include "../Media/AudioManager.h"
 #include "../Media/FontManager.h"
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
+#include "../Rendering/ScreenshotWriter.h"
+#include "../Utilities/FrameArena.h"
+#include "../Utilities/MemoryReport.h"
+#include "../Utilities/FramePacer.h"
 
 // This class holds the current game data, manages the primary game loop, and 
 // updates the game state each frame.
@@ -39,32 +49,57 @@ private:
 
 	AudioManager audioManager;
 	InputManager inputManager;
+	InputRecording inputRecording;
 	FontManager fontManager;
 	std::unique_ptr<GameData> gameData;
 	Options options;
 	std::unique_ptr<Panel> panel, nextPanel, nextSubPanel;
+	std::unique_ptr<Panel> suspendedPanel; // Replaced panel kept for resuming, if any.
 	Renderer renderer;
 	TextureManager textureManager;
+	TextBoxCache textBoxCache; // After the renderer so its textures are freed first.
 	MiscAssets miscAssets;
 	FPSCounter fpsCounter;
+	FramePacer framePacer;
+	FrameArena frameArena;
+	MemoryReport memoryReport;
+	ScreenshotWriter screenshotWriter;
+	QuickSave quickSave;
+	Benchmark benchmark;
+	RenderThreadTuner renderThreadTuner;
 	std::string basePath, optionsPath;
+	int captureFrameCount; // Frames since the last captured frame.
+	uint64_t tickCount; // Ticks since startup.
+	double tickPercent; // How far the rendered frame is between the last tick and the next.
+	double memoryReportSeconds, memoryDumpSeconds; // Since the memory report was last made/saved.
+	double metricsSeconds; // Since the metrics were last saved.
+	const Panel *frozenPanel, *frozenSubPanel; // Panels the renderer's frozen frame is for.
 	bool requestedSubPanelPop;
+	bool requestedPanelResume; // Whether the next panel is the suspended one.
 
 	// Gets the top-most sub-panel if one exists, or the main panel if no sub-panels exist.
 	Panel *getActivePanel() const;
 
+	// Gets the index of the lowest sub-panel that uses a frozen background, or -1 if none.
+	int getFrozenSubPanelIndex() const;
+
+	// Returns whether the renderer's frozen frame shows what's under the given sub-panel.
+	bool isFrozenFrameCurrent(int subPanelIndex) const;
+
 	void initOptions(const std::string &basePath, const std::string &optionsPath);
 
 	// Resizes the SDL renderer and any other renderer-associated components.
 	void resizeWindow(int width, int height);
 
-	// Saves the given surface as a BMP file in the screenshots folder at the lowest
-	// available index.
-	void saveScreenshot(const Surface &surface);
-
 	// Handles any changes in panels after an SDL event or game tick.
 	void handlePanelChanges();
 
+	// Returns whether any visible panel has changed since it was last drawn.
+	bool panelsNeedRender() const;
+
+	// Handles one SDL event, live or replayed.
+	void handleEvent(const SDL_Event &e, bool &running);
+
 	// Handles SDL events for the current frame.
 	void handleEvents(bool &running);
 
@@ -73,10 +108,47 @@ private:
 
 	// Runs the current panel's render method for drawing to the screen.
 	void render();
+
+	// How long an idle frame waits for an event before the loop goes on anyway, so the
+	// audio manager still gets updated.
+	static const int IDLE_WAIT_MILLISECONDS;
+
+	// Seconds between memory report updates while the debug overlay is showing.
+	static const double MEMORY_REPORT_SECONDS;
+
+	// Writes the frame stats since the last reset to the given file in the log folder, using
+	// the frame stats format option for the extension. Returns the path written to.
+	std::string exportFrameStats(const std::string &name);
+
+	// Writes the frame stats of a finished replay to the log folder.
+	void exportReplayStats();
+
+	// Prints and writes the frame stats of a finished benchmark.
+	void finishBenchmark();
+
+	// Returns whether this frame's render time should go to the render thread tuner. Only
+	// plain game world frames are measured, and only while the auto mode has no count yet.
+	bool shouldTuneRenderThreads() const;
+
+	// Gives the render thread tuner a frame's render time, switching render thread counts
+	// as needed and saving the best one once it's found.
+	void tuneRenderThreads(double renderSeconds);
+
+	// Asks each subsystem for the memory it holds every so often, and appends the report
+	// to the log folder at the memory report interval.
+	void updateMemoryReport(double dt);
+
+	// Asks each subsystem for the memory it holds.
+	void refreshMemoryReport();
+
+	// Sets the metrics that are read from other stats (frame times, render phases, caches,
+	// etc.). Run before each metrics snapshot.
+	void collectMetrics();
 public:
 	Game();
 	Game(const Game&) = delete;
 	Game(Game&&) = delete;
+	~Game();
 
 	Game &operator=(const Game&) = delete;
 	Game &operator=(Game&&) = delete;
@@ -88,9 +160,16 @@ public:
 	// all classes except the Game class.
 	InputManager &getInputManager();
 
+	// Gets the input recording, which panels check so they stay deterministic while it's
+	// recording or replaying.
+	const InputRecording &getInputRecording() const;
+
 	// Gets the font manager object for creating text with.
 	FontManager &getFontManager();
 
+	// Gets the cache of text boxes for text that's shown repeatedly.
+	TextBoxCache &getTextBoxCache();
+
 	// Determines if a game session is currently running. This is true when a player
 	// is loaded into memory.
 	bool gameDataIsActive() const;
@@ -114,6 +193,32 @@ public:
 	// Gets the frames-per-second counter. This is updated in the game loop.
 	const FPSCounter &getFPSCounter() const;
 
+	// Gets the frame limiter, for how precisely it's keeping to the target FPS.
+	const FramePacer &getFramePacer() const;
+
+	// Gets the memory for things that only last until the end of the frame. It's reset at
+	// the start of each frame.
+	FrameArena &getFrameArena();
+
+	// Gets the most recent memory report. It's only kept up to date while the debug overlay
+	// is showing or the memory report interval option is set.
+	const MemoryReport &getMemoryReport() const;
+
+	// Writes the current metrics to the log folder. Returns the path written to, or empty
+	// if it couldn't be written.
+	std::string saveMetrics();
+
+	// Gets the quicksave writer and reader.
+	QuickSave &getQuickSave();
+
+	// Gets the number of ticks so far, including the one in progress. Panels can compare
+	// it against the count from their own last tick to see if they were the last to tick.
+	uint64_t getTickCount() const;
+
+	// Gets how far (0 to 1) the current frame is from the last tick toward the next one,
+	// for interpolating state when ticks run at a fixed rate. Always 1 otherwise.
+	double getTickPercent() const;
+
 	// Sets the panel after the current SDL event has been processed (to avoid 
 	// interfering with the current panel). This uses template parameters for
 	// convenience (to avoid writing a unique_ptr at each callsite).
@@ -128,6 +233,23 @@ public:
 	// calculations, etc.).
 	void setPanel(std::unique_ptr<Panel> nextPanel);
 
+	// Returns to the suspended panel if it's a T (see Panel::isSuspendable()), otherwise
+	// sets a new T like setPanel(). Menus opened from the game world use this to get back
+	// to it without rebuilding it.
+	template <class T, typename... Args>
+	void resumePanel(Args&&... args)
+	{
+		if (dynamic_cast<T*>(this->suspendedPanel.get()) != nullptr)
+		{
+			this->nextPanel = std::move(this->suspendedPanel);
+			this->requestedPanelResume = true;
+		}
+		else
+		{
+			this->setPanel<T>(std::forward<Args>(args)...);
+		}
+	}
+
 	// Adds a new sub-panel after the current SDL event has been processed (to avoid
 	// adding multiple pop-ups from the same panel or sub-panel). This uses template 
 	// parameters for convenience (to avoid writing a unique_ptr at each callsite).
@@ -153,9 +275,23 @@ public:
 	void setMusic(MusicName name);
 
 	// Sets the current game data object. A game session is active if the game data
-	// is not null.
+	// is not null. Any suspended panel is for the old session, so it's destroyed.
 	void setGameData(std::unique_ptr<GameData> gameData);
 
+	// Records the input of every frame of the game loop, saving it to the given file when
+	// the loop ends. This must be called before loop().
+	void recordInput(const std::string &filename);
+
+	// Replays recorded input instead of SDL's, exporting the frame stats and ending the loop
+	// when it's done. This must be called before loop(). Returns false if the recording
+	// can't be read.
+	bool replayInput(const std::string &filename);
+
+	// Loads the given built-in benchmark scenario and runs its camera path with no frame
+	// limit, then prints and exports the frame stats and ends the loop. This must be called
+	// before loop(). Returns false if there's no such scenario.
+	bool startBenchmark(const std::string &scenarioName);
+
 	// Initial method for starting the game loop. This must only be called by main().
 	void loop();
 };
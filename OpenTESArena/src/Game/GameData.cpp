@@ -1,7 +1,9 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <tuple>
+#include <type_traits>
 
 #include "SDL.h"
 
@@ -28,6 +30,7 @@
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/Metrics.h"
 #include "../Utilities/String.h"
 #include "../World/ClimateType.h"
 #include "../World/ExteriorWorldData.h"
@@ -51,9 +54,55 @@ namespace
 		{ WeatherType::Overcast2, 30.0 },
 		{ WeatherType::SnowOvercast2, 20.0 }
 	};
+
+	// Locations are written to snapshots as raw bytes.
+	static_assert(std::is_trivially_copyable<Location>::value,
+		"Location must be trivially copyable for snapshots.");
+
+	// Start of every snapshot. Followed by the source .MIF name, the entered interior's .MIF
+	// name, the active interior level's voxel IDs, and then the open doors.
+	struct SnapshotHeader
+	{
+		uint32_t magic, version;
+		int32_t year, month, day;
+		int32_t hours, minutes, seconds;
+		double fractionOfSecond;
+		uint32_t randomSeed;
+		std::array<int32_t, 36> weathers;
+		uint8_t location[sizeof(Location)];
+		int32_t sourceType, sourceLocalID, sourceProvinceID;
+		int32_t wildBlockX, wildBlockY;
+		std::array<int32_t, 4> rmdIDs;
+		int32_t starCount, sourceWeatherType, isArtifactDungeon;
+		int32_t hasInterior, returnVoxelX, returnVoxelY, levelIndex;
+		double playerX, playerY, playerZ;
+		double directionX, directionY, directionZ;
+		uint32_t sourceMifNameSize, interiorMifNameSize;
+		uint32_t gridWidth, gridHeight, gridDepth; // Zero if the active level isn't an interior.
+		uint32_t doorCount;
+	};
+
+	struct SnapshotDoor
+	{
+		int32_t x, y;
+		double percentOpen;
+		int32_t direction, padding;
+	};
+
+	const uint32_t SnapshotMagic = 0x50414E53; // "SNAP".
+
+	// Gets the histogram of how long loading each kind of level takes, from the start of
+	// generating it to it being active in the renderer.
+	Metrics::Histogram &getLevelLoadHistogram(const char *levelType)
+	{
+		return Metrics::getHistogram("opentesarena_level_load_seconds{type=\"" +
+			std::string(levelType) + "\"}", "Seconds to generate a level and make it active.",
+			Metrics::DEFAULT_SECONDS_BUCKETS);
+	}
 }
 
-GameData::TimedTextBox::TimedTextBox(double remainingDuration, std::unique_ptr<TextBox> textBox)
+GameData::TimedTextBox::TimedTextBox(double remainingDuration,
+	std::shared_ptr<const TextBox> textBox)
 	: textBox(std::move(textBox))
 {
 	this->remainingDuration = remainingDuration;
@@ -79,6 +128,21 @@ const double GameData::TIME_SCALE = static_cast<double>(Clock::SECONDS_IN_A_DAY)
 
 const double GameData::DEFAULT_INTERIOR_FOG_DIST = 25.0;
 
+GameData::WorldSource::WorldSource()
+{
+	this->type = WorldSource::Type::None;
+	this->localID = 0;
+	this->provinceID = 0;
+	this->wildBlockX = 0;
+	this->wildBlockY = 0;
+	this->rmdIDs.fill(0);
+	this->starCount = 0;
+	this->weatherType = WeatherType::Clear;
+	this->isArtifactDungeon = false;
+}
+
+const uint32_t GameData::SNAPSHOT_VERSION = 1;
+
 GameData::GameData(Player &&player, const MiscAssets &miscAssets)
 	: player(std::move(player))
 {
@@ -133,11 +197,11 @@ GameData::~GameData()
 
 std::string GameData::getDateString(const Date &date, const ExeData &exeData)
 {
-	std::string text = exeData.status.date;
+	std::string text = exeData.getStatus().date;
 	
 	// Replace first %s with weekday.
 	const std::string &weekdayString =
-		exeData.calendar.weekdayNames.at(date.getWeekday());
+		exeData.getCalendar().weekdayNames.at(date.getWeekday());
 	size_t index = text.find("%s");
 	text.replace(index, 2, weekdayString);
 
@@ -148,7 +212,7 @@ std::string GameData::getDateString(const Date &date, const ExeData &exeData)
 
 	// Replace third %s with month.
 	const std::string &monthString =
-		exeData.calendar.monthNames.at(date.getMonth());
+		exeData.getCalendar().monthNames.at(date.getMonth());
 	index = text.find("%s");
 	text.replace(index, 2, monthString);
 
@@ -260,6 +324,8 @@ MusicName GameData::getInteriorMusicName(const std::string &mifName, Random &ran
 void GameData::loadInterior(const MIFFile &mif, const Location &location,
 	const ExeData &exeData, TextureManager &textureManager, Renderer &renderer)
 {
+	const Metrics::ScopedTimer loadTimer(getLevelLoadHistogram("interior"));
+
 	// Call interior WorldData loader.
 	this->worldData = std::make_unique<InteriorWorldData>(
 		InteriorWorldData::loadInterior(mif, exeData));
@@ -277,6 +343,10 @@ void GameData::loadInterior(const MIFFile &mif, const Location &location,
 	// Set location.
 	this->location = location;
 
+	this->worldSource = GameData::WorldSource();
+	this->worldSource.type = WorldSource::Type::Interior;
+	this->worldSource.mifName = mif.getName();
+
 	// Arbitrary interior weather and fog.
 	const double fogDistance = GameData::DEFAULT_INTERIOR_FOG_DIST;
 	this->weatherType = WeatherType::Clear;
@@ -284,7 +354,7 @@ void GameData::loadInterior(const MIFFile &mif, const Location &location,
 	renderer.setFogDistance(fogDistance);
 }
 
-void GameData::enterInterior(const MIFFile &mif, const Int2 &returnVoxel, const ExeData &exeData,
+void GameData::enterInterior(InteriorWorldData &&interior, const Int2 &returnVoxel,
 	TextureManager &textureManager, Renderer &renderer)
 {
 	DebugAssert(this->worldData.get() != nullptr);
@@ -293,8 +363,6 @@ void GameData::enterInterior(const MIFFile &mif, const Int2 &returnVoxel, const
 	ExteriorWorldData &exterior = static_cast<ExteriorWorldData&>(*this->worldData.get());
 	DebugAssert(exterior.getInterior() == nullptr);
 
-	InteriorWorldData interior = InteriorWorldData::loadInterior(mif, exeData);
-
 	// Give the interior world data to the active exterior.
 	exterior.enterInterior(std::move(interior), returnVoxel);
 
@@ -353,6 +421,8 @@ void GameData::leaveInterior(TextureManager &textureManager, Renderer &renderer)
 void GameData::loadNamedDungeon(int localDungeonID, int provinceID, bool isArtifactDungeon,
 	const ExeData &exeData, TextureManager &textureManager, Renderer &renderer)
 {
+	const Metrics::ScopedTimer loadTimer(getLevelLoadHistogram("named_dungeon"));
+
 	// Dungeon ID must be for a named dungeon, not main quest dungeon.
 	DebugAssertMsg(localDungeonID >= 2, "Dungeon ID \"" + std::to_string(localDungeonID) +
 		"\" must not be for main quest dungeon.");
@@ -379,6 +449,12 @@ void GameData::loadNamedDungeon(int localDungeonID, int provinceID, bool isArtif
 	// Set location.
 	this->location = Location::makeDungeon(localDungeonID, provinceID);
 
+	this->worldSource = GameData::WorldSource();
+	this->worldSource.type = WorldSource::Type::NamedDungeon;
+	this->worldSource.localID = localDungeonID;
+	this->worldSource.provinceID = provinceID;
+	this->worldSource.isArtifactDungeon = isArtifactDungeon;
+
 	// Arbitrary interior weather and fog.
 	const double fogDistance = GameData::DEFAULT_INTERIOR_FOG_DIST;
 	this->weatherType = WeatherType::Clear;
@@ -390,6 +466,8 @@ void GameData::loadWildernessDungeon(int provinceID, int wildBlockX, int wildBlo
 	const CityDataFile &cityData, const ExeData &exeData, TextureManager &textureManager,
 	Renderer &renderer)
 {
+	const Metrics::ScopedTimer loadTimer(getLevelLoadHistogram("wilderness_dungeon"));
+
 	// Verify that the wilderness block coordinates are valid (0..63).
 	DebugAssertMsg((wildBlockX >= 0) && (wildBlockX < RMDFile::WIDTH),
 		"Wild block X \"" + std::to_string(wildBlockX) + "\" out of range.");
@@ -421,6 +499,12 @@ void GameData::loadWildernessDungeon(int provinceID, int wildBlockX, int wildBlo
 	// value for testing).
 	this->location = Location::makeSpecialCase(Location::SpecialCaseType::WildDungeon, provinceID);
 
+	this->worldSource = GameData::WorldSource();
+	this->worldSource.type = WorldSource::Type::WildernessDungeon;
+	this->worldSource.provinceID = provinceID;
+	this->worldSource.wildBlockX = wildBlockX;
+	this->worldSource.wildBlockY = wildBlockY;
+
 	// Arbitrary interior weather and fog.
 	const double fogDistance = GameData::DEFAULT_INTERIOR_FOG_DIST;
 	this->weatherType = WeatherType::Clear;
@@ -431,6 +515,8 @@ void GameData::loadWildernessDungeon(int provinceID, int wildBlockX, int wildBlo
 void GameData::loadPremadeCity(const MIFFile &mif, WeatherType weatherType, int starCount,
 	const MiscAssets &miscAssets, TextureManager &textureManager, Renderer &renderer)
 {
+	const Metrics::ScopedTimer loadTimer(getLevelLoadHistogram("premade_city"));
+
 	// Climate for center province.
 	const int localCityID = 0;
 	const int provinceID = Location::CENTER_PROVINCE_ID;
@@ -455,6 +541,12 @@ void GameData::loadPremadeCity(const MIFFile &mif, WeatherType weatherType, int
 	// Set location.
 	this->location = Location::makeCity(localCityID, provinceID);
 
+	this->worldSource = GameData::WorldSource();
+	this->worldSource.type = WorldSource::Type::PremadeCity;
+	this->worldSource.mifName = mif.getName();
+	this->worldSource.starCount = starCount;
+	this->worldSource.weatherType = weatherType;
+
 	// Regular sky palette based on weather.
 	const std::vector<uint32_t> skyPalette =
 		GameData::makeExteriorSkyPalette(weatherType, textureManager);
@@ -471,6 +563,8 @@ void GameData::loadPremadeCity(const MIFFile &mif, WeatherType weatherType, int
 void GameData::loadCity(int localCityID, int provinceID, WeatherType weatherType, int starCount,
 	const MiscAssets &miscAssets, TextureManager &textureManager, Renderer &renderer)
 {
+	const Metrics::ScopedTimer loadTimer(getLevelLoadHistogram("city"));
+
 	const int globalCityID = CityDataFile::getGlobalCityID(localCityID, provinceID);
 
 	// Check that the IDs are in the proper range. Although 256 is a valid city ID,
@@ -482,7 +576,7 @@ void GameData::loadCity(int localCityID, int provinceID, WeatherType weatherType
 
 	// Determine city traits from the given city ID.
 	const LocationType locationType = Location::getCityType(localCityID);
-	const ExeData::CityGeneration &cityGen = miscAssets.getExeData().cityGen;
+	const ExeData::CityGeneration &cityGen = miscAssets.getExeData().getCityGeneration();
 	const bool isCityState = locationType == LocationType::CityState;
 	const bool isCoastal = std::find(cityGen.coastalCityList.begin(),
 		cityGen.coastalCityList.end(), globalCityID) != cityGen.coastalCityList.end();
@@ -546,6 +640,13 @@ void GameData::loadCity(int localCityID, int provinceID, WeatherType weatherType
 	// Set location.
 	this->location = Location::makeCity(localCityID, provinceID);
 
+	this->worldSource = GameData::WorldSource();
+	this->worldSource.type = WorldSource::Type::City;
+	this->worldSource.localID = localCityID;
+	this->worldSource.provinceID = provinceID;
+	this->worldSource.starCount = starCount;
+	this->worldSource.weatherType = weatherType;
+
 	// Regular sky palette based on weather.
 	const std::vector<uint32_t> skyPalette =
 		GameData::makeExteriorSkyPalette(weatherType, textureManager);
@@ -563,6 +664,8 @@ void GameData::loadWilderness(int localCityID, int provinceID, int rmdTR, int rm
 	int rmdBL, WeatherType weatherType, int starCount, const MiscAssets &miscAssets,
 	TextureManager &textureManager, Renderer &renderer)
 {
+	const Metrics::ScopedTimer loadTimer(getLevelLoadHistogram("wilderness"));
+
 	// Get the location's climate type.
 	const ClimateType climateType = Location::getCityClimateType(
 		localCityID, provinceID, miscAssets);
@@ -585,6 +688,14 @@ void GameData::loadWilderness(int localCityID, int provinceID, int rmdTR, int rm
 	// Set location.
 	this->location = Location::makeCity(localCityID, provinceID);
 
+	this->worldSource = GameData::WorldSource();
+	this->worldSource.type = WorldSource::Type::Wilderness;
+	this->worldSource.localID = localCityID;
+	this->worldSource.provinceID = provinceID;
+	this->worldSource.rmdIDs = { rmdTR, rmdTL, rmdBR, rmdBL };
+	this->worldSource.starCount = starCount;
+	this->worldSource.weatherType = weatherType;
+
 	// Regular sky palette based on weather.
 	const std::vector<uint32_t> skyPalette =
 		GameData::makeExteriorSkyPalette(weatherType, textureManager);
@@ -755,16 +866,319 @@ std::function<void(Game&)> &GameData::getOnLevelUpVoxelEnter()
 	return this->onLevelUpVoxelEnter;
 }
 
+std::vector<uint8_t> GameData::makeSnapshot() const
+{
+	DebugAssert(this->worldData.get() != nullptr);
+	DebugAssert(this->worldSource.type != WorldSource::Type::None);
+
+	SnapshotHeader header = SnapshotHeader();
+	header.magic = SnapshotMagic;
+	header.version = GameData::SNAPSHOT_VERSION;
+	header.year = this->date.getYear();
+	header.month = this->date.getMonth();
+	header.day = this->date.getDay();
+	header.hours = this->clock.getHours24();
+	header.minutes = this->clock.getMinutes();
+	header.seconds = this->clock.getSeconds();
+	header.fractionOfSecond = this->clock.getFractionOfSecond();
+	header.randomSeed = this->arenaRandom.getSeed();
+
+	for (size_t i = 0; i < this->weathers.size(); i++)
+	{
+		header.weathers[i] = static_cast<int32_t>(this->weathers[i]);
+	}
+
+	std::memcpy(header.location, &this->location, sizeof(this->location));
+	header.sourceType = static_cast<int32_t>(this->worldSource.type);
+	header.sourceLocalID = this->worldSource.localID;
+	header.sourceProvinceID = this->worldSource.provinceID;
+	header.wildBlockX = this->worldSource.wildBlockX;
+	header.wildBlockY = this->worldSource.wildBlockY;
+	std::copy(this->worldSource.rmdIDs.begin(), this->worldSource.rmdIDs.end(),
+		header.rmdIDs.begin());
+	header.starCount = this->worldSource.starCount;
+	header.sourceWeatherType = static_cast<int32_t>(this->worldSource.weatherType);
+	header.isArtifactDungeon = this->worldSource.isArtifactDungeon ? 1 : 0;
+
+	// The interior whose level is active, if any. Its level index and voxels are saved since
+	// dungeons have several levels and nothing streams into an interior's grid.
+	const InteriorWorldData *interior = nullptr;
+	if (this->worldData->getBaseWorldType() == WorldType::Interior)
+	{
+		interior = static_cast<const InteriorWorldData*>(this->worldData.get());
+	}
+	else
+	{
+		const auto &exterior = static_cast<const ExteriorWorldData&>(*this->worldData.get());
+		interior = exterior.getInterior();
+		if (interior != nullptr)
+		{
+			const Int2 &returnVoxel = exterior.getInteriorReturnVoxel();
+			header.hasInterior = 1;
+			header.returnVoxelX = returnVoxel.x;
+			header.returnVoxelY = returnVoxel.y;
+		}
+	}
+
+	const std::string &interiorMifName = (header.hasInterior != 0) ?
+		interior->getMifName() : std::string();
+
+	const LevelData &activeLevel = this->worldData->getActiveLevel();
+	const VoxelGrid &voxelGrid = activeLevel.getVoxelGrid();
+	if (interior != nullptr)
+	{
+		header.levelIndex = interior->getLevelIndex();
+		header.gridWidth = static_cast<uint32_t>(voxelGrid.getWidth());
+		header.gridHeight = static_cast<uint32_t>(voxelGrid.getHeight());
+		header.gridDepth = static_cast<uint32_t>(voxelGrid.getDepth());
+	}
+
+	const Double3 &position = this->player.getPosition();
+	const Double3 &direction = this->player.getDirection();
+	header.playerX = position.x;
+	header.playerY = position.y;
+	header.playerZ = position.z;
+	header.directionX = direction.x;
+	header.directionY = direction.y;
+	header.directionZ = direction.z;
+
+	const std::vector<LevelData::DoorState> &doors = activeLevel.getOpenDoors().getDoors();
+	header.sourceMifNameSize = static_cast<uint32_t>(this->worldSource.mifName.size());
+	header.interiorMifNameSize = static_cast<uint32_t>(interiorMifName.size());
+	header.doorCount = static_cast<uint32_t>(doors.size());
+
+	const size_t voxelCount = static_cast<size_t>(header.gridWidth) * header.gridHeight *
+		header.gridDepth;
+
+	std::vector<uint8_t> snapshot(sizeof(header) + header.sourceMifNameSize +
+		header.interiorMifNameSize + (voxelCount * sizeof(uint16_t)) +
+		(doors.size() * sizeof(SnapshotDoor)));
+	uint8_t *dst = snapshot.data();
+
+	auto write = [&dst](const void *src, size_t size)
+	{
+		std::memcpy(dst, src, size);
+		dst += size;
+	};
+
+	write(&header, sizeof(header));
+	write(this->worldSource.mifName.data(), header.sourceMifNameSize);
+	write(interiorMifName.data(), header.interiorMifNameSize);
+	write(voxelGrid.getVoxels(), voxelCount * sizeof(uint16_t));
+
+	for (const LevelData::DoorState &door : doors)
+	{
+		SnapshotDoor snapshotDoor = SnapshotDoor();
+		snapshotDoor.x = door.getVoxel().x;
+		snapshotDoor.y = door.getVoxel().y;
+		snapshotDoor.percentOpen = door.getPercentOpen();
+		snapshotDoor.direction = static_cast<int32_t>(door.getDirection());
+		write(&snapshotDoor, sizeof(snapshotDoor));
+	}
+
+	DebugAssert(dst == (snapshot.data() + snapshot.size()));
+	return snapshot;
+}
+
+bool GameData::restoreSnapshot(const std::vector<uint8_t> &snapshot,
+	const MiscAssets &miscAssets, TextureManager &textureManager, Renderer &renderer)
+{
+	SnapshotHeader header;
+	if (snapshot.size() < sizeof(header))
+	{
+		DebugLogWarning("Snapshot is too small.");
+		return false;
+	}
+
+	std::memcpy(&header, snapshot.data(), sizeof(header));
+
+	const size_t voxelCount = static_cast<size_t>(header.gridWidth) * header.gridHeight *
+		header.gridDepth;
+	const size_t expectedSize = sizeof(header) + header.sourceMifNameSize +
+		header.interiorMifNameSize + (voxelCount * sizeof(uint16_t)) +
+		(static_cast<size_t>(header.doorCount) * sizeof(SnapshotDoor));
+	const int typeCount = static_cast<int>(WorldSource::Type::Wilderness) + 1;
+	if ((header.magic != SnapshotMagic) || (header.version != GameData::SNAPSHOT_VERSION) ||
+		(snapshot.size() != expectedSize) || (header.sourceType <= 0) ||
+		(header.sourceType >= typeCount))
+	{
+		DebugLogWarning("Snapshot is from another version or is corrupt.");
+		return false;
+	}
+
+	const uint8_t *src = snapshot.data() + sizeof(header);
+	const std::string sourceMifName(reinterpret_cast<const char*>(src), header.sourceMifNameSize);
+	src += header.sourceMifNameSize;
+	const std::string interiorMifName(reinterpret_cast<const char*>(src),
+		header.interiorMifNameSize);
+	src += header.interiorMifNameSize;
+	const uint8_t *voxelBytes = src;
+	const uint8_t *doorBytes = voxelBytes + (voxelCount * sizeof(uint16_t));
+
+	// Read any .MIF files before touching the game data, so a missing one changes nothing.
+	const WorldSource::Type sourceType = static_cast<WorldSource::Type>(header.sourceType);
+	MIFFile sourceMif, interiorMif;
+	const bool needsSourceMif = (sourceType == WorldSource::Type::Interior) ||
+		(sourceType == WorldSource::Type::PremadeCity);
+	if (needsSourceMif && !sourceMif.init(sourceMifName.c_str()))
+	{
+		DebugLogWarning("Could not init snapshot .MIF file \"" + sourceMifName + "\".");
+		return false;
+	}
+
+	if ((header.hasInterior != 0) && !interiorMif.init(interiorMifName.c_str()))
+	{
+		DebugLogWarning("Could not init snapshot .MIF file \"" + interiorMifName + "\".");
+		return false;
+	}
+
+	Location location;
+	std::memcpy(&location, header.location, sizeof(location));
+
+	// Time and weather go first since building the world reads them (for night lights, etc.).
+	this->date = Date(header.year, header.month, header.day);
+	this->clock = Clock(header.hours, header.minutes, header.seconds, header.fractionOfSecond);
+	for (size_t i = 0; i < this->weathers.size(); i++)
+	{
+		this->weathers[i] = static_cast<WeatherType>(header.weathers[i]);
+	}
+
+	// Build the saved world again from its source.
+	const ExeData &exeData = miscAssets.getExeData();
+	const WeatherType sourceWeatherType = static_cast<WeatherType>(header.sourceWeatherType);
+	if (sourceType == WorldSource::Type::Interior)
+	{
+		this->loadInterior(sourceMif, location, exeData, textureManager, renderer);
+	}
+	else if (sourceType == WorldSource::Type::NamedDungeon)
+	{
+		this->loadNamedDungeon(header.sourceLocalID, header.sourceProvinceID,
+			header.isArtifactDungeon != 0, exeData, textureManager, renderer);
+	}
+	else if (sourceType == WorldSource::Type::WildernessDungeon)
+	{
+		this->loadWildernessDungeon(header.sourceProvinceID, header.wildBlockX,
+			header.wildBlockY, this->cityData, exeData, textureManager, renderer);
+	}
+	else if (sourceType == WorldSource::Type::PremadeCity)
+	{
+		this->loadPremadeCity(sourceMif, sourceWeatherType, header.starCount, miscAssets,
+			textureManager, renderer);
+	}
+	else if (sourceType == WorldSource::Type::City)
+	{
+		this->loadCity(header.sourceLocalID, header.sourceProvinceID, sourceWeatherType,
+			header.starCount, miscAssets, textureManager, renderer);
+	}
+	else
+	{
+		this->loadWilderness(header.sourceLocalID, header.sourceProvinceID,
+			header.rmdIDs[0], header.rmdIDs[1], header.rmdIDs[2], header.rmdIDs[3],
+			sourceWeatherType, header.starCount, miscAssets, textureManager, renderer);
+	}
+
+	this->location = location;
+
+	// Go back into the interior the player was in, if any.
+	InteriorWorldData *interior = nullptr;
+	if (this->worldData->getBaseWorldType() == WorldType::Interior)
+	{
+		interior = static_cast<InteriorWorldData*>(this->worldData.get());
+	}
+	else if (header.hasInterior != 0)
+	{
+		const Int2 returnVoxel(header.returnVoxelX, header.returnVoxelY);
+		this->enterInterior(InteriorWorldData::loadInterior(interiorMif, exeData), returnVoxel,
+			textureManager, renderer);
+		interior = static_cast<ExteriorWorldData&>(*this->worldData.get()).getInterior();
+	}
+
+	if ((interior != nullptr) && (header.levelIndex != interior->getLevelIndex()) &&
+		(header.levelIndex >= 0) && (header.levelIndex < interior->getLevelCount()))
+	{
+		interior->setLevelIndex(header.levelIndex);
+		interior->getActiveLevel().setActive(textureManager, renderer);
+	}
+
+	// Put the saved voxels back if the grid is the one they came from.
+	LevelData &activeLevel = this->worldData->getActiveLevel();
+	VoxelGrid &voxelGrid = activeLevel.getVoxelGrid();
+	if ((interior != nullptr) && (voxelCount > 0))
+	{
+		const uint16_t voxelDataCount = static_cast<uint16_t>(voxelGrid.getVoxelDataCount());
+		const bool sameGrid =
+			(header.gridWidth == static_cast<uint32_t>(voxelGrid.getWidth())) &&
+			(header.gridHeight == static_cast<uint32_t>(voxelGrid.getHeight())) &&
+			(header.gridDepth == static_cast<uint32_t>(voxelGrid.getDepth()));
+
+		if (sameGrid)
+		{
+			// Only changed voxels go through setVoxel() so the grid's derived data stays
+			// up to date without rebuilding all of it. The saved IDs are in the grid's
+			// own order.
+			const uint8_t *voxelPtr = voxelBytes;
+			for (int z = 0; z < voxelGrid.getDepth(); z++)
+			{
+				for (int y = 0; y < voxelGrid.getHeight(); y++)
+				{
+					for (int x = 0; x < voxelGrid.getWidth(); x++)
+					{
+						uint16_t voxel;
+						std::memcpy(&voxel, voxelPtr, sizeof(voxel));
+						voxelPtr += sizeof(voxel);
+
+						if ((voxel != voxelGrid.getVoxel(x, y, z)) && (voxel < voxelDataCount))
+						{
+							voxelGrid.setVoxel(x, y, z, voxel);
+						}
+					}
+				}
+			}
+
+			activeLevel.updateVoxelChanges();
+		}
+		else
+		{
+			DebugLogWarning("Snapshot voxel grid doesn't match the rebuilt level.");
+		}
+	}
+
+	LevelData::OpenDoors &openDoors = activeLevel.getOpenDoors();
+	openDoors.clear();
+
+	for (uint32_t i = 0; i < header.doorCount; i++)
+	{
+		SnapshotDoor door;
+		std::memcpy(&door, doorBytes + (i * sizeof(SnapshotDoor)), sizeof(door));
+
+		const Int2 voxel(door.x, door.y);
+		if (openDoors.find(voxel) == nullptr)
+		{
+			openDoors.add(LevelData::DoorState(voxel, door.percentOpen,
+				static_cast<LevelData::DoorState::Direction>(door.direction)));
+		}
+	}
+
+	const Double3 position(header.playerX, header.playerY, header.playerZ);
+	const Double3 direction(header.directionX, header.directionY, header.directionZ);
+	this->player.teleport(position);
+	this->player.lookAt(position + direction);
+	this->player.setVelocityToZero();
+
+	this->arenaRandom.srand(header.randomSeed);
+	return true;
+}
+
 void GameData::updateWeather(const ExeData &exeData)
 {
 	const int seasonIndex = this->date.getSeason();
 
 	for (size_t i = 0; i < this->weathers.size(); i++)
 	{
-		static_assert(std::tuple_size<decltype(exeData.locations.climates)>::value ==
+		static_assert(std::tuple_size<decltype(exeData.getLocations().climates)>::value ==
 			std::tuple_size<decltype(this->weathers)>::value);
 		
-		const int climateIndex = exeData.locations.climates[i];
+		const int climateIndex = exeData.getLocations().climates[i];
 		const int variantIndex = [this]()
 		{
 			// 40% for 2, 20% for 1, 20% for 3, 10% for 0, and 10% for 4.
@@ -794,7 +1208,7 @@ void GameData::updateWeather(const ExeData &exeData)
 
 		const int weatherTableIndex = (climateIndex * 20) + (seasonIndex * 5) + variantIndex;
 		this->weathers[i] = static_cast<WeatherType>(
-			exeData.locations.weatherTable.at(weatherTableIndex));
+			exeData.getLocations().weatherTable.at(weatherTableIndex));
 	}
 }
 
@@ -1,6 +1,8 @@
 #ifndef GAME_DATA_H
 #define GAME_DATA_H
 
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -28,6 +30,7 @@
 
 class CharacterClass;
 class INFFile;
+class InteriorWorldData;
 class MIFFile;
 class Renderer;
 class TextBox;
@@ -44,9 +47,9 @@ public:
 	struct TimedTextBox
 	{
 		double remainingDuration;
-		std::unique_ptr<TextBox> textBox;
+		std::shared_ptr<const TextBox> textBox; // Can be shared with the text box cache.
 
-		TimedTextBox(double remainingDuration, std::unique_ptr<TextBox> textBox);
+		TimedTextBox(double remainingDuration, std::shared_ptr<const TextBox> textBox);
 		TimedTextBox();
 
 		// Returns whether there's remaining duration.
@@ -89,6 +92,30 @@ private:
 	// behavior is to decrement the world's level index.
 	std::function<void(Game&)> onLevelUpVoxelEnter;
 
+	// How the current world was loaded, so a snapshot can have it built again before its
+	// saved state is put back on top.
+	struct WorldSource
+	{
+		enum class Type { None, Interior, NamedDungeon, WildernessDungeon, PremadeCity, City,
+			Wilderness };
+
+		Type type;
+		std::string mifName; // Interiors and the premade city.
+		int localID, provinceID; // Local city or dungeon ID, depending on the type.
+		int wildBlockX, wildBlockY; // Wilderness dungeons.
+		std::array<int, 4> rmdIDs; // Wilderness blocks (TR, TL, BR, BL).
+		int starCount;
+		WeatherType weatherType;
+		bool isArtifactDungeon;
+
+		WorldSource();
+	};
+
+	WorldSource worldSource;
+
+	// Incremented whenever the snapshot layout changes.
+	static const uint32_t SNAPSHOT_VERSION;
+
 	// Creates a sky palette from the given weather. This palette covers the entire day
 	// (including night colors).
 	static std::vector<uint32_t> makeExteriorSkyPalette(WeatherType weatherType,
@@ -119,9 +146,10 @@ public:
 	void loadInterior(const MIFFile &mif, const Location &location, const ExeData &exeData,
 		TextureManager &textureManager, Renderer &renderer);
 
-	// Reads in data from an interior .MIF file and inserts it into the active exterior data.
-	// Only call this method if the player is in an exterior location (city or wilderness).
-	void enterInterior(const MIFFile &mif, const Int2 &returnVoxel, const ExeData &exeData,
+	// Inserts an interior loaded from a .MIF file into the active exterior data. Only call
+	// this method if the player is in an exterior location (city or wilderness). The interior
+	// can be loaded on another thread beforehand since only activating it touches the renderer.
+	void enterInterior(InteriorWorldData &&interior, const Int2 &returnVoxel,
 		TextureManager &textureManager, Renderer &renderer);
 
 	// Leaves the current interior and returns to the exterior. Only call this method if the
@@ -190,6 +218,16 @@ public:
 	// Gets the custom function for the *LEVELUP voxel enter event.
 	std::function<void(Game&)> &getOnLevelUpVoxelEnter();
 
+	// Copies the session state a quicksave needs (date, time, weather, location, world,
+	// player, open doors, and an interior's voxels) into one buffer, so it can be written out
+	// on another thread while the game keeps running.
+	std::vector<uint8_t> makeSnapshot() const;
+
+	// Builds the world a snapshot was made in again and restores the snapshot's state. Returns
+	// false and changes nothing if the snapshot isn't valid.
+	bool restoreSnapshot(const std::vector<uint8_t> &snapshot, const MiscAssets &miscAssets,
+		TextureManager &textureManager, Renderer &renderer);
+
 	// Recalculates the weather for each global quarter (done hourly).
 	void updateWeather(const ExeData &exeData);
 
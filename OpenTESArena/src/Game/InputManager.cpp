@@ -1,7 +1,16 @@
+#include <algorithm>
+#include <cstring>
+
 #include "InputManager.h"
 
 InputManager::InputManager()
-	: mouseDelta(0, 0) { }
+	: mouseDelta(0, 0), mousePosition(0, 0)
+{
+	this->keyboardState.fill(0);
+	this->mouseButtons = 0;
+	this->pendingInputTime = 0;
+	this->hasPendingInput = false;
+}
 
 bool InputManager::keyPressed(const SDL_Event &e, SDL_Keycode keycode) const
 {
@@ -15,14 +24,12 @@ bool InputManager::keyReleased(const SDL_Event &e, SDL_Keycode keycode) const
 
 bool InputManager::keyIsDown(SDL_Scancode scancode) const
 {
-	const uint8_t *keys = SDL_GetKeyboardState(nullptr);
-	return keys[scancode] != 0;
+	return this->keyboardState[scancode] != 0;
 }
 
 bool InputManager::keyIsUp(SDL_Scancode scancode) const
 {
-	const uint8_t *keys = SDL_GetKeyboardState(nullptr);
-	return keys[scancode] == 0;
+	return this->keyboardState[scancode] == 0;
 }
 
 bool InputManager::mouseButtonPressed(const SDL_Event &e, uint8_t button) const
@@ -37,14 +44,12 @@ bool InputManager::mouseButtonReleased(const SDL_Event &e, uint8_t button) const
 
 bool InputManager::mouseButtonIsDown(uint8_t button) const
 {
-	const uint32_t mouse = SDL_GetMouseState(nullptr, nullptr);
-	return (mouse & SDL_BUTTON(button)) != 0;
+	return (this->mouseButtons & SDL_BUTTON(button)) != 0;
 }
 
 bool InputManager::mouseButtonIsUp(uint8_t button) const
 {
-	const uint32_t mouse = SDL_GetMouseState(nullptr, nullptr);
-	return (mouse & SDL_BUTTON(button)) == 0;
+	return (this->mouseButtons & SDL_BUTTON(button)) == 0;
 }
 
 bool InputManager::mouseWheeledUp(const SDL_Event &e) const
@@ -69,9 +74,7 @@ bool InputManager::applicationExit(const SDL_Event &e) const
 
 Int2 InputManager::getMousePosition() const
 {
-	int x, y;
-	SDL_GetMouseState(&x, &y);
-	return Int2(x, y);
+	return this->mousePosition;
 }
 
 Int2 InputManager::getMouseDelta() const
@@ -79,14 +82,88 @@ Int2 InputManager::getMouseDelta() const
 	return this->mouseDelta;
 }
 
+const InputManager::KeyboardState &InputManager::getKeyboardState() const
+{
+	return this->keyboardState;
+}
+
+uint32_t InputManager::getMouseButtons() const
+{
+	return this->mouseButtons;
+}
+
 void InputManager::setRelativeMouseMode(bool active)
 {
 	SDL_bool enabled = active ? SDL_TRUE : SDL_FALSE;
 	SDL_SetRelativeMouseMode(enabled);
 }
 
+void InputManager::sampleMouseDelta()
+{
+	SDL_PumpEvents();
+
+	int dx, dy;
+	SDL_GetRelativeMouseState(&dx, &dy);
+	this->mouseDelta.x += dx;
+	this->mouseDelta.y += dy;
+
+	if ((dx != 0) || (dy != 0))
+	{
+		this->markInput(SDL_GetTicks());
+	}
+}
+
+void InputManager::markInput(uint32_t timestamp)
+{
+	if (!this->hasPendingInput)
+	{
+		this->pendingInputTime = timestamp;
+		this->hasPendingInput = true;
+	}
+}
+
+bool InputManager::finishInputLatency(uint32_t presentTime, double *outSeconds)
+{
+	if (!this->hasPendingInput)
+	{
+		return false;
+	}
+
+	// Event times can be a little after the present time if they arrived while presenting.
+	const int32_t milliseconds = static_cast<int32_t>(presentTime - this->pendingInputTime);
+	*outSeconds = static_cast<double>(std::max(milliseconds, 0)) / 1000.0;
+	this->hasPendingInput = false;
+	return true;
+}
+
+void InputManager::clearMouseDelta()
+{
+	this->mouseDelta = Int2(0, 0);
+}
+
 void InputManager::update()
 {
-	// Refresh the mouse delta.
-	SDL_GetRelativeMouseState(&this->mouseDelta.x, &this->mouseDelta.y);
+	int keyCount;
+	const uint8_t *keys = SDL_GetKeyboardState(&keyCount);
+	const size_t copyCount = std::min(static_cast<size_t>(keyCount), this->keyboardState.size());
+	std::memcpy(this->keyboardState.data(), keys, copyCount);
+
+	int x, y;
+	this->mouseButtons = SDL_GetMouseState(&x, &y);
+	this->mousePosition = Int2(x, y);
+
+	// Add to the mouse delta.
+	int dx, dy;
+	SDL_GetRelativeMouseState(&dx, &dy);
+	this->mouseDelta.x += dx;
+	this->mouseDelta.y += dy;
+}
+
+void InputManager::update(const KeyboardState &keyboardState, const Int2 &mousePosition,
+	uint32_t mouseButtons, const Int2 &mouseDelta)
+{
+	this->keyboardState = keyboardState;
+	this->mousePosition = mousePosition;
+	this->mouseButtons = mouseButtons;
+	this->mouseDelta = mouseDelta;
 }
@@ -1,6 +1,7 @@
 #ifndef INPUT_MANAGER_H
 #define INPUT_MANAGER_H
 
+#include <array>
 #include <cstdint>
 
 #include "SDL.h"
@@ -12,10 +13,21 @@
 // This became a necessity after seeing that SDL_GetRelativeMouseState() can only be 
 // called once per frame, so its value must be stored somewhere.
 
+// The keyboard and mouse state are sampled once per frame too, so recorded input can stand
+// in for SDL's when replaying.
+
 class InputManager
 {
-private:	
-	Int2 mouseDelta;
+public:
+	using KeyboardState = std::array<uint8_t, SDL_NUM_SCANCODES>;
+private:
+	KeyboardState keyboardState;
+	Int2 mouseDelta, mousePosition;
+	uint32_t mouseButtons;
+
+	// SDL time in milliseconds of the oldest input not yet shown on screen.
+	uint32_t pendingInputTime;
+	bool hasPendingInput;
 public:
 	InputManager();
 
@@ -34,12 +46,38 @@ public:
 	Int2 getMousePosition() const;
 	Int2 getMouseDelta() const;
 
+	// Gets the state sampled by the last update, for recording it.
+	const KeyboardState &getKeyboardState() const;
+	uint32_t getMouseButtons() const;
+
 	// Sets whether the mouse should move during motion events (for player camera).
 	void setRelativeMouseMode(bool active);
 
+	// Adds any mouse motion since the last update to the mouse delta, so a frame drawn
+	// after the tick can show where the mouse has moved since (see GameWorldPanel::render()).
+	// The next tick still applies it.
+	void sampleMouseDelta();
+
+	// Notes that input arrived at the given SDL time, for measuring how long it takes to
+	// get on screen.
+	void markInput(uint32_t timestamp);
+
+	// Gets the seconds from the oldest input since the last call to the given SDL time
+	// (i.e., when a frame was presented). Returns false if there was no input.
+	bool finishInputLatency(uint32_t presentTime, double *outSeconds);
+
+	// Clears the mouse delta once a tick has used it. Until then, deltas from frames
+	// without a tick add up so no mouse movement is lost.
+	void clearMouseDelta();
+
 	// Updates input values whose associated SDL functions should only be called once 
 	// per frame.
 	void update();
+
+	// Sets the input values from a recording instead of SDL. The mouse delta replaces the
+	// current one since recordings save it with any delta left over from earlier frames.
+	void update(const KeyboardState &keyboardState, const Int2 &mousePosition,
+		uint32_t mouseButtons, const Int2 &mouseDelta);
 };
 
 #endif
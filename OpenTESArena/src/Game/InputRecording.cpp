@@ -0,0 +1,363 @@
+#include <ctime>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+
+#include "InputRecording.h"
+#include "../Math/Random.h"
+#include "../Utilities/Debug.h"
+
+namespace
+{
+	// Events are written as raw bytes. None of the event types the game handles point to
+	// memory owned by SDL.
+	static_assert(std::is_trivially_copyable<SDL_Event>::value,
+		"SDL_Event must be trivially copyable for input recordings.");
+
+	// Start of every recording, followed by the frames.
+	struct Header
+	{
+		double timeScale;
+		uint32_t magic, version, eventSize, randomSeed;
+		int32_t tickRate, windowWidth, windowHeight;
+		uint32_t frameCount;
+	};
+
+	// Start of every frame, followed by its key changes and then its events.
+	struct FrameHeader
+	{
+		double dt;
+		int32_t mouseDeltaX, mouseDeltaY, mouseX, mouseY;
+		uint32_t mouseButtons, arenaRandomSeed, hasArenaRandomSeed;
+		uint32_t keyChangeCount, eventCount, padding;
+	};
+
+	const uint32_t MAGIC = 0x43455249; // "IREC".
+
+	// Appends the bytes of the given values to the buffer.
+	template <typename T>
+	void writeBytes(const T *values, size_t count, std::vector<uint8_t> &bytes)
+	{
+		const uint8_t *begin = reinterpret_cast<const uint8_t*>(values);
+		bytes.insert(bytes.end(), begin, begin + (sizeof(T) * count));
+	}
+
+	// Copies values out of the buffer at the given offset and moves past them. Returns false
+	// if the buffer ends first.
+	template <typename T>
+	bool readBytes(const std::vector<uint8_t> &bytes, size_t &offset, T *values, size_t count)
+	{
+		const size_t size = sizeof(T) * count;
+		if ((bytes.size() - offset) < size)
+		{
+			return false;
+		}
+
+		std::memcpy(values, bytes.data() + offset, size);
+		offset += size;
+		return true;
+	}
+}
+
+const uint32_t InputRecording::VERSION = 1;
+
+InputRecording::InputRecording()
+{
+	this->keyboardState.fill(0);
+	this->timeScale = 1.0;
+	this->randomSeed = 0;
+	this->tickRate = 0;
+	this->windowWidth = 0;
+	this->windowHeight = 0;
+	this->frameIndex = -1;
+	this->diverged = false;
+	this->mode = Mode::None;
+}
+
+InputRecording::Frame &InputRecording::getFrame()
+{
+	DebugAssert(!this->frames.empty());
+	return this->isReplaying() ? this->frames.at(this->frameIndex) : this->frames.back();
+}
+
+const InputRecording::Frame &InputRecording::getFrame() const
+{
+	DebugAssert(!this->frames.empty());
+	return this->isReplaying() ? this->frames.at(this->frameIndex) : this->frames.back();
+}
+
+bool InputRecording::isRecording() const
+{
+	return this->mode == Mode::Recording;
+}
+
+bool InputRecording::isReplaying() const
+{
+	return this->mode == Mode::Replaying;
+}
+
+int InputRecording::getTickRate() const
+{
+	return this->tickRate;
+}
+
+double InputRecording::getTimeScale() const
+{
+	return this->timeScale;
+}
+
+void InputRecording::startRecording(const std::string &filename, int tickRate,
+	double timeScale, int windowWidth, int windowHeight)
+{
+	DebugAssert(this->mode == Mode::None);
+
+	this->frames.clear();
+	this->keyboardState.fill(0);
+	this->filename = filename;
+	this->timeScale = timeScale;
+	this->randomSeed = static_cast<uint32_t>(time(nullptr));
+	this->tickRate = tickRate;
+	this->windowWidth = windowWidth;
+	this->windowHeight = windowHeight;
+	this->mode = Mode::Recording;
+
+	Random::setReplaySeed(static_cast<int>(this->randomSeed));
+	DebugLog("Recording input to \"" + filename + "\".");
+}
+
+bool InputRecording::startReplay(const std::string &filename, int windowWidth,
+	int windowHeight)
+{
+	DebugAssert(this->mode == Mode::None);
+
+	std::ifstream ifs(filename, std::ios::binary);
+	if (!ifs.is_open())
+	{
+		DebugLogWarning("Could not open input recording \"" + filename + "\".");
+		return false;
+	}
+
+	const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(ifs)),
+		std::istreambuf_iterator<char>());
+
+	size_t offset = 0;
+	Header header;
+	if (!readBytes(bytes, offset, &header, 1) || (header.magic != MAGIC) ||
+		(header.version != InputRecording::VERSION) || (header.eventSize != sizeof(SDL_Event)))
+	{
+		DebugLogWarning("\"" + filename + "\" is not an input recording from this version.");
+		return false;
+	}
+
+	std::vector<Frame> frames(header.frameCount);
+	for (Frame &frame : frames)
+	{
+		FrameHeader frameHeader;
+		if (!readBytes(bytes, offset, &frameHeader, 1))
+		{
+			DebugLogWarning("Input recording \"" + filename + "\" is truncated.");
+			return false;
+		}
+
+		frame.dt = frameHeader.dt;
+		frame.mouseDelta = Int2(frameHeader.mouseDeltaX, frameHeader.mouseDeltaY);
+		frame.mousePosition = Int2(frameHeader.mouseX, frameHeader.mouseY);
+		frame.mouseButtons = frameHeader.mouseButtons;
+		frame.arenaRandomSeed = frameHeader.arenaRandomSeed;
+		frame.hasArenaRandomSeed = frameHeader.hasArenaRandomSeed != 0;
+		frame.keyChanges.resize(frameHeader.keyChangeCount);
+		frame.events.resize(frameHeader.eventCount);
+
+		if (!readBytes(bytes, offset, frame.keyChanges.data(), frame.keyChanges.size()) ||
+			!readBytes(bytes, offset, frame.events.data(), frame.events.size()))
+		{
+			DebugLogWarning("Input recording \"" + filename + "\" is truncated.");
+			return false;
+		}
+
+		for (const KeyChange &keyChange : frame.keyChanges)
+		{
+			if (keyChange.scancode >= this->keyboardState.size())
+			{
+				DebugLogWarning("Input recording \"" + filename + "\" is corrupt.");
+				return false;
+			}
+		}
+	}
+
+	// Mouse positions are in window coordinates, so they only land on the same buttons in
+	// a window of the same size.
+	if ((header.windowWidth != windowWidth) || (header.windowHeight != windowHeight))
+	{
+		DebugLogWarning("Input recording \"" + filename + "\" was made in a " +
+			std::to_string(header.windowWidth) + "x" + std::to_string(header.windowHeight) +
+			" window, so it may not replay the same in this one.");
+	}
+
+	this->frames = std::move(frames);
+	this->keyboardState.fill(0);
+	this->filename = filename;
+	this->timeScale = header.timeScale;
+	this->randomSeed = header.randomSeed;
+	this->tickRate = header.tickRate;
+	this->windowWidth = header.windowWidth;
+	this->windowHeight = header.windowHeight;
+	this->frameIndex = -1;
+	this->diverged = false;
+	this->mode = Mode::Replaying;
+
+	Random::setReplaySeed(static_cast<int>(this->randomSeed));
+	DebugLog("Replaying " + std::to_string(this->frames.size()) + " frames from \"" +
+		filename + "\".");
+	return true;
+}
+
+bool InputRecording::stopRecording()
+{
+	DebugAssert(this->isRecording());
+	this->mode = Mode::None;
+
+	Header header;
+	header.timeScale = this->timeScale;
+	header.magic = MAGIC;
+	header.version = InputRecording::VERSION;
+	header.eventSize = sizeof(SDL_Event);
+	header.randomSeed = this->randomSeed;
+	header.tickRate = this->tickRate;
+	header.windowWidth = this->windowWidth;
+	header.windowHeight = this->windowHeight;
+	header.frameCount = static_cast<uint32_t>(this->frames.size());
+
+	std::vector<uint8_t> bytes;
+	writeBytes(&header, 1, bytes);
+
+	for (const Frame &frame : this->frames)
+	{
+		FrameHeader frameHeader;
+		std::memset(&frameHeader, 0, sizeof(frameHeader));
+		frameHeader.dt = frame.dt;
+		frameHeader.mouseDeltaX = frame.mouseDelta.x;
+		frameHeader.mouseDeltaY = frame.mouseDelta.y;
+		frameHeader.mouseX = frame.mousePosition.x;
+		frameHeader.mouseY = frame.mousePosition.y;
+		frameHeader.mouseButtons = frame.mouseButtons;
+		frameHeader.arenaRandomSeed = frame.arenaRandomSeed;
+		frameHeader.hasArenaRandomSeed = frame.hasArenaRandomSeed ? 1 : 0;
+		frameHeader.keyChangeCount = static_cast<uint32_t>(frame.keyChanges.size());
+		frameHeader.eventCount = static_cast<uint32_t>(frame.events.size());
+
+		writeBytes(&frameHeader, 1, bytes);
+		writeBytes(frame.keyChanges.data(), frame.keyChanges.size(), bytes);
+		writeBytes(frame.events.data(), frame.events.size(), bytes);
+	}
+
+	std::ofstream ofs(this->filename, std::ios::binary);
+	ofs.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	if (!ofs.good())
+	{
+		DebugLogWarning("Could not write input recording \"" + this->filename + "\".");
+		return false;
+	}
+
+	DebugLog("Saved " + std::to_string(this->frames.size()) + " frames of input to \"" +
+		this->filename + "\".");
+	return true;
+}
+
+void InputRecording::beginFrame(double dt, const ArenaRandom *random)
+{
+	DebugAssert(this->isRecording());
+
+	Frame frame;
+	frame.dt = dt;
+	frame.mouseButtons = 0;
+	frame.arenaRandomSeed = (random != nullptr) ? random->getSeed() : 0;
+	frame.hasArenaRandomSeed = random != nullptr;
+	this->frames.push_back(std::move(frame));
+}
+
+void InputRecording::recordInput(const InputManager &inputManager)
+{
+	Frame &frame = this->getFrame();
+	frame.mouseDelta = inputManager.getMouseDelta();
+	frame.mousePosition = inputManager.getMousePosition();
+	frame.mouseButtons = inputManager.getMouseButtons();
+
+	// Only the keys that changed are saved since most of the keyboard sits still.
+	const InputManager::KeyboardState &keyboardState = inputManager.getKeyboardState();
+	for (size_t i = 0; i < keyboardState.size(); i++)
+	{
+		if (keyboardState[i] != this->keyboardState[i])
+		{
+			KeyChange keyChange;
+			keyChange.scancode = static_cast<uint16_t>(i);
+			keyChange.state = keyboardState[i];
+			keyChange.padding = 0;
+			frame.keyChanges.push_back(keyChange);
+		}
+	}
+
+	this->keyboardState = keyboardState;
+}
+
+void InputRecording::recordEvent(const SDL_Event &e)
+{
+	this->getFrame().events.push_back(e);
+}
+
+bool InputRecording::nextFrame()
+{
+	DebugAssert(this->isReplaying());
+
+	if ((this->frameIndex + 1) >= static_cast<int>(this->frames.size()))
+	{
+		this->mode = Mode::None;
+		DebugLog("Finished replaying \"" + this->filename + "\"" +
+			(this->diverged ? " (it diverged)." : "."));
+		return false;
+	}
+
+	this->frameIndex++;
+	return true;
+}
+
+double InputRecording::getFrameDt() const
+{
+	return this->getFrame().dt;
+}
+
+const std::vector<SDL_Event> &InputRecording::getFrameEvents() const
+{
+	return this->getFrame().events;
+}
+
+void InputRecording::replayInput(InputManager &inputManager)
+{
+	const Frame &frame = this->getFrame();
+	for (const KeyChange &keyChange : frame.keyChanges)
+	{
+		this->keyboardState[keyChange.scancode] = keyChange.state;
+	}
+
+	inputManager.update(this->keyboardState, frame.mousePosition, frame.mouseButtons,
+		frame.mouseDelta);
+}
+
+void InputRecording::checkRandom(const ArenaRandom *random)
+{
+	if (this->diverged)
+	{
+		return;
+	}
+
+	const Frame &frame = this->getFrame();
+	const bool hasSeed = random != nullptr;
+	if ((hasSeed != frame.hasArenaRandomSeed) ||
+		(hasSeed && (random->getSeed() != frame.arenaRandomSeed)))
+	{
+		this->diverged = true;
+		DebugLogWarning("Replay diverged from the recording at frame " +
+			std::to_string(this->frameIndex) + ".");
+	}
+}
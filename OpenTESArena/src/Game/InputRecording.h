@@ -0,0 +1,103 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+#include "InputManager.h"
+#include "../Math/Vector2.h"
+
+// Records everything that feeds the game loop each frame (SDL events, the sampled keyboard
+// and mouse state, and the frame's delta time) so a session can be replayed exactly, for
+// reproducing performance problems and comparing frame times between builds.
+
+// The seed for default-constructed random generators is saved with the recording, and the
+// game data's Arena random seed is saved each frame to find where a replay goes wrong.
+
+class ArenaRandom;
+
+class InputRecording
+{
+private:
+	enum class Mode { None, Recording, Replaying };
+
+	struct KeyChange
+	{
+		uint16_t scancode;
+		uint8_t state, padding;
+	};
+
+	struct Frame
+	{
+		double dt;
+		Int2 mouseDelta, mousePosition;
+		uint32_t mouseButtons;
+		uint32_t arenaRandomSeed;
+		bool hasArenaRandomSeed;
+		std::vector<KeyChange> keyChanges; // Keys changed since the previous frame.
+		std::vector<SDL_Event> events;
+	};
+
+	static const uint32_t VERSION;
+
+	std::vector<Frame> frames;
+	InputManager::KeyboardState keyboardState; // As of the last recorded or replayed frame.
+	std::string filename;
+	double timeScale;
+	uint32_t randomSeed;
+	int tickRate, windowWidth, windowHeight;
+	int frameIndex; // Frame being replayed.
+	bool diverged;
+	Mode mode;
+
+	Frame &getFrame();
+	const Frame &getFrame() const;
+public:
+	InputRecording();
+
+	bool isRecording() const;
+	bool isReplaying() const;
+
+	// Gets the settings the recording was made with. The replay uses them instead of the
+	// options so it steps the game the same way.
+	int getTickRate() const;
+	double getTimeScale() const;
+
+	// Starts recording from the first frame of the game loop. The random seed is set here.
+	void startRecording(const std::string &filename, int tickRate, double timeScale,
+		int windowWidth, int windowHeight);
+
+	// Reads a recording for replaying from the first frame of the game loop. Returns false
+	// if it can't be read.
+	bool startReplay(const std::string &filename, int windowWidth, int windowHeight);
+
+	// Writes the recording to its file and stops recording.
+	bool stopRecording();
+
+	// Starts a new recorded frame. The random generator is null if there's no game data.
+	void beginFrame(double dt, const ArenaRandom *random);
+
+	// Saves the input state sampled this frame.
+	void recordInput(const InputManager &inputManager);
+	void recordEvent(const SDL_Event &e);
+
+	// Moves to the next replayed frame. Returns false when there are no frames left.
+	bool nextFrame();
+
+	// Gets the delta time of the frame being replayed.
+	double getFrameDt() const;
+
+	// Gets the events of the frame being replayed.
+	const std::vector<SDL_Event> &getFrameEvents() const;
+
+	// Sets the input manager's state to the replayed frame's.
+	void replayInput(InputManager &inputManager);
+
+	// Warns the first time the game data's random seed differs from the recording's.
+	void checkRandom(const ArenaRandom *random);
+};
+
+#endif
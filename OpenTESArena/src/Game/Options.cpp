@@ -25,9 +25,20 @@ namespace
 		{ "VerticalFOV", OptionType::Double },
 		{ "ParallaxSky", OptionType::Bool },
 		{ "LetterboxMode", OptionType::Int },
+		{ "OriginalUIScale", OptionType::Int },
 		{ "CursorScale", OptionType::Double },
 		{ "ModernInterface", OptionType::Bool },
-		{ "RenderThreadsMode", OptionType::Int }
+		{ "RenderThreadsMode", OptionType::Int },
+		{ "RenderThreadsAutoCount", OptionType::Int },
+		{ "RenderThreadsAffinity", OptionType::Int },
+		{ "RenderThreadsCores", OptionType::String },
+		{ "RenderThreadsHighPriority", OptionType::Bool },
+		{ "PipelinedFrames", OptionType::Bool },
+		{ "DynamicResolution", OptionType::Bool },
+		{ "InterlacedVoxels", OptionType::Bool },
+		{ "PaletteRendering", OptionType::Bool },
+		{ "BackgroundFPS", OptionType::Int },
+		{ "VoxelDetailDistance", OptionType::Double }
 	};
 
 	const std::vector<std::pair<std::string, OptionType>> AudioMappings =
@@ -36,7 +47,10 @@ namespace
 		{ "SoundVolume", OptionType::Double },
 		{ "MidiConfig", OptionType::String },
 		{ "SoundChannels", OptionType::Int },
-		{ "SoundResampling", OptionType::Int }
+		{ "SoundResampling", OptionType::Int },
+		{ "MusicCacheMegabytes", OptionType::Int },
+		{ "SoundLoadResampling", OptionType::Int },
+		{ "BackgroundUpdateInterval", OptionType::Int }
 	};
 
 	const std::vector<std::pair<std::string, OptionType>> InputMappings =
@@ -55,7 +69,23 @@ namespace
 		{ "ShowDebug", OptionType::Bool },
 		{ "ShowCompass", OptionType::Bool },
 		{ "TimeScale", OptionType::Double },
-		{ "StarDensity", OptionType::Int }
+		{ "StarDensity", OptionType::Int },
+		{ "ClassicStarSequence", OptionType::Bool },
+		{ "FrameCaptureInterval", OptionType::Int },
+		{ "ChunkDistance", OptionType::Int },
+		{ "LevelCache", OptionType::Bool },
+		{ "ImagePack", OptionType::Bool },
+		{ "TextureCacheMegabytes", OptionType::Int },
+		{ "TickRate", OptionType::Int },
+		{ "HitchThresholds", OptionType::String },
+		{ "FrameStatsInterval", OptionType::Int },
+		{ "FrameStatsFormat", OptionType::Int },
+		{ "QuickSaveCompression", OptionType::Bool },
+		{ "LogLevel", OptionType::Int },
+		{ "LogRateLimit", OptionType::Int },
+		{ "CpuIsaLimit", OptionType::String },
+		{ "MemoryReportInterval", OptionType::Int },
+		{ "MetricsInterval", OptionType::Int }
 	};
 }
 
@@ -72,6 +102,7 @@ const std::string Options::SECTION_AUDIO = "Audio";
 const std::string Options::SECTION_MISC = "Misc";
 
 const int Options::MIN_FPS = 15;
+const int Options::MIN_BACKGROUND_FPS = 0;
 const double Options::MIN_RESOLUTION_SCALE = 0.10;
 const double Options::MAX_RESOLUTION_SCALE = 1.0;
 const double Options::MIN_VERTICAL_FOV = 40.0;
@@ -80,8 +111,13 @@ const double Options::MIN_CURSOR_SCALE = 0.50;
 const double Options::MAX_CURSOR_SCALE = 8.0;
 const int Options::MIN_LETTERBOX_MODE = 0;
 const int Options::MAX_LETTERBOX_MODE = 2;
+const int Options::MIN_ORIGINAL_UI_SCALE = 0;
+const int Options::MAX_ORIGINAL_UI_SCALE = 8;
 const int Options::MIN_RENDER_THREADS_MODE = 0;
-const int Options::MAX_RENDER_THREADS_MODE = 5;
+const int Options::MAX_RENDER_THREADS_MODE = 6;
+const int Options::AUTO_RENDER_THREADS_MODE = 6;
+const int Options::MIN_RENDER_THREADS_AFFINITY = 0;
+const int Options::MAX_RENDER_THREADS_AFFINITY = 2;
 const double Options::MIN_HORIZONTAL_SENSITIVITY = 0.50;
 const double Options::MAX_HORIZONTAL_SENSITIVITY = 50.0;
 const double Options::MIN_VERTICAL_SENSITIVITY = 0.50;
@@ -92,10 +128,25 @@ const double Options::MIN_VOLUME = 0.0;
 const double Options::MAX_VOLUME = 1.0;
 const int Options::MIN_SOUND_CHANNELS = 1;
 const int Options::RESAMPLING_OPTION_COUNT = 4;
+const int Options::MIN_MUSIC_CACHE_MEGABYTES = 0;
+const int Options::MIN_SOUND_LOAD_RESAMPLING = 0;
+const int Options::MAX_SOUND_LOAD_RESAMPLING = 2;
 const double Options::MIN_TIME_SCALE = 0.50;
 const double Options::MAX_TIME_SCALE = 1.0;
 const int Options::MIN_STAR_DENSITY_MODE = 0;
 const int Options::MAX_STAR_DENSITY_MODE = 2;
+const int Options::MIN_FRAME_CAPTURE_INTERVAL = 0;
+const int Options::MIN_CHUNK_DISTANCE = 16;
+const int Options::MIN_TEXTURE_CACHE_MEGABYTES = 0;
+const int Options::MIN_TICK_RATE = 0;
+const int Options::MIN_FRAME_STATS_INTERVAL = 0;
+const int Options::MIN_FRAME_STATS_FORMAT = 0;
+const int Options::MAX_FRAME_STATS_FORMAT = 1;
+const int Options::MIN_LOG_LEVEL = 0;
+const int Options::MAX_LOG_LEVEL = 2;
+const int Options::MIN_LOG_RATE_LIMIT = 0;
+const int Options::MIN_MEMORY_REPORT_INTERVAL = 0;
+const int Options::MIN_METRICS_INTERVAL = 0;
 
 void Options::load(const std::string &filename,
 	std::unordered_map<std::string, Options::MapGroup> &maps)
@@ -105,7 +156,7 @@ void Options::load(const std::string &filename,
 
 	for (const auto &sectionPair : keyValueMap.getAll())
 	{
-		const std::string &section = sectionPair.first;
+		const std::string_view section = sectionPair.first;
 		const KeyValueMap::SectionMap &sectionMap = sectionPair.second;
 
 		// Get the list of key-type pairs to pull from.
@@ -130,7 +181,7 @@ void Options::load(const std::string &filename,
 			else
 			{
 				throw DebugException("Unrecognized section \"" +
-					section + "\" in " + filename);
+					std::string(section) + "\" in " + filename);
 			}
 		}();
 
@@ -138,7 +189,7 @@ void Options::load(const std::string &filename,
 		{
 			// See if the key is recognized, and if so, see what type the value should be, 
 			// convert it, and place it in the changed map.
-			const std::string &key = pair.first;
+			const std::string_view key = pair.first;
 			const auto keyListIter = std::find_if(keyList.begin(), keyList.end(),
 				[&key](const std::pair<std::string, OptionType> &keyTypePair)
 			{
@@ -148,48 +199,44 @@ void Options::load(const std::string &filename,
 			if (keyListIter != keyList.end())
 			{
 				const OptionType type = keyListIter->second;
-				auto groupIter = maps.find(section);
 
 				// Add an empty map group if the section is new.
-				if (groupIter == maps.end())
-				{
-					groupIter = maps.insert(std::make_pair(
-						section, Options::MapGroup())).first;
-				}
-
-				Options::MapGroup &mapGroup = groupIter->second;
+				Options::MapGroup &mapGroup = maps[std::string(section)];
 
 				// Using KeyValueMap's getter code here for convenience, despite it doing
 				// an unnecessary look-up.
 				if (type == OptionType::Bool)
 				{
-					mapGroup.bools.insert(std::make_pair(
-						key, keyValueMap.getBoolean(section, key)));
+					mapGroup.bools.emplace(key, keyValueMap.getBoolean(section, key));
 				}
 				else if (type == OptionType::Int)
 				{
-					mapGroup.integers.insert(std::make_pair(
-						key, keyValueMap.getInteger(section, key)));
+					mapGroup.integers.emplace(key, keyValueMap.getInteger(section, key));
 				}
 				else if (type == OptionType::Double)
 				{
-					mapGroup.doubles.insert(std::make_pair(
-						key, keyValueMap.getDouble(section, key)));
+					mapGroup.doubles.emplace(key, keyValueMap.getDouble(section, key));
 				}
 				else if (type == OptionType::String)
 				{
-					mapGroup.strings.insert(std::make_pair(
-						key, keyValueMap.getString(section, key)));
+					mapGroup.strings.emplace(key, keyValueMap.getString(section, key));
 				}
 			}
 			else
 			{
-				DebugLogWarning("Key \"" + key + "\" not recognized in " + filename + ".");
+				DebugLogWarning("Key \"" + std::string(key) + "\" not recognized in " +
+					filename + ".");
 			}
 		}
 	}
 }
 
+void Options::checkOwnerThread() const
+{
+	DebugAssertMsg(std::this_thread::get_id() == this->ownerThread,
+		"Options can only be used from the thread that made them.");
+}
+
 bool Options::getBool(const std::string &section, const std::string &key) const
 {
 	auto getValuePtr = [](const std::string &section, const std::string &key,
@@ -459,6 +506,18 @@ void Options::checkGraphics_TargetFPS(int value) const
 		std::to_string(Options::MIN_FPS) + ".");
 }
 
+void Options::checkGraphics_BackgroundFPS(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_BACKGROUND_FPS,
+		"Background FPS cannot be less than " +
+		std::to_string(Options::MIN_BACKGROUND_FPS) + ".");
+}
+
+void Options::checkGraphics_VoxelDetailDistance(double value) const
+{
+	DebugAssertMsg(value >= 0.0, "Voxel detail distance cannot be negative.");
+}
+
 void Options::checkGraphics_ResolutionScale(double value) const
 {
 	DebugAssertMsg(value > 0.0, "Resolution scale must be positive.");
@@ -483,6 +542,16 @@ void Options::checkGraphics_LetterboxMode(int value) const
 		std::to_string(Options::MAX_LETTERBOX_MODE) + ".");
 }
 
+void Options::checkGraphics_OriginalUIScale(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_ORIGINAL_UI_SCALE,
+		"Original UI scale cannot be less than " +
+		std::to_string(Options::MIN_ORIGINAL_UI_SCALE) + ".");
+	DebugAssertMsg(value <= Options::MAX_ORIGINAL_UI_SCALE,
+		"Original UI scale cannot be greater than " +
+		std::to_string(Options::MAX_ORIGINAL_UI_SCALE) + ".");
+}
+
 void Options::checkGraphics_CursorScale(double value) const
 {
 	DebugAssertMsg(value >= Options::MIN_CURSOR_SCALE,
@@ -503,6 +572,21 @@ void Options::checkGraphics_RenderThreadsMode(int value) const
 		std::to_string(Options::MAX_RENDER_THREADS_MODE) + ".");
 }
 
+void Options::checkGraphics_RenderThreadsAutoCount(int value) const
+{
+	DebugAssertMsg(value >= 0, "Render threads auto count cannot be negative.");
+}
+
+void Options::checkGraphics_RenderThreadsAffinity(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_RENDER_THREADS_AFFINITY,
+		"Render threads affinity cannot be less than " +
+		std::to_string(Options::MIN_RENDER_THREADS_AFFINITY) + ".");
+	DebugAssertMsg(value <= Options::MAX_RENDER_THREADS_AFFINITY,
+		"Render threads affinity cannot be greater than " +
+		std::to_string(Options::MAX_RENDER_THREADS_AFFINITY) + ".");
+}
+
 void Options::checkAudio_MusicVolume(double value) const
 {
 	DebugAssertMsg(value >= Options::MIN_VOLUME, "Music volume cannot be negative.");
@@ -531,6 +615,28 @@ void Options::checkAudio_SoundResampling(int value) const
 		std::to_string(Options::RESAMPLING_OPTION_COUNT - 1) + ".");
 }
 
+void Options::checkAudio_MusicCacheMegabytes(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_MUSIC_CACHE_MEGABYTES,
+		"Music cache megabytes cannot be less than " +
+		std::to_string(Options::MIN_MUSIC_CACHE_MEGABYTES) + ".");
+}
+
+void Options::checkAudio_SoundLoadResampling(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_SOUND_LOAD_RESAMPLING,
+		"Sound load resampling cannot be less than " +
+		std::to_string(Options::MIN_SOUND_LOAD_RESAMPLING) + ".");
+	DebugAssertMsg(value <= Options::MAX_SOUND_LOAD_RESAMPLING,
+		"Sound load resampling cannot be greater than " +
+		std::to_string(Options::MAX_SOUND_LOAD_RESAMPLING) + ".");
+}
+
+void Options::checkAudio_BackgroundUpdateInterval(int value) const
+{
+	DebugAssertMsg(value > 0, "Background audio update interval must be positive.");
+}
+
 void Options::checkInput_HorizontalSensitivity(double value) const
 {
 	DebugAssertMsg(value >= Options::MIN_HORIZONTAL_SENSITIVITY,
@@ -581,11 +687,85 @@ void Options::checkMisc_StarDensity(int value) const
 		std::to_string(Options::MAX_STAR_DENSITY_MODE) + ".");
 }
 
+void Options::checkMisc_FrameCaptureInterval(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_FRAME_CAPTURE_INTERVAL,
+		"Frame capture interval cannot be less than " +
+		std::to_string(Options::MIN_FRAME_CAPTURE_INTERVAL) + ".");
+}
+
+void Options::checkMisc_ChunkDistance(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_CHUNK_DISTANCE,
+		"Chunk distance cannot be less than " +
+		std::to_string(Options::MIN_CHUNK_DISTANCE) + ".");
+}
+
+void Options::checkMisc_TextureCacheMegabytes(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_TEXTURE_CACHE_MEGABYTES,
+		"Texture cache megabytes cannot be less than " +
+		std::to_string(Options::MIN_TEXTURE_CACHE_MEGABYTES) + ".");
+}
+
+void Options::checkMisc_TickRate(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_TICK_RATE, "Tick rate cannot be less than " +
+		std::to_string(Options::MIN_TICK_RATE) + ".");
+}
+
+void Options::checkMisc_FrameStatsInterval(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_FRAME_STATS_INTERVAL,
+		"Frame stats interval cannot be less than " +
+		std::to_string(Options::MIN_FRAME_STATS_INTERVAL) + ".");
+}
+
+void Options::checkMisc_FrameStatsFormat(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_FRAME_STATS_FORMAT,
+		"Frame stats format cannot be less than " +
+		std::to_string(Options::MIN_FRAME_STATS_FORMAT) + ".");
+	DebugAssertMsg(value <= Options::MAX_FRAME_STATS_FORMAT,
+		"Frame stats format cannot be greater than " +
+		std::to_string(Options::MAX_FRAME_STATS_FORMAT) + ".");
+}
+
+void Options::checkMisc_LogLevel(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_LOG_LEVEL, "Log level cannot be less than " +
+		std::to_string(Options::MIN_LOG_LEVEL) + ".");
+	DebugAssertMsg(value <= Options::MAX_LOG_LEVEL, "Log level cannot be greater than " +
+		std::to_string(Options::MAX_LOG_LEVEL) + ".");
+}
+
+void Options::checkMisc_LogRateLimit(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_LOG_RATE_LIMIT,
+		"Log rate limit cannot be less than " +
+		std::to_string(Options::MIN_LOG_RATE_LIMIT) + ".");
+}
+
+void Options::checkMisc_MemoryReportInterval(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_MEMORY_REPORT_INTERVAL,
+		"Memory report interval cannot be less than " +
+		std::to_string(Options::MIN_MEMORY_REPORT_INTERVAL) + ".");
+}
+
+void Options::checkMisc_MetricsInterval(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_METRICS_INTERVAL,
+		"Metrics interval cannot be less than " +
+		std::to_string(Options::MIN_METRICS_INTERVAL) + ".");
+}
+
 void Options::loadDefaults(const std::string &filename)
 {
 	DebugLog("Reading defaults \"" + filename + "\".");
 
 	Options::load(filename, this->defaultMaps);
+	this->generation++;
 }
 
 void Options::loadChanges(const std::string &filename)
@@ -593,6 +773,7 @@ void Options::loadChanges(const std::string &filename)
 	DebugLog("Reading changes \"" + filename + "\".");
 
 	Options::load(filename, this->changedMaps);
+	this->generation++;
 }
 
 void Options::saveChanges()
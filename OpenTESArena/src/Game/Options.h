@@ -2,6 +2,7 @@
 #define OPTIONS_H
 
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 // Settings found in the options menu are saved in this object, which should live in
@@ -30,6 +31,39 @@ private:
 	// section in the options file has its own map of values.
 	std::unordered_map<std::string, MapGroup> defaultMaps, changedMaps;
 
+	// An option's value as of a certain generation of the maps above.
+	template <typename T>
+	struct CachedValue
+	{
+		T value;
+		int generation;
+
+		CachedValue()
+		{
+			this->value = T();
+			this->generation = -1;
+		}
+
+		void set(const T &value, int generation)
+		{
+			this->value = value;
+			this->generation = generation;
+		}
+	};
+
+	// Incremented whenever a file is loaded into the maps, so every cached value gets
+	// looked up again the next time it's read. Setters keep their own cache current.
+	int generation = 0;
+
+	// Thread that made the options (the main thread). The caches are written by const
+	// getters without any locking, so options are only used from this thread, and other
+	// threads are given copies of the values they need.
+	std::thread::id ownerThread = std::this_thread::get_id();
+
+	// Causes an error if not called from the owner thread. Checked wherever a cache is
+	// written.
+	void checkOwnerThread() const;
+
 	// Opens the given file and reads its key-value pairs into the given maps.
 	static void load(const std::string &filename,
 		std::unordered_map<std::string, Options::MapGroup> &maps);
@@ -58,6 +92,7 @@ public:
 
 	// Min/max/allowed values for the application.
 	static const int MIN_FPS;
+	static const int MIN_BACKGROUND_FPS;
 	static const double MIN_RESOLUTION_SCALE;
 	static const double MAX_RESOLUTION_SCALE;
 	static const double MIN_VERTICAL_FOV;
@@ -66,8 +101,13 @@ public:
 	static const double MAX_CURSOR_SCALE;
 	static const int MIN_LETTERBOX_MODE;
 	static const int MAX_LETTERBOX_MODE;
+	static const int MIN_ORIGINAL_UI_SCALE;
+	static const int MAX_ORIGINAL_UI_SCALE;
 	static const int MIN_RENDER_THREADS_MODE;
 	static const int MAX_RENDER_THREADS_MODE;
+	static const int AUTO_RENDER_THREADS_MODE; // Tuned at runtime (see RenderThreadsAutoCount).
+	static const int MIN_RENDER_THREADS_AFFINITY;
+	static const int MAX_RENDER_THREADS_AFFINITY;
 	static const double MIN_HORIZONTAL_SENSITIVITY;
 	static const double MAX_HORIZONTAL_SENSITIVITY;
 	static const double MIN_VERTICAL_SENSITIVITY;
@@ -78,57 +118,118 @@ public:
 	static const double MAX_VOLUME;
 	static const int MIN_SOUND_CHANNELS;
 	static const int RESAMPLING_OPTION_COUNT;
+	static const int MIN_MUSIC_CACHE_MEGABYTES;
+	static const int MIN_SOUND_LOAD_RESAMPLING;
+	static const int MAX_SOUND_LOAD_RESAMPLING;
 	static const double MIN_TIME_SCALE;
 	static const double MAX_TIME_SCALE;
 	static const int MIN_STAR_DENSITY_MODE;
 	static const int MAX_STAR_DENSITY_MODE;
+	static const int MIN_FRAME_CAPTURE_INTERVAL;
+	static const int MIN_CHUNK_DISTANCE;
+	static const int MIN_TEXTURE_CACHE_MEGABYTES;
+	static const int MIN_TICK_RATE;
+	static const int MIN_FRAME_STATS_INTERVAL;
+	static const int MIN_FRAME_STATS_FORMAT;
+	static const int MAX_FRAME_STATS_FORMAT;
+	static const int MIN_LOG_LEVEL;
+	static const int MAX_LOG_LEVEL;
+	static const int MIN_LOG_RATE_LIMIT;
+	static const int MIN_MEMORY_REPORT_INTERVAL;
+	static const int MIN_METRICS_INTERVAL;
+
+// Each option keeps its resolved value next to the generation of the maps it was resolved
+// from, so getters are a compare and a load unless the maps were reloaded since. The caches
+// aren't synchronized, so getters and setters are for the owner thread only.
+#define OPTION_CACHE(type, section, name) \
+private: \
+mutable Options::CachedValue<type> section##_##name##Cache; \
+public:
 
 #define OPTION_BOOL(section, name) \
+OPTION_CACHE(bool, section, name) \
 bool get##section##_##name() const \
 { \
-	return this->getBool(#section, #name); \
+	auto &cache = this->section##_##name##Cache; \
+	if (cache.generation != this->generation) \
+	{ \
+		this->checkOwnerThread(); \
+		cache.value = this->getBool(#section, #name); \
+		cache.generation = this->generation; \
+	} \
+	return cache.value; \
 } \
 void set##section##_##name(bool value) \
 { \
+	this->checkOwnerThread(); \
 	this->setBool(#section, #name, value); \
+	this->section##_##name##Cache.set(value, this->generation); \
 }
 
 #define OPTION_INT(section, name) \
+OPTION_CACHE(int, section, name) \
 void check##section##_##name(int value) const; \
 int get##section##_##name() const \
 { \
-	const int value = this->getInt(#section, #name); \
-	this->check##section##_##name(value); \
-	return value; \
+	auto &cache = this->section##_##name##Cache; \
+	if (cache.generation != this->generation) \
+	{ \
+		this->checkOwnerThread(); \
+		cache.value = this->getInt(#section, #name); \
+		this->check##section##_##name(cache.value); \
+		cache.generation = this->generation; \
+	} \
+	return cache.value; \
 } \
 void set##section##_##name(int value) \
 { \
 	this->check##section##_##name(value); \
+	this->checkOwnerThread(); \
 	this->setInt(#section, #name, value); \
+	this->section##_##name##Cache.set(value, this->generation); \
 }
 
 #define OPTION_DOUBLE(section, name) \
+OPTION_CACHE(double, section, name) \
 void check##section##_##name(double value) const; \
 double get##section##_##name() const \
 { \
-	const double value = this->getDouble(#section, #name); \
-	this->check##section##_##name(value); \
-	return value; \
+	auto &cache = this->section##_##name##Cache; \
+	if (cache.generation != this->generation) \
+	{ \
+		this->checkOwnerThread(); \
+		cache.value = this->getDouble(#section, #name); \
+		this->check##section##_##name(cache.value); \
+		cache.generation = this->generation; \
+	} \
+	return cache.value; \
 } \
 void set##section##_##name(double value) \
 { \
 	this->check##section##_##name(value); \
+	this->checkOwnerThread(); \
 	this->setDouble(#section, #name, value); \
+	this->section##_##name##Cache.set(value, this->generation); \
 }
 
 #define OPTION_STRING(section, name) \
+OPTION_CACHE(std::string, section, name) \
 const std::string &get##section##_##name() const \
 { \
-	return this->getString(#section, #name); \
+	auto &cache = this->section##_##name##Cache; \
+	if (cache.generation != this->generation) \
+	{ \
+		this->checkOwnerThread(); \
+		cache.value = this->getString(#section, #name); \
+		cache.generation = this->generation; \
+	} \
+	return cache.value; \
 } \
 void set##section##_##name(const std::string &value) \
 { \
+	this->checkOwnerThread(); \
 	this->setString(#section, #name, value); \
+	this->section##_##name##Cache.set(value, this->generation); \
 }
 
 	// Getter, setter, and optional checker methods.
@@ -140,15 +241,29 @@ void set##section##_##name(const std::string &value) \
 	OPTION_DOUBLE(Graphics, VerticalFOV)
 	OPTION_BOOL(Graphics, ParallaxSky)
 	OPTION_INT(Graphics, LetterboxMode)
+	OPTION_INT(Graphics, OriginalUIScale)
 	OPTION_DOUBLE(Graphics, CursorScale)
 	OPTION_BOOL(Graphics, ModernInterface)
 	OPTION_INT(Graphics, RenderThreadsMode)
+	OPTION_INT(Graphics, RenderThreadsAutoCount)
+	OPTION_INT(Graphics, RenderThreadsAffinity)
+	OPTION_STRING(Graphics, RenderThreadsCores)
+	OPTION_BOOL(Graphics, RenderThreadsHighPriority)
+	OPTION_BOOL(Graphics, PipelinedFrames)
+	OPTION_BOOL(Graphics, DynamicResolution)
+	OPTION_BOOL(Graphics, InterlacedVoxels)
+	OPTION_BOOL(Graphics, PaletteRendering)
+	OPTION_INT(Graphics, BackgroundFPS)
+	OPTION_DOUBLE(Graphics, VoxelDetailDistance)
 
 	OPTION_DOUBLE(Audio, MusicVolume)
 	OPTION_DOUBLE(Audio, SoundVolume)
 	OPTION_STRING(Audio, MidiConfig)
 	OPTION_INT(Audio, SoundChannels)
 	OPTION_INT(Audio, SoundResampling)
+	OPTION_INT(Audio, MusicCacheMegabytes)
+	OPTION_INT(Audio, SoundLoadResampling)
+	OPTION_INT(Audio, BackgroundUpdateInterval)
 
 	OPTION_DOUBLE(Input, HorizontalSensitivity)
 	OPTION_DOUBLE(Input, VerticalSensitivity)
@@ -162,6 +277,22 @@ void set##section##_##name(const std::string &value) \
 	OPTION_BOOL(Misc, ShowCompass)
 	OPTION_DOUBLE(Misc, TimeScale)
 	OPTION_INT(Misc, StarDensity)
+	OPTION_BOOL(Misc, ClassicStarSequence)
+	OPTION_INT(Misc, FrameCaptureInterval)
+	OPTION_INT(Misc, ChunkDistance)
+	OPTION_BOOL(Misc, LevelCache)
+	OPTION_BOOL(Misc, ImagePack)
+	OPTION_INT(Misc, TextureCacheMegabytes)
+	OPTION_INT(Misc, TickRate)
+	OPTION_STRING(Misc, HitchThresholds)
+	OPTION_INT(Misc, FrameStatsInterval)
+	OPTION_INT(Misc, FrameStatsFormat)
+	OPTION_BOOL(Misc, QuickSaveCompression)
+	OPTION_INT(Misc, LogLevel)
+	OPTION_INT(Misc, LogRateLimit)
+	OPTION_STRING(Misc, CpuIsaLimit)
+	OPTION_INT(Misc, MemoryReportInterval)
+	OPTION_INT(Misc, MetricsInterval)
 
 	// Reads all the key-values pairs from the given absolute path into the default members.
 	void loadDefaults(const std::string &filename);
@@ -1,6 +1,11 @@
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 #include "Physics.h"
+#include "../Entities/Entity.h"
+#include "../Entities/EntityManager.h"
 #include "../Utilities/Debug.h"
 #include "../World/VoxelDataType.h"
 #include "../World/VoxelGrid.h"
@@ -290,8 +295,123 @@ bool Physics::testVoxelRay(const Double3 &rayStart, const Double3 &direction,
 	}
 }
 
-bool Physics::rayCast(const Double3 &rayStart, const Double3 &direction, double ceilingHeight,
-	const VoxelGrid &voxelGrid, Physics::Hit &hit)
+bool Physics::testEntityRay(const Double3 &rayStart, const Double3 &direction,
+	const Entity &entity, bool hasHit, Physics::Hit &hit)
+{
+	// Intersect the ray with the entity's bounding circle in the XZ plane, using XZ distances
+	// like the voxel tests.
+	const Double2 directionXZ = Double2(direction.x, direction.z).normalized();
+	const Double3 &position = entity.getPosition();
+	const Double2 diff(rayStart.x - position.x, rayStart.z - position.z);
+	const double radius = EntityManager::ENTITY_RADIUS;
+	const double b = diff.dot(directionXZ);
+	const double c = diff.dot(diff) - (radius * radius);
+	if ((c > 0.0) && (b > 0.0))
+	{
+		// Outside the circle and pointing away from it.
+		return false;
+	}
+
+	const double discriminant = (b * b) - c;
+	if (discriminant < 0.0)
+	{
+		return false;
+	}
+
+	// Rays starting inside the circle hit it right away.
+	const double t = std::max(-b - std::sqrt(discriminant), 0.0);
+	if (hasHit && (t >= hit.t))
+	{
+		return false;
+	}
+
+	// The hit has to be within the entity's height.
+	const double lengthXZ = std::sqrt((direction.x * direction.x) + (direction.z * direction.z));
+	const double t3D = t / lengthXZ;
+	const Double3 point = rayStart + (direction * t3D);
+	if ((point.y < position.y) || (point.y > (position.y + EntityManager::ENTITY_HEIGHT)))
+	{
+		return false;
+	}
+
+	hit.t = t;
+	hit.point = point;
+	hit.voxel = Int3(
+		static_cast<int>(std::floor(position.x)),
+		static_cast<int>(std::floor(position.y)),
+		static_cast<int>(std::floor(position.z)));
+	hit.type = Hit::Type::Entity;
+	hit.entityID = entity.getID();
+	return true;
+}
+
+const int Physics::RAY_BATCH_SIZE = 32;
+const int Physics::MAX_SLIDES = 3;
+const double Physics::SWEEP_SKIN = 0.001;
+
+Physics::Ray::Ray(const Double3 &start, const Double3 &direction, double maxDistance)
+	: start(start), direction(direction)
+{
+	this->maxDistance = maxDistance;
+}
+
+bool Physics::getBoxTimeOfImpact(const Double2 &position, double halfWidth,
+	const Double2 &delta, int voxelX, int voxelZ, double &t, Double2 &normal)
+{
+	// Grow the voxel's square by the box's half width so the box can be treated as a point
+	// moving along the delta, then intersect that segment with the square's slabs.
+	const double minX = static_cast<double>(voxelX) - halfWidth;
+	const double maxX = static_cast<double>(voxelX) + 1.0 + halfWidth;
+	const double minZ = static_cast<double>(voxelZ) - halfWidth;
+	const double maxZ = static_cast<double>(voxelZ) + 1.0 + halfWidth;
+
+	// Already overlapping is not a hit.
+	if ((position.x > minX) && (position.x < maxX) && (position.y > minZ) && (position.y < maxZ))
+	{
+		return false;
+	}
+
+	// Lambda for getting the entry and exit fractions along one axis. A box not moving on
+	// an axis is either always or never within that slab.
+	auto getSlab = [](double start, double move, double slabMin, double slabMax,
+		double &entry, double &exit)
+	{
+		if (move == 0.0)
+		{
+			const bool inside = (start > slabMin) && (start < slabMax);
+			entry = inside ? -std::numeric_limits<double>::infinity() :
+				std::numeric_limits<double>::infinity();
+			exit = std::numeric_limits<double>::infinity();
+		}
+		else
+		{
+			const double t0 = (slabMin - start) / move;
+			const double t1 = (slabMax - start) / move;
+			entry = std::min(t0, t1);
+			exit = std::max(t0, t1);
+		}
+	};
+
+	double entryX, exitX, entryZ, exitZ;
+	getSlab(position.x, delta.x, minX, maxX, entryX, exitX);
+	getSlab(position.y, delta.y, minZ, maxZ, entryZ, exitZ);
+
+	const double entry = std::max(entryX, entryZ);
+	const double exit = std::min(exitX, exitZ);
+	if ((entry > exit) || (entry < 0.0) || (entry > 1.0))
+	{
+		return false;
+	}
+
+	t = entry;
+	normal = (entryX > entryZ) ? Double2((delta.x > 0.0) ? -1.0 : 1.0, 0.0) :
+		Double2(0.0, (delta.y > 0.0) ? -1.0 : 1.0);
+	return true;
+}
+
+bool Physics::rayCastInternal(const Double3 &rayStart, const Double3 &direction,
+	double ceilingHeight, double maxDistance, const VoxelGrid &voxelGrid, bool skipEmptyBlocks,
+	Physics::Hit &hit)
 {
 	const Double3 voxelReal(
 		std::floor(rayStart.x),
@@ -389,7 +509,7 @@ bool Physics::rayCast(const Double3 &rayStart, const Double3 &direction, double
 		if (success)
 		{
 			// The ray hit something in the first block, so it can return early.
-			return true;
+			return hit.t <= maxDistance;
 		}
 	}
 	
@@ -442,6 +562,54 @@ bool Physics::rayCast(const Double3 &rayStart, const Double3 &direction, double
 	// intersection has occurred.
 	while (voxelIsValid)
 	{
+		// The Z distance is to the near side of the current voxel, so nothing from here on
+		// can be hit within the max distance.
+		if (zDistance > maxDistance)
+		{
+			break;
+		}
+
+		// If the ray's height is empty in a block around here, step across the rest of the
+		// block without testing any voxels. Lone empty voxels are left to the regular step.
+		const int emptySpan = skipEmptyBlocks ?
+			voxelGrid.getEmptyLayerSpan(cell.x, cell.y, cell.z) : 0;
+		if (emptySpan > 1)
+		{
+			// Only the side distances and cell change until the ray leaves the block, so the
+			// last step is the only one that needs the full DDA step.
+			const int blockMinX = (cell.x / emptySpan) * emptySpan;
+			const int blockMinZ = (cell.z / emptySpan) * emptySpan;
+			const int lastX = nonNegativeDirX ? (blockMinX + emptySpan - 1) : blockMinX;
+			const int lastZ = nonNegativeDirZ ? (blockMinZ + emptySpan - 1) : blockMinZ;
+
+			while (true)
+			{
+				if (sideDistX < sideDistZ)
+				{
+					if (cell.x == lastX)
+					{
+						break;
+					}
+
+					sideDistX += deltaDistX;
+					cell.x += stepX;
+				}
+				else
+				{
+					if (cell.z == lastZ)
+					{
+						break;
+					}
+
+					sideDistZ += deltaDistZ;
+					cell.z += stepZ;
+				}
+			}
+
+			doDDAStep();
+			continue;
+		}
+
 		// Store the cell coordinates, axis, and Z distance for wall rendering. The
 		// loop needs to do another DDA step to calculate the far point.
 		const int savedCellX = cell.x;
@@ -460,25 +628,180 @@ bool Physics::rayCast(const Double3 &rayStart, const Double3 &direction, double
 			rayStart.x + (dirX * zDistance),
 			rayStart.z + (dirZ * zDistance));
 
-		// Check voxel.
+		// Check voxel if it isn't empty.
+		if (voxelGrid.getVoxelMask(savedCellX, savedCellY, savedCellZ) == 0)
+		{
+			continue;
+		}
+
 		const Int3 savedCell(savedCellX, savedCellY, savedCellZ);
 		const bool success = Physics::testVoxelRay(rayStart, directionXZ_3D, savedCell,
 			savedFacing, nearPoint, farPoint, ceilingHeight, voxelGrid, hit);
 
 		if (success)
 		{
-			// The ray hit something.
-			return true;
+			// The ray hit something, though some voxel shapes can put the hit past the max
+			// distance.
+			return hit.t <= maxDistance;
 		}
 	}
 
-	// The ray exited the voxel grid without hitting anything.
+	// The ray exited the voxel grid or went past its max distance without hitting anything.
 	return false;
 }
 
+bool Physics::rayCast(const Double3 &rayStart, const Double3 &direction, double ceilingHeight,
+	const VoxelGrid &voxelGrid, Physics::Hit &hit)
+{
+	const bool skipEmptyBlocks = true;
+	const double maxDistance = std::numeric_limits<double>::infinity();
+	return Physics::rayCastInternal(rayStart, direction, ceilingHeight, maxDistance, voxelGrid,
+		skipEmptyBlocks, hit);
+}
+
+bool Physics::rayCastEveryVoxel(const Double3 &rayStart, const Double3 &direction,
+	double ceilingHeight, const VoxelGrid &voxelGrid, Physics::Hit &hit)
+{
+	const bool skipEmptyBlocks = false;
+	const double maxDistance = std::numeric_limits<double>::infinity();
+	return Physics::rayCastInternal(rayStart, direction, ceilingHeight, maxDistance, voxelGrid,
+		skipEmptyBlocks, hit);
+}
+
 bool Physics::rayCast(const Double3 &point, const Double3 &direction, const VoxelGrid &voxelGrid,
 	Physics::Hit &hit)
 {
 	const double ceilingHeight = 1.0;
 	return Physics::rayCast(point, direction, ceilingHeight, voxelGrid, hit);
 }
+
+bool Physics::rayCast(const Double3 &rayStart, const Double3 &direction, double ceilingHeight,
+	const VoxelGrid &voxelGrid, const EntityManager &entityManager, Physics::Hit &hit)
+{
+	bool hasHit = Physics::rayCast(rayStart, direction, ceilingHeight, voxelGrid, hit);
+
+	// Only entities closer than the voxel hit can be hit. Without one, the ray goes as far as
+	// the voxel grid is wide.
+	const double maxDistance = hasHit ? hit.t : std::sqrt(static_cast<double>(
+		(voxelGrid.getWidth() * voxelGrid.getWidth()) + (voxelGrid.getDepth() * voxelGrid.getDepth())));
+
+	std::vector<Entity*> entities;
+	const Double2 directionXZ = Double2(direction.x, direction.z).normalized();
+	entityManager.getEntitiesOnRay(Double2(rayStart.x, rayStart.z), directionXZ,
+		maxDistance, entities);
+
+	for (const Entity *entity : entities)
+	{
+		hasHit |= Physics::testEntityRay(rayStart, direction, *entity, hasHit, hit);
+	}
+
+	return hasHit;
+}
+
+void Physics::rayCast(const Physics::Ray *rays, int count, double ceilingHeight,
+	const VoxelGrid &voxelGrid, Physics::Hit *hits)
+{
+	const bool skipEmptyBlocks = true;
+	for (int i = 0; i < count; i++)
+	{
+		const Ray &ray = rays[i];
+		Physics::Hit &hit = hits[i];
+
+		// Rays with no length can't hit anything.
+		const bool success = (ray.maxDistance > 0.0) && Physics::rayCastInternal(ray.start,
+			ray.direction, ceilingHeight, ray.maxDistance, voxelGrid, skipEmptyBlocks, hit);
+
+		if (!success)
+		{
+			hit.t = std::numeric_limits<double>::infinity();
+		}
+	}
+}
+
+void Physics::rayCast(const Physics::Ray *rays, int count, double ceilingHeight,
+	const VoxelGrid &voxelGrid, Physics::Hit *hits, const ParallelFunction &runParallel)
+{
+	// Small batches aren't worth waking other threads for.
+	const int batchCount = (count + Physics::RAY_BATCH_SIZE - 1) / Physics::RAY_BATCH_SIZE;
+	if (batchCount <= 1)
+	{
+		Physics::rayCast(rays, count, ceilingHeight, voxelGrid, hits);
+		return;
+	}
+
+	// Each batch only writes its own rays' hits.
+	runParallel(batchCount, [rays, count, ceilingHeight, &voxelGrid, hits](int batchIndex)
+	{
+		const int begin = batchIndex * Physics::RAY_BATCH_SIZE;
+		const int end = std::min(begin + Physics::RAY_BATCH_SIZE, count);
+		Physics::rayCast(rays + begin, end - begin, ceilingHeight, voxelGrid, hits + begin);
+	});
+}
+
+Double2 Physics::sweepBox(const Double2 &position, double halfWidth, const Double2 &delta,
+	int voxelY, const VoxelGrid &voxelGrid, const std::function<bool(const Int3&)> &isSolid)
+{
+	DebugAssert(halfWidth >= 0.0);
+
+	Double2 currentPosition = position;
+	Double2 remaining = delta;
+	for (int i = 0; i < Physics::MAX_SLIDES; i++)
+	{
+		if ((remaining.x == 0.0) && (remaining.y == 0.0))
+		{
+			break;
+		}
+
+		// Voxels the box could touch anywhere between its start and end, clamped to the grid
+		// since everything outside it is air.
+		const Double2 endPosition = currentPosition + remaining;
+		const int minX = std::max(static_cast<int>(std::floor(
+			std::min(currentPosition.x, endPosition.x) - halfWidth)), 0);
+		const int maxX = std::min(static_cast<int>(std::floor(
+			std::max(currentPosition.x, endPosition.x) + halfWidth)), voxelGrid.getWidth() - 1);
+		const int minZ = std::max(static_cast<int>(std::floor(
+			std::min(currentPosition.y, endPosition.y) - halfWidth)), 0);
+		const int maxZ = std::min(static_cast<int>(std::floor(
+			std::max(currentPosition.y, endPosition.y) + halfWidth)), voxelGrid.getDepth() - 1);
+
+		// Find the earliest hit.
+		bool hasHit = false;
+		double hitT = 1.0;
+		Double2 hitNormal;
+		if ((voxelY >= 0) && (voxelY < voxelGrid.getHeight()))
+		{
+			for (int z = minZ; z <= maxZ; z++)
+			{
+				for (int x = minX; x <= maxX; x++)
+				{
+					double t;
+					Double2 normal;
+					if (Physics::getBoxTimeOfImpact(currentPosition, halfWidth, remaining,
+						x, z, t, normal) && (t < hitT) && isSolid(Int3(x, voxelY, z)))
+					{
+						hasHit = true;
+						hitT = t;
+						hitNormal = normal;
+					}
+				}
+			}
+		}
+
+		if (!hasHit)
+		{
+			currentPosition = endPosition;
+			break;
+		}
+
+		// Move up to the hit, held back a little along the movement.
+		const double moveLength = remaining.length();
+		const double skinT = std::min(Physics::SWEEP_SKIN / moveLength, hitT);
+		currentPosition = currentPosition + (remaining * (hitT - skinT));
+
+		// Slide along the face with whatever movement is left.
+		const Double2 leftover = remaining * (1.0 - hitT);
+		remaining = leftover - (hitNormal * leftover.dot(hitNormal));
+	}
+
+	return currentPosition - position;
+}
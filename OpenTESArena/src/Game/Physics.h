@@ -1,12 +1,16 @@
 #ifndef PHYSICS_H
 #define PHYSICS_H
 
+#include <functional>
+
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../World/VoxelData.h"
 
 // Static class for physics-related calculations like ray casting.
 
+class Entity;
+class EntityManager;
 class VoxelGrid;
 
 class Physics
@@ -24,7 +28,38 @@ public:
 		Hit::Type type;
 		union { uint16_t voxelID; int entityID; };
 	};
+
+	// A ray for batched ray casts. Only hits within the max distance (in the XZ plane) count.
+	struct Ray
+	{
+		Double3 start, direction;
+		double maxDistance;
+
+		Ray(const Double3 &start, const Double3 &direction, double maxDistance);
+	};
+
+	// Runs a function once for each batch index, possibly on other threads, and returns when
+	// every batch is done (i.e., Renderer::runParallel()).
+	typedef std::function<void(int batchCount, const std::function<void(int)> &batchFunction)>
+		ParallelFunction;
 private:
+	// Most rays cast by one batch in a parallel batched ray cast.
+	static const int RAY_BATCH_SIZE;
+
+	// Most times a swept box slides along a wall per sweep, so a box pushed into a corner
+	// stops instead of sliding back and forth.
+	static const int MAX_SLIDES;
+
+	// Distance a swept box is held back from whatever it hits, so floating-point error
+	// doesn't leave it touching or inside the voxel.
+	static const double SWEEP_SKIN;
+
+	// Gets the fraction (0 to 1) of a box's movement where it first touches a voxel's XZ
+	// square, and the voxel face's normal. Returns false if the box misses or already
+	// overlaps the voxel.
+	static bool getBoxTimeOfImpact(const Double2 &position, double halfWidth,
+		const Double2 &delta, int voxelX, int voxelZ, double &t, Double2 &normal);
+
 	Physics() = delete;
 	~Physics() = delete;
 
@@ -41,15 +76,54 @@ private:
 		const Int3 &voxel, VoxelData::Facing facing, const Double2 &nearPoint,
 		const Double2 &farPoint, double ceilingHeight, const VoxelGrid &voxelGrid,
 		Physics::Hit &hit);
-public:
-	// @todo: bit mask elements for each voxel data type.
 
+	// Checks an entity's bounding cylinder for a ray hit no farther than the hit's current
+	// distance (if there is one) and writes it into the output parameter. Returns true if the
+	// ray hit the entity.
+	static bool testEntityRay(const Double3 &rayStart, const Double3 &direction,
+		const Entity &entity, bool hasHit, Physics::Hit &hit);
+
+	// Ray cast shared by the public functions. The ray stops once it's past the max distance.
+	// If skipping empty blocks, the ray steps across blocks with nothing at its height without
+	// testing their voxels.
+	static bool rayCastInternal(const Double3 &rayStart, const Double3 &direction,
+		double ceilingHeight, double maxDistance, const VoxelGrid &voxelGrid,
+		bool skipEmptyBlocks, Physics::Hit &hit);
+public:
 	// Casts a ray through the world and writes any intersection data into the output
 	// parameter. Returns true if the ray hit something.
 	static bool rayCast(const Double3 &rayStart, const Double3 &direction, double ceilingHeight,
 		const VoxelGrid &voxelGrid, Physics::Hit &hit);
 	static bool rayCast(const Double3 &rayStart, const Double3 &direction,
 		const VoxelGrid &voxelGrid, Physics::Hit &hit);
+
+	// Same as rayCast() but also tests the entities near the ray, returning whichever of the
+	// nearest voxel and entity hits is closer.
+	static bool rayCast(const Double3 &rayStart, const Double3 &direction, double ceilingHeight,
+		const VoxelGrid &voxelGrid, const EntityManager &entityManager, Physics::Hit &hit);
+
+	// Casts each ray through the voxel grid and writes its intersection data into the hit at
+	// the same index. A ray that hits nothing within its max distance gets a hit distance of
+	// infinity. The parallel version splits large batches across threads through the given
+	// function.
+	static void rayCast(const Physics::Ray *rays, int count, double ceilingHeight,
+		const VoxelGrid &voxelGrid, Physics::Hit *hits);
+	static void rayCast(const Physics::Ray *rays, int count, double ceilingHeight,
+		const VoxelGrid &voxelGrid, Physics::Hit *hits, const ParallelFunction &runParallel);
+
+	// Moves an axis-aligned square (the XZ footprint of a collider) by a delta through one
+	// layer of the voxel grid, stopping at the first voxel the predicate says is solid and
+	// sliding along it for the rest of the delta. Every voxel the square can touch along the
+	// way is tested at once, so it can't tunnel through a wall however far it moves. Voxels
+	// the square already overlaps are ignored so it can't get stuck. Returns the delta the
+	// square actually moved.
+	static Double2 sweepBox(const Double2 &position, double halfWidth, const Double2 &delta,
+		int voxelY, const VoxelGrid &voxelGrid, const std::function<bool(const Int3&)> &isSolid);
+
+	// Same as rayCast() but tests every voxel along the way. Only for comparing against the
+	// accelerated version in benchmarks.
+	static bool rayCastEveryVoxel(const Double3 &rayStart, const Double3 &direction,
+		double ceilingHeight, const VoxelGrid &voxelGrid, Physics::Hit &hit);
 };
 
 #endif
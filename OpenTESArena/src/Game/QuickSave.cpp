@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "GameData.h"
+#include "QuickSave.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/File.h"
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/Platform.h"
+
+namespace
+{
+	// Start of every quicksave file, followed by the snapshot (compressed or not).
+	struct Header
+	{
+		uint32_t magic, version, isCompressed;
+		uint32_t snapshotSize, storedSize;
+	};
+
+	const uint32_t MAGIC = 0x56535141; // "AQSV".
+
+	// Shortest match worth a sequence, and the farthest back one can start.
+	const size_t MIN_MATCH = 4;
+	const size_t MAX_OFFSET = 65535;
+	const int HASH_BITS = 12;
+
+	// Writes the extra bytes of a length that didn't fit in its token nibble.
+	void writeLength(size_t length, std::vector<uint8_t> &dst)
+	{
+		while (length >= 255)
+		{
+			dst.push_back(255);
+			length -= 255;
+		}
+
+		dst.push_back(static_cast<uint8_t>(length));
+	}
+
+	// Writes one sequence: a token, literals, and a match unless it's the last sequence.
+	void writeSequence(const uint8_t *literals, size_t literalLength, size_t offset,
+		size_t matchLength, std::vector<uint8_t> &dst)
+	{
+		const size_t matchCode = (matchLength > 0) ? (matchLength - MIN_MATCH) : 0;
+		const uint8_t token = static_cast<uint8_t>(
+			(std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15));
+		dst.push_back(token);
+
+		if (literalLength >= 15)
+		{
+			writeLength(literalLength - 15, dst);
+		}
+
+		dst.insert(dst.end(), literals, literals + literalLength);
+
+		if (matchLength > 0)
+		{
+			dst.push_back(static_cast<uint8_t>(offset & 0xFF));
+			dst.push_back(static_cast<uint8_t>(offset >> 8));
+
+			if (matchCode >= 15)
+			{
+				writeLength(matchCode - 15, dst);
+			}
+		}
+	}
+
+	// Greedy LZ77 with one hash table slot per four-byte prefix.
+	std::vector<uint8_t> compress(const std::vector<uint8_t> &src)
+	{
+		std::vector<uint8_t> dst;
+		dst.reserve((src.size() / 2) + 16);
+
+		std::array<int64_t, 1 << HASH_BITS> table;
+		table.fill(-1);
+
+		const size_t size = src.size();
+		size_t anchor = 0;
+		size_t i = 0;
+		while ((i + MIN_MATCH) <= size)
+		{
+			uint32_t prefix;
+			std::memcpy(&prefix, src.data() + i, sizeof(prefix));
+			const uint32_t hash = (prefix * 2654435761u) >> (32 - HASH_BITS);
+			const int64_t candidate = table[hash];
+			table[hash] = static_cast<int64_t>(i);
+
+			if ((candidate >= 0) && ((i - static_cast<size_t>(candidate)) <= MAX_OFFSET) &&
+				(std::memcmp(src.data() + candidate, src.data() + i, MIN_MATCH) == 0))
+			{
+				size_t matchLength = MIN_MATCH;
+				while (((i + matchLength) < size) &&
+					(src[static_cast<size_t>(candidate) + matchLength] == src[i + matchLength]))
+				{
+					matchLength++;
+				}
+
+				writeSequence(src.data() + anchor, i - anchor,
+					i - static_cast<size_t>(candidate), matchLength, dst);
+
+				i += matchLength;
+				anchor = i;
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		// The rest are literals.
+		writeSequence(src.data() + anchor, size - anchor, 0, 0, dst);
+		return dst;
+	}
+
+	// Reads a length continued past its token nibble. Returns false if the input ends first.
+	bool readLength(const uint8_t *&src, const uint8_t *srcEnd, size_t &length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (src == srcEnd)
+			{
+				return false;
+			}
+
+			byte = *(src++);
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	// Returns false if the input is corrupt or doesn't decode to exactly the expected size.
+	bool decompress(const uint8_t *src, size_t srcSize, size_t dstSize, std::vector<uint8_t> &dst)
+	{
+		dst.clear();
+		dst.reserve(dstSize);
+
+		const uint8_t *srcEnd = src + srcSize;
+		while (src < srcEnd)
+		{
+			const uint8_t token = *(src++);
+
+			size_t literalLength = token >> 4;
+			if ((literalLength == 15) && !readLength(src, srcEnd, literalLength))
+			{
+				return false;
+			}
+
+			if ((static_cast<size_t>(srcEnd - src) < literalLength) ||
+				((dst.size() + literalLength) > dstSize))
+			{
+				return false;
+			}
+
+			dst.insert(dst.end(), src, src + literalLength);
+			src += literalLength;
+
+			// The last sequence has no match.
+			if (src == srcEnd)
+			{
+				break;
+			}
+
+			if ((srcEnd - src) < 2)
+			{
+				return false;
+			}
+
+			const size_t offset = static_cast<size_t>(src[0]) | (static_cast<size_t>(src[1]) << 8);
+			src += 2;
+
+			size_t matchLength = token & 0x0F;
+			if ((matchLength == 15) && !readLength(src, srcEnd, matchLength))
+			{
+				return false;
+			}
+
+			matchLength += MIN_MATCH;
+
+			if ((offset == 0) || (offset > dst.size()) || ((dst.size() + matchLength) > dstSize))
+			{
+				return false;
+			}
+
+			// Byte by byte since a match can overlap the bytes it's writing.
+			size_t matchIndex = dst.size() - offset;
+			for (size_t i = 0; i < matchLength; i++)
+			{
+				dst.push_back(dst[matchIndex + i]);
+			}
+		}
+
+		return dst.size() == dstSize;
+	}
+}
+
+const uint32_t QuickSave::VERSION = 1;
+
+QuickSave::~QuickSave()
+{
+	// Whatever the callback refers to might already be gone.
+	this->onFinished = std::function<void(bool)>();
+	this->waitForWrite();
+}
+
+std::string QuickSave::getFilename()
+{
+	return Platform::getSavePath() + "quicksave.sav";
+}
+
+bool QuickSave::write(const std::vector<uint8_t> &snapshot, bool compress)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	const std::vector<uint8_t> compressed =
+		compress ? ::compress(snapshot) : std::vector<uint8_t>();
+
+	// Keep it uncompressed if compressing didn't help.
+	const bool isCompressed = compress && (compressed.size() < snapshot.size());
+	const std::vector<uint8_t> &stored = isCompressed ? compressed : snapshot;
+
+	Header header;
+	header.magic = MAGIC;
+	header.version = QuickSave::VERSION;
+	header.isCompressed = isCompressed ? 1 : 0;
+	header.snapshotSize = static_cast<uint32_t>(snapshot.size());
+	header.storedSize = static_cast<uint32_t>(stored.size());
+
+	// Written to a temporary file first so a crash mid-write doesn't lose the last quicksave.
+	const std::string filename = QuickSave::getFilename();
+	const std::string tempFilename = filename + ".tmp";
+	{
+		std::ofstream ofs(tempFilename, std::ios::binary);
+		if (!ofs.is_open())
+		{
+			DebugLogWarning("Could not open \"" + tempFilename + "\" for writing.");
+			return false;
+		}
+
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(stored.data()), stored.size());
+		if (!ofs.good())
+		{
+			DebugLogWarning("Could not write \"" + tempFilename + "\".");
+			return false;
+		}
+	}
+
+	if (!File::replaceWithTemporary(tempFilename, filename))
+	{
+		DebugLogWarning("Could not replace \"" + filename + "\" with \"" + tempFilename + "\".");
+		return false;
+	}
+
+	const std::chrono::duration<double, std::milli> duration =
+		std::chrono::steady_clock::now() - startTime;
+	DebugLog("Quicksaved " + std::to_string(stored.size()) + " bytes (" +
+		std::to_string(snapshot.size()) + " uncompressed) in " +
+		std::to_string(static_cast<int>(duration.count())) + "ms.");
+	return true;
+}
+
+void QuickSave::waitForWrite()
+{
+	if (this->pendingWrite.valid())
+	{
+		this->finishWrite(this->pendingWrite.get());
+	}
+}
+
+void QuickSave::finishWrite(bool success)
+{
+	// Cleared before calling in case the callback starts another save.
+	std::function<void(bool)> onFinished = std::move(this->onFinished);
+	this->onFinished = std::function<void(bool)>();
+	if (onFinished)
+	{
+		onFinished(success);
+	}
+}
+
+bool QuickSave::isSaving() const
+{
+	return this->pendingWrite.valid() &&
+		(this->pendingWrite.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+}
+
+void QuickSave::update()
+{
+	if (this->pendingWrite.valid() &&
+		(this->pendingWrite.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+	{
+		this->finishWrite(this->pendingWrite.get());
+	}
+}
+
+void QuickSave::save(const GameData &gameData, bool compress,
+	const std::function<void(bool)> &onFinished)
+{
+	this->waitForWrite();
+
+	// The snapshot is a copy, so the game can keep changing while it's written.
+	std::vector<uint8_t> snapshot = gameData.makeSnapshot();
+	this->onFinished = onFinished;
+	this->pendingWrite = JobSystem::submit(JobSystem::Priority::Background,
+		[snapshot = std::move(snapshot), compress]()
+	{
+		return QuickSave::write(snapshot, compress);
+	});
+}
+
+bool QuickSave::load(GameData &gameData, const MiscAssets &miscAssets,
+	TextureManager &textureManager, Renderer &renderer)
+{
+	// A save still being written is the one to load.
+	this->waitForWrite();
+
+	const std::string filename = QuickSave::getFilename();
+	std::ifstream ifs(filename, std::ios::binary);
+	if (!ifs.is_open())
+	{
+		DebugLogWarning("No quicksave at \"" + filename + "\".");
+		return false;
+	}
+
+	const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(ifs)),
+		std::istreambuf_iterator<char>());
+
+	Header header;
+	if (bytes.size() < sizeof(header))
+	{
+		DebugLogWarning("Quicksave \"" + filename + "\" is too small.");
+		return false;
+	}
+
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	if ((header.magic != MAGIC) || (header.version != QuickSave::VERSION) ||
+		(bytes.size() != (sizeof(header) + header.storedSize)))
+	{
+		DebugLogWarning("Quicksave \"" + filename + "\" is from another version or is corrupt.");
+		return false;
+	}
+
+	const uint8_t *stored = bytes.data() + sizeof(header);
+	std::vector<uint8_t> snapshot;
+	if (header.isCompressed != 0)
+	{
+		if (!decompress(stored, header.storedSize, header.snapshotSize, snapshot))
+		{
+			DebugLogWarning("Could not decompress quicksave \"" + filename + "\".");
+			return false;
+		}
+	}
+	else
+	{
+		snapshot.assign(stored, stored + header.storedSize);
+	}
+
+	return gameData.restoreSnapshot(snapshot, miscAssets, textureManager, renderer);
+}
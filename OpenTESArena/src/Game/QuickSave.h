@@ -0,0 +1,70 @@
+#ifndef QUICK_SAVE_H
+#define QUICK_SAVE_H
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+// Writes and reads the quicksave, the engine's own snapshot of a game session (see
+// GameData::makeSnapshot()). It's separate from Arena's save files. The snapshot is copied
+// out of the game data on the main thread, then compressed and written on a background
+// thread so saving doesn't hitch the frame. The file is replaced in one step once it's on
+// disk, so a crash while saving leaves the previous quicksave intact.
+
+// Snapshots can be compressed with a small byte-oriented LZ77 coder laid out like LZ4
+// blocks, which is fast to decode and does well on the runs in voxel grids.
+
+class GameData;
+class MiscAssets;
+class Renderer;
+class TextureManager;
+
+class QuickSave
+{
+private:
+	// Incremented whenever the file layout or the compression changes. The snapshot inside
+	// has its own version.
+	static const uint32_t VERSION;
+
+	std::future<bool> pendingWrite;
+	std::function<void(bool)> onFinished; // For the save being written, if any.
+
+	static std::string getFilename();
+
+	// Compresses and writes a snapshot. Run on the writer thread.
+	static bool write(const std::vector<uint8_t> &snapshot, bool compress);
+
+	// Waits for the last save to finish writing, if any.
+	void waitForWrite();
+
+	// Calls the finished save's callback, if any.
+	void finishWrite(bool success);
+public:
+	QuickSave() = default;
+	QuickSave(const QuickSave&) = delete;
+	~QuickSave();
+
+	QuickSave &operator=(const QuickSave&) = delete;
+
+	// Returns whether a save is still being written.
+	bool isSaving() const;
+
+	// Calls the callback of a save that finished writing since the last call. Called once a
+	// tick so callbacks are on the main thread.
+	void update();
+
+	// Takes a snapshot of the game data and writes it in the background. Waits for the
+	// previous save if it's still being written. The optional callback is given whether
+	// the save was written.
+	void save(const GameData &gameData, bool compress,
+		const std::function<void(bool)> &onFinished);
+
+	// Reads the quicksave back into the game data, rebuilding its world. Returns false if
+	// there's no usable quicksave.
+	bool load(GameData &gameData, const MiscAssets &miscAssets, TextureManager &textureManager,
+		Renderer &renderer);
+};
+
+#endif
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <iterator>
+
+#include "Options.h"
+#include "RenderThreadTuner.h"
+#include "../Rendering/SoftwareRenderer.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/String.h"
+
+const int RenderThreadTuner::WARMUP_FRAMES = 30;
+const int RenderThreadTuner::SAMPLE_FRAMES = 90;
+
+RenderThreadTuner::RenderThreadTuner()
+{
+	this->candidateIndex = -1;
+	this->frameCount = 0;
+}
+
+std::vector<int> RenderThreadTuner::getCandidateThreadCounts()
+{
+	std::vector<int> threadCounts;
+	for (int mode = Options::MIN_RENDER_THREADS_MODE; mode < Options::AUTO_RENDER_THREADS_MODE;
+		mode++)
+	{
+		threadCounts.push_back(SoftwareRenderer::getRenderThreadsFromMode(mode));
+	}
+
+	std::sort(threadCounts.begin(), threadCounts.end());
+	threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()),
+		threadCounts.end());
+	return threadCounts;
+}
+
+bool RenderThreadTuner::isRunning() const
+{
+	return this->candidateIndex >= 0;
+}
+
+int RenderThreadTuner::getThreadCount() const
+{
+	DebugAssert(this->isRunning());
+	return this->threadCounts[this->candidateIndex];
+}
+
+int RenderThreadTuner::getBestThreadCount() const
+{
+	DebugAssert(!this->isRunning());
+	DebugAssert(this->medianSeconds.size() == this->threadCounts.size());
+
+	// Ties go to fewer threads since they leave more of the CPU for everything else.
+	const auto bestIter = std::min_element(this->medianSeconds.begin(),
+		this->medianSeconds.end());
+	return this->threadCounts[std::distance(this->medianSeconds.begin(), bestIter)];
+}
+
+void RenderThreadTuner::start()
+{
+	this->threadCounts = RenderThreadTuner::getCandidateThreadCounts();
+	this->medianSeconds.clear();
+	this->samples.clear();
+	this->candidateIndex = 0;
+	this->frameCount = 0;
+}
+
+bool RenderThreadTuner::update(double renderSeconds)
+{
+	DebugAssert(this->isRunning());
+
+	this->frameCount++;
+	if (this->frameCount <= RenderThreadTuner::WARMUP_FRAMES)
+	{
+		return false;
+	}
+
+	this->samples.push_back(renderSeconds);
+	if (static_cast<int>(this->samples.size()) < RenderThreadTuner::SAMPLE_FRAMES)
+	{
+		return false;
+	}
+
+	// The median leaves out frames that hitched on loading or the OS.
+	const auto medianIter = this->samples.begin() + (this->samples.size() / 2);
+	std::nth_element(this->samples.begin(), medianIter, this->samples.end());
+	this->medianSeconds.push_back(*medianIter);
+
+	DebugLog("Render threads " + std::to_string(this->getThreadCount()) + ": " +
+		String::fixedPrecision(*medianIter * 1000.0, 2) + "ms median.");
+
+	this->samples.clear();
+	this->frameCount = 0;
+	this->candidateIndex++;
+	if (this->candidateIndex == static_cast<int>(this->threadCounts.size()))
+	{
+		this->candidateIndex = -1;
+	}
+
+	return true;
+}
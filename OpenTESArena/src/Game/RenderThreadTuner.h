@@ -0,0 +1,47 @@
+#ifndef RENDER_THREAD_TUNER_H
+#define RENDER_THREAD_TUNER_H
+
+#include <vector>
+
+// Finds the fastest render thread count for the auto render threads mode by trying each of
+// the other modes' counts for a short while in the game world and comparing their median
+// render times. The best count depends on the CPU, SMT, and resolution, and past some point
+// the per-frame synchronization costs more than another thread gains.
+
+class RenderThreadTuner
+{
+private:
+	// Frames skipped after switching counts while the new threads settle in.
+	static const int WARMUP_FRAMES;
+
+	// Frames measured for each count.
+	static const int SAMPLE_FRAMES;
+
+	std::vector<int> threadCounts; // Candidates, fewest threads first.
+	std::vector<double> medianSeconds; // Median render time of each finished candidate.
+	std::vector<double> samples; // Render times of the current candidate.
+	int candidateIndex; // Index into the candidates, or -1 if not running.
+	int frameCount; // Frames since the current candidate started.
+public:
+	RenderThreadTuner();
+
+	// Gets the distinct thread counts of the fixed render threads modes on this CPU.
+	static std::vector<int> getCandidateThreadCounts();
+
+	bool isRunning() const;
+
+	// Gets the thread count being measured.
+	int getThreadCount() const;
+
+	// Gets the fastest thread count once every candidate has been measured.
+	int getBestThreadCount() const;
+
+	// Starts over with the first candidate.
+	void start();
+
+	// Adds the render time of a game world frame. Returns whether the candidate changed or
+	// tuning finished, in which case the caller should apply the new thread count.
+	bool update(double renderSeconds);
+};
+
+#endif
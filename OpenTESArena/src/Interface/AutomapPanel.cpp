@@ -26,10 +26,9 @@
 #include "../Media/TextureName.h"
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Surface.h"
-#include "../Utilities/Debug.h"
-#include "../World/VoxelData.h"
-#include "../World/VoxelDataType.h"
-#include "../World/VoxelGrid.h"
+#include "../Rendering/SurfaceBlitter.h"
+#include "../World/Automap.h"
+#include "../World/LevelData.h"
 
 namespace
 {
@@ -42,18 +41,8 @@ namespace
 	// The "canvas" area for drawing automap content.
 	const Rect DrawingArea(25, 40, 179, 125);
 
-	// Colors for automap pixels. Ground pixels (y == 0) are transparent.
+	// Color of the player's arrow.
 	const Color AutomapPlayer(247, 255, 0);
-	const Color AutomapFloor(0, 0, 0, 0);
-	const Color AutomapWall(130, 89, 48);
-	const Color AutomapRaised(97, 85, 60);
-	const Color AutomapDoor(146, 0, 0);
-	const Color AutomapLevelUp(0, 105, 0);
-	const Color AutomapLevelDown(0, 0, 255);
-	const Color AutomapDryChasm(20, 40, 40);
-	const Color AutomapWetChasm(109, 138, 174);
-	const Color AutomapLavaChasm(255, 0, 0);
-	const Color AutomapNotImplemented(255, 0, 255);
 
 	// Sets of sub-pixel coordinates for drawing each of the player's arrow directions. 
 	// These are offsets from the top-left corner of the 3x3 map pixel that the player 
@@ -72,8 +61,9 @@ namespace
 }
 
 AutomapPanel::AutomapPanel(Game &game, const Double2 &playerPosition,
-	const Double2 &playerDirection, const VoxelGrid &voxelGrid, const std::string &locationName)
-	: Panel(game), automapOffset(playerPosition)
+	const Double2 &playerDirection, LevelData &level, const std::string &locationName)
+	: Panel(game), automap(level.getAutomap()), automapOffset(playerPosition),
+	playerPosition(playerPosition), playerDirection(playerDirection)
 {
 	this->locationTextBox = [&game, &locationName]()
 	{
@@ -97,201 +87,92 @@ AutomapPanel::AutomapPanel(Game &game, const Double2 &playerPosition,
 		int height = 13;
 		auto function = [](Game &game)
 		{
-			game.setPanel<GameWorldPanel>(game);
+			game.resumePanel<GameWorldPanel>(game);
 		};
 		return Button<Game&>(center, width, height, function);
 	}();
 
-	this->mapTexture = [this, &playerPosition, &playerDirection, &voxelGrid]()
+	// Reuse the level's automap image if it's already generated, otherwise it's uploaded
+	// once the worker generating it is done.
+	this->automap.update(level.getVoxelGrid());
+	if (this->automap.isReady())
 	{
-		// Create scratch surface. For the purposes of the automap, the bottom left corner
-		// is (0, 0), left to right is the Z axis, and up and down is the X axis, because 
-		// north is +X in-game. It is scaled by 3 so that all directions of the player's 
-		// arrow are representable.
-		Surface surface = Surface::createWithFormat(
-			voxelGrid.getDepth() * 3, voxelGrid.getWidth() * 3, Renderer::DEFAULT_BPP,
-			Renderer::DEFAULT_PIXELFORMAT);
-
-		// Fill with transparent color first (used by floor voxels).
-		surface.fill(AutomapFloor.toARGB());
-
-		// Lambda for filling in a square in the map surface.
-		auto drawSquare = [&surface](int x, int z, const Color &color)
-		{
-			const int width = 3;
-			const int height = width;
-			const Rect rect(z * 3, surface.getHeight() - 3 - (x * 3), width, height);
-			surface.fillRect(rect, color.toARGB());
-		};
-
-		auto getVoxelData = [&voxelGrid](int x, int y, int z) -> const VoxelData&
-		{
-			const uint16_t voxelID = voxelGrid.getVoxel(x, y, z);
-			return voxelGrid.getVoxelData(voxelID);
-		};
-
-		// For each voxel, start at the lowest Y and walk upwards. The color depends 
-		// on a couple factors, like whether the voxel is a wall, a door, water, etc.,
-		// and some context-sensitive cases like whether a dry chasm has a wall
-		// over it.
-		for (int x = 0; x < voxelGrid.getWidth(); x++)
-		{
-			for (int z = 0; z < voxelGrid.getDepth(); z++)
-			{
-				const VoxelData &floorData = getVoxelData(x, 0, z);
-				const VoxelData &wallData = getVoxelData(x, 1, z);
-
-				// Decide which color to use for the automap pixel.
-				const Color &color = AutomapPanel::getPixelColor(floorData, wallData);
-
-				// Draw the automap pixel.
-				drawSquare(x, z, color);
-			}
-		}
-
-		// Lambda for drawing the player's arrow in the automap. It's drawn differently 
-		// depending on their direction.
-		auto drawPlayer = [&surface](int x, int z, const Double2 &direction)
-		{
-			const CardinalDirectionName cardinalDirection =
-				CardinalDirection::getDirectionName(direction);
-
-			const int surfaceX = z * 3;
-			const int surfaceY = surface.getHeight() - 3 - (x * 3);
-
-			uint32_t *pixels = static_cast<uint32_t*>(surface.get()->pixels);
-
-			// Draw the player's arrow within the 3x3 map pixel.
-			const std::vector<Int2> &offsets = AutomapPlayerArrowPatterns.at(cardinalDirection);
-			for (const auto &offset : offsets)
-			{
-				const int index = (surfaceX + offset.x) +
-					((surfaceY + offset.y) * surface.getWidth());
-				pixels[index] = AutomapPlayer.toARGB();
-			}
-		};
-
-		const int playerVoxelX = static_cast<int>(std::floor(playerPosition.x));
-		const int playerVoxelZ = static_cast<int>(std::floor(playerPosition.y));
-
-		// Draw player last. Verify that the player is within the bounds of the map 
-		// before drawing.
-		if ((playerVoxelX >= 0) && (playerVoxelX < voxelGrid.getWidth()) &&
-			(playerVoxelZ >= 0) && (playerVoxelZ < voxelGrid.getDepth()))
-		{
-			drawPlayer(playerVoxelX, playerVoxelZ, playerDirection);
-		}
-
-		auto &renderer = this->getGame().getRenderer();
-		Texture texture = renderer.createTextureFromSurface(surface);
-
-		return texture;
-	}();
+		this->mapTexture = this->makeMapTexture();
+	}
 }
 
-const Color &AutomapPanel::getPixelColor(const VoxelData &floorData, const VoxelData &wallData)
+AutomapPanel::~AutomapPanel()
 {
-	const VoxelDataType floorDataType = floorData.dataType;
-	const VoxelDataType wallDataType = wallData.dataType;
+	// The game world can't change the voxel grid until the automap is done reading it.
+	this->automap.wait();
+}
 
-	if (floorDataType == VoxelDataType::Chasm)
+Texture AutomapPanel::makeMapTexture() const
+{
+	// Create scratch surface. For the purposes of the automap, the bottom left corner
+	// is (0, 0), left to right is the Z axis, and up and down is the X axis, because
+	// north is +X in-game. It is scaled by 3 so that all directions of the player's
+	// arrow are representable.
+	const int width = this->automap.getWidth();
+	const int depth = this->automap.getDepth();
+	Surface surface = Surface::createWithFormat(depth * 3, width * 3, Renderer::DEFAULT_BPP,
+		Renderer::DEFAULT_PIXELFORMAT);
+
+	uint32_t *pixels = static_cast<uint32_t*>(surface.get()->pixels);
+
+	// Copy each column's color into its 3x3 square. The first row of a line of squares is
+	// written, then copied into the other two.
+	const std::vector<uint32_t> &colors = this->automap.getColors();
+	for (int x = 0; x < width; x++)
 	{
-		const VoxelData::ChasmData::Type chasmType = floorData.chasm.type;
-
-		if (chasmType == VoxelData::ChasmData::Type::Dry)
-		{
-			// Dry chasms are a different color if a wall is over them.
-			return (wallDataType == VoxelDataType::Wall) ? AutomapRaised : AutomapDryChasm;
-		}
-		else if (chasmType == VoxelData::ChasmData::Type::Lava)
-		{
-			// Lava chasms ignore all but raised platforms.
-			return (wallDataType == VoxelDataType::Raised) ? AutomapRaised : AutomapLavaChasm;
-		}
-		else if (chasmType == VoxelData::ChasmData::Type::Wet)
-		{
-			// Water chasms ignore all but raised platforms.
-			return (wallDataType == VoxelDataType::Raised) ? AutomapRaised : AutomapWetChasm;
-		}
-		else
+		const int surfaceY = surface.getHeight() - 3 - (x * 3);
+		uint32_t *row = pixels + (surfaceY * surface.getWidth());
+		for (int z = 0; z < depth; z++)
 		{
-			DebugLogWarning("Unrecognized chasm type \"" +
-				std::to_string(static_cast<int>(chasmType)) + "\".");
-			return AutomapNotImplemented;
+			const uint32_t color = colors[x + (z * width)];
+			uint32_t *square = row + (z * 3);
+			square[0] = color;
+			square[1] = color;
+			square[2] = color;
 		}
+
+		SurfaceBlitter::copyPixels(row, 0, row + surface.getWidth(), surface.getWidth(),
+			surface.getWidth(), 2);
 	}
-	else if (floorDataType == VoxelDataType::Floor)
+
+	// Lambda for drawing the player's arrow in the automap. It's drawn differently
+	// depending on their direction.
+	auto drawPlayer = [&surface, pixels](int x, int z, const Double2 &direction)
 	{
-		// If nothing is over the floor, return transparent. Otherwise, choose from
-		// a number of cases.
-		if (wallDataType == VoxelDataType::None)
-		{
-			return AutomapFloor;
-		}
-		else if (wallDataType == VoxelDataType::Wall)
-		{
-			const VoxelData::WallData::Type wallType = wallData.wall.type;
-
-			if (wallType == VoxelData::WallData::Type::Solid)
-			{
-				return AutomapWall;
-			}
-			else if (wallType == VoxelData::WallData::Type::LevelUp)
-			{
-				return AutomapLevelUp;
-			}
-			else if (wallType == VoxelData::WallData::Type::LevelDown)
-			{
-				return AutomapLevelDown;
-			}
-			else if (wallType == VoxelData::WallData::Type::Menu)
-			{
-				// Menu blocks are the same color as doors.
-				return AutomapDoor;
-			}
-			else
-			{
-				DebugLogWarning("Unrecognized wall type \"" +
-					std::to_string(static_cast<int>(wallType)) + "\".");
-				return AutomapNotImplemented;
-			}
-		}
-		else if (wallDataType == VoxelDataType::Raised)
-		{
-			return AutomapRaised;
-		}
-		else if (wallDataType == VoxelDataType::Diagonal)
-		{
-			return AutomapFloor;
-		}
-		else if (wallDataType == VoxelDataType::Door)
-		{
-			return AutomapDoor;
-		}
-		else if (wallDataType == VoxelDataType::TransparentWall)
-		{
-			// Transparent walls with collision (hedges) are shown, while
-			// ones without collision (archways) are not.
-			const VoxelData::TransparentWallData &transparentWallData = wallData.transparentWall;
-			return transparentWallData.collider ? AutomapWall : AutomapFloor;
-		}
-		else if (wallDataType == VoxelDataType::Edge)
-		{
-			return AutomapWall;
-		}
-		else
+		const CardinalDirectionName cardinalDirection =
+			CardinalDirection::getDirectionName(direction);
+
+		const int surfaceX = z * 3;
+		const int surfaceY = surface.getHeight() - 3 - (x * 3);
+
+		// Draw the player's arrow within the 3x3 map pixel.
+		const std::vector<Int2> &offsets = AutomapPlayerArrowPatterns.at(cardinalDirection);
+		for (const auto &offset : offsets)
 		{
-			DebugLogWarning("Unrecognized wall data type \"" +
-				std::to_string(static_cast<int>(wallDataType)) + "\".");
-			return AutomapNotImplemented;
+			const int index = (surfaceX + offset.x) +
+				((surfaceY + offset.y) * surface.getWidth());
+			pixels[index] = AutomapPlayer.toARGB();
 		}
-	}
-	else
+	};
+
+	const int playerVoxelX = static_cast<int>(std::floor(this->playerPosition.x));
+	const int playerVoxelZ = static_cast<int>(std::floor(this->playerPosition.y));
+
+	// Draw player last. Verify that the player is within the bounds of the map
+	// before drawing.
+	if ((playerVoxelX >= 0) && (playerVoxelX < width) &&
+		(playerVoxelZ >= 0) && (playerVoxelZ < depth))
 	{
-		DebugLogWarning("Unrecognized floor data type \"" +
-			std::to_string(static_cast<int>(floorDataType)) + "\".");
-		return AutomapNotImplemented;
+		drawPlayer(playerVoxelX, playerVoxelZ, this->playerDirection);
 	}
+
+	auto &renderer = this->getGame().getRenderer();
+	return renderer.createTextureFromSurface(surface);
 }
 
 std::pair<const Texture*, CursorAlignment> AutomapPanel::getCurrentCursor() const
@@ -388,6 +269,11 @@ void AutomapPanel::drawTooltip(const std::string &text, Renderer &renderer)
 void AutomapPanel::tick(double dt)
 {
 	this->handleMouse(dt);
+
+	if ((this->mapTexture.get() == nullptr) && this->automap.isReady())
+	{
+		this->mapTexture = this->makeMapTexture();
+	}
 }
 
 void AutomapPanel::render(Renderer &renderer)
@@ -409,14 +295,17 @@ void AutomapPanel::render(Renderer &renderer)
 	const Rect nativeDrawingArea = renderer.originalToNative(DrawingArea);
 	renderer.setClipRect(&nativeDrawingArea.getRect());
 
-	// Draw automap. Remember that +X is north and +Z is east (aliased as Y), and that
-	// the map texture is scaled by 3 (for the 3x3 player pixel).
-	const int offsetX = static_cast<int>(std::floor(this->automapOffset.y * 3.0));
-	const int offsetY = static_cast<int>(std::floor(this->automapOffset.x * 3.0));
-	const int mapX = (DrawingArea.getLeft() + (DrawingArea.getWidth() / 2)) - offsetX;
-	const int mapY = (DrawingArea.getTop() + (DrawingArea.getHeight() / 2)) + offsetY -
-		this->mapTexture.getHeight();
-	renderer.drawOriginal(this->mapTexture, mapX, mapY);
+	// Draw automap once it's generated. Remember that +X is north and +Z is east (aliased
+	// as Y), and that the map texture is scaled by 3 (for the 3x3 player pixel).
+	if (this->mapTexture.get() != nullptr)
+	{
+		const int offsetX = static_cast<int>(std::floor(this->automapOffset.y * 3.0));
+		const int offsetY = static_cast<int>(std::floor(this->automapOffset.x * 3.0));
+		const int mapX = (DrawingArea.getLeft() + (DrawingArea.getWidth() / 2)) - offsetX;
+		const int mapY = (DrawingArea.getTop() + (DrawingArea.getHeight() / 2)) + offsetY -
+			this->mapTexture.getHeight();
+		renderer.drawOriginal(this->mapTexture, mapX, mapY);
+	}
 
 	// Reset renderer clipping to normal.
 	renderer.setClipRect(nullptr);
@@ -8,23 +8,23 @@
 #include "../Math/Vector2.h"
 #include "../Rendering/Texture.h"
 
-class Color;
+class Automap;
+class LevelData;
 class Renderer;
 class TextBox;
-class VoxelData;
-class VoxelGrid;
 
 class AutomapPanel : public Panel
 {
 private:
 	std::unique_ptr<TextBox> locationTextBox;
 	Button<Game&> backToGameButton;
-	Texture mapTexture;
+	Automap &automap;
+	Texture mapTexture; // Empty until the level's automap image is ready.
 	Double2 automapOffset; // Displayed XZ coordinate offset from (0, 0).
+	Double2 playerPosition, playerDirection;
 
-	// Gets the display color for a pixel on the automap, given its associated floor
-	// and wall voxel data definitions.
-	static const Color &getPixelColor(const VoxelData &floorData, const VoxelData &wallData);
+	// Makes the map texture from the level's automap image with the player's arrow on top.
+	Texture makeMapTexture() const;
 
 	// Listen for when the LMB is held on a compass direction.
 	void handleMouse(double dt);
@@ -32,8 +32,8 @@ private:
 	void drawTooltip(const std::string &text, Renderer &renderer);
 public:
 	AutomapPanel(Game &game, const Double2 &playerPosition, const Double2 &playerDirection,
-		const VoxelGrid &voxelGrid, const std::string &locationName);
-	virtual ~AutomapPanel() = default;
+		LevelData &level, const std::string &locationName);
+	virtual ~AutomapPanel();
 
 	virtual std::pair<const Texture*, CursorAlignment> getCurrentCursor() const override;
 	virtual void handleEvent(const SDL_Event &e) override;
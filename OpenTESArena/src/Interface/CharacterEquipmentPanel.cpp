@@ -51,7 +51,7 @@ CharacterEquipmentPanel::CharacterEquipmentPanel(Game &game)
 
 		const auto &player = game.getGameData().getPlayer();
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.races.singularNames.at(player.getRaceID());
+		const std::string &text = exeData.getRaces().singularNames.at(player.getRaceID());
 
 		const RichTextString richText(
 			text,
@@ -171,6 +171,11 @@ std::pair<const Texture*, CursorAlignment> CharacterEquipmentPanel::getCurrentCu
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool CharacterEquipmentPanel::isStatic() const
+{
+	return true;
+}
+
 void CharacterEquipmentPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -53,7 +53,7 @@ CharacterPanel::CharacterPanel(Game &game)
 
 		const auto &player = game.getGameData().getPlayer();
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.races.singularNames.at(player.getRaceID());
+		const std::string &text = exeData.getRaces().singularNames.at(player.getRaceID());
 
 		const RichTextString richText(
 			text,
@@ -87,7 +87,7 @@ CharacterPanel::CharacterPanel(Game &game)
 		int height = 13;
 		auto function = [](Game &game)
 		{
-			game.setPanel<GameWorldPanel>(game);
+			game.resumePanel<GameWorldPanel>(game);
 		};
 		return Button<Game&>(center, width, height, function);
 	}();
@@ -133,6 +133,11 @@ std::pair<const Texture*, CursorAlignment> CharacterPanel::getCurrentCursor() co
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool CharacterPanel::isStatic() const
+{
+	return true;
+}
+
 void CharacterPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
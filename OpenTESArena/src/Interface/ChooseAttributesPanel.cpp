@@ -68,7 +68,7 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game,
 		const int y = 17;
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.races.singularNames.at(raceID);
+		const std::string &text = exeData.getRaces().singularNames.at(raceID);
 
 		const RichTextString richText(
 			text,
@@ -120,7 +120,7 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game,
 			messageBoxTitle.textBox = [&game, raceID, &renderer]()
 			{
 				const auto &exeData = game.getMiscAssets().getExeData();
-				const std::string &text = exeData.charCreation.chooseAttributes;
+				const std::string &text = exeData.getCharacterCreation().chooseAttributes;
 
 				const Color textColor(199, 199, 199);
 
@@ -157,7 +157,7 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game,
 			messageBoxSave.textBox = [&game, &renderer, &buttonTextColor]()
 			{
 				const auto &exeData = game.getMiscAssets().getExeData();
-				std::string text = exeData.charCreation.chooseAttributesSave;
+				std::string text = exeData.getCharacterCreation().chooseAttributesSave;
 
 				// @todo: use the formatting characters in the string for color.
 				// - For now, just delete them.
@@ -196,7 +196,7 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game,
 				const std::string text = [&game]()
 				{
 					const auto &exeData = game.getMiscAssets().getExeData();
-					std::string segment = exeData.charCreation.chooseAppearance;
+					std::string segment = exeData.getCharacterCreation().chooseAppearance;
 					segment = String::replace(segment, '\r', '\n');
 
 					return segment;
@@ -270,7 +270,7 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game,
 						// Load starting dungeon.
 						const auto &exeData = miscAssets.getExeData();
 						const std::string mifName = String::toUppercase(
-							exeData.locations.startDungeonMifName);
+							exeData.getLocations().startDungeonMifName);
 						
 						MIFFile mif;
 						if (!mif.init(mifName.c_str()))
@@ -407,7 +407,7 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game,
 			messageBoxReroll.textBox = [&game, &renderer, &buttonTextColor]()
 			{
 				const auto &exeData = game.getMiscAssets().getExeData();
-				std::string text = exeData.charCreation.chooseAttributesReroll;
+				std::string text = exeData.getCharacterCreation().chooseAttributesReroll;
 
 				// @todo: use the formatting characters in the string for color.
 				// - For now, just delete them.
@@ -514,7 +514,7 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game,
 		const std::string text = [&game]()
 		{
 			const auto &exeData = game.getMiscAssets().getExeData();
-			std::string segment = exeData.charCreation.distributeClassPoints;
+			std::string segment = exeData.getCharacterCreation().distributeClassPoints;
 			segment = String::replace(segment, '\r', '\n');
 
 			return segment;
@@ -560,6 +560,11 @@ std::pair<const Texture*, CursorAlignment> ChooseAttributesPanel::getCurrentCurs
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool ChooseAttributesPanel::isStatic() const
+{
+	return true;
+}
+
 void ChooseAttributesPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
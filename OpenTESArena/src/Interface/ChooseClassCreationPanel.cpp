@@ -36,7 +36,7 @@ ChooseClassCreationPanel::ChooseClassCreationPanel(Game &game)
 		const Int2 center((Renderer::ORIGINAL_WIDTH / 2) - 1, 80);
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		std::string text = exeData.charCreation.chooseClassCreation;
+		std::string text = exeData.getCharacterCreation().chooseClassCreation;
 		text = String::replace(text, '\r', '\n');
 
 		const int lineSpacing = 1;
@@ -57,7 +57,7 @@ ChooseClassCreationPanel::ChooseClassCreationPanel(Game &game)
 		const Int2 center((Renderer::ORIGINAL_WIDTH / 2) - 1, 120);
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.charCreation.chooseClassCreationGenerate;
+		const std::string &text = exeData.getCharacterCreation().chooseClassCreationGenerate;
 
 		const RichTextString richText(
 			text,
@@ -74,7 +74,7 @@ ChooseClassCreationPanel::ChooseClassCreationPanel(Game &game)
 		const Int2 center((Renderer::ORIGINAL_WIDTH / 2) - 1, 160);
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.charCreation.chooseClassCreationSelect;
+		const std::string &text = exeData.getCharacterCreation().chooseClassCreationSelect;
 
 		const RichTextString richText(
 			text,
@@ -128,6 +128,11 @@ std::pair<const Texture*, CursorAlignment> ChooseClassCreationPanel::getCurrentC
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool ChooseClassCreationPanel::isStatic() const
+{
+	return true;
+}
+
 void ChooseClassCreationPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -55,7 +55,7 @@ ChooseClassPanel::ChooseClassPanel(Game &game)
 		const int y = 32;
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.charCreation.chooseClassList;
+		const std::string &text = exeData.getCharacterCreation().chooseClassList;
 
 		const RichTextString richText(
 			text,
@@ -106,7 +106,7 @@ ChooseClassPanel::ChooseClassPanel(Game &game)
 	this->upButton = [&game]
 	{
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const auto &chooseClassListUI = exeData.ui.chooseClassList;
+		const auto &chooseClassListUI = exeData.getUI().chooseClassList;
 		const int x = chooseClassListUI.buttonUp.x;
 		const int y = chooseClassListUI.buttonUp.y;
 		const int w = chooseClassListUI.buttonUp.w;
@@ -125,7 +125,7 @@ ChooseClassPanel::ChooseClassPanel(Game &game)
 	this->downButton = [&game]
 	{
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const auto &chooseClassListUI = exeData.ui.chooseClassList;
+		const auto &chooseClassListUI = exeData.getUI().chooseClassList;
 		const int x = chooseClassListUI.buttonDown.x;
 		const int y = chooseClassListUI.buttonDown.y;
 		const int w = chooseClassListUI.buttonDown.w;
@@ -169,6 +169,11 @@ std::pair<const Texture*, CursorAlignment> ChooseClassPanel::getCurrentCursor()
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool ChooseClassPanel::isStatic() const
+{
+	return true;
+}
+
 void ChooseClassPanel::handleEvent(const SDL_Event &e)
 {
 	// Eventually handle mouse motion: if mouse is over scroll bar and
@@ -329,7 +334,7 @@ std::string ChooseClassPanel::getClassWeapons(const CharacterClass &characterCla
 
 	// Get weapon names from the executable.
 	const auto &exeData = this->getGame().getMiscAssets().getExeData();
-	const auto &weaponStrings = exeData.equipment.weaponNames;
+	const auto &weaponStrings = exeData.getEquipment().weaponNames;
 
 	// Sort as they are listed in the CharacterClassParser.
 	std::vector<int> allowedWeapons = characterClass.getAllowedWeapons();
@@ -383,7 +388,7 @@ std::string ChooseClassPanel::getClassWeapons(const CharacterClass &characterCla
 
 Rect ChooseClassPanel::getClassListRect(const ExeData &exeData)
 {
-	const auto &chooseClassListUI = exeData.ui.chooseClassList;
+	const auto &chooseClassListUI = exeData.getUI().chooseClassList;
 	return Rect(chooseClassListUI.area.x, chooseClassListUI.area.y,
 		chooseClassListUI.area.w, chooseClassListUI.area.h);
 }
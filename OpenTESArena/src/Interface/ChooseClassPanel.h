@@ -47,6 +47,7 @@ public:
 
 	virtual std::pair<const Texture*, CursorAlignment> getCurrentCursor() const override;
 	virtual void handleEvent(const SDL_Event &e) override;
+	virtual bool isStatic() const override;
 	virtual void render(Renderer &renderer) override;
 };
 
@@ -36,7 +36,7 @@ ChooseGenderPanel::ChooseGenderPanel(Game &game, const CharacterClass &charClass
 		const Int2 center(Renderer::ORIGINAL_WIDTH / 2, 80);
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.charCreation.chooseGender;
+		const std::string &text = exeData.getCharacterCreation().chooseGender;
 
 		const RichTextString richText(
 			text,
@@ -53,7 +53,7 @@ ChooseGenderPanel::ChooseGenderPanel(Game &game, const CharacterClass &charClass
 		const Int2 center(Renderer::ORIGINAL_WIDTH / 2, 120);
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.charCreation.chooseGenderMale;
+		const std::string &text = exeData.getCharacterCreation().chooseGenderMale;
 
 		const RichTextString richText(
 			text,
@@ -70,7 +70,7 @@ ChooseGenderPanel::ChooseGenderPanel(Game &game, const CharacterClass &charClass
 		const Int2 center(Renderer::ORIGINAL_WIDTH / 2, 160);
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.charCreation.chooseGenderFemale;
+		const std::string &text = exeData.getCharacterCreation().chooseGenderFemale;
 
 		const RichTextString richText(
 			text,
@@ -127,6 +127,11 @@ std::pair<const Texture*, CursorAlignment> ChooseGenderPanel::getCurrentCursor()
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool ChooseGenderPanel::isStatic() const
+{
+	return true;
+}
+
 void ChooseGenderPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -41,7 +41,7 @@ ChooseNamePanel::ChooseNamePanel(Game &game, const CharacterClass &charClass)
 		const int y = 82;
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		std::string text = exeData.charCreation.chooseName;
+		std::string text = exeData.getCharacterCreation().chooseName;
 		text = String::replace(text, "%s", charClass.getName());
 
 		const RichTextString richText(
@@ -105,6 +105,11 @@ std::pair<const Texture*, CursorAlignment> ChooseNamePanel::getCurrentCursor() c
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool ChooseNamePanel::isStatic() const
+{
+	return true;
+}
+
 void ChooseNamePanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
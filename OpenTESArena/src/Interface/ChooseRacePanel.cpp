@@ -11,7 +11,6 @@
 #include "TextSubPanel.h"
 #include "../Assets/ExeData.h"
 #include "../Assets/MiscAssets.h"
-#include "../Assets/WorldMapMask.h"
 #include "../Entities/GenderName.h"
 #include "../Game/Game.h"
 #include "../Game/Options.h"
@@ -59,12 +58,12 @@ ChooseRacePanel::ChooseRacePanel(Game &game, const CharacterClass &charClass,
 			messageBoxTitle.textBox = [&game, raceID, &renderer, &textColor]()
 			{
 				const auto &exeData = game.getMiscAssets().getExeData();
-				std::string text = exeData.charCreation.confirmRace;
+				std::string text = exeData.getCharacterCreation().confirmRace;
 				text = String::replace(text, '\r', '\n');
 
 				const std::string &provinceName =
-					exeData.locations.charCreationProvinceNames.at(raceID);
-				const std::string &pluralRaceName = exeData.races.pluralNames.at(raceID);
+					exeData.getLocations().charCreationProvinceNames.at(raceID);
+				const std::string &pluralRaceName = exeData.getRaces().pluralNames.at(raceID);
 
 				// Replace first %s with province name.
 				size_t index = text.find("%s");
@@ -150,7 +149,7 @@ ChooseRacePanel::ChooseRacePanel(Game &game, const CharacterClass &charClass,
 					const std::string text = [&game]()
 					{
 						const auto &exeData = game.getMiscAssets().getExeData();
-						std::string segment = exeData.charCreation.confirmedRace4;
+						std::string segment = exeData.getCharacterCreation().confirmedRace4;
 						segment = String::replace(segment, '\r', '\n');
 
 						return segment;
@@ -191,11 +190,12 @@ ChooseRacePanel::ChooseRacePanel(Game &game, const CharacterClass &charClass,
 					const std::string text = [&game, &charClass]()
 					{
 						const auto &exeData = game.getMiscAssets().getExeData();
-						std::string segment = exeData.charCreation.confirmedRace3;
+						std::string segment = exeData.getCharacterCreation().confirmedRace3;
 						segment = String::replace(segment, '\r', '\n');
 
 						const std::string &preferredAttributes =
-							exeData.charClasses.preferredAttributes.at(charClass.getClassIndex());
+							exeData.getCharacterClasses().preferredAttributes.at(
+								charClass.getClassIndex());
 
 						// Replace first %s with desired class attributes.
 						size_t index = segment.find("%s");
@@ -243,7 +243,7 @@ ChooseRacePanel::ChooseRacePanel(Game &game, const CharacterClass &charClass,
 					const std::string text = [&game, raceID]()
 					{
 						const auto &exeData = game.getMiscAssets().getExeData();
-						std::string segment = exeData.charCreation.confirmedRace2;
+						std::string segment = exeData.getCharacterCreation().confirmedRace2;
 						segment = String::replace(segment, '\r', '\n');
 
 						// Get race description from TEMPLATE.DAT.
@@ -299,12 +299,13 @@ ChooseRacePanel::ChooseRacePanel(Game &game, const CharacterClass &charClass,
 					const std::string text = [&game, &charClass, &name, gender, raceID]()
 					{
 						const auto &exeData = game.getMiscAssets().getExeData();
-						std::string segment = exeData.charCreation.confirmedRace1;
+						std::string segment = exeData.getCharacterCreation().confirmedRace1;
 						segment = String::replace(segment, '\r', '\n');
 
 						const std::string &provinceName =
-							exeData.locations.charCreationProvinceNames.at(raceID);
-						const std::string &pluralRaceName = exeData.races.pluralNames.at(raceID);
+							exeData.getLocations().charCreationProvinceNames.at(raceID);
+						const std::string &pluralRaceName =
+							exeData.getRaces().pluralNames.at(raceID);
 
 						// Replace first %s with player class.
 						size_t index = segment.find("%s");
@@ -436,7 +437,7 @@ std::unique_ptr<Panel> ChooseRacePanel::getInitialSubPanel(Game &game,
 	const std::string text = [&game, &charClass, &name]()
 	{
 		const auto &exeData = game.getMiscAssets().getExeData();
-		std::string segment = exeData.charCreation.chooseRace;
+		std::string segment = exeData.getCharacterCreation().chooseRace;
 		segment = String::replace(segment, '\r', '\n');
 
 		// Replace first "%s" with player name.
@@ -478,35 +479,17 @@ std::unique_ptr<Panel> ChooseRacePanel::getInitialSubPanel(Game &game,
 
 int ChooseRacePanel::getProvinceMaskID(const Int2 &position) const
 {
-	const auto &worldMapMasks = this->getGame().getMiscAssets().getWorldMapMasks();
-	const int maskCount = static_cast<int>(worldMapMasks.size());
-	for (int maskID = 0; maskID < maskCount; maskID++)
+	// Ignore the center province and the "Exit" button. The center province's mask only
+	// wins where no other province's mask is set.
+	const int maskID = this->getGame().getMiscAssets().getWorldMapMaskID(position);
+	const int exitButtonID = 9;
+	if ((maskID < 0) || (maskID == Location::CENTER_PROVINCE_ID) || (maskID == exitButtonID))
 	{
-		// Ignore the center province and the "Exit" button.
-		const int exitButtonID = 9;
-		if ((maskID == Location::CENTER_PROVINCE_ID) || (maskID == exitButtonID))
-		{
-			continue;
-		}
-
-		const WorldMapMask &mapMask = worldMapMasks.at(maskID);
-		const Rect &maskRect = mapMask.getRect();
-
-		if (maskRect.contains(position))
-		{
-			// See if the pixel is set in the bitmask.
-			const bool success = mapMask.get(position.x, position.y);
-
-			if (success)
-			{
-				// Return the mask's ID.
-				return maskID;
-			}
-		}
+		// No province mask found at the given location.
+		return ChooseRacePanel::NO_ID;
 	}
 
-	// No province mask found at the given location.
-	return ChooseRacePanel::NO_ID;
+	return maskID;
 }
 
 std::pair<const Texture*, CursorAlignment> ChooseRacePanel::getCurrentCursor() const
@@ -520,6 +503,11 @@ std::pair<const Texture*, CursorAlignment> ChooseRacePanel::getCurrentCursor() c
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool ChooseRacePanel::isStatic() const
+{
+	return true;
+}
+
 void ChooseRacePanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -553,7 +541,7 @@ void ChooseRacePanel::drawProvinceTooltip(int provinceID, Renderer &renderer)
 {
 	// Get the race name associated with the province.
 	const auto &exeData = this->getGame().getMiscAssets().getExeData();
-	const std::string &raceName = exeData.races.pluralNames.at(provinceID);
+	const std::string &raceName = exeData.getRaces().pluralNames.at(provinceID);
 
 	const Texture tooltip = Panel::createTooltip(
 		"Land of the " + raceName, FontName::D, this->getGame().getFontManager(), renderer);
@@ -2,9 +2,12 @@
 
 #include "CinematicPanel.h"
 #include "../Game/Game.h"
+#include "../Media/FLCPlayer.h"
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Rendering/Texture.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/StringView.h"
 
 CinematicPanel::CinematicPanel(Game &game,
 	const std::string &paletteName, const std::string &sequenceName,
@@ -16,11 +19,48 @@ CinematicPanel::CinematicPanel(Game &game,
 		return Button<Game&>(endingAction);
 	}();
 
+	// Movies are streamed since they can have hundreds of full screen frames.
+	const std::string_view extension = StringView::getExtension(sequenceName);
+	if ((extension == "FLC") || (extension == "CEL"))
+	{
+		this->flcPlayer = std::make_unique<FLCPlayer>();
+		if (!this->flcPlayer->init(sequenceName.c_str(), game.getRenderer()))
+		{
+			DebugCrash("Could not init .FLC/.CEL player for \"" + sequenceName + "\".");
+		}
+	}
+	else
+	{
+		// Other sequences are decoded on a worker thread, and playback waits for them
+		// instead of stalling the frame that first draws them.
+		game.getTextureManager().requestTexturesAsync(sequenceName, paletteName);
+	}
+
 	this->secondsPerImage = secondsPerImage;
 	this->currentSeconds = 0.0;
 	this->imageIndex = 0;
 }
 
+CinematicPanel::~CinematicPanel()
+{
+
+}
+
+int CinematicPanel::getImageCount()
+{
+	if (this->flcPlayer != nullptr)
+	{
+		return this->flcPlayer->getFrameCount();
+	}
+
+	// Get a reference to all images in the sequence.
+	auto &game = this->getGame();
+	auto &textureManager = game.getTextureManager();
+	const auto &textures = textureManager.getTextures(
+		this->sequenceName, this->paletteName, game.getRenderer());
+	return static_cast<int>(textures.size());
+}
+
 void CinematicPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -38,8 +78,25 @@ void CinematicPanel::handleEvent(const SDL_Event &e)
 	}
 }
 
+bool CinematicPanel::isReady() const
+{
+	if (this->flcPlayer != nullptr)
+	{
+		return true;
+	}
+
+	const auto &textureManager = this->getGame().getTextureManager();
+	return !textureManager.isTexturePending(this->sequenceName, this->paletteName);
+}
+
 void CinematicPanel::tick(double dt)
 {
+	// Don't start playing until the images can be shown.
+	if (!this->isReady())
+	{
+		return;
+	}
+
 	// See if it's time for the next image.
 	this->currentSeconds += dt;
 	while (this->currentSeconds > this->secondsPerImage)
@@ -48,18 +105,12 @@ void CinematicPanel::tick(double dt)
 		this->imageIndex++;
 	}
 
-	// Get a reference to all images in the sequence.
-	auto &game = this->getGame();
-	auto &renderer = game.getRenderer();
-	auto &textureManager = game.getTextureManager();
-	const auto &textures = textureManager.getTextures(
-		this->sequenceName, this->paletteName, renderer);
-
 	// If at the end, then prepare for the next panel.
-	if (this->imageIndex >= textures.size())
+	const int imageCount = this->getImageCount();
+	if (this->imageIndex >= imageCount)
 	{
-		this->imageIndex = static_cast<int>(textures.size() - 1);
-		this->skipButton.click(game);
+		this->imageIndex = imageCount - 1;
+		this->skipButton.click(this->getGame());
 	}
 }
 
@@ -68,12 +119,22 @@ void CinematicPanel::render(Renderer &renderer)
 	// Clear full screen.
 	renderer.clear();
 
-	// Get a reference to all images in the sequence.
-	auto &textureManager = this->getGame().getTextureManager();
-	const auto &textures = textureManager.getTextures(
-		this->sequenceName, this->paletteName, renderer);
-
 	// Draw image.
-	const auto &texture = textures.at(this->imageIndex);
-	renderer.drawOriginal(texture);
+	if (!this->isReady())
+	{
+		return;
+	}
+	else if (this->flcPlayer != nullptr)
+	{
+		const Texture &texture = this->flcPlayer->getFrame(this->imageIndex);
+		renderer.drawOriginal(texture);
+	}
+	else
+	{
+		auto &textureManager = this->getGame().getTextureManager();
+		const auto &textures = textureManager.getTextures(
+			this->sequenceName, this->paletteName, renderer);
+		const auto &texture = textures.at(this->imageIndex);
+		renderer.drawOriginal(texture);
+	}
 }
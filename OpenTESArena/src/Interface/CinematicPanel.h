@@ -2,6 +2,7 @@
 #define CINEMATIC_PANEL_H
 
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "Button.h"
@@ -10,6 +11,7 @@
 // Designed for sets of images (i.e., videos) that play one after another and
 // eventually lead to another panel. Skipping is available, too.
 
+class FLCPlayer;
 class Game;
 class Renderer;
 
@@ -19,13 +21,20 @@ private:
 	Button<Game&> skipButton;
 	std::string paletteName;
 	std::string sequenceName;
+	std::unique_ptr<FLCPlayer> flcPlayer; // Streams .FLC/.CEL frames instead of loading them all.
 	double secondsPerImage, currentSeconds;
 	int imageIndex;
+
+	// Gets the number of images in the sequence.
+	int getImageCount();
+
+	// Returns whether the sequence's images are done decoding, so playback can start.
+	bool isReady() const;
 public:
 	CinematicPanel(Game &game, const std::string &paletteName,
 		const std::string &sequenceName, double secondsPerImage,
 		const std::function<void(Game&)> &endingAction);
-	virtual ~CinematicPanel() = default;
+	virtual ~CinematicPanel();
 
 	virtual void handleEvent(const SDL_Event &e) override;
 	virtual void tick(double dt) override;
@@ -1,13 +1,86 @@
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <numeric>
 
 #include "FPSCounter.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/String.h"
+
+const double FPSCounter::MIN_BUCKET_TIME = 0.00025;
 
 FPSCounter::FPSCounter()
 {
 	this->frameTimes.fill(0.0);
+	this->busyTimes.fill(0.0);
+	this->inputLatencies.fill(0.0);
+	this->inputLatencyCount = 0;
+	this->resetStats();
+}
+
+int FPSCounter::getBucketIndex(double frameTime)
+{
+	if (!(frameTime > FPSCounter::MIN_BUCKET_TIME))
+	{
+		return 0;
+	}
+
+	const double octaves = std::log2(frameTime / FPSCounter::MIN_BUCKET_TIME);
+	const int index = static_cast<int>(octaves * static_cast<double>(FPSCounter::BUCKETS_PER_OCTAVE));
+	return std::min(index, FPSCounter::BUCKET_COUNT - 1);
+}
+
+double FPSCounter::getPercentileTime(double percentile) const
+{
+	if (this->statsFrameCount == 0)
+	{
+		return 0.0;
+	}
+
+	// Find the bucket the percentile's frame falls in and use that bucket's average.
+	const uint64_t targetCount = std::max<uint64_t>(1, static_cast<uint64_t>(
+		std::ceil(percentile * static_cast<double>(this->statsFrameCount))));
+	uint64_t count = 0;
+	for (int i = 0; i < FPSCounter::BUCKET_COUNT; i++)
+	{
+		count += this->bucketCounts[i];
+		if (count >= targetCount)
+		{
+			return this->bucketTimes[i] / static_cast<double>(this->bucketCounts[i]);
+		}
+	}
+
+	return 0.0;
+}
+
+double FPSCounter::getLowFPS(double fraction) const
+{
+	if (this->statsFrameCount == 0)
+	{
+		return 0.0;
+	}
+
+	// Add up the slowest frames from the top bucket down. A partly used bucket adds its
+	// average frame time for each frame taken from it.
+	const uint64_t targetCount = std::max<uint64_t>(1, static_cast<uint64_t>(
+		std::ceil(fraction * static_cast<double>(this->statsFrameCount))));
+	uint64_t count = 0;
+	double seconds = 0.0;
+	for (int i = FPSCounter::BUCKET_COUNT - 1; (i >= 0) && (count < targetCount); i--)
+	{
+		const uint64_t bucketCount = this->bucketCounts[i];
+		if (bucketCount == 0)
+		{
+			continue;
+		}
+
+		const uint64_t takenCount = std::min(bucketCount, targetCount - count);
+		seconds += this->bucketTimes[i] * (static_cast<double>(takenCount) /
+			static_cast<double>(bucketCount));
+		count += takenCount;
+	}
+
+	return (seconds > 0.0) ? (static_cast<double>(count) / seconds) : 0.0;
 }
 
 int FPSCounter::getFrameCount() const
@@ -36,11 +109,185 @@ double FPSCounter::getFPS() const
 	return std::isfinite(fps) ? fps : 0.0;
 }
 
-void FPSCounter::updateFrameTime(double dt)
+double FPSCounter::getAverageBusyTime() const
+{
+	// Same sample count as the average frame time.
+	const size_t count = 20;
+	DebugAssert(count <= this->busyTimes.size());
+
+	const double sum = std::accumulate(this->busyTimes.begin(), this->busyTimes.begin() + count, 0.0);
+	return sum / static_cast<double>(count);
+}
+
+double FPSCounter::getAverageInputLatency() const
+{
+	if (this->inputLatencyCount == 0)
+	{
+		return 0.0;
+	}
+
+	const double sum = std::accumulate(this->inputLatencies.begin(),
+		this->inputLatencies.begin() + this->inputLatencyCount, 0.0);
+	return sum / static_cast<double>(this->inputLatencyCount);
+}
+
+double FPSCounter::getMaxInputLatency() const
+{
+	if (this->inputLatencyCount == 0)
+	{
+		return 0.0;
+	}
+
+	return *std::max_element(this->inputLatencies.begin(),
+		this->inputLatencies.begin() + this->inputLatencyCount);
+}
+
+const std::vector<uint64_t> &FPSCounter::getHitchCounts() const
+{
+	return this->hitchCounts;
+}
+
+FPSCounter::Stats FPSCounter::getStats() const
+{
+	Stats stats;
+	stats.frameCount = this->statsFrameCount;
+	stats.seconds = this->statsSeconds;
+	stats.p50 = this->getPercentileTime(0.50);
+	stats.p95 = this->getPercentileTime(0.95);
+	stats.p99 = this->getPercentileTime(0.99);
+	stats.low1Percent = this->getLowFPS(0.01);
+	stats.low01Percent = this->getLowFPS(0.001);
+	stats.hitchThresholds = this->hitchThresholds;
+	stats.hitchCounts = this->hitchCounts;
+	return stats;
+}
+
+double FPSCounter::getStatsSeconds() const
+{
+	return this->statsSeconds;
+}
+
+void FPSCounter::setHitchThresholds(const std::vector<double> &thresholds)
 {
-	// Rotate the array right by one index (this puts the last value at the front).
+	this->hitchThresholds = thresholds;
+	std::sort(this->hitchThresholds.begin(), this->hitchThresholds.end());
+	this->hitchCounts.assign(this->hitchThresholds.size(), 0);
+}
+
+void FPSCounter::resetStats()
+{
+	this->bucketCounts.fill(0);
+	this->bucketTimes.fill(0.0);
+	this->statsFrameCount = 0;
+	this->statsSeconds = 0.0;
+	std::fill(this->hitchCounts.begin(), this->hitchCounts.end(), 0);
+}
+
+void FPSCounter::exportStats(const std::string &filename, bool json) const
+{
+	// Only CSV needs to know whether to write the header first.
+	const bool isNewFile = [&filename]()
+	{
+		std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
+		return !ifs.is_open() || (ifs.tellg() <= 0);
+	}();
+
+	std::ofstream ofs(filename, std::ios::app);
+	if (!ofs.is_open())
+	{
+		DebugLogWarning("Could not open \"" + filename + "\" for writing frame stats.");
+		return;
+	}
+
+	const Stats stats = this->getStats();
+	auto toMs = [](double seconds)
+	{
+		return String::fixedPrecision(seconds * 1000.0, 3);
+	};
+
+	auto getThresholdName = [&stats](int index)
+	{
+		return "hitches_" + std::to_string(static_cast<int>(
+			std::round(stats.hitchThresholds[index] * 1000.0))) + "ms";
+	};
+
+	const int hitchCount = static_cast<int>(stats.hitchCounts.size());
+	if (json)
+	{
+		ofs << "{\"frames\":" << stats.frameCount <<
+			",\"seconds\":" << String::fixedPrecision(stats.seconds, 3) <<
+			",\"p50_ms\":" << toMs(stats.p50) <<
+			",\"p95_ms\":" << toMs(stats.p95) <<
+			",\"p99_ms\":" << toMs(stats.p99) <<
+			",\"low_1_fps\":" << String::fixedPrecision(stats.low1Percent, 2) <<
+			",\"low_0.1_fps\":" << String::fixedPrecision(stats.low01Percent, 2);
+		for (int i = 0; i < hitchCount; i++)
+		{
+			ofs << ",\"" << getThresholdName(i) << "\":" << stats.hitchCounts[i];
+		}
+
+		ofs << "}\n";
+	}
+	else
+	{
+		if (isNewFile)
+		{
+			ofs << "frames,seconds,p50_ms,p95_ms,p99_ms,low_1_fps,low_0.1_fps";
+			for (int i = 0; i < hitchCount; i++)
+			{
+				ofs << ',' << getThresholdName(i);
+			}
+
+			ofs << '\n';
+		}
+
+		ofs << stats.frameCount << ',' << String::fixedPrecision(stats.seconds, 3) << ',' <<
+			toMs(stats.p50) << ',' << toMs(stats.p95) << ',' << toMs(stats.p99) << ',' <<
+			String::fixedPrecision(stats.low1Percent, 2) << ',' <<
+			String::fixedPrecision(stats.low01Percent, 2);
+		for (int i = 0; i < hitchCount; i++)
+		{
+			ofs << ',' << stats.hitchCounts[i];
+		}
+
+		ofs << '\n';
+	}
+}
+
+void FPSCounter::updateFrameTime(double dt, double busyTime, double unclampedDt)
+{
+	// Rotate the arrays right by one index (this puts the last value at the front).
 	std::rotate(this->frameTimes.rbegin(),
 		this->frameTimes.rbegin() + 1, this->frameTimes.rend());
+	std::rotate(this->busyTimes.rbegin(),
+		this->busyTimes.rbegin() + 1, this->busyTimes.rend());
 
 	this->frameTimes.front() = dt;
+	this->busyTimes.front() = busyTime;
+
+	const int bucketIndex = FPSCounter::getBucketIndex(unclampedDt);
+	this->bucketCounts[bucketIndex]++;
+	this->bucketTimes[bucketIndex] += unclampedDt;
+	this->statsFrameCount++;
+	this->statsSeconds += unclampedDt;
+
+	// Thresholds are sorted, so stop at the first one the frame is under.
+	for (size_t i = 0; i < this->hitchThresholds.size(); i++)
+	{
+		if (unclampedDt <= this->hitchThresholds[i])
+		{
+			break;
+		}
+
+		this->hitchCounts[i]++;
+	}
+}
+
+void FPSCounter::updateInputLatency(double seconds)
+{
+	std::rotate(this->inputLatencies.rbegin(),
+		this->inputLatencies.rbegin() + 1, this->inputLatencies.rend());
+	this->inputLatencies.front() = seconds;
+	this->inputLatencyCount = std::min(this->inputLatencyCount + 1,
+		static_cast<int>(this->inputLatencies.size()));
 }
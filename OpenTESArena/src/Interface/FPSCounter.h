@@ -2,11 +2,51 @@
 #define FPS_COUNTER_H
 
 #include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Keeps recent frame times for the FPS display and graph, and a histogram of all frame
+// times since the stats were last reset for finding stutters that an average hides.
 
 class FPSCounter
 {
+public:
+	// Frame time distribution since the last reset. Times are in seconds.
+	struct Stats
+	{
+		uint64_t frameCount;
+		double seconds; // Total frame time.
+		double p50, p95, p99;
+		double low1Percent, low01Percent; // Average FPS of the slowest 1% and 0.1% of frames.
+		std::vector<double> hitchThresholds;
+		std::vector<uint64_t> hitchCounts; // Frames longer than each threshold.
+	};
+
+	// Histogram buckets are spaced logarithmically from a quarter millisecond to about four
+	// seconds. Frames outside that go in the first or last bucket.
+	static constexpr int BUCKETS_PER_OCTAVE = 8;
+	static constexpr int BUCKET_COUNT = 14 * BUCKETS_PER_OCTAVE;
+	static const double MIN_BUCKET_TIME;
 private:
 	std::array<double, 60> frameTimes;
+	std::array<double, 60> busyTimes;
+
+	// Recent input-to-present times, and how many of them have been set.
+	std::array<double, 60> inputLatencies;
+	int inputLatencyCount;
+
+	// Frame count and total frame time in each histogram bucket.
+	std::array<uint64_t, BUCKET_COUNT> bucketCounts;
+	std::array<double, BUCKET_COUNT> bucketTimes;
+	uint64_t statsFrameCount;
+	double statsSeconds;
+
+	std::vector<double> hitchThresholds;
+	std::vector<uint64_t> hitchCounts;
+
+	// Gets the histogram bucket a frame time goes in.
+	static int getBucketIndex(double frameTime);
 
 	// Calculates average frame time based on previous frames.
 	double getAverageFrameTime() const;
@@ -22,9 +62,48 @@ public:
 	// Gets the average frames per second based on recent data.
 	double getFPS() const;
 
-	// Sets the frame time of the most recent frame. This should be called once
-	// per frame.
-	void updateFrameTime(double dt);
+	// Gets the average time in seconds recent frames spent working, not counting the
+	// time slept to stay at the target FPS.
+	double getAverageBusyTime() const;
+
+	// Gets the average and longest times in seconds from input to the frame showing it
+	// being presented, over recent frames that had input. Presenting is as close to the
+	// screen as the game can measure, so the display's own latency isn't included.
+	double getAverageInputLatency() const;
+	double getMaxInputLatency() const;
+
+	// Gets the frame time at the given percentile (0 to 1) of the histogram.
+	double getPercentileTime(double percentile) const;
+
+	// Gets the average FPS of the slowest given fraction of frames in the histogram.
+	double getLowFPS(double fraction) const;
+
+	// Gets how many frames since the last reset were longer than each hitch threshold.
+	const std::vector<uint64_t> &getHitchCounts() const;
+
+	// Gets the frame time distribution since the last reset.
+	Stats getStats() const;
+
+	// Gets the total frame time in seconds since the last reset.
+	double getStatsSeconds() const;
+
+	// Sets the frame times in seconds that count as hitches. Resets the hitch counts.
+	void setHitchThresholds(const std::vector<double> &thresholds);
+
+	// Clears the histogram and hitch counts, i.e., after exporting them.
+	void resetStats();
+
+	// Appends the stats to a file as one CSV row (with a header if the file is new) or one
+	// JSON object per line, for collecting from many machines.
+	void exportStats(const std::string &filename, bool json) const;
+
+	// Sets the frame time and busy time of the most recent frame. The unclamped frame time
+	// goes in the histogram so long stalls aren't hidden by the game's delta time limit. This
+	// should be called once per frame.
+	void updateFrameTime(double dt, double busyTime, double unclampedDt);
+
+	// Adds the input latency of a presented frame that had input.
+	void updateInputLatency(double seconds);
 };
 
 #endif
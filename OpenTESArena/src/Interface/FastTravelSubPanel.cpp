@@ -86,21 +86,21 @@ std::unique_ptr<Panel> FastTravelSubPanel::makeCityArrivalPopUp() const
 					if (localCityID < 8)
 					{
 						// City.
-						return exeData.locations.locationTypes.front();
+						return exeData.getLocations().locationTypes.front();
 					}
 					else if (localCityID < 16)
 					{
 						// Town.
-						return exeData.locations.locationTypes.at(1);
+						return exeData.getLocations().locationTypes.at(1);
 					}
 					else
 					{
 						// Village.
-						return exeData.locations.locationTypes.at(2);
+						return exeData.getLocations().locationTypes.at(2);
 					}
 				}();
 
-				std::string text = exeData.travel.locationFormatTexts.at(2);
+				std::string text = exeData.getTravel().locationFormatTexts.at(2);
 
 				// Replace first %s with location type name.
 				size_t index = text.find("%s");
@@ -114,25 +114,25 @@ std::unique_ptr<Panel> FastTravelSubPanel::makeCityArrivalPopUp() const
 				index = text.find("%s", index);
 				text.replace(index, 2, provinceData.name);
 
-				return exeData.travel.arrivalPopUpLocation + text;
+				return exeData.getTravel().arrivalPopUpLocation + text;
 			}
 			else
 			{
 				// Center province displays only the city name.
-				return exeData.travel.arrivalPopUpLocation +
-					exeData.travel.arrivalCenterProvinceLocation;
+				return exeData.getTravel().arrivalPopUpLocation +
+					exeData.getTravel().arrivalCenterProvinceLocation;
 			}
 		}();
 
 		const std::string dateString = [&gameData, &exeData]()
 		{
-			return exeData.travel.arrivalPopUpDate +
+			return exeData.getTravel().arrivalPopUpDate +
 				GameData::getDateString(gameData.getDate(), exeData);
 		}();
 
 		const std::string daysString = [this, &exeData]()
 		{
-			std::string text = exeData.travel.arrivalPopUpDays;
+			std::string text = exeData.getTravel().arrivalPopUpDays;
 
 			// Replace %d with travel days.
 			size_t index = text.find("%d");
@@ -297,6 +297,11 @@ std::unique_ptr<Panel> FastTravelSubPanel::makeCityArrivalPopUp() const
 		std::move(texture), textureCenter);
 }
 
+bool FastTravelSubPanel::usesFrozenBackground() const
+{
+	return true;
+}
+
 std::pair<const Texture*, CursorAlignment> FastTravelSubPanel::getCurrentCursor() const
 {
 	auto &game = this->getGame();
@@ -387,7 +392,7 @@ void FastTravelSubPanel::switchToNextPanel()
 		else
 		{
 			const std::string mifName = String::toUppercase(
-				exeData.locations.centerProvinceCityMifName);
+				exeData.getLocations().centerProvinceCityMifName);
 
 			MIFFile mif;
 			if (!mif.init(mifName.c_str()))
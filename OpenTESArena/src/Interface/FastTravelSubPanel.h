@@ -45,6 +45,7 @@ public:
 	static const double MIN_SECONDS;
 
 	virtual std::pair<const Texture*, CursorAlignment> getCurrentCursor() const override;
+	virtual bool usesFrozenBackground() const override;
 	virtual void tick(double dt) override;
 	virtual void render(Renderer &renderer) override;
 };
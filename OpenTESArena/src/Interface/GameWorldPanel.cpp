@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <memory_resource>
 
 #include "SDL.h"
 
@@ -47,6 +49,9 @@
 #include "../Rendering/Surface.h"
 #include "../Rendering/Texture.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/KernelDispatch.h"
+#include "../Utilities/Platform.h"
+#include "../Utilities/Profiler.h"
 #include "../Utilities/String.h"
 #include "../World/ExteriorWorldData.h"
 #include "../World/InteriorLevelData.h"
@@ -98,6 +103,44 @@ namespace
 		CursorAlignment::Bottom,
 		CursorAlignment::Right
 	};
+
+	// Seconds the game world takes to fade out while a level is loading.
+	const double LoadingFadeSeconds = 0.25;
+
+	// Shows the given text in the middle of the game world for a moment.
+	void setActionText(const std::string &text, Game &game)
+	{
+		const TextBox::ShadowData shadowData(ActionTextShadowColor, Int2(-1, 0));
+
+		// Get the text box for display from the cache since the same text comes up often
+		// (the renderer will decide where to draw it).
+		auto textBox = game.getTextBoxCache().get(
+			text,
+			FontName::Arena,
+			ActionTextColor,
+			TextAlignment::Center,
+			0,
+			&shadowData,
+			game.getFontManager(),
+			game.getRenderer());
+
+		// Assign the text box and its duration to the action text.
+		auto &gameData = game.getGameData();
+		auto &actionText = gameData.getActionText();
+		const double duration = std::max(2.25, static_cast<double>(text.size()) * 0.050);
+		actionText = GameData::TimedTextBox(duration, std::move(textBox));
+	}
+
+	// Converts mouse motion to camera turning for the modern interface. The smaller window
+	// dimension is used so the look sensitivity is relative to a square instead of a
+	// rectangle, keeping it independent of the aspect ratio.
+	Double2 getMouseLookDelta(const Int2 &mouseDelta, const Int2 &windowDimensions)
+	{
+		const int minDimension = std::min(windowDimensions.x, windowDimensions.y);
+		return Double2(
+			static_cast<double>(mouseDelta.x) / static_cast<double>(minDimension),
+			static_cast<double>(-mouseDelta.y) / static_cast<double>(minDimension));
+	}
 }
 
 GameWorldPanel::GameWorldPanel(Game &game)
@@ -217,13 +260,13 @@ GameWorldPanel::GameWorldPanel(Game &game)
 					}();
 
 					const std::string &timeOfDayString =
-						exeData.calendar.timesOfDay.at(timeOfDayIndex);
+						exeData.getCalendar().timesOfDay.at(timeOfDayIndex);
 
 					return clockTimeString + ' ' + timeOfDayString;
 				}();
 
 				// Get the base status text.
-				std::string baseText = exeData.status.popUp;
+				std::string baseText = exeData.getStatus().popUp;
 
 				// Replace carriage returns with newlines.
 				baseText = String::replace(baseText, '\r', '\n');
@@ -256,13 +299,13 @@ GameWorldPanel::GameWorldPanel(Game &game)
 				// Append the list of effects at the bottom (healthy/diseased...).
 				const std::string effectText = [&exeData]()
 				{
-					std::string text = exeData.status.effect;
+					std::string text = exeData.getStatus().effect;
 
 					// Replace carriage returns with newlines.
 					text = String::replace(text, '\r', '\n');
 
 					// Replace %s with placeholder.
-					const std::string &effectStr = exeData.status.effectsList.front();
+					const std::string &effectStr = exeData.getStatus().effectsList.front();
 					size_t index = text.find("%s");
 					text.replace(index, 2, effectStr);
 
@@ -384,8 +427,8 @@ GameWorldPanel::GameWorldPanel(Game &game)
 			{
 				auto &gameData = game.getGameData();
 				const auto &exeData = game.getMiscAssets().getExeData();
-				const auto &worldData = gameData.getWorldData();
-				const auto &level = worldData.getActiveLevel();
+				auto &worldData = gameData.getWorldData();
+				auto &level = worldData.getActiveLevel();
 				const auto &player = gameData.getPlayer();
 				const Location &location = gameData.getLocation();
 				const Double3 &position = player.getPosition();
@@ -417,7 +460,7 @@ GameWorldPanel::GameWorldPanel(Game &game)
 				}();
 
 				game.setPanel<AutomapPanel>(game, Double2(position.x, position.z), 
-					player.getGroundDirection(), level.getVoxelGrid(), automapLocationName);
+					player.getGroundDirection(), level, automapLocationName);
 			}
 			else
 			{
@@ -433,9 +476,11 @@ GameWorldPanel::GameWorldPanel(Game &game)
 
 	// Load all the weapon offsets for the player's currently equipped weapon. If the
 	// player can ever change weapons in-game (i.e., with a hotkey), then this will
-	// need to be moved into update() instead.
+	// need to be moved into update() instead. Only the headers are read here, and the
+	// frames are decoded on a worker so the first unsheathing doesn't wait for them.
 	const auto &weaponAnimation = game.getGameData().getPlayer().getWeaponAnimation();
 	const std::string &weaponFilename = weaponAnimation.getAnimationFilename();
+	game.getTextureManager().requestTexturesAsync(weaponFilename);
 
 	if (!weaponAnimation.isRanged())
 	{
@@ -466,6 +511,39 @@ GameWorldPanel::GameWorldPanel(Game &game)
 		}
 	}
 
+	// Interface layers are composed on their first draw.
+	this->interfacePortraitID = -1;
+	this->interfaceShowsNoSpell = false;
+	this->compassSliderOffset = -1;
+	this->loadingSeconds = 0.0;
+	this->texturePrefetchLevel = nullptr;
+
+	const Player &player = game.getGameData().getPlayer();
+	this->lastTickPlayerPosition = player.getPosition();
+	this->lastTickPlayerDirection = player.getDirection();
+	this->lastTickCount = 0;
+
+	// The interface is always drawn with the default palette.
+	auto &textureManager = game.getTextureManager();
+	auto &renderer = game.getRenderer();
+	const std::string &paletteName = PaletteFile::fromName(PaletteName::Default);
+	this->gameInterfaceTextureID = textureManager.getTextureID(
+		TextureFile::fromName(TextureName::GameWorldInterface), paletteName, renderer);
+	this->swordCursorTextureID = textureManager.getTextureID(
+		TextureFile::fromName(TextureName::SwordCursor), paletteName, renderer);
+	this->arrowCursorsTextureSetID = textureManager.getTextureSetID(
+		TextureFile::fromName(TextureName::ArrowCursors), paletteName, renderer);
+	this->gameInterfaceSurfaceID = textureManager.getSurfaceID(
+		TextureFile::fromName(TextureName::GameWorldInterface), paletteName);
+	this->noSpellSurfaceID = textureManager.getSurfaceID(
+		TextureFile::fromName(TextureName::NoSpell), paletteName);
+	this->compassSliderSurfaceID = textureManager.getSurfaceID(
+		TextureFile::fromName(TextureName::CompassSlider), paletteName);
+	this->compassFrameSurfaceID = textureManager.getSurfaceID(
+		TextureFile::fromName(TextureName::CompassFrame), paletteName);
+	this->statusGradientsSurfaceSetID = textureManager.getSurfaceSetID(
+		TextureFile::fromName(TextureName::StatusGradients), paletteName);
+
 	// If in modern mode, lock mouse to center of screen for free-look.
 	const auto &options = game.getOptions();
 	const bool modernInterface = options.getGraphics_ModernInterface();
@@ -510,7 +588,6 @@ std::pair<const Texture*, CursorAlignment> GameWorldPanel::getCurrentCursor() co
 {
 	// The cursor texture depends on the current mouse position.
 	auto &game = this->getGame();
-	auto &renderer = game.getRenderer();
 	auto &textureManager = game.getTextureManager();
 	const bool modernInterface = game.getOptions().getGraphics_ModernInterface();
 	const Int2 mousePosition = game.getInputManager().getMousePosition();
@@ -528,14 +605,13 @@ std::pair<const Texture*, CursorAlignment> GameWorldPanel::getCurrentCursor() co
 			if (this->nativeCursorRegions[i].contains(mousePosition))
 			{
 				const auto &texture = textureManager.getTextures(
-					TextureFile::fromName(TextureName::ArrowCursors), renderer).at(i);
+					this->arrowCursorsTextureSetID).at(i);
 				return std::make_pair(&texture, ArrowCursorAlignments.at(i));
 			}
 		}
 
 		// If not in any of the arrow regions, use the default sword cursor.
-		const auto &texture = textureManager.getTexture(
-			TextureFile::fromName(TextureName::SwordCursor), renderer);
+		const auto &texture = textureManager.getTexture(this->swordCursorTextureID);
 		return std::make_pair(&texture, CursorAlignment::TopLeft);
 	}
 }
@@ -596,12 +672,24 @@ void GameWorldPanel::setFreeLookActive(bool active)
 
 void GameWorldPanel::handleEvent(const SDL_Event &e)
 {
+	// Ignore input while a level is loading so nothing can leave this panel or start
+	// another transition.
+	if (this->isLoadingLevel())
+	{
+		return;
+	}
+
 	auto &game = this->getGame();
 	auto &options = game.getOptions();
 	auto &player = game.getGameData().getPlayer();
 	const auto &inputManager = game.getInputManager();
 	const bool escapePressed = inputManager.keyPressed(e, SDLK_ESCAPE);
 	const bool f4Pressed = inputManager.keyPressed(e, SDLK_F4);
+	const bool f5Pressed = inputManager.keyPressed(e, SDLK_F5);
+	const bool f6Pressed = inputManager.keyPressed(e, SDLK_F6);
+	const bool f7Pressed = inputManager.keyPressed(e, SDLK_F7);
+	const bool quickSavePressed = inputManager.keyPressed(e, SDLK_F9);
+	const bool quickLoadPressed = inputManager.keyPressed(e, SDLK_F10);
 
 	if (escapePressed)
 	{
@@ -612,6 +700,75 @@ void GameWorldPanel::handleEvent(const SDL_Event &e)
 		// Toggle debug display.
 		options.setMisc_ShowDebug(!options.getMisc_ShowDebug());
 	}
+	else if (f5Pressed && options.getMisc_ShowDebug())
+	{
+		// Save the recent render timings next to the log file.
+		const std::string logPath = Platform::getLogPath();
+		if (!Platform::directoryExists(logPath))
+		{
+			Platform::createDirectoryRecursively(logPath);
+		}
+
+		const std::string filename = logPath + "render-timings.txt";
+		game.getRenderer().getRenderTimings().save(filename);
+		DebugLog("Saved render timings to \"" + filename + "\".");
+	}
+	else if (f6Pressed && options.getMisc_ShowDebug())
+	{
+		// Save the profiler's recent zones as a trace next to the log file.
+		if (!Profiler::isEnabled())
+		{
+			DebugLogWarning("Profiler not compiled in (see the TES_PROFILER CMake option).");
+		}
+		else
+		{
+			const std::string logPath = Platform::getLogPath();
+			if (!Platform::directoryExists(logPath))
+			{
+				Platform::createDirectoryRecursively(logPath);
+			}
+
+			const std::string filename = logPath + "profile-trace.json";
+			if (Profiler::save(filename))
+			{
+				DebugLog("Saved profiler trace to \"" + filename + "\".");
+			}
+			else
+			{
+				DebugLogWarning("Couldn't save profiler trace to \"" + filename + "\".");
+			}
+		}
+	}
+	else if (f7Pressed && options.getMisc_ShowDebug())
+	{
+		// Save a snapshot of the metrics next to the log file.
+		const std::string filename = game.saveMetrics();
+		if (!filename.empty())
+		{
+			DebugLog("Saved metrics to \"" + filename + "\".");
+		}
+	}
+	else if (quickSavePressed)
+	{
+		// The file is written in the background. The game data might be gone by the time
+		// it's done (i.e., back at the main menu), and then there's nowhere to say so.
+		const bool compress = options.getMisc_QuickSaveCompression();
+		game.getQuickSave().save(game.getGameData(), compress, [&game](bool success)
+		{
+			if (game.gameDataIsActive())
+			{
+				setActionText(success ? "Game saved." : "Couldn't save the game.", game);
+			}
+		});
+	}
+	else if (quickLoadPressed)
+	{
+		if (game.getQuickSave().load(game.getGameData(), game.getMiscAssets(),
+			game.getTextureManager(), game.getRenderer()))
+		{
+			DebugLog("Quickloaded.");
+		}
+	}
 
 	// Listen for hotkeys.
 	const bool drawWeaponHotkeyPressed = inputManager.keyPressed(e, SDLK_f);
@@ -672,7 +829,7 @@ void GameWorldPanel::handleEvent(const SDL_Event &e)
 		const auto &exeData = game.getMiscAssets().getExeData();
 		const std::string text = [&exeData, &originalVoxel]()
 		{
-			std::string str = exeData.ui.currentWorldPosition;
+			std::string str = exeData.getUI().currentWorldPosition;
 
 			// Replace first %d with X, second %d with Y.
 			size_t index = str.find("%d");
@@ -684,28 +841,7 @@ void GameWorldPanel::handleEvent(const SDL_Event &e)
 			return str;
 		}();
 
-		const RichTextString richText(
-			text,
-			FontName::Arena,
-			ActionTextColor,
-			TextAlignment::Center,
-			game.getFontManager());
-
-		const TextBox::ShadowData shadowData(ActionTextShadowColor, Int2(-1, 0));
-
-		// Create the text box for display (set position to zero; the renderer will decide
-		// where to draw it).
-		auto textBox = std::make_unique<TextBox>(
-			Int2(0, 0),
-			richText,
-			&shadowData,
-			game.getRenderer());
-
-		// Assign the text box and its duration to the action text.
-		auto &gameData = game.getGameData();
-		auto &actionText = gameData.getActionText();
-		const double duration = std::max(2.25, static_cast<double>(text.size()) * 0.050);
-		actionText = GameData::TimedTextBox(duration, std::move(textBox));
+		setActionText(text, game);
 	}
 
 	const bool leftClick = inputManager.mouseButtonPressed(e, SDL_BUTTON_LEFT);
@@ -814,6 +950,12 @@ void GameWorldPanel::handleEvent(const SDL_Event &e)
 	}
 }
 
+bool GameWorldPanel::isSuspendable() const
+{
+	// Menus over the game world don't change anything it built, so it's kept for them.
+	return true;
+}
+
 void GameWorldPanel::onPauseChanged(bool paused)
 {
 	auto &game = this->getGame();
@@ -943,17 +1085,11 @@ void GameWorldPanel::handlePlayerTurning(double dt, const Int2 &mouseDelta)
 
 		if (turning)
 		{
-			const Int2 dimensions = game.getRenderer().getWindowDimensions();
-
-			// Get the smaller of the two dimensions, so the look sensitivity is relative 
-			// to a square instead of a rectangle. This keeps the camera look independent 
-			// of the aspect ratio.
-			const int minDimension = std::min(dimensions.x, dimensions.y);
-			const double dxx = static_cast<double>(dx) / static_cast<double>(minDimension);
-			const double dyy = static_cast<double>(dy) / static_cast<double>(minDimension);
+			const Double2 lookDelta = getMouseLookDelta(mouseDelta,
+				game.getRenderer().getWindowDimensions());
 
 			// Pitch and/or yaw the camera.
-			player.rotate(dxx, -dyy, options.getInput_HorizontalSensitivity(),
+			player.rotate(lookDelta.x, lookDelta.y, options.getInput_HorizontalSensitivity(),
 				options.getInput_VerticalSensitivity(), options.getInput_CameraPitchLimit());
 		}
 	}
@@ -1287,7 +1423,8 @@ void GameWorldPanel::handlePlayerAttack(const Int2 &mouseDelta)
 				}
 
 				// Play the swing sound.
-				audioManager.playSound(SoundFile::fromName(SoundName::Swish));
+				audioManager.playSound(SoundFile::fromName(SoundName::Swish),
+					AudioManager::SoundPriority::High);
 			}
 		}
 		else
@@ -1330,20 +1467,20 @@ void GameWorldPanel::handlePlayerAttack(const Int2 &mouseDelta)
 				weaponAnimation.setState(WeaponAnimation::State::Firing);
 
 				// Play the firing sound.
-				audioManager.playSound(SoundFile::fromName(SoundName::ArrowFire));
+				audioManager.playSound(SoundFile::fromName(SoundName::ArrowFire),
+					AudioManager::SoundPriority::High);
 			}
 		}
 	}	
 }
 
-void GameWorldPanel::handleClickInWorld(const Int2 &nativePoint, bool primaryClick)
+bool GameWorldPanel::rayCastScreenPoint(const Int2 &nativePoint, Physics::Hit &hit) const
 {
 	auto &game = this->getGame();
 	auto &gameData = game.getGameData();
-	auto &player = gameData.getPlayer();
-	auto &worldData = gameData.getWorldData();
-	auto &level = worldData.getActiveLevel();
-	auto &voxelGrid = level.getVoxelGrid();
+	const auto &player = gameData.getPlayer();
+	const auto &level = gameData.getWorldData().getActiveLevel();
+	const auto &voxelGrid = level.getVoxelGrid();
 	const double ceilingHeight = level.getCeilingHeight();
 
 	const Double3 rayStart = player.getPosition();
@@ -1393,8 +1530,54 @@ void GameWorldPanel::handleClickInWorld(const Int2 &nativePoint, bool primaryCli
 		return (forwardComponent + rightComponent - upComponent).normalized();
 	}();
 
+	// The ray cast only tests voxels at the ray start's height, like the renderer's columns,
+	// so an opaque wall drawn first in the point's column is what it would hit. That's only
+	// known to hold if the last frame was drawn from the player's own voxel layer and the
+	// player isn't standing inside a voxel that could be hit first.
+	const Int3 startVoxel(
+		static_cast<int>(std::floor(rayStart.x)),
+		static_cast<int>(std::floor(rayStart.y / ceilingHeight)),
+		static_cast<int>(std::floor(rayStart.z)));
+	const bool startVoxelIsEmpty = (startVoxel.x >= 0) && (startVoxel.y >= 0) &&
+		(startVoxel.z >= 0) && (startVoxel.x < voxelGrid.getWidth()) &&
+		(startVoxel.y < voxelGrid.getHeight()) && (startVoxel.z < voxelGrid.getDepth()) &&
+		(voxelGrid.getVoxelData(voxelGrid.getVoxel(startVoxel.x, startVoxel.y,
+			startVoxel.z)).dataType == VoxelDataType::None);
+
+	Int3 cachedVoxel;
+	double cachedDistance;
+	VoxelData::Facing cachedFacing;
+	if (startVoxelIsEmpty && game.getRenderer().getWorldColumnHit(rayStart,
+		player.getDirection(), nativePoint.x, &cachedVoxel, &cachedDistance, &cachedFacing) &&
+		(cachedVoxel.y == startVoxel.y))
+	{
+		const uint16_t voxelID = voxelGrid.getVoxel(cachedVoxel.x, cachedVoxel.y,
+			cachedVoxel.z);
+		if (voxelGrid.getVoxelData(voxelID).dataType == VoxelDataType::Wall)
+		{
+			hit.t = cachedDistance;
+			hit.point = rayStart + (rayDirection * hit.t);
+			hit.voxel = cachedVoxel;
+			hit.facing = cachedFacing;
+			hit.type = Physics::Hit::Type::Voxel;
+			hit.voxelID = voxelID;
+			return true;
+		}
+	}
+
+	return Physics::rayCast(rayStart, rayDirection, ceilingHeight, voxelGrid, hit);
+}
+
+void GameWorldPanel::handleClickInWorld(const Int2 &nativePoint, bool primaryClick)
+{
+	auto &game = this->getGame();
+	auto &gameData = game.getGameData();
+	auto &worldData = gameData.getWorldData();
+	auto &level = worldData.getActiveLevel();
+	auto &voxelGrid = level.getVoxelGrid();
+
 	Physics::Hit hit;
-	const bool success = Physics::rayCast(rayStart, rayDirection, ceilingHeight, voxelGrid, hit);
+	const bool success = this->rayCastScreenPoint(nativePoint, hit);
 
 	// See if the ray hit anything.
 	if (success)
@@ -1440,28 +1623,19 @@ void GameWorldPanel::handleClickInWorld(const Int2 &nativePoint, bool primaryCli
 
 					// If the door is closed, then open it.
 					auto &openDoors = level.getOpenDoors();
-					const bool isClosed = [&openDoors, &voxelXZ]()
-					{
-						const auto iter = std::find_if(openDoors.begin(), openDoors.end(),
-							[&voxelXZ](const LevelData::DoorState &openDoor)
-						{
-							return openDoor.getVoxel() == voxelXZ;
-						});
-
-						return iter == openDoors.end();
-					}();
+					const bool isClosed = openDoors.find(voxelXZ) == nullptr;
 
 					if (isClosed)
 					{
 						// Add the door to the open doors list.
-						openDoors.push_back(LevelData::DoorState(voxelXZ));
+						openDoors.add(voxelXZ);
 
 						// Get the door's opening sound index and play it.
 						const int soundIndex = doorData.getOpenSoundIndex();
 						const auto &inf = level.getInfFile();
 						const std::string &soundFilename = inf.getSound(soundIndex);
 						auto &audioManager = game.getAudioManager();
-						audioManager.playSound(soundFilename);
+						audioManager.playSound(soundFilename, AudioManager::SoundPriority::High);
 					}
 				}
 			}
@@ -1507,7 +1681,7 @@ void GameWorldPanel::handleClickInWorld(const Int2 &nativePoint, bool primaryCli
 							{
 								const auto &miscAssets = game.getMiscAssets();
 								const auto &exeData = miscAssets.getExeData();
-								menuName = exeData.cityGen.magesGuildMenuName;
+								menuName = exeData.getCityGeneration().magesGuildMenuName;
 							}
 							else
 							{
@@ -1518,24 +1692,21 @@ void GameWorldPanel::handleClickInWorld(const Int2 &nativePoint, bool primaryCli
 							}
 						}
 
-						const RichTextString richText(
+						const TextBox::ShadowData shadowData(ActionTextShadowColor, Int2(-1, 0));
+
+						auto textBox = game.getTextBoxCache().get(
 							menuName,
 							FontName::Arena,
 							ActionTextColor,
 							TextAlignment::Center,
-							game.getFontManager());
-
-						const TextBox::ShadowData shadowData(ActionTextShadowColor, Int2(-1, 0));
-
-						auto textBox = std::make_unique<TextBox>(
-							Int2(0, 0),
-							richText,
+							0,
 							&shadowData,
+							game.getFontManager(),
 							game.getRenderer());
 
 						auto &actionText = gameData.getActionText();
 						const double duration = std::max(2.25,
-							static_cast<double>(richText.getText().size()) * 0.050);
+							static_cast<double>(menuName.size()) * 0.050);
 						actionText = GameData::TimedTextBox(duration, std::move(textBox));
 					}
 				}
@@ -1570,22 +1741,18 @@ void GameWorldPanel::handleTriggers(const Int2 &voxel)
 					0, textTrigger->getText().size() - 1);
 				const int lineSpacing = 1;
 
-				const RichTextString richText(
+				const TextBox::ShadowData shadowData(TriggerTextShadowColor, Int2(-1, 0));
+
+				// Get the text box for display from the cache, since triggers are often
+				// walked over more than once (the renderer will decide where to draw it).
+				auto textBox = game.getTextBoxCache().get(
 					text,
 					FontName::Arena,
 					TriggerTextColor,
 					TextAlignment::Center,
 					lineSpacing,
-					game.getFontManager());
-
-				const TextBox::ShadowData shadowData(TriggerTextShadowColor, Int2(-1, 0));
-
-				// Create the text box for display (set position to zero; the renderer will
-				// decide where to draw it).
-				auto textBox = std::make_unique<TextBox>(
-					Int2(0, 0),
-					richText,
 					&shadowData,
+					game.getFontManager(),
 					game.getRenderer());
 
 				// Assign the text box and its duration to the triggered text member. It will 
@@ -1619,44 +1786,57 @@ void GameWorldPanel::handleDoors(double dt, const Double2 &playerPos)
 	auto &worldData = gameData.getWorldData();
 	auto &activeLevel = worldData.getActiveLevel();
 	auto &openDoors = activeLevel.getOpenDoors();
+
+	// Most of the time no doors are moving.
+	if (openDoors.getCount() == 0)
+	{
+		return;
+	}
+
 	const auto &voxelGrid = activeLevel.getVoxelGrid();
 
-	// Lambda for playing a sound by .INF sound index if the close sound types match.
-	auto playSoundIfType = [&game, &activeLevel](
-		const VoxelData::DoorData::CloseSoundData &closeSoundData,
+	// Lambda for playing a door's close sound by .INF sound index if the close sound types
+	// match. The door's voxel data is only looked up when it changes direction or closes.
+	auto playSoundIfType = [&game, &activeLevel, &voxelGrid](const Int2 &voxel,
 		VoxelData::DoorData::CloseSoundType closeSoundType)
 	{
+		const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, 1, voxel.y);
+		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+		const auto closeSoundData = voxelData.door.getCloseSoundData();
 		if (closeSoundData.type == closeSoundType)
 		{
 			const auto &inf = activeLevel.getInfFile();
 			const std::string &soundFilename = inf.getSound(closeSoundData.soundIndex);
+
+			// Doors close by themselves, so their sounds give way to others. They're heard
+			// from the middle of the door.
+			const double ceilingHeight = activeLevel.getCeilingHeight();
+			const Double3 soundPosition(
+				static_cast<double>(voxel.x) + 0.50,
+				ceilingHeight * 1.50,
+				static_cast<double>(voxel.y) + 0.50);
+
 			auto &audioManager = game.getAudioManager();
-			audioManager.playSound(soundFilename);
+			audioManager.addEmitter(soundFilename, soundPosition,
+				AudioManager::SoundPriority::Low, 1.0, false);
 		}
 	};
 
-	// Update each open door and remove ones that become closed. A reverse iterator loop
-	// was causing increment issues after erasing.
-	for (int i = static_cast<int>(openDoors.size()) - 1; i >= 0; i--)
+	// Update each open door and remove ones that become closed. Looping backwards lets
+	// removed doors be replaced by ones that were already updated.
+	for (int i = openDoors.getCount() - 1; i >= 0; i--)
 	{
-		auto &door = openDoors.at(i);
+		auto &door = openDoors.get(i);
 		door.update(dt);
 
-		// Get the door's voxel data and its close sound data for determining how it plays
-		// sounds when closing.
-		const Int2 &voxel = door.getVoxel();
-		const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, 1, voxel.y);
-		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
-		const VoxelData::DoorData &doorData = voxelData.door;
-		const auto closeSoundData = doorData.getCloseSoundData();
-
+		const Int2 voxel = door.getVoxel();
 		if (door.isClosed())
 		{
 			// Only some doors play a sound when they become closed.
-			playSoundIfType(closeSoundData, VoxelData::DoorData::CloseSoundType::OnClosed);
+			playSoundIfType(voxel, VoxelData::DoorData::CloseSoundType::OnClosed);
 
 			// Erase closed door.
-			openDoors.erase(openDoors.begin() + i);
+			openDoors.remove(voxel);
 		}
 		else if (!door.isClosing())
 		{
@@ -1678,7 +1858,7 @@ void GameWorldPanel::handleDoors(double dt, const Double2 &playerPos)
 				door.setDirection(LevelData::DoorState::Direction::Closing);
 
 				// Only some doors play a sound when they start closing.
-				playSoundIfType(closeSoundData, VoxelData::DoorData::CloseSoundType::OnClosing);
+				playSoundIfType(voxel, VoxelData::DoorData::CloseSoundType::OnClosing);
 			}
 		}
 	}
@@ -1785,20 +1965,18 @@ void GameWorldPanel::handleWorldTransition(const Physics::Hit &hit, int menuID)
 				// Enter the interior location if the .MIF name is valid.
 				if (mifName.size() > 0)
 				{
+					// Decode the interior on a worker thread so the game keeps drawing frames,
+					// unless it was already prefetched. It's entered once it's ready in tick().
 					// @todo: I think dungeons can't use enterInterior(). They need an enterDungeon() method.
-					MIFFile mif;
-					if (!mif.init(mifName.c_str()))
+					this->pendingInteriorMifName = mifName;
+					this->pendingInteriorReturnVoxel = Int2(returnVoxel.x, returnVoxel.z);
+					this->loadingSeconds = 0.0;
+					this->pendingInterior = this->interiorPrefetcher.take(mifName);
+					if (!this->pendingInterior.valid())
 					{
-						DebugCrash("Could not init .MIF file \"" + mifName + "\".");
+						this->pendingInterior = InteriorPrefetcher::loadAsync(mifName, exeData,
+							JobSystem::Priority::Streaming);
 					}
-
-					gameData.enterInterior(mif, Int2(returnVoxel.x, returnVoxel.z),
-						exeData, game.getTextureManager(), game.getRenderer());
-
-					// Change to interior music.
-					Random random;
-					const MusicName musicName = GameData::getInteriorMusicName(mifName, random);
-					game.setMusic(musicName);
 				}
 				else
 				{
@@ -1816,6 +1994,87 @@ void GameWorldPanel::handleWorldTransition(const Physics::Hit &hit, int menuID)
 	}
 }
 
+bool GameWorldPanel::isLoadingLevel() const
+{
+	return this->pendingInterior.valid();
+}
+
+void GameWorldPanel::finishEnteringInterior()
+{
+	DebugAssert(this->isLoadingLevel());
+
+	auto &game = this->getGame();
+	auto &gameData = game.getGameData();
+
+	// Only activating the interior touches the texture manager and renderer.
+	gameData.enterInterior(this->pendingInterior.get(), this->pendingInteriorReturnVoxel,
+		game.getTextureManager(), game.getRenderer());
+
+	// Change to interior music.
+	Random random;
+	const MusicName musicName = GameData::getInteriorMusicName(
+		this->pendingInteriorMifName, random);
+	game.setMusic(musicName);
+
+	this->pendingInteriorMifName.clear();
+	this->loadingSeconds = 0.0;
+}
+
+void GameWorldPanel::prefetchNearbyInteriors(const Int2 &playerVoxel)
+{
+	auto &game = this->getGame();
+	auto &gameData = game.getGameData();
+	const auto &worldData = gameData.getWorldData();
+	DebugAssert(worldData.getActiveWorldType() == WorldType::City);
+
+	const auto &level = worldData.getActiveLevel();
+	const auto &voxelGrid = level.getVoxelGrid();
+	const auto &cityDataFile = gameData.getCityDataFile();
+	const Location &location = gameData.getLocation();
+	const auto &exeData = game.getMiscAssets().getExeData();
+
+	// *MENU voxels are on the main floor.
+	const int y = 1;
+	const int distance = InteriorPrefetcher::DOOR_DISTANCE;
+	const int minX = std::max(playerVoxel.x - distance, 0);
+	const int maxX = std::min(playerVoxel.x + distance, voxelGrid.getWidth() - 1);
+	const int minZ = std::max(playerVoxel.y - distance, 0);
+	const int maxZ = std::min(playerVoxel.y + distance, voxelGrid.getDepth() - 1);
+	for (int x = minX; x <= maxX; x++)
+	{
+		for (int z = minZ; z <= maxZ; z++)
+		{
+			if ((level.getVoxelFlags(Int2(x, z)) & LevelData::VOXEL_MENU) == 0)
+			{
+				continue;
+			}
+
+			const VoxelData &voxelData = voxelGrid.getVoxelData(voxelGrid.getVoxel(x, y, z));
+			const VoxelData::WallData &wallData = voxelData.wall;
+
+			const bool isCity = true;
+			const VoxelData::WallData::MenuType menuType =
+				VoxelData::WallData::getMenuType(wallData.menuID, isCity);
+			if (!VoxelData::WallData::menuLeadsToInterior(menuType))
+			{
+				continue;
+			}
+
+			// Same .MIF name as handleWorldTransition() gets for the door.
+			const Int2 originalVoxel = VoxelGrid::getTransformedCoordinate(
+				Int2(x, z), voxelGrid.getWidth(), voxelGrid.getDepth());
+			const std::string mifName = cityDataFile.getDoorVoxelMifName(
+				originalVoxel.x, originalVoxel.y, wallData.menuID, location.localCityID,
+				location.provinceID, isCity, exeData);
+
+			if (mifName.size() > 0)
+			{
+				this->interiorPrefetcher.prefetch(mifName, exeData);
+			}
+		}
+	}
+}
+
 void GameWorldPanel::handleLevelTransition(const Int2 &playerVoxel, const Int2 &transitionVoxel)
 {
 	auto &game = this->getGame();
@@ -1982,25 +2241,97 @@ void GameWorldPanel::handleLevelTransition(const Int2 &playerVoxel, const Int2 &
 	}
 }
 
+void GameWorldPanel::updateInterfaceLayer(const Player &player,
+	TextureManager &textureManager, Renderer &renderer)
+{
+	const Surface &gameInterface = textureManager.getSurface(this->gameInterfaceSurfaceID);
+	const int interfaceY = Renderer::ORIGINAL_HEIGHT - gameInterface.getHeight();
+
+	// Redraws the interface under a region, for elements that might not fully cover
+	// what was there before.
+	auto restoreInterface = [this, &gameInterface, interfaceY](const Rect &rect)
+	{
+		this->interfaceLayer.fillRect(rect, 0, 0, 0, 0);
+		this->interfaceLayer.blitRect(gameInterface, Rect(rect.getLeft(),
+			rect.getTop() - interfaceY, rect.getWidth(), rect.getHeight()),
+			rect.getLeft(), rect.getTop());
+	};
+
+	if (!this->interfaceLayer.isInited())
+	{
+		this->interfaceLayer.init(0, interfaceY, gameInterface.getWidth(),
+			gameInterface.getHeight(), renderer);
+		this->interfaceLayer.blit(gameInterface, 0, interfaceY);
+
+		// Player name.
+		this->interfaceLayer.blit(this->playerNameTextBox->getSurface(),
+			this->playerNameTextBox->getX(), this->playerNameTextBox->getY());
+
+		this->interfacePortraitID = -1;
+		this->interfaceShowsNoSpell = false;
+	}
+
+	// Player portrait over the status gradient.
+	const int portraitID = player.getPortraitID();
+	if (portraitID != this->interfacePortraitID)
+	{
+		const auto &headsFilename = PortraitFile::getHeads(
+			player.getGenderName(), player.getRaceID(), true);
+		const Surface &portrait = textureManager.getSurfaces(headsFilename).at(portraitID);
+		const Surface &status = textureManager.getSurfaces(
+			this->statusGradientsSurfaceSetID).at(0);
+
+		const int portraitX = 14;
+		const int portraitY = 166;
+		restoreInterface(Rect(portraitX, portraitY,
+			std::max(status.getWidth(), portrait.getWidth()),
+			std::max(status.getHeight(), portrait.getHeight())));
+		this->interfaceLayer.blit(status, portraitX, portraitY);
+		this->interfaceLayer.blit(portrait, portraitX, portraitY);
+		this->interfacePortraitID = portraitID;
+	}
+
+	// If the player's class can't use magic, show the darkened spell icon.
+	const bool showsNoSpell = !player.getCharacterClass().canCastMagic();
+	if (showsNoSpell != this->interfaceShowsNoSpell)
+	{
+		const Surface &nonMagicIcon = textureManager.getSurface(this->noSpellSurfaceID);
+
+		const int iconX = 91;
+		const int iconY = 177;
+		restoreInterface(Rect(iconX, iconY, nonMagicIcon.getWidth(), nonMagicIcon.getHeight()));
+
+		if (showsNoSpell)
+		{
+			this->interfaceLayer.blit(nonMagicIcon, iconX, iconY);
+		}
+
+		this->interfaceShowsNoSpell = showsNoSpell;
+	}
+}
+
 void GameWorldPanel::drawTooltip(const std::string &text, Renderer &renderer)
 {
-	const Texture tooltip = Panel::createTooltip(
-		text, FontName::D, this->getGame().getFontManager(), renderer);
+	if (text != this->tooltipText)
+	{
+		this->tooltipTexture = Panel::createTooltip(
+			text, FontName::D, this->getGame().getFontManager(), renderer);
+		this->tooltipText = text;
+	}
 
 	auto &textureManager = this->getGame().getTextureManager();
-	const auto &gameInterface = textureManager.getTexture(
-		TextureFile::fromName(TextureName::GameWorldInterface), renderer);
+	const auto &gameInterface = textureManager.getTexture(this->gameInterfaceTextureID);
 
-	renderer.drawOriginal(tooltip, 0, Renderer::ORIGINAL_HEIGHT -
-		gameInterface.getHeight() - tooltip.getHeight());
+	renderer.drawOriginal(this->tooltipTexture, 0, Renderer::ORIGINAL_HEIGHT -
+		gameInterface.getHeight() - this->tooltipTexture.getHeight());
 }
 
 void GameWorldPanel::drawCompass(const Double2 &direction, 
 	TextureManager &textureManager, Renderer &renderer)
 {
 	// Draw compass slider based on player direction. +X is north, +Z is east.
-	const auto &compassSlider = textureManager.getTexture(
-		TextureFile::fromName(TextureName::CompassSlider), renderer);
+	const Surface &compassSlider = textureManager.getSurface(this->compassSliderSurfaceID);
+	const Surface &compassFrame = textureManager.getSurface(this->compassFrameSurfaceID);
 
 	// Angle between 0 and 2 pi.
 	const double angle = std::atan2(direction.y, direction.x);
@@ -2019,17 +2350,35 @@ void GameWorldPanel::drawCompass(const Double2 &direction,
 	const int sliderY = clipRect.getHeight();
 
 	// Since there are some off-by-one rounding errors with SDL_RenderCopy,
-	// draw a black rectangle behind the slider to cover up gaps.
-	renderer.fillOriginalRect(Color::Black, sliderX - 1, sliderY - 1,
+	// keep a black rectangle behind the slider to cover up gaps.
+	const Rect sliderBorderRect(sliderX - 1, sliderY - 1,
 		clipRect.getWidth() + 2, clipRect.getHeight() + 2);
 
-	renderer.drawOriginalClipped(compassSlider, clipRect, sliderX, sliderY);
+	const int frameX = (Renderer::ORIGINAL_WIDTH / 2) - (compassFrame.getWidth() / 2);
+
+	if (!this->compassLayer.isInited())
+	{
+		const int left = std::min(frameX, sliderBorderRect.getLeft());
+		const int right = std::max(frameX + compassFrame.getWidth(),
+			sliderBorderRect.getRight());
+		const int bottom = std::max(compassFrame.getHeight(), sliderBorderRect.getBottom());
+		this->compassLayer.init(left, 0, right - left, bottom, renderer);
+		this->compassLayer.blit(compassFrame, frameX, 0);
+		this->compassSliderOffset = -1;
+	}
 
-	// Draw the compass frame over the slider.
-	const auto &compassFrame = textureManager.getTexture(
-		TextureFile::fromName(TextureName::CompassFrame), renderer);
-	renderer.drawOriginal(compassFrame,
-		(Renderer::ORIGINAL_WIDTH / 2) - (compassFrame.getWidth() / 2), 0);
+	// Only the slider and the part of the frame over it change when turning.
+	if (xOffset != this->compassSliderOffset)
+	{
+		this->compassLayer.fillRect(sliderBorderRect, 0, 0, 0, 255);
+		this->compassLayer.blitRect(compassSlider, clipRect, sliderX, sliderY);
+		this->compassLayer.blitRect(compassFrame, Rect(sliderBorderRect.getLeft() - frameX,
+			sliderBorderRect.getTop(), sliderBorderRect.getWidth(),
+			sliderBorderRect.getHeight()), sliderBorderRect.getLeft(), sliderBorderRect.getTop());
+		this->compassSliderOffset = xOffset;
+	}
+
+	this->compassLayer.draw(renderer);
 }
 
 void GameWorldPanel::drawDebugText(Renderer &renderer)
@@ -2037,7 +2386,7 @@ void GameWorldPanel::drawDebugText(Renderer &renderer)
 	const Int2 windowDims = renderer.getWindowDimensions();
 
 	auto &game = this->getGame();
-	const double resolutionScale = game.getOptions().getGraphics_ResolutionScale();
+	const double resolutionScale = renderer.getResolutionScale();
 
 	const FPSCounter &fpsCounter = game.getFPSCounter();
 	const double targetFps = static_cast<double>(game.getOptions().getGraphics_TargetFPS());
@@ -2051,32 +2400,196 @@ void GameWorldPanel::drawDebugText(Renderer &renderer)
 	const auto &worldData = gameData.getWorldData();
 	const auto &level = worldData.getActiveLevel();
 
-	const std::string text =
-		"Screen: " + std::to_string(windowDims.x) + "x" + std::to_string(windowDims.y) + "\n" +
-		"Resolution scale: " + String::fixedPrecision(resolutionScale, 2) + "\n" +
-		"FPS: " + String::fixedPrecision(fpsCounter.getFPS(), 1) + "\n" +
-		"Map: " + worldData.getMifName() + "\n" +
-		"Info: " + level.getInfFile().getName() + "\n" +
-		"X: " + String::fixedPrecision(position.x, 5) + "\n" +
-		"Y: " + String::fixedPrecision(position.y, 5) + "\n" +
-		"Z: " + String::fixedPrecision(position.z, 5) + "\n" +
-		"DirX: " + String::fixedPrecision(direction.x, 5) + "\n" +
-		"DirY: " + String::fixedPrecision(direction.y, 5) + "\n" +
-		"DirZ: " + String::fixedPrecision(direction.z, 5) + "\n\n" +
-		"FPS Graph:" + "\n" +
-		"                               " + std::to_string(static_cast<int>(targetFps)) + "\n\n\n\n" +
-		"                               " + std::to_string(static_cast<int>(minFps));
-
-	const RichTextString richText(
-		text,
-		FontName::D,
-		Color::White,
-		TextAlignment::Left,
-		game.getFontManager());
+	// The text is rebuilt every frame, so it's made in the frame arena. Numbers are short
+	// enough that their own strings don't allocate.
+	FrameArena &frameArena = game.getFrameArena();
+	std::pmr::string text(&frameArena);
+	text.reserve(2048);
+
+	auto appendFixed = [&text](double value, int precision)
+	{
+		text += String::fixedPrecision(value, precision);
+	};
+
+	auto appendInt = [&text](uint64_t value)
+	{
+		text += std::to_string(value);
+	};
+
+	text += "Screen: ";
+	appendInt(windowDims.x);
+	text += "x";
+	appendInt(windowDims.y);
+	text += "\nResolution scale: ";
+	appendFixed(resolutionScale, 2);
+	text += "\nFPS: ";
+	appendFixed(fpsCounter.getFPS(), 1);
+	text += "\nMap: ";
+	text += worldData.getMifName();
+	text += "\nInfo: ";
+	text += level.getInfFile().getName();
+	text += "\nX: ";
+	appendFixed(position.x, 5);
+	text += "\nY: ";
+	appendFixed(position.y, 5);
+	text += "\nZ: ";
+	appendFixed(position.z, 5);
+	text += "\nDirX: ";
+	appendFixed(direction.x, 5);
+	text += "\nDirY: ";
+	appendFixed(direction.y, 5);
+	text += "\nDirZ: ";
+	appendFixed(direction.z, 5);
+	text += "\n\nFPS Graph:\n                               ";
+	appendInt(static_cast<int>(targetFps));
+	text += "\n\n\n\n                               ";
+	appendInt(static_cast<int>(minFps));
+
+	// How late the frame limiter woke up compared to the target frame time.
+	const FramePacer &framePacer = game.getFramePacer();
+	text += "\n\nFrame pacing late avg/max (ms): ";
+	appendFixed(framePacer.getAverageLateTime() * 1000.0, 3);
+	text += "/";
+	appendFixed(framePacer.getMaxLateTime() * 1000.0, 3);
+
+	// Time from input to the frame showing it being presented.
+	text += "\nInput latency avg/max (ms): ";
+	appendFixed(fpsCounter.getAverageInputLatency() * 1000.0, 1);
+	text += "/";
+	appendFixed(fpsCounter.getMaxInputLatency() * 1000.0, 1);
+
+	// Frame time spread since the stats were last exported (or since startup). Read one
+	// at a time since the stats struct copies the hitch vectors.
+	text += "\nFrames p50/p95/p99 (ms): ";
+	appendFixed(fpsCounter.getPercentileTime(0.50) * 1000.0, 1);
+	text += "/";
+	appendFixed(fpsCounter.getPercentileTime(0.95) * 1000.0, 1);
+	text += "/";
+	appendFixed(fpsCounter.getPercentileTime(0.99) * 1000.0, 1);
+	text += ", lows ";
+	appendFixed(fpsCounter.getLowFPS(0.01), 1);
+	text += "/";
+	appendFixed(fpsCounter.getLowFPS(0.001), 1);
+	text += " FPS, hitches ";
+	const std::vector<uint64_t> &hitchCounts = fpsCounter.getHitchCounts();
+	for (size_t i = 0; i < hitchCounts.size(); i++)
+	{
+		text += (i > 0) ? "/" : "";
+		appendInt(hitchCounts[i]);
+	}
+
+	if (hitchCounts.empty())
+	{
+		text += "-";
+	}
+
+	// Texture cache memory in megabytes, and how many lookups were already loaded.
+	const TextureManager::CacheStats &cacheStats = game.getTextureManager().getCacheStats();
+	const uint64_t lookupCount = cacheStats.hitCount + cacheStats.missCount;
+	text += "\nTextures: ";
+	appendFixed(static_cast<double>(cacheStats.residentBytes) / (1024.0 * 1024.0), 1);
+	text += "/";
+	appendFixed(static_cast<double>(cacheStats.budgetBytes) / (1024.0 * 1024.0), 1);
+	text += " MB, ";
+	appendFixed((lookupCount > 0) ? (100.0 * static_cast<double>(cacheStats.hitCount) /
+		static_cast<double>(lookupCount)) : 0.0, 1);
+	text += "% hits, ";
+	appendInt(cacheStats.evictionCount);
+	text += " evicted";
+
+	const AudioManager::SoundStats &soundStats = game.getAudioManager().getSoundStats();
+	text += "\nSounds: ";
+	appendInt(soundStats.playedCount);
+	text += " played, ";
+	appendInt(soundStats.droppedCount);
+	text += " dropped, ";
+	appendInt(soundStats.stolenCount);
+	text += " stolen";
+
+	const AudioManager::MusicStats musicStats = game.getAudioManager().getMusicStats();
+	text += "\nMusic: ";
+	appendInt(musicStats.underrunCount);
+	text += " underruns, ";
+	appendInt(musicStats.starvedCount);
+	text += " synth stalls, ";
+	appendInt(musicStats.queuedBufferCount);
+	text += " buffers, ";
+	appendInt(musicStats.cachedSongCount);
+	text += " cached";
+
+	// Peak is over the whole run since the arena only grows to fit it once.
+	text += "\nFrame arena peak/size (KB): ";
+	appendFixed(static_cast<double>(frameArena.getPeakBytes()) / 1024.0, 1);
+	text += "/";
+	appendFixed(static_cast<double>(frameArena.getCapacity()) / 1024.0, 1);
+	text += ", ";
+	appendInt(frameArena.getLastOverflowCount());
+	text += " overflowed";
+
+	// Totals per subsystem and the biggest single consumers, updated about once a second.
+	const MemoryReport &memoryReport = game.getMemoryReport();
+	const double bytesPerMegabyte = 1024.0 * 1024.0;
+	text += "\nMemory (MB): ";
+	appendFixed(static_cast<double>(memoryReport.getTotalBytes()) / bytesPerMegabyte, 1);
+	text += " total";
+	for (const char *group : { "Textures", "Renderer", "Audio", "World", "Assets" })
+	{
+		text += ", ";
+		text += group;
+		text += " ";
+		appendFixed(static_cast<double>(memoryReport.getGroupBytes(group)) / bytesPerMegabyte, 1);
+	}
+
+	const std::vector<MemoryReport::Entry> &memoryEntries = memoryReport.getEntries();
+	text += "\nBiggest (MB): ";
+	for (size_t i = 0; i < std::min<size_t>(memoryEntries.size(), 3); i++)
+	{
+		text += (i > 0) ? ", " : "";
+		text += memoryEntries[i].name;
+		text += " ";
+		appendFixed(static_cast<double>(memoryEntries[i].bytes) / bytesPerMegabyte, 1);
+	}
+
+	// Time each render thread spent working and waiting last frame, for checking load balance.
+	const RenderTimings &renderTimings = renderer.getRenderTimings();
+	text += "\nRender threads busy/wait (ms): ";
+	for (int i = 0; i < renderTimings.getThreadCount(); i++)
+	{
+		text += (i > 0) ? " " : "";
+		appendFixed(renderTimings.getThreadBusyTime(i) * 1000.0, 1);
+		text += "/";
+		const double waitTime = renderTimings.getThreadTime(i, RenderTimings::Phase::ThreadWait);
+		appendFixed(waitTime * 1000.0, 1);
+	}
 
+	text += "\nKernels: ";
+	text += KernelDispatch::getSelectionsText();
+
+	// Min, average, and 99th percentile of each phase over recent frames. Render thread
+	// phases use the slowest thread. Phases that didn't run recently are left out.
+	text += "\nPhase min/avg/p99 (ms, F5 to save):";
+	for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+	{
+		const RenderTimings::Phase phase = static_cast<RenderTimings::Phase>(i);
+		const RenderTimings::Stats stats = renderTimings.getStats(phase);
+		if (stats.p99 > 0.0)
+		{
+			text += "\n";
+			text += RenderTimings::getPhaseName(phase);
+			text += ": ";
+			appendFixed(stats.min * 1000.0, 2);
+			text += " ";
+			appendFixed(stats.avg * 1000.0, 2);
+			text += " ";
+			appendFixed(stats.p99 * 1000.0, 2);
+		}
+	}
+
+	// Drawn from the font's glyph atlas since the text changes every frame.
 	const int x = 2;
 	const int y = 2;
-	const TextBox tempText(x, y, richText, renderer);
+	TextBox::drawBatched(x, y, text, FontName::D, Color::White, game.getFontManager(),
+		renderer);
 
 	// Create graph of frame times.
 	const Texture frameTimesGraph = [&renderer, &game, &fpsCounter, targetFps, minFps]()
@@ -2139,8 +2652,7 @@ void GameWorldPanel::drawDebugText(Renderer &renderer)
 		return renderer.createTextureFromSurface(surface);
 	}();
 
-	renderer.drawOriginal(tempText.getTexture(), tempText.getX(), tempText.getY());
-	renderer.drawOriginal(frameTimesGraph, tempText.getX(), 94);
+	renderer.drawOriginal(frameTimesGraph, x, 94);
 }
 
 void GameWorldPanel::tick(double dt)
@@ -2148,6 +2660,75 @@ void GameWorldPanel::tick(double dt)
 	auto &game = this->getGame();
 	DebugAssert(game.gameDataIsActive());
 
+	// Remember where the view was so frames drawn before the next tick can blend from it.
+	const Player &lastTickPlayer = game.getGameData().getPlayer();
+	this->lastTickPlayerPosition = lastTickPlayer.getPosition();
+	this->lastTickPlayerDirection = lastTickPlayer.getDirection();
+	this->lastTickCount = game.getTickCount();
+
+	// The world stays frozen while a level is loading in the background.
+	if (this->isLoadingLevel())
+	{
+		this->loadingSeconds += dt;
+
+		// The interior must finish on the same tick in a replay as in its recording.
+		const InputRecording &inputRecording = game.getInputRecording();
+		if (inputRecording.isRecording() || inputRecording.isReplaying())
+		{
+			this->pendingInterior.wait();
+		}
+
+		const std::future_status status = this->pendingInterior.wait_for(std::chrono::seconds(0));
+		if (status == std::future_status::ready)
+		{
+			this->finishEnteringInterior();
+		}
+
+		return;
+	}
+
+	// Preload the sounds of a newly active level so doors and triggers don't hitch the
+	// first time they're heard.
+	const INFFile &activeInf = game.getGameData().getWorldData().getActiveLevel().getInfFile();
+	if (activeInf.getName() != this->preloadedSoundsInfName)
+	{
+		std::vector<std::string> soundFilenames;
+		for (const auto &pair : activeInf.getSounds())
+		{
+			soundFilenames.push_back(pair.second);
+		}
+
+		game.getAudioManager().preloadSounds(soundFilenames);
+		this->preloadedSoundsInfName = activeInf.getName();
+	}
+
+	// Every level of an interior is built when it's loaded, so taking the stairs only has to
+	// activate the next level. Decode the textures of the levels above and below ahead of
+	// time so that doesn't wait on them either.
+	const WorldData &activeWorldData = game.getGameData().getWorldData();
+	const LevelData &activeLevel = activeWorldData.getActiveLevel();
+	if (&activeLevel != this->texturePrefetchLevel)
+	{
+		this->texturePrefetchLevel = &activeLevel;
+
+		if (activeWorldData.getActiveWorldType() == WorldType::Interior)
+		{
+			const InteriorWorldData &interior =
+				(activeWorldData.getBaseWorldType() == WorldType::Interior) ?
+				static_cast<const InteriorWorldData&>(activeWorldData) :
+				*static_cast<const ExteriorWorldData&>(activeWorldData).getInterior();
+
+			const int levelIndex = interior.getLevelIndex();
+			for (const int adjacentIndex : { levelIndex - 1, levelIndex + 1 })
+			{
+				if ((adjacentIndex >= 0) && (adjacentIndex < interior.getLevelCount()))
+				{
+					interior.getLevel(adjacentIndex).prefetchTextures(game.getTextureManager());
+				}
+			}
+		}
+	}
+
 	// Get the relative mouse state.
 	const auto &inputManager = game.getInputManager();
 	const Int2 mouseDelta = inputManager.getMouseDelta();
@@ -2164,6 +2745,17 @@ void GameWorldPanel::tick(double dt)
 
 	auto &renderer = game.getRenderer();
 
+	// Fit the game world resolution to the measured frame time if enabled.
+	const auto &options = game.getOptions();
+	if (options.getGraphics_DynamicResolution())
+	{
+		const FPSCounter &fpsCounter = game.getFPSCounter();
+		const double targetFrameTime = 1.0 / static_cast<double>(options.getGraphics_TargetFPS());
+		renderer.updateDynamicResolution(fpsCounter.getFrameTime(0),
+			fpsCounter.getAverageBusyTime(), targetFrameTime, Options::MIN_RESOLUTION_SCALE,
+			options.getGraphics_ResolutionScale());
+	}
+
 	// See if the clock passed the boundary between night and day, and vice versa.
 	const double oldClockTime = oldClock.getPreciseTotalSeconds();
 	const double newClockTime = newClock.getPreciseTotalSeconds();
@@ -2221,6 +2813,23 @@ void GameWorldPanel::tick(double dt)
 	auto &levelData = worldData.getActiveLevel();
 	levelData.tick(dt);
 
+	// Animated voxel textures run on the renderer's own clock.
+	game.getRenderer().tickAnimations(dt);
+
+	// Keep the chunks around the player in the voxel grid.
+	const Int3 playerVoxel = gameData.getPlayer().getVoxelPosition();
+	levelData.updateResidentChunks(Int2(playerVoxel.x, playerVoxel.z),
+		game.getOptions().getMisc_ChunkDistance());
+
+	// Recorded input only replays the same if chunks arrive on the same tick, so wait for
+	// background work while recording or replaying.
+	const InputRecording &inputRecording = game.getInputRecording();
+	const bool isDeterministic = inputRecording.isRecording() || inputRecording.isReplaying();
+	if (isDeterministic)
+	{
+		levelData.waitForChunks();
+	}
+
 	// Tick text timers if their remaining duration is positive.
 	auto &triggerText = gameData.getTriggerText();
 	auto &actionText = gameData.getActionText();
@@ -2250,21 +2859,40 @@ void GameWorldPanel::tick(double dt)
 	const Double3 newPlayerPos = player.getPosition();
 	this->handleDoors(dt, Double2(newPlayerPos.x, newPlayerPos.z));
 
+	// Hear sounds in the world from the player, through whatever voxels are in the way.
+	auto &audioManager = game.getAudioManager();
+	audioManager.setListener(newPlayerPos, player.getDirection());
+	audioManager.updateEmitterOcclusion(levelData.getCeilingHeight(), levelData.getVoxelGrid());
+
 	// Update entities and their state in the renderer.
 	// @todo: entity management.
 	/*auto &entityManager = worldData.getEntityManager();
-	for (auto *entity : entityManager.getAllEntities())
+	const Double2 playerPositionXZ(newPlayerPos.x, newPlayerPos.z);
+	const Double2 groundDirection = player.getGroundDirection();
+
+	// Entities behind the player can't be on screen.
+	auto isVisible = [&playerPositionXZ, &groundDirection](const Entity &entity)
+	{
+		const Double3 &position = entity.getPosition();
+		const Double2 diff = Double2(position.x, position.z) - playerPositionXZ;
+		return diff.dot(groundDirection) >= -EntityManager::ENTITY_RADIUS;
+	};
+
+	// Entity ticks are spread over the render threads, which are idle between frames.
+	auto runParallel = [&renderer](int batchCount, const std::function<void(int)> &batchFunction)
 	{
-		// Tick entity state.
-		entity->tick(game, dt);
+		renderer.runParallel(batchCount, batchFunction);
+	};
 
+	entityManager.tick(game, dt, playerPositionXZ, isVisible, [&renderer](Entity &entity)
+	{
 		// Update entity flat properties for rendering.
-		const Double3 position = entity->getPosition();
-		const int textureID = entity->getTextureID();
-		const bool flipped = entity->getFlipped();
-		renderer.updateFlat(entity->getID(), &position, nullptr, nullptr,
-			&textureID, &flipped);
-	}*/
+		const Double3 position = entity.getPosition();
+		const int textureID = entity.getTextureID();
+		const bool flipped = entity.getFlipped();
+		renderer.updateFlat(entity.getID(), &position, nullptr, nullptr,
+			&textureID, nullptr, &flipped);
+	}, runParallel);*/
 
 	// See if the player changed voxels in the XZ plane. If so, trigger text and
 	// sound events, and handle any level transition.
@@ -2291,6 +2919,10 @@ void GameWorldPanel::tick(double dt)
 			// of checking that they're in the voxel.
 			this->handleLevelTransition(oldPlayerVoxelXZ, newPlayerVoxelXZ);
 		}
+		else if (inVoxelGrid && (worldData.getActiveWorldType() == WorldType::City))
+		{
+			this->prefetchNearbyInteriors(newPlayerVoxelXZ);
+		}
 	}
 }
 
@@ -2309,18 +2941,23 @@ void GameWorldPanel::render(Renderer &renderer)
 	const auto &worldData = gameData.getWorldData();
 	const auto &level = worldData.getActiveLevel();
 	const auto &options = this->getGame().getOptions();
-	const double ambientPercent = [&gameData, &worldData]()
+	const double ambientPercent = [this, &gameData, &worldData]()
 	{
 		// Interiors are always completely dark, but for testing purposes, they
 		// will be 100% bright until lights are implemented.
 		// @todo: take into account "outdoorDungeon". Add it to LevelData?
-		if (worldData.getActiveWorldType() == WorldType::Interior)
+		const double ambient = (worldData.getActiveWorldType() == WorldType::Interior) ?
+			1.0 : gameData.getAmbientPercent();
+
+		// Fade out while a level is loading.
+		if (this->isLoadingLevel())
 		{
-			return 1.0;
+			const double fadePercent = std::min(this->loadingSeconds / LoadingFadeSeconds, 1.0);
+			return ambient * (1.0 - fadePercent);
 		}
 		else
 		{
-			return gameData.getAmbientPercent();
+			return ambient;
 		}
 	}();
 	
@@ -2330,17 +2967,64 @@ void GameWorldPanel::render(Renderer &renderer)
 		return location.getLatitude(gameData.getCityDataFile());
 	}();
 
-	renderer.renderWorld(player.getPosition(), player.getDirection(),
+	// Draw the view partway from the last tick to the current one when ticks run at a fixed
+	// rate. Not done if another panel ticked since (i.e., paused) or the player teleported.
+	const Double3 &playerPosition = player.getPosition();
+	const Double3 &playerDirection = player.getDirection();
+	const double tickPercent = (this->lastTickCount == this->getGame().getTickCount()) ?
+		this->getGame().getTickPercent() : 1.0;
+	const bool interpolateView = (tickPercent < 1.0) &&
+		((playerPosition - this->lastTickPlayerPosition).lengthSquared() < 1.0);
+	const Double3 eyePosition = interpolateView ?
+		this->lastTickPlayerPosition.lerp(playerPosition, tickPercent) : playerPosition;
+	const Double3 viewDirection = [this, &playerDirection, interpolateView, tickPercent]()
+	{
+		if (!interpolateView)
+		{
+			return playerDirection;
+		}
+
+		const Double3 direction = this->lastTickPlayerDirection.lerp(playerDirection, tickPercent);
+		return (direction.lengthSquared() > Constants::Epsilon) ?
+			direction.normalized() : playerDirection;
+	}();
+
+	// Also turn the view by mouse motion the next tick will apply, so mouse look is drawn
+	// as soon as it's sampled instead of a frame later. Only when this panel is ticking and
+	// the mouse would turn the camera (not swing the weapon).
+	const Double3 eyeDirection = [this, &player, &options, &viewDirection]()
+	{
+		Game &game = this->getGame();
+		const auto &inputManager = game.getInputManager();
+		const Int2 mouseDelta = inputManager.getMouseDelta();
+		const bool rightClick = inputManager.mouseButtonIsDown(SDL_BUTTON_RIGHT);
+		const bool turning = options.getGraphics_ModernInterface() &&
+			(this->lastTickCount == game.getTickCount()) &&
+			((mouseDelta.x != 0) || (mouseDelta.y != 0)) &&
+			(player.getWeaponAnimation().isSheathed() || !rightClick);
+
+		if (!turning)
+		{
+			return viewDirection;
+		}
+
+		const Double2 lookDelta = getMouseLookDelta(mouseDelta,
+			game.getRenderer().getWindowDimensions());
+		return Player::getRotatedDirection(viewDirection, lookDelta.x, lookDelta.y,
+			options.getInput_HorizontalSensitivity(), options.getInput_VerticalSensitivity(),
+			options.getInput_CameraPitchLimit());
+	}();
+
+	renderer.setVoxelDetailDistance(options.getGraphics_VoxelDetailDistance());
+	renderer.renderWorld(eyePosition, eyeDirection,
 		options.getGraphics_VerticalFOV(), ambientPercent, gameData.getDaytimePercent(), latitude,
 		options.getGraphics_ParallaxSky(), level.getCeilingHeight(), level.getOpenDoors(),
-		level.getVoxelGrid());
+		level.getVoxelGrid(), options.getGraphics_PipelinedFrames(),
+		options.getGraphics_InterlacedVoxels(), options.getGraphics_PaletteRendering());
 
 	auto &textureManager = this->getGame().getTextureManager();
 	textureManager.setPalette(PaletteFile::fromName(PaletteName::Default));
 
-	const auto &gameInterface = textureManager.getTexture(
-		TextureFile::fromName(TextureName::GameWorldInterface), renderer);
-
 	const auto &inputManager = this->getGame().getInputManager();
 	const Int2 mousePosition = inputManager.getMousePosition();
 	const bool modernInterface = options.getGraphics_ModernInterface();
@@ -2349,31 +3033,9 @@ void GameWorldPanel::render(Renderer &renderer)
 	// - @todo: clamp game world interface to screen edges, not letterbox edges.
 	if (!modernInterface)
 	{
-		// Draw game world interface.
-		renderer.drawOriginal(gameInterface, 0,
-			Renderer::ORIGINAL_HEIGHT - gameInterface.getHeight());
-
-		// Draw player portrait.
-		const auto &headsFilename = PortraitFile::getHeads(
-			player.getGenderName(), player.getRaceID(), true);
-		const auto &portrait = textureManager.getTextures(
-			headsFilename, renderer).at(player.getPortraitID());
-		const auto &status = textureManager.getTextures(
-			TextureFile::fromName(TextureName::StatusGradients), renderer).at(0);
-		renderer.drawOriginal(status, 14, 166);
-		renderer.drawOriginal(portrait, 14, 166);
-
-		// If the player's class can't use magic, show the darkened spell icon.
-		if (!player.getCharacterClass().canCastMagic())
-		{
-			const auto &nonMagicIcon = textureManager.getTexture(
-				TextureFile::fromName(TextureName::NoSpell), renderer);
-			renderer.drawOriginal(nonMagicIcon, 91, 177);
-		}
-
-		// Draw text: player name.
-		renderer.drawOriginal(this->playerNameTextBox->getTexture(),
-			this->playerNameTextBox->getX(), this->playerNameTextBox->getY());
+		// Draw game world interface, player portrait, and player name in one layer.
+		this->updateInterfaceLayer(player, textureManager, renderer);
+		this->interfaceLayer.draw(renderer);
 	}
 }
 
@@ -2386,8 +3048,7 @@ void GameWorldPanel::renderSecondary(Renderer &renderer)
 	auto &textureManager = this->getGame().getTextureManager();
 	textureManager.setPalette(PaletteFile::fromName(PaletteName::Default));
 
-	const auto &gameInterface = textureManager.getTexture(
-		TextureFile::fromName(TextureName::GameWorldInterface), renderer);
+	const auto &gameInterface = textureManager.getTexture(this->gameInterfaceTextureID);
 
 	auto &gameData = this->getGame().getGameData();
 	auto &player = gameData.getPlayer();
@@ -2437,7 +3098,7 @@ void GameWorldPanel::renderSecondary(Renderer &renderer)
 				static_cast<double>(std::min(weaponTexture.getHeight() + 1,
 					std::max(Renderer::ORIGINAL_HEIGHT - weaponY, 0))) * weaponScaleY));
 
-			renderer.drawOriginal(weaponTexture,
+			renderer.drawOriginalPrescaled(weaponTexture,
 				weaponX, weaponY, weaponWidth, weaponHeight);
 
 			// Reset letterbox mode back to what it was.
@@ -2453,7 +3114,7 @@ void GameWorldPanel::renderSecondary(Renderer &renderer)
 			// Add 1 to the height because Arena's renderer has an off-by-one bug, and a 1 pixel
 			// gap appears unless a small change is added.
 			const int weaponHeight = std::clamp(weaponTexture.getHeight() + 1, 0, maxWeaponHeight);
-			renderer.drawOriginal(weaponTexture,
+			renderer.drawOriginalPrescaled(weaponTexture,
 				weaponOffset.x, weaponOffset.y, weaponTexture.getWidth(), weaponHeight);
 		}
 	}
@@ -2,13 +2,21 @@
 #define GAME_WORLD_PANEL_H
 
 #include <array>
+#include <cstdint>
+#include <future>
+#include <string>
 #include <vector>
 
 #include "Button.h"
 #include "Panel.h"
+#include "RetainedLayer.h"
 #include "TextBox.h"
 #include "../Game/Physics.h"
 #include "../Math/Rect.h"
+#include "../Math/Vector3.h"
+#include "../Media/TextureManager.h"
+#include "../World/InteriorPrefetcher.h"
+#include "../World/InteriorWorldData.h"
 #include "../World/VoxelData.h"
 
 // When the GameWorldPanel is active, the game world is ticking.
@@ -17,9 +25,9 @@
 // - The original: compass, portrait, stat bars, and buttons with original mouse.
 // - A modern version: only compass and stat bars with free-look mouse.
 
+class LevelData;
 class Player;
 class Renderer;
-class TextureManager;
 
 class GameWorldPanel : public Panel
 {
@@ -34,6 +42,55 @@ private:
 	std::array<Rect, 9> nativeCursorRegions;
 	std::vector<Int2> weaponOffsets;
 
+	// Classic interface elements that rarely change, composed once and then only updated
+	// where something changed.
+	RetainedLayer interfaceLayer, compassLayer;
+	int interfacePortraitID; // Portrait in the interface layer, or -1 if not drawn yet.
+	bool interfaceShowsNoSpell; // Whether the darkened spell icon is in the interface layer.
+	int compassSliderOffset; // Slider offset in the compass layer, or -1 if not drawn yet.
+
+	// Interface images used every frame, so they aren't looked up by name each time.
+	TextureManager::TextureID gameInterfaceTextureID, swordCursorTextureID;
+	TextureManager::TextureSetID arrowCursorsTextureSetID;
+	TextureManager::SurfaceID gameInterfaceSurfaceID, noSpellSurfaceID,
+		compassSliderSurfaceID, compassFrameSurfaceID;
+	TextureManager::SurfaceSetID statusGradientsSurfaceSetID;
+
+	// The tooltip is only recreated when the hovered button changes.
+	Texture tooltipTexture;
+	std::string tooltipText;
+
+	// Interior being loaded on a worker thread after activating a *MENU voxel. The world is
+	// frozen and fades out until it's ready, then it's swapped in on the main thread.
+	std::future<InteriorWorldData> pendingInterior;
+	std::string pendingInteriorMifName;
+	Int2 pendingInteriorReturnVoxel;
+	double loadingSeconds;
+
+	// Interiors behind city doors near the player, loaded before they're entered.
+	InteriorPrefetcher interiorPrefetcher;
+
+	// .INF whose sounds were last preloaded, for noticing when the active level changes.
+	std::string preloadedSoundsInfName;
+
+	// Active level the textures of the levels next to it were last prefetched for. Only
+	// compared against, never read through.
+	const LevelData *texturePrefetchLevel;
+
+	// The player's view before the latest tick, for drawing frames between ticks, and
+	// the game's tick count at that tick.
+	Double3 lastTickPlayerPosition, lastTickPlayerDirection;
+	uint64_t lastTickCount;
+
+	// Returns whether a level is being loaded in the background.
+	bool isLoadingLevel() const;
+
+	// Activates the pending interior once its worker thread is done.
+	void finishEnteringInterior();
+
+	// Starts loading the interiors behind city doors near the given voxel.
+	void prefetchNearbyInteriors(const Int2 &playerVoxel);
+
 	// Modifies the values in the native cursor regions array so rectangles in
 	// the current window correctly represent regions for different arrow cursors.
 	void updateCursorRegions(int width, int height);
@@ -51,6 +108,11 @@ private:
 	// the previous frame.
 	void handlePlayerAttack(const Int2 &mouseDelta);
 
+	// Gets what's under a native screen point in the game world. Walls the last frame drew
+	// at the player's height are looked up from the renderer's voxel columns, and anything
+	// else is ray cast. Returns true if something was hit.
+	bool rayCastScreenPoint(const Int2 &nativePoint, Physics::Hit &hit) const;
+
 	// Handles the behavior of the player clicking in the game world. "primaryClick" is
 	// true for left clicks, false for right clicks.
 	void handleClickInWorld(const Int2 &nativePoint, bool primaryClick);
@@ -70,6 +132,11 @@ private:
 	// and changes the current level if it is.
 	void handleLevelTransition(const Int2 &playerVoxel, const Int2 &transitionVoxel);
 
+	// Composes the classic game world interface into its layer, redrawing only the parts
+	// whose contents have changed since the last frame.
+	void updateInterfaceLayer(const Player &player, TextureManager &textureManager,
+		Renderer &renderer);
+
 	// Draws a tooltip sitting on the top left of the game interface.
 	void drawTooltip(const std::string &text, Renderer &renderer);
 
@@ -91,6 +158,7 @@ public:
 
 	virtual std::pair<const Texture*, CursorAlignment> getCurrentCursor() const override;
 	virtual void handleEvent(const SDL_Event &e) override;
+	virtual bool isSuspendable() const override;
 	virtual void onPauseChanged(bool paused) override;
 	virtual void resize(int windowWidth, int windowHeight) override;
 	virtual void tick(double dt) override;
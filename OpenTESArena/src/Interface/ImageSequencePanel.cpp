@@ -13,6 +13,8 @@
 #include "../Rendering/Texture.h"
 #include "../Utilities/Debug.h"
 
+const int ImageSequencePanel::PREFETCH_COUNT = 2;
+
 ImageSequencePanel::ImageSequencePanel(Game &game,
 	const std::vector<std::string> &paletteNames,
 	const std::vector<std::string> &textureNames,
@@ -31,6 +33,28 @@ ImageSequencePanel::ImageSequencePanel(Game &game,
 
 	this->currentSeconds = 0.0;
 	this->imageIndex = 0;
+	this->prefetchedEnd = 0;
+
+	// The first image is requested too, since the panel is usually made a frame before
+	// it's drawn.
+	this->prefetchImages();
+}
+
+void ImageSequencePanel::prefetchImages()
+{
+	auto &textureManager = this->getGame().getTextureManager();
+	const int imageCount = static_cast<int>(this->textureNames.size());
+	const int end = std::min(this->imageIndex + 1 + ImageSequencePanel::PREFETCH_COUNT,
+		imageCount);
+
+	// Images already shown are left to the texture manager, which evicts them once the
+	// cache is over its memory budget.
+	for (int i = std::max(this->prefetchedEnd, this->imageIndex); i < end; i++)
+	{
+		textureManager.requestTextureAsync(this->textureNames.at(i), this->paletteNames.at(i));
+	}
+
+	this->prefetchedEnd = std::max(this->prefetchedEnd, end);
 }
 
 void ImageSequencePanel::handleEvent(const SDL_Event &e)
@@ -86,6 +110,8 @@ void ImageSequencePanel::tick(double dt)
 
 	// Clamp against the max so the index doesn't go outside the image vector.
 	this->imageIndex = std::min(this->imageIndex, imageCount - 1);
+
+	this->prefetchImages();
 }
 
 void ImageSequencePanel::render(Renderer &renderer)
@@ -16,12 +16,20 @@
 class ImageSequencePanel : public Panel
 {
 private:
+	// Number of images after the current one that are decoded ahead of time.
+	static const int PREFETCH_COUNT;
+
 	Button<Game&> skipButton;
 	std::vector<std::string> paletteNames;
 	std::vector<std::string> textureNames;
 	std::vector<double> imageDurations;
 	double currentSeconds;
 	int imageIndex;
+	int prefetchedEnd; // One past the last image requested ahead of time.
+
+	// Requests the images after the current one so they're decoded on a worker thread by
+	// the time they're shown.
+	void prefetchImages();
 public:
 	ImageSequencePanel(Game &game,
 		const std::vector<std::string> &paletteNames,
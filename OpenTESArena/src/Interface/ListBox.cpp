@@ -15,12 +15,16 @@
 #include "../Utilities/Debug.h"
 #include "../Utilities/String.h"
 
+const int ListBox::CACHE_MARGIN = 4;
+
 ListBox::ListBox(int x, int y, const Color &textColor, const std::vector<std::string> &elements,
 	FontName fontName, int maxDisplayed, FontManager &fontManager, Renderer &renderer)
-	: textColor(textColor), point(x, y), fontName(fontName)
+	: textColor(textColor), point(x, y), fontName(fontName), fontManager(fontManager),
+	renderer(renderer)
 {
 	DebugAssert(maxDisplayed > 0);
 
+	this->textBoxesIndex = 0;
 	this->scrollIndex = 0;
 
 	// Get the font data associated with the font name.
@@ -28,45 +32,25 @@ ListBox::ListBox(int x, int y, const Color &textColor, const std::vector<std::st
 
 	this->characterHeight = font.getCharacterHeight();
 
-	// Make text boxes for getting list box dimensions now and drawing later.
-	// It's okay for there to be zero elements. Just be blank, then!
+	// Keep the elements for making text boxes later, and measure them for the list box
+	// dimensions. It's okay for there to be zero elements. Just be blank, then!
+	int width = 0;
+	this->elements.reserve(elements.size());
 	for (const auto &element : elements)
 	{
 		// Remove any new lines.
-		std::string trimmedElement = String::trimLines(element);
-
-		const int textBoxX = 0;
-		const int textBoxY = 0;
+		this->elements.push_back(String::trimLines(element));
 
 		const RichTextString richText(
-			trimmedElement,
+			this->elements.back(),
 			font.getFontName(),
 			textColor,
 			TextAlignment::Left,
 			fontManager);
 
-		// Store the text box for later.
-		auto textBox = std::make_unique<TextBox>(textBoxX, textBoxY, richText, renderer);
-		this->textBoxes.push_back(std::move(textBox));
+		width = std::max(width, richText.getDimensions().x);
 	}
 
-	// Calculate the dimensions of the displayed list box area.
-	const int width = [this]()
-	{
-		int maxWidth = 0;
-		for (const auto &textBox : this->textBoxes)
-		{
-			const int textBoxWidth = textBox->getTexture().getWidth();
-
-			if (textBoxWidth > maxWidth)
-			{
-				maxWidth = textBoxWidth;
-			}
-		}
-
-		return maxWidth;
-	}();
-
 	const int height = font.getCharacterHeight() * maxDisplayed;
 
 	// Create the clear surface. This exists because the text box surfaces can't
@@ -93,7 +77,7 @@ int ListBox::getScrollIndex() const
 
 int ListBox::getElementCount() const
 {
-	return static_cast<int>(this->textBoxes.size());
+	return static_cast<int>(this->elements.size());
 }
 
 int ListBox::getMaxDisplayedCount() const
@@ -133,21 +117,88 @@ int ListBox::getClickedIndex(const Int2 &point) const
 	return index;
 }
 
+void ListBox::updateTextBoxes()
+{
+	const int totalElements = this->getElementCount();
+	const int maxDisplayed = this->getMaxDisplayedCount();
+	const int newIndex = std::clamp(this->scrollIndex - ListBox::CACHE_MARGIN, 0, totalElements);
+	const int newEnd = std::clamp(this->scrollIndex + maxDisplayed + ListBox::CACHE_MARGIN,
+		newIndex, totalElements);
+	const int oldIndex = this->textBoxesIndex;
+	const int oldEnd = oldIndex + static_cast<int>(this->textBoxes.size());
+
+	if ((newIndex == oldIndex) && (newEnd == oldEnd))
+	{
+		return;
+	}
+
+	// Keep the text boxes that are still in range and take the textures of the others.
+	std::vector<std::unique_ptr<TextBox>> textBoxes(newEnd - newIndex);
+	std::vector<Texture> freeTextures;
+	for (int i = oldIndex; i < oldEnd; i++)
+	{
+		std::unique_ptr<TextBox> &textBox = this->textBoxes[i - oldIndex];
+		if ((i >= newIndex) && (i < newEnd))
+		{
+			textBoxes[i - newIndex] = std::move(textBox);
+		}
+		else
+		{
+			freeTextures.push_back(textBox->releaseTexture());
+		}
+	}
+
+	const Font &font = this->fontManager.getFont(this->fontName);
+	for (int i = newIndex; i < newEnd; i++)
+	{
+		std::unique_ptr<TextBox> &textBox = textBoxes[i - newIndex];
+		if (textBox == nullptr)
+		{
+			const RichTextString richText(
+				this->elements[i],
+				font.getFontName(),
+				this->textColor,
+				TextAlignment::Left,
+				this->fontManager);
+
+			// The text box only draws into a recycled texture if they're the same size.
+			Texture texture;
+			if (!freeTextures.empty())
+			{
+				texture = std::move(freeTextures.back());
+				freeTextures.pop_back();
+			}
+
+			const int textBoxX = 0;
+			const int textBoxY = 0;
+			textBox = std::make_unique<TextBox>(textBoxX, textBoxY, richText, nullptr,
+				std::move(texture), this->renderer);
+		}
+	}
+
+	this->textBoxes = std::move(textBoxes);
+	this->textBoxesIndex = newIndex;
+}
+
 void ListBox::updateDisplay()
 {
 	// Clear the display texture. Otherwise, remnants of previous text might be left over.
 	SDL_UpdateTexture(this->texture.get(), nullptr,
 		this->clearSurface.get()->pixels, this->clearSurface.get()->pitch);
 
-	// Prepare the range of text boxes that will be displayed.
-	const int totalElements = static_cast<int>(this->textBoxes.size());
+	this->updateTextBoxes();
+
+	// Prepare the range of text boxes that will be displayed. The scroll index can be
+	// out of range, so only the cached text boxes are drawn.
 	const int maxDisplayed = this->getMaxDisplayedCount();
-	const int indexEnd = std::min(this->scrollIndex + maxDisplayed, totalElements);
+	const int indexBegin = std::max(this->scrollIndex, this->textBoxesIndex);
+	const int indexEnd = std::min(this->scrollIndex + maxDisplayed,
+		this->textBoxesIndex + static_cast<int>(this->textBoxes.size()));
 
 	// Draw the relevant text boxes according to scroll index.
-	for (int i = this->scrollIndex; i < indexEnd; i++)
+	for (int i = indexBegin; i < indexEnd; i++)
 	{
-		const Surface &surface = this->textBoxes.at(i)->getSurface();
+		const Surface &surface = this->textBoxes.at(i - this->textBoxesIndex)->getSurface();
 
 		SDL_Rect rect;
 		rect.x = 0;
@@ -17,6 +17,9 @@
 // Though the index of a selected item can be obtained, this class is not intended
 // for holding data about those selected items. It is simply a view for the text.
 
+// Text boxes are only made for the visible elements plus a few on either side, and
+// their textures are reused as the list scrolls, so long lists open as fast as short ones.
+
 class FontManager;
 class Renderer;
 class TextBox;
@@ -26,15 +29,26 @@ enum class FontName;
 class ListBox
 {
 private:
-	std::vector<std::unique_ptr<TextBox>> textBoxes;
+	// Number of text boxes kept above and below the visible ones.
+	static const int CACHE_MARGIN;
+
+	std::vector<std::string> elements; // Without new lines.
+	std::vector<std::unique_ptr<TextBox>> textBoxes; // Elements starting at textBoxesIndex.
 	Color textColor;
 	Int2 point;
 	FontName fontName;
 	Surface clearSurface; // For clearing the texture upon updating.
 	Texture texture;
+	FontManager &fontManager;
+	Renderer &renderer;
+	int textBoxesIndex;
 	int scrollIndex;
 	int characterHeight;
 
+	// Makes the text boxes around the scroll index, reusing ones that are still in range
+	// and the textures of ones that aren't.
+	void updateTextBoxes();
+
 	// Updates the texture to show the currently visible text boxes.
 	void updateDisplay();
 public:
@@ -44,7 +58,7 @@ public:
 	// Gets the index of the top-most displayed element.
 	int getScrollIndex() const;
 
-	// Gets the total number of text boxes (elements) in the list box.
+	// Gets the total number of elements in the list box.
 	int getElementCount() const;
 
 	// Gets the max number of displayed text boxes.
@@ -1,3 +1,7 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "SDL.h"
 
 #include "CursorAlignment.h"
@@ -27,6 +31,26 @@
 #include "../Utilities/Platform.h"
 #include "../Utilities/String.h"
 
+namespace
+{
+	// Slot names from the last NAMES.DAT that was read. The panel only reads the file again
+	// once it's been modified, since the saves folder might be slow to read from (i.e., on
+	// a network drive).
+	struct SlotNameCache
+	{
+		std::string filename;
+		int64_t modifiedTime;
+		std::vector<std::string> names;
+
+		SlotNameCache()
+		{
+			this->modifiedTime = 0;
+		}
+	};
+
+	SlotNameCache slotNameCache;
+}
+
 const int LoadSavePanel::SlotCount = 10;
 
 LoadSavePanel::LoadSavePanel(Game &game, LoadSavePanel::Type type)
@@ -42,16 +66,29 @@ LoadSavePanel::LoadSavePanel(Game &game, LoadSavePanel::Type type)
 		return String::addTrailingSlashIfMissing(path);
 	}();
 
-	if (File::exists(savesPath + "NAMES.DAT"))
+	const std::string namesFilename = savesPath + "NAMES.DAT";
+	const int64_t namesModifiedTime = File::getModifiedTime(namesFilename);
+	if (namesModifiedTime != 0)
 	{
-		const auto names = ArenaSave::loadNAMES(savesPath);
-		for (int i = 0; i < LoadSavePanel::SlotCount; i++)
+		if ((slotNameCache.filename != namesFilename) ||
+			(slotNameCache.modifiedTime != namesModifiedTime))
 		{
-			const auto &entry = names->entries.at(i);
+			const auto names = ArenaSave::loadNAMES(savesPath);
+			slotNameCache.names.clear();
+			for (int i = 0; i < LoadSavePanel::SlotCount; i++)
+			{
+				slotNameCache.names.push_back(std::string(names->entries.at(i).name.data()));
+			}
 
+			slotNameCache.filename = namesFilename;
+			slotNameCache.modifiedTime = namesModifiedTime;
+		}
+
+		for (int i = 0; i < LoadSavePanel::SlotCount; i++)
+		{
 			const Int2 center(Renderer::ORIGINAL_WIDTH / 2, 8 + (i * 14));
 			const RichTextString richText(
-				std::string(entry.name.data()),
+				slotNameCache.names.at(i),
 				FontName::Arena,
 				Color::White,
 				TextAlignment::Center,
@@ -157,6 +194,11 @@ std::pair<const Texture*, CursorAlignment> LoadSavePanel::getCurrentCursor() con
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool LoadSavePanel::isStatic() const
+{
+	return true;
+}
+
 void LoadSavePanel::handleEvent(const SDL_Event &e)
 {
 	auto &game = this->getGame();
@@ -32,7 +32,7 @@ LogbookPanel::LogbookPanel(Game &game)
 			Renderer::ORIGINAL_HEIGHT / 2);
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.logbook.isEmpty;
+		const std::string &text = exeData.getLogbook().isEmpty;
 
 		const RichTextString richText(
 			text,
@@ -52,7 +52,7 @@ LogbookPanel::LogbookPanel(Game &game)
 
 		auto function = [](Game &game)
 		{
-			game.setPanel<GameWorldPanel>(game);
+			game.resumePanel<GameWorldPanel>(game);
 		};
 		return Button<Game&>(center, 34, 14, function);
 	}();
@@ -69,6 +69,11 @@ std::pair<const Texture*, CursorAlignment> LogbookPanel::getCurrentCursor() cons
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool LogbookPanel::isStatic() const
+{
+	return true;
+}
+
 void LogbookPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -75,7 +75,7 @@ namespace
 		else
 		{
 			// Generate the location from the executable data.
-			const auto &staffProvinces = exeData.locations.staffProvinces;
+			const auto &staffProvinces = exeData.getLocations().staffProvinces;
 			const int localDungeonID = testIndex % 2;
 			const int provinceID = staffProvinces.at((testIndex - 1) / 2);
 			return Location::makeDungeon(localDungeonID, provinceID);
@@ -654,6 +654,12 @@ MainMenuPanel::MainMenuPanel(Game &game)
 	this->testIndex2 = 1;
 	this->testWeather = 0;
 
+	// Start decoding the character creation background so choosing a new game
+	// doesn't wait on it.
+	game.getTextureManager().requestTextureAsync(
+		TextureFile::fromName(TextureName::CharacterCreation),
+		PaletteFile::fromName(PaletteName::BuiltIn));
+
 	// The game data should not be active on the main menu.
 	DebugAssert(!game.gameDataIsActive());
 }
@@ -670,12 +676,12 @@ std::string MainMenuPanel::getSelectedTestName() const
 		if (this->testIndex == 0)
 		{
 			// Start dungeon.
-			return String::toUppercase(exeData.locations.startDungeonMifName);
+			return String::toUppercase(exeData.getLocations().startDungeonMifName);
 		}
 		else if (this->testIndex == (MainQuestLocationCount - 1))
 		{
 			// Final dungeon.
-			return String::toUppercase(exeData.locations.finalDungeonMifName);
+			return String::toUppercase(exeData.getLocations().finalDungeonMifName);
 		}
 		else
 		{
@@ -744,6 +750,11 @@ std::pair<const Texture*, CursorAlignment> MainMenuPanel::getCurrentCursor() con
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool MainMenuPanel::isStatic() const
+{
+	return true;
+}
+
 void MainMenuPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -33,7 +33,7 @@ MainQuestSplashPanel::MainQuestSplashPanel(Game &game, int provinceID)
 			const std::pair<std::string, std::string> &pair = [provinceID, &miscAssets]()
 			{
 				const auto &exeData = miscAssets.getExeData();
-				const int index = exeData.travel.staffDungeonSplashIndices.at(provinceID);
+				const int index = exeData.getTravel().staffDungeonSplashIndices.at(provinceID);
 				return miscAssets.getDungeonTxtDungeons().at(index);
 			}();
 
@@ -76,8 +76,8 @@ MainQuestSplashPanel::MainQuestSplashPanel(Game &game, int provinceID)
 	this->splashFilename = [&game, provinceID]()
 	{
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const int index = exeData.travel.staffDungeonSplashIndices.at(provinceID);
-		return String::toUppercase(exeData.travel.staffDungeonSplashes.at(index));
+		const int index = exeData.getTravel().staffDungeonSplashIndices.at(provinceID);
+		return String::toUppercase(exeData.getTravel().staffDungeonSplashes.at(index));
 	}();
 }
 
@@ -92,6 +92,11 @@ std::pair<const Texture*, CursorAlignment> MainQuestSplashPanel::getCurrentCurso
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool MainQuestSplashPanel::isStatic() const
+{
+	return true;
+}
+
 void MainQuestSplashPanel::handleEvent(const SDL_Event &e)
 {
 	// When the exit button is clicked, go to the game world panel.
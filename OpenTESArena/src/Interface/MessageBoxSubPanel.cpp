@@ -32,6 +32,16 @@ std::pair<const Texture*, CursorAlignment> MessageBoxSubPanel::getCurrentCursor(
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool MessageBoxSubPanel::isStatic() const
+{
+	return true;
+}
+
+bool MessageBoxSubPanel::usesFrozenBackground() const
+{
+	return true;
+}
+
 void MessageBoxSubPanel::handleEvent(const SDL_Event &e)
 {
 	auto &game = this->getGame();
@@ -219,11 +219,15 @@ const std::string OptionsPanel::DEV_TAB_NAME = "Dev";
 
 // Graphics.
 const std::string OptionsPanel::CURSOR_SCALE_NAME = "Cursor Scale";
+const std::string OptionsPanel::DYNAMIC_RESOLUTION_NAME = "Dynamic Resolution";
 const std::string OptionsPanel::FPS_LIMIT_NAME = "FPS Limit";
 const std::string OptionsPanel::FULLSCREEN_NAME = "Fullscreen";
+const std::string OptionsPanel::INTERLACED_VOXELS_NAME = "Interlaced Voxels";
 const std::string OptionsPanel::LETTERBOX_MODE_NAME = "Letterbox Mode";
 const std::string OptionsPanel::MODERN_INTERFACE_NAME = "Modern Interface";
+const std::string OptionsPanel::PALETTE_RENDERING_NAME = "Palette Rendering";
 const std::string OptionsPanel::PARALLAX_SKY_NAME = "Parallax Sky";
+const std::string OptionsPanel::PIPELINED_FRAMES_NAME = "Pipelined Frames";
 const std::string OptionsPanel::RENDER_THREADS_MODE_NAME = "Render Threads Mode";
 const std::string OptionsPanel::RESOLUTION_SCALE_NAME = "Resolution Scale";
 const std::string OptionsPanel::VERTICAL_FOV_NAME = "Vertical FOV";
@@ -484,7 +488,7 @@ OptionsPanel::OptionsPanel(Game &game)
 
 	auto renderThreadsModeOption = std::make_unique<IntOption>(
 		OptionsPanel::RENDER_THREADS_MODE_NAME,
-		"Determines the number of CPU threads to use for rendering.\nThis has a significant impact on performance.\nVery Low: one, Low: 1/4, Medium: 1/2, High: 3/4,\nVery High: all but one, Max: all",
+		"Determines the number of CPU threads to use for rendering.\nThis has a significant impact on performance.\nVery Low: one, Low: 1/4, Medium: 1/2, High: 3/4,\nVery High: all but one, Max: all,\nAuto: the fastest of those, measured in-game",
 		options.getGraphics_RenderThreadsMode(),
 		1,
 		Options::MIN_RENDER_THREADS_MODE,
@@ -498,9 +502,60 @@ OptionsPanel::OptionsPanel(Game &game)
 		renderer.setRenderThreadsMode(value);
 	});
 
-	renderThreadsModeOption->setDisplayOverrides({ "Very Low", "Low", "Medium", "High", "Very High", "Max" });
+	renderThreadsModeOption->setDisplayOverrides({ "Very Low", "Low", "Medium", "High", "Very High", "Max", "Auto" });
 	this->graphicsOptions.push_back(std::move(renderThreadsModeOption));
 
+	this->graphicsOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::PIPELINED_FRAMES_NAME,
+		"Uploads the previous frame to the screen while the next one is\nbeing rendered. This can improve performance but adds one\nframe of latency.",
+		options.getGraphics_PipelinedFrames(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		options.setGraphics_PipelinedFrames(value);
+	}));
+
+	this->graphicsOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::DYNAMIC_RESOLUTION_NAME,
+		"Lowers the resolution scale when frames take longer than the\nFPS limit allows, and raises it again up to the resolution\nscale option when there is headroom.",
+		options.getGraphics_DynamicResolution(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		options.setGraphics_DynamicResolution(value);
+
+		// Go back to the chosen resolution scale.
+		auto &renderer = game.getRenderer();
+		const Int2 windowDimensions = renderer.getWindowDimensions();
+		const bool fullGameWindow = options.getGraphics_ModernInterface();
+		renderer.resize(windowDimensions.x, windowDimensions.y,
+			options.getGraphics_ResolutionScale(), fullGameWindow);
+	}));
+
+	this->graphicsOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::INTERLACED_VOXELS_NAME,
+		"Only ray casts every other column of voxels each frame, reusing\nthe previous frame for the rest. This improves performance but\ncan look smeared while moving.",
+		options.getGraphics_InterlacedVoxels(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		options.setGraphics_InterlacedVoxels(value);
+	}));
+
+	this->graphicsOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::PALETTE_RENDERING_NAME,
+		"Shades walls and sprites through palette light tables like the\noriginal game, which gives banded lighting and fog. Colored\nlights are shown by brightness only.",
+		options.getGraphics_PaletteRendering(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		options.setGraphics_PaletteRendering(value);
+	}));
+
 	// Create audio options.
 	this->audioOptions.push_back(std::make_unique<IntOption>(
 		OptionsPanel::SOUND_CHANNELS_NAME,
@@ -770,6 +825,11 @@ std::pair<const Texture*, CursorAlignment> OptionsPanel::getCurrentCursor() cons
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool OptionsPanel::isStatic() const
+{
+	return true;
+}
+
 void OptionsPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
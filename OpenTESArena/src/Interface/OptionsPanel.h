@@ -136,11 +136,15 @@ private:
 
 	// Graphics.
 	static const std::string CURSOR_SCALE_NAME;
+	static const std::string DYNAMIC_RESOLUTION_NAME;
 	static const std::string FPS_LIMIT_NAME;
 	static const std::string FULLSCREEN_NAME;
+	static const std::string INTERLACED_VOXELS_NAME;
 	static const std::string LETTERBOX_MODE_NAME;
 	static const std::string MODERN_INTERFACE_NAME;
+	static const std::string PALETTE_RENDERING_NAME;
 	static const std::string PARALLAX_SKY_NAME;
+	static const std::string PIPELINED_FRAMES_NAME;
 	static const std::string RENDER_THREADS_MODE_NAME;
 	static const std::string RESOLUTION_SCALE_NAME;
 	static const std::string VERTICAL_FOV_NAME;
@@ -191,6 +195,7 @@ public:
 
 	virtual std::pair<const Texture*, CursorAlignment> getCurrentCursor() const override;
 	virtual void handleEvent(const SDL_Event &e) override;
+	virtual bool isStatic() const override;
 	virtual void render(Renderer &renderer) override;
 };
 
@@ -29,7 +29,10 @@
 #include "components/vfs/manager.hpp"
 
 Panel::Panel(Game &game)
-	: game(game) { }
+	: game(game)
+{
+	this->dirty = true;
+}
 
 Texture Panel::createTooltip(const std::string &text,
 	FontName fontName, FontManager &fontManager, Renderer &renderer)
@@ -60,14 +63,8 @@ Texture Panel::createTooltip(const std::string &text,
 
 	// Offset the text from the top left corner by a bit so it isn't against the side 
 	// of the tooltip (for aesthetic purposes).
-	SDL_Rect rect;
-	rect.x = padding / 2;
-	rect.y = padding / 2;
-	rect.w = textSurface.getWidth();
-	rect.h = textSurface.getHeight();
-
 	// Draw the text onto the background.
-	SDL_BlitSurface(textSurface.get(), nullptr, background.get(), &rect);
+	textSurface.blit(background, padding / 2, padding / 2);
 
 	// Create a hardware texture for the tooltip.
 	Texture tooltip = renderer.createTextureFromSurface(background);
@@ -187,6 +184,36 @@ void Panel::handleEvent(const SDL_Event &e)
 	static_cast<void>(e);
 }
 
+bool Panel::isStatic() const
+{
+	return false;
+}
+
+bool Panel::usesFrozenBackground() const
+{
+	return false;
+}
+
+bool Panel::isSuspendable() const
+{
+	return false;
+}
+
+void Panel::invalidate()
+{
+	this->dirty = true;
+}
+
+bool Panel::needsRender() const
+{
+	return !this->isStatic() || this->dirty;
+}
+
+void Panel::clearInvalidated()
+{
+	this->dirty = false;
+}
+
 void Panel::onPauseChanged(bool paused)
 {
 	// Do nothing by default.
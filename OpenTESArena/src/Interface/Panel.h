@@ -31,6 +31,7 @@ class Panel
 {
 private:
 	Game &game;
+	bool dirty; // Whether a static panel has changed since it was last drawn.
 protected:
 	// Generates a tooltip texture with the default white foreground and gray
 	// background with alpha blending.
@@ -53,6 +54,32 @@ public:
 	// are handled by the game loop.
 	virtual void handleEvent(const SDL_Event &e);
 
+	// Returns whether the panel only changes on screen because of events or calls to
+	// invalidate(), so the game can skip drawing frames where nothing changed. Panels that
+	// animate or depend on held keys should leave this false.
+	virtual bool isStatic() const;
+
+	// Returns whether the panels below this one can be drawn once when it opens and shown
+	// as they were until it closes. Modal sub-panels over a paused panel (i.e., a message
+	// box over the game world) use this so the world isn't drawn again every frame.
+	virtual bool usesFrozenBackground() const;
+
+	// Returns whether the game keeps the panel when another panel replaces it, so menus
+	// opened from it can return to it without building it again (see Game::resumePanel()).
+	// A kept panel is paused while it waits.
+	virtual bool isSuspendable() const;
+
+	// Marks the panel as changed so it's drawn next frame. The game does this for every
+	// event, and panels can do it for anything else that changes them.
+	void invalidate();
+
+	// Returns whether the panel has to be drawn this frame. Always true for panels that
+	// aren't static.
+	bool needsRender() const;
+
+	// Called by the game after the panel is drawn.
+	void clearInvalidated();
+
 	// Called when a sub-panel above this panel is pushed (added) or popped (removed).
 	virtual void onPauseChanged(bool paused);
 
@@ -159,7 +159,7 @@ PauseMenuPanel::PauseMenuPanel(Game &game)
 		const int y = 118;
 		auto function = [](Game &game)
 		{
-			game.setPanel<GameWorldPanel>(game);
+			game.resumePanel<GameWorldPanel>(game);
 		};
 		return Button<Game&>(x, y, 64, 29, function);
 	}();
@@ -311,6 +311,11 @@ std::pair<const Texture*, CursorAlignment> PauseMenuPanel::getCurrentCursor() co
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool PauseMenuPanel::isStatic() const
+{
+	return true;
+}
+
 void PauseMenuPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -114,7 +114,7 @@ ProvinceMapPanel::ProvinceMapPanel(Game &game, int provinceID,
 				const auto &exeData = game.getMiscAssets().getExeData();
 				const std::string errorText = [&exeData]()
 				{
-					std::string text = exeData.travel.noDestination;
+					std::string text = exeData.getTravel().noDestination;
 
 					// Remove carriage return at end.
 					text.pop_back();
@@ -150,6 +150,10 @@ ProvinceMapPanel::ProvinceMapPanel(Game &game, int provinceID,
 	this->provinceID = provinceID;
 	this->blinkTimer = 0.0;
 
+	// Bucket the visible locations for finding the one closest to the mouse.
+	const auto &cityData = game.getGameData().getCityDataFile();
+	this->locationGrid.init(cityData.getProvinceData(provinceID));
+
 	// Get the palette for the background image.
 	const std::string backgroundFilename = this->getBackgroundFilename();
 	if (!IMGFile::extractPalette(backgroundFilename.c_str(), this->provinceMapPalette))
@@ -250,7 +254,7 @@ void ProvinceMapPanel::trySelectLocation(int selectedLocationID)
 		{
 			const auto &cityData = gameData.getCityDataFile();
 			const auto &exeData = game.getMiscAssets().getExeData();
-			std::string text = exeData.travel.alreadyAtDestination;
+			std::string text = exeData.getTravel().alreadyAtDestination;
 
 			// Remove carriage return at end.
 			text.pop_back();
@@ -328,7 +332,7 @@ void ProvinceMapPanel::handleEvent(const SDL_Event &e)
 std::string ProvinceMapPanel::getBackgroundFilename() const
 {
 	const auto &exeData = this->getGame().getMiscAssets().getExeData();
-	const auto &provinceImgFilenames = exeData.locations.provinceImgFilenames;
+	const auto &provinceImgFilenames = exeData.getLocations().provinceImgFilenames;
 	const std::string &filename = provinceImgFilenames.at(this->provinceID);
 
 	// Set all characters to uppercase because the texture manager expects 
@@ -338,41 +342,9 @@ std::string ProvinceMapPanel::getBackgroundFilename() const
 
 int ProvinceMapPanel::getClosestLocationID(const Int2 &originalPosition) const
 {
-	// Initialize the current closest position to something very far away (watch out for
-	// integer multiplication overflow with closest distance).
-	Int2 closestPosition(-1000, -1000);
-
-	// Lambda for comparing distances of two location points to the mouse position.
-	auto closerThanCurrentClosest = [&originalPosition, &closestPosition](const Int2 &point)
-	{
-		const Int2 diff = point - originalPosition;
-		const Int2 closestDiff = closestPosition - originalPosition;
-		const double distance = std::sqrt((diff.x * diff.x) + (diff.y * diff.y));
-		const double closestDistance = std::sqrt(
-			(closestDiff.x * closestDiff.x) + (closestDiff.y * closestDiff.y));
-		return distance < closestDistance;
-	};
-
-	// Look through all visible locations to find the one closest to the mouse.
-	int closestID = -1;
-	const auto &cityData = this->getGame().getGameData().getCityDataFile();
-	const auto &provinceData = cityData.getProvinceData(this->provinceID);
-	for (int i = 0; i < 48; i++)
-	{
-		const auto &locationData = provinceData.getLocationData(i);
-
-		if (locationData.isVisible())
-		{
-			const Int2 point(locationData.x, locationData.y);
-
-			if (closerThanCurrentClosest(point))
-			{
-				closestPosition = point;
-				closestID = i;
-			}
-		}
-	}
-
+	// Only the grid cells near the mouse are checked. This runs every frame for the
+	// hovered location's name.
+	const int closestID = this->locationGrid.getClosestLocationID(originalPosition);
 	DebugAssertMsg(closestID >= 0, "No closest location ID found.");
 	return closestID;
 }
@@ -413,7 +385,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 				if (closestLocationID < 32)
 				{
 					// City format.
-					std::string text = exeData.travel.locationFormatTexts.at(2);
+					std::string text = exeData.getTravel().locationFormatTexts.at(2);
 
 					// Replace first %s with location type.
 					const std::string &locationTypeName = [&exeData, closestLocationID]()
@@ -421,17 +393,17 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 						if (closestLocationID < 8)
 						{
 							// City.
-							return exeData.locations.locationTypes.front();
+							return exeData.getLocations().locationTypes.front();
 						}
 						else if (closestLocationID < 16)
 						{
 							// Town.
-							return exeData.locations.locationTypes.at(1);
+							return exeData.getLocations().locationTypes.at(1);
 						}
 						else
 						{
 							// Village.
-							return exeData.locations.locationTypes.at(2);
+							return exeData.getLocations().locationTypes.at(2);
 						}
 					}();
 
@@ -451,7 +423,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 				else
 				{
 					// Dungeon format.
-					std::string text = exeData.travel.locationFormatTexts.at(0);
+					std::string text = exeData.getTravel().locationFormatTexts.at(0);
 
 					// Replace first %s with dungeon name.
 					size_t index = text.find("%s");
@@ -467,7 +439,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 			else
 			{
 				// Center province format (always the center city).
-				std::string text = exeData.travel.locationFormatTexts.at(1);
+				std::string text = exeData.getTravel().locationFormatTexts.at(1);
 
 				// Replace first %s with center province city name.
 				size_t index = text.find("%s");
@@ -489,7 +461,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 	// Lambda for getting the date string for a given date.
 	auto getDateString = [&exeData](const Date &date)
 	{
-		std::string text = exeData.status.date;
+		std::string text = exeData.getStatus().date;
 
 		// Replace carriage returns with newlines.
 		text = String::replace(text, '\r', '\n');
@@ -499,7 +471,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 
 		// Replace first %s with weekday.
 		const std::string &weekdayString =
-			exeData.calendar.weekdayNames.at(date.getWeekday());
+			exeData.getCalendar().weekdayNames.at(date.getWeekday());
 		size_t index = text.find("%s");
 		text.replace(index, 2, weekdayString);
 
@@ -510,7 +482,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 
 		// Replace third %s with month.
 		const std::string &monthString =
-			exeData.calendar.monthNames.at(date.getMonth());
+			exeData.getCalendar().monthNames.at(date.getMonth());
 		index = text.find("%s");
 		text.replace(index, 2, monthString);
 
@@ -524,7 +496,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 	const std::string startDateString = [&exeData, &getDateString, &currentDate]()
 	{
 		// The date prefix is shared between the province map pop-up and the arrival pop-up.
-		const std::string datePrefix = exeData.travel.arrivalPopUpDate;
+		const std::string datePrefix = exeData.getTravel().arrivalPopUpDate;
 
 		// Replace carriage returns with newlines.
 		return String::replace(datePrefix + getDateString(currentDate), '\r', '\n');
@@ -532,10 +504,10 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 
 	const std::string dayString = [&exeData, &travelData]()
 	{
-		const std::string &dayStringPrefix = exeData.travel.dayPrediction.front();
+		const std::string &dayStringPrefix = exeData.getTravel().dayPrediction.front();
 		const std::string dayStringBody = [&exeData, &travelData]()
 		{
-			std::string text = exeData.travel.dayPrediction.back();
+			std::string text = exeData.getTravel().dayPrediction.back();
 
 			// Replace %d with travel days.
 			const size_t index = text.find("%d");
@@ -570,7 +542,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 
 	const std::string distanceString = [&exeData, travelDistance]()
 	{
-		std::string text = exeData.travel.distancePrediction;
+		std::string text = exeData.getTravel().distancePrediction;
 
 		// Replace %d with travel distance.
 		const size_t index = text.find("%d");
@@ -582,7 +554,7 @@ std::string ProvinceMapPanel::makeTravelText(int currentLocationID,
 
 	const std::string arrivalDateString = [&exeData, &getDateString, &destinationDate]()
 	{
-		const std::string text = exeData.travel.arrivalDatePrediction;
+		const std::string text = exeData.getTravel().arrivalDatePrediction;
 
 		// Replace carriage returns with newlines.
 		return String::replace(text + getDateString(destinationDate), '\r', '\n');
@@ -652,28 +624,39 @@ void ProvinceMapPanel::drawCenteredIcon(const Texture &texture,
 		point.y - (texture.getHeight() / 2));
 }
 
+void ProvinceMapPanel::drawCenteredIcon(const TextureAtlas::Region &icon,
+	const Int2 &point, TextureManager &textureManager, Renderer &renderer)
+{
+	const Texture &page = textureManager.getAtlasPage(icon.pageIndex);
+	renderer.drawOriginalClipped(page, icon.rect,
+		point.x - (icon.rect.getWidth() / 2),
+		point.y - (icon.rect.getHeight() / 2));
+}
+
 void ProvinceMapPanel::drawVisibleLocations(const std::string &backgroundFilename,
 	TextureManager &textureManager, Renderer &renderer)
 {
 	// Lambda for drawing a location icon if it's visible.
-	auto drawIconIfVisible = [this, &renderer](
-		const CityDataFile::ProvinceData::LocationData &location, const Texture &icon)
+	auto drawIconIfVisible = [this, &textureManager, &renderer](
+		const CityDataFile::ProvinceData::LocationData &location,
+		const TextureAtlas::Region &icon)
 	{
 		// Only draw visible locations.
 		if (location.isVisible())
 		{
 			const Int2 point(location.x, location.y);
-			this->drawCenteredIcon(icon, point, renderer);
+			this->drawCenteredIcon(icon, point, textureManager, renderer);
 		}
 	};
 
-	const auto &cityStateIcon = textureManager.getTexture(
+	// The icons are packed in the UI atlas so the dozens drawn here share one texture.
+	const auto &cityStateIcon = textureManager.getAtlasImage(
 		TextureFile::fromName(TextureName::CityStateIcon), backgroundFilename, renderer);
-	const auto &townIcon = textureManager.getTexture(
+	const auto &townIcon = textureManager.getAtlasImage(
 		TextureFile::fromName(TextureName::TownIcon), backgroundFilename, renderer);
-	const auto &villageIcon = textureManager.getTexture(
+	const auto &villageIcon = textureManager.getAtlasImage(
 		TextureFile::fromName(TextureName::VillageIcon), backgroundFilename, renderer);
-	const auto &dungeonIcon = textureManager.getTexture(
+	const auto &dungeonIcon = textureManager.getAtlasImage(
 		TextureFile::fromName(TextureName::DungeonIcon), backgroundFilename, renderer);
 
 	const auto &cityData = this->getGame().getGameData().getCityDataFile();
@@ -703,7 +686,7 @@ void ProvinceMapPanel::drawVisibleLocations(const std::string &backgroundFilenam
 	if (this->provinceID != Location::CENTER_PROVINCE_ID)
 	{
 		// Only draw staff dungeon if not the center province.
-		const auto &staffDungeonIcon = textureManager.getTextures(
+		const auto &staffDungeonIcon = textureManager.getAtlasImages(
 			TextureFile::fromName(TextureName::StaffDungeonIcons),
 			backgroundFilename, renderer).at(this->provinceID);
 		drawIconIfVisible(province.secondDungeon, staffDungeonIcon);
@@ -719,11 +702,12 @@ void ProvinceMapPanel::drawLocationHighlight(const Location &location,
 	LocationHighlightType highlightType, const std::string &backgroundFilename,
 	TextureManager &textureManager, Renderer &renderer)
 {
-	auto drawHighlight = [this, &renderer](
-		const CityDataFile::ProvinceData::LocationData &location, const Texture &highlight)
+	auto drawHighlight = [this, &textureManager, &renderer](
+		const CityDataFile::ProvinceData::LocationData &location,
+		const TextureAtlas::Region &highlight)
 	{
 		const Int2 point(location.x, location.y);
-		this->drawCenteredIcon(highlight, point, renderer);
+		this->drawCenteredIcon(highlight, point, textureManager, renderer);
 	};
 
 	const auto &cityData = this->getGame().getGameData().getCityDataFile();
@@ -733,7 +717,7 @@ void ProvinceMapPanel::drawLocationHighlight(const Location &location,
 	const std::string &outlinesFilename = TextureFile::fromName(
 		(highlightType == ProvinceMapPanel::LocationHighlightType::Current) ?
 		TextureName::MapIconOutlines : TextureName::MapIconOutlinesBlinking);
-	const auto &highlights = textureManager.getTextures(
+	const auto &highlights = textureManager.getAtlasImages(
 		outlinesFilename, backgroundFilename, renderer);
 
 	auto handleCityHighlight = [&renderer, &province, &location,
@@ -812,7 +796,8 @@ void ProvinceMapPanel::drawLocationHighlight(const Location &location,
 				return texture;
 			}();
 
-			drawHighlight(locationData, highlight);
+			const Int2 point(locationData.x, locationData.y);
+			this->drawCenteredIcon(highlight, point, renderer);
 		}
 		else if (localDungeonID == 1)
 		{
@@ -8,6 +8,8 @@
 #include "../Assets/CIFFile.h"
 #include "../Math/Vector2.h"
 #include "../Media/Palette.h"
+#include "../Rendering/TextureAtlas.h"
+#include "../World/ProvinceLocationGrid.h"
 
 class Location;
 class Renderer;
@@ -38,6 +40,7 @@ private:
 	Button<Game&, std::unique_ptr<ProvinceMapPanel::TravelData>> backToWorldMapButton;
 	CIFFile staffDungeonCif; // For obtaining palette indices.
 	std::unique_ptr<TravelData> travelData;
+	ProvinceLocationGrid locationGrid; // Visible locations by position.
 	Palette provinceMapPalette;
 	double blinkTimer;
 	int provinceID;
@@ -64,6 +67,8 @@ private:
 
 	// Draws an icon (i.e., location or highlight) centered at the given point.
 	void drawCenteredIcon(const Texture &texture, const Int2 &point, Renderer &renderer);
+	void drawCenteredIcon(const TextureAtlas::Region &icon, const Int2 &point,
+		TextureManager &textureManager, Renderer &renderer);
 
 	// Draws the icons of all visible locations in the province.
 	void drawVisibleLocations(const std::string &backgroundFilename,
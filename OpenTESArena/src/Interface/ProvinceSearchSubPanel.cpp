@@ -9,6 +9,7 @@
 #include "TextAlignment.h"
 #include "TextEntry.h"
 #include "../Assets/CityDataFile.h"
+#include "../Assets/MiscAssets.h"
 #include "../Game/Game.h"
 #include "../Media/Color.h"
 #include "../Media/FontName.h"
@@ -19,6 +20,7 @@
 #include "../Media/TextureName.h"
 #include "../Rendering/Renderer.h"
 #include "../Utilities/String.h"
+#include "../World/LocationSearchIndex.h"
 
 const int ProvinceSearchSubPanel::MAX_NAME_LENGTH = 20;
 const Int2 ProvinceSearchSubPanel::DEFAULT_TEXT_CURSOR_POSITION(85, 100);
@@ -39,7 +41,7 @@ ProvinceSearchSubPanel::ProvinceSearchSubPanel(Game &game,
 		const int y = 89;
 
 		const auto &exeData = game.getMiscAssets().getExeData();
-		const std::string &text = exeData.travel.searchTitleText;
+		const std::string &text = exeData.getTravel().searchTitleText;
 
 		const RichTextString richText(
 			text,
@@ -80,7 +82,8 @@ ProvinceSearchSubPanel::ProvinceSearchSubPanel(Game &game,
 			// Otherwise, display the list box of locations sorted by their location ID.
 			const int *exactLocationID = nullptr;
 			panel.locationsListIDs = ProvinceSearchSubPanel::getMatchingLocations(
-				panel.locationName, panel.provinceID, cityData, &exactLocationID);
+				panel.locationName, panel.provinceID, cityData,
+				game.getMiscAssets().getLocationSearchIndex(), &exactLocationID);
 
 			if (exactLocationID != nullptr)
 			{
@@ -177,69 +180,56 @@ std::pair<const Texture*, CursorAlignment> ProvinceSearchSubPanel::getCurrentCur
 }
 
 std::vector<int> ProvinceSearchSubPanel::getMatchingLocations(const std::string &locationName,
-	int provinceID, const CityDataFile &cityData, const int **exactLocationID)
+	int provinceID, const CityDataFile &cityData, const LocationSearchIndex &searchIndex,
+	const int **exactLocationID)
 {
 	const auto &provinceData = cityData.getProvinceData(provinceID);
-	const int locationCount = 48;
 
-	// Iterate through all locations in the province. If any visible location's name has
-	// a match with the one entered, then add the location to the matching IDs.
-	std::vector<int> locationIDs;
-	for (int i = 0; i < locationCount; i++)
+	// Only visible locations can be found.
+	auto removeHidden = [&provinceData](std::vector<int> &locationIDs)
 	{
-		const auto &locationData = provinceData.getLocationData(i);
-
-		// Only check visible locations.
-		const bool locationIsVisible = locationData.isVisible();
-
-		if (locationIsVisible)
+		locationIDs.erase(std::remove_if(locationIDs.begin(), locationIDs.end(),
+			[&provinceData](int locationID)
 		{
-			// See if the location names are an exact match.
-			const bool isExactMatch = String::caseInsensitiveEquals(
-				locationName, locationData.name);
+			return !provinceData.getLocationData(locationID).isVisible();
+		}), locationIDs.end());
+	};
 
-			if (isExactMatch)
-			{
-				locationIDs.push_back(i);
-				*exactLocationID = &locationIDs.back();
-				break;
-			}
-			else
-			{
-				// Approximate match behavior. If the given location name is a case-insensitive
-				// substring of the current location, it's a match.
-				const std::string locNameLower = String::toLowercase(locationName);
-				const std::string locDataNameLower = String::toLowercase(locationData.name);
-				const bool isApproxMatch = locDataNameLower.find(locNameLower) != std::string::npos;
+	// See if the location name is an exact match with a visible location.
+	std::vector<int> locationIDs;
+	const int exactID = searchIndex.findExact(locationName, provinceID);
+	if ((exactID >= 0) && provinceData.getLocationData(exactID).isVisible())
+	{
+		locationIDs.push_back(exactID);
+		*exactLocationID = &locationIDs.back();
+		return locationIDs;
+	}
 
-				if (isApproxMatch)
-				{
-					locationIDs.push_back(i);
-				}
-			}
-		}
+	// Approximate match behavior. If the given location name is a case-insensitive
+	// substring of a location, it's a match.
+	locationIDs = searchIndex.findContaining(locationName, provinceID);
+	removeHidden(locationIDs);
+
+	// If one approximate match was found, treat it as the nearest.
+	if (locationIDs.size() == 1)
+	{
+		*exactLocationID = &locationIDs.front();
+		return locationIDs;
 	}
 
-	// If no exact or approximate matches, just fill the list with all visible location IDs.
+	// If there are no approximate matches, try names that are spelled similarly (i.e.,
+	// with a typo). These are never selected on their own since they might be wrong.
 	if (locationIDs.empty())
 	{
-		for (int i = 0; i < locationCount; i++)
-		{
-			const auto &locationData = provinceData.getLocationData(i);
-			const bool locationIsVisible = locationData.isVisible();
-
-			if (locationIsVisible)
-			{
-				locationIDs.push_back(i);
-			}
-		}
+		locationIDs = searchIndex.findSimilar(locationName, provinceID);
+		removeHidden(locationIDs);
 	}
 
-	// If one approximate match was found and no exact match was found, treat the approximate
-	// match as the nearest.
-	if ((locationIDs.size() == 1) && (*exactLocationID == nullptr))
+	// If nothing is close, just fill the list with all visible location IDs.
+	if (locationIDs.empty())
 	{
-		*exactLocationID = &locationIDs.front();
+		locationIDs = searchIndex.getAll(provinceID);
+		removeHidden(locationIDs);
 	}
 
 	// The original game orders locations by their ID, but that's hardly helpful for the
@@ -247,21 +237,14 @@ std::vector<int> ProvinceSearchSubPanel::getMatchingLocations(const std::string
 	// from the original behavior for the sake of convenience. If the list isn't sorted
 	// alphabetically, then it takes the player linear time to find a location in it,
 	// which essentially isn't any faster than hovering over each location individually.
-	std::sort(locationIDs.begin(), locationIDs.end(),
-		[&provinceData](int a, int b)
-	{
-		const std::string &aName = provinceData.getLocationData(a).name;
-		const std::string &bName = provinceData.getLocationData(b).name;
-		return aName.compare(bName) < 0;
-	});
-
+	// The search index already returns them in that order.
 	return locationIDs;
 }
 
 std::string ProvinceSearchSubPanel::getBackgroundFilename() const
 {
 	const auto &exeData = this->getGame().getMiscAssets().getExeData();
-	const auto &provinceImgFilenames = exeData.locations.provinceImgFilenames;
+	const auto &provinceImgFilenames = exeData.getLocations().provinceImgFilenames;
 	const std::string &filename = provinceImgFilenames.at(this->provinceID);
 
 	// Set all characters to uppercase because the texture manager expects 
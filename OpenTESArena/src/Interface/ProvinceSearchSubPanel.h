@@ -14,6 +14,7 @@
 // as a convenience.
 
 class CityDataFile;
+class LocationSearchIndex;
 class ProvinceMapPanel;
 
 class ProvinceSearchSubPanel : public Panel
@@ -39,9 +40,11 @@ private:
 	// Returns a list of all visible location IDs in the given province that have a match with
 	// the given location name. Technically, this should only return up to one ID, but returning
 	// a list allows functionality for approximate matches. The exact location ID points into
-	// the vector if there is an exact match, or null otherwise.
+	// the vector if there is an exact match, or null otherwise. The city data is only used
+	// for location visibility.
 	static std::vector<int> getMatchingLocations(const std::string &locationName, int provinceID,
-		const CityDataFile &cityData, const int **exactLocationID);
+		const CityDataFile &cityData, const LocationSearchIndex &searchIndex,
+		const int **exactLocationID);
 
 	// Gets the .IMG filename of the background image.
 	std::string getBackgroundFilename() const;
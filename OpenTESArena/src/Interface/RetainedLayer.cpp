@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <string>
+
+#include "SDL.h"
+
+#include "RetainedLayer.h"
+#include "../Rendering/Renderer.h"
+#include "../Utilities/Debug.h"
+
+RetainedLayer::RetainedLayer()
+{
+	this->x = 0;
+	this->y = 0;
+}
+
+void RetainedLayer::addDirtyRect(int x, int y, int width, int height)
+{
+	const int left = std::max(x - this->x, 0);
+	const int top = std::max(y - this->y, 0);
+	const int right = std::min(x - this->x + width, this->surface.getWidth());
+	const int bottom = std::min(y - this->y + height, this->surface.getHeight());
+
+	if ((right <= left) || (bottom <= top))
+	{
+		return;
+	}
+
+	// Elements are usually drawn over a region that's already dirty (i.e., after a clear).
+	const Rect rect(left, top, right - left, bottom - top);
+	const bool alreadyDirty = std::any_of(this->dirtyRects.begin(), this->dirtyRects.end(),
+		[&rect](const Rect &dirtyRect)
+	{
+		return (rect.getLeft() >= dirtyRect.getLeft()) &&
+			(rect.getTop() >= dirtyRect.getTop()) &&
+			(rect.getRight() <= dirtyRect.getRight()) &&
+			(rect.getBottom() <= dirtyRect.getBottom());
+	});
+
+	if (!alreadyDirty)
+	{
+		this->dirtyRects.push_back(rect);
+	}
+}
+
+void RetainedLayer::init(int x, int y, int width, int height, Renderer &renderer)
+{
+	DebugAssert(width > 0);
+	DebugAssert(height > 0);
+
+	this->x = x;
+	this->y = y;
+	this->surface = Surface::createWithFormat(width, height,
+		Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
+
+	this->texture = renderer.createTexture(Renderer::DEFAULT_PIXELFORMAT,
+		SDL_TEXTUREACCESS_STREAMING, width, height);
+	DebugAssertMsg(this->texture.get() != nullptr,
+		"Couldn't create retained layer texture, " + std::string(SDL_GetError()));
+	SDL_SetTextureBlendMode(this->texture.get(), SDL_BLENDMODE_BLEND);
+
+	this->dirtyRects.clear();
+	this->clear();
+}
+
+bool RetainedLayer::isInited() const
+{
+	return this->texture.get() != nullptr;
+}
+
+int RetainedLayer::getX() const
+{
+	return this->x;
+}
+
+int RetainedLayer::getY() const
+{
+	return this->y;
+}
+
+void RetainedLayer::blit(const Surface &src, int x, int y)
+{
+	DebugAssert(this->isInited());
+	src.blit(this->surface, x - this->x, y - this->y);
+	this->addDirtyRect(x, y, src.getWidth(), src.getHeight());
+}
+
+void RetainedLayer::blitRect(const Surface &src, const Rect &srcRect, int x, int y)
+{
+	DebugAssert(this->isInited());
+	src.blitRect(srcRect, this->surface,
+		Rect(x - this->x, y - this->y, srcRect.getWidth(), srcRect.getHeight()));
+	this->addDirtyRect(x, y, srcRect.getWidth(), srcRect.getHeight());
+}
+
+void RetainedLayer::fillRect(const Rect &rect, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	DebugAssert(this->isInited());
+	const Rect layerRect(rect.getLeft() - this->x, rect.getTop() - this->y,
+		rect.getWidth(), rect.getHeight());
+	this->surface.fillRect(layerRect, r, g, b, a);
+	this->addDirtyRect(rect.getLeft(), rect.getTop(), rect.getWidth(), rect.getHeight());
+}
+
+void RetainedLayer::clear()
+{
+	DebugAssert(this->isInited());
+	this->surface.fill(0, 0, 0, 0);
+	this->addDirtyRect(this->x, this->y, this->surface.getWidth(), this->surface.getHeight());
+}
+
+void RetainedLayer::draw(Renderer &renderer)
+{
+	DebugAssert(this->isInited());
+
+	// Upload only what changed since the last draw.
+	const uint8_t *pixels = static_cast<const uint8_t*>(this->surface.getPixels());
+	const int pitch = this->surface.get()->pitch;
+	for (const Rect &rect : this->dirtyRects)
+	{
+		const uint8_t *rectPixels = pixels + (rect.getTop() * pitch) +
+			(rect.getLeft() * static_cast<int>(sizeof(uint32_t)));
+		SDL_UpdateTexture(this->texture.get(), &rect.getRect(), rectPixels, pitch);
+	}
+
+	this->dirtyRects.clear();
+
+	renderer.drawOriginal(this->texture, this->x, this->y);
+}
@@ -0,0 +1,54 @@
+#ifndef RETAINED_LAYER_H
+#define RETAINED_LAYER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/Rect.h"
+#include "../Rendering/Surface.h"
+#include "../Rendering/Texture.h"
+
+// A group of interface elements that rarely change (i.e., the classic game world HUD),
+// composed once into one texture so they take a single draw call per frame. Elements are
+// blitted into a software surface, and only the regions changed since the last draw are
+// uploaded to the texture.
+
+class Renderer;
+
+class RetainedLayer
+{
+private:
+	Surface surface;
+	Texture texture;
+	std::vector<Rect> dirtyRects;
+	int x, y; // Top-left corner in original (320x200) space.
+
+	// Marks a region of the layer as needing to be uploaded, clipped to the layer bounds.
+	void addDirtyRect(int x, int y, int width, int height);
+public:
+	RetainedLayer();
+
+	// Creates a fully transparent layer at the given position in original space. Replaces
+	// any existing contents.
+	void init(int x, int y, int width, int height, Renderer &renderer);
+
+	bool isInited() const;
+	int getX() const;
+	int getY() const;
+
+	// Blits a surface (or part of one) into the layer. Coordinates are in original space
+	// like the element's draw position would be.
+	void blit(const Surface &src, int x, int y);
+	void blitRect(const Surface &src, const Rect &srcRect, int x, int y);
+
+	// Fills a region of the layer, in original space, with a color.
+	void fillRect(const Rect &rect, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+
+	// Clears the whole layer to transparent.
+	void clear();
+
+	// Uploads any changed regions and draws the layer onto the native frame buffer.
+	void draw(Renderer &renderer);
+};
+
+#endif
@@ -16,18 +16,17 @@ RichTextString::RichTextString(const std::string &text, FontName fontName,
 	// Get the height in pixels for all characters in the font.
 	this->characterHeight = font.getCharacterHeight();
 
+	// Split the text on each newline. If the text is empty, then just add a space, 
+	// so there doesn't need to be any "zero-character" special case.
+	this->textLines = String::split((text.size() > 0) ? text : std::string(" "), '\n');
+
 	// Get the character surfaces associated with each line of text.
-	this->surfaceLists = [&text, &font]()
+	this->surfaceLists = [this, &font]()
 	{
-		// Split the text on each newline. If the text is empty, then just add a space, 
-		// so there doesn't need to be any "zero-character" special case.
-		const std::vector<std::string> textLines =
-			String::split((text.size() > 0) ? text : std::string(" "), '\n');
-
 		std::vector<std::vector<const SDL_Surface*>> tempLists;
 
 		// Go through each line of text and get the associated surface pointers.
-		for (const auto &textLine : textLines)
+		for (const auto &textLine : this->textLines)
 		{
 			std::vector<const SDL_Surface*> surfaces;
 
@@ -100,6 +99,11 @@ const std::vector<std::vector<const SDL_Surface*>> &RichTextString::getSurfaceLi
 	return this->surfaceLists;
 }
 
+const std::vector<std::string> &RichTextString::getTextLines() const
+{
+	return this->textLines;
+}
+
 const std::vector<int> &RichTextString::getLineWidths() const
 {
 	return this->lineWidths;
@@ -20,6 +20,7 @@ class RichTextString
 {
 private:
 	std::vector<std::vector<const SDL_Surface*>> surfaceLists; // Surfaces for each line of text.
+	std::vector<std::string> textLines; // Characters of each line, for drawing from a glyph atlas.
 	std::vector<int> lineWidths; // Width in pixels for each line of surfaces.
 	std::string text;
 	FontName fontName;
@@ -35,6 +36,7 @@ public:
 		TextAlignment alignment, FontManager &fontManager);
 
 	const std::vector<std::vector<const SDL_Surface*>> &getSurfaceLists() const;
+	const std::vector<std::string> &getTextLines() const;
 	const std::vector<int> &getLineWidths() const;
 	const std::string &getText() const;
 	FontName getFontName() const;
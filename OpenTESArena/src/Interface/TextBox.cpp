@@ -6,12 +6,18 @@
 #include "TextBox.h"
 #include "../Math/Rect.h"
 #include "../Media/Font.h"
+#include "../Media/FontManager.h"
 #include "../Rendering/Renderer.h"
+#include "../Rendering/SurfaceBlitter.h"
 #include "../Utilities/Debug.h"
 #include "../Utilities/String.h"
 
 TextBox::TextBox(int x, int y, const RichTextString &richText,
 	const ShadowData *shadow, Renderer &renderer)
+	: TextBox(x, y, richText, shadow, Texture(), renderer) { }
+
+TextBox::TextBox(int x, int y, const RichTextString &richText,
+	const ShadowData *shadow, Texture &&texture, Renderer &renderer)
 	: richText(richText)
 {
 	this->x = x;
@@ -25,65 +31,43 @@ TextBox::TextBox(int x, int y, const RichTextString &richText,
 	const Color shadowColor = hasShadow ? shadow->color : Color();
 	const Int2 shadowOffset = hasShadow ? shadow->offset : Int2();
 
-	// Create an intermediate surface for blitting each character surface onto
-	// before changing all non-transparent pixels to the desired text color.
-	Surface tempSurface = [&dimensions, &renderer]()
+	// Create the text box surface itself with proper dimensions (i.e., accounting for
+	// any shadow offset).
+	this->surface = [&dimensions, &shadowOffset]()
 	{
-		Surface surface = Surface::createWithFormat(dimensions.x, dimensions.y,
+		const Int2 surfaceDims(
+			dimensions.x + std::abs(shadowOffset.x),
+			dimensions.y + std::abs(shadowOffset.y));
+
+		Surface surface = Surface::createWithFormat(surfaceDims.x, surfaceDims.y,
 			Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
 		surface.fill(0, 0, 0, 0);
 
 		return surface;
 	}();
 
-	// Lambda for drawing a surface onto another surface.
-	auto blitToSurface = [](const SDL_Surface *src, int x, int y, Surface &dst)
+	// Lambda for drawing each character's surface onto the text box surface in some color,
+	// starting at the given offset. Glyph pixels are replaced by the color as they're
+	// drawn, so no scratch surface needs recoloring.
+	auto drawText = [this, &richText, &dimensions](const Color &color, int xStart, int yStart)
 	{
-		SDL_Rect rect;
-		rect.x = x;
-		rect.y = y;
-		rect.w = src->w;
-		rect.h = src->h;
+		const uint32_t tint = this->surface.mapRGBA(color.r, color.g, color.b, color.a);
 
-		SDL_BlitSurface(const_cast<SDL_Surface*>(src), nullptr, dst.get(), &rect);
-	};
-
-	// Lambda for setting all non-transparent pixels in the temp surface to some color.
-	auto setNonTransparentPixels = [&tempSurface](const Color &color)
-	{
-		uint32_t *pixels = static_cast<uint32_t*>(tempSurface.getPixels());
-		const int pixelCount = tempSurface.getWidth() * tempSurface.getHeight();
-		const uint32_t transparent = tempSurface.mapRGBA(0, 0, 0, 0);
-		const uint32_t desiredColor = tempSurface.mapRGBA(color.r, color.g, color.b, color.a);
-
-		std::for_each(pixels, pixels + pixelCount,
-			[transparent, desiredColor](uint32_t &pixel)
-		{
-			if (pixel != transparent)
-			{
-				pixel = desiredColor;
-			}
-		});
-	};
-
-	// Lambda for drawing the text to the temp surface with some color.
-	auto drawTempText = [&richText, &dimensions, &tempSurface, &blitToSurface,
-		&setNonTransparentPixels](const Color &color)
-	{
 		// The surface lists are a set of character surfaces for each line of text.
 		const auto &surfaceLists = richText.getSurfaceLists();
 		const TextAlignment alignment = richText.getAlignment();
 
-		// Draw each character's surface onto the intermediate surface based on alignment.
+		// Draw each character's surface based on alignment.
 		if (alignment == TextAlignment::Left)
 		{
-			int yOffset = 0;
+			int yOffset = yStart;
 			for (const auto &surfaceList : surfaceLists)
 			{
-				int xOffset = 0;
+				int xOffset = xStart;
 				for (auto *surface : surfaceList)
 				{
-					blitToSurface(surface, xOffset, yOffset, tempSurface);
+					SurfaceBlitter::blitTinted(surface, this->surface.get(), xOffset, yOffset,
+						tint);
 					xOffset += surface->w;
 				}
 
@@ -95,17 +79,16 @@ TextBox::TextBox(int x, int y, const RichTextString &richText,
 			const std::vector<int> &lineWidths = richText.getLineWidths();
 			DebugAssert(lineWidths.size() == surfaceLists.size());
 
-			int yOffset = 0;
+			int yOffset = yStart;
 			for (size_t i = 0; i < surfaceLists.size(); i++)
 			{
 				const auto &charSurfaces = surfaceLists[i];
 				const int lineWidth = lineWidths[i];
-				const int xStart = (dimensions.x / 2) - (lineWidth / 2);
-
-				int xOffset = 0;
+				int xOffset = xStart + (dimensions.x / 2) - (lineWidth / 2);
 				for (auto *surface : charSurfaces)
 				{
-					blitToSurface(surface, xStart + xOffset, yOffset, tempSurface);
+					SurfaceBlitter::blitTinted(surface, this->surface.get(), xOffset, yOffset,
+						tint);
 					xOffset += surface->w;
 				}
 
@@ -117,48 +100,35 @@ TextBox::TextBox(int x, int y, const RichTextString &richText,
 			DebugCrash("Alignment \"" +
 				std::to_string(static_cast<int>(alignment)) + "\" unrecognized.");
 		}
-
-		// Change all non-transparent pixels in the scratch surface to the desired 
-		// text colors.
-		setNonTransparentPixels(color);
 	};
 
-	// Create the text box surface itself with proper dimensions (i.e., accounting for
-	// any shadow offset).
-	this->surface = [&tempSurface, &shadowOffset]()
-	{
-		const Int2 surfaceDims(
-			tempSurface.getWidth() + std::abs(shadowOffset.x),
-			tempSurface.getHeight() + std::abs(shadowOffset.y));
-
-		Surface surface = Surface::createWithFormat(surfaceDims.x, surfaceDims.y,
-			Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
-		surface.fill(0, 0, 0, 0);
-
-		return surface;
-	}();
-
 	// Determine how to fill the text box surface, based on whether it has a shadow.
 	if (hasShadow)
 	{
-		drawTempText(shadowColor);
-		blitToSurface(tempSurface.get(), std::max(shadowOffset.x, 0),
-			std::max(shadowOffset.y, 0), this->surface);
-
-		// Set all shadow pixels in the temp surface to the main color.
-		setNonTransparentPixels(richText.getColor());
-
-		blitToSurface(tempSurface.get(), std::max(-shadowOffset.x, 0),
-			std::max(-shadowOffset.y, 0), this->surface);
+		drawText(shadowColor, std::max(shadowOffset.x, 0), std::max(shadowOffset.y, 0));
+		drawText(richText.getColor(), std::max(-shadowOffset.x, 0),
+			std::max(-shadowOffset.y, 0));
 	}
 	else
 	{
-		drawTempText(richText.getColor());
-		blitToSurface(tempSurface.get(), 0, 0, this->surface);
+		drawText(richText.getColor(), 0, 0);
 	}
 
-	// Create the destination SDL textures (keeping the surfaces' color keys).
-	this->texture = renderer.createTextureFromSurface(this->surface);
+	// Upload into the given texture if it's the right size, otherwise create the
+	// destination SDL texture (keeping the surface's color keys).
+	const bool canReuseTexture = (texture.get() != nullptr) &&
+		(texture.getWidth() == this->surface.getWidth()) &&
+		(texture.getHeight() == this->surface.getHeight());
+	if (canReuseTexture)
+	{
+		SDL_UpdateTexture(texture.get(), nullptr, this->surface.get()->pixels,
+			this->surface.get()->pitch);
+		this->texture = std::move(texture);
+	}
+	else
+	{
+		this->texture = renderer.createTextureFromSurface(this->surface);
+	}
 }
 
 TextBox::TextBox(const Int2 &center, const RichTextString &richText,
@@ -177,6 +147,97 @@ TextBox::TextBox(int x, int y, const RichTextString &richText, Renderer &rendere
 TextBox::TextBox(const Int2 &center, const RichTextString &richText, Renderer &renderer)
 	: TextBox(center, richText, nullptr, renderer) { }
 
+void TextBox::drawBatched(int x, int y, const RichTextString &richText,
+	const ShadowData *shadow, FontManager &fontManager, Renderer &renderer)
+{
+	const Font &font = fontManager.getFont(richText.getFontName());
+	const Texture &glyphAtlas = fontManager.getGlyphAtlas(richText.getFontName(), renderer);
+
+	const TextAlignment alignment = richText.getAlignment();
+	DebugAssertMsg((alignment == TextAlignment::Left) || (alignment == TextAlignment::Center),
+		"Alignment \"" + std::to_string(static_cast<int>(alignment)) + "\" unrecognized.");
+
+	const Int2 &dimensions = richText.getDimensions();
+	const std::vector<std::string> &textLines = richText.getTextLines();
+	const std::vector<int> &lineWidths = richText.getLineWidths();
+	DebugAssert(lineWidths.size() == textLines.size());
+
+	// Lambda for drawing every character with some color. The glyphs are white, so the
+	// color modulation gives the same pixels as recoloring a text box surface. Every copy
+	// uses the same texture, so SDL can batch them.
+	auto drawText = [x, y, &richText, &font, &glyphAtlas, &renderer, alignment, &dimensions,
+		&textLines, &lineWidths](const Color &color, int xOffset, int yOffset)
+	{
+		SDL_SetTextureColorMod(glyphAtlas.get(), color.r, color.g, color.b);
+		SDL_SetTextureAlphaMod(glyphAtlas.get(), color.a);
+
+		int lineY = y + yOffset;
+		for (size_t i = 0; i < textLines.size(); i++)
+		{
+			int lineX = x + xOffset;
+			if (alignment == TextAlignment::Center)
+			{
+				lineX += (dimensions.x / 2) - (lineWidths[i] / 2);
+			}
+
+			for (const char c : textLines[i])
+			{
+				const Rect glyphRect = font.getGlyphRect(c);
+				renderer.drawOriginalClipped(glyphAtlas, glyphRect, lineX, lineY);
+				lineX += glyphRect.getWidth();
+			}
+
+			lineY += richText.getCharacterHeight() + richText.getLineSpacing();
+		}
+	};
+
+	// Same placement as the text box surface, which makes room for the shadow offset.
+	if (shadow != nullptr)
+	{
+		const Int2 &shadowOffset = shadow->offset;
+		drawText(shadow->color, std::max(shadowOffset.x, 0), std::max(shadowOffset.y, 0));
+		drawText(richText.getColor(), std::max(-shadowOffset.x, 0),
+			std::max(-shadowOffset.y, 0));
+	}
+	else
+	{
+		drawText(richText.getColor(), 0, 0);
+	}
+
+	// Leave the shared texture untinted.
+	SDL_SetTextureColorMod(glyphAtlas.get(), 255, 255, 255);
+	SDL_SetTextureAlphaMod(glyphAtlas.get(), 255);
+}
+
+void TextBox::drawBatched(int x, int y, std::string_view text, FontName fontName,
+	const Color &color, FontManager &fontManager, Renderer &renderer)
+{
+	const Font &font = fontManager.getFont(fontName);
+	const Texture &glyphAtlas = fontManager.getGlyphAtlas(fontName, renderer);
+
+	SDL_SetTextureColorMod(glyphAtlas.get(), color.r, color.g, color.b);
+	SDL_SetTextureAlphaMod(glyphAtlas.get(), color.a);
+
+	int lineX = x;
+	int lineY = y;
+	for (const char c : text)
+	{
+		if (c == '\n')
+		{
+			lineX = x;
+			lineY += font.getCharacterHeight();
+			continue;
+		}
+
+		const Rect glyphRect = font.getGlyphRect(c);
+		renderer.drawOriginalClipped(glyphAtlas, glyphRect, lineX, lineY);
+		lineX += glyphRect.getWidth();
+	}
+
+	SDL_SetTextureColorMod(glyphAtlas.get(), 255, 255, 255);
+	SDL_SetTextureAlphaMod(glyphAtlas.get(), 255);
+}
+
 int TextBox::getX() const
 {
 	return this->x;
@@ -206,3 +267,8 @@ const Texture &TextBox::getTexture() const
 {
 	return this->texture;
 }
+
+Texture TextBox::releaseTexture()
+{
+	return std::move(this->texture);
+}
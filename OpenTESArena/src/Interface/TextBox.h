@@ -2,6 +2,7 @@
 #define TEXT_BOX_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "RichTextString.h"
@@ -12,9 +13,12 @@
 
 // Redesigned for use with the font system using Arena assets.
 
+class FontManager;
 class Rect;
 class Renderer;
 
+enum class FontName;
+
 class TextBox
 {
 public:
@@ -38,11 +42,28 @@ public:
 
 	TextBox(int x, int y, const RichTextString &richText, const ShadowData *shadow,
 		Renderer &renderer);
+
+	// Draws into the given texture instead of creating one if it has the text box's
+	// dimensions (i.e., one recycled from an old text box). It can be empty.
+	TextBox(int x, int y, const RichTextString &richText, const ShadowData *shadow,
+		Texture &&texture, Renderer &renderer);
 	TextBox(const Int2 &center, const RichTextString &richText, const ShadowData *shadow,
 		Renderer &renderer);
 	TextBox(int x, int y, const RichTextString &richText, Renderer &renderer);
 	TextBox(const Int2 &center, const RichTextString &richText, Renderer &renderer);
 
+	// Draws text straight from its font's glyph atlas instead of building a text box, for
+	// text that changes often (i.e., every frame). Looks the same as drawing a text box
+	// made with the same arguments at the same position.
+	static void drawBatched(int x, int y, const RichTextString &richText,
+		const ShadowData *shadow, FontManager &fontManager, Renderer &renderer);
+
+	// Same as above for left-aligned text without a shadow, but reads the characters
+	// straight from the given text so nothing is allocated (i.e., for text built in the
+	// frame arena).
+	static void drawBatched(int x, int y, std::string_view text, FontName fontName,
+		const Color &color, FontManager &fontManager, Renderer &renderer);
+
 	int getX() const;
 	int getY() const;
 	const RichTextString &getRichText() const;
@@ -53,6 +74,9 @@ public:
 
 	const Surface &getSurface() const;
 	const Texture &getTexture() const;
+
+	// Moves the texture out so it can be reused. The text box can't be drawn afterwards.
+	Texture releaseTexture();
 };
 
 #endif
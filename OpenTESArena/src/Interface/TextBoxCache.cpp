@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "RichTextString.h"
+#include "TextBoxCache.h"
+#include "../Utilities/Debug.h"
+
+const int TextBoxCache::MAX_ENTRIES = 64;
+const int TextBoxCache::MAX_FREE_TEXTURES = 16;
+
+TextBoxCache::TextBoxCache()
+{
+	this->useCount = 0;
+}
+
+std::string TextBoxCache::makeKey(const std::string &text, FontName fontName,
+	const Color &color, TextAlignment alignment, int lineSpacing,
+	const TextBox::ShadowData *shadow)
+{
+	// The text goes last so it can't run into the other fields.
+	std::string key = std::to_string(static_cast<int>(fontName)) + ',' +
+		std::to_string(color.toARGB()) + ',' +
+		std::to_string(static_cast<int>(alignment)) + ',' +
+		std::to_string(lineSpacing) + ',';
+
+	if (shadow != nullptr)
+	{
+		key += std::to_string(shadow->color.toARGB()) + ',' +
+			std::to_string(shadow->offset.x) + ',' + std::to_string(shadow->offset.y);
+	}
+
+	return key + ':' + text;
+}
+
+Texture TextBoxCache::takeFreeTexture(int width, int height)
+{
+	const auto iter = std::find_if(this->freeTextures.begin(), this->freeTextures.end(),
+		[width, height](const Texture &texture)
+	{
+		return (texture.getWidth() == width) && (texture.getHeight() == height);
+	});
+
+	if (iter == this->freeTextures.end())
+	{
+		return Texture();
+	}
+
+	Texture texture = std::move(*iter);
+	this->freeTextures.erase(iter);
+	return texture;
+}
+
+void TextBoxCache::evictOldest()
+{
+	DebugAssert(this->entries.size() > 0);
+
+	const auto oldestIter = std::min_element(this->entries.begin(), this->entries.end(),
+		[](const auto &a, const auto &b)
+	{
+		return a.second.lastUsed < b.second.lastUsed;
+	});
+
+	// Only recycle the texture if no timed text box or panel still holds the text box.
+	std::shared_ptr<TextBox> &textBox = oldestIter->second.textBox;
+	if (textBox.use_count() == 1)
+	{
+		if (static_cast<int>(this->freeTextures.size()) >= TextBoxCache::MAX_FREE_TEXTURES)
+		{
+			this->freeTextures.erase(this->freeTextures.begin());
+		}
+
+		this->freeTextures.push_back(textBox->releaseTexture());
+	}
+
+	this->entries.erase(oldestIter);
+}
+
+std::shared_ptr<const TextBox> TextBoxCache::get(const std::string &text, FontName fontName,
+	const Color &color, TextAlignment alignment, int lineSpacing,
+	const TextBox::ShadowData *shadow, FontManager &fontManager, Renderer &renderer)
+{
+	this->useCount++;
+
+	const std::string key = TextBoxCache::makeKey(
+		text, fontName, color, alignment, lineSpacing, shadow);
+	const auto iter = this->entries.find(key);
+	if (iter != this->entries.end())
+	{
+		iter->second.lastUsed = this->useCount;
+		return iter->second.textBox;
+	}
+
+	if (static_cast<int>(this->entries.size()) >= TextBoxCache::MAX_ENTRIES)
+	{
+		this->evictOldest();
+	}
+
+	const RichTextString richText(text, fontName, color, alignment, lineSpacing, fontManager);
+
+	// The text box texture makes room for the shadow offset.
+	const Int2 &dimensions = richText.getDimensions();
+	const Int2 shadowOffset = (shadow != nullptr) ? shadow->offset : Int2();
+	Texture texture = this->takeFreeTexture(dimensions.x + std::abs(shadowOffset.x),
+		dimensions.y + std::abs(shadowOffset.y));
+
+	Entry entry;
+	entry.textBox = std::make_shared<TextBox>(
+		0, 0, richText, shadow, std::move(texture), renderer);
+	entry.lastUsed = this->useCount;
+
+	return this->entries.emplace(std::make_pair(key, std::move(entry))).first->second.textBox;
+}
+
+void TextBoxCache::clear()
+{
+	this->entries.clear();
+	this->freeTextures.clear();
+}
@@ -0,0 +1,62 @@
+#ifndef TEXT_BOX_CACHE_H
+#define TEXT_BOX_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TextBox.h"
+#include "../Rendering/Texture.h"
+
+// Keeps recently made text boxes so the same text with the same look (i.e., a trigger
+// message shown again) isn't laid out and uploaded again. Holds a bounded number of
+// entries, evicting the least recently used, and keeps the textures of evicted text boxes
+// so a new text box of the same size can be drawn into one instead of creating another.
+
+class FontManager;
+class Renderer;
+
+enum class FontName;
+enum class TextAlignment;
+
+class TextBoxCache
+{
+public:
+	static const int MAX_ENTRIES;
+	static const int MAX_FREE_TEXTURES;
+private:
+	struct Entry
+	{
+		std::shared_ptr<TextBox> textBox;
+		uint64_t lastUsed;
+	};
+
+	std::unordered_map<std::string, Entry> entries;
+	std::vector<Texture> freeTextures;
+	uint64_t useCount;
+
+	// Makes the key of a text box from everything that affects its pixels.
+	static std::string makeKey(const std::string &text, FontName fontName, const Color &color,
+		TextAlignment alignment, int lineSpacing, const TextBox::ShadowData *shadow);
+
+	// Takes a free texture with the given dimensions, or returns an empty one if none match.
+	Texture takeFreeTexture(int width, int height);
+
+	// Removes the least recently used entry, keeping its texture if nothing else uses it.
+	void evictOldest();
+public:
+	TextBoxCache();
+
+	// Gets a text box with its top left corner at (0, 0), making it if it isn't cached.
+	// Callers decide where to draw its texture. Text boxes from here must not be changed.
+	std::shared_ptr<const TextBox> get(const std::string &text, FontName fontName,
+		const Color &color, TextAlignment alignment, int lineSpacing,
+		const TextBox::ShadowData *shadow, FontManager &fontManager, Renderer &renderer);
+
+	// Frees all cached text boxes and textures.
+	void clear();
+};
+
+#endif
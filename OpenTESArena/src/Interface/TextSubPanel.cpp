@@ -38,6 +38,16 @@ std::pair<const Texture*, CursorAlignment> TextSubPanel::getCurrentCursor() cons
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool TextSubPanel::isStatic() const
+{
+	return true;
+}
+
+bool TextSubPanel::usesFrozenBackground() const
+{
+	return true;
+}
+
 void TextSubPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
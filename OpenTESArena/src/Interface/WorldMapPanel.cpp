@@ -7,7 +7,6 @@
 #include "WorldMapPanel.h"
 #include "../Assets/CIFFile.h"
 #include "../Assets/MiscAssets.h"
-#include "../Assets/WorldMapMask.h"
 #include "../Game/Game.h"
 #include "../Game/GameData.h"
 #include "../Game/Options.h"
@@ -32,7 +31,7 @@ WorldMapPanel::WorldMapPanel(Game &game, std::unique_ptr<ProvinceMapPanel::Trave
 		int height = 9;
 		auto function = [](Game &game)
 		{
-			game.setPanel<GameWorldPanel>(game);
+			game.resumePanel<GameWorldPanel>(game);
 		};
 		return Button<Game&>(center, width, height, function);
 	}();
@@ -72,6 +71,11 @@ std::pair<const Texture*, CursorAlignment> WorldMapPanel::getCurrentCursor() con
 	return std::make_pair(&texture, CursorAlignment::TopLeft);
 }
 
+bool WorldMapPanel::isStatic() const
+{
+	return true;
+}
+
 void WorldMapPanel::handleEvent(const SDL_Event &e)
 {
 	const auto &inputManager = this->getGame().getInputManager();
@@ -92,35 +96,20 @@ void WorldMapPanel::handleEvent(const SDL_Event &e)
 			.nativeToOriginal(mousePosition);
 
 		// Listen for clicks on the map and exit button.
-		const auto &worldMapMasks = this->getGame().getMiscAssets().getWorldMapMasks();
-		const int maskCount = static_cast<int>(worldMapMasks.size());
-		for (int maskID = 0; maskID < maskCount; maskID++)
+		const int maskID = this->getGame().getMiscAssets().getWorldMapMaskID(originalPoint);
+		if (maskID >= 0)
 		{
-			const WorldMapMask &mapMask = worldMapMasks.at(maskID);
-			const Rect &maskRect = mapMask.getRect();
-
-			if (maskRect.contains(originalPoint))
+			// Mask IDs 0 through 8 are provinces, and 9 is the "Exit" button.
+			if (maskID < 9)
+			{
+				// Go to the selected province panel.
+				this->provinceButton.click(this->getGame(), maskID,
+					std::move(this->travelData));
+			}
+			else
 			{
-				// See if the clicked pixel is set in the bitmask.
-				const bool success = mapMask.get(originalPoint.x, originalPoint.y);
-
-				if (success)
-				{
-					// Mask IDs 0 through 8 are provinces, and 9 is the "Exit" button.
-					if (maskID < 9)
-					{
-						// Go to the selected province panel.
-						this->provinceButton.click(this->getGame(), maskID,
-							std::move(this->travelData));
-					}
-					else
-					{
-						// Exit the world map panel.
-						this->backToGameButton.click(this->getGame());
-					}
-					
-					break;
-				}
+				// Exit the world map panel.
+				this->backToGameButton.click(this->getGame());
 			}
 		}
 	}	
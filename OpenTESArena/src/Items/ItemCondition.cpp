@@ -79,6 +79,33 @@ ItemCondition ItemCondition::makeFistsCondition()
 	return itemCondition;
 }
 
+ItemCondition ItemCondition::makeFromValues(int currentCondition, int maxCondition,
+	int degradeRate)
+{
+	DebugAssert(currentCondition <= maxCondition);
+
+	ItemCondition itemCondition;
+	itemCondition.maxCondition = maxCondition;
+	itemCondition.currentCondition = currentCondition;
+	itemCondition.degradeRate = degradeRate;
+	return itemCondition;
+}
+
+int ItemCondition::getCurrentCondition() const
+{
+	return this->currentCondition;
+}
+
+int ItemCondition::getMaxCondition() const
+{
+	return this->maxCondition;
+}
+
+int ItemCondition::getDegradeRate() const
+{
+	return this->degradeRate;
+}
+
 ItemConditionName ItemCondition::getCurrentConditionName() const
 {
 	DebugAssert(this->maxCondition > 0);
@@ -36,6 +36,15 @@ public:
 
 	// Item condition for fists.
 	static ItemCondition makeFistsCondition();
+
+	// Item condition with the given values, for conditions kept apart from the item (i.e.,
+	// an item instance's current condition with its definition's max and degrade rate).
+	static ItemCondition makeFromValues(int currentCondition, int maxCondition,
+		int degradeRate);
+
+	int getCurrentCondition() const;
+	int getMaxCondition() const;
+	int getDegradeRate() const;
 	
 	ItemConditionName getCurrentConditionName() const;
 	bool isBroken() const;
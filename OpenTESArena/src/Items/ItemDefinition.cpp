@@ -0,0 +1,62 @@
+#include "ItemCondition.h"
+#include "ItemDefinition.h"
+#include "ItemType.h"
+#include "../Utilities/Debug.h"
+
+ItemDefinition::ItemDefinition(std::unique_ptr<Item> prototype, const ItemCondition *condition)
+	: prototype(std::move(prototype))
+{
+	DebugAssert(this->prototype != nullptr);
+
+	this->displayName = this->prototype->getDisplayName();
+	this->weight = this->prototype->getWeight();
+	this->goldValue = this->prototype->getGoldValue();
+	this->maxCondition = (condition != nullptr) ? condition->getMaxCondition() : 0;
+	this->degradeRate = (condition != nullptr) ? condition->getDegradeRate() : 0;
+	this->itemType = this->prototype->getItemType();
+}
+
+const Item &ItemDefinition::getPrototype() const
+{
+	return *this->prototype.get();
+}
+
+ItemType ItemDefinition::getItemType() const
+{
+	return this->itemType;
+}
+
+const std::string &ItemDefinition::getDisplayName() const
+{
+	return this->displayName;
+}
+
+double ItemDefinition::getWeight() const
+{
+	return this->weight;
+}
+
+int ItemDefinition::getGoldValue() const
+{
+	return this->goldValue;
+}
+
+const ArtifactData *ItemDefinition::getArtifactData() const
+{
+	return this->prototype->getArtifactData();
+}
+
+bool ItemDefinition::hasCondition() const
+{
+	return this->maxCondition > 0;
+}
+
+int ItemDefinition::getMaxCondition() const
+{
+	return this->maxCondition;
+}
+
+int ItemDefinition::getDegradeRate() const
+{
+	return this->degradeRate;
+}
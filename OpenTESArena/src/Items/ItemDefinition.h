@@ -0,0 +1,50 @@
+#ifndef ITEM_DEFINITION_H
+#define ITEM_DEFINITION_H
+
+#include <memory>
+#include <string>
+
+#include "Item.h"
+
+// Everything about an item that's the same for each copy of it: its type, name, weight,
+// value, and how fast it wears out. Copies of an item only differ by their condition,
+// so inventories, piles, and shops keep small item instances pointing at one shared
+// definition instead of each copy being its own Item object.
+
+class ArtifactData;
+class ItemCondition;
+
+enum class ItemType;
+
+class ItemDefinition
+{
+private:
+	std::unique_ptr<Item> prototype; // For type-specific data (damage, armor rating, etc.).
+	std::string displayName; // Item::getDisplayName() makes a new string on each call.
+	double weight;
+	int goldValue;
+	int maxCondition, degradeRate; // Max condition is zero if the item doesn't wear out.
+	ItemType itemType;
+public:
+	// Makes a definition from the given item. The condition is null for items that don't
+	// wear out (i.e., accessories and consumables).
+	ItemDefinition(std::unique_ptr<Item> prototype, const ItemCondition *condition);
+
+	// Gets the item this definition was made from, for data only specific item types have.
+	const Item &getPrototype() const;
+
+	ItemType getItemType() const;
+	const std::string &getDisplayName() const;
+	double getWeight() const;
+	int getGoldValue() const;
+
+	// Null if the item is not an artifact.
+	const ArtifactData *getArtifactData() const;
+
+	// Returns whether copies of the item have a condition that wears out with use.
+	bool hasCondition() const;
+	int getMaxCondition() const;
+	int getDegradeRate() const;
+};
+
+#endif
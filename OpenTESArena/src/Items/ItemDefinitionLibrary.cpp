@@ -0,0 +1,48 @@
+#include "ArtifactData.h"
+#include "ItemDefinitionLibrary.h"
+#include "ItemType.h"
+#include "../Utilities/Debug.h"
+
+std::string ItemDefinitionLibrary::makeKey(const Item &item)
+{
+	// Artifacts can have the same display name as the plain item they're based on.
+	const ArtifactData *artifactData = item.getArtifactData();
+	return std::to_string(static_cast<int>(item.getItemType())) + "|" +
+		item.getDisplayName() + "|" +
+		((artifactData != nullptr) ? artifactData->getDisplayName() : std::string());
+}
+
+int ItemDefinitionLibrary::findOrAdd(std::unique_ptr<Item> item,
+	const ItemCondition *condition)
+{
+	DebugAssert(item != nullptr);
+
+	std::string key = ItemDefinitionLibrary::makeKey(*item.get());
+	const auto iter = this->definitionIDs.find(key);
+	if (iter != this->definitionIDs.end())
+	{
+		return iter->second;
+	}
+
+	const int id = static_cast<int>(this->definitions.size());
+	this->definitions.push_back(ItemDefinition(std::move(item), condition));
+	this->definitionIDs.insert(std::make_pair(std::move(key), id));
+	return id;
+}
+
+int ItemDefinitionLibrary::getCount() const
+{
+	return static_cast<int>(this->definitions.size());
+}
+
+const ItemDefinition &ItemDefinitionLibrary::get(int id) const
+{
+	DebugAssertIndex(this->definitions, id);
+	return this->definitions[id];
+}
+
+void ItemDefinitionLibrary::clear()
+{
+	this->definitions.clear();
+	this->definitionIDs.clear();
+}
@@ -0,0 +1,41 @@
+#ifndef ITEM_DEFINITION_LIBRARY_H
+#define ITEM_DEFINITION_LIBRARY_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ItemDefinition.h"
+
+// Owns the item definitions that item instances refer to by ID. Identical items share
+// one definition, so filling a shop with fifty steel longswords only makes one.
+
+class Item;
+class ItemCondition;
+
+class ItemDefinitionLibrary
+{
+private:
+	std::vector<ItemDefinition> definitions;
+
+	// IDs by item type, display name, and artifact name, for finding identical items.
+	std::unordered_map<std::string, int> definitionIDs;
+
+	// Gets the key that identical items have in common.
+	static std::string makeKey(const Item &item);
+public:
+	// Gets the ID of the definition for an identical item if there is one, otherwise adds
+	// one made from the given item. See ItemDefinition for the condition.
+	int findOrAdd(std::unique_ptr<Item> item, const ItemCondition *condition);
+
+	int getCount() const;
+
+	// Gets the definition with the given ID. The reference is only valid until the next
+	// definition is added.
+	const ItemDefinition &get(int id) const;
+
+	void clear();
+};
+
+#endif
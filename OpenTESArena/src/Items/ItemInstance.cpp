@@ -0,0 +1,56 @@
+#include <limits>
+
+#include "ItemInstance.h"
+#include "../Utilities/Debug.h"
+
+const int ItemInstance::NO_ENCHANTMENT = -1;
+
+ItemInstance::ItemInstance(int definitionID, int condition, int enchantmentID)
+{
+	DebugAssert(definitionID >= 0);
+	DebugAssert(definitionID <= std::numeric_limits<uint16_t>::max());
+
+	this->definitionID = static_cast<uint16_t>(definitionID);
+	this->setCondition(condition);
+	this->setEnchantmentID(enchantmentID);
+}
+
+ItemInstance::ItemInstance(int definitionID, int condition)
+	: ItemInstance(definitionID, condition, ItemInstance::NO_ENCHANTMENT) { }
+
+int ItemInstance::getDefinitionID() const
+{
+	return static_cast<int>(this->definitionID);
+}
+
+int ItemInstance::getCondition() const
+{
+	return static_cast<int>(this->condition);
+}
+
+int ItemInstance::getEnchantmentID() const
+{
+	return static_cast<int>(this->enchantmentID);
+}
+
+void ItemInstance::setCondition(int condition)
+{
+	// Degrading can go below zero, which is the same as broken.
+	const int maxCondition = std::numeric_limits<uint16_t>::max();
+	DebugAssert(condition <= maxCondition);
+	this->condition = static_cast<uint16_t>((condition > 0) ? condition : 0);
+}
+
+void ItemInstance::setEnchantmentID(int enchantmentID)
+{
+	DebugAssert(enchantmentID >= ItemInstance::NO_ENCHANTMENT);
+	DebugAssert(enchantmentID <= std::numeric_limits<int16_t>::max());
+	this->enchantmentID = static_cast<int16_t>(enchantmentID);
+}
+
+bool ItemInstance::isIdentical(const ItemInstance &other) const
+{
+	return (this->definitionID == other.definitionID) &&
+		(this->condition == other.condition) &&
+		(this->enchantmentID == other.enchantmentID);
+}
@@ -0,0 +1,37 @@
+#ifndef ITEM_INSTANCE_H
+#define ITEM_INSTANCE_H
+
+#include <cstdint>
+
+// One copy of an item in an inventory, pile, or shop. Only what can differ between copies
+// is kept here, and the rest is looked up in its item definition, so instances are small
+// enough to keep by value in one array per inventory.
+
+class ItemInstance
+{
+private:
+	uint16_t definitionID;
+	uint16_t condition; // Current condition. Zero for items that don't wear out.
+	int16_t enchantmentID; // Spell effect cast on this copy, or NO_ENCHANTMENT.
+public:
+	static const int NO_ENCHANTMENT;
+
+	ItemInstance(int definitionID, int condition, int enchantmentID);
+
+	// Item instance with no enchantment.
+	ItemInstance(int definitionID, int condition);
+
+	ItemInstance() = default;
+
+	int getDefinitionID() const;
+	int getCondition() const;
+	int getEnchantmentID() const;
+
+	void setCondition(int condition);
+	void setEnchantmentID(int enchantmentID);
+
+	// Returns whether the two instances are interchangeable (i.e., for stacking in a list).
+	bool isIdentical(const ItemInstance &other) const;
+};
+
+#endif
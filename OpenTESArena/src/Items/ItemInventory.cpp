@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "ItemCondition.h"
+#include "ItemDefinitionLibrary.h"
+#include "ItemInventory.h"
+#include "../Utilities/Debug.h"
+
+int ItemInventory::getCount() const
+{
+	return static_cast<int>(this->items.size());
+}
+
+bool ItemInventory::isEmpty() const
+{
+	return this->items.empty();
+}
+
+const ItemInstance &ItemInventory::get(int index) const
+{
+	DebugAssertIndex(this->items, index);
+	return this->items[index];
+}
+
+ItemInstance &ItemInventory::get(int index)
+{
+	DebugAssertIndex(this->items, index);
+	return this->items[index];
+}
+
+void ItemInventory::add(int definitionID, const ItemDefinitionLibrary &library)
+{
+	const ItemDefinition &definition = library.get(definitionID);
+	this->items.push_back(ItemInstance(definitionID, definition.getMaxCondition()));
+}
+
+void ItemInventory::add(const ItemInstance &item)
+{
+	this->items.push_back(item);
+}
+
+void ItemInventory::remove(int index)
+{
+	DebugAssertIndex(this->items, index);
+	this->items.erase(this->items.begin() + index);
+}
+
+void ItemInventory::clear()
+{
+	this->items.clear();
+}
+
+const std::string &ItemInventory::getDisplayName(int index,
+	const ItemDefinitionLibrary &library) const
+{
+	return library.get(this->get(index).getDefinitionID()).getDisplayName();
+}
+
+ItemCondition ItemInventory::getCondition(int index, const ItemDefinitionLibrary &library) const
+{
+	const ItemInstance &item = this->get(index);
+	const ItemDefinition &definition = library.get(item.getDefinitionID());
+	DebugAssert(definition.hasCondition());
+
+	return ItemCondition::makeFromValues(item.getCondition(), definition.getMaxCondition(),
+		definition.getDegradeRate());
+}
+
+void ItemInventory::setCondition(int index, const ItemCondition &condition)
+{
+	this->get(index).setCondition(condition.getCurrentCondition());
+}
+
+double ItemInventory::getTotalWeight(const ItemDefinitionLibrary &library) const
+{
+	double weight = 0.0;
+	for (const ItemInstance &item : this->items)
+	{
+		weight += library.get(item.getDefinitionID()).getWeight();
+	}
+
+	return weight;
+}
+
+int ItemInventory::getIdenticalCount(const ItemInstance &item) const
+{
+	return static_cast<int>(std::count_if(this->items.begin(), this->items.end(),
+		[&item](const ItemInstance &other)
+	{
+		return other.isIdentical(item);
+	}));
+}
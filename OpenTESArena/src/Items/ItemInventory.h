@@ -0,0 +1,56 @@
+#ifndef ITEM_INVENTORY_H
+#define ITEM_INVENTORY_H
+
+#include <string>
+#include <vector>
+
+#include "ItemInstance.h"
+
+// The items held by a character, a loot pile, or a shop, in the order they were added.
+// Items are instances of definitions in an item definition library, which has to be
+// given to anything that needs more than the instances themselves.
+
+class ItemCondition;
+class ItemDefinitionLibrary;
+
+class ItemInventory
+{
+private:
+	std::vector<ItemInstance> items;
+public:
+	int getCount() const;
+	bool isEmpty() const;
+
+	const ItemInstance &get(int index) const;
+	ItemInstance &get(int index);
+
+	// Adds a copy of the given definition in full condition.
+	void add(int definitionID, const ItemDefinitionLibrary &library);
+	void add(const ItemInstance &item);
+
+	// Removes the item at the given index. Items after it move up by one.
+	void remove(int index);
+
+	void clear();
+
+	// Gets the display name of the item at the given index. The name is made once per
+	// definition, so listing an inventory doesn't make any strings.
+	const std::string &getDisplayName(int index, const ItemDefinitionLibrary &library) const;
+
+	// Gets the item's condition with its definition's max and degrade rate filled in. The
+	// item must have a condition (see ItemDefinition::hasCondition()).
+	ItemCondition getCondition(int index, const ItemDefinitionLibrary &library) const;
+
+	// Sets the item's condition to the current condition of the given one (i.e., after
+	// calling ItemCondition::degrade() on the one from getCondition()).
+	void setCondition(int index, const ItemCondition &condition);
+
+	// Gets the weight of every item in kilograms.
+	double getTotalWeight(const ItemDefinitionLibrary &library) const;
+
+	// Gets how many items are interchangeable with the given one, for listing copies of
+	// the same item as one entry with a count.
+	int getIdenticalCount(const ItemInstance &item) const;
+};
+
+#endif
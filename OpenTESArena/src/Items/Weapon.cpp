@@ -148,7 +148,7 @@ Weapon::Weapon(int weaponID, MetalType metalType,
 	DebugAssert(weaponID != -1);
 
 	this->weaponID = weaponID;
-	this->weaponName = exeData.equipment.weaponNames.at(weaponID);
+	this->weaponName = exeData.getEquipment().weaponNames.at(weaponID);
 }
 
 Weapon::Weapon(int weaponID, MetalType metalType, const ExeData &exeData)
@@ -10,13 +10,50 @@
 
 int main(int argc, char *argv[])
 {
-	static_cast<void>(argc);
-	static_cast<void>(argv);
+	// "--record <file>" saves the session's input for replaying with "--replay <file>".
+	// "--benchmark <scenario>" runs a built-in benchmark and exits.
+	std::string recordFilename, replayFilename, benchmarkScenario;
+	for (int i = 1; (i + 1) < argc; i++)
+	{
+		const std::string arg(argv[i]);
+		if (arg == "--record")
+		{
+			recordFilename = argv[++i];
+		}
+		else if (arg == "--replay")
+		{
+			replayFilename = argv[++i];
+		}
+		else if (arg == "--benchmark")
+		{
+			benchmarkScenario = argv[++i];
+		}
+	}
 
 	try
 	{
 		// Allocated on the heap to avoid stack overflow warning.
 		auto g = std::make_unique<Game>();
+
+		if (!benchmarkScenario.empty())
+		{
+			if (!g->startBenchmark(benchmarkScenario))
+			{
+				return EXIT_FAILURE;
+			}
+		}
+		else if (!replayFilename.empty())
+		{
+			if (!g->replayInput(replayFilename))
+			{
+				return EXIT_FAILURE;
+			}
+		}
+		else if (!recordFilename.empty())
+		{
+			g->recordInput(recordFilename);
+		}
+
 		g->loop();
 	}
 	catch (const std::exception &e)
@@ -2,6 +2,124 @@
 
 #include "Constants.h"
 #include "Matrix4.h"
+#include "../Utilities/KernelDispatch.h"
+#include "../Utilities/PlatformIsa.h"
+
+namespace
+{
+	// Matrix-vector products, shared by the matrix-matrix product one column at a time. The
+	// vector versions add the columns scaled by each vector component in the same order as
+	// the reference versions, so results are exactly the same whichever one is selected.
+	template <typename T>
+	void multiplyColumnScalar(const Matrix4<T> &m, const Vector4f<T> &v, Vector4f<T> &out)
+	{
+		out = m.multiplyReference(v);
+	}
+
+#if defined(PLATFORM_SSE2)
+	void multiplyColumnSSE2(const Matrix4<float> &m, const Vector4f<float> &v,
+		Vector4f<float> &out)
+	{
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(&m.x.x), _mm_set1_ps(v.x));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&m.y.x), _mm_set1_ps(v.y)));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&m.z.x), _mm_set1_ps(v.z)));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&m.w.x), _mm_set1_ps(v.w)));
+		_mm_storeu_ps(&out.x, sum);
+	}
+
+	void multiplyColumnSSE2(const Matrix4<double> &m, const Vector4f<double> &v,
+		Vector4f<double> &out)
+	{
+		// Two lanes per register, so X and Y are done apart from Z and W.
+		const __m128d vx = _mm_set1_pd(v.x);
+		const __m128d vy = _mm_set1_pd(v.y);
+		const __m128d vz = _mm_set1_pd(v.z);
+		const __m128d vw = _mm_set1_pd(v.w);
+
+		__m128d xy = _mm_mul_pd(_mm_loadu_pd(&m.x.x), vx);
+		xy = _mm_add_pd(xy, _mm_mul_pd(_mm_loadu_pd(&m.y.x), vy));
+		xy = _mm_add_pd(xy, _mm_mul_pd(_mm_loadu_pd(&m.z.x), vz));
+		xy = _mm_add_pd(xy, _mm_mul_pd(_mm_loadu_pd(&m.w.x), vw));
+
+		__m128d zw = _mm_mul_pd(_mm_loadu_pd(&m.x.z), vx);
+		zw = _mm_add_pd(zw, _mm_mul_pd(_mm_loadu_pd(&m.y.z), vy));
+		zw = _mm_add_pd(zw, _mm_mul_pd(_mm_loadu_pd(&m.z.z), vz));
+		zw = _mm_add_pd(zw, _mm_mul_pd(_mm_loadu_pd(&m.w.z), vw));
+
+		_mm_storeu_pd(&out.x, xy);
+		_mm_storeu_pd(&out.z, zw);
+	}
+#elif defined(PLATFORM_NEON)
+	void multiplyColumnNEON(const Matrix4<float> &m, const Vector4f<float> &v,
+		Vector4f<float> &out)
+	{
+		// Separate multiply and add instead of a fused multiply-add so rounding matches.
+		float32x4_t sum = vmulq_n_f32(vld1q_f32(&m.x.x), v.x);
+		sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(&m.y.x), v.y));
+		sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(&m.z.x), v.z));
+		sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(&m.w.x), v.w));
+		vst1q_f32(&out.x, sum);
+	}
+
+	void multiplyColumnNEON(const Matrix4<double> &m, const Vector4f<double> &v,
+		Vector4f<double> &out)
+	{
+		float64x2_t xy = vmulq_n_f64(vld1q_f64(&m.x.x), v.x);
+		xy = vaddq_f64(xy, vmulq_n_f64(vld1q_f64(&m.y.x), v.y));
+		xy = vaddq_f64(xy, vmulq_n_f64(vld1q_f64(&m.z.x), v.z));
+		xy = vaddq_f64(xy, vmulq_n_f64(vld1q_f64(&m.w.x), v.w));
+
+		float64x2_t zw = vmulq_n_f64(vld1q_f64(&m.x.z), v.x);
+		zw = vaddq_f64(zw, vmulq_n_f64(vld1q_f64(&m.y.z), v.y));
+		zw = vaddq_f64(zw, vmulq_n_f64(vld1q_f64(&m.z.z), v.z));
+		zw = vaddq_f64(zw, vmulq_n_f64(vld1q_f64(&m.w.z), v.w));
+
+		vst1q_f64(&out.x, xy);
+		vst1q_f64(&out.z, zw);
+	}
+#endif
+
+	template <typename T>
+	using MultiplyColumnKernel =
+		KernelDispatch::Kernel<void(const Matrix4<T>&, const Vector4f<T>&, Vector4f<T>&)>;
+
+	// Kernels are function-local statics because matrices are also multiplied while other
+	// files' globals are being initialized, which can be before globals here are.
+	template <typename T>
+	const MultiplyColumnKernel<T> &getMultiplyColumnKernel();
+
+	template <>
+	const MultiplyColumnKernel<float> &getMultiplyColumnKernel()
+	{
+		static const MultiplyColumnKernel<float> kernel("Matrix4fColumn",
+		{
+			{ Platform::CpuIsa::Scalar, multiplyColumnScalar<float> },
+#if defined(PLATFORM_SSE2)
+			{ Platform::CpuIsa::SSE2, multiplyColumnSSE2 }
+#elif defined(PLATFORM_NEON)
+			{ Platform::CpuIsa::NEON, multiplyColumnNEON }
+#endif
+		});
+
+		return kernel;
+	}
+
+	template <>
+	const MultiplyColumnKernel<double> &getMultiplyColumnKernel()
+	{
+		static const MultiplyColumnKernel<double> kernel("Matrix4dColumn",
+		{
+			{ Platform::CpuIsa::Scalar, multiplyColumnScalar<double> },
+#if defined(PLATFORM_SSE2)
+			{ Platform::CpuIsa::SSE2, multiplyColumnSSE2 }
+#elif defined(PLATFORM_NEON)
+			{ Platform::CpuIsa::NEON, multiplyColumnNEON }
+#endif
+		});
+
+		return kernel;
+	}
+}
 
 template <typename T>
 Matrix4<T>::Matrix4(const Vector4f<T> &x, const Vector4f<T> &y, const Vector4f<T> &z,
@@ -122,6 +240,27 @@ Matrix4<T> Matrix4<T>::perspective(T fovY, T aspect, T near, T far)
 
 template <typename T>
 Matrix4<T> Matrix4<T>::operator*(const Matrix4<T> &m) const
+{
+	// Each column of the product is this matrix times that column of the other.
+	const auto &multiplyColumn = getMultiplyColumnKernel<T>().get();
+	Matrix4<T> p;
+	multiplyColumn(*this, m.x, p.x);
+	multiplyColumn(*this, m.y, p.y);
+	multiplyColumn(*this, m.z, p.z);
+	multiplyColumn(*this, m.w, p.w);
+	return p;
+}
+
+template <typename T>
+Vector4f<T> Matrix4<T>::operator*(const Vector4f<T> &v) const
+{
+	Vector4f<T> p;
+	getMultiplyColumnKernel<T>().get()(*this, v, p);
+	return p;
+}
+
+template <typename T>
+Matrix4<T> Matrix4<T>::multiplyReference(const Matrix4<T> &m) const
 {
 	Matrix4<T> p;
 
@@ -217,7 +356,7 @@ Matrix4<T> Matrix4<T>::operator*(const Matrix4<T> &m) const
 }
 
 template <typename T>
-Vector4f<T> Matrix4<T>::operator*(const Vector4f<T> &v) const
+Vector4f<T> Matrix4<T>::multiplyReference(const Vector4f<T> &v) const
 {
 	const T newX = (this->x.x * v.x) + (this->y.x * v.y) +
 		(this->z.x * v.z) + (this->w.x * v.w);
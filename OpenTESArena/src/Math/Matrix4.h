@@ -37,6 +37,11 @@ public:
 	Matrix4<T> operator*(const Matrix4<T> &m) const;
 	Vector4f<T> operator*(const Vector4f<T> &v) const;
 
+	// Plain scalar versions of the products above, which use SIMD where the target always
+	// has it. Kept for checking and timing against in the benchmark.
+	Matrix4<T> multiplyReference(const Matrix4<T> &m) const;
+	Vector4f<T> multiplyReference(const Vector4f<T> &v) const;
+
 	// A partial vector multiplication, calculating only the Y and W values instead
 	// of all four (X, Y, Z, W). Intended for use with ray casted columns. The
 	// fourth input component (W) is omitted since it's a constant.
@@ -1,8 +1,21 @@
+#include <atomic>
 #include <ctime>
 #include <limits>
 
 #include "Random.h"
 
+namespace
+{
+	// Seed for the next default-constructed generator while replaying input.
+	std::atomic<bool> hasReplaySeed(false);
+	std::atomic<int> nextReplaySeed(0);
+
+	int makeDefaultSeed()
+	{
+		return hasReplaySeed ? nextReplaySeed++ : static_cast<int>(time(nullptr));
+	}
+}
+
 Random::Random(int seed)
 {
 	this->generator = std::default_random_engine(seed);
@@ -13,7 +26,13 @@ Random::Random(int seed)
 }
 
 Random::Random()
-	: Random(static_cast<int>(time(nullptr))) { }
+	: Random(makeDefaultSeed()) { }
+
+void Random::setReplaySeed(int seed)
+{
+	nextReplaySeed = seed;
+	hasReplaySeed = true;
+}
 
 int Random::next()
 {
@@ -14,9 +14,13 @@ public:
 	// Initialized with the given seed.
 	Random(int seed);
 
-	// Initialized with the current time.
+	// Initialized with the current time, or the next replay seed if one was set.
 	Random();
 
+	// Makes default-constructed generators use the given seed (plus one for each generator
+	// made so far) instead of the time, so recorded input replays the same random results.
+	static void setReplaySeed(int seed);
+
 	// Includes 0 to ~2.14 billion.
 	int next();
 
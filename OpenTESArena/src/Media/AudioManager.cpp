@@ -1,9 +1,13 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <functional>
+#include <future>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -17,7 +21,11 @@
 #include "WildMidi.h"
 #include "../Assets/VOCFile.h"
 #include "../Game/Options.h"
+#include "../Game/Physics.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/MemoryReport.h"
+#include "../Utilities/Profiler.h"
 
 namespace
 {
@@ -28,6 +36,115 @@ namespace
 	{
 		"DRUMS.VOC"
 	};
+
+	// Sounds quieter than this (after the sound volume) aren't given a channel.
+	const float MinAudibleGain = 0.01f;
+
+	// Gain scale of an emitter with voxels between it and the listener.
+	const float OccludedGain = 0.35f;
+
+	// Converts 8-bit unsigned mono PCM to the given sample rate with cubic interpolation,
+	// and optionally to 16-bit signed. Done once at load time so OpenAL can mix the sound
+	// at 1:1 instead of resampling it every time it plays.
+	std::vector<uint8_t> resampleSound(const std::vector<uint8_t> &src, int srcRate,
+		int dstRate, bool use16Bit)
+	{
+		if (src.empty() || (srcRate <= 0) || (dstRate <= 0))
+		{
+			return src;
+		}
+
+		const ptrdiff_t srcCount = static_cast<ptrdiff_t>(src.size());
+		auto getSample = [&src, srcCount](ptrdiff_t index)
+		{
+			const ptrdiff_t clampedIndex = std::max<ptrdiff_t>(
+				0, std::min<ptrdiff_t>(index, srcCount - 1));
+			return (static_cast<float>(src[clampedIndex]) - 128.0f) / 128.0f;
+		};
+
+		const size_t dstCount = static_cast<size_t>(
+			((static_cast<uint64_t>(srcCount) * dstRate) + srcRate - 1) / srcRate);
+		const size_t bytesPerSample = use16Bit ? sizeof(int16_t) : 1;
+		std::vector<uint8_t> dst(dstCount * bytesPerSample);
+
+		const double step = static_cast<double>(srcRate) / static_cast<double>(dstRate);
+		for (size_t i = 0; i < dstCount; i++)
+		{
+			const double srcPos = static_cast<double>(i) * step;
+			const ptrdiff_t index = static_cast<ptrdiff_t>(srcPos);
+			const float t = static_cast<float>(srcPos - static_cast<double>(index));
+
+			// Catmull-Rom spline through the four nearest samples.
+			const float p0 = getSample(index - 1);
+			const float p1 = getSample(index);
+			const float p2 = getSample(index + 1);
+			const float p3 = getSample(index + 2);
+			const float value = 0.5f * ((2.0f * p1) + ((p2 - p0) * t) +
+				(((2.0f * p0) - (5.0f * p1) + (4.0f * p2) - p3) * t * t) +
+				(((3.0f * p1) - p0 - (3.0f * p2) + p3) * t * t * t));
+			const float clampedValue = std::max(-1.0f, std::min(value, 1.0f));
+
+			if (use16Bit)
+			{
+				// OpenAL takes 16-bit samples in native byte order.
+				const int16_t sample = static_cast<int16_t>(std::lround(clampedValue * 32767.0f));
+				std::memcpy(dst.data() + (i * sizeof(int16_t)), &sample, sizeof(sample));
+			}
+			else
+			{
+				const long sample = std::lround((clampedValue * 128.0f) + 128.0f);
+				dst[i] = static_cast<uint8_t>(std::max(0L, std::min(sample, 255L)));
+			}
+		}
+
+		return dst;
+	}
+
+	// A song synthesized ahead of time, shared by the music cache and any stream playing it.
+	struct RenderedSong
+	{
+		std::vector<char> pcm; // 16-bit stereo frames.
+		int sampleRate;
+	};
+
+	// Plays a rendered song back by copying its samples instead of synthesizing them.
+	class RenderedMidiSong : public MidiSong
+	{
+	private:
+		static const size_t FrameSize = 4;
+
+		std::shared_ptr<const RenderedSong> song;
+		size_t frame;
+	public:
+		RenderedMidiSong(std::shared_ptr<const RenderedSong> song)
+			: song(std::move(song)), frame(0) { }
+
+		virtual void getFormat(int *sampleRate) override
+		{
+			*sampleRate = this->song->sampleRate;
+		}
+
+		virtual size_t read(char *buffer, size_t count) override
+		{
+			const size_t frameCount = this->song->pcm.size() / FrameSize;
+			const size_t readCount = std::min(count, frameCount - this->frame);
+			const char *src = this->song->pcm.data() + (this->frame * FrameSize);
+			std::copy(src, src + (readCount * FrameSize), buffer);
+			this->frame += readCount;
+			return readCount;
+		}
+
+		virtual bool seek(size_t offset) override
+		{
+			if (offset > (this->song->pcm.size() / FrameSize))
+			{
+				return false;
+			}
+
+			this->frame = offset;
+			return true;
+		}
+	};
 }
 
 std::unique_ptr<MidiDevice> MidiDevice::sInstance;
@@ -39,6 +156,31 @@ class AudioManagerImpl
 private:
 	static const ALint UNSUPPORTED_EXTENSION;
 
+	// A .VOC's samples ready to upload, possibly decoded on a worker thread.
+	struct DecodedSound
+	{
+		std::string filename;
+		std::vector<uint8_t> audioData;
+		int sampleRate;
+		ALenum format;
+	};
+
+	// A sound in the world. Its source is only valid while it's bound.
+	struct Emitter
+	{
+		std::string filename;
+		Double3 position;
+		AudioManager::SoundPriority priority;
+		float volume;
+		float gain; // Audible gain as of the last update, 0 if culled.
+		bool looping;
+		bool occluded;
+		bool started; // One-shot emitters only play once.
+		bool bound;
+		ALuint source;
+		ALint sampleOffset; // Where a looping emitter resumes when bound again.
+	};
+
 	ALint mResampler;
 
 	// Use this when resetting sound sources back to their default resampling. This uses
@@ -53,11 +195,70 @@ private:
 	// Returns whether the given sound is currently playing. Intended for limiting certain
 	// sounds to only have one instance at a time.
 	bool soundIsPlaying(const std::string &filename) const;
+
+	// Stops a sound source and sets it back to its defaults.
+	void resetSource(ALuint source);
+
+	// Synthesizes a whole song for the music cache. Returns null if it can't be opened,
+	// would take more than the given bytes, or the render is cancelled.
+	static std::shared_ptr<RenderedSong> renderSong(const std::string &filename,
+		size_t maxBytes, const std::atomic<bool> &cancel);
+
+	// Starts rendering the given song on a worker thread if the cache has room for it
+	// and no other song is being rendered.
+	void requestRenderedSong(const std::string &filename);
+
+	// Adds the finished render to the music cache. Blocks if it isn't done yet.
+	void finishRenderedSong();
+
+	// Frees the least recently played rendered songs until the cache is under budget.
+	void evictRenderedSongs();
+
+	// Reads a .VOC for uploading, first resampling it to the given rate if that's non-zero.
+	// Returns false if the file couldn't be read.
+	static bool decodeSound(const std::string &filename, int resampleRate, bool use16Bit,
+		DecodedSound *outSound);
+
+	// Gives a sound's PCM data to a new OpenAL buffer.
+	static ALuint createBuffer(const DecodedSound &sound);
+
+	// Gets the buffer of a sound, loading it first if needed.
+	ALuint getSoundBuffer(const std::string &filename);
+
+	// Uploads the sounds decoded by the last preload. Blocks if they aren't done yet.
+	void finishPendingSounds();
+
+	// Finds the index of the used source to give a new sound to if none are free, or
+	// returns the used source count if all playing sounds matter more. The lowest priority is taken, then the quietest,
+	// then the oldest.
+	size_t findVoiceToSteal(AudioManager::SoundPriority priority) const;
+
+	// Takes back an emitter's source, remembering where a looping sound was so it can
+	// resume there.
+	void unbindEmitter(Emitter &emitter);
+
+	// Culls emitters that can't be heard, gives sources to the loudest ones and takes them
+	// from the rest, and sets the bound sources' positions and gains for this frame.
+	void updateEmitters();
 public:
+	// A playing sound.
+	struct Voice
+	{
+		std::string filename; // Required for sounds that can only have one instance.
+		ALuint source;
+		AudioManager::SoundPriority priority;
+		float volume; // Scales the sound volume.
+	};
+
 	float mMusicVolume;
 	float mSfxVolume;
 	bool mHasResamplerExtension; // Whether AL_SOFT_source_resampler is supported.
 
+	// Rate and bit depth sounds are converted to when loaded (0 rate to keep them as is).
+	int mSoundLoadRate;
+	bool mSoundLoad16Bit;
+	int mDeviceSampleRate;
+
 	// Currently active song and playback stream.
 	MidiSongPtr mCurrentSong;
 	std::unique_ptr<OpenALStream> mSongStream;
@@ -65,14 +266,47 @@ public:
 	// Loaded sound buffers from .VOC files.
 	std::unordered_map<std::string, ALuint> mSoundBuffers;
 
+	// Sounds wanted by the last preload (freed when no longer wanted), and the ones still
+	// being decoded.
+	std::unordered_set<std::string> mPreloadedSounds;
+	std::unordered_set<std::string> mPendingSoundNames;
+	std::future<std::vector<DecodedSound>> mPendingSounds;
+
+	// Songs already synthesized, the one being rendered on a worker thread, and the cache
+	// size in bytes (0 if songs are always synthesized while playing).
+	struct CachedSong
+	{
+		std::shared_ptr<const RenderedSong> song;
+		uint64_t lastPlayed;
+	};
+
+	std::unordered_map<std::string, CachedSong> mRenderedSongs;
+	std::string mRenderingSongName;
+	std::future<std::shared_ptr<RenderedSong>> mRenderingSong;
+	std::atomic<bool> mCancelRender;
+	size_t mMusicCacheBudget;
+	uint64_t mMusicPlayCount;
+
 	// A deque of available sources to play sounds and streams with.
 	std::deque<ALuint> mFreeSources;
 
-	// A deque of currently used sources for sounds (the music source is owned 
-	// by OpenALStream). The string is the filename and the integer is the ID.
-	// The filename is required for some sounds that can only have one instance
-	// active at a time.
-	std::deque<std::pair<std::string, ALuint>> mUsedSources;
+	// A deque of currently used sources for sounds, newest first (the music source is
+	// owned by OpenALStream).
+	std::deque<Voice> mUsedSources;
+
+	// Sounds in the world by ID, and where they're heard from.
+	std::unordered_map<int, Emitter> mEmitters;
+	int mNextEmitterID;
+	size_t mMaxBoundEmitters; // Leaves the other channels for non-positional sounds.
+	Double3 mListenerPosition, mListenerDirection;
+
+	AudioManager::SoundStats mSoundStats;
+
+	// Music stream health, written by the stream's feeder thread. The queue length
+	// carries over between songs so a machine that underran once doesn't keep doing so.
+	std::atomic<int> mMusicUnderrunCount;
+	std::atomic<int> mMusicStarvedCount;
+	std::atomic<int> mMusicQueueLength;
 
 	AudioManagerImpl();
 	~AudioManagerImpl();
@@ -81,7 +315,17 @@ public:
 		int resamplingOption, const std::string &midiConfig);
 
 	void playMusic(const std::string &filename);
-	void playSound(const std::string &filename);
+	void playSound(const std::string &filename, AudioManager::SoundPriority priority,
+		double volumePercent);
+
+	void preloadSounds(const std::vector<std::string> &filenames);
+
+	int addEmitter(const std::string &filename, const Double3 &position,
+		AudioManager::SoundPriority priority, double volumePercent, bool looping);
+	void setEmitterPosition(int id, const Double3 &position);
+	void removeEmitter(int id);
+	void setListener(const Double3 &position, const Double3 &direction);
+	void updateEmitterOcclusion(double ceilingHeight, const VoxelGrid &voxelGrid);
 
 	void stopMusic();
 	void stopSound();
@@ -89,37 +333,121 @@ public:
 	void setMusicVolume(double percent);
 	void setSoundVolume(double percent);
 	void setResamplingOption(int value);
+	void setMusicCacheBudget(size_t bytes);
+	void setSoundLoadResampling(int mode);
 
 	void update();
 };
 
 const ALint AudioManagerImpl::UNSUPPORTED_EXTENSION = -1;
 
+/* Single-producer, single-consumer ring of fixed-size PCM blocks. The synth thread
+ * writes blocks and the feeder thread hands them to OpenAL, with neither taking a
+ * lock or waiting on the other. Only resize and clear it while both are stopped.
+ */
+class PcmBlockRing
+{
+private:
+	std::vector<std::vector<char>> mBlocks;
+
+	/* Total blocks ever written and read. The difference is the fill level. */
+	std::atomic<size_t> mWriteCount;
+	std::atomic<size_t> mReadCount;
+public:
+	PcmBlockRing()
+		: mWriteCount(0), mReadCount(0)
+	{
+	}
+
+	void resize(size_t blockCount, size_t blockBytes)
+	{
+		mBlocks.assign(blockCount, std::vector<char>(blockBytes));
+		clear();
+	}
+
+	void clear()
+	{
+		mWriteCount.store(0);
+		mReadCount.store(0);
+	}
+
+	size_t size() const
+	{
+		return mWriteCount.load(std::memory_order_acquire) -
+			mReadCount.load(std::memory_order_acquire);
+	}
+
+	/* Producer side. Returns null if the ring is full. */
+	std::vector<char> *beginWrite()
+	{
+		const size_t written = mWriteCount.load(std::memory_order_relaxed);
+		const size_t read = mReadCount.load(std::memory_order_acquire);
+		if ((written - read) == mBlocks.size())
+			return nullptr;
+		return &mBlocks[written % mBlocks.size()];
+	}
+
+	void endWrite()
+	{
+		mWriteCount.fetch_add(1, std::memory_order_release);
+	}
+
+	/* Consumer side. Returns null if the ring is empty. */
+	const std::vector<char> *beginRead() const
+	{
+		const size_t read = mReadCount.load(std::memory_order_relaxed);
+		const size_t written = mWriteCount.load(std::memory_order_acquire);
+		if (written == read)
+			return nullptr;
+		return &mBlocks[read % mBlocks.size()];
+	}
+
+	void endRead()
+	{
+		mReadCount.fetch_add(1, std::memory_order_release);
+	}
+};
+
 class OpenALStream
 {
 private:
 	AudioManagerImpl *mManager;
 	MidiSong *mSong;
 
-	/* Background thread and control. */
+	/* Background threads and control. The synth thread renders the song into the
+	 * ring, and the feeder thread moves blocks from the ring to the source queue,
+	 * so a slow synthesis pass can't hold up requeueing what's already rendered.
+	 */
 	std::atomic<bool> mQuit;
+	std::atomic<bool> mSongEnded;
 	std::thread mThread;
+	std::thread mSynthThread;
+
+	/* Rendered blocks waiting for the feeder. About three seconds at 44.1kHz. */
+	static const int sRingBlocks = 16;
+	PcmBlockRing mRing;
 
-	/* Playback source and buffer queue. */
-	static const int sBufferFrames = 16384;
+	/* Playback source and buffer queue. Starts at the minimum queue length and
+	 * grows (for the rest of the session) each time the source underruns.
+	 */
+	static const int sBufferFrames = 8192;
+	static const int sMinQueuedBuffers = 8;
+	static const int sMaxQueuedBuffers = 16;
+	static const int sQueueGrowth = 2;
 	ALuint mSource;
-	std::array<ALuint, 4> mBuffers;
+	std::array<ALuint, sMaxQueuedBuffers> mBuffers;
 	ALuint mBufferIdx;
+	bool mStarving; // The ring was empty when the queue wanted a block.
 
 	/* Stream format. */
 	ALenum mFormat;
 	ALuint mSampleRate;
 	ALuint mFrameSize;
 
-	/* Read samples from the song and fill the given OpenAL buffer ID (buffer
-	 * vector is for temporary storage). Returns true if the buffer was filled.
+	/* Read samples from the song into the given block, looping at the end. Returns
+	 * false if nothing could be read (the song is over).
 	 */
-	bool fillBuffer(ALuint bufid, std::vector<char> &buffer)
+	bool renderBlock(std::vector<char> &buffer)
 	{
 		size_t totalSize = 0;
 		while (totalSize < buffer.size())
@@ -138,23 +466,38 @@ private:
 			return false;
 
 		std::fill(buffer.begin() + totalSize, buffer.end(), 0);
-		alBufferData(bufid, mFormat, buffer.data(),
-			static_cast<ALsizei>(buffer.size()), mSampleRate);
 		return true;
 	}
 
-	/* Fill buffers to fill up the source queue. Returns the number of buffers
-	 * queued.
+	/* Move rendered blocks from the ring to fill up the source queue. Returns the
+	 * number of buffers queued.
 	 */
-	ALint fillBufferQueue(std::vector<char> &buffer)
+	ALint fillBufferQueue()
 	{
+		const ALint queueLength = mManager->mMusicQueueLength.load();
+
 		ALint queued;
 		alGetSourcei(mSource, AL_BUFFERS_QUEUED, &queued);
-		while (queued < mBuffers.size())
+		while (queued < queueLength)
 		{
-			ALuint bufid = mBuffers[mBufferIdx];
-			if (!fillBuffer(bufid, buffer))
+			const std::vector<char> *block = mRing.beginRead();
+			if (block == nullptr)
+			{
+				/* Count each time synthesis falls behind, not each check. */
+				if (!mSongEnded.load() && !mStarving)
+				{
+					mStarving = true;
+					mManager->mMusicStarvedCount++;
+				}
 				break;
+			}
+			mStarving = false;
+
+			ALuint bufid = mBuffers[mBufferIdx];
+			alBufferData(bufid, mFormat, block->data(),
+				static_cast<ALsizei>(block->size()), mSampleRate);
+			mRing.endRead();
+
 			mBufferIdx = (mBufferIdx + 1) % mBuffers.size();
 			alSourceQueueBuffers(mSource, 1, &bufid);
 			queued++;
@@ -162,20 +505,71 @@ private:
 		return queued;
 	}
 
+	/* Removes buffers the source has finished with. */
+	void unqueueProcessed()
+	{
+		ALint processed;
+		alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
+		while (processed > 0)
+		{
+			ALuint bufid;
+			alSourceUnqueueBuffers(mSource, 1, &bufid);
+			processed--;
+		}
+	}
+
+	/* A method run in a background thread, to keep the ring full of rendered audio
+	 * ahead of the feeder.
+	 */
+	void synthProc()
+	{
+		Profiler::setThreadName("Music synth");
+
+		while (!mQuit.load())
+		{
+			std::vector<char> *block = mRing.beginWrite();
+			if (block == nullptr)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				continue;
+			}
+
+			bool rendered;
+			{
+				ProfilerZone("Synthesize music");
+				rendered = renderBlock(*block);
+			}
+
+			if (!rendered)
+			{
+				mSongEnded.store(true);
+				return;
+			}
+
+			mRing.endWrite();
+		}
+	}
+
 	/* A method run in a backround thread, to keep filling the queue with new
 	 * audio over time.
 	 */
 	void backgroundProc()
 	{
-		/* Temporary storage to read samples into, before passing to OpenAL.
-		 * Kept here to avoid reallocating it during playback.
+		Profiler::setThreadName("Music stream");
+
+		/* Give the synth thread a head start so the source doesn't start on a
+		 * nearly empty queue.
 		 */
-		std::vector<char> buffer(sBufferFrames * mFrameSize);
+		const size_t startBlocks = std::min<size_t>(
+			mManager->mMusicQueueLength.load(), sRingBlocks);
+		while (!mQuit.load() && !mSongEnded.load() && (mRing.size() < startBlocks))
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
 
+		bool started = false;
 		while (!mQuit.load())
 		{
 			/* First, make sure the buffer queue is filled. */
-			fillBufferQueue(buffer);
+			fillBufferQueue();
 
 			ALint state;
 			alGetSourcei(mSource, AL_SOURCE_STATE, &state);
@@ -185,36 +579,55 @@ private:
 				 * or hasn't started at all yet. So remove any buffers that
 				 * have been played (will be 0 when first starting).
 				 */
-				ALint processed;
-				alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
-				while (processed > 0)
-				{
-					ALuint bufid;
-					alSourceUnqueueBuffers(mSource, 1, &bufid);
-					processed--;
-				}
+				unqueueProcessed();
 
 				/* Make sure the buffer queue is still filled, in case another
 				 * buffer had finished before checking the state and after the
-				 * last fill. If the queue is empty, playback is over.
+				 * last fill. If the queue is empty, playback is over unless
+				 * the synth thread is still catching up.
 				 */
-				if (fillBufferQueue(buffer) == 0)
+				if (fillBufferQueue() == 0)
 				{
-					mQuit.store(true);
-					return;
+					if (mSongEnded.load())
+					{
+						mQuit.store(true);
+						return;
+					}
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(5));
+					continue;
+				}
+
+				/* If it had started, the queue ran dry, so keep more queued from
+				 * now on.
+				 */
+				if (started && !mSongEnded.load())
+				{
+					mManager->mMusicUnderrunCount++;
+
+					const int queueLength = mManager->mMusicQueueLength.load();
+					if (queueLength < sMaxQueuedBuffers)
+					{
+						mManager->mMusicQueueLength.store(
+							std::min(queueLength + sQueueGrowth, sMaxQueuedBuffers));
+					}
 				}
 
 				/* Now start the sound source. */
 				alSourcePlay(mSource);
+				started = true;
 			}
 
 			ALint processed;
 			alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
 			if (processed == 0)
 			{
-				/* Wait until a buffer in the queue has been processed. */
+				/* Wait until a buffer in the queue has been processed. Blocks are
+				 * short enough that this has to wake up more often than once a
+				 * block.
+				 */
 				do {
-					std::this_thread::sleep_for(std::chrono::milliseconds(50));
+					std::this_thread::sleep_for(std::chrono::milliseconds(20));
 					if (mQuit.load()) break;
 					alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
 				} while (processed == 0);
@@ -222,19 +635,24 @@ private:
 			/* Remove processed buffers, then restart the loop to keep the
 			 * queue filled.
 			 */
-			while (processed > 0)
-			{
-				ALuint bufid;
-				alSourceUnqueueBuffers(mSource, 1, &bufid);
-				processed--;
-			}
+			unqueueProcessed();
 		}
 	}
 
+	/* Tells both threads to quit and waits for them to stop. */
+	void joinThreads()
+	{
+		mQuit.store(true);
+		if (mThread.get_id() != std::thread::id())
+			mThread.join();
+		if (mSynthThread.get_id() != std::thread::id())
+			mSynthThread.join();
+	}
+
 public:
 	OpenALStream(AudioManagerImpl *manager, MidiSong *song)
-		: mManager(manager), mSong(song), mQuit(false), mSource(0)
-		, mBufferIdx(0), mSampleRate(0)
+		: mManager(manager), mSong(song), mQuit(false), mSongEnded(false), mSource(0)
+		, mBufferIdx(0), mStarving(false), mSampleRate(0)
 	{
 		// Using std::array::fill() for mBuffers since VS2013 doesn't support mBuffers{0}.
 		mBuffers.fill(0);
@@ -242,12 +660,7 @@ public:
 
 	~OpenALStream()
 	{
-		if (mThread.get_id() != std::thread::id())
-		{
-			/* Tell the thread to quit and wait for it to stop. */
-			mQuit.store(true);
-			mThread.join();
-		}
+		joinThreads();
 		if (mSource)
 		{
 			/* Stop the source, remove the buffers, then put it back so it can
@@ -270,26 +683,26 @@ public:
 		{
 			if (!mQuit.load())
 				return;
-			mThread.join();
 		}
+		joinThreads();
 
 		/* Reset the source and clear any buffers that may be on it. */
 		alSourceRewind(mSource);
 		alSourcei(mSource, AL_BUFFER, 0);
 		mBufferIdx = 0;
+		mStarving = false;
+		mRing.clear();
 		mQuit.store(false);
+		mSongEnded.store(false);
 
 		/* Start the background thread processing. */
+		mSynthThread = std::thread(std::mem_fn(&OpenALStream::synthProc), this);
 		mThread = std::thread(std::mem_fn(&OpenALStream::backgroundProc), this);
 	}
 
 	void stop()
 	{
-		if (mThread.get_id() != std::thread::id())
-		{
-			mQuit.store(true);
-			mThread.join();
-		}
+		joinThreads();
 
 		alSourceRewind(mSource);
 		alSourcei(mSource, AL_BUFFER, 0);
@@ -337,18 +750,31 @@ public:
 		mFormat = AL_FORMAT_STEREO16;
 		mFrameSize = 4;
 		mSampleRate = srate;
+		mRing.resize(sRingBlocks, sBufferFrames * mFrameSize);
 
 		mSource = source;
 		return true;
 	}
+
+	static int getMinQueuedBuffers()
+	{
+		return sMinQueuedBuffers;
+	}
 };
 
 // Audio Manager Impl
 
 AudioManagerImpl::AudioManagerImpl()
-	: mMusicVolume(1.0f), mSfxVolume(1.0f), mHasResamplerExtension(false)
+	: mMusicVolume(1.0f), mSfxVolume(1.0f), mHasResamplerExtension(false),
+	mSoundLoadRate(0), mSoundLoad16Bit(false), mDeviceSampleRate(0), mCancelRender(false),
+	mMusicCacheBudget(0), mMusicPlayCount(0), mNextEmitterID(0), mMaxBoundEmitters(0),
+	mMusicUnderrunCount(0), mMusicStarvedCount(0),
+	mMusicQueueLength(OpenALStream::getMinQueuedBuffers())
 {
-
+	mSoundStats.playedCount = 0;
+	mSoundStats.droppedCount = 0;
+	mSoundStats.stolenCount = 0;
+	mSoundStats.culledCount = 0;
 }
 
 AudioManagerImpl::~AudioManagerImpl()
@@ -356,6 +782,26 @@ AudioManagerImpl::~AudioManagerImpl()
 	this->stopMusic();
 	this->stopSound();
 
+	// Don't leave a decode running past the VFS and OpenAL context.
+	if (mPendingSounds.valid())
+	{
+		mPendingSounds.wait();
+	}
+
+	if (mRenderingSong.valid())
+	{
+		mCancelRender.store(true);
+		mRenderingSong.wait();
+	}
+
+	DebugLog("Sounds played: " + std::to_string(mSoundStats.playedCount) +
+		", dropped: " + std::to_string(mSoundStats.droppedCount) +
+		", stolen: " + std::to_string(mSoundStats.stolenCount) +
+		", culled: " + std::to_string(mSoundStats.culledCount) + ".");
+	DebugLog("Music underruns: " + std::to_string(mMusicUnderrunCount.load()) +
+		", synth stalls: " + std::to_string(mMusicStarvedCount.load()) +
+		", queue length: " + std::to_string(mMusicQueueLength.load()) + ".");
+
 	MidiDevice::shutdown();
 
 	ALCcontext *context = alcGetCurrentContext();
@@ -426,162 +872,821 @@ bool AudioManagerImpl::soundIsPlaying(const std::string &filename) const
 {
 	// Check through used sources' filenames.
 	const auto iter = std::find_if(mUsedSources.begin(), mUsedSources.end(),
-		[&filename](const std::pair<std::string, ALuint> &pair)
+		[&filename](const Voice &voice)
 	{
-		return pair.first == filename;
+		return voice.filename == filename;
 	});
 
 	return iter != mUsedSources.end();
 }
 
-void AudioManagerImpl::init(double musicVolume, double soundVolume, int maxChannels,
-	int resamplingOption, const std::string &midiConfig)
+void AudioManagerImpl::resetSource(ALuint source)
 {
-	DebugLog("Initializing.");
+	alSourceStop(source);
+	alSourceRewind(source);
+	alSourcei(source, AL_BUFFER, 0);
+	alSourcef(source, AL_GAIN, mSfxVolume);
+	alSourcei(source, AL_LOOPING, AL_FALSE);
 
-#ifdef HAVE_WILDMIDI
-	WildMidiDevice::init(midiConfig);
-#endif
+	// Non-positional, in case an emitter had it.
+	alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+	alSource3f(source, AL_POSITION, 0.0f, 0.0f, 0.0f);
 
-	// Initialize the OpenAL device and context.
-	ALCdevice *device = alcOpenDevice(nullptr);
-	if (device == nullptr)
+	if (mHasResamplerExtension)
 	{
-		DebugLogWarning("alcOpenDevice() error " + std::to_string(alGetError()) + ".");
+		const ALint defaultResampler = AudioManagerImpl::getDefaultResampler();
+		alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, defaultResampler);
 	}
+}
 
-	ALCcontext *context = alcCreateContext(device, nullptr);
-	if (context == nullptr)
+bool AudioManagerImpl::decodeSound(const std::string &filename, int resampleRate,
+	bool use16Bit, DecodedSound *outSound)
+{
+	VOCFile voc;
+	if (!voc.init(filename.c_str()))
 	{
-		DebugLogWarning("alcCreateContext() error " + std::to_string(alGetError()) + ".");
+		return false;
 	}
 
-	const ALCboolean success = alcMakeContextCurrent(context);
-	if (success != AL_TRUE)
+	outSound->filename = filename;
+	if ((resampleRate > 0) && ((resampleRate != voc.getSampleRate()) || use16Bit))
 	{
-		DebugLogWarning("alcMakeContextCurrent() error " + std::to_string(alGetError()) + ".");
+		outSound->audioData = resampleSound(
+			voc.getAudioData(), voc.getSampleRate(), resampleRate, use16Bit);
+		outSound->sampleRate = resampleRate;
+		outSound->format = use16Bit ? AL_FORMAT_MONO16 : AL_FORMAT_MONO8;
+	}
+	else
+	{
+		outSound->audioData = voc.getAudioData();
+		outSound->sampleRate = voc.getSampleRate();
+		outSound->format = AL_FORMAT_MONO8;
 	}
 
-	// Check for sound resampling extension.
-	mHasResamplerExtension = alIsExtensionPresent("AL_SOFT_source_resampler") != AL_FALSE;
-	mResampler = mHasResamplerExtension ? 
-		AudioManagerImpl::getResamplingIndex(resamplingOption) :
-		AudioManagerImpl::UNSUPPORTED_EXTENSION;
+	return true;
+}
 
-	// Generate the sound sources.
-	for (int i = 0; i < maxChannels; i++)
+ALuint AudioManagerImpl::createBuffer(const DecodedSound &sound)
+{
+	// Clear OpenAL error.
+	alGetError();
+
+	ALuint bufferID;
+	alGenBuffers(1, &bufferID);
+
+	const ALenum status = alGetError();
+	if (status != AL_NO_ERROR)
 	{
-		ALuint source;
-		alGenSources(1, &source);
+		DebugLogWarning("alGenBuffers() error " + std::to_string(status) + ".");
+	}
 
-		const ALenum status = alGetError();
-		if (status != AL_NO_ERROR)
-		{
-			DebugLogWarning("alGenSources() error " + std::to_string(status) + ".");
-		}
+	alBufferData(bufferID, sound.format,
+		static_cast<const ALvoid*>(sound.audioData.data()),
+		static_cast<ALsizei>(sound.audioData.size()),
+		static_cast<ALsizei>(sound.sampleRate));
 
-		// Set resampling if the extension is supported.
-		if (mHasResamplerExtension)
+	return bufferID;
+}
+
+ALuint AudioManagerImpl::getSoundBuffer(const std::string &filename)
+{
+	// If it's being preloaded, wait for that instead of decoding it again.
+	if (mPendingSoundNames.find(filename) != mPendingSoundNames.end())
+	{
+		this->finishPendingSounds();
+	}
+
+	auto vocIter = mSoundBuffers.find(filename);
+
+	if (vocIter == mSoundBuffers.end())
+	{
+		// Load the .VOC file and give its PCM data to a new OpenAL buffer.
+		DecodedSound sound;
+		if (!AudioManagerImpl::decodeSound(filename, mSoundLoadRate, mSoundLoad16Bit, &sound))
 		{
-			alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
+			DebugCrash("Could not init .VOC file \"" + filename + "\".");
 		}
 
-		mFreeSources.push_back(source);
+		const ALuint bufferID = AudioManagerImpl::createBuffer(sound);
+		vocIter = mSoundBuffers.insert(std::make_pair(filename, bufferID)).first;
 	}
 
-	this->setMusicVolume(musicVolume);
-	this->setSoundVolume(soundVolume);
+	return vocIter->second;
 }
 
-void AudioManagerImpl::playMusic(const std::string &filename)
+void AudioManagerImpl::finishPendingSounds()
 {
-	stopMusic();
+	if (!mPendingSounds.valid())
+	{
+		return;
+	}
 
-	if (!mFreeSources.empty())
+	const std::vector<DecodedSound> decodedSounds = mPendingSounds.get();
+	for (const DecodedSound &sound : decodedSounds)
 	{
-		if (MidiDevice::isInited())
-			mCurrentSong = MidiDevice::get().open(filename);
-		if (!mCurrentSong)
+		// Might have been loaded by playSound() in the meantime.
+		if (mSoundBuffers.find(sound.filename) == mSoundBuffers.end())
 		{
-			DebugLogWarning("Failed to play " + filename + ".");
-			return;
+			const ALuint bufferID = AudioManagerImpl::createBuffer(sound);
+			mSoundBuffers.insert(std::make_pair(sound.filename, bufferID));
 		}
+	}
 
-		mSongStream = std::make_unique<OpenALStream>(this, mCurrentSong.get());
-		if (mSongStream->init(mFreeSources.front(), mMusicVolume))
+	mPendingSoundNames.clear();
+}
+
+std::shared_ptr<RenderedSong> AudioManagerImpl::renderSong(const std::string &filename,
+	size_t maxBytes, const std::atomic<bool> &cancel)
+{
+	ProfilerZone("Render song");
+
+	// A separate instance from the one playing, so the two don't share read positions.
+	MidiSongPtr song = MidiDevice::get().open(filename);
+	if (!song)
+	{
+		return nullptr;
+	}
+
+	auto renderedSong = std::make_shared<RenderedSong>();
+	song->getFormat(&renderedSong->sampleRate);
+
+	const size_t frameSize = 4;
+	const size_t chunkFrames = 8192;
+	std::vector<char> chunk(chunkFrames * frameSize);
+	while (!cancel.load())
+	{
+		const size_t frameCount = song->read(chunk.data(), chunkFrames);
+		renderedSong->pcm.insert(renderedSong->pcm.end(), chunk.begin(),
+			chunk.begin() + (frameCount * frameSize));
+
+		if (renderedSong->pcm.size() > maxBytes)
 		{
-			mFreeSources.pop_front();
-			mSongStream->play();
-			DebugLog("Playing music " + filename + ".");
+			DebugLogWarning(filename + " is too long for the music cache.");
+			return nullptr;
 		}
-		else
+
+		if (frameCount < chunkFrames)
 		{
-			DebugLogWarning("Failed to init " + filename + " stream.");
+			renderedSong->pcm.shrink_to_fit();
+			return renderedSong;
 		}
 	}
+
+	return nullptr;
 }
 
-void AudioManagerImpl::playSound(const std::string &filename)
+void AudioManagerImpl::requestRenderedSong(const std::string &filename)
 {
-	// Certain sounds (like DRUMS.VOC) should only have one live instance at a time.
-	// This is purely an arbitrary rule to avoid having long sounds overlap each other
-	// which would ultimately be very annoying and/or distracting for the player.
-	const bool isSingleInstance =
-		SingleInstanceSounds.find(filename) != SingleInstanceSounds.end();
-	const bool allowedToPlay = !isSingleInstance ||
-		(isSingleInstance && !this->soundIsPlaying(filename));
+	if ((mMusicCacheBudget == 0) || mRenderingSong.valid())
+	{
+		return;
+	}
+
+	mRenderingSongName = filename;
+	const size_t budget = mMusicCacheBudget;
+	const std::atomic<bool> *cancel = &mCancelRender;
+	mRenderingSong = JobSystem::submit(JobSystem::Priority::Background,
+		[filename, budget, cancel]()
+	{
+		return AudioManagerImpl::renderSong(filename, budget, *cancel);
+	});
+}
+
+void AudioManagerImpl::finishRenderedSong()
+{
+	if (!mRenderingSong.valid())
+	{
+		return;
+	}
+
+	std::shared_ptr<RenderedSong> renderedSong = mRenderingSong.get();
+	if (renderedSong != nullptr)
+	{
+		// Not counted as played yet, so it's the first to go if space is short.
+		CachedSong cachedSong;
+		cachedSong.song = std::move(renderedSong);
+		cachedSong.lastPlayed = 0;
+		mRenderedSongs.insert(std::make_pair(mRenderingSongName, std::move(cachedSong)));
+		this->evictRenderedSongs();
+	}
+
+	mRenderingSongName.clear();
+}
+
+void AudioManagerImpl::evictRenderedSongs()
+{
+	auto getUsedBytes = [this]()
+	{
+		size_t byteCount = 0;
+		for (const auto &pair : mRenderedSongs)
+		{
+			byteCount += pair.second.song->pcm.size();
+		}
+
+		return byteCount;
+	};
+
+	// A stream still playing an evicted song keeps its own reference to the samples.
+	while (!mRenderedSongs.empty() && (getUsedBytes() > mMusicCacheBudget))
+	{
+		auto oldestIter = mRenderedSongs.begin();
+		for (auto iter = mRenderedSongs.begin(); iter != mRenderedSongs.end(); ++iter)
+		{
+			if (iter->second.lastPlayed < oldestIter->second.lastPlayed)
+			{
+				oldestIter = iter;
+			}
+		}
+
+		mRenderedSongs.erase(oldestIter);
+	}
+}
+
+size_t AudioManagerImpl::findVoiceToSteal(AudioManager::SoundPriority priority) const
+{
+	// Oldest voices are at the back, so search from there to prefer them on ties.
+	size_t bestIndex = mUsedSources.size();
+	for (size_t i = mUsedSources.size(); i-- > 0;)
+	{
+		const Voice &voice = mUsedSources[i];
+		if (voice.priority > priority)
+		{
+			continue;
+		}
+
+		if (bestIndex == mUsedSources.size())
+		{
+			bestIndex = i;
+			continue;
+		}
+
+		const Voice &bestVoice = mUsedSources[bestIndex];
+		if ((voice.priority < bestVoice.priority) ||
+			((voice.priority == bestVoice.priority) && (voice.volume < bestVoice.volume)))
+		{
+			bestIndex = i;
+		}
+	}
+
+	return bestIndex;
+}
+
+void AudioManagerImpl::unbindEmitter(Emitter &emitter)
+{
+	DebugAssert(emitter.bound);
 
-	if (!mFreeSources.empty() && allowedToPlay)
+	if (emitter.looping)
 	{
-		auto vocIter = mSoundBuffers.find(filename);
+		alGetSourcei(emitter.source, AL_SAMPLE_OFFSET, &emitter.sampleOffset);
+	}
+
+	this->resetSource(emitter.source);
+	mFreeSources.push_front(emitter.source);
+	emitter.bound = false;
+}
 
-		if (vocIter == mSoundBuffers.end())
+void AudioManagerImpl::updateEmitters()
+{
+	// Remove one-shot emitters that are done, and get how loud the rest are from here.
+	std::vector<Emitter*> audibleEmitters;
+	for (auto iter = mEmitters.begin(); iter != mEmitters.end();)
+	{
+		Emitter &emitter = iter->second;
+		if (emitter.bound && !emitter.looping)
 		{
-			// Load the .VOC file and give its PCM data to a new OpenAL buffer.
-			VOCFile voc;
-			if (!voc.init(filename.c_str()))
+			ALint state;
+			alGetSourcei(emitter.source, AL_SOURCE_STATE, &state);
+
+			if (state == AL_STOPPED)
 			{
-				DebugCrash("Could not init .VOC file \"" + filename + "\".");
+				this->unbindEmitter(emitter);
+				iter = mEmitters.erase(iter);
+				continue;
 			}
+		}
 
-			// Clear OpenAL error.
-			alGetError();
+		const double distance = (emitter.position - mListenerPosition).length();
+		const double falloff =
+			std::max(0.0, 1.0 - (distance / AudioManager::MAX_EMITTER_DISTANCE));
+		emitter.gain = mSfxVolume * emitter.volume * static_cast<float>(falloff) *
+			(emitter.occluded ? OccludedGain : 1.0f);
 
-			ALuint bufferID;
-			alGenBuffers(1, &bufferID);
+		if (emitter.gain >= MinAudibleGain)
+		{
+			audibleEmitters.push_back(&emitter);
+		}
+		else
+		{
+			emitter.gain = 0.0f;
 
-			const ALenum status = alGetError();
-			if (status != AL_NO_ERROR)
+			// A one-shot sound only gets one chance to be heard.
+			if (!emitter.looping && !emitter.started)
 			{
-				DebugLogWarning("alGenBuffers() error " + std::to_string(status) + ".");
+				mSoundStats.culledCount++;
+				iter = mEmitters.erase(iter);
+				continue;
 			}
+		}
 
-			const std::vector<uint8_t> &audioData = voc.getAudioData();
+		++iter;
+	}
 
-			alBufferData(bufferID, AL_FORMAT_MONO8,
-				static_cast<const ALvoid*>(audioData.data()),
-				static_cast<ALsizei>(audioData.size()),
-				static_cast<ALsizei>(voc.getSampleRate()));
+	// Only the loudest emitters get sources, with priority taking precedence like it does
+	// for other sounds.
+	std::sort(audibleEmitters.begin(), audibleEmitters.end(),
+		[](const Emitter *a, const Emitter *b)
+	{
+		if (a->priority != b->priority)
+		{
+			return a->priority > b->priority;
+		}
+
+		return a->gain > b->gain;
+	});
 
-			vocIter = mSoundBuffers.insert(std::make_pair(filename, bufferID)).first;
+	for (size_t i = mMaxBoundEmitters; i < audibleEmitters.size(); i++)
+	{
+		audibleEmitters[i]->gain = 0.0f;
+	}
+
+	audibleEmitters.resize(std::min(audibleEmitters.size(), mMaxBoundEmitters));
+
+	// Free sources first so they can go to the emitters that replace them.
+	for (auto &pair : mEmitters)
+	{
+		Emitter &emitter = pair.second;
+		if (emitter.bound && (emitter.gain == 0.0f))
+		{
+			this->unbindEmitter(emitter);
+
+			if (!emitter.looping)
+			{
+				mSoundStats.stolenCount++;
+			}
+		}
+	}
+
+	std::vector<ALuint> startedSources;
+	for (Emitter *emitter : audibleEmitters)
+	{
+		if (emitter->bound)
+		{
+			continue;
+		}
+
+		if (mFreeSources.empty())
+		{
+			// Every channel is busy with non-positional sounds. Looping emitters try again
+			// next frame.
+			if (!emitter->looping && !emitter->started)
+			{
+				mSoundStats.droppedCount++;
+				emitter->started = true;
+			}
+
+			continue;
 		}
 
-		// Set up the sound source.
 		const ALuint source = mFreeSources.front();
-		alSourcei(source, AL_BUFFER, vocIter->second);
+		mFreeSources.pop_front();
+
+		alSourcei(source, AL_BUFFER, this->getSoundBuffer(emitter->filename));
+		alSourcei(source, AL_SOURCE_RELATIVE, AL_FALSE);
+		alSourcei(source, AL_LOOPING, emitter->looping ? AL_TRUE : AL_FALSE);
+		alSourcei(source, AL_SAMPLE_OFFSET, emitter->sampleOffset);
+
+		if (mHasResamplerExtension)
+		{
+			alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
+		}
+
+		if (!emitter->started)
+		{
+			mSoundStats.playedCount++;
+		}
+
+		emitter->source = source;
+		emitter->bound = true;
+		emitter->started = true;
+		startedSources.push_back(source);
+	}
+
+	// One-shot emitters that lost their source don't come back.
+	for (auto iter = mEmitters.begin(); iter != mEmitters.end();)
+	{
+		const Emitter &emitter = iter->second;
+		if (!emitter.looping && emitter.started && !emitter.bound)
+		{
+			iter = mEmitters.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	// Send this frame's listener and source changes together so the mixer doesn't apply
+	// half of them.
+	ALCcontext *context = alcGetCurrentContext();
+	alcSuspendContext(context);
+
+	const ALfloat orientation[] =
+	{
+		static_cast<ALfloat>(mListenerDirection.x),
+		static_cast<ALfloat>(mListenerDirection.y),
+		static_cast<ALfloat>(mListenerDirection.z),
+		0.0f, 1.0f, 0.0f
+	};
+
+	alListener3f(AL_POSITION, static_cast<ALfloat>(mListenerPosition.x),
+		static_cast<ALfloat>(mListenerPosition.y), static_cast<ALfloat>(mListenerPosition.z));
+	alListenerfv(AL_ORIENTATION, orientation);
+
+	for (const Emitter *emitter : audibleEmitters)
+	{
+		if (emitter->bound)
+		{
+			alSource3f(emitter->source, AL_POSITION, static_cast<ALfloat>(emitter->position.x),
+				static_cast<ALfloat>(emitter->position.y),
+				static_cast<ALfloat>(emitter->position.z));
+			alSourcef(emitter->source, AL_GAIN, emitter->gain);
+		}
+	}
+
+	if (!startedSources.empty())
+	{
+		alSourcePlayv(static_cast<ALsizei>(startedSources.size()), startedSources.data());
+	}
+
+	alcProcessContext(context);
+}
+
+void AudioManagerImpl::init(double musicVolume, double soundVolume, int maxChannels,
+	int resamplingOption, const std::string &midiConfig)
+{
+	DebugLog("Initializing.");
+
+#ifdef HAVE_WILDMIDI
+	WildMidiDevice::init(midiConfig);
+#endif
+
+	// Initialize the OpenAL device and context.
+	ALCdevice *device = alcOpenDevice(nullptr);
+	if (device == nullptr)
+	{
+		DebugLogWarning("alcOpenDevice() error " + std::to_string(alGetError()) + ".");
+	}
+
+	ALCcontext *context = alcCreateContext(device, nullptr);
+	if (context == nullptr)
+	{
+		DebugLogWarning("alcCreateContext() error " + std::to_string(alGetError()) + ".");
+	}
+
+	const ALCboolean success = alcMakeContextCurrent(context);
+	if (success != AL_TRUE)
+	{
+		DebugLogWarning("alcMakeContextCurrent() error " + std::to_string(alGetError()) + ".");
+	}
+
+	// The rate the device mixes at, for resampling sounds to when they're loaded.
+	ALCint deviceSampleRate = 0;
+	if (device != nullptr)
+	{
+		alcGetIntegerv(device, ALC_FREQUENCY, 1, &deviceSampleRate);
+	}
+
+	mDeviceSampleRate = deviceSampleRate;
+
+	// Check for sound resampling extension.
+	mHasResamplerExtension = alIsExtensionPresent("AL_SOFT_source_resampler") != AL_FALSE;
+	mResampler = mHasResamplerExtension ? 
+		AudioManagerImpl::getResamplingIndex(resamplingOption) :
+		AudioManagerImpl::UNSUPPORTED_EXTENSION;
+
+	// Emitter falloff is done by the gain so culling can use the same number.
+	alDistanceModel(AL_NONE);
+	mListenerPosition = Double3::Zero;
+	mListenerDirection = Double3::UnitX;
+
+	// Generate the sound sources.
+	for (int i = 0; i < maxChannels; i++)
+	{
+		ALuint source;
+		alGenSources(1, &source);
+
+		const ALenum status = alGetError();
+		if (status != AL_NO_ERROR)
+		{
+			DebugLogWarning("alGenSources() error " + std::to_string(status) + ".");
+		}
 
 		// Set resampling if the extension is supported.
 		if (mHasResamplerExtension)
 		{
 			alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
-		}		
+		}
 
-		// Play the sound.
-		alSourcePlay(source);
+		alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+		mFreeSources.push_back(source);
+	}
 
-		mUsedSources.push_front(std::make_pair(filename, source));
-		mFreeSources.pop_front();
+	// Half of the channels at most, so emitters can't crowd out the player's own sounds.
+	mMaxBoundEmitters = std::max<size_t>(1, mFreeSources.size() / 2);
+
+	this->setMusicVolume(musicVolume);
+	this->setSoundVolume(soundVolume);
+}
+
+void AudioManagerImpl::playMusic(const std::string &filename)
+{
+	stopMusic();
+
+	if (!mFreeSources.empty())
+	{
+		// Play from the music cache if the song has been rendered, otherwise synthesize
+		// it while playing and render it for next time.
+		const auto cacheIter = mRenderedSongs.find(filename);
+		if (cacheIter != mRenderedSongs.end())
+		{
+			mMusicPlayCount++;
+			cacheIter->second.lastPlayed = mMusicPlayCount;
+			mCurrentSong = std::make_unique<RenderedMidiSong>(cacheIter->second.song);
+		}
+		else if (MidiDevice::isInited())
+		{
+			mCurrentSong = MidiDevice::get().open(filename);
+			if (mCurrentSong)
+			{
+				this->requestRenderedSong(filename);
+			}
+		}
+
+		if (!mCurrentSong)
+		{
+			DebugLogWarning("Failed to play " + filename + ".");
+			return;
+		}
+
+		mSongStream = std::make_unique<OpenALStream>(this, mCurrentSong.get());
+		if (mSongStream->init(mFreeSources.front(), mMusicVolume))
+		{
+			mFreeSources.pop_front();
+			mSongStream->play();
+			DebugLog("Playing music " + filename + ".");
+		}
+		else
+		{
+			DebugLogWarning("Failed to init " + filename + " stream.");
+		}
+	}
+}
+
+void AudioManagerImpl::playSound(const std::string &filename,
+	AudioManager::SoundPriority priority, double volumePercent)
+{
+	// Certain sounds (like DRUMS.VOC) should only have one live instance at a time.
+	// This is purely an arbitrary rule to avoid having long sounds overlap each other
+	// which would ultimately be very annoying and/or distracting for the player.
+	const bool isSingleInstance =
+		SingleInstanceSounds.find(filename) != SingleInstanceSounds.end();
+	const bool allowedToPlay = !isSingleInstance ||
+		(isSingleInstance && !this->soundIsPlaying(filename));
+
+	if (!allowedToPlay)
+	{
+		return;
+	}
+
+	// Don't take a channel for something that can't be heard.
+	const float volume = static_cast<float>(volumePercent);
+	if ((volume * mSfxVolume) < MinAudibleGain)
+	{
+		mSoundStats.culledCount++;
+		return;
+	}
+
+	// If every channel is busy, cut off the least important sound unless they all matter
+	// more than this one.
+	if (mFreeSources.empty())
+	{
+		const size_t stealIndex = this->findVoiceToSteal(priority);
+		if (stealIndex == mUsedSources.size())
+		{
+			mSoundStats.droppedCount++;
+			return;
+		}
+
+		const ALuint stolenSource = mUsedSources[stealIndex].source;
+		this->resetSource(stolenSource);
+		mUsedSources.erase(mUsedSources.begin() + stealIndex);
+		mFreeSources.push_front(stolenSource);
+		mSoundStats.stolenCount++;
+	}
+
+	// Set up the sound source.
+	const ALuint source = mFreeSources.front();
+	alSourcei(source, AL_BUFFER, this->getSoundBuffer(filename));
+	alSourcef(source, AL_GAIN, mSfxVolume * volume);
+
+	// Set resampling if the extension is supported.
+	if (mHasResamplerExtension)
+	{
+		alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
+	}
+
+	// Play the sound.
+	alSourcePlay(source);
+
+	Voice voice;
+	voice.filename = filename;
+	voice.source = source;
+	voice.priority = priority;
+	voice.volume = volume;
+	mUsedSources.push_front(std::move(voice));
+	mFreeSources.pop_front();
+	mSoundStats.playedCount++;
+}
+
+int AudioManagerImpl::addEmitter(const std::string &filename, const Double3 &position,
+	AudioManager::SoundPriority priority, double volumePercent, bool looping)
+{
+	// Sources are given out by update() once the emitter's gain is known.
+	Emitter emitter;
+	emitter.filename = filename;
+	emitter.position = position;
+	emitter.priority = priority;
+	emitter.volume = static_cast<float>(volumePercent);
+	emitter.gain = 0.0f;
+	emitter.looping = looping;
+	emitter.occluded = false;
+	emitter.started = false;
+	emitter.bound = false;
+	emitter.source = 0;
+	emitter.sampleOffset = 0;
+
+	const int id = mNextEmitterID;
+	mNextEmitterID++;
+	mEmitters.insert(std::make_pair(id, std::move(emitter)));
+	return id;
+}
+
+void AudioManagerImpl::setEmitterPosition(int id, const Double3 &position)
+{
+	const auto iter = mEmitters.find(id);
+	if (iter != mEmitters.end())
+	{
+		iter->second.position = position;
+	}
+}
+
+void AudioManagerImpl::removeEmitter(int id)
+{
+	const auto iter = mEmitters.find(id);
+	if (iter == mEmitters.end())
+	{
+		return;
+	}
+
+	if (iter->second.bound)
+	{
+		this->unbindEmitter(iter->second);
+	}
+
+	mEmitters.erase(iter);
+}
+
+void AudioManagerImpl::setListener(const Double3 &position, const Double3 &direction)
+{
+	mListenerPosition = position;
+	mListenerDirection = direction;
+}
+
+void AudioManagerImpl::updateEmitterOcclusion(double ceilingHeight, const VoxelGrid &voxelGrid)
+{
+	// One ray from the listener to each emitter in hearing range. An emitter is occluded if
+	// the ray hits a voxel before reaching the emitter's own voxel (i.e., a door's sound
+	// isn't blocked by the door).
+	std::vector<Physics::Ray> rays;
+	std::vector<Emitter*> rayEmitters;
+	for (auto &pair : mEmitters)
+	{
+		Emitter &emitter = pair.second;
+		emitter.occluded = false;
+
+		const Double3 diff = emitter.position - mListenerPosition;
+		const double distance = diff.length();
+		if ((distance <= 0.0) || (distance >= AudioManager::MAX_EMITTER_DISTANCE))
+		{
+			continue;
+		}
+
+		const double distanceXZ = std::sqrt((diff.x * diff.x) + (diff.z * diff.z));
+		rays.push_back(Physics::Ray(mListenerPosition, diff / distance, distanceXZ));
+		rayEmitters.push_back(&emitter);
+	}
+
+	if (rays.empty())
+	{
+		return;
+	}
+
+	std::vector<Physics::Hit> hits(rays.size());
+	Physics::rayCast(rays.data(), static_cast<int>(rays.size()), ceilingHeight, voxelGrid,
+		hits.data());
+
+	for (size_t i = 0; i < hits.size(); i++)
+	{
+		const Physics::Hit &hit = hits[i];
+		if (!std::isfinite(hit.t))
+		{
+			continue;
+		}
+
+		Emitter &emitter = *rayEmitters[i];
+		const Int3 emitterVoxel(
+			static_cast<int>(std::floor(emitter.position.x)),
+			static_cast<int>(std::floor(emitter.position.y / ceilingHeight)),
+			static_cast<int>(std::floor(emitter.position.z)));
+		emitter.occluded = hit.voxel != emitterVoxel;
+	}
+}
+
+void AudioManagerImpl::preloadSounds(const std::vector<std::string> &filenames)
+{
+	// Only one batch is decoded at a time.
+	this->finishPendingSounds();
+
+	const std::unordered_set<std::string> wantedSounds(filenames.begin(), filenames.end());
+
+	// Free the previous preload's sounds that are no longer wanted. Ones still playing are
+	// kept until a later preload since their buffers can't be deleted while attached.
+	std::unordered_set<std::string> keptSounds;
+	for (const std::string &filename : mPreloadedSounds)
+	{
+		if (wantedSounds.find(filename) != wantedSounds.end())
+		{
+			continue;
+		}
+
+		if (this->soundIsPlaying(filename))
+		{
+			keptSounds.insert(filename);
+			continue;
+		}
+
+		const auto bufferIter = mSoundBuffers.find(filename);
+		if (bufferIter != mSoundBuffers.end())
+		{
+			ALuint bufferID = bufferIter->second;
+			alDeleteBuffers(1, &bufferID);
+			mSoundBuffers.erase(bufferIter);
+		}
 	}
+
+	mPreloadedSounds = wantedSounds;
+	mPreloadedSounds.insert(keptSounds.begin(), keptSounds.end());
+
+	std::vector<std::string> decodeFilenames;
+	for (const std::string &filename : wantedSounds)
+	{
+		if (mSoundBuffers.find(filename) == mSoundBuffers.end())
+		{
+			decodeFilenames.push_back(filename);
+			mPendingSoundNames.insert(filename);
+		}
+	}
+
+	if (decodeFilenames.empty())
+	{
+		return;
+	}
+
+	// Decoding reads through the VFS, which is safe from any thread. The OpenAL buffers
+	// are made on this thread.
+	const int resampleRate = mSoundLoadRate;
+	const bool use16Bit = mSoundLoad16Bit;
+	mPendingSounds = JobSystem::submit(JobSystem::Priority::Streaming,
+		[decodeFilenames, resampleRate, use16Bit]()
+	{
+		ProfilerZone("Decode sounds");
+
+		std::vector<DecodedSound> decodedSounds;
+		for (const std::string &filename : decodeFilenames)
+		{
+			DecodedSound sound;
+			if (!AudioManagerImpl::decodeSound(filename, resampleRate, use16Bit, &sound))
+			{
+				// Leave it for playSound() to report.
+				DebugLogWarning("Could not preload .VOC file \"" + filename + "\".");
+				continue;
+			}
+
+			decodedSounds.push_back(std::move(sound));
+		}
+
+		return decodedSounds;
+	});
 }
 
 void AudioManagerImpl::stopMusic()
@@ -598,23 +1703,23 @@ void AudioManagerImpl::stopMusic()
 void AudioManagerImpl::stopSound()
 {
 	// Reset all used sources and return them to the free sources.
-	for (const auto &pair : mUsedSources)
+	for (const Voice &voice : mUsedSources)
 	{
-		const ALuint source = pair.second;
-		alSourceStop(source);
-		alSourceRewind(source);
-		alSourcei(source, AL_BUFFER, 0);
+		this->resetSource(voice.source);
+		mFreeSources.push_front(voice.source);
+	}
 
-		if (mHasResamplerExtension)
+	mUsedSources.clear();
+
+	for (auto &pair : mEmitters)
+	{
+		if (pair.second.bound)
 		{
-			const ALint defaultResampler = AudioManagerImpl::getDefaultResampler();
-			alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, defaultResampler);
+			this->unbindEmitter(pair.second);
 		}
-
-		mFreeSources.push_front(source);
 	}
 
-	mUsedSources.clear();
+	mEmitters.clear();
 }
 
 void AudioManagerImpl::setMusicVolume(double percent)
@@ -637,10 +1742,9 @@ void AudioManagerImpl::setSoundVolume(double percent)
 		alSourcef(source, AL_GAIN, mSfxVolume);
 	}
 
-	for (const auto &pair : mUsedSources)
+	for (const Voice &voice : mUsedSources)
 	{
-		const ALuint source = pair.second;
-		alSourcef(source, AL_GAIN, mSfxVolume);
+		alSourcef(voice.source, AL_GAIN, mSfxVolume * voice.volume);
 	}
 }
 
@@ -658,37 +1762,75 @@ void AudioManagerImpl::setResamplingOption(int resamplingOption)
 		alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
 	}
 
-	for (const auto &pair : mUsedSources)
+	for (const Voice &voice : mUsedSources)
 	{
-		const ALuint source = pair.second;
-		alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
+		alSourcei(voice.source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
 	}
+
+	for (const auto &pair : mEmitters)
+	{
+		if (pair.second.bound)
+		{
+			alSourcei(pair.second.source, AL_SOURCE_RESAMPLER_SOFT, mResampler);
+		}
+	}
+}
+
+void AudioManagerImpl::setMusicCacheBudget(size_t bytes)
+{
+	mMusicCacheBudget = bytes;
+	this->evictRenderedSongs();
+}
+
+void AudioManagerImpl::setSoundLoadResampling(int mode)
+{
+	// Sounds already loaded keep their format.
+	mSoundLoadRate = (mode > 0) ? mDeviceSampleRate : 0;
+	mSoundLoad16Bit = mode == 2;
 }
 
 void AudioManagerImpl::update()
 {
+	ProfilerZone("Audio update");
+
+	// Cache the song rendered for next time once it's done.
+	if (mRenderingSong.valid() &&
+		(mRenderingSong.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+	{
+		this->finishRenderedSong();
+	}
+
+	// Upload preloaded sounds once they're decoded.
+	if (mPendingSounds.valid() &&
+		(mPendingSounds.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+	{
+		this->finishPendingSounds();
+	}
+
 	// If a sound source is done, reset it and return the ID to the free sources.
-	for (size_t i = 0; i < mUsedSources.size(); i++)
+	size_t i = 0;
+	while (i < mUsedSources.size())
 	{
-		const ALuint source = mUsedSources[i].second;
+		const ALuint source = mUsedSources[i].source;
 
 		ALint state;
 		alGetSourcei(source, AL_SOURCE_STATE, &state);
 
 		if (state == AL_STOPPED)
 		{
-			alSourceRewind(source);
-			alSourcei(source, AL_BUFFER, 0);
-
-			if (mHasResamplerExtension)
-			{
-				const ALint defaultResampler = AudioManagerImpl::getDefaultResampler();
-				alSourcei(source, AL_SOURCE_RESAMPLER_SOFT, defaultResampler);
-			}
-
+			this->resetSource(source);
 			mFreeSources.push_front(source);
 			mUsedSources.erase(mUsedSources.begin() + i);
 		}
+		else
+		{
+			i++;
+		}
+	}
+
+	if (!mEmitters.empty())
+	{
+		this->updateEmitters();
 	}
 }
 
@@ -696,6 +1838,7 @@ void AudioManagerImpl::update()
 
 const double AudioManager::MIN_VOLUME = 0.0;
 const double AudioManager::MAX_VOLUME = 1.0;
+const double AudioManager::MAX_EMITTER_DISTANCE = 16.0;
 
 AudioManager::AudioManager()
 	: pImpl(std::make_unique<AudioManagerImpl>()) { }
@@ -721,6 +1864,42 @@ double AudioManager::getSoundVolume() const
 	return static_cast<double>(pImpl->mSfxVolume);
 }
 
+const AudioManager::SoundStats &AudioManager::getSoundStats() const
+{
+	return pImpl->mSoundStats;
+}
+
+AudioManager::MusicStats AudioManager::getMusicStats() const
+{
+	MusicStats stats;
+	stats.underrunCount = pImpl->mMusicUnderrunCount.load();
+	stats.starvedCount = pImpl->mMusicStarvedCount.load();
+	stats.queuedBufferCount = pImpl->mMusicQueueLength.load();
+	stats.cachedSongCount = static_cast<int>(pImpl->mRenderedSongs.size());
+	return stats;
+}
+
+void AudioManager::reportMemory(MemoryReport &report) const
+{
+	// Sound samples live in OpenAL, so it's asked for their sizes.
+	size_t soundBytes = 0;
+	for (const auto &pair : pImpl->mSoundBuffers)
+	{
+		ALint size = 0;
+		alGetBufferi(pair.second, AL_SIZE, &size);
+		soundBytes += static_cast<size_t>(std::max(size, 0));
+	}
+
+	size_t songBytes = 0;
+	for (const auto &pair : pImpl->mRenderedSongs)
+	{
+		songBytes += MemoryReport::getVectorBytes(pair.second.song->pcm);
+	}
+
+	report.add("Audio/Sound buffers", soundBytes);
+	report.add("Audio/Music cache", songBytes);
+}
+
 bool AudioManager::hasResamplerExtension() const
 {
 	return pImpl->mHasResamplerExtension;
@@ -731,9 +1910,51 @@ void AudioManager::playMusic(const std::string &filename)
 	pImpl->playMusic(filename);
 }
 
+void AudioManager::playSound(const std::string &filename, SoundPriority priority,
+	double volumePercent)
+{
+	pImpl->playSound(filename, priority, volumePercent);
+}
+
+void AudioManager::playSound(const std::string &filename, SoundPriority priority)
+{
+	this->playSound(filename, priority, 1.0);
+}
+
 void AudioManager::playSound(const std::string &filename)
 {
-	pImpl->playSound(filename);
+	this->playSound(filename, SoundPriority::Normal);
+}
+
+void AudioManager::preloadSounds(const std::vector<std::string> &filenames)
+{
+	pImpl->preloadSounds(filenames);
+}
+
+int AudioManager::addEmitter(const std::string &filename, const Double3 &position,
+	SoundPriority priority, double volumePercent, bool looping)
+{
+	return pImpl->addEmitter(filename, position, priority, volumePercent, looping);
+}
+
+void AudioManager::setEmitterPosition(int id, const Double3 &position)
+{
+	pImpl->setEmitterPosition(id, position);
+}
+
+void AudioManager::removeEmitter(int id)
+{
+	pImpl->removeEmitter(id);
+}
+
+void AudioManager::setListener(const Double3 &position, const Double3 &direction)
+{
+	pImpl->setListener(position, direction);
+}
+
+void AudioManager::updateEmitterOcclusion(double ceilingHeight, const VoxelGrid &voxelGrid)
+{
+	pImpl->updateEmitterOcclusion(ceilingHeight, voxelGrid);
 }
 
 void AudioManager::stopMusic()
@@ -761,6 +1982,16 @@ void AudioManager::setResamplingOption(int resamplingOption)
 	pImpl->setResamplingOption(resamplingOption);
 }
 
+void AudioManager::setMusicCacheBudget(size_t bytes)
+{
+	pImpl->setMusicCacheBudget(bytes);
+}
+
+void AudioManager::setSoundLoadResampling(int mode)
+{
+	pImpl->setSoundLoadResampling(mode);
+}
+
 void AudioManager::update()
 {
 	pImpl->update();
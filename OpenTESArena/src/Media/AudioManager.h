@@ -1,16 +1,49 @@
 #ifndef AUDIO_MANAGER_H
 #define AUDIO_MANAGER_H
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include "../Math/Vector3.h"
 
 // This class manages what sounds and music are played by OpenAL Soft.
 
 class AudioManagerImpl;
+class MemoryReport;
 class Options;
+class VoxelGrid;
 
 class AudioManager
 {
+public:
+	// How much a sound matters when there are more sounds than channels. A sound can take
+	// the channel of a playing sound with the same or lower priority.
+	enum class SoundPriority
+	{
+		Low, // Ambient sounds the player didn't cause (i.e., doors closing by themselves).
+		Normal,
+		High // Direct results of player actions.
+	};
+
+	// Counts since startup, for tuning the channel count.
+	struct SoundStats
+	{
+		int playedCount; // Got a channel.
+		int droppedCount; // No channel with low enough priority was free.
+		int stolenCount; // Cut off for a higher priority sound.
+		int culledCount; // Too quiet to be worth a channel.
+	};
+
+	// Music stream counts since startup.
+	struct MusicStats
+	{
+		int underrunCount; // The source ran out of queued audio and had to restart.
+		int starvedCount; // Synthesis fell behind what the source wanted queued.
+		int queuedBufferCount; // Buffers currently kept queued (grows after underruns).
+		int cachedSongCount; // Songs rendered ahead of time.
+	};
 private:
 	std::unique_ptr<AudioManagerImpl> pImpl;
 public:
@@ -23,8 +56,16 @@ public:
 	static const double MIN_VOLUME;
 	static const double MAX_VOLUME;
 
+	// Distance (in voxels) past which emitters can't be heard.
+	static const double MAX_EMITTER_DISTANCE;
+
 	double getMusicVolume() const;
 	double getSoundVolume() const;
+	const SoundStats &getSoundStats() const;
+	MusicStats getMusicStats() const;
+
+	// Adds the bytes of loaded sounds and cached songs to the report.
+	void reportMemory(MemoryReport &report) const;
 
 	// Returns whether the implementation supports resampling options.
 	bool hasResamplerExtension() const;
@@ -32,13 +73,43 @@ public:
 	// Plays a music file. All music should loop until changed.
 	void playMusic(const std::string &filename);
 
-	// Plays a sound file. All sounds should play once.
+	// Plays a sound file. All sounds should play once. The volume percent scales the
+	// sound volume for this sound, i.e., for distance falloff.
+	void playSound(const std::string &filename, SoundPriority priority, double volumePercent);
+	void playSound(const std::string &filename, SoundPriority priority);
 	void playSound(const std::string &filename);
 
+	// Adds a sound in the world and returns its emitter ID. Emitters fade with distance
+	// from the listener and are quieter when voxels are in the way. Only the loudest ones
+	// get a channel, and a looping emitter that loses its channel resumes where it left off
+	// when it gets one back. A one-shot emitter is removed once it's done playing, or if
+	// it can't be heard the next time the emitters are updated.
+	int addEmitter(const std::string &filename, const Double3 &position,
+		SoundPriority priority, double volumePercent, bool looping);
+
+	// Moves an emitter. The sound's channel is updated by update().
+	void setEmitterPosition(int id, const Double3 &position);
+
+	// Stops an emitter's sound. Does nothing if the emitter was already removed.
+	void removeEmitter(int id);
+
+	// Sets where emitters are heard from (i.e., the player's camera).
+	void setListener(const Double3 &position, const Double3 &direction);
+
+	// Tests each emitter within hearing range for voxels between it and the listener, in
+	// one ray cast batch.
+	void updateEmitterOcclusion(double ceilingHeight, const VoxelGrid &voxelGrid);
+
+	// Starts decoding the given sounds (i.e., a level's .INF sounds) on a worker thread so
+	// they don't have to be loaded the first time they're played. They're uploaded by
+	// update(). Sounds from the previous call that aren't in this list and aren't playing
+	// are freed; sounds only ever loaded by playSound() are kept.
+	void preloadSounds(const std::vector<std::string> &filenames);
+
 	// Stops the music.
 	void stopMusic();
 
-	// Stops all sounds.
+	// Stops all sounds and removes all emitters.
 	void stopSound();
 
 	// Sets the music volume. Percent must be between 0.0 and 1.0.
@@ -52,8 +123,19 @@ public:
 	// resampling options are not supported.
 	void setResamplingOption(int resamplingOption);
 
+	// Sets how many bytes of songs may be kept pre-rendered. Each song played is rendered
+	// once on a worker thread, and later plays of it stream the rendered samples instead
+	// of synthesizing them. 0 disables the cache.
+	void setMusicCacheBudget(size_t bytes);
+
+	// Sets whether sounds are converted to the device's sample rate when they're loaded,
+	// so OpenAL doesn't resample them while mixing. 0: keep them as is, 1: resample,
+	// 2: resample and convert to 16-bit. Only affects sounds loaded afterwards.
+	void setSoundLoadResampling(int mode);
+
 	// Updates any state not handled by a background thread, such as resetting 
-	// the sources of finished sounds.
+	// the sources of finished sounds, uploading preloaded sounds, and giving channels to
+	// the loudest emitters.
 	void update();
 };
 
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <string>
+
+#include "SDL.h"
+
+#include "FLCPlayer.h"
+#include "TextureManager.h"
+#include "../Rendering/Renderer.h"
+#include "../Utilities/Debug.h"
+
+const int FLCPlayer::FRAME_RING_SIZE = 8;
+
+FLCPlayer::FLCPlayer()
+{
+	this->framesDecoded = 0;
+	this->firstNeededFrame = 0;
+	this->textureFrame = -1;
+	this->textureIndex = 0;
+	this->stop = false;
+}
+
+FLCPlayer::~FLCPlayer()
+{
+	if (this->thread.joinable())
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->stop = true;
+		lock.unlock();
+		this->condVar.notify_one();
+		this->thread.join();
+	}
+}
+
+void FLCPlayer::run()
+{
+	const int frameCount = this->decoder.getFrameCount();
+	const int pixelCount = this->decoder.getWidth() * this->decoder.getHeight();
+
+	while (true)
+	{
+		// Wait for a free slot in the ring. A slot is free once the frame in it is older
+		// than any the main thread can still ask for.
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->condVar.wait(lock, [this]()
+		{
+			return this->stop ||
+				(this->framesDecoded < (this->firstNeededFrame + FLCPlayer::FRAME_RING_SIZE));
+		});
+
+		if (this->stop)
+		{
+			break;
+		}
+
+		const int frameIndex = this->framesDecoded;
+		lock.unlock();
+
+		// Every frame is decoded even if it's skipped, since each one builds on the last.
+		if (!this->decoder.decodeNextFrame())
+		{
+			DebugCrash("Could not decode .FLC frame " + std::to_string(frameIndex) + ".");
+		}
+
+		const uint8_t *srcPixels = this->decoder.getPixels();
+		const Palette &palette = this->decoder.getPalette();
+		std::vector<uint32_t> &dstPixels = this->frames[frameIndex % FLCPlayer::FRAME_RING_SIZE];
+		TextureManager::expandPaletted(srcPixels, pixelCount, palette, dstPixels.data());
+
+		lock.lock();
+		this->framesDecoded++;
+		const bool done = this->framesDecoded == frameCount;
+		lock.unlock();
+		this->frameCondVar.notify_one();
+
+		if (done)
+		{
+			break;
+		}
+	}
+}
+
+bool FLCPlayer::init(const char *filename, Renderer &renderer)
+{
+	DebugAssert(!this->thread.joinable());
+
+	if (!this->decoder.init(filename))
+	{
+		return false;
+	}
+
+	const int width = this->decoder.getWidth();
+	const int height = this->decoder.getHeight();
+	const int frameCount = this->decoder.getFrameCount();
+	if (frameCount == 0)
+	{
+		DebugLogError("\"" + std::string(filename) + "\" has no frames.");
+		return false;
+	}
+
+	const int ringSize = std::min(frameCount, FLCPlayer::FRAME_RING_SIZE);
+	this->frames = std::vector<std::vector<uint32_t>>(FLCPlayer::FRAME_RING_SIZE);
+	for (int i = 0; i < ringSize; i++)
+	{
+		this->frames[i] = std::vector<uint32_t>(width * height);
+	}
+
+	for (Texture &texture : this->textures)
+	{
+		texture = renderer.createTexture(Renderer::DEFAULT_PIXELFORMAT,
+			SDL_TEXTUREACCESS_STREAMING, width, height);
+		if (texture.get() == nullptr)
+		{
+			return false;
+		}
+	}
+
+	this->thread = std::thread(&FLCPlayer::run, this);
+	return true;
+}
+
+int FLCPlayer::getFrameCount() const
+{
+	return this->decoder.getFrameCount();
+}
+
+double FLCPlayer::getFrameDuration() const
+{
+	return this->decoder.getFrameDuration();
+}
+
+const Texture &FLCPlayer::getFrame(int index)
+{
+	DebugAssert(index >= 0);
+	DebugAssert(index < this->getFrameCount());
+
+	if (index == this->textureFrame)
+	{
+		return this->textures[this->textureIndex];
+	}
+
+	DebugAssertMsg(index > this->textureFrame, "Can't go back to a previous .FLC frame.");
+
+	// Let go of every frame before this one, then wait for this one to be decoded. The
+	// thread won't write over its slot until a later frame is asked for.
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->firstNeededFrame = index;
+	lock.unlock();
+	this->condVar.notify_one();
+
+	lock.lock();
+	this->frameCondVar.wait(lock, [this, index]()
+	{
+		return this->framesDecoded > index;
+	});
+
+	lock.unlock();
+
+	this->textureIndex = (this->textureIndex + 1) % static_cast<int>(this->textures.size());
+	const Texture &texture = this->textures[this->textureIndex];
+	const std::vector<uint32_t> &srcPixels = this->frames[index % FLCPlayer::FRAME_RING_SIZE];
+	const int pitch = this->decoder.getWidth() * static_cast<int>(sizeof(uint32_t));
+	if (SDL_UpdateTexture(texture.get(), nullptr, srcPixels.data(), pitch) != 0)
+	{
+		DebugLogWarning("Could not update .FLC frame texture, " + std::string(SDL_GetError()));
+	}
+
+	this->textureFrame = index;
+	return texture;
+}
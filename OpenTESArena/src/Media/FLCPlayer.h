@@ -0,0 +1,61 @@
+#ifndef FLC_PLAYER_H
+#define FLC_PLAYER_H
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../Assets/FLCDecoder.h"
+#include "../Rendering/Texture.h"
+
+// Plays an .FLC or .CEL without having all of its frames in memory. A background thread
+// decodes frames a little ahead of playback into a small ring of 32-bit frames, and the
+// main thread copies the shown frame into one of a couple of streaming textures.
+
+class Renderer;
+
+class FLCPlayer
+{
+private:
+	// Decoded frames kept ahead of the one being shown.
+	static const int FRAME_RING_SIZE;
+
+	FLCDecoder decoder;
+	std::vector<std::vector<uint32_t>> frames; // Ring of 32-bit frames, indexed by frame % size.
+	std::array<Texture, 2> textures; // Alternated between so a texture isn't updated while in use.
+	std::mutex mutex;
+	std::condition_variable condVar, frameCondVar;
+	std::thread thread;
+	int framesDecoded; // Frames written to the ring so far.
+	int firstNeededFrame; // Oldest frame the main thread can still ask for.
+	int textureFrame; // Frame that's in the current texture, or -1.
+	int textureIndex; // Index of the current texture.
+	bool stop;
+
+	// Decodes frames into the ring until all are decoded or told to stop.
+	void run();
+public:
+	FLCPlayer();
+	FLCPlayer(const FLCPlayer&) = delete;
+	~FLCPlayer();
+
+	FLCPlayer &operator=(const FLCPlayer&) = delete;
+
+	// Opens the file, creates the textures, and starts the decoder thread.
+	bool init(const char *filename, Renderer &renderer);
+
+	// Gets the number of frames.
+	int getFrameCount() const;
+
+	// Gets the duration of each frame in seconds.
+	double getFrameDuration() const;
+
+	// Gets a texture with the given frame, waiting for it to be decoded if needed. Frames
+	// must be asked for in increasing order, and any skipped over are dropped.
+	const Texture &getFrame(int index);
+};
+
+#endif
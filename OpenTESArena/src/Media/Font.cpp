@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <unordered_map>
 
 #include "SDL.h"
@@ -64,11 +65,39 @@ Font::Font(FontName fontName)
 
 		this->characters.at(i) = std::move(surface);
 	}
+
+	// Copy the characters into the glyph sheet.
+	int sheetWidth = 0;
+	this->glyphOffsets.resize(this->characters.size());
+	for (size_t i = 0; i < this->characters.size(); i++)
+	{
+		this->glyphOffsets[i] = sheetWidth;
+		sheetWidth += this->characters[i].getWidth();
+	}
+
+	this->glyphSheet = Surface::createWithFormat(sheetWidth, elementHeight,
+		Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
+
+	uint32_t *sheetPixels = static_cast<uint32_t*>(this->glyphSheet.get()->pixels);
+	const int sheetPitch = this->glyphSheet.get()->pitch / sizeof(uint32_t);
+	for (size_t i = 0; i < this->characters.size(); i++)
+	{
+		const Surface &surface = this->characters[i];
+		const uint32_t *pixels = static_cast<const uint32_t*>(surface.get()->pixels);
+		const int width = surface.getWidth();
+		for (int y = 0; y < elementHeight; y++)
+		{
+			std::copy(pixels + (y * width), pixels + ((y + 1) * width),
+				sheetPixels + (y * sheetPitch) + this->glyphOffsets[i]);
+		}
+	}
 }
 
 Font::Font(Font &&font)
 {
 	this->characters = std::move(font.characters);
+	this->glyphSheet = std::move(font.glyphSheet);
+	this->glyphOffsets = std::move(font.glyphOffsets);
 	this->characterHeight = font.characterHeight;
 	this->fontName = font.fontName;
 }
@@ -104,3 +133,16 @@ SDL_Surface *Font::getSurface(char c) const
 	SDL_Surface *surface = this->characters.at(c - 32).get();
 	return surface;
 }
+
+const Surface &Font::getGlyphSheet() const
+{
+	return this->glyphSheet;
+}
+
+Rect Font::getGlyphRect(char c) const
+{
+	// Invalid characters are drawn as space, like getSurface().
+	const int index = ((c < 32) || (c > 127)) ? 0 : (c - 32);
+	return Rect(this->glyphOffsets[index], 0, this->characters[index].getWidth(),
+		this->characterHeight);
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "../Math/Rect.h"
 #include "../Rendering/Surface.h"
 
 // Redesigned for use with Arena assets.
@@ -17,6 +18,11 @@ class Font
 private:
 	// ASCII character-indexed surfaces, where space (ASCII 32) is index 0.
 	std::vector<Surface> characters;
+
+	// All characters side by side in one row, for drawing text from a single texture.
+	Surface glyphSheet;
+	std::vector<int> glyphOffsets; // X of each character in the glyph sheet.
+
 	FontName fontName;
 	int characterHeight;
 public:
@@ -38,6 +44,10 @@ public:
 
 	// Gets the surface for a given character.
 	SDL_Surface *getSurface(char c) const;
+
+	// Gets the sheet of every character and where a given character is in it.
+	const Surface &getGlyphSheet() const;
+	Rect getGlyphRect(char c) const;
 };
 
 #endif
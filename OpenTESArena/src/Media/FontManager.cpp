@@ -1,5 +1,31 @@
+#include <array>
+
+#include "SDL.h"
+
 #include "FontManager.h"
 #include "FontName.h"
+#include "../Rendering/Renderer.h"
+
+void FontManager::preloadFonts()
+{
+	const std::array<FontName, 9> FontNames =
+	{
+		FontName::A,
+		FontName::Arena,
+		FontName::B,
+		FontName::C,
+		FontName::Char,
+		FontName::D,
+		FontName::Four,
+		FontName::S,
+		FontName::Teeny
+	};
+
+	for (const FontName fontName : FontNames)
+	{
+		this->getFont(fontName);
+	}
+}
 
 const Font &FontManager::getFont(FontName fontName)
 {
@@ -18,3 +44,21 @@ const Font &FontManager::getFont(FontName fontName)
 		return fontIter->second;
 	}
 }
+
+const Texture &FontManager::getGlyphAtlas(FontName fontName, Renderer &renderer)
+{
+	auto atlasIter = this->glyphAtlases.find(fontName);
+	if (atlasIter != this->glyphAtlases.end())
+	{
+		return atlasIter->second;
+	}
+
+	const Font &font = this->getFont(fontName);
+	Texture texture = renderer.createTextureFromSurface(font.getGlyphSheet());
+
+	// Set alpha transparency on.
+	SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+
+	atlasIter = this->glyphAtlases.emplace(std::make_pair(fontName, std::move(texture))).first;
+	return atlasIter->second;
+}
@@ -4,19 +4,31 @@
 #include <unordered_map>
 
 #include "Font.h"
+#include "../Rendering/Texture.h"
 
 // This class manages access for each font object. This should be stored in the 
 // game state with the other managers.
 
+class Renderer;
+
 enum class FontName;
 
 class FontManager
 {
 private:
 	std::unordered_map<FontName, Font> fonts;
+	std::unordered_map<FontName, Texture> glyphAtlases;
 public:
+	// Decodes every font ahead of time so getFont() doesn't have to. Safe to run on another
+	// thread as long as nothing else uses the font manager until it's done.
+	void preloadFonts();
+
 	// Gets a font object using one of the Arena font assets.
 	const Font &getFont(FontName fontName);
+
+	// Gets the texture of a font's glyph sheet, for drawing text one character at a time
+	// without building a texture for it. Characters are white so they can be tinted.
+	const Texture &getGlyphAtlas(FontName fontName, Renderer &renderer);
 };
 
 #endif
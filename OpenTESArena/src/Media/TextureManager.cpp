@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <numeric>
 
 #include "SDL.h"
 
@@ -12,21 +15,489 @@
 #include "../Assets/DFAFile.h"
 #include "../Assets/FLCFile.h"
 #include "../Assets/IMGFile.h"
+#include "../Assets/ImagePack.h"
 #include "../Assets/RCIFile.h"
 #include "../Assets/SETFile.h"
 #include "../Math/Vector2.h"
 #include "../Rendering/Renderer.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/KernelDispatch.h"
+#include "../Utilities/MemoryReport.h"
+#include "../Utilities/Platform.h"
+#include "../Utilities/PlatformIsa.h"
+#include "../Utilities/Profiler.h"
 #include "../Utilities/String.h"
 #include "../Utilities/StringView.h"
 
 #include "components/vfs/manager.hpp"
 
+namespace
+{
+	// Estimated pixel memory of cached images, for the memory budget.
+	size_t getByteCount(const Surface &surface)
+	{
+		return static_cast<size_t>(surface.get()->pitch) * surface.getHeight();
+	}
+
+	size_t getByteCount(const Texture &texture)
+	{
+		return static_cast<size_t>(texture.getWidth()) * texture.getHeight() * sizeof(uint32_t);
+	}
+
+	// Pixels read from the image pack are in the OS's file cache, not owned here.
+	size_t getByteCount(const TextureManager::PalettedImage &image)
+	{
+		return image.pixels.size() + ((image.ownPalette != nullptr) ? sizeof(Palette) : 0);
+	}
+
+	template <typename T>
+	size_t getColdByteCount(const T &coldSurface)
+	{
+		return coldSurface.compressedIndices.size() + sizeof(coldSurface.palette);
+	}
+
+	template <typename T>
+	size_t getColdByteCount(const std::vector<T> &coldSurfaces)
+	{
+		size_t byteCount = 0;
+		for (const T &coldSurface : coldSurfaces)
+		{
+			byteCount += getColdByteCount(coldSurface);
+		}
+
+		return byteCount;
+	}
+
+	template <typename T>
+	size_t getByteCount(const std::vector<T> &values)
+	{
+		size_t byteCount = 0;
+		for (const T &value : values)
+		{
+			byteCount += getByteCount(value);
+		}
+
+		return byteCount;
+	}
+
+	void expandPalettedScalar(const uint8_t *srcPixels, int pixelCount, const uint32_t *colors,
+		uint32_t *dstPixels)
+	{
+		// Look up eight pixels per iteration since the lookups don't depend on each other.
+		const int unrolledCount = pixelCount - (pixelCount % 8);
+		int i = 0;
+		for (; i < unrolledCount; i += 8)
+		{
+			dstPixels[i] = colors[srcPixels[i]];
+			dstPixels[i + 1] = colors[srcPixels[i + 1]];
+			dstPixels[i + 2] = colors[srcPixels[i + 2]];
+			dstPixels[i + 3] = colors[srcPixels[i + 3]];
+			dstPixels[i + 4] = colors[srcPixels[i + 4]];
+			dstPixels[i + 5] = colors[srcPixels[i + 5]];
+			dstPixels[i + 6] = colors[srcPixels[i + 6]];
+			dstPixels[i + 7] = colors[srcPixels[i + 7]];
+		}
+
+		for (; i < pixelCount; i++)
+		{
+			dstPixels[i] = colors[srcPixels[i]];
+		}
+	}
+
+#if defined(PLATFORM_AVX2)
+	PLATFORM_TARGET_AVX2 void expandPalettedAVX2(const uint8_t *srcPixels, int pixelCount,
+		const uint32_t *colors, uint32_t *dstPixels)
+	{
+		// Eight indices are widened to 32 bits and looked up with one gather.
+		const int *colorTable = reinterpret_cast<const int*>(colors);
+		int i = 0;
+		for (; (i + 8) <= pixelCount; i += 8)
+		{
+			const __m128i indices8 = _mm_loadl_epi64(
+				reinterpret_cast<const __m128i*>(srcPixels + i));
+			const __m256i indices = _mm256_cvtepu8_epi32(indices8);
+			const __m256i pixels = _mm256_i32gather_epi32(colorTable, indices, 4);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dstPixels + i), pixels);
+		}
+
+		for (; i < pixelCount; i++)
+		{
+			dstPixels[i] = colors[srcPixels[i]];
+		}
+	}
+#endif
+
+	// SSE2 has no gather or 256-entry shuffle, so it has nothing over the scalar lookups.
+	const KernelDispatch::Kernel<void(const uint8_t*, int, const uint32_t*, uint32_t*)>
+		ExpandPalettedKernel("ExpandPaletted",
+	{
+		{ Platform::CpuIsa::Scalar, expandPalettedScalar },
+#if defined(PLATFORM_AVX2)
+		{ Platform::CpuIsa::AVX2, expandPalettedAVX2 }
+#endif
+	});
+}
+
+const double TextureManager::UPLOAD_BUDGET_SECONDS = 0.004;
+const double TextureManager::COLD_SECONDS = 30.0;
+const double TextureManager::COMPRESS_BUDGET_SECONDS = 0.002;
+
+TextureManager::PalettedImage::PalettedImage()
+{
+	this->width = 0;
+	this->height = 0;
+	this->packedPixels = nullptr;
+	this->usesOwnPalette = false;
+}
+
+const uint8_t *TextureManager::PalettedImage::getPixels() const
+{
+	return (this->packedPixels != nullptr) ? this->packedPixels : this->pixels.data();
+}
+
+TextureManager::TextureManager()
+{
+	this->cacheStats.hitCount = 0;
+	this->cacheStats.missCount = 0;
+	this->cacheStats.evictionCount = 0;
+	this->cacheStats.compressionCount = 0;
+	this->cacheStats.residentBytes = 0;
+	this->cacheStats.pinnedBytes = 0;
+	this->cacheStats.budgetBytes = 0;
+	this->cacheStats.coldBytes = 0;
+	this->frameIndex = 0;
+	this->startTime = std::chrono::steady_clock::now();
+	this->currentSeconds = 0.0;
+}
+
 TextureManager::~TextureManager()
 {
 	
 }
 
+template <typename T>
+const T *TextureManager::findEntry(std::unordered_map<std::string, CacheEntry<T>> &map,
+	const std::string &fullName)
+{
+	const auto iter = map.find(fullName);
+	if (iter == map.end())
+	{
+		return nullptr;
+	}
+
+	CacheEntry<T> &entry = iter->second;
+	entry.lastUsedFrame = this->frameIndex;
+	entry.lastUsedSeconds = this->currentSeconds;
+	this->cacheStats.hitCount++;
+	return &entry.value;
+}
+
+template <typename Hot, typename Cold>
+const Hot *TextureManager::findColdEntry(std::unordered_map<std::string, CacheEntry<Hot>> &hotMap,
+	std::unordered_map<std::string, CacheEntry<Cold>> &coldMap, const std::string &fullName)
+{
+	const auto iter = coldMap.find(fullName);
+	if (iter == coldMap.end())
+	{
+		return nullptr;
+	}
+
+	CacheEntry<Hot> entry;
+	entry.value = TextureManager::decompress(iter->second.value);
+	entry.byteCount = getByteCount(entry.value);
+	entry.lastUsedFrame = this->frameIndex;
+	entry.lastUsedSeconds = this->currentSeconds;
+	entry.pinned = false;
+
+	// Still a hit since nothing had to be loaded.
+	this->cacheStats.hitCount++;
+	this->cacheStats.residentBytes += entry.byteCount;
+	this->cacheStats.residentBytes -= iter->second.byteCount;
+	this->cacheStats.coldBytes -= iter->second.byteCount;
+	coldMap.erase(iter);
+
+	auto hotIter = hotMap.emplace(std::make_pair(fullName, std::move(entry))).first;
+	return &hotIter->second.value;
+}
+
+template <typename Hot, typename Cold>
+bool TextureManager::compressColdEntries(std::unordered_map<std::string, CacheEntry<Hot>> &hotMap,
+	std::unordered_map<std::string, CacheEntry<Cold>> &coldMap,
+	std::chrono::steady_clock::time_point deadline)
+{
+	auto iter = hotMap.begin();
+	while (iter != hotMap.end())
+	{
+		CacheEntry<Hot> &entry = iter->second;
+		const double unusedSeconds = this->currentSeconds - entry.lastUsedSeconds;
+		if (entry.pinned || (unusedSeconds < TextureManager::COLD_SECONDS))
+		{
+			++iter;
+			continue;
+		}
+
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			return false;
+		}
+
+		CacheEntry<Cold> coldEntry;
+		if (!TextureManager::compress(entry.value, &coldEntry.value))
+		{
+			// Too many colors. Try again once it's gone unused for another while.
+			entry.lastUsedSeconds = this->currentSeconds;
+			++iter;
+			continue;
+		}
+
+		// Keep its age so eviction still sees it as old.
+		coldEntry.byteCount = getColdByteCount(coldEntry.value);
+		coldEntry.lastUsedFrame = entry.lastUsedFrame;
+		coldEntry.lastUsedSeconds = entry.lastUsedSeconds;
+		coldEntry.pinned = false;
+
+		this->cacheStats.compressionCount++;
+		this->cacheStats.residentBytes -= entry.byteCount;
+		this->cacheStats.residentBytes += coldEntry.byteCount;
+		this->cacheStats.coldBytes += coldEntry.byteCount;
+		coldMap.emplace(std::make_pair(iter->first, std::move(coldEntry)));
+		iter = hotMap.erase(iter);
+	}
+
+	return true;
+}
+
+template <typename T>
+const T &TextureManager::addEntry(std::unordered_map<std::string, CacheEntry<T>> &map,
+	const std::string &fullName, T &&value)
+{
+	CacheEntry<T> entry;
+	entry.byteCount = getByteCount(value);
+	entry.value = std::move(value);
+	entry.lastUsedFrame = this->frameIndex;
+	entry.lastUsedSeconds = this->currentSeconds;
+	entry.pinned = false;
+
+	this->cacheStats.missCount++;
+	this->cacheStats.residentBytes += entry.byteCount;
+
+	auto iter = map.emplace(std::make_pair(fullName, std::move(entry))).first;
+	return iter->second.value;
+}
+
+template <typename T>
+void TextureManager::pinEntry(std::unordered_map<std::string, CacheEntry<T>> &map,
+	const std::string &fullName)
+{
+	CacheEntry<T> &entry = map.at(fullName);
+	if (!entry.pinned)
+	{
+		entry.pinned = true;
+		this->cacheStats.pinnedBytes += entry.byteCount;
+	}
+}
+
+void TextureManager::evictToBudget()
+{
+	const size_t budgetBytes = this->cacheStats.budgetBytes;
+	if ((budgetBytes == 0) || (this->cacheStats.residentBytes <= budgetBytes))
+	{
+		return;
+	}
+
+	// Entries that can be evicted, oldest first. Ones used in the last frame are kept so a
+	// screen's images aren't reloaded every frame when they don't all fit.
+	struct Candidate
+	{
+		uint64_t lastUsedFrame;
+		const std::string *fullName;
+		int mapIndex;
+	};
+
+	std::vector<Candidate> candidates;
+	auto addCandidates = [this, &candidates](const auto &map, int mapIndex)
+	{
+		for (const auto &pair : map)
+		{
+			const auto &entry = pair.second;
+			if (!entry.pinned && ((entry.lastUsedFrame + 1) < this->frameIndex))
+			{
+				Candidate candidate;
+				candidate.lastUsedFrame = entry.lastUsedFrame;
+				candidate.fullName = &pair.first;
+				candidate.mapIndex = mapIndex;
+				candidates.push_back(candidate);
+			}
+		}
+	};
+
+	addCandidates(this->surfaces, 0);
+	addCandidates(this->textures, 1);
+	addCandidates(this->surfaceSets, 2);
+	addCandidates(this->textureSets, 3);
+	addCandidates(this->palettedImages, 4);
+	addCandidates(this->coldSurfaces, 5);
+	addCandidates(this->coldSurfaceSets, 6);
+
+	std::sort(candidates.begin(), candidates.end(),
+		[](const Candidate &a, const Candidate &b)
+	{
+		return a.lastUsedFrame < b.lastUsedFrame;
+	});
+
+	auto evict = [this](auto &map, const std::string &fullName)
+	{
+		const auto iter = map.find(fullName);
+		this->cacheStats.residentBytes -= iter->second.byteCount;
+		this->cacheStats.evictionCount++;
+		map.erase(iter);
+	};
+
+	auto evictCold = [this, &evict](auto &map, const std::string &fullName)
+	{
+		this->cacheStats.coldBytes -= map.at(fullName).byteCount;
+		evict(map, fullName);
+	};
+
+	for (const Candidate &candidate : candidates)
+	{
+		if (this->cacheStats.residentBytes <= budgetBytes)
+		{
+			break;
+		}
+
+		// Copy the name since erasing the entry frees the key it points to.
+		const std::string fullName = *candidate.fullName;
+		if (candidate.mapIndex == 0)
+		{
+			evict(this->surfaces, fullName);
+		}
+		else if (candidate.mapIndex == 1)
+		{
+			evict(this->textures, fullName);
+		}
+		else if (candidate.mapIndex == 2)
+		{
+			evict(this->surfaceSets, fullName);
+		}
+		else if (candidate.mapIndex == 3)
+		{
+			evict(this->textureSets, fullName);
+		}
+		else if (candidate.mapIndex == 4)
+		{
+			evict(this->palettedImages, fullName);
+		}
+		else if (candidate.mapIndex == 5)
+		{
+			evictCold(this->coldSurfaces, fullName);
+		}
+		else
+		{
+			evictCold(this->coldSurfaceSets, fullName);
+		}
+	}
+}
+
+bool TextureManager::compress(const Surface &surface, ColdSurface *outColdSurface)
+{
+	const SDL_Surface *sdlSurface = surface.get();
+	const int width = surface.getWidth();
+	const int height = surface.getHeight();
+
+	// Give each color an index in the order they're found. Images made from paletted ones
+	// never have more than 256, so this only fails for ones made some other way.
+	std::unordered_map<uint32_t, uint8_t> colorIndices;
+	auto &paletteColors = outColdSurface->palette.get();
+	std::vector<uint8_t> indices(width * height);
+	uint32_t previousColor = 0;
+	uint8_t previousIndex = 0;
+	bool hasPrevious = false;
+	for (int y = 0; y < height; y++)
+	{
+		const uint32_t *srcRow = reinterpret_cast<const uint32_t*>(
+			static_cast<const uint8_t*>(sdlSurface->pixels) + (y * sdlSurface->pitch));
+		uint8_t *dstRow = indices.data() + (y * width);
+		for (int x = 0; x < width; x++)
+		{
+			// Most neighboring pixels are the same color, so check the last one first.
+			const uint32_t color = srcRow[x];
+			if (hasPrevious && (color == previousColor))
+			{
+				dstRow[x] = previousIndex;
+				continue;
+			}
+
+			auto iter = colorIndices.find(color);
+			if (iter == colorIndices.end())
+			{
+				const int colorCount = static_cast<int>(colorIndices.size());
+				if (colorCount == static_cast<int>(paletteColors.size()))
+				{
+					return false;
+				}
+
+				paletteColors[colorCount] = Color::fromARGB(color);
+				iter = colorIndices.emplace(std::make_pair(
+					color, static_cast<uint8_t>(colorCount))).first;
+			}
+
+			dstRow[x] = iter->second;
+			previousColor = color;
+			previousIndex = iter->second;
+			hasPrevious = true;
+		}
+	}
+
+	outColdSurface->width = width;
+	outColdSurface->height = height;
+	Compression::encodeLZ(indices.data(), static_cast<int>(indices.size()),
+		outColdSurface->compressedIndices);
+	outColdSurface->compressedIndices.shrink_to_fit();
+	return true;
+}
+
+bool TextureManager::compress(const std::vector<Surface> &surfaces,
+	std::vector<ColdSurface> *outColdSurfaces)
+{
+	outColdSurfaces->resize(surfaces.size());
+	for (size_t i = 0; i < surfaces.size(); i++)
+	{
+		if (!TextureManager::compress(surfaces[i], &(*outColdSurfaces)[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Surface TextureManager::decompress(const ColdSurface &coldSurface)
+{
+	const int width = coldSurface.width;
+	const int height = coldSurface.height;
+	std::vector<uint8_t> indices(width * height);
+	const std::vector<uint8_t> &compressedIndices = coldSurface.compressedIndices;
+	Compression::decodeLZ(compressedIndices.data(),
+		compressedIndices.data() + compressedIndices.size(), indices.data(),
+		static_cast<int>(indices.size()));
+	return TextureManager::make32BitFromPaletted(width, height, indices.data(),
+		coldSurface.palette);
+}
+
+std::vector<Surface> TextureManager::decompress(const std::vector<ColdSurface> &coldSurfaces)
+{
+	std::vector<Surface> surfaces;
+	surfaces.reserve(coldSurfaces.size());
+	for (const ColdSurface &coldSurface : coldSurfaces)
+	{
+		surfaces.push_back(TextureManager::decompress(coldSurface));
+	}
+
+	return surfaces;
+}
+
 void TextureManager::loadCOLPalette(const std::string &colName)
 {
 	COLFile colFile;
@@ -77,6 +548,20 @@ void TextureManager::loadPalette(const std::string &paletteName)
 	DebugAssert(this->palettes.find(paletteName) != this->palettes.end());
 }
 
+void TextureManager::expandPaletted(const uint8_t *srcPixels, int pixelCount,
+	const Palette &palette, uint32_t *dstPixels)
+{
+	// Convert the palette to 32-bit colors once instead of once per pixel.
+	std::array<uint32_t, 256> colors;
+	std::transform(palette.get().begin(), palette.get().end(), colors.begin(),
+		[](const Color &color)
+	{
+		return color.toARGB();
+	});
+
+	ExpandPalettedKernel.get()(srcPixels, pixelCount, colors.data(), dstPixels);
+}
+
 Surface TextureManager::make32BitFromPaletted(int width, int height,
 	const uint8_t *srcPixels, const Palette &palette)
 {
@@ -86,292 +571,168 @@ Surface TextureManager::make32BitFromPaletted(int width, int height,
 
 	// Generate a 32-bit color from each palette index in the source image and
 	// write them to the destination image.
-	const int pixelCount = width * height;
-	std::transform(srcPixels, srcPixels + pixelCount, dstPixels,
-		[&palette](uint8_t pixel)
-	{
-		return palette.get()[pixel].toARGB();
-	});
+	TextureManager::expandPaletted(srcPixels, width * height, palette, dstPixels);
 
 	return surface;
 }
 
-const Surface &TextureManager::getSurface(const std::string &filename,
+const Palette *TextureManager::loadImagePalette(const std::string &filename,
 	const std::string &paletteName)
 {
-	// Use this name when interfacing with the surfaces map.
-	const std::string fullName = filename + paletteName;
-
-	// See if the image file has already been loaded with the palette.
-	auto surfaceIter = this->surfaces.find(fullName);
-	if (surfaceIter != this->surfaces.end())
-	{
-		// The requested surface exists.
-		return surfaceIter->second;
-	}
-
 	// Attempt to use the image's built-in palette if requested.
 	const bool useBuiltInPalette = Palette::isBuiltIn(paletteName);
 
-	// See if the palette hasn't already been loaded.
-	const bool paletteIsLoaded = this->palettes.find(paletteName) != this->palettes.end();
-	const bool imagePaletteIsLoaded = this->palettes.find(filename) != this->palettes.end();
-	if ((!useBuiltInPalette && !paletteIsLoaded) ||
-		(useBuiltInPalette && !imagePaletteIsLoaded))
+	// Use the filename (i.e., TAMRIEL.IMG) if using the built-in palette. Otherwise, use
+	// the given palette name (i.e., PAL.COL).
+	const std::string &name = useBuiltInPalette ? filename : paletteName;
+	if (this->palettes.find(name) == this->palettes.end())
 	{
-		// Use the image's filename if using the built-in palette. Otherwise, use the given
-		// palette name.
-		this->loadPalette(useBuiltInPalette ? filename : paletteName);
+		this->loadPalette(name);
 	}
 
-	// The image hasn't been loaded with the palette yet, so make a new entry.
+	return useBuiltInPalette ? nullptr : &this->palettes.at(paletteName);
+}
+
+bool TextureManager::decodePalettedImage(const std::string &filename,
+	std::vector<PalettedImage> *outImages)
+{
+	ProfilerZone("Load image");
+
 	// Check what kind of file extension the filename has.
 	const std::string_view extension = StringView::getExtension(filename);
 	const bool isCOL = extension == "COL";
 	const bool isIMG = extension == "IMG";
 	const bool isMNU = extension == "MNU";
 
-	Surface surface;
+	PalettedImage image;
 
 	if (isCOL)
 	{
-		// A palette was requested as the primary image. Convert it to a surface.
+		// A palette was requested as the primary image. It's shown as a 16x16 swatch of
+		// its own colors.
 		COLFile colFile;
 		if (!colFile.init(filename.c_str()))
 		{
-			DebugCrash("Could not init .COL file \"" + filename + "\".");
+			DebugLogWarning("Could not init .COL file \"" + filename + "\".");
+			return false;
 		}
 
-		const Palette &colPalette = colFile.getPalette();
-
-		DebugAssert(colPalette.get().size() == 256);
-		surface = Surface::createWithFormat(16, 16, Renderer::DEFAULT_BPP,
-			Renderer::DEFAULT_PIXELFORMAT);
-		
-		uint32_t *pixels = static_cast<uint32_t*>(surface.get()->pixels);
-		for (size_t i = 0; i < colPalette.get().size(); i++)
-		{
-			pixels[i] = colPalette.get()[i].toARGB();
-		}
+		DebugAssert(colFile.getPalette().get().size() == 256);
+		image.width = 16;
+		image.height = 16;
+		image.pixels.resize(image.width * image.height);
+		std::iota(image.pixels.begin(), image.pixels.end(), 0);
+		image.ownPalette = std::make_unique<Palette>(colFile.getPalette());
+		image.usesOwnPalette = true;
 	}
 	else if (isIMG || isMNU)
 	{
 		IMGFile img;
 		if (!img.init(filename.c_str()))
 		{
-			DebugCrash("Could not init .IMG file \"" + filename + "\".");
+			DebugLogWarning("Could not init .IMG file \"" + filename + "\".");
+			return false;
 		}
 
-		// Decide if the .IMG will use its own palette or not.
-		const Palette &palette = useBuiltInPalette ?
-			*img.getPalette() : this->palettes.at(paletteName);
-		
-		// Create a surface from the .IMG.
-		surface = Surface::createWithFormat(img.getWidth(), img.getHeight(),
-			Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
+		image.width = img.getWidth();
+		image.height = img.getHeight();
+		image.pixels.assign(img.getPixels(), img.getPixels() + (image.width * image.height));
 
-		// Generate 32-bit colors from each palette index in the .IMG pixels and
-		// write them to the destination image.
-		const uint8_t *srcPixels = img.getPixels();
-		uint32_t *dstPixels = static_cast<uint32_t*>(surface.get()->pixels);
-		std::transform(srcPixels, srcPixels + (img.getWidth() * img.getHeight()), dstPixels,
-			[&palette](uint8_t srcPixel)
+		// Keep the built-in palette in case it's requested.
+		if (img.getPalette() != nullptr)
 		{
-			return palette.get()[srcPixel].toARGB();
-		});
+			image.ownPalette = std::make_unique<Palette>(*img.getPalette());
+		}
+
+		image.usesOwnPalette = false;
 	}
 	else
 	{
-		DebugCrash("Unrecognized surface format \"" + filename + "\".");
+		DebugLogWarning("Unrecognized surface format \"" + filename + "\".");
+		return false;
 	}
 
-	// Add the new surface and return it.
-	auto iter = this->surfaces.emplace(std::make_pair(fullName, std::move(surface))).first;
-	return iter->second;
-}
-
-const Surface &TextureManager::getSurface(const std::string &filename)
-{
-	return this->getSurface(filename, this->activePalette);
+	outImages->clear();
+	outImages->push_back(std::move(image));
+	return true;
 }
 
-const Texture &TextureManager::getTexture(const std::string &filename,
-	const std::string &paletteName, Renderer &renderer)
+bool TextureManager::decodePalettedImageSet(const std::string &filename,
+	std::vector<PalettedImage> *outImages)
 {
-	// Use this name when interfacing with the textures map.
-	const std::string fullName = filename + paletteName;
-
-	// See if the image file has already been loaded with the palette.
-	auto textureIter = this->textures.find(fullName);
-	if (textureIter != this->textures.end())
-	{
-		// The requested texture exists.
-		return textureIter->second;
-	}
-	// Attempt to use the image's built-in palette if requested.
-	const bool useBuiltInPalette = Palette::isBuiltIn(paletteName);
+	ProfilerZone("Load image set");
 
-	// See if the palette hasn't already been loaded.
-	const bool paletteIsLoaded = this->palettes.find(paletteName) != this->palettes.end();
-	const bool imagePaletteIsLoaded = this->palettes.find(filename) != this->palettes.end();
-	if ((!useBuiltInPalette && !paletteIsLoaded) || 
-		(useBuiltInPalette && !imagePaletteIsLoaded))
-	{
-		// Use the filename (i.e., TAMRIEL.IMG) if using the built-in palette.
-		// Otherwise, use the given palette name (i.e., PAL.COL).
-		this->loadPalette(useBuiltInPalette ? filename : paletteName);
-	}
-
-	// The image hasn't been loaded with the palette yet, so make a new entry.
-	// Check what kind of file extension the filename has.
+	// This method deals with animations and movies, so it will check filenames 
+	// for ".CFA", ".CIF", ".DFA", ".FLC", ".SET", etc..
 	const std::string_view extension = StringView::getExtension(filename);
-	const bool isIMG = extension == "IMG";
-	const bool isMNU = extension == "MNU";
+	const bool isCFA = extension == "CFA";
+	const bool isCIF = extension == "CIF";
+	const bool isCEL = extension == "CEL";
+	const bool isDFA = extension == "DFA";
+	const bool isFLC = extension == "FLC";
+	const bool isRCI = extension == "RCI";
+	const bool isSET = extension == "SET";
 
-	Texture texture;
+	std::vector<PalettedImage> &images = *outImages;
+	images.clear();
 
-	if (isIMG || isMNU)
+	// Copies one image of the set. Only .FLC frames come with a palette.
+	auto addImage = [&images](int width, int height, const uint8_t *pixels,
+		const Palette *framePalette)
 	{
-		Surface surface = [this, &filename, &paletteName, useBuiltInPalette]()
+		PalettedImage image;
+		image.width = width;
+		image.height = height;
+		image.pixels.assign(pixels, pixels + (width * height));
+		if (framePalette != nullptr)
 		{
-			IMGFile img;
-			if (!img.init(filename.c_str()))
-			{
-				DebugCrash("Could not init .IMG file \"" + filename + "\".");
-			}
-
-			// Decide if the .IMG will use its own palette or not.
-			const Palette &palette = useBuiltInPalette ?
-				*img.getPalette() : this->palettes.at(paletteName);
-
-			// Create a surface from the .IMG.
-			Surface surface = Surface::createWithFormat(img.getWidth(), img.getHeight(),
-				Renderer::DEFAULT_BPP, Renderer::DEFAULT_PIXELFORMAT);
-
-			// Generate 32-bit colors from each palette index in the .IMG pixels and
-			// write them to the destination image.
-			const uint8_t *srcPixels = img.getPixels();
-			uint32_t *dstPixels = static_cast<uint32_t*>(surface.get()->pixels);
-			std::transform(srcPixels, srcPixels + (img.getWidth() * img.getHeight()), dstPixels,
-				[&palette](uint8_t srcPixel)
-			{
-				return palette.get()[srcPixel].toARGB();
-			});
+			image.ownPalette = std::make_unique<Palette>(*framePalette);
+		}
 
-			return surface;
-		}();
+		image.usesOwnPalette = framePalette != nullptr;
+		images.push_back(std::move(image));
+	};
 
-		// Create a texture from the surface.
-		texture = renderer.createTextureFromSurface(surface);
+	if (isCFA)
+	{
+		CFAFile cfaFile;
+		if (!cfaFile.init(filename.c_str()))
+		{
+			DebugLogWarning("Could not init .CFA file \"" + filename + "\".");
+			return false;
+		}
 
-		// Set alpha transparency on.
-		SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+		for (int i = 0; i < cfaFile.getImageCount(); i++)
+		{
+			addImage(cfaFile.getWidth(), cfaFile.getHeight(), cfaFile.getPixels(i), nullptr);
+		}
 	}
-	else
+	else if (isCIF)
 	{
-		DebugCrash("Unrecognized texture format \"" + filename + "\".");
+		CIFFile cifFile;
+		if (!cifFile.init(filename.c_str()))
+		{
+			DebugLogWarning("Could not init .CIF file \"" + filename + "\".");
+			return false;
+		}
+
+		for (int i = 0; i < cifFile.getImageCount(); i++)
+		{
+			addImage(cifFile.getWidth(i), cifFile.getHeight(i), cifFile.getPixels(i), nullptr);
+		}
 	}
+	else if (isDFA)
+	{
+		DFAFile dfaFile;
+		if (!dfaFile.init(filename.c_str()))
+		{
+			DebugLogWarning("Could not init .DFA file \"" + filename + "\".");
+			return false;
+		}
 
-	// Add the new texture and return it.
-	auto iter = this->textures.emplace(std::make_pair(fullName, std::move(texture))).first;
-	DebugAssert(texture.get() == nullptr);
-	return iter->second;
-}
-
-const Texture &TextureManager::getTexture(const std::string &filename, Renderer &renderer)
-{
-	return this->getTexture(filename, this->activePalette, renderer);
-}
-
-const std::vector<Surface> &TextureManager::getSurfaces(
-	const std::string &filename, const std::string &paletteName)
-{
-	// This method deals with animations and movies, so it will check filenames 
-	// for ".CFA", ".CIF", ".DFA", ".FLC", ".SET", etc..
-
-	// Use this name when interfacing with the surface sets map.
-	const std::string fullName = filename + paletteName;
-
-	// See if the file has already been loaded with the palette.
-	auto setIter = this->surfaceSets.find(fullName);
-	if (setIter != this->surfaceSets.end())
-	{
-		// The requested texture set exists.
-		return setIter->second;
-	}
-
-	// Do not use a built-in palette for surface sets.
-	DebugAssertMsg(!Palette::isBuiltIn(paletteName),
-		"Image sets (i.e., .SET files) do not have built-in palettes.");
-
-	// See if the palette hasn't already been loaded.
-	if (this->palettes.find(paletteName) == this->palettes.end())
-	{
-		this->loadPalette(paletteName);
-	}
-
-	// The file hasn't been loaded with the palette yet, so make a new entry.
-	const auto iter = this->surfaceSets.emplace(
-		std::make_pair(fullName, std::vector<Surface>())).first;
-
-	std::vector<Surface> &surfaceSet = iter->second;
-	const Palette &palette = this->palettes.at(paletteName);
-
-	const std::string_view extension = StringView::getExtension(filename);
-	const bool isCFA = extension == "CFA";
-	const bool isCIF = extension == "CIF";
-	const bool isCEL = extension == "CEL";
-	const bool isDFA = extension == "DFA";
-	const bool isFLC = extension == "FLC";
-	const bool isRCI = extension == "RCI";
-	const bool isSET = extension == "SET";
-
-	if (isCFA)
-	{
-		CFAFile cfaFile;
-		if (!cfaFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .CFA file \"" + filename + "\".");
-		}
-
-		// Create a surface for each image in the .CFA.
-		for (int i = 0; i < cfaFile.getImageCount(); i++)
-		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				cfaFile.getWidth(), cfaFile.getHeight(), cfaFile.getPixels(i), palette);
-			surfaceSet.push_back(std::move(surface));
-		}
-	}
-	else if (isCIF)
-	{
-		CIFFile cifFile;
-		if (!cifFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .CIF file \"" + filename + "\".");
-		}
-
-		// Create a surface for each image in the .CIF.
-		for (int i = 0; i < cifFile.getImageCount(); i++)
-		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				cifFile.getWidth(i), cifFile.getHeight(i), cifFile.getPixels(i), palette);
-			surfaceSet.push_back(std::move(surface));
-		}
-	}
-	else if (isDFA)
-	{
-		DFAFile dfaFile;
-		if (!dfaFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .DFA file \"" + filename + "\".");
-		}
-
-		// Create a surface for each image in the .DFA.
 		for (int i = 0; i < dfaFile.getImageCount(); i++)
 		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				dfaFile.getWidth(), dfaFile.getHeight(), dfaFile.getPixels(i), palette);
-			surfaceSet.push_back(std::move(surface));
+			addImage(dfaFile.getWidth(), dfaFile.getHeight(), dfaFile.getPixels(i), nullptr);
 		}
 	}
 	else if (isFLC || isCEL)
@@ -379,16 +740,15 @@ const std::vector<Surface> &TextureManager::getSurfaces(
 		FLCFile flcFile;
 		if (!flcFile.init(filename.c_str()))
 		{
-			DebugCrash("Could not init .FLC/.CEL file \"" + filename + "\".");
+			DebugLogWarning("Could not init .FLC/.CEL file \"" + filename + "\".");
+			return false;
 		}
 
-		// Create a surface for each frame in the .FLC.
+		// Each frame uses its own palette regardless of the one requested.
 		for (int i = 0; i < flcFile.getFrameCount(); i++)
 		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				flcFile.getWidth(), flcFile.getHeight(), flcFile.getPixels(i),
-				flcFile.getFramePalette(i));
-			surfaceSet.push_back(std::move(surface));
+			addImage(flcFile.getWidth(), flcFile.getHeight(), flcFile.getPixels(i),
+				&flcFile.getFramePalette(i));
 		}
 	}
 	else if (isRCI)
@@ -396,15 +756,13 @@ const std::vector<Surface> &TextureManager::getSurfaces(
 		RCIFile rciFile;
 		if (!rciFile.init(filename.c_str()))
 		{
-			DebugCrash("Could not init .RCI file \"" + filename + "\".");
+			DebugLogWarning("Could not init .RCI file \"" + filename + "\".");
+			return false;
 		}
 
-		// Create a surface for each image in the .RCI.
 		for (int i = 0; i < rciFile.getImageCount(); i++)
 		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				RCIFile::WIDTH, RCIFile::HEIGHT, rciFile.getPixels(i), palette);
-			surfaceSet.push_back(std::move(surface));
+			addImage(RCIFile::WIDTH, RCIFile::HEIGHT, rciFile.getPixels(i), nullptr);
 		}
 	}
 	else if (isSET)
@@ -412,23 +770,273 @@ const std::vector<Surface> &TextureManager::getSurfaces(
 		SETFile setFile;
 		if (!setFile.init(filename.c_str()))
 		{
-			DebugCrash("Could not init .SET file \"" + filename + "\".");
+			DebugLogWarning("Could not init .SET file \"" + filename + "\".");
+			return false;
 		}
 
-		// Create a surface for each image in the .SET.
 		for (int i = 0; i < setFile.getImageCount(); i++)
 		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				SETFile::CHUNK_WIDTH, SETFile::CHUNK_HEIGHT, setFile.getPixels(i), palette);
-			surfaceSet.push_back(std::move(surface));
+			addImage(SETFile::CHUNK_WIDTH, SETFile::CHUNK_HEIGHT, setFile.getPixels(i), nullptr);
 		}
 	}
 	else
 	{
-		DebugCrash("Unrecognized surface list \"" + filename + "\".");
+		DebugLogWarning("Unrecognized surface list \"" + filename + "\".");
+		return false;
+	}
+
+	return true;
+}
+
+std::vector<TextureManager::PalettedImage> TextureManager::loadPalettedImages(
+	const ImagePack &imagePack, const std::string &filename, bool isSet)
+{
+	// Loose files replace archive entries, so the pack is only used for ones that don't.
+	int firstImage, imageCount;
+	if (imagePack.find(filename, &firstImage, &imageCount) &&
+		VFS::Manager::get().isInGlobalBSA(filename.c_str()))
+	{
+		std::vector<PalettedImage> images(imageCount);
+		for (int i = 0; i < imageCount; i++)
+		{
+			const ImagePack::Image packImage = imagePack.getImage(firstImage + i);
+			PalettedImage &image = images[i];
+			image.width = packImage.width;
+			image.height = packImage.height;
+			image.packedPixels = packImage.pixels;
+			if (packImage.paletteColors != nullptr)
+			{
+				image.ownPalette = std::make_unique<Palette>();
+				auto &colors = image.ownPalette->get();
+				for (size_t j = 0; j < colors.size(); j++)
+				{
+					const uint8_t *color = packImage.paletteColors + (j * 4);
+					colors[j] = Color(color[0], color[1], color[2], color[3]);
+				}
+			}
+
+			image.usesOwnPalette = packImage.usesOwnPalette;
+		}
+
+		return images;
+	}
+
+	std::vector<PalettedImage> images;
+	const bool success = isSet ? TextureManager::decodePalettedImageSet(filename, &images) :
+		TextureManager::decodePalettedImage(filename, &images);
+	if (!success)
+	{
+		DebugCrash("Could not load \"" + filename + "\".");
+	}
+
+	return images;
+}
+
+Surface TextureManager::makeSurface(const PalettedImage &image, const Palette *palette)
+{
+	// Decide if the image will use its own palette or not.
+	const bool useOwnPalette = image.usesOwnPalette || (palette == nullptr);
+	DebugAssertMsg(!useOwnPalette || (image.ownPalette != nullptr),
+		"Image has no built-in palette.");
+
+	const Palette &imagePalette = useOwnPalette ? *image.ownPalette : *palette;
+	return TextureManager::make32BitFromPaletted(image.width, image.height,
+		image.getPixels(), imagePalette);
+}
+
+std::vector<Surface> TextureManager::makeSurfaces(const std::vector<PalettedImage> &images,
+	const Palette *palette)
+{
+	std::vector<Surface> surfaces;
+	surfaces.reserve(images.size());
+	for (const PalettedImage &image : images)
+	{
+		surfaces.push_back(TextureManager::makeSurface(image, palette));
+	}
+
+	return surfaces;
+}
+
+const std::vector<TextureManager::PalettedImage> &TextureManager::getPalettedImages(
+	const std::string &filename, bool isSet)
+{
+	const std::vector<PalettedImage> *cachedImages =
+		this->findEntry(this->palettedImages, filename);
+	if (cachedImages != nullptr)
+	{
+		return *cachedImages;
+	}
+
+	// Wait for the index data if it was requested ahead of time.
+	const auto pendingIter = this->pendingImages.find(filename);
+	if (pendingIter != this->pendingImages.end())
+	{
+		std::vector<PalettedImage> images = pendingIter->second.get();
+		this->pendingImages.erase(pendingIter);
+		return this->addEntry(this->palettedImages, filename, std::move(images));
 	}
 
-	return surfaceSet;
+	std::vector<PalettedImage> images =
+		TextureManager::loadPalettedImages(this->imagePack, filename, isSet);
+	return this->addEntry(this->palettedImages, filename, std::move(images));
+}
+
+void TextureManager::finishPendingTextures(const std::string &fullName,
+	PendingTextures &pending, Renderer &renderer)
+{
+	std::vector<PalettedImage> images = pending.images.get();
+	const std::vector<Surface> surfaces = TextureManager::makeSurfaces(images,
+		pending.useBuiltInPalette ? nullptr : &this->palettes.at(pending.paletteName));
+
+	// Keep the index data for when the same file is wanted with another palette.
+	if (this->palettedImages.find(pending.filename) == this->palettedImages.end())
+	{
+		this->addEntry(this->palettedImages, pending.filename, std::move(images));
+	}
+
+	std::vector<Texture> textureSet;
+	for (const Surface &surface : surfaces)
+	{
+		Texture texture = renderer.createTextureFromSurface(surface);
+
+		// Set alpha transparency on.
+		SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+		textureSet.push_back(std::move(texture));
+	}
+
+	if (pending.isSet)
+	{
+		this->addEntry(this->textureSets, fullName, std::move(textureSet));
+	}
+	else
+	{
+		DebugAssert(textureSet.size() == 1);
+		this->addEntry(this->textures, fullName, std::move(textureSet.front()));
+	}
+}
+
+const Surface &TextureManager::getSurface(const std::string &filename,
+	const std::string &paletteName)
+{
+	// Use this name when interfacing with the surfaces map.
+	const std::string fullName = filename + paletteName;
+
+	// See if the image file has already been loaded with the palette.
+	const Surface *cachedSurface = this->findEntry(this->surfaces, fullName);
+	if (cachedSurface != nullptr)
+	{
+		// The requested surface exists.
+		return *cachedSurface;
+	}
+
+	// If it went cold, decompress it instead of loading it again.
+	const Surface *coldSurface = this->findColdEntry(this->surfaces, this->coldSurfaces,
+		fullName);
+	if (coldSurface != nullptr)
+	{
+		return *coldSurface;
+	}
+
+	// The image hasn't been loaded with the palette yet, so make a new entry.
+	const Palette *palette = this->loadImagePalette(filename, paletteName);
+	const std::vector<PalettedImage> &images = this->getPalettedImages(filename, false);
+	Surface surface = TextureManager::makeSurface(images.front(), palette);
+
+	// Add the new surface and return it.
+	return this->addEntry(this->surfaces, fullName, std::move(surface));
+}
+
+const Surface &TextureManager::getSurface(const std::string &filename)
+{
+	return this->getSurface(filename, this->activePalette);
+}
+
+const Texture &TextureManager::getTexture(const std::string &filename,
+	const std::string &paletteName, Renderer &renderer)
+{
+	// Use this name when interfacing with the textures map.
+	const std::string fullName = filename + paletteName;
+
+	// See if the image file has already been loaded with the palette.
+	const Texture *cachedTexture = this->findEntry(this->textures, fullName);
+	if (cachedTexture != nullptr)
+	{
+		// The requested texture exists.
+		return *cachedTexture;
+	}
+
+	// If it was requested ahead of time, wait for that instead of decoding it again.
+	auto pendingIter = this->pendingTextures.find(fullName);
+	if (pendingIter != this->pendingTextures.end())
+	{
+		this->finishPendingTextures(fullName, pendingIter->second, renderer);
+		this->pendingTextures.erase(pendingIter);
+		return this->textures.at(fullName).value;
+	}
+
+	// The image hasn't been loaded with the palette yet, so make a new entry.
+	// Check what kind of file extension the filename has.
+	const std::string_view extension = StringView::getExtension(filename);
+	const bool isIMG = extension == "IMG";
+	const bool isMNU = extension == "MNU";
+	if (!isIMG && !isMNU)
+	{
+		DebugCrash("Unrecognized texture format \"" + filename + "\".");
+	}
+
+	const Palette *palette = this->loadImagePalette(filename, paletteName);
+	const std::vector<PalettedImage> &images = this->getPalettedImages(filename, false);
+	const Surface surface = TextureManager::makeSurface(images.front(), palette);
+
+	// Create a texture from the surface.
+	Texture texture = renderer.createTextureFromSurface(surface);
+
+	// Set alpha transparency on.
+	SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+
+	// Add the new texture and return it.
+	const Texture &newTexture = this->addEntry(this->textures, fullName, std::move(texture));
+	DebugAssert(texture.get() == nullptr);
+	return newTexture;
+}
+
+const Texture &TextureManager::getTexture(const std::string &filename, Renderer &renderer)
+{
+	return this->getTexture(filename, this->activePalette, renderer);
+}
+
+const std::vector<Surface> &TextureManager::getSurfaces(
+	const std::string &filename, const std::string &paletteName)
+{
+	// Use this name when interfacing with the surface sets map.
+	const std::string fullName = filename + paletteName;
+
+	// See if the file has already been loaded with the palette.
+	const std::vector<Surface> *cachedSet = this->findEntry(this->surfaceSets, fullName);
+	if (cachedSet != nullptr)
+	{
+		// The requested texture set exists.
+		return *cachedSet;
+	}
+
+	// If it went cold, decompress it instead of loading it again.
+	const std::vector<Surface> *coldSet = this->findColdEntry(this->surfaceSets,
+		this->coldSurfaceSets, fullName);
+	if (coldSet != nullptr)
+	{
+		return *coldSet;
+	}
+
+	// Do not use a built-in palette for surface sets.
+	DebugAssertMsg(!Palette::isBuiltIn(paletteName),
+		"Image sets (i.e., .SET files) do not have built-in palettes.");
+
+	// The file hasn't been loaded with the palette yet, so make a new entry.
+	const Palette *palette = this->loadImagePalette(filename, paletteName);
+	const std::vector<PalettedImage> &images = this->getPalettedImages(filename, true);
+	std::vector<Surface> surfaceSet = TextureManager::makeSurfaces(images, palette);
+
+	return this->addEntry(this->surfaceSets, fullName, std::move(surfaceSet));
 }
 
 const std::vector<Surface> &TextureManager::getSurfaces(const std::string &filename)
@@ -439,167 +1047,362 @@ const std::vector<Surface> &TextureManager::getSurfaces(const std::string &filen
 const std::vector<Texture> &TextureManager::getTextures(
 	const std::string &filename, const std::string &paletteName, Renderer &renderer)
 {
-	// This method deals with animations and movies, so it will check filenames 
-	// for ".CFA", ".CIF", ".DFA", ".FLC", ".SET", etc..
-
 	// Use this name when interfacing with the texture sets map.
 	const std::string fullName = filename + paletteName;
 
 	// See if the file has already been loaded with the palette.
-	auto setIter = this->textureSets.find(fullName);
-	if (setIter != this->textureSets.end())
+	const std::vector<Texture> *cachedSet = this->findEntry(this->textureSets, fullName);
+	if (cachedSet != nullptr)
 	{
 		// The requested texture set exists.
-		return setIter->second;
+		return *cachedSet;
+	}
+
+	// If it was requested ahead of time, wait for that instead of decoding it again.
+	auto pendingIter = this->pendingTextures.find(fullName);
+	if (pendingIter != this->pendingTextures.end())
+	{
+		this->finishPendingTextures(fullName, pendingIter->second, renderer);
+		this->pendingTextures.erase(pendingIter);
+		return this->textureSets.at(fullName).value;
 	}
 
 	// Do not use a built-in palette for texture sets.
 	DebugAssertMsg(!Palette::isBuiltIn(paletteName),
 		"Image sets (i.e., .SET files) do not have built-in palettes.");
 
-	// See if the palette hasn't already been loaded.
-	if (this->palettes.find(paletteName) == this->palettes.end())
+	// The file hasn't been loaded with the palette yet, so make a new entry.
+	const Palette *palette = this->loadImagePalette(filename, paletteName);
+	const std::vector<PalettedImage> &images = this->getPalettedImages(filename, true);
+	const std::vector<Surface> surfaceSet = TextureManager::makeSurfaces(images, palette);
+
+	std::vector<Texture> textureSet;
+	for (const Surface &surface : surfaceSet)
 	{
-		this->loadPalette(paletteName);
+		Texture texture = renderer.createTextureFromSurface(surface);
+
+		// Set alpha transparency on.
+		SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+		textureSet.push_back(std::move(texture));
 	}
 
-	// The file hasn't been loaded with the palette yet, so make a new entry.
-	const auto iter = this->textureSets.emplace(
-		std::make_pair(fullName, std::vector<Texture>())).first;
+	return this->addEntry(this->textureSets, fullName, std::move(textureSet));
+}
 
-	std::vector<Texture> &textureSet = iter->second;
-	const Palette &palette = this->palettes.at(paletteName);
+const std::vector<Texture> &TextureManager::getTextures(const std::string &filename,
+	Renderer &renderer)
+{
+	return this->getTextures(filename, this->activePalette, renderer);
+}
 
-	const std::string_view extension = StringView::getExtension(filename);
-	const bool isCFA = extension == "CFA";
-	const bool isCIF = extension == "CIF";
-	const bool isCEL = extension == "CEL";
-	const bool isDFA = extension == "DFA";
-	const bool isFLC = extension == "FLC";
-	const bool isRCI = extension == "RCI";
-	const bool isSET = extension == "SET";
+const TextureAtlas::Region &TextureManager::getAtlasImage(const std::string &filename,
+	const std::string &paletteName, Renderer &renderer)
+{
+	const std::string fullName = filename + paletteName;
+	const auto iter = this->atlasImages.find(fullName);
+	if (iter != this->atlasImages.end())
+	{
+		return iter->second;
+	}
 
-	if (isCFA)
+	// Expand the image into a scratch surface and copy it into the atlas.
+	const Palette *palette = this->loadImagePalette(filename, paletteName);
+	const std::vector<PalettedImage> &images = this->getPalettedImages(filename, false);
+	const Surface surface = TextureManager::makeSurface(images.front(), palette);
+	const TextureAtlas::Region region = this->atlas.add(surface, renderer);
+
+	return this->atlasImages.emplace(std::make_pair(fullName, region)).first->second;
+}
+
+const std::vector<TextureAtlas::Region> &TextureManager::getAtlasImages(
+	const std::string &filename, const std::string &paletteName, Renderer &renderer)
+{
+	const std::string fullName = filename + paletteName;
+	const auto iter = this->atlasImageSets.find(fullName);
+	if (iter != this->atlasImageSets.end())
 	{
-		CFAFile cfaFile;
-		if (!cfaFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .CFA file \"" + filename + "\".");
-		}
+		return iter->second;
+	}
 
-		// Create a texture for each image in the .CFA.
-		for (int i = 0; i < cfaFile.getImageCount(); i++)
-		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				cfaFile.getWidth(), cfaFile.getHeight(), cfaFile.getPixels(i), palette);
-			Texture texture = renderer.createTextureFromSurface(surface);
-			textureSet.push_back(std::move(texture));
-		}
+	// Do not use a built-in palette for image sets.
+	DebugAssertMsg(!Palette::isBuiltIn(paletteName),
+		"Image sets (i.e., .SET files) do not have built-in palettes.");
+
+	const Palette *palette = this->loadImagePalette(filename, paletteName);
+	const std::vector<PalettedImage> &images = this->getPalettedImages(filename, true);
+
+	std::vector<TextureAtlas::Region> regions;
+	for (const PalettedImage &image : images)
+	{
+		const Surface surface = TextureManager::makeSurface(image, palette);
+		regions.push_back(this->atlas.add(surface, renderer));
 	}
-	else if (isCIF)
+
+	return this->atlasImageSets.emplace(std::make_pair(fullName, std::move(regions))).first->second;
+}
+
+const Texture &TextureManager::getAtlasPage(int pageIndex) const
+{
+	return this->atlas.getPage(pageIndex);
+}
+
+TextureManager::SurfaceID TextureManager::getSurfaceID(const std::string &filename,
+	const std::string &paletteName)
+{
+	const std::string fullName = filename + paletteName;
+	const auto iter = this->surfaceIDs.find(fullName);
+	if (iter != this->surfaceIDs.end())
 	{
-		CIFFile cifFile;
-		if (!cifFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .CIF file \"" + filename + "\".");
-		}
+		return iter->second;
+	}
 
-		// Create a texture for each image in the .CIF.
-		for (int i = 0; i < cifFile.getImageCount(); i++)
-		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				cifFile.getWidth(i), cifFile.getHeight(i), cifFile.getPixels(i), palette);
-			Texture texture = renderer.createTextureFromSurface(surface);
-			textureSet.push_back(std::move(texture));
-		}
+	const SurfaceID id = static_cast<SurfaceID>(this->surfaceHandles.size());
+	this->surfaceHandles.push_back(&this->getSurface(filename, paletteName));
+	this->surfaceIDs.emplace(std::make_pair(fullName, id));
+	this->pinEntry(this->surfaces, fullName);
+	return id;
+}
+
+TextureManager::TextureID TextureManager::getTextureID(const std::string &filename,
+	const std::string &paletteName, Renderer &renderer)
+{
+	const std::string fullName = filename + paletteName;
+	const auto iter = this->textureIDs.find(fullName);
+	if (iter != this->textureIDs.end())
+	{
+		return iter->second;
 	}
-	else if (isDFA)
+
+	const TextureID id = static_cast<TextureID>(this->textureHandles.size());
+	this->textureHandles.push_back(&this->getTexture(filename, paletteName, renderer));
+	this->textureIDs.emplace(std::make_pair(fullName, id));
+	this->pinEntry(this->textures, fullName);
+	return id;
+}
+
+TextureManager::SurfaceSetID TextureManager::getSurfaceSetID(const std::string &filename,
+	const std::string &paletteName)
+{
+	const std::string fullName = filename + paletteName;
+	const auto iter = this->surfaceSetIDs.find(fullName);
+	if (iter != this->surfaceSetIDs.end())
 	{
-		DFAFile dfaFile;
-		if (!dfaFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .DFA file \"" + filename + "\".");
-		}
+		return iter->second;
+	}
 
-		// Create a texture for each image in the .DFA.
-		for (int i = 0; i < dfaFile.getImageCount(); i++)
-		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				dfaFile.getWidth(), dfaFile.getHeight(), dfaFile.getPixels(i), palette);
-			Texture texture = renderer.createTextureFromSurface(surface);
-			textureSet.push_back(std::move(texture));
-		}
+	const SurfaceSetID id = static_cast<SurfaceSetID>(this->surfaceSetHandles.size());
+	this->surfaceSetHandles.push_back(&this->getSurfaces(filename, paletteName));
+	this->surfaceSetIDs.emplace(std::make_pair(fullName, id));
+	this->pinEntry(this->surfaceSets, fullName);
+	return id;
+}
+
+TextureManager::TextureSetID TextureManager::getTextureSetID(const std::string &filename,
+	const std::string &paletteName, Renderer &renderer)
+{
+	const std::string fullName = filename + paletteName;
+	const auto iter = this->textureSetIDs.find(fullName);
+	if (iter != this->textureSetIDs.end())
+	{
+		return iter->second;
 	}
-	else if (isFLC || isCEL)
+
+	const TextureSetID id = static_cast<TextureSetID>(this->textureSetHandles.size());
+	this->textureSetHandles.push_back(&this->getTextures(filename, paletteName, renderer));
+	this->textureSetIDs.emplace(std::make_pair(fullName, id));
+	this->pinEntry(this->textureSets, fullName);
+	return id;
+}
+
+TextureManager::SurfaceID TextureManager::getSurfaceID(const std::string &filename)
+{
+	return this->getSurfaceID(filename, this->activePalette);
+}
+
+TextureManager::TextureID TextureManager::getTextureID(const std::string &filename,
+	Renderer &renderer)
+{
+	return this->getTextureID(filename, this->activePalette, renderer);
+}
+
+TextureManager::SurfaceSetID TextureManager::getSurfaceSetID(const std::string &filename)
+{
+	return this->getSurfaceSetID(filename, this->activePalette);
+}
+
+TextureManager::TextureSetID TextureManager::getTextureSetID(const std::string &filename,
+	Renderer &renderer)
+{
+	return this->getTextureSetID(filename, this->activePalette, renderer);
+}
+
+const Surface &TextureManager::getSurface(SurfaceID id) const
+{
+	DebugAssertIndex(this->surfaceHandles, id);
+	return *this->surfaceHandles[id];
+}
+
+const Texture &TextureManager::getTexture(TextureID id) const
+{
+	DebugAssertIndex(this->textureHandles, id);
+	return *this->textureHandles[id];
+}
+
+const std::vector<Surface> &TextureManager::getSurfaces(SurfaceSetID id) const
+{
+	DebugAssertIndex(this->surfaceSetHandles, id);
+	return *this->surfaceSetHandles[id];
+}
+
+const std::vector<Texture> &TextureManager::getTextures(TextureSetID id) const
+{
+	DebugAssertIndex(this->textureSetHandles, id);
+	return *this->textureSetHandles[id];
+}
+
+void TextureManager::requestImagesAsync(const std::string &filename,
+	const std::string &paletteName, bool isSet)
+{
+	const std::string fullName = filename + paletteName;
+	const bool isLoaded = isSet ?
+		(this->textureSets.find(fullName) != this->textureSets.end()) :
+		(this->textures.find(fullName) != this->textures.end());
+	if (isLoaded || (this->pendingTextures.find(fullName) != this->pendingTextures.end()))
 	{
-		FLCFile flcFile;
-		if (!flcFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .FLC/.CEL file \"" + filename + "\".");
-		}
+		return;
+	}
 
-		// Create a texture for each frame in the .FLC.
-		for (int i = 0; i < flcFile.getFrameCount(); i++)
-		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				flcFile.getWidth(), flcFile.getHeight(), flcFile.getPixels(i),
-				flcFile.getFramePalette(i));
-			Texture texture = renderer.createTextureFromSurface(surface);
-			textureSet.push_back(std::move(texture));
-		}
+	// If the index data is already cached or being decoded, the getter only has to expand
+	// it, which is cheap enough to not need a worker.
+	if ((this->palettedImages.find(filename) != this->palettedImages.end()) ||
+		(this->pendingImages.find(filename) != this->pendingImages.end()))
+	{
+		return;
 	}
-	else if (isRCI)
+
+	// Palettes are loaded here since the palettes map is only used on this thread.
+	const Palette *palette = this->loadImagePalette(filename, paletteName);
+
+	PendingTextures pending;
+	pending.filename = filename;
+	pending.paletteName = paletteName;
+	pending.useBuiltInPalette = palette == nullptr;
+	pending.isSet = isSet;
+	const ImagePack &imagePack = this->imagePack;
+	pending.images = JobSystem::submit(JobSystem::Priority::Streaming,
+		[&imagePack, filename, isSet]()
 	{
-		RCIFile rciFile;
-		if (!rciFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .RCI file \"" + filename + "\".");
-		}
+		return TextureManager::loadPalettedImages(imagePack, filename, isSet);
+	});
 
-		// Create a texture for each image in the .RCI.
-		for (int i = 0; i < rciFile.getImageCount(); i++)
-		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				RCIFile::WIDTH, RCIFile::HEIGHT, rciFile.getPixels(i), palette);
-			Texture texture = renderer.createTextureFromSurface(surface);
-			textureSet.push_back(std::move(texture));
-		}
+	this->pendingTextures.emplace(std::make_pair(fullName, std::move(pending)));
+}
+
+void TextureManager::requestTextureAsync(const std::string &filename,
+	const std::string &paletteName)
+{
+	const std::string_view extension = StringView::getExtension(filename);
+	const bool isIMG = extension == "IMG";
+	const bool isMNU = extension == "MNU";
+	if (!isIMG && !isMNU)
+	{
+		DebugCrash("Unrecognized texture format \"" + filename + "\".");
 	}
-	else if (isSET)
+
+	this->requestImagesAsync(filename, paletteName, false);
+}
+
+void TextureManager::requestTexturesAsync(const std::string &filename,
+	const std::string &paletteName)
+{
+	// Do not use a built-in palette for texture sets.
+	DebugAssertMsg(!Palette::isBuiltIn(paletteName),
+		"Image sets (i.e., .SET files) do not have built-in palettes.");
+
+	this->requestImagesAsync(filename, paletteName, true);
+}
+
+void TextureManager::requestTexturesAsync(const std::string &filename)
+{
+	this->requestTexturesAsync(filename, this->activePalette);
+}
+
+void TextureManager::requestImageDataAsync(const std::string &filename, bool isSet)
+{
+	if ((this->palettedImages.find(filename) != this->palettedImages.end()) ||
+		(this->pendingImages.find(filename) != this->pendingImages.end()))
 	{
-		SETFile setFile;
-		if (!setFile.init(filename.c_str()))
-		{
-			DebugCrash("Could not init .SET file \"" + filename + "\".");
-		}
+		return;
+	}
 
-		// Create a texture for each image in the .SET.
-		for (int i = 0; i < setFile.getImageCount(); i++)
+	const ImagePack &imagePack = this->imagePack;
+	this->pendingImages.emplace(std::make_pair(filename, JobSystem::submit(
+		JobSystem::Priority::Background, [&imagePack, filename, isSet]()
+	{
+		return TextureManager::loadPalettedImages(imagePack, filename, isSet);
+	})));
+}
+
+const TextureManager::CacheStats &TextureManager::getCacheStats() const
+{
+	return this->cacheStats;
+}
+
+void TextureManager::reportMemory(MemoryReport &report) const
+{
+	auto addEntries = [&report](const auto &map, const std::string &name)
+	{
+		size_t byteCount = 0;
+		for (const auto &pair : map)
 		{
-			Surface surface = TextureManager::make32BitFromPaletted(
-				SETFile::CHUNK_WIDTH, SETFile::CHUNK_HEIGHT, setFile.getPixels(i), palette);
-			Texture texture = renderer.createTextureFromSurface(surface);
-			textureSet.push_back(std::move(texture));
+			byteCount += pair.second.byteCount;
 		}
-	}
-	else
+
+		report.add(name, byteCount);
+	};
+
+	addEntries(this->surfaces, "Textures/Surfaces");
+	addEntries(this->textures, "Textures/GPU textures");
+	addEntries(this->surfaceSets, "Textures/Surface sets");
+	addEntries(this->coldSurfaces, "Textures/Cold surfaces");
+	addEntries(this->coldSurfaceSets, "Textures/Cold surface sets");
+	addEntries(this->textureSets, "Textures/GPU texture sets");
+
+	// Animation frames are the bulk of the index data, so they're split out.
+	size_t animationBytes = 0;
+	size_t imageBytes = 0;
+	for (const auto &pair : this->palettedImages)
 	{
-		DebugCrash("Unrecognized texture list \"" + filename + "\".");
+		const std::string_view extension = StringView::getExtension(pair.first);
+		const bool isAnimation = StringView::caseInsensitiveEquals(extension, "FLC") ||
+			StringView::caseInsensitiveEquals(extension, "CEL");
+		(isAnimation ? animationBytes : imageBytes) += pair.second.byteCount;
 	}
 
-	// Set alpha transparency on for each texture.
-	for (auto &texture : textureSet)
+	report.add("Textures/Paletted images", imageBytes);
+	report.add("Textures/FLC frames", animationBytes);
+
+	size_t atlasBytes = 0;
+	for (int i = 0; i < this->atlas.getPageCount(); i++)
 	{
-		SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+		atlasBytes += getByteCount(this->atlas.getPage(i));
 	}
 
-	return textureSet;
+	report.add("Textures/UI atlas", atlasBytes);
 }
 
-const std::vector<Texture> &TextureManager::getTextures(const std::string &filename,
-	Renderer &renderer)
+bool TextureManager::isTextureLoaded(const std::string &filename,
+	const std::string &paletteName) const
 {
-	return this->getTextures(filename, this->activePalette, renderer);
+	const std::string fullName = filename + paletteName;
+	return (this->textures.find(fullName) != this->textures.end()) ||
+		(this->textureSets.find(fullName) != this->textureSets.end());
+}
+
+bool TextureManager::isTexturePending(const std::string &filename,
+	const std::string &paletteName) const
+{
+	return this->pendingTextures.find(filename + paletteName) != this->pendingTextures.end();
 }
 
 void TextureManager::init()
@@ -610,6 +1413,132 @@ void TextureManager::init()
 	this->setPalette(PaletteFile::fromName(PaletteName::Default));
 }
 
+void TextureManager::initImagePack(const std::string &cacheFolder)
+{
+	VFS::Manager &vfs = VFS::Manager::get();
+	const uint64_t bsaHash = vfs.getGlobalBSAHash();
+	const std::string folder = String::addTrailingSlashIfMissing(cacheFolder);
+	const std::string filename = folder + "GLOBAL.BSA.images";
+	if (this->imagePack.init(filename, bsaHash))
+	{
+		return;
+	}
+
+	// Every image entry of the archive that isn't replaced by a loose file. Movies are left
+	// out since they're loose files and have a palette per frame.
+	std::vector<std::pair<std::string, bool>> entries;
+	for (const std::string &name : vfs.list())
+	{
+		const std::string_view extension = StringView::getExtension(name);
+		const bool isImage = (extension == "IMG") || (extension == "MNU");
+		const bool isSet = (extension == "CFA") || (extension == "CIF") ||
+			(extension == "DFA") || (extension == "RCI") || (extension == "SET");
+		if ((isImage || isSet) && vfs.isInGlobalBSA(name.c_str()))
+		{
+			entries.push_back(std::make_pair(name, isSet));
+		}
+	}
+
+	DebugLog("Baking " + std::to_string(entries.size()) + " GLOBAL.BSA images into \"" +
+		filename + "\".");
+	const auto startTime = std::chrono::steady_clock::now();
+
+	if (!Platform::directoryExists(folder))
+	{
+		Platform::createDirectoryRecursively(folder);
+	}
+
+	ImagePack::Writer writer;
+	if (!writer.init(filename))
+	{
+		return;
+	}
+
+	// Entries are decoded on the workers and written in order, so only the ones waiting to
+	// be written are held in memory. One that can't be decoded is left out of the pack and
+	// decoded as usual if it's ever loaded.
+	std::vector<std::future<std::vector<PalettedImage>>> decodedEntries;
+	decodedEntries.reserve(entries.size());
+	for (const auto &entry : entries)
+	{
+		decodedEntries.push_back(JobSystem::submit(JobSystem::Priority::Streaming, [entry]()
+		{
+			std::vector<PalettedImage> images;
+			const bool success = entry.second ?
+				TextureManager::decodePalettedImageSet(entry.first, &images) :
+				TextureManager::decodePalettedImage(entry.first, &images);
+			if (!success)
+			{
+				images.clear();
+			}
+
+			return images;
+		}));
+	}
+
+	std::vector<ImagePack::Image> packImages;
+	std::vector<uint8_t> paletteColors;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const std::vector<PalettedImage> images = decodedEntries[i].get();
+		if (images.empty())
+		{
+			continue;
+		}
+
+		paletteColors.resize(images.size() * ImagePack::PALETTE_BYTES);
+		packImages.clear();
+		for (size_t j = 0; j < images.size(); j++)
+		{
+			const PalettedImage &image = images[j];
+			ImagePack::Image packImage;
+			packImage.width = image.width;
+			packImage.height = image.height;
+			packImage.pixels = image.getPixels();
+			packImage.paletteColors = nullptr;
+			packImage.usesOwnPalette = image.usesOwnPalette;
+
+			if (image.ownPalette != nullptr)
+			{
+				uint8_t *dstColors = paletteColors.data() + (j * ImagePack::PALETTE_BYTES);
+				const auto &colors = image.ownPalette->get();
+				for (size_t k = 0; k < colors.size(); k++)
+				{
+					const Color &color = colors[k];
+					dstColors[(k * 4) + 0] = color.r;
+					dstColors[(k * 4) + 1] = color.g;
+					dstColors[(k * 4) + 2] = color.b;
+					dstColors[(k * 4) + 3] = color.a;
+				}
+
+				packImage.paletteColors = dstColors;
+			}
+
+			packImages.push_back(packImage);
+		}
+
+		writer.add(entries[i].first, packImages);
+	}
+
+	if (!writer.finish(bsaHash))
+	{
+		return;
+	}
+
+	const std::chrono::duration<double> bakeTime = std::chrono::steady_clock::now() - startTime;
+	DebugLog("Baked image pack in " + String::fixedPrecision(bakeTime.count(), 2) + "s.");
+
+	if (!this->imagePack.init(filename, bsaHash))
+	{
+		DebugLogWarning("Could not map new image pack \"" + filename + "\".");
+	}
+}
+
+void TextureManager::setMemoryBudget(size_t byteCount)
+{
+	this->cacheStats.budgetBytes = byteCount;
+}
+
 void TextureManager::setPalette(const std::string &paletteName)
 {
 	// Check if the palette hasn't already been loaded.
@@ -620,3 +1549,66 @@ void TextureManager::setPalette(const std::string &paletteName)
 
 	this->activePalette = paletteName;
 }
+
+void TextureManager::update(Renderer &renderer)
+{
+	ProfilerZone("Texture uploads");
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	auto iter = this->pendingTextures.begin();
+	while (iter != this->pendingTextures.end())
+	{
+		PendingTextures &pending = iter->second;
+		if (pending.images.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++iter;
+			continue;
+		}
+
+		this->finishPendingTextures(iter->first, pending, renderer);
+		iter = this->pendingTextures.erase(iter);
+
+		// Leave the rest for later frames if this one has spent its budget.
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+		if (seconds >= TextureManager::UPLOAD_BUDGET_SECONDS)
+		{
+			break;
+		}
+	}
+
+	// Cache index data that finished decoding. It's only moved, so there's no budget for it.
+	auto imagesIter = this->pendingImages.begin();
+	while (imagesIter != this->pendingImages.end())
+	{
+		std::future<std::vector<PalettedImage>> &images = imagesIter->second;
+		if (images.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++imagesIter;
+			continue;
+		}
+
+		if (this->palettedImages.find(imagesIter->first) == this->palettedImages.end())
+		{
+			this->addEntry(this->palettedImages, imagesIter->first, images.get());
+		}
+
+		imagesIter = this->pendingImages.erase(imagesIter);
+	}
+
+	// Compress surfaces that went cold, a few at a time so leaving a screen doesn't stall
+	// a frame later on.
+	const auto nowTime = std::chrono::steady_clock::now();
+	this->currentSeconds = std::chrono::duration<double>(nowTime - this->startTime).count();
+
+	const auto compressDeadline = nowTime + std::chrono::duration_cast<
+		std::chrono::steady_clock::duration>(std::chrono::duration<double>(
+			TextureManager::COMPRESS_BUDGET_SECONDS));
+	if (this->compressColdEntries(this->surfaces, this->coldSurfaces, compressDeadline))
+	{
+		this->compressColdEntries(this->surfaceSets, this->coldSurfaceSets, compressDeadline);
+	}
+
+	this->evictToBudget();
+	this->frameIndex++;
+}
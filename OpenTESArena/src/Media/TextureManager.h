@@ -1,29 +1,183 @@
 #ifndef TEXTURE_MANAGER_H
 #define TEXTURE_MANAGER_H
 
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Palette.h"
+#include "../Assets/ImagePack.h"
 #include "../Rendering/Surface.h"
 #include "../Rendering/Texture.h"
+#include "../Rendering/TextureAtlas.h"
 
+class MemoryReport;
 class Renderer;
 
 class TextureManager
 {
+public:
+	// Interned handles to loaded images, for ones looked up every frame. Looking one up is
+	// an array index instead of building and hashing a name.
+	using SurfaceID = int;
+	using TextureID = int;
+	using SurfaceSetID = int;
+	using TextureSetID = int;
+
+	// Cache counters since startup, and how much is resident now.
+	struct CacheStats
+	{
+		uint64_t hitCount, missCount, evictionCount, compressionCount;
+		size_t residentBytes, pinnedBytes, budgetBytes;
+		size_t coldBytes; // Part of the resident bytes.
+	};
+
+	// An image's 8-bit palette indices as stored in its file, before any palette is
+	// applied. Cached once per file so the same image under another palette only has to
+	// be expanded again, not decoded.
+	struct PalettedImage
+	{
+		int width, height;
+		std::vector<uint8_t> pixels; // Empty if the pixels are read from the image pack.
+		const uint8_t *packedPixels; // Pixels in the image pack, if they're from it.
+		std::unique_ptr<Palette> ownPalette; // Built-in palette, if any.
+		bool usesOwnPalette; // Ignores the requested palette (.FLC frames, .COL swatches).
+
+		PalettedImage();
+
+		const uint8_t *getPixels() const;
+	};
 private:
+	// A cached image or image set and what's needed for evicting it.
+	template <typename T>
+	struct CacheEntry
+	{
+		T value;
+		size_t byteCount; // Estimated pixel memory.
+		uint64_t lastUsedFrame;
+		double lastUsedSeconds; // Since the manager was created.
+		bool pinned; // Has an ID, so it's never evicted.
+	};
+
+	// A surface that hasn't been used in a while, kept as compressed 8-bit indices into the
+	// colors it uses so it's small but doesn't have to be loaded again.
+	struct ColdSurface
+	{
+		int width, height;
+		Palette palette;
+		std::vector<uint8_t> compressedIndices;
+	};
+
+	// Images being decoded on a worker thread for textures requested ahead of time.
+	struct PendingTextures
+	{
+		std::future<std::vector<PalettedImage>> images;
+		std::string filename, paletteName;
+		bool useBuiltInPalette;
+		bool isSet; // Whether they go to getTextures() or getTexture().
+	};
+
+	// How long update() can spend creating textures from finished requests each frame.
+	static const double UPLOAD_BUDGET_SECONDS;
+
+	// How long an unpinned surface can go unused before it's compressed, and how long
+	// update() can spend compressing them each frame.
+	static const double COLD_SECONDS;
+	static const double COMPRESS_BUDGET_SECONDS;
+
 	std::unordered_map<std::string, Palette> palettes;
 
+	// Decoded GLOBAL.BSA images, if a pack is in use. Declared before the caches since their
+	// index data can point into it.
+	ImagePack imagePack;
+
 	// The filename and palette name are concatenated when mapping to avoid using two 
-	// maps. I.e., "EQUIPMEN.IMG" and "PAL.COL" become "EQUIPMEN.IMGPAL.COL".
-	std::unordered_map<std::string, Surface> surfaces;
-	std::unordered_map<std::string, Texture> textures;
-	std::unordered_map<std::string, std::vector<Surface>> surfaceSets;
-	std::unordered_map<std::string, std::vector<Texture>> textureSets;
+	// maps. I.e., "EQUIPMEN.IMG" and "PAL.COL" become "EQUIPMEN.IMGPAL.COL". The
+	// palette-independent index data is mapped by filename alone.
+	std::unordered_map<std::string, CacheEntry<Surface>> surfaces;
+	std::unordered_map<std::string, CacheEntry<Texture>> textures;
+	std::unordered_map<std::string, CacheEntry<std::vector<Surface>>> surfaceSets;
+	std::unordered_map<std::string, CacheEntry<std::vector<Texture>>> textureSets;
+	std::unordered_map<std::string, CacheEntry<std::vector<PalettedImage>>> palettedImages;
+	std::unordered_map<std::string, PendingTextures> pendingTextures;
+
+	// Surfaces and surface sets that went cold, by concatenated name. An entry is in either
+	// its hot map or its cold one, and it's moved back on the next lookup.
+	std::unordered_map<std::string, CacheEntry<ColdSurface>> coldSurfaces;
+	std::unordered_map<std::string, CacheEntry<std::vector<ColdSurface>>> coldSurfaceSets;
+
+	// Index data being decoded on a worker thread for surfaces requested ahead of time, by
+	// filename.
+	std::unordered_map<std::string, std::future<std::vector<PalettedImage>>> pendingImages;
 	std::string activePalette;
 
+	// Small UI images packed into shared pages, by concatenated name. Atlas images are
+	// never evicted.
+	TextureAtlas atlas;
+	std::unordered_map<std::string, TextureAtlas::Region> atlasImages;
+	std::unordered_map<std::string, std::vector<TextureAtlas::Region>> atlasImageSets;
+
+	// Entries of the maps above by ID, and the IDs by concatenated name. Map elements
+	// don't move, so the pointers stay valid.
+	std::vector<const Surface*> surfaceHandles;
+	std::vector<const Texture*> textureHandles;
+	std::vector<const std::vector<Surface>*> surfaceSetHandles;
+	std::vector<const std::vector<Texture>*> textureSetHandles;
+	std::unordered_map<std::string, SurfaceID> surfaceIDs;
+	std::unordered_map<std::string, TextureID> textureIDs;
+	std::unordered_map<std::string, SurfaceSetID> surfaceSetIDs;
+	std::unordered_map<std::string, TextureSetID> textureSetIDs;
+
+	// Unpinned entries not used recently are evicted by update() while the resident bytes
+	// are over the budget (zero for no limit).
+	CacheStats cacheStats;
+	uint64_t frameIndex;
+	std::chrono::steady_clock::time_point startTime;
+	double currentSeconds; // Since the start time, as of the last update().
+
+	// Gets a cache entry's value and marks it used this frame, or null if not cached.
+	template <typename T>
+	const T *findEntry(std::unordered_map<std::string, CacheEntry<T>> &map,
+		const std::string &fullName);
+
+	// Caches a newly loaded value.
+	template <typename T>
+	const T &addEntry(std::unordered_map<std::string, CacheEntry<T>> &map,
+		const std::string &fullName, T &&value);
+
+	// Gets a cold entry's value, decompressing it back into the hot map and marking it used
+	// this frame, or null if there's no cold entry.
+	template <typename Hot, typename Cold>
+	const Hot *findColdEntry(std::unordered_map<std::string, CacheEntry<Hot>> &hotMap,
+		std::unordered_map<std::string, CacheEntry<Cold>> &coldMap, const std::string &fullName);
+
+	// Moves hot entries that haven't been used for COLD_SECONDS to the cold map, until the
+	// deadline. Returns whether it finished before the deadline.
+	template <typename Hot, typename Cold>
+	bool compressColdEntries(std::unordered_map<std::string, CacheEntry<Hot>> &hotMap,
+		std::unordered_map<std::string, CacheEntry<Cold>> &coldMap,
+		std::chrono::steady_clock::time_point deadline);
+
+	// Keeps a cache entry from being evicted.
+	template <typename T>
+	void pinEntry(std::unordered_map<std::string, CacheEntry<T>> &map,
+		const std::string &fullName);
+
+	// Evicts least recently used entries until the resident bytes fit in the budget.
+	void evictToBudget();
+
+	// Compresses a surface or surface set for the cold tier. Returns false if a surface has
+	// more than 256 colors. Decompressing gives back the same pixels.
+	static bool compress(const Surface &surface, ColdSurface *outColdSurface);
+	static bool compress(const std::vector<Surface> &surfaces,
+		std::vector<ColdSurface> *outColdSurfaces);
+	static Surface decompress(const ColdSurface &coldSurface);
+	static std::vector<Surface> decompress(const std::vector<ColdSurface> &coldSurfaces);
+
 	// Specialty method for loading a COL file into the palettes map.
 	void loadCOLPalette(const std::string &colName);
 
@@ -32,18 +186,63 @@ private:
 
 	// Helper method for loading a palette file into the palettes map.
 	void loadPalette(const std::string &paletteName);
+
+	// Loads the palette an image uses if it isn't loaded yet. Returns null if the image
+	// uses its built-in palette.
+	const Palette *loadImagePalette(const std::string &filename, const std::string &paletteName);
+
+	// Decodes a .COL, .IMG, or .MNU into a one-image list. Returns false if it isn't an image
+	// that can be decoded. Safe to call from any thread.
+	static bool decodePalettedImage(const std::string &filename,
+		std::vector<PalettedImage> *outImages);
+
+	// Decodes each image in an image set (.CFA, .SET, etc.). Returns false if it isn't an
+	// image set that can be decoded. Safe to call from any thread.
+	static bool decodePalettedImageSet(const std::string &filename,
+		std::vector<PalettedImage> *outImages);
+
+	// Gets an image or image set's index data from the image pack if it's there, otherwise
+	// decodes it. Safe to call from any thread.
+	static std::vector<PalettedImage> loadPalettedImages(const ImagePack &imagePack,
+		const std::string &filename, bool isSet);
+
+	// Expands index data into 32-bit surfaces. The palette is null if the image's built-in
+	// palette is used.
+	static Surface makeSurface(const PalettedImage &image, const Palette *palette);
+	static std::vector<Surface> makeSurfaces(const std::vector<PalettedImage> &images,
+		const Palette *palette);
+
+	// Gets a file's index data, decoding it if it isn't cached.
+	const std::vector<PalettedImage> &getPalettedImages(const std::string &filename,
+		bool isSet);
+
+	// Shared by the async requests below.
+	void requestImagesAsync(const std::string &filename, const std::string &paletteName,
+		bool isSet);
+
+	// Creates textures from a finished async request and stores them. Blocks if the
+	// request's surfaces aren't decoded yet.
+	void finishPendingTextures(const std::string &fullName, PendingTextures &pending,
+		Renderer &renderer);
 public:
+	TextureManager();
 	~TextureManager();
 
 	TextureManager &operator=(TextureManager &&textureManager) = delete;
 
+	// Writes the 32-bit ARGB colors of 8-bit palette indices.
+	static void expandPaletted(const uint8_t *srcPixels, int pixelCount,
+		const Palette &palette, uint32_t *dstPixels);
+
 	// Creates a 32-bit image with the given dimensions and settings from an 8-bit image
 	// and a 256 color palette.
 	static Surface make32BitFromPaletted(int width, int height,
 		const uint8_t *srcPixels, const Palette &palette);
 
 	// Gets a surface by filename. It will be loaded if not already stored with the 
-	// requested palette. If no palette name is given, the active one is used.
+	// requested palette. If no palette name is given, the active one is used. Surfaces that
+	// go unused for a while are compressed by update() and decompressed here, so the
+	// reference is only valid until the next update().
 	const Surface &getSurface(const std::string &filename, const std::string &paletteName);
 	const Surface &getSurface(const std::string &filename);
 
@@ -63,11 +262,87 @@ public:
 		const std::string &paletteName, Renderer &renderer);
 	const std::vector<Texture> &getTextures(const std::string &filename, Renderer &renderer);
 
+	// Gets where a small image or each image of a small image set is in the UI texture
+	// atlas, adding it if needed. Drawing several of these from the same page (e.g., with
+	// Renderer::drawOriginalClipped()) avoids a texture switch per image. Images must be
+	// no larger than TextureAtlas::MAX_IMAGE_WIDTH x MAX_IMAGE_HEIGHT.
+	const TextureAtlas::Region &getAtlasImage(const std::string &filename,
+		const std::string &paletteName, Renderer &renderer);
+	const std::vector<TextureAtlas::Region> &getAtlasImages(const std::string &filename,
+		const std::string &paletteName, Renderer &renderer);
+	const Texture &getAtlasPage(int pageIndex) const;
+
+	// Gets the ID of an image or image set, loading it like the getters above if needed.
+	// The palette is part of the ID, so the active palette at the time of the call is used
+	// if none is given. IDs stay valid for the manager's lifetime, and the image is never
+	// evicted, so the reference from the getters below can be kept.
+	SurfaceID getSurfaceID(const std::string &filename, const std::string &paletteName);
+	SurfaceID getSurfaceID(const std::string &filename);
+	TextureID getTextureID(const std::string &filename, const std::string &paletteName,
+		Renderer &renderer);
+	TextureID getTextureID(const std::string &filename, Renderer &renderer);
+	SurfaceSetID getSurfaceSetID(const std::string &filename, const std::string &paletteName);
+	SurfaceSetID getSurfaceSetID(const std::string &filename);
+	TextureSetID getTextureSetID(const std::string &filename, const std::string &paletteName,
+		Renderer &renderer);
+	TextureSetID getTextureSetID(const std::string &filename, Renderer &renderer);
+
+	// Gets a loaded image or image set by ID.
+	const Surface &getSurface(SurfaceID id) const;
+	const Texture &getTexture(TextureID id) const;
+	const std::vector<Surface> &getSurfaces(SurfaceSetID id) const;
+	const std::vector<Texture> &getTextures(TextureSetID id) const;
+
+	// Starts decoding the image for getTexture() or the image set for getTextures() on a
+	// worker thread, so a panel can request what the next one uses before it's needed.
+	// The textures are created by update() once decoded, or by the getter if it's called
+	// first. Does nothing if they're already loaded or requested.
+	void requestTextureAsync(const std::string &filename, const std::string &paletteName);
+	void requestTexturesAsync(const std::string &filename, const std::string &paletteName);
+	void requestTexturesAsync(const std::string &filename);
+
+	// Starts decoding an image or image set's index data on a worker thread, for surfaces that
+	// will be wanted soon but not this frame (i.e., the voxel textures of a level the player
+	// can walk into next). The getters wait for it instead of decoding again. Does nothing if
+	// it's already cached or requested.
+	void requestImageDataAsync(const std::string &filename, bool isSet);
+
+	// Returns whether the texture or texture set has been created, i.e., getTexture() or
+	// getTextures() with the same names won't load anything.
+	bool isTextureLoaded(const std::string &filename, const std::string &paletteName) const;
+
+	// Returns whether an async request for the texture or texture set is still waiting to
+	// be decoded or created. Once it isn't, the getter doesn't have to decode anything.
+	bool isTexturePending(const std::string &filename, const std::string &paletteName) const;
+
+	const CacheStats &getCacheStats() const;
+
+	// Adds the pixel memory of each kind of cached image to the report. Frames of .FLC and
+	// .CEL animations are counted on their own.
+	void reportMemory(MemoryReport &report) const;
+
 	void init();
 
+	// Maps the pack of decoded GLOBAL.BSA images in the given folder, baking it first if it's
+	// missing or was made from another copy of the archive. Images in the pack are then read
+	// from it in place instead of being decoded. Must be called before any images are loaded.
+	void initImagePack(const std::string &cacheFolder);
+
+	// Sets how many bytes of images can stay cached before the least recently used ones are
+	// evicted. Zero means no limit. References from name-based getters are only valid until
+	// the next update().
+	void setMemoryBudget(size_t byteCount);
+
+	// Creates textures for async requests that finished decoding, until this frame's time
+	// budget is used up, caches finished index data requests, compresses surfaces that went
+	// cold, and evicts images if over the memory budget. Must be called on the main thread
+	// once per frame.
+	void update(Renderer &renderer);
+
 	// Sets the palette to use for subsequent images. The source of the palette can be
 	// from a loose .COL file, or can be built into an .IMG. If the .IMG does not have a 
-	// built-in palette, an error occurs.
+	// built-in palette, an error occurs. Images already decoded under another palette
+	// are re-expanded from their cached index data instead of decoded again.
 	void setPalette(const std::string &paletteName);
 };
 
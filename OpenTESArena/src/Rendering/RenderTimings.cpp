@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "RenderTimings.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/String.h"
+
+RenderTimings::RenderTimings()
+{
+	this->mainTimes.fill(0.0);
+
+	for (auto &times : this->frameTimes)
+	{
+		times.fill(0.0);
+	}
+
+	this->nextFrameIndex = 0;
+	this->frameCount = 0;
+}
+
+std::string RenderTimings::getPhaseName(Phase phase)
+{
+	switch (phase)
+	{
+	case Phase::SkyGradient:
+		return "Sky gradient";
+	case Phase::DistantSky:
+		return "Distant sky";
+	case Phase::Voxels:
+		return "Voxels";
+	case Phase::VoxelHistory:
+		return "Voxel history";
+	case Phase::Flats:
+		return "Flats";
+	case Phase::PaletteResolve:
+		return "Palette resolve";
+	case Phase::Transpose:
+		return "Transpose";
+	case Phase::ThreadWait:
+		return "Thread wait";
+	case Phase::VisibleDistantObjects:
+		return "Visible distant";
+	case Phase::VisibleFlats:
+		return "Visible flats";
+	case Phase::MainThreadTask:
+		return "Main task";
+	case Phase::MainThreadWait:
+		return "Main wait";
+	case Phase::Render:
+		return "Render";
+	case Phase::Present:
+		return "Present";
+	default:
+		DebugUnhandledReturnMsg(std::string, std::to_string(static_cast<int>(phase)));
+	}
+}
+
+bool RenderTimings::isThreadPhase(Phase phase)
+{
+	return static_cast<int>(phase) <= static_cast<int>(Phase::ThreadWait);
+}
+
+int RenderTimings::getThreadCount() const
+{
+	return static_cast<int>(this->threadTimes.size());
+}
+
+double RenderTimings::getThreadTime(int threadIndex, Phase phase) const
+{
+	DebugAssert(RenderTimings::isThreadPhase(phase));
+	return this->threadTimes.at(threadIndex)[static_cast<int>(phase)];
+}
+
+double RenderTimings::getThreadBusyTime(int threadIndex) const
+{
+	const auto &times = this->threadTimes.at(threadIndex);
+	double busyTime = 0.0;
+	for (int i = 0; i < static_cast<int>(Phase::ThreadWait); i++)
+	{
+		busyTime += times[i];
+	}
+
+	return busyTime;
+}
+
+RenderTimings::Stats RenderTimings::getStats(Phase phase) const
+{
+	Stats stats;
+	if (this->frameCount == 0)
+	{
+		stats.min = 0.0;
+		stats.avg = 0.0;
+		stats.p99 = 0.0;
+		return stats;
+	}
+
+	// Only the first frames are filled in until the ring wraps around.
+	const auto &times = this->frameTimes[static_cast<int>(phase)];
+	std::array<double, RenderTimings::FRAME_COUNT> sortedTimes;
+	std::copy(times.begin(), times.begin() + this->frameCount, sortedTimes.begin());
+	std::sort(sortedTimes.begin(), sortedTimes.begin() + this->frameCount);
+
+	double sum = 0.0;
+	for (int i = 0; i < this->frameCount; i++)
+	{
+		sum += sortedTimes[i];
+	}
+
+	const int p99Index = std::max(static_cast<int>(
+		std::ceil(static_cast<double>(this->frameCount) * 0.99)) - 1, 0);
+
+	stats.min = sortedTimes[0];
+	stats.avg = sum / static_cast<double>(this->frameCount);
+	stats.p99 = sortedTimes[p99Index];
+	return stats;
+}
+
+void RenderTimings::beginFrame(int threadCount)
+{
+	this->threadTimes.resize(threadCount);
+	for (auto &times : this->threadTimes)
+	{
+		times.fill(0.0);
+	}
+
+	const double presentTime = this->mainTimes[static_cast<int>(Phase::Present)];
+	this->mainTimes.fill(0.0);
+	this->mainTimes[static_cast<int>(Phase::Present)] = presentTime;
+}
+
+void RenderTimings::addThreadTime(int threadIndex, Phase phase, double seconds)
+{
+	DebugAssert(RenderTimings::isThreadPhase(phase));
+	this->threadTimes[threadIndex][static_cast<int>(phase)] += seconds;
+}
+
+void RenderTimings::addMainTime(Phase phase, double seconds)
+{
+	DebugAssert(!RenderTimings::isThreadPhase(phase));
+	this->mainTimes[static_cast<int>(phase)] += seconds;
+}
+
+void RenderTimings::setPresentTime(double seconds)
+{
+	this->mainTimes[static_cast<int>(Phase::Present)] = seconds;
+}
+
+void RenderTimings::endFrame()
+{
+	for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+	{
+		const Phase phase = static_cast<Phase>(i);
+		const double seconds = [this, phase, i]()
+		{
+			if (RenderTimings::isThreadPhase(phase))
+			{
+				// The slowest render thread decides how long the phase took.
+				double maxSeconds = 0.0;
+				for (const auto &times : this->threadTimes)
+				{
+					maxSeconds = std::max(maxSeconds, times[i]);
+				}
+
+				return maxSeconds;
+			}
+			else
+			{
+				return this->mainTimes[i];
+			}
+		}();
+
+		this->frameTimes[i][this->nextFrameIndex] = seconds;
+	}
+
+	this->nextFrameIndex = (this->nextFrameIndex + 1) % RenderTimings::FRAME_COUNT;
+	this->frameCount = std::min(this->frameCount + 1, RenderTimings::FRAME_COUNT);
+}
+
+void RenderTimings::save(const std::string &filename) const
+{
+	std::ofstream ofs(filename);
+
+	if (!ofs.is_open())
+	{
+		DebugLogWarning("Could not open \"" + filename + "\" for writing render timings.");
+		return;
+	}
+
+	// Stats of each phase, then a table of the recent frames from oldest to newest. All
+	// times are in milliseconds.
+	ofs << "Phase: min avg p99 (ms)" << '\n';
+	for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+	{
+		const Phase phase = static_cast<Phase>(i);
+		const Stats stats = this->getStats(phase);
+		ofs << RenderTimings::getPhaseName(phase) << ": " <<
+			String::fixedPrecision(stats.min * 1000.0, 3) << ' ' <<
+			String::fixedPrecision(stats.avg * 1000.0, 3) << ' ' <<
+			String::fixedPrecision(stats.p99 * 1000.0, 3) << '\n';
+	}
+
+	ofs << '\n';
+	for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+	{
+		ofs << ((i > 0) ? "," : "") << RenderTimings::getPhaseName(static_cast<Phase>(i));
+	}
+
+	ofs << '\n';
+
+	const int firstFrameIndex = (this->frameCount == RenderTimings::FRAME_COUNT) ?
+		this->nextFrameIndex : 0;
+	for (int frame = 0; frame < this->frameCount; frame++)
+	{
+		const int frameIndex = (firstFrameIndex + frame) % RenderTimings::FRAME_COUNT;
+		for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+		{
+			ofs << ((i > 0) ? "," : "") <<
+				String::fixedPrecision(this->frameTimes[i][frameIndex] * 1000.0, 3);
+		}
+
+		ofs << '\n';
+	}
+}
@@ -0,0 +1,101 @@
+#ifndef RENDER_TIMINGS_H
+#define RENDER_TIMINGS_H
+
+#include <array>
+#include <string>
+#include <vector>
+
+// Per-phase timings of the software renderer over recent frames, for finding out which part
+// of a slow frame took the time. Each render thread only writes its own times during a frame,
+// and the main thread collects them once every render thread is done.
+
+class RenderTimings
+{
+public:
+	// Timed parts of a frame. Render thread phases are timed on every render thread, and the
+	// rest only on the main thread.
+	enum class Phase
+	{
+		// Render threads.
+		SkyGradient,
+		DistantSky,
+		Voxels,
+		VoxelHistory,
+		Flats,
+		PaletteResolve,
+		Transpose,
+		ThreadWait, // Waiting on other threads between phases.
+
+		// Main thread.
+		VisibleDistantObjects,
+		VisibleFlats,
+		MainThreadTask,
+		MainThreadWait,
+		Render, // All of the software renderer's render call.
+		Present
+	};
+
+	// Min, average, and 99th percentile of a phase's time in seconds over recent frames.
+	struct Stats
+	{
+		double min, avg, p99;
+	};
+
+	static constexpr int PHASE_COUNT = static_cast<int>(Phase::Present) + 1;
+
+	// Number of recent frames kept.
+	static constexpr int FRAME_COUNT = 120;
+private:
+	// This frame's seconds in each phase, per render thread.
+	std::vector<std::array<double, PHASE_COUNT>> threadTimes;
+
+	// This frame's seconds in each main thread phase.
+	std::array<double, PHASE_COUNT> mainTimes;
+
+	// Seconds in each phase of recent frames, oldest first once the ring is full. Render
+	// thread phases store the slowest thread's time.
+	std::array<std::array<double, FRAME_COUNT>, PHASE_COUNT> frameTimes;
+	int nextFrameIndex, frameCount;
+public:
+	RenderTimings();
+
+	// Gets the display name of a phase.
+	static std::string getPhaseName(Phase phase);
+
+	// Returns whether a phase is timed on the render threads.
+	static bool isThreadPhase(Phase phase);
+
+	int getThreadCount() const;
+
+	// Gets a render thread's seconds in a phase in the most recent frame.
+	double getThreadTime(int threadIndex, Phase phase) const;
+
+	// Gets a render thread's seconds in every phase except waiting in the most recent frame.
+	double getThreadBusyTime(int threadIndex) const;
+
+	// Gets the stats of a phase over recent frames. All zero if no frames are done yet.
+	Stats getStats(Phase phase) const;
+
+	// Clears this frame's times (except for present time) and sets the number of render
+	// threads.
+	void beginFrame(int threadCount);
+
+	// Adds seconds to a render thread's phase. Only called by that render thread.
+	void addThreadTime(int threadIndex, Phase phase, double seconds);
+
+	// Adds seconds to a main thread phase.
+	void addMainTime(Phase phase, double seconds);
+
+	// Sets the seconds the last present took. It's saved with the next frame since it
+	// happens after the frame is done.
+	void setPresentTime(double seconds);
+
+	// Saves this frame's times into the recent frames. Must be called once all render
+	// threads are done with the frame.
+	void endFrame();
+
+	// Writes the stats and each recent frame's times to a text file.
+	void save(const std::string &filename) const;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <string>
 
@@ -11,6 +12,8 @@
 #include "../Math/Rect.h"
 #include "../Media/Color.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/MemoryReport.h"
+#include "../Utilities/String.h"
 #include "../World/VoxelGrid.h"
 
 Renderer::DisplayMode::DisplayMode(int width, int height, int refreshRate)
@@ -26,15 +29,38 @@ const int Renderer::ORIGINAL_WIDTH = 320;
 const int Renderer::ORIGINAL_HEIGHT = 200;
 const int Renderer::DEFAULT_BPP = 32;
 const uint32_t Renderer::DEFAULT_PIXELFORMAT = SDL_PIXELFORMAT_ARGB8888;
+const double Renderer::DYNAMIC_RESOLUTION_OVER_BUDGET = 0.95;
+const double Renderer::DYNAMIC_RESOLUTION_UNDER_BUDGET = 0.70;
+const double Renderer::DYNAMIC_RESOLUTION_DOWNSCALE_DELAY = 0.50;
+const double Renderer::DYNAMIC_RESOLUTION_UPSCALE_DELAY = 2.0;
+const double Renderer::DYNAMIC_RESOLUTION_STEP = 0.05;
+const uint64_t Renderer::SCALED_TEXTURE_FRAMES = 300;
 
 Renderer::Renderer()
 {
 	DebugAssert(this->nativeTexture.get() == nullptr);
-	DebugAssert(this->gameWorldTexture.get() == nullptr);
+	for (const Texture &texture : this->gameWorldTextures)
+	{
+		DebugAssert(texture.get() == nullptr);
+	}
+
 	this->window = nullptr;
 	this->renderer = nullptr;
 	this->letterboxMode = 0;
+	this->resolutionScale = 1.0;
+	this->overBudgetTime = 0.0;
+	this->underBudgetTime = 0.0;
+	this->pipelinedFrameIndex = 0;
+	this->hasPipelinedFrame = false;
+	this->gameWorldTexturesLockable = false;
+	this->pipelinedTextureLocked = false;
+	this->shownGameWorldTextureIndex = -1;
 	this->fullGameWindow = false;
+	this->hasFrozenFrame = false;
+	this->originalScale = 0;
+	this->originalTextureDirty = false;
+	this->clipRectActive = false;
+	this->presentCount = 0;
 }
 
 Renderer::~Renderer()
@@ -91,6 +117,222 @@ SDL_Renderer *Renderer::createRenderer(SDL_Window *window)
 	return rendererContext;
 }
 
+void Renderer::initGameWorldTextures(int width, int height)
+{
+	// Any locked texture must be given back before it's replaced.
+	this->resetPipelinedFrames();
+	this->shownGameWorldTextureIndex = -1;
+
+	for (Texture &texture : this->gameWorldTextures)
+	{
+		texture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
+			SDL_TEXTUREACCESS_STREAMING, width, height);
+		DebugAssertMsg(texture.get() != nullptr,
+			"Couldn't create game world texture, " + std::string(SDL_GetError()));
+	}
+
+	// Some backends can't lock streaming textures or pad their rows, so frames have to be
+	// rendered into a CPU buffer and copied row by row instead.
+	const uint32_t *lockedPixels = this->lockGameWorldTexture(0);
+	this->gameWorldTexturesLockable = lockedPixels != nullptr;
+
+	if (this->gameWorldTexturesLockable)
+	{
+		SDL_UnlockTexture(this->gameWorldTextures[0].get());
+	}
+	else
+	{
+		DebugLogWarning("Can't render into game world texture directly, copying frames instead.");
+	}
+}
+
+uint32_t *Renderer::lockGameWorldTexture(int index)
+{
+	const Texture &texture = this->gameWorldTextures.at(index);
+
+	void *pixels;
+	int pitch;
+	if (SDL_LockTexture(texture.get(), nullptr, &pixels, &pitch) != 0)
+	{
+		return nullptr;
+	}
+
+	// The software renderer writes its rows back to back.
+	if (pitch != (texture.getWidth() * static_cast<int>(sizeof(uint32_t))))
+	{
+		SDL_UnlockTexture(texture.get());
+		return nullptr;
+	}
+
+	return static_cast<uint32_t*>(pixels);
+}
+
+void Renderer::updateGameWorldTexture(const uint32_t *srcPixels)
+{
+	const Texture &texture = this->gameWorldTextures[0];
+
+	uint32_t *gameWorldPixels;
+	int gameWorldPitch;
+	int status = SDL_LockTexture(texture.get(), nullptr,
+		reinterpret_cast<void**>(&gameWorldPixels), &gameWorldPitch);
+	DebugAssertMsg(status == 0, "Couldn't lock game world texture, " +
+		std::string(SDL_GetError()));
+
+	// Copy row by row since the texture pitch might be wider than the frame.
+	const int width = texture.getWidth();
+	const int height = texture.getHeight();
+	for (int y = 0; y < height; y++)
+	{
+		const uint32_t *srcRow = srcPixels + (y * width);
+		uint32_t *dstRow = reinterpret_cast<uint32_t*>(
+			reinterpret_cast<uint8_t*>(gameWorldPixels) + (y * gameWorldPitch));
+		std::copy(srcRow, srcRow + width, dstRow);
+	}
+
+	SDL_UnlockTexture(texture.get());
+}
+
+void Renderer::setNativeTarget()
+{
+	if (this->originalTextureDirty)
+	{
+		this->originalTextureDirty = false;
+
+		const SDL_Rect letterbox = this->getLetterboxDimensions();
+		SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+		SDL_RenderCopy(this->renderer, this->originalTexture.get(), nullptr, &letterbox);
+	}
+	else
+	{
+		SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	}
+}
+
+bool Renderer::setOriginalTarget()
+{
+	if ((this->originalScale == 0) || this->clipRectActive)
+	{
+		this->setNativeTarget();
+		return false;
+	}
+
+	SDL_SetRenderTarget(this->renderer, this->originalTexture.get());
+	if (!this->originalTextureDirty)
+	{
+		// Parts without UI are see-through so the native frame buffer shows.
+		SDL_SetRenderDrawColor(this->renderer, 0, 0, 0, 0);
+		SDL_RenderClear(this->renderer);
+		this->originalTextureDirty = true;
+	}
+
+	return true;
+}
+
+Rect Renderer::originalToTarget(const Rect &originalRect, bool composing) const
+{
+	if (composing)
+	{
+		const int scale = this->originalScale;
+		return Rect(originalRect.getLeft() * scale, originalRect.getTop() * scale,
+			originalRect.getWidth() * scale, originalRect.getHeight() * scale);
+	}
+	else
+	{
+		return this->originalToNative(originalRect);
+	}
+}
+
+const Texture &Renderer::getScaledTexture(const Texture &texture, int width, int height)
+{
+	DebugAssert(texture.get() != nullptr);
+
+	if (((width == texture.getWidth()) && (height == texture.getHeight())) ||
+		(width <= 0) || (height <= 0))
+	{
+		return texture;
+	}
+
+	const uint64_t sourceID = texture.getID();
+	const auto iter = std::find_if(this->scaledTextures.begin(), this->scaledTextures.end(),
+		[sourceID, width, height](const ScaledTexture &scaledTexture)
+	{
+		return (scaledTexture.sourceID == sourceID) && (scaledTexture.width == width) &&
+			(scaledTexture.height == height);
+	});
+
+	if (iter != this->scaledTextures.end())
+	{
+		iter->lastUsedFrame = this->presentCount;
+		return iter->texture;
+	}
+
+	ScaledTexture scaledTexture;
+	scaledTexture.sourceID = sourceID;
+	scaledTexture.width = width;
+	scaledTexture.height = height;
+	scaledTexture.lastUsedFrame = this->presentCount;
+	scaledTexture.texture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
+		SDL_TEXTUREACCESS_TARGET, width, height);
+	if (scaledTexture.texture.get() == nullptr)
+	{
+		return texture;
+	}
+
+	// Copy the texture's pixels as they are, transparency included, and draw the copy the
+	// way the texture would be drawn. Color mods are left to each draw.
+	SDL_Texture *source = texture.get();
+	SDL_BlendMode blendMode;
+	SDL_GetTextureBlendMode(source, &blendMode);
+	Uint8 r, g, b, a;
+	SDL_GetTextureColorMod(source, &r, &g, &b);
+	SDL_GetTextureAlphaMod(source, &a);
+
+	SDL_Texture *oldTarget = SDL_GetRenderTarget(this->renderer);
+	SDL_SetRenderTarget(this->renderer, scaledTexture.texture.get());
+	SDL_SetRenderDrawColor(this->renderer, 0, 0, 0, 0);
+	SDL_RenderClear(this->renderer);
+	SDL_SetTextureBlendMode(source, SDL_BLENDMODE_NONE);
+	SDL_SetTextureColorMod(source, 255, 255, 255);
+	SDL_SetTextureAlphaMod(source, 255);
+	SDL_RenderCopy(this->renderer, source, nullptr, nullptr);
+	SDL_SetTextureBlendMode(source, blendMode);
+	SDL_SetTextureColorMod(source, r, g, b);
+	SDL_SetTextureAlphaMod(source, a);
+	SDL_SetRenderTarget(this->renderer, oldTarget);
+
+	SDL_SetTextureBlendMode(scaledTexture.texture.get(), blendMode);
+	this->scaledTextures.push_back(std::move(scaledTexture));
+	return this->scaledTextures.back().texture;
+}
+
+void Renderer::evictScaledTextures(bool all)
+{
+	const uint64_t presentCount = this->presentCount;
+	this->scaledTextures.erase(std::remove_if(this->scaledTextures.begin(),
+		this->scaledTextures.end(), [all, presentCount](const ScaledTexture &scaledTexture)
+	{
+		return all ||
+			((presentCount - scaledTexture.lastUsedFrame) > Renderer::SCALED_TEXTURE_FRAMES);
+	}), this->scaledTextures.end());
+}
+
+void Renderer::resetPipelinedFrames()
+{
+	if (this->pipelinedTextureLocked)
+	{
+		SDL_UnlockTexture(this->gameWorldTextures[this->pipelinedFrameIndex ^ 1].get());
+		this->pipelinedTextureLocked = false;
+	}
+
+	for (auto &frame : this->pipelinedFrames)
+	{
+		frame.clear();
+	}
+
+	this->pipelinedFrameIndex = 0;
+	this->hasPipelinedFrame = false;
+}
+
 double Renderer::getLetterboxAspect() const
 {
 	if (this->letterboxMode == 0)
@@ -121,6 +363,12 @@ Int2 Renderer::getWindowDimensions() const
 	return Int2(nativeSurface->w, nativeSurface->h);
 }
 
+bool Renderer::isWindowInBackground() const
+{
+	const uint32_t flags = SDL_GetWindowFlags(this->window);
+	return ((flags & SDL_WINDOW_MINIMIZED) != 0) || ((flags & SDL_WINDOW_INPUT_FOCUS) == 0);
+}
+
 const std::vector<Renderer::DisplayMode> &Renderer::getDisplayModes() const
 {
 	return this->displayModes;
@@ -202,6 +450,54 @@ Surface Renderer::getScreenshot() const
 	return screenshot;
 }
 
+double Renderer::getResolutionScale() const
+{
+	return this->resolutionScale;
+}
+
+const RenderTimings &Renderer::getRenderTimings() const
+{
+	return this->softwareRenderer.getRenderTimings();
+}
+
+bool Renderer::getWorldColumnHit(const Double3 &eye, const Double3 &forward, int nativeX,
+	Int3 *outVoxel, double *outDistance, VoxelData::Facing *outFacing) const
+{
+	// The game world spans the window's width at any resolution scale.
+	const double xPercent = (static_cast<double>(nativeX) + 0.50) /
+		static_cast<double>(this->getWindowDimensions().x);
+	return this->softwareRenderer.getColumnHit(eye, forward, xPercent, outVoxel, outDistance,
+		outFacing);
+}
+
+void Renderer::reportMemory(MemoryReport &report) const
+{
+	this->softwareRenderer.reportMemory(report);
+
+	size_t pipelinedFrameBytes = 0;
+	for (const std::vector<uint32_t> &frame : this->pipelinedFrames)
+	{
+		pipelinedFrameBytes += MemoryReport::getVectorBytes(frame);
+	}
+
+	report.add("Renderer/Pipelined frames", pipelinedFrameBytes);
+
+	if (this->originalTexture.get() != nullptr)
+	{
+		report.add("Renderer/Original UI", static_cast<size_t>(this->originalTexture.getWidth()) *
+			this->originalTexture.getHeight() * sizeof(uint32_t));
+	}
+
+	size_t scaledTextureBytes = 0;
+	for (const ScaledTexture &scaledTexture : this->scaledTextures)
+	{
+		scaledTextureBytes += static_cast<size_t>(scaledTexture.width) *
+			scaledTexture.height * sizeof(uint32_t);
+	}
+
+	report.add("Renderer/Scaled textures", scaledTextureBytes);
+}
+
 Int2 Renderer::nativeToOriginal(const Int2 &nativePoint) const
 {
 	// From native point to letterbox point.
@@ -365,8 +661,8 @@ void Renderer::init(int width, int height, bool fullscreen, int letterboxMode)
 	DebugAssertMsg(this->nativeTexture.get() != nullptr,
 		"Couldn't create native frame buffer, " + std::string(SDL_GetError()));
 
-	// Don't initialize the game world buffer until the 3D renderer is initialized.
-	DebugAssert(this->gameWorldTexture.get() == nullptr);
+	// Don't initialize the game world buffers until the 3D renderer is initialized.
+	DebugAssert(this->gameWorldTextures[0].get() == nullptr);
 	this->fullGameWindow = false;
 }
 
@@ -385,7 +681,14 @@ void Renderer::resize(int width, int height, double resolutionScale, bool fullGa
 	DebugAssertMsg(this->nativeTexture.get() != nullptr,
 		"Couldn't recreate native frame buffer, " + std::string(SDL_GetError()));
 
+	// The frozen frame and scaled textures are for the old size.
+	this->clearFrozenFrame();
+	this->evictScaledTextures(true);
+
 	this->fullGameWindow = fullGameWindow;
+	this->resolutionScale = resolutionScale;
+	this->overBudgetTime = 0.0;
+	this->underBudgetTime = 0.0;
 
 	// Rebuild the 3D renderer if initialized.
 	if (this->softwareRenderer.isInited())
@@ -398,11 +701,8 @@ void Renderer::resize(int width, int height, double resolutionScale, bool fullGa
 		const int renderWidth = std::max(static_cast<int>(width * resolutionScale), 1);
 		const int renderHeight = std::max(static_cast<int>(viewHeight * resolutionScale), 1);
 
-		// Reinitialize the game world frame buffer.
-		this->gameWorldTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
-			SDL_TEXTUREACCESS_STREAMING, renderWidth, renderHeight);
-		DebugAssertMsg(this->gameWorldTexture.get() != nullptr,
-			"Couldn't recreate game world texture, " + std::string(SDL_GetError()));
+		// Reinitialize the game world frame buffers.
+		this->initGameWorldTextures(renderWidth, renderHeight);
 
 		// Resize 3D renderer.
 		this->softwareRenderer.resize(renderWidth, renderHeight);
@@ -411,9 +711,42 @@ void Renderer::resize(int width, int height, double resolutionScale, bool fullGa
 
 void Renderer::setLetterboxMode(int letterboxMode)
 {
+	// UI composed so far is for the old letterbox.
+	if (letterboxMode != this->letterboxMode)
+	{
+		this->setNativeTarget();
+	}
+
 	this->letterboxMode = letterboxMode;
 }
 
+void Renderer::setOriginalUIScale(int scale)
+{
+	DebugAssert(scale >= 0);
+	this->setNativeTarget();
+
+	if (scale == 0)
+	{
+		this->originalTexture = Texture();
+		this->originalScale = 0;
+		return;
+	}
+
+	this->originalTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
+		SDL_TEXTUREACCESS_TARGET, Renderer::ORIGINAL_WIDTH * scale,
+		Renderer::ORIGINAL_HEIGHT * scale);
+	if (this->originalTexture.get() == nullptr)
+	{
+		DebugLogWarning("Couldn't create original UI frame buffer, " +
+			std::string(SDL_GetError()));
+		this->originalScale = 0;
+		return;
+	}
+
+	SDL_SetTextureBlendMode(this->originalTexture.get(), SDL_BLENDMODE_BLEND);
+	this->originalScale = scale;
+}
+
 void Renderer::setFullscreen(bool fullscreen)
 {
 	// Use "fake" fullscreen for now.
@@ -442,6 +775,9 @@ void Renderer::warpMouse(int x, int y)
 
 void Renderer::setClipRect(const SDL_Rect *rect)
 {
+	// The rectangle is in native space, so clipped UI is drawn straight to native.
+	this->setNativeTarget();
+	this->clipRectActive = rect != nullptr;
 	SDL_RenderSetClipRect(this->renderer, rect);
 }
 
@@ -449,6 +785,9 @@ void Renderer::initializeWorldRendering(double resolutionScale, bool fullGameWin
 	int renderThreadsMode)
 {
 	this->fullGameWindow = fullGameWindow;
+	this->resolutionScale = resolutionScale;
+	this->overBudgetTime = 0.0;
+	this->underBudgetTime = 0.0;
 
 	const int screenWidth = this->getWindowDimensions().x;
 
@@ -460,22 +799,107 @@ void Renderer::initializeWorldRendering(double resolutionScale, bool fullGameWin
 	const int renderWidth = std::max(static_cast<int>(screenWidth * resolutionScale), 1);
 	const int renderHeight = std::max(static_cast<int>(viewHeight * resolutionScale), 1);
 
-	// Initialize a new game world frame buffer, removing any previous game world frame buffer.
-	this->gameWorldTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
-		SDL_TEXTUREACCESS_STREAMING, renderWidth, renderHeight);
-	DebugAssertMsg(this->gameWorldTexture.get() != nullptr,
-		"Couldn't create game world texture, " + std::string(SDL_GetError()));
+	// Initialize new game world frame buffers, removing any previous ones.
+	this->initGameWorldTextures(renderWidth, renderHeight);
 
 	// Initialize 3D rendering.
 	this->softwareRenderer.init(renderWidth, renderHeight, renderThreadsMode);
 }
 
+void Renderer::initializeOffscreenWorldRendering(int width, int height,
+	int renderThreadsMode)
+{
+	DebugAssert(width > 0);
+	DebugAssert(height > 0);
+
+	this->softwareRenderer.init(width, height, renderThreadsMode);
+	this->resetPipelinedFrames();
+}
+
 void Renderer::setRenderThreadsMode(int mode)
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.setRenderThreadsMode(mode);
 }
 
+void Renderer::setAutoRenderThreadCount(int threadCount)
+{
+	this->softwareRenderer.setAutoRenderThreadCount(threadCount);
+}
+
+void Renderer::setRenderThreadsAffinity(int renderThreadsMode, int affinityMode,
+	const std::string &cores, bool highPriority)
+{
+	std::vector<int> coreList;
+	for (const std::string &coreString : String::split(cores, ','))
+	{
+		const std::string trimmedString = String::trim(coreString);
+		if (trimmedString.size() == 0)
+		{
+			continue;
+		}
+
+		try
+		{
+			coreList.push_back(std::stoi(trimmedString));
+		}
+		catch (const std::exception&)
+		{
+			DebugLogWarning("Ignoring render thread core \"" + trimmedString + "\".");
+		}
+	}
+
+	SoftwareRenderer::avoidRenderThreadCores(renderThreadsMode, affinityMode, coreList);
+	this->softwareRenderer.setRenderThreadsAffinity(affinityMode, coreList, highPriority);
+}
+
+void Renderer::updateDynamicResolution(double dt, double busyTime, double targetFrameTime,
+	double minResolutionScale, double maxResolutionScale)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+
+	// Only count time while the busy time stays past a threshold, so a single slow frame
+	// (i.e., loading a chunk) doesn't change the resolution.
+	const double budgetPercent = busyTime / targetFrameTime;
+	this->overBudgetTime = (budgetPercent > Renderer::DYNAMIC_RESOLUTION_OVER_BUDGET) ?
+		(this->overBudgetTime + dt) : 0.0;
+	this->underBudgetTime = (budgetPercent < Renderer::DYNAMIC_RESOLUTION_UNDER_BUDGET) ?
+		(this->underBudgetTime + dt) : 0.0;
+
+	const double newResolutionScale = [this, minResolutionScale, maxResolutionScale]()
+	{
+		if (this->overBudgetTime >= Renderer::DYNAMIC_RESOLUTION_DOWNSCALE_DELAY)
+		{
+			return this->resolutionScale - Renderer::DYNAMIC_RESOLUTION_STEP;
+		}
+		else if (this->underBudgetTime >= Renderer::DYNAMIC_RESOLUTION_UPSCALE_DELAY)
+		{
+			return this->resolutionScale + Renderer::DYNAMIC_RESOLUTION_STEP;
+		}
+		else
+		{
+			return this->resolutionScale;
+		}
+	}();
+
+	const double clampedResolutionScale = std::clamp(
+		newResolutionScale, minResolutionScale, maxResolutionScale);
+
+	if (clampedResolutionScale != this->resolutionScale)
+	{
+		// Recreate the game world frame buffer at the new size. Its texture is already
+		// stretched to fit the screen, so this is the only change needed. This also resets
+		// the threshold timers. The 3D renderer's buffers are allocated for the largest
+		// scale once, so stepping between scales doesn't reallocate them.
+		const Int2 windowDimensions = this->getWindowDimensions();
+		this->softwareRenderer.reserve(
+			std::max(static_cast<int>(windowDimensions.x * maxResolutionScale), 1),
+			std::max(static_cast<int>(this->getViewHeight() * maxResolutionScale), 1));
+		this->resize(windowDimensions.x, windowDimensions.y, clampedResolutionScale,
+			this->fullGameWindow);
+	}
+}
+
 void Renderer::addFlat(int id, const Double3 &position, double width, 
 	double height, int textureID)
 {
@@ -490,10 +914,11 @@ void Renderer::addLight(int id, const Double3 &point, const Double3 &color, doub
 }
 
 void Renderer::updateFlat(int id, const Double3 *position, const double *width, 
-	const double *height, const int *textureID, const bool *flipped)
+	const double *height, const int *textureID, const int *frameIndex, const bool *flipped)
 {
 	DebugAssert(this->softwareRenderer.isInited());
-	this->softwareRenderer.updateFlat(id, position, width, height, textureID, flipped);
+	this->softwareRenderer.updateFlat(id, position, width, height, textureID, frameIndex,
+		flipped);
 }
 
 void Renderer::updateLight(int id, const Double3 *point, const Double3 *color, 
@@ -509,18 +934,44 @@ void Renderer::setFogDistance(double fogDistance)
 	this->softwareRenderer.setFogDistance(fogDistance);
 }
 
+void Renderer::setVoxelDetailDistance(double distance)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setVoxelDetailDistance(distance);
+}
+
 void Renderer::setVoxelTexture(int id, const uint32_t *srcTexels)
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.setVoxelTexture(id, srcTexels);
 }
 
+void Renderer::setVoxelTextures(const std::vector<const uint32_t*> &srcTexels)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setVoxelTextures(srcTexels);
+}
+
+void Renderer::setVoxelTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames,
+	double secondsPerFrame)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setVoxelTextureFrames(id, srcFrames, secondsPerFrame);
+}
+
 void Renderer::setFlatTexture(int id, const uint32_t *srcTexels, int width, int height)
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.setFlatTexture(id, srcTexels, width, height);
 }
 
+void Renderer::setFlatTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames,
+	int width, int height)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setFlatTextureFrames(id, srcFrames, width, height);
+}
+
 void Renderer::setDistantSky(const DistantSky &distantSky)
 {
 	DebugAssert(this->softwareRenderer.isInited());
@@ -533,12 +984,24 @@ void Renderer::setSkyPalette(const uint32_t *colors, int count)
 	this->softwareRenderer.setSkyPalette(colors, count);
 }
 
+void Renderer::setTexturePalette(const uint32_t *colors, int count)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setTexturePalette(colors, count);
+}
+
 void Renderer::setNightLightsActive(bool active)
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.setNightLightsActive(active);
 }
 
+void Renderer::setScanlinePlanes(bool active)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setScanlinePlanes(active);
+}
+
 void Renderer::removeFlat(int id)
 {
 	DebugAssert(this->softwareRenderer.isInited());
@@ -551,21 +1014,94 @@ void Renderer::removeLight(int id)
 	this->softwareRenderer.removeLight(id);
 }
 
+void Renderer::bakeLights(const VoxelGrid &voxelGrid, double ceilingHeight)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.bakeLights(voxelGrid, ceilingHeight);
+}
+
+void Renderer::buildVisibilityRegions(const VoxelGrid &voxelGrid)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.buildVisibilityRegions(voxelGrid);
+}
+
+void Renderer::clearVisibilityRegions()
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.clearVisibilityRegions();
+}
+
 void Renderer::clearTextures()
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.clearTextures();
 }
 
+void Renderer::tickAnimations(double dt)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.tickAnimations(dt);
+}
+
 void Renderer::clearDistantSky()
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.clearDistantSky();
 }
 
+void Renderer::runParallel(int batchCount, const std::function<void(int)> &batchFunction)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.runParallel(batchCount, batchFunction);
+}
+
+void Renderer::freezeFrame()
+{
+	const int width = this->nativeTexture.getWidth();
+	const int height = this->nativeTexture.getHeight();
+	if ((this->frozenTexture.get() == nullptr) || (this->frozenTexture.getWidth() != width) ||
+		(this->frozenTexture.getHeight() != height))
+	{
+		this->frozenTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
+			SDL_TEXTUREACCESS_TARGET, width, height);
+		if (this->frozenTexture.get() == nullptr)
+		{
+			DebugLogWarning("Couldn't create frozen frame buffer, " +
+				std::string(SDL_GetError()));
+			this->hasFrozenFrame = false;
+			return;
+		}
+	}
+
+	this->setNativeTarget();
+	SDL_SetRenderTarget(this->renderer, this->frozenTexture.get());
+	SDL_RenderCopy(this->renderer, this->nativeTexture.get(), nullptr, nullptr);
+	this->setNativeTarget();
+	this->hasFrozenFrame = true;
+}
+
+bool Renderer::isFrameFrozen() const
+{
+	return this->hasFrozenFrame;
+}
+
+void Renderer::drawFrozenFrame()
+{
+	DebugAssert(this->hasFrozenFrame);
+	this->setNativeTarget();
+	SDL_RenderCopy(this->renderer, this->frozenTexture.get(), nullptr, nullptr);
+}
+
+void Renderer::clearFrozenFrame()
+{
+	// The texture is kept for the next frozen frame of the same size.
+	this->hasFrozenFrame = false;
+}
+
 void Renderer::clear(const Color &color)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderClear(this->renderer);
 }
@@ -577,11 +1113,18 @@ void Renderer::clear()
 
 void Renderer::clearOriginal(const Color &color)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
-	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
+	if (this->setOriginalTarget())
+	{
+		SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
+		SDL_RenderClear(this->renderer);
+	}
+	else
+	{
+		SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 
-	const SDL_Rect rect = this->getLetterboxDimensions();
-	SDL_RenderFillRect(this->renderer, &rect);
+		const SDL_Rect rect = this->getLetterboxDimensions();
+		SDL_RenderFillRect(this->renderer, &rect);
+	}
 }
 
 void Renderer::clearOriginal()
@@ -591,21 +1134,21 @@ void Renderer::clearOriginal()
 
 void Renderer::drawPixel(const Color &color, int x, int y)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderDrawPoint(this->renderer, x, y);
 }
 
 void Renderer::drawLine(const Color &color, int x1, int y1, int x2, int y2)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderDrawLine(this->renderer, x1, y1, x2, y2);
 }
 
 void Renderer::drawRect(const Color &color, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 
 	SDL_Rect rect;
@@ -619,7 +1162,7 @@ void Renderer::drawRect(const Color &color, int x, int y, int w, int h)
 
 void Renderer::fillRect(const Color &color, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 
 	SDL_Rect rect;
@@ -633,41 +1176,191 @@ void Renderer::fillRect(const Color &color, int x, int y, int w, int h)
 
 void Renderer::fillOriginalRect(const Color &color, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	const bool composing = this->setOriginalTarget();
 	SDL_SetRenderDrawColor(this->renderer, color.r, color.g, color.b, color.a);
 
-	const Rect rect = this->originalToNative(Rect(x, y, w, h));
+	const Rect rect = this->originalToTarget(Rect(x, y, w, h), composing);
 	SDL_RenderFillRect(this->renderer, &rect.getRect());
 }
 
 void Renderer::renderWorld(const Double3 &eye, const Double3 &forward, double fovY,
 	double ambient, double daytimePercent, double latitude, bool parallaxSky, double ceilingHeight,
-	const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid)
+	const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+	bool pipelined, bool interlacedVoxels, bool paletteRendering)
 {
 	// The 3D renderer must be initialized.
 	DebugAssert(this->softwareRenderer.isInited());
-	
-	// Lock the game world texture and give the pixel pointer to the software renderer.
-	// - Supposedly this is faster than SDL_UpdateTexture(). In any case, there's one
-	//   less frame buffer to take care of.
-	uint32_t *gameWorldPixels;
-	int gameWorldPitch;
-	int status = SDL_LockTexture(this->gameWorldTexture.get(), nullptr,
-		reinterpret_cast<void**>(&gameWorldPixels), &gameWorldPitch);
-	DebugAssertMsg(status == 0, "Couldn't lock game world texture, " +
-		std::string(SDL_GetError()));
 
-	// Render the game world to the game world frame buffer.
-	this->softwareRenderer.render(eye, forward, fovY, ambient, daytimePercent, latitude,
-		parallaxSky, ceilingHeight, openDoors, voxelGrid, gameWorldPixels);
-
-	// Update the game world texture with the new ARGB8888 pixels.
-	SDL_UnlockTexture(this->gameWorldTexture.get());
+	this->softwareRenderer.setInterlacedVoxels(interlacedVoxels);
+	this->softwareRenderer.setPaletteRendering(paletteRendering);
 
-	// Now copy to the native frame buffer (stretching if needed).
 	const int screenWidth = this->getWindowDimensions().x;
 	const int viewHeight = this->getViewHeight();
-	this->draw(this->gameWorldTexture, 0, 0, screenWidth, viewHeight);
+
+	// If the frame would be the same as the last one (i.e., standing still in a quiet scene),
+	// show the last one again.
+	const bool frameUnchanged = (this->shownGameWorldTextureIndex >= 0) &&
+		this->softwareRenderer.isFrameUnchanged(eye, forward, fovY, ambient, daytimePercent,
+			latitude, parallaxSky, ceilingHeight, openDoors, voxelGrid);
+
+	if (frameUnchanged)
+	{
+		// A pipelined frame is shown a call late, so the newest one might still be waiting.
+		const int newestIndex = this->pipelinedFrameIndex ^ 1;
+		if (this->pipelinedTextureLocked)
+		{
+			this->shownGameWorldTextureIndex = newestIndex;
+		}
+		else if (this->hasPipelinedFrame && !this->gameWorldTexturesLockable)
+		{
+			this->updateGameWorldTexture(this->pipelinedFrames[newestIndex].data());
+			this->shownGameWorldTextureIndex = 0;
+		}
+
+		// With no frame in flight, the next changed frame is shown right away.
+		this->resetPipelinedFrames();
+
+		const Texture &shownTexture = this->gameWorldTextures[this->shownGameWorldTextureIndex];
+		this->draw(shownTexture, 0, 0, screenWidth, viewHeight);
+		return;
+	}
+
+	const Texture *shownTexture = &this->gameWorldTextures[0];
+
+	if (pipelined)
+	{
+		// Render into one frame while the other (finished last call) is uploaded to its
+		// game world texture. The world data is only read during this call, so the render
+		// threads are never running while the game is updating.
+		uint32_t *lockedPixels = nullptr;
+		if (this->gameWorldTexturesLockable)
+		{
+			lockedPixels = this->lockGameWorldTexture(this->pipelinedFrameIndex);
+			if (lockedPixels == nullptr)
+			{
+				// The backend stopped allowing it, so copy frames from now on.
+				this->resetPipelinedFrames();
+				this->gameWorldTexturesLockable = false;
+			}
+		}
+
+		if (lockedPixels != nullptr)
+		{
+			// Render straight into this frame's texture. It stays locked until the next
+			// call, where unlocking it uploads it while the render threads are busy.
+			const int previousIndex = this->pipelinedFrameIndex ^ 1;
+			auto unlockPreviousFrame = [this, previousIndex]()
+			{
+				SDL_UnlockTexture(this->gameWorldTextures[previousIndex].get());
+				this->pipelinedTextureLocked = false;
+			};
+
+			this->softwareRenderer.render(eye, forward, fovY, ambient, daytimePercent, latitude,
+				parallaxSky, ceilingHeight, openDoors, voxelGrid, lockedPixels,
+				this->pipelinedTextureLocked ? unlockPreviousFrame : std::function<void()>());
+
+			// In case the renderer finished without running the upload.
+			if (this->pipelinedTextureLocked)
+			{
+				unlockPreviousFrame();
+			}
+
+			if (this->hasPipelinedFrame)
+			{
+				shownTexture = &this->gameWorldTextures[previousIndex];
+				this->pipelinedTextureLocked = true;
+			}
+			else
+			{
+				// No previous frame to show (i.e., after a resize), so show this one now.
+				SDL_UnlockTexture(this->gameWorldTextures[this->pipelinedFrameIndex].get());
+				shownTexture = &this->gameWorldTextures[this->pipelinedFrameIndex];
+			}
+		}
+		else
+		{
+			const int pixelCount = shownTexture->getWidth() * shownTexture->getHeight();
+
+			std::vector<uint32_t> &currentFrame =
+				this->pipelinedFrames[this->pipelinedFrameIndex];
+			const std::vector<uint32_t> &previousFrame =
+				this->pipelinedFrames[this->pipelinedFrameIndex ^ 1];
+			currentFrame.resize(pixelCount);
+
+			auto uploadPreviousFrame = [this, &previousFrame]()
+			{
+				this->updateGameWorldTexture(previousFrame.data());
+			};
+
+			this->softwareRenderer.render(eye, forward, fovY, ambient, daytimePercent, latitude,
+				parallaxSky, ceilingHeight, openDoors, voxelGrid, currentFrame.data(),
+				this->hasPipelinedFrame ? uploadPreviousFrame : std::function<void()>());
+
+			// If there was no previous frame to show (i.e., after a resize), show this one now.
+			if (!this->hasPipelinedFrame)
+			{
+				this->updateGameWorldTexture(currentFrame.data());
+			}
+		}
+
+		this->pipelinedFrameIndex ^= 1;
+		this->hasPipelinedFrame = true;
+	}
+	else
+	{
+		// Any pipelined frame is stale now.
+		this->resetPipelinedFrames();
+
+		// Give the locked texture's pixels to the software renderer so there's no frame
+		// buffer to copy, unless the backend doesn't allow it.
+		uint32_t *lockedPixels = this->gameWorldTexturesLockable ?
+			this->lockGameWorldTexture(0) : nullptr;
+
+		if (lockedPixels != nullptr)
+		{
+			this->softwareRenderer.render(eye, forward, fovY, ambient, daytimePercent, latitude,
+				parallaxSky, ceilingHeight, openDoors, voxelGrid, lockedPixels,
+				std::function<void()>());
+
+			// Update the game world texture with the new ARGB8888 pixels.
+			SDL_UnlockTexture(this->gameWorldTextures[0].get());
+		}
+		else
+		{
+			std::vector<uint32_t> &frame = this->pipelinedFrames[0];
+			frame.resize(shownTexture->getWidth() * shownTexture->getHeight());
+
+			this->softwareRenderer.render(eye, forward, fovY, ambient, daytimePercent, latitude,
+				parallaxSky, ceilingHeight, openDoors, voxelGrid, frame.data(),
+				std::function<void()>());
+
+			this->updateGameWorldTexture(frame.data());
+		}
+	}
+
+	this->shownGameWorldTextureIndex =
+		static_cast<int>(shownTexture - this->gameWorldTextures.data());
+
+	// Now copy to the native frame buffer (stretching if needed).
+	this->draw(*shownTexture, 0, 0, screenWidth, viewHeight);
+}
+
+void Renderer::renderWorldOffscreen(const Double3 &eye, const Double3 &forward,
+	double fovY, double ambient, double daytimePercent, double latitude, bool parallaxSky,
+	double ceilingHeight, const LevelData::OpenDoors &openDoors,
+	const VoxelGrid &voxelGrid, bool interlacedVoxels, bool paletteRendering,
+	uint32_t *colorBuffer)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	DebugAssert(colorBuffer != nullptr);
+
+	this->softwareRenderer.setInterlacedVoxels(interlacedVoxels);
+	this->softwareRenderer.setPaletteRendering(paletteRendering);
+	this->softwareRenderer.render(eye, forward, fovY, ambient, daytimePercent, latitude,
+		parallaxSky, ceilingHeight, openDoors, voxelGrid, colorBuffer, std::function<void()>());
+
+	// The game world textures don't have this frame.
+	this->shownGameWorldTextureIndex = -1;
 }
 
 void Renderer::drawCursor(const Texture &cursor, CursorAlignment alignment,
@@ -725,7 +1418,8 @@ void Renderer::drawCursor(const Texture &cursor, CursorAlignment alignment,
 		return Int2(xOffset, yOffset);
 	}();
 
-	this->draw(cursor,
+	const Texture &scaledCursor = this->getScaledTexture(cursor, scaledWidth, scaledHeight);
+	this->draw(scaledCursor,
 		mousePosition.x - cursorOffset.x,
 		mousePosition.y - cursorOffset.y,
 		scaledWidth,
@@ -734,7 +1428,7 @@ void Renderer::drawCursor(const Texture &cursor, CursorAlignment alignment,
 
 void Renderer::draw(const Texture &texture, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 
 	SDL_Rect rect;
 	rect.x = x;
@@ -760,7 +1454,7 @@ void Renderer::draw(const Texture &texture)
 
 void Renderer::drawClipped(const Texture &texture, const Rect &srcRect, const Rect &dstRect)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 	SDL_RenderCopy(this->renderer, texture.get(), &srcRect.getRect(), &dstRect.getRect());
 }
 
@@ -771,11 +1465,11 @@ void Renderer::drawClipped(const Texture &texture, const Rect &srcRect, int x, i
 
 void Renderer::drawOriginal(const Texture &texture, int x, int y, int w, int h)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	const bool composing = this->setOriginalTarget();
 	
 	// The given coordinates and dimensions are in 320x200 space, so transform them
-	// to native space.
-	const Rect rect = this->originalToNative(Rect(x, y, w, h));
+	// to the target's space.
+	const Rect rect = this->originalToTarget(Rect(x, y, w, h), composing);
 
 	SDL_RenderCopy(this->renderer, texture.get(), nullptr, &rect.getRect());
 }
@@ -793,13 +1487,30 @@ void Renderer::drawOriginal(const Texture &texture)
 	this->drawOriginal(texture, 0, 0);
 }
 
+void Renderer::drawOriginalPrescaled(const Texture &texture, int x, int y, int w, int h)
+{
+	const bool composing = this->setOriginalTarget();
+	const Rect rect = this->originalToTarget(Rect(x, y, w, h), composing);
+	const Texture &scaledTexture = this->getScaledTexture(texture, rect.getWidth(),
+		rect.getHeight());
+
+	// The copy has to be drawn with the same mods as the texture.
+	Uint8 r, g, b, a;
+	SDL_GetTextureColorMod(texture.get(), &r, &g, &b);
+	SDL_GetTextureAlphaMod(texture.get(), &a);
+	SDL_SetTextureColorMod(scaledTexture.get(), r, g, b);
+	SDL_SetTextureAlphaMod(scaledTexture.get(), a);
+
+	SDL_RenderCopy(this->renderer, scaledTexture.get(), nullptr, &rect.getRect());
+}
+
 void Renderer::drawOriginalClipped(const Texture &texture, const Rect &srcRect, const Rect &dstRect)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	const bool composing = this->setOriginalTarget();
 
 	// The destination coordinates and dimensions are in 320x200 space, so transform 
-	// them to native space.
-	const Rect rect = this->originalToNative(dstRect);
+	// them to the target's space.
+	const Rect rect = this->originalToTarget(dstRect, composing);
 
 	SDL_RenderCopy(this->renderer, texture.get(), &srcRect.getRect(), &rect.getRect());
 }
@@ -812,13 +1523,23 @@ void Renderer::drawOriginalClipped(const Texture &texture, const Rect &srcRect,
 
 void Renderer::fill(const Texture &texture)
 {
-	SDL_SetRenderTarget(this->renderer, this->nativeTexture.get());
+	this->setNativeTarget();
 	SDL_RenderCopy(this->renderer, texture.get(), nullptr, nullptr);
 }
 
 void Renderer::present()
 {
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	this->setNativeTarget();
 	SDL_SetRenderTarget(this->renderer, nullptr);
 	SDL_RenderCopy(this->renderer, this->nativeTexture.get(), nullptr, nullptr);
 	SDL_RenderPresent(this->renderer);
+
+	this->presentCount++;
+	this->evictScaledTextures(false);
+
+	const std::chrono::duration<double> presentDuration =
+		std::chrono::high_resolution_clock::now() - startTime;
+	this->softwareRenderer.setPresentTime(presentDuration.count());
 }
@@ -1,7 +1,9 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <array>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -17,6 +19,7 @@
 
 class Color;
 class DistantSky;
+class MemoryReport;
 class Rect;
 class Surface;
 class VoxelGrid;
@@ -42,16 +45,92 @@ private:
 	static const char *DEFAULT_RENDER_SCALE_QUALITY;
 	static const char *DEFAULT_TITLE;
 
+	// Dynamic resolution thresholds, as percents of the frame time budget. The gap between
+	// them keeps the resolution from oscillating.
+	static const double DYNAMIC_RESOLUTION_OVER_BUDGET;
+	static const double DYNAMIC_RESOLUTION_UNDER_BUDGET;
+
+	// Frames a scaled copy of a texture is kept after it was last drawn.
+	static const uint64_t SCALED_TEXTURE_FRAMES;
+
+	// Seconds a frame time must stay past a threshold before the resolution changes.
+	static const double DYNAMIC_RESOLUTION_DOWNSCALE_DELAY;
+	static const double DYNAMIC_RESOLUTION_UPSCALE_DELAY;
+
+	// Amount the resolution scale changes by each step.
+	static const double DYNAMIC_RESOLUTION_STEP;
+
+	// A texture scaled once to the size it's drawn at. Scale quality is the renderer's
+	// fixed hint, so it isn't part of the key.
+	struct ScaledTexture
+	{
+		uint64_t sourceID;
+		int width, height;
+		Texture texture;
+		uint64_t lastUsedFrame;
+	};
+
 	std::vector<DisplayMode> displayModes;
 	SDL_Window *window;
 	SDL_Renderer *renderer;
-	Texture nativeTexture, gameWorldTexture; // Frame buffers.
+	Texture nativeTexture; // Frame buffer.
+	Texture frozenTexture; // Copy of the frame buffer shown under modal sub-panels.
+	bool hasFrozenFrame; // Whether the frozen texture has a frame to show.
+	Texture originalTexture; // Original UI composed at the UI scale, then drawn to native once.
+	int originalScale; // Scale of the original texture, or 0 if UI is drawn straight to native.
+	bool originalTextureDirty; // Whether the original texture has UI not drawn to native yet.
+	bool clipRectActive; // Original UI is drawn straight to native while clipping.
+	std::array<Texture, 2> gameWorldTextures; // Game world frame buffers, one per pipelined frame.
+	std::array<std::vector<uint32_t>, 2> pipelinedFrames; // Game world frames if not lockable.
 	SoftwareRenderer softwareRenderer; // Game world renderer.
+	int pipelinedFrameIndex; // Pipelined frame currently being rendered to.
+	bool hasPipelinedFrame; // Whether the other pipelined frame is ready to be shown.
+	bool gameWorldTexturesLockable; // Whether frames can be rendered straight into textures.
+	bool pipelinedTextureLocked; // Whether the other pipelined frame's texture is still locked.
+	int shownGameWorldTextureIndex; // Game world texture last shown, or -1 if none.
 	int letterboxMode; // Determines aspect ratio of the original UI (16:10, 4:3, etc.).
+	double resolutionScale; // Percent of the screen resolution used by the 3D frame buffer.
+	double overBudgetTime, underBudgetTime; // Seconds spent past dynamic resolution thresholds.
 	bool fullGameWindow; // Determines height of 3D frame buffer.
+	std::vector<ScaledTexture> scaledTextures; // Few enough to search in order.
+	uint64_t presentCount;
 
 	// Helper method for making a renderer context.
 	static SDL_Renderer *createRenderer(SDL_Window *window);
+
+	// Creates the game world textures and checks whether the software renderer can write
+	// into them directly, which needs a lockable texture with no padding between rows.
+	void initGameWorldTextures(int width, int height);
+
+	// Locks a game world texture for the software renderer to write into, returning null if
+	// it can't be written with the frame's pitch.
+	uint32_t *lockGameWorldTexture(int index);
+
+	// Copies the given ARGB8888 frame into the first game world texture.
+	void updateGameWorldTexture(const uint32_t *srcPixels);
+
+	// Discards any pipelined frame so the next frame is shown without latency. Also unlocks
+	// the pipelined frame's texture if it's still locked.
+	void resetPipelinedFrames();
+
+	// Draws any UI composed in the original texture to the letterbox, then targets the
+	// native frame buffer. Anything drawn to native has to come after the UI before it.
+	void setNativeTarget();
+
+	// Targets the original texture if composing the UI, clearing it first if it has
+	// nothing yet, or the native frame buffer otherwise. Returns whether it's composing.
+	bool setOriginalTarget();
+
+	// Gets the rectangle in the current target for a rectangle in 320x200 space.
+	Rect originalToTarget(const Rect &originalRect, bool composing) const;
+
+	// Gets a copy of the texture scaled to the given size, scaling it the first time it's
+	// asked for so drawing it every frame is an unscaled copy. Returns the texture itself if
+	// it's already that size. Copies not drawn for a while are freed.
+	const Texture &getScaledTexture(const Texture &texture, int width, int height);
+
+	// Frees scaled copies no longer being drawn, or all of them (i.e., after a resize).
+	void evictScaledTextures(bool all);
 public:
 	// Only defined so members are initialized for Game ctor exception handling.
 	Renderer();
@@ -73,6 +152,9 @@ public:
 	// Gets the width and height of the active window.
 	Int2 getWindowDimensions() const;
 
+	// Returns whether the window is minimized or doesn't have input focus.
+	bool isWindowInBackground() const;
+
 	// Gets a list of supported fullscreen display modes.
 	const std::vector<DisplayMode> &getDisplayModes() const;
 
@@ -88,6 +170,21 @@ public:
 	// Gets a screenshot of the current window.
 	Surface getScreenshot() const;
 
+	// Gets the resolution scale the game world is currently rendered at.
+	double getResolutionScale() const;
+
+	// Gets how long each phase of recent game world frames took, including presenting.
+	const RenderTimings &getRenderTimings() const;
+
+	// Gets the nearest non-air voxel at the camera's voxel height drawn under a native window
+	// X coordinate in the last game world frame, if it was rendered from the given eye and
+	// direction. Returns false if the caller has to ray cast instead.
+	bool getWorldColumnHit(const Double3 &eye, const Double3 &forward, int nativeX,
+		Int3 *outVoxel, double *outDistance, VoxelData::Facing *outFacing) const;
+
+	// Adds the bytes held by the game world renderer and its frames to the report.
+	void reportMemory(MemoryReport &report) const;
+
 	// Transforms a native window (i.e., 1920x1080) point or rectangle to an original 
 	// (320x200) point or rectangle. Points outside the letterbox will either be negative 
 	// or outside the 320x200 limit when returned.
@@ -113,6 +210,11 @@ public:
 	// Sets the letterbox mode.
 	void setLetterboxMode(int letterboxMode);
 
+	// Sets the scale of the texture the original UI is composed in before one scaled draw
+	// to the letterbox (i.e., 1 for 320x200), or 0 to draw each UI image to the letterbox
+	// on its own. Composing does less scaled drawing per frame and scales the UI evenly.
+	void setOriginalUIScale(int scale);
+
 	// Sets whether the program is windowed or fullscreen.
 	void setFullscreen(bool fullscreen);
 
@@ -136,9 +238,30 @@ public:
 	void initializeWorldRendering(double resolutionScale, bool fullGameWindow,
 		int renderThreadsMode);
 
+	// Initializes the renderer for drawing the game world into a caller-owned buffer instead
+	// of the game world texture. Used by tools that have no window (i.e., benchmarks).
+	void initializeOffscreenWorldRendering(int width, int height, int renderThreadsMode);
+
 	// Sets which mode to use for software render threads (low, medium, high, etc.).
 	void setRenderThreadsMode(int mode);
 
+	// Sets the software render thread count for the auto render threads mode, or zero if it
+	// isn't known yet. Can be called before world rendering is initialized.
+	void setAutoRenderThreadCount(int threadCount);
+
+	// Sets which cores software render threads are pinned to (see the RenderThreadsAffinity
+	// option) and whether they get a higher priority. The core list is comma-separated. The
+	// calling thread is moved off the render thread cores, so this should be called before
+	// other threads are started.
+	void setRenderThreadsAffinity(int renderThreadsMode, int affinityMode,
+		const std::string &cores, bool highPriority);
+
+	// Lowers the game world resolution after frames have been over the target frame time
+	// for a while, and raises it again (up to the max scale) when there is headroom. The
+	// busy time should not include time slept for frame limiting.
+	void updateDynamicResolution(double dt, double busyTime, double targetFrameTime,
+		double minResolutionScale, double maxResolutionScale);
+
 	// Helper methods for changing data in the 3D renderer. Some data, like the voxel
 	// grid, are passed each frame by reference.
 	// - Some 'add' methods take a unique ID and parameters to create a new object.
@@ -147,20 +270,53 @@ public:
 	void addFlat(int id, const Double3 &position, double width, double height, int textureID);
 	void addLight(int id, const Double3 &point, const Double3 &color, double intensity);
 	void updateFlat(int id, const Double3 *position, const double *width, 
-		const double *height, const int *textureID, const bool *flipped);
+		const double *height, const int *textureID, const int *frameIndex,
+		const bool *flipped);
 	void updateLight(int id, const Double3 *point, const Double3 *color,
 		const double *intensity);
 	void setFogDistance(double fogDistance);
+
+	// Sets the distance past which only every other voxel column is ray cast and the rest
+	// are copied from their neighbor. Zero gives full detail at every distance.
+	void setVoxelDetailDistance(double distance);
 	void setVoxelTexture(int id, const uint32_t *srcTexels);
+	void setVoxelTextures(const std::vector<const uint32_t*> &srcTexels);
+	void setVoxelTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames,
+		double secondsPerFrame);
 	void setFlatTexture(int id, const uint32_t *srcTexels, int width, int height);
+	void setFlatTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames, int width,
+		int height);
 	void setDistantSky(const DistantSky &distantSky);
 	void setSkyPalette(const uint32_t *colors, int count);
+	void setTexturePalette(const uint32_t *colors, int count);
 	void setNightLightsActive(bool active);
+
+	// Sets whether floors and ceilings are drawn a row at a time instead of with the ray cast
+	// columns. Only for levels with one flat floor and ceiling layer (i.e., interiors).
+	void setScanlinePlanes(bool active);
 	void removeFlat(int id);
 	void removeLight(int id);
+	void bakeLights(const VoxelGrid &voxelGrid, double ceilingHeight);
+	void buildVisibilityRegions(const VoxelGrid &voxelGrid);
+	void clearVisibilityRegions();
 	void clearTextures();
+
+	// Advances the clock of animated voxel textures.
+	void tickAnimations(double dt);
 	void clearDistantSky();
 
+	// Runs batches of non-render work (i.e., entity updates) on the render threads between
+	// frames. See SoftwareRenderer::runParallel().
+	void runParallel(int batchCount, const std::function<void(int)> &batchFunction);
+
+	// Copies the native frame buffer so it can be shown again instead of drawing what's
+	// under a modal sub-panel every frame. The copy is kept until clearFrozenFrame() or a
+	// resize.
+	void freezeFrame();
+	bool isFrameFrozen() const;
+	void drawFrozenFrame();
+	void clearFrozenFrame();
+
 	// Fills the native frame buffer with the draw color, or default black/transparent.
 	void clear(const Color &color);
 	void clear();
@@ -177,14 +333,31 @@ public:
 	void fillOriginalRect(const Color &color, int x, int y, int w, int h);
 
 	// Runs the 3D renderer which draws the world onto the native frame buffer.
-	// If the renderer is uninitialized, this causes a crash.
+	// If the renderer is uninitialized, this causes a crash. Frames are rendered straight
+	// into the locked game world texture when possible, otherwise into a CPU buffer that is
+	// copied over. If 'pipelined' is true, the previous frame is uploaded while the render
+	// threads work on this one, and this frame is shown on the next call instead. If
+	// 'interlacedVoxels' is true, only every other voxel column is ray cast and the rest are
+	// reused from the previous frame. If 'paletteRendering' is true, voxels and flats are
+	// shaded through palette light tables. If nothing changed since the last frame, it's
+	// shown again without rendering.
 	void renderWorld(const Double3 &eye, const Double3 &forward, double fovY, 
 		double ambient, double daytimePercent, double latitude, bool parallaxSky,
-		double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
-		const VoxelGrid &voxelGrid);
+		double ceilingHeight, const LevelData::OpenDoors &openDoors,
+		const VoxelGrid &voxelGrid, bool pipelined, bool interlacedVoxels,
+		bool paletteRendering);
+
+	// Runs the 3D renderer into the given buffer of the dimensions given to
+	// initializeOffscreenWorldRendering(). Nothing is uploaded or presented.
+	void renderWorldOffscreen(const Double3 &eye, const Double3 &forward, double fovY,
+		double ambient, double daytimePercent, double latitude, bool parallaxSky,
+		double ceilingHeight, const LevelData::OpenDoors &openDoors,
+		const VoxelGrid &voxelGrid, bool interlacedVoxels, bool paletteRendering,
+		uint32_t *colorBuffer);
 
 	// Draws the given cursor texture to the native frame buffer. The exact position 
-	// of the cursor is modified by the cursor alignment.
+	// of the cursor is modified by the cursor alignment. The scaled cursor is kept between
+	// frames.
 	void drawCursor(const Texture &texture, CursorAlignment alignment, 
 		const Int2 &mousePosition, double scale);
 
@@ -200,6 +373,10 @@ public:
 	void drawOriginalClipped(const Texture &texture, const Rect &srcRect, const Rect &dstRect);
 	void drawOriginalClipped(const Texture &texture, const Rect &srcRect, int x, int y);
 
+	// Same as drawOriginal() but draws a copy scaled ahead of time to the size on screen,
+	// for large images drawn every frame (i.e., the first-person weapon).
+	void drawOriginalPrescaled(const Texture &texture, int x, int y, int w, int h);
+
 	// Stretches a texture over the entire native frame buffer.
 	void fill(const Texture &texture);
 
@@ -0,0 +1,156 @@
+#include <iomanip>
+#include <sstream>
+
+#include "SDL.h"
+
+#include "ScreenshotWriter.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/File.h"
+#include "../Utilities/JobSystem.h"
+
+namespace
+{
+	const std::string ScreenshotPrefix = "screenshot";
+	const std::string CapturePrefix = "capture";
+	const int ScreenshotDigits = 3;
+	const int CaptureDigits = 5;
+}
+
+const int ScreenshotWriter::MAX_QUEUED_FRAMES = 8;
+
+ScreenshotWriter::ScreenshotWriter()
+{
+	this->nextScreenshotIndex = -1;
+	this->nextCaptureIndex = -1;
+	this->writing = false;
+}
+
+ScreenshotWriter::~ScreenshotWriter()
+{
+	// Let the write job finish anything still queued.
+	if (this->writeJob.valid())
+	{
+		this->writeJob.wait();
+	}
+}
+
+std::string ScreenshotWriter::makePath(const std::string &prefix, int digits, int index) const
+{
+	std::stringstream ss;
+	ss << std::setw(digits) << std::setfill('0') << index;
+	return this->folder + prefix + ss.str() + ".bmp";
+}
+
+int ScreenshotWriter::getFirstFreeIndex(const std::string &prefix, int digits) const
+{
+	int index = 0;
+	while (File::exists(this->makePath(prefix, digits, index)))
+	{
+		index++;
+	}
+
+	return index;
+}
+
+void ScreenshotWriter::addJob(Surface &&surface, std::string &&path, bool isCapture)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	Job job;
+	job.surface = std::move(surface);
+	job.path = std::move(path);
+	job.isCapture = isCapture;
+	this->jobs.push_back(std::move(job));
+
+	// Only one write job runs at a time so files are written in order. It's submitted
+	// unlocked since it runs right away if the job system is shut down.
+	const bool startWriting = !this->writing;
+	this->writing = true;
+	lock.unlock();
+
+	if (startWriting)
+	{
+		this->writeJob = JobSystem::submit(JobSystem::Priority::Background,
+			[this]() { this->writeQueued(); });
+	}
+}
+
+void ScreenshotWriter::writeQueued()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		if (this->jobs.empty())
+		{
+			// The next file queued starts another write job.
+			this->writing = false;
+			break;
+		}
+
+		Job job = std::move(this->jobs.front());
+		this->jobs.pop_front();
+		lock.unlock();
+
+		const int status = SDL_SaveBMP(job.surface.get(), job.path.c_str());
+
+		if (status == 0)
+		{
+			if (!job.isCapture)
+			{
+				DebugLog("Screenshot saved to \"" + job.path + "\".");
+			}
+		}
+		else
+		{
+			DebugLogWarning("Failed to save screenshot to \"" + job.path + "\": " +
+				std::string(SDL_GetError()));
+		}
+	}
+}
+
+void ScreenshotWriter::init(const std::string &folder)
+{
+	DebugAssert(this->folder.empty());
+	this->folder = folder;
+}
+
+bool ScreenshotWriter::isFull() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return static_cast<int>(this->jobs.size()) >= ScreenshotWriter::MAX_QUEUED_FRAMES;
+}
+
+void ScreenshotWriter::addScreenshot(Surface &&surface)
+{
+	DebugAssert(!this->folder.empty());
+
+	// Only the first screenshot scans the folder. Later ones count up from there.
+	if (this->nextScreenshotIndex < 0)
+	{
+		this->nextScreenshotIndex = this->getFirstFreeIndex(ScreenshotPrefix, ScreenshotDigits);
+	}
+
+	std::string path = this->makePath(ScreenshotPrefix, ScreenshotDigits,
+		this->nextScreenshotIndex);
+	this->nextScreenshotIndex++;
+	this->addJob(std::move(surface), std::move(path), false);
+}
+
+bool ScreenshotWriter::addCapture(Surface &&surface)
+{
+	DebugAssert(!this->folder.empty());
+
+	if (this->isFull())
+	{
+		return false;
+	}
+
+	if (this->nextCaptureIndex < 0)
+	{
+		this->nextCaptureIndex = this->getFirstFreeIndex(CapturePrefix, CaptureDigits);
+	}
+
+	std::string path = this->makePath(CapturePrefix, CaptureDigits, this->nextCaptureIndex);
+	this->nextCaptureIndex++;
+	this->addJob(std::move(surface), std::move(path), true);
+	return true;
+}
@@ -0,0 +1,68 @@
+#ifndef SCREENSHOT_WRITER_H
+#define SCREENSHOT_WRITER_H
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+
+#include "Surface.h"
+
+// Saves screenshots and captured frames as BMP files with a background job so the main
+// thread doesn't hitch on file writes. Screenshots are always queued, but captured frames
+// are dropped while the queue is full so continuous capture never stalls rendering.
+
+class ScreenshotWriter
+{
+public:
+	// Most captured frames waiting to be written at once.
+	static const int MAX_QUEUED_FRAMES;
+private:
+	struct Job
+	{
+		Surface surface;
+		std::string path;
+		bool isCapture; // Captured frames aren't logged when saved.
+	};
+
+	std::deque<Job> jobs;
+	mutable std::mutex mutex;
+	std::future<void> writeJob; // Writes queued files in order until there are none left.
+	std::string folder;
+
+	// Next free file indices, found by scanning the folder once. -1 until then.
+	int nextScreenshotIndex, nextCaptureIndex;
+	bool writing; // Whether the write job is taking files from the queue.
+
+	// Gets the lowest free index of the given filename prefix in the screenshots folder.
+	int getFirstFreeIndex(const std::string &prefix, int digits) const;
+
+	// Makes the path of a numbered file in the screenshots folder.
+	std::string makePath(const std::string &prefix, int digits, int index) const;
+
+	void addJob(Surface &&surface, std::string &&path, bool isCapture);
+
+	// Writes queued jobs until the queue is empty.
+	void writeQueued();
+public:
+	ScreenshotWriter();
+	ScreenshotWriter(const ScreenshotWriter&) = delete;
+	~ScreenshotWriter();
+
+	ScreenshotWriter &operator=(const ScreenshotWriter&) = delete;
+
+	// Sets the folder files are saved in.
+	void init(const std::string &folder);
+
+	// Returns whether enough captured frames are waiting that new ones would be dropped.
+	bool isFull() const;
+
+	// Queues a screenshot to be saved at the lowest available index.
+	void addScreenshot(Surface &&surface);
+
+	// Queues a captured frame of continuous capture. Returns false and drops the frame if
+	// the queue is full.
+	bool addCapture(Surface &&surface);
+};
+
+#endif
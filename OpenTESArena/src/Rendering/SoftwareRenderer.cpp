@@ -1,6 +1,12 @@
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <future>
 #include <limits>
+#include <numeric>
 
 #include "SoftwareRenderer.h"
 #include "Surface.h"
@@ -8,25 +14,346 @@
 #include "../Math/MathUtils.h"
 #include "../Media/Color.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/KernelDispatch.h"
+#include "../Utilities/MemoryReport.h"
 #include "../Utilities/Platform.h"
+#include "../Utilities/PlatformIsa.h"
+#include "../Utilities/Profiler.h"
 #include "../World/VoxelDataType.h"
 #include "../World/VoxelGrid.h"
 
+namespace
+{
+	// Texture lookup for the render loops. IDs come from voxel and flat data that was checked
+	// when it was added, so only validation builds check them again here.
+	template <typename T>
+	const T &getTexture(const std::vector<T> &textures, int id)
+	{
+		DebugValidateIndex(textures, id);
+		return textures[id];
+	}
+
+	// Copies the given columns of a column-major frame to the same columns of a row-major one.
+	void transposePixelsScalar(const uint32_t *srcPixels, uint32_t *dstPixels, int width,
+		int height, int startX, int endX)
+	{
+		// Rows are done in bands so the columns being read from stay in the cache between rows.
+		constexpr int bandHeight = 16;
+
+		for (int bandY = 0; bandY < height; bandY += bandHeight)
+		{
+			const int bandEndY = std::min(bandY + bandHeight, height);
+			for (int y = bandY; y < bandEndY; y++)
+			{
+				uint32_t *dstRow = dstPixels + (y * width);
+				for (int x = startX; x < endX; x++)
+				{
+					dstRow[x] = srcPixels[y + (x * height)];
+				}
+			}
+		}
+	}
+
+#if defined(PLATFORM_SSE2)
+	void transposePixelsSSE2(const uint32_t *srcPixels, uint32_t *dstPixels, int width,
+		int height, int startX, int endX)
+	{
+		// Rows are done in bands so the columns being read from stay in the cache between rows.
+		constexpr int bandHeight = 16;
+
+		for (int bandY = 0; bandY < height; bandY += bandHeight)
+		{
+			const int bandEndY = std::min(bandY + bandHeight, height);
+			int y = bandY;
+
+			// Blocks of 4x4 pixels are transposed in registers.
+			for (; (y + 4) <= bandEndY; y += 4)
+			{
+				int x = startX;
+				for (; (x + 4) <= endX; x += 4)
+				{
+					const uint32_t *src = srcPixels + y + (x * height);
+					const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+					const __m128i c1 = _mm_loadu_si128(
+						reinterpret_cast<const __m128i*>(src + height));
+					const __m128i c2 = _mm_loadu_si128(
+						reinterpret_cast<const __m128i*>(src + (height * 2)));
+					const __m128i c3 = _mm_loadu_si128(
+						reinterpret_cast<const __m128i*>(src + (height * 3)));
+
+					const __m128i c01Lo = _mm_unpacklo_epi32(c0, c1);
+					const __m128i c01Hi = _mm_unpackhi_epi32(c0, c1);
+					const __m128i c23Lo = _mm_unpacklo_epi32(c2, c3);
+					const __m128i c23Hi = _mm_unpackhi_epi32(c2, c3);
+
+					uint32_t *dst = dstPixels + x + (y * width);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+						_mm_unpacklo_epi64(c01Lo, c23Lo));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + width),
+						_mm_unpackhi_epi64(c01Lo, c23Lo));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (width * 2)),
+						_mm_unpacklo_epi64(c01Hi, c23Hi));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (width * 3)),
+						_mm_unpackhi_epi64(c01Hi, c23Hi));
+				}
+
+				// Leftover columns.
+				for (; x < endX; x++)
+				{
+					for (int blockY = y; blockY < (y + 4); blockY++)
+					{
+						dstPixels[x + (blockY * width)] = srcPixels[blockY + (x * height)];
+					}
+				}
+			}
+
+			// Leftover rows.
+			for (; y < bandEndY; y++)
+			{
+				uint32_t *dstRow = dstPixels + (y * width);
+				for (int x = startX; x < endX; x++)
+				{
+					dstRow[x] = srcPixels[y + (x * height)];
+				}
+			}
+		}
+	}
+#endif
+
+	const KernelDispatch::Kernel<void(const uint32_t*, uint32_t*, int, int, int, int)>
+		TransposePixelsKernel("TransposeFrame",
+	{
+		{ Platform::CpuIsa::Scalar, transposePixelsScalar },
+#if defined(PLATFORM_SSE2)
+		{ Platform::CpuIsa::SSE2, transposePixelsSSE2 }
+#endif
+	});
+
+	// Shading for a run of voxel texels that share the same light and fog. Values are in
+	// B, G, R order so each texel's channels come out in packed color order, and the fourth
+	// lane is zero. Disabled fog is a color percent of one and a fog color of zero.
+	struct VoxelTexelSpanShading
+	{
+		std::array<double, 4> multipliers; // Shading clamped to [0, 1] for plain texels.
+		std::array<double, 4> emissiveMultipliers; // Same for emissive texels.
+		std::array<double, 4> fogColor; // Premultiplied by the fog percent.
+		double colorPercent;
+		uint8_t emissiveFlag;
+	};
+
+	// Texels are 4 bytes each (R, G, B, flags) and colors are written in 0x00RRGGBB format.
+	// Every version does the same math in doubles as getShadedVoxelTexelColor(), though ones
+	// built with FMA may fuse the fog multiply-add.
+	void shadeVoxelTexelSpanScalar(const uint8_t *texels, int count,
+		const VoxelTexelSpanShading &shading, uint32_t *outColors)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			const uint8_t *texel = texels + (i * 4);
+			const std::array<double, 4> &multipliers = ((texel[3] & shading.emissiveFlag) != 0) ?
+				shading.emissiveMultipliers : shading.multipliers;
+
+			uint32_t color = 0;
+			for (int channel = 0; channel < 3; channel++)
+			{
+				const double value = static_cast<double>(texel[2 - channel]) / 255.0;
+				double shaded = ((value * multipliers[channel]) * shading.colorPercent) +
+					shading.fogColor[channel];
+				shaded = (shaded > 1.0) ? 1.0 : shaded;
+				color |= static_cast<uint32_t>(static_cast<uint8_t>(shaded * 255.0)) <<
+					(channel * 8);
+			}
+
+			outColors[i] = color;
+		}
+	}
+
+#if defined(PLATFORM_SSE2)
+	void shadeVoxelTexelSpanSSE2(const uint8_t *texels, int count,
+		const VoxelTexelSpanShading &shading, uint32_t *outColors)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128d channelMax = _mm_set1_pd(255.0);
+		const __m128d one = _mm_set1_pd(1.0);
+		const __m128d colorPercent = _mm_set1_pd(shading.colorPercent);
+		const __m128d fogBG = _mm_loadu_pd(shading.fogColor.data());
+		const __m128d fogRX = _mm_loadu_pd(shading.fogColor.data() + 2);
+
+		for (int i = 0; i < count; i++)
+		{
+			const uint8_t *texel = texels + (i * 4);
+			const std::array<double, 4> &multipliers = ((texel[3] & shading.emissiveFlag) != 0) ?
+				shading.emissiveMultipliers : shading.multipliers;
+
+			// Widen R, G, B, flags to 32-bit lanes in B, G, R, flags order.
+			uint32_t texelBits;
+			std::memcpy(&texelBits, texel, sizeof(texelBits));
+			__m128i channels = _mm_unpacklo_epi8(_mm_cvtsi32_si128(texelBits), zero);
+			channels = _mm_unpacklo_epi16(channels, zero);
+			channels = _mm_shuffle_epi32(channels, _MM_SHUFFLE(3, 0, 1, 2));
+
+			__m128d bg = _mm_div_pd(_mm_cvtepi32_pd(channels), channelMax);
+			__m128d rx = _mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(channels,
+				_MM_SHUFFLE(3, 2, 3, 2))), channelMax);
+			bg = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(bg, _mm_loadu_pd(multipliers.data())),
+				colorPercent), fogBG);
+			rx = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(rx, _mm_loadu_pd(multipliers.data() + 2)),
+				colorPercent), fogRX);
+			bg = _mm_mul_pd(_mm_min_pd(bg, one), channelMax);
+			rx = _mm_mul_pd(_mm_min_pd(rx, one), channelMax);
+
+			// Truncate like the scalar cast, then narrow the lanes to bytes.
+			const __m128i ints = _mm_unpacklo_epi64(_mm_cvttpd_epi32(bg), _mm_cvttpd_epi32(rx));
+			const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(ints, zero), zero);
+			outColors[i] = static_cast<uint32_t>(_mm_cvtsi128_si32(bytes));
+		}
+	}
+#endif
+
+#if defined(PLATFORM_AVX2)
+	PLATFORM_TARGET_AVX2 void shadeVoxelTexelSpanAVX2(const uint8_t *texels, int count,
+		const VoxelTexelSpanShading &shading, uint32_t *outColors)
+	{
+		const __m256d channelMax = _mm256_set1_pd(255.0);
+		const __m256d one = _mm256_set1_pd(1.0);
+		const __m256d colorPercent = _mm256_set1_pd(shading.colorPercent);
+		const __m256d fogColor = _mm256_loadu_pd(shading.fogColor.data());
+		const __m256d multipliers = _mm256_loadu_pd(shading.multipliers.data());
+		const __m256d emissiveMultipliers = _mm256_loadu_pd(shading.emissiveMultipliers.data());
+
+		for (int i = 0; i < count; i++)
+		{
+			const uint8_t *texel = texels + (i * 4);
+			const __m256d texelMultipliers = ((texel[3] & shading.emissiveFlag) != 0) ?
+				emissiveMultipliers : multipliers;
+
+			// Each texel's channels fill one vector in B, G, R, flags order.
+			uint32_t texelBits;
+			std::memcpy(&texelBits, texel, sizeof(texelBits));
+			const __m128i channels = _mm_shuffle_epi32(
+				_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(texelBits))),
+				_MM_SHUFFLE(3, 0, 1, 2));
+
+			__m256d color = _mm256_div_pd(_mm256_cvtepi32_pd(channels), channelMax);
+			color = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(color, texelMultipliers),
+				colorPercent), fogColor);
+			color = _mm256_mul_pd(_mm256_min_pd(color, one), channelMax);
+
+			const __m128i ints = _mm256_cvttpd_epi32(color);
+			const __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(ints, ints), ints);
+			outColors[i] = static_cast<uint32_t>(_mm_cvtsi128_si32(bytes));
+		}
+	}
+#endif
+
+#if defined(PLATFORM_NEON)
+	void shadeVoxelTexelSpanNEON(const uint8_t *texels, int count,
+		const VoxelTexelSpanShading &shading, uint32_t *outColors)
+	{
+		// Byte shuffle from R, G, B, flags to 32-bit lanes in B, G, R, flags order. Indices
+		// out of range give zero.
+		static const uint8_t ChannelShuffle[16] =
+		{
+			2, 255, 255, 255, 1, 255, 255, 255, 0, 255, 255, 255, 3, 255, 255, 255
+		};
+
+		const uint8x16_t shuffle = vld1q_u8(ChannelShuffle);
+		const float64x2_t channelMax = vdupq_n_f64(255.0);
+		const float64x2_t one = vdupq_n_f64(1.0);
+		const float64x2_t colorPercent = vdupq_n_f64(shading.colorPercent);
+		const float64x2_t fogBG = vld1q_f64(shading.fogColor.data());
+		const float64x2_t fogRX = vld1q_f64(shading.fogColor.data() + 2);
+
+		for (int i = 0; i < count; i++)
+		{
+			const uint8_t *texel = texels + (i * 4);
+			const std::array<double, 4> &multipliers = ((texel[3] & shading.emissiveFlag) != 0) ?
+				shading.emissiveMultipliers : shading.multipliers;
+
+			uint32_t texelBits;
+			std::memcpy(&texelBits, texel, sizeof(texelBits));
+			const uint32x4_t channels = vreinterpretq_u32_u8(
+				vqtbl1q_u8(vreinterpretq_u8_u32(vdupq_n_u32(texelBits)), shuffle));
+
+			float64x2_t bg = vdivq_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(channels))),
+				channelMax);
+			float64x2_t rx = vdivq_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(channels))),
+				channelMax);
+			bg = vaddq_f64(vmulq_f64(vmulq_f64(bg, vld1q_f64(multipliers.data())),
+				colorPercent), fogBG);
+			rx = vaddq_f64(vmulq_f64(vmulq_f64(rx, vld1q_f64(multipliers.data() + 2)),
+				colorPercent), fogRX);
+			bg = vmulq_f64(vminq_f64(bg, one), channelMax);
+			rx = vmulq_f64(vminq_f64(rx, one), channelMax);
+
+			// Truncate like the scalar cast, then narrow the lanes to bytes.
+			const uint32x4_t ints = vcombine_u32(vmovn_u64(vcvtq_u64_f64(bg)),
+				vmovn_u64(vcvtq_u64_f64(rx)));
+			const uint16x4_t shorts = vmovn_u32(ints);
+			const uint8x8_t bytes = vmovn_u16(vcombine_u16(shorts, shorts));
+			outColors[i] = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+		}
+	}
+#endif
+
+	const KernelDispatch::Kernel<void(const uint8_t*, int, const VoxelTexelSpanShading&,
+		uint32_t*)> ShadeVoxelTexelSpanKernel("ShadeVoxelTexelSpan",
+	{
+		{ Platform::CpuIsa::Scalar, shadeVoxelTexelSpanScalar },
+#if defined(PLATFORM_SSE2)
+		{ Platform::CpuIsa::SSE2, shadeVoxelTexelSpanSSE2 },
+#endif
+#if defined(PLATFORM_AVX2)
+		{ Platform::CpuIsa::AVX2, shadeVoxelTexelSpanAVX2 },
+#endif
+#if defined(PLATFORM_NEON)
+		{ Platform::CpuIsa::NEON, shadeVoxelTexelSpanNEON }
+#endif
+	});
+
+	// Gets a phase name that lives as long as the program, for profiler zones.
+	const char *getProfilerPhaseName(RenderTimings::Phase phase)
+	{
+		static const std::array<std::string, RenderTimings::PHASE_COUNT> PhaseNames = []()
+		{
+			std::array<std::string, RenderTimings::PHASE_COUNT> names;
+			for (int i = 0; i < RenderTimings::PHASE_COUNT; i++)
+			{
+				names[i] = RenderTimings::getPhaseName(static_cast<RenderTimings::Phase>(i));
+			}
+
+			return names;
+		}();
+
+		return PhaseNames[static_cast<int>(phase)].c_str();
+	}
+}
+
 SoftwareRenderer::VoxelTexel::VoxelTexel()
 {
-	this->r = 0.0;
-	this->g = 0.0;
-	this->b = 0.0;
-	this->emission = 0.0;
-	this->transparent = false;
+	this->r = 0;
+	this->g = 0;
+	this->b = 0;
+	this->flags = 0;
+}
+
+bool SoftwareRenderer::VoxelTexel::isTransparent() const
+{
+	return (this->flags & VoxelTexel::FLAG_TRANSPARENT) != 0;
+}
+
+double SoftwareRenderer::VoxelTexel::getEmission() const
+{
+	return ((this->flags & VoxelTexel::FLAG_EMISSIVE) != 0) ? 1.0 : 0.0;
 }
 
 SoftwareRenderer::FlatTexel::FlatTexel()
 {
-	this->r = 0.0;
-	this->g = 0.0;
-	this->b = 0.0;
-	this->a = 0.0;
+	this->r = 0;
+	this->g = 0;
+	this->b = 0;
+	this->a = 0;
 }
 
 SoftwareRenderer::SkyTexel::SkyTexel()
@@ -37,10 +364,330 @@ SoftwareRenderer::SkyTexel::SkyTexel()
 	this->transparent = false;
 }
 
+SoftwareRenderer::ShadeTable::ShadeTable()
+{
+	this->palette.fill(0);
+	this->fogColor = Double3::Zero;
+}
+
+void SoftwareRenderer::ShadeTable::init(const uint32_t *paletteColors)
+{
+	std::copy(paletteColors, paletteColors + ShadeTable::PALETTE_SIZE, this->palette.begin());
+
+	// Some palettes repeat colors, so the first index of each one is used.
+	this->paletteIndices.clear();
+	for (int i = 0; i < ShadeTable::PALETTE_SIZE; i++)
+	{
+		this->paletteIndices.emplace(this->palette[i] & 0x00FFFFFF, static_cast<uint8_t>(i));
+	}
+
+	// Force the colors to be recalculated.
+	this->colors.clear();
+	this->update(this->fogColor);
+}
+
+void SoftwareRenderer::ShadeTable::update(const Double3 &fogColor)
+{
+	if ((this->colors.size() > 0) && (fogColor == this->fogColor))
+	{
+		return;
+	}
+
+	this->fogColor = fogColor;
+	this->colors.resize(ShadeTable::SHADE_COUNT * ShadeTable::PALETTE_SIZE);
+
+	for (int shade = 0; shade < ShadeTable::SHADE_COUNT; shade++)
+	{
+		const int lightLevel = shade / ShadeTable::FOG_LEVEL_COUNT;
+		const int fogLevel = shade % ShadeTable::FOG_LEVEL_COUNT;
+		const double lightPercent = static_cast<double>(lightLevel) /
+			static_cast<double>(ShadeTable::LIGHT_LEVEL_COUNT - 1);
+		const double fogPercent = static_cast<double>(fogLevel) /
+			static_cast<double>(ShadeTable::FOG_LEVEL_COUNT - 1);
+		const double colorPercent = lightPercent * (1.0 - fogPercent);
+		const Double3 fogComponent = fogColor * fogPercent;
+
+		uint32_t *shadeColors = this->colors.data() + (shade * ShadeTable::PALETTE_SIZE);
+		for (int i = 0; i < ShadeTable::PALETTE_SIZE; i++)
+		{
+			const Double3 color = ((Double3::fromRGB(this->palette[i]) * colorPercent) +
+				fogComponent).clamped(0.0, 1.0);
+
+			shadeColors[i] = static_cast<uint32_t>(
+				((static_cast<uint8_t>(color.x * 255.0)) << 16) |
+				((static_cast<uint8_t>(color.y * 255.0)) << 8) |
+				((static_cast<uint8_t>(color.z * 255.0))));
+		}
+	}
+}
+
+uint8_t SoftwareRenderer::ShadeTable::getNearestIndex(uint8_t r, uint8_t g, uint8_t b) const
+{
+	// Most texels are exactly a palette color, except in mip levels and night lights.
+	const uint32_t rgb = (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) |
+		static_cast<uint32_t>(b);
+	const auto iter = this->paletteIndices.find(rgb);
+	if (iter != this->paletteIndices.end())
+	{
+		return iter->second;
+	}
+
+	int nearestIndex = 0;
+	int nearestDistSqr = std::numeric_limits<int>::max();
+	for (int i = 0; i < ShadeTable::PALETTE_SIZE; i++)
+	{
+		const uint32_t color = this->palette[i];
+		const int diffR = static_cast<int>(r) - static_cast<int>((color >> 16) & 0xFF);
+		const int diffG = static_cast<int>(g) - static_cast<int>((color >> 8) & 0xFF);
+		const int diffB = static_cast<int>(b) - static_cast<int>(color & 0xFF);
+		const int distSqr = (diffR * diffR) + (diffG * diffG) + (diffB * diffB);
+
+		if (distSqr < nearestDistSqr)
+		{
+			nearestIndex = i;
+			nearestDistSqr = distSqr;
+		}
+	}
+
+	return static_cast<uint8_t>(nearestIndex);
+}
+
+uint16_t SoftwareRenderer::ShadeTable::getIndexValue(uint8_t paletteIndex, double lightPercent,
+	double fogPercent)
+{
+	const int lightLevel = static_cast<int>((std::clamp(lightPercent, 0.0, 1.0) *
+		static_cast<double>(ShadeTable::LIGHT_LEVEL_COUNT - 1)) + 0.50);
+	const int fogLevel = static_cast<int>((std::clamp(fogPercent, 0.0, 1.0) *
+		static_cast<double>(ShadeTable::FOG_LEVEL_COUNT - 1)) + 0.50);
+	const int shade = (lightLevel * ShadeTable::FOG_LEVEL_COUNT) + fogLevel;
+	return static_cast<uint16_t>((shade * ShadeTable::PALETTE_SIZE) + paletteIndex);
+}
+
+int SoftwareRenderer::VoxelTexture::getMipOffset(int level)
+{
+	int offset = 0;
+	for (int i = 0; i < level; i++)
+	{
+		offset += VoxelTexture::TEXEL_COUNT >> (i * 2);
+	}
+
+	return offset;
+}
+
+int SoftwareRenderer::VoxelTexture::getTexelIndex(int x, int y, int height)
+{
+	return y + (x * height);
+}
+
+int SoftwareRenderer::VoxelTexture::getMipLevel(double texelsPerPixel)
+{
+	// Each level halves the texel density, so step down until a pixel is no longer
+	// skipping over texels.
+	int level = 0;
+	while ((texelsPerPixel >= 2.0) && (level < (VoxelTexture::MIP_LEVEL_COUNT - 1)))
+	{
+		texelsPerPixel *= 0.50;
+		level++;
+	}
+
+	return level;
+}
+
+const SoftwareRenderer::VoxelTexel *SoftwareRenderer::VoxelTexture::getTexels(
+	bool nightLightsActive) const
+{
+	return (nightLightsActive && !this->nightTexels.empty()) ?
+		this->nightTexels.data() : this->texels.data();
+}
+
+const uint8_t *SoftwareRenderer::VoxelTexture::getPaletteIndices(bool nightLightsActive) const
+{
+	return (nightLightsActive && !this->nightPaletteIndices.empty()) ?
+		this->nightPaletteIndices.data() : this->paletteIndices.data();
+}
+
+void SoftwareRenderer::VoxelTexture::updateMipLevels(VoxelTexel *texels)
+{
+	for (int level = 1; level < VoxelTexture::MIP_LEVEL_COUNT; level++)
+	{
+		const int srcHeight = VoxelTexture::HEIGHT >> (level - 1);
+		const int dstWidth = VoxelTexture::WIDTH >> level;
+		const int dstHeight = VoxelTexture::HEIGHT >> level;
+		const VoxelTexel *srcTexels = texels + VoxelTexture::getMipOffset(level - 1);
+		VoxelTexel *dstTexels = texels + VoxelTexture::getMipOffset(level);
+
+		for (int x = 0; x < dstWidth; x++)
+		{
+			for (int y = 0; y < dstHeight; y++)
+			{
+				// Average the opaque texels in each 2x2 block. A block is transparent if most
+				// of it is, so alpha-tested edges stay in about the same place.
+				const std::array<const VoxelTexel*, 4> blockTexels =
+				{
+					&srcTexels[VoxelTexture::getTexelIndex(x * 2, y * 2, srcHeight)],
+					&srcTexels[VoxelTexture::getTexelIndex((x * 2) + 1, y * 2, srcHeight)],
+					&srcTexels[VoxelTexture::getTexelIndex(x * 2, (y * 2) + 1, srcHeight)],
+					&srcTexels[VoxelTexture::getTexelIndex((x * 2) + 1, (y * 2) + 1, srcHeight)]
+				};
+
+				int r = 0, g = 0, b = 0, opaqueCount = 0, emissiveCount = 0;
+				for (const VoxelTexel *texel : blockTexels)
+				{
+					if (!texel->isTransparent())
+					{
+						r += texel->r;
+						g += texel->g;
+						b += texel->b;
+						opaqueCount++;
+
+						if ((texel->flags & VoxelTexel::FLAG_EMISSIVE) != 0)
+						{
+							emissiveCount++;
+						}
+					}
+				}
+
+				VoxelTexel &dstTexel = dstTexels[VoxelTexture::getTexelIndex(x, y, dstHeight)];
+				if (opaqueCount >= 2)
+				{
+					dstTexel.r = static_cast<uint8_t>((r + (opaqueCount / 2)) / opaqueCount);
+					dstTexel.g = static_cast<uint8_t>((g + (opaqueCount / 2)) / opaqueCount);
+					dstTexel.b = static_cast<uint8_t>((b + (opaqueCount / 2)) / opaqueCount);
+					dstTexel.flags = ((emissiveCount * 2) >= opaqueCount) ?
+						VoxelTexel::FLAG_EMISSIVE : 0;
+				}
+				else
+				{
+					dstTexel = VoxelTexel();
+					dstTexel.flags = VoxelTexel::FLAG_TRANSPARENT;
+				}
+			}
+		}
+	}
+}
+
+void SoftwareRenderer::VoxelTexture::updateMipLevels()
+{
+	VoxelTexture::updateMipLevels(this->texels.data());
+
+	if (!this->nightTexels.empty())
+	{
+		VoxelTexture::updateMipLevels(this->nightTexels.data());
+	}
+}
+
+void SoftwareRenderer::VoxelTexture::updatePaletteIndices(const VoxelTexel *texels,
+	uint8_t *paletteIndices, const ShadeTable &shadeTable, int startLevel)
+{
+	for (int i = VoxelTexture::getMipOffset(startLevel); i < VoxelTexture::MIP_TEXEL_COUNT; i++)
+	{
+		const VoxelTexel &texel = texels[i];
+		paletteIndices[i] = shadeTable.getNearestIndex(texel.r, texel.g, texel.b);
+	}
+}
+
+void SoftwareRenderer::VoxelTexture::updatePaletteIndices(const ShadeTable &shadeTable,
+	int startLevel)
+{
+	VoxelTexture::updatePaletteIndices(this->texels.data(), this->paletteIndices.data(),
+		shadeTable, startLevel);
+
+	if (!this->nightTexels.empty())
+	{
+		VoxelTexture::updatePaletteIndices(this->nightTexels.data(),
+			this->nightPaletteIndices.data(), shadeTable, startLevel);
+	}
+}
+
+void SoftwareRenderer::VoxelTexture::initNightTexels()
+{
+	if (this->lightTexels.empty())
+	{
+		this->nightTexels.clear();
+		this->nightPaletteIndices.clear();
+		return;
+	}
+
+	for (const Int2 &lightTexel : this->lightTexels)
+	{
+		const int index = VoxelTexture::getTexelIndex(
+			lightTexel.x, lightTexel.y, VoxelTexture::HEIGHT);
+		VoxelTexel &texel = this->texels[index];
+		texel.r = 0;
+		texel.g = 0;
+		texel.b = 0;
+		texel.flags = 0;
+	}
+
+	this->nightTexels.assign(this->texels.begin(), this->texels.end());
+	this->nightPaletteIndices.resize(VoxelTexture::MIP_TEXEL_COUNT);
+
+	const uint32_t nightColor = Color(255, 166, 0).toARGB();
+	for (const Int2 &lightTexel : this->lightTexels)
+	{
+		const int index = VoxelTexture::getTexelIndex(
+			lightTexel.x, lightTexel.y, VoxelTexture::HEIGHT);
+		VoxelTexel &texel = this->nightTexels[index];
+		texel.r = static_cast<uint8_t>(nightColor >> 16);
+		texel.g = static_cast<uint8_t>(nightColor >> 8);
+		texel.b = static_cast<uint8_t>(nightColor);
+		texel.flags = VoxelTexel::FLAG_EMISSIVE;
+	}
+}
+
 SoftwareRenderer::FlatTexture::FlatTexture()
 {
 	this->width = 0;
 	this->height = 0;
+	this->frameCount = 0;
+}
+
+void SoftwareRenderer::FlatTexture::updatePaletteIndices(const ShadeTable &shadeTable)
+{
+	this->paletteIndices.resize(this->texels.size());
+
+	for (size_t i = 0; i < this->texels.size(); i++)
+	{
+		const FlatTexel &texel = this->texels[i];
+		this->paletteIndices[i] = shadeTable.getNearestIndex(texel.r, texel.g, texel.b);
+	}
+}
+
+void SoftwareRenderer::FlatTexture::initOpaqueRuns()
+{
+	// Frames are side by side, so their columns are gone through as one.
+	const int columnCount = this->width * this->frameCount;
+	this->opaqueRuns.clear();
+	this->columnRunOffsets = std::vector<int>(columnCount + 1);
+
+	for (int x = 0; x < columnCount; x++)
+	{
+		this->columnRunOffsets[x] = static_cast<int>(this->opaqueRuns.size());
+
+		const FlatTexel *columnTexels = this->texels.data() + (x * this->height);
+		int y = 0;
+		while (y < this->height)
+		{
+			// Find the next opaque texel, then where its run ends.
+			while ((y < this->height) && (columnTexels[y].a == 0))
+			{
+				y++;
+			}
+
+			const int runStart = y;
+			while ((y < this->height) && (columnTexels[y].a > 0))
+			{
+				y++;
+			}
+
+			if (runStart < y)
+			{
+				this->opaqueRuns.push_back(Int2(runStart, y));
+			}
+		}
+	}
+
+	this->columnRunOffsets[columnCount] = static_cast<int>(this->opaqueRuns.size());
 }
 
 SoftwareRenderer::SkyTexture::SkyTexture()
@@ -49,6 +696,38 @@ SoftwareRenderer::SkyTexture::SkyTexture()
 	this->height = 0;
 }
 
+void SoftwareRenderer::SkyTexture::initColumnOpaqueRanges()
+{
+	this->columnOpaqueStarts = std::vector<int>(this->width);
+	this->columnOpaqueEnds = std::vector<int>(this->width);
+
+	for (int x = 0; x < this->width; x++)
+	{
+		int start = this->height;
+		int end = 0;
+
+		for (int y = 0; y < this->height; y++)
+		{
+			const SkyTexel &texel = this->texels[x + (y * this->width)];
+			if (!texel.transparent)
+			{
+				start = std::min(start, y);
+				end = y + 1;
+			}
+		}
+
+		// Fully transparent columns have an empty range.
+		if (start >= end)
+		{
+			start = 0;
+			end = 0;
+		}
+
+		this->columnOpaqueStarts[x] = start;
+		this->columnOpaqueEnds[x] = end;
+	}
+}
+
 SoftwareRenderer::Camera::Camera(const Double3 &eye, const Double3 &direction,
 	double fovY, double aspect, double projectionModifier)
 	: eye(eye), direction(direction)
@@ -145,6 +824,9 @@ SoftwareRenderer::Ray::Ray(double dirX, double dirZ)
 	this->dirZ = dirZ;
 }
 
+SoftwareRenderer::Ray::Ray()
+	: Ray(0.0, 0.0) { }
+
 SoftwareRenderer::DrawRange::DrawRange(double yProjStart, double yProjEnd, int yStart, int yEnd)
 {
 	this->yProjStart = yProjStart;
@@ -205,9 +887,28 @@ void SoftwareRenderer::OcclusionData::update(int yStart, int yEnd)
 	}
 }
 
-SoftwareRenderer::ShadingInfo::ShadingInfo(const std::vector<Double3> &skyPalette,
-	double daytimePercent, double latitude, double ambient, double fogDistance)
+SoftwareRenderer::ShadingInfo::ShadingInfo(const LightGrid &lightGrid,
+	const LightMap &lightMap)
+	: lightGrid(lightGrid), lightMap(lightMap)
+{
+	this->ambient = 0.0;
+	this->distantAmbient = 0.0;
+	this->fogDistance = 0.0;
+	this->fogSampleScale = 0.0;
+	this->fogEnabled = false;
+	this->isAM = false;
+	this->nightLightsActive = false;
+	this->scanlinePlanes = false;
+	this->animationTime = 0.0;
+	this->fogSamplesDistance = 0.0;
+	this->fogSamplesValid = false;
+}
+
+void SoftwareRenderer::ShadingInfo::update(const std::vector<Double3> &skyPalette,
+	double daytimePercent, double latitude, double ambient, double fogDistance,
+	bool nightLightsActive)
 {
+	this->nightLightsActive = nightLightsActive;
 	this->timeRotation = SoftwareRenderer::getTimeOfDayRotation(daytimePercent);
 	this->latitudeRotation = SoftwareRenderer::getLatitudeRotation(latitude);
 
@@ -279,6 +980,37 @@ SoftwareRenderer::ShadingInfo::ShadingInfo(const std::vector<Double3> &skyPalett
 	this->distantAmbient = std::clamp(ambient, 0.25, 1.0);
 
 	this->fogDistance = fogDistance;
+	this->fogEnabled = std::isfinite(fogDistance);
+	this->fogSampleScale = this->fogEnabled ?
+		(static_cast<double>(ShadingInfo::FOG_SAMPLE_COUNT) / fogDistance) : 0.0;
+
+	// Fog is linear from the eye to the fog distance. Changes smaller than this can't show
+	// in an 8-bit channel.
+	constexpr double fogColorEpsilon = 0.50 / 255.0;
+	const Double3 &fogColor = this->getFogColor();
+	const Double3 fogColorDiff = fogColor - this->fogSamplesColor;
+	const bool fogSamplesCurrent = this->fogSamplesValid &&
+		(this->fogSamplesDistance == fogDistance) &&
+		(std::abs(fogColorDiff.x) < fogColorEpsilon) &&
+		(std::abs(fogColorDiff.y) < fogColorEpsilon) &&
+		(std::abs(fogColorDiff.z) < fogColorEpsilon);
+	if (fogSamplesCurrent)
+	{
+		return;
+	}
+
+	this->fogSamplesColor = fogColor;
+	this->fogSamplesDistance = fogDistance;
+	this->fogSamplesValid = true;
+	for (int i = 0; i < static_cast<int>(this->fogSamples.size()); i++)
+	{
+		const double fogPercent = static_cast<double>(i) /
+			static_cast<double>(ShadingInfo::FOG_SAMPLE_COUNT);
+
+		FogSample &fogSample = this->fogSamples[i];
+		fogSample.fogColor = fogColor * fogPercent;
+		fogSample.colorPercent = 1.0 - fogPercent;
+	}
 }
 
 const Double3 &SoftwareRenderer::ShadingInfo::getFogColor() const
@@ -287,12 +1019,329 @@ const Double3 &SoftwareRenderer::ShadingInfo::getFogColor() const
 	return this->skyColors.front();
 }
 
-SoftwareRenderer::FrameView::FrameView(uint32_t *colorBuffer, double *depthBuffer, 
-	int width, int height)
+const SoftwareRenderer::ShadingInfo::FogSample &SoftwareRenderer::ShadingInfo::getFogSample(
+	double depth) const
 {
-	this->colorBuffer = colorBuffer;
-	this->depthBuffer = depthBuffer;
-	this->width = width;
+	// Depths at or past the fog distance all use the last sample.
+	const double sampleIndex = std::min(depth * this->fogSampleScale,
+		static_cast<double>(ShadingInfo::FOG_SAMPLE_COUNT));
+	return this->fogSamples[static_cast<int>(sampleIndex + 0.50)];
+}
+
+const SoftwareRenderer::VoxelTexture &SoftwareRenderer::ShadingInfo::getVoxelTexture(
+	const std::vector<VoxelTexture> &textures, int id) const
+{
+	DebugValidateIndex(this->voxelTextureIndices, id);
+	return getTexture(textures, this->voxelTextureIndices[id]);
+}
+
+const std::vector<const SoftwareRenderer::Light*> *SoftwareRenderer::ShadingInfo::getVoxelColumnLights(
+	int voxelX, int voxelZ) const
+{
+	// Most scenes have no lights, so avoid hashing in that case.
+	if (this->lightGrid.empty())
+	{
+		return nullptr;
+	}
+
+	const auto cellIter = this->lightGrid.find(Int2(voxelX, voxelZ));
+	return (cellIter != this->lightGrid.end()) ? &cellIter->second : nullptr;
+}
+
+const std::vector<Double3> *SoftwareRenderer::ShadingInfo::getBakedVoxelColumn(
+	int voxelX, int voxelZ) const
+{
+	if (this->lightMap.columns.empty())
+	{
+		return nullptr;
+	}
+
+	const auto columnIter = this->lightMap.columns.find(Int2(voxelX, voxelZ));
+	return (columnIter != this->lightMap.columns.end()) ? &columnIter->second : nullptr;
+}
+
+Double3 SoftwareRenderer::ShadingInfo::getLightColor(const Double3 &point,
+	const std::vector<const Light*> &lights)
+{
+	Double3 lightColor = Double3::Zero;
+
+	for (const Light *light : lights)
+	{
+		const double distance = (light->point - point).length();
+		if (distance < light->intensity)
+		{
+			const double lightPercent = 1.0 - (distance / light->intensity);
+			lightColor = lightColor + (light->color * lightPercent);
+		}
+	}
+
+	return lightColor;
+}
+
+Double3 SoftwareRenderer::ShadingInfo::getVoxelLightColor(const Double3 &point, int voxelY,
+	VoxelData::Facing facing, const std::vector<Double3> *bakedColumn,
+	const std::vector<const Light*> *columnLights)
+{
+	Double3 lightColor = Double3::Zero;
+
+	if (bakedColumn != nullptr)
+	{
+		const int faceIndex = (voxelY * LightMap::FACES_PER_VOXEL) + static_cast<int>(facing);
+		lightColor = (*bakedColumn)[faceIndex];
+	}
+
+	if (columnLights != nullptr)
+	{
+		lightColor = lightColor + ShadingInfo::getLightColor(point, *columnLights);
+	}
+
+	return lightColor;
+}
+
+SoftwareRenderer::LightMap::LightMap()
+{
+	this->gridHeight = 0;
+	this->ceilingHeight = 0.0;
+}
+
+void SoftwareRenderer::LightMap::bake(const std::vector<Light> &lights, int gridHeight,
+	double ceilingHeight)
+{
+	this->gridHeight = gridHeight;
+	this->ceilingHeight = ceilingHeight;
+
+	const std::array<VoxelData::Facing, LightMap::FACES_PER_VOXEL> facings =
+	{
+		VoxelData::Facing::PositiveX,
+		VoxelData::Facing::NegativeX,
+		VoxelData::Facing::PositiveZ,
+		VoxelData::Facing::NegativeZ
+	};
+
+	for (const Light &light : lights)
+	{
+		Int2 minCell, maxCell;
+		SoftwareRenderer::getLightGridCells(light, &minCell, &maxCell);
+
+		for (int z = minCell.y; z <= maxCell.y; z++)
+		{
+			for (int x = minCell.x; x <= maxCell.x; x++)
+			{
+				std::vector<Double3> &column = this->columns[Int2(x, z)];
+				if (column.empty())
+				{
+					column.resize(gridHeight * LightMap::FACES_PER_VOXEL, Double3::Zero);
+				}
+
+				for (int y = 0; y < gridHeight; y++)
+				{
+					const Double3 voxelCenter(
+						static_cast<double>(x) + 0.50,
+						(static_cast<double>(y) + 0.50) * ceilingHeight,
+						static_cast<double>(z) + 0.50);
+
+					for (const VoxelData::Facing facing : facings)
+					{
+						// Sample at the center of the face.
+						const Double3 facePoint = voxelCenter + (VoxelData::getNormal(facing) * 0.50);
+						const double distance = (light.point - facePoint).length();
+						if (distance < light.intensity)
+						{
+							const double lightPercent = 1.0 - (distance / light.intensity);
+							Double3 &faceColor =
+								column[(y * LightMap::FACES_PER_VOXEL) + static_cast<int>(facing)];
+							faceColor = faceColor + (light.color * lightPercent);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+Double3 SoftwareRenderer::LightMap::getAverageFaceColor(const std::vector<Double3> &column,
+	double y) const
+{
+	const int voxelY = std::clamp(static_cast<int>(std::floor(y / this->ceilingHeight)),
+		0, this->gridHeight - 1);
+
+	Double3 faceColorSum = Double3::Zero;
+	for (int i = 0; i < LightMap::FACES_PER_VOXEL; i++)
+	{
+		faceColorSum = faceColorSum + column[(voxelY * LightMap::FACES_PER_VOXEL) + i];
+	}
+
+	return faceColorSum / static_cast<double>(LightMap::FACES_PER_VOXEL);
+}
+
+void SoftwareRenderer::VoxelColumnView::init(int voxelX, int voxelZ, const VoxelGrid &voxelGrid,
+	const LevelData::OpenDoors &openDoors, const ShadingInfo &shadingInfo,
+	const VoxelData **voxelDataBuffer)
+{
+	this->voxelX = voxelX;
+	this->voxelZ = voxelZ;
+	this->voxelData = voxelDataBuffer;
+	this->bakedColumn = shadingInfo.getBakedVoxelColumn(voxelX, voxelZ);
+	this->columnLights = shadingInfo.getVoxelColumnLights(voxelX, voxelZ);
+
+	bool hasDoor = false;
+	this->hasDiagonal = false;
+	this->hasFarFacing = false;
+	this->hasSwingingDoor = false;
+	for (int voxelY = 0; voxelY < voxelGrid.getHeight(); voxelY++)
+	{
+		const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
+		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+		this->voxelData[voxelY] = &voxelData;
+		hasDoor |= (voxelGrid.getVoxelMask(voxelX, voxelY, voxelZ) & VoxelGrid::MASK_DOOR) != 0;
+
+		const VoxelDataType dataType = voxelData.dataType;
+		this->hasDiagonal |= dataType == VoxelDataType::Diagonal;
+		this->hasFarFacing |= (dataType == VoxelDataType::Edge) ||
+			(dataType == VoxelDataType::Chasm);
+		this->hasSwingingDoor |= (dataType == VoxelDataType::Door) &&
+			(voxelData.door.type == VoxelData::DoorData::Type::Swinging);
+	}
+
+	// Only search the open doors if the column has a door in it.
+	this->doorPercentOpen = hasDoor ?
+		SoftwareRenderer::getDoorPercentOpen(voxelX, voxelZ, openDoors) : 0.0;
+
+	// Closed swinging doors are treated like walls.
+	this->hasSwingingDoor &= this->doorPercentOpen != 0.0;
+}
+
+void SoftwareRenderer::VoxelCornerAngles::init(int voxelX, int voxelZ, const Double2 &eye)
+{
+	// Corners in world space.
+	const Double2 bottomLeftCorner(
+		static_cast<double>(voxelX),
+		static_cast<double>(voxelZ));
+	const Double2 topLeftCorner(
+		bottomLeftCorner.x + 1.0,
+		bottomLeftCorner.y);
+	const Double2 bottomRightCorner(
+		bottomLeftCorner.x,
+		bottomLeftCorner.y + 1.0);
+	const Double2 topRightCorner(
+		topLeftCorner.x,
+		bottomRightCorner.y);
+
+	const Double2 upLeftDir = (topLeftCorner - eye).normalized();
+	const Double2 upRightDir = (topRightCorner - eye).normalized();
+	const Double2 downLeftDir = (bottomLeftCorner - eye).normalized();
+	const Double2 downRightDir = (bottomRightCorner - eye).normalized();
+	this->upLeft = MathUtils::fullAtan2(upLeftDir.x, upLeftDir.y);
+	this->upRight = MathUtils::fullAtan2(upRightDir.x, upRightDir.y);
+	this->downLeft = MathUtils::fullAtan2(downLeftDir.x, downLeftDir.y);
+	this->downRight = MathUtils::fullAtan2(downRightDir.x, downRightDir.y);
+}
+
+void SoftwareRenderer::RayDDA::init(const Camera &camera, const Ray &ray,
+	const VoxelGrid &voxelGrid)
+{
+	const double dirXSquared = ray.dirX * ray.dirX;
+	const double dirZSquared = ray.dirZ * ray.dirZ;
+
+	this->deltaDistX = std::sqrt(1.0 + (dirZSquared / dirXSquared));
+	this->deltaDistZ = std::sqrt(1.0 + (dirXSquared / dirZSquared));
+
+	this->nonNegativeDirX = ray.dirX >= 0.0;
+	this->nonNegativeDirZ = ray.dirZ >= 0.0;
+
+	if (this->nonNegativeDirX)
+	{
+		this->stepX = 1;
+		this->sideDistX = (camera.eyeVoxelReal.x + 1.0 - camera.eye.x) * this->deltaDistX;
+	}
+	else
+	{
+		this->stepX = -1;
+		this->sideDistX = (camera.eye.x - camera.eyeVoxelReal.x) * this->deltaDistX;
+	}
+
+	if (this->nonNegativeDirZ)
+	{
+		this->stepZ = 1;
+		this->sideDistZ = (camera.eyeVoxelReal.z + 1.0 - camera.eye.z) * this->deltaDistZ;
+	}
+	else
+	{
+		this->stepZ = -1;
+		this->sideDistZ = (camera.eye.z - camera.eyeVoxelReal.z) * this->deltaDistZ;
+	}
+
+	// Decide how far the first voxel edge is, and which voxel face was hit.
+	if (this->sideDistX < this->sideDistZ)
+	{
+		this->zDistance = this->sideDistX;
+		this->facing = this->nonNegativeDirX ? VoxelData::Facing::NegativeX :
+			VoxelData::Facing::PositiveX;
+	}
+	else
+	{
+		this->zDistance = this->sideDistZ;
+		this->facing = this->nonNegativeDirZ ? VoxelData::Facing::NegativeZ :
+			VoxelData::Facing::PositiveZ;
+	}
+
+	this->cell = camera.eyeVoxel;
+
+	// Verify that the initial voxel coordinate is within the world bounds.
+	this->voxelIsValid =
+		(camera.eyeVoxel.x >= 0) &&
+		(camera.eyeVoxel.y >= 0) &&
+		(camera.eyeVoxel.z >= 0) &&
+		(camera.eyeVoxel.x < voxelGrid.getWidth()) &&
+		(camera.eyeVoxel.y < voxelGrid.getHeight()) &&
+		(camera.eyeVoxel.z < voxelGrid.getDepth());
+}
+
+void SoftwareRenderer::RayDDA::step(const Camera &camera, const Ray &ray,
+	const VoxelGrid &voxelGrid)
+{
+	if (this->sideDistX < this->sideDistZ)
+	{
+		this->sideDistX += this->deltaDistX;
+		this->cell.x += this->stepX;
+		this->facing = this->nonNegativeDirX ? VoxelData::Facing::NegativeX :
+			VoxelData::Facing::PositiveX;
+		this->voxelIsValid &= (this->cell.x >= 0) && (this->cell.x < voxelGrid.getWidth());
+	}
+	else
+	{
+		this->sideDistZ += this->deltaDistZ;
+		this->cell.z += this->stepZ;
+		this->facing = this->nonNegativeDirZ ? VoxelData::Facing::NegativeZ :
+			VoxelData::Facing::PositiveZ;
+		this->voxelIsValid &= (this->cell.z >= 0) && (this->cell.z < voxelGrid.getDepth());
+	}
+
+	const bool onXAxis = (this->facing == VoxelData::Facing::PositiveX) ||
+		(this->facing == VoxelData::Facing::NegativeX);
+
+	// Update the Z distance depending on which axis was stepped with.
+	if (onXAxis)
+	{
+		this->zDistance = (static_cast<double>(this->cell.x) -
+			camera.eye.x + static_cast<double>((1 - this->stepX) / 2)) / ray.dirX;
+	}
+	else
+	{
+		this->zDistance = (static_cast<double>(this->cell.z) -
+			camera.eye.z + static_cast<double>((1 - this->stepZ) / 2)) / ray.dirZ;
+	}
+}
+
+SoftwareRenderer::FrameView::FrameView(uint32_t *colorBuffer, float *depthBuffer,
+	uint16_t *indexBuffer, uint32_t *outputBuffer, ColumnHit *columnHits, int width, int height)
+{
+	this->colorBuffer = colorBuffer;
+	this->depthBuffer = depthBuffer;
+	this->indexBuffer = indexBuffer;
+	this->outputBuffer = outputBuffer;
+	this->columnHits = columnHits;
+	this->width = width;
 	this->height = height;
 	this->widthReal = static_cast<double>(width);
 	this->heightReal = static_cast<double>(height);
@@ -314,6 +1363,75 @@ const SoftwareRenderer::Flat::Frame &SoftwareRenderer::VisibleFlat::getFrame() c
 	return this->frame;
 }
 
+const int SoftwareRenderer::FlatOcclusion::TILE_WIDTH = 8;
+
+SoftwareRenderer::FlatOcclusion::FlatOcclusion()
+{
+	this->startX = 0;
+	this->endX = 0;
+}
+
+void SoftwareRenderer::FlatOcclusion::init(int startX, int endX, const FrameView &frame)
+{
+	this->startX = startX;
+	this->endX = endX;
+
+	const int columnCount = endX - startX;
+	const int tileCount = (columnCount + FlatOcclusion::TILE_WIDTH - 1) /
+		FlatOcclusion::TILE_WIDTH;
+	this->columnDepths.resize(columnCount);
+	this->tileDepths.resize(tileCount);
+	std::fill(this->tileDepths.begin(), this->tileDepths.end(), 0.0f);
+
+	constexpr float infinity = std::numeric_limits<float>::infinity();
+	for (int i = 0; i < columnCount; i++)
+	{
+		// Columns that can see the sky usually see it in their first pixel, so only columns
+		// filled in by walls are read all the way down.
+		const float *columnDepths = frame.depthBuffer + ((startX + i) * frame.height);
+		float columnDepth = 0.0f;
+		for (int y = 0; (y < frame.height) && (columnDepth != infinity); y++)
+		{
+			columnDepth = std::max(columnDepth, columnDepths[y]);
+		}
+
+		this->columnDepths[i] = columnDepth;
+
+		float &tileDepth = this->tileDepths[i / FlatOcclusion::TILE_WIDTH];
+		tileDepth = std::max(tileDepth, columnDepth);
+	}
+}
+
+float SoftwareRenderer::FlatOcclusion::getColumnDepth(int x) const
+{
+	if ((x < this->startX) || (x >= this->endX))
+	{
+		return std::numeric_limits<float>::infinity();
+	}
+
+	return this->columnDepths[x - this->startX];
+}
+
+bool SoftwareRenderer::FlatOcclusion::isRangeOccluded(int startX, int endX, float depth) const
+{
+	if ((startX < this->startX) || (endX > this->endX) || (startX >= endX))
+	{
+		return false;
+	}
+
+	const int startTile = (startX - this->startX) / FlatOcclusion::TILE_WIDTH;
+	const int endTile = ((endX - 1 - this->startX) / FlatOcclusion::TILE_WIDTH) + 1;
+	for (int i = startTile; i < endTile; i++)
+	{
+		if (this->tileDepths[i] >= depth)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 template <typename T>
 SoftwareRenderer::DistantObject<T>::DistantObject(const T &obj, int textureIndex)
 	: obj(obj)
@@ -321,49 +1439,72 @@ SoftwareRenderer::DistantObject<T>::DistantObject(const T &obj, int textureIndex
 	this->textureIndex = textureIndex;
 }
 
+SoftwareRenderer::DistantObjects::StarCell::StarCell()
+{
+	this->sinRadius = 0.0;
+}
+
 const int SoftwareRenderer::DistantObjects::NO_SUN = -1;
+const int SoftwareRenderer::DistantObjects::STAR_CELLS_X = 32;
+const int SoftwareRenderer::DistantObjects::STAR_CELLS_Y = 16;
 
 SoftwareRenderer::DistantObjects::DistantObjects()
 {
+	this->starMaxWidth = 0.0;
 	this->sunTextureIndex = DistantObjects::NO_SUN;
 }
 
 void SoftwareRenderer::DistantObjects::init(const DistantSky &distantSky,
-	std::vector<SkyTexture> &skyTextures)
+	std::vector<SkyTexture> &skyTextures, std::vector<const Surface*> &skyTextureSurfaces,
+	std::unordered_map<const Surface*, SkyTexture> &oldSkyTextures)
 {
 	DebugAssert(skyTextures.size() == 0);
+	DebugAssert(skyTextureSurfaces.size() == 0);
+
+	// Index of the first sky texture made from each surface, for surfaces used more than once.
+	std::unordered_map<const Surface*, int> surfaceTextureIndices;
+
+	// Sky textures to convert from their surface once every object has one, and ones to copy
+	// from another sky texture afterwards (destination index, source index).
+	std::vector<int> convertIndices;
+	std::vector<std::pair<int, int>> copyIndices;
+
+	// Adds a render texture for the given surface to the sky textures list and returns its
+	// index in the sky textures list. A surface that already has a texture (from earlier in
+	// this sky or from the previous one) isn't converted again.
+	auto addSkyTexture = [&skyTextures, &skyTextureSurfaces, &oldSkyTextures,
+		&surfaceTextureIndices, &convertIndices, &copyIndices](const Surface &surface)
+	{
+		const auto indexIter = surfaceTextureIndices.find(&surface);
+		if (indexIter != surfaceTextureIndices.end())
+		{
+			copyIndices.push_back(std::make_pair(static_cast<int>(skyTextures.size()),
+				indexIter->second));
+			skyTextures.push_back(SkyTexture());
+			skyTextureSurfaces.push_back(&surface);
+			return static_cast<int>(skyTextures.size()) - 1;
+		}
 
-	// Creates a render texture from the given surface, adds it to the sky textures list, and
-	// returns its index in the sky textures list.
-	auto addSkyTexture = [&skyTextures](const Surface &surface)
-	{
-		const int width = surface.getWidth();
-		const int height = surface.getHeight();
-		const uint32_t *texels = static_cast<const uint32_t*>(surface.getPixels());
-		const int texelCount = width * height;
+		surfaceTextureIndices.emplace(&surface, static_cast<int>(skyTextures.size()));
+		skyTextureSurfaces.push_back(&surface);
 
-		skyTextures.push_back(SkyTexture());
-		SkyTexture &texture = skyTextures.back();
-		texture.texels = std::vector<SkyTexel>(texelCount);
-		texture.width = width;
-		texture.height = height;
-
-		for (int i = 0; i < texelCount; i++)
+		const auto oldIter = oldSkyTextures.find(&surface);
+		if (oldIter != oldSkyTextures.end())
 		{
-			const Double4 srcTexel = Double4::fromARGB(texels[i]);
-			SkyTexel &dstTexel = texture.texels[i];
-			dstTexel.r = srcTexel.x;
-			dstTexel.g = srcTexel.y;
-			dstTexel.b = srcTexel.z;
-			dstTexel.transparent = srcTexel.w == 0.0;
+			skyTextures.push_back(std::move(oldIter->second));
+			oldSkyTextures.erase(oldIter);
+			return static_cast<int>(skyTextures.size()) - 1;
 		}
 
+		convertIndices.push_back(static_cast<int>(skyTextures.size()));
+		skyTextures.push_back(SkyTexture());
 		return static_cast<int>(skyTextures.size()) - 1;
 	};
 
 	// Creates a render texture with a single texel for small stars.
-	auto addSmallStarTexture = [&skyTextures](uint32_t color)
+	auto addSmallStarTexture = [&skyTextures, &skyTextureSurfaces](uint32_t color)
 	{
+		skyTextureSurfaces.push_back(nullptr);
 		skyTextures.push_back(SkyTexture());
 		SkyTexture &texture = skyTextures.back();
 		texture.texels = std::vector<SkyTexel>(1);
@@ -377,6 +1518,8 @@ void SoftwareRenderer::DistantObjects::init(const DistantSky &distantSky,
 		dstTexel.b = srcColor.z;
 		dstTexel.transparent = false;
 
+		texture.initColumnOpaqueRanges();
+
 		return static_cast<int>(skyTextures.size()) - 1;
 	};
 
@@ -448,6 +1591,141 @@ void SoftwareRenderer::DistantObjects::init(const DistantSky &distantSky,
 			starObject, textureIndex));
 	}
 
+	// Convert the new surfaces on the job system since big skies (i.e., animated land) take a
+	// while on one thread. Each job only writes its own texture.
+	auto convertSkyTexture = [&skyTextures, &skyTextureSurfaces](int index)
+	{
+		const Surface &surface = *skyTextureSurfaces[index];
+		const int width = surface.getWidth();
+		const int height = surface.getHeight();
+		const uint32_t *texels = static_cast<const uint32_t*>(surface.getPixels());
+		const int texelCount = width * height;
+
+		SkyTexture &texture = skyTextures[index];
+		texture.texels = std::vector<SkyTexel>(texelCount);
+		texture.width = width;
+		texture.height = height;
+
+		for (int i = 0; i < texelCount; i++)
+		{
+			const Double4 srcTexel = Double4::fromARGB(texels[i]);
+			SkyTexel &dstTexel = texture.texels[i];
+			dstTexel.r = srcTexel.x;
+			dstTexel.g = srcTexel.y;
+			dstTexel.b = srcTexel.z;
+			dstTexel.transparent = srcTexel.w == 0.0;
+		}
+
+		texture.initColumnOpaqueRanges();
+	};
+
+	std::vector<std::future<void>> conversions;
+	for (size_t i = 1; i < convertIndices.size(); i++)
+	{
+		const int index = convertIndices[i];
+		conversions.push_back(JobSystem::submit(JobSystem::Priority::Streaming,
+			[&convertSkyTexture, index]() { convertSkyTexture(index); }));
+	}
+
+	if (convertIndices.size() > 0)
+	{
+		convertSkyTexture(convertIndices.front());
+	}
+
+	for (std::future<void> &conversion : conversions)
+	{
+		conversion.get();
+	}
+
+	for (const std::pair<int, int> &pair : copyIndices)
+	{
+		skyTextures[pair.first] = skyTextures[pair.second];
+	}
+
+	// Pre-calculate each star's unrotated direction and bucket the stars by azimuth and
+	// elevation. The last bucket is for directions that can't be placed in the grid.
+	const int starGridCellCount = DistantObjects::STAR_CELLS_X * DistantObjects::STAR_CELLS_Y;
+	std::vector<std::vector<int>> cellStarIndices(starGridCellCount + 1);
+
+	for (int i = 0; i < static_cast<int>(this->stars.size()); i++)
+	{
+		const auto &star = this->stars[i];
+		const Double3 &direction = star.obj.getDirection();
+		const double xAngleRadians = MathUtils::fullAtan2(direction.x, direction.z);
+		const double yAngleRadians = direction.getYAngleRadians();
+		const Double3 starDirection = SoftwareRenderer::getSpaceObjectDirection(
+			xAngleRadians, yAngleRadians);
+		this->starDirections.push_back(starDirection);
+
+		const SkyTexture &texture = skyTextures.at(star.textureIndex);
+		this->starMaxWidth = std::max(this->starMaxWidth,
+			static_cast<double>(texture.width) / DistantSky::IDENTITY_DIM);
+
+		const bool isFinite = std::isfinite(starDirection.x) && std::isfinite(starDirection.y) &&
+			std::isfinite(starDirection.z);
+
+		const int cellIndex = [&starDirection, starGridCellCount, isFinite]()
+		{
+			if (!isFinite)
+			{
+				return starGridCellCount;
+			}
+
+			const double xPercent = MathUtils::fullAtan2(starDirection.x, starDirection.z) /
+				Constants::TwoPi;
+			const double yPercent = (std::asin(std::clamp(starDirection.y, -1.0, 1.0)) +
+				Constants::HalfPi) / Constants::Pi;
+			const int cellX = std::clamp(static_cast<int>(xPercent * DistantObjects::STAR_CELLS_X),
+				0, DistantObjects::STAR_CELLS_X - 1);
+			const int cellY = std::clamp(static_cast<int>(yPercent * DistantObjects::STAR_CELLS_Y),
+				0, DistantObjects::STAR_CELLS_Y - 1);
+			return cellX + (cellY * DistantObjects::STAR_CELLS_X);
+		}();
+
+		cellStarIndices[cellIndex].push_back(i);
+	}
+
+	for (int i = 0; i < static_cast<int>(cellStarIndices.size()); i++)
+	{
+		std::vector<int> &starIndices = cellStarIndices[i];
+		if (starIndices.size() == 0)
+		{
+			continue;
+		}
+
+		StarCell cell;
+		if (i == starGridCellCount)
+		{
+			// Always tested.
+			cell.direction = Double3::Zero;
+			cell.sinRadius = 1.0;
+		}
+		else
+		{
+			Double3 directionSum = Double3::Zero;
+			for (const int starIndex : starIndices)
+			{
+				directionSum = directionSum + this->starDirections[starIndex];
+			}
+
+			cell.direction = directionSum.normalized();
+
+			double maxAngleRadians = 0.0;
+			for (const int starIndex : starIndices)
+			{
+				const double cosAngle = std::clamp(
+					cell.direction.dot(this->starDirections[starIndex]), -1.0, 1.0);
+				maxAngleRadians = std::max(maxAngleRadians, std::acos(cosAngle));
+			}
+
+			cell.sinRadius = (maxAngleRadians < Constants::HalfPi) ?
+				std::sin(maxAngleRadians) : 1.0;
+		}
+
+		cell.starIndices = std::move(starIndices);
+		this->starCells.push_back(std::move(cell));
+	}
+
 	if (distantSky.hasSun())
 	{
 		// Add the sun to the sky textures and assign its texture index.
@@ -462,6 +1740,9 @@ void SoftwareRenderer::DistantObjects::clear()
 	this->airs.clear();
 	this->moons.clear();
 	this->stars.clear();
+	this->starDirections.clear();
+	this->starCells.clear();
+	this->starMaxWidth = 0.0;
 	this->sunTextureIndex = DistantObjects::NO_SUN;
 }
 
@@ -533,14 +1814,145 @@ void SoftwareRenderer::VisDistantObjects::clear()
 	this->starEnd = 0;
 }
 
+const double SoftwareRenderer::VoxelHistory::MAX_TURN_RADIANS = 3.0 * Constants::DegToRad;
+const double SoftwareRenderer::VoxelHistory::MAX_MOVE_DISTANCE = 0.01;
+
+SoftwareRenderer::VoxelHistory::VoxelHistory()
+{
+	this->zoom = 0.0;
+	this->aspect = 0.0;
+	this->yShear = 0.0;
+	this->bufferIndex = 0;
+	this->columnParity = -1;
+	this->isValid = false;
+}
+
+void SoftwareRenderer::VoxelHistory::init(int width, int height)
+{
+	const int pixelCount = width * height;
+	for (int i = 0; i < static_cast<int>(this->colorBuffers.size()); i++)
+	{
+		// Assigned in place so a reserved buffer is reused.
+		this->colorBuffers[i].assign(pixelCount, 0);
+		this->depthBuffers[i].assign(pixelCount, std::numeric_limits<float>::infinity());
+	}
+
+	this->bufferIndex = 0;
+	this->columnParity = -1;
+	this->isValid = false;
+}
+
+// One game minute, and about the smallest change in ambient light that shows in a texel.
+const double SoftwareRenderer::FrameInputs::DAYTIME_STEP = 1.0 / 1440.0;
+const double SoftwareRenderer::FrameInputs::AMBIENT_STEP = 1.0 / 256.0;
+
+SoftwareRenderer::FrameInputs::FrameInputs()
+{
+	this->fovY = 0.0;
+	this->ambientStep = 0.0;
+	this->daytimeStep = 0.0;
+	this->latitude = 0.0;
+	this->ceilingHeight = 0.0;
+	this->voxelGrid = nullptr;
+	this->voxelGridRevision = 0;
+	this->parallaxSky = false;
+	this->isComplete = false;
+	this->isValid = false;
+}
+
+void SoftwareRenderer::FrameInputs::init(const Double3 &eye, const Double3 &direction,
+	double fovY, double ambient, double daytimePercent, double latitude, bool parallaxSky,
+	double ceilingHeight, const LevelData::OpenDoors &openDoors,
+	const VoxelGrid &voxelGrid, const DistantObjects &distantObjects)
+{
+	this->eye = eye;
+	this->direction = direction;
+	this->fovY = fovY;
+	this->ambientStep = std::floor(ambient / FrameInputs::AMBIENT_STEP);
+	this->daytimeStep = std::floor(daytimePercent / FrameInputs::DAYTIME_STEP);
+	this->latitude = latitude;
+	this->ceilingHeight = ceilingHeight;
+
+	this->doors.clear();
+	for (const LevelData::DoorState &door : openDoors.getDoors())
+	{
+		this->doors.push_back(std::make_pair(door.getVoxel(), door.getPercentOpen()));
+	}
+
+	this->animLandIndices.clear();
+	for (const auto &animLand : distantObjects.animLands)
+	{
+		this->animLandIndices.push_back(animLand.obj.getIndex());
+	}
+
+	this->voxelGrid = &voxelGrid;
+	this->voxelGridRevision = voxelGrid.getRevision();
+	this->parallaxSky = parallaxSky;
+	this->isValid = true;
+}
+
+bool SoftwareRenderer::FrameInputs::matches(const Double3 &eye, const Double3 &direction,
+	double fovY, double ambient, double daytimePercent, double latitude, bool parallaxSky,
+	double ceilingHeight, const LevelData::OpenDoors &openDoors,
+	const VoxelGrid &voxelGrid, const DistantObjects &distantObjects) const
+{
+	const bool sameView = (eye == this->eye) && (direction == this->direction) &&
+		(fovY == this->fovY) && (latitude == this->latitude) &&
+		(ceilingHeight == this->ceilingHeight) && (parallaxSky == this->parallaxSky);
+	const bool sameLight =
+		(std::floor(ambient / FrameInputs::AMBIENT_STEP) == this->ambientStep) &&
+		(std::floor(daytimePercent / FrameInputs::DAYTIME_STEP) == this->daytimeStep);
+	const bool sameVoxels = (&voxelGrid == this->voxelGrid) &&
+		(voxelGrid.getRevision() == this->voxelGridRevision);
+
+	if (!sameView || !sameLight || !sameVoxels)
+	{
+		return false;
+	}
+
+	const std::vector<LevelData::DoorState> &doors = openDoors.getDoors();
+	if (doors.size() != this->doors.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < doors.size(); i++)
+	{
+		const LevelData::DoorState &door = doors[i];
+		const std::pair<Int2, double> &lastDoor = this->doors[i];
+		if ((door.getVoxel() != lastDoor.first) || (door.getPercentOpen() != lastDoor.second))
+		{
+			return false;
+		}
+	}
+
+	if (distantObjects.animLands.size() != this->animLandIndices.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < distantObjects.animLands.size(); i++)
+	{
+		if (distantObjects.animLands[i].obj.getIndex() != this->animLandIndices[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void SoftwareRenderer::RenderThreadData::SkyGradient::init(double projectedYTop,
-	double projectedYBottom, std::vector<Double3> &rowCache)
+	double projectedYBottom, std::vector<Double3> &rowCache,
+	std::vector<uint32_t> &rowColorCache, bool rowCacheIsValid)
 {
 	this->threadsDone = 0;
 	this->rowCache = &rowCache;
+	this->rowColorCache = &rowColorCache;
 	this->projectedYTop = projectedYTop;
 	this->projectedYBottom = projectedYBottom;
 	this->shouldDrawStars = false;
+	this->rowCacheIsValid = rowCacheIsValid;
 }
 
 void SoftwareRenderer::RenderThreadData::DistantSky::init(bool parallaxSky,
@@ -554,57 +1966,265 @@ void SoftwareRenderer::RenderThreadData::DistantSky::init(bool parallaxSky,
 	this->doneVisTesting = false;
 }
 
+const int SoftwareRenderer::RenderThreadData::Voxels::COLUMN_BATCH_WIDTH = 16;
+
+SoftwareRenderer::RenderThreadData::Voxels::Voxels()
+{
+	this->threadsDone = 0;
+	this->threadsDoneHistory = 0;
+	this->openDoors = nullptr;
+	this->voxelGrid = nullptr;
+	this->voxelTextures = nullptr;
+	this->occlusion = nullptr;
+	this->history = nullptr;
+	this->ceilingHeight = 0.0;
+	this->frameWidth = 0;
+	this->rangeCount = 0;
+	this->columnParity = -1;
+	this->reprojectHistory = false;
+}
+
 void SoftwareRenderer::RenderThreadData::Voxels::init(double ceilingHeight,
-	const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid,
-	const std::vector<VoxelTexture> &voxelTextures, std::vector<OcclusionData> &occlusion)
+	double detailDistance, const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+	const std::vector<VoxelTexture> &voxelTextures, std::vector<OcclusionData> &occlusion,
+	int totalThreads, int frameWidth, VoxelHistory *history, int columnParity,
+	bool reprojectHistory)
 {
 	this->threadsDone = 0;
+	this->threadsDoneHistory = 0;
 	this->ceilingHeight = ceilingHeight;
+	this->detailDistance = detailDistance;
 	this->openDoors = &openDoors;
 	this->voxelGrid = &voxelGrid;
 	this->voxelTextures = &voxelTextures;
 	this->occlusion = &occlusion;
+	this->history = history;
+	this->frameWidth = frameWidth;
+	this->columnParity = columnParity;
+	this->reprojectHistory = reprojectHistory;
+
+	if (this->rangeCount != totalThreads)
+	{
+		this->batchRanges = std::make_unique<ColumnBatchRange[]>(totalThreads);
+		this->rangeCount = totalThreads;
+	}
+
+	// Give each thread an equal contiguous share of the column batches. Adjacent columns
+	// are more cache-friendly than interleaved ones, and stealing handles the imbalance.
+	const int batchCount = (frameWidth + Voxels::COLUMN_BATCH_WIDTH - 1) /
+		Voxels::COLUMN_BATCH_WIDTH;
+
+	for (int i = 0; i < totalThreads; i++)
+	{
+		const uint64_t begin = static_cast<uint64_t>((batchCount * i) / totalThreads);
+		const uint64_t end = static_cast<uint64_t>((batchCount * (i + 1)) / totalThreads);
+		this->batchRanges[i].range = (end << 32) | begin;
+	}
+}
+
+bool SoftwareRenderer::RenderThreadData::Voxels::getNextColumnBatch(int threadIndex,
+	int *startX, int *endX)
+{
+	// Try the thread's own range first, then the other threads' ranges in order.
+	for (int i = 0; i < this->rangeCount; i++)
+	{
+		const int rangeIndex = (threadIndex + i) % this->rangeCount;
+		const bool isOwnRange = i == 0;
+		std::atomic<uint64_t> &range = this->batchRanges[rangeIndex].range;
+		uint64_t oldRange = range.load();
+
+		while (true)
+		{
+			const uint64_t begin = oldRange & 0xFFFFFFFF;
+			const uint64_t end = oldRange >> 32;
+			if (begin >= end)
+			{
+				// This range is empty. Batches are only ever removed within a frame, so it
+				// can't refill.
+				break;
+			}
+
+			// The owner takes from the front, thieves take from the back.
+			const uint64_t batch = isOwnRange ? begin : (end - 1);
+			const uint64_t newRange = isOwnRange ? ((end << 32) | (begin + 1)) :
+				(((end - 1) << 32) | begin);
+
+			if (range.compare_exchange_weak(oldRange, newRange))
+			{
+				*startX = static_cast<int>(batch) * Voxels::COLUMN_BATCH_WIDTH;
+				*endX = std::min(*startX + Voxels::COLUMN_BATCH_WIDTH, this->frameWidth);
+				return true;
+			}
+		}
+	}
+
+	return false;
 }
 
 void SoftwareRenderer::RenderThreadData::Flats::init(const Double3 &flatNormal,
-	const std::vector<VisibleFlat> &visibleFlats, const std::vector<FlatTexture> &flatTextures)
+	const std::vector<VisibleFlat> &visibleFlats,
+	const std::vector<std::vector<int>> &visibleFlatBins,
+	std::vector<FlatOcclusion> &occlusions, const std::vector<FlatTexture> &flatTextures,
+	const ShadeTable &shadeTable)
 {
 	this->threadsDone = 0;
 	this->flatNormal = &flatNormal;
 	this->visibleFlats = &visibleFlats;
+	this->visibleFlatBins = &visibleFlatBins;
+	this->occlusions = &occlusions;
 	this->flatTextures = &flatTextures;
+	this->shadeTable = &shadeTable;
 	this->doneSorting = false;
 }
 
+SoftwareRenderer::RenderThreadData::Job::Job()
+{
+	this->batchFunction = nullptr;
+	this->batchCount = 0;
+	this->nextBatch = 0;
+	this->threadsDone = 0;
+	this->threadsReleased = 0;
+}
+
+void SoftwareRenderer::RenderThreadData::Job::init(const std::function<void(int)> &batchFunction,
+	int batchCount)
+{
+	this->batchFunction = &batchFunction;
+	this->batchCount = batchCount;
+	this->nextBatch = 0;
+	this->threadsDone = 0;
+	this->threadsReleased = 0;
+}
+
+void SoftwareRenderer::RenderThreadData::Job::runBatches()
+{
+	int batchIndex = this->nextBatch.fetch_add(1);
+	while (batchIndex < this->batchCount)
+	{
+		(*this->batchFunction)(batchIndex);
+		batchIndex = this->nextBatch.fetch_add(1);
+	}
+}
+
+const int SoftwareRenderer::RenderThreadData::SPIN_COUNT = 2048;
+
 SoftwareRenderer::RenderThreadData::RenderThreadData()
 {
 	// Make sure 'go' is initialized to false.
+	this->parkedThreads = 0;
 	this->totalThreads = 0;
 	this->go = false;
 	this->isDestructing = false;
 	this->camera = nullptr;
 	this->shadingInfo = nullptr;
 	this->frame = nullptr;
+	this->timings = nullptr;
 }
 
 void SoftwareRenderer::RenderThreadData::init(int totalThreads, const Camera &camera,
-	const ShadingInfo &shadingInfo, const FrameView &frame)
+	const ShadingInfo &shadingInfo, const FrameView &frame, RenderTimings &timings)
 {
 	this->totalThreads = totalThreads;
 	this->camera = &camera;
 	this->shadingInfo = &shadingInfo;
 	this->frame = &frame;
+	this->timings = &timings;
 	this->go = false;
 	this->isDestructing = false;
+
+	// Block width and height are the approximate number of columns and rows per thread,
+	// respectively. Rounding is involved so the start and end coordinates are correct for
+	// all resolutions.
+	this->ranges.resize(totalThreads);
+	const double blockWidth = frame.widthReal / static_cast<double>(totalThreads);
+	const double blockHeight = frame.heightReal / static_cast<double>(totalThreads);
+	for (int i = 0; i < totalThreads; i++)
+	{
+		ThreadRange &range = this->ranges[i];
+		range.startX = static_cast<int>(std::round(static_cast<double>(i) * blockWidth));
+		range.endX = static_cast<int>(std::round(static_cast<double>(i + 1) * blockWidth));
+		range.startY = static_cast<int>(std::round(static_cast<double>(i) * blockHeight));
+		range.endY = static_cast<int>(std::round(static_cast<double>(i + 1) * blockHeight));
+
+		// Make sure the rounding is correct.
+		DebugAssert(range.startX >= 0);
+		DebugAssert(range.endX <= frame.width);
+		DebugAssert(range.startY >= 0);
+		DebugAssert(range.endY <= frame.height);
+	}
+}
+
+template <typename T>
+void SoftwareRenderer::RenderThreadData::waitUntil(T &&predicate)
+{
+	// Try spinning first since the condition usually becomes true soon.
+	for (int i = 0; i < RenderThreadData::SPIN_COUNT; i++)
+	{
+		if (predicate())
+		{
+			return;
+		}
+
+		std::this_thread::yield();
+	}
+
+	// Park on the condition variable. The parked count is incremented before re-checking the
+	// predicate so notifyAll() cannot miss this thread.
+	std::unique_lock<std::mutex> lk(this->mutex);
+	this->parkedThreads++;
+	this->condVar.wait(lk, predicate);
+	this->parkedThreads--;
+}
+
+void SoftwareRenderer::RenderThreadData::notifyAll()
+{
+	// Only touch the mutex if someone might be sleeping. Locking it before notifying makes
+	// sure a thread between its predicate check and wait() doesn't lose the wake-up.
+	if (this->parkedThreads > 0)
+	{
+		std::unique_lock<std::mutex> lk(this->mutex);
+		lk.unlock();
+		this->condVar.notify_all();
+	}
+}
+
+void SoftwareRenderer::RenderThreadData::arrive(std::atomic<int> &threadsDone)
+{
+	const int prevThreadsDone = threadsDone.fetch_add(1);
+
+	// If this was the last thread, wake up anyone waiting on the phase.
+	if ((prevThreadsDone + 1) == this->totalThreads)
+	{
+		this->notifyAll();
+	}
 }
 
 const double SoftwareRenderer::NEAR_PLANE = 0.0001;
 const double SoftwareRenderer::FAR_PLANE = 1000.0;
+const SoftwareRenderer::PixelReal SoftwareRenderer::PIXEL_CENTER =
+	static_cast<SoftwareRenderer::PixelReal>(0.50);
+const SoftwareRenderer::PixelReal SoftwareRenderer::PIXEL_JUST_BELOW_ONE = std::nextafter(
+	static_cast<SoftwareRenderer::PixelReal>(1.0), static_cast<SoftwareRenderer::PixelReal>(0.0));
+const int SoftwareRenderer::RAY_PACKET_SIZE = 8;
 const int SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT = 64;
 const int SoftwareRenderer::DEFAULT_FLAT_TEXTURE_COUNT = 256;
 const double SoftwareRenderer::DOOR_MIN_VISIBLE = 0.10;
 const double SoftwareRenderer::SKY_GRADIENT_ANGLE = 30.0;
 const double SoftwareRenderer::DISTANT_CLOUDS_MAX_ANGLE = 25.0;
+const double SoftwareRenderer::FLAT_GRID_CELL_SIZE = 8.0;
+const int SoftwareRenderer::SCANLINE_FLOOR_Y = 0;
+const int SoftwareRenderer::SCANLINE_CEILING_Y = 2;
+const std::array<double, 256> SoftwareRenderer::TEXEL_CHANNEL_TO_DOUBLE = []()
+{
+	// Same conversion as Double4::fromARGB() so texel intensities are unchanged.
+	std::array<double, 256> table;
+	for (size_t i = 0; i < table.size(); i++)
+	{
+		table[i] = static_cast<double>(static_cast<uint8_t>(i)) / 255.0;
+	}
+
+	return table;
+}();
 const double SoftwareRenderer::TALL_PIXEL_RATIO = 1.20;
 
 SoftwareRenderer::SoftwareRenderer()
@@ -613,12 +2233,25 @@ SoftwareRenderer::SoftwareRenderer()
 	this->width = 0;
 	this->height = 0;
 	this->renderThreadsMode = 0;
+	this->autoRenderThreadCount = 0;
+	this->renderThreadsAffinity = 0;
+	this->renderThreadsHighPriority = false;
 	this->fogDistance = 0.0;
+	this->shadingInfo = std::make_unique<ShadingInfo>(this->lightGrid, this->lightMap);
+	this->interlacedVoxels = false;
+	this->nightLightsActive = false;
+	this->voxelDetailDistance = 0.0;
+	this->paletteRendering = false;
+	this->scanlinePlanes = false;
+	this->lightBakeDone = false;
+	this->lightBakeStale = false;
 }
 
 SoftwareRenderer::~SoftwareRenderer()
 {
 	this->resetRenderThreads();
+	JobSystem::setReservedThreadCount(0);
+	this->waitForLightBake();
 }
 
 bool SoftwareRenderer::isInited() const
@@ -631,29 +2264,107 @@ void SoftwareRenderer::init(int width, int height, int renderThreadsMode)
 {
 	// Initialize 2D frame buffer.
 	const int pixelCount = width * height;
-	this->depthBuffer = std::vector<double>(pixelCount,
-		std::numeric_limits<double>::infinity());
+	this->colorBuffer = std::vector<uint32_t>(pixelCount, 0);
+	this->depthBuffer = std::vector<float>(pixelCount,
+		std::numeric_limits<float>::infinity());
 
 	// Initialize occlusion columns.
 	this->occlusion = std::vector<OcclusionData>(width, OcclusionData(0, height));
 
 	// Initialize sky gradient cache.
 	this->skyGradientRowCache = std::vector<Double3>(height, Double3::Zero);
+	this->skyGradientRowColorCache = std::vector<uint32_t>(height, 0);
+	this->skyGradientCacheProjYTop = 0.0;
+	this->skyGradientCacheProjYBottom = 0.0;
+	this->skyGradientCacheIsValid = false;
+
+	// The voxel history is allocated when interlaced rendering is first used.
+	this->voxelHistory.isValid = false;
+
+	// No frame has been rendered yet.
+	this->lastFrameInputs.isValid = false;
 
 	// Initialize texture vectors to default sizes.
 	this->voxelTextures = std::vector<VoxelTexture>(SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
 	this->flatTextures = std::vector<FlatTexture>(SoftwareRenderer::DEFAULT_FLAT_TEXTURE_COUNT);
 
-	this->width = width;
-	this->height = height;
-	this->renderThreadsMode = renderThreadsMode;
+	// No voxel textures are animated yet, so each ID uses its own slot.
+	std::vector<int> &voxelTextureIndices = this->shadingInfo->voxelTextureIndices;
+	voxelTextureIndices.resize(SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
+	std::iota(voxelTextureIndices.begin(), voxelTextureIndices.end(), 0);
+
+	this->width = width;
+	this->height = height;
+	this->renderThreadsMode = renderThreadsMode;
+
+	// Fog distance is zero by default.
+	this->fogDistance = 0.0;
+
+	// Initialize render threads.
+	const int threadCount = this->getRenderThreadCount();
+	this->initRenderThreads(threadCount);
+}
+
+std::vector<int> SoftwareRenderer::getRenderThreadCores(int threadCount, int affinityMode,
+	const std::vector<int> &coreList)
+{
+	const std::vector<int> cores = [affinityMode, &coreList]()
+	{
+		if (affinityMode == 0)
+		{
+			return std::vector<int>();
+		}
+		else if (affinityMode == 1)
+		{
+			return Platform::getCoresByPerformance();
+		}
+		else if (affinityMode == 2)
+		{
+			return coreList;
+		}
+		else
+		{
+			DebugUnhandledReturnMsg(std::vector<int>, std::to_string(affinityMode));
+		}
+	}();
+
+	if (cores.empty())
+	{
+		return cores;
+	}
 
-	// Fog distance is zero by default.
-	this->fogDistance = 0.0;
+	// Wrap around if there are more threads than cores to pin to.
+	std::vector<int> threadCores(threadCount);
+	for (int i = 0; i < threadCount; i++)
+	{
+		threadCores[i] = cores[i % cores.size()];
+	}
 
-	// Initialize render threads.
+	return threadCores;
+}
+
+void SoftwareRenderer::avoidRenderThreadCores(int renderThreadsMode, int affinityMode,
+	const std::vector<int> &coreList)
+{
 	const int threadCount = SoftwareRenderer::getRenderThreadsFromMode(renderThreadsMode);
-	this->initRenderThreads(width, height, threadCount);
+	const std::vector<int> threadCores =
+		SoftwareRenderer::getRenderThreadCores(threadCount, affinityMode, coreList);
+	if (threadCores.empty())
+	{
+		return;
+	}
+
+	std::vector<int> otherCores = Platform::getCoresByPerformance();
+	otherCores.erase(std::remove_if(otherCores.begin(), otherCores.end(),
+		[&threadCores](int core)
+	{
+		return std::find(threadCores.begin(), threadCores.end(), core) != threadCores.end();
+	}), otherCores.end());
+
+	if (!otherCores.empty() && !Platform::setCurrentThreadAffinity(otherCores))
+	{
+		DebugLogWarning("Couldn't move thread off the render thread cores.");
+	}
 }
 
 void SoftwareRenderer::setRenderThreadsMode(int mode)
@@ -661,8 +2372,33 @@ void SoftwareRenderer::setRenderThreadsMode(int mode)
 	this->renderThreadsMode = mode;
 
 	// Re-initialize render threads.
-	const int threadCount = SoftwareRenderer::getRenderThreadsFromMode(renderThreadsMode);
-	this->initRenderThreads(this->width, this->height, threadCount);
+	const int threadCount = this->getRenderThreadCount();
+	this->initRenderThreads(threadCount);
+}
+
+void SoftwareRenderer::setAutoRenderThreadCount(int threadCount)
+{
+	const int prevThreadCount = this->getRenderThreadCount();
+	this->autoRenderThreadCount = threadCount;
+
+	if (this->isInited() && (this->getRenderThreadCount() != prevThreadCount))
+	{
+		this->initRenderThreads(this->getRenderThreadCount());
+	}
+}
+
+void SoftwareRenderer::setRenderThreadsAffinity(int affinityMode,
+	const std::vector<int> &coreList, bool highPriority)
+{
+	this->renderThreadsAffinity = affinityMode;
+	this->renderThreadsCoreList = coreList;
+	this->renderThreadsHighPriority = highPriority;
+
+	if (this->isInited())
+	{
+		const int threadCount = this->getRenderThreadCount();
+		this->initRenderThreads(threadCount);
+	}
 }
 
 void SoftwareRenderer::addFlat(int id, const Double3 &position, double width, 
@@ -677,22 +2413,40 @@ void SoftwareRenderer::addFlat(int id, const Double3 &position, double width,
 	flat.width = width;
 	flat.height = height;
 	flat.textureID = textureID;
+	flat.frameIndex = 0;
 	flat.flipped = false; // The initial value doesn't matter; it's updated frequently.
 
-	// Add the flat (sprite, door, store sign, etc.).
-	this->flats.insert(std::make_pair(id, flat));
+	// Add the flat (sprite, door, store sign, etc.). References to unordered_map elements
+	// stay valid until they're erased, so the flat grid can point to it.
+	const auto flatIter = this->flats.insert(std::make_pair(id, flat)).first;
+	this->addFlatToGrid(flatIter->second);
+	this->lastFrameInputs.isValid = false;
 }
 
 void SoftwareRenderer::addLight(int id, const Double3 &point, const Double3 &color, 
 	double intensity)
 {
-	DebugNotImplemented();
+	// Verify that the ID is not already in use.
+	DebugAssertMsg(this->lights.find(id) == this->lights.end(),
+		"Light ID \"" + std::to_string(id) + "\" already taken.");
+
+	SoftwareRenderer::Light light;
+	light.point = point;
+	light.color = color;
+	light.intensity = intensity;
+	light.isBaked = false;
+
+	// References to unordered_map elements stay valid until they're erased, so the light
+	// grid can point to it.
+	const auto lightIter = this->lights.insert(std::make_pair(id, light)).first;
+	this->addLightToGrid(lightIter->second);
+	this->lastFrameInputs.isValid = false;
 }
 
-void SoftwareRenderer::setVoxelTexture(int id, const uint32_t *srcTexels)
+void SoftwareRenderer::initVoxelTexture(VoxelTexture &texture, const uint32_t *srcTexels,
+	const ShadeTable &shadeTable)
 {
-	// Clear the selected texture.
-	VoxelTexture &texture = this->voxelTextures.at(id);
+	// Clear the texture.
 	std::fill(texture.texels.begin(), texture.texels.end(), VoxelTexel());
 	texture.lightTexels.clear();
 
@@ -700,23 +2454,22 @@ void SoftwareRenderer::setVoxelTexture(int id, const uint32_t *srcTexels)
 	{
 		for (int x = 0; x < VoxelTexture::WIDTH; x++)
 		{
-			// @todo: change this calculation for rotated textures. Make sure to have a 
-			// source index and destination index.
-			// - "dstX" and "dstY" should be calculated, and also used with lightTexels.
-			const int index = x + (y * VoxelTexture::WIDTH);
+			// @todo: change this calculation for rotated textures.
+			const int srcIndex = x + (y * VoxelTexture::WIDTH);
+			const int dstIndex = VoxelTexture::getTexelIndex(x, y, VoxelTexture::HEIGHT);
 
-			// Convert ARGB color from integer to double-precision format. This does waste
-			// an extreme amount of memory (32 bytes per pixel!), but it's not a big deal
-			// for Arena's textures (eight textures is a megabyte).
-			const Double4 srcTexel = Double4::fromARGB(srcTexels[index]);
-			VoxelTexel &dstTexel = texture.texels[index];
-			dstTexel.r = srcTexel.x;
-			dstTexel.g = srcTexel.y;
-			dstTexel.b = srcTexel.z;
-			dstTexel.transparent = srcTexel.w == 0.0;
+			// Keep the ARGB channels as 8-bit integers (four bytes per texel) so a whole
+			// voxel texture is only 16KB. They are expanded to floating point when drawn.
+			const uint32_t srcTexel = srcTexels[srcIndex];
+			VoxelTexel &dstTexel = texture.texels[dstIndex];
+			dstTexel.r = static_cast<uint8_t>(srcTexel >> 16);
+			dstTexel.g = static_cast<uint8_t>(srcTexel >> 8);
+			dstTexel.b = static_cast<uint8_t>(srcTexel);
+			dstTexel.flags = (static_cast<uint8_t>(srcTexel >> 24) == 0) ?
+				VoxelTexel::FLAG_TRANSPARENT : 0;
 
 			// If it's a white texel, it's used with night lights (i.e., yellow at night).
-			const bool isWhite = (srcTexel.x == 1.0) && (srcTexel.y == 1.0) && (srcTexel.z == 1.0);
+			const bool isWhite = (dstTexel.r == 255) && (dstTexel.g == 255) && (dstTexel.b == 255);
 
 			if (isWhite)
 			{
@@ -724,31 +2477,211 @@ void SoftwareRenderer::setVoxelTexture(int id, const uint32_t *srcTexels)
 			}
 		}
 	}
+
+	texture.initNightTexels();
+	texture.updateMipLevels();
+	texture.updatePaletteIndices(shadeTable, 0);
+}
+
+void SoftwareRenderer::stopVoxelTextureAnimation(int id)
+{
+	const auto iter = std::find_if(this->voxelTextureAnimations.begin(),
+		this->voxelTextureAnimations.end(), [id](const VoxelTextureAnimation &animation)
+	{
+		return animation.id == id;
+	});
+
+	if (iter != this->voxelTextureAnimations.end())
+	{
+		this->voxelTextureAnimations.erase(iter);
+		this->shadingInfo->voxelTextureIndices[id] = id;
+	}
+}
+
+void SoftwareRenderer::setVoxelTexture(int id, const uint32_t *srcTexels)
+{
+	DebugAssert(id < SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
+	this->stopVoxelTextureAnimation(id);
+
+	VoxelTexture &texture = this->voxelTextures.at(id);
+	SoftwareRenderer::initVoxelTexture(texture, srcTexels, this->shadeTable);
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::setVoxelTextures(const std::vector<const uint32_t*> &srcTexels)
+{
+	DebugAssert(srcTexels.size() <= SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
+
+	const int count = static_cast<int>(srcTexels.size());
+	for (int id = 0; id < count; id++)
+	{
+		if (srcTexels[id] != nullptr)
+		{
+			this->stopVoxelTextureAnimation(id);
+		}
+	}
+
+	// Each texture is only written by its own batch.
+	const std::function<void(int)> batchFunction = [this, &srcTexels](int id)
+	{
+		if (srcTexels[id] != nullptr)
+		{
+			SoftwareRenderer::initVoxelTexture(this->voxelTextures[id], srcTexels[id],
+				this->shadeTable);
+		}
+	};
+
+	this->runParallel(count, batchFunction);
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::setVoxelTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames,
+	double secondsPerFrame)
+{
+	DebugAssert(id < SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
+	DebugAssert(srcFrames.size() > 0);
+	DebugAssert(secondsPerFrame > 0.0);
+
+	const int frameCount = static_cast<int>(srcFrames.size());
+	if (frameCount == 1)
+	{
+		this->setVoxelTexture(id, srcFrames.front());
+		return;
+	}
+
+	// Reuse the ID's extra frames if it's being given the same number of them again.
+	auto iter = std::find_if(this->voxelTextureAnimations.begin(),
+		this->voxelTextureAnimations.end(), [id](const VoxelTextureAnimation &animation)
+	{
+		return animation.id == id;
+	});
+
+	if ((iter != this->voxelTextureAnimations.end()) && (iter->frameCount != frameCount))
+	{
+		this->stopVoxelTextureAnimation(id);
+		iter = this->voxelTextureAnimations.end();
+	}
+
+	if (iter == this->voxelTextureAnimations.end())
+	{
+		VoxelTextureAnimation animation;
+		animation.id = id;
+		animation.extraFramesIndex = static_cast<int>(this->voxelTextures.size());
+		animation.frameCount = frameCount;
+		this->voxelTextures.resize(this->voxelTextures.size() + (frameCount - 1));
+		this->voxelTextureAnimations.push_back(animation);
+		iter = this->voxelTextureAnimations.end() - 1;
+	}
+
+	iter->secondsPerFrame = secondsPerFrame;
+	const int extraFramesIndex = iter->extraFramesIndex;
+
+	// Each frame is only written by its own batch.
+	const std::function<void(int)> batchFunction = [this, id, extraFramesIndex,
+		&srcFrames](int frameIndex)
+	{
+		const int textureIndex = (frameIndex == 0) ? id : (extraFramesIndex + frameIndex - 1);
+		SoftwareRenderer::initVoxelTexture(this->voxelTextures[textureIndex],
+			srcFrames[frameIndex], this->shadeTable);
+	};
+
+	this->runParallel(frameCount, batchFunction);
+
+	// Start on whichever frame the clock is at.
+	this->shadingInfo->voxelTextureIndices[id] = id;
+	this->tickAnimations(0.0);
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::tickAnimations(double dt)
+{
+	ShadingInfo &shadingInfo = *this->shadingInfo;
+	shadingInfo.animationTime += dt;
+
+	for (const VoxelTextureAnimation &animation : this->voxelTextureAnimations)
+	{
+		const double frameCountReal = static_cast<double>(animation.frameCount);
+		const double framePosition = std::fmod(
+			shadingInfo.animationTime / animation.secondsPerFrame, frameCountReal);
+		const int frameIndex = std::min(static_cast<int>(framePosition),
+			animation.frameCount - 1);
+		const int textureIndex = (frameIndex == 0) ? animation.id :
+			(animation.extraFramesIndex + frameIndex - 1);
+
+		// Only a frame change makes this frame differ from the last one.
+		int &voxelTextureIndex = shadingInfo.voxelTextureIndices[animation.id];
+		if (voxelTextureIndex != textureIndex)
+		{
+			voxelTextureIndex = textureIndex;
+			this->lastFrameInputs.isValid = false;
+		}
+	}
 }
 
 void SoftwareRenderer::setFlatTexture(int id, const uint32_t *srcTexels, int width, int height)
 {
-	const int texelCount = width * height;
+	this->setFlatTextureFrames(id, std::vector<const uint32_t*> { srcTexels }, width, height);
+}
+
+void SoftwareRenderer::setFlatTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames,
+	int width, int height)
+{
+	const int frameCount = static_cast<int>(srcFrames.size());
+	const int frameTexelCount = width * height;
 
-	// Reset the selected texture.
+	// Reset the selected texture, keeping its storage when the size is the same. Animation
+	// frames are often set again with the same texels, and then the palette indices and
+	// opaque runs made from them can be kept too.
 	FlatTexture &texture = this->flatTextures.at(id);
-	texture.texels = std::vector<FlatTexel>(texelCount);
-	texture.width = width;
-	texture.height = height;
+	bool texelsChanged = (texture.width != width) || (texture.height != height) ||
+		(texture.frameCount != frameCount);
+	if (texelsChanged)
+	{
+		texture.texels.resize(frameTexelCount * frameCount);
+		texture.width = width;
+		texture.height = height;
+		texture.frameCount = frameCount;
+	}
+
+	// Flats are drawn one screen column at a time, so store them column-major like voxel
+	// textures. Each frame's columns come after the previous frame's.
+	for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+	{
+		const uint32_t *srcTexels = srcFrames[frameIndex];
+		FlatTexel *dstTexels = texture.texels.data() + (frameIndex * frameTexelCount);
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				const uint32_t srcTexel = srcTexels[x + (y * width)];
+				const uint8_t r = static_cast<uint8_t>(srcTexel >> 16);
+				const uint8_t g = static_cast<uint8_t>(srcTexel >> 8);
+				const uint8_t b = static_cast<uint8_t>(srcTexel);
+				const uint8_t a = static_cast<uint8_t>(srcTexel >> 24);
+
+				FlatTexel &dstTexel = dstTexels[y + (x * height)];
+				texelsChanged |= (dstTexel.r != r) || (dstTexel.g != g) ||
+					(dstTexel.b != b) || (dstTexel.a != a);
+				dstTexel.r = r;
+				dstTexel.g = g;
+				dstTexel.b = b;
+				dstTexel.a = a;
+			}
+		}
+	}
 
-	for (int i = 0; i < texelCount; i++)
+	if (!texelsChanged)
 	{
-		const Double4 srcTexel = Double4::fromARGB(srcTexels[i]);
-		FlatTexel &dstTexel = texture.texels[i];
-		dstTexel.r = srcTexel.x;
-		dstTexel.g = srcTexel.y;
-		dstTexel.b = srcTexel.z;
-		dstTexel.a = srcTexel.w;
+		return;
 	}
+
+	texture.updatePaletteIndices(this->shadeTable);
+	texture.initOpaqueRuns();
+	this->lastFrameInputs.isValid = false;
 }
 
 void SoftwareRenderer::updateFlat(int id, const Double3 *position, const double *width, 
-	const double *height, const int *textureID, const bool *flipped)
+	const double *height, const int *textureID, const int *frameIndex, const bool *flipped)
 {
 	const auto flatIter = this->flats.find(id);
 	DebugAssertMsg(flatIter != this->flats.end(),
@@ -756,10 +2689,37 @@ void SoftwareRenderer::updateFlat(int id, const Double3 *position, const double
 
 	SoftwareRenderer::Flat &flat = flatIter->second;
 
+	// Entities are updated every frame whether or not they changed, so only a real change
+	// means the next frame can't be the same as the last one.
+	const bool changed = ((position != nullptr) && (*position != flat.position)) ||
+		((width != nullptr) && (*width != flat.width)) ||
+		((height != nullptr) && (*height != flat.height)) ||
+		((textureID != nullptr) && (*textureID != flat.textureID)) ||
+		((frameIndex != nullptr) && (*frameIndex != flat.frameIndex)) ||
+		((flipped != nullptr) && (*flipped != flat.flipped));
+
+	if (changed)
+	{
+		this->lastFrameInputs.isValid = false;
+	}
+
 	// Check which values requested updating and update them.
 	if (position != nullptr)
 	{
-		flat.position = *position;
+		// Move the flat to its new grid cell if needed.
+		const bool isNewCell = SoftwareRenderer::getFlatGridCell(flat.position) !=
+			SoftwareRenderer::getFlatGridCell(*position);
+
+		if (isNewCell)
+		{
+			this->removeFlatFromGrid(flat);
+			flat.position = *position;
+			this->addFlatToGrid(flat);
+		}
+		else
+		{
+			flat.position = *position;
+		}
 	}
 
 	if (width != nullptr)
@@ -777,6 +2737,11 @@ void SoftwareRenderer::updateFlat(int id, const Double3 *position, const double
 		flat.textureID = *textureID;
 	}
 
+	if (frameIndex != nullptr)
+	{
+		flat.frameIndex = *frameIndex;
+	}
+
 	if (flipped != nullptr)
 	{
 		flat.flipped = *flipped;
@@ -786,22 +2751,81 @@ void SoftwareRenderer::updateFlat(int id, const Double3 *position, const double
 void SoftwareRenderer::updateLight(int id, const Double3 *point,
 	const Double3 *color, const double *intensity)
 {
-	DebugNotImplemented();
+	const auto lightIter = this->lights.find(id);
+	DebugAssertMsg(lightIter != this->lights.end(),
+		"Cannot update a non-existent light (" + std::to_string(id) + ").");
+
+	SoftwareRenderer::Light &light = lightIter->second;
+	this->lastFrameInputs.isValid = false;
+
+	// A changed light can't stay baked, and can't be baked by an unfinished bake either.
+	if (light.isBaked)
+	{
+		this->discardLightMap();
+	}
+
+	this->lightBakeStale |= this->lightBakeJob.valid();
+
+	// Moving or resizing a light can change which voxel columns it reaches.
+	const bool reachChanged = (point != nullptr) || (intensity != nullptr);
+	if (reachChanged)
+	{
+		this->removeLightFromGrid(light);
+	}
+
+	if (point != nullptr)
+	{
+		light.point = *point;
+	}
+
+	if (color != nullptr)
+	{
+		light.color = *color;
+	}
+
+	if (intensity != nullptr)
+	{
+		light.intensity = *intensity;
+	}
+
+	if (reachChanged)
+	{
+		this->addLightToGrid(light);
+	}
 }
 
 void SoftwareRenderer::setFogDistance(double fogDistance)
 {
-	this->fogDistance = fogDistance;
+	if (fogDistance != this->fogDistance)
+	{
+		this->fogDistance = fogDistance;
+		this->lastFrameInputs.isValid = false;
+	}
 }
 
 void SoftwareRenderer::setDistantSky(const DistantSky &distantSky)
 {
-	// Clear old distant sky data.
+	// Clear old distant sky data, keeping its textures by surface so the ones the new sky
+	// shares with it (i.e., when going back to the same exterior) are reused.
 	this->distantObjects.clear();
+
+	std::unordered_map<const Surface*, SkyTexture> oldSkyTextures;
+	for (size_t i = 0; i < this->skyTextures.size(); i++)
+	{
+		const Surface *surface = this->skyTextureSurfaces[i];
+		if (surface != nullptr)
+		{
+			oldSkyTextures.emplace(surface, std::move(this->skyTextures[i]));
+		}
+	}
+
 	this->skyTextures.clear();
+	this->skyTextureSurfaces.clear();
 
 	// Create distant objects and set the sky textures.
-	this->distantObjects.init(distantSky, this->skyTextures);
+	this->distantObjects.init(distantSky, this->skyTextures, this->skyTextureSurfaces,
+		oldSkyTextures);
+	this->lastFrameInputs.isValid = false;
 }
 
 void SoftwareRenderer::setSkyPalette(const uint32_t *colors, int count)
@@ -812,32 +2836,75 @@ void SoftwareRenderer::setSkyPalette(const uint32_t *colors, int count)
 	{
 		this->skyPalette[i] = Double3::fromRGB(colors[i]);
 	}
+
+	this->lastFrameInputs.isValid = false;
 }
 
-void SoftwareRenderer::setNightLightsActive(bool active)
+void SoftwareRenderer::setVoxelDetailDistance(double distance)
 {
-	// @todo: activate lights (don't worry about textures).
+	if (distance != this->voxelDetailDistance)
+	{
+		this->voxelDetailDistance = distance;
+		this->lastFrameInputs.isValid = false;
+	}
+}
+
+void SoftwareRenderer::setInterlacedVoxels(bool active)
+{
+	if (active != this->interlacedVoxels)
+	{
+		this->interlacedVoxels = active;
+		this->lastFrameInputs.isValid = false;
+	}
+}
 
-	// Change voxel texels based on whether it's night.
-	const Double4 texelColor = Double4::fromARGB(
-		(active ? Color(255, 166, 0) : Color::Black).toARGB());
-	const double texelEmission = active ? 1.0 : 0.0;
+void SoftwareRenderer::setTexturePalette(const uint32_t *colors, int count)
+{
+	DebugAssert(count == ShadeTable::PALETTE_SIZE);
+	this->shadeTable.init(colors);
 
-	for (auto &voxelTexture : this->voxelTextures)
+	// Textures that were already set need their palette indices redone.
+	for (auto &texture : this->voxelTextures)
 	{
-		auto &texels = voxelTexture.texels;
+		texture.updatePaletteIndices(this->shadeTable, 0);
+	}
 
-		for (const auto &lightTexels : voxelTexture.lightTexels)
-		{
-			const int index = lightTexels.x + (lightTexels.y * VoxelTexture::WIDTH);
+	for (auto &texture : this->flatTextures)
+	{
+		texture.updatePaletteIndices(this->shadeTable);
+	}
 
-			VoxelTexel &texel = texels.at(index);
-			texel.r = texelColor.x;
-			texel.g = texelColor.y;
-			texel.b = texelColor.z;
-			texel.transparent = texelColor.w == 0.0;
-			texel.emission = texelEmission;
-		}
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::setPaletteRendering(bool active)
+{
+	if (active != this->paletteRendering)
+	{
+		this->paletteRendering = active;
+		this->lastFrameInputs.isValid = false;
+	}
+}
+
+void SoftwareRenderer::setScanlinePlanes(bool active)
+{
+	if (active != this->scanlinePlanes)
+	{
+		this->scanlinePlanes = active;
+		this->lastFrameInputs.isValid = false;
+	}
+}
+
+void SoftwareRenderer::setNightLightsActive(bool active)
+{
+	// @todo: activate lights (don't worry about textures).
+
+	// Voxel textures with light texels already have a night variant, so only the choice of
+	// variant changes. It's read once per frame through the shading info.
+	if (active != this->nightLightsActive)
+	{
+		this->nightLightsActive = active;
+		this->lastFrameInputs.isValid = false;
 	}
 }
 
@@ -848,61 +2915,229 @@ void SoftwareRenderer::removeFlat(int id)
 	DebugAssertMsg(flatIter != this->flats.end(),
 		"Cannot remove a non-existent flat (" + std::to_string(id) + ").");
 
+	this->removeFlatFromGrid(flatIter->second);
 	this->flats.erase(flatIter);
+	this->lastFrameInputs.isValid = false;
 }
 
 void SoftwareRenderer::removeLight(int id)
 {
-	DebugNotImplemented();
+	// Make sure the light exists before removing it.
+	const auto lightIter = this->lights.find(id);
+	DebugAssertMsg(lightIter != this->lights.end(),
+		"Cannot remove a non-existent light (" + std::to_string(id) + ").");
+
+	if (lightIter->second.isBaked)
+	{
+		this->discardLightMap();
+	}
+
+	this->lightBakeStale |= this->lightBakeJob.valid();
+	this->removeLightFromGrid(lightIter->second);
+	this->lights.erase(lightIter);
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::bakeLights(const VoxelGrid &voxelGrid, double ceilingHeight)
+{
+	// Start over from every light being unbaked.
+	this->waitForLightBake();
+	this->discardLightMap();
+	this->lastFrameInputs.isValid = false;
+
+	// The bake job gets its own copy of the lights so they can keep changing here.
+	std::vector<Light> lightsToBake;
+	this->pendingLightMap = LightMap();
+	for (const auto &pair : this->lights)
+	{
+		lightsToBake.push_back(pair.second);
+		this->pendingLightMap.lightIDs.push_back(pair.first);
+	}
+
+	this->lightBakeDone = false;
+	this->lightBakeStale = false;
+
+	const int gridHeight = voxelGrid.getHeight();
+	this->lightBakeJob = JobSystem::submit(JobSystem::Priority::Background,
+		[this, lightsToBake = std::move(lightsToBake), gridHeight, ceilingHeight]()
+	{
+		this->pendingLightMap.bake(lightsToBake, gridHeight, ceilingHeight);
+		this->lightBakeDone = true;
+	});
 }
 
 void SoftwareRenderer::clearTextures()
 {
+	// Extra frames of animated voxel textures are freed.
+	for (const VoxelTextureAnimation &animation : this->voxelTextureAnimations)
+	{
+		this->shadingInfo->voxelTextureIndices[animation.id] = animation.id;
+	}
+
+	this->voxelTextureAnimations.clear();
+	this->voxelTextures.resize(SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
+
 	for (auto &texture : this->voxelTextures)
 	{
 		std::fill(texture.texels.begin(), texture.texels.end(), VoxelTexel());
+		texture.paletteIndices.fill(0);
 		texture.lightTexels.clear();
+		texture.nightTexels.clear();
+		texture.nightPaletteIndices.clear();
 	}
 
 	for (auto &texture : this->flatTextures)
 	{
 		std::fill(texture.texels.begin(), texture.texels.end(), FlatTexel());
+		std::fill(texture.paletteIndices.begin(), texture.paletteIndices.end(), 0);
+		texture.opaqueRuns.clear();
+		texture.columnRunOffsets.clear();
 		texture.width = 0;
 		texture.height = 0;
+		texture.frameCount = 0;
 	}
 
 	// Distant sky textures are cleared because the vector size is managed internally.
 	this->skyTextures.clear();
+	this->skyTextureSurfaces.clear();
 	this->distantObjects.sunTextureIndex = SoftwareRenderer::DistantObjects::NO_SUN;
+	this->lastFrameInputs.isValid = false;
 }
 
 void SoftwareRenderer::clearDistantSky()
 {
 	this->distantObjects.clear();
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::buildVisibilityRegions(const VoxelGrid &voxelGrid)
+{
+	this->visibilityRegions.init(voxelGrid);
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::clearVisibilityRegions()
+{
+	this->visibilityRegions.clear();
+	this->lastFrameInputs.isValid = false;
+}
+
+void SoftwareRenderer::reportMemory(MemoryReport &report) const
+{
+	size_t voxelTextureBytes = MemoryReport::getVectorBytes(this->voxelTextures);
+	for (const VoxelTexture &texture : this->voxelTextures)
+	{
+		voxelTextureBytes += MemoryReport::getVectorBytes(texture.lightTexels) +
+			MemoryReport::getVectorBytes(texture.nightTexels) +
+			MemoryReport::getVectorBytes(texture.nightPaletteIndices);
+	}
+
+	size_t flatTextureBytes = MemoryReport::getVectorBytes(this->flatTextures);
+	for (const FlatTexture &texture : this->flatTextures)
+	{
+		flatTextureBytes += MemoryReport::getVectorBytes(texture.texels) +
+			MemoryReport::getVectorBytes(texture.paletteIndices) +
+			MemoryReport::getVectorBytes(texture.opaqueRuns) +
+			MemoryReport::getVectorBytes(texture.columnRunOffsets);
+	}
+
+	size_t skyTextureBytes = MemoryReport::getVectorBytes(this->skyTextures);
+	for (const SkyTexture &texture : this->skyTextures)
+	{
+		skyTextureBytes += MemoryReport::getVectorBytes(texture.texels) +
+			MemoryReport::getVectorBytes(texture.columnOpaqueStarts) +
+			MemoryReport::getVectorBytes(texture.columnOpaqueEnds);
+	}
+
+	size_t frameBufferBytes = MemoryReport::getVectorBytes(this->colorBuffer) +
+		MemoryReport::getVectorBytes(this->depthBuffer) +
+		MemoryReport::getVectorBytes(this->indexBuffer) +
+		MemoryReport::getVectorBytes(this->occlusion) +
+		MemoryReport::getVectorBytes(this->columnHits);
+	for (size_t i = 0; i < this->voxelHistory.colorBuffers.size(); i++)
+	{
+		frameBufferBytes += MemoryReport::getVectorBytes(this->voxelHistory.colorBuffers[i]) +
+			MemoryReport::getVectorBytes(this->voxelHistory.depthBuffers[i]);
+	}
+
+	// The pending light map is left out since the bake job might be writing it.
+	size_t lightMapBytes = MemoryReport::getVectorBytes(this->lightMap.lightIDs);
+	for (const auto &pair : this->lightMap.columns)
+	{
+		lightMapBytes += MemoryReport::getVectorBytes(pair.second);
+	}
+
+	report.add("Renderer/Voxel textures", voxelTextureBytes);
+	report.add("Renderer/Flat textures", flatTextureBytes);
+	report.add("Renderer/Sky textures", skyTextureBytes);
+	report.add("Renderer/Frame buffers", frameBufferBytes);
+	report.add("Renderer/Light map", lightMapBytes);
+}
+
+const RenderTimings &SoftwareRenderer::getRenderTimings() const
+{
+	return this->renderTimings;
+}
+
+void SoftwareRenderer::setPresentTime(double seconds)
+{
+	this->renderTimings.setPresentTime(seconds);
 }
 
 void SoftwareRenderer::resize(int width, int height)
 {
 	const int pixelCount = width * height;
+	this->colorBuffer.resize(pixelCount);
+	std::fill(this->colorBuffer.begin(), this->colorBuffer.end(), 0);
+
 	this->depthBuffer.resize(pixelCount);
 	std::fill(this->depthBuffer.begin(), this->depthBuffer.end(), 
-		std::numeric_limits<double>::infinity());
+		std::numeric_limits<float>::infinity());
 
 	this->occlusion.resize(width);
 	std::fill(this->occlusion.begin(), this->occlusion.end(), OcclusionData(0, height));
 
 	this->skyGradientRowCache.resize(height);
 	std::fill(this->skyGradientRowCache.begin(), this->skyGradientRowCache.end(), Double3::Zero);
+	this->skyGradientRowColorCache.resize(height);
+	std::fill(this->skyGradientRowColorCache.begin(), this->skyGradientRowColorCache.end(), 0);
+	this->skyGradientCacheIsValid = false;
+
+	// The previous frame can't be reprojected or reused at a different size.
+	this->voxelHistory.isValid = false;
+	this->lastFrameInputs.isValid = false;
 
 	this->width = width;
 	this->height = height;
+}
+
+void SoftwareRenderer::reserve(int width, int height)
+{
+	const int pixelCount = width * height;
+	this->colorBuffer.reserve(pixelCount);
+	this->depthBuffer.reserve(pixelCount);
+	this->occlusion.reserve(width);
+	this->columnHits.reserve(width);
+	this->skyGradientRowCache.reserve(height);
+	this->skyGradientRowColorCache.reserve(height);
+
+	// The palette and interlacing buffers are only reserved if they're in use.
+	if (!this->indexBuffer.empty())
+	{
+		this->indexBuffer.reserve(pixelCount);
+	}
 
-	// Restart render threads with new dimensions.
-	const int threadCount = SoftwareRenderer::getRenderThreadsFromMode(this->renderThreadsMode);
-	this->initRenderThreads(width, height, threadCount);
+	if (!this->voxelHistory.colorBuffers[0].empty())
+	{
+		for (size_t i = 0; i < this->voxelHistory.colorBuffers.size(); i++)
+		{
+			this->voxelHistory.colorBuffers[i].reserve(pixelCount);
+			this->voxelHistory.depthBuffers[i].reserve(pixelCount);
+		}
+	}
 }
 
-void SoftwareRenderer::initRenderThreads(int width, int height, int threadCount)
+void SoftwareRenderer::initRenderThreads(int threadCount)
 {
 	// If there are existing threads, reset them.
 	if (this->renderThreads.size() > 0)
@@ -916,40 +3151,36 @@ void SoftwareRenderer::initRenderThreads(int width, int height, int threadCount)
 		this->renderThreads.resize(threadCount);
 	}
 
-	// Block width and height are the approximate number of columns and rows per thread,
-	// respectively.
-	const double blockWidth = static_cast<double>(width) / static_cast<double>(threadCount);
-	const double blockHeight = static_cast<double>(height) / static_cast<double>(threadCount);
+	this->visibleFlatBins.resize(threadCount);
+	this->flatOcclusions.resize(threadCount);
+
+	// Render threads are started from the main thread, so it's moved off their cores first.
+	const std::vector<int> threadCores = SoftwareRenderer::getRenderThreadCores(
+		threadCount, this->renderThreadsAffinity, this->renderThreadsCoreList);
+	SoftwareRenderer::avoidRenderThreadCores(this->renderThreadsMode,
+		this->renderThreadsAffinity, this->renderThreadsCoreList);
 
-	// Start thread loop for each render thread. Rounding is involved so the start and stop
-	// coordinates are correct for all resolutions.
+	// Start thread loop for each render thread. Their columns and rows are given with each
+	// frame.
 	for (size_t i = 0; i < this->renderThreads.size(); i++)
 	{
 		const int threadIndex = static_cast<int>(i);
-		const int startX = static_cast<int>(std::round(static_cast<double>(i) * blockWidth));
-		const int endX = static_cast<int>(std::round(static_cast<double>(i + 1) * blockWidth));
-		const int startY = static_cast<int>(std::round(static_cast<double>(i) * blockHeight));
-		const int endY = static_cast<int>(std::round(static_cast<double>(i + 1) * blockHeight));
-
-		// Make sure the rounding is correct.
-		DebugAssert(startX >= 0);
-		DebugAssert(endX <= width);
-		DebugAssert(startY >= 0);
-		DebugAssert(endY <= height);
-
+		const int core = threadCores.empty() ? -1 : threadCores[i];
 		this->renderThreads[i] = std::thread(SoftwareRenderer::renderThreadLoop,
-			std::ref(this->threadData), threadIndex, startX, endX, startY, endY);
+			std::ref(this->threadData), threadIndex, core, this->renderThreadsHighPriority);
 	}
+
+	// Job workers are held back so loading alongside rendering doesn't oversubscribe the CPU.
+	JobSystem::setReservedThreadCount(threadCount);
 }
 
 void SoftwareRenderer::resetRenderThreads()
 {
-	// Tell each render thread it needs to terminate.
-	std::unique_lock<std::mutex> lk(this->threadData.mutex);
-	this->threadData.go = true;
+	// Tell each render thread it needs to terminate. The destruct flag must be visible before
+	// the go signal.
 	this->threadData.isDestructing = true;
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+	this->threadData.go = true;
+	this->threadData.notifyAll();
 
 	for (auto &thread : this->renderThreads)
 	{
@@ -1180,7 +3411,7 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 
 	for (const auto &land : this->distantObjects.lands)
 	{
-		const SkyTexture &texture = this->skyTextures.at(land.textureIndex);
+		const SkyTexture &texture = getTexture(this->skyTextures, land.textureIndex);
 		const double xAngleRadians = land.obj.getAngleRadians();
 		const double yAngleRadians = 0.0;
 		const bool emissive = false;
@@ -1194,7 +3425,7 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 
 	for (const auto &animLand : this->distantObjects.animLands)
 	{
-		const SkyTexture &texture = this->skyTextures.at(
+		const SkyTexture &texture = getTexture(this->skyTextures,
 			animLand.textureIndex + animLand.obj.getIndex());
 		const double xAngleRadians = animLand.obj.getAngleRadians();
 		const double yAngleRadians = 0.0;
@@ -1209,7 +3440,7 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 
 	for (const auto &air : this->distantObjects.airs)
 	{
-		const SkyTexture &texture = skyTextures.at(air.textureIndex);
+		const SkyTexture &texture = getTexture(skyTextures, air.textureIndex);
 		const double xAngleRadians = air.obj.getAngleRadians();
 		const double yAngleRadians = [&air]()
 		{
@@ -1233,15 +3464,9 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 	const Matrix4d &timeRotation = shadingInfo.timeRotation;
 	const Matrix4d &latitudeRotation = shadingInfo.latitudeRotation;
 
-	auto getSpaceCorrectedAngles = [&timeRotation, &latitudeRotation](double xAngleRadians,
-		double yAngleRadians, double &newXAngleRadians, double &newYAngleRadians)
+	auto getSpaceCorrectedAngles = [&timeRotation, &latitudeRotation](const Double3 &direction,
+		double &newXAngleRadians, double &newYAngleRadians)
 	{
-		// Direction towards the space object.
-		const Double3 direction = Double3(
-			std::sin(xAngleRadians),
-			std::tan(yAngleRadians),
-			std::cos(xAngleRadians)).normalized();
-
 		// Rotate the direction based on latitude and time of day.
 		const Double4 dir = latitudeRotation * (timeRotation * Double4(direction, 0.0));
 		newXAngleRadians = std::atan2(dir.x, dir.z);
@@ -1250,7 +3475,7 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 
 	for (const auto &moon : this->distantObjects.moons)
 	{
-		const SkyTexture &texture = skyTextures.at(moon.textureIndex);
+		const SkyTexture &texture = getTexture(skyTextures, moon.textureIndex);
 
 		// These moon directions are roughly correct, based on the original game.
 		const Double3 direction = [&moon]()
@@ -1289,8 +3514,10 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 		const Orientation orientation = Orientation::Top;
 
 		// Modify angle based on latitude and time of day.
+		const Double3 spaceDirection = SoftwareRenderer::getSpaceObjectDirection(
+			xAngleRadians, yAngleRadians);
 		double newXAngleRadians, newYAngleRadians;
-		getSpaceCorrectedAngles(xAngleRadians, yAngleRadians, newXAngleRadians, newYAngleRadians);
+		getSpaceCorrectedAngles(spaceDirection, newXAngleRadians, newYAngleRadians);
 
 		tryAddObject(texture, newXAngleRadians, newYAngleRadians, emissive, orientation);
 	}
@@ -1301,7 +3528,8 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 	// Try to add the sun to the visible distant objects.
 	if (this->distantObjects.sunTextureIndex != SoftwareRenderer::DistantObjects::NO_SUN)
 	{
-		const SkyTexture &sunTexture = this->skyTextures.at(this->distantObjects.sunTextureIndex);
+		const SkyTexture &sunTexture = getTexture(this->skyTextures,
+			this->distantObjects.sunTextureIndex);
 
 		// The sun direction is already corrected for latitude and time of day since the same
 		// variable is reused with shading.
@@ -1324,19 +3552,101 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 	this->visDistantObjs.sunEnd = static_cast<int>(this->visDistantObjs.objs.size());
 	this->visDistantObjs.starStart = this->visDistantObjs.sunEnd;
 
-	for (const auto &star : this->distantObjects.stars)
+	// Gather the stars that might be on-screen. A star's horizontal screen position only depends
+	// on its direction in the XZ plane, so it can only be visible inside a wedge around the
+	// camera's forward direction that is widened for the largest star. The wedge's planes are
+	// rotated back into the unrotated sky so whole star cells can be rejected at once.
+	std::vector<int> &potentiallyVisibleStars = this->potentiallyVisibleStars;
+	potentiallyVisibleStars.clear();
+
+	const double starWedgeAngleRadians = [this, parallaxSky, &camera]()
 	{
-		const SkyTexture &texture = skyTextures.at(star.textureIndex);
+		constexpr double paddingRadians = 2.0 * Constants::DegToRad;
+		const double starMaxHalfWidth = this->distantObjects.starMaxWidth * 0.50;
 
-		const Double3 &direction = star.obj.getDirection();
-		const double xAngleRadians = MathUtils::fullAtan2(direction.x, direction.z);
-		const double yAngleRadians = direction.getYAngleRadians();
+		if (parallaxSky)
+		{
+			const double cameraHFov = MathUtils::verticalFovToHorizontalFov(
+				camera.fovY, camera.aspect);
+			const double halfCameraHFovRadians = (cameraHFov * 0.50) * Constants::DegToRad;
+			return halfCameraHFovRadians +
+				(starMaxHalfWidth * DistantSky::IDENTITY_ANGLE_RADIANS) + paddingRadians;
+		}
+		else
+		{
+			// The projected X of a horizontal direction is proportional to the tangent of its
+			// angle from forward, so project one 45 degrees off to get the scale.
+			const Double3 diagonalPoint = camera.eye +
+				Double3(camera.forwardX + camera.rightX, 0.0, camera.forwardZ + camera.rightZ);
+			const Double4 diagonalProjPoint = camera.transform * Double4(diagonalPoint, 1.0);
+			const double diagonalProjX = std::abs(diagonalProjPoint.x / diagonalProjPoint.w);
+
+			const double starMaxProjHalfWidth = (starMaxHalfWidth * camera.zoom) /
+				(camera.aspect * SoftwareRenderer::TALL_PIXEL_RATIO);
+			const double maxTangent = (1.0 + (starMaxProjHalfWidth * 2.0)) / diagonalProjX;
+			return std::atan(maxTangent) + paddingRadians;
+		}
+	}();
+
+	if (std::isfinite(starWedgeAngleRadians) && (starWedgeAngleRadians < Constants::HalfPi))
+	{
+		// Inward normals of the wedge's two planes in world space.
+		const Double2 right(camera.rightX, camera.rightZ);
+		const double wedgeSin = std::sin(starWedgeAngleRadians);
+		const double wedgeCos = std::cos(starWedgeAngleRadians);
+		const Double2 normalA = (forward * wedgeSin) - (right * wedgeCos);
+		const Double2 normalB = (forward * wedgeSin) + (right * wedgeCos);
+
+		// Transform the normals into the unrotated sky with the transpose of the rotation.
+		const Matrix4d skyRotation = latitudeRotation * timeRotation;
+		auto getSkyNormal = [&skyRotation](const Double2 &normal)
+		{
+			const Double3 worldNormal(normal.x, 0.0, normal.y);
+			return Double3(
+				worldNormal.dot(Double3(skyRotation.x.x, skyRotation.x.y, skyRotation.x.z)),
+				worldNormal.dot(Double3(skyRotation.y.x, skyRotation.y.y, skyRotation.y.z)),
+				worldNormal.dot(Double3(skyRotation.z.x, skyRotation.z.y, skyRotation.z.z)));
+		};
+
+		const Double3 skyNormalA = getSkyNormal(normalA);
+		const Double3 skyNormalB = getSkyNormal(normalB);
+
+		for (const DistantObjects::StarCell &cell : this->distantObjects.starCells)
+		{
+			// A cell can be skipped if all of its directions are behind one of the planes.
+			constexpr double epsilon = 1.0e-3;
+			const double minDot = -(cell.sinRadius + epsilon);
+			if ((cell.direction.dot(skyNormalA) >= minDot) &&
+				(cell.direction.dot(skyNormalB) >= minDot))
+			{
+				potentiallyVisibleStars.insert(potentiallyVisibleStars.end(),
+					cell.starIndices.begin(), cell.starIndices.end());
+			}
+		}
+
+		// Keep the stars in their original draw order.
+		std::sort(potentiallyVisibleStars.begin(), potentiallyVisibleStars.end());
+	}
+	else
+	{
+		// The wedge is too wide to cull anything.
+		for (int i = 0; i < static_cast<int>(this->distantObjects.stars.size()); i++)
+		{
+			potentiallyVisibleStars.push_back(i);
+		}
+	}
+
+	for (const int starIndex : potentiallyVisibleStars)
+	{
+		const auto &star = this->distantObjects.stars[starIndex];
+		const SkyTexture &texture = getTexture(skyTextures, star.textureIndex);
+		const Double3 &direction = this->distantObjects.starDirections[starIndex];
 		const bool emissive = true;
 		const Orientation orientation = Orientation::Bottom;
 
 		// Modify angle based on latitude and time of day.
 		double newXAngleRadians, newYAngleRadians;
-		getSpaceCorrectedAngles(xAngleRadians, yAngleRadians, newXAngleRadians, newYAngleRadians);
+		getSpaceCorrectedAngles(direction, newXAngleRadians, newYAngleRadians);
 
 		tryAddObject(texture, newXAngleRadians, newYAngleRadians, emissive, orientation);
 	}
@@ -1344,10 +3654,199 @@ void SoftwareRenderer::updateVisibleDistantObjects(bool parallaxSky,
 	this->visDistantObjs.starEnd = static_cast<int>(this->visDistantObjs.objs.size());
 }
 
-void SoftwareRenderer::updateVisibleFlats(const Camera &camera)
+Int2 SoftwareRenderer::getFlatGridCell(const Double3 &point)
+{
+	return Int2(
+		static_cast<int>(std::floor(point.x / SoftwareRenderer::FLAT_GRID_CELL_SIZE)),
+		static_cast<int>(std::floor(point.z / SoftwareRenderer::FLAT_GRID_CELL_SIZE)));
+}
+
+void SoftwareRenderer::addFlatToGrid(const Flat &flat)
+{
+	const Int2 cell = SoftwareRenderer::getFlatGridCell(flat.position);
+	this->flatGrid[cell].push_back(&flat);
+}
+
+void SoftwareRenderer::removeFlatFromGrid(const Flat &flat)
+{
+	const Int2 cell = SoftwareRenderer::getFlatGridCell(flat.position);
+	const auto cellIter = this->flatGrid.find(cell);
+	DebugAssert(cellIter != this->flatGrid.end());
+
+	std::vector<const Flat*> &cellFlats = cellIter->second;
+	const auto flatIter = std::find(cellFlats.begin(), cellFlats.end(), &flat);
+	DebugAssert(flatIter != cellFlats.end());
+
+	// Order within a cell doesn't matter, so swap with the last one.
+	*flatIter = cellFlats.back();
+	cellFlats.pop_back();
+
+	if (cellFlats.empty())
+	{
+		this->flatGrid.erase(cellIter);
+	}
+}
+
+void SoftwareRenderer::getLightGridCells(const Light &light, Int2 *outMin, Int2 *outMax)
+{
+	*outMin = Int2(
+		static_cast<int>(std::floor(light.point.x - light.intensity)),
+		static_cast<int>(std::floor(light.point.z - light.intensity)));
+	*outMax = Int2(
+		static_cast<int>(std::floor(light.point.x + light.intensity)),
+		static_cast<int>(std::floor(light.point.z + light.intensity)));
+}
+
+void SoftwareRenderer::addLightToGrid(const Light &light)
+{
+	Int2 minCell, maxCell;
+	SoftwareRenderer::getLightGridCells(light, &minCell, &maxCell);
+
+	for (int z = minCell.y; z <= maxCell.y; z++)
+	{
+		for (int x = minCell.x; x <= maxCell.x; x++)
+		{
+			this->lightGrid[Int2(x, z)].push_back(&light);
+		}
+	}
+}
+
+void SoftwareRenderer::removeLightFromGrid(const Light &light)
+{
+	Int2 minCell, maxCell;
+	SoftwareRenderer::getLightGridCells(light, &minCell, &maxCell);
+
+	for (int z = minCell.y; z <= maxCell.y; z++)
+	{
+		for (int x = minCell.x; x <= maxCell.x; x++)
+		{
+			const auto cellIter = this->lightGrid.find(Int2(x, z));
+			DebugAssert(cellIter != this->lightGrid.end());
+
+			std::vector<const Light*> &cellLights = cellIter->second;
+			const auto lightIter = std::find(cellLights.begin(), cellLights.end(), &light);
+			DebugAssert(lightIter != cellLights.end());
+
+			// Order within a cell doesn't matter, so swap with the last one.
+			*lightIter = cellLights.back();
+			cellLights.pop_back();
+
+			if (cellLights.empty())
+			{
+				this->lightGrid.erase(cellIter);
+			}
+		}
+	}
+}
+
+void SoftwareRenderer::waitForLightBake()
+{
+	if (this->lightBakeJob.valid())
+	{
+		this->lightBakeJob.get();
+	}
+}
+
+void SoftwareRenderer::discardLightMap()
+{
+	for (const int id : this->lightMap.lightIDs)
+	{
+		Light &light = this->lights.at(id);
+		DebugAssert(light.isBaked);
+		light.isBaked = false;
+		this->addLightToGrid(light);
+	}
+
+	this->lightMap = LightMap();
+}
+
+void SoftwareRenderer::updateLightMap()
+{
+	if (!this->lightBakeJob.valid() || !this->lightBakeDone)
+	{
+		return;
+	}
+
+	this->lightBakeJob.get();
+
+	if (this->lightBakeStale)
+	{
+		// A light changed during the bake, so the results are out of date.
+		this->pendingLightMap = LightMap();
+		return;
+	}
+
+	// The baked lights no longer need to be evaluated per frame.
+	this->lightMap = std::move(this->pendingLightMap);
+	for (const int id : this->lightMap.lightIDs)
+	{
+		Light &light = this->lights.at(id);
+		this->removeLightFromGrid(light);
+		light.isBaked = true;
+	}
+
+	this->pendingLightMap = LightMap();
+}
+
+void SoftwareRenderer::updateVisibleFlats(const Camera &camera, double ceilingHeight,
+	const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid)
 {
 	this->visibleFlats.clear();
 
+	// Find which visibility regions can be seen from the eye. They only describe the main
+	// floor, so the eye has to be in it.
+	const bool useRegions = [this, &camera, ceilingHeight, &openDoors, &voxelGrid]()
+	{
+		if (!this->visibilityRegions.isInited())
+		{
+			return false;
+		}
+
+		this->visibilityRegions.update(voxelGrid);
+
+		const int eyeVoxelY = static_cast<int>(std::floor(camera.eye.y / ceilingHeight));
+		if (eyeVoxelY != 1)
+		{
+			return false;
+		}
+
+		const Int2 eyeVoxel(
+			static_cast<int>(std::floor(camera.eye.x)),
+			static_cast<int>(std::floor(camera.eye.z)));
+		return this->visibilityRegions.getVisibleRegions(eyeVoxel, openDoors,
+			this->visibleRegions);
+	}();
+
+	// Returns whether a flat might be in a visible region. A flat is hidden if every voxel
+	// its width could reach is in a hidden region. Flats reaching above the main floor could
+	// be seen over walls, so they're never hidden.
+	auto flatIsInVisibleRegion = [this, ceilingHeight](const Flat &flat)
+	{
+		if ((flat.position.y + flat.height) > (ceilingHeight * 2.0))
+		{
+			return true;
+		}
+
+		const double halfWidth = flat.width * 0.50;
+		const int minX = static_cast<int>(std::floor(flat.position.x - halfWidth));
+		const int maxX = static_cast<int>(std::floor(flat.position.x + halfWidth));
+		const int minZ = static_cast<int>(std::floor(flat.position.z - halfWidth));
+		const int maxZ = static_cast<int>(std::floor(flat.position.z + halfWidth));
+		for (int z = minZ; z <= maxZ; z++)
+		{
+			for (int x = minX; x <= maxX; x++)
+			{
+				const int region = this->visibilityRegions.getRegion(x, z);
+				if ((region == VisibilityRegions::NO_REGION) || this->visibleRegions[region])
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	};
+
 	// Each flat shares the same axes. The forward direction always faces opposite to 
 	// the camera direction.
 	const Double3 flatForward = Double3(-camera.forwardX, 0.0, -camera.forwardZ).normalized();
@@ -1357,11 +3856,25 @@ void SoftwareRenderer::updateVisibleFlats(const Camera &camera)
 	const Double2 eye2D(camera.eye.x, camera.eye.z);
 	const Double2 direction(camera.forwardX, camera.forwardZ);
 
-	// This is the visible flat determination algorithm. It goes through all flats and sees 
-	// which ones would be at least partially visible in the view frustum.
-	for (const auto &pair : this->flats)
+	// This is the visible flat determination algorithm. It goes through the given flat and
+	// sees if it would be at least partially visible in the view frustum.
+	auto tryAddVisibleFlat = [this, &camera, &flatRight, &flatUp, &eye2D,
+		&direction, useRegions, &flatIsInVisibleRegion](const Flat &flat)
 	{
-		const Flat &flat = pair.second;
+		// Flats only in regions hidden behind walls and closed doors can't be seen.
+		if (useRegions && !flatIsInVisibleRegion(flat))
+		{
+			return;
+		}
+
+		// A flat entirely at or past the fog distance would be drawn in solid fog color, so
+		// it's left out like voxels past the fog distance are.
+		const Double2 flatPosition2D(flat.position.x, flat.position.z);
+		const double nearestDistance = (flatPosition2D - eye2D).length() - (flat.width * 0.50);
+		if (nearestDistance >= this->fogDistance)
+		{
+			return;
+		}
 
 		// Scaled axes based on flat dimensions.
 		const Double3 flatRightScaled = flatRight * (flat.width * 0.50);
@@ -1375,7 +3888,6 @@ void SoftwareRenderer::updateVisibleFlats(const Camera &camera)
 		flatFrame.topEnd = flatFrame.bottomEnd + flatUpScaled;
 
 		// If the flat is somewhere in front of the camera, do further checks.
-		const Double2 flatPosition2D(flat.position.x, flat.position.z);
 		const Double2 flatEyeDiff = (flatPosition2D - eye2D).normalized();
 		const bool inFrontOfCamera = direction.dot(flatEyeDiff) > 0.0;
 
@@ -1387,35 +3899,274 @@ void SoftwareRenderer::updateVisibleFlats(const Camera &camera)
 			Double4 projStart = camera.transform * Double4(flatFrame.topStart, 1.0);
 			Double4 projEnd = camera.transform * Double4(flatFrame.bottomEnd, 1.0);
 
-			// Normalize coordinates.
-			projStart = projStart / projStart.w;
-			projEnd = projEnd / projEnd.w;
+			// Normalize coordinates.
+			projStart = projStart / projStart.w;
+			projEnd = projEnd / projEnd.w;
+
+			// Assign each screen value to the flat frame data.
+			flatFrame.startX = 0.50 + (projStart.x * 0.50);
+			flatFrame.endX = 0.50 + (projEnd.x * 0.50);
+			flatFrame.startY = (0.50 + camera.yShear) - (projStart.y * 0.50);
+			flatFrame.endY = (0.50 + camera.yShear) - (projEnd.y * 0.50);
+			flatFrame.z = projStart.z;
+
+			// Check that the Z value is within the clipping planes.
+			const bool inPlanes = (flatFrame.z >= SoftwareRenderer::NEAR_PLANE) &&
+				(flatFrame.z <= SoftwareRenderer::FAR_PLANE);
+
+			if (inPlanes)
+			{
+				// Add the flat data to the draw list.
+				this->visibleFlats.push_back(VisibleFlat(flat, std::move(flatFrame)));
+			}
+		}
+	};
+
+	const Double2 frustumLeft(camera.frustumLeftX, camera.frustumLeftZ);
+	const Double2 frustumRight(camera.frustumRightX, camera.frustumRightZ);
+
+	// Directions perpendicular to the frustum edges, pointing towards the inside. The camera's
+	// right vector is forward x up, so the frustum's left edge is on the +X side when looking
+	// down +Z, and its inward perpendicular is the left one.
+	const Double2 frustumLeftPerp = frustumLeft.leftPerp();
+	const Double2 frustumRightPerp = frustumRight.rightPerp();
+
+	// Flats past the fog distance are not drawn, the same as voxels. The 2D view frustum is
+	// then a circle sector of that radius, and its bounding box (padded by one cell for flat
+	// widths) gives the range of grid cells to check. Without fog, the range is every
+	// occupied cell instead.
+	Int2 minCell, maxCell;
+	if (std::isfinite(this->fogDistance))
+	{
+		const double viewDistance = this->fogDistance;
+
+		// The sector's extent is reached at the eye, the ends of the frustum edges, and
+		// wherever the arc crosses an axis, since the arc bulges past its end points there.
+		const std::array<Double2, 4> axisDirections =
+		{
+			Double2::UnitX, -Double2::UnitX, Double2::UnitY, -Double2::UnitY
+		};
+
+		std::array<Double2, 7> sectorPoints;
+		int sectorPointCount = 0;
+		sectorPoints[sectorPointCount++] = eye2D;
+		sectorPoints[sectorPointCount++] = eye2D + (frustumLeft * viewDistance);
+		sectorPoints[sectorPointCount++] = eye2D + (frustumRight * viewDistance);
+		for (const Double2 &axisDirection : axisDirections)
+		{
+			const bool inFrustum = (frustumLeftPerp.dot(axisDirection) >= 0.0) &&
+				(frustumRightPerp.dot(axisDirection) >= 0.0);
+			if (inFrustum)
+			{
+				sectorPoints[sectorPointCount++] = eye2D + (axisDirection * viewDistance);
+			}
+		}
+
+		Double2 sectorMin = sectorPoints[0];
+		Double2 sectorMax = sectorPoints[0];
+		for (int i = 1; i < sectorPointCount; i++)
+		{
+			const Double2 &point = sectorPoints[i];
+			sectorMin = Double2(std::min(sectorMin.x, point.x), std::min(sectorMin.y, point.y));
+			sectorMax = Double2(std::max(sectorMax.x, point.x), std::max(sectorMax.y, point.y));
+		}
+
+		minCell = SoftwareRenderer::getFlatGridCell(
+			Double3(sectorMin.x, 0.0, sectorMin.y)) - Int2(1, 1);
+		maxCell = SoftwareRenderer::getFlatGridCell(
+			Double3(sectorMax.x, 0.0, sectorMax.y)) + Int2(1, 1);
+	}
+	else if (this->flatGrid.size() > 0)
+	{
+		minCell = this->flatGrid.begin()->first;
+		maxCell = minCell;
+		for (const auto &pair : this->flatGrid)
+		{
+			const Int2 &cell = pair.first;
+			minCell = Int2(std::min(minCell.x, cell.x), std::min(minCell.y, cell.y));
+			maxCell = Int2(std::max(maxCell.x, cell.x), std::max(maxCell.y, cell.y));
+		}
+	}
+	else
+	{
+		// Empty range.
+		minCell = Int2(0, 0);
+		maxCell = Int2(-1, -1);
+	}
+
+	// Returns whether any part of a cell (padded by one cell) could be inside the frustum.
+	auto cellIsInFrustum = [&eye2D, &frustumLeftPerp, &frustumRightPerp](const Int2 &cell)
+	{
+		const double cellSize = SoftwareRenderer::FLAT_GRID_CELL_SIZE;
+		const Double2 boxMin(
+			(static_cast<double>(cell.x) - 1.0) * cellSize,
+			(static_cast<double>(cell.y) - 1.0) * cellSize);
+		const Double2 boxMax = boxMin + Double2(cellSize * 3.0, cellSize * 3.0);
+		const std::array<Double2, 4> corners =
+		{
+			Double2(boxMin.x, boxMin.y) - eye2D,
+			Double2(boxMax.x, boxMin.y) - eye2D,
+			Double2(boxMin.x, boxMax.y) - eye2D,
+			Double2(boxMax.x, boxMax.y) - eye2D
+		};
+
+		auto isInside = [&corners](const Double2 &perp)
+		{
+			return std::any_of(corners.begin(), corners.end(),
+				[&perp](const Double2 &corner) { return perp.dot(corner) >= 0.0; });
+		};
+
+		return isInside(frustumLeftPerp) && isInside(frustumRightPerp);
+	};
+
+	auto tryAddCellFlats = [&tryAddVisibleFlat, &cellIsInFrustum](const Int2 &cell,
+		const std::vector<const Flat*> &cellFlats)
+	{
+		if (cellIsInFrustum(cell))
+		{
+			for (const Flat *flat : cellFlats)
+			{
+				tryAddVisibleFlat(*flat);
+			}
+		}
+	};
+
+	// Visit whichever is fewer: the cells in range, or the occupied cells.
+	const int rangeCellCount = (maxCell.x - minCell.x + 1) * (maxCell.y - minCell.y + 1);
+	if (rangeCellCount <= static_cast<int>(this->flatGrid.size()))
+	{
+		for (int z = minCell.y; z <= maxCell.y; z++)
+		{
+			for (int x = minCell.x; x <= maxCell.x; x++)
+			{
+				const Int2 cell(x, z);
+				const auto cellIter = this->flatGrid.find(cell);
+				if (cellIter != this->flatGrid.end())
+				{
+					tryAddCellFlats(cell, cellIter->second);
+				}
+			}
+		}
+	}
+	else
+	{
+		for (const auto &pair : this->flatGrid)
+		{
+			const Int2 &cell = pair.first;
+			const bool inRange = (cell.x >= minCell.x) && (cell.x <= maxCell.x) &&
+				(cell.y >= minCell.y) && (cell.y <= maxCell.y);
+
+			if (inRange)
+			{
+				tryAddCellFlats(cell, pair.second);
+			}
+		}
+	}
+
+	// Sort the visible flats farthest to nearest (relevant for transparencies).
+	this->sortVisibleFlats();
+}
+
+void SoftwareRenderer::sortVisibleFlats()
+{
+	const int flatCount = static_cast<int>(this->visibleFlats.size());
+	if (flatCount < 2)
+	{
+		return;
+	}
+
+	// Make a sort key from each flat's depth. Visible flats are always between the near and
+	// far planes, and the bits of a positive double sort the same as its value, so inverting
+	// them gives a farthest-to-nearest ordering.
+	this->visibleFlatKeys.resize(flatCount);
+	this->visibleFlatKeysTemp.resize(flatCount);
+	for (int i = 0; i < flatCount; i++)
+	{
+		const double z = this->visibleFlats[i].getFrame().z;
+		DebugAssert(z >= 0.0);
+
+		uint64_t zBits;
+		std::memcpy(&zBits, &z, sizeof(zBits));
+		this->visibleFlatKeys[i] = std::make_pair(~zBits, i);
+	}
+
+	// Least-significant-digit radix sort, one byte at a time. Passes where every key has
+	// the same byte (i.e., the exponent bits of similar depths) are skipped.
+	constexpr int bucketCount = 256;
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		std::array<int, bucketCount> bucketOffsets;
+		bucketOffsets.fill(0);
+
+		for (const auto &key : this->visibleFlatKeys)
+		{
+			bucketOffsets[(key.first >> shift) & 0xFF]++;
+		}
+
+		const int firstBucket = (this->visibleFlatKeys.front().first >> shift) & 0xFF;
+		if (bucketOffsets[firstBucket] == flatCount)
+		{
+			continue;
+		}
+
+		int offset = 0;
+		for (int &bucketOffset : bucketOffsets)
+		{
+			const int count = bucketOffset;
+			bucketOffset = offset;
+			offset += count;
+		}
+
+		for (const auto &key : this->visibleFlatKeys)
+		{
+			const int bucket = (key.first >> shift) & 0xFF;
+			this->visibleFlatKeysTemp[bucketOffsets[bucket]] = key;
+			bucketOffsets[bucket]++;
+		}
+
+		this->visibleFlatKeys.swap(this->visibleFlatKeysTemp);
+	}
+
+	// Reorder the flats themselves once at the end, since they are much larger than the keys.
+	this->visibleFlatsTemp.clear();
+	for (const auto &key : this->visibleFlatKeys)
+	{
+		this->visibleFlatsTemp.push_back(this->visibleFlats[key.second]);
+	}
+
+	this->visibleFlats.swap(this->visibleFlatsTemp);
+}
 
-			// Assign each screen value to the flat frame data.
-			flatFrame.startX = 0.50 + (projStart.x * 0.50);
-			flatFrame.endX = 0.50 + (projEnd.x * 0.50);
-			flatFrame.startY = (0.50 + camera.yShear) - (projStart.y * 0.50);
-			flatFrame.endY = (0.50 + camera.yShear) - (projEnd.y * 0.50);
-			flatFrame.z = projStart.z;
+void SoftwareRenderer::binVisibleFlats(const FrameView &frame)
+{
+	for (std::vector<int> &bin : this->visibleFlatBins)
+	{
+		bin.clear();
+	}
 
-			// Check that the Z value is within the clipping planes.
-			const bool inPlanes = (flatFrame.z >= SoftwareRenderer::NEAR_PLANE) &&
-				(flatFrame.z <= SoftwareRenderer::FAR_PLANE);
+	const int threadCount = static_cast<int>(this->threadData.ranges.size());
+	for (int i = 0; i < static_cast<int>(this->visibleFlats.size()); i++)
+	{
+		const Flat::Frame &flatFrame = this->visibleFlats[i].getFrame();
+		const double flatStartX = std::min(flatFrame.startX, flatFrame.endX);
+		const double flatEndX = std::max(flatFrame.startX, flatFrame.endX);
 
-			if (inPlanes)
+		// Same X range test as drawFlat() (screen percents of the first and last column
+		// centers), so a flat is in every bin that it could be drawn in.
+		for (int j = 0; j < threadCount; j++)
+		{
+			const RenderThreadData::ThreadRange &range = this->threadData.ranges[j];
+			const double startXPercent = (static_cast<double>(range.startX) + 0.50) /
+				frame.widthReal;
+			const double endXPercent = (static_cast<double>(range.endX) + 0.50) /
+				frame.widthReal;
+
+			if ((flatStartX <= endXPercent) && (flatEndX >= startXPercent))
 			{
-				// Add the flat data to the draw list.
-				this->visibleFlats.push_back(VisibleFlat(flat, std::move(flatFrame)));
+				this->visibleFlatBins[j].push_back(i);
 			}
 		}
 	}
-
-	// Sort the visible flats farthest to nearest (relevant for transparencies).
-	std::sort(this->visibleFlats.begin(), this->visibleFlats.end(),
-		[](const VisibleFlat &a, const VisibleFlat &b)
-	{
-		return a.getFrame().z > b.getFrame().z;
-	});
 }
 
 /*Double3 SoftwareRenderer::castRay(const Double3 &direction,
@@ -1750,9 +4501,9 @@ int SoftwareRenderer::getRenderThreadsFromMode(int mode)
 		// High.
 		return std::max((3 * Platform::getThreadCount()) / 4, 1);
 	}
-	else if (mode == 4)
+	else if ((mode == 4) || (mode == 6))
 	{
-		// Very high.
+		// Very high, or auto before it's tuned.
 		return std::max(Platform::getThreadCount() - 1, 1);
 	}
 	else if (mode == 5)
@@ -1766,6 +4517,17 @@ int SoftwareRenderer::getRenderThreadsFromMode(int mode)
 	}
 }
 
+int SoftwareRenderer::getRenderThreadCount() const
+{
+	const bool isAutoMode = this->renderThreadsMode == 6;
+	if (isAutoMode && (this->autoRenderThreadCount > 0))
+	{
+		return this->autoRenderThreadCount;
+	}
+
+	return SoftwareRenderer::getRenderThreadsFromMode(this->renderThreadsMode);
+}
+
 VoxelData::Facing SoftwareRenderer::getInitialChasmFarFacing(int voxelX, int voxelZ,
 	const Double2 &eye, const Ray &ray)
 {
@@ -1817,33 +4579,23 @@ VoxelData::Facing SoftwareRenderer::getInitialChasmFarFacing(int voxelX, int vox
 VoxelData::Facing SoftwareRenderer::getChasmFarFacing(int voxelX, int voxelZ, 
 	VoxelData::Facing nearFacing, const Camera &camera, const Ray &ray)
 {
-	const Double2 eye2D(camera.eye.x, camera.eye.z);
-	
 	// Angle of the ray from the camera eye.
 	const double angle = MathUtils::fullAtan2(ray.dirX, ray.dirZ);
 
-	// Corners in world space.
-	const Double2 bottomLeftCorner(
-		static_cast<double>(voxelX),
-		static_cast<double>(voxelZ));
-	const Double2 topLeftCorner(
-		bottomLeftCorner.x + 1.0,
-		bottomLeftCorner.y);
-	const Double2 bottomRightCorner(
-		bottomLeftCorner.x,
-		bottomLeftCorner.y + 1.0);
-	const Double2 topRightCorner(
-		topLeftCorner.x,
-		bottomRightCorner.y);
+	VoxelCornerAngles cornerAngles;
+	cornerAngles.init(voxelX, voxelZ, Double2(camera.eye.x, camera.eye.z));
+	return SoftwareRenderer::getChasmFarFacing(voxelX, voxelZ, nearFacing, camera, angle,
+		cornerAngles);
+}
 
-	const Double2 upLeft = (topLeftCorner - eye2D).normalized();
-	const Double2 upRight = (topRightCorner - eye2D).normalized();
-	const Double2 downLeft = (bottomLeftCorner - eye2D).normalized();
-	const Double2 downRight = (bottomRightCorner - eye2D).normalized();
-	const double upLeftAngle = MathUtils::fullAtan2(upLeft.x, upLeft.y);
-	const double upRightAngle = MathUtils::fullAtan2(upRight.x, upRight.y);
-	const double downLeftAngle = MathUtils::fullAtan2(downLeft.x, downLeft.y);
-	const double downRightAngle = MathUtils::fullAtan2(downRight.x, downRight.y);
+VoxelData::Facing SoftwareRenderer::getChasmFarFacing(int voxelX, int voxelZ,
+	VoxelData::Facing nearFacing, const Camera &camera, double angle,
+	const VoxelCornerAngles &cornerAngles)
+{
+	const double upLeftAngle = cornerAngles.upLeft;
+	const double upRightAngle = cornerAngles.upRight;
+	const double downLeftAngle = cornerAngles.downLeft;
+	const double downRightAngle = cornerAngles.downRight;
 
 	// Find which side it starts on, then do some checks against line angles.
 	// When the ray origin is at a diagonal to the voxel, ignore the corner
@@ -2036,16 +4788,10 @@ VoxelData::Facing SoftwareRenderer::getChasmFarFacing(int voxelX, int voxelZ,
 }
 
 double SoftwareRenderer::getDoorPercentOpen(int voxelX, int voxelZ,
-	const std::vector<LevelData::DoorState> &openDoors)
+	const LevelData::OpenDoors &openDoors)
 {
-	const Int2 voxel(voxelX, voxelZ);
-	const auto iter = std::find_if(openDoors.begin(), openDoors.end(),
-		[&voxel](const LevelData::DoorState &openDoor)
-	{
-		return openDoor.getVoxel() == voxel;
-	});
-
-	return (iter != openDoors.end()) ? iter->getPercentOpen() : 0.0;
+	const LevelData::DoorState *door = openDoors.find(Int2(voxelX, voxelZ));
+	return (door != nullptr) ? door->getPercentOpen() : 0.0;
 }
 
 double SoftwareRenderer::getProjectedY(const Double3 &point, 
@@ -2138,6 +4884,14 @@ std::array<SoftwareRenderer::DrawRange, 3> SoftwareRenderer::makeDrawRangeThreeP
 	};
 }
 
+Double3 SoftwareRenderer::getSpaceObjectDirection(double xAngleRadians, double yAngleRadians)
+{
+	return Double3(
+		std::sin(xAngleRadians),
+		std::tan(yAngleRadians),
+		std::cos(xAngleRadians)).normalized();
+}
+
 Matrix4d SoftwareRenderer::getLatitudeRotation(double latitude)
 {
 	return Matrix4d::zRotation(latitude * (Constants::Pi / 8.0));
@@ -2445,9 +5199,9 @@ bool SoftwareRenderer::findInitialEdgeIntersection(int voxelX, int voxelZ,
 	}
 }
 
-bool SoftwareRenderer::findEdgeIntersection(int voxelX, int voxelZ, VoxelData::Facing edgeFacing,
-	bool flipped, VoxelData::Facing nearFacing, const Double2 &nearPoint, const Double2 &farPoint,
-	double nearU, const Camera &camera, const Ray &ray, RayHit &hit)
+bool SoftwareRenderer::findEdgeIntersection(VoxelData::Facing edgeFacing, bool flipped,
+	VoxelData::Facing nearFacing, const Double2 &nearPoint, const Double2 &farPoint,
+	double nearU, const ColumnIntersections &intersections, RayHit &hit)
 {
 	// If the edge facing and near facing match, the intersection is trivial.
 	if (edgeFacing == nearFacing)
@@ -2461,42 +5215,15 @@ bool SoftwareRenderer::findEdgeIntersection(int voxelX, int voxelZ, VoxelData::F
 	}
 	else
 	{
-		// A search is needed to see whether an intersection occurred. Reuse the chasm
-		// facing code to find what the far facing is.
-		const VoxelData::Facing farFacing = SoftwareRenderer::getChasmFarFacing(
-			voxelX, voxelZ, nearFacing, camera, ray);
-
 		// If the edge facing and far facing match, there's an intersection.
+		const VoxelData::Facing farFacing = intersections.farFacing;
 		if (edgeFacing == farFacing)
 		{
+			// Account for the possibility of the texture being flipped horizontally.
+			const double uVal = intersections.farU;
 			hit.innerZ = (farPoint - nearPoint).length();
-			hit.u = [flipped, &farPoint, farFacing]()
-			{
-				const double uVal = [&farPoint, farFacing]()
-				{
-					if (farFacing == VoxelData::Facing::PositiveX)
-					{
-						return Constants::JustBelowOne - (farPoint.y - std::floor(farPoint.y));
-					}
-					else if (farFacing == VoxelData::Facing::NegativeX)
-					{
-						return farPoint.y - std::floor(farPoint.y);
-					}
-					else if (farFacing == VoxelData::Facing::PositiveZ)
-					{
-						return farPoint.x - std::floor(farPoint.x);
-					}
-					else
-					{
-						return Constants::JustBelowOne - (farPoint.x - std::floor(farPoint.x));
-					}
-				}();
-
-				// Account for the possibility of the texture being flipped horizontally.
-				return std::clamp(!flipped ? uVal : (Constants::JustBelowOne - uVal),
-					0.0, Constants::JustBelowOne);
-			}();
-
+			hit.u = std::clamp(!flipped ? uVal : (Constants::JustBelowOne - uVal),
+				0.0, Constants::JustBelowOne);
 			hit.point = farPoint;
 			hit.normal = -VoxelData::getNormal(farFacing);
 			return true;
@@ -2804,9 +5531,8 @@ bool SoftwareRenderer::findInitialDoorIntersection(int voxelX, int voxelZ,
 	}
 }
 
-bool SoftwareRenderer::findSwingingDoorIntersection(int voxelX, int voxelZ,
-	double percentOpen, VoxelData::Facing nearFacing, const Double2 &nearPoint,
-	const Double2 &farPoint, double nearU, RayHit &hit)
+void SoftwareRenderer::getSwingingDoorLine(int voxelX, int voxelZ, double percentOpen,
+	VoxelData::Facing nearFacing, Double2 *outPivot, Double2 *outDoorVec)
 {
 	// Decide which corner the door's hinge will be in, and create the line segment
 	// that will be rotated based on percent open.
@@ -2859,48 +5585,13 @@ bool SoftwareRenderer::findSwingingDoorIntersection(int voxelX, int voxelZ,
 	const Double2 interpEnd = interpStart.leftPerp();
 
 	// Actual position of the door in its rotation, represented as a vector.
-	const Double2 doorVec = interpStart.lerp(interpEnd, 1.0 - percentOpen).normalized();
-
-	// Vector cross product in 2D, returns a scalar.
-	auto cross = [](const Double2 &a, const Double2 &b)
-	{
-		return (a.x * b.y) - (b.x * a.y);
-	};
-
-	// Solve line segment intersection between the incoming ray and the door.
-	const Double2 p1 = pivot;
-	const Double2 v1 = doorVec;
-	const Double2 p2 = nearPoint;
-	const Double2 v2 = farPoint - nearPoint;
-
-	// Percent from p1 to (p1 + v1).
-	const double t = cross(p2 - p1, v2) / cross(v1, v2);
-
-	// See if the two line segments intersect.
-	if ((t >= 0.0) && (t < 1.0))
-	{
-		// Hit.
-		hit.point = p1 + (v1 * t);
-		hit.innerZ = (hit.point - nearPoint).length();
-		hit.u = t;
-		hit.normal = [&v1]()
-		{
-			const Double2 norm2D = v1.rightPerp();
-			return Double3(norm2D.x, 0.0, norm2D.y);
-		}();
-
-		return true;
-	}
-	else
-	{
-		// No hit.
-		return false;
-	}
+	*outPivot = pivot;
+	*outDoorVec = interpStart.lerp(interpEnd, 1.0 - percentOpen).normalized();
 }
 
-bool SoftwareRenderer::findDoorIntersection(int voxelX, int voxelZ, 
-	VoxelData::DoorData::Type doorType, double percentOpen, VoxelData::Facing nearFacing,
-	const Double2 &nearPoint, const Double2 &farPoint, double nearU, RayHit &hit)
+bool SoftwareRenderer::findDoorIntersection(VoxelData::DoorData::Type doorType,
+	double percentOpen, VoxelData::Facing nearFacing, const Double2 &nearPoint, double nearU,
+	const ColumnIntersections &intersections, RayHit &hit)
 {
 	// Check trivial case first: whether the door is closed.
 	const bool isClosed = percentOpen == 0.0;
@@ -2916,8 +5607,8 @@ bool SoftwareRenderer::findDoorIntersection(int voxelX, int voxelZ,
 	}
 	else if (doorType == VoxelData::DoorData::Type::Swinging)
 	{
-		return SoftwareRenderer::findSwingingDoorIntersection(voxelX, voxelZ, percentOpen,
-			nearFacing, nearPoint, farPoint, nearU, hit);
+		hit = intersections.swingingDoorHit;
+		return intersections.swingingDoorSuccess;
 	}
 	else if (doorType == VoxelData::DoorData::Type::Sliding)
 	{
@@ -3023,9 +5714,260 @@ bool SoftwareRenderer::findDoorIntersection(int voxelX, int voxelZ,
 	}
 }
 
+void SoftwareRenderer::findDiagIntersections(int voxelX, int voxelZ, int rayCount,
+	const Double2 *nearPoints, const Double2 *farPoints, ColumnIntersections *outIntersections)
+{
+	// Same math as findDiag1Intersection() and findDiag2Intersection(), with both diagonals
+	// done together since they share the ray's slope and intercept. Every case of the hit
+	// coordinate is calculated and the right one selected, so the loop has no branches.
+	const double voxelXReal = static_cast<double>(voxelX);
+	const double voxelZReal = static_cast<double>(voxelZ);
+	const Double2 diagMiddle(voxelXReal + 0.50, voxelZReal + 0.50);
+	const double diag1XIntercept = voxelXReal - voxelZReal;
+	const double diag2StartX = voxelXReal + Constants::JustBelowOne;
+	const double diag2XIntercept = diag2StartX + voxelZReal;
+
+	// Normals for the left and right faces of each diagonal (magic number is sqrt(2) / 2).
+	const Double3 diag1LeftNormal(0.7071068, 0.0, -0.7071068);
+	const Double3 diag1RightNormal(-0.7071068, 0.0, 0.7071068);
+	const Double3 diag2LeftNormal(0.7071068, 0.0, 0.7071068);
+	const Double3 diag2RightNormal(-0.7071068, 0.0, -0.7071068);
+	const Double2 diag1LeftNormal2D(diag1LeftNormal.x, diag1LeftNormal.z);
+	const Double2 diag2LeftNormal2D(diag2LeftNormal.x, diag2LeftNormal.z);
+
+	for (int i = 0; i < rayCount; i++)
+	{
+		const Double2 &nearPoint = nearPoints[i];
+		const Double2 &farPoint = farPoints[i];
+		ColumnIntersections &intersections = outIntersections[i];
+
+		// An intersection occurs if the near and far points are on different sides of the
+		// diagonal, or if the near point lies on it.
+		const Double2 nearOffset = nearPoint - diagMiddle;
+		const Double2 farOffset = farPoint - diagMiddle;
+		const bool nearOnLeft1 = diag1LeftNormal2D.dot(nearOffset) >= 0.0;
+		const bool farOnLeft1 = diag1LeftNormal2D.dot(farOffset) >= 0.0;
+		const bool nearOnLeft2 = diag2LeftNormal2D.dot(nearOffset) >= 0.0;
+		const bool farOnLeft2 = diag2LeftNormal2D.dot(farOffset) >= 0.0;
+
+		// Change in X and change in Z of the incoming ray across the voxel. The X axis is
+		// treated as the vertical axis and the Z axis as the horizontal axis.
+		const double dx = farPoint.x - nearPoint.x;
+		const double dz = farPoint.y - nearPoint.y;
+		const bool isHorizontal = std::abs(dx) < Constants::Epsilon;
+		const bool isVertical = std::abs(dz) < Constants::Epsilon;
+		const double raySlope = dx / dz;
+		const double rayXIntercept = nearPoint.x - (raySlope * nearPoint.y);
+
+		// Hit coordinates along each diagonal, from the X intercept, the Z intercept, or the
+		// general line intersection.
+		const double diag1Coordinate = isHorizontal ? (nearPoint.x - voxelXReal) :
+			(isVertical ? (nearPoint.y - voxelZReal) :
+			(((rayXIntercept - diag1XIntercept) / (1.0 - raySlope)) - voxelZReal));
+		const double diag2Coordinate = isHorizontal ?
+			(Constants::JustBelowOne - (nearPoint.x - diag2StartX)) :
+			(isVertical ? (Constants::JustBelowOne - (nearPoint.y - voxelZReal)) :
+			(((rayXIntercept - diag2XIntercept) / (-1.0 - raySlope)) - voxelZReal));
+
+		RayHit &diag1Hit = intersections.diag1Hit;
+		diag1Hit.u = std::clamp(diag1Coordinate, 0.0, Constants::JustBelowOne);
+		diag1Hit.point = Double2(voxelXReal + diag1Hit.u, voxelZReal + diag1Hit.u);
+		diag1Hit.innerZ = (diag1Hit.point - nearPoint).length();
+		diag1Hit.normal = nearOnLeft1 ? diag1LeftNormal : diag1RightNormal;
+		intersections.diag1Success = nearOnLeft1 != farOnLeft1;
+
+		RayHit &diag2Hit = intersections.diag2Hit;
+		diag2Hit.u = std::clamp(diag2Coordinate, 0.0, Constants::JustBelowOne);
+		diag2Hit.point = Double2(
+			voxelXReal + (Constants::JustBelowOne - diag2Hit.u),
+			voxelZReal + diag2Hit.u);
+		diag2Hit.innerZ = (diag2Hit.point - nearPoint).length();
+		diag2Hit.normal = nearOnLeft2 ? diag2LeftNormal : diag2RightNormal;
+		intersections.diag2Success = nearOnLeft2 != farOnLeft2;
+	}
+}
+
+void SoftwareRenderer::findFarFacings(int voxelX, int voxelZ, int rayCount,
+	const VoxelData::Facing *nearFacings, const Double2 *farPoints, const Camera &camera,
+	const double *rayAngles, ColumnIntersections *outIntersections)
+{
+	// The corner angles only depend on the voxel, so the rays share them.
+	VoxelCornerAngles cornerAngles;
+	cornerAngles.init(voxelX, voxelZ, Double2(camera.eye.x, camera.eye.z));
+
+	for (int i = 0; i < rayCount; i++)
+	{
+		const Double2 &farPoint = farPoints[i];
+		ColumnIntersections &intersections = outIntersections[i];
+		const VoxelData::Facing farFacing = SoftwareRenderer::getChasmFarFacing(voxelX, voxelZ,
+			nearFacings[i], camera, rayAngles[i], cornerAngles);
+
+		// Texture coordinate along the far side, going the same way as a wall's.
+		const bool onXSide = (farFacing == VoxelData::Facing::PositiveX) ||
+			(farFacing == VoxelData::Facing::NegativeX);
+		const bool reversed = (farFacing == VoxelData::Facing::PositiveX) ||
+			(farFacing == VoxelData::Facing::NegativeZ);
+		const double fraction = onXSide ? (farPoint.y - std::floor(farPoint.y)) :
+			(farPoint.x - std::floor(farPoint.x));
+
+		intersections.farFacing = farFacing;
+		intersections.farU = reversed ? (Constants::JustBelowOne - fraction) : fraction;
+	}
+}
+
+void SoftwareRenderer::findSwingingDoorIntersections(int voxelX, int voxelZ, double percentOpen,
+	int rayCount, const VoxelData::Facing *nearFacings, const Double2 *nearPoints,
+	const Double2 *farPoints, ColumnIntersections *outIntersections)
+{
+	// The door's line only depends on the face the ray enters through, so it's found once
+	// per face that any of the rays enter through.
+	constexpr int facingCount = 4;
+	std::array<Double2, facingCount> pivots, doorVecs;
+	std::array<bool, facingCount> hasLine;
+	hasLine.fill(false);
+
+	// Vector cross product in 2D, returns a scalar.
+	auto cross = [](const Double2 &a, const Double2 &b)
+	{
+		return (a.x * b.y) - (b.x * a.y);
+	};
+
+	for (int i = 0; i < rayCount; i++)
+	{
+		const VoxelData::Facing nearFacing = nearFacings[i];
+		const int facingIndex = static_cast<int>(nearFacing);
+		if (!hasLine[facingIndex])
+		{
+			SoftwareRenderer::getSwingingDoorLine(voxelX, voxelZ, percentOpen, nearFacing,
+				&pivots[facingIndex], &doorVecs[facingIndex]);
+			hasLine[facingIndex] = true;
+		}
+
+		// Solve line segment intersection between the incoming ray and the door.
+		const Double2 &p1 = pivots[facingIndex];
+		const Double2 &v1 = doorVecs[facingIndex];
+		const Double2 &p2 = nearPoints[i];
+		const Double2 v2 = farPoints[i] - p2;
+
+		// Percent from p1 to (p1 + v1).
+		const double t = cross(p2 - p1, v2) / cross(v1, v2);
+		const Double2 norm2D = v1.rightPerp();
+
+		ColumnIntersections &intersections = outIntersections[i];
+		RayHit &hit = intersections.swingingDoorHit;
+		hit.point = p1 + (v1 * t);
+		hit.innerZ = (hit.point - p2).length();
+		hit.u = t;
+		hit.normal = Double3(norm2D.x, 0.0, norm2D.y);
+		intersections.swingingDoorSuccess = (t >= 0.0) && (t < 1.0);
+	}
+}
+
+void SoftwareRenderer::findColumnIntersections(const VoxelColumnView &column, int rayCount,
+	const VoxelData::Facing *nearFacings, const Double2 *nearPoints, const Double2 *farPoints,
+	const Camera &camera, const double *rayAngles, ColumnIntersections *outIntersections)
+{
+	if (column.hasDiagonal)
+	{
+		SoftwareRenderer::findDiagIntersections(column.voxelX, column.voxelZ, rayCount,
+			nearPoints, farPoints, outIntersections);
+	}
+
+	if (column.hasFarFacing)
+	{
+		SoftwareRenderer::findFarFacings(column.voxelX, column.voxelZ, rayCount, nearFacings,
+			farPoints, camera, rayAngles, outIntersections);
+	}
+
+	if (column.hasSwingingDoor)
+	{
+		SoftwareRenderer::findSwingingDoorIntersections(column.voxelX, column.voxelZ,
+			column.doorPercentOpen, rayCount, nearFacings, nearPoints, farPoints,
+			outIntersections);
+	}
+}
+
+template <bool FogEnabled>
+uint32_t SoftwareRenderer::getShadedVoxelTexelColor(const VoxelTexel &texel,
+	const Double3 &shading, const ShadingInfo::FogSample &fogSample)
+{
+	// Texture color with shading.
+	const double shadingMax = 1.0;
+	const double texelEmission = texel.getEmission();
+	double colorR = SoftwareRenderer::TEXEL_CHANNEL_TO_DOUBLE[texel.r] *
+		std::min(shading.x + texelEmission, shadingMax);
+	double colorG = SoftwareRenderer::TEXEL_CHANNEL_TO_DOUBLE[texel.g] *
+		std::min(shading.y + texelEmission, shadingMax);
+	double colorB = SoftwareRenderer::TEXEL_CHANNEL_TO_DOUBLE[texel.b] *
+		std::min(shading.z + texelEmission, shadingMax);
+
+	// Linearly interpolate with fog.
+	if constexpr (FogEnabled)
+	{
+		colorR = (colorR * fogSample.colorPercent) + fogSample.fogColor.x;
+		colorG = (colorG * fogSample.colorPercent) + fogSample.fogColor.y;
+		colorB = (colorB * fogSample.colorPercent) + fogSample.fogColor.z;
+	}
+
+	// Clamp maximum (don't worry about negative values).
+	const double high = 1.0;
+	colorR = (colorR > high) ? high : colorR;
+	colorG = (colorG > high) ? high : colorG;
+	colorB = (colorB > high) ? high : colorB;
+
+	// Convert floats to integers.
+	return static_cast<uint32_t>(
+		((static_cast<uint8_t>(colorR * 255.0)) << 16) |
+		((static_cast<uint8_t>(colorG * 255.0)) << 8) |
+		((static_cast<uint8_t>(colorB * 255.0))));
+}
+
+uint64_t SoftwareRenderer::shadeVoxelTexelColumn(const VoxelTexel *columnTexels, int startY,
+	int endY, const Double3 &shading, const ShadingInfo &shadingInfo,
+	const ShadingInfo::FogSample &fogSample, uint32_t *texelColors)
+{
+	static_assert(sizeof(VoxelTexel) == 4, "Span kernel expects 4-byte texels.");
+	static_assert(offsetof(VoxelTexel, flags) == 3, "Span kernel expects flags last.");
+
+	if (startY >= endY)
+	{
+		return 0;
+	}
+
+	const double shadingMax = 1.0;
+	VoxelTexelSpanShading spanShading;
+	spanShading.multipliers = { std::min(shading.z, shadingMax), std::min(shading.y, shadingMax),
+		std::min(shading.x, shadingMax), 0.0 };
+	spanShading.emissiveMultipliers = { std::min(shading.z + 1.0, shadingMax),
+		std::min(shading.y + 1.0, shadingMax), std::min(shading.x + 1.0, shadingMax), 0.0 };
+
+	if (shadingInfo.fogEnabled)
+	{
+		spanShading.fogColor = { fogSample.fogColor.z, fogSample.fogColor.y,
+			fogSample.fogColor.x, 0.0 };
+		spanShading.colorPercent = fogSample.colorPercent;
+	}
+	else
+	{
+		spanShading.fogColor = { 0.0, 0.0, 0.0, 0.0 };
+		spanShading.colorPercent = 1.0;
+	}
+
+	spanShading.emissiveFlag = VoxelTexel::FLAG_EMISSIVE;
+
+	const int count = endY - startY;
+	ShadeVoxelTexelSpanKernel.get()(reinterpret_cast<const uint8_t*>(columnTexels + startY),
+		count, spanShading, texelColors + startY);
+
+	const uint64_t countBits = (count == 64) ? ~static_cast<uint64_t>(0) :
+		((static_cast<uint64_t>(1) << count) - 1);
+	return countBits << startY;
+}
+
 void SoftwareRenderer::drawPixels(int x, const DrawRange &drawRange, double depth, double u,
-	double vStart, double vEnd, const Double3 &normal, const VoxelTexture &texture,
-	const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame)
+	double vStart, double vEnd, const Double3 &normal, const Double3 &lightColor,
+	const VoxelTexture &texture, const ShadingInfo &shadingInfo, OcclusionData &occlusion,
+	const FrameView &frame)
 {
 	// Draw range values.
 	const double yProjStart = drawRange.yProjStart;
@@ -3033,12 +5975,30 @@ void SoftwareRenderer::drawPixels(int x, const DrawRange &drawRange, double dept
 	int yStart = drawRange.yStart;
 	int yEnd = drawRange.yEnd;
 
-	// Horizontal offset in texture.
-	const int textureX = static_cast<int>(u * static_cast<double>(VoxelTexture::WIDTH));
+	// Mip level from how many texels each pixel of the column covers.
+	const int mipLevel = VoxelTexture::getMipLevel(((vEnd - vStart) *
+		static_cast<double>(VoxelTexture::HEIGHT)) / (yProjEnd - yProjStart));
+	const int mipWidth = VoxelTexture::WIDTH >> mipLevel;
+	const int mipHeight = VoxelTexture::HEIGHT >> mipLevel;
+
+	// Horizontal offset in texture. Texels are column-major, so the column is contiguous.
+	const int textureX = static_cast<int>(u * static_cast<double>(mipWidth));
+	const int columnOffset = VoxelTexture::getMipOffset(mipLevel) +
+		VoxelTexture::getTexelIndex(textureX, 0, mipHeight);
+	const VoxelTexel *columnTexels =
+		texture.getTexels(shadingInfo.nightLightsActive) + columnOffset;
+	const uint8_t *columnPaletteIndices =
+		texture.getPaletteIndices(shadingInfo.nightLightsActive) + columnOffset;
+
+	// Depth as stored in the depth buffer. The comparison is done at the same precision so
+	// equal depths always compare the same way. A pixel has to be nearer by a margin relative
+	// to the stored depth, since a fixed margin is below a float's precision past a few
+	// hundred units and coplanar columns would fight there.
+	const float depthValue = static_cast<float>(depth);
+	const float depthScale = 1.0f - static_cast<float>(Constants::Epsilon);
 
 	// Linearly interpolated fog.
-	const Double3 &fogColor = shadingInfo.getFogColor();
-	const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+	const ShadingInfo::FogSample &fogSample = shadingInfo.getFogSample(depth);
 
 	// Contribution from the sun.
 	const double lightNormalDot = std::max(0.0, shadingInfo.sunDirection.dot(normal));
@@ -3046,73 +6006,110 @@ void SoftwareRenderer::drawPixels(int x, const DrawRange &drawRange, double dept
 		0.0, 1.0 - shadingInfo.ambient);
 
 	// Shading on the texture.
-	// - @todo: contribution from lights.
 	const Double3 shading(
-		shadingInfo.ambient + sunComponent.x,
-		shadingInfo.ambient + sunComponent.y,
-		shadingInfo.ambient + sunComponent.z);
+		shadingInfo.ambient + sunComponent.x + lightColor.x,
+		shadingInfo.ambient + sunComponent.y + lightColor.y,
+		shadingInfo.ambient + sunComponent.z + lightColor.z);
 
 	// Clip the Y start and end coordinates as needed, and refresh the occlusion buffer.
 	occlusion.clipRange(&yStart, &yEnd);
 	occlusion.update(yStart, yEnd);
 
+	// Light and fog levels for palette mode.
+	const double lightPercent = std::max({ shading.x, shading.y, shading.z });
+	const double fogPercent = shadingInfo.fogEnabled ? (1.0 - fogSample.colorPercent) : 0.0;
+
+	// Shading and fog are constant down the column and only one texture column is sampled,
+	// so each texel's final color is computed the first time it's hit and reused after that.
+	// In palette mode, the cached values are index buffer values instead.
+	static_assert(VoxelTexture::HEIGHT <= 64, "Texel color cache mask is too small.");
+	std::array<uint32_t, VoxelTexture::HEIGHT> texelColors;
+	uint64_t texelColorsMask = 0;
+
+	// Values for interpolating down the column at pixel precision.
+	const PixelReal yProjStartReal = static_cast<PixelReal>(yProjStart);
+	const PixelReal yProjRange = static_cast<PixelReal>(yProjEnd - yProjStart);
+	const PixelReal vStartReal = static_cast<PixelReal>(vStart);
+	const PixelReal vRange = static_cast<PixelReal>(vEnd - vStart);
+	const PixelReal mipHeightReal = static_cast<PixelReal>(mipHeight);
+
+	// Y position in texture of a pixel in the column.
+	auto getTextureY = [yProjStartReal, yProjRange, vStartReal, vRange, mipHeightReal,
+		mipHeight](int y)
+	{
+		// Percent stepped from beginning to end on the column.
+		const PixelReal yPercent = ((static_cast<PixelReal>(y) +
+			SoftwareRenderer::PIXEL_CENTER) - yProjStartReal) / yProjRange;
+
+		// Vertical texture coordinate.
+		const PixelReal v = vStartReal + (vRange * yPercent);
+		return std::min(static_cast<int>(v * mipHeightReal), mipHeight - 1);
+	};
+
+	// In true color mode, the texture rows between the column's ends are shaded together
+	// up front. Any other rows are still shaded when they're first hit.
+	if ((frame.indexBuffer == nullptr) && (yStart < yEnd))
+	{
+		const int firstTextureY = getTextureY(yStart);
+		const int lastTextureY = getTextureY(yEnd - 1);
+		texelColorsMask = SoftwareRenderer::shadeVoxelTexelColumn(columnTexels,
+			std::max(std::min(firstTextureY, lastTextureY), 0),
+			std::max(firstTextureY, lastTextureY) + 1, shading, shadingInfo, fogSample,
+			texelColors.data());
+	}
+
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = y + (x * frame.height);
 
 		// Check depth of the pixel before rendering.
 		// - @todo: implement occlusion culling and back-to-front transparent rendering so
 		//   this depth check isn't needed.
-		if (depth <= (frame.depthBuffer[index] - Constants::Epsilon))
+		if (depthValue <= (frame.depthBuffer[index] * depthScale))
 		{
-			// Percent stepped from beginning to end on the column.
-			const double yPercent = 
-				((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
-
-			// Vertical texture coordinate.
-			const double v = vStart + ((vEnd - vStart) * yPercent);
-
-			// Y position in texture.
-			const int textureY = static_cast<int>(v * static_cast<double>(VoxelTexture::HEIGHT));
+			const int textureY = getTextureY(y);
 
 			// Alpha is ignored in this loop, so transparent texels will appear black.
-			const int textureIndex = textureX + (textureY * VoxelTexture::WIDTH);
-			const VoxelTexel &texel = texture.texels[textureIndex];
-
-			// Texture color with shading.
-			const double shadingMax = 1.0;
-			double colorR = texel.r * std::min(shading.x + texel.emission, shadingMax);
-			double colorG = texel.g * std::min(shading.y + texel.emission, shadingMax);
-			double colorB = texel.b * std::min(shading.z + texel.emission, shadingMax);
-
-			// Linearly interpolate with fog.
-			colorR += (fogColor.x - colorR) * fogPercent;
-			colorG += (fogColor.y - colorG) * fogPercent;
-			colorB += (fogColor.z - colorB) * fogPercent;
+			const uint64_t texelBit = static_cast<uint64_t>(1) << textureY;
+			if ((texelColorsMask & texelBit) == 0)
+			{
+				const VoxelTexel &texel = columnTexels[textureY];
+				if (frame.indexBuffer != nullptr)
+				{
+					texelColors[textureY] = ShadeTable::getIndexValue(
+						columnPaletteIndices[textureY], lightPercent + texel.getEmission(),
+						fogPercent);
+				}
+				else
+				{
+					texelColors[textureY] = shadingInfo.fogEnabled ?
+						SoftwareRenderer::getShadedVoxelTexelColor<true>(texel, shading, fogSample) :
+						SoftwareRenderer::getShadedVoxelTexelColor<false>(texel, shading, fogSample);
+				}
 
-			// Clamp maximum (don't worry about negative values).
-			const double high = 1.0;
-			colorR = (colorR > high) ? high : colorR;
-			colorG = (colorG > high) ? high : colorG;
-			colorB = (colorB > high) ? high : colorB;
+				texelColorsMask |= texelBit;
+			}
 
-			// Convert floats to integers.
-			const uint32_t colorRGB = static_cast<uint32_t>(
-				((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-				((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-				((static_cast<uint8_t>(colorB * 255.0))));
+			if (frame.indexBuffer != nullptr)
+			{
+				frame.indexBuffer[index] = static_cast<uint16_t>(texelColors[textureY]);
+			}
+			else
+			{
+				frame.colorBuffer[index] = texelColors[textureY];
+			}
 
-			frame.colorBuffer[index] = colorRGB;
-			frame.depthBuffer[index] = depth;
+			frame.depthBuffer[index] = depthValue;
 		}
 	}
 }
 
+template <bool FogEnabled>
 void SoftwareRenderer::drawPerspectivePixels(int x, const DrawRange &drawRange,
 	const Double2 &startPoint, const Double2 &endPoint, double depthStart, double depthEnd,
-	const Double3 &normal, const VoxelTexture &texture, const ShadingInfo &shadingInfo,
-	OcclusionData &occlusion, const FrameView &frame)
+	const Double3 &normal, const Double3 &lightColor, const VoxelTexture &texture,
+	const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame)
 {
 	// Draw range values.
 	const double yProjStart = drawRange.yProjStart;
@@ -3120,20 +6117,16 @@ void SoftwareRenderer::drawPerspectivePixels(int x, const DrawRange &drawRange,
 	int yStart = drawRange.yStart;
 	int yEnd = drawRange.yEnd;
 
-	// Fog color to interpolate with.
-	const Double3 &fogColor = shadingInfo.getFogColor();
-
 	// Contribution from the sun.
 	const double lightNormalDot = std::max(0.0, shadingInfo.sunDirection.dot(normal));
 	const Double3 sunComponent = (shadingInfo.sunColor * lightNormalDot).clamped(
 		0.0, 1.0 - shadingInfo.ambient);
 
 	// Shading on the texture.
-	// - @todo: contribution from lights.
 	const Double3 shading(
-		shadingInfo.ambient + sunComponent.x,
-		shadingInfo.ambient + sunComponent.y,
-		shadingInfo.ambient + sunComponent.z);
+		shadingInfo.ambient + sunComponent.x + lightColor.x,
+		shadingInfo.ambient + sunComponent.y + lightColor.y,
+		shadingInfo.ambient + sunComponent.z + lightColor.z);
 
 	// Values for perspective-correct interpolation.
 	const double depthStartRecip = 1.0 / depthStart;
@@ -3141,84 +6134,164 @@ void SoftwareRenderer::drawPerspectivePixels(int x, const DrawRange &drawRange,
 	const Double2 startPointDiv = startPoint * depthStartRecip;
 	const Double2 endPointDiv = endPoint * depthEndRecip;
 	const Double2 pointDivDiff = endPointDiv - startPointDiv;
+
+	// Mip level from how many texels each pixel covers on average, using the distance
+	// stepped across the texture (one voxel wide) from the start to the end of the column.
+	const int mipLevel = VoxelTexture::getMipLevel(((endPoint - startPoint).length() *
+		static_cast<double>(VoxelTexture::WIDTH)) / std::abs(yProjEnd - yProjStart));
+	const int mipWidth = VoxelTexture::WIDTH >> mipLevel;
+	const int mipHeight = VoxelTexture::HEIGHT >> mipLevel;
+	const int mipOffset = VoxelTexture::getMipOffset(mipLevel);
+	const VoxelTexel *mipTexels = texture.getTexels(shadingInfo.nightLightsActive) + mipOffset;
+	const uint8_t *mipPaletteIndices =
+		texture.getPaletteIndices(shadingInfo.nightLightsActive) + mipOffset;
+
+	// Light level for palette mode.
+	const double lightPercent = std::max({ shading.x, shading.y, shading.z });
+
+	// Pixels at the last fog sample are solid fog color whatever the texel is, so they don't
+	// need to be sampled. This is where the column reaches past the fog distance.
+	const ShadingInfo::FogSample &fullFogSample = shadingInfo.fogSamples.back();
+	const uint32_t fullFogValue = (frame.indexBuffer != nullptr) ?
+		ShadeTable::getIndexValue(0, 0.0, 1.0) :
+		SoftwareRenderer::getShadedVoxelTexelColor<true>(mipTexels[0], shading, fullFogSample);
 	
 	// Clip the Y start and end coordinates as needed, and refresh the occlusion buffer.
 	occlusion.clipRange(&yStart, &yEnd);
 	occlusion.update(yStart, yEnd);
 
+	// Values for interpolating down the column at pixel precision.
+	const PixelReal yProjStartReal = static_cast<PixelReal>(yProjStart);
+	const PixelReal yProjRange = static_cast<PixelReal>(yProjEnd - yProjStart);
+	const PixelReal depthStartRecipReal = static_cast<PixelReal>(depthStartRecip);
+	const PixelReal depthRecipRange = static_cast<PixelReal>(depthEndRecip - depthStartRecip);
+	const PixelReal startPointDivX = static_cast<PixelReal>(startPointDiv.x);
+	const PixelReal startPointDivY = static_cast<PixelReal>(startPointDiv.y);
+	const PixelReal pointDivDiffX = static_cast<PixelReal>(pointDivDiff.x);
+	const PixelReal pointDivDiffY = static_cast<PixelReal>(pointDivDiff.y);
+	const PixelReal mipWidthReal = static_cast<PixelReal>(mipWidth);
+	const PixelReal mipHeightReal = static_cast<PixelReal>(mipHeight);
+	const PixelReal zero = static_cast<PixelReal>(0.0);
+	const PixelReal justBelowOne = SoftwareRenderer::PIXEL_JUST_BELOW_ONE;
+
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = y + (x * frame.height);
 
 		// Percent stepped from beginning to end on the column.
-		const double yPercent = 
-			((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
+		const PixelReal yPercent = ((static_cast<PixelReal>(y) +
+			SoftwareRenderer::PIXEL_CENTER) - yProjStartReal) / yProjRange;
 
 		// Interpolate between the near and far depth.
-		const double depth = 1.0 / 
-			(depthStartRecip + ((depthEndRecip - depthStartRecip) * yPercent));
+		const PixelReal depth = static_cast<PixelReal>(1.0) /
+			(depthStartRecipReal + (depthRecipRange * yPercent));
 
 		// Check depth of the pixel before rendering.
 		// - @todo: implement occlusion culling and back-to-front transparent rendering so
 		//   this depth check isn't needed.
-		if (depth <= frame.depthBuffer[index])
+		const float depthValue = static_cast<float>(depth);
+		if (depthValue <= frame.depthBuffer[index])
 		{
 			// Linearly interpolated fog.
-			const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+			const ShadingInfo::FogSample &fogSample = FogEnabled ?
+				shadingInfo.getFogSample(depth) : shadingInfo.fogSamples.front();
+
+			if (FogEnabled && (&fogSample == &fullFogSample))
+			{
+				if (frame.indexBuffer != nullptr)
+				{
+					frame.indexBuffer[index] = static_cast<uint16_t>(fullFogValue);
+				}
+				else
+				{
+					frame.colorBuffer[index] = fullFogValue;
+				}
+
+				frame.depthBuffer[index] = depthValue;
+				continue;
+			}
 
 			// Interpolate between start and end points.
-			const double currentPointX = (startPointDiv.x + (pointDivDiff.x * yPercent)) * depth;
-			const double currentPointY = (startPointDiv.y + (pointDivDiff.y * yPercent)) * depth;
+			const PixelReal currentPointX = (startPointDivX + (pointDivDiffX * yPercent)) * depth;
+			const PixelReal currentPointY = (startPointDivY + (pointDivDiffY * yPercent)) * depth;
 
 			// Texture coordinates.
-			const double u = std::clamp(
-				Constants::JustBelowOne - (currentPointX - std::floor(currentPointX)),
-				0.0, Constants::JustBelowOne);
-			const double v = std::clamp(
-				Constants::JustBelowOne - (currentPointY - std::floor(currentPointY)),
-				0.0, Constants::JustBelowOne);
+			const PixelReal u = std::clamp(
+				justBelowOne - (currentPointX - std::floor(currentPointX)), zero, justBelowOne);
+			const PixelReal v = std::clamp(
+				justBelowOne - (currentPointY - std::floor(currentPointY)), zero, justBelowOne);
 
 			// Offsets in texture.
-			const int textureX = static_cast<int>(u * static_cast<double>(VoxelTexture::WIDTH));
-			const int textureY = static_cast<int>(v * static_cast<double>(VoxelTexture::HEIGHT));
+			const int textureX = static_cast<int>(u * mipWidthReal);
+			const int textureY = static_cast<int>(v * mipHeightReal);
 
 			// Alpha is ignored in this loop, so transparent texels will appear black.
-			const int textureIndex = textureX + (textureY * VoxelTexture::WIDTH);
-			const VoxelTexel &texel = texture.texels[textureIndex];
+			const int textureIndex = VoxelTexture::getTexelIndex(textureX, textureY, mipHeight);
+			const VoxelTexel &texel = mipTexels[textureIndex];
 
-			// Texture color with shading.
-			const double shadingMax = 1.0;
-			double colorR = texel.r * std::min(shading.x + texel.emission, shadingMax);
-			double colorG = texel.g * std::min(shading.y + texel.emission, shadingMax);
-			double colorB = texel.b * std::min(shading.z + texel.emission, shadingMax);
-
-			// Linearly interpolate with fog.
-			colorR += (fogColor.x - colorR) * fogPercent;
-			colorG += (fogColor.y - colorG) * fogPercent;
-			colorB += (fogColor.z - colorB) * fogPercent;
+			if (frame.indexBuffer != nullptr)
+			{
+				const double fogPercent = FogEnabled ? (1.0 - fogSample.colorPercent) : 0.0;
+				frame.indexBuffer[index] = ShadeTable::getIndexValue(
+					mipPaletteIndices[textureIndex], lightPercent + texel.getEmission(),
+					fogPercent);
+			}
+			else
+			{
+				frame.colorBuffer[index] = SoftwareRenderer::getShadedVoxelTexelColor<FogEnabled>(
+					texel, shading, fogSample);
+			}
 
-			// Clamp maximum (don't worry about negative values).
-			const double high = 1.0;
-			colorR = (colorR > high) ? high : colorR;
-			colorG = (colorG > high) ? high : colorG;
-			colorB = (colorB > high) ? high : colorB;
+			frame.depthBuffer[index] = depthValue;
+		}
+	}
+}
 
-			// Convert floats to integers.
-			const uint32_t colorRGB = static_cast<uint32_t>(
-				((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-				((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-				((static_cast<uint8_t>(colorB * 255.0))));
+void SoftwareRenderer::drawPerspectivePixels(int x, const DrawRange &drawRange,
+	const Double2 &startPoint, const Double2 &endPoint, double depthStart, double depthEnd,
+	const Double3 &normal, const Double3 &lightColor, const VoxelTexture &texture,
+	const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame)
+{
+	if (shadingInfo.fogEnabled)
+	{
+		SoftwareRenderer::drawPerspectivePixels<true>(x, drawRange, startPoint, endPoint,
+			depthStart, depthEnd, normal, lightColor, texture, shadingInfo, occlusion, frame);
+	}
+	else
+	{
+		SoftwareRenderer::drawPerspectivePixels<false>(x, drawRange, startPoint, endPoint,
+			depthStart, depthEnd, normal, lightColor, texture, shadingInfo, occlusion, frame);
+	}
+}
 
-			frame.colorBuffer[index] = colorRGB;
-			frame.depthBuffer[index] = depth;
-		}
+void SoftwareRenderer::drawPlanePixels(int x, int voxelY, const DrawRange &drawRange,
+	const Double2 &startPoint, const Double2 &endPoint, double depthStart, double depthEnd,
+	const Double3 &normal, const Double3 &lightColor, const VoxelTexture &texture,
+	const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame)
+{
+	const bool isScanlineLayer = (normal.y > 0.0) ?
+		(voxelY == SoftwareRenderer::SCANLINE_FLOOR_Y) :
+		(voxelY == SoftwareRenderer::SCANLINE_CEILING_Y);
+
+	if (shadingInfo.scanlinePlanes && isScanlineLayer)
+	{
+		int yStart = drawRange.yStart;
+		int yEnd = drawRange.yEnd;
+		occlusion.clipRange(&yStart, &yEnd);
+		occlusion.update(yStart, yEnd);
+	}
+	else
+	{
+		SoftwareRenderer::drawPerspectivePixels(x, drawRange, startPoint, endPoint,
+			depthStart, depthEnd, normal, lightColor, texture, shadingInfo, occlusion, frame);
 	}
 }
 
 void SoftwareRenderer::drawTransparentPixels(int x, const DrawRange &drawRange, double depth,
-	double u, double vStart, double vEnd, const Double3 &normal, const VoxelTexture &texture,
-	const ShadingInfo &shadingInfo, const OcclusionData &occlusion, const FrameView &frame)
+	double u, double vStart, double vEnd, const Double3 &normal, const Double3 &lightColor,
+	const VoxelTexture &texture, const ShadingInfo &shadingInfo, const OcclusionData &occlusion,
+	const FrameView &frame)
 {
 	// Draw range values.
 	const double yProjStart = drawRange.yProjStart;
@@ -3226,12 +6299,30 @@ void SoftwareRenderer::drawTransparentPixels(int x, const DrawRange &drawRange,
 	int yStart = drawRange.yStart;
 	int yEnd = drawRange.yEnd;
 
-	// Horizontal offset in texture.
-	const int textureX = static_cast<int>(u * static_cast<double>(VoxelTexture::WIDTH));
+	// Mip level from how many texels each pixel of the column covers.
+	const int mipLevel = VoxelTexture::getMipLevel(((vEnd - vStart) *
+		static_cast<double>(VoxelTexture::HEIGHT)) / (yProjEnd - yProjStart));
+	const int mipWidth = VoxelTexture::WIDTH >> mipLevel;
+	const int mipHeight = VoxelTexture::HEIGHT >> mipLevel;
+
+	// Horizontal offset in texture. Texels are column-major, so the column is contiguous.
+	const int textureX = static_cast<int>(u * static_cast<double>(mipWidth));
+	const int columnOffset = VoxelTexture::getMipOffset(mipLevel) +
+		VoxelTexture::getTexelIndex(textureX, 0, mipHeight);
+	const VoxelTexel *columnTexels =
+		texture.getTexels(shadingInfo.nightLightsActive) + columnOffset;
+	const uint8_t *columnPaletteIndices =
+		texture.getPaletteIndices(shadingInfo.nightLightsActive) + columnOffset;
+
+	// Depth as stored in the depth buffer. The comparison is done at the same precision so
+	// equal depths always compare the same way. A pixel has to be nearer by a margin relative
+	// to the stored depth, since a fixed margin is below a float's precision past a few
+	// hundred units and coplanar columns would fight there.
+	const float depthValue = static_cast<float>(depth);
+	const float depthScale = 1.0f - static_cast<float>(Constants::Epsilon);
 
 	// Linearly interpolated fog.
-	const Double3 &fogColor = shadingInfo.getFogColor();
-	const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+	const ShadingInfo::FogSample &fogSample = shadingInfo.getFogSample(depth);
 
 	// Contribution from the sun.
 	const double lightNormalDot = std::max(0.0, shadingInfo.sunDirection.dot(normal));
@@ -3239,70 +6330,135 @@ void SoftwareRenderer::drawTransparentPixels(int x, const DrawRange &drawRange,
 		0.0, 1.0 - shadingInfo.ambient);
 
 	// Shading on the texture.
-	// - @todo: contribution from lights.
 	const Double3 shading(
-		shadingInfo.ambient + sunComponent.x,
-		shadingInfo.ambient + sunComponent.y,
-		shadingInfo.ambient + sunComponent.z);
+		shadingInfo.ambient + sunComponent.x + lightColor.x,
+		shadingInfo.ambient + sunComponent.y + lightColor.y,
+		shadingInfo.ambient + sunComponent.z + lightColor.z);
 
 	// Clip the Y start and end coordinates as needed, but do not refresh the occlusion buffer,
 	// because transparent ranges do not occlude as simply as opaque ranges.
 	occlusion.clipRange(&yStart, &yEnd);
 
+	// Light and fog levels for palette mode.
+	const double lightPercent = std::max({ shading.x, shading.y, shading.z });
+	const double fogPercent = shadingInfo.fogEnabled ? (1.0 - fogSample.colorPercent) : 0.0;
+
+	// Shading and fog are constant down the column, so each texel's final color (or index
+	// buffer value in palette mode) is cached the same way as in drawPixels().
+	static_assert(VoxelTexture::HEIGHT <= 64, "Texel color cache mask is too small.");
+	std::array<uint32_t, VoxelTexture::HEIGHT> texelColors;
+	uint64_t texelColorsMask = 0;
+
+	// Values for interpolating down the column at pixel precision.
+	const PixelReal yProjStartReal = static_cast<PixelReal>(yProjStart);
+	const PixelReal yProjRange = static_cast<PixelReal>(yProjEnd - yProjStart);
+	const PixelReal vStartReal = static_cast<PixelReal>(vStart);
+	const PixelReal vRange = static_cast<PixelReal>(vEnd - vStart);
+	const PixelReal mipHeightReal = static_cast<PixelReal>(mipHeight);
+
+	// Y position in texture of a pixel in the column.
+	auto getTextureY = [yProjStartReal, yProjRange, vStartReal, vRange, mipHeightReal,
+		mipHeight](int y)
+	{
+		// Percent stepped from beginning to end on the column.
+		const PixelReal yPercent = ((static_cast<PixelReal>(y) +
+			SoftwareRenderer::PIXEL_CENTER) - yProjStartReal) / yProjRange;
+
+		// Vertical texture coordinate.
+		const PixelReal v = vStartReal + (vRange * yPercent);
+		return std::min(static_cast<int>(v * mipHeightReal), mipHeight - 1);
+	};
+
+	// In true color mode, the texture rows between the column's ends are shaded together
+	// up front. Any other rows are still shaded when they're first hit.
+	if ((frame.indexBuffer == nullptr) && (yStart < yEnd))
+	{
+		const int firstTextureY = getTextureY(yStart);
+		const int lastTextureY = getTextureY(yEnd - 1);
+		texelColorsMask = SoftwareRenderer::shadeVoxelTexelColumn(columnTexels,
+			std::max(std::min(firstTextureY, lastTextureY), 0),
+			std::max(firstTextureY, lastTextureY) + 1, shading, shadingInfo, fogSample,
+			texelColors.data());
+	}
+
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = y + (x * frame.height);
 
 		// Check depth of the pixel before rendering.
-		if (depth <= (frame.depthBuffer[index] - Constants::Epsilon))
+		if (depthValue <= (frame.depthBuffer[index] * depthScale))
 		{
-			// Percent stepped from beginning to end on the column.
-			const double yPercent =
-				((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
-
-			// Vertical texture coordinate.
-			const double v = vStart + ((vEnd - vStart) * yPercent);
-
-			// Y position in texture.
-			const int textureY = static_cast<int>(v * static_cast<double>(VoxelTexture::HEIGHT));
+			const int textureY = getTextureY(y);
 
 			// Alpha is checked in this loop, and transparent texels are not drawn.
-			const int textureIndex = textureX + (textureY * VoxelTexture::WIDTH);
-			const VoxelTexel &texel = texture.texels[textureIndex];
+			const VoxelTexel &texel = columnTexels[textureY];
 			
-			if (!texel.transparent)
+			if (!texel.isTransparent())
 			{
-				// Texture color with shading.
-				const double shadingMax = 1.0;
-				double colorR = texel.r * std::min(shading.x + texel.emission, shadingMax);
-				double colorG = texel.g * std::min(shading.y + texel.emission, shadingMax);
-				double colorB = texel.b * std::min(shading.z + texel.emission, shadingMax);
-
-				// Linearly interpolate with fog.
-				colorR += (fogColor.x - colorR) * fogPercent;
-				colorG += (fogColor.y - colorG) * fogPercent;
-				colorB += (fogColor.z - colorB) * fogPercent;
-				
-				// Clamp maximum (don't worry about negative values).
-				const double high = 1.0;
-				colorR = (colorR > high) ? high : colorR;
-				colorG = (colorG > high) ? high : colorG;
-				colorB = (colorB > high) ? high : colorB;
+				const uint64_t texelBit = static_cast<uint64_t>(1) << textureY;
+				if ((texelColorsMask & texelBit) == 0)
+				{
+					if (frame.indexBuffer != nullptr)
+					{
+						texelColors[textureY] = ShadeTable::getIndexValue(
+							columnPaletteIndices[textureY], lightPercent + texel.getEmission(),
+							fogPercent);
+					}
+					else
+					{
+						texelColors[textureY] = shadingInfo.fogEnabled ?
+							SoftwareRenderer::getShadedVoxelTexelColor<true>(texel, shading, fogSample) :
+							SoftwareRenderer::getShadedVoxelTexelColor<false>(texel, shading, fogSample);
+					}
 
-				// Convert floats to integers.
-				const uint32_t colorRGB = static_cast<uint32_t>(
-					((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-					((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-					((static_cast<uint8_t>(colorB * 255.0))));
+					texelColorsMask |= texelBit;
+				}
 
-				frame.colorBuffer[index] = colorRGB;
-				frame.depthBuffer[index] = depth;
+				if (frame.indexBuffer != nullptr)
+				{
+					frame.indexBuffer[index] = static_cast<uint16_t>(texelColors[textureY]);
+				}
+				else
+				{
+					frame.colorBuffer[index] = texelColors[textureY];
+				}
+
+				frame.depthBuffer[index] = depthValue;
 			}
 		}
 	}
 }
 
+bool SoftwareRenderer::getDistantColumnRange(const DrawRange &drawRange, double vStart,
+	double vEnd, const SkyTexture &texture, int textureX, int *outYStart, int *outYEnd)
+{
+	const int opaqueStart = texture.columnOpaqueStarts[textureX];
+	const int opaqueEnd = texture.columnOpaqueEnds[textureX];
+	if (opaqueStart == opaqueEnd)
+	{
+		return false;
+	}
+
+	// Inverse of the vertical texture coordinate mapping in the pixel loops. The range is
+	// padded by a pixel on each side to absorb rounding, so the per-texel alpha check still
+	// decides the exact edges.
+	const double yProjStart = drawRange.yProjStart;
+	const double yProjEnd = drawRange.yProjEnd;
+	auto getScreenY = [&texture, vStart, vEnd, yProjStart, yProjEnd](int textureY)
+	{
+		const double v = static_cast<double>(textureY) / static_cast<double>(texture.height);
+		const double yPercent = (v - vStart) / (vEnd - vStart);
+		return (yProjStart + ((yProjEnd - yProjStart) * yPercent)) - 0.50;
+	};
+
+	const int yStart = static_cast<int>(std::floor(getScreenY(opaqueStart))) - 1;
+	const int yEnd = static_cast<int>(std::ceil(getScreenY(opaqueEnd))) + 1;
+	*outYStart = std::max(yStart, drawRange.yStart);
+	*outYEnd = std::min(yEnd, drawRange.yEnd);
+	return *outYStart < *outYEnd;
+}
+
 void SoftwareRenderer::drawDistantPixels(int x, const DrawRange &drawRange, double u,
 	double vStart, double vEnd, const SkyTexture &texture, bool emissive,
 	const ShadingInfo &shadingInfo, const FrameView &frame)
@@ -3310,11 +6466,17 @@ void SoftwareRenderer::drawDistantPixels(int x, const DrawRange &drawRange, doub
 	// Draw range values.
 	const double yProjStart = drawRange.yProjStart;
 	const double yProjEnd = drawRange.yProjEnd;
-	const int yStart = drawRange.yStart;
-	const int yEnd = drawRange.yEnd;
 
 	// Horizontal offset in texture.
 	const int textureX = static_cast<int>(u * static_cast<double>(texture.width));
+
+	// Only the part of the column that can have opaque texels is visited.
+	int yStart, yEnd;
+	if (!SoftwareRenderer::getDistantColumnRange(drawRange, vStart, vEnd, texture, textureX,
+		&yStart, &yEnd))
+	{
+		return;
+	}
 	
 	// Shading on the texture. Some distant objects are completely bright.
 	const double shading = emissive ? 1.0 : shadingInfo.distantAmbient;
@@ -3322,7 +6484,7 @@ void SoftwareRenderer::drawDistantPixels(int x, const DrawRange &drawRange, doub
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = y + (x * frame.height);
 
 		// Percent stepped from beginning to end on the column.
 		const double yPercent =
@@ -3368,12 +6530,18 @@ void SoftwareRenderer::drawMoonPixels(int x, const DrawRange &drawRange, double
 	// Draw range values.
 	const double yProjStart = drawRange.yProjStart;
 	const double yProjEnd = drawRange.yProjEnd;
-	const int yStart = drawRange.yStart;
-	const int yEnd = drawRange.yEnd;
 
 	// Horizontal offset in texture.
 	const int textureX = static_cast<int>(u * static_cast<double>(texture.width));
 
+	// Only the part of the column that can have opaque texels is visited.
+	int yStart, yEnd;
+	if (!SoftwareRenderer::getDistantColumnRange(drawRange, vStart, vEnd, texture, textureX,
+		&yStart, &yEnd))
+	{
+		return;
+	}
+
 	// The gradient color is used for "unlit" texels on the moon's texture.
 	constexpr double gradientPercent = 0.80;
 	const Double3 gradientColor = SoftwareRenderer::getSkyGradientRowColor(
@@ -3386,7 +6554,7 @@ void SoftwareRenderer::drawMoonPixels(int x, const DrawRange &drawRange, double
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = y + (x * frame.height);
 
 		// Percent stepped from beginning to end on the column.
 		const double yPercent =
@@ -3452,16 +6620,22 @@ void SoftwareRenderer::drawStarPixels(int x, const DrawRange &drawRange, double
 	// Draw range values.
 	const double yProjStart = drawRange.yProjStart;
 	const double yProjEnd = drawRange.yProjEnd;
-	const int yStart = drawRange.yStart;
-	const int yEnd = drawRange.yEnd;
 
 	// Horizontal offset in texture.
 	const int textureX = static_cast<int>(u * static_cast<double>(texture.width));
 
+	// Only the part of the column that can have opaque texels is visited.
+	int yStart, yEnd;
+	if (!SoftwareRenderer::getDistantColumnRange(drawRange, vStart, vEnd, texture, textureX,
+		&yStart, &yEnd))
+	{
+		return;
+	}
+
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = y + (x * frame.height);
 
 		// Percent stepped from beginning to end on the column.
 		const double yPercent =
@@ -3530,7 +6704,7 @@ void SoftwareRenderer::drawStarPixels(int x, const DrawRange &drawRange, double
 void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, const Camera &camera,
 	const Ray &ray, VoxelData::Facing facing, const Double2 &nearPoint, const Double2 &farPoint,
 	double nearZ, double farZ, const ShadingInfo &shadingInfo, double ceilingHeight,
-	const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid,
+	const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
 	const std::vector<VoxelTexture> &textures, OcclusionData &occlusion, const FrameView &frame)
 {
 	// This method handles some special cases such as drawing the back-faces of wall sides.
@@ -3570,16 +6744,29 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 	// this voxel column.
 	const Double3 wallNormal = -VoxelData::getNormal(facing);
 
-	auto drawInitialVoxel = [x, voxelX, voxelZ, &camera, &ray, &wallNormal, &nearPoint,
-		&farPoint, nearZ, farZ, wallU, &shadingInfo, ceilingHeight, &openDoors, &voxelGrid,
-		&textures, &occlusion, &frame](int voxelY)
+	// Lights that reach this voxel column, if any.
+	const std::vector<Double3> *bakedColumn = shadingInfo.getBakedVoxelColumn(voxelX, voxelZ);
+	const std::vector<const Light*> *columnLights =
+		shadingInfo.getVoxelColumnLights(voxelX, voxelZ);
+
+	auto drawInitialVoxel = [x, voxelX, voxelZ, &camera, &ray, facing, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, wallU, &shadingInfo, bakedColumn, columnLights,
+		ceilingHeight, &openDoors, &voxelGrid, &textures, &occlusion, &frame](int voxelY)
 	{
 		const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 		const double voxelHeight = ceilingHeight;
 		const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
-		if (voxelData.dataType == VoxelDataType::Wall)
+		// Light from point lights, sampled at the ray's hit point halfway up the voxel and
+		// shared by every face drawn for it.
+		const Double3 voxelLight = ShadingInfo::getVoxelLightColor(
+			Double3(farPoint.x, voxelYReal + (voxelHeight * 0.50), farPoint.y), voxelY, facing,
+			bakedColumn, columnLights);
+
+		switch (voxelData.dataType)
+		{
+		case VoxelDataType::Wall:
 		{
 			// Draw inner ceiling, wall, and floor.
 			const VoxelData::WallData &wallData = voxelData.wall;
@@ -3606,24 +6793,29 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 			// Ceiling.
 			SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), nearPoint, farPoint,
-				nearZ, farZ, -Double3::UnitY, textures.at(wallData.ceilingID), shadingInfo,
+				nearZ, farZ, -Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.ceilingID), shadingInfo,
 				occlusion, frame);
 
 			// Wall.
 			SoftwareRenderer::drawPixels(x, drawRanges.at(1), farZ, wallU, 0.0,
-				Constants::JustBelowOne, wallNormal, textures.at(wallData.sideID), shadingInfo,
+				Constants::JustBelowOne, wallNormal, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.sideID), shadingInfo,
 				occlusion, frame);
 
 			// Floor.
 			SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(2), farPoint, nearPoint,
-				farZ, nearZ, Double3::UnitY, textures.at(wallData.floorID), shadingInfo,
+				farZ, nearZ, Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.floorID), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Floor)
+		case VoxelDataType::Floor:
 		{
 			// Do nothing. Floors can only be seen from above.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Ceiling)
+		case VoxelDataType::Ceiling:
 		{
 			// Draw bottom of ceiling voxel if the camera is below it.
 			if (camera.eye.y < voxelYReal)
@@ -3642,12 +6834,14 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 				const auto drawRange = SoftwareRenderer::makeDrawRange(
 					nearFloorPoint, farFloorPoint, camera, frame);
 
-				SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint,
-					nearZ, farZ, -Double3::UnitY, textures.at(ceilingData.id), shadingInfo,
+				SoftwareRenderer::drawPlanePixels(x, voxelY, drawRange, nearPoint, farPoint,
+					nearZ, farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, ceilingData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Raised)
+		case VoxelDataType::Raised:
 		{
 			const VoxelData::RaisedData &raisedData = voxelData.raised;
 
@@ -3674,7 +6868,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRange, farPoint, nearPoint, farZ,
-					nearZ, Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 			}
 			else if (camera.eye.y < nearFloorPoint.y)
@@ -3690,7 +6885,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint, nearZ,
-					farZ, -Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
 			else
@@ -3711,21 +6907,25 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), nearPoint, farPoint,
-					nearZ, farZ, -Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					nearZ, farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(1), farZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(2), farPoint, nearPoint,
-					farZ, nearZ, Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					farZ, nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Diagonal)
+		case VoxelDataType::Diagonal:
 		{
 			const VoxelData::DiagonalData &diagData = voxelData.diagonal;
 
@@ -3750,15 +6950,18 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					diagTopPoint, diagBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawPixels(x, drawRange, nearZ + hit.innerZ, hit.u, 0.0,
-					Constants::JustBelowOne, hit.normal, textures.at(diagData.id), shadingInfo,
+					Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, diagData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::TransparentWall)
+		case VoxelDataType::TransparentWall:
 		{
 			// Do nothing. Transparent walls have no back-faces.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Edge)
+		case VoxelDataType::Edge:
 		{
 			const VoxelData::EdgeData &edgeData = voxelData.edge;
 
@@ -3783,15 +6986,24 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					edgeTopPoint, edgeBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ, hit.u,
-					0.0, Constants::JustBelowOne, hit.normal, textures.at(edgeData.id),
+					0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, edgeData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Chasm)
+		case VoxelDataType::Chasm:
 		{
 			// Render back-face.
 			const VoxelData::ChasmData &chasmData = voxelData.chasm;
 
+			// The faces come from the chasm's neighbors at load time, so there's nothing to
+			// find the intersected faces for if it has none.
+			if (!chasmData.hasVisibleFaces())
+			{
+				break;
+			}
+
 			// Find which far face on the chasm was intersected.
 			const VoxelData::Facing farFacing = SoftwareRenderer::getInitialChasmFarFacing(
 				voxelX, voxelZ, Double2(camera.eye.x, camera.eye.z), ray);
@@ -3843,11 +7055,13 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					farCeilingPoint, farFloorPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, farZ, farU, 0.0,
-					Constants::JustBelowOne, farNormal, textures.at(chasmData.id), shadingInfo,
+					Constants::JustBelowOne, farNormal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, chasmData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Door)
+		case VoxelDataType::Door:
 		{
 			const VoxelData::DoorData &doorData = voxelData.door;
 			const double percentOpen = SoftwareRenderer::getDoorPercentOpen(
@@ -3874,7 +7088,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Sliding)
@@ -3892,7 +7107,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Raising)
@@ -3918,7 +7134,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
 						hit.u, vStart, Constants::JustBelowOne, hit.normal,
-						textures.at(doorData.id), shadingInfo, occlusion, frame);
+						voxelLight, shadingInfo.getVoxelTexture(textures, doorData.id), shadingInfo,
+						occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Splitting)
 				{
@@ -3935,23 +7152,36 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 			}
+			break;
+		}
+		default:
+			break;
 		}
 	};
 
-	auto drawInitialVoxelBelow = [x, voxelX, voxelZ, &camera, &ray, &wallNormal, &nearPoint,
-		&farPoint, nearZ, farZ, wallU, &shadingInfo, ceilingHeight, &openDoors, &voxelGrid,
-		&textures, &occlusion, &frame](int voxelY)
+	auto drawInitialVoxelBelow = [x, voxelX, voxelZ, &camera, &ray, facing, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, wallU, &shadingInfo, bakedColumn, columnLights,
+		ceilingHeight, &openDoors, &voxelGrid, &textures, &occlusion, &frame](int voxelY)
 	{
 		const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 		const double voxelHeight = ceilingHeight;
 		const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
-		if (voxelData.dataType == VoxelDataType::Wall)
+		// Light from point lights, sampled at the ray's hit point halfway up the voxel and
+		// shared by every face drawn for it.
+		const Double3 voxelLight = ShadingInfo::getVoxelLightColor(
+			Double3(farPoint.x, voxelYReal + (voxelHeight * 0.50), farPoint.y), voxelY, facing,
+			bakedColumn, columnLights);
+
+		switch (voxelData.dataType)
+		{
+		case VoxelDataType::Wall:
 		{
 			const VoxelData::WallData &wallData = voxelData.wall;
 
@@ -3969,10 +7199,12 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 			// Ceiling.
 			SoftwareRenderer::drawPerspectivePixels(x, drawRange, farPoint, nearPoint, farZ,
-				nearZ, Double3::UnitY, textures.at(wallData.ceilingID), shadingInfo,
+				nearZ, Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.ceilingID), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Floor)
+		case VoxelDataType::Floor:
 		{
 			// Draw top of floor voxel.
 			const VoxelData::FloorData &floorData = voxelData.floor;
@@ -3990,15 +7222,18 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 				farCeilingPoint, nearCeilingPoint, camera, frame);
 
 			// Ceiling.
-			SoftwareRenderer::drawPerspectivePixels(x, drawRange, farPoint, nearPoint, farZ,
-				nearZ, Double3::UnitY, textures.at(floorData.id), shadingInfo,
+			SoftwareRenderer::drawPlanePixels(x, voxelY, drawRange, farPoint, nearPoint, farZ,
+				nearZ, Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, floorData.id), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Ceiling)
+		case VoxelDataType::Ceiling:
 		{
 			// Do nothing. Ceilings can only be seen from below.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Raised)
+		case VoxelDataType::Raised:
 		{
 			const VoxelData::RaisedData &raisedData = voxelData.raised;
 
@@ -4025,7 +7260,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRange, farPoint, nearPoint, farZ,
-					nearZ, Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 			}
 			else if (camera.eye.y < nearFloorPoint.y)
@@ -4041,7 +7277,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint, nearZ,
-					farZ, -Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
 			else
@@ -4062,21 +7299,25 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), nearPoint, farPoint,
-					nearZ, farZ, -Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					nearZ, farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(1), farZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(2), farPoint, nearPoint,
-					farZ, nearZ, Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					farZ, nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Diagonal)
+		case VoxelDataType::Diagonal:
 		{
 			const VoxelData::DiagonalData &diagData = voxelData.diagonal;
 
@@ -4101,15 +7342,18 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					diagTopPoint, diagBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawPixels(x, drawRange, nearZ + hit.innerZ, hit.u, 0.0,
-					Constants::JustBelowOne, hit.normal, textures.at(diagData.id), shadingInfo,
+					Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, diagData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::TransparentWall)
+		case VoxelDataType::TransparentWall:
 		{
 			// Do nothing. Transparent walls have no back-faces.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Edge)
+		case VoxelDataType::Edge:
 		{
 			const VoxelData::EdgeData &edgeData = voxelData.edge;
 
@@ -4134,15 +7378,24 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					edgeTopPoint, edgeBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ, hit.u,
-					0.0, Constants::JustBelowOne, hit.normal, textures.at(edgeData.id),
+					0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, edgeData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Chasm)
+		case VoxelDataType::Chasm:
 		{
 			// Render back-face.
 			const VoxelData::ChasmData &chasmData = voxelData.chasm;
 
+			// The faces come from the chasm's neighbors at load time, so there's nothing to
+			// find the intersected faces for if it has none.
+			if (!chasmData.hasVisibleFaces())
+			{
+				break;
+			}
+
 			// Find which far face on the chasm was intersected.
 			const VoxelData::Facing farFacing = SoftwareRenderer::getInitialChasmFarFacing(
 				voxelX, voxelZ, Double2(camera.eye.x, camera.eye.z), ray);
@@ -4194,11 +7447,13 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					farCeilingPoint, farFloorPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, farZ, farU, 0.0,
-					Constants::JustBelowOne, farNormal, textures.at(chasmData.id), shadingInfo,
+					Constants::JustBelowOne, farNormal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, chasmData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Door)
+		case VoxelDataType::Door:
 		{
 			const VoxelData::DoorData &doorData = voxelData.door;
 			const double percentOpen = SoftwareRenderer::getDoorPercentOpen(
@@ -4225,7 +7480,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Sliding)
@@ -4243,7 +7499,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Raising)
@@ -4269,7 +7526,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
 						hit.u, vStart, Constants::JustBelowOne, hit.normal,
-						textures.at(doorData.id), shadingInfo, occlusion, frame);
+						voxelLight, shadingInfo.getVoxelTexture(textures, doorData.id), shadingInfo,
+						occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Splitting)
 				{
@@ -4286,23 +7544,36 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 			}
+			break;
+		}
+		default:
+			break;
 		}
 	};
 
-	auto drawInitialVoxelAbove = [x, voxelX, voxelZ, &camera, &ray, &wallNormal, &nearPoint,
-		&farPoint, nearZ, farZ, wallU, &shadingInfo, ceilingHeight, &openDoors, &voxelGrid,
-		&textures, &occlusion, &frame](int voxelY)
+	auto drawInitialVoxelAbove = [x, voxelX, voxelZ, &camera, &ray, facing, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, wallU, &shadingInfo, bakedColumn, columnLights,
+		ceilingHeight, &openDoors, &voxelGrid, &textures, &occlusion, &frame](int voxelY)
 	{
 		const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
 		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
 		const double voxelHeight = ceilingHeight;
 		const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
-		if (voxelData.dataType == VoxelDataType::Wall)
+		// Light from point lights, sampled at the ray's hit point halfway up the voxel and
+		// shared by every face drawn for it.
+		const Double3 voxelLight = ShadingInfo::getVoxelLightColor(
+			Double3(farPoint.x, voxelYReal + (voxelHeight * 0.50), farPoint.y), voxelY, facing,
+			bakedColumn, columnLights);
+
+		switch (voxelData.dataType)
+		{
+		case VoxelDataType::Wall:
 		{
 			const VoxelData::WallData &wallData = voxelData.wall;
 
@@ -4320,14 +7591,17 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 			// Floor.
 			SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint, nearZ,
-				farZ, -Double3::UnitY, textures.at(wallData.floorID), shadingInfo,
+				farZ, -Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.floorID), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Floor)
+		case VoxelDataType::Floor:
 		{
 			// Do nothing. Floors can only be seen from above.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Ceiling)
+		case VoxelDataType::Ceiling:
 		{
 			// Draw bottom of ceiling voxel.
 			const VoxelData::CeilingData &ceilingData = voxelData.ceiling;
@@ -4344,11 +7618,13 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 			const auto drawRange = SoftwareRenderer::makeDrawRange(
 				nearFloorPoint, farFloorPoint, camera, frame);
 
-			SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint, nearZ,
-				farZ, -Double3::UnitY, textures.at(ceilingData.id), shadingInfo,
+			SoftwareRenderer::drawPlanePixels(x, voxelY, drawRange, nearPoint, farPoint, nearZ,
+				farZ, -Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, ceilingData.id), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Raised)
+		case VoxelDataType::Raised:
 		{
 			const VoxelData::RaisedData &raisedData = voxelData.raised;
 
@@ -4375,7 +7651,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRange, farPoint, nearPoint, farZ,
-					nearZ, Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 			}
 			else if (camera.eye.y < nearFloorPoint.y)
@@ -4391,7 +7668,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint, nearZ,
-					farZ, -Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
 			else
@@ -4412,21 +7690,25 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), nearPoint, farPoint,
-					nearZ, farZ, -Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					nearZ, farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(1), farZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(2), farPoint, nearPoint,
-					farZ, nearZ, Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					farZ, nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Diagonal)
+		case VoxelDataType::Diagonal:
 		{
 			const VoxelData::DiagonalData &diagData = voxelData.diagonal;
 
@@ -4451,15 +7733,18 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					diagTopPoint, diagBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawPixels(x, drawRange, nearZ + hit.innerZ, hit.u, 0.0,
-					Constants::JustBelowOne, hit.normal, textures.at(diagData.id), shadingInfo,
+					Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, diagData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::TransparentWall)
+		case VoxelDataType::TransparentWall:
 		{
 			// Do nothing. Transparent walls have no back-faces.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Edge)
+		case VoxelDataType::Edge:
 		{
 			const VoxelData::EdgeData &edgeData = voxelData.edge;
 
@@ -4484,15 +7769,18 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 					edgeTopPoint, edgeBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ, hit.u,
-					0.0, Constants::JustBelowOne, hit.normal, textures.at(edgeData.id),
+					0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, edgeData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Chasm)
+		case VoxelDataType::Chasm:
 		{
 			// Ignore. Chasms should never be above the player's voxel.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Door)
+		case VoxelDataType::Door:
 		{
 			const VoxelData::DoorData &doorData = voxelData.door;
 			const double percentOpen = SoftwareRenderer::getDoorPercentOpen(
@@ -4519,7 +7807,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Sliding)
@@ -4537,7 +7826,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Raising)
@@ -4563,7 +7853,8 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
 						hit.u, vStart, Constants::JustBelowOne, hit.normal,
-						textures.at(doorData.id), shadingInfo, occlusion, frame);
+						voxelLight, shadingInfo.getVoxelTexture(textures, doorData.id), shadingInfo,
+						occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Splitting)
 				{
@@ -4580,10 +7871,15 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 			}
+			break;
+		}
+		default:
+			break;
 		}
 	};
 
@@ -4606,10 +7902,10 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, int voxelX, int voxelZ, con
 	}
 }
 
-void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Camera &camera,
-	const Ray &ray, VoxelData::Facing facing, const Double2 &nearPoint, const Double2 &farPoint,
-	double nearZ, double farZ, const ShadingInfo &shadingInfo, double ceilingHeight,
-	const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid,
+void SoftwareRenderer::drawVoxelColumn(int x, const VoxelColumnView &column,
+	const ColumnIntersections &intersections, const Camera &camera, VoxelData::Facing facing,
+	const Double2 &nearPoint, const Double2 &farPoint, double nearZ, double farZ,
+	const ShadingInfo &shadingInfo, double ceilingHeight, const VoxelGrid &voxelGrid,
 	const std::vector<VoxelTexture> &textures, OcclusionData &occlusion, const FrameView &frame)
 {
 	// Much of the code here is duplicated from the initial voxel column drawing method, but
@@ -4656,16 +7952,37 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 	// this voxel column.
 	const Double3 wallNormal = VoxelData::getNormal(facing);
 
-	auto drawVoxel = [x, voxelX, voxelZ, &camera, &ray, facing, &wallNormal, &nearPoint,
-		&farPoint, nearZ, farZ, wallU, &shadingInfo, ceilingHeight, &openDoors, &voxelGrid,
-		&textures, &occlusion, &frame](int voxelY)
+	const int voxelX = column.voxelX;
+	const int voxelZ = column.voxelZ;
+
+	// Lights that reach this voxel column, if any.
+	const std::vector<Double3> *bakedColumn = column.bakedColumn;
+	const std::vector<const Light*> *columnLights = column.columnLights;
+
+	auto drawVoxel = [x, voxelX, voxelZ, &camera, facing, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, wallU, &shadingInfo, bakedColumn, columnLights,
+		ceilingHeight, &column, &intersections, &textures, &occlusion, &frame](int voxelY)
 	{
-		const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+		const VoxelData &voxelData = *column.voxelData[voxelY];
+
+		// Empty voxels have nothing to draw.
+		if (voxelData.dataType == VoxelDataType::None)
+		{
+			return;
+		}
+
 		const double voxelHeight = ceilingHeight;
 		const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
-		if (voxelData.dataType == VoxelDataType::Wall)
+		// Light from point lights, sampled at the ray's hit point halfway up the voxel and
+		// shared by every face drawn for it.
+		const Double3 voxelLight = ShadingInfo::getVoxelLightColor(
+			Double3(nearPoint.x, voxelYReal + (voxelHeight * 0.50), nearPoint.y), voxelY, facing,
+			bakedColumn, columnLights);
+
+		switch (voxelData.dataType)
+		{
+		case VoxelDataType::Wall:
 		{
 			// Draw side.
 			const VoxelData::WallData &wallData = voxelData.wall;
@@ -4683,13 +8000,16 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				nearCeilingPoint, nearFloorPoint, camera, frame);
 
 			SoftwareRenderer::drawPixels(x, drawRange, nearZ, wallU, 0.0, Constants::JustBelowOne,
-				wallNormal, textures.at(wallData.sideID), shadingInfo, occlusion, frame);
+				wallNormal, voxelLight, shadingInfo.getVoxelTexture(textures, wallData.sideID),
+				shadingInfo, occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Floor)
+		case VoxelDataType::Floor:
 		{
 			// Do nothing. Floors can only be seen from above.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Ceiling)
+		case VoxelDataType::Ceiling:
 		{
 			// Draw bottom of ceiling voxel if the camera is below it.
 			if (camera.eye.y < voxelYReal)
@@ -4708,12 +8028,14 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				const auto drawRange = SoftwareRenderer::makeDrawRange(
 					nearFloorPoint, farFloorPoint, camera, frame);
 
-				SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint, nearZ,
-					farZ, -Double3::UnitY, textures.at(ceilingData.id), shadingInfo,
+				SoftwareRenderer::drawPlanePixels(x, voxelY, drawRange, nearPoint, farPoint, nearZ,
+					farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, ceilingData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Raised)
+		case VoxelDataType::Raised:
 		{
 			const VoxelData::RaisedData &raisedData = voxelData.raised;
 
@@ -4740,13 +8062,15 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), farPoint, nearPoint,
-					farZ, nearZ, Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					farZ, nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(1), nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 			}
 			else if (camera.eye.y < nearFloorPoint.y)
 			{
@@ -4762,11 +8086,13 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(0), nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(1), nearPoint, farPoint,
-					nearZ, farZ, -Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					nearZ, farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
 			else
@@ -4777,18 +8103,19 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Diagonal)
+		case VoxelDataType::Diagonal:
 		{
 			const VoxelData::DiagonalData &diagData = voxelData.diagonal;
 
-			// Find intersection.
-			RayHit hit;
-			const bool success = diagData.type1 ?
-				SoftwareRenderer::findDiag1Intersection(voxelX, voxelZ, nearPoint, farPoint, hit) :
-				SoftwareRenderer::findDiag2Intersection(voxelX, voxelZ, nearPoint, farPoint, hit);
+			// Intersection from the column's batched intersections.
+			const RayHit &hit = diagData.type1 ? intersections.diag1Hit : intersections.diag2Hit;
+			const bool success = diagData.type1 ? intersections.diag1Success :
+				intersections.diag2Success;
 
 			if (success)
 			{
@@ -4805,11 +8132,13 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					diagTopPoint, diagBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawPixels(x, drawRange, nearZ + hit.innerZ, hit.u, 0.0,
-					Constants::JustBelowOne, hit.normal, textures.at(diagData.id), shadingInfo,
+					Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, diagData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::TransparentWall)
+		case VoxelDataType::TransparentWall:
 		{
 			// Draw transparent side.
 			const VoxelData::TransparentWallData &transparentWallData = voxelData.transparentWall;
@@ -4827,18 +8156,19 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				nearCeilingPoint, nearFloorPoint, camera, frame);
 
 			SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, wallU, 0.0,
-				Constants::JustBelowOne, wallNormal, textures.at(transparentWallData.id),
+				Constants::JustBelowOne, wallNormal, voxelLight,
+				shadingInfo.getVoxelTexture(textures, transparentWallData.id),
 				shadingInfo, occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Edge)
+		case VoxelDataType::Edge:
 		{
 			const VoxelData::EdgeData &edgeData = voxelData.edge;
 
 			// Find intersection.
 			RayHit hit;
-			const bool success = SoftwareRenderer::findEdgeIntersection(voxelX, voxelZ,
-				edgeData.facing, edgeData.flipped, facing, nearPoint, farPoint, wallU,
-				camera, ray, hit);
+			const bool success = SoftwareRenderer::findEdgeIntersection(edgeData.facing,
+				edgeData.flipped, facing, nearPoint, farPoint, wallU, intersections, hit);
 
 			if (success)
 			{
@@ -4855,19 +8185,27 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					edgeTopPoint, edgeBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ, hit.u,
-					0.0, Constants::JustBelowOne, hit.normal, textures.at(edgeData.id),
+					0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, edgeData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Chasm)
+		case VoxelDataType::Chasm:
 		{
 			// Render front and back-faces.
 			const VoxelData::ChasmData &chasmData = voxelData.chasm;
 
+			// The faces come from the chasm's neighbors at load time, so there's nothing to
+			// find the intersected faces for if it has none.
+			if (!chasmData.hasVisibleFaces())
+			{
+				break;
+			}
+
 			// Find which faces on the chasm were intersected.
 			const VoxelData::Facing nearFacing = facing;
-			const VoxelData::Facing farFacing = SoftwareRenderer::getChasmFarFacing(
-				voxelX, voxelZ, nearFacing, camera, ray);
+			const VoxelData::Facing farFacing = intersections.farFacing;
 
 			// Near.
 			if (chasmData.faceIsVisible(nearFacing))
@@ -4892,7 +8230,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					nearCeilingPoint, nearFloorPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, nearU, 0.0,
-					Constants::JustBelowOne, nearNormal, textures.at(chasmData.id),
+					Constants::JustBelowOne, nearNormal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, chasmData.id),
 					shadingInfo, occlusion, frame);
 			}
 
@@ -4943,19 +8282,20 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					farCeilingPoint, farFloorPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, farZ, farU, 0.0,
-					Constants::JustBelowOne, farNormal, textures.at(chasmData.id),
+					Constants::JustBelowOne, farNormal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, chasmData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Door)
+		case VoxelDataType::Door:
 		{
 			const VoxelData::DoorData &doorData = voxelData.door;
-			const double percentOpen = SoftwareRenderer::getDoorPercentOpen(
-				voxelX, voxelZ, openDoors);
+			const double percentOpen = column.doorPercentOpen;
 
 			RayHit hit;
-			const bool success = SoftwareRenderer::findDoorIntersection(voxelX, voxelZ,
-				doorData.type, percentOpen, facing, nearPoint, farPoint, wallU, hit);
+			const bool success = SoftwareRenderer::findDoorIntersection(doorData.type,
+				percentOpen, facing, nearPoint, wallU, intersections, hit);
 
 			if (success)
 			{
@@ -4974,7 +8314,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Sliding)
@@ -4992,7 +8333,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, 0.0,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Raising)
@@ -5017,7 +8359,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					const double vStart = raisedAmount / voxelHeight;
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, vStart,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id), shadingInfo,
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id), shadingInfo,
 						occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Splitting)
@@ -5035,23 +8378,42 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, 0.0,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 			}
+			break;
+		}
+		default:
+			break;
 		}
 	};
 
-	auto drawVoxelBelow = [x, voxelX, voxelZ, &camera, &ray, facing, &wallNormal, &nearPoint,
-		&farPoint, nearZ, farZ, wallU, &shadingInfo, ceilingHeight, &openDoors, &voxelGrid,
-		&textures, &occlusion, &frame](int voxelY)
+	auto drawVoxelBelow = [x, voxelX, voxelZ, &camera, facing, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, wallU, &shadingInfo, bakedColumn, columnLights,
+		ceilingHeight, &column, &intersections, &textures, &occlusion, &frame](int voxelY)
 	{
-		const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+		const VoxelData &voxelData = *column.voxelData[voxelY];
+
+		// Empty voxels have nothing to draw.
+		if (voxelData.dataType == VoxelDataType::None)
+		{
+			return;
+		}
+
 		const double voxelHeight = ceilingHeight;
 		const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
-		if (voxelData.dataType == VoxelDataType::Wall)
+		// Light from point lights, sampled at the ray's hit point halfway up the voxel and
+		// shared by every face drawn for it.
+		const Double3 voxelLight = ShadingInfo::getVoxelLightColor(
+			Double3(nearPoint.x, voxelYReal + (voxelHeight * 0.50), nearPoint.y), voxelY, facing,
+			bakedColumn, columnLights);
+
+		switch (voxelData.dataType)
+		{
+		case VoxelDataType::Wall:
 		{
 			const VoxelData::WallData &wallData = voxelData.wall;
 
@@ -5073,15 +8435,18 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 
 			// Ceiling.
 			SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), farPoint, nearPoint, farZ,
-				nearZ, Double3::UnitY, textures.at(wallData.ceilingID), shadingInfo,
+				nearZ, Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.ceilingID), shadingInfo,
 				occlusion, frame);
 
 			// Wall.
 			SoftwareRenderer::drawPixels(x, drawRanges.at(1), nearZ, wallU, 0.0,
-				Constants::JustBelowOne, wallNormal, textures.at(wallData.sideID), shadingInfo,
+				Constants::JustBelowOne, wallNormal, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.sideID), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Floor)
+		case VoxelDataType::Floor:
 		{
 			// Draw top of floor voxel.
 			const VoxelData::FloorData &floorData = voxelData.floor;
@@ -5098,15 +8463,18 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 			const auto drawRange = SoftwareRenderer::makeDrawRange(
 				farCeilingPoint, nearCeilingPoint, camera, frame);
 
-			SoftwareRenderer::drawPerspectivePixels(x, drawRange, farPoint, nearPoint, farZ,
-				nearZ, Double3::UnitY, textures.at(floorData.id), shadingInfo, 
+			SoftwareRenderer::drawPlanePixels(x, voxelY, drawRange, farPoint, nearPoint, farZ,
+				nearZ, Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, floorData.id), shadingInfo, 
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Ceiling)
+		case VoxelDataType::Ceiling:
 		{
 			// Do nothing. Ceilings can only be seen from below.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Raised)
+		case VoxelDataType::Raised:
 		{
 			const VoxelData::RaisedData &raisedData = voxelData.raised;
 
@@ -5133,13 +8501,15 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), farPoint, nearPoint,
-					farZ, nearZ, Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					farZ, nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(1), nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 			}
 			else if (camera.eye.y < nearFloorPoint.y)
 			{
@@ -5155,11 +8525,13 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(0), nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(1), nearPoint, farPoint,
-					nearZ, farZ, -Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					nearZ, farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
 			else
@@ -5170,18 +8542,19 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Diagonal)
+		case VoxelDataType::Diagonal:
 		{
 			const VoxelData::DiagonalData &diagData = voxelData.diagonal;
 
-			// Find intersection.
-			RayHit hit;
-			const bool success = diagData.type1 ?
-				SoftwareRenderer::findDiag1Intersection(voxelX, voxelZ, nearPoint, farPoint, hit) :
-				SoftwareRenderer::findDiag2Intersection(voxelX, voxelZ, nearPoint, farPoint, hit);
+			// Intersection from the column's batched intersections.
+			const RayHit &hit = diagData.type1 ? intersections.diag1Hit : intersections.diag2Hit;
+			const bool success = diagData.type1 ? intersections.diag1Success :
+				intersections.diag2Success;
 
 			if (success)
 			{
@@ -5198,11 +8571,13 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					diagTopPoint, diagBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawPixels(x, drawRange, nearZ + hit.innerZ, hit.u, 0.0,
-					Constants::JustBelowOne, hit.normal, textures.at(diagData.id), shadingInfo,
+					Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, diagData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::TransparentWall)
+		case VoxelDataType::TransparentWall:
 		{
 			// Draw transparent side.
 			const VoxelData::TransparentWallData &transparentWallData = voxelData.transparentWall;
@@ -5220,18 +8595,19 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				nearCeilingPoint, nearFloorPoint, camera, frame);
 
 			SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, wallU, 0.0,
-				Constants::JustBelowOne, wallNormal, textures.at(transparentWallData.id),
+				Constants::JustBelowOne, wallNormal, voxelLight,
+				shadingInfo.getVoxelTexture(textures, transparentWallData.id),
 				shadingInfo, occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Edge)
+		case VoxelDataType::Edge:
 		{
 			const VoxelData::EdgeData &edgeData = voxelData.edge;
 
 			// Find intersection.
 			RayHit hit;
-			const bool success = SoftwareRenderer::findEdgeIntersection(voxelX, voxelZ,
-				edgeData.facing, edgeData.flipped, facing, nearPoint, farPoint, wallU,
-				camera, ray, hit);
+			const bool success = SoftwareRenderer::findEdgeIntersection(edgeData.facing,
+				edgeData.flipped, facing, nearPoint, farPoint, wallU, intersections, hit);
 
 			if (success)
 			{
@@ -5248,19 +8624,27 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					edgeTopPoint, edgeBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ, hit.u,
-					0.0, Constants::JustBelowOne, hit.normal, textures.at(edgeData.id),
+					0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, edgeData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Chasm)
+		case VoxelDataType::Chasm:
 		{
 			// Render front and back-faces.
 			const VoxelData::ChasmData &chasmData = voxelData.chasm;
 
+			// The faces come from the chasm's neighbors at load time, so there's nothing to
+			// find the intersected faces for if it has none.
+			if (!chasmData.hasVisibleFaces())
+			{
+				break;
+			}
+
 			// Find which faces on the chasm were intersected.
 			const VoxelData::Facing nearFacing = facing;
-			const VoxelData::Facing farFacing = SoftwareRenderer::getChasmFarFacing(
-				voxelX, voxelZ, nearFacing, camera, ray);
+			const VoxelData::Facing farFacing = intersections.farFacing;
 
 			// Near.
 			if (chasmData.faceIsVisible(nearFacing))
@@ -5285,7 +8669,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					nearCeilingPoint, nearFloorPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, nearU, 0.0,
-					Constants::JustBelowOne, nearNormal, textures.at(chasmData.id),
+					Constants::JustBelowOne, nearNormal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, chasmData.id),
 					shadingInfo, occlusion, frame);
 			}
 
@@ -5336,19 +8721,20 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					farCeilingPoint, farFloorPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, farZ, farU, 0.0,
-					Constants::JustBelowOne, farNormal, textures.at(chasmData.id),
+					Constants::JustBelowOne, farNormal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, chasmData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Door)
+		case VoxelDataType::Door:
 		{
 			const VoxelData::DoorData &doorData = voxelData.door;
-			const double percentOpen = SoftwareRenderer::getDoorPercentOpen(
-				voxelX, voxelZ, openDoors);
+			const double percentOpen = column.doorPercentOpen;
 
 			RayHit hit;
-			const bool success = SoftwareRenderer::findDoorIntersection(voxelX, voxelZ,
-				doorData.type, percentOpen, facing, nearPoint, farPoint, wallU, hit);
+			const bool success = SoftwareRenderer::findDoorIntersection(doorData.type,
+				percentOpen, facing, nearPoint, wallU, intersections, hit);
 
 			if (success)
 			{
@@ -5367,7 +8753,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Sliding)
@@ -5385,7 +8772,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, 0.0,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Raising)
@@ -5410,7 +8798,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					const double vStart = raisedAmount / voxelHeight;
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, vStart,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id), shadingInfo,
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id), shadingInfo,
 						occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Splitting)
@@ -5428,23 +8817,42 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, 0.0,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 			}
+			break;
+		}
+		default:
+			break;
 		}
 	};
 
-	auto drawVoxelAbove = [x, voxelX, voxelZ, &camera, &ray, facing, &wallNormal, &nearPoint,
-		&farPoint, nearZ, farZ, wallU, &shadingInfo, ceilingHeight, &openDoors, &voxelGrid,
-		&textures, &occlusion, &frame](int voxelY)
+	auto drawVoxelAbove = [x, voxelX, voxelZ, &camera, facing, &wallNormal, &nearPoint,
+		&farPoint, nearZ, farZ, wallU, &shadingInfo, bakedColumn, columnLights,
+		ceilingHeight, &column, &intersections, &textures, &occlusion, &frame](int voxelY)
 	{
-		const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-		const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+		const VoxelData &voxelData = *column.voxelData[voxelY];
+
+		// Empty voxels have nothing to draw.
+		if (voxelData.dataType == VoxelDataType::None)
+		{
+			return;
+		}
+
 		const double voxelHeight = ceilingHeight;
 		const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
-		if (voxelData.dataType == VoxelDataType::Wall)
+		// Light from point lights, sampled at the ray's hit point halfway up the voxel and
+		// shared by every face drawn for it.
+		const Double3 voxelLight = ShadingInfo::getVoxelLightColor(
+			Double3(nearPoint.x, voxelYReal + (voxelHeight * 0.50), nearPoint.y), voxelY, facing,
+			bakedColumn, columnLights);
+
+		switch (voxelData.dataType)
+		{
+		case VoxelDataType::Wall:
 		{
 			const VoxelData::WallData &wallData = voxelData.wall;
 
@@ -5466,19 +8874,23 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 			
 			// Wall.
 			SoftwareRenderer::drawPixels(x, drawRanges.at(0), nearZ, wallU, 0.0,
-				Constants::JustBelowOne, wallNormal, textures.at(wallData.sideID), shadingInfo,
+				Constants::JustBelowOne, wallNormal, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.sideID), shadingInfo,
 				occlusion, frame);
 
 			// Floor.
 			SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(1), nearPoint, farPoint,
-				nearZ, farZ, -Double3::UnitY, textures.at(wallData.floorID), shadingInfo,
+				nearZ, farZ, -Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, wallData.floorID), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Floor)
+		case VoxelDataType::Floor:
 		{
 			// Do nothing. Floors can only be seen from above.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Ceiling)
+		case VoxelDataType::Ceiling:
 		{
 			// Draw bottom of ceiling voxel.
 			const VoxelData::CeilingData &ceilingData = voxelData.ceiling;
@@ -5495,11 +8907,13 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 			const auto drawRange = SoftwareRenderer::makeDrawRange(
 				nearFloorPoint, farFloorPoint, camera, frame);
 
-			SoftwareRenderer::drawPerspectivePixels(x, drawRange, nearPoint, farPoint, nearZ,
-				farZ, -Double3::UnitY, textures.at(ceilingData.id), shadingInfo,
+			SoftwareRenderer::drawPlanePixels(x, voxelY, drawRange, nearPoint, farPoint, nearZ,
+				farZ, -Double3::UnitY, voxelLight,
+				shadingInfo.getVoxelTexture(textures, ceilingData.id), shadingInfo,
 				occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Raised)
+		case VoxelDataType::Raised:
 		{
 			const VoxelData::RaisedData &raisedData = voxelData.raised;
 
@@ -5526,13 +8940,15 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 
 				// Ceiling.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(0), farPoint, nearPoint,
-					farZ, nearZ, Double3::UnitY, textures.at(raisedData.ceilingID), shadingInfo,
+					farZ, nearZ, Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.ceilingID), shadingInfo,
 					occlusion, frame);
 
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(1), nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 			}
 			else if (camera.eye.y < nearFloorPoint.y)
 			{
@@ -5548,11 +8964,13 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				// Wall.
 				SoftwareRenderer::drawTransparentPixels(x, drawRanges.at(0), nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 
 				// Floor.
 				SoftwareRenderer::drawPerspectivePixels(x, drawRanges.at(1), nearPoint, farPoint,
-					nearZ, farZ, -Double3::UnitY, textures.at(raisedData.floorID), shadingInfo,
+					nearZ, farZ, -Double3::UnitY, voxelLight,
+					shadingInfo.getVoxelTexture(textures, raisedData.floorID), shadingInfo,
 					occlusion, frame);
 			}
 			else
@@ -5563,18 +8981,19 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, wallU,
 					raisedData.vTop, raisedData.vBottom, wallNormal,
-					textures.at(raisedData.sideID), shadingInfo, occlusion, frame);
+					voxelLight, shadingInfo.getVoxelTexture(textures, raisedData.sideID),
+					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Diagonal)
+		case VoxelDataType::Diagonal:
 		{
 			const VoxelData::DiagonalData &diagData = voxelData.diagonal;
 
-			// Find intersection.
-			RayHit hit;
-			const bool success = diagData.type1 ?
-				SoftwareRenderer::findDiag1Intersection(voxelX, voxelZ, nearPoint, farPoint, hit) :
-				SoftwareRenderer::findDiag2Intersection(voxelX, voxelZ, nearPoint, farPoint, hit);
+			// Intersection from the column's batched intersections.
+			const RayHit &hit = diagData.type1 ? intersections.diag1Hit : intersections.diag2Hit;
+			const bool success = diagData.type1 ? intersections.diag1Success :
+				intersections.diag2Success;
 
 			if (success)
 			{
@@ -5591,11 +9010,13 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					diagTopPoint, diagBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawPixels(x, drawRange, nearZ + hit.innerZ, hit.u, 0.0,
-					Constants::JustBelowOne, hit.normal, textures.at(diagData.id), shadingInfo,
+					Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, diagData.id), shadingInfo,
 					occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::TransparentWall)
+		case VoxelDataType::TransparentWall:
 		{
 			// Draw transparent side.
 			const VoxelData::TransparentWallData &transparentWallData = voxelData.transparentWall;
@@ -5613,18 +9034,19 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 				nearCeilingPoint, nearFloorPoint, camera, frame);
 
 			SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, wallU, 0.0,
-				Constants::JustBelowOne, wallNormal, textures.at(transparentWallData.id),
+				Constants::JustBelowOne, wallNormal, voxelLight,
+				shadingInfo.getVoxelTexture(textures, transparentWallData.id),
 				shadingInfo, occlusion, frame);
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Edge)
+		case VoxelDataType::Edge:
 		{
 			const VoxelData::EdgeData &edgeData = voxelData.edge;
 
 			// Find intersection.
 			RayHit hit;
-			const bool success = SoftwareRenderer::findEdgeIntersection(voxelX, voxelZ,
-				edgeData.facing, edgeData.flipped, facing, nearPoint, farPoint, wallU,
-				camera, ray, hit);
+			const bool success = SoftwareRenderer::findEdgeIntersection(edgeData.facing,
+				edgeData.flipped, facing, nearPoint, farPoint, wallU, intersections, hit);
 
 			if (success)
 			{
@@ -5641,23 +9063,25 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					edgeTopPoint, edgeBottomPoint, camera, frame);
 
 				SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ, hit.u,
-					0.0, Constants::JustBelowOne, hit.normal, textures.at(edgeData.id),
+					0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+					shadingInfo.getVoxelTexture(textures, edgeData.id),
 					shadingInfo, occlusion, frame);
 			}
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Chasm)
+		case VoxelDataType::Chasm:
 		{
 			// Ignore. Chasms should never be above the player's voxel.
+			break;
 		}
-		else if (voxelData.dataType == VoxelDataType::Door)
+		case VoxelDataType::Door:
 		{
 			const VoxelData::DoorData &doorData = voxelData.door;
-			const double percentOpen = SoftwareRenderer::getDoorPercentOpen(
-				voxelX, voxelZ, openDoors);
+			const double percentOpen = column.doorPercentOpen;
 
 			RayHit hit;
-			const bool success = SoftwareRenderer::findDoorIntersection(voxelX, voxelZ,
-				doorData.type, percentOpen, facing, nearPoint, farPoint, wallU, hit);
+			const bool success = SoftwareRenderer::findDoorIntersection(doorData.type,
+				percentOpen, facing, nearPoint, wallU, intersections, hit);
 
 			if (success)
 			{
@@ -5676,7 +9100,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ + hit.innerZ,
-						hit.u, 0.0, Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						hit.u, 0.0, Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Sliding)
@@ -5694,7 +9119,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, 0.0,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Raising)
@@ -5719,7 +9145,8 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 					const double vStart = raisedAmount / voxelHeight;
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, vStart,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id), shadingInfo,
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id), shadingInfo,
 						occlusion, frame);
 				}
 				else if (doorData.type == VoxelData::DoorData::Type::Splitting)
@@ -5737,35 +9164,46 @@ void SoftwareRenderer::drawVoxelColumn(int x, int voxelX, int voxelZ, const Came
 						doorTopPoint, doorBottomPoint, camera, frame);
 
 					SoftwareRenderer::drawTransparentPixels(x, drawRange, nearZ, hit.u, 0.0,
-						Constants::JustBelowOne, hit.normal, textures.at(doorData.id),
+						Constants::JustBelowOne, hit.normal, voxelLight,
+						shadingInfo.getVoxelTexture(textures, doorData.id),
 						shadingInfo, occlusion, frame);
 				}
 			}
+			break;
+		}
+		default:
+			break;
 		}
 	};
 
 	// Relative Y voxel coordinate of the camera, compensating for the ceiling height.
 	const int adjustedVoxelY = camera.getAdjustedEyeVoxelY(ceilingHeight);
+	const int gridHeight = voxelGrid.getHeight();
 
-	// Draw voxel straight ahead first.
-	drawVoxel(adjustedVoxelY);
+	// Draw voxel straight ahead first. The camera might be above or below the grid.
+	if ((adjustedVoxelY >= 0) && (adjustedVoxelY < gridHeight))
+	{
+		drawVoxel(adjustedVoxelY);
+	}
 
 	// Draw voxels below the voxel.
-	for (int voxelY = (adjustedVoxelY - 1); voxelY >= 0; voxelY--)
+	for (int voxelY = std::min(adjustedVoxelY - 1, gridHeight - 1); voxelY >= 0; voxelY--)
 	{
 		drawVoxelBelow(voxelY);
 	}
 
 	// Draw voxels above the voxel.
-	for (int voxelY = (adjustedVoxelY + 1); voxelY < voxelGrid.getHeight(); voxelY++)
+	for (int voxelY = std::max(adjustedVoxelY + 1, 0); voxelY < gridHeight; voxelY++)
 	{
 		drawVoxelAbove(voxelY);
 	}
 }
 
+template <bool FogEnabled>
 void SoftwareRenderer::drawFlat(int startX, int endX, const Flat::Frame &flatFrame,
-	const Double3 &normal, bool flipped, const Double2 &eye, const ShadingInfo &shadingInfo,
-	const FlatTexture &texture, const FrameView &frame)
+	const Double3 &normal, const Double3 &lightColor, bool flipped, const Double2 &eye,
+	const ShadingInfo &shadingInfo, const FlatTexture &texture, int frameIndex,
+	const FlatOcclusion &occlusion, const FrameView &frame)
 {
 	// Contribution from the sun.
 	const double lightNormalDot = std::max(0.0, shadingInfo.sunDirection.dot(normal));
@@ -5826,12 +9264,51 @@ void SoftwareRenderer::drawFlat(int startX, int endX, const Flat::Frame &flatFra
 	const int yStart = SoftwareRenderer::getLowerBoundedPixel(projectedYStart, frame.height);
 	const int yEnd = SoftwareRenderer::getUpperBoundedPixel(projectedYEnd, frame.height);
 
-	// Shading on the texture.
-	// - @todo: contribution from lights.
-	const Double3 shading(
-		shadingInfo.ambient + sunComponent.x,
-		shadingInfo.ambient + sunComponent.y,
-		shadingInfo.ambient + sunComponent.z);
+	// Throw out the flat if even its nearest point in the XZ plane is behind the farthest
+	// wall pixel of every column it covers (i.e., an NPC behind a building).
+	const double nearestDepth = [&eye, &startTopPoint, &endTopPoint]()
+	{
+		const Double2 start(startTopPoint.x, startTopPoint.z);
+		const Double2 diff = Double2(endTopPoint.x, endTopPoint.z) - start;
+		const double lengthSqr = diff.lengthSquared();
+		const double percent = (lengthSqr > 0.0) ?
+			std::clamp((eye - start).dot(diff) / lengthSqr, 0.0, 1.0) : 0.0;
+		return ((start + (diff * percent)) - eye).length();
+	}();
+
+	if (occlusion.isRangeOccluded(xStart, xEnd, static_cast<float>(nearestDepth)))
+	{
+		return;
+	}
+
+	// Shading on the texture.
+	const Double3 shading(
+		shadingInfo.ambient + sunComponent.x + lightColor.x,
+		shadingInfo.ambient + sunComponent.y + lightColor.y,
+		shadingInfo.ambient + sunComponent.z + lightColor.z);
+
+	// Light level for palette mode.
+	const double lightPercent = std::max({ shading.x, shading.y, shading.z });
+
+	// Values for interpolating down each column at pixel precision.
+	const PixelReal projectedYStartReal = static_cast<PixelReal>(projectedYStart);
+	const PixelReal projectedYRange = static_cast<PixelReal>(projectedYEnd - projectedYStart);
+	const PixelReal textureHeightReal = static_cast<PixelReal>(texture.height);
+
+	// Gets the texel row of a pixel row in each column.
+	auto getTextureY = [projectedYStartReal, projectedYRange, textureHeightReal,
+		&texture](int y)
+	{
+		const PixelReal yPercent = ((static_cast<PixelReal>(y) +
+			SoftwareRenderer::PIXEL_CENTER) - projectedYStartReal) / projectedYRange;
+
+		// Vertical texture coordinate.
+		const PixelReal startV = static_cast<PixelReal>(0.0);
+		const PixelReal endV = SoftwareRenderer::PIXEL_JUST_BELOW_ONE;
+		const PixelReal v = startV + ((endV - startV) * yPercent);
+
+		return std::min(static_cast<int>(v * textureHeightReal), texture.height - 1);
+	};
 
 	// Draw by-column, similar to wall rendering.
 	for (int x = xStart; x < xEnd; x++)
@@ -5842,79 +9319,129 @@ void SoftwareRenderer::drawFlat(int startX, int endX, const Flat::Frame &flatFra
 		// Horizontal texture coordinate.
 		const double u = startU + ((endU - startU) * xPercent);
 
-		// Horizontal texel position.
+		// Horizontal texel position in the atlas, past the columns of earlier frames.
 		const int textureX = static_cast<int>(
 			(flipped ? (Constants::JustBelowOne - u) : u) *
-			static_cast<double>(texture.width));
+			static_cast<double>(texture.width)) + (frameIndex * texture.width);
+
+		// Flat texels are column-major, so the column is contiguous.
+		const int columnOffset = textureX * texture.height;
+		const FlatTexel *columnTexels = texture.texels.data() + columnOffset;
+		const uint8_t *columnPaletteIndices = texture.paletteIndices.data() + columnOffset;
 
 		const Double3 topPoint = startTopPoint.lerp(endTopPoint, xPercent);
 
 		// Get the true XZ distance for the depth.
 		const double depth = (Double2(topPoint.x, topPoint.z) - eye).length();
 
-		// Linearly interpolated fog.
-		const Double3 &fogColor = shadingInfo.getFogColor();
-		const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+		// Depth as stored in the depth buffer.
+		const float depthValue = static_cast<float>(depth);
 
-		for (int y = yStart; y < yEnd; y++)
+		// Skip the column if every wall pixel in it is nearer.
+		if (depthValue > occlusion.getColumnDepth(x))
 		{
-			const int index = x + (y * frame.width);
+			continue;
+		}
 
-			if (depth <= frame.depthBuffer[index])
+		// Linearly interpolated fog.
+		const ShadingInfo::FogSample &fogSample = shadingInfo.getFogSample(depth);
+		const double fogPercent = FogEnabled ? (1.0 - fogSample.colorPercent) : 0.0;
+
+		// Only the opaque runs of texels in the texture column are drawn. Texel rows never go
+		// back up the column, so the pixels over transparent rows between runs are jumped
+		// over instead of being alpha tested.
+		const Int2 *runs = texture.opaqueRuns.data();
+		const int runsStart = texture.columnRunOffsets[textureX];
+		const int runsEnd = texture.columnRunOffsets[textureX + 1];
+
+		int y = yStart;
+		for (int runIndex = runsStart; (runIndex < runsEnd) && (y < yEnd); runIndex++)
+		{
+			const Int2 &run = runs[runIndex];
+
+			// Estimate the first pixel on the run's start row, then settle it on the exact
+			// one so it agrees with the per-pixel texel rows.
+			const PixelReal runStartPercent = static_cast<PixelReal>(run.x) /
+				(textureHeightReal * SoftwareRenderer::PIXEL_JUST_BELOW_ONE);
+			const PixelReal runStartY = (projectedYStartReal +
+				(runStartPercent * projectedYRange)) - SoftwareRenderer::PIXEL_CENTER;
+			int runY = std::clamp(static_cast<int>(std::ceil(runStartY)), y, yEnd);
+
+			while ((runY > y) && (getTextureY(runY - 1) >= run.x))
 			{
-				const double yPercent = ((static_cast<double>(y) + 0.50) - projectedYStart) /
-					(projectedYEnd - projectedYStart);
-
-				// Vertical texture coordinate.
-				const double startV = 0.0;
-				const double endV = Constants::JustBelowOne;
-				const double v = startV + ((endV - startV) * yPercent);
+				runY--;
+			}
 
-				// Vertical texel position.
-				const int textureY = static_cast<int>(v * static_cast<double>(texture.height));
+			while ((runY < yEnd) && (getTextureY(runY) < run.x))
+			{
+				runY++;
+			}
 
-				// Alpha is checked in this loop, and transparent texels are not drawn.
-				// Flats do not have emission, so ignore it.
-				const int textureIndex = textureX + (textureY * texture.width);
-				const FlatTexel &texel = texture.texels[textureIndex];
+			for (y = runY; y < yEnd; y++)
+			{
+				const int textureY = getTextureY(y);
+				if (textureY >= run.y)
+				{
+					break;
+				}
 
-				if (texel.a > 0.0)
+				const int index = y + (x * frame.height);
+				if (depthValue <= frame.depthBuffer[index])
 				{
-					// Texture color with shading.
-					const double shadingMax = 1.0;
-					double colorR = texel.r * std::min(shading.x, shadingMax);
-					double colorG = texel.g * std::min(shading.y, shadingMax);
-					double colorB = texel.b * std::min(shading.z, shadingMax);
-
-					// Linearly interpolate with fog.
-					colorR += (fogColor.x - colorR) * fogPercent;
-					colorG += (fogColor.y - colorG) * fogPercent;
-					colorB += (fogColor.z - colorB) * fogPercent;
-
-					// Clamp maximum (don't worry about negative values).
-					const double high = 1.0;
-					colorR = (colorR > high) ? high : colorR;
-					colorG = (colorG > high) ? high : colorG;
-					colorB = (colorB > high) ? high : colorB;
-
-					// Convert floats to integers.
-					const uint32_t colorRGB = static_cast<uint32_t>(
-						((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-						((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-						((static_cast<uint8_t>(colorB * 255.0))));
-
-					frame.colorBuffer[index] = colorRGB;
-					frame.depthBuffer[index] = depth;
+					// Flats do not have emission, so ignore it.
+					const FlatTexel &texel = columnTexels[textureY];
+
+					if (frame.indexBuffer != nullptr)
+					{
+						frame.indexBuffer[index] = ShadeTable::getIndexValue(
+							columnPaletteIndices[textureY], lightPercent, fogPercent);
+					}
+					else
+					{
+						// Texture color with shading.
+						const double shadingMax = 1.0;
+						double colorR = SoftwareRenderer::TEXEL_CHANNEL_TO_DOUBLE[texel.r] *
+							std::min(shading.x, shadingMax);
+						double colorG = SoftwareRenderer::TEXEL_CHANNEL_TO_DOUBLE[texel.g] *
+							std::min(shading.y, shadingMax);
+						double colorB = SoftwareRenderer::TEXEL_CHANNEL_TO_DOUBLE[texel.b] *
+							std::min(shading.z, shadingMax);
+
+						// Linearly interpolate with fog.
+						if constexpr (FogEnabled)
+						{
+							colorR = (colorR * fogSample.colorPercent) + fogSample.fogColor.x;
+							colorG = (colorG * fogSample.colorPercent) + fogSample.fogColor.y;
+							colorB = (colorB * fogSample.colorPercent) + fogSample.fogColor.z;
+						}
+
+						// Clamp maximum (don't worry about negative values).
+						const double high = 1.0;
+						colorR = (colorR > high) ? high : colorR;
+						colorG = (colorG > high) ? high : colorG;
+						colorB = (colorB > high) ? high : colorB;
+
+						// Convert floats to integers.
+						const uint32_t colorRGB = static_cast<uint32_t>(
+							((static_cast<uint8_t>(colorR * 255.0)) << 16) |
+							((static_cast<uint8_t>(colorG * 255.0)) << 8) |
+							((static_cast<uint8_t>(colorB * 255.0))));
+
+						frame.colorBuffer[index] = colorRGB;
+					}
+
+					frame.depthBuffer[index] = depthValue;
 				}
 			}
 		}
 	}
 }
 
-void SoftwareRenderer::rayCast2D(int x, const Camera &camera, const Ray &ray,
-	const ShadingInfo &shadingInfo, double ceilingHeight,
-	const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid,
-	const std::vector<VoxelTexture> &textures, OcclusionData &occlusion, const FrameView &frame)
+void SoftwareRenderer::rayCast2D(int startX, int columnStep, int rayCount,
+	const Camera &camera, const Ray *rays, const ShadingInfo &shadingInfo, double ceilingHeight,
+	double detailDistance, const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+	const std::vector<VoxelTexture> &textures, std::vector<OcclusionData> &occlusion,
+	const FrameView &frame)
 {
 	// Initially based on Lode Vandevenne's algorithm, this method of 2.5D ray casting is more 
 	// expensive as it does not stop at the first wall intersection, and it also renders voxels 
@@ -5927,213 +9454,309 @@ void SoftwareRenderer::rayCast2D(int x, const Camera &camera, const Ray &ray,
 	// -> (int)floor(-0.8) == -1
 	// -> (int)ceil(-0.8) == 0
 
-	const double dirXSquared = ray.dirX * ray.dirX;
-	const double dirZSquared = ray.dirZ * ray.dirZ;
-
-	const double deltaDistX = std::sqrt(1.0 + (dirZSquared / dirXSquared));
-	const double deltaDistZ = std::sqrt(1.0 + (dirXSquared / dirZSquared));
+	DebugAssert(rayCount <= SoftwareRenderer::RAY_PACKET_SIZE);
 
-	const bool nonNegativeDirX = ray.dirX >= 0.0;
-	const bool nonNegativeDirZ = ray.dirZ >= 0.0;
+	// Odd columns whose left neighbor is in the packet stop at the detail distance and copy
+	// the rest of that column afterwards. The others go out to the fog distance.
+	std::array<double, SoftwareRenderer::RAY_PACKET_SIZE> maxDistances;
+	std::array<bool, SoftwareRenderer::RAY_PACKET_SIZE> reducedDetail;
 
-	int stepX, stepZ;
-	double sideDistX, sideDistZ;
-	if (nonNegativeDirX)
-	{
-		stepX = 1;
-		sideDistX = (camera.eyeVoxelReal.x + 1.0 - camera.eye.x) * deltaDistX;
-	}
-	else
+	std::array<RayDDA, SoftwareRenderer::RAY_PACKET_SIZE> ddas;
+	std::array<double, SoftwareRenderer::RAY_PACKET_SIZE> rayAngles;
+	for (int i = 0; i < rayCount; i++)
 	{
-		stepX = -1;
-		sideDistX = (camera.eye.x - camera.eyeVoxelReal.x) * deltaDistX;
+		const int x = startX + (i * columnStep);
+		reducedDetail[i] = (columnStep == 1) && (i > 0) && ((x & 1) != 0) &&
+			(detailDistance < shadingInfo.fogDistance);
+		maxDistances[i] = reducedDetail[i] ? detailDistance : shadingInfo.fogDistance;
+
+		const Ray &ray = rays[i];
+		rayAngles[i] = MathUtils::fullAtan2(ray.dirX, ray.dirZ);
+
+		RayDDA &dda = ddas[i];
+		dda.init(camera, ray, voxelGrid);
+
+		if (dda.voxelIsValid)
+		{
+			// The initial near point is directly in front of the player in the near Z 
+			// camera plane.
+			const Double2 initialNearPoint(
+				camera.eye.x + (ray.dirX * SoftwareRenderer::NEAR_PLANE),
+				camera.eye.z + (ray.dirZ * SoftwareRenderer::NEAR_PLANE));
+
+			// The initial far point is the wall hit. This is used with the player's position 
+			// for drawing the initial floor and ceiling.
+			const Double2 initialFarPoint(
+				camera.eye.x + (ray.dirX * dda.zDistance),
+				camera.eye.z + (ray.dirZ * dda.zDistance));
+
+			// Draw all voxels in a column at the player's XZ coordinate.
+			SoftwareRenderer::drawInitialVoxelColumn(x, camera.eyeVoxel.x, camera.eyeVoxel.z,
+				camera, ray, dda.facing, initialNearPoint, initialFarPoint,
+				SoftwareRenderer::NEAR_PLANE, dda.zDistance, shadingInfo, ceilingHeight,
+				openDoors, voxelGrid, textures, occlusion.at(x), frame);
+		}
+
+		// Step forward in the grid once to leave the initial voxel and update the Z distance.
+		dda.step(camera, ray, voxelGrid);
 	}
 
-	if (nonNegativeDirZ)
+	// A ray keeps stepping while the current coordinate is valid, the distance stepped is
+	// less than the distance at which fog is maximum (or the detail distance), and the column
+	// is not completely occluded.
+	auto isRayActive = [columnStep, &maxDistances, &occlusion, startX, &ddas](int i)
 	{
-		stepZ = 1;
-		sideDistZ = (camera.eyeVoxelReal.z + 1.0 - camera.eye.z) * deltaDistZ;
-	}
-	else
+		const RayDDA &dda = ddas[i];
+		const OcclusionData &columnOcclusion = occlusion[startX + (i * columnStep)];
+		return dda.voxelIsValid && (dda.zDistance < maxDistances[i]) &&
+			(columnOcclusion.yMin != columnOcclusion.yMax);
+	};
+
+	// If a voxel column is empty at every height, steps a ray across the rest of the largest
+	// empty block around it without drawing anything.
+	auto skipEmptyBlock = [&camera, rays, &maxDistances, &voxelGrid, &ddas](int i, int emptySpan)
 	{
-		stepZ = -1;
-		sideDistZ = (camera.eye.z - camera.eyeVoxelReal.z) * deltaDistZ;
-	}
+		RayDDA &dda = ddas[i];
+		const int blockX = dda.cell.x / emptySpan;
+		const int blockZ = dda.cell.z / emptySpan;
 
-	// The Z distance from the camera to the wall, and the X or Z normal of the intersected
-	// voxel face. The first Z distance is a special case, so it's brought outside the 
-	// DDA loop.
-	double zDistance;
-	VoxelData::Facing facing;
+		do
+		{
+			dda.step(camera, rays[i], voxelGrid);
+		} while (dda.voxelIsValid && (dda.zDistance < maxDistances[i]) &&
+			((dda.cell.x / emptySpan) == blockX) && ((dda.cell.z / emptySpan) == blockZ));
+	};
 
-	// Verify that the initial voxel coordinate is within the world bounds.
-	bool voxelIsValid = 
-		(camera.eyeVoxel.x >= 0) && 
-		(camera.eyeVoxel.y >= 0) && 
-		(camera.eyeVoxel.z >= 0) &&
-		(camera.eyeVoxel.x < voxelGrid.getWidth()) && 
-		(camera.eyeVoxel.y < voxelGrid.getHeight()) &&
-		(camera.eyeVoxel.z < voxelGrid.getDepth());
+	// Rays stepped across the voxel column being drawn, in the order they were stepped, and
+	// what they need for drawing it.
+	struct ColumnRays
+	{
+		std::array<int, SoftwareRenderer::RAY_PACKET_SIZE> rayIndices;
+		std::array<VoxelData::Facing, SoftwareRenderer::RAY_PACKET_SIZE> nearFacings;
+		std::array<double, SoftwareRenderer::RAY_PACKET_SIZE> nearZs, rayAngles;
+		std::array<Double2, SoftwareRenderer::RAY_PACKET_SIZE> nearPoints, farPoints;
+		std::array<ColumnIntersections, SoftwareRenderer::RAY_PACKET_SIZE> intersections;
+		int count;
+	};
+
+	ColumnRays columnRays;
+	columnRays.count = 0;
 
-	if (voxelIsValid)
+	// Steps the ray across its current voxel column to the next one, adding it to the rays
+	// drawing the column.
+	auto stepRayColumn = [startX, columnStep, &camera, rays, &voxelGrid, &frame, &ddas,
+		&rayAngles, &columnRays](int i, const VoxelColumnView &column)
 	{
-		// Decide how far the wall is, and which voxel face was hit.
-		if (sideDistX < sideDistZ)
-		{
-			zDistance = sideDistX;
-			facing = nonNegativeDirX ? VoxelData::Facing::NegativeX : 
-				VoxelData::Facing::PositiveX;
-		}
-		else
+		const int x = startX + (i * columnStep);
+		const Ray &ray = rays[i];
+		RayDDA &dda = ddas[i];
+
+		// Store the axis and Z distance for wall rendering. The ray needs to do another DDA
+		// step to calculate the far point.
+		const VoxelData::Facing savedFacing = dda.facing;
+		const double wallDistance = dda.zDistance;
+
+		// Keep the first voxel at the camera's height for screen point queries.
+		if (frame.columnHits != nullptr)
 		{
-			zDistance = sideDistZ;
-			facing = nonNegativeDirZ ? VoxelData::Facing::NegativeZ : 
-				VoxelData::Facing::PositiveZ;
+			ColumnHit &columnHit = frame.columnHits[x];
+			if (!columnHit.isValid &&
+				(column.voxelData[camera.eyeVoxel.y]->dataType != VoxelDataType::None))
+			{
+				columnHit.voxel = Int3(column.voxelX, camera.eyeVoxel.y, column.voxelZ);
+				columnHit.distance = wallDistance;
+				columnHit.facing = savedFacing;
+				columnHit.isValid = true;
+			}
 		}
 
-		// The initial near point is directly in front of the player in the near Z 
-		// camera plane.
-		const Double2 initialNearPoint(
-			camera.eye.x + (ray.dirX * SoftwareRenderer::NEAR_PLANE),
-			camera.eye.z + (ray.dirZ * SoftwareRenderer::NEAR_PLANE));
+		// Decide which voxel in the XZ plane to step to next, and update the Z distance.
+		dda.step(camera, ray, voxelGrid);
 
-		// The initial far point is the wall hit. This is used with the player's position 
-		// for drawing the initial floor and ceiling.
-		const Double2 initialFarPoint(
-			camera.eye.x + (ray.dirX * zDistance),
-			camera.eye.z + (ray.dirZ * zDistance));
+		const int slot = columnRays.count;
+		columnRays.rayIndices[slot] = i;
+		columnRays.nearFacings[slot] = savedFacing;
+		columnRays.nearZs[slot] = wallDistance;
+		columnRays.rayAngles[slot] = rayAngles[i];
 
-		// Draw all voxels in a column at the player's XZ coordinate.
-		SoftwareRenderer::drawInitialVoxelColumn(x, camera.eyeVoxel.x, camera.eyeVoxel.z,
-			camera, ray, facing, initialNearPoint, initialFarPoint, SoftwareRenderer::NEAR_PLANE, 
-			zDistance, shadingInfo, ceilingHeight, openDoors, voxelGrid, textures, occlusion,
-			frame);
-	}
+		// Near and far points in the XZ plane. The near point is where the wall is, and 
+		// the far point is used with the near point for drawing the floor and ceiling.
+		columnRays.nearPoints[slot] = Double2(
+			camera.eye.x + (ray.dirX * wallDistance),
+			camera.eye.z + (ray.dirZ * wallDistance));
+		columnRays.farPoints[slot] = Double2(
+			camera.eye.x + (ray.dirX * dda.zDistance),
+			camera.eye.z + (ray.dirZ * dda.zDistance));
+		columnRays.count++;
+	};
+
+	// Finds the batched intersections of the rays stepped across the voxel column, and
+	// draws all voxels in the column for each of them.
+	auto drawColumnRays = [startX, columnStep, &camera, &shadingInfo, ceilingHeight,
+		&voxelGrid, &textures, &occlusion, &frame, &ddas, &columnRays](
+		const VoxelColumnView &column)
+	{
+		SoftwareRenderer::findColumnIntersections(column, columnRays.count,
+			columnRays.nearFacings.data(), columnRays.nearPoints.data(),
+			columnRays.farPoints.data(), camera, columnRays.rayAngles.data(),
+			columnRays.intersections.data());
+
+		for (int slot = 0; slot < columnRays.count; slot++)
+		{
+			const int i = columnRays.rayIndices[slot];
+			const int x = startX + (i * columnStep);
+			SoftwareRenderer::drawVoxelColumn(x, column, columnRays.intersections[slot],
+				camera, columnRays.nearFacings[slot], columnRays.nearPoints[slot],
+				columnRays.farPoints[slot], columnRays.nearZs[slot], ddas[i].zDistance,
+				shadingInfo, ceilingHeight, voxelGrid, textures, occlusion[x], frame);
+		}
 
-	// The current voxel coordinate in the DDA loop. For all intents and purposes,
-	// the Y cell coordinate is constant.
-	Int3 cell(camera.eyeVoxel.x, camera.eyeVoxel.y, camera.eyeVoxel.z);
+		columnRays.count = 0;
+	};
+
+	// Voxel data of the column being drawn, one per voxel height.
+	std::vector<const VoxelData*> columnVoxelData(voxelGrid.getHeight());
+	VoxelColumnView column;
 
-	// Lambda for stepping to the next XZ coordinate in the grid and updating the Z
-	// distance for the current edge point.
-	auto doDDAStep = [&camera, &ray, &voxelGrid, &sideDistX, &sideDistZ, &cell,
-		&facing, &voxelIsValid, &zDistance, deltaDistX, deltaDistZ, stepX, stepZ,
-		nonNegativeDirX, nonNegativeDirZ]()
+	// Step the rays together while every active one is in the same voxel column, so the
+	// column's lookups are only done once.
+	while (true)
 	{
-		if (sideDistX < sideDistZ)
+		int activeCount = 0;
+		bool coherent = true;
+		Int2 sharedCell;
+		for (int i = 0; i < rayCount; i++)
 		{
-			sideDistX += deltaDistX;
-			cell.x += stepX;
-			facing = nonNegativeDirX ? VoxelData::Facing::NegativeX : 
-				VoxelData::Facing::PositiveX;
-			voxelIsValid &= (cell.x >= 0) && (cell.x < voxelGrid.getWidth());
+			if (isRayActive(i))
+			{
+				const Int2 cell(ddas[i].cell.x, ddas[i].cell.z);
+				if (activeCount == 0)
+				{
+					sharedCell = cell;
+				}
+				else if (cell != sharedCell)
+				{
+					coherent = false;
+					break;
+				}
+
+				activeCount++;
+			}
 		}
-		else
+
+		if (!coherent || (activeCount == 0))
 		{
-			sideDistZ += deltaDistZ;
-			cell.z += stepZ;
-			facing = nonNegativeDirZ ? VoxelData::Facing::NegativeZ : 
-				VoxelData::Facing::PositiveZ;
-			voxelIsValid &= (cell.z >= 0) && (cell.z < voxelGrid.getDepth());
+			break;
 		}
 
-		const bool onXAxis = (facing == VoxelData::Facing::PositiveX) || 
-			(facing == VoxelData::Facing::NegativeX);
-
-		// Update the Z distance depending on which axis was stepped with.
-		if (onXAxis)
+		const int emptySpan = voxelGrid.getEmptyColumnSpan(sharedCell.x, sharedCell.y);
+		if (emptySpan > 0)
 		{
-			zDistance = (static_cast<double>(cell.x) - 
-				camera.eye.x + static_cast<double>((1 - stepX) / 2)) / ray.dirX;
+			for (int i = 0; i < rayCount; i++)
+			{
+				if (isRayActive(i))
+				{
+					skipEmptyBlock(i, emptySpan);
+				}
+			}
+
+			continue;
 		}
-		else
+
+		column.init(sharedCell.x, sharedCell.y, voxelGrid, openDoors, shadingInfo,
+			columnVoxelData.data());
+
+		for (int i = 0; i < rayCount; i++)
 		{
-			zDistance = (static_cast<double>(cell.z) -
-				camera.eye.z + static_cast<double>((1 - stepZ) / 2)) / ray.dirZ;
+			if (isRayActive(i))
+			{
+				stepRayColumn(i, column);
+			}
 		}
-	};
 
-	// Step forward in the grid once to leave the initial voxel and update the Z distance.
-	doDDAStep();
+		drawColumnRays(column);
+	}
 
-	// Step through the voxel grid while the current coordinate is valid, the 
-	// distance stepped is less than the distance at which fog is maximum, and
-	// the column is not completely occluded.
-	while (voxelIsValid && (zDistance < shadingInfo.fogDistance) && 
-		(occlusion.yMin != occlusion.yMax))
+	// The rays diverged, so finish each one on its own.
+	for (int i = 0; i < rayCount; i++)
 	{
-		// Store the cell coordinates, axis, and Z distance for wall rendering. The
-		// loop needs to do another DDA step to calculate the far point.
-		const int savedCellX = cell.x;
-		const int savedCellZ = cell.z;
-		const VoxelData::Facing savedFacing = facing;
-		const double wallDistance = zDistance;
+		while (isRayActive(i))
+		{
+			const RayDDA &dda = ddas[i];
+			const int emptySpan = voxelGrid.getEmptyColumnSpan(dda.cell.x, dda.cell.z);
+			if (emptySpan > 0)
+			{
+				skipEmptyBlock(i, emptySpan);
+				continue;
+			}
 
-		// Decide which voxel in the XZ plane to step to next, and update the Z distance.
-		doDDAStep();
+			column.init(dda.cell.x, dda.cell.z, voxelGrid, openDoors, shadingInfo,
+				columnVoxelData.data());
+			stepRayColumn(i, column);
+			drawColumnRays(column);
+		}
+	}
 
-		// Near and far points in the XZ plane. The near point is where the wall is, and 
-		// the far point is used with the near point for drawing the floor and ceiling.
-		const Double2 nearPoint(
-			camera.eye.x + (ray.dirX * wallDistance),
-			camera.eye.z + (ray.dirZ * wallDistance));
-		const Double2 farPoint(
-			camera.eye.x + (ray.dirX * zDistance),
-			camera.eye.z + (ray.dirZ * zDistance));
+	// Fill in the pixels that columns stopped at the detail distance didn't get to from the
+	// column to their left, which is finished now.
+	for (int i = 0; i < rayCount; i++)
+	{
+		const RayDDA &dda = ddas[i];
+		if (!reducedDetail[i] || !dda.voxelIsValid || (dda.zDistance < detailDistance))
+		{
+			continue;
+		}
+
+		const int x = startX + i;
+		OcclusionData &columnOcclusion = occlusion[x];
+		for (int y = columnOcclusion.yMin; y < columnOcclusion.yMax; y++)
+		{
+			const int index = y + (x * frame.height);
+			const int leftIndex = index - frame.height;
+			frame.colorBuffer[index] = frame.colorBuffer[leftIndex];
+			frame.depthBuffer[index] = frame.depthBuffer[leftIndex];
+			if (frame.indexBuffer != nullptr)
+			{
+				frame.indexBuffer[index] = frame.indexBuffer[leftIndex];
+			}
+		}
 
-		// Draw all voxels in a column at the given XZ coordinate.
-		SoftwareRenderer::drawVoxelColumn(x, savedCellX, savedCellZ, camera, ray, savedFacing,
-			nearPoint, farPoint, wallDistance, zDistance, shadingInfo, ceilingHeight, 
-			openDoors, voxelGrid, textures, occlusion, frame);
+		columnOcclusion.yMin = columnOcclusion.yMax;
 	}
 }
 
-void SoftwareRenderer::drawSkyGradient(int startY, int endY, double gradientProjYTop,
+void SoftwareRenderer::updateSkyGradientRows(int startY, int endY, double gradientProjYTop,
 	double gradientProjYBottom, std::vector<Double3> &skyGradientRowCache,
+	std::vector<uint32_t> &skyGradientRowColorCache, bool rowCacheIsValid,
 	std::atomic<bool> &shouldDrawStars, const ShadingInfo &shadingInfo, const FrameView &frame)
 {
-	// Lambda for drawing one row of colors and depth in the frame buffer.
-	auto drawSkyRow = [&frame](int y, const Double3 &color)
-	{
-		uint32_t *colorPtr = frame.colorBuffer;
-		double *depthPtr = frame.depthBuffer;
-		const int startIndex = y * frame.width;
-		const int endIndex = (y + 1) * frame.width;
-		const uint32_t colorValue = color.toRGB();
-		constexpr double depthValue = std::numeric_limits<double>::infinity();
-
-		// Clear the color and depth of one row.
-		for (int i = startIndex; i < endIndex; i++)
-		{
-			colorPtr[i] = colorValue;
-			depthPtr[i] = depthValue;
-		}
-	};
-
-	// While drawing the sky gradient, determine if it is dark enough for stars to be visible.
+	// While updating the sky gradient, determine if it is dark enough for stars to be visible.
 	bool isDarkEnough = false;
 
 	for (int y = startY; y < endY; y++)
 	{
-		// Y percent across the screen.
-		const double yPercent = (static_cast<double>(y) + 0.50) / frame.heightReal;
+		if (!rowCacheIsValid)
+		{
+			// Y percent across the screen.
+			const double yPercent = (static_cast<double>(y) + 0.50) / frame.heightReal;
 
-		// Y percent within the sky gradient.
-		const double gradientPercent = SoftwareRenderer::getSkyGradientPercent(
-			yPercent, gradientProjYTop, gradientProjYBottom);
+			// Y percent within the sky gradient.
+			const double gradientPercent = SoftwareRenderer::getSkyGradientPercent(
+				yPercent, gradientProjYTop, gradientProjYBottom);
 
-		// Color of the sky gradient at the given percentage.
-		const Double3 color = SoftwareRenderer::getSkyGradientRowColor(
-			gradientPercent, shadingInfo);
+			// Color of the sky gradient at the given percentage.
+			const Double3 color = SoftwareRenderer::getSkyGradientRowColor(
+				gradientPercent, shadingInfo);
 
-		// Cache row color for star rendering.
-		skyGradientRowCache.at(y) = color;
+			// Cache row color for star rendering and later frames.
+			skyGradientRowCache.at(y) = color;
+			skyGradientRowColorCache.at(y) = color.toRGB();
+		}
 
 		// Update star visibility.
+		const Double3 &color = skyGradientRowCache[y];
 		const double maxComp = std::max(std::max(color.x, color.y), color.z);
 		isDarkEnough |= maxComp <= ShadingInfo::STAR_VIS_THRESHOLD;
-
-		drawSkyRow(y, color);
 	}
 
 	if (isDarkEnough)
@@ -6142,6 +9765,29 @@ void SoftwareRenderer::drawSkyGradient(int startY, int endY, double gradientProj
 	}
 }
 
+void SoftwareRenderer::drawSkyGradient(int startX, int endX,
+	const std::vector<uint32_t> &skyGradientRowColorCache, const FrameView &frame)
+{
+	constexpr float depthValue = std::numeric_limits<float>::infinity();
+
+	for (int x = startX; x < endX; x++)
+	{
+		// Clear the color and depth of one column. Its colors are the row colors in order.
+		const int startIndex = x * frame.height;
+		const int endIndex = startIndex + frame.height;
+		std::copy(skyGradientRowColorCache.begin(),
+			skyGradientRowColorCache.begin() + frame.height, frame.colorBuffer + startIndex);
+		std::fill(frame.depthBuffer + startIndex, frame.depthBuffer + endIndex, depthValue);
+
+		// In palette mode, the sky is left as colors by the resolve pass.
+		if (frame.indexBuffer != nullptr)
+		{
+			std::fill(frame.indexBuffer + startIndex, frame.indexBuffer + endIndex,
+				ShadeTable::NO_INDEX);
+		}
+	}
+}
+
 void SoftwareRenderer::drawDistantSky(int startX, int endX, bool parallaxSky, 
 	const VisDistantObjects &visDistantObjs, const std::vector<SkyTexture> &skyTextures,
 	const std::vector<Double3> &skyGradientRowCache, bool shouldDrawStars,
@@ -6189,144 +9835,553 @@ void SoftwareRenderer::drawDistantSky(int startX, int endX, bool parallaxSky,
 					SoftwareRenderer::drawDistantPixels(x, drawRange, u, 0.0,
 						Constants::JustBelowOne, texture, emissive, shadingInfo, frame);
 				}
-				else if (renderType == DistantRenderType::Moon)
+				else if (renderType == DistantRenderType::Moon)
+				{
+					SoftwareRenderer::drawMoonPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
+						texture, shadingInfo, frame);
+				}
+				else if (renderType == DistantRenderType::Star)
+				{
+					SoftwareRenderer::drawStarPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
+						texture, skyGradientRowCache, shadingInfo, frame);
+				}
+			}
+		}
+		else
+		{
+			// Classic rendering. Render the object based on its midpoint.
+			for (int x = xDrawStart; x < xDrawEnd; x++)
+			{
+				// Percent X across the screen.
+				const double xPercent = (static_cast<double>(x) + 0.50) / frame.widthReal;
+
+				// Percentage across the horizontal span of the object in screen space.
+				const double widthPercent = std::clamp(
+					(xPercent - xProjStart) / (xProjEnd - xProjStart),
+					0.0, Constants::JustBelowOne);
+
+				// Horizontal texture coordinate, not accounting for parallax.
+				const double u = widthPercent;
+
+				if (renderType == DistantRenderType::General)
+				{
+					SoftwareRenderer::drawDistantPixels(x, drawRange, u, 0.0,
+						Constants::JustBelowOne, texture, emissive, shadingInfo, frame);
+				}
+				else if (renderType == DistantRenderType::Moon)
+				{
+					SoftwareRenderer::drawMoonPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
+						texture, shadingInfo, frame);
+				}
+				else if (renderType == DistantRenderType::Star)
+				{
+					SoftwareRenderer::drawStarPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
+						texture, skyGradientRowCache, shadingInfo, frame);
+				}
+			}
+		}
+	};
+
+	// Lambda for drawing a group of distant objects with some render type.
+	auto drawDistantObjRange = [&visDistantObjs, &drawDistantObj](int start, int end,
+		DistantRenderType renderType)
+	{
+		DebugAssert(start >= 0);
+		DebugAssert(end <= visDistantObjs.objs.size());
+
+		// Reverse iterate so objects are drawn far to near.
+		const VisDistantObject *objs = visDistantObjs.objs.data();
+		for (int i = end - 1; i >= start; i--)
+		{
+			drawDistantObj(objs[i], renderType);
+		}
+	};
+
+	// Stars are only drawn when the sky gradient is dark enough. This saves on performance during
+	// the daytime.
+	if (shouldDrawStars)
+	{
+		drawDistantObjRange(visDistantObjs.starStart, visDistantObjs.starEnd, DistantRenderType::Star);
+	}
+
+	drawDistantObjRange(visDistantObjs.sunStart, visDistantObjs.sunEnd, DistantRenderType::General);
+	drawDistantObjRange(visDistantObjs.moonStart, visDistantObjs.moonEnd, DistantRenderType::Moon);
+	drawDistantObjRange(visDistantObjs.airStart, visDistantObjs.airEnd, DistantRenderType::General);
+	drawDistantObjRange(visDistantObjs.animLandStart, visDistantObjs.animLandEnd, DistantRenderType::General);
+	drawDistantObjRange(visDistantObjs.landStart, visDistantObjs.landEnd, DistantRenderType::General);
+}
+
+void SoftwareRenderer::drawVoxels(int startX, int endX, int columnStep, const Camera &camera,
+	double ceilingHeight, double detailDistance, const LevelData::OpenDoors &openDoors,
+	const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &voxelTextures,
+	std::vector<OcclusionData> &occlusion, const ShadingInfo &shadingInfo, const FrameView &frame)
+{
+	const Double2 forwardZoomed(camera.forwardZoomedX, camera.forwardZoomedZ);
+	const Double2 rightAspected(camera.rightAspectedX, camera.rightAspectedZ);
+
+	// Adjacent columns nearly always cross the same voxels, so their rays are cast in packets.
+	const int packetWidth = SoftwareRenderer::RAY_PACKET_SIZE * columnStep;
+	for (int packetStartX = startX; packetStartX < endX; packetStartX += packetWidth)
+	{
+		std::array<Ray, SoftwareRenderer::RAY_PACKET_SIZE> rays;
+		int rayCount = 0;
+
+		const int packetEndX = std::min(packetStartX + packetWidth, endX);
+		for (int x = packetStartX; x < packetEndX; x += columnStep)
+		{
+			// X percent across the screen.
+			const double xPercent = (static_cast<double>(x) + 0.50) / frame.widthReal;
+
+			// "Right" component of the ray direction, based on current screen X.
+			const Double2 rightComp = rightAspected * ((2.0 * xPercent) - 1.0);
+
+			// Calculate the ray direction through the pixel.
+			// - If un-normalized, it uses the Z distance, but the insides of voxels
+			//   don't look right then.
+			const Double2 direction = (forwardZoomed + rightComp).normalized();
+			rays[rayCount] = Ray(direction.x, direction.y);
+			rayCount++;
+		}
+
+		// Cast the 2D rays and fill in the columns' pixels with color.
+		SoftwareRenderer::rayCast2D(packetStartX, columnStep, rayCount, camera, rays.data(),
+			shadingInfo, ceilingHeight, detailDistance, openDoors, voxelGrid, voxelTextures,
+			occlusion, frame);
+	}
+}
+
+void SoftwareRenderer::drawScanlinePlanes(int startX, int endX, int columnStep,
+	const Camera &camera, double ceilingHeight, const VoxelGrid &voxelGrid,
+	const std::vector<VoxelTexture> &voxelTextures, const ShadingInfo &shadingInfo,
+	const FrameView &frame)
+{
+	const Double2 eye(camera.eye.x, camera.eye.z);
+	const Double2 forwardZoomed(camera.forwardZoomedX, camera.forwardZoomedZ);
+	const Double2 rightAspected(camera.rightAspectedX, camera.rightAspectedZ);
+	const double horizonY = (0.50 + camera.yShear) * frame.heightReal;
+
+	// Unnormalized ray direction of the first column, and how much it changes per column.
+	const double startXPercent = (static_cast<double>(startX) + 0.50) / frame.widthReal;
+	const Double2 startDirection = forwardZoomed + (rightAspected * ((2.0 * startXPercent) - 1.0));
+	const Double2 directionStep = rightAspected *
+		((2.0 * static_cast<double>(columnStep)) / frame.widthReal);
+
+	const PixelReal zero = static_cast<PixelReal>(0.0);
+	const PixelReal justBelowOne = SoftwareRenderer::PIXEL_JUST_BELOW_ONE;
+	const ShadingInfo::FogSample &fullFogSample = shadingInfo.fogSamples.back();
+
+	auto drawPlane = [&](int voxelY, double planeY, VoxelDataType dataType, const Double3 &normal)
+	{
+		// A point on the plane projects to (horizonY + (probeOffset / cameraDepth)), where the
+		// probe is the point on the plane one unit in front of the camera. Each row therefore
+		// has one camera depth.
+		const Double3 probePoint(camera.eye.x + camera.forwardX, planeY,
+			camera.eye.z + camera.forwardZ);
+		const double probeOffset = (SoftwareRenderer::getProjectedY(
+			probePoint, camera.transform, camera.yShear) * frame.heightReal) - horizonY;
+
+		// Contribution from the sun, the same across the whole plane.
+		const double lightNormalDot = std::max(0.0, shadingInfo.sunDirection.dot(normal));
+		const Double3 sunComponent = (shadingInfo.sunColor * lightNormalDot).clamped(
+			0.0, 1.0 - shadingInfo.ambient);
+
+		const double lightY = planeY + ((normal.y > 0.0) ? -0.50 : 0.50) * ceilingHeight;
+
+		for (int y = 0; y < frame.height; y++)
+		{
+			// Rows on the other side of the horizon can't see the plane.
+			const double rowOffset = (static_cast<double>(y) + 0.50) - horizonY;
+			if ((rowOffset * probeOffset) <= 0.0)
+			{
+				continue;
+			}
+
+			// Distance along the unnormalized ray direction to the plane. Points step linearly
+			// across the row, and the depth is the XZ distance like the ray cast columns use.
+			const double cameraDepth = probeOffset / rowOffset;
+			const double rowScale = cameraDepth / camera.zoom;
+			Double2 direction = startDirection;
+			const Double2 pointStep = directionStep * rowScale;
+
+			// Mip level from how many texels each pixel steps across the plane, either to the
+			// next column or (near the horizon, usually farther) to the next row.
+			const double columnStepLength = pointStep.length() / static_cast<double>(columnStep);
+			const double rowStepLength = forwardZoomed.length() * rowScale / std::abs(rowOffset);
+			const int mipLevel = VoxelTexture::getMipLevel(std::max(columnStepLength,
+				rowStepLength) * static_cast<double>(VoxelTexture::WIDTH));
+			const int mipWidth = VoxelTexture::WIDTH >> mipLevel;
+			const int mipHeight = VoxelTexture::HEIGHT >> mipLevel;
+			const int mipOffset = VoxelTexture::getMipOffset(mipLevel);
+			const PixelReal mipWidthReal = static_cast<PixelReal>(mipWidth);
+			const PixelReal mipHeightReal = static_cast<PixelReal>(mipHeight);
+
+			// Voxel and lighting values, only looked up again when the row enters another cell.
+			int cellX = -1;
+			int cellZ = -1;
+			const VoxelTexture *texture = nullptr;
+			Double3 shading;
+			double lightPercent = 0.0;
+
+			for (int x = startX; x < endX; x += columnStep, direction = direction + directionStep)
+			{
+				const Double2 point = eye + (direction * rowScale);
+				const int pointCellX = static_cast<int>(std::floor(point.x));
+				const int pointCellZ = static_cast<int>(std::floor(point.y));
+				if ((pointCellX != cellX) || (pointCellZ != cellZ))
+				{
+					cellX = pointCellX;
+					cellZ = pointCellZ;
+					texture = nullptr;
+
+					const bool insideGrid = (cellX >= 0) && (cellX < voxelGrid.getWidth()) &&
+						(cellZ >= 0) && (cellZ < voxelGrid.getDepth());
+					if (insideGrid)
+					{
+						// Chasms and other voxel types are left to the ray cast columns.
+						const uint16_t voxelID = voxelGrid.getVoxel(cellX, voxelY, cellZ);
+						const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+						if (voxelData.dataType == dataType)
+						{
+							const int textureID = (dataType == VoxelDataType::Floor) ?
+								voxelData.floor.id : voxelData.ceiling.id;
+							texture = &shadingInfo.getVoxelTexture(voxelTextures, textureID);
+
+							const Double3 cellCenter(static_cast<double>(cellX) + 0.50, lightY,
+								static_cast<double>(cellZ) + 0.50);
+							Double3 lightColor = Double3::Zero;
+
+							const std::vector<Double3> *bakedColumn =
+								shadingInfo.getBakedVoxelColumn(cellX, cellZ);
+							if (bakedColumn != nullptr)
+							{
+								lightColor = shadingInfo.lightMap.getAverageFaceColor(
+									*bakedColumn, cellCenter.y);
+							}
+
+							const std::vector<const Light*> *lights =
+								shadingInfo.getVoxelColumnLights(cellX, cellZ);
+							if (lights != nullptr)
+							{
+								lightColor = lightColor +
+									ShadingInfo::getLightColor(cellCenter, *lights);
+							}
+
+							shading = Double3(
+								shadingInfo.ambient + sunComponent.x + lightColor.x,
+								shadingInfo.ambient + sunComponent.y + lightColor.y,
+								shadingInfo.ambient + sunComponent.z + lightColor.z);
+							lightPercent = std::max({ shading.x, shading.y, shading.z });
+						}
+					}
+				}
+
+				if (texture == nullptr)
 				{
-					SoftwareRenderer::drawMoonPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
-						texture, shadingInfo, frame);
+					continue;
 				}
-				else if (renderType == DistantRenderType::Star)
+
+				const int index = y + (x * frame.height);
+				const double depth = direction.length() * rowScale;
+				const float depthValue = static_cast<float>(depth);
+				if (depthValue > frame.depthBuffer[index])
 				{
-					SoftwareRenderer::drawStarPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
-						texture, skyGradientRowCache, shadingInfo, frame);
+					continue;
 				}
-			}
-		}
-		else
-		{
-			// Classic rendering. Render the object based on its midpoint.
-			for (int x = xDrawStart; x < xDrawEnd; x++)
-			{
-				// Percent X across the screen.
-				const double xPercent = (static_cast<double>(x) + 0.50) / frame.widthReal;
-
-				// Percentage across the horizontal span of the object in screen space.
-				const double widthPercent = std::clamp(
-					(xPercent - xProjStart) / (xProjEnd - xProjStart),
-					0.0, Constants::JustBelowOne);
-
-				// Horizontal texture coordinate, not accounting for parallax.
-				const double u = widthPercent;
 
-				if (renderType == DistantRenderType::General)
+				const ShadingInfo::FogSample &fogSample = shadingInfo.fogEnabled ?
+					shadingInfo.getFogSample(depth) : shadingInfo.fogSamples.front();
+				const bool fullFog = shadingInfo.fogEnabled && (&fogSample == &fullFogSample);
+
+				// Texture coordinates, the same as drawPerspectivePixels() gives a plane.
+				const PixelReal pointX = static_cast<PixelReal>(point.x);
+				const PixelReal pointZ = static_cast<PixelReal>(point.y);
+				const PixelReal u = std::clamp(
+					justBelowOne - (pointX - std::floor(pointX)), zero, justBelowOne);
+				const PixelReal v = std::clamp(
+					justBelowOne - (pointZ - std::floor(pointZ)), zero, justBelowOne);
+				const int textureX = static_cast<int>(u * mipWidthReal);
+				const int textureY = static_cast<int>(v * mipHeightReal);
+				const int textureIndex = VoxelTexture::getTexelIndex(textureX, textureY, mipHeight);
+				const VoxelTexel &texel =
+					(texture->getTexels(shadingInfo.nightLightsActive) + mipOffset)[textureIndex];
+
+				if (frame.indexBuffer != nullptr)
 				{
-					SoftwareRenderer::drawDistantPixels(x, drawRange, u, 0.0,
-						Constants::JustBelowOne, texture, emissive, shadingInfo, frame);
+					if (fullFog)
+					{
+						frame.indexBuffer[index] = ShadeTable::getIndexValue(0, 0.0, 1.0);
+					}
+					else
+					{
+						const uint8_t paletteIndex = (texture->getPaletteIndices(
+							shadingInfo.nightLightsActive) + mipOffset)[textureIndex];
+						const double fogPercent = shadingInfo.fogEnabled ?
+							(1.0 - fogSample.colorPercent) : 0.0;
+						frame.indexBuffer[index] = ShadeTable::getIndexValue(paletteIndex,
+							lightPercent + texel.getEmission(), fogPercent);
+					}
 				}
-				else if (renderType == DistantRenderType::Moon)
+				else if (shadingInfo.fogEnabled)
 				{
-					SoftwareRenderer::drawMoonPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
-						texture, shadingInfo, frame);
+					frame.colorBuffer[index] = SoftwareRenderer::getShadedVoxelTexelColor<true>(
+						texel, shading, fogSample);
 				}
-				else if (renderType == DistantRenderType::Star)
+				else
 				{
-					SoftwareRenderer::drawStarPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
-						texture, skyGradientRowCache, shadingInfo, frame);
+					frame.colorBuffer[index] = SoftwareRenderer::getShadedVoxelTexelColor<false>(
+						texel, shading, fogSample);
 				}
+
+				frame.depthBuffer[index] = depthValue;
 			}
 		}
 	};
 
-	// Lambda for drawing a group of distant objects with some render type.
-	auto drawDistantObjRange = [&visDistantObjs, &drawDistantObj](int start, int end,
-		DistantRenderType renderType)
-	{
-		DebugAssert(start >= 0);
-		DebugAssert(end <= visDistantObjs.objs.size());
-
-		// Reverse iterate so objects are drawn far to near.
-		const VisDistantObject *objs = visDistantObjs.objs.data();
-		for (int i = end - 1; i >= start; i--)
-		{
-			drawDistantObj(objs[i], renderType);
-		}
-	};
+	// Each plane is only visible from its open side.
+	const double floorY = static_cast<double>(SoftwareRenderer::SCANLINE_FLOOR_Y + 1) *
+		ceilingHeight;
+	const double ceilingY = static_cast<double>(SoftwareRenderer::SCANLINE_CEILING_Y) *
+		ceilingHeight;
 
-	// Stars are only drawn when the sky gradient is dark enough. This saves on performance during
-	// the daytime.
-	if (shouldDrawStars)
+	if (camera.eye.y > floorY)
 	{
-		drawDistantObjRange(visDistantObjs.starStart, visDistantObjs.starEnd, DistantRenderType::Star);
+		drawPlane(SoftwareRenderer::SCANLINE_FLOOR_Y, floorY, VoxelDataType::Floor,
+			Double3::UnitY);
 	}
 
-	drawDistantObjRange(visDistantObjs.sunStart, visDistantObjs.sunEnd, DistantRenderType::General);
-	drawDistantObjRange(visDistantObjs.moonStart, visDistantObjs.moonEnd, DistantRenderType::Moon);
-	drawDistantObjRange(visDistantObjs.airStart, visDistantObjs.airEnd, DistantRenderType::General);
-	drawDistantObjRange(visDistantObjs.animLandStart, visDistantObjs.animLandEnd, DistantRenderType::General);
-	drawDistantObjRange(visDistantObjs.landStart, visDistantObjs.landEnd, DistantRenderType::General);
+	if ((camera.eye.y < ceilingY) &&
+		(SoftwareRenderer::SCANLINE_CEILING_Y < voxelGrid.getHeight()))
+	{
+		drawPlane(SoftwareRenderer::SCANLINE_CEILING_Y, ceilingY, VoxelDataType::Ceiling,
+			-Double3::UnitY);
+	}
 }
 
-void SoftwareRenderer::drawVoxels(int startX, int stride, const Camera &camera,
-	double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
-	const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &voxelTextures,
-	std::vector<OcclusionData> &occlusion, const ShadingInfo &shadingInfo, const FrameView &frame)
+void SoftwareRenderer::updateVoxelHistory(int startX, int endX, const Camera &camera,
+	VoxelHistory &history, int columnParity, bool reprojectHistory, const FrameView &frame)
 {
+	const int previousIndex = history.bufferIndex;
+	const int currentIndex = previousIndex ^ 1;
+	const uint32_t *previousColors = history.colorBuffers[previousIndex].data();
+	const float *previousDepths = history.depthBuffers[previousIndex].data();
+	uint32_t *currentColors = history.colorBuffers[currentIndex].data();
+	float *currentDepths = history.depthBuffers[currentIndex].data();
+
+	const Double2 forward(camera.forwardX, camera.forwardZ);
 	const Double2 forwardZoomed(camera.forwardZoomedX, camera.forwardZoomedZ);
 	const Double2 rightAspected(camera.rightAspectedX, camera.rightAspectedZ);
 
-	// Draw pixel columns with spacing determined by the number of render threads.
-	for (int x = startX; x < frame.width; x += stride)
+	// Reprojection needs the same vertical shear, so both frames share a horizon row.
+	const double horizonY = (0.50 + camera.yShear) * frame.heightReal;
+
+	// Gets the column in the previous frame that was ray cast closest to where the given
+	// column's ray points, or -1 if it was off-screen. Columns that were themselves filled in
+	// are never used, so reprojected pixels are at most one frame old. Also gets how much
+	// deeper things along the ray are now than they were in the previous frame.
+	auto getPreviousColumn = [&history, &frame, &forward, &forwardZoomed, &rightAspected](int x,
+		double *outDepthRatio)
 	{
-		// X percent across the screen.
 		const double xPercent = (static_cast<double>(x) + 0.50) / frame.widthReal;
+		const Double2 direction = forwardZoomed + (rightAspected * ((2.0 * xPercent) - 1.0));
+
+		// Inverse of the ray direction calculation, using the previous camera.
+		const double forwardDist = direction.dot(history.forward);
+		if (forwardDist <= 0.0)
+		{
+			return -1;
+		}
+
+		*outDepthRatio = direction.dot(forward) / forwardDist;
 
-		// "Right" component of the ray direction, based on current screen X.
-		const Double2 rightComp = rightAspected * ((2.0 * xPercent) - 1.0);
+		const double previousRightPercent =
+			((direction.dot(history.right) / forwardDist) * history.zoom) / history.aspect;
+		const double previousXReal =
+			(((previousRightPercent + 1.0) * 0.50) * frame.widthReal) - 0.50;
+
+		const int previousX = [&history, previousXReal]()
+		{
+			if (history.columnParity < 0)
+			{
+				return static_cast<int>(std::round(previousXReal));
+			}
+			else
+			{
+				const double parityReal = static_cast<double>(history.columnParity);
+				return (static_cast<int>(std::round((previousXReal - parityReal) * 0.50)) * 2) +
+					history.columnParity;
+			}
+		}();
+
+		return ((previousX >= 0) && (previousX < frame.width)) ? previousX : -1;
+	};
+
+	// The frame and history buffers are column-major, so each column is one contiguous copy.
+	auto copyColumn = [&frame](const uint32_t *srcColors, const float *srcDepths, int srcX,
+		uint32_t *dstColors, float *dstDepths, int dstX)
+	{
+		const int srcIndex = srcX * frame.height;
+		const int dstIndex = dstX * frame.height;
+		std::copy(srcColors + srcIndex, srcColors + srcIndex + frame.height, dstColors + dstIndex);
+		std::copy(srcDepths + srcIndex, srcDepths + srcIndex + frame.height, dstDepths + dstIndex);
+	};
+
+	// A column's height on screen is inversely proportional to its forward depth, which
+	// changes with the viewing angle when turning, so the previous column's rows are scaled
+	// about the horizon by the ratio of the two depths. Otherwise the reprojected columns would
+	// be a little too tall or short next to the ray cast ones.
+	auto reprojectColumn = [&frame, horizonY, previousColors, previousDepths](int srcX,
+		int dstX, double depthRatio)
+	{
+		const uint32_t *srcColors = previousColors + (srcX * frame.height);
+		const float *srcDepths = previousDepths + (srcX * frame.height);
+		uint32_t *dstColors = frame.colorBuffer + (dstX * frame.height);
+		float *dstDepths = frame.depthBuffer + (dstX * frame.height);
+		const float depthScale = static_cast<float>(depthRatio);
+
+		for (int y = 0; y < frame.height; y++)
+		{
+			const double srcYReal = horizonY +
+				(((static_cast<double>(y) + 0.50) - horizonY) * depthRatio);
+			const int srcY = std::clamp(static_cast<int>(std::floor(srcYReal)), 0,
+				frame.height - 1);
+			dstColors[y] = srcColors[srcY];
+			dstDepths[y] = srcDepths[srcY] * depthScale;
+		}
+	};
 
-		// Calculate the ray direction through the pixel.
-		// - If un-normalized, it uses the Z distance, but the insides of voxels
-		//   don't look right then.
-		const Double2 direction = (forwardZoomed + rightComp).normalized();
-		const Ray ray(direction.x, direction.y);
+	for (int x = startX; x < endX; x++)
+	{
+		const bool wasRayCast = (columnParity < 0) || ((x & 1) == columnParity);
+		if (wasRayCast)
+		{
+			// Save the column for the next frame.
+			copyColumn(frame.colorBuffer, frame.depthBuffer, x, currentColors, currentDepths, x);
+			continue;
+		}
 
-		// Cast the 2D ray and fill in the column's pixels with color.
-		SoftwareRenderer::rayCast2D(x, camera, ray, shadingInfo, ceilingHeight, openDoors,
-			voxelGrid, voxelTextures, occlusion.at(x), frame);
+		double depthRatio = 1.0;
+		const int previousX = reprojectHistory ? getPreviousColumn(x, &depthRatio) : -1;
+		if (previousX >= 0)
+		{
+			// Reuse the previous frame's column.
+			reprojectColumn(previousX, x, depthRatio);
+		}
+		else
+		{
+			// Copy a neighboring column that was ray cast this frame. Render threads only
+			// write to skipped columns here, so reading across thread ranges is safe.
+			const int neighborX = (x > 0) ? (x - 1) : (x + 1);
+			copyColumn(frame.colorBuffer, frame.depthBuffer, neighborX, frame.colorBuffer,
+				frame.depthBuffer, x);
+		}
 	}
 }
 
 void SoftwareRenderer::drawFlats(int startX, int endX, const Camera &camera,
 	const Double3 &flatNormal, const std::vector<VisibleFlat> &visibleFlats,
-	const std::vector<FlatTexture> &flatTextures, const ShadingInfo &shadingInfo,
-	const FrameView &frame)
+	const std::vector<int> &flatIndices, const std::vector<FlatTexture> &flatTextures,
+	const ShadingInfo &shadingInfo, const FlatOcclusion &occlusion, const FrameView &frame)
 {
-	// Iterate through all flats, rendering those visible within the given X range of 
+	// Iterate through the given flats, rendering those visible within the given X range of
 	// the screen.
-	for (const auto &visibleFlat : visibleFlats)
+	for (const int flatIndex : flatIndices)
 	{
+		const VisibleFlat &visibleFlat = visibleFlats[flatIndex];
 		const Flat &flat = visibleFlat.getFlat();
 		const Flat::Frame &flatFrame = visibleFlat.getFrame();
 
 		// Texture of the flat. It might be flipped horizontally as well, given by
 		// the "flat.flipped" value.
-		const FlatTexture &texture = flatTextures.at(flat.textureID);
+		const FlatTexture &texture = getTexture(flatTextures, flat.textureID);
+		DebugValidate(flat.frameIndex < std::max(texture.frameCount, 1));
 
 		const Double2 eye2D(camera.eye.x, camera.eye.z);
 
-		SoftwareRenderer::drawFlat(startX, endX, flatFrame, flatNormal, flat.flipped,
-			eye2D, shadingInfo, texture, frame);
+		// Light from point lights, sampled at the flat's center.
+		const Double3 flatLight = [&flat, &shadingInfo]()
+		{
+			const int voxelX = static_cast<int>(std::floor(flat.position.x));
+			const int voxelZ = static_cast<int>(std::floor(flat.position.z));
+			const Double3 flatCenter(flat.position.x, flat.position.y + (flat.height * 0.50),
+				flat.position.z);
+
+			Double3 lightColor = Double3::Zero;
+
+			const std::vector<Double3> *bakedColumn =
+				shadingInfo.getBakedVoxelColumn(voxelX, voxelZ);
+			if (bakedColumn != nullptr)
+			{
+				lightColor = shadingInfo.lightMap.getAverageFaceColor(*bakedColumn, flatCenter.y);
+			}
+
+			const std::vector<const Light*> *lights =
+				shadingInfo.getVoxelColumnLights(voxelX, voxelZ);
+			if (lights != nullptr)
+			{
+				lightColor = lightColor + ShadingInfo::getLightColor(flatCenter, *lights);
+			}
+
+			return lightColor;
+		}();
+
+		if (shadingInfo.fogEnabled)
+		{
+			SoftwareRenderer::drawFlat<true>(startX, endX, flatFrame, flatNormal, flatLight,
+				flat.flipped, eye2D, shadingInfo, texture, flat.frameIndex, occlusion, frame);
+		}
+		else
+		{
+			SoftwareRenderer::drawFlat<false>(startX, endX, flatFrame, flatNormal, flatLight,
+				flat.flipped, eye2D, shadingInfo, texture, flat.frameIndex, occlusion, frame);
+		}
+	}
+}
+
+void SoftwareRenderer::resolvePaletteIndices(int startX, int endX, const ShadeTable &shadeTable,
+	const FrameView &frame)
+{
+	const uint32_t *shadeColors = shadeTable.colors.data();
+
+	// The columns are next to each other in the buffers, so the range is one span of pixels.
+	const int startIndex = startX * frame.height;
+	const int endIndex = endX * frame.height;
+	for (int i = startIndex; i < endIndex; i++)
+	{
+		const uint16_t indexValue = frame.indexBuffer[i];
+		if (indexValue != ShadeTable::NO_INDEX)
+		{
+			frame.colorBuffer[i] = shadeColors[indexValue];
+		}
 	}
 }
 
-void SoftwareRenderer::renderThreadLoop(RenderThreadData &threadData, int threadIndex, int startX,
-	int endX, int startY, int endY)
+void SoftwareRenderer::transposeFrame(int startX, int endX, const FrameView &frame)
+{
+	TransposePixelsKernel.get()(frame.colorBuffer, frame.outputBuffer, frame.width,
+		frame.height, startX, endX);
+}
+
+void SoftwareRenderer::renderThreadLoop(RenderThreadData &threadData, int threadIndex, int core,
+	bool highPriority)
 {
+	// Only the first thread warns so the log isn't written from every thread at once.
+	if ((core >= 0) && !Platform::setCurrentThreadAffinity(std::vector<int> { core }) &&
+		(threadIndex == 0))
+	{
+		DebugLogWarning("Couldn't pin render threads to their cores.");
+	}
+
+	if (highPriority && !Platform::raiseCurrentThreadPriority() && (threadIndex == 0))
+	{
+		DebugLogWarning("Couldn't raise render thread priority.");
+	}
+
+	Profiler::setThreadName("Render " + std::to_string(threadIndex));
+
 	while (true)
 	{
-		// Initial wait condition. The lock must be unlocked after wait() so other threads can
-		// lock it.
-		std::unique_lock<std::mutex> lk(threadData.mutex);
-		threadData.condVar.wait(lk, [&threadData]() { return threadData.go; });
-		lk.unlock();
+		// Initial wait condition.
+		threadData.waitUntil([&threadData]() { return threadData.go.load(); });
 
 		// Received a go signal. Check if the renderer is being destroyed before doing anything.
 		if (threadData.isDestructing)
@@ -6334,87 +10389,198 @@ void SoftwareRenderer::renderThreadLoop(RenderThreadData &threadData, int thread
 			break;
 		}
 
-		// Lambda for making a thread wait until others are finished rendering something. The last
-		// thread to call this calls notify on all others.
-		auto threadBarrier = [&threadData, &lk](auto &data)
+		// The go signal might be for a job instead of a frame.
+		RenderThreadData::Job &job = threadData.job;
+		if (job.batchFunction != nullptr)
 		{
-			lk.lock();
-			data.threadsDone++;
+			job.runBatches();
+			threadData.arrive(job.threadsDone);
 
-			// If this was the last thread, notify all to continue.
-			if (data.threadsDone == threadData.totalThreads)
-			{
-				lk.unlock();
-				threadData.condVar.notify_all();
-			}
-			else
+			// Wait for the go signal to be taken back so the job isn't started again, then
+			// tell the calling thread it's safe to clear the job.
+			threadData.waitUntil([&threadData]() { return !threadData.go.load(); });
+			threadData.arrive(job.threadsReleased);
+			continue;
+		}
+
+		// This frame's columns and rows for the thread.
+		const RenderThreadData::ThreadRange &range = threadData.ranges[threadIndex];
+		const int startX = range.startX;
+		const int endX = range.endX;
+		const int startY = range.startY;
+		const int endY = range.endY;
+
+		// Lambda for making a thread wait until others are finished rendering something.
+		auto threadBarrier = [&threadData](auto &data)
+		{
+			threadData.arrive(data.threadsDone);
+			threadData.waitUntil([&threadData, &data]()
 			{
-				// Wait for other threads to finish.
-				threadData.condVar.wait(lk, [&threadData, &data]()
-				{
-					return data.threadsDone == threadData.totalThreads;
-				});
+				return data.threadsDone == threadData.totalThreads;
+			});
+		};
 
-				lk.unlock();
-			}
+		// Lambda for timing consecutive parts of this thread's frame. Adds the time since the
+		// previous call to the given phase.
+		RenderTimings &timings = *threadData.timings;
+		auto lapTime = std::chrono::high_resolution_clock::now();
+		auto endLap = [&timings, threadIndex, &lapTime](RenderTimings::Phase phase)
+		{
+			const auto now = std::chrono::high_resolution_clock::now();
+			const std::chrono::duration<double> lapDuration = now - lapTime;
+			timings.addThreadTime(threadIndex, phase, lapDuration.count());
+#if defined(TES_PROFILER)
+			Profiler::recordZone(getProfilerPhaseName(phase), lapTime, now);
+#endif
+			lapTime = now;
 		};
 
-		// Draw this thread's portion of the sky gradient.
+		// Update this thread's rows of the sky gradient.
 		RenderThreadData::SkyGradient &skyGradient = threadData.skyGradient;
-		SoftwareRenderer::drawSkyGradient(startY, endY, skyGradient.projectedYTop,
-			skyGradient.projectedYBottom, *skyGradient.rowCache, skyGradient.shouldDrawStars,
-			*threadData.shadingInfo, *threadData.frame);
-
-		// Wait for other threads to finish the sky gradient.
+		SoftwareRenderer::updateSkyGradientRows(startY, endY, skyGradient.projectedYTop,
+			skyGradient.projectedYBottom, *skyGradient.rowCache, *skyGradient.rowColorCache,
+			skyGradient.rowCacheIsValid, skyGradient.shouldDrawStars, *threadData.shadingInfo,
+			*threadData.frame);
+		endLap(RenderTimings::Phase::SkyGradient);
+
+		// Every row is needed for drawing this thread's columns of the sky gradient. The main
+		// thread waits on the same counter before letting distant objects be drawn.
 		threadBarrier(skyGradient);
+		endLap(RenderTimings::Phase::ThreadWait);
+
+		SoftwareRenderer::drawSkyGradient(startX, endX, *skyGradient.rowColorCache,
+			*threadData.frame);
+		endLap(RenderTimings::Phase::SkyGradient);
 
 		// Wait for the visible distant object testing to finish.
 		RenderThreadData::DistantSky &distantSky = threadData.distantSky;
-		lk.lock();
-		threadData.condVar.wait(lk, [&distantSky]() { return distantSky.doneVisTesting; });
-		lk.unlock();
+		threadData.waitUntil([&distantSky]() { return distantSky.doneVisTesting.load(); });
+		endLap(RenderTimings::Phase::ThreadWait);
 
 		// Draw this thread's portion of distant sky objects.
 		SoftwareRenderer::drawDistantSky(startX, endX, distantSky.parallaxSky,
 			*distantSky.visDistantObjs, *distantSky.skyTextures, *skyGradient.rowCache,
 			skyGradient.shouldDrawStars, *threadData.shadingInfo, *threadData.frame);
+		endLap(RenderTimings::Phase::DistantSky);
 
 		// Wait for other threads to finish distant sky objects.
 		threadBarrier(distantSky);
+		endLap(RenderTimings::Phase::ThreadWait);
 
-		// Number of columns to skip per ray cast (for interleaved ray casting as a means of
-		// load-balancing).
-		const int strideX = threadData.totalThreads;
-
-		// Draw this thread's portion of voxels.
+		// Draw batches of voxel columns until none are left. Batches are taken from this
+		// thread's range first and then stolen from other threads (as a means of load-balancing,
+		// since some columns are much more expensive to ray cast than others).
 		RenderThreadData::Voxels &voxels = threadData.voxels;
-		SoftwareRenderer::drawVoxels(threadIndex, strideX, *threadData.camera,
-			voxels.ceilingHeight, *voxels.openDoors, *voxels.voxelGrid, *voxels.voxelTextures,
-			*voxels.occlusion, *threadData.shadingInfo, *threadData.frame);
+		const int columnParity = voxels.columnParity;
+		const int columnStep = (columnParity >= 0) ? 2 : 1;
+		int voxelsStartX, voxelsEndX;
+		while (voxels.getNextColumnBatch(threadIndex, &voxelsStartX, &voxelsEndX))
+		{
+			// When interlacing, start at the batch's first column with the right parity.
+			if ((columnParity >= 0) && ((voxelsStartX & 1) != columnParity))
+			{
+				voxelsStartX++;
+			}
+
+			SoftwareRenderer::drawVoxels(voxelsStartX, voxelsEndX, columnStep,
+				*threadData.camera, voxels.ceilingHeight, voxels.detailDistance,
+				*voxels.openDoors, *voxels.voxelGrid,
+				*voxels.voxelTextures, *voxels.occlusion, *threadData.shadingInfo,
+				*threadData.frame);
+
+			if (threadData.shadingInfo->scanlinePlanes)
+			{
+				SoftwareRenderer::drawScanlinePlanes(voxelsStartX, voxelsEndX, columnStep,
+					*threadData.camera, voxels.ceilingHeight, *voxels.voxelGrid,
+					*voxels.voxelTextures, *threadData.shadingInfo, *threadData.frame);
+			}
+		}
+
+		endLap(RenderTimings::Phase::Voxels);
+
+		// Let the main thread know this thread is done with voxels. Flat sorting is only
+		// signaled as done once every thread has finished voxels.
+		threadData.arrive(voxels.threadsDone);
+
+		// With interlaced rendering, fill in this thread's skipped columns once every column
+		// has been ray cast, since they can be copied from anywhere in the frame.
+		if (voxels.history != nullptr)
+		{
+			threadData.waitUntil([&threadData, &voxels]()
+			{
+				return voxels.threadsDone == threadData.totalThreads;
+			});
+			endLap(RenderTimings::Phase::ThreadWait);
 
-		// Wait for other threads to finish voxels.
-		threadBarrier(voxels);
+			SoftwareRenderer::updateVoxelHistory(startX, endX, *threadData.camera,
+				*voxels.history, columnParity, voxels.reprojectHistory, *threadData.frame);
+			endLap(RenderTimings::Phase::VoxelHistory);
+
+			threadData.arrive(voxels.threadsDoneHistory);
+		}
 
 		// Wait for the visible flat sorting to finish.
 		RenderThreadData::Flats &flats = threadData.flats;
-		lk.lock();
-		threadData.condVar.wait(lk, [&flats]() { return flats.doneSorting; });
-		lk.unlock();
+		threadData.waitUntil([&flats]() { return flats.doneSorting.load(); });
+		endLap(RenderTimings::Phase::ThreadWait);
 
-		// Draw this thread's portion of flats.
+		// Every voxel column is drawn once flats are sorted, so the farthest wall depths of
+		// this thread's columns can be read before its portion of flats is drawn.
+		FlatOcclusion &flatOcclusion = (*flats.occlusions)[threadIndex];
+		flatOcclusion.init(startX, endX, *threadData.frame);
 		SoftwareRenderer::drawFlats(startX, endX, *threadData.camera, *flats.flatNormal,
-			*flats.visibleFlats, *flats.flatTextures, *threadData.shadingInfo, *threadData.frame);
+			*flats.visibleFlats, (*flats.visibleFlatBins)[threadIndex], *flats.flatTextures,
+			*threadData.shadingInfo, flatOcclusion, *threadData.frame);
+		endLap(RenderTimings::Phase::Flats);
+
+		// In palette mode, every voxel and flat in this thread's columns is drawn now, so they
+		// can be turned into colors without waiting on other threads.
+		if (threadData.frame->indexBuffer != nullptr)
+		{
+			SoftwareRenderer::resolvePaletteIndices(startX, endX, *flats.shadeTable,
+				*threadData.frame);
+			endLap(RenderTimings::Phase::PaletteResolve);
+		}
+
+		// This thread's columns are done, so they can go to the caller's pixels.
+		SoftwareRenderer::transposeFrame(startX, endX, *threadData.frame);
+		endLap(RenderTimings::Phase::Transpose);
+
+		// Let the main thread know this thread is done with flats. Threads don't wait on each
+		// other here, so none of them can still be waiting when the next frame resets the
+		// phase counters.
+		threadData.arrive(flats.threadsDone);
+	}
+}
+
+bool SoftwareRenderer::isFrameUnchanged(const Double3 &eye, const Double3 &direction,
+	double fovY, double ambient, double daytimePercent, double latitude, bool parallaxSky,
+	double ceilingHeight, const LevelData::OpenDoors &openDoors,
+	const VoxelGrid &voxelGrid) const
+{
+	const FrameInputs &lastFrameInputs = this->lastFrameInputs;
+	if (!lastFrameInputs.isValid || !lastFrameInputs.isComplete)
+	{
+		return false;
+	}
 
-		// Wait for other threads to finish flats.
-		threadBarrier(flats);
+	// Newly baked lights are swapped in by the next render.
+	if (this->lightBakeJob.valid() && this->lightBakeDone)
+	{
+		return false;
 	}
+
+	return lastFrameInputs.matches(eye, direction, fovY, ambient, daytimePercent, latitude,
+		parallaxSky, ceilingHeight, openDoors, voxelGrid, this->distantObjects);
 }
 
 void SoftwareRenderer::render(const Double3 &eye, const Double3 &direction, double fovY,
 	double ambient, double daytimePercent, double latitude, bool parallaxSky, double ceilingHeight,
-	const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid,
-	uint32_t *colorBuffer)
+	const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+	uint32_t *outputBuffer, const std::function<void()> &mainThreadTask)
 {
+	const auto renderStartTime = std::chrono::high_resolution_clock::now();
+
 	// Constants for screen dimensions.
 	const double widthReal = static_cast<double>(this->width);
 	const double heightReal = static_cast<double>(this->height);
@@ -6429,76 +10595,284 @@ void SoftwareRenderer::render(const Double3 &eye, const Double3 &direction, doub
 	// Normal of all flats (always facing the camera).
 	const Double3 flatNormal = Double3(-camera.forwardX, 0.0, -camera.forwardZ).normalized();
 
+	// Decide which voxel columns to ray cast. When interlacing, only every other column is
+	// ray cast and the skipped ones are reprojected from the previous frame, or copied from a
+	// neighbor if the camera moved. Turning too fast would make the reprojection obvious, so
+	// every column is ray cast then. The voxel history holds colors, so palette mode doesn't
+	// interlace.
+	VoxelHistory &voxelHistory = this->voxelHistory;
+	const int pixelCount = this->width * this->height;
+	const bool interlacedVoxels = this->interlacedVoxels && !this->paletteRendering;
+	if (interlacedVoxels &&
+		(static_cast<int>(voxelHistory.colorBuffers[0].size()) != pixelCount))
+	{
+		voxelHistory.init(this->width, this->height);
+	}
+
+	const Double2 cameraForward(camera.forwardX, camera.forwardZ);
+	const Double2 cameraRight(camera.rightX, camera.rightZ);
+	const bool interlaceColumns = interlacedVoxels && voxelHistory.isValid &&
+		(this->width >= 2) && [&voxelHistory, &cameraForward]()
+	{
+		const double cosTurn = std::clamp(cameraForward.dot(voxelHistory.forward), -1.0, 1.0);
+		return std::acos(cosTurn) <= VoxelHistory::MAX_TURN_RADIANS;
+	}();
+
+	// An interlaced frame only ends up the same as a full one if the columns it reprojects are
+	// from an identical view.
+	const bool repeatsLastFrame = this->lastFrameInputs.isValid &&
+		!(this->lightBakeJob.valid() && this->lightBakeDone) &&
+		this->lastFrameInputs.matches(eye, direction, fovY, ambient, daytimePercent, latitude,
+			parallaxSky, ceilingHeight, openDoors, voxelGrid, this->distantObjects);
+
+	const int columnParity = interlaceColumns ? ((voxelHistory.columnParity == 0) ? 1 : 0) : -1;
+	const bool reprojectHistory = interlaceColumns &&
+		((camera.eye - voxelHistory.eye).length() <= VoxelHistory::MAX_MOVE_DISTANCE) &&
+		(camera.yShear == voxelHistory.yShear) && (camera.zoom == voxelHistory.zoom) &&
+		(camera.aspect == voxelHistory.aspect);
+
+	// Use the newest baked lights if they finished since last frame.
+	this->updateLightMap();
+
 	// Calculate shading information for this frame. Create some helper structs to keep similar
 	// values together.
-	const ShadingInfo shadingInfo(this->skyPalette, daytimePercent, latitude,
-		ambient, this->fogDistance);
-	const FrameView frame(colorBuffer, this->depthBuffer.data(), this->width, this->height);
+	this->shadingInfo->update(this->skyPalette, daytimePercent, latitude, ambient,
+		this->fogDistance, this->nightLightsActive);
+	this->shadingInfo->scanlinePlanes = this->scanlinePlanes;
+	const ShadingInfo &shadingInfo = *this->shadingInfo;
+
+	// In palette mode, voxels and flats are drawn into the index buffer (allocated when first
+	// used) and resolved through the shade table, which only changes with the fog color. It
+	// follows the fog samples' color so it's only remade when they are.
+	if (this->paletteRendering)
+	{
+		if (static_cast<int>(this->indexBuffer.size()) != pixelCount)
+		{
+			this->indexBuffer.resize(pixelCount);
+		}
+
+		this->shadeTable.update(shadingInfo.fogSamplesColor);
+	}
+
+	uint16_t *indexBuffer = this->paletteRendering ? this->indexBuffer.data() : nullptr;
+
+	// Columns skipped by interlacing keep their hits from the last frame if the view is the
+	// same. Hits are only recorded while the camera is inside the voxel grid's height.
+	const bool sameColumnHitsView =
+		(static_cast<int>(this->columnHits.size()) == this->width) &&
+		(eye == this->columnHitsEye) && (direction == this->columnHitsDirection);
+	this->columnHits.resize(this->width);
+	for (int x = 0; x < this->width; x++)
+	{
+		if (!sameColumnHitsView || (columnParity < 0) || ((x & 1) == columnParity))
+		{
+			this->columnHits[x].isValid = false;
+		}
+	}
+
+	this->columnHitsEye = eye;
+	this->columnHitsDirection = direction;
+	ColumnHit *columnHits = ((camera.eyeVoxel.y >= 0) &&
+		(camera.eyeVoxel.y < voxelGrid.getHeight())) ? this->columnHits.data() : nullptr;
+
+	const FrameView frame(this->colorBuffer.data(), this->depthBuffer.data(), indexBuffer,
+		outputBuffer, columnHits, this->width, this->height);
 
 	// Projected Y range of the sky gradient.
 	double gradientProjYTop, gradientProjYBottom;
 	SoftwareRenderer::getSkyGradientProjectedYRange(camera, gradientProjYTop, gradientProjYBottom);
 
 	// Set all the render-thread-specific shared data for this frame.
-	this->threadData.init(static_cast<int>(this->renderThreads.size()),
-		camera, shadingInfo, frame);
+	const int renderThreadCount = static_cast<int>(this->renderThreads.size());
+	this->renderTimings.beginFrame(renderThreadCount);
+	this->threadData.init(renderThreadCount, camera, shadingInfo, frame, this->renderTimings);
+	// The sky gradient rows only depend on the projected gradient range and the sky colors,
+	// so if neither changed since last frame (i.e., walking without looking up or down),
+	// the cached rows can be reused.
+	const bool skyGradientCacheIsValid = this->skyGradientCacheIsValid &&
+		(gradientProjYTop == this->skyGradientCacheProjYTop) &&
+		(gradientProjYBottom == this->skyGradientCacheProjYBottom) &&
+		(shadingInfo.skyColors == this->skyGradientCacheColors);
+
+	this->skyGradientCacheColors = shadingInfo.skyColors;
+	this->skyGradientCacheProjYTop = gradientProjYTop;
+	this->skyGradientCacheProjYBottom = gradientProjYBottom;
+	this->skyGradientCacheIsValid = true;
+
 	this->threadData.skyGradient.init(gradientProjYTop, gradientProjYBottom,
-		this->skyGradientRowCache);
+		this->skyGradientRowCache, this->skyGradientRowColorCache, skyGradientCacheIsValid);
 	this->threadData.distantSky.init(parallaxSky, this->visDistantObjs, this->skyTextures);
-	this->threadData.voxels.init(ceilingHeight, openDoors, voxelGrid,
-		this->voxelTextures, this->occlusion);
-	this->threadData.flats.init(flatNormal, this->visibleFlats, this->flatTextures);
+	// Interlacing already skips every other column, so the detail distance is only used
+	// when every column is cast.
+	const double detailDistance = ((columnParity < 0) && (this->voxelDetailDistance > 0.0)) ?
+		this->voxelDetailDistance : std::numeric_limits<double>::infinity();
+
+	this->threadData.voxels.init(ceilingHeight, detailDistance, openDoors, voxelGrid,
+		this->voxelTextures, this->occlusion, this->threadData.totalThreads, this->width,
+		interlacedVoxels ? &voxelHistory : nullptr, columnParity, reprojectHistory);
+	this->threadData.flats.init(flatNormal, this->visibleFlats, this->visibleFlatBins,
+		this->flatOcclusions, this->flatTextures, this->shadeTable);
 
 	// Give the render threads the go signal. They can work on the sky and voxels while this thread
 	// does things like resetting occlusion and doing visible flat determination.
-	// - Note about locks: they must always be locked before wait(), and stay locked after wait().
-	std::unique_lock<std::mutex> lk(this->threadData.mutex);
 	this->threadData.go = true;
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+	this->threadData.notifyAll();
 
 	// Reset occlusion. Don't need to reset sky gradient row cache because it is written to before
 	// it is read.
 	std::fill(this->occlusion.begin(), this->occlusion.end(), OcclusionData(0, this->height));
 
+	// Lambda for timing consecutive parts of this thread's frame. Adds the time since the
+	// previous call to the given phase.
+	auto lapTime = std::chrono::high_resolution_clock::now();
+	auto endLap = [this, &lapTime](RenderTimings::Phase phase)
+	{
+		const auto now = std::chrono::high_resolution_clock::now();
+		const std::chrono::duration<double> lapDuration = now - lapTime;
+		this->renderTimings.addMainTime(phase, lapDuration.count());
+#if defined(TES_PROFILER)
+		Profiler::recordZone(getProfilerPhaseName(phase), lapTime, now);
+#endif
+		lapTime = now;
+	};
+
 	// Refresh the visible distant objects.
 	this->updateVisibleDistantObjects(parallaxSky, shadingInfo, camera, frame);
+	endLap(RenderTimings::Phase::VisibleDistantObjects);
 
-	lk.lock();
-	this->threadData.condVar.wait(lk, [this]()
+	this->threadData.waitUntil([this]()
 	{
 		return this->threadData.skyGradient.threadsDone == this->threadData.totalThreads;
 	});
+	endLap(RenderTimings::Phase::MainThreadWait);
 
 	// Keep the render threads from getting the go signal again before the next frame.
 	this->threadData.go = false;
 
 	// Let the render threads know that they can start drawing distant objects.
 	this->threadData.distantSky.doneVisTesting = true;
-
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+	this->threadData.notifyAll();
 
 	// Refresh the visible flats. This should erase the old list, calculate a new list, and sort
-	// it by depth.
-	this->updateVisibleFlats(camera);
+	// it by depth. Then give each render thread the ones in its columns.
+	this->updateVisibleFlats(camera, ceilingHeight, openDoors, voxelGrid);
+	this->binVisibleFlats(frame);
+	endLap(RenderTimings::Phase::VisibleFlats);
+
+	// Do the caller's work (if any) while the render threads are still busy with voxels.
+	if (mainThreadTask)
+	{
+		mainThreadTask();
+		endLap(RenderTimings::Phase::MainThreadTask);
+	}
 
-	lk.lock();
-	this->threadData.condVar.wait(lk, [this]()
+	this->threadData.waitUntil([this]()
 	{
-		return this->threadData.voxels.threadsDone == this->threadData.totalThreads;
+		const RenderThreadData::Voxels &voxels = this->threadData.voxels;
+		const int threadsDone = (voxels.history != nullptr) ?
+			voxels.threadsDoneHistory.load() : voxels.threadsDone.load();
+		return threadsDone == this->threadData.totalThreads;
 	});
 
 	// Let the render threads know that they can start drawing flats.
 	this->threadData.flats.doneSorting = true;
-
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+	this->threadData.notifyAll();
 
 	// Wait until render threads are done drawing flats.
-	lk.lock();
-	this->threadData.condVar.wait(lk, [this]()
+	this->threadData.waitUntil([this]()
 	{
 		return this->threadData.flats.threadsDone == this->threadData.totalThreads;
 	});
+	endLap(RenderTimings::Phase::MainThreadWait);
+
+	// Remember this frame's camera for reprojecting next frame's skipped columns.
+	if (interlacedVoxels)
+	{
+		voxelHistory.eye = camera.eye;
+		voxelHistory.forward = cameraForward;
+		voxelHistory.right = cameraRight;
+		voxelHistory.zoom = camera.zoom;
+		voxelHistory.aspect = camera.aspect;
+		voxelHistory.yShear = camera.yShear;
+		voxelHistory.bufferIndex ^= 1;
+		voxelHistory.columnParity = columnParity;
+		voxelHistory.isValid = true;
+	}
+	else
+	{
+		voxelHistory.isValid = false;
+	}
+
+	this->lastFrameInputs.init(eye, direction, fovY, ambient, daytimePercent, latitude,
+		parallaxSky, ceilingHeight, openDoors, voxelGrid, this->distantObjects);
+	this->lastFrameInputs.isComplete = !interlaceColumns || repeatsLastFrame;
+
+	const std::chrono::duration<double> renderDuration =
+		std::chrono::high_resolution_clock::now() - renderStartTime;
+	this->renderTimings.addMainTime(RenderTimings::Phase::Render, renderDuration.count());
+	this->renderTimings.endFrame();
+}
+
+bool SoftwareRenderer::getColumnHit(const Double3 &eye, const Double3 &direction,
+	double xPercent, Int3 *outVoxel, double *outDistance, VoxelData::Facing *outFacing) const
+{
+	if ((eye != this->columnHitsEye) || (direction != this->columnHitsDirection) ||
+		(xPercent < 0.0) || (xPercent >= 1.0))
+	{
+		return false;
+	}
+
+	const int x = static_cast<int>(xPercent * static_cast<double>(this->columnHits.size()));
+	if ((x >= static_cast<int>(this->columnHits.size())) || !this->columnHits[x].isValid)
+	{
+		return false;
+	}
+
+	const ColumnHit &columnHit = this->columnHits[x];
+	*outVoxel = columnHit.voxel;
+	*outDistance = columnHit.distance;
+	*outFacing = columnHit.facing;
+	return true;
+}
+
+void SoftwareRenderer::runParallel(int batchCount, const std::function<void(int)> &batchFunction)
+{
+	// Without render threads, this thread does every batch.
+	const int renderThreadCount = static_cast<int>(this->renderThreads.size());
+	if (renderThreadCount == 0)
+	{
+		for (int i = 0; i < batchCount; i++)
+		{
+			batchFunction(i);
+		}
+
+		return;
+	}
+
+	DebugAssert(!this->threadData.go);
+
+	RenderThreadData &threadData = this->threadData;
+	RenderThreadData::Job &job = threadData.job;
+	threadData.totalThreads = renderThreadCount;
+	job.init(batchFunction, batchCount);
+
+	threadData.go = true;
+	threadData.notifyAll();
+
+	// Take batches on this thread too instead of just waiting.
+	job.runBatches();
+	threadData.waitUntil([&threadData, &job]()
+	{
+		return job.threadsDone == threadData.totalThreads;
+	});
+
+	threadData.go = false;
+	threadData.notifyAll();
+
+	threadData.waitUntil([&threadData, &job]()
+	{
+		return job.threadsReleased == threadData.totalThreads;
+	});
+
+	job.batchFunction = nullptr;
 }
@@ -5,6 +5,9 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -14,32 +17,86 @@
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
+#include "RenderTimings.h"
 #include "../World/DistantSky.h"
 #include "../World/LevelData.h"
+#include "../World/VisibilityRegions.h"
 #include "../World/VoxelData.h"
 
 // This class runs the CPU-based 3D rendering for the application.
 
+class MemoryReport;
 class VoxelGrid;
 
 class SoftwareRenderer
 {
 private:
+	// Voxel and flat texels are stored as 8-bit color channels so a whole texture fits in
+	// far fewer cache lines. Channels are expanded to [0, 1] with a lookup table when drawing.
 	struct VoxelTexel
 	{
-		double r, g, b, emission;
-		bool transparent; // Voxel texels only support alpha testing, not alpha blending.
+		static const uint8_t FLAG_TRANSPARENT = 1 << 0;
+		static const uint8_t FLAG_EMISSIVE = 1 << 1;
+
+		uint8_t r, g, b;
+		uint8_t flags; // Voxel texels only support alpha testing, not alpha blending.
 
 		VoxelTexel();
+
+		bool isTransparent() const;
+
+		// Emission is either fully on (night lights) or off.
+		double getEmission() const;
 	};
 
 	struct FlatTexel
 	{
-		double r, g, b, a;
+		uint8_t r, g, b, a;
 
 		FlatTexel();
 	};
 
+	// In palette mode, voxels and flats are drawn as palette indices and quantized light and
+	// fog levels, like Arena's light tables, and a resolve pass looks up their final colors
+	// in this table.
+	struct ShadeTable
+	{
+		static constexpr int PALETTE_SIZE = 256;
+		static constexpr int LIGHT_LEVEL_COUNT = 16;
+		static constexpr int FOG_LEVEL_COUNT = 8;
+		static constexpr int SHADE_COUNT = ShadeTable::LIGHT_LEVEL_COUNT *
+			ShadeTable::FOG_LEVEL_COUNT;
+
+		// Index buffer value for pixels that were drawn as colors instead (i.e., the sky).
+		static constexpr uint16_t NO_INDEX = 0xFFFF;
+
+		// Colors the textures were made from, and exact lookups back to their indices.
+		std::array<uint32_t, ShadeTable::PALETTE_SIZE> palette;
+		std::unordered_map<uint32_t, uint8_t> paletteIndices;
+
+		// Final color of each index buffer value, one row of palette colors per shade.
+		std::vector<uint32_t> colors;
+
+		// Fog color that the table's colors were calculated with.
+		Double3 fogColor;
+
+		ShadeTable();
+
+		// Sets the palette and recalculates the table.
+		void init(const uint32_t *paletteColors);
+
+		// Recalculates the table if the fog color is different from last time.
+		void update(const Double3 &fogColor);
+
+		// Gets the index of the palette color nearest to the given color.
+		uint8_t getNearestIndex(uint8_t r, uint8_t g, uint8_t b) const;
+
+		// Gets the index buffer value for a palette index with the given light percent (0 is
+		// black, 1 is fully lit) and fog percent (0 is no fog, 1 is only fog).
+		static uint16_t getIndexValue(uint8_t paletteIndex, double lightPercent,
+			double fogPercent);
+	};
+
 	// For distant sky objects (mountains, clouds, etc.).
 	struct SkyTexel
 	{
@@ -55,24 +112,95 @@ private:
 		static const int HEIGHT = VoxelTexture::WIDTH;
 		static const int TEXEL_COUNT = VoxelTexture::WIDTH * VoxelTexture::HEIGHT;
 
-		std::array<VoxelTexel, VoxelTexture::TEXEL_COUNT> texels;
+		// Mip levels are 64, 32, 16, and 8 texels wide, stored one after another so the
+		// smaller ones used at a distance share just a few cache lines.
+		static const int MIP_LEVEL_COUNT = 4;
+		static const int MIP_TEXEL_COUNT = VoxelTexture::TEXEL_COUNT +
+			(VoxelTexture::TEXEL_COUNT / 4) + (VoxelTexture::TEXEL_COUNT / 16) +
+			(VoxelTexture::TEXEL_COUNT / 64);
+
+		// Texels are column-major within each level since walls are drawn one screen column
+		// at a time, so stepping down a column reads contiguous memory. These are the day
+		// variant, with any light texels black.
+		std::array<VoxelTexel, VoxelTexture::MIP_TEXEL_COUNT> texels; // Level 0 first.
+		std::array<uint8_t, VoxelTexture::MIP_TEXEL_COUNT> paletteIndices; // For palette mode.
 		std::vector<Int2> lightTexels; // Black during the day, yellow at night.
+
+		// Night variant with the light texels lit, kept alongside the day one so toggling
+		// night lights is just a choice of bank at the start of a frame. Empty if there are
+		// no light texels.
+		std::vector<VoxelTexel> nightTexels;
+		std::vector<uint8_t> nightPaletteIndices;
+
+		// Gets the texels and palette indices of the day or night variant.
+		const VoxelTexel *getTexels(bool nightLightsActive) const;
+		const uint8_t *getPaletteIndices(bool nightLightsActive) const;
+
+		// Gets the index of a texel relative to the start of a mip level of the given height.
+		static int getTexelIndex(int x, int y, int height);
+
+		// Gets the index of the first texel in the given mip level.
+		static int getMipOffset(int level);
+
+		// Gets the mip level to sample when each pixel covers the given number of level 0
+		// texels.
+		static int getMipLevel(double texelsPerPixel);
+
+		// Regenerates the smaller mip levels from level 0.
+		static void updateMipLevels(VoxelTexel *texels);
+		void updateMipLevels();
+
+		// Regenerates each texel's nearest palette index in the shade table's palette, from the
+		// given mip level to the smallest one.
+		static void updatePaletteIndices(const VoxelTexel *texels, uint8_t *paletteIndices,
+			const ShadeTable &shadeTable, int startLevel);
+		void updatePaletteIndices(const ShadeTable &shadeTable, int startLevel);
+
+		// Blacks out the light texels in level 0 of the day variant and makes the night
+		// variant from it, or clears the night variant if there are no light texels.
+		void initNightTexels();
 	};
 
+	// Every animation frame of a sprite in one atlas, frames side by side. Since texels are
+	// column-major, a frame's sub-rect is a contiguous range of columns, and a flat only needs
+	// a frame index to change frames.
 	struct FlatTexture
 	{
-		std::vector<FlatTexel> texels;
-		int width, height;
+		std::vector<FlatTexel> texels; // Column-major, all frames.
+		std::vector<uint8_t> paletteIndices; // For palette mode.
+
+		// First and one-past-last texel row of each run of opaque texels, for every column of
+		// every frame in order. A column's runs start at its offset and end at the next
+		// column's offset, so there are '(width * frameCount) + 1' offsets. Calculated when the
+		// texture is set so drawing can skip the transparent parts of sprites.
+		std::vector<Int2> opaqueRuns;
+		std::vector<int> columnRunOffsets;
+
+		int width, height; // Of one frame.
+		int frameCount;
 
 		FlatTexture();
+
+		// Regenerates each texel's nearest palette index in the shade table's palette.
+		void updatePaletteIndices(const ShadeTable &shadeTable);
+
+		void initOpaqueRuns();
 	};
 
 	struct SkyTexture
 	{
 		std::vector<SkyTexel> texels;
+
+		// First and one-past-last opaque texel row of each column, calculated once when the
+		// distant sky is set so render threads can skip the transparent parts of a column.
+		// Equal values mean the column is fully transparent.
+		std::vector<int> columnOpaqueStarts, columnOpaqueEnds;
+
 		int width, height;
 
 		SkyTexture();
+
+		void initColumnOpaqueRanges();
 	};
 
 	// Camera for 2.5D ray casting (with some pre-calculated values to avoid duplicating work).
@@ -109,6 +237,7 @@ private:
 		double dirX, dirZ; // Normalized components in XZ plane.
 
 		Ray(double dirX, double dirZ);
+		Ray();
 	};
 
 	// A draw range contains data for the vertical range that two projected vertices
@@ -151,6 +280,57 @@ private:
 		Double3 normal;
 	};
 
+	// Intersections of one ray with the diagonals, edge far sides, and swinging doors a voxel
+	// column can have. They only depend on the ray's path through the column in the XZ plane,
+	// so they're found once per column by the batched methods instead of once per voxel.
+	struct ColumnIntersections
+	{
+		RayHit diag1Hit, diag2Hit, swingingDoorHit;
+		bool diag1Success, diag2Success, swingingDoorSuccess;
+
+		// Side of the column the ray leaves through, and the unflipped texture coordinate
+		// there, for edges and chasms.
+		VoxelData::Facing farFacing;
+		double farU;
+	};
+
+	// A point light. Its intensity is the radius it reaches, with the light falling off
+	// linearly to zero at that distance.
+	struct Light
+	{
+		Double3 point, color;
+		double intensity;
+		bool isBaked; // Whether the light is in the light map instead of the light grid.
+	};
+
+	// Lights bucketed by each voxel column (XZ coordinate) they reach.
+	using LightGrid = std::unordered_map<Int2, std::vector<const Light*>>;
+
+	// Pre-computed light from lights that don't change, for each side face of each voxel in
+	// the voxel columns they reach.
+	struct LightMap
+	{
+		static constexpr int FACES_PER_VOXEL = 4;
+
+		// Face colors of each voxel column, indexed by (voxelY * FACES_PER_VOXEL) + facing.
+		std::unordered_map<Int2, std::vector<Double3>> columns;
+
+		// Baked light IDs, for knowing which lights to take out of the light grid.
+		std::vector<int> lightIDs;
+
+		int gridHeight;
+		double ceilingHeight;
+
+		LightMap();
+
+		// Adds the light from the given lights to each face in the voxel columns they reach.
+		void bake(const std::vector<Light> &lights, int gridHeight, double ceilingHeight);
+
+		// Gets the average light of a voxel's faces in the given column at some height, for
+		// things like flats that don't belong to a face.
+		Double3 getAverageFaceColor(const std::vector<Double3> &column, double y) const;
+	};
+
 	// Helper struct for keeping shading data organized in the renderer. These values are
 	// computed once per frame.
 	struct ShadingInfo
@@ -176,28 +356,169 @@ private:
 		// Ambient light percent used with distant sky objects.
 		double distantAmbient;
 
+		// Number of fog samples between the eye and the fog distance.
+		static constexpr int FOG_SAMPLE_COUNT = 1024;
+
+		// Fog at a quantized depth. A shaded color becomes (color * colorPercent) + fogColor,
+		// where the fog color is already multiplied by the fog percent at that depth.
+		struct FogSample
+		{
+			Double3 fogColor;
+			double colorPercent;
+		};
+
+		// Fog samples from the eye (index 0) out to the fog distance (last index).
+		std::array<FogSample, FOG_SAMPLE_COUNT + 1> fogSamples;
+
 		// Distance at which fog is maximum.
 		double fogDistance;
 
+		// Converts a depth to a fog sample index.
+		double fogSampleScale;
+
+		// Whether fog is applied at all. An infinite fog distance disables it.
+		bool fogEnabled;
+
 		// Returns whether the current clock time is before noon.
 		bool isAM;
 
-		ShadingInfo(const std::vector<Double3> &skyPalette, double daytimePercent, double latitude,
-			double ambient, double fogDistance);
+		// Whether voxel textures are drawn with their night variant.
+		bool nightLightsActive;
+
+		// Whether floor tops and ceiling bottoms are left to the scanline pass instead of
+		// being drawn by ray cast columns.
+		bool scanlinePlanes;
+
+		// Clock that animated voxel textures step through their frames with.
+		double animationTime;
+
+		// Index in the voxel textures of each texture ID's current frame. An animated ID
+		// points at one of its frames, and every other ID at itself.
+		std::vector<int> voxelTextureIndices;
+
+		// Fog color and distance the fog samples were made with. The samples are only remade
+		// once the fog color has moved by about half of an 8-bit step, since the horizon
+		// color changes a tiny bit every frame while the clock runs.
+		Double3 fogSamplesColor;
+		double fogSamplesDistance;
+		bool fogSamplesValid;
+
+		// Point lights in the world, owned by the renderer.
+		const LightGrid &lightGrid;
+		const LightMap &lightMap;
+
+		ShadingInfo(const LightGrid &lightGrid, const LightMap &lightMap);
+
+		// Recalculates the sky, sun, and fog values for a frame. Kept between frames by the
+		// renderer so the fog samples can be reused.
+		void update(const std::vector<Double3> &skyPalette, double daytimePercent,
+			double latitude, double ambient, double fogDistance, bool nightLightsActive);
 
 		const Double3 &getFogColor() const;
+
+		// Gets the fog sample nearest to the given depth.
+		const FogSample &getFogSample(double depth) const;
+
+		// Gets the current frame of the voxel texture with the given ID.
+		const VoxelTexture &getVoxelTexture(const std::vector<VoxelTexture> &textures,
+			int id) const;
+
+		// Gets the lights that reach the given voxel column, or null if there are none.
+		const std::vector<const Light*> *getVoxelColumnLights(int voxelX, int voxelZ) const;
+
+		// Gets the baked light of the given voxel column's faces, or null if there is none.
+		const std::vector<Double3> *getBakedVoxelColumn(int voxelX, int voxelZ) const;
+
+		// Gets the combined color of the given lights at a point.
+		static Double3 getLightColor(const Double3 &point, const std::vector<const Light*> &lights);
+
+		// Gets the light reaching a voxel's face at the given point from its voxel column's
+		// baked and unbaked lights. Either of those can be null.
+		static Double3 getVoxelLightColor(const Double3 &point, int voxelY,
+			VoxelData::Facing facing, const std::vector<Double3> *bakedColumn,
+			const std::vector<const Light*> *columnLights);
+	};
+
+	// Lookups for one XZ column of the voxel grid, shared by every ray in a packet that
+	// crosses the column in the same step.
+	struct VoxelColumnView
+	{
+		int voxelX, voxelZ;
+		const VoxelData **voxelData; // One per voxel height, owned by the caller.
+		const std::vector<Double3> *bakedColumn;
+		const std::vector<const Light*> *columnLights;
+		double doorPercentOpen; // Shared by any door voxels in the column.
+
+		// Which batched intersections the column's voxels need.
+		bool hasDiagonal, hasFarFacing, hasSwingingDoor;
+
+		void init(int voxelX, int voxelZ, const VoxelGrid &voxelGrid,
+			const LevelData::OpenDoors &openDoors, const ShadingInfo &shadingInfo,
+			const VoxelData **voxelDataBuffer);
+	};
+
+	// Angles from the camera eye to the corners of a voxel in the XZ plane, shared by the rays
+	// finding the far facing of the same voxel.
+	struct VoxelCornerAngles
+	{
+		double upLeft, upRight, downLeft, downRight;
+
+		void init(int voxelX, int voxelZ, const Double2 &eye);
+	};
+
+	// DDA state of a 2D ray stepping through the XZ plane of the voxel grid. The Y cell
+	// coordinate is constant.
+	struct RayDDA
+	{
+		double deltaDistX, deltaDistZ, sideDistX, sideDistZ;
+
+		// Distance to the edge of the current cell, and the facing of that edge.
+		double zDistance;
+		VoxelData::Facing facing;
+
+		Int3 cell;
+		int stepX, stepZ;
+		bool nonNegativeDirX, nonNegativeDirZ;
+
+		// Whether the current cell is inside the voxel grid.
+		bool voxelIsValid;
+
+		// Starts the ray in the camera's voxel, with the Z distance and facing of the first
+		// voxel edge it crosses.
+		void init(const Camera &camera, const Ray &ray, const VoxelGrid &voxelGrid);
+
+		// Steps to the next XZ coordinate in the grid and updates the Z distance.
+		void step(const Camera &camera, const Ray &ray, const VoxelGrid &voxelGrid);
+	};
+
+	// The nearest non-air voxel at the camera's voxel height that a column's 2D ray reached,
+	// kept from the voxel pass so screen points can be looked up without another ray cast.
+	struct ColumnHit
+	{
+		Int3 voxel;
+		double distance; // XZ distance to the voxel's near face.
+		VoxelData::Facing facing;
+		bool isValid; // False if the column's ray stopped before reaching one.
 	};
 
 	// Helper struct for values related to the frame buffer. The pointers are owned
 	// elsewhere; they are copied here simply for convenience.
+	// - Nearly everything is drawn in vertical spans, so the color, depth, and index buffers
+	//   are column-major (the pixel at (x, y) is at y + (x * height)). That way stepping down
+	//   a column stays in the same cache lines instead of jumping a whole row each pixel.
+	// - The output buffer is the caller's row-major pixels, written once the frame is done.
 	struct FrameView
 	{
 		uint32_t *colorBuffer;
-		double *depthBuffer;
+		float *depthBuffer;
+		uint16_t *indexBuffer; // Shade table values in palette mode, otherwise null.
+		uint32_t *outputBuffer;
+		ColumnHit *columnHits; // One per column, or null if not recorded this frame.
 		int width, height;
 		double widthReal, heightReal;
 
-		FrameView(uint32_t *colorBuffer, double *depthBuffer, int width, int height);
+		FrameView(uint32_t *colorBuffer, float *depthBuffer, uint16_t *indexBuffer,
+			uint32_t *outputBuffer, ColumnHit *columnHits, int width, int height);
 	};
 
 	// A flat is a 2D surface always facing perpendicular to the Y axis, and opposite to
@@ -207,6 +528,7 @@ private:
 		Double3 position; // Center of bottom edge.
 		double width, height;
 		int textureID;
+		int frameIndex; // Animation frame in the flat texture's atlas.
 		bool flipped;
 
 		// A flat's frame consists of their four corner points in world space, and some
@@ -240,6 +562,31 @@ private:
 		const Flat::Frame &getFrame() const;
 	};
 
+	// Farthest depth in each of a render thread's screen columns once voxels are drawn, for
+	// throwing out flats (or columns of them) that are entirely behind walls before any texel
+	// is sampled. A column with any pixel open to the sky is infinitely deep. Tiles of adjacent
+	// columns let a whole flat be thrown out with a few comparisons.
+	struct FlatOcclusion
+	{
+		// Columns per tile.
+		static const int TILE_WIDTH;
+
+		std::vector<float> columnDepths, tileDepths; // From the first column of the range.
+		int startX, endX;
+
+		FlatOcclusion();
+
+		// Reads the farthest depths of the given columns from the depth buffer.
+		void init(int startX, int endX, const FrameView &frame);
+
+		// Gets the farthest depth of a column, or infinity if it's not in the range.
+		float getColumnDepth(int x) const;
+
+		// Returns whether every column in the given range has its farthest depth nearer than
+		// the given one. Columns outside the range aren't known, so they're never occluded.
+		bool isRangeOccluded(int startX, int endX, float depth) const;
+	};
+
 	// Pairs together a distant sky object with its render texture index. If it's an animation,
 	// then the index points to the start of its textures.
 	template <typename T>
@@ -254,19 +601,41 @@ private:
 	// Collection of all distant objects.
 	struct DistantObjects
 	{
+		// A group of stars that are close together in the sky before the latitude and time of
+		// day rotation is applied, so visibility can be tested for the whole group at once.
+		struct StarCell
+		{
+			Double3 direction; // Average direction of the cell's stars.
+			double sinRadius; // Sine of the angle to the cell's farthest star (1 if >= 90 degrees).
+			std::vector<int> starIndices; // Indices into stars, in ascending order.
+
+			StarCell();
+		};
+
 		// Default index if no sun exists in the world.
 		static const int NO_SUN;
 
+		// Number of azimuth and elevation divisions when bucketing star directions.
+		static const int STAR_CELLS_X;
+		static const int STAR_CELLS_Y;
+
 		std::vector<DistantObject<DistantSky::LandObject>> lands;
 		std::vector<DistantObject<DistantSky::AnimatedLandObject>> animLands;
 		std::vector<DistantObject<DistantSky::AirObject>> airs;
 		std::vector<DistantObject<DistantSky::MoonObject>> moons;
 		std::vector<DistantObject<DistantSky::StarObject>> stars;
+		std::vector<Double3> starDirections; // Unrotated direction of each star.
+		std::vector<StarCell> starCells; // Non-empty star cells.
+		double starMaxWidth; // Width of the widest star texture, relative to the identity dimension.
 		int sunTextureIndex; // Points into skyTextures if the sun exists, or NO_SUN if it doesn't.
 
 		DistantObjects();
 
-		void init(const DistantSky &distantSky, std::vector<SkyTexture> &skyTextures);
+		// Creates the sky textures for each object. Textures for surfaces in the old sky
+		// textures are moved from there instead of being converted again.
+		void init(const DistantSky &distantSky, std::vector<SkyTexture> &skyTextures,
+			std::vector<const Surface*> &skyTextureSurfaces,
+			std::unordered_map<const Surface*, SkyTexture> &oldSkyTextures);
 		void clear();
 	};
 
@@ -314,27 +683,102 @@ private:
 		void clear();
 	};
 
+	// The previous frame's voxel pass results for interlaced rendering, where only every other
+	// voxel column is ray cast in a frame and the rest are filled in afterwards.
+	struct VoxelHistory
+	{
+		// Most the camera can turn in one frame (in radians) before falling back to ray casting
+		// every column.
+		static const double MAX_TURN_RADIANS;
+
+		// Most the camera can move in one frame before skipped columns are copied from their
+		// neighbors instead of reprojected from the previous frame.
+		static const double MAX_MOVE_DISTANCE;
+
+		std::array<std::vector<uint32_t>, 2> colorBuffers;
+		std::array<std::vector<float>, 2> depthBuffers;
+		Double3 eye;
+		Double2 forward, right; // XZ directions of the camera.
+		double zoom, aspect, yShear;
+		int bufferIndex; // Buffers holding the previous frame. The other ones are written to.
+		int columnParity; // X parity of the columns ray cast in the previous frame, or -1 for all.
+		bool isValid; // False if there is no previous frame to reuse.
+
+		VoxelHistory();
+
+		void init(int width, int height);
+	};
+
+	// Frames of an animated voxel texture. Frame 0 is in the texture ID's own slot, and the
+	// others start at the given index past the texture IDs.
+	struct VoxelTextureAnimation
+	{
+		int id, extraFramesIndex, frameCount;
+		double secondsPerFrame;
+	};
+
+	// Inputs of the most recently rendered frame, for telling whether the next one would draw
+	// the same thing. Daytime and ambient light are compared in steps so the view is only
+	// redrawn for changes that can be seen.
+	struct FrameInputs
+	{
+		// Sizes of the daytime and ambient steps.
+		static const double DAYTIME_STEP;
+		static const double AMBIENT_STEP;
+
+		Double3 eye, direction;
+		double fovY, ambientStep, daytimeStep, latitude, ceilingHeight;
+		std::vector<std::pair<Int2, double>> doors; // Voxel and percent open of each open door.
+		std::vector<int> animLandIndices; // Current frame of each animated distant land.
+		const VoxelGrid *voxelGrid;
+		uint32_t voxelGridRevision;
+		bool parallaxSky;
+		bool isComplete; // False if some columns were reprojected from a different view.
+		bool isValid; // False if anything else the frame depends on changed since.
+
+		FrameInputs();
+
+		void init(const Double3 &eye, const Double3 &direction, double fovY, double ambient,
+			double daytimePercent, double latitude, bool parallaxSky, double ceilingHeight,
+			const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+			const DistantObjects &distantObjects);
+
+		// Returns whether the given inputs are the same as these (daytime and ambient light
+		// only to within a step).
+		bool matches(const Double3 &eye, const Double3 &direction, double fovY, double ambient,
+			double daytimePercent, double latitude, bool parallaxSky, double ceilingHeight,
+			const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+			const DistantObjects &distantObjects) const;
+	};
+
 	// Data owned by the main thread that is referenced by render threads.
+	// Values that every render thread writes (phase counters and flags) are each given their own
+	// cache line, after the values that are only written before a phase starts. Otherwise a
+	// thread arriving at a barrier would evict the pointers the other threads are still reading.
 	struct RenderThreadData
 	{
 		struct SkyGradient
 		{
-			int threadsDone;
 			std::vector<Double3> *rowCache;
+			std::vector<uint32_t> *rowColorCache; // Row colors in frame buffer format.
 			double projectedYTop, projectedYBottom; // Projected Y range of sky gradient.
-			std::atomic<bool> shouldDrawStars; // True if the sky is dark enough.
+			bool rowCacheIsValid; // True if the row caches are still correct from last frame.
+			alignas(64) std::atomic<int> threadsDone;
+			alignas(64) std::atomic<bool> shouldDrawStars; // True if the sky is dark enough.
 
 			void init(double projectedYTop, double projectedYBottom,
-				std::vector<Double3> &rowCache);
+				std::vector<Double3> &rowCache, std::vector<uint32_t> &rowColorCache,
+				bool rowCacheIsValid);
 		};
 
 		struct DistantSky
 		{
-			int threadsDone;
 			const VisDistantObjects *visDistantObjs;
 			const std::vector<SkyTexture> *skyTextures;
 			bool parallaxSky;
-			bool doneVisTesting; // True when render threads can start rendering distant sky.
+			alignas(64) std::atomic<int> threadsDone;
+			// True when threads can start rendering distant sky.
+			alignas(64) std::atomic<bool> doneVisTesting;
 
 			void init(bool parallaxSky, const VisDistantObjects &visDistantObjs,
 				const std::vector<SkyTexture> &skyTextures);
@@ -342,54 +786,154 @@ private:
 
 		struct Voxels
 		{
-			int threadsDone;
-			const std::vector<LevelData::DoorState> *openDoors;
+			// Number of adjacent screen columns handed to a render thread at a time. Wide enough
+			// that a batch's occlusion and depth values and its slice of a color buffer row each
+			// fill whole cache lines, so two threads only ever share the lines at a batch's edges.
+			static const int COLUMN_BATCH_WIDTH;
+
+			// A render thread's remaining column batches, packed as (end << 32) | begin. The
+			// owning thread takes batches from the front and other threads steal from the back.
+			// Padded to a cache line so threads don't contend over neighboring ranges.
+			struct alignas(64) ColumnBatchRange
+			{
+				std::atomic<uint64_t> range;
+			};
+
+			const LevelData::OpenDoors *openDoors;
 			const VoxelGrid *voxelGrid;
 			const std::vector<VoxelTexture> *voxelTextures;
 			std::vector<OcclusionData> *occlusion;
+			VoxelHistory *history; // Null if interlaced rendering is off.
+			std::unique_ptr<ColumnBatchRange[]> batchRanges; // One per render thread.
 			double ceilingHeight;
-
-			void init(double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
-				const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &voxelTextures,
-				std::vector<OcclusionData> &occlusion);
+			double detailDistance; // Where odd columns stop ray casting. Infinite if off.
+			int frameWidth;
+			int rangeCount;
+			int columnParity; // Only columns with this X parity are ray cast, or all if -1.
+			bool reprojectHistory; // Whether skipped columns can come from the previous frame.
+			alignas(64) std::atomic<int> threadsDone;
+			// Threads done filling in skipped columns.
+			alignas(64) std::atomic<int> threadsDoneHistory;
+
+			Voxels();
+
+			void init(double ceilingHeight, double detailDistance,
+				const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+				const std::vector<VoxelTexture> &voxelTextures,
+				std::vector<OcclusionData> &occlusion, int totalThreads, int frameWidth,
+				VoxelHistory *history, int columnParity, bool reprojectHistory);
+
+			// Gets the next batch of columns for the given render thread to draw, stealing from
+			// another thread if its own range is empty. Returns false when no columns are left.
+			bool getNextColumnBatch(int threadIndex, int *startX, int *endX);
 		};
 
 		struct Flats
 		{
-			int threadsDone;
 			const Double3 *flatNormal;
 			const std::vector<VisibleFlat> *visibleFlats;
+			const std::vector<std::vector<int>> *visibleFlatBins; // Visible flats per thread.
+			std::vector<FlatOcclusion> *occlusions; // Written by each thread before its flats.
 			const std::vector<FlatTexture> *flatTextures;
-			bool doneSorting; // True when render threads can start rendering flats.
+			const ShadeTable *shadeTable; // For resolving palette mode pixels after flats.
+			alignas(64) std::atomic<int> threadsDone;
+			// True when render threads can start rendering flats.
+			alignas(64) std::atomic<bool> doneSorting;
 
 			void init(const Double3 &flatNormal, const std::vector<VisibleFlat> &visibleFlats,
-				const std::vector<FlatTexture> &flatTextures);
+				const std::vector<std::vector<int>> &visibleFlatBins,
+				std::vector<FlatOcclusion> &occlusions,
+				const std::vector<FlatTexture> &flatTextures, const ShadeTable &shadeTable);
+		};
+
+		// Work from outside the renderer (i.e., entity updates) split into batches that the
+		// render threads and the calling thread take until there are none left.
+		struct Job
+		{
+			const std::function<void(int)> *batchFunction; // Null when the go signal is for a frame.
+			int batchCount;
+			alignas(64) std::atomic<int> nextBatch;
+			alignas(64) std::atomic<int> threadsDone;
+			alignas(64) std::atomic<int> threadsReleased;
+
+			Job();
+
+			void init(const std::function<void(int)> &batchFunction, int batchCount);
+
+			// Runs batches until every batch has been taken.
+			void runBatches();
+		};
+
+		// Columns and rows of the frame that a thread draws its share of.
+		struct ThreadRange
+		{
+			int startX, endX, startY, endY;
 		};
 
 		SkyGradient skyGradient;
 		DistantSky distantSky;
 		Voxels voxels;
 		Flats flats;
+		Job job;
+		std::vector<ThreadRange> ranges; // One per thread, from the current frame's size.
 		const Camera *camera;
 		const ShadingInfo *shadingInfo;
 		const FrameView *frame;
+		RenderTimings *timings;
+
+		// Number of times a waiting thread polls its condition before parking on the
+		// condition variable. Most phase waits are short, so spinning avoids the cost of
+		// sleeping and waking every thread several times per frame.
+		static const int SPIN_COUNT;
 
-		std::condition_variable condVar;
-		std::mutex mutex;
 		int totalThreads;
-		bool go; // Initial go signal to start work each frame.
-		bool isDestructing; // Helps shut down threads in the renderer destructor.
+		alignas(64) std::condition_variable condVar;
+		std::mutex mutex;
+		// Threads currently sleeping on the condition variable.
+		alignas(64) std::atomic<int> parkedThreads;
+		alignas(64) std::atomic<bool> go; // Initial go signal to start work each frame.
+		std::atomic<bool> isDestructing; // Helps shut down threads in the renderer destructor.
 
 		RenderThreadData();
 
 		void init(int totalThreads, const Camera &camera, const ShadingInfo &shadingInfo,
-			const FrameView &frame);
+			const FrameView &frame, RenderTimings &timings);
+
+		// Blocks the calling thread until the predicate is true. It spins for a while first,
+		// then parks on the condition variable until notifyAll() is called.
+		template <typename T>
+		void waitUntil(T &&predicate);
+
+		// Wakes any parked threads so they re-check their condition. Must be called after
+		// changing something that a thread might be waiting on.
+		void notifyAll();
+
+		// Marks the calling thread as done with a phase and wakes waiters if it was the last one.
+		void arrive(std::atomic<int> &threadsDone);
 	};
 
 	// Clipping planes for Z coordinates.
 	static const double NEAR_PLANE;
 	static const double FAR_PLANE;
 
+	// Scalar type of the per-pixel interpolation in the rasterization loops (texture
+	// coordinates and depth down a column). World-space positions, ray casting, and per-column
+	// setup stay double. Building with TES_RENDERER_FLOAT trades some texture coordinate
+	// precision for cheaper, twice as wide math.
+#ifdef TES_RENDERER_FLOAT
+	typedef float PixelReal;
+#else
+	typedef double PixelReal;
+#endif
+
+	// Offset to a pixel's center, and the largest texture coordinate below one, at pixel
+	// precision.
+	static const PixelReal PIXEL_CENTER;
+	static const PixelReal PIXEL_JUST_BELOW_ONE;
+
+	// Max number of adjacent rays cast together as a packet.
+	static const int RAY_PACKET_SIZE;
+
 	// Default texture array sizes (using vector instead of array to avoid stack overflow).
 	static const int DEFAULT_VOXEL_TEXTURE_COUNT;
 	static const int DEFAULT_FLAT_TEXTURE_COUNT;
@@ -403,50 +947,146 @@ private:
 	// Max angle of distant clouds above the horizon, in degrees.
 	static const double DISTANT_CLOUDS_MAX_ANGLE;
 
-	std::vector<double> depthBuffer; // 2D buffer, mostly consists of depth in the XZ plane.
+	// Width and depth of each flat grid cell in voxels. Flats are assumed to be narrower
+	// than this so they never reach more than one cell past their own.
+	static const double FLAT_GRID_CELL_SIZE;
+
+	// Voxel layers whose floor tops and ceiling bottoms the scanline pass draws.
+	static const int SCANLINE_FLOOR_Y;
+	static const int SCANLINE_CEILING_Y;
+
+	// Maps an 8-bit texel channel to its [0, 1] floating-point intensity.
+	static const std::array<double, 256> TEXEL_CHANNEL_TO_DOUBLE;
+
+	// 2D buffers in column-major order (see FrameView).
+	std::vector<uint32_t> colorBuffer; // Drawn into, then transposed into the caller's pixels.
+	std::vector<float> depthBuffer; // Mostly consists of depth in the XZ plane.
+	std::vector<uint16_t> indexBuffer; // Shade table values for palette mode.
 	std::vector<OcclusionData> occlusion; // Min and max Y for each column.
 	std::unordered_map<int, Flat> flats; // All flats in world.
+	std::unordered_map<Int2, std::vector<const Flat*>> flatGrid; // Flats bucketed by grid cell.
+	VisibilityRegions visibilityRegions; // Regions of the level bounded by walls and doors.
+	std::vector<bool> visibleRegions; // Regions seen from the eye this frame.
+	std::unordered_map<int, Light> lights; // All lights in world.
+	LightGrid lightGrid; // Lights bucketed by the voxel columns they reach.
+	LightMap lightMap; // Baked light from lights that haven't changed since the last bake.
+	LightMap pendingLightMap; // Written by the light bake job.
+	std::unique_ptr<ShadingInfo> shadingInfo; // Updated each frame, points to the lights.
+	std::future<void> lightBakeJob; // Bakes the pending light map off the main thread.
+	std::atomic<bool> lightBakeDone; // Set by the light bake job when it finishes.
+	bool lightBakeStale; // Whether a light in the pending bake changed before it finished.
 	std::vector<VisibleFlat> visibleFlats; // Flats to be drawn.
+	std::vector<VisibleFlat> visibleFlatsTemp; // Scratch space for sorting visible flats.
+	std::vector<std::pair<uint64_t, int>> visibleFlatKeys, visibleFlatKeysTemp; // Depth sort keys.
 	DistantObjects distantObjects; // Distant sky objects (mountains, clouds, etc.).
 	VisDistantObjects visDistantObjs; // Visible distant sky objects.
+	std::vector<int> potentiallyVisibleStars; // Scratch space for star visibility testing.
 	std::vector<VoxelTexture> voxelTextures; // Max 64 voxel textures in original engine.
+	std::vector<VoxelTextureAnimation> voxelTextureAnimations; // Voxel textures with frames.
 	std::vector<FlatTexture> flatTextures; // Max 256 flat textures in original engine.
 	std::vector<SkyTexture> skyTextures; // Distant object textures. Size is managed internally.
+	std::vector<const Surface*> skyTextureSurfaces; // Source of each sky texture (null for small stars).
 	std::vector<Double3> skyPalette; // Colors for each time of day.
 	std::vector<Double3> skyGradientRowCache; // Contains row colors of most recent sky gradient.
+	std::vector<uint32_t> skyGradientRowColorCache; // Same as above but in frame buffer format.
+	std::array<Double3, ShadingInfo::SKY_COLOR_COUNT> skyGradientCacheColors; // Cache inputs.
+	double skyGradientCacheProjYTop, skyGradientCacheProjYBottom; // Cache inputs.
+	bool skyGradientCacheIsValid; // False if the row caches must be recomputed.
 	std::vector<std::thread> renderThreads; // Threads used for rendering the world.
+	std::vector<std::vector<int>> visibleFlatBins; // Visible flat indices touching each thread.
+	std::vector<FlatOcclusion> flatOcclusions; // Farthest wall depths in each thread's columns.
 	RenderThreadData threadData; // Managed by main thread, used by render threads.
 	double fogDistance; // Distance at which fog is maximum.
+	VoxelHistory voxelHistory; // Previous voxel pass results for interlaced rendering.
+	FrameInputs lastFrameInputs; // For skipping frames that would be the same as the last one.
+	std::vector<ColumnHit> columnHits; // Per column of the last frame, for screen point queries.
+	Double3 columnHitsEye, columnHitsDirection; // Camera the column hits were recorded from.
 	int width, height; // Dimensions of frame buffer.
 	int renderThreadsMode; // Determines number of threads to use for rendering.
-
-	// Gets the number of render threads to use based on the given mode.
-	static int getRenderThreadsFromMode(int mode);
+	int autoRenderThreadCount; // Thread count for the auto mode, or 0 if it isn't known yet.
+	int renderThreadsAffinity; // Determines which cores render threads are pinned to.
+	std::vector<int> renderThreadsCoreList; // Cores to pin to in the list affinity mode.
+	bool renderThreadsHighPriority; // Whether render threads ask for a higher priority.
+	bool interlacedVoxels; // Whether only every other voxel column is ray cast each frame.
+	bool nightLightsActive; // Whether voxel textures use their night variant.
+	double voxelDetailDistance; // Past this, odd voxel columns copy their neighbor. Zero if off.
+	ShadeTable shadeTable; // Palette and final colors for palette mode.
+	bool paletteRendering; // Whether voxels and flats are drawn as palette indices.
+	bool scanlinePlanes; // Whether floors and ceilings are drawn a row at a time.
+	RenderTimings renderTimings; // Per-phase times of recent frames.
+
+	// Gets the number of render threads to use for the current mode.
+	int getRenderThreadCount() const;
 
 	// Initializes render threads that run in the background for the duration of the renderer's
-	// lifetime. This can also be used to reset threads after a screen resize.
-	void initRenderThreads(int width, int height, int threadCount);
+	// lifetime. This can also be used to restart threads with a different count or affinity.
+	void initRenderThreads(int threadCount);
 
 	// Turns off each thread in the render threads list peacefully. The render threads are expected
 	// to be at their initial wait condition before being given the go + destruct signals.
 	void resetRenderThreads();
 
+	// Puts an animated voxel texture back to using its first frame only. The rest of its
+	// frames are left allocated until the textures are cleared.
+	void stopVoxelTextureAnimation(int id);
+
+	// Overwrites a voxel texture's data with the given 64x64 set of texels. Only writes to
+	// the given texture, so different textures can be done at the same time.
+	static void initVoxelTexture(VoxelTexture &texture, const uint32_t *srcTexels,
+		const ShadeTable &shadeTable);
+
 	// Refreshes the list of distant objects to be drawn.
 	void updateVisibleDistantObjects(bool parallaxSky, const ShadingInfo &shadingInfo,
 		const Camera &camera, const FrameView &frame);
 
-	// Refreshes the list of flats to be drawn.
-	void updateVisibleFlats(const Camera &camera);
+	// Gets the flat grid cell that contains the given point.
+	static Int2 getFlatGridCell(const Double3 &point);
+
+	// Adds or removes a flat in the flat grid cell it's currently in.
+	void addFlatToGrid(const Flat &flat);
+	void removeFlatFromGrid(const Flat &flat);
+
+	// Gets the inclusive range of voxel columns that a light reaches.
+	static void getLightGridCells(const Light &light, Int2 *outMin, Int2 *outMax);
+
+	// Adds or removes a light in every voxel column it reaches.
+	void addLightToGrid(const Light &light);
+	void removeLightFromGrid(const Light &light);
+
+	// Waits for the light bake job, if any, to finish.
+	void waitForLightBake();
+
+	// Puts every baked light back in the light grid and empties the light map.
+	void discardLightMap();
+
+	// Swaps in the pending light map if the light bake job is done.
+	void updateLightMap();
+
+	// Refreshes the list of flats to be drawn. Only flats in grid cells that intersect the
+	// 2D view frustum (bounded by the fog distance) are tested, and if the level has
+	// visibility regions, only flats in regions seen from the eye.
+	void updateVisibleFlats(const Camera &camera, double ceilingHeight,
+		const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid);
+
+	// Sorts the visible flats farthest to nearest with a radix sort on their depth.
+	void sortVisibleFlats();
+
+	// Assigns each visible flat to the render threads whose screen columns it covers, so each
+	// thread only sets up the flats it draws. Bins keep the sorted draw order.
+	void binVisibleFlats(const FrameView &frame);
 	
 	// Gets the facing value for the far side of a chasm.
 	static VoxelData::Facing getInitialChasmFarFacing(int voxelX, int voxelZ,
 		const Double2 &eye, const Ray &ray);
 	static VoxelData::Facing getChasmFarFacing(int voxelX, int voxelZ,
 		VoxelData::Facing nearFacing, const Camera &camera, const Ray &ray);
+	static VoxelData::Facing getChasmFarFacing(int voxelX, int voxelZ,
+		VoxelData::Facing nearFacing, const Camera &camera, double angle,
+		const VoxelCornerAngles &cornerAngles);
 
 	// Gets the percent open of a door, or zero if there's no open door at the given voxel.
 	static double getDoorPercentOpen(int voxelX, int voxelZ,
-		const std::vector<LevelData::DoorState> &openDoors);
+		const LevelData::OpenDoors &openDoors);
 
 	// Calculates the projected Y coordinate of a 3D point given a transform and Y-shear value.
 	static double getProjectedY(const Double3 &point, const Matrix4d &transform, double yShear);
@@ -473,6 +1113,9 @@ private:
 		const Double3 &midPoint1, const Double3 &midPoint2, const Double3 &endPoint,
 		const Camera &camera, const FrameView &frame);
 
+	// Gets the direction towards a distant space object from its X and Y angles.
+	static Double3 getSpaceObjectDirection(double xAngleRadians, double yAngleRadians);
+
 	// Creates a rotation matrix for drawing latitude-correct distant space objects.
 	static Matrix4d getLatitudeRotation(double latitude);
 
@@ -513,9 +1156,10 @@ private:
 	// Gathers potential intersection data from a voxel containing an edge ID. The facing
 	// determines which edge of the voxel an intersection can occur on. This function is separate
 	// from the initial case since it's a trivial solution when the edge and near facings match.
-	static bool findEdgeIntersection(int voxelX, int voxelZ, VoxelData::Facing edgeFacing,
-		bool flipped, VoxelData::Facing nearFacing, const Double2 &nearPoint,
-		const Double2 &farPoint, double nearU, const Camera &camera, const Ray &ray, RayHit &hit);
+	// The far side comes from the column's batched intersections.
+	static bool findEdgeIntersection(VoxelData::Facing edgeFacing, bool flipped,
+		VoxelData::Facing nearFacing, const Double2 &nearPoint, const Double2 &farPoint,
+		double nearU, const ColumnIntersections &intersections, RayHit &hit);
 
 	// Helper method for findInitialDoorIntersection() for swinging doors.
 	static bool findInitialSwingingDoorIntersection(int voxelX, int voxelZ, double percentOpen,
@@ -529,38 +1173,92 @@ private:
 		const Double2 &farPoint, const Camera &camera, const Ray &ray, const VoxelGrid &voxelGrid,
 		RayHit &hit);
 
-	// Helper method for findDoorIntersection() for swinging doors.
-	static bool findSwingingDoorIntersection(int voxelX, int voxelZ, double percentOpen,
-		VoxelData::Facing nearFacing, const Double2 &nearPoint, const Double2 &farPoint,
-		double nearU, RayHit &hit);
+	// Gets the hinge point and the current direction of a swinging door that's entered
+	// through the given face.
+	static void getSwingingDoorLine(int voxelX, int voxelZ, double percentOpen,
+		VoxelData::Facing nearFacing, Double2 *outPivot, Double2 *outDoorVec);
 
 	// Gathers potential intersection data from a voxel containing a door ID. The door
 	// type determines what kind of door formula to calculate for the intersection. Raising doors
-	// are always hit, so they do not need a specialized method.
-	static bool findDoorIntersection(int voxelX, int voxelZ, VoxelData::DoorData::Type doorType,
-		double percentOpen, VoxelData::Facing nearFacing, const Double2 &nearPoint,
-		const Double2 &farPoint, double nearU, RayHit &hit);
+	// are always hit, and swinging door hits come from the column's batched intersections.
+	static bool findDoorIntersection(VoxelData::DoorData::Type doorType, double percentOpen,
+		VoxelData::Facing nearFacing, const Double2 &nearPoint, double nearU,
+		const ColumnIntersections &intersections, RayHit &hit);
+
+	// Batched intersections for rays crossing the same voxel column, one per ray. The
+	// per-ray math is done in tight loops over the rays, and anything that only depends on
+	// the column (corner angles, door hinges) is done once. Ray angles are from
+	// MathUtils::fullAtan2(ray.dirX, ray.dirZ).
+	static void findDiagIntersections(int voxelX, int voxelZ, int rayCount,
+		const Double2 *nearPoints, const Double2 *farPoints,
+		ColumnIntersections *outIntersections);
+	static void findFarFacings(int voxelX, int voxelZ, int rayCount,
+		const VoxelData::Facing *nearFacings, const Double2 *farPoints, const Camera &camera,
+		const double *rayAngles, ColumnIntersections *outIntersections);
+	static void findSwingingDoorIntersections(int voxelX, int voxelZ, double percentOpen,
+		int rayCount, const VoxelData::Facing *nearFacings, const Double2 *nearPoints,
+		const Double2 *farPoints, ColumnIntersections *outIntersections);
+
+	// Finds the batched intersections that a voxel column's voxels need.
+	static void findColumnIntersections(const VoxelColumnView &column, int rayCount,
+		const VoxelData::Facing *nearFacings, const Double2 *nearPoints,
+		const Double2 *farPoints, const Camera &camera, const double *rayAngles,
+		ColumnIntersections *outIntersections);
 
 	// Casts a 3D ray from the default start point (eye) and returns the color.
 	// (Unused for now; keeping for reference).
 	//Double3 castRay(const Double3 &direction, const VoxelGrid &voxelGrid) const;
 
-	// Draws a column of pixels with no perspective or transparency.
+	// Gets the final color of a voxel texel after shading and fog are applied. The fog sample
+	// is ignored when fog is disabled.
+	template <bool FogEnabled>
+	static uint32_t getShadedVoxelTexelColor(const VoxelTexel &texel, const Double3 &shading,
+		const ShadingInfo::FogSample &fogSample);
+
+	// Shades texture rows [startY, endY) of a voxel texel column into the matching entries of
+	// a column color cache with the span kernel. Returns the cache mask bits of those rows.
+	static uint64_t shadeVoxelTexelColumn(const VoxelTexel *columnTexels, int startY, int endY,
+		const Double3 &shading, const ShadingInfo &shadingInfo,
+		const ShadingInfo::FogSample &fogSample, uint32_t *texelColors);
+
+	// Draws a column of pixels with no perspective or transparency. The light color is the
+	// contribution from point lights, which is constant for the column like the sun's.
 	static void drawPixels(int x, const DrawRange &drawRange, double depth, double u,
-		double vStart, double vEnd, const Double3 &normal, const VoxelTexture &texture,
-		const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame);
+		double vStart, double vEnd, const Double3 &normal, const Double3 &lightColor,
+		const VoxelTexture &texture, const ShadingInfo &shadingInfo, OcclusionData &occlusion,
+		const FrameView &frame);
 
 	// Draws a column of pixels with perspective but no transparency. The pixel drawing order is 
-	// top to bottom, so the start and end values should be passed with that in mind.
+	// top to bottom, so the start and end values should be passed with that in mind. Fog is
+	// sampled per pixel, so there is a specialization for when it's disabled.
+	template <bool FogEnabled>
 	static void drawPerspectivePixels(int x, const DrawRange &drawRange, const Double2 &startPoint,
 		const Double2 &endPoint, double depthStart, double depthEnd, const Double3 &normal,
-		const VoxelTexture &texture, const ShadingInfo &shadingInfo, OcclusionData &occlusion,
-		const FrameView &frame);
+		const Double3 &lightColor, const VoxelTexture &texture, const ShadingInfo &shadingInfo,
+		OcclusionData &occlusion, const FrameView &frame);
+	static void drawPerspectivePixels(int x, const DrawRange &drawRange, const Double2 &startPoint,
+		const Double2 &endPoint, double depthStart, double depthEnd, const Double3 &normal,
+		const Double3 &lightColor, const VoxelTexture &texture, const ShadingInfo &shadingInfo,
+		OcclusionData &occlusion, const FrameView &frame);
+
+	// Draws a column of a floor's top or a ceiling's bottom at the given voxel Y. When the
+	// scanline pass is drawing that layer, this only marks the pixels as occluded so farther
+	// voxels aren't drawn behind them.
+	static void drawPlanePixels(int x, int voxelY, const DrawRange &drawRange,
+		const Double2 &startPoint, const Double2 &endPoint, double depthStart, double depthEnd,
+		const Double3 &normal, const Double3 &lightColor, const VoxelTexture &texture,
+		const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame);
 
 	// Draws a column of pixels with transparency but no perspective.
 	static void drawTransparentPixels(int x, const DrawRange &drawRange, double depth, double u,
-		double vStart, double vEnd, const Double3 &normal, const VoxelTexture &texture,
-		const ShadingInfo &shadingInfo, const OcclusionData &occlusion, const FrameView &frame);
+		double vStart, double vEnd, const Double3 &normal, const Double3 &lightColor,
+		const VoxelTexture &texture, const ShadingInfo &shadingInfo,
+		const OcclusionData &occlusion, const FrameView &frame);
+
+	// Gets the screen rows of a distant object's column that might contain opaque texels,
+	// based on the texture column's opaque range. Returns false if the column is empty.
+	static bool getDistantColumnRange(const DrawRange &drawRange, double vStart, double vEnd,
+		const SkyTexture &texture, int textureX, int *outYStart, int *outYEnd);
 
 	// Draws a column of pixels for a distant sky object (mountain, cloud, etc.). The 'emissive'
 	// parameter is for animated objects like volcanoes.
@@ -584,42 +1282,56 @@ private:
 	static void drawInitialVoxelColumn(int x, int voxelX, int voxelZ, const Camera &camera,
 		const Ray &ray, VoxelData::Facing facing, const Double2 &nearPoint,
 		const Double2 &farPoint, double nearZ, double farZ, const ShadingInfo &shadingInfo,
-		double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
+		double ceilingHeight, const LevelData::OpenDoors &openDoors,
 		const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &textures,
 		OcclusionData &occlusion, const FrameView &frame);
 
-	// Manages drawing voxels in the column of the given XZ coordinate in the voxel grid.
-	static void drawVoxelColumn(int x, int voxelX, int voxelZ, const Camera &camera,
-		const Ray &ray, VoxelData::Facing facing, const Double2 &nearPoint,
-		const Double2 &farPoint, double nearZ, double farZ, const ShadingInfo &shadingInfo,
-		double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
+	// Manages drawing voxels in the given XZ column of the voxel grid.
+	static void drawVoxelColumn(int x, const VoxelColumnView &column,
+		const ColumnIntersections &intersections, const Camera &camera,
+		VoxelData::Facing facing, const Double2 &nearPoint, const Double2 &farPoint,
+		double nearZ, double farZ, const ShadingInfo &shadingInfo, double ceilingHeight,
 		const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &textures,
 		OcclusionData &occlusion, const FrameView &frame);
 
 	// Draws the portion of a flat contained within the given X range of the screen. The end
-	// X value is exclusive.
+	// X value is exclusive. Columns of the flat behind every wall pixel in them are skipped.
+	template <bool FogEnabled>
 	static void drawFlat(int startX, int endX, const Flat::Frame &flatFrame, 
-		const Double3 &normal, bool flipped, const Double2 &eye, const ShadingInfo &shadingInfo, 
-		const FlatTexture &texture, const FrameView &frame);
+		const Double3 &normal, const Double3 &lightColor, bool flipped, const Double2 &eye,
+		const ShadingInfo &shadingInfo, const FlatTexture &texture, int frameIndex,
+		const FlatOcclusion &occlusion, const FrameView &frame);
 
 	// @todo: drawAlphaFlat(...), for flats with partial transparency.
 	// - Must be back to front.
 
-	// Casts a 2D ray that steps through the current floor, rendering all voxels
-	// in the XZ column of each voxel.
-	static void rayCast2D(int x, const Camera &camera, const Ray &ray,
-		const ShadingInfo &shadingInfo, double ceilingHeight,
-		const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid,
-		const std::vector<VoxelTexture> &textures, OcclusionData &occlusion,
+	// Casts a packet of 2D rays for adjacent screen columns (starting at the given X and
+	// spaced by the column step) that step through the current floor, rendering all voxels
+	// in the XZ column of each voxel. While the rays are in the same voxel column, its voxel
+	// lookups are shared. Once they diverge, each ray finishes on its own. When every column
+	// is cast, rays for odd columns stop at the detail distance and the rest of their pixels
+	// are copied from the column to their left.
+	static void rayCast2D(int startX, int columnStep, int rayCount, const Camera &camera,
+		const Ray *rays, const ShadingInfo &shadingInfo, double ceilingHeight,
+		double detailDistance,
+		const LevelData::OpenDoors &openDoors, const VoxelGrid &voxelGrid,
+		const std::vector<VoxelTexture> &textures, std::vector<OcclusionData> &occlusion,
 		const FrameView &frame);
 
-	// Draws a portion of the sky gradient. The start and end Y are determined from current
-	// threading settings.
-	static void drawSkyGradient(int startY, int endY, double gradientProjYTop,
+	// Updates a portion of the sky gradient row caches. The start and end Y are determined
+	// from current threading settings. If the row caches are valid, their colors are reused
+	// instead of being recomputed.
+	static void updateSkyGradientRows(int startY, int endY, double gradientProjYTop,
 		double gradientProjYBottom, std::vector<Double3> &skyGradientRowCache,
+		std::vector<uint32_t> &skyGradientRowColorCache, bool rowCacheIsValid,
 		std::atomic<bool> &shouldDrawStars, const ShadingInfo &shadingInfo,
 		const FrameView &frame);
 
+	// Draws the sky gradient in the given range of screen columns. Every row of the row
+	// color cache must be updated first.
+	static void drawSkyGradient(int startX, int endX,
+		const std::vector<uint32_t> &skyGradientRowColorCache, const FrameView &frame);
+
 	// Draws some columns of distant sky objects (mountains, clouds, etc.). The start and end X
 	// are determined from current threading settings.
 	static void drawDistantSky(int startX, int endX, bool parallaxSky,
@@ -627,23 +1339,53 @@ private:
 		const std::vector<Double3> &skyGradientRowCache, bool shouldDrawStars,
 		const ShadingInfo &shadingInfo, const FrameView &frame);
 
-	// Handles drawing all voxels for the current frame.
-	static void drawVoxels(int startX, int stride, const Camera &camera, double ceilingHeight,
-		const std::vector<LevelData::DoorState> &openDoors, const VoxelGrid &voxelGrid,
-		const std::vector<VoxelTexture> &voxelTextures, std::vector<OcclusionData> &occlusion,
-		const ShadingInfo &shadingInfo, const FrameView &frame);
+	// Handles drawing voxels in the given range of screen columns for the current frame,
+	// stepping by the given number of columns.
+	static void drawVoxels(int startX, int endX, int columnStep, const Camera &camera,
+		double ceilingHeight, double detailDistance, const LevelData::OpenDoors &openDoors,
+		const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &voxelTextures,
+		std::vector<OcclusionData> &occlusion, const ShadingInfo &shadingInfo,
+		const FrameView &frame);
 
-	// Handles drawing all flats for the current frame.
+	// Draws the floor tops of the bottom voxel layer and the ceiling bottoms of the top one in
+	// the given range of screen columns, a row at a time. Every pixel in a row has the same
+	// camera depth, so points on the plane are stepped across the row instead of being
+	// interpolated down each column. Must be called after drawVoxels() for the same columns.
+	static void drawScanlinePlanes(int startX, int endX, int columnStep, const Camera &camera,
+		double ceilingHeight, const VoxelGrid &voxelGrid,
+		const std::vector<VoxelTexture> &voxelTextures, const ShadingInfo &shadingInfo,
+		const FrameView &frame);
+
+	// For interlaced rendering. Saves the ray cast columns in the given range to the voxel
+	// history and fills in the skipped ones, either from the previous frame or from a
+	// neighboring column.
+	static void updateVoxelHistory(int startX, int endX, const Camera &camera,
+		VoxelHistory &history, int columnParity, bool reprojectHistory, const FrameView &frame);
+
+	// Handles drawing the given visible flats (in order) for the current frame. The occlusion
+	// must be initialized for the same columns after voxels are drawn.
 	static void drawFlats(int startX, int endX, const Camera &camera, const Double3 &flatNormal,
-		const std::vector<VisibleFlat> &visibleFlats, const std::vector<FlatTexture> &flatTextures,
-		const ShadingInfo &shadingInfo, const FrameView &frame);
+		const std::vector<VisibleFlat> &visibleFlats, const std::vector<int> &flatIndices,
+		const std::vector<FlatTexture> &flatTextures, const ShadingInfo &shadingInfo,
+		const FlatOcclusion &occlusion, const FrameView &frame);
+
+	// For palette mode. Replaces the colors of pixels in the given range of screen columns
+	// that were drawn as shade table values.
+	static void resolvePaletteIndices(int startX, int endX, const ShadeTable &shadeTable,
+		const FrameView &frame);
+
+	// Copies the given range of screen columns from the column-major color buffer into the
+	// row-major output buffer.
+	static void transposeFrame(int startX, int endX, const FrameView &frame);
 
 	// Thread loop for each render thread. All threads are initialized in the constructor and
 	// wait for a go signal at the beginning of each render(). If the renderer is destructing,
 	// then each render thread still gets a go signal, but they immediately leave their loop
-	// and terminate. Non-thread-data parameters are for start/end column/row for each thread.
-	static void renderThreadLoop(RenderThreadData &threadData, int threadIndex, int startX,
-		int endX, int startY, int endY);
+	// and terminate. The thread's columns and rows are read from the thread data each frame.
+	// Other parameters are the core to pin the thread to (-1 for any), and whether to raise
+	// its priority.
+	static void renderThreadLoop(RenderThreadData &threadData, int threadIndex, int core,
+		bool highPriority);
 public:
 	SoftwareRenderer();
 	~SoftwareRenderer();
@@ -653,26 +1395,52 @@ public:
 
 	bool isInited() const;
 
+	// Gets the core each render thread is pinned to for an affinity mode (0: any core,
+	// 1: fastest cores first, 2: the given core list in order). Empty if the OS decides.
+	static std::vector<int> getRenderThreadCores(int threadCount, int affinityMode,
+		const std::vector<int> &coreList);
+
+	// Moves the calling thread off the cores render threads would be pinned to, so it and
+	// any threads it starts afterwards (i.e., audio) don't compete with them. Does nothing
+	// if render threads aren't pinned or would use every core.
+	static void avoidRenderThreadCores(int renderThreadsMode, int affinityMode,
+		const std::vector<int> &coreList);
+
+	// Gets the number of render threads to use based on the given mode. The auto mode gets
+	// the same count as very high since the tuned count isn't known statically.
+	static int getRenderThreadsFromMode(int mode);
+
 	// Sets the render threads mode to use (low, medium, high, etc.).
 	void setRenderThreadsMode(int mode);
 
+	// Sets the thread count used by the auto render threads mode, or zero for the default.
+	// Restarts render threads if initialized in that mode and the count changed.
+	void setAutoRenderThreadCount(int threadCount);
+
+	// Sets the affinity mode and core list that render threads are pinned with, and whether
+	// they ask for a higher scheduling priority. Restarts render threads if initialized.
+	void setRenderThreadsAffinity(int affinityMode, const std::vector<int> &coreList,
+		bool highPriority);
+
 	// Adds a flat. Causes an error if the ID exists.
 	void addFlat(int id, const Double3 &position, double width, double height, int textureID);
 
-	// Adds a light. Causes an error if the ID exists.
+	// Adds a light. Causes an error if the ID exists. The intensity is the radius the light
+	// reaches, in voxels.
 	void addLight(int id, const Double3 &point, const Double3 &color, double intensity);
 
 	// Updates various data for a flat. If a value doesn't need updating, pass null.
 	// Causes an error if no ID matches.
 	void updateFlat(int id, const Double3 *position, const double *width, 
-		const double *height, const int *textureID, const bool *flipped);
+		const double *height, const int *textureID, const int *frameIndex,
+		const bool *flipped);
 
 	// Updates various data for a light. If a value doesn't need updating, pass null.
 	// Causes an error if no ID matches.
 	void updateLight(int id, const Double3 *point, const Double3 *color,
 		const double *intensity);
 
-	// Sets the distance at which the fog is maximum.
+	// Sets the distance at which the fog is maximum. An infinite distance disables fog.
 	void setFogDistance(double fogDistance);
 
 	// Sets textures for the distant sky (mountains, clouds, etc.).
@@ -685,9 +1453,48 @@ public:
 	// Overwrites the selected voxel texture's data with the given 64x64 set of texels.
 	void setVoxelTexture(int id, const uint32_t *srcTexels);
 
+	// Overwrites the voxel textures with the IDs of the given 64x64 sets of texels (null ones
+	// are left alone). They are converted in parallel on the render threads, so this must not
+	// be called during a frame.
+	void setVoxelTextures(const std::vector<const uint32_t*> &srcTexels);
+
+	// Same as setVoxelTexture() but with every frame of an animation, which are all converted
+	// once here. The ID's first frame goes in its own slot and the rest are stored after the
+	// texture IDs, so changing frames is only a change of index.
+	void setVoxelTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames,
+		double secondsPerFrame);
+
+	// Advances the clock of animated voxel textures.
+	void tickAnimations(double dt);
+
 	// Overwrites the selected flat texture's data with the given texels and dimensions.
 	void setFlatTexture(int id, const uint32_t *srcTexels, int width, int height);
 
+	// Same as setFlatTexture() but packs every frame of an animation into the texture's
+	// atlas. Frames all have the given dimensions.
+	void setFlatTextureFrames(int id, const std::vector<const uint32_t*> &srcFrames, int width,
+		int height);
+
+	// Sets whether voxel columns are interlaced, so only every other column is ray cast each
+	// frame and the rest are reprojected from the previous frame.
+	void setInterlacedVoxels(bool active);
+
+	// Sets the distance past which only even voxel columns keep being ray cast, and odd ones
+	// take the rest of their pixels from the column to their left. Zero turns it off.
+	void setVoxelDetailDistance(double distance);
+
+	// Sets the 256 colors that voxel and flat textures are made from, for palette mode.
+	void setTexturePalette(const uint32_t *colors, int count);
+
+	// Sets whether voxels and flats are drawn as palette indices with quantized light and fog
+	// levels, then resolved to colors through a shade table. Interlaced voxels are not used
+	// in this mode.
+	void setPaletteRendering(bool active);
+
+	// Sets whether the floor and ceiling voxel layers are drawn a row at a time after the ray
+	// cast columns. Only for levels with one flat floor and ceiling (i.e., interiors).
+	void setScanlinePlanes(bool active);
+
 	// Sets whether night lights and night textures are active. This only needs to be set for
 	// exterior locations (i.e., cities and wilderness) because those are the only places
 	// with time-dependent light sources and textures.
@@ -699,24 +1506,73 @@ public:
 	// Removes a light. Causes an error if no ID matches.
 	void removeLight(int id);
 
+	// Starts baking the current lights into a light map on a worker thread, so they don't
+	// need to be evaluated per frame. Until it finishes, lights are drawn as before. Updating
+	// or removing a baked light puts all baked lights back to being evaluated per frame.
+	void bakeLights(const VoxelGrid &voxelGrid, double ceilingHeight);
+
 	// Zeroes out all renderer textures.
 	void clearTextures();
 
 	// Removes all distant sky objects.
 	void clearDistantSky();
 
+	// Groups the level's voxels into regions bounded by walls and doors, so flats in regions
+	// that can't be seen through the open doors aren't tested each frame. For levels with
+	// enclosed rooms (i.e., interiors). Regions are rebuilt if the voxel grid changes.
+	void buildVisibilityRegions(const VoxelGrid &voxelGrid);
+	void clearVisibilityRegions();
+
+	void reportMemory(MemoryReport &report) const;
+
+	// Gets how long each phase of recent frames took, on each render thread and on the main
+	// thread.
+	const RenderTimings &getRenderTimings() const;
+
+	// Sets how long presenting the last frame took, so it's included with the render timings.
+	void setPresentTime(double seconds);
+
 	// Initializes software renderer with the given frame buffer dimensions. This can be called
 	// on first start or to reset the software renderer.
 	void init(int width, int height, int renderThreadsMode);
 
-	// Resizes the frame buffer and related values.
+	// Resizes the frame buffer and related values. The render threads keep running, and
+	// buffers are only reallocated when they grow past what was reserved.
 	void resize(int width, int height);
 
-	// Draws the scene to the output color buffer in ARGB8888 format.
+	// Allocates the frame buffer and related values for sizes up to the given one, so
+	// resizing within it (i.e., dynamic resolution) doesn't allocate.
+	void reserve(int width, int height);
+
+	// Returns whether rendering with the given inputs would draw the same frame as the last
+	// render call, because neither they nor anything set in the renderer since have changed
+	// (daytime and ambient light only to within a small step). The caller can show its copy of
+	// the last frame again instead of rendering.
+	bool isFrameUnchanged(const Double3 &eye, const Double3 &direction, double fovY,
+		double ambient, double daytimePercent, double latitude, bool parallaxSky,
+		double ceilingHeight, const LevelData::OpenDoors &openDoors,
+		const VoxelGrid &voxelGrid) const;
+
+	// Draws the scene to the output buffer in ARGB8888 format (row-major). The optional main
+	// thread task is run while the render threads are busy drawing voxels.
 	void render(const Double3 &eye, const Double3 &direction, double fovY,
 		double ambient, double daytimePercent, double latitude, bool parallaxSky,
-		double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
-		const VoxelGrid &voxelGrid, uint32_t *colorBuffer);
+		double ceilingHeight, const LevelData::OpenDoors &openDoors,
+		const VoxelGrid &voxelGrid, uint32_t *outputBuffer,
+		const std::function<void()> &mainThreadTask);
+
+	// Gets the nearest non-air voxel at the camera's voxel height drawn in the column at the
+	// given X percent across the last frame, if that frame was rendered from the given eye
+	// and direction. Returns false if the column's ray didn't reach one (i.e., the column was
+	// skipped by interlacing or stopped at the fog), so the caller has to ray cast instead.
+	bool getColumnHit(const Double3 &eye, const Double3 &direction, double xPercent,
+		Int3 *outVoxel, double *outDistance, VoxelData::Facing *outFacing) const;
+
+	// Calls the batch function once for each batch index, spread over the render threads and
+	// the calling thread, and returns when every batch is done. Batches run in no particular
+	// order, so each one must only write data that no other batch touches. Must not be called
+	// during a frame.
+	void runParallel(int batchCount, const std::function<void(int)> &batchFunction);
 };
 
 #endif
@@ -1,6 +1,7 @@
 #include "SDL.h"
 
 #include "Surface.h"
+#include "SurfaceBlitter.h"
 #include "../Math/Rect.h"
 #include "../Utilities/Debug.h"
 
@@ -131,7 +132,10 @@ uint32_t Surface::mapRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a) const
 
 void Surface::fill(uint32_t color)
 {
-	SDL_FillRect(this->surface, nullptr, color);
+	if (!SurfaceBlitter::fillRect(this->surface, nullptr, color))
+	{
+		SDL_FillRect(this->surface, nullptr, color);
+	}
 }
 
 void Surface::fill(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
@@ -146,7 +150,10 @@ void Surface::fill(uint8_t r, uint8_t g, uint8_t b)
 
 void Surface::fillRect(const Rect &rect, uint32_t color)
 {
-	SDL_FillRect(this->surface, &rect.getRect(), color);
+	if (!SurfaceBlitter::fillRect(this->surface, &rect.getRect(), color))
+	{
+		SDL_FillRect(this->surface, &rect.getRect(), color);
+	}
 }
 
 void Surface::fillRect(const Rect &rect, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
@@ -161,7 +168,12 @@ void Surface::fillRect(const Rect &rect, uint8_t r, uint8_t g, uint8_t b)
 
 void Surface::blit(Surface &dst, const Rect &dstRect) const
 {
-	SDL_BlitSurface(this->surface, nullptr, dst.surface, const_cast<SDL_Rect*>(&dstRect.getRect()));
+	if (!SurfaceBlitter::blit(this->surface, nullptr, dst.surface, dstRect.getLeft(),
+		dstRect.getTop()))
+	{
+		SDL_BlitSurface(this->surface, nullptr, dst.surface,
+			const_cast<SDL_Rect*>(&dstRect.getRect()));
+	}
 }
 
 void Surface::blit(Surface &dst, int dstX, int dstY) const
@@ -172,8 +184,12 @@ void Surface::blit(Surface &dst, int dstX, int dstY) const
 
 void Surface::blitRect(const Rect &srcRect, Surface &dst, const Rect &dstRect) const
 {
-	SDL_BlitSurface(this->surface, const_cast<SDL_Rect*>(&srcRect.getRect()),
-		dst.surface, const_cast<SDL_Rect*>(&dstRect.getRect()));
+	if (!SurfaceBlitter::blit(this->surface, &srcRect.getRect(), dst.surface,
+		dstRect.getLeft(), dstRect.getTop()))
+	{
+		SDL_BlitSurface(this->surface, const_cast<SDL_Rect*>(&srcRect.getRect()),
+			dst.surface, const_cast<SDL_Rect*>(&dstRect.getRect()));
+	}
 }
 
 void Surface::blitRect(const Rect &srcRect, Surface &dst, int dstX, int dstY) const
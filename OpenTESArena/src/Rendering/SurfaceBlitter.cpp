@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <cstring>
+
+#include "SDL.h"
+
+#include "SurfaceBlitter.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/KernelDispatch.h"
+#include "../Utilities/PlatformIsa.h"
+
+namespace
+{
+	const uint32_t ALPHA_MASK = 0xFF000000;
+
+	// Rounded (value / 255) for products of two channels.
+	uint32_t divide255(uint32_t value)
+	{
+		value += 128;
+		return (value + (value >> 8)) >> 8;
+	}
+
+	// One pixel of SDL_BLENDMODE_BLEND: the color is interpolated by the source alpha, and
+	// the alpha becomes srcA + (dstA * (1 - srcA)).
+	uint32_t blendPixel(uint32_t src, uint32_t dst)
+	{
+		const uint32_t srcA = src >> 24;
+		const uint32_t invSrcA = 255 - srcA;
+		const uint32_t r = divide255((((src >> 16) & 0xFF) * srcA) +
+			(((dst >> 16) & 0xFF) * invSrcA));
+		const uint32_t g = divide255((((src >> 8) & 0xFF) * srcA) +
+			(((dst >> 8) & 0xFF) * invSrcA));
+		const uint32_t b = divide255(((src & 0xFF) * srcA) + ((dst & 0xFF) * invSrcA));
+		const uint32_t a = srcA + divide255((dst >> 24) * invSrcA);
+		return (a << 24) | (r << 16) | (g << 8) | b;
+	}
+
+	void blendSpan(const uint32_t *src, uint32_t *dst, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			const uint32_t srcPixel = src[i];
+			const uint32_t srcAlpha = srcPixel & ALPHA_MASK;
+			if (srcAlpha == ALPHA_MASK)
+			{
+				dst[i] = srcPixel;
+			}
+			else if (srcAlpha != 0)
+			{
+				dst[i] = blendPixel(srcPixel, dst[i]);
+			}
+		}
+	}
+
+	void tintSpan(const uint32_t *src, uint32_t *dst, int count, uint32_t tint)
+	{
+		const bool isTintOpaque = (tint & ALPHA_MASK) == ALPHA_MASK;
+		for (int i = 0; i < count; i++)
+		{
+			if ((src[i] & ALPHA_MASK) != 0)
+			{
+				dst[i] = isTintOpaque ? tint : blendPixel(tint, dst[i]);
+			}
+		}
+	}
+
+	// Clips a blit the same way as SDL_BlitSurface(): the source rect to the source, then the
+	// destination to its clip rect. Returns false if nothing is left to draw.
+	bool clipBlit(const SDL_Surface *src, const SDL_Rect *srcRect, const SDL_Surface *dst,
+		int dstX, int dstY, int *outSrcX, int *outSrcY, SDL_Rect *outDstRect)
+	{
+		int srcX = 0;
+		int srcY = 0;
+		int width = src->w;
+		int height = src->h;
+		if (srcRect != nullptr)
+		{
+			srcX = srcRect->x;
+			srcY = srcRect->y;
+			width = srcRect->w;
+			height = srcRect->h;
+
+			if (srcX < 0)
+			{
+				width += srcX;
+				dstX -= srcX;
+				srcX = 0;
+			}
+
+			if (srcY < 0)
+			{
+				height += srcY;
+				dstY -= srcY;
+				srcY = 0;
+			}
+
+			width = std::min(width, src->w - srcX);
+			height = std::min(height, src->h - srcY);
+		}
+
+		const SDL_Rect &clipRect = dst->clip_rect;
+		if (dstX < clipRect.x)
+		{
+			const int delta = clipRect.x - dstX;
+			srcX += delta;
+			width -= delta;
+			dstX = clipRect.x;
+		}
+
+		if (dstY < clipRect.y)
+		{
+			const int delta = clipRect.y - dstY;
+			srcY += delta;
+			height -= delta;
+			dstY = clipRect.y;
+		}
+
+		width = std::min(width, (clipRect.x + clipRect.w) - dstX);
+		height = std::min(height, (clipRect.y + clipRect.h) - dstY);
+		if ((width <= 0) || (height <= 0))
+		{
+			return false;
+		}
+
+		*outSrcX = srcX;
+		*outSrcY = srcY;
+		outDstRect->x = dstX;
+		outDstRect->y = dstY;
+		outDstRect->w = width;
+		outDstRect->h = height;
+		return true;
+	}
+
+	const uint32_t *getPixels(const SDL_Surface *surface, int x, int y)
+	{
+		const int pitch = surface->pitch / sizeof(uint32_t);
+		return static_cast<const uint32_t*>(surface->pixels) + x + (y * pitch);
+	}
+
+	uint32_t *getPixels(SDL_Surface *surface, int x, int y)
+	{
+		const int pitch = surface->pitch / sizeof(uint32_t);
+		return static_cast<uint32_t*>(surface->pixels) + x + (y * pitch);
+	}
+
+	int getPitch(const SDL_Surface *surface)
+	{
+		return surface->pitch / sizeof(uint32_t);
+	}
+
+	void fillPixelsScalar(uint32_t *dst, int dstPitch, int width, int height, uint32_t color)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			uint32_t *dstRow = dst + (y * dstPitch);
+			std::fill(dstRow, dstRow + width, color);
+		}
+	}
+
+	void copyPixelsScalar(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			std::memcpy(dst + (y * dstPitch), src + (y * srcPitch), width * sizeof(uint32_t));
+		}
+	}
+
+	void blendPixelsScalar(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			blendSpan(src + (y * srcPitch), dst + (y * dstPitch), width);
+		}
+	}
+
+	void tintPixelsScalar(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height, uint32_t tint)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			tintSpan(src + (y * srcPitch), dst + (y * dstPitch), width, tint);
+		}
+	}
+
+#if defined(PLATFORM_SSE2)
+	void fillPixelsSSE2(uint32_t *dst, int dstPitch, int width, int height, uint32_t color)
+	{
+		const __m128i color4 = _mm_set1_epi32(static_cast<int>(color));
+		for (int y = 0; y < height; y++)
+		{
+			uint32_t *dstRow = dst + (y * dstPitch);
+			int x = 0;
+			for (; (x + 4) <= width; x += 4)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + x), color4);
+			}
+
+			std::fill(dstRow + x, dstRow + width, color);
+		}
+	}
+
+	void copyPixelsSSE2(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height)
+	{
+		// UI rows are mostly a glyph or a line of the automap wide, which is too short for a
+		// call to memcpy() to pay off.
+		for (int y = 0; y < height; y++)
+		{
+			const uint32_t *srcRow = src + (y * srcPitch);
+			uint32_t *dstRow = dst + (y * dstPitch);
+			int x = 0;
+			for (; (x + 4) <= width; x += 4)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow + x),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow + x)));
+			}
+
+			std::copy(srcRow + x, srcRow + width, dstRow + x);
+		}
+	}
+
+	void blendPixelsSSE2(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height)
+	{
+		// Groups of four that are all transparent or opaque are selected with masks. Any
+		// translucent pixel sends its group through the scalar blend.
+		const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(ALPHA_MASK));
+		const __m128i zero = _mm_setzero_si128();
+		for (int y = 0; y < height; y++)
+		{
+			const uint32_t *srcRow = src + (y * srcPitch);
+			uint32_t *dstRow = dst + (y * dstPitch);
+			int x = 0;
+			for (; (x + 4) <= width; x += 4)
+			{
+				const __m128i srcPixels =
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow + x));
+				const __m128i srcAlphas = _mm_and_si128(srcPixels, alphaMask);
+				const __m128i isTransparent = _mm_cmpeq_epi32(srcAlphas, zero);
+				const __m128i isOpaque = _mm_cmpeq_epi32(srcAlphas, alphaMask);
+				const int transparentBits = _mm_movemask_epi8(isTransparent);
+				if (transparentBits == 0xFFFF)
+				{
+					continue;
+				}
+
+				if ((transparentBits | _mm_movemask_epi8(isOpaque)) != 0xFFFF)
+				{
+					blendSpan(srcRow + x, dstRow + x, 4);
+					continue;
+				}
+
+				__m128i *dstPixelsPtr = reinterpret_cast<__m128i*>(dstRow + x);
+				const __m128i dstPixels = _mm_loadu_si128(dstPixelsPtr);
+				_mm_storeu_si128(dstPixelsPtr, _mm_or_si128(_mm_and_si128(isOpaque, srcPixels),
+					_mm_andnot_si128(isOpaque, dstPixels)));
+			}
+
+			blendSpan(srcRow + x, dstRow + x, width - x);
+		}
+	}
+
+	void tintPixelsSSE2(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height, uint32_t tint)
+	{
+		// Translucent tints need the scalar blend for every covered pixel.
+		const bool isTintOpaque = (tint & ALPHA_MASK) == ALPHA_MASK;
+		if (!isTintOpaque)
+		{
+			tintPixelsScalar(src, srcPitch, dst, dstPitch, width, height, tint);
+			return;
+		}
+
+		const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(ALPHA_MASK));
+		const __m128i tint4 = _mm_set1_epi32(static_cast<int>(tint));
+		const __m128i zero = _mm_setzero_si128();
+		for (int y = 0; y < height; y++)
+		{
+			const uint32_t *srcRow = src + (y * srcPitch);
+			uint32_t *dstRow = dst + (y * dstPitch);
+			int x = 0;
+			for (; (x + 4) <= width; x += 4)
+			{
+				const __m128i srcPixels =
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow + x));
+				const __m128i isTransparent =
+					_mm_cmpeq_epi32(_mm_and_si128(srcPixels, alphaMask), zero);
+				if (_mm_movemask_epi8(isTransparent) == 0xFFFF)
+				{
+					continue;
+				}
+
+				__m128i *dstPixelsPtr = reinterpret_cast<__m128i*>(dstRow + x);
+				const __m128i dstPixels = _mm_loadu_si128(dstPixelsPtr);
+				_mm_storeu_si128(dstPixelsPtr, _mm_or_si128(_mm_and_si128(isTransparent,
+					dstPixels), _mm_andnot_si128(isTransparent, tint4)));
+			}
+
+			tintSpan(srcRow + x, dstRow + x, width - x, tint);
+		}
+	}
+#endif
+
+	const KernelDispatch::Kernel<void(uint32_t*, int, int, int, uint32_t)>
+		FillPixelsKernel("SurfaceFill",
+	{
+		{ Platform::CpuIsa::Scalar, fillPixelsScalar },
+#if defined(PLATFORM_SSE2)
+		{ Platform::CpuIsa::SSE2, fillPixelsSSE2 }
+#endif
+	});
+
+	const KernelDispatch::Kernel<void(const uint32_t*, int, uint32_t*, int, int, int)>
+		CopyPixelsKernel("SurfaceCopy",
+	{
+		{ Platform::CpuIsa::Scalar, copyPixelsScalar },
+#if defined(PLATFORM_SSE2)
+		{ Platform::CpuIsa::SSE2, copyPixelsSSE2 }
+#endif
+	});
+
+	const KernelDispatch::Kernel<void(const uint32_t*, int, uint32_t*, int, int, int)>
+		BlendPixelsKernel("SurfaceBlend",
+	{
+		{ Platform::CpuIsa::Scalar, blendPixelsScalar },
+#if defined(PLATFORM_SSE2)
+		{ Platform::CpuIsa::SSE2, blendPixelsSSE2 }
+#endif
+	});
+
+	const KernelDispatch::Kernel<void(const uint32_t*, int, uint32_t*, int, int, int, uint32_t)>
+		TintPixelsKernel("SurfaceTint",
+	{
+		{ Platform::CpuIsa::Scalar, tintPixelsScalar },
+#if defined(PLATFORM_SSE2)
+		{ Platform::CpuIsa::SSE2, tintPixelsSSE2 }
+#endif
+	});
+}
+
+void SurfaceBlitter::fillPixels(uint32_t *dst, int dstPitch, int width, int height,
+	uint32_t color)
+{
+	FillPixelsKernel.get()(dst, dstPitch, width, height, color);
+}
+
+void SurfaceBlitter::copyPixels(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+	int width, int height)
+{
+	CopyPixelsKernel.get()(src, srcPitch, dst, dstPitch, width, height);
+}
+
+void SurfaceBlitter::blendPixels(const uint32_t *src, int srcPitch, uint32_t *dst,
+	int dstPitch, int width, int height)
+{
+	BlendPixelsKernel.get()(src, srcPitch, dst, dstPitch, width, height);
+}
+
+void SurfaceBlitter::tintPixels(const uint32_t *src, int srcPitch, uint32_t *dst,
+	int dstPitch, int width, int height, uint32_t tint)
+{
+	TintPixelsKernel.get()(src, srcPitch, dst, dstPitch, width, height, tint);
+}
+
+bool SurfaceBlitter::canDraw(const SDL_Surface *surface)
+{
+	SDL_Surface *mutableSurface = const_cast<SDL_Surface*>(surface);
+	return (surface->format->format == SDL_PIXELFORMAT_ARGB8888) &&
+		!SDL_MUSTLOCK(mutableSurface);
+}
+
+bool SurfaceBlitter::fillRect(SDL_Surface *dst, const SDL_Rect *rect, uint32_t color)
+{
+	if (!SurfaceBlitter::canDraw(dst))
+	{
+		return false;
+	}
+
+	SDL_Rect fillRect = dst->clip_rect;
+	if ((rect != nullptr) && !SDL_IntersectRect(rect, &dst->clip_rect, &fillRect))
+	{
+		return true;
+	}
+
+	SurfaceBlitter::fillPixels(getPixels(dst, fillRect.x, fillRect.y), getPitch(dst),
+		fillRect.w, fillRect.h, color);
+	return true;
+}
+
+bool SurfaceBlitter::blit(const SDL_Surface *src, const SDL_Rect *srcRect, SDL_Surface *dst,
+	int dstX, int dstY)
+{
+	if (!SurfaceBlitter::canDraw(src) || !SurfaceBlitter::canDraw(dst))
+	{
+		return false;
+	}
+
+	// Color keys and modulation are left to SDL.
+	SDL_Surface *mutableSrc = const_cast<SDL_Surface*>(src);
+	uint32_t colorKey;
+	uint8_t alphaMod, redMod, greenMod, blueMod;
+	SDL_BlendMode blendMode;
+	SDL_GetSurfaceAlphaMod(mutableSrc, &alphaMod);
+	SDL_GetSurfaceColorMod(mutableSrc, &redMod, &greenMod, &blueMod);
+	SDL_GetSurfaceBlendMode(mutableSrc, &blendMode);
+	if ((SDL_GetColorKey(mutableSrc, &colorKey) == 0) || (alphaMod != 255) ||
+		((redMod & greenMod & blueMod) != 255) ||
+		((blendMode != SDL_BLENDMODE_NONE) && (blendMode != SDL_BLENDMODE_BLEND)))
+	{
+		return false;
+	}
+
+	int srcX, srcY;
+	SDL_Rect dstRect;
+	if (!clipBlit(src, srcRect, dst, dstX, dstY, &srcX, &srcY, &dstRect))
+	{
+		return true;
+	}
+
+	const uint32_t *srcPixels = getPixels(src, srcX, srcY);
+	uint32_t *dstPixels = getPixels(dst, dstRect.x, dstRect.y);
+	if (blendMode == SDL_BLENDMODE_NONE)
+	{
+		SurfaceBlitter::copyPixels(srcPixels, getPitch(src), dstPixels, getPitch(dst),
+			dstRect.w, dstRect.h);
+	}
+	else
+	{
+		SurfaceBlitter::blendPixels(srcPixels, getPitch(src), dstPixels, getPitch(dst),
+			dstRect.w, dstRect.h);
+	}
+
+	return true;
+}
+
+void SurfaceBlitter::blitTinted(const SDL_Surface *src, SDL_Surface *dst, int dstX, int dstY,
+	uint32_t tint)
+{
+	DebugAssert(SurfaceBlitter::canDraw(src));
+	DebugAssert(SurfaceBlitter::canDraw(dst));
+
+	int srcX, srcY;
+	SDL_Rect dstRect;
+	if (!clipBlit(src, nullptr, dst, dstX, dstY, &srcX, &srcY, &dstRect))
+	{
+		return;
+	}
+
+	SurfaceBlitter::tintPixels(getPixels(src, srcX, srcY), getPitch(src),
+		getPixels(dst, dstRect.x, dstRect.y), getPitch(dst), dstRect.w, dstRect.h, tint);
+}
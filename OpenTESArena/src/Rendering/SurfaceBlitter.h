@@ -0,0 +1,50 @@
+#ifndef SURFACE_BLITTER_H
+#define SURFACE_BLITTER_H
+
+#include <cstdint>
+
+// Copies and fills for ARGB8888 surfaces, which is what every UI scratch surface is. Text
+// boxes, tooltips, and panel layers are built from these instead of going through SDL's
+// generic blit machinery, which looks up a conversion for every call.
+
+// Blended copies use the same formula as SDL_BLENDMODE_BLEND. Nearly every UI pixel is
+// either fully transparent or opaque, so those are skipped or copied without any math.
+
+struct SDL_Rect;
+struct SDL_Surface;
+
+class SurfaceBlitter
+{
+public:
+	SurfaceBlitter() = delete;
+	~SurfaceBlitter() = delete;
+
+	// Pixel kernels. Pitches are in pixels, and a source pitch of zero repeats one row.
+	static void fillPixels(uint32_t *dst, int dstPitch, int width, int height, uint32_t color);
+	static void copyPixels(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height);
+	static void blendPixels(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height);
+
+	// Puts the tint wherever the source isn't fully transparent (blending it if it's
+	// translucent), for drawing glyphs in a text color.
+	static void tintPixels(const uint32_t *src, int srcPitch, uint32_t *dst, int dstPitch,
+		int width, int height, uint32_t tint);
+
+	// Whether a surface is one the kernels can read or write directly.
+	static bool canDraw(const SDL_Surface *surface);
+
+	// Surface versions, clipped the same as SDL_FillRect() and SDL_BlitSurface(). They return
+	// false without drawing anything if either surface can't be drawn directly (i.e., it has a
+	// color key or color modulation), so the caller can fall back to SDL. A null source rect
+	// is the whole surface, and a null fill rect is the whole clip rect.
+	static bool fillRect(SDL_Surface *dst, const SDL_Rect *rect, uint32_t color);
+	static bool blit(const SDL_Surface *src, const SDL_Rect *srcRect, SDL_Surface *dst,
+		int dstX, int dstY);
+
+	// Draws a glyph or other mask in the tint color. Both surfaces must be drawable.
+	static void blitTinted(const SDL_Surface *src, SDL_Surface *dst, int dstX, int dstY,
+		uint32_t tint);
+};
+
+#endif
@@ -1,3 +1,5 @@
+#include <atomic>
+
 #include "SDL.h"
 
 #include "Texture.h"
@@ -9,15 +11,23 @@
 #include "../Rendering/Surface.h"
 #include "../Utilities/Debug.h"
 
+namespace
+{
+	std::atomic<uint64_t> NextTextureID(1);
+}
+
 Texture::Texture()
 {
 	this->texture = nullptr;
+	this->id = 0;
 }
 
 Texture::Texture(Texture &&texture)
 {
 	this->texture = texture.texture;
+	this->id = texture.id;
 	texture.texture = nullptr;
+	texture.id = 0;
 }
 
 Texture::~Texture()
@@ -38,9 +48,11 @@ Texture &Texture::operator=(Texture &&texture)
 		}
 
 		this->texture = texture.texture;
+		this->id = texture.id;
 	}
 
 	texture.texture = nullptr;
+	texture.id = 0;
 	return *this;
 }
 
@@ -248,8 +260,14 @@ SDL_Texture *Texture::get() const
 	return this->texture;
 }
 
+uint64_t Texture::getID() const
+{
+	return this->id;
+}
+
 void Texture::init(SDL_Texture *texture)
 {
 	DebugAssert(this->texture == nullptr);
 	this->texture = texture;
+	this->id = NextTextureID.fetch_add(1);
 }
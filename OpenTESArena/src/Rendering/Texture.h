@@ -1,6 +1,8 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <cstdint>
+
 // A thin SDL_Texture wrapper.
 
 class Renderer;
@@ -12,6 +14,7 @@ class Texture
 {
 private:
 	SDL_Texture *texture;
+	uint64_t id; // Never reused, unlike the SDL_Texture pointer once it's freed.
 public:
 	// Generated texture types. These refer to patterns used with pop-ups and buttons.
 	enum class PatternType
@@ -37,6 +40,9 @@ public:
 	int getHeight() const;
 	SDL_Texture *get() const;
 
+	// Gets the texture's unique ID (0 if it has no texture), for caches made from it.
+	uint64_t getID() const;
+
 	// Alternative to constructor to avoid accidentally copying pointers and double-freeing, etc..
 	// Most code shouldn't touch a native texture directly.
 	void init(SDL_Texture *texture);
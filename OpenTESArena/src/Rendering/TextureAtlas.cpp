@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+#include "Renderer.h"
+#include "Surface.h"
+#include "TextureAtlas.h"
+#include "../Utilities/Debug.h"
+
+const int TextureAtlas::PAGE_WIDTH = 512;
+const int TextureAtlas::PAGE_HEIGHT = 512;
+const int TextureAtlas::MAX_IMAGE_WIDTH = 64;
+const int TextureAtlas::MAX_IMAGE_HEIGHT = 64;
+const int TextureAtlas::PADDING = 1;
+
+bool TextureAtlas::tryPlace(Page &page, int width, int height, Rect *outRect)
+{
+	const int paddedWidth = width + (TextureAtlas::PADDING * 2);
+	const int paddedHeight = height + (TextureAtlas::PADDING * 2);
+
+	// Start a new row if the image doesn't fit at the end of the current one.
+	if ((page.shelfX + paddedWidth) > TextureAtlas::PAGE_WIDTH)
+	{
+		page.shelfX = 0;
+		page.shelfY += page.shelfHeight;
+		page.shelfHeight = 0;
+	}
+
+	if ((page.shelfY + paddedHeight) > TextureAtlas::PAGE_HEIGHT)
+	{
+		return false;
+	}
+
+	*outRect = Rect(page.shelfX + TextureAtlas::PADDING, page.shelfY + TextureAtlas::PADDING,
+		width, height);
+	page.shelfX += paddedWidth;
+	page.shelfHeight = std::max(page.shelfHeight, paddedHeight);
+	return true;
+}
+
+void TextureAtlas::addPage(Renderer &renderer)
+{
+	Page page;
+	page.texture = renderer.createTexture(Renderer::DEFAULT_PIXELFORMAT,
+		SDL_TEXTUREACCESS_STATIC, TextureAtlas::PAGE_WIDTH, TextureAtlas::PAGE_HEIGHT);
+	page.shelfX = 0;
+	page.shelfY = 0;
+	page.shelfHeight = 0;
+
+	// Clear to transparent so padding doesn't show up when filtered.
+	const std::vector<uint32_t> clearPixels(
+		TextureAtlas::PAGE_WIDTH * TextureAtlas::PAGE_HEIGHT, 0);
+	SDL_UpdateTexture(page.texture.get(), nullptr, clearPixels.data(),
+		TextureAtlas::PAGE_WIDTH * sizeof(uint32_t));
+
+	// Set alpha transparency on.
+	SDL_SetTextureBlendMode(page.texture.get(), SDL_BLENDMODE_BLEND);
+
+	this->pages.push_back(std::move(page));
+}
+
+bool TextureAtlas::fits(const Surface &surface)
+{
+	return (surface.getWidth() <= TextureAtlas::MAX_IMAGE_WIDTH) &&
+		(surface.getHeight() <= TextureAtlas::MAX_IMAGE_HEIGHT);
+}
+
+TextureAtlas::Region TextureAtlas::add(const Surface &surface, Renderer &renderer)
+{
+	DebugAssertMsg(TextureAtlas::fits(surface), "Image too large for texture atlas (" +
+		std::to_string(surface.getWidth()) + "x" + std::to_string(surface.getHeight()) + ").");
+	DebugAssert(surface.get()->format->format == Renderer::DEFAULT_PIXELFORMAT);
+
+	const int width = surface.getWidth();
+	const int height = surface.getHeight();
+
+	Region region;
+	if (this->pages.empty() ||
+		!TextureAtlas::tryPlace(this->pages.back(), width, height, &region.rect))
+	{
+		this->addPage(renderer);
+		const bool success = TextureAtlas::tryPlace(this->pages.back(), width, height,
+			&region.rect);
+		DebugAssert(success);
+	}
+
+	region.pageIndex = static_cast<int>(this->pages.size()) - 1;
+
+	const SDL_Surface *nativeSurface = surface.get();
+	SDL_UpdateTexture(this->pages.back().texture.get(), &region.rect.getRect(),
+		nativeSurface->pixels, nativeSurface->pitch);
+
+	return region;
+}
+
+const Texture &TextureAtlas::getPage(int index) const
+{
+	DebugAssertIndex(this->pages, index);
+	return this->pages[index].texture;
+}
+
+int TextureAtlas::getPageCount() const
+{
+	return static_cast<int>(this->pages.size());
+}
@@ -0,0 +1,62 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <vector>
+
+#include "Texture.h"
+#include "../Math/Rect.h"
+
+// Packs small images (icons, highlights, etc.) into shared texture pages so UI drawn from
+// several of them binds the same texture instead of switching for every image, which lets
+// SDL batch the copies. Images are placed in rows ("shelves") left to right, and a new
+// page is started when one fills up. Nothing is freed until the atlas is destroyed.
+
+class Renderer;
+class Surface;
+
+class TextureAtlas
+{
+public:
+	// Dimensions of each page.
+	static const int PAGE_WIDTH;
+	static const int PAGE_HEIGHT;
+
+	// Largest image that can be added; bigger ones should be separate textures.
+	static const int MAX_IMAGE_WIDTH;
+	static const int MAX_IMAGE_HEIGHT;
+
+	// Where an added image is.
+	struct Region
+	{
+		int pageIndex;
+		Rect rect; // In page pixels.
+	};
+private:
+	// Empty pixels kept around each image so scaled draws don't bleed into neighbors.
+	static const int PADDING;
+
+	struct Page
+	{
+		Texture texture;
+		int shelfX, shelfY, shelfHeight; // Next free spot in the current row.
+	};
+
+	std::vector<Page> pages;
+
+	// Finds room for an image in the last page, starting a new row if needed. Returns
+	// false if the page is full.
+	static bool tryPlace(Page &page, int width, int height, Rect *outRect);
+
+	void addPage(Renderer &renderer);
+public:
+	// Returns whether the image is small enough to be added.
+	static bool fits(const Surface &surface);
+
+	// Copies a 32-bit surface into a page and returns where it is.
+	Region add(const Surface &surface, Renderer &renderer);
+
+	const Texture &getPage(int index) const;
+	int getPageCount() const;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef BUFFER_VIEW_H
+#define BUFFER_VIEW_H
+
+#include "Debug.h"
+
+// A non-owning view of a contiguous range of elements owned by something else. The owner
+// must outlive the view.
+
+template <typename T>
+class BufferView
+{
+private:
+	T *data;
+	int count;
+public:
+	BufferView()
+	{
+		this->data = nullptr;
+		this->count = 0;
+	}
+
+	BufferView(T *data, int count)
+	{
+		DebugAssert(count >= 0);
+		DebugAssert((data != nullptr) || (count == 0));
+		this->data = data;
+		this->count = count;
+	}
+
+	T *get() const
+	{
+		return this->data;
+	}
+
+	T &get(int index) const
+	{
+		DebugAssert(index >= 0);
+		DebugAssert(index < this->count);
+		return this->data[index];
+	}
+
+	int getCount() const
+	{
+		return this->count;
+	}
+
+	// For range-based for loops and standard algorithms.
+	T *begin() const
+	{
+		return this->data;
+	}
+
+	T *end() const
+	{
+		return this->data + this->count;
+	}
+};
+
+#endif
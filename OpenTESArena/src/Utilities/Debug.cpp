@@ -1,12 +1,20 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "SDL_messagebox.h"
 
 #include "Debug.h"
-#include "String.h"
 
 namespace
 {
@@ -16,58 +24,348 @@ namespace
 		{ Debug::MessageType::Warning, "Warning: " },
 		{ Debug::MessageType::Error, "Error: " },
 	};
-}
 
-const std::string Debug::LOG_FILENAME = "log.txt";
+	// Must be a power of two.
+	constexpr size_t LogQueueCapacity = 4096;
 
-std::string Debug::getShorterPath(const char *__file__)
-{
-	// Replace back-slashes with forward slashes, then split.
-	const std::string path = String::replace(std::string(__file__), '\\', '/');
-	const std::vector<std::string> tokens = String::split(path, '/');
+	// Rate limits are kept per call site in a small hash table. Call sites that land in the
+	// same entry share a limit, which is fine for a safeguard against floods.
+	constexpr size_t RateLimitEntryCount = 256;
+
+	// How often the flush thread writes queued messages.
+	constexpr std::chrono::milliseconds FlushInterval(10);
 
-	std::string shortPath;
+	// Constant-initialized, so usable before and after the queue exists.
+	std::atomic<int> MinimumMessageType(static_cast<int>(Debug::MessageType::Status));
+	std::atomic<int> RateLimit(20); // Until the options are read.
+	std::atomic<bool> LogQueueMade(false);
+	std::atomic<bool> LogQueueAlive(false);
 
-	if (tokens.size() >= 2)
+	void appendMessage(std::string &str, Debug::MessageType type, const std::string &filePath,
+		int lineNumber, const std::string &message)
 	{
-		shortPath = tokens.at(tokens.size() - 2) + '/' + tokens.back();
+		str += "[" + filePath + "(" + std::to_string(lineNumber) + ")] " +
+			DebugMessageTypeNames.at(type) + message + "\n";
 	}
-	else if (tokens.size() == 1)
+
+	struct RateLimitEntry
+	{
+		// Second the count is for in the upper half, message count in the lower half.
+		std::atomic<uint64_t> secondAndCount;
+		std::atomic<uint32_t> droppedCount;
+
+		RateLimitEntry() : secondAndCount(0), droppedCount(0) { }
+	};
+
+	struct LogSlot
+	{
+		// Equal to the slot's push position when free and one past it when written.
+		std::atomic<size_t> sequence;
+		Debug::MessageType type;
+		const char *file;
+		int lineNumber;
+		uint32_t droppedCount; // Messages from the same call site dropped before this one.
+		std::string message;
+	};
+
+	// Bounded multi-producer queue (each slot has a sequence number that tells producers and
+	// the consumer whose turn it is), so pushing is a compare-and-swap and a string copy.
+	class LogQueue
+	{
+	private:
+		std::array<LogSlot, LogQueueCapacity> slots;
+		std::array<RateLimitEntry, RateLimitEntryCount> rateLimits;
+		alignas(64) std::atomic<size_t> pushPosition;
+		alignas(64) std::atomic<uint32_t> fullDroppedCount;
+		size_t popPosition;
+		std::mutex popMutex; // Only between the flush thread and explicit flushes.
+		std::mutex stopMutex;
+		std::condition_variable stopCondVar;
+		bool stop;
+		std::thread thread;
+
+		std::chrono::steady_clock::time_point startTime;
+
+		// Returns whether a message from the given call site is under the rate limit, and
+		// if so, how many from it were dropped since the last one that wasn't.
+		bool tryCount(const char *file, int lineNumber, uint32_t *outDroppedCount)
+		{
+			const int limit = RateLimit.load(std::memory_order_relaxed);
+			if (limit <= 0)
+			{
+				*outDroppedCount = 0;
+				return true;
+			}
+
+			const size_t hash = std::hash<const void*>()(file) ^
+				(static_cast<size_t>(lineNumber) * 2654435761u);
+			RateLimitEntry &entry = this->rateLimits[hash % this->rateLimits.size()];
+			const uint64_t second = static_cast<uint64_t>(std::chrono::duration_cast<
+				std::chrono::seconds>(std::chrono::steady_clock::now() - this->startTime).count());
+
+			uint64_t oldValue = entry.secondAndCount.load(std::memory_order_relaxed);
+			while (true)
+			{
+				uint64_t newValue;
+				if ((oldValue >> 32) != second)
+				{
+					newValue = (second << 32) | 1;
+				}
+				else if ((oldValue & 0xFFFFFFFF) >= static_cast<uint64_t>(limit))
+				{
+					entry.droppedCount.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else
+				{
+					newValue = oldValue + 1;
+				}
+
+				if (entry.secondAndCount.compare_exchange_weak(oldValue, newValue,
+					std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+
+			*outDroppedCount = entry.droppedCount.exchange(0, std::memory_order_relaxed);
+			return true;
+		}
+
+		// Writes the queued messages. The pop mutex must be held.
+		void drain()
+		{
+			std::string str;
+			const uint32_t fullDropped = this->fullDroppedCount.exchange(0,
+				std::memory_order_relaxed);
+			if (fullDropped > 0)
+			{
+				appendMessage(str, Debug::MessageType::Warning, Debug::getShorterPath(__FILE__),
+					__LINE__, "Dropped " + std::to_string(fullDropped) +
+					" message(s) while the log queue was full.");
+			}
+
+			while (true)
+			{
+				LogSlot &slot = this->slots[this->popPosition & (LogQueueCapacity - 1)];
+				if (slot.sequence.load(std::memory_order_acquire) != (this->popPosition + 1))
+				{
+					break;
+				}
+
+				std::string message = slot.message;
+				if (slot.droppedCount > 0)
+				{
+					message += " (" + std::to_string(slot.droppedCount) +
+						" more dropped by the rate limit)";
+				}
+
+				appendMessage(str, slot.type, Debug::getShorterPath(slot.file),
+					slot.lineNumber, message);
+
+				// Keep the string's capacity for the next producer of this slot.
+				slot.message.clear();
+				slot.sequence.store(this->popPosition + LogQueueCapacity,
+					std::memory_order_release);
+				this->popPosition++;
+			}
+
+			if (!str.empty())
+			{
+				std::cerr << str;
+			}
+		}
+
+		void run()
+		{
+			std::unique_lock<std::mutex> stopLock(this->stopMutex);
+			while (!this->stop)
+			{
+				this->stopCondVar.wait_for(stopLock, FlushInterval);
+				this->flush();
+			}
+		}
+	public:
+		LogQueue()
+		{
+			for (size_t i = 0; i < this->slots.size(); i++)
+			{
+				this->slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+
+			this->pushPosition.store(0, std::memory_order_relaxed);
+			this->fullDroppedCount.store(0, std::memory_order_relaxed);
+			this->popPosition = 0;
+			this->stop = false;
+			this->startTime = std::chrono::steady_clock::now();
+			this->thread = std::thread([this]() { this->run(); });
+			LogQueueMade.store(true, std::memory_order_release);
+			LogQueueAlive.store(true, std::memory_order_release);
+		}
+
+		~LogQueue()
+		{
+			LogQueueAlive.store(false, std::memory_order_release);
+
+			{
+				std::lock_guard<std::mutex> stopLock(this->stopMutex);
+				this->stop = true;
+			}
+
+			this->stopCondVar.notify_one();
+			this->thread.join();
+			this->flush();
+		}
+
+		// Returns false if the message was dropped.
+		bool tryPush(Debug::MessageType type, const char *file, int lineNumber,
+			const std::string &message)
+		{
+			uint32_t droppedCount = 0;
+			if ((type != Debug::MessageType::Error) &&
+				!this->tryCount(file, lineNumber, &droppedCount))
+			{
+				return false;
+			}
+
+			size_t position = this->pushPosition.load(std::memory_order_relaxed);
+			LogSlot *slot;
+			while (true)
+			{
+				slot = &this->slots[position & (LogQueueCapacity - 1)];
+				const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+				const intptr_t diff = static_cast<intptr_t>(sequence) -
+					static_cast<intptr_t>(position);
+				if (diff == 0)
+				{
+					if (this->pushPosition.compare_exchange_weak(position, position + 1,
+						std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					// Full. The flush thread is behind, so drop it rather than wait.
+					this->fullDroppedCount.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else
+				{
+					position = this->pushPosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			slot->type = type;
+			slot->file = file;
+			slot->lineNumber = lineNumber;
+			slot->droppedCount = droppedCount;
+			slot->message = message;
+			slot->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		void flush()
+		{
+			std::lock_guard<std::mutex> popLock(this->popMutex);
+			this->drain();
+		}
+	};
+
+	LogQueue &getLogQueue()
 	{
-		shortPath = tokens.front();
+		static LogQueue logQueue;
+		return logQueue;
 	}
+}
 
+const std::string Debug::LOG_FILENAME = "log.txt";
+
+std::string Debug::getShorterPath(const char *__file__)
+{
+	// Keep everything after the second-to-last slash of either kind.
+	const std::string_view path(__file__);
+	const size_t lastSlash = path.find_last_of("/\\");
+	const size_t parentSlash = ((lastSlash != std::string_view::npos) && (lastSlash > 0)) ?
+		path.find_last_of("/\\", lastSlash - 1) : std::string_view::npos;
+	const size_t start = (parentSlash != std::string_view::npos) ? (parentSlash + 1) : 0;
+
+	std::string shortPath(path.substr(start));
+	std::replace(shortPath.begin(), shortPath.end(), '\\', '/');
 	return shortPath;
 }
 
+bool Debug::isEnabled(Debug::MessageType type)
+{
+	return static_cast<int>(type) >= MinimumMessageType.load(std::memory_order_relaxed);
+}
+
+void Debug::setMinimumType(Debug::MessageType type)
+{
+	const int value = std::min(static_cast<int>(type), static_cast<int>(MessageType::Error));
+	MinimumMessageType.store(value, std::memory_order_relaxed);
+}
+
+void Debug::setRateLimit(int messagesPerSecond)
+{
+	RateLimit.store(messagesPerSecond, std::memory_order_relaxed);
+}
+
+void Debug::flush()
+{
+	if (LogQueueAlive.load(std::memory_order_acquire))
+	{
+		getLogQueue().flush();
+	}
+}
+
 void Debug::write(Debug::MessageType type, const std::string &filePath,
 	int lineNumber, const std::string &message)
 {
-	const std::string &messageType = DebugMessageTypeNames.at(type);
-	std::cerr << "[" << filePath << "(" << std::to_string(lineNumber) << ")] " <<
-		messageType << message << "\n";
+	std::string str;
+	appendMessage(str, type, filePath, lineNumber, message);
+	std::cerr << str;
+}
+
+void Debug::push(Debug::MessageType type, const char *__file__, int lineNumber,
+	const std::string &message)
+{
+	if (!Debug::isEnabled(type))
+	{
+		return;
+	}
+
+	// The queue is made by the first message. Messages from static destructors that run
+	// after it's gone are written right away instead.
+	if (LogQueueAlive.load(std::memory_order_acquire) ||
+		!LogQueueMade.load(std::memory_order_acquire))
+	{
+		getLogQueue().tryPush(type, __file__, lineNumber, message);
+	}
+	else
+	{
+		Debug::write(type, Debug::getShorterPath(__file__), lineNumber, message);
+	}
 }
 
 void Debug::log(const char *__file__, int lineNumber, const std::string &message)
 {
-	Debug::write(Debug::MessageType::Status, Debug::getShorterPath(__file__),
-		lineNumber, message);
+	Debug::push(Debug::MessageType::Status, __file__, lineNumber, message);
 }
 
 void Debug::logWarning(const char *__file__, int lineNumber, const std::string &message)
 {
-	Debug::write(Debug::MessageType::Warning, Debug::getShorterPath(__file__),
-		lineNumber, message);
+	Debug::push(Debug::MessageType::Warning, __file__, lineNumber, message);
 }
 
 void Debug::logError(const char *__file__, int lineNumber, const std::string &message)
 {
-	Debug::write(Debug::MessageType::Error, Debug::getShorterPath(__file__),
-		lineNumber, message);
+	Debug::push(Debug::MessageType::Error, __file__, lineNumber, message);
 }
 
 void Debug::crash(const char *__file__, int lineNumber, const std::string &message)
 {
+	Debug::flush();
 	Debug::write(Debug::MessageType::Error, Debug::getShorterPath(__file__),
 		lineNumber, message);
 
@@ -8,6 +8,11 @@
 // Below are various debug methods and macros for replacing asserts or program exits 
 // that might be accompanied with messages and logging.
 
+// Messages are put in a fixed-size queue and written to the console by a background thread,
+// so logging from a hot path never waits on the console. Each call site can only log so
+// many messages per second, and messages below the minimum level are skipped before they're
+// even made. Crashes write everything still queued before their own message.
+
 class Debug
 {
 public:
@@ -26,7 +31,25 @@ private:
 	// Writes a debug message to the console with the file path and line number.
 	static void write(Debug::MessageType type, const std::string &filePath,
 		int lineNumber, const std::string &message);
+
+	// Queues a debug message for the flush thread, or writes it right away if logging has
+	// shut down. Drops it if its call site is over the rate limit or the queue is full.
+	static void push(Debug::MessageType type, const char *__file__, int lineNumber,
+		const std::string &message);
 public:
+	// Whether messages of the given type are logged at all.
+	static bool isEnabled(Debug::MessageType type);
+
+	// Sets the lowest message type that gets logged. Errors are always logged.
+	static void setMinimumType(Debug::MessageType type);
+
+	// Sets how many messages per second each call site may log before the rest are dropped
+	// (and counted). Errors aren't limited. 0 means no limit.
+	static void setRateLimit(int messagesPerSecond);
+
+	// Writes all queued messages on the calling thread.
+	static void flush();
+
 	// Shortens the __FILE__ macro so it only includes a couple parent folders.
 	static std::string getShorterPath(const char *__file__);
 
@@ -43,8 +66,10 @@ public:
 	static void crash(const char *__file__, int lineNumber, const std::string &message);
 
 	// General logging defines.
-#define DebugLog(message) Debug::log(__FILE__, __LINE__, message)
-#define DebugLogWarning(message) Debug::logWarning(__FILE__, __LINE__, message)
+#define DebugLog(message) \
+	do { if (Debug::isEnabled(Debug::MessageType::Status)) Debug::log(__FILE__, __LINE__, message); } while (false)
+#define DebugLogWarning(message) \
+	do { if (Debug::isEnabled(Debug::MessageType::Warning)) Debug::logWarning(__FILE__, __LINE__, message); } while (false)
 #define DebugLogError(message) Debug::logError(__FILE__, __LINE__, message)
 
 	// Crash define, when the program simply cannot continue.
@@ -80,6 +105,18 @@ public:
 	do { if (!DebugValidIndex(container, index)) DebugCrash("Index '" + std::to_string(index) + "' out of bounds."); } while (false)
 #define DebugMakeIndex(container, index) \
 	([&]() { const auto val = index; DebugAssertIndex(container, val); return val; }())
+
+	// Checks for unchecked accessors in hot paths. They compile to nothing unless the build
+	// has TES_VALIDATE (on by default in debug builds), so release builds don't pay for them.
+#if defined(TES_VALIDATE)
+#define DebugValidateMsg(condition, message) DebugAssertMsg(condition, message)
+#define DebugValidate(condition) DebugAssert(condition)
+#define DebugValidateIndex(container, index) DebugAssertIndex(container, index)
+#else
+#define DebugValidateMsg(condition, message) do { } while (false)
+#define DebugValidate(condition) do { } while (false)
+#define DebugValidateIndex(container, index) do { } while (false)
+#endif
 };
 
 #endif
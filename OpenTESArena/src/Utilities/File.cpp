@@ -2,6 +2,18 @@
 #include <fstream>
 #include <vector>
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "Debug.h"
 #include "File.h"
 #include "Platform.h"
@@ -28,6 +40,25 @@ bool File::exists(const std::string &filename)
 	return isOpen;
 }
 
+int64_t File::getModifiedTime(const std::string &filename)
+{
+#if defined(_WIN32)
+	struct _stat64 st;
+	if (_stat64(filename.c_str(), &st) != 0)
+	{
+		return 0;
+	}
+#else
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0)
+	{
+		return 0;
+	}
+#endif
+
+	return static_cast<int64_t>(st.st_mtime);
+}
+
 bool File::pathIsRelative(const std::string &filename)
 {
 	DebugAssertMsg(filename.size() > 0, "Path cannot be empty.");
@@ -63,3 +94,42 @@ void File::copy(const std::string &srcFilename, const std::string &dstFilename)
 	// Copy the source file to the destination.
 	ofs << ifs.rdbuf();
 }
+
+bool File::replaceWithTemporary(const std::string &tempFilename, const std::string &filename)
+{
+	// The data has to be on disk before the rename, or a crash could leave the new name
+	// pointing at an empty or partial file.
+#if defined(_WIN32)
+	const int fd = _open(tempFilename.c_str(), _O_RDWR | _O_BINARY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	const bool synced = _commit(fd) == 0;
+	_close(fd);
+	if (!synced)
+	{
+		return false;
+	}
+
+	return MoveFileExA(tempFilename.c_str(), filename.c_str(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	const int fd = open(tempFilename.c_str(), O_RDWR);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	const bool synced = fsync(fd) == 0;
+	close(fd);
+	if (!synced)
+	{
+		return false;
+	}
+
+	// Renaming over an existing file is atomic on POSIX systems.
+	return rename(tempFilename.c_str(), filename.c_str()) == 0;
+#endif
+}
@@ -1,6 +1,7 @@
 #ifndef FILE_H
 #define FILE_H
 
+#include <cstdint>
 #include <string>
 
 class File
@@ -15,11 +16,21 @@ public:
 	// Checks that a file exists.
 	static bool exists(const std::string &filename);
 
+	// Gets the last time a file was modified in seconds since the epoch, or 0 if it doesn't
+	// exist. Cheaper than opening it for finding out whether it changed.
+	static int64_t getModifiedTime(const std::string &filename);
+
 	// Checks if the path to a file is relative or absolute.
 	static bool pathIsRelative(const std::string &filename);
 
 	// Copies a file to a destination file.
 	static void copy(const std::string &srcFilename, const std::string &dstFilename);
+
+	// Flushes a finished temporary file to disk and moves it over the destination file in
+	// one step, so the destination is always either the old file or the whole new one, even
+	// after a crash. Returns false (leaving the destination alone) if either step fails.
+	static bool replaceWithTemporary(const std::string &tempFilename,
+		const std::string &filename);
 };
 
 #endif
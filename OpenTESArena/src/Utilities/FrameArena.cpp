@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "Debug.h"
+#include "FrameArena.h"
+
+const size_t FrameArena::DEFAULT_CAPACITY = 64 * 1024;
+
+FrameArena::FrameArena()
+{
+	this->block = std::make_unique<uint8_t[]>(FrameArena::DEFAULT_CAPACITY);
+	this->capacity = FrameArena::DEFAULT_CAPACITY;
+	this->offset = 0;
+	this->overflowBytes = 0;
+	this->peakBytes = 0;
+	this->overflowCount = 0;
+	this->lastOverflowCount = 0;
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+	const uintptr_t base = reinterpret_cast<uintptr_t>(this->block.get());
+	const uintptr_t start = (base + this->offset + (alignment - 1)) & ~(alignment - 1);
+	const size_t end = static_cast<size_t>(start - base) + bytes;
+	if (end > this->capacity)
+	{
+		// The allocation is freed with the given alignment in do_deallocate(), which can
+		// tell it's from the heap because it's outside the block.
+		this->overflowBytes += bytes + alignment;
+		this->overflowCount++;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	this->offset = end;
+	return reinterpret_cast<void*>(start);
+}
+
+void FrameArena::do_deallocate(void *ptr, size_t bytes, size_t alignment)
+{
+	const uint8_t *bytePtr = static_cast<const uint8_t*>(ptr);
+	const bool inBlock = (bytePtr >= this->block.get()) &&
+		(bytePtr < (this->block.get() + this->capacity));
+	if (!inBlock)
+	{
+		std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+	}
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+	return this == &other;
+}
+
+size_t FrameArena::getCapacity() const
+{
+	return this->capacity;
+}
+
+size_t FrameArena::getPeakBytes() const
+{
+	return this->peakBytes;
+}
+
+size_t FrameArena::getLastOverflowCount() const
+{
+	return this->lastOverflowCount;
+}
+
+void FrameArena::reset()
+{
+	const size_t frameBytes = this->offset + this->overflowBytes;
+	this->peakBytes = std::max(this->peakBytes, frameBytes);
+
+	// Grow to fit the last frame with some room to spare. Nothing may still be using the
+	// old block.
+	if (frameBytes > this->capacity)
+	{
+		const size_t newCapacity = frameBytes + (frameBytes / 2);
+		DebugLog("Growing frame arena from " + std::to_string(this->capacity) + " to " +
+			std::to_string(newCapacity) + " bytes.");
+		this->block = std::make_unique<uint8_t[]>(newCapacity);
+		this->capacity = newCapacity;
+	}
+
+	this->offset = 0;
+	this->overflowBytes = 0;
+	this->lastOverflowCount = this->overflowCount;
+	this->overflowCount = 0;
+}
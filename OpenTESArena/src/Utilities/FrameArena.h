@@ -0,0 +1,52 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+// Memory for data that only lives until the end of the frame, like strings made for the
+// debug text. Allocating bumps a pointer and deallocating does nothing; it's all given back
+// at once when the next frame starts. std::pmr containers can use it directly.
+
+// Allocations that don't fit go to the heap and are counted. At the next reset, the block
+// grows to fit what the last frame needed, so after the first few frames nothing reaches
+// the heap.
+
+class FrameArena : public std::pmr::memory_resource
+{
+private:
+	static const size_t DEFAULT_CAPACITY;
+
+	std::unique_ptr<uint8_t[]> block;
+	size_t capacity, offset;
+	size_t overflowBytes; // Bytes this frame that went to the heap, with alignment.
+	size_t peakBytes; // Most bytes used by one frame since startup.
+	size_t overflowCount; // Allocations this frame that went to the heap.
+	size_t lastOverflowCount; // Overflow count of the last finished frame.
+
+	void *do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void *ptr, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+public:
+	FrameArena();
+	FrameArena(const FrameArena&) = delete;
+
+	FrameArena &operator=(const FrameArena&) = delete;
+
+	// Bytes in the block, used or not.
+	size_t getCapacity() const;
+
+	// Most bytes used by one frame since startup.
+	size_t getPeakBytes() const;
+
+	// How many allocations in the last finished frame didn't fit in the block.
+	size_t getLastOverflowCount() const;
+
+	// Frees everything allocated since the last reset. Nothing from the arena may be used
+	// after this. Called once at the start of each frame.
+	void reset();
+};
+
+#endif
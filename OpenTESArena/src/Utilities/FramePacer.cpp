@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+#include "FramePacer.h"
+#include "Profiler.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#endif
+
+#if defined(_WIN32) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+// Windows 10 1803 and later. Older SDKs don't define it.
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+FramePacer::FramePacer()
+{
+	this->lateTimes.fill(0.0);
+	this->lateTimeIndex = 0;
+
+	// The default spin time covers high-resolution timers, which wake within a few hundred
+	// microseconds.
+	this->spinTime = std::chrono::microseconds(500);
+
+#if defined(_WIN32)
+	this->timerHandle = CreateWaitableTimerExW(nullptr, nullptr,
+		CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (this->timerHandle == nullptr)
+	{
+		// Older versions only have timers with the system tick's resolution.
+		this->timerHandle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+		this->spinTime = std::chrono::milliseconds(2);
+	}
+#endif
+}
+
+FramePacer::~FramePacer()
+{
+#if defined(_WIN32)
+	if (this->timerHandle != nullptr)
+	{
+		CloseHandle(this->timerHandle);
+	}
+#endif
+}
+
+void FramePacer::sleep(std::chrono::nanoseconds duration)
+{
+#if defined(_WIN32)
+	if (this->timerHandle != nullptr)
+	{
+		// Negative due times are relative, in 100 nanosecond units.
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -static_cast<LONGLONG>(duration.count() / 100);
+		if (SetWaitableTimer(this->timerHandle, &dueTime, 0, nullptr, nullptr, FALSE))
+		{
+			WaitForSingleObject(this->timerHandle, INFINITE);
+			return;
+		}
+	}
+
+	std::this_thread::sleep_for(duration);
+#elif defined(__linux__)
+	// Absolute deadline on the monotonic clock, so being interrupted doesn't add time.
+	timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	const long nanosecondsPerSecond = 1000000000;
+	const auto durationCount = duration.count();
+	deadline.tv_sec += static_cast<time_t>(durationCount / nanosecondsPerSecond);
+	deadline.tv_nsec += static_cast<long>(durationCount % nanosecondsPerSecond);
+	if (deadline.tv_nsec >= nanosecondsPerSecond)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= nanosecondsPerSecond;
+	}
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) { }
+#else
+	std::this_thread::sleep_for(duration);
+#endif
+}
+
+void FramePacer::waitUntil(Clock::time_point deadline)
+{
+	ProfilerZone("Frame pacing");
+
+	const auto sleepDuration = deadline - Clock::now() - this->spinTime;
+	if (sleepDuration > std::chrono::nanoseconds(0))
+	{
+		this->sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(sleepDuration));
+	}
+
+	// Spin for the rest. Sub-millisecond sleeps aren't reliable anywhere.
+	Clock::time_point now = Clock::now();
+	while (now < deadline)
+	{
+		now = Clock::now();
+	}
+
+	const std::chrono::duration<double> lateTime = now - deadline;
+	this->lateTimes[this->lateTimeIndex] = lateTime.count();
+	this->lateTimeIndex = (this->lateTimeIndex + 1) % static_cast<int>(this->lateTimes.size());
+}
+
+double FramePacer::getAverageLateTime() const
+{
+	const double total = std::accumulate(this->lateTimes.begin(), this->lateTimes.end(), 0.0);
+	return total / static_cast<double>(this->lateTimes.size());
+}
+
+double FramePacer::getMaxLateTime() const
+{
+	return *std::max_element(this->lateTimes.begin(), this->lateTimes.end());
+}
@@ -0,0 +1,42 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <array>
+#include <chrono>
+
+// Waits until a point in time more precisely than std::this_thread::sleep_for(), which can
+// overshoot by a millisecond or two. Most of the wait is slept on the platform's
+// high-resolution timer and the last fraction of a millisecond is spun.
+
+class FramePacer
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+private:
+	// How late recent waits returned, in seconds.
+	std::array<double, 60> lateTimes;
+	int lateTimeIndex;
+	std::chrono::nanoseconds spinTime; // Left to spin after sleeping.
+#if defined(_WIN32)
+	void *timerHandle;
+#endif
+
+	// Sleeps for roughly the given time, never much longer.
+	void sleep(std::chrono::nanoseconds duration);
+public:
+	FramePacer();
+	FramePacer(const FramePacer&) = delete;
+	~FramePacer();
+
+	FramePacer &operator=(const FramePacer&) = delete;
+
+	// Returns once the given time point has been reached.
+	void waitUntil(Clock::time_point deadline);
+
+	// Gets the average and worst time in seconds that recent waits returned after their
+	// deadline, for checking frame pacing.
+	double getAverageLateTime() const;
+	double getMaxLateTime() const;
+};
+
+#endif
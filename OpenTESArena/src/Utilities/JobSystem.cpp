@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Debug.h"
+#include "JobSystem.h"
+#include "Platform.h"
+
+namespace
+{
+	struct JobState;
+	void stopWorkers(JobState &state);
+
+	struct JobState
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::array<std::deque<std::function<void()>>, 2> queues; // One per priority.
+		std::vector<std::thread> threads;
+		int reservedCount; // Threads busy outside the pool.
+		bool started, stopped;
+
+		JobState()
+		{
+			this->reservedCount = 0;
+			this->started = false;
+			this->stopped = false;
+		}
+
+		~JobState()
+		{
+			stopWorkers(*this);
+		}
+	};
+
+	JobState &getJobState()
+	{
+		static JobState state;
+		return state;
+	}
+
+	// Gets how many workers may take jobs. The mutex must be locked.
+	int getActiveWorkerCount(const JobState &state)
+	{
+		return std::max(static_cast<int>(state.threads.size()) - state.reservedCount, 1);
+	}
+
+	void workerLoop(JobState &state, int workerIndex)
+	{
+		while (true)
+		{
+			std::function<void()> job;
+
+			{
+				// Workers held back for reserved threads still help finish the queues when
+				// stopping.
+				std::unique_lock<std::mutex> lock(state.mutex);
+				state.condition.wait(lock, [&state, workerIndex]()
+				{
+					const bool canTakeJobs = state.stopped ||
+						(workerIndex < getActiveWorkerCount(state));
+					return state.stopped || (canTakeJobs && std::any_of(state.queues.begin(),
+						state.queues.end(), [](const auto &queue) { return !queue.empty(); }));
+				});
+
+				// Higher priority queues come first.
+				auto queueIter = std::find_if(state.queues.begin(), state.queues.end(),
+					[](const auto &queue) { return !queue.empty(); });
+
+				// Stopping only happens once the queues are empty.
+				if (queueIter == state.queues.end())
+				{
+					return;
+				}
+
+				job = std::move(queueIter->front());
+				queueIter->pop_front();
+			}
+
+			job();
+		}
+	}
+
+	// Starts the worker threads if they haven't been. The mutex must be locked.
+	void startWorkers(JobState &state)
+	{
+		if (state.started)
+		{
+			return;
+		}
+
+		// Leave a thread for the main thread, which is usually busy when jobs are queued.
+		const int threadCount = std::max(Platform::getThreadCount() - 1, 1);
+		state.threads.reserve(threadCount);
+		for (int i = 0; i < threadCount; i++)
+		{
+			state.threads.push_back(std::thread(workerLoop, std::ref(state), i));
+		}
+
+		state.started = true;
+		DebugLog("Started " + std::to_string(threadCount) + " job thread(s).");
+	}
+
+	// Lets the workers finish what's queued, then joins them.
+	void stopWorkers(JobState &state)
+	{
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			if (state.stopped)
+			{
+				return;
+			}
+
+			state.stopped = true;
+		}
+
+		state.condition.notify_all();
+		for (std::thread &thread : state.threads)
+		{
+			thread.join();
+		}
+
+		state.threads.clear();
+	}
+}
+
+void JobSystem::push(Priority priority, std::function<void()> &&job)
+{
+	JobState &state = getJobState();
+
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (!state.stopped)
+		{
+			startWorkers(state);
+			state.queues[static_cast<int>(priority)].push_back(std::move(job));
+
+			// A held back worker might be the one woken, so all of them are.
+			if (state.reservedCount > 0)
+			{
+				state.condition.notify_all();
+			}
+			else
+			{
+				state.condition.notify_one();
+			}
+
+			return;
+		}
+	}
+
+	job();
+}
+
+int JobSystem::getThreadCount()
+{
+	JobState &state = getJobState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if (!state.stopped)
+	{
+		startWorkers(state);
+	}
+
+	return static_cast<int>(state.threads.size());
+}
+
+void JobSystem::setReservedThreadCount(int count)
+{
+	DebugAssert(count >= 0);
+
+	JobState &state = getJobState();
+
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		state.reservedCount = count;
+	}
+
+	// Workers that can take jobs again need to see the queues.
+	state.condition.notify_all();
+}
+
+void JobSystem::shutdown()
+{
+	stopWorkers(getJobState());
+}
@@ -0,0 +1,59 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+
+// Shared pool of worker threads for loading and other work that shouldn't hold up the main
+// thread, so every subsystem isn't starting threads of its own. Sized from the CPU's thread
+// count and started on first use.
+
+// Jobs are taken by priority and then in the order they were submitted. A job must not wait
+// on another job's future since that could leave every worker waiting. The render threads,
+// the audio stream, and video decoding keep their own threads because they're synchronized
+// every frame or every buffer and can't sit behind a long load. The render threads are busy
+// whenever a frame is drawn, so workers are held back for them (see setReservedThreadCount()).
+
+class JobSystem
+{
+public:
+	enum class Priority
+	{
+		Streaming, // Something the player is about to need (entering a level, its textures).
+		Background // Prefetching and anything else that can wait.
+	};
+private:
+	JobSystem() = delete;
+	~JobSystem() = delete;
+
+	// Queues a job for the workers, or runs it on the calling thread if they're shut down.
+	static void push(Priority priority, std::function<void()> &&job);
+public:
+	// Gets how many worker threads the pool has, starting them if needed.
+	static int getThreadCount();
+
+	// Sets how many of the CPU's threads are kept busy outside the pool (i.e., by rendering).
+	// That many workers stop taking jobs, so the pool and those threads don't oversubscribe
+	// the CPU. At least one worker always takes jobs.
+	static void setReservedThreadCount(int count);
+
+	// Queues a function to run on a worker thread. The future works like one from std::async
+	// except that destroying it doesn't wait for the function.
+	template <typename F>
+	static auto submit(Priority priority, F &&function) -> std::future<decltype(function())>
+	{
+		using Result = decltype(function());
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+		std::future<Result> future = task->get_future();
+		JobSystem::push(priority, [task]() { (*task)(); });
+		return future;
+	}
+
+	// Finishes every queued job and stops the worker threads. Jobs submitted afterwards run
+	// on the calling thread. Called before the data that jobs point to is freed.
+	static void shutdown();
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "KernelDispatch.h"
+
+// Constant-initialized, so kernels registered before main() can read it.
+std::optional<Platform::CpuIsa> KernelDispatch::maxIsa;
+
+KernelDispatch::KernelBase::KernelBase(const char *name)
+{
+	this->name = name;
+	this->selectedIsa = Platform::CpuIsa::Scalar;
+}
+
+const char *KernelDispatch::KernelBase::getName() const
+{
+	return this->name;
+}
+
+Platform::CpuIsa KernelDispatch::KernelBase::getSelectedIsa() const
+{
+	return this->selectedIsa;
+}
+
+std::vector<KernelDispatch::KernelBase*> &KernelDispatch::getKernels()
+{
+	static std::vector<KernelBase*> kernels;
+	return kernels;
+}
+
+std::string &KernelDispatch::getMutableSelectionsText()
+{
+	static std::string text;
+	return text;
+}
+
+void KernelDispatch::addKernel(KernelBase *kernel)
+{
+	KernelDispatch::getKernels().push_back(kernel);
+	KernelDispatch::updateSelectionsText();
+}
+
+void KernelDispatch::updateSelectionsText()
+{
+	std::string &text = KernelDispatch::getMutableSelectionsText();
+	text.clear();
+	for (const KernelBase *kernel : KernelDispatch::getKernels())
+	{
+		text += (text.empty() ? "" : ", ") + std::string(kernel->getName()) + ": " +
+			Platform::getCpuIsaName(kernel->getSelectedIsa());
+	}
+}
+
+bool KernelDispatch::isAllowed(Platform::CpuIsa isa,
+	const std::optional<Platform::CpuIsa> &maxIsa)
+{
+	if (!Platform::isCpuIsaSupported(isa))
+	{
+		return false;
+	}
+	else if (!maxIsa.has_value() || (isa == Platform::CpuIsa::Scalar))
+	{
+		return true;
+	}
+
+	// x86 instruction sets imply the ones before them. NEON is on its own.
+	if ((isa == Platform::CpuIsa::NEON) || (*maxIsa == Platform::CpuIsa::NEON))
+	{
+		return isa == *maxIsa;
+	}
+
+	return static_cast<int>(isa) <= static_cast<int>(*maxIsa);
+}
+
+const std::optional<Platform::CpuIsa> &KernelDispatch::getMaxIsa()
+{
+	return KernelDispatch::maxIsa;
+}
+
+void KernelDispatch::setMaxIsa(const std::optional<Platform::CpuIsa> &isa)
+{
+	KernelDispatch::maxIsa = isa;
+	for (KernelBase *kernel : KernelDispatch::getKernels())
+	{
+		kernel->select(isa);
+	}
+
+	KernelDispatch::updateSelectionsText();
+}
+
+const std::string &KernelDispatch::getSelectionsText()
+{
+	return KernelDispatch::getMutableSelectionsText();
+}
@@ -0,0 +1,113 @@
+#ifndef KERNEL_DISPATCH_H
+#define KERNEL_DISPATCH_H
+
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Debug.h"
+#include "Platform.h"
+
+// Picks one version of a hot function for the CPU the game is running on, so a single build
+// can use newer instruction sets where they're there. Each kernel lists its versions by the
+// instruction set they need, and the most capable one allowed is selected once at startup.
+
+// Versions for instruction sets beyond the build's own have to be compiled for them (i.e.,
+// with a target attribute or in a file with its own flags). A scalar version is required.
+// The ISA limit is for comparing versions; kernels must not be called while it changes.
+
+class KernelDispatch
+{
+private:
+	class KernelBase
+	{
+	protected:
+		const char *name;
+		Platform::CpuIsa selectedIsa;
+
+		KernelBase(const char *name);
+	public:
+		virtual ~KernelBase() = default;
+
+		const char *getName() const;
+		Platform::CpuIsa getSelectedIsa() const;
+
+		// Selects the most capable version the CPU supports within the given limit (if any).
+		virtual void select(const std::optional<Platform::CpuIsa> &maxIsa) = 0;
+	};
+
+	static std::optional<Platform::CpuIsa> maxIsa;
+
+	KernelDispatch() = delete;
+	~KernelDispatch() = delete;
+
+	// Kept as local statics so kernels registered before main() can use them.
+	static std::vector<KernelBase*> &getKernels();
+	static std::string &getMutableSelectionsText();
+
+	// Adds a kernel so it's selected again when the limit changes.
+	static void addKernel(KernelBase *kernel);
+
+	// Remakes the text returned by getSelectionsText().
+	static void updateSelectionsText();
+
+	// Returns whether a version for the given instruction set may be selected.
+	static bool isAllowed(Platform::CpuIsa isa, const std::optional<Platform::CpuIsa> &maxIsa);
+public:
+	// A function with versions for different instruction sets. Meant to be defined once at
+	// namespace scope (or as a static member) so it's registered before main().
+	template <typename FunctionType>
+	class Kernel : public KernelBase
+	{
+	private:
+		std::vector<std::pair<Platform::CpuIsa, FunctionType*>> versions;
+		FunctionType *selected;
+	public:
+		Kernel(const char *name,
+			std::initializer_list<std::pair<Platform::CpuIsa, FunctionType*>> versions)
+			: KernelBase(name), versions(versions)
+		{
+			this->selected = nullptr;
+			this->select(KernelDispatch::maxIsa);
+			KernelDispatch::addKernel(this);
+		}
+
+		void select(const std::optional<Platform::CpuIsa> &maxIsa) override
+		{
+			this->selected = nullptr;
+			for (const auto &pair : this->versions)
+			{
+				const bool isBetter = (this->selected == nullptr) ||
+					(static_cast<int>(pair.first) > static_cast<int>(this->selectedIsa));
+				if (KernelDispatch::isAllowed(pair.first, maxIsa) && isBetter)
+				{
+					this->selected = pair.second;
+					this->selectedIsa = pair.first;
+				}
+			}
+
+			DebugAssertMsg(this->selected != nullptr, "No usable version of kernel \"" +
+				std::string(this->name) + "\".");
+		}
+
+		FunctionType &get() const
+		{
+			return *this->selected;
+		}
+	};
+
+	// Gets the most capable instruction set kernels may use, if limited.
+	static const std::optional<Platform::CpuIsa> &getMaxIsa();
+
+	// Limits kernels to the given instruction set (or lesser ones of the same architecture)
+	// and selects them again. No limit gives each kernel its best version for the CPU.
+	static void setMaxIsa(const std::optional<Platform::CpuIsa> &isa);
+
+	// Gets each kernel's name and selected instruction set, i.e., "TransposeFrame: SSE2".
+	// Only remade when the selections change, so it can be shown every frame.
+	static const std::string &getSelectionsText();
+};
+
+#endif
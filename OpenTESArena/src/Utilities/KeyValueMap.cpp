@@ -1,16 +1,17 @@
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <string_view>
-#include <vector>
+#include <system_error>
 
 #include "Debug.h"
 #include "File.h"
 #include "KeyValueMap.h"
-#include "String.h"
 #include "StringView.h"
 
 namespace
 {
-	const std::unordered_map<std::string, bool> BooleanStrings =
+	const std::unordered_map<std::string_view, bool> BooleanStrings =
 	{
 		{ "True", true },
 		{ "true", true },
@@ -25,51 +26,42 @@ const char KeyValueMap::SECTION_FRONT = '[';
 const char KeyValueMap::SECTION_BACK = ']';
 
 KeyValueMap::KeyValueMap(const std::string &filename)
-	: filename(filename)
+	: text(File::readAllText(filename)), filename(filename)
 {
-	const std::string text = File::readAllText(filename);
-	std::istringstream iss(text);
+	const std::string_view text = this->text;
 
 	// Check each line for a valid section or key-value pair. Start the line numbers at 1
 	// since most users aren't programmers.
-	std::string line;
 	SectionMap *activeSectionMap = nullptr;
-	for (int lineNumber = 1; std::getline(iss, line); lineNumber++)
+	size_t lineStart = 0;
+	for (int lineNumber = 1; lineStart < text.size(); lineNumber++)
 	{
+		const size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+		const std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
 		// Get a filtered version of the current line so it can be parsed. If the filtered
 		// string is empty, then skip to the next line.
-		const std::string_view filteredLine = [&line]()
+		const std::string_view filteredLine = [line]()
 		{
 			std::string_view str = line;
 
-			// Skip empty strings.
-			if ((str.size() == 0) || ((str.size() == 1) && (str.front() == '\r')))
-			{
-				return std::string_view();
-			}
-
 			// Remove carriage return at the end (if any).
-			if (str.back() == '\r')
+			if (!str.empty() && (str.back() == '\r'))
 			{
 				str.remove_suffix(1);
 			}
 
 			// Extract left-most comment (if any).
 			const size_t commentIndex = str.find(KeyValueMap::COMMENT);
-			if (commentIndex == 0)
+			if (commentIndex != std::string_view::npos)
 			{
-				// Comment covers the entire line.
-				return std::string_view();
-			}
-			else if (commentIndex != std::string_view::npos)
-			{
-				// Comment is somewhere in the line, so only work with the left substring.
 				str = str.substr(0, commentIndex);
 			}
 
 			// Trim leading and trailing whitespace (i.e., in case the key has whitespace
 			// before it, or a comment had whitespace before it).
-			return StringView::trimFront(StringView::trimBack(str));
+			return StringView::trimEnds(str);
 		}();
 
 		if (filteredLine.empty())
@@ -100,21 +92,17 @@ KeyValueMap::KeyValueMap(const std::string &filename)
 				// leading or trailing whitespace.
 				std::string_view sectionName = filteredLine.substr(
 					sectionFrontIndex + 1, sectionBackIndex - sectionFrontIndex - 1);
-				sectionName = StringView::trimFront(StringView::trimBack(sectionName));
-
-				std::string sectionNameStr(sectionName);
-				auto sectionIter = this->sectionMaps.find(sectionNameStr);
+				sectionName = StringView::trimEnds(sectionName);
 
 				// If the section is new, add it to the section maps.
-				if (sectionIter == this->sectionMaps.end())
+				const auto sectionIter = this->sectionMaps.emplace(sectionName, SectionMap());
+				if (sectionIter.second)
 				{
-					sectionIter = this->sectionMaps.insert(std::make_pair(
-						std::move(sectionNameStr), SectionMap())).first;
-					activeSectionMap = &sectionIter->second;
+					activeSectionMap = &sectionIter.first->second;
 				}
 				else
 				{
-					DebugCrash("Section \"" + sectionNameStr + "\" (line " +
+					DebugCrash("Section \"" + std::string(sectionName) + "\" (line " +
 						std::to_string(lineNumber) + ") already defined in " + filename + ".");
 				}
 			}
@@ -124,21 +112,22 @@ KeyValueMap::KeyValueMap(const std::string &filename)
 					std::to_string(lineNumber) + ") in " + filename + ".");
 			}
 		}
-		else if (filteredLine.find(KeyValueMap::PAIR_SEPARATOR) != std::string::npos)
+		else if (filteredLine.find(KeyValueMap::PAIR_SEPARATOR) != std::string_view::npos)
 		{
 			// Key-value pair line. There must be two tokens: key and value.
-			const std::vector<std::string_view> tokens = StringView::split(
-				filteredLine, KeyValueMap::PAIR_SEPARATOR);
+			std::array<std::string_view, 2> tokens;
+			const size_t tokenCount = StringView::split(
+				filteredLine, KeyValueMap::PAIR_SEPARATOR, tokens);
 
-			if (tokens.size() != 2)
+			if (tokenCount != tokens.size())
 			{
 				DebugCrash("Invalid pair \"" + std::string(filteredLine) + "\" (line " +
 					std::to_string(lineNumber) + ") in " + filename + ".");
 			}
 
 			// Trim trailing whitespace from the key and leading whitespace from the value.
-			std::string_view key = StringView::trimBack(tokens.front());
-			std::string_view value = StringView::trimFront(tokens.back());
+			const std::string_view key = StringView::trimBack(tokens[0]);
+			const std::string_view value = StringView::trimFront(tokens[1]);
 
 			if (key.size() == 0)
 			{
@@ -149,7 +138,7 @@ KeyValueMap::KeyValueMap(const std::string &filename)
 			// Add the key-value pair to the active section map.
 			if (activeSectionMap != nullptr)
 			{
-				activeSectionMap->insert(std::make_pair(std::string(key), std::string(value)));
+				activeSectionMap->emplace(key, value);
 			}
 			else
 			{
@@ -162,20 +151,20 @@ KeyValueMap::KeyValueMap(const std::string &filename)
 		else
 		{
 			// Filtered line is not a section or key-value pair.
-			DebugCrash("Invalid line \"" + line + "\" (line " +
+			DebugCrash("Invalid line \"" + std::string(line) + "\" (line " +
 				std::to_string(lineNumber) + ") in " + filename + ".");
 		}
 	}
 }
 
-const std::string &KeyValueMap::getValue(const std::string &section, const std::string &key) const
+std::string_view KeyValueMap::getValue(std::string_view section, std::string_view key) const
 {
 	const auto sectionIter = this->sectionMaps.find(section);
 
 	// @todo: redesign so it returns success instead of needing exceptions.
 	if (sectionIter == this->sectionMaps.end())
 	{
-		throw DebugException("Section \"" + section +
+		throw DebugException("Section \"" + std::string(section) +
 			"\" not found in " + this->filename + ".");
 	}
 	else
@@ -184,8 +173,8 @@ const std::string &KeyValueMap::getValue(const std::string &section, const std::
 		const auto keyIter = sectionMap.find(key);
 		if (keyIter == sectionMap.end())
 		{
-			throw DebugException("Key \"" + key + "\" not found in " +
-				KeyValueMap::SECTION_FRONT + section + KeyValueMap::SECTION_BACK +
+			throw DebugException("Key \"" + std::string(key) + "\" not found in " +
+				KeyValueMap::SECTION_FRONT + std::string(section) + KeyValueMap::SECTION_BACK +
 				" in " + this->filename + ".");
 		}
 		else
@@ -195,35 +184,52 @@ const std::string &KeyValueMap::getValue(const std::string &section, const std::
 	}
 }
 
-bool KeyValueMap::getBoolean(const std::string &section, const std::string &key) const
+bool KeyValueMap::getBoolean(std::string_view section, std::string_view key) const
 {
-	const std::string &value = this->getValue(section, key);
+	const std::string_view value = this->getValue(section, key);
 	const auto iter = BooleanStrings.find(value);
-	DebugAssertMsg(iter != BooleanStrings.end(), "\"" + key + "\" value \"" +
-		value + "\" in " + this->filename + " must be true or false.");
+	DebugAssertMsg(iter != BooleanStrings.end(), "\"" + std::string(key) + "\" value \"" +
+		std::string(value) + "\" in " + this->filename + " must be true or false.");
 
 	return iter->second;
 }
 
-int KeyValueMap::getInteger(const std::string &section, const std::string &key) const
+int KeyValueMap::getInteger(std::string_view section, std::string_view key) const
 {
-	const std::string &value = this->getValue(section, key);
-	return std::stoi(value);
+	std::string_view value = this->getValue(section, key);
+
+	// Same as std::stoi(), which allowed a leading plus sign.
+	if ((value.size() > 1) && (value.front() == '+'))
+	{
+		value.remove_prefix(1);
+	}
+
+	int integer = 0;
+	const std::from_chars_result result =
+		std::from_chars(value.data(), value.data() + value.size(), integer);
+	if (result.ec != std::errc())
+	{
+		throw DebugException("\"" + std::string(key) + "\" value \"" + std::string(value) +
+			"\" in " + this->filename + " must be an integer.");
+	}
+
+	return integer;
 }
 
-double KeyValueMap::getDouble(const std::string &section, const std::string &key) const
+double KeyValueMap::getDouble(std::string_view section, std::string_view key) const
 {
-	const std::string &value = this->getValue(section, key);
+	// Copied since there's no string view version of std::stod(). The value is short so it
+	// usually fits in the string without allocating.
+	const std::string value(this->getValue(section, key));
 	return std::stod(value);
 }
 
-const std::string &KeyValueMap::getString(const std::string &section, const std::string &key) const
+std::string_view KeyValueMap::getString(std::string_view section, std::string_view key) const
 {
-	const std::string &value = this->getValue(section, key);
-	return value;
+	return this->getValue(section, key);
 }
 
-const std::unordered_map<std::string, KeyValueMap::SectionMap> &KeyValueMap::getAll() const
+const std::unordered_map<std::string_view, KeyValueMap::SectionMap> &KeyValueMap::getAll() const
 {
 	return this->sectionMaps;
 }
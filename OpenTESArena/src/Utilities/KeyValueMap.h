@@ -2,23 +2,28 @@
 #define KEY_VALUE_MAP_H
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 // A key-value map reads in a key-value pair file that uses the "key = value" syntax.
 // Pairs are associated with a section and can be listed in the file in any order.
 // Comments can be anywhere in a line.
 
+// The file is kept in one buffer and every section, key, and value is a view into it, so
+// parsing doesn't allocate per line or per pair. Because of that a map can't be copied.
+
 class KeyValueMap
 {
 public:
-	typedef std::unordered_map<std::string, std::string> SectionMap;
+	typedef std::unordered_map<std::string_view, std::string_view> SectionMap;
 private:
-	// Each section has a map of key-value pairs.
-	std::unordered_map<std::string, SectionMap> sectionMaps;
+	// Each section has a map of key-value pairs, all pointing into the file text.
+	std::unordered_map<std::string_view, SectionMap> sectionMaps;
+	std::string text;
 	std::string filename;
 
 	// Use this function to access the section maps since it does error checking.
-	const std::string &getValue(const std::string &section, const std::string &key) const;
+	std::string_view getValue(std::string_view section, std::string_view key) const;
 public:
 	// These are public so other code can use them (i.e., for options writing).
 	static const char COMMENT;
@@ -28,15 +33,19 @@ public:
 
 	// Converts key-value pairs in a file to string->string mappings.
 	KeyValueMap(const std::string &filename);
+	KeyValueMap(const KeyValueMap&) = delete;
+
+	KeyValueMap &operator=(const KeyValueMap&) = delete;
 
-	// Typed getter methods for convenience.
-	bool getBoolean(const std::string &section, const std::string &key) const;
-	int getInteger(const std::string &section, const std::string &key) const;
-	double getDouble(const std::string &section, const std::string &key) const;
-	const std::string &getString(const std::string &section, const std::string &key) const;
+	// Typed getter methods for convenience. Returned strings are views into the map, so
+	// they're only valid while it's alive.
+	bool getBoolean(std::string_view section, std::string_view key) const;
+	int getInteger(std::string_view section, std::string_view key) const;
+	double getDouble(std::string_view section, std::string_view key) const;
+	std::string_view getString(std::string_view section, std::string_view key) const;
 
 	// Gets a reference to all section maps. Intended for iteration.
-	const std::unordered_map<std::string, SectionMap> &getAll() const;
+	const std::unordered_map<std::string_view, SectionMap> &getAll() const;
 };
 
 #endif
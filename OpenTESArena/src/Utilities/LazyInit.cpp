@@ -0,0 +1,42 @@
+#include <chrono>
+
+#include "Debug.h"
+#include "LazyInit.h"
+#include "String.h"
+
+LazyInit::LazyInit()
+{
+	this->success = false;
+	this->done = false;
+}
+
+void LazyInit::init(const std::string &name, std::function<bool()> &&function)
+{
+	this->name = name;
+	this->function = std::move(function);
+}
+
+bool LazyInit::get() const
+{
+	std::call_once(this->flag, [this]()
+	{
+		DebugAssert(this->function);
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		this->success = this->function();
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+
+		DebugLog("Loaded " + this->name + " in " +
+			String::fixedPrecision(seconds * 1000.0, 1) + "ms.");
+
+		this->done.store(true, std::memory_order_release);
+	});
+
+	return this->success;
+}
+
+bool LazyInit::isDone() const
+{
+	return this->done.load(std::memory_order_acquire);
+}
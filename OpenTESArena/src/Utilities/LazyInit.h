@@ -0,0 +1,37 @@
+#ifndef LAZY_INIT_H
+#define LAZY_INIT_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// Defers a loading function until the data it loads is first needed. Any number of threads
+// can ask for it at once; the first one runs the function and the rest wait for it to finish.
+
+// The function is expected to log its own errors. A failed load isn't retried, so the
+// caller gets whatever the function left behind.
+
+class LazyInit
+{
+private:
+	std::string name; // For logging how long it took.
+	std::function<bool()> function;
+	mutable std::once_flag flag;
+	mutable bool success;
+	mutable std::atomic<bool> done;
+public:
+	LazyInit();
+
+	// Sets the function to run on first use. Must be called before get().
+	void init(const std::string &name, std::function<bool()> &&function);
+
+	// Runs the function if it hasn't been run yet, and returns whether it succeeded.
+	bool get() const;
+
+	// Returns whether the function has finished, without running it. For code that only
+	// wants to look at the data if it's already there (i.e., memory reports).
+	bool isDone() const;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+	this->data = nullptr;
+	this->size = 0;
+#if defined(_WIN32)
+	this->fileHandle = nullptr;
+	this->mappingHandle = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	this->clear();
+}
+
+bool MappedFile::init(const char *filename)
+{
+	this->clear();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart == 0))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	this->fileHandle = file;
+	this->mappingHandle = mapping;
+	this->data = static_cast<const uint8_t*>(view);
+	this->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+	{
+		close(fd);
+		return false;
+	}
+
+	void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps the file open, so the descriptor isn't needed anymore.
+	close(fd);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	this->data = static_cast<const uint8_t*>(view);
+	this->size = static_cast<size_t>(st.st_size);
+#endif
+
+	return true;
+}
+
+bool MappedFile::isMapped() const
+{
+	return this->data != nullptr;
+}
+
+const uint8_t *MappedFile::getData() const
+{
+	return this->data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return this->size;
+}
+
+void MappedFile::clear()
+{
+	if (this->data == nullptr)
+	{
+		return;
+	}
+
+#if defined(_WIN32)
+	UnmapViewOfFile(this->data);
+	CloseHandle(this->mappingHandle);
+	CloseHandle(this->fileHandle);
+	this->fileHandle = nullptr;
+	this->mappingHandle = nullptr;
+#else
+	munmap(const_cast<uint8_t*>(this->data), this->size);
+#endif
+
+	this->data = nullptr;
+	this->size = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// A whole file mapped read-only into memory, so reading it doesn't copy it into a buffer
+// first. The OS pages it in as it's used.
+
+class MappedFile
+{
+private:
+	const uint8_t *data;
+	size_t size;
+#if defined(_WIN32)
+	void *fileHandle, *mappingHandle;
+#endif
+public:
+	MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	~MappedFile();
+
+	MappedFile &operator=(const MappedFile&) = delete;
+
+	// Maps a file, replacing any mapped one. Returns false if it can't be opened or is empty.
+	bool init(const char *filename);
+
+	bool isMapped() const;
+
+	// Gets the file's bytes. Only valid while the file is mapped.
+	const uint8_t *getData() const;
+	size_t getSize() const;
+
+	void clear();
+};
+
+#endif
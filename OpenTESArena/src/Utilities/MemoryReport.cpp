@@ -0,0 +1,97 @@
+#include <algorithm>
+
+#include "MemoryReport.h"
+#include "String.h"
+
+void MemoryReport::add(const std::string &name, size_t bytes)
+{
+	auto iter = std::find_if(this->entries.begin(), this->entries.end(),
+		[&name](const Entry &entry)
+	{
+		return entry.name == name;
+	});
+
+	if (iter != this->entries.end())
+	{
+		iter->bytes += bytes;
+	}
+	else
+	{
+		this->entries.push_back(Entry { name, bytes });
+		iter = this->entries.end() - 1;
+	}
+
+	// Keep the biggest first. Only the changed entry can be out of place, and only upward.
+	while ((iter != this->entries.begin()) && ((iter - 1)->bytes < iter->bytes))
+	{
+		std::iter_swap(iter - 1, iter);
+		--iter;
+	}
+}
+
+void MemoryReport::clear()
+{
+	this->entries.clear();
+}
+
+const std::vector<MemoryReport::Entry> &MemoryReport::getEntries() const
+{
+	return this->entries;
+}
+
+size_t MemoryReport::getTotalBytes() const
+{
+	size_t bytes = 0;
+	for (const Entry &entry : this->entries)
+	{
+		bytes += entry.bytes;
+	}
+
+	return bytes;
+}
+
+size_t MemoryReport::getGroupBytes(const std::string &group) const
+{
+	size_t bytes = 0;
+	for (const Entry &entry : this->entries)
+	{
+		const bool inGroup = (entry.name.size() > group.size()) &&
+			(entry.name.compare(0, group.size(), group) == 0) &&
+			(entry.name[group.size()] == '/');
+		if (inGroup)
+		{
+			bytes += entry.bytes;
+		}
+	}
+
+	return bytes;
+}
+
+std::string MemoryReport::toString() const
+{
+	auto toMB = [](size_t bytes)
+	{
+		return String::fixedPrecision(static_cast<double>(bytes) / (1024.0 * 1024.0), 2);
+	};
+
+	const size_t totalBytes = this->getTotalBytes();
+	std::string str = "Total: " + toMB(totalBytes) + " MB\n";
+	for (const Entry &entry : this->entries)
+	{
+		const double percent = (totalBytes > 0) ?
+			(100.0 * static_cast<double>(entry.bytes) / static_cast<double>(totalBytes)) : 0.0;
+		str += entry.name + ": " + toMB(entry.bytes) + " MB (" +
+			String::fixedPrecision(percent, 1) + "%)\n";
+	}
+
+	return str;
+}
+
+size_t MemoryReport::getStringBytes(const std::string &str)
+{
+	// Strings within the small string buffer point inside themselves.
+	const char *data = str.data();
+	const char *self = reinterpret_cast<const char*>(&str);
+	const bool isSmall = (data >= self) && (data < (self + sizeof(std::string)));
+	return isSmall ? 0 : (str.capacity() + 1);
+}
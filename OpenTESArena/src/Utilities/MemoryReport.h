@@ -0,0 +1,51 @@
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Bytes held by each part of the game, as told by the parts themselves. Each one adds its
+// big buffers (pixels, texels, samples, voxels, text tables) under a name like
+// "Textures/Surfaces". Small bookkeeping isn't counted, so the total is a lower bound.
+
+class MemoryReport
+{
+public:
+	struct Entry
+	{
+		std::string name;
+		size_t bytes;
+	};
+private:
+	std::vector<Entry> entries;
+public:
+	// Adds bytes under the given name, on top of any already there.
+	void add(const std::string &name, size_t bytes);
+
+	void clear();
+
+	// Gets the entries from biggest to smallest.
+	const std::vector<Entry> &getEntries() const;
+
+	size_t getTotalBytes() const;
+
+	// Gets the bytes of every entry whose name starts with the given group and a slash
+	// (i.e., "Textures" for "Textures/Surfaces"), for per-subsystem totals.
+	size_t getGroupBytes(const std::string &group) const;
+
+	// Gets one line per entry in megabytes with its share of the total, biggest first.
+	std::string toString() const;
+
+	// Gets the heap bytes of a vector's elements, for reporters to sum their containers.
+	template <typename T>
+	static size_t getVectorBytes(const std::vector<T> &vec)
+	{
+		return vec.capacity() * sizeof(T);
+	}
+
+	// Gets the heap bytes of a string (zero if it fits in the string itself).
+	static size_t getStringBytes(const std::string &str);
+};
+
+#endif
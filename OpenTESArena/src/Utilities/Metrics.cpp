@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "Debug.h"
+#include "File.h"
+#include "Metrics.h"
+
+namespace
+{
+	enum class MetricType { Counter, Gauge, Histogram };
+
+	struct MetricEntry
+	{
+		std::string baseName, labels; // Labels without the braces, or empty.
+		std::string help;
+		MetricType type;
+
+		// Only the one for the type is set.
+		std::unique_ptr<Metrics::Counter> counter;
+		std::unique_ptr<Metrics::Gauge> gauge;
+		std::unique_ptr<Metrics::Histogram> histogram;
+	};
+
+	struct MetricRegistry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<MetricEntry>> entries; // In registration order.
+		std::unordered_map<std::string, MetricEntry*> entriesByName;
+
+		// Separate from the registry mutex since collectors get metrics themselves.
+		std::mutex collectorMutex;
+		std::vector<std::function<void()>> collectors;
+	};
+
+	MetricRegistry &getRegistry()
+	{
+		static MetricRegistry registry;
+		return registry;
+	}
+
+	// Gets the entry for a name, adding one of the given type if it doesn't exist yet. The
+	// registry mutex must be held.
+	MetricEntry &getOrAddEntry(MetricRegistry &registry, const std::string &name,
+		const std::string &help, MetricType type, bool *outAdded)
+	{
+		const auto iter = registry.entriesByName.find(name);
+		if (iter != registry.entriesByName.end())
+		{
+			MetricEntry &entry = *iter->second;
+			DebugAssertMsg(entry.type == type, "Metric \"" + name +
+				"\" was registered with a different type.");
+			*outAdded = false;
+			return entry;
+		}
+
+		auto entry = std::make_unique<MetricEntry>();
+		const size_t braceIndex = name.find('{');
+		if (braceIndex != std::string::npos)
+		{
+			DebugAssertMsg(name.back() == '}', "Metric \"" + name + "\" has unclosed labels.");
+			entry->baseName = name.substr(0, braceIndex);
+			entry->labels = name.substr(braceIndex + 1, name.size() - braceIndex - 2);
+		}
+		else
+		{
+			entry->baseName = name;
+		}
+
+		entry->help = help;
+		entry->type = type;
+
+		MetricEntry &entryRef = *entry.get();
+		registry.entriesByName.insert(std::make_pair(name, entry.get()));
+		registry.entries.push_back(std::move(entry));
+		*outAdded = true;
+		return entryRef;
+	}
+
+	const char *getTypeName(MetricType type)
+	{
+		if (type == MetricType::Counter)
+		{
+			return "counter";
+		}
+		else if (type == MetricType::Gauge)
+		{
+			return "gauge";
+		}
+		else
+		{
+			return "histogram";
+		}
+	}
+
+	// Writes a sample line, putting any extra label after the metric's own labels.
+	void writeSample(std::ostringstream &stream, const std::string &name,
+		const std::string &labels, const std::string &extraLabel, double value)
+	{
+		stream << name;
+		if (!labels.empty() || !extraLabel.empty())
+		{
+			stream << '{' << labels;
+			if (!labels.empty() && !extraLabel.empty())
+			{
+				stream << ',';
+			}
+
+			stream << extraLabel << '}';
+		}
+
+		stream << ' ';
+		if (std::isinf(value))
+		{
+			stream << ((value > 0.0) ? "+Inf" : "-Inf");
+		}
+		else
+		{
+			stream << value;
+		}
+
+		stream << '\n';
+	}
+}
+
+Metrics::Counter::Counter()
+	: value(0) { }
+
+void Metrics::Counter::add(uint64_t count)
+{
+	this->value.fetch_add(count, std::memory_order_relaxed);
+}
+
+void Metrics::Counter::increment()
+{
+	this->add(1);
+}
+
+void Metrics::Counter::setTotal(uint64_t total)
+{
+	this->value.store(total, std::memory_order_relaxed);
+}
+
+uint64_t Metrics::Counter::get() const
+{
+	return this->value.load(std::memory_order_relaxed);
+}
+
+Metrics::Gauge::Gauge()
+	: value(0.0) { }
+
+void Metrics::Gauge::set(double value)
+{
+	this->value.store(value, std::memory_order_relaxed);
+}
+
+double Metrics::Gauge::get() const
+{
+	return this->value.load(std::memory_order_relaxed);
+}
+
+Metrics::Histogram::Histogram(const std::vector<double> &upperBounds)
+	: upperBounds(upperBounds), count(0), sum(0.0)
+{
+	DebugAssert(std::is_sorted(this->upperBounds.begin(), this->upperBounds.end()));
+
+	const size_t bucketCount = this->upperBounds.size() + 1;
+	this->bucketCounts = std::make_unique<std::atomic<uint64_t>[]>(bucketCount);
+	for (size_t i = 0; i < bucketCount; i++)
+	{
+		this->bucketCounts[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void Metrics::Histogram::observe(double value)
+{
+	const auto iter = std::lower_bound(this->upperBounds.begin(), this->upperBounds.end(),
+		value);
+	const size_t bucketIndex = std::distance(this->upperBounds.begin(), iter);
+	this->bucketCounts[bucketIndex].fetch_add(1, std::memory_order_relaxed);
+	this->count.fetch_add(1, std::memory_order_relaxed);
+
+	double oldSum = this->sum.load(std::memory_order_relaxed);
+	while (!this->sum.compare_exchange_weak(oldSum, oldSum + value,
+		std::memory_order_relaxed)) { }
+}
+
+const std::vector<double> &Metrics::Histogram::getUpperBounds() const
+{
+	return this->upperBounds;
+}
+
+uint64_t Metrics::Histogram::getCumulativeCount(int bucketIndex) const
+{
+	DebugAssert(bucketIndex >= 0);
+	DebugAssert(bucketIndex <= static_cast<int>(this->upperBounds.size()));
+
+	uint64_t cumulativeCount = 0;
+	for (int i = 0; i <= bucketIndex; i++)
+	{
+		cumulativeCount += this->bucketCounts[i].load(std::memory_order_relaxed);
+	}
+
+	return cumulativeCount;
+}
+
+uint64_t Metrics::Histogram::getCount() const
+{
+	return this->count.load(std::memory_order_relaxed);
+}
+
+double Metrics::Histogram::getSum() const
+{
+	return this->sum.load(std::memory_order_relaxed);
+}
+
+Metrics::ScopedTimer::ScopedTimer(Histogram &histogram)
+	: histogram(histogram)
+{
+	this->startTime = std::chrono::steady_clock::now();
+}
+
+Metrics::ScopedTimer::~ScopedTimer()
+{
+	const std::chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - this->startTime;
+	this->histogram.observe(duration.count());
+}
+
+const std::vector<double> Metrics::DEFAULT_SECONDS_BUCKETS =
+{
+	0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+Metrics::Counter &Metrics::getCounter(const std::string &name, const std::string &help)
+{
+	MetricRegistry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	bool added;
+	MetricEntry &entry = getOrAddEntry(registry, name, help, MetricType::Counter, &added);
+	if (added)
+	{
+		entry.counter = std::make_unique<Counter>();
+	}
+
+	return *entry.counter.get();
+}
+
+Metrics::Gauge &Metrics::getGauge(const std::string &name, const std::string &help)
+{
+	MetricRegistry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	bool added;
+	MetricEntry &entry = getOrAddEntry(registry, name, help, MetricType::Gauge, &added);
+	if (added)
+	{
+		entry.gauge = std::make_unique<Gauge>();
+	}
+
+	return *entry.gauge.get();
+}
+
+Metrics::Histogram &Metrics::getHistogram(const std::string &name, const std::string &help,
+	const std::vector<double> &upperBounds)
+{
+	MetricRegistry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	bool added;
+	MetricEntry &entry = getOrAddEntry(registry, name, help, MetricType::Histogram, &added);
+	if (added)
+	{
+		entry.histogram = std::make_unique<Histogram>(upperBounds);
+	}
+
+	return *entry.histogram.get();
+}
+
+void Metrics::addCollector(std::function<void()> &&collector)
+{
+	MetricRegistry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.collectorMutex);
+	registry.collectors.push_back(std::move(collector));
+}
+
+void Metrics::clearCollectors()
+{
+	MetricRegistry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.collectorMutex);
+	registry.collectors.clear();
+}
+
+std::string Metrics::toText()
+{
+	MetricRegistry &registry = getRegistry();
+
+	{
+		std::lock_guard<std::mutex> lock(registry.collectorMutex);
+		for (const std::function<void()> &collector : registry.collectors)
+		{
+			collector();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	// Metrics sharing a name have to be next to each other under one HELP and TYPE line.
+	std::vector<const MetricEntry*> entries;
+	entries.reserve(registry.entries.size());
+	for (const auto &entry : registry.entries)
+	{
+		entries.push_back(entry.get());
+	}
+
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const MetricEntry *a, const MetricEntry *b)
+	{
+		return a->baseName < b->baseName;
+	});
+
+	std::ostringstream stream;
+	stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+	const std::string *previousBaseName = nullptr;
+	for (const MetricEntry *entry : entries)
+	{
+		if ((previousBaseName == nullptr) || (*previousBaseName != entry->baseName))
+		{
+			stream << "# HELP " << entry->baseName << ' ' << entry->help << '\n';
+			stream << "# TYPE " << entry->baseName << ' ' << getTypeName(entry->type) << '\n';
+			previousBaseName = &entry->baseName;
+		}
+
+		if (entry->type == MetricType::Counter)
+		{
+			writeSample(stream, entry->baseName, entry->labels, std::string(),
+				static_cast<double>(entry->counter->get()));
+		}
+		else if (entry->type == MetricType::Gauge)
+		{
+			writeSample(stream, entry->baseName, entry->labels, std::string(),
+				entry->gauge->get());
+		}
+		else
+		{
+			const Histogram &histogram = *entry->histogram.get();
+			const std::vector<double> &upperBounds = histogram.getUpperBounds();
+			const std::string bucketName = entry->baseName + "_bucket";
+
+			// Bucket bounds are written with few digits so they're readable and stable.
+			for (int i = 0; i <= static_cast<int>(upperBounds.size()); i++)
+			{
+				std::ostringstream boundStream;
+				if (i < static_cast<int>(upperBounds.size()))
+				{
+					boundStream << upperBounds[i];
+				}
+				else
+				{
+					boundStream << "+Inf";
+				}
+
+				writeSample(stream, bucketName, entry->labels, "le=\"" + boundStream.str() +
+					"\"", static_cast<double>(histogram.getCumulativeCount(i)));
+			}
+
+			writeSample(stream, entry->baseName + "_sum", entry->labels, std::string(),
+				histogram.getSum());
+			writeSample(stream, entry->baseName + "_count", entry->labels, std::string(),
+				static_cast<double>(histogram.getCount()));
+		}
+	}
+
+	return stream.str();
+}
+
+bool Metrics::save(const std::string &filename)
+{
+	const std::string text = Metrics::toText();
+	const std::string tempFilename = filename + ".tmp";
+	{
+		std::ofstream ofs(tempFilename, std::ios::binary);
+		if (!ofs.is_open())
+		{
+			DebugLogWarning("Could not open \"" + tempFilename + "\" for writing.");
+			return false;
+		}
+
+		ofs.write(text.data(), text.size());
+		if (!ofs.good())
+		{
+			DebugLogWarning("Could not write \"" + tempFilename + "\".");
+			return false;
+		}
+	}
+
+	if (!File::replaceWithTemporary(tempFilename, filename))
+	{
+		DebugLogWarning("Could not replace \"" + filename + "\" with \"" + tempFilename + "\".");
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,121 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Named counters, gauges, and histograms that any part of the game can register and update,
+// for reading performance numbers out of a running game. They're written in the Prometheus
+// text format, so a file saved in the log folder can be scraped by node_exporter's textfile
+// collector or just read.
+
+// Names may end with labels in braces (i.e., "level_load_seconds{type=\"city\"}"). Metrics
+// with the same name but different labels share one HELP and TYPE line.
+
+class Metrics
+{
+public:
+	// A count that only goes up (i.e., sounds played). Safe to update from any thread.
+	class Counter
+	{
+	private:
+		std::atomic<uint64_t> value;
+	public:
+		Counter();
+
+		void add(uint64_t count);
+		void increment();
+
+		// Sets the count to a total kept elsewhere, for subsystems that already count it.
+		void setTotal(uint64_t total);
+
+		uint64_t get() const;
+	};
+
+	// A value that can go up and down (i.e., bytes in use). Safe to update from any thread.
+	class Gauge
+	{
+	private:
+		std::atomic<double> value;
+	public:
+		Gauge();
+
+		void set(double value);
+		double get() const;
+	};
+
+	// How many observed values were at or below each bucket's upper bound, plus their count
+	// and sum. Safe to update from any thread.
+	class Histogram
+	{
+	private:
+		std::vector<double> upperBounds; // Sorted, without the implicit +Inf bucket.
+		std::unique_ptr<std::atomic<uint64_t>[]> bucketCounts; // Not cumulative.
+		std::atomic<uint64_t> count;
+		std::atomic<double> sum;
+	public:
+		Histogram(const std::vector<double> &upperBounds);
+
+		void observe(double value);
+
+		const std::vector<double> &getUpperBounds() const;
+
+		// Gets how many values were at or below the bucket's upper bound. The bucket after
+		// the last upper bound is for every value.
+		uint64_t getCumulativeCount(int bucketIndex) const;
+
+		uint64_t getCount() const;
+		double getSum() const;
+	};
+
+	// Observes the seconds from construction to destruction in a histogram.
+	class ScopedTimer
+	{
+	private:
+		Histogram &histogram;
+		std::chrono::steady_clock::time_point startTime;
+	public:
+		ScopedTimer(Histogram &histogram);
+		ScopedTimer(const ScopedTimer&) = delete;
+		~ScopedTimer();
+
+		ScopedTimer &operator=(const ScopedTimer&) = delete;
+	};
+
+	Metrics() = delete;
+	~Metrics() = delete;
+
+	// Bucket upper bounds for timing things that take a few milliseconds to a few seconds.
+	static const std::vector<double> DEFAULT_SECONDS_BUCKETS;
+
+	// Gets the metric with the given name, registering it the first time. The reference
+	// stays valid for the rest of the program, so callers can keep it in a static. The help
+	// text is only used by the first call for a name.
+	static Counter &getCounter(const std::string &name, const std::string &help);
+	static Gauge &getGauge(const std::string &name, const std::string &help);
+	static Histogram &getHistogram(const std::string &name, const std::string &help,
+		const std::vector<double> &upperBounds);
+
+	// Adds a function that's run before each snapshot, for updating gauges from stats a
+	// subsystem keeps anyway instead of updating them as things happen. Collectors run on
+	// the thread that takes the snapshot.
+	static void addCollector(std::function<void()> &&collector);
+
+	// Removes every collector, for when the objects they read from are going away. The
+	// metrics themselves keep their last values.
+	static void clearCollectors();
+
+	// Runs the collectors and gets every metric in the Prometheus text format.
+	static std::string toText();
+
+	// Writes toText() to the given file, replacing it all at once so a reader never sees a
+	// half-written file. Returns whether it was written.
+	static bool save(const std::string &filename);
+};
+
+#endif
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
 #include <thread>
+#include <utility>
 
 #include "SDL.h"
 
@@ -11,10 +16,105 @@
 #elif defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
 #include <cerrno>
 #include <cstring>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #endif
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	// Gets the EAX, EBX, ECX, and EDX registers of a CPUID leaf. All zero if the leaf isn't
+	// supported.
+	std::array<uint32_t, 4> getCpuid(uint32_t leaf, uint32_t subleaf)
+	{
+		std::array<uint32_t, 4> registers = { 0, 0, 0, 0 };
+#if defined(_M_X64) || defined(_M_IX86)
+		int maxInfo[4];
+		__cpuid(maxInfo, static_cast<int>(leaf & 0x80000000));
+		if (static_cast<uint32_t>(maxInfo[0]) >= leaf)
+		{
+			int info[4];
+			__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+			for (size_t i = 0; i < registers.size(); i++)
+			{
+				registers[i] = static_cast<uint32_t>(info[i]);
+			}
+		}
+#else
+		unsigned int eax, ebx, ecx, edx;
+		if (__get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx) != 0)
+		{
+			registers = { eax, ebx, ecx, edx };
+		}
+#endif
+		return registers;
+	}
+
+	// Gets which register states the OS saves on context switches. Only valid if the CPU
+	// has OSXSAVE.
+	uint64_t getXcr0()
+	{
+#if defined(_M_X64) || defined(_M_IX86)
+		return _xgetbv(0);
+#else
+		uint32_t eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+	}
+#endif
+
+	std::array<bool, Platform::CPU_ISA_COUNT> detectCpuIsas()
+	{
+		std::array<bool, Platform::CPU_ISA_COUNT> supported;
+		supported.fill(false);
+		supported[static_cast<int>(Platform::CpuIsa::Scalar)] = true;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		const std::array<uint32_t, 4> leaf1 = getCpuid(1, 0);
+		const std::array<uint32_t, 4> leaf7 = getCpuid(7, 0);
+		const bool sse2 = (leaf1[3] & (1u << 26)) != 0;
+		const bool sse41 = (leaf1[2] & (1u << 19)) != 0;
+		const bool osxsave = (leaf1[2] & (1u << 27)) != 0;
+		const bool avx = (leaf1[2] & (1u << 28)) != 0;
+		const bool fma = (leaf1[2] & (1u << 12)) != 0;
+		const bool avx2 = (leaf7[1] & (1u << 5)) != 0;
+		const bool avx512f = (leaf7[1] & (1u << 16)) != 0;
+		const bool avx512bw = (leaf7[1] & (1u << 30)) != 0;
+
+		// The OS has to save the YMM (and for AVX-512, the opmask and ZMM) registers too.
+		const uint64_t xcr0 = osxsave ? getXcr0() : 0;
+		const bool osYmm = (xcr0 & 0x6) == 0x6;
+		const bool osZmm = (xcr0 & 0xE6) == 0xE6;
+
+		supported[static_cast<int>(Platform::CpuIsa::SSE2)] = sse2;
+		supported[static_cast<int>(Platform::CpuIsa::SSE41)] = sse2 && sse41;
+		supported[static_cast<int>(Platform::CpuIsa::AVX2)] = sse41 && avx && fma && avx2 && osYmm;
+		supported[static_cast<int>(Platform::CpuIsa::AVX512)] =
+			supported[static_cast<int>(Platform::CpuIsa::AVX2)] && avx512f && avx512bw && osZmm;
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+		// Always there on 64-bit ARM, and on 32-bit ARM only if the build requires it.
+		supported[static_cast<int>(Platform::CpuIsa::NEON)] = true;
+#endif
+
+		return supported;
+	}
+}
+
 const std::string Platform::XDGDataHome = "XDG_DATA_HOME";
 const std::string Platform::XDGConfigHome = "XDG_CONFIG_HOME";
 
@@ -115,6 +215,42 @@ std::string Platform::getScreenshotPath()
 	return String::replace(screenshotPathString, '\\', '/');
 }
 
+std::string Platform::getCachePath()
+{
+	// SDL_GetPrefPath() creates the desired folder if it doesn't exist.
+	char *cachePathPtr = SDL_GetPrefPath("OpenTESArena", "cache");
+
+	if (cachePathPtr == nullptr)
+	{
+		DebugLogWarning("SDL_GetPrefPath() not available on this platform.");
+		cachePathPtr = SDL_strdup("cache/");
+	}
+
+	const std::string cachePathString(cachePathPtr);
+	SDL_free(cachePathPtr);
+
+	// Convert Windows backslashes to forward slashes.
+	return String::replace(cachePathString, '\\', '/');
+}
+
+std::string Platform::getSavePath()
+{
+	// SDL_GetPrefPath() creates the desired folder if it doesn't exist.
+	char *savePathPtr = SDL_GetPrefPath("OpenTESArena", "saves");
+
+	if (savePathPtr == nullptr)
+	{
+		DebugLogWarning("SDL_GetPrefPath() not available on this platform.");
+		savePathPtr = SDL_strdup("saves/");
+	}
+
+	const std::string savePathString(savePathPtr);
+	SDL_free(savePathPtr);
+
+	// Convert Windows backslashes to forward slashes.
+	return String::replace(savePathString, '\\', '/');
+}
+
 std::string Platform::getLogPath()
 {
 	// Unfortunately there's no SDL_GetLogPath(), so we need to make our own.
@@ -167,6 +303,176 @@ int Platform::getThreadCount()
 	}
 }
 
+bool Platform::isCpuIsaSupported(Platform::CpuIsa isa)
+{
+	static const std::array<bool, Platform::CPU_ISA_COUNT> Supported = detectCpuIsas();
+	return Supported[static_cast<int>(isa)];
+}
+
+Platform::CpuIsa Platform::getBestCpuIsa()
+{
+	for (int i = Platform::CPU_ISA_COUNT - 1; i > 0; i--)
+	{
+		const Platform::CpuIsa isa = static_cast<Platform::CpuIsa>(i);
+		if (Platform::isCpuIsaSupported(isa))
+		{
+			return isa;
+		}
+	}
+
+	return Platform::CpuIsa::Scalar;
+}
+
+const char *Platform::getCpuIsaName(Platform::CpuIsa isa)
+{
+	static const std::array<const char*, Platform::CPU_ISA_COUNT> Names =
+	{
+		"Scalar", "SSE2", "SSE4.1", "AVX2", "AVX-512", "NEON"
+	};
+
+	return Names[static_cast<int>(isa)];
+}
+
+bool Platform::tryParseCpuIsa(const std::string &name, Platform::CpuIsa *outIsa)
+{
+	for (int i = 0; i < Platform::CPU_ISA_COUNT; i++)
+	{
+		const Platform::CpuIsa isa = static_cast<Platform::CpuIsa>(i);
+		if (String::caseInsensitiveEquals(name, Platform::getCpuIsaName(isa)))
+		{
+			*outIsa = isa;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::vector<int> Platform::getCoresByPerformance()
+{
+	// Pairs of logical CPU index and relative performance (higher is faster).
+	std::vector<std::pair<int, int>> cores;
+
+#if defined(_WIN32)
+	// Efficiency class is only non-zero on hybrid CPUs, where higher means faster. Only the
+	// first processor group is used since thread affinity masks are per group.
+	ULONG length = 0;
+	GetSystemCpuSetInformation(nullptr, 0, &length, GetCurrentProcess(), 0);
+	std::vector<uint8_t> buffer(length);
+	if ((length > 0) && GetSystemCpuSetInformation(
+		reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data()), length, &length,
+		GetCurrentProcess(), 0))
+	{
+		ULONG offset = 0;
+		while (offset < length)
+		{
+			const auto *info = reinterpret_cast<const SYSTEM_CPU_SET_INFORMATION*>(
+				buffer.data() + offset);
+			if ((info->Type == CpuSetInformation) && (info->CpuSet.Group == 0))
+			{
+				cores.push_back(std::make_pair(
+					static_cast<int>(info->CpuSet.LogicalProcessorIndex),
+					static_cast<int>(info->CpuSet.EfficiencyClass)));
+			}
+
+			offset += info->Size;
+		}
+	}
+#elif defined(__linux__)
+	// The kernel gives each core a capacity on hybrid and big.LITTLE CPUs. Otherwise the max
+	// frequency is the best guess (it also differs between CCXs on some CPUs).
+	auto readValue = [](const std::string &filename)
+	{
+		std::ifstream ifs(filename);
+		int value = 0;
+		return (ifs >> value) ? value : 0;
+	};
+
+	const int threadCount = Platform::getThreadCount();
+	for (int i = 0; i < threadCount; i++)
+	{
+		const std::string cpuPath = "/sys/devices/system/cpu/cpu" + std::to_string(i) + "/";
+		const int capacity = readValue(cpuPath + "cpu_capacity");
+		cores.push_back(std::make_pair(i, (capacity > 0) ?
+			capacity : readValue(cpuPath + "cpufreq/cpuinfo_max_freq")));
+	}
+#endif
+
+	if (cores.empty())
+	{
+		// No per-core information, so all cores are treated the same.
+		const int threadCount = Platform::getThreadCount();
+		for (int i = 0; i < threadCount; i++)
+		{
+			cores.push_back(std::make_pair(i, 0));
+		}
+	}
+
+	std::stable_sort(cores.begin(), cores.end(),
+		[](const std::pair<int, int> &a, const std::pair<int, int> &b)
+	{
+		return a.second > b.second;
+	});
+
+	std::vector<int> coreIndices(cores.size());
+	std::transform(cores.begin(), cores.end(), coreIndices.begin(),
+		[](const std::pair<int, int> &core) { return core.first; });
+
+	return coreIndices;
+}
+
+bool Platform::setCurrentThreadAffinity(const std::vector<int> &cores)
+{
+	if (cores.empty())
+	{
+		return false;
+	}
+
+#if defined(_WIN32)
+	DWORD_PTR mask = 0;
+	for (const int core : cores)
+	{
+		if ((core >= 0) && (core < static_cast<int>(sizeof(DWORD_PTR) * 8)))
+		{
+			mask |= static_cast<DWORD_PTR>(1) << core;
+		}
+	}
+
+	return (mask != 0) && (SetThreadAffinityMask(GetCurrentThread(), mask) != 0);
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	for (const int core : cores)
+	{
+		if ((core >= 0) && (core < CPU_SETSIZE))
+		{
+			CPU_SET(core, &cpuSet);
+		}
+	}
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+	// macOS only takes affinity hints between threads, not cores.
+	return false;
+#endif
+}
+
+bool Platform::raiseCurrentThreadPriority()
+{
+#if defined(_WIN32)
+	return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL) != 0;
+#elif defined(__linux__)
+	// Linux threads have their own nice value. Going below zero needs CAP_SYS_NICE or a
+	// raised RLIMIT_NICE.
+	const pid_t threadID = static_cast<pid_t>(syscall(SYS_gettid));
+	return setpriority(PRIO_PROCESS, static_cast<id_t>(threadID), -5) == 0;
+#elif defined(__APPLE__) && defined(__MACH__)
+	return pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#else
+	return false;
+#endif
+}
+
 bool Platform::directoryExists(const std::string &path)
 {
 #if defined(_WIN32)
@@ -2,11 +2,26 @@
 #define PLATFORM_H
 
 #include <string>
+#include <vector>
 
 // Static class for various platform-specific functions.
 
 class Platform
 {
+public:
+	// Instruction set extensions that kernels can have versions for. The x86 ones are in
+	// order of capability, and each one implies the ones before it.
+	enum class CpuIsa
+	{
+		Scalar,
+		SSE2,
+		SSE41,
+		AVX2,
+		AVX512,
+		NEON
+	};
+
+	static constexpr int CPU_ISA_COUNT = 6;
 private:
 	// Linux user environment variables. Data home is "~/.local/share" and config home is
 	// "~/.config". If getenv("XDG_...") is null, then try getenv("HOME") with the desired
@@ -42,12 +57,47 @@ public:
 	// Gets the screenshot folder path via SDL_GetPrefPath().
 	static std::string getScreenshotPath();
 
+	// Gets the cache folder path via SDL_GetPrefPath(), for the level cache and the unpacked
+	// executable.
+	static std::string getCachePath();
+
+	// Gets the save folder path via SDL_GetPrefPath(), for quicksaves. Arena's own saves are
+	// in the ArenaSavesPath option instead.
+	static std::string getSavePath();
+
 	// Gets the log folder path for logging program messages.
 	static std::string getLogPath();
 
 	// Gets the max number of threads available on the CPU.
 	static int getThreadCount();
 
+	// Returns whether the CPU and OS can run code using the given instruction set. Checked
+	// once, then cached.
+	static bool isCpuIsaSupported(Platform::CpuIsa isa);
+
+	// Gets the most capable instruction set the CPU supports.
+	static Platform::CpuIsa getBestCpuIsa();
+
+	// Gets the display name of an instruction set (i.e., "SSE4.1").
+	static const char *getCpuIsaName(Platform::CpuIsa isa);
+
+	// Gets the instruction set with the given name, ignoring case. Returns false if there
+	// isn't one.
+	static bool tryParseCpuIsa(const std::string &name, Platform::CpuIsa *outIsa);
+
+	// Gets the logical CPU indices sorted from the fastest class of core to the slowest
+	// (i.e., performance cores before efficiency cores). Cores of the same class keep their
+	// system order.
+	static std::vector<int> getCoresByPerformance();
+
+	// Restricts the calling thread to run only on the given logical CPUs. Returns whether
+	// the platform allowed it.
+	static bool setCurrentThreadAffinity(const std::vector<int> &cores);
+
+	// Raises the calling thread's scheduling priority above normal. Returns whether the
+	// platform allowed it (some need elevated privileges).
+	static bool raiseCurrentThreadPriority();
+
 	// Returns whether the given directory exists.
 	static bool directoryExists(const std::string &path);
 
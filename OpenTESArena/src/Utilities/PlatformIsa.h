@@ -0,0 +1,31 @@
+#ifndef PLATFORM_ISA_H
+#define PLATFORM_ISA_H
+
+// Instruction sets the build can compile kernel versions for, and their intrinsics headers.
+// Having a version compiled doesn't mean the CPU can run it, so kernels with these versions
+// go through KernelDispatch, which only selects ones the CPU supports (within CpuIsaLimit).
+
+// SSE2 is part of x86-64, and NEON with doubles is part of 64-bit ARM, so they need no build
+// flags. AVX2 versions are compiled per function with PLATFORM_TARGET_AVX2 instead of for the
+// whole file, so the rest of the build still runs on any x86-64 CPU.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PLATFORM_SSE2
+#include <emmintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PLATFORM_AVX2
+#define PLATFORM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+// MSVC allows any intrinsics in any function.
+#define PLATFORM_AVX2
+#define PLATFORM_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PLATFORM_NEON
+#include <arm_neon.h>
+#endif
+
+#endif
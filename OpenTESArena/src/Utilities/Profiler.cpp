@@ -0,0 +1,218 @@
+#include "Profiler.h"
+
+#if defined(TES_PROFILER)
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Debug.h"
+#include "String.h"
+
+namespace
+{
+	struct ZoneRecord
+	{
+		const char *name;
+		int64_t startNs, endNs; // Since the profiler started.
+	};
+
+	// One thread's recent zones. Only the owning thread writes them, and saving reads up to
+	// the published count. Saving while a thread is overwriting its oldest zones can give a
+	// torn zone at the start of that thread's timeline, which is fine for viewing.
+	struct ThreadRecords
+	{
+		static constexpr size_t CAPACITY = 16384;
+
+		std::array<ZoneRecord, CAPACITY> zones;
+		std::atomic<uint64_t> zoneCount;
+		std::string name;
+		int id;
+		std::atomic<bool> finished;
+
+		ThreadRecords(int id)
+			: zoneCount(0), id(id), finished(false) { }
+	};
+
+	// Threads that exited are dropped once there are more than this, so short-lived worker
+	// threads don't keep adding buffers.
+	const size_t MaxFinishedThreads = 16;
+
+	const Profiler::Clock::time_point StartTime = Profiler::Clock::now();
+
+	std::mutex RegistryMutex;
+	std::vector<std::shared_ptr<ThreadRecords>> Registry;
+	int NextThreadID = 1;
+
+	// Registers the thread on its first zone and marks it finished when the thread exits.
+	struct ThreadHandle
+	{
+		std::shared_ptr<ThreadRecords> records;
+
+		ThreadHandle()
+		{
+			std::lock_guard<std::mutex> lock(RegistryMutex);
+
+			size_t finishedCount = std::count_if(Registry.begin(), Registry.end(),
+				[](const std::shared_ptr<ThreadRecords> &records)
+			{
+				return records->finished.load();
+			});
+
+			for (auto iter = Registry.begin(); (iter != Registry.end()) &&
+				(finishedCount >= MaxFinishedThreads);)
+			{
+				if ((*iter)->finished.load())
+				{
+					iter = Registry.erase(iter);
+					finishedCount--;
+				}
+				else
+				{
+					++iter;
+				}
+			}
+
+			this->records = std::make_shared<ThreadRecords>(NextThreadID);
+			this->records->name = "Thread " + std::to_string(NextThreadID);
+			NextThreadID++;
+			Registry.push_back(this->records);
+		}
+
+		~ThreadHandle()
+		{
+			this->records->finished.store(true);
+		}
+	};
+
+	ThreadRecords &getThreadRecords()
+	{
+		thread_local ThreadHandle handle;
+		return *handle.records;
+	}
+
+	int64_t getNanoseconds(Profiler::Clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time - StartTime).count();
+	}
+
+	std::string escapeJson(const std::string &str)
+	{
+		std::string escaped;
+		for (const char c : str)
+		{
+			if ((c == '"') || (c == '\\'))
+			{
+				escaped += '\\';
+			}
+
+			escaped += c;
+		}
+
+		return escaped;
+	}
+}
+#endif
+
+Profiler::Zone::Zone(const char *name)
+{
+	this->name = name;
+#if defined(TES_PROFILER)
+	this->startTime = Clock::now();
+#endif
+}
+
+Profiler::Zone::~Zone()
+{
+#if defined(TES_PROFILER)
+	Profiler::recordZone(this->name, this->startTime, Clock::now());
+#endif
+}
+
+bool Profiler::isEnabled()
+{
+#if defined(TES_PROFILER)
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Profiler::recordZone(const char *name, Clock::time_point startTime,
+	Clock::time_point endTime)
+{
+#if defined(TES_PROFILER)
+	ThreadRecords &records = getThreadRecords();
+	const uint64_t zoneCount = records.zoneCount.load(std::memory_order_relaxed);
+	ZoneRecord &zone = records.zones[zoneCount % ThreadRecords::CAPACITY];
+	zone.name = name;
+	zone.startNs = getNanoseconds(startTime);
+	zone.endNs = getNanoseconds(endTime);
+	records.zoneCount.store(zoneCount + 1, std::memory_order_release);
+#endif
+}
+
+void Profiler::setThreadName(const std::string &name)
+{
+#if defined(TES_PROFILER)
+	ThreadRecords &records = getThreadRecords();
+	std::lock_guard<std::mutex> lock(RegistryMutex);
+	records.name = name;
+#endif
+}
+
+bool Profiler::save(const std::string &filename)
+{
+#if defined(TES_PROFILER)
+	std::ofstream ofs(filename);
+	if (!ofs.is_open())
+	{
+		DebugLogWarning("Could not open \"" + filename + "\" for writing the profile.");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(RegistryMutex);
+
+	// Complete ("X") events in microseconds, plus a metadata event naming each thread.
+	ofs << "{\"traceEvents\":[";
+	bool isFirstEvent = true;
+	auto beginEvent = [&ofs, &isFirstEvent]()
+	{
+		ofs << (isFirstEvent ? "\n" : ",\n");
+		isFirstEvent = false;
+	};
+
+	for (const std::shared_ptr<ThreadRecords> &records : Registry)
+	{
+		beginEvent();
+		ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << records->id <<
+			",\"args\":{\"name\":\"" << escapeJson(records->name) << "\"}}";
+
+		const uint64_t zoneCount = records->zoneCount.load(std::memory_order_acquire);
+		const uint64_t firstZone = (zoneCount > ThreadRecords::CAPACITY) ?
+			(zoneCount - ThreadRecords::CAPACITY) : 0;
+		for (uint64_t i = firstZone; i < zoneCount; i++)
+		{
+			const ZoneRecord &zone = records->zones[i % ThreadRecords::CAPACITY];
+			const int64_t durationNs = std::max<int64_t>(zone.endNs - zone.startNs, 0);
+
+			beginEvent();
+			ofs << "{\"name\":\"" << escapeJson(zone.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" <<
+				records->id << ",\"ts\":" <<
+				String::fixedPrecision(static_cast<double>(zone.startNs) / 1000.0, 3) <<
+				",\"dur\":" << String::fixedPrecision(static_cast<double>(durationNs) / 1000.0, 3) <<
+				"}";
+		}
+	}
+
+	ofs << "\n]}\n";
+	return true;
+#else
+	static_cast<void>(filename);
+	return false;
+#endif
+}
@@ -0,0 +1,58 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <string>
+
+// Records timed zones on each thread for viewing what every thread did over the last few
+// seconds as a timeline. Zones go in a fixed-size ring per thread, so recording never locks
+// or allocates and old zones are overwritten. Only compiled in when TES_PROFILER is defined;
+// otherwise ProfilerZone() is empty and the functions do nothing.
+
+class Profiler
+{
+public:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// Records the time from construction to destruction as a zone on the calling thread.
+	class Zone
+	{
+	private:
+		const char *name;
+		Clock::time_point startTime;
+	public:
+		Zone(const char *name);
+		Zone(const Zone&) = delete;
+		~Zone();
+
+		Zone &operator=(const Zone&) = delete;
+	};
+
+	Profiler() = delete;
+	~Profiler() = delete;
+
+	// Returns whether the profiler was compiled in.
+	static bool isEnabled();
+
+	// Records a zone on the calling thread, for code that already has its own start and end
+	// times. The name must outlive the profiler (i.e., a string literal).
+	static void recordZone(const char *name, Clock::time_point startTime,
+		Clock::time_point endTime);
+
+	// Sets the calling thread's name in saved traces.
+	static void setThreadName(const std::string &name);
+
+	// Writes every thread's recorded zones in the Chrome trace event format, for opening in
+	// chrome://tracing or Perfetto. Returns whether the file was written.
+	static bool save(const std::string &filename);
+};
+
+#if defined(TES_PROFILER)
+#define ProfilerConcatInner(a, b) a##b
+#define ProfilerConcat(a, b) ProfilerConcatInner(a, b)
+#define ProfilerZone(name) Profiler::Zone ProfilerConcat(profilerZone, __COUNTER__)(name)
+#else
+#define ProfilerZone(name) do { } while (false)
+#endif
+
+#endif
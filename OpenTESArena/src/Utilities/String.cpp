@@ -1,45 +1,23 @@
-#include <cctype>
-
 #include "String.h"
+#include "StringView.h"
 
 bool String::caseInsensitiveEquals(const std::string &a, const std::string &b)
 {
-	if (a.size() != b.size())
-	{
-		return false;
-	}
-
-	for (size_t i = 0; i < a.size(); i++)
-	{
-		if (std::tolower(a[i]) != std::tolower(b[i]))
-		{
-			return false;
-		}
-	}
-
-	return true;
+	return StringView::caseInsensitiveEquals(a, b);
 }
 
 std::vector<std::string> String::split(const std::string &str, char separator)
 {
-	std::vector<std::string> strings;
-
-	// Add an empty string to start off. If the given string is empty, then a
-	// vector with one empty string is returned.
-	strings.push_back(std::string());
+	// Find the pieces first so each string is made once at its final size. If the given
+	// string is empty, then a vector with one empty string is returned.
+	std::vector<std::string_view> views;
+	StringView::split(str, separator, views);
 
-	for (const char c : str)
+	std::vector<std::string> strings;
+	strings.reserve(views.size());
+	for (const std::string_view view : views)
 	{
-		if (c == separator)
-		{
-			// Start a new string.
-			strings.push_back(std::string());
-		}
-		else
-		{
-			// Put the character on the end of the current string.
-			strings.back().push_back(c);
-		}
+		strings.emplace_back(view);
 	}
 
 	return strings;
@@ -246,23 +224,35 @@ std::string String::replace(const std::string &str, const std::string &a,
 std::string String::toUppercase(const std::string &str)
 {
 	std::string newStr(str);
+	String::toUppercaseInPlace(newStr);
+	return newStr;
+}
 
-	for (char &c : newStr)
+void String::toUppercaseInPlace(std::string &str)
+{
+	for (char &c : str)
 	{
-		c = std::toupper(c);
+		if ((c >= 'a') && (c <= 'z'))
+		{
+			c -= 'a' - 'A';
+		}
 	}
-
-	return newStr;
 }
 
 std::string String::toLowercase(const std::string &str)
 {
 	std::string newStr(str);
+	String::toLowercaseInPlace(newStr);
+	return newStr;
+}
 
-	for (char &c : newStr)
+void String::toLowercaseInPlace(std::string &str)
+{
+	for (char &c : str)
 	{
-		c = std::tolower(c);
+		if ((c >= 'A') && (c <= 'Z'))
+		{
+			c += 'a' - 'A';
+		}
 	}
-
-	return newStr;
 }
@@ -23,6 +23,8 @@ public:
 	// Splits a string on whitespace.
 	static std::vector<std::string> split(const std::string &str);
 
+	// See StringView for splitting and trimming without making new strings.
+
 	// Removes all whitespace from a string.
 	static std::string trim(const std::string &str);
 
@@ -58,9 +60,11 @@ public:
 
 	// Converts each ASCII character in the given string to uppercase.
 	static std::string toUppercase(const std::string &str);
+	static void toUppercaseInPlace(std::string &str);
 
 	// Converts each ASCII character in the given string to lowercase.
 	static std::string toLowercase(const std::string &str);
+	static void toLowercaseInPlace(std::string &str);
 
 	// Converts an integral value to a hex string.
 	template <typename T>
@@ -1,3 +1,5 @@
+#include <cctype>
+
 #include "StringView.h"
 
 std::string_view StringView::substr(const std::string_view &str, size_t offset, size_t count)
@@ -8,28 +10,7 @@ std::string_view StringView::substr(const std::string_view &str, size_t offset,
 std::vector<std::string_view> StringView::split(const std::string_view &str, char separator)
 {
 	std::vector<std::string_view> strings;
-
-	// Add an empty string view to start off. If the given string view is empty, then a
-	// vector with one empty string view is returned.
-	strings.push_back(std::string_view(str.data(), 0));
-
-	for (size_t i = 0; i < str.size(); i++)
-	{
-		const char c = str[i];
-
-		if (c == separator)
-		{
-			// Start a new string.
-			strings.push_back(std::string_view(str.data() + i + 1, 0));
-		}
-		else
-		{
-			// Put the character on the end of the current string.
-			std::string_view old = strings.back();
-			strings.back() = std::string_view(old.data(), old.size() + 1);
-		}
-	}
-
+	StringView::split(str, separator, strings);
 	return strings;
 }
 
@@ -45,7 +26,7 @@ std::string_view StringView::trimFront(const std::string_view &str)
 
 	std::string_view trimmed(str);
 
-	while ((trimmed.front() == space) || (trimmed.front() == tab))
+	while (!trimmed.empty() && ((trimmed.front() == space) || (trimmed.front() == tab)))
 	{
 		trimmed.remove_prefix(1);
 	}
@@ -60,7 +41,7 @@ std::string_view StringView::trimBack(const std::string_view &str)
 
 	std::string_view trimmed(str);
 
-	while ((trimmed.back() == space) || (trimmed.back() == tab))
+	while (!trimmed.empty() && ((trimmed.back() == space) || (trimmed.back() == tab)))
 	{
 		trimmed.remove_suffix(1);
 	}
@@ -68,6 +49,50 @@ std::string_view StringView::trimBack(const std::string_view &str)
 	return trimmed;
 }
 
+void StringView::split(const std::string_view &str, char separator,
+	std::vector<std::string_view> &dst)
+{
+	dst.clear();
+
+	// If the given string view is empty, then there is one empty string view.
+	size_t start = 0;
+	while (true)
+	{
+		const size_t end = std::min(str.find(separator, start), str.size());
+		dst.push_back(std::string_view(str.data() + start, end - start));
+
+		if (end == str.size())
+		{
+			return;
+		}
+
+		start = end + 1;
+	}
+}
+
+std::string_view StringView::trimEnds(const std::string_view &str)
+{
+	return StringView::trimFront(StringView::trimBack(str));
+}
+
+bool StringView::caseInsensitiveEquals(const std::string_view &a, const std::string_view &b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (std::tolower(a[i]) != std::tolower(b[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 std::string_view StringView::getExtension(const std::string_view &str)
 {
 	const size_t dotPos = str.rfind('.');
@@ -1,6 +1,8 @@
 #ifndef STRING_VIEW_H
 #define STRING_VIEW_H
 
+#include <algorithm>
+#include <array>
 #include <string_view>
 #include <vector>
 
@@ -20,12 +22,50 @@ public:
 	// Splits a string view on whitespace.
 	static std::vector<std::string_view> split(const std::string_view &str);
 
+	// Same as split() but into the given vector, which is cleared first. Reusing one vector
+	// for many strings only allocates when there are more pieces than ever before.
+	static void split(const std::string_view &str, char separator,
+		std::vector<std::string_view> &dst);
+
+	// Same as split() but into a fixed-size array, so nothing is allocated. Returns the number
+	// of pieces, which can be more than the array holds (those aren't written).
+	template <size_t N>
+	static size_t split(const std::string_view &str, char separator,
+		std::array<std::string_view, N> &dst)
+	{
+		size_t count = 0;
+		size_t start = 0;
+		while (true)
+		{
+			const size_t end = std::min(str.find(separator, start), str.size());
+			if (count < N)
+			{
+				dst[count] = str.substr(start, end - start);
+			}
+
+			count++;
+
+			if (end == str.size())
+			{
+				return count;
+			}
+
+			start = end + 1;
+		}
+	}
+
 	// Removes leading whitespace from a string view.
 	static std::string_view trimFront(const std::string_view &str);
 
 	// Removes trailing whitespace from a string view.
 	static std::string_view trimBack(const std::string_view &str);
 
+	// Removes leading and trailing whitespace from a string view.
+	static std::string_view trimEnds(const std::string_view &str);
+
+	// Performs a case-insensitive ASCII comparison.
+	static bool caseInsensitiveEquals(const std::string_view &a, const std::string_view &b);
+
 	// Gets the right-most extension from a string view, i.e., "txt".
 	static std::string_view getExtension(const std::string_view &str);
 };
@@ -0,0 +1,262 @@
+#include <chrono>
+#include <string>
+
+#include "Automap.h"
+#include "VoxelData.h"
+#include "VoxelDataType.h"
+#include "VoxelGrid.h"
+#include "../Media/Color.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
+
+namespace
+{
+	// Colors for automap pixels. Ground pixels (y == 0) are transparent.
+	const Color AutomapFloor(0, 0, 0, 0);
+	const Color AutomapWall(130, 89, 48);
+	const Color AutomapRaised(97, 85, 60);
+	const Color AutomapDoor(146, 0, 0);
+	const Color AutomapLevelUp(0, 105, 0);
+	const Color AutomapLevelDown(0, 0, 255);
+	const Color AutomapDryChasm(20, 40, 40);
+	const Color AutomapWetChasm(109, 138, 174);
+	const Color AutomapLavaChasm(255, 0, 0);
+	const Color AutomapNotImplemented(255, 0, 255);
+}
+
+Automap::Automap()
+{
+	this->changeCount = 0;
+	this->width = 0;
+	this->depth = 0;
+}
+
+uint32_t Automap::getColor(const VoxelGrid &voxelGrid, int x, int z)
+{
+	const VoxelData &floorData = voxelGrid.getVoxelData(voxelGrid.getVoxel(x, 0, z));
+	const VoxelData &wallData = voxelGrid.getVoxelData(voxelGrid.getVoxel(x, 1, z));
+	return Automap::getPixelColor(floorData, wallData);
+}
+
+uint32_t Automap::getPixelColor(const VoxelData &floorData, const VoxelData &wallData)
+{
+	const VoxelDataType floorDataType = floorData.dataType;
+	const VoxelDataType wallDataType = wallData.dataType;
+
+	if (floorDataType == VoxelDataType::Chasm)
+	{
+		const VoxelData::ChasmData::Type chasmType = floorData.chasm.type;
+
+		if (chasmType == VoxelData::ChasmData::Type::Dry)
+		{
+			// Dry chasms are a different color if a wall is over them.
+			return ((wallDataType == VoxelDataType::Wall) ? AutomapRaised : AutomapDryChasm).toARGB();
+		}
+		else if (chasmType == VoxelData::ChasmData::Type::Lava)
+		{
+			// Lava chasms ignore all but raised platforms.
+			return ((wallDataType == VoxelDataType::Raised) ? AutomapRaised : AutomapLavaChasm).toARGB();
+		}
+		else if (chasmType == VoxelData::ChasmData::Type::Wet)
+		{
+			// Water chasms ignore all but raised platforms.
+			return ((wallDataType == VoxelDataType::Raised) ? AutomapRaised : AutomapWetChasm).toARGB();
+		}
+		else
+		{
+			DebugLogWarning("Unrecognized chasm type \"" +
+				std::to_string(static_cast<int>(chasmType)) + "\".");
+			return AutomapNotImplemented.toARGB();
+		}
+	}
+	else if (floorDataType == VoxelDataType::Floor)
+	{
+		// If nothing is over the floor, return transparent. Otherwise, choose from
+		// a number of cases.
+		if (wallDataType == VoxelDataType::None)
+		{
+			return AutomapFloor.toARGB();
+		}
+		else if (wallDataType == VoxelDataType::Wall)
+		{
+			const VoxelData::WallData::Type wallType = wallData.wall.type;
+
+			if (wallType == VoxelData::WallData::Type::Solid)
+			{
+				return AutomapWall.toARGB();
+			}
+			else if (wallType == VoxelData::WallData::Type::LevelUp)
+			{
+				return AutomapLevelUp.toARGB();
+			}
+			else if (wallType == VoxelData::WallData::Type::LevelDown)
+			{
+				return AutomapLevelDown.toARGB();
+			}
+			else if (wallType == VoxelData::WallData::Type::Menu)
+			{
+				// Menu blocks are the same color as doors.
+				return AutomapDoor.toARGB();
+			}
+			else
+			{
+				DebugLogWarning("Unrecognized wall type \"" +
+					std::to_string(static_cast<int>(wallType)) + "\".");
+				return AutomapNotImplemented.toARGB();
+			}
+		}
+		else if (wallDataType == VoxelDataType::Raised)
+		{
+			return AutomapRaised.toARGB();
+		}
+		else if (wallDataType == VoxelDataType::Diagonal)
+		{
+			return AutomapFloor.toARGB();
+		}
+		else if (wallDataType == VoxelDataType::Door)
+		{
+			return AutomapDoor.toARGB();
+		}
+		else if (wallDataType == VoxelDataType::TransparentWall)
+		{
+			// Transparent walls with collision (hedges) are shown, while
+			// ones without collision (archways) are not.
+			const VoxelData::TransparentWallData &transparentWallData = wallData.transparentWall;
+			return (transparentWallData.collider ? AutomapWall : AutomapFloor).toARGB();
+		}
+		else if (wallDataType == VoxelDataType::Edge)
+		{
+			return AutomapWall.toARGB();
+		}
+		else
+		{
+			DebugLogWarning("Unrecognized wall data type \"" +
+				std::to_string(static_cast<int>(wallDataType)) + "\".");
+			return AutomapNotImplemented.toARGB();
+		}
+	}
+	else
+	{
+		DebugLogWarning("Unrecognized floor data type \"" +
+			std::to_string(static_cast<int>(floorDataType)) + "\".");
+		return AutomapNotImplemented.toARGB();
+	}
+}
+
+int Automap::getWidth() const
+{
+	return this->width;
+}
+
+int Automap::getDepth() const
+{
+	return this->depth;
+}
+
+const std::vector<uint32_t> &Automap::getColors() const
+{
+	return this->colors;
+}
+
+bool Automap::isReady()
+{
+	if (this->pendingColors.valid())
+	{
+		if (this->pendingColors.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return false;
+		}
+
+		this->colors = this->pendingColors.get();
+	}
+
+	return !this->colors.empty();
+}
+
+void Automap::update(const VoxelGrid &voxelGrid)
+{
+	if (this->pendingColors.valid())
+	{
+		return;
+	}
+
+	// If more voxels were set than the grid keeps track of, every column is recolored.
+	const Int3 *changedVoxels = nullptr;
+	int changedVoxelCount = 0;
+	if (!this->colors.empty() &&
+		!voxelGrid.getChangedVoxels(this->changeCount, &changedVoxels, &changedVoxelCount))
+	{
+		this->colors.clear();
+	}
+
+	if (this->colors.empty())
+	{
+		this->width = voxelGrid.getWidth();
+		this->depth = voxelGrid.getDepth();
+		this->dirtyFlags = std::vector<bool>(this->width * this->depth, false);
+		this->dirtyColumns.clear();
+		this->changeCount = voxelGrid.getChangeCount();
+
+		this->pendingColors = JobSystem::submit(JobSystem::Priority::Background, [&voxelGrid]()
+		{
+			const int width = voxelGrid.getWidth();
+			const int depth = voxelGrid.getDepth();
+			std::vector<uint32_t> colors(width * depth);
+
+			for (int z = 0; z < depth; z++)
+			{
+				for (int x = 0; x < width; x++)
+				{
+					colors[x + (z * width)] = Automap::getColor(voxelGrid, x, z);
+				}
+			}
+
+			return colors;
+		});
+
+		return;
+	}
+
+	DebugAssert(voxelGrid.getWidth() == this->width);
+	DebugAssert(voxelGrid.getDepth() == this->depth);
+
+	// Only the floor and main floor voxels are shown.
+	for (int i = 0; i < changedVoxelCount; i++)
+	{
+		const Int3 &voxel = changedVoxels[i];
+		if (voxel.y <= 1)
+		{
+			this->setDirty(voxel.x, voxel.z);
+		}
+	}
+
+	this->changeCount = voxelGrid.getChangeCount();
+
+	for (const int index : this->dirtyColumns)
+	{
+		const int x = index % this->width;
+		const int z = index / this->width;
+		this->colors[index] = Automap::getColor(voxelGrid, x, z);
+		this->dirtyFlags[index] = false;
+	}
+
+	this->dirtyColumns.clear();
+}
+
+void Automap::wait()
+{
+	if (this->pendingColors.valid())
+	{
+		this->colors = this->pendingColors.get();
+	}
+}
+
+void Automap::setDirty(int x, int z)
+{
+	const int index = x + (z * this->width);
+	if (!this->dirtyFlags[index])
+	{
+		this->dirtyFlags[index] = true;
+		this->dirtyColumns.push_back(index);
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef AUTOMAP_H
+#define AUTOMAP_H
+
+#include <cstdint>
+#include <future>
+#include <vector>
+
+// A level's automap image, kept for as long as the level is so opening the automap doesn't
+// walk the whole voxel grid again. It has one color per XZ column and is generated from the
+// voxel grid on a worker thread the first time it's needed. After that, only columns whose
+// floor or wall voxel was set since (i.e., wilderness chunks coming back into the grid) are
+// recolored the next time it's used, going by the voxel grid's list of set voxels.
+
+// The worker only reads the voxel grid, so the grid must not change until the image is ready.
+// The automap panel waits for it before going back to the game world.
+
+class VoxelData;
+class VoxelGrid;
+
+class Automap
+{
+private:
+	std::vector<uint32_t> colors; // ARGB color of each XZ column, x + (z * width).
+	std::vector<int> dirtyColumns; // Indices of columns to recolor.
+	std::vector<bool> dirtyFlags; // Whether each column is in the dirty list.
+	std::future<std::vector<uint32_t>> pendingColors;
+	uint32_t changeCount; // Voxel grid change count the colors are up to date with.
+	int width, depth;
+
+	// Marks a column to be recolored.
+	void setDirty(int x, int z);
+
+	// Gets the color of an XZ column from its floor and wall voxels.
+	static uint32_t getColor(const VoxelGrid &voxelGrid, int x, int z);
+public:
+	Automap();
+
+	// Gets the display color for a pixel on the automap, given its associated floor
+	// and wall voxel data definitions.
+	static uint32_t getPixelColor(const VoxelData &floorData, const VoxelData &wallData);
+
+	int getWidth() const;
+	int getDepth() const;
+
+	// Gets the color of each XZ column. Only valid once the image is ready.
+	const std::vector<uint32_t> &getColors() const;
+
+	// Returns whether the image is generated and up to date with the last update() call.
+	bool isReady();
+
+	// Starts generating the image on a worker thread if it hasn't been generated yet,
+	// otherwise recolors the columns that changed since the last update.
+	void update(const VoxelGrid &voxelGrid);
+
+	// Blocks until the worker generating the image is done, if there is one.
+	void wait();
+};
+
+#endif
@@ -1,26 +1,38 @@
 #include <algorithm>
 
 #include "Chunk.h"
+#include "VoxelDataRegistry.h"
 #include "../Utilities/Debug.h"
 
-Chunk::Chunk(int x, int y, int height)
+Chunk::Chunk(int x, int y, int height, VoxelDataRegistry &voxelDataRegistry)
+	: voxelDataRegistry(voxelDataRegistry)
 {
 	// Set all voxels to air and unused.
 	const int voxelCount = Chunk::WIDTH * height * Chunk::DEPTH;
 	this->voxels = std::make_unique<VoxelID[]>(voxelCount);
 	std::fill(this->voxels.get(), this->voxels.get() + voxelCount, 0);
 
-	this->voxelData.fill(VoxelData());
-	this->activeVoxelData.fill(false);
+	this->voxelDataIDs.fill(Chunk::NO_VOXEL_DATA);
 
 	// Let the first voxel data (air) be usable immediately. All default voxel IDs can safely point to it.
-	this->activeVoxelData.front() = true;
+	this->voxelDataIDs.front() = this->voxelDataRegistry.acquire(VoxelData());
 
 	this->height = height;
 	this->x = x;
 	this->y = y;
 }
 
+Chunk::~Chunk()
+{
+	for (const uint16_t id : this->voxelDataIDs)
+	{
+		if (id != Chunk::NO_VOXEL_DATA)
+		{
+			this->voxelDataRegistry.release(id);
+		}
+	}
+}
+
 int Chunk::getX() const
 {
 	return this->x;
@@ -55,8 +67,8 @@ bool Chunk::coordIsValid(int x, int y, int z) const
 
 int Chunk::getIndex(int x, int y, int z) const
 {
-	DebugAssert(this->coordIsValid(x, y, z));
-	return x + (y * this->getWidth()) + (z * this->getWidth() * this->getHeight());
+	DebugValidate(this->coordIsValid(x, y, z));
+	return x + (z * Chunk::WIDTH) + (y * Chunk::WIDTH * Chunk::DEPTH);
 }
 
 VoxelID Chunk::get(int x, int y, int z) const
@@ -67,40 +79,55 @@ VoxelID Chunk::get(int x, int y, int z) const
 
 const VoxelData &Chunk::getVoxelData(VoxelID id) const
 {
-	DebugAssert(id < this->voxelData.size());
-	DebugAssert(this->activeVoxelData[id]);
-	return this->voxelData[id];
+	DebugValidate(id < this->voxelDataIDs.size());
+	DebugValidate(this->voxelDataIDs[id] != Chunk::NO_VOXEL_DATA);
+	return this->voxelDataRegistry.get(this->voxelDataIDs[id]);
 }
 
 int Chunk::debug_getVoxelDataCount() const
 {
-	return static_cast<int>(
-		std::count(this->activeVoxelData.begin(), this->activeVoxelData.end(), true));
+	return static_cast<int>(this->voxelDataIDs.size() - std::count(
+		this->voxelDataIDs.begin(), this->voxelDataIDs.end(), Chunk::NO_VOXEL_DATA));
 }
 
 void Chunk::set(int x, int y, int z, VoxelID value)
 {
 	const int index = this->getIndex(x, y, z);
 	this->voxels[index] = value;
+	this->dirtyVoxels.push_back(Int3(x, y, z));
+}
+
+const std::vector<Int3> &Chunk::getDirtyVoxels() const
+{
+	return this->dirtyVoxels;
+}
+
+void Chunk::clearDirtyVoxels()
+{
+	this->dirtyVoxels.clear();
 }
 
 VoxelID Chunk::addVoxelData(VoxelData &&voxelData)
 {
 	// Find a place to add the voxel data.
-	const auto iter = std::find(this->activeVoxelData.begin(), this->activeVoxelData.end(), false);
+	const auto iter = std::find(this->voxelDataIDs.begin(), this->voxelDataIDs.end(),
+		Chunk::NO_VOXEL_DATA);
 
 	// If we ever hit this, we need more bits per voxel.
-	DebugAssert(iter != this->activeVoxelData.end());
+	DebugAssert(iter != this->voxelDataIDs.end());
 
-	const VoxelID id = static_cast<VoxelID>(std::distance(this->activeVoxelData.begin(), iter));
-	this->voxelData[id] = std::move(voxelData);
-	this->activeVoxelData[id] = true;
+	const VoxelID id = static_cast<VoxelID>(std::distance(this->voxelDataIDs.begin(), iter));
+	*iter = this->voxelDataRegistry.acquire(voxelData);
 	return id;
 }
 
 void Chunk::removeVoxelData(VoxelID id)
 {
-	DebugAssert(id < this->voxelData.size());
-	this->voxelData[id] = VoxelData();
-	this->activeVoxelData[id] = false;
+	DebugAssert(id < this->voxelDataIDs.size());
+	uint16_t &registryID = this->voxelDataIDs[id];
+	if (registryID != Chunk::NO_VOXEL_DATA)
+	{
+		this->voxelDataRegistry.release(registryID);
+		registryID = Chunk::NO_VOXEL_DATA;
+	}
 }
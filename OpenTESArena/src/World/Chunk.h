@@ -4,26 +4,40 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "VoxelData.h"
+#include "../Math/Vector3.h"
+
+class VoxelDataRegistry;
 
 // There should be fewer than 256 unique voxel types per chunk. If we need more, then the data
 // can be redesigned to be something like 9 bits per voxel (and the ID type would be 16-bit).
 using VoxelID = uint8_t;
 
 // A chunk is a 3D set of voxels for each part of the world, for both interiors and exteriors.
+// Its voxel data definitions are kept in a registry shared by the level's chunks.
 class Chunk
 {
 private:
 	static constexpr int MAX_VOXEL_DATA = 256;
 
-	// Indices into voxel data.
+	// Registry ID of an unused voxel ID.
+	static constexpr uint16_t NO_VOXEL_DATA = 0xFFFF;
+
+	// Indices into voxel data. Each Y layer is a contiguous WIDTH x DEPTH slice, so finding a
+	// voxel only takes shifts by the constant width and depth, and a whole floor or ceiling
+	// can be read or written in one pass.
 	std::unique_ptr<VoxelID[]> voxels;
 
-	// Voxel data definitions, pointed to by voxel IDs. If the associated bool is true,
-	// the voxel data is in use by the voxel grid.
-	std::array<VoxelData, MAX_VOXEL_DATA> voxelData;
-	std::array<bool, MAX_VOXEL_DATA> activeVoxelData;
+	// Registry IDs of the voxel data definitions pointed to by voxel IDs, or NO_VOXEL_DATA
+	// if the voxel ID isn't in use.
+	std::array<uint16_t, MAX_VOXEL_DATA> voxelDataIDs;
+	VoxelDataRegistry &voxelDataRegistry;
+
+	// Voxels set since the dirty list was last cleared, in the order they were set, so caches
+	// built from the chunk can update from just those.
+	std::vector<Int3> dirtyVoxels;
 
 	// Chunk height. Depends on whether it's an interior or exterior.
 	int height;
@@ -31,7 +45,7 @@ private:
 	// Chunk coordinates.
 	int x, y;
 protected:
-	Chunk(int x, int y, int height);
+	Chunk(int x, int y, int height, VoxelDataRegistry &voxelDataRegistry);
 private:
 	bool coordIsValid(int x, int y, int z) const;
 	int getIndex(int x, int y, int z) const;
@@ -40,6 +54,12 @@ public:
 	static constexpr int WIDTH = 64;
 	static constexpr int DEPTH = WIDTH;
 
+	// Chunks hold references into the registry, so they aren't copied.
+	Chunk(const Chunk&) = delete;
+	virtual ~Chunk();
+
+	Chunk &operator=(const Chunk&) = delete;
+
 	int getX() const;
 	int getY() const;
 	constexpr int getWidth() const;
@@ -58,25 +78,36 @@ public:
 	// Sets the voxel at the given coordinate.
 	void set(int x, int y, int z, VoxelID id);
 
-	// Adds a voxel data definition and returns its assigned ID.
+	// Gets the voxels set since the dirty list was last cleared. A voxel is in it again each
+	// time it's set. The chunk's owner clears it once per frame after its caches are updated.
+	const std::vector<Int3> &getDirtyVoxels() const;
+	void clearDirtyVoxels();
+
+	// Adds a voxel data definition and returns its assigned ID. Identical definitions in
+	// other chunks share the same registry entry.
 	VoxelID addVoxelData(VoxelData &&voxelData);
 
 	// Removes a voxel data definition so its corresponding voxel ID can be reused.
 	void removeVoxelData(VoxelID id);
 };
 
-// Interior chunks are always three voxels high (ground, main floor, ceiling).
-class InteriorChunk final : public Chunk
+// Chunk with a height known at compile time. The voxel index math doesn't depend on height
+// either way, since layers are stored one after another, but the height is there for bulk
+// operations that want it as a constant.
+template <int Height>
+class FixedHeightChunk final : public Chunk
 {
 public:
-	InteriorChunk(int x, int y) : Chunk(x, y, 3) { }
+	static constexpr int HEIGHT = Height;
+
+	FixedHeightChunk(int x, int y, VoxelDataRegistry &voxelDataRegistry)
+		: Chunk(x, y, Height, voxelDataRegistry) { }
 };
 
+// Interior chunks are always three voxels high (ground, main floor, ceiling).
+using InteriorChunk = FixedHeightChunk<3>;
+
 // Exteriors are higher to allow for tall buildings.
-class ExteriorChunk final : public Chunk
-{
-public:
-	ExteriorChunk(int x, int y) : Chunk(x, y, 6) { }
-};
+using ExteriorChunk = FixedHeightChunk<6>;
 
 #endif
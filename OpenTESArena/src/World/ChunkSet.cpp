@@ -4,32 +4,16 @@
 
 ChunkSet::ChunkSet(bool exterior, bool wrap)
 {
+	this->width = 0;
+	this->height = 0;
 	this->exterior = exterior;
 	this->wrap = wrap;
 }
 
-auto ChunkSet::getIter(int x, int y)
-{
-	return std::find_if(this->chunks.begin(), this->chunks.end(),
-		[x, y](const std::unique_ptr<Chunk> &chunk)
-	{
-		return (chunk->getX() == x) && (chunk->getY() == y);
-	});
-}
-
-auto ChunkSet::getIter(int x, int y) const
-{
-	return std::find_if(this->chunks.begin(), this->chunks.end(),
-		[x, y](const std::unique_ptr<Chunk> &chunk)
-	{
-		return (chunk->getX() == x) && (chunk->getY() == y);
-	});
-}
-
 Chunk *ChunkSet::getPtr(int x, int y) const
 {
-	const auto iter = this->getIter(x, y);
-	return (iter != this->chunks.end()) ? iter->get() : nullptr;
+	const auto iter = this->indices.find(Int2(x, y));
+	return (iter != this->indices.end()) ? this->chunks[iter->second].get() : nullptr;
 }
 
 Chunk *ChunkSet::getInternal(int x, int y) const
@@ -72,44 +56,38 @@ Chunk *ChunkSet::getRelativeInternal(int srcX, int srcY, int srcVoxelX, int srcV
 
 int ChunkSet::getWidth() const
 {
-	// Find min and max X chunk coordinates.
-	const auto iters = std::minmax_element(this->chunks.begin(), this->chunks.end(),
-		[](const std::unique_ptr<Chunk> &a, const std::unique_ptr<Chunk> &b)
-	{
-		return a->getX() < b->getX();
-	});
-
-	if (iters.first != this->chunks.end())
-	{
-		const int minX = (*iters.first)->getX();
-		const int maxX = (*iters.second)->getX();
-		return maxX - minX;
-	}
-	else
-	{
-		return 0;
-	}
+	return this->width;
 }
 
 int ChunkSet::getHeight() const
 {
-	// Find min and max Y chunk coordinates.
-	const auto iters = std::minmax_element(this->chunks.begin(), this->chunks.end(),
-		[](const std::unique_ptr<Chunk> &a, const std::unique_ptr<Chunk> &b)
-	{
-		return a->getY() < b->getY();
-	});
+	return this->height;
+}
 
-	if (iters.first != this->chunks.end())
+void ChunkSet::updateDimensions()
+{
+	if (this->chunks.empty())
 	{
-		const int minY = (*iters.first)->getY();
-		const int maxY = (*iters.second)->getY();
-		return maxY - minY;
+		this->width = 0;
+		this->height = 0;
+		return;
 	}
-	else
+
+	// Find min and max chunk coordinates.
+	int minX = this->chunks.front()->getX();
+	int maxX = minX;
+	int minY = this->chunks.front()->getY();
+	int maxY = minY;
+	for (const auto &chunk : this->chunks)
 	{
-		return 0;
+		minX = std::min(minX, chunk->getX());
+		maxX = std::max(maxX, chunk->getX());
+		minY = std::min(minY, chunk->getY());
+		maxY = std::max(maxY, chunk->getY());
 	}
+
+	this->width = maxX - minX;
+	this->height = maxY - minY;
 }
 
 void ChunkSet::getWrappedCoords(int x, int y, int &dstX, int &dstY) const
@@ -121,6 +99,11 @@ void ChunkSet::getWrappedCoords(int x, int y, int &dstX, int &dstY) const
 	dstY = y % this->getHeight();
 }
 
+const VoxelDataRegistry &ChunkSet::getVoxelDataRegistry() const
+{
+	return this->voxelDataRegistry;
+}
+
 int ChunkSet::getCount() const
 {
 	return static_cast<int>(this->chunks.size());
@@ -162,40 +145,55 @@ Chunk &ChunkSet::insert(int x, int y)
 	{
 		if (this->exterior)
 		{
-			return std::make_unique<ExteriorChunk>(x, y);
+			return std::make_unique<ExteriorChunk>(x, y, this->voxelDataRegistry);
 		}
 		else
 		{
-			return std::make_unique<InteriorChunk>(x, y);
+			return std::make_unique<InteriorChunk>(x, y, this->voxelDataRegistry);
 		}
 	};
 
-	const auto iter = this->getIter(x, y);
-
 	// Add if it doesn't exist, overwrite if it does.
-	const bool exists = iter != this->chunks.end();
+	const auto iter = this->indices.find(Int2(x, y));
+	const bool exists = iter != this->indices.end();
 
 	if (exists)
 	{
-		*iter = makeChunk(x, y);
-		return *iter->get();
+		std::unique_ptr<Chunk> &chunk = this->chunks[iter->second];
+		chunk = makeChunk(x, y);
+		return *chunk.get();
 	}
 	else
 	{
+		this->indices.insert(std::make_pair(Int2(x, y), static_cast<int>(this->chunks.size())));
 		this->chunks.push_back(makeChunk(x, y));
+		this->updateDimensions();
 		return *this->chunks.back().get();
 	}
 }
 
 void ChunkSet::remove(int x, int y)
 {
-	const auto iter = this->getIter(x, y);
+	const auto iter = this->indices.find(Int2(x, y));
 
 	// Remove if the chunk exists.
-	const bool exists = iter != this->chunks.end();
+	const bool exists = iter != this->indices.end();
 
 	if (exists)
 	{
-		this->chunks.erase(iter);
+		// Move the last chunk into the removed chunk's place.
+		const int index = iter->second;
+		const int lastIndex = static_cast<int>(this->chunks.size()) - 1;
+		this->indices.erase(iter);
+
+		if (index != lastIndex)
+		{
+			this->chunks[index] = std::move(this->chunks[lastIndex]);
+			const Chunk &chunk = *this->chunks[index].get();
+			this->indices[Int2(chunk.getX(), chunk.getY())] = index;
+		}
+
+		this->chunks.pop_back();
+		this->updateDimensions();
 	}
 }
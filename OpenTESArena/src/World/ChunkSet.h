@@ -2,9 +2,12 @@
 #define CHUNK_SET_H
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "Chunk.h"
+#include "VoxelDataRegistry.h"
+#include "../Math/Vector2.h"
 
 // Dynamic group of all active chunks. Chunks are added and removed by a caller as needed.
 // This only stores the voxels in each chunk, not the entities.
@@ -16,15 +19,19 @@
 class ChunkSet
 {
 private:
+	// Voxel data definitions shared by the chunks. Declared first so it outlives them.
+	VoxelDataRegistry voxelDataRegistry;
+
 	std::vector<std::unique_ptr<Chunk>> chunks;
+
+	// Index of each chunk in the list by its coordinates, so lookups (once per chunk a voxel
+	// access crosses into) are constant time.
+	std::unordered_map<Int2, int> indices;
+
+	int width, height; // Dimensions in chunks, updated when chunks are added or removed.
 	bool exterior; // True if exterior, false if interior. Determines chunk allocation.
 	bool wrap; // Determines whether out-of-bounds coordinates are wrapped.
 
-	// Convenience function for getting an iterator to a chunk if it exists, or the end of the
-	// chunks list if it doesn't.
-	auto getIter(int x, int y);
-	auto getIter(int x, int y) const;
-
 	// Convenience function for getting a pointer to a chunk if it exists, or null if it doesn't.
 	Chunk *getPtr(int x, int y) const;
 
@@ -40,12 +47,21 @@ private:
 	int getWidth() const;
 	int getHeight() const;
 
+	// Recalculates the dimensions from the chunks' coordinates.
+	void updateDimensions();
+
 	// Gets the wrapped chunk coordinates for the input coordinates. Interiors and cities have
 	// their coordinates wrapped when accessing out-of-level voxels.
 	void getWrappedCoords(int x, int y, int &dstX, int &dstY) const;
 public:
 	ChunkSet(bool exterior, bool wrap);
 
+	// Chunks point to the set's voxel data registry, so the set isn't copied or moved.
+	ChunkSet(const ChunkSet&) = delete;
+	ChunkSet &operator=(const ChunkSet&) = delete;
+
+	const VoxelDataRegistry &getVoxelDataRegistry() const;
+
 	// Returns number of chunks in the set.
 	int getCount() const;
 
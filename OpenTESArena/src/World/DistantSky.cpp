@@ -1,5 +1,8 @@
 #include <algorithm>
 #include <array>
+#include <deque>
+#include <future>
+#include <iterator>
 
 #include "ClimateType.h"
 #include "DistantSky.h"
@@ -18,6 +21,7 @@
 #include "../Media/TextureManager.h"
 #include "../Rendering/Surface.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
 #include "../Utilities/String.h"
 
 namespace
@@ -46,6 +50,217 @@ namespace
 			{ ClimateType::Mountain, DistantMountainTraits(0, 6, 11, 2) }
 		}
 	};
+
+	// Everything a distant sky is generated from.
+	struct DistantSkyKey
+	{
+		int localCityID, provinceID, currentDay, starCount;
+		WeatherType weatherType;
+		bool classicStarSequence;
+
+		bool operator==(const DistantSkyKey &other) const
+		{
+			return (this->localCityID == other.localCityID) &&
+				(this->provinceID == other.provinceID) && (this->currentDay == other.currentDay) &&
+				(this->starCount == other.starCount) && (this->weatherType == other.weatherType) &&
+				(this->classicStarSequence == other.classicStarSequence);
+		}
+	};
+
+	// Stars as the original game generates them, before converting to directions.
+	struct SubStar
+	{
+		int8_t dx, dy;
+		uint8_t color;
+	};
+
+	struct Star
+	{
+		int16_t x, y, z;
+		std::vector<SubStar> subList;
+		int8_t type;
+	};
+
+	const int8_t NO_STAR_TYPE = -1;
+
+	// The original game's star seed. Every sky has the same stars.
+	const uint32_t StarSeed = 0x12345679;
+
+	// Stars generated and converted per job. The classic star count fits in one chunk, so
+	// the first chunk is always the original sequence.
+	const int StarsPerChunk = 512;
+
+	// Generates stars from the random generator's current state. Large stars 5 to 7 are
+	// planets, and each one only appears once among the stars sharing the planets array. If
+	// planets aren't allowed, those values are rolled again.
+	void generateStars(int count, bool allowPlanets, ArenaRandom &random,
+		std::array<bool, 3> &planets, std::vector<Star> &stars)
+	{
+		auto getRndCoord = [&random]()
+		{
+			const int16_t d = (0x800 + random.next()) & 0x0FFF;
+			return ((d & 2) == 0) ? d : -d;
+		};
+
+		for (int i = 0; i < count; i++)
+		{
+			Star star;
+			star.x = getRndCoord();
+			star.y = getRndCoord();
+			star.z = getRndCoord();
+			star.type = NO_STAR_TYPE;
+
+			const uint8_t selection = random.next() % 4;
+			if (selection != 0)
+			{
+				// Constellation.
+				std::vector<SubStar> starList;
+				const int n = 2 + (random.next() % 4);
+
+				for (int j = 0; j < n; j++)
+				{
+					// Must convert to short for arithmetic right shift (to preserve sign bit).
+					SubStar subStar;
+					subStar.dx = static_cast<int16_t>(random.next()) >> 9;
+					subStar.dy = static_cast<int16_t>(random.next()) >> 9;
+					subStar.color = (random.next() % 10) + 64;
+					starList.push_back(std::move(subStar));
+				}
+
+				star.subList = std::move(starList);
+			}
+			else
+			{
+				// Large star.
+				int8_t value;
+				do
+				{
+					value = random.next() % 8;
+				} while ((value >= 5) && (!allowPlanets || planets.at(value - 5)));
+
+				if (value >= 5)
+				{
+					planets.at(value - 5) = true;
+				}
+
+				star.type = value;
+			}
+
+			stars.push_back(std::move(star));
+		}
+	}
+
+	// Generates every star from one random sequence like the original game. Skies with more
+	// stars than the original take longer since none of it can run in parallel.
+	std::vector<Star> generateClassicStars(int starCount)
+	{
+		ArenaRandom random(StarSeed);
+		std::array<bool, 3> planets = { false, false, false };
+		std::vector<Star> stars;
+		stars.reserve(starCount);
+		generateStars(starCount, true, random, planets, stars);
+		return stars;
+	}
+
+	// Generates stars in chunks with their own seeds on the job system. The first chunk uses
+	// the original seed and is the only one with planets, so it matches the classic sequence
+	// and every planet still appears at most once.
+	std::vector<Star> generateChunkedStars(int starCount)
+	{
+		auto generateChunk = [](int chunkIndex, int count)
+		{
+			const uint32_t seed = StarSeed + (static_cast<uint32_t>(chunkIndex) * 0x9E3779B9);
+			ArenaRandom random(seed);
+			std::array<bool, 3> planets = { false, false, false };
+			std::vector<Star> stars;
+			stars.reserve(count);
+			generateStars(count, chunkIndex == 0, random, planets, stars);
+			return stars;
+		};
+
+		std::vector<std::future<std::vector<Star>>> chunks;
+		for (int i = StarsPerChunk; i < starCount; i += StarsPerChunk)
+		{
+			const int chunkIndex = i / StarsPerChunk;
+			const int count = std::min(StarsPerChunk, starCount - i);
+			chunks.push_back(JobSystem::submit(JobSystem::Priority::Streaming,
+				[generateChunk, chunkIndex, count]()
+			{
+				return generateChunk(chunkIndex, count);
+			}));
+		}
+
+		std::vector<Star> stars = generateChunk(0, std::min(StarsPerChunk, starCount));
+		stars.reserve(starCount);
+		for (auto &chunk : chunks)
+		{
+			std::vector<Star> chunkStars = chunk.get();
+			std::move(chunkStars.begin(), chunkStars.end(), std::back_inserter(stars));
+		}
+
+		return stars;
+	}
+
+	// Converts stars to distant sky objects. Large star surfaces are indexed by star type.
+	std::vector<DistantSky::StarObject> convertStars(const Star *stars, int count,
+		const Palette &palette, const std::array<const Surface*, 8> &largeStarSurfaces)
+	{
+		std::vector<DistantSky::StarObject> starObjects;
+		for (int i = 0; i < count; i++)
+		{
+			const Star &star = stars[i];
+			const Double3 direction = Double3(
+				static_cast<double>(star.x),
+				static_cast<double>(star.y),
+				static_cast<double>(star.z)).normalized();
+
+			const bool isSmallStar = star.type == NO_STAR_TYPE;
+			if (isSmallStar)
+			{
+				for (const auto &subStar : star.subList)
+				{
+					const uint32_t color = palette.get().at(subStar.color).toARGB();
+
+					// Delta X and Y are applied after world-to-pixel projection of the base
+					// direction in the original game, but we're doing angle calculations here
+					// instead for the sake of keeping all the star generation code in one place.
+					const Double3 subDirection = [&direction, &subStar]()
+					{
+						// Convert delta X and Y to percentages of the identity dimension (320px).
+						const double dxPercent = static_cast<double>(subStar.dx) / DistantSky::IDENTITY_DIM;
+						const double dyPercent = static_cast<double>(subStar.dy) / DistantSky::IDENTITY_DIM;
+
+						// Convert percentages to radians. Positive X is counter-clockwise, positive
+						// Y is up.
+						const double dxRadians = dxPercent * DistantSky::IDENTITY_ANGLE_RADIANS;
+						const double dyRadians = dyPercent * DistantSky::IDENTITY_ANGLE_RADIANS;
+
+						// Apply rotations to base direction.
+						const Matrix4d xRotation = Matrix4d::xRotation(dxRadians);
+						const Matrix4d yRotation = Matrix4d::yRotation(dyRadians);
+						const Double4 newDir = yRotation * (xRotation * Double4(direction, 0.0));
+
+						return Double3(newDir.x, newDir.y, newDir.z);
+					}();
+
+					starObjects.push_back(DistantSky::StarObject::makeSmall(color, subDirection));
+				}
+			}
+			else
+			{
+				const Surface *surface = largeStarSurfaces.at(star.type);
+				DebugAssert(surface != nullptr);
+				starObjects.push_back(DistantSky::StarObject::makeLarge(*surface, direction));
+			}
+		}
+
+		return starObjects;
+	}
+
+	// Recently generated distant skies, least recently used first. Their surfaces are owned
+	// by the texture manager, which never frees them.
+	const int MaxCachedDistantSkies = 4;
+	std::deque<std::pair<DistantSkyKey, DistantSky>> CachedDistantSkies;
 }
 
 DistantSky::LandObject::LandObject(const Surface &surface, double angleRadians)
@@ -230,6 +445,7 @@ const Double3 &DistantSky::StarObject::getDirection() const
 }
 
 const int DistantSky::UNIQUE_ANGLES = 512;
+bool DistantSky::classicStarSequence = false;
 const double DistantSky::IDENTITY_DIM = 320.0;
 const double DistantSky::IDENTITY_ANGLE_RADIANS = 90.0 * Constants::DegToRad;
 
@@ -298,6 +514,11 @@ const Surface &DistantSky::getSunSurface() const
 	return *this->sunSurface;
 }
 
+void DistantSky::setClassicStarSequence(bool classic)
+{
+	DistantSky::classicStarSequence = classic;
+}
+
 int DistantSky::getStarCountFromDensity(int starDensity)
 {
 	if (starDensity == 0)
@@ -323,13 +544,52 @@ int DistantSky::getStarCountFromDensity(int starDensity)
 
 void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 	int currentDay, int starCount, const MiscAssets &miscAssets, TextureManager &textureManager)
+{
+	// The same inputs always make the same sky, so a recently generated one is copied.
+	DistantSkyKey key;
+	key.localCityID = localCityID;
+	key.provinceID = provinceID;
+	key.currentDay = currentDay;
+	key.starCount = starCount;
+	key.weatherType = weatherType;
+	key.classicStarSequence = DistantSky::classicStarSequence;
+
+	const auto iter = std::find_if(CachedDistantSkies.begin(), CachedDistantSkies.end(),
+		[&key](const std::pair<DistantSkyKey, DistantSky> &pair)
+	{
+		return pair.first == key;
+	});
+
+	if (iter != CachedDistantSkies.end())
+	{
+		// Move it to the back so it's dropped last.
+		std::pair<DistantSkyKey, DistantSky> pair = std::move(*iter);
+		CachedDistantSkies.erase(iter);
+		CachedDistantSkies.push_back(std::move(pair));
+		*this = CachedDistantSkies.back().second;
+		return;
+	}
+
+	this->generate(localCityID, provinceID, weatherType, currentDay, starCount,
+		miscAssets, textureManager);
+
+	if (static_cast<int>(CachedDistantSkies.size()) >= MaxCachedDistantSkies)
+	{
+		CachedDistantSkies.pop_front();
+	}
+
+	CachedDistantSkies.push_back(std::make_pair(key, *this));
+}
+
+void DistantSky::generate(int localCityID, int provinceID, WeatherType weatherType,
+	int currentDay, int starCount, const MiscAssets &miscAssets, TextureManager &textureManager)
 {
 	// Add mountains and clouds first. Get the climate type of the city.
 	const ClimateType climateType = Location::getCityClimateType(
 		localCityID, provinceID, miscAssets);
 
 	const auto &exeData = miscAssets.getExeData();
-	const auto &distantMountainFilenames = exeData.locations.distantMountainFilenames;
+	const auto &distantMountainFilenames = exeData.getLocations().distantMountainFilenames;
 
 	// Get the mountain traits associated with the given climate type.
 	const DistantMountainTraits &mtnTraits = [climateType]()
@@ -395,7 +655,8 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 				return String::toUppercase(name);
 			}();
 
-			const Surface &surface = textureManager.getSurface(filename);
+			const Surface &surface = textureManager.getSurface(
+				textureManager.getSurfaceID(filename));
 
 			// The yPos parameter is optional, and is assigned depending on whether the object
 			// is in the air.
@@ -435,7 +696,7 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 		random.srand(cloudSeed);
 
 		const int cloudCount = 7;
-		const std::string &cloudFilename = exeData.locations.cloudFilename;
+		const std::string &cloudFilename = exeData.getLocations().cloudFilename;
 		const int cloudPos = 5;
 		const int cloudVar = 17;
 		const int cloudMaxDigits = 2;
@@ -478,7 +739,7 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 			}
 		}();
 
-		const auto &animFilenames = exeData.locations.animDistantMountainFilenames;
+		const auto &animFilenames = exeData.getLocations().animDistantMountainFilenames;
 		const std::string animFilename = String::toUppercase(animFilenames.at(animIndex));
 
 		// .DFAs have multiple frames, .IMGs do not.
@@ -489,7 +750,8 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 		// Determine which frames the animation will have.
 		if (hasMultipleFrames)
 		{
-			const auto &animSurfaces = textureManager.getSurfaces(animFilename);
+			const auto &animSurfaces = textureManager.getSurfaces(
+				textureManager.getSurfaceSetID(animFilename));
 			for (auto &surface : animSurfaces)
 			{
 				animLandObj.addSurface(surface);
@@ -497,7 +759,8 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 		}
 		else
 		{
-			const auto &surface = textureManager.getSurface(animFilename);
+			const auto &surface = textureManager.getSurface(
+				textureManager.getSurfaceID(animFilename));
 			animLandObj.addSurface(surface);
 		}
 
@@ -531,8 +794,9 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 
 			const int moonIndex = static_cast<int>(type);
 			const std::string filename = String::toUppercase(
-				exeData.locations.moonFilenames.at(moonIndex));
-			const auto &surfaces = textureManager.getSurfaces(filename);
+				exeData.getLocations().moonFilenames.at(moonIndex));
+			const auto &surfaces = textureManager.getSurfaces(
+				textureManager.getSurfaceSetID(filename));
 			const auto &surface = surfaces.at(phaseIndex);
 			const double phasePercent = static_cast<double>(phaseIndex) /
 				static_cast<double>(phaseCount);
@@ -542,88 +806,34 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 		this->moonObjects.push_back(makeMoon(MoonObject::Type::First));
 		this->moonObjects.push_back(makeMoon(MoonObject::Type::Second));
 
-		// Initialize stars.
-		struct SubStar
-		{
-			int8_t dx, dy;
-			uint8_t color;
-		};
-
-		struct Star
-		{
-			int16_t x, y, z;
-			std::vector<SubStar> subList;
-			int8_t type;
-		};
+		// Initialize stars. The large star surfaces are looked up here since the texture
+		// manager is only used on this thread.
+		std::vector<Star> stars = DistantSky::classicStarSequence ?
+			generateClassicStars(starCount) : generateChunkedStars(starCount);
 
-		const int8_t NO_STAR_TYPE = -1;
-
-		auto getRndCoord = [&random]()
+		// Sort stars so large ones appear in front when rendered (it looks a bit better that way).
+		std::sort(stars.begin(), stars.end(), [](const Star &a, const Star &b)
 		{
-			const int16_t d = (0x800 + random.next()) & 0x0FFF;
-			return ((d & 2) == 0) ? d : -d;
-		};
-
-		std::vector<Star> stars;
-		std::array<bool, 3> planets = { false, false, false };
-
-		random.srand(0x12345679);
+			return a.type < b.type;
+		});
 
-		// The original game is hardcoded to 40 stars but it doesn't seem like very many, so
-		// it is now a variable.
-		for (int i = 0; i < starCount; i++)
+		std::array<const Surface*, 8> largeStarSurfaces;
+		largeStarSurfaces.fill(nullptr);
+		for (const Star &star : stars)
 		{
-			Star star;
-			star.x = getRndCoord();
-			star.y = getRndCoord();
-			star.z = getRndCoord();
-			star.type = NO_STAR_TYPE;
-
-			const uint8_t selection = random.next() % 4;
-			if (selection != 0)
+			if ((star.type != NO_STAR_TYPE) && (largeStarSurfaces.at(star.type) == nullptr))
 			{
-				// Constellation.
-				std::vector<SubStar> starList;
-				const int n = 2 + (random.next() % 4);
-
-				for (int j = 0; j < n; j++)
-				{
-					// Must convert to short for arithmetic right shift (to preserve sign bit).
-					SubStar subStar;
-					subStar.dx = static_cast<int16_t>(random.next()) >> 9;
-					subStar.dy = static_cast<int16_t>(random.next()) >> 9;
-					subStar.color = (random.next() % 10) + 64;
-					starList.push_back(std::move(subStar));
-				}
-
-				star.subList = std::move(starList);
+				const std::string typeStr = std::to_string(star.type + 1);
+				std::string filename = exeData.getLocations().starFilename;
+				const size_t index = filename.find('1');
+				DebugAssert(index != std::string::npos);
+
+				filename.replace(index, 1, typeStr);
+				largeStarSurfaces.at(star.type) = &textureManager.getSurface(
+					textureManager.getSurfaceID(String::toUppercase(filename)));
 			}
-			else
-			{
-				// Large star.
-				int8_t value;
-				do
-				{
-					value = random.next() % 8;
-				} while ((value >= 5) && planets.at(value - 5));
-
-				if (value >= 5)
-				{
-					planets.at(value - 5) = true;
-				}
-
-				star.type = value;
-			}
-
-			stars.push_back(std::move(star));
 		}
 
-		// Sort stars so large ones appear in front when rendered (it looks a bit better that way).
-		std::sort(stars.begin(), stars.end(), [](const Star &a, const Star &b)
-		{
-			return a.type < b.type;
-		});
-
 		// Palette used to obtain colors for small stars in constellations.
 		const Palette palette = []()
 		{
@@ -637,71 +847,33 @@ void DistantSky::init(int localCityID, int provinceID, WeatherType weatherType,
 			return colFile.getPalette();
 		}();
 
-		// Convert stars to modern representation.
-		for (const auto &star : stars)
+		// Convert stars to modern representation in ranges on the job system, keeping them in
+		// the sorted order.
+		const int starTotal = static_cast<int>(stars.size());
+		std::vector<std::future<std::vector<StarObject>>> conversions;
+		for (int i = StarsPerChunk; i < starTotal; i += StarsPerChunk)
 		{
-			const Double3 direction = Double3(
-				static_cast<double>(star.x),
-				static_cast<double>(star.y),
-				static_cast<double>(star.z)).normalized();
-
-			const bool isSmallStar = star.type == -1;
-			if (isSmallStar)
+			const int count = std::min(StarsPerChunk, starTotal - i);
+			conversions.push_back(JobSystem::submit(JobSystem::Priority::Streaming,
+				[&stars, &palette, &largeStarSurfaces, i, count]()
 			{
-				for (const auto &subStar : star.subList)
-				{
-					const uint32_t color = [&palette, &subStar]()
-					{
-						const Color &paletteColor = palette.get().at(subStar.color);
-						return paletteColor.toARGB();
-					}();
-
-					// Delta X and Y are applied after world-to-pixel projection of the base
-					// direction in the original game, but we're doing angle calculations here
-					// instead for the sake of keeping all the star generation code in one place.
-					const Double3 subDirection = [&direction, &subStar]()
-					{
-						// Convert delta X and Y to percentages of the identity dimension (320px).
-						const double dxPercent = static_cast<double>(subStar.dx) / DistantSky::IDENTITY_DIM;
-						const double dyPercent = static_cast<double>(subStar.dy) / DistantSky::IDENTITY_DIM;
-
-						// Convert percentages to radians. Positive X is counter-clockwise, positive
-						// Y is up.
-						const double dxRadians = dxPercent * DistantSky::IDENTITY_ANGLE_RADIANS;
-						const double dyRadians = dyPercent * DistantSky::IDENTITY_ANGLE_RADIANS;
-
-						// Apply rotations to base direction.
-						const Matrix4d xRotation = Matrix4d::xRotation(dxRadians);
-						const Matrix4d yRotation = Matrix4d::yRotation(dyRadians);
-						const Double4 newDir = yRotation * (xRotation * Double4(direction, 0.0));
-
-						return Double3(newDir.x, newDir.y, newDir.z);
-					}();
-
-					this->starObjects.push_back(StarObject::makeSmall(color, subDirection));
-				}
-			}
-			else
-			{
-				const std::string starFilename = [&exeData, &star]()
-				{
-					const std::string typeStr = std::to_string(star.type + 1);
-					std::string filename = exeData.locations.starFilename;
-					const size_t index = filename.find('1');
-					DebugAssert(index != std::string::npos);
-
-					filename.replace(index, 1, typeStr);
-					return String::toUppercase(filename);
-				}();
+				return convertStars(stars.data() + i, count, palette, largeStarSurfaces);
+			}));
+		}
 
-				const Surface &surface = textureManager.getSurface(starFilename);
-				this->starObjects.push_back(StarObject::makeLarge(surface, direction));
-			}
+		this->starObjects = convertStars(stars.data(), std::min(StarsPerChunk, starTotal),
+			palette, largeStarSurfaces);
+		for (auto &conversion : conversions)
+		{
+			const std::vector<StarObject> starObjects = conversion.get();
+			this->starObjects.insert(this->starObjects.end(), starObjects.begin(),
+				starObjects.end());
 		}
 
 		// Initialize sun texture.
-		const std::string &sunFilename = exeData.locations.sunFilename;
-		this->sunSurface = &textureManager.getSurface(String::toUppercase(sunFilename));
+		const std::string &sunFilename = exeData.getLocations().sunFilename;
+		this->sunSurface = &textureManager.getSurface(
+			textureManager.getSurfaceID(String::toUppercase(sunFilename)));
 	}
 }
 
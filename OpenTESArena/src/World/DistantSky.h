@@ -129,6 +129,10 @@ private:
 	// Number of unique directions in 360 degrees.
 	static const int UNIQUE_ANGLES;
 
+	// Whether stars come from one random sequence like the original game instead of in
+	// chunks with their own seeds.
+	static bool classicStarSequence;
+
 	std::vector<LandObject> landObjects;
 	std::vector<AnimatedLandObject> animLandObjects;
 	std::vector<AirObject> airObjects;
@@ -137,6 +141,10 @@ private:
 
 	// The sun's position is a function of time of day.
 	const Surface *sunSurface;
+
+	// Creates the distant objects from the distant sky seed and the other inputs.
+	void generate(int localCityID, int provinceID, WeatherType weatherType, int currentDay,
+		int starCount, const MiscAssets &miscAssets, TextureManager &textureManager);
 public:
 	// The size of textures in world space is based on 320px being 1 unit, and a 320px
 	// wide texture spans a screen's worth of horizontal FOV in the original game.
@@ -162,6 +170,13 @@ public:
 	// Added in the new engine for fun. Gets the number of stars for some density.
 	static int getStarCountFromDensity(int starDensity);
 
+	// Sets whether stars are generated from one random sequence like the original game.
+	// Otherwise they're generated in parallel chunks, which only differ from the original
+	// past the first few hundred stars (more than the classic density has). Skies made
+	// afterwards use the new setting.
+	static void setClassicStarSequence(bool classic);
+
+	// Creates the distant objects, or copies them if the same sky was made recently.
 	void init(int localCityID, int provinceID, WeatherType weatherType, int currentDay,
 		int starCount, const MiscAssets &miscAssets, TextureManager &textureManager);
 
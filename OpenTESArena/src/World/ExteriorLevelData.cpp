@@ -1,8 +1,8 @@
 #include <algorithm>
-#include <iomanip>
-#include <sstream>
+#include <limits>
 
 #include "ExteriorLevelData.h"
+#include "LevelCache.h"
 #include "WorldType.h"
 #include "../Assets/RMDFile.h"
 #include "../Math/Random.h"
@@ -14,15 +14,220 @@
 #include "../World/LocationType.h"
 #include "../World/VoxelDataType.h"
 
+namespace
+{
+	// Run-length encodes voxels as (count, voxel) pairs.
+	std::vector<uint16_t> packVoxels(const std::vector<uint16_t> &voxels)
+	{
+		std::vector<uint16_t> packed;
+		size_t i = 0;
+		while (i < voxels.size())
+		{
+			const uint16_t voxel = voxels[i];
+			size_t count = 1;
+			while (((i + count) < voxels.size()) && (voxels[i + count] == voxel) &&
+				(count < std::numeric_limits<uint16_t>::max()))
+			{
+				count++;
+			}
+
+			packed.push_back(static_cast<uint16_t>(count));
+			packed.push_back(voxel);
+			i += count;
+		}
+
+		packed.shrink_to_fit();
+		return packed;
+	}
+
+	std::vector<uint16_t> unpackVoxels(const std::vector<uint16_t> &packed)
+	{
+		std::vector<uint16_t> voxels;
+		voxels.reserve(RMDFile::ELEMENTS_PER_FLOOR);
+		for (size_t i = 0; i < packed.size(); i += 2)
+		{
+			voxels.insert(voxels.end(), packed[i], packed[i + 1]);
+		}
+
+		return voxels;
+	}
+}
+
+const int ExteriorLevelData::WILD_CHUNK_UNLOAD_MARGIN = 16;
+const int ExteriorLevelData::MAX_CACHED_CITIES = 8;
+std::deque<ExteriorLevelData::CachedCity> ExteriorLevelData::cachedCities;
+
 ExteriorLevelData::ExteriorLevelData(int gridWidth, int gridHeight, int gridDepth,
 	const std::string &infName, const std::string &name)
-	: LevelData(gridWidth, gridHeight, gridDepth, infName, name) { }
+	: LevelData(gridWidth, gridHeight, gridDepth, infName, name)
+{
+	this->exeData = nullptr;
+}
 
 ExteriorLevelData::~ExteriorLevelData()
 {
 
 }
 
+int ExteriorLevelData::getWildChunkCountX() const
+{
+	return this->getVoxelGrid().getWidth() / RMDFile::WIDTH;
+}
+
+int ExteriorLevelData::getWildChunkCountZ() const
+{
+	return this->getVoxelGrid().getDepth() / RMDFile::DEPTH;
+}
+
+Int2 ExteriorLevelData::getWildChunkFromOffset(int xOffset, int zOffset, int gridWidth,
+	int gridDepth)
+{
+	// Arena's voxel data is stored in reverse, so the offset changes which side it's from.
+	return Int2(((gridWidth - zOffset) / RMDFile::WIDTH) - 1,
+		((gridDepth - xOffset) / RMDFile::DEPTH) - 1);
+}
+
+void ExteriorLevelData::copyWildChunkVoxels(const Int2 &chunk, int gridWidth, int gridDepth,
+	std::vector<uint16_t> &chunkVoxels, std::vector<uint16_t> &gridVoxels, bool toGrid)
+{
+	const int xOffset = gridDepth - ((chunk.y + 1) * RMDFile::DEPTH);
+	const int zOffset = gridWidth - ((chunk.x + 1) * RMDFile::WIDTH);
+
+	for (int z = 0; z < RMDFile::DEPTH; z++)
+	{
+		const auto chunkBegin = chunkVoxels.begin() + (z * RMDFile::WIDTH);
+		const auto gridBegin = gridVoxels.begin() + xOffset + ((z + zOffset) * gridDepth);
+
+		if (toGrid)
+		{
+			std::copy(chunkBegin, chunkBegin + RMDFile::WIDTH, gridBegin);
+		}
+		else
+		{
+			std::copy(gridBegin, gridBegin + RMDFile::WIDTH, chunkBegin);
+		}
+	}
+}
+
+void ExteriorLevelData::packWildChunk(WildChunk &wildChunk)
+{
+	DebugAssert(!wildChunk.isPacked);
+	wildChunk.flor = packVoxels(wildChunk.flor);
+	wildChunk.map1 = packVoxels(wildChunk.map1);
+	wildChunk.map2 = packVoxels(wildChunk.map2);
+	wildChunk.isPacked = true;
+}
+
+void ExteriorLevelData::unpackWildChunk(WildChunk &wildChunk)
+{
+	DebugAssert(wildChunk.isPacked);
+	wildChunk.flor = unpackVoxels(wildChunk.flor);
+	wildChunk.map1 = unpackVoxels(wildChunk.map1);
+	wildChunk.map2 = unpackVoxels(wildChunk.map2);
+	wildChunk.isPacked = false;
+}
+
+void ExteriorLevelData::insertWildChunk(int chunkX, int chunkZ)
+{
+	DebugAssert(this->exeData != nullptr);
+
+	const VoxelGrid &voxelGrid = this->getVoxelGrid();
+	const int gridWidth = voxelGrid.getWidth();
+	const int gridDepth = voxelGrid.getDepth();
+	const int chunkCountX = this->getWildChunkCountX();
+	const int chunkCountZ = this->getWildChunkCountZ();
+	this->unpackWildChunk(this->wildChunks[chunkX + (chunkZ * chunkCountX)]);
+
+	// The voxel reads work on the whole wilderness so chasms can see their neighbors across
+	// chunk edges, so lay every chunk out in temp buffers. Packed chunks are only unpacked
+	// for the copy.
+	std::vector<uint16_t> tempFlor(gridWidth * gridDepth);
+	std::vector<uint16_t> tempMap1(tempFlor.size());
+	std::vector<uint16_t> tempMap2(tempFlor.size());
+	for (int z = 0; z < chunkCountZ; z++)
+	{
+		for (int x = 0; x < chunkCountX; x++)
+		{
+			const Int2 chunk(x, z);
+			const WildChunk &wildChunk = this->wildChunks[x + (z * chunkCountX)];
+
+			auto copyVoxels = [gridWidth, gridDepth, &chunk, &wildChunk](
+				const std::vector<uint16_t> &chunkVoxels, std::vector<uint16_t> &gridVoxels)
+			{
+				std::vector<uint16_t> voxels = wildChunk.isPacked ?
+					unpackVoxels(chunkVoxels) : chunkVoxels;
+				ExteriorLevelData::copyWildChunkVoxels(chunk, gridWidth, gridDepth,
+					voxels, gridVoxels, true);
+			};
+
+			copyVoxels(wildChunk.flor, tempFlor);
+			copyVoxels(wildChunk.map1, tempMap1);
+			copyVoxels(wildChunk.map2, tempMap2);
+		}
+	}
+
+	// The data mappings are kept from the first read, so no voxel data is added again.
+	const Int2 voxelMin(chunkX * RMDFile::WIDTH, chunkZ * RMDFile::DEPTH);
+	const Int2 voxelMax(voxelMin.x + RMDFile::WIDTH, voxelMin.y + RMDFile::DEPTH);
+	const INFFile &inf = this->getInfFile();
+	this->readFLOR(tempFlor.data(), inf, gridWidth, gridDepth, voxelMin, voxelMax);
+	this->readMAP1(tempMap1.data(), inf, WorldType::Wilderness, gridWidth, gridDepth,
+		*this->exeData, voxelMin, voxelMax);
+	this->readMAP2(tempMap2.data(), inf, gridWidth, gridDepth, voxelMin, voxelMax);
+}
+
+void ExteriorLevelData::removeWildChunk(int chunkX, int chunkZ)
+{
+	const Int2 voxelMin(chunkX * RMDFile::WIDTH, chunkZ * RMDFile::DEPTH);
+	const Int2 voxelMax(voxelMin.x + RMDFile::WIDTH, voxelMin.y + RMDFile::DEPTH);
+	this->clearVoxels(voxelMin, voxelMax);
+	this->packWildChunk(this->wildChunks[chunkX + (chunkZ * this->getWildChunkCountX())]);
+}
+
+void ExteriorLevelData::writeWildChunk(const Int2 &chunk, const RMDFile &rmd)
+{
+	WildChunk &wildChunk = this->wildChunks[chunk.x + (chunk.y * this->getWildChunkCountX())];
+	const bool isResident = !wildChunk.isPacked;
+	wildChunk.flor = rmd.getFLOR();
+	wildChunk.map1 = rmd.getMAP1();
+	wildChunk.map2 = rmd.getMAP2();
+	wildChunk.isPacked = false;
+
+	// Replace the placeholder voxels if the chunk is in the voxel grid. Otherwise it's read
+	// once the player gets near it.
+	if (isResident)
+	{
+		this->removeWildChunk(chunk.x, chunk.y);
+		this->insertWildChunk(chunk.x, chunk.y);
+	}
+	else
+	{
+		this->packWildChunk(wildChunk);
+	}
+}
+
+void ExteriorLevelData::writeFinishedWildChunks(bool wait)
+{
+	if (this->wildChunkLoader == nullptr)
+	{
+		return;
+	}
+
+	const std::vector<WildernessChunkLoader::Result> results =
+		this->wildChunkLoader->takeResults(wait);
+
+	for (const WildernessChunkLoader::Result &result : results)
+	{
+		this->writeWildChunk(result.chunk, result.rmd);
+	}
+
+	// Stop the loader thread once every chunk is written.
+	if (!this->wildChunkLoader->hasPendingChunks())
+	{
+		this->wildChunkLoader = nullptr;
+	}
+}
+
 void ExteriorLevelData::generateBuildingNames(int localCityID, int provinceID, uint32_t citySeed,
 	ArenaRandom &random, bool isCoastal, bool isCity, int gridWidth, int gridDepth,
 	const MiscAssets &miscAssets)
@@ -31,11 +236,32 @@ void ExteriorLevelData::generateBuildingNames(int localCityID, int provinceID, u
 	const int globalCityID = CityDataFile::getGlobalCityID(localCityID, provinceID);
 	const Int2 localCityPoint = CityDataFile::getLocalCityPoint(citySeed);
 
-	// Lambda for looping through main-floor voxels and generating names for *MENU blocks that
-	// match the given menu type.
-	auto generateNames = [this, localCityID, provinceID, &citySeed, &random, isCoastal, isCity,
-		gridWidth, gridDepth, &miscAssets, &exeData, globalCityID, &localCityPoint](
-			VoxelData::WallData::MenuType menuType)
+	// Find the main-floor *MENU blocks and their menu types once instead of looking through
+	// every voxel for each menu type. They're in the order names are generated in, starting
+	// at the top-right corner of the map, running right to left and top to bottom.
+	std::vector<std::pair<Int2, VoxelData::WallData::MenuType>> menuBlocks;
+	const auto &voxelGrid = this->getVoxelGrid();
+	for (int x = gridWidth - 1; x >= 0; x--)
+	{
+		for (int z = gridDepth - 1; z >= 0; z--)
+		{
+			const uint16_t voxelID = voxelGrid.getVoxel(x, 1, z);
+			const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
+			if ((voxelData.dataType == VoxelDataType::Wall) && voxelData.wall.isMenu())
+			{
+				const VoxelData::WallData::MenuType menuType =
+					VoxelData::WallData::getMenuType(voxelData.wall.menuID, isCity);
+				menuBlocks.push_back(std::make_pair(Int2(x, z), menuType));
+			}
+		}
+	}
+
+	this->menuNames.reserve(this->menuNames.size() + menuBlocks.size());
+
+	// Lambda for generating names for the *MENU blocks that match the given menu type.
+	auto generateNames = [this, localCityID, provinceID, &citySeed, &random, isCoastal,
+		gridWidth, gridDepth, &miscAssets, &exeData, globalCityID, &localCityPoint,
+		&menuBlocks](VoxelData::WallData::MenuType menuType)
 	{
 		if ((menuType == VoxelData::WallData::MenuType::Equipment) ||
 			(menuType == VoxelData::WallData::MenuType::Temple))
@@ -44,26 +270,29 @@ void ExteriorLevelData::generateBuildingNames(int localCityID, int provinceID, u
 			random.srand(citySeed);
 		}
 
-		std::vector<int> seen;
+		// Names already given, by hash. Hashes are (m << 8) + n, and m is always less
+		// than 23.
+		std::vector<bool> seen(23 << 8, false);
 		auto hashInSeen = [&seen](int hash)
 		{
-			return std::find(seen.begin(), seen.end(), hash) != seen.end();
+			return seen[hash];
 		};
 
 		// Lambdas for creating tavern, equipment store, and temple building names.
 		auto createTavernName = [isCoastal, &exeData](int m, int n)
 		{
-			const auto &tavernPrefixes = exeData.cityGen.tavernPrefixes;
+			const auto &cityGen = exeData.getCityGeneration();
+			const auto &tavernPrefixes = cityGen.tavernPrefixes;
 			const auto &tavernSuffixes = isCoastal ?
-				exeData.cityGen.tavernMarineSuffixes : exeData.cityGen.tavernSuffixes;
+				cityGen.tavernMarineSuffixes : cityGen.tavernSuffixes;
 			return tavernPrefixes.at(m) + ' ' + tavernSuffixes.at(n);
 		};
 
 		auto createEquipmentName = [localCityID, provinceID, &random, gridWidth, gridDepth,
 			&miscAssets, &exeData](int m, int n, int x, int z)
 		{
-			const auto &equipmentPrefixes = exeData.cityGen.equipmentPrefixes;
-			const auto &equipmentSuffixes = exeData.cityGen.equipmentSuffixes;
+			const auto &equipmentPrefixes = exeData.getCityGeneration().equipmentPrefixes;
+			const auto &equipmentSuffixes = exeData.getCityGeneration().equipmentSuffixes;
 
 			// Equipment store names can have variables in them.
 			std::string str = equipmentPrefixes.at(m) + ' ' + equipmentSuffixes.at(n);
@@ -92,7 +321,7 @@ void ExteriorLevelData::generateBuildingNames(int localCityID, int provinceID, u
 					}
 				}();
 
-				return exeData.locations.locationTypes.at(index);
+				return exeData.getLocations().locationTypes.at(index);
 			}();
 
 			size_t index = str.find("%ct");
@@ -136,10 +365,10 @@ void ExteriorLevelData::generateBuildingNames(int localCityID, int provinceID, u
 
 		auto createTempleName = [&exeData](int model, int n)
 		{
-			const auto &templePrefixes = exeData.cityGen.templePrefixes;
-			const auto &temple1Suffixes = exeData.cityGen.temple1Suffixes;
-			const auto &temple2Suffixes = exeData.cityGen.temple2Suffixes;
-			const auto &temple3Suffixes = exeData.cityGen.temple3Suffixes;
+			const auto &templePrefixes = exeData.getCityGeneration().templePrefixes;
+			const auto &temple1Suffixes = exeData.getCityGeneration().temple1Suffixes;
+			const auto &temple2Suffixes = exeData.getCityGeneration().temple2Suffixes;
+			const auto &temple3Suffixes = exeData.getCityGeneration().temple3Suffixes;
 
 			const std::string &templeSuffix = [&temple1Suffixes, &temple2Suffixes,
 				&temple3Suffixes, model, n]() -> const std::string&
@@ -162,79 +391,65 @@ void ExteriorLevelData::generateBuildingNames(int localCityID, int provinceID, u
 			return templePrefixes.at(model) + templeSuffix;
 		};
 
-		// The lambda called for each main-floor voxel in the area.
-		auto tryGenerateBlockName = [this, isCity, menuType, &random, globalCityID, &seen,
-			&hashInSeen, &createTavernName, &createEquipmentName, &createTempleName](int x, int z)
+		// The lambda called for each *MENU block of the target menu type.
+		auto generateBlockName = [this, menuType, &random, &seen, &hashInSeen,
+			&createTavernName, &createEquipmentName, &createTempleName](int x, int z)
 		{
-			// See if the current voxel is a *MENU block and matches the target menu type.
-			const bool matchesTargetType = [this, isCity, x, z, menuType]()
-			{
-				const auto &voxelGrid = this->getVoxelGrid();
-				const uint16_t voxelID = voxelGrid.getVoxel(x, 1, z);
-				const VoxelData &voxelData = voxelGrid.getVoxelData(voxelID);
-				return (voxelData.dataType == VoxelDataType::Wall) && voxelData.wall.isMenu() &&
-					(VoxelData::WallData::getMenuType(voxelData.wall.menuID, isCity) == menuType);
-			}();
+			// Get the *MENU block's display name.
+			int hash;
+			std::string name;
 
-			if (matchesTargetType)
+			if (menuType == VoxelData::WallData::MenuType::Tavern)
 			{
-				// Get the *MENU block's display name.
-				int hash;
-				std::string name;
-
-				if (menuType == VoxelData::WallData::MenuType::Tavern)
+				// Tavern.
+				int m, n;
+				do
 				{
-					// Tavern.
-					int m, n;
-					do
-					{
-						m = random.next() % 23;
-						n = random.next() % 23;
-						hash = (m << 8) + n;
-					} while (hashInSeen(hash));
+					m = random.next() % 23;
+					n = random.next() % 23;
+					hash = (m << 8) + n;
+				} while (hashInSeen(hash));
 
-					name = createTavernName(m, n);
-				}
-				else if (menuType == VoxelData::WallData::MenuType::Equipment)
+				name = createTavernName(m, n);
+			}
+			else if (menuType == VoxelData::WallData::MenuType::Equipment)
+			{
+				// Equipment store.
+				int m, n;
+				do
 				{
-					// Equipment store.
-					int m, n;
-					do
-					{
-						m = random.next() % 20;
-						n = random.next() % 10;
-						hash = (m << 8) + n;
-					} while (hashInSeen(hash));
+					m = random.next() % 20;
+					n = random.next() % 10;
+					hash = (m << 8) + n;
+				} while (hashInSeen(hash));
 
-					name = createEquipmentName(m, n, x, z);
-				}
-				else
+				name = createEquipmentName(m, n, x, z);
+			}
+			else
+			{
+				// Temple.
+				int model, n;
+				do
 				{
-					// Temple.
-					int model, n;
-					do
-					{
-						model = random.next() % 3;
-						const std::array<int, 3> ModelVars = { 5, 9, 10 };
-						const int vars = ModelVars.at(model);
-						n = random.next() % vars;
-						hash = (model << 8) + n;
-					} while (hashInSeen(hash));
-
-					name = createTempleName(model, n);
-				}
-
-				this->menuNames.push_back(std::make_pair(Int2(x, z), std::move(name)));
-				seen.push_back(hash);
+					model = random.next() % 3;
+					const std::array<int, 3> ModelVars = { 5, 9, 10 };
+					const int vars = ModelVars.at(model);
+					n = random.next() % vars;
+					hash = (model << 8) + n;
+				} while (hashInSeen(hash));
+
+				name = createTempleName(model, n);
 			}
+
+			this->menuNames.push_back(std::make_pair(Int2(x, z), std::move(name)));
+			seen[hash] = true;
 		};
 
-		// Start at the top-right corner of the map, running right to left and top to bottom.
-		for (int x = gridWidth - 1; x >= 0; x--)
+		for (const auto &menuBlock : menuBlocks)
 		{
-			for (int z = gridDepth - 1; z >= 0; z--)
+			if (menuBlock.second == menuType)
 			{
-				tryGenerateBlockName(x, z);
+				generateBlockName(menuBlock.first.x, menuBlock.first.y);
 			}
 		}
 
@@ -467,9 +682,9 @@ ExteriorLevelData ExteriorLevelData::loadPremadeCity(const MIFFile::Level &level
 	// Load FLOR, MAP1, and MAP2 voxels. No locks or triggers.
 	const auto &exeData = miscAssets.getExeData();
 	const INFFile &inf = levelData.getInfFile();
-	levelData.readFLOR(level.flor.data(), inf, gridWidth, gridDepth);
+	levelData.readFLOR(level.flor.get(), inf, gridWidth, gridDepth);
 	levelData.readMAP1(tempMap1.data(), inf, WorldType::City, gridWidth, gridDepth, exeData);
-	levelData.readMAP2(level.map2.data(), inf, gridWidth, gridDepth);
+	levelData.readMAP2(level.map2.get(), inf, gridWidth, gridDepth);
 
 	// Generate building names.
 	// @todo: pass these as arguments to loadPremadeCity() instead of hardcoding them.
@@ -496,6 +711,67 @@ ExteriorLevelData ExteriorLevelData::loadCity(const MIFFile::Level &level, int l
 	const std::string &infName, int gridWidth, int gridDepth, const MiscAssets &miscAssets,
 	TextureManager &textureManager)
 {
+	// Lambda for creating the level from its finished FLOR, MAP1, and MAP2 voxels.
+	auto makeLevel = [&level, &infName, gridWidth, gridDepth, &miscAssets](
+		const std::vector<uint16_t> &flor, const std::vector<uint16_t> &map1,
+		const std::vector<uint16_t> &map2)
+	{
+		// Create the level for the voxel data to be written into.
+		ExteriorLevelData levelData(gridWidth, level.getHeight(), gridDepth, infName, level.name);
+
+		// Empty voxel data (for air).
+		levelData.getVoxelGrid().addVoxelData(VoxelData());
+
+		// Load FLOR, MAP1, and MAP2 voxels into the voxel grid.
+		const auto &exeData = miscAssets.getExeData();
+		const INFFile &inf = levelData.getInfFile();
+		levelData.readFLOR(flor.data(), inf, gridWidth, gridDepth);
+		levelData.readMAP1(map1.data(), inf, WorldType::City, gridWidth, gridDepth, exeData);
+		levelData.readMAP2(map2.data(), inf, gridWidth, gridDepth);
+		return levelData;
+	};
+
+	// The city is the same every time for the same city seed and skeleton, so a recently
+	// generated one is reused as-is.
+	const uint64_t cityKey = [&level, localCityID, provinceID, &infName, gridWidth, gridDepth,
+		&miscAssets]()
+	{
+		const uint32_t citySeed = miscAssets.getCityDataFile().getCitySeed(localCityID, provinceID);
+
+		uint64_t key = LevelCache::EMPTY_KEY;
+		key = LevelCache::hash(&citySeed, sizeof(citySeed), key);
+		key = LevelCache::hash(localCityID, key);
+		key = LevelCache::hash(provinceID, key);
+		key = LevelCache::hash(level.name, key);
+		key = LevelCache::hash(infName, key);
+		key = LevelCache::hash(gridWidth, key);
+		return LevelCache::hash(gridDepth, key);
+	}();
+
+	const auto cachedIter = std::find_if(ExteriorLevelData::cachedCities.begin(),
+		ExteriorLevelData::cachedCities.end(), [cityKey](const CachedCity &cachedCity)
+	{
+		return cachedCity.key == cityKey;
+	});
+
+	if (cachedIter != ExteriorLevelData::cachedCities.end())
+	{
+		// Move it to the back so it's dropped last.
+		CachedCity cachedCity = std::move(*cachedIter);
+		ExteriorLevelData::cachedCities.erase(cachedIter);
+		ExteriorLevelData::cachedCities.push_back(std::move(cachedCity));
+
+		const CachedCity &city = ExteriorLevelData::cachedCities.back();
+		ExteriorLevelData levelData = makeLevel(city.flor, city.map1, city.map2);
+		levelData.menuNames = city.menuNames;
+
+		// Generate distant sky.
+		levelData.distantSky.init(localCityID, provinceID, weatherType, currentDay,
+			starCount, miscAssets, textureManager);
+
+		return levelData;
+	}
+
 	// Create temp voxel data buffers and write the city skeleton data to them. Each city
 	// block will be written to them as well.
 	std::vector<uint16_t> tempFlor(level.flor.begin(), level.flor.end());
@@ -637,7 +913,7 @@ ExteriorLevelData ExteriorLevelData::loadCity(const MIFFile::Level &level, int l
 				const int dstIndex = xOffset + ((z + zOffset) * gridDepth);
 
 				auto writeRow = [&blockMif, srcIndex, dstIndex](
-					const std::vector<uint16_t> &src, std::vector<uint16_t> &dst)
+					const BufferView<const uint16_t> &src, std::vector<uint16_t> &dst)
 				{
 					const auto srcBegin = src.begin() + srcIndex;
 					const auto srcEnd = srcBegin + blockMif.getWidth();
@@ -666,24 +942,28 @@ ExteriorLevelData ExteriorLevelData::loadCity(const MIFFile::Level &level, int l
 	// Run the palace gate graphic algorithm over the perimeter of the MAP1 data.
 	ExteriorLevelData::revisePalaceGraphics(tempMap1, gridWidth, gridDepth);
 
-	// Create the level for the voxel data to be written into.
-	ExteriorLevelData levelData(gridWidth, level.getHeight(), gridDepth, infName, level.name);
-
-	// Empty voxel data (for air).
-	levelData.getVoxelGrid().addVoxelData(VoxelData());
-
-	// Load FLOR, MAP1, and MAP2 voxels into the voxel grid.
-	const auto &exeData = miscAssets.getExeData();
-	const INFFile &inf = levelData.getInfFile();
-	levelData.readFLOR(tempFlor.data(), inf, gridWidth, gridDepth);
-	levelData.readMAP1(tempMap1.data(), inf, WorldType::City, gridWidth, gridDepth, exeData);
-	levelData.readMAP2(tempMap2.data(), inf, gridWidth, gridDepth);
+	ExteriorLevelData levelData = makeLevel(tempFlor, tempMap1, tempMap2);
 
 	// Generate building names.
 	const bool isCity = true;
 	levelData.generateBuildingNames(localCityID, provinceID, citySeed, random, isCoastal,
 		isCity, gridWidth, gridDepth, miscAssets);
 
+	// Keep the generated city, dropping the least recently used one if there's no room.
+	if (static_cast<int>(ExteriorLevelData::cachedCities.size()) >=
+		ExteriorLevelData::MAX_CACHED_CITIES)
+	{
+		ExteriorLevelData::cachedCities.pop_front();
+	}
+
+	CachedCity cachedCity;
+	cachedCity.key = cityKey;
+	cachedCity.flor = std::move(tempFlor);
+	cachedCity.map1 = std::move(tempMap1);
+	cachedCity.map2 = std::move(tempMap2);
+	cachedCity.menuNames = levelData.menuNames;
+	ExteriorLevelData::cachedCities.push_back(std::move(cachedCity));
+
 	// Generate distant sky.
 	levelData.distantSky.init(localCityID, provinceID, weatherType, currentDay,
 		starCount, miscAssets, textureManager);
@@ -716,57 +996,14 @@ ExteriorLevelData ExteriorLevelData::loadWilderness(int rmdTR, int rmdTL, int rm
 	std::copy(level.map1.begin(), level.map1.end(), tempMap1.begin());
 	std::copy(level.map2.begin(), level.map2.end(), tempMap2.begin());
 
-	auto writeRMD = [gridDepth, &tempFlor, &tempMap1, &tempMap2](
-		int rmdID, int xOffset, int zOffset)
-	{
-		const std::string rmdName = [rmdID]()
-		{
-			std::stringstream ss;
-			ss << std::setw(3) << std::setfill('0') << rmdID;
-			return "WILD" + ss.str() + ".RMD";
-		}();
-
-		RMDFile rmd;
-		if (!rmd.init(rmdName.c_str()))
-		{
-			DebugCrash("Could not init .RMD file \"" + rmdName + "\".");
-		}
-
-		// Copy .RMD voxel data to temp buffers.
-		for (int z = 0; z < RMDFile::DEPTH; z++)
-		{
-			const int srcIndex = z * RMDFile::WIDTH;
-			const int dstIndex = xOffset + ((z + zOffset) * gridDepth);
-
-			auto writeRow = [srcIndex, dstIndex](const std::vector<uint16_t> &src,
-				std::vector<uint16_t> &dst)
-			{
-				const auto srcBegin = src.begin() + srcIndex;
-				const auto srcEnd = srcBegin + RMDFile::WIDTH;
-				const auto dstBegin = dst.begin() + dstIndex;
-				std::copy(srcBegin, srcEnd, dstBegin);
-			};
-
-			writeRow(rmd.getFLOR(), tempFlor);
-			writeRow(rmd.getMAP1(), tempMap1);
-			writeRow(rmd.getMAP2(), tempMap2);
-		}
-	};
-
-	// Load four .RMD files into the wilderness skeleton, each at some X and Z offset in
-	// the voxel grid.
-	writeRMD(rmdTR, 0, 0); // Top right.
-	writeRMD(rmdTL, RMDFile::WIDTH, 0); // Top left.
-	writeRMD(rmdBR, 0, RMDFile::DEPTH); // Bottom right.
-	writeRMD(rmdBL, RMDFile::WIDTH, RMDFile::DEPTH); // Bottom left.
-
 	// Create the level for the voxel data to be written into.
 	ExteriorLevelData levelData(gridWidth, level.getHeight(), gridDepth, infName, level.name);
 
 	// Empty voxel data (for air).
 	levelData.getVoxelGrid().addVoxelData(VoxelData());
 
-	// Load FLOR, MAP1, and MAP2 voxels into the voxel grid.
+	// Load the skeleton's FLOR, MAP1, and MAP2 voxels into the voxel grid. They stand in for
+	// each chunk until its .RMD file is read.
 	const auto &exeData = miscAssets.getExeData();
 	const INFFile &inf = levelData.getInfFile();
 	levelData.readFLOR(tempFlor.data(), inf, gridWidth, gridDepth);
@@ -774,6 +1011,52 @@ ExteriorLevelData ExteriorLevelData::loadWilderness(int rmdTR, int rmdTL, int rm
 	levelData.readMAP2(tempMap2.data(), inf, gridWidth, gridDepth);
 	// @todo: load FLAT from WILD.MIF level data. levelData.readFLAT(level.flat, ...)?
 
+	// Keep each chunk's voxels for streaming chunks in and out around the player. Every
+	// chunk starts in the voxel grid since the player's position isn't known yet.
+	const int chunkCountX = levelData.getWildChunkCountX();
+	const int chunkCountZ = levelData.getWildChunkCountZ();
+	levelData.wildChunks.resize(chunkCountX * chunkCountZ);
+	for (int z = 0; z < chunkCountZ; z++)
+	{
+		for (int x = 0; x < chunkCountX; x++)
+		{
+			WildChunk &wildChunk = levelData.wildChunks[x + (z * chunkCountX)];
+			wildChunk.flor.resize(RMDFile::ELEMENTS_PER_FLOOR);
+			wildChunk.map1.resize(RMDFile::ELEMENTS_PER_FLOOR);
+			wildChunk.map2.resize(RMDFile::ELEMENTS_PER_FLOOR);
+			wildChunk.isPacked = false;
+
+			const Int2 chunk(x, z);
+			ExteriorLevelData::copyWildChunkVoxels(chunk, gridWidth, gridDepth,
+				wildChunk.flor, tempFlor, false);
+			ExteriorLevelData::copyWildChunkVoxels(chunk, gridWidth, gridDepth,
+				wildChunk.map1, tempMap1, false);
+			ExteriorLevelData::copyWildChunkVoxels(chunk, gridWidth, gridDepth,
+				wildChunk.map2, tempMap2, false);
+		}
+	}
+
+	levelData.exeData = &exeData;
+
+	// Read the four .RMD files in the background, each written at some X and Z offset in
+	// the voxel data once it's done.
+	levelData.wildChunkLoader = std::make_unique<WildernessChunkLoader>();
+	levelData.wildChunkLoader->init();
+
+	auto addRMD = [gridWidth, gridDepth, &levelData](int rmdID, int xOffset, int zOffset)
+	{
+		const Int2 chunk = ExteriorLevelData::getWildChunkFromOffset(
+			xOffset, zOffset, gridWidth, gridDepth);
+		const Int2 voxelMin(chunk.x * RMDFile::WIDTH, chunk.y * RMDFile::DEPTH);
+		const Int2 voxelMax(voxelMin.x + RMDFile::WIDTH, voxelMin.y + RMDFile::DEPTH);
+		levelData.wildChunkLoader->add(chunk, voxelMin, voxelMax, rmdID);
+	};
+
+	addRMD(rmdTR, 0, 0); // Top right.
+	addRMD(rmdTL, RMDFile::WIDTH, 0); // Top left.
+	addRMD(rmdBR, 0, RMDFile::DEPTH); // Bottom right.
+	addRMD(rmdBL, RMDFile::WIDTH, RMDFile::DEPTH); // Bottom left.
+
 	// Generate random distant sky since this wilderness isn't anywhere in particular.
 	Random random;
 	const int localCityID = random.next() % 32;
@@ -802,6 +1085,60 @@ void ExteriorLevelData::setActive(TextureManager &textureManager, Renderer &rend
 	renderer.setDistantSky(this->distantSky);
 }
 
+void ExteriorLevelData::updateResidentChunks(const Int2 &playerVoxel, int chunkDistance)
+{
+	if (this->wildChunks.empty())
+	{
+		// Cities are always fully in the voxel grid.
+		return;
+	}
+
+	// Chunks nearest the player are read first.
+	if (this->wildChunkLoader != nullptr)
+	{
+		this->wildChunkLoader->setPriorityVoxel(playerVoxel);
+		this->writeFinishedWildChunks(false);
+	}
+
+	const int unloadDistance = chunkDistance + ExteriorLevelData::WILD_CHUNK_UNLOAD_MARGIN;
+	const int loadDistSqr = chunkDistance * chunkDistance;
+	const int unloadDistSqr = unloadDistance * unloadDistance;
+
+	const int chunkCountX = this->getWildChunkCountX();
+	const int chunkCountZ = this->getWildChunkCountZ();
+	for (int chunkZ = 0; chunkZ < chunkCountZ; chunkZ++)
+	{
+		for (int chunkX = 0; chunkX < chunkCountX; chunkX++)
+		{
+			// Distance from the player to the nearest voxel of the chunk.
+			const int minX = chunkX * RMDFile::WIDTH;
+			const int minZ = chunkZ * RMDFile::DEPTH;
+			const int maxX = minX + RMDFile::WIDTH - 1;
+			const int maxZ = minZ + RMDFile::DEPTH - 1;
+			const int diffX = std::max(std::max(minX - playerVoxel.x, playerVoxel.x - maxX), 0);
+			const int diffZ = std::max(std::max(minZ - playerVoxel.y, playerVoxel.y - maxZ), 0);
+			const int distSqr = (diffX * diffX) + (diffZ * diffZ);
+
+			const WildChunk &wildChunk = this->wildChunks[chunkX + (chunkZ * chunkCountX)];
+			const bool isResident = !wildChunk.isPacked;
+
+			if (!isResident && (distSqr <= loadDistSqr))
+			{
+				this->insertWildChunk(chunkX, chunkZ);
+			}
+			else if (isResident && (distSqr > unloadDistSqr))
+			{
+				this->removeWildChunk(chunkX, chunkZ);
+			}
+		}
+	}
+}
+
+void ExteriorLevelData::waitForChunks()
+{
+	this->writeFinishedWildChunks(true);
+}
+
 void ExteriorLevelData::tick(double dt)
 {
 	this->distantSky.tick(dt);
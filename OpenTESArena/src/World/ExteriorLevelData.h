@@ -2,22 +2,61 @@
 #define EXTERIOR_LEVEL_DATA_H
 
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "DistantSky.h"
 #include "LevelData.h"
+#include "WildernessChunkLoader.h"
 #include "../Assets/MiscAssets.h"
 #include "../Math/Vector2.h"
 
 class ExteriorLevelData : public LevelData
 {
 private:
+	// Wilderness chunks are brought into the voxel grid once the player is within the chunk
+	// distance of them (in voxels), and taken out again this many voxels past it.
+	static const int WILD_CHUNK_UNLOAD_MARGIN;
+
+	// A wilderness chunk's FLOR, MAP1, and MAP2 voxels in .RMD layout. They're run-length
+	// encoded while the chunk isn't in the voxel grid so far away chunks take less memory.
+	struct WildChunk
+	{
+		std::vector<uint16_t> flor, map1, map2;
+		bool isPacked;
+	};
+
+	// A generated city's voxels (after its blocks are placed and its palace graphics are
+	// revised) and building names, so entering it again doesn't generate it again.
+	struct CachedCity
+	{
+		uint64_t key;
+		std::vector<uint16_t> flor, map1, map2;
+		std::vector<std::pair<Int2, std::string>> menuNames;
+	};
+
+	// Most generated cities kept at once.
+	static const int MAX_CACHED_CITIES;
+
+	// Recently generated cities, least recently used first.
+	static std::deque<CachedCity> cachedCities;
+
 	DistantSky distantSky;
 
 	// Mappings of voxel coordinates to *MENU display names.
 	std::vector<std::pair<Int2, std::string>> menuNames;
 
+	// Wilderness only. Each chunk's voxels so it can be read into the voxel grid again when
+	// the player comes back near it. Empty for cities. Voxel data isn't stored per chunk
+	// since the level's data mappings already share it between every chunk.
+	std::vector<WildChunk> wildChunks;
+	const ExeData *exeData;
+
+	// Reads the wilderness .RMD files in the background. Null once they're all written.
+	std::unique_ptr<WildernessChunkLoader> wildChunkLoader;
+
 	ExteriorLevelData(int gridWidth, int gridHeight, int gridDepth, const std::string &infName,
 		const std::string &name);
 
@@ -27,6 +66,35 @@ private:
 		ArenaRandom &random, bool isCoastal, bool isCity, int gridWidth, int gridDepth,
 		const MiscAssets &miscAssets);
 
+	// Gets the number of wilderness chunks along each side of the voxel grid.
+	int getWildChunkCountX() const;
+	int getWildChunkCountZ() const;
+
+	// Gets the chunk coordinates of an .RMD file written at the given offset in the
+	// wilderness voxel data.
+	static Int2 getWildChunkFromOffset(int xOffset, int zOffset, int gridWidth, int gridDepth);
+
+	// Copies a chunk's voxels in .RMD layout to or from its place in voxels laid out like
+	// the whole wilderness.
+	static void copyWildChunkVoxels(const Int2 &chunk, int gridWidth, int gridDepth,
+		std::vector<uint16_t> &chunkVoxels, std::vector<uint16_t> &gridVoxels, bool toGrid);
+
+	// Run-length encodes or decodes a chunk's voxels.
+	static void packWildChunk(WildChunk &wildChunk);
+	static void unpackWildChunk(WildChunk &wildChunk);
+
+	// Copies a finished .RMD file into the chunk's voxels, replacing its placeholder voxels
+	// if it's in the voxel grid.
+	void writeWildChunk(const Int2 &chunk, const RMDFile &rmd);
+
+	// Writes any .RMD files the loader has finished. If wait is true, waits for every one.
+	void writeFinishedWildChunks(bool wait);
+
+	// Reads a wilderness chunk's voxels into the voxel grid, or clears them to air and packs
+	// them.
+	void insertWildChunk(int chunkX, int chunkZ);
+	void removeWildChunk(int chunkX, int chunkZ);
+
 	// This algorithm runs over the perimeter of a city map and changes palace graphics and
 	// their gates to the actual ones used in-game.
 	static void revisePalaceGraphics(std::vector<uint16_t> &map1, int gridWidth, int gridDepth);
@@ -63,6 +131,13 @@ public:
 	// Calls the base level data method then does some exterior-specific work.
 	virtual void setActive(TextureManager &textureManager, Renderer &renderer) override;
 
+	// Streams wilderness chunks in and out of the voxel grid by their distance to the player,
+	// and writes any chunks finished in the background.
+	virtual void updateResidentChunks(const Int2 &playerVoxel, int chunkDistance) override;
+
+	// Waits for the wilderness chunks still being read in the background.
+	virtual void waitForChunks() override;
+
 	// Updates data exclusive to exterior level data (such as animated distant land).
 	virtual void tick(double dt) override;
 };
@@ -7,6 +7,7 @@
 #include "WorldType.h"
 #include "../Assets/MiscAssets.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/Profiler.h"
 
 ExteriorWorldData::InteriorState::InteriorState(InteriorWorldData &&worldData,
 	const Int2 &returnVoxel)
@@ -145,6 +146,8 @@ ExteriorWorldData ExteriorWorldData::loadPremadeCity(const MIFFile &mif, Climate
 	WeatherType weatherType, int currentDay, int starCount, const MiscAssets &miscAssets,
 	TextureManager &textureManager)
 {
+	ProfilerZone("Load premade city");
+
 	const auto &level = mif.getLevels().front();
 	const std::string infName = ExteriorWorldData::generateCityInfName(climateType, weatherType);
 
@@ -177,6 +180,8 @@ ExteriorWorldData ExteriorWorldData::loadCity(int localCityID, int provinceID, c
 	const Int2 &startPosition, WeatherType weatherType, int currentDay, int starCount,
 	const MiscAssets &miscAssets, TextureManager &textureManager)
 {
+	ProfilerZone("Load city");
+
 	// Generate level.
 	const auto &level = mif.getLevels().front();
 
@@ -212,6 +217,8 @@ ExteriorWorldData ExteriorWorldData::loadWilderness(int rmdTR, int rmdTL, int rm
 	ClimateType climateType, WeatherType weatherType, int currentDay, int starCount,
 	const MiscAssets &miscAssets, TextureManager &textureManager)
 {
+	ProfilerZone("Load wilderness");
+
 	const std::string infName =
 		ExteriorWorldData::generateWildernessInfName(climateType, weatherType);
 
@@ -233,6 +240,12 @@ InteriorWorldData *ExteriorWorldData::getInterior() const
 	return (this->interior.get() != nullptr) ? &this->interior->worldData : nullptr;
 }
 
+const Int2 &ExteriorWorldData::getInteriorReturnVoxel() const
+{
+	DebugAssert(this->interior.get() != nullptr);
+	return this->interior->returnVoxel;
+}
+
 const std::string &ExteriorWorldData::getMifName() const
 {
 	return (this->interior.get() != nullptr) ?
@@ -63,6 +63,10 @@ public:
 	// Returns the current active interior (if any).
 	InteriorWorldData *getInterior() const;
 
+	// Gets the voxel the player returns to when leaving the active interior. Causes an error
+	// if no interior is active.
+	const Int2 &getInteriorReturnVoxel() const;
+
 	virtual const std::string &getMifName() const override;
 
 	virtual WorldType getBaseWorldType() const override;
@@ -1,4 +1,5 @@
 #include "InteriorLevelData.h"
+#include "LevelCache.h"
 #include "WorldType.h"
 #include "../Math/Random.h"
 #include "../Media/Color.h"
@@ -33,22 +34,34 @@ InteriorLevelData InteriorLevelData::loadInterior(const MIFFile::Level &level, i
 	levelData.skyColor = levelData.isOutdoorDungeon() ?
 		Color::Gray.toARGB() : Color::Black.toARGB();
 
-	// Empty voxel data (for air).
-	levelData.getVoxelGrid().addVoxelData(VoxelData());
-
-	// Load FLOR and MAP1 voxels.
-	levelData.readFLOR(level.flor.data(), inf, gridWidth, gridDepth);
-	levelData.readMAP1(level.map1.data(), inf, WorldType::Interior, gridWidth, gridDepth, exeData);
-
 	// All interiors have ceilings except some main quest dungeons which have a 1
 	// as the third number after *CEILING in their .INF file.
 	const bool hasCeiling = !inf.getCeiling().outdoorDungeon;
 
-	// Fill the second floor with ceiling tiles if it's an "indoor dungeon". Otherwise,
-	// leave it empty (for some "outdoor dungeons").
-	if (hasCeiling)
+	// Use the voxels from the level cache if they were built before.
+	const uint64_t cacheKey = InteriorLevelData::getCacheKey(
+		level.flor, level.map1, inf, hasCeiling, gridWidth, gridDepth);
+	if (!LevelCache::tryRead(cacheKey, levelData.getVoxelGrid()))
 	{
-		levelData.readCeiling(inf, gridWidth, gridDepth);
+		// Empty voxel data (for air).
+		levelData.getVoxelGrid().addVoxelData(VoxelData());
+
+		// Load FLOR and MAP1 voxels.
+		levelData.readFLOR(level.flor.get(), inf, gridWidth, gridDepth);
+		levelData.readMAP1(level.map1.get(), inf, WorldType::Interior, gridWidth, gridDepth, exeData);
+
+		// Fill the second floor with ceiling tiles if it's an "indoor dungeon". Otherwise,
+		// leave it empty (for some "outdoor dungeons").
+		if (hasCeiling)
+		{
+			levelData.readCeiling(inf, gridWidth, gridDepth);
+		}
+
+		LevelCache::write(cacheKey, levelData.getVoxelGrid());
+	}
+	else
+	{
+		levelData.updateVoxelChanges();
 	}
 
 	// Assign locks.
@@ -92,7 +105,7 @@ InteriorLevelData InteriorLevelData::loadDungeon(ArenaRandom &random,
 				const int dstIndex = dX + ((z + dZ) * gridDepth);
 
 				auto writeRow = [chunkDim, srcIndex, dstIndex](
-					const std::vector<uint16_t> &src, std::vector<uint16_t> &dst)
+					const BufferView<const uint16_t> &src, std::vector<uint16_t> &dst)
 				{
 					const auto srcBegin = src.begin() + srcIndex;
 					const auto srcEnd = srcBegin + chunkDim;
@@ -166,13 +179,28 @@ InteriorLevelData InteriorLevelData::loadDungeon(ArenaRandom &random,
 	// @todo: use actual color from palette.
 	levelData.skyColor = Color::Black.toARGB();
 
-	// Empty voxel data (for air).
-	levelData.getVoxelGrid().addVoxelData(VoxelData());
+	// Use the voxels from the level cache if they were built before. The dungeon seed is
+	// already in the generated FLOR and MAP1 voxels.
+	const uint64_t cacheKey = InteriorLevelData::getCacheKey(
+		BufferView<const uint16_t>(tempFlor.data(), static_cast<int>(tempFlor.size())),
+		BufferView<const uint16_t>(tempMap1.data(), static_cast<int>(tempMap1.size())),
+		inf, true, gridWidth, gridDepth);
+	if (!LevelCache::tryRead(cacheKey, levelData.getVoxelGrid()))
+	{
+		// Empty voxel data (for air).
+		levelData.getVoxelGrid().addVoxelData(VoxelData());
 
-	// Load FLOR, MAP1, and ceiling into the voxel grid.
-	levelData.readFLOR(tempFlor.data(), inf, gridWidth, gridDepth);
-	levelData.readMAP1(tempMap1.data(), inf, WorldType::Interior, gridWidth, gridDepth, exeData);
-	levelData.readCeiling(inf, gridWidth, gridDepth);
+		// Load FLOR, MAP1, and ceiling into the voxel grid.
+		levelData.readFLOR(tempFlor.data(), inf, gridWidth, gridDepth);
+		levelData.readMAP1(tempMap1.data(), inf, WorldType::Interior, gridWidth, gridDepth, exeData);
+		levelData.readCeiling(inf, gridWidth, gridDepth);
+
+		LevelCache::write(cacheKey, levelData.getVoxelGrid());
+	}
+	else
+	{
+		levelData.updateVoxelChanges();
+	}
 
 	// Load locks and triggers (if any).
 	levelData.readLocks(tempLocks, gridWidth, gridDepth);
@@ -181,14 +209,42 @@ InteriorLevelData InteriorLevelData::loadDungeon(ArenaRandom &random,
 	return levelData;
 }
 
+uint64_t InteriorLevelData::getCacheKey(const BufferView<const uint16_t> &flor,
+	const BufferView<const uint16_t> &map1, const INFFile &inf, bool hasCeiling,
+	int gridWidth, int gridDepth)
+{
+	// The .INF decides the texture IDs and ceiling. Its contents are hashed and not just its
+	// name, since the same name can come from game data that was patched or swapped.
+	const uint64_t infHash = inf.getSourceHash();
+	uint64_t key = LevelCache::hash(static_cast<int>(WorldType::Interior), LevelCache::EMPTY_KEY);
+	key = LevelCache::hash(gridWidth, key);
+	key = LevelCache::hash(gridDepth, key);
+	key = LevelCache::hash(inf.getName(), key);
+	key = LevelCache::hash(&infHash, sizeof(infHash), key);
+	key = LevelCache::hash(hasCeiling ? 1 : 0, key);
+	key = LevelCache::hash(flor.get(), flor.getCount() * sizeof(uint16_t), key);
+	key = LevelCache::hash(map1.get(), map1.getCount() * sizeof(uint16_t), key);
+	return key;
+}
+
 LevelData::TextTrigger *InteriorLevelData::getTextTrigger(const Int2 &voxel)
 {
+	if ((this->getVoxelFlags(voxel) & LevelData::VOXEL_TEXT_TRIGGER) == 0)
+	{
+		return nullptr;
+	}
+
 	const auto textIter = this->textTriggers.find(voxel);
 	return (textIter != this->textTriggers.end()) ? &textIter->second : nullptr;
 }
 
 const std::string *InteriorLevelData::getSoundTrigger(const Int2 &voxel) const
 {
+	if ((this->getVoxelFlags(voxel) & LevelData::VOXEL_SOUND_TRIGGER) == 0)
+	{
+		return nullptr;
+	}
+
 	const auto soundIter = this->soundTriggers.find(voxel);
 	return (soundIter != this->soundTriggers.end()) ? &soundIter->second : nullptr;
 }
@@ -217,11 +273,13 @@ void InteriorLevelData::readTriggers(const std::vector<ArenaTypes::MIFTrigger> &
 			const INFFile::TextData &textData = inf.getText(trigger.textIndex);
 			this->textTriggers.insert(std::make_pair(
 				voxel, TextTrigger(textData.text, textData.displayedOnce)));
+			this->addVoxelFlags(voxel, LevelData::VOXEL_TEXT_TRIGGER);
 		}
 
 		if (isSoundTrigger)
 		{
 			this->soundTriggers.insert(std::make_pair(voxel, inf.getSound(trigger.soundIndex)));
+			this->addVoxelFlags(voxel, LevelData::VOXEL_SOUND_TRIGGER);
 		}
 	}
 }
@@ -232,4 +290,11 @@ void InteriorLevelData::setActive(TextureManager &textureManager, Renderer &rend
 
 	// Set interior sky color.
 	renderer.setSkyPalette(&this->skyColor, 1);
+
+	// Interiors are enclosed rooms and corridors, so flats behind walls and closed doors
+	// can be skipped.
+	renderer.buildVisibilityRegions(this->getVoxelGrid());
+
+	// Interior floors and ceilings are flat planes, so they can be drawn a row at a time.
+	renderer.setScanlinePlanes(true);
 }
@@ -2,6 +2,7 @@
 #define INTERIOR_LEVEL_DATA_H
 
 #include "LevelData.h"
+#include "../Utilities/BufferView.h"
 
 class InteriorLevelData : public LevelData
 {
@@ -21,6 +22,11 @@ private:
 	InteriorLevelData(int gridWidth, int gridDepth, const std::string &infName,
 		const std::string &name);
 
+	// Gets the level cache key for an interior built from the given voxels and .INF.
+	static uint64_t getCacheKey(const BufferView<const uint16_t> &flor,
+		const BufferView<const uint16_t> &map1, const INFFile &inf, bool hasCeiling,
+		int gridWidth, int gridDepth);
+
 	void readTriggers(const std::vector<ArenaTypes::MIFTrigger> &triggers, const INFFile &inf,
 		int width, int depth);
 public:
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+
+#include "InteriorPrefetcher.h"
+#include "../Assets/ExeData.h"
+#include "../Assets/MIFFile.h"
+#include "../Utilities/Debug.h"
+
+const int InteriorPrefetcher::MAX_INTERIORS = 4;
+const int InteriorPrefetcher::DOOR_DISTANCE = 4;
+
+std::future<InteriorWorldData> InteriorPrefetcher::loadAsync(const std::string &mifName,
+	const ExeData &exeData, JobSystem::Priority priority)
+{
+	return JobSystem::submit(priority, [mifName, &exeData]()
+	{
+		MIFFile mif;
+		if (!mif.init(mifName.c_str()))
+		{
+			DebugCrash("Could not init .MIF file \"" + mifName + "\".");
+		}
+
+		return InteriorWorldData::loadInterior(mif, exeData);
+	});
+}
+
+void InteriorPrefetcher::prefetch(const std::string &mifName, const ExeData &exeData)
+{
+	const auto iter = std::find_if(this->entries.begin(), this->entries.end(),
+		[&mifName](const Entry &entry)
+	{
+		return entry.mifName == mifName;
+	});
+
+	if (iter != this->entries.end())
+	{
+		// Already kept. Move it to the back so it's dropped last.
+		Entry entry = std::move(*iter);
+		this->entries.erase(iter);
+		this->entries.push_back(std::move(entry));
+		return;
+	}
+
+	if (static_cast<int>(this->entries.size()) >= InteriorPrefetcher::MAX_INTERIORS)
+	{
+		const auto readyIter = std::find_if(this->entries.begin(), this->entries.end(),
+			[](const Entry &entry)
+		{
+			return entry.interior.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		});
+
+		if (readyIter == this->entries.end())
+		{
+			return;
+		}
+
+		this->entries.erase(readyIter);
+	}
+
+	Entry entry;
+	entry.mifName = mifName;
+	entry.interior = InteriorPrefetcher::loadAsync(mifName, exeData,
+		JobSystem::Priority::Background);
+	this->entries.push_back(std::move(entry));
+}
+
+std::future<InteriorWorldData> InteriorPrefetcher::take(const std::string &mifName)
+{
+	const auto iter = std::find_if(this->entries.begin(), this->entries.end(),
+		[&mifName](const Entry &entry)
+	{
+		return entry.mifName == mifName;
+	});
+
+	if (iter == this->entries.end())
+	{
+		return std::future<InteriorWorldData>();
+	}
+
+	std::future<InteriorWorldData> interior = std::move(iter->interior);
+	this->entries.erase(iter);
+	return interior;
+}
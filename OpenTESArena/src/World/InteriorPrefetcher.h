@@ -0,0 +1,50 @@
+#ifndef INTERIOR_PREFETCHER_H
+#define INTERIOR_PREFETCHER_H
+
+#include <deque>
+#include <future>
+#include <string>
+
+#include "InteriorWorldData.h"
+#include "../Utilities/JobSystem.h"
+
+// Loads the interiors behind nearby city doors on worker threads before the player reaches
+// them, so entering a building usually doesn't have to wait on decoding its .MIF and .INF.
+// Only a few interiors are kept, recently requested ones first. Textures are still loaded
+// when the interior is activated since the texture manager is main-thread only.
+
+class ExeData;
+
+class InteriorPrefetcher
+{
+public:
+	// Most interiors kept at once, including ones still loading.
+	static const int MAX_INTERIORS;
+
+	// Distance in voxels around the player that doors are prefetched from.
+	static const int DOOR_DISTANCE;
+private:
+	struct Entry
+	{
+		std::string mifName;
+		std::future<InteriorWorldData> interior;
+	};
+
+	// Oldest request first.
+	std::deque<Entry> entries;
+public:
+	// Starts loading the interior for a .MIF on a job thread.
+	static std::future<InteriorWorldData> loadAsync(const std::string &mifName,
+		const ExeData &exeData, JobSystem::Priority priority);
+
+	// Starts loading the interior for a .MIF unless it's already kept. If there's no room,
+	// the oldest finished interior is dropped, or nothing happens if all of them are still
+	// loading (dropping one would wait for its worker).
+	void prefetch(const std::string &mifName, const ExeData &exeData);
+
+	// Takes the interior for a .MIF out of the prefetcher, or returns an invalid future if it
+	// wasn't prefetched.
+	std::future<InteriorWorldData> take(const std::string &mifName);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "WorldType.h"
 #include "../Math/Random.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/Profiler.h"
 #include "../Utilities/String.h"
 
 InteriorWorldData::InteriorWorldData()
@@ -16,6 +17,8 @@ InteriorWorldData::~InteriorWorldData()
 
 InteriorWorldData InteriorWorldData::loadInterior(const MIFFile &mif, const ExeData &exeData)
 {
+	ProfilerZone("Load interior");
+
 	InteriorWorldData worldData;
 
 	// Generate levels.
@@ -41,6 +44,8 @@ InteriorWorldData InteriorWorldData::loadInterior(const MIFFile &mif, const ExeD
 InteriorWorldData InteriorWorldData::loadDungeon(uint32_t seed, int widthChunks, int depthChunks,
 	bool isArtifactDungeon, const ExeData &exeData)
 {
+	ProfilerZone("Load dungeon");
+
 	// Load the .MIF file with all the dungeon chunks in it. Dimensions should be 32x32.
 	const std::string mifName = "RANDOM1.MIF";
 	MIFFile mif;
@@ -142,6 +147,11 @@ int InteriorWorldData::getLevelCount() const
 	return static_cast<int>(this->levels.size());
 }
 
+const LevelData &InteriorWorldData::getLevel(int levelIndex) const
+{
+	return this->levels.at(levelIndex);
+}
+
 const std::string &InteriorWorldData::getMifName() const
 {
 	return this->mifName;
@@ -33,6 +33,9 @@ public:
 	// Gets the number of levels in the interior.
 	int getLevelCount() const;
 
+	// Gets a level by index, active or not.
+	const LevelData &getLevel(int levelIndex) const;
+
 	virtual const std::string &getMifName() const override;
 
 	// Always interior for interior world data.
@@ -0,0 +1,231 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "LevelCache.h"
+#include "VoxelData.h"
+#include "VoxelGrid.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/Platform.h"
+
+namespace
+{
+	// Voxel data is written as raw bytes.
+	static_assert(std::is_trivially_copyable<VoxelData>::value,
+		"VoxelData must be trivially copyable for the level cache.");
+
+	// Start of every cache file, followed by the voxel data list and then the voxel IDs. The
+	// full key is kept so a file is never used for a different key with the same filename.
+	struct Header
+	{
+		uint32_t magic, version, voxelDataSize;
+		uint32_t width, height, depth, voxelDataCount;
+		uint32_t unused; // Padding so no bytes of the file are uninitialized.
+		uint64_t key;
+	};
+
+	const uint32_t MAGIC = 0x4C564C4F; // "OLVL".
+}
+
+const uint32_t LevelCache::VERSION = 2;
+const uint64_t LevelCache::EMPTY_KEY = 14695981039346656037ULL; // FNV-1a offset basis.
+std::string LevelCache::folder;
+
+std::string LevelCache::getFilename(uint64_t key)
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.lvl", static_cast<unsigned long long>(key));
+	return LevelCache::folder + name;
+}
+
+void LevelCache::setFolder(const std::string &folder)
+{
+	LevelCache::folder = folder;
+
+	if (!folder.empty() && !Platform::directoryExists(folder))
+	{
+		Platform::createDirectoryRecursively(folder);
+	}
+}
+
+bool LevelCache::isEnabled()
+{
+	return !LevelCache::folder.empty();
+}
+
+uint64_t LevelCache::hash(const void *data, size_t size, uint64_t key)
+{
+	// FNV-1a.
+	const uint8_t *bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		key = (key ^ bytes[i]) * 1099511628211ULL;
+	}
+
+	return key;
+}
+
+uint64_t LevelCache::hash(const std::string &str, uint64_t key)
+{
+	// Include the length so neighbouring strings can't run together.
+	key = LevelCache::hash(static_cast<int>(str.size()), key);
+	return LevelCache::hash(str.data(), str.size(), key);
+}
+
+uint64_t LevelCache::hash(int value, uint64_t key)
+{
+	return LevelCache::hash(&value, sizeof(value), key);
+}
+
+bool LevelCache::tryRead(uint64_t key, VoxelGrid &voxelGrid)
+{
+	DebugAssert(voxelGrid.getVoxelDataCount() == 0);
+
+	if (!LevelCache::isEnabled())
+	{
+		return false;
+	}
+
+	std::ifstream ifs(LevelCache::getFilename(key), std::ios::binary);
+	if (!ifs.is_open())
+	{
+		return false;
+	}
+
+	const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(ifs)),
+		std::istreambuf_iterator<char>());
+
+	// Reject files from other versions or for a different grid size.
+	Header header;
+	if (bytes.size() < sizeof(header))
+	{
+		return false;
+	}
+
+	std::memcpy(&header, bytes.data(), sizeof(header));
+
+	const int voxelCount = voxelGrid.getWidth() * voxelGrid.getHeight() * voxelGrid.getDepth();
+	const size_t expectedSize = sizeof(header) +
+		(static_cast<size_t>(header.voxelDataCount) * sizeof(VoxelData)) +
+		(static_cast<size_t>(voxelCount) * sizeof(uint16_t));
+	if ((header.magic != MAGIC) || (header.version != LevelCache::VERSION) ||
+		(header.key != key) || (header.voxelDataSize != sizeof(VoxelData)) ||
+		(header.width != static_cast<uint32_t>(voxelGrid.getWidth())) ||
+		(header.height != static_cast<uint32_t>(voxelGrid.getHeight())) ||
+		(header.depth != static_cast<uint32_t>(voxelGrid.getDepth())) ||
+		(header.voxelDataCount == 0) || (bytes.size() != expectedSize))
+	{
+		DebugLogWarning("Ignoring stale level cache file \"" +
+			LevelCache::getFilename(key) + "\".");
+		return false;
+	}
+
+	const uint8_t *voxelDataBytes = bytes.data() + sizeof(header);
+	const uint8_t *voxelBytes = voxelDataBytes + (header.voxelDataCount * sizeof(VoxelData));
+
+	// Make sure every voxel ID points at voxel data before touching the grid.
+	const uint16_t *voxels = reinterpret_cast<const uint16_t*>(voxelBytes);
+	for (int i = 0; i < voxelCount; i++)
+	{
+		uint16_t voxel;
+		std::memcpy(&voxel, voxels + i, sizeof(voxel));
+		if (voxel >= header.voxelDataCount)
+		{
+			DebugLogWarning("Ignoring corrupt level cache file \"" +
+				LevelCache::getFilename(key) + "\".");
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < header.voxelDataCount; i++)
+	{
+		VoxelData voxelData;
+		std::memcpy(&voxelData, voxelDataBytes + (i * sizeof(VoxelData)), sizeof(VoxelData));
+		voxelGrid.addVoxelData(voxelData);
+	}
+
+	// Setting each voxel rebuilds the grid's category bits and empty block counts. Air is
+	// already zero.
+	const int width = voxelGrid.getWidth();
+	const int height = voxelGrid.getHeight();
+	const int depth = voxelGrid.getDepth();
+	for (int z = 0; z < depth; z++)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				const int index = x + (y * width) + (z * width * height);
+				uint16_t voxel;
+				std::memcpy(&voxel, voxels + index, sizeof(voxel));
+				if (voxel != 0)
+				{
+					voxelGrid.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+void LevelCache::write(uint64_t key, const VoxelGrid &voxelGrid)
+{
+	if (!LevelCache::isEnabled())
+	{
+		return;
+	}
+
+	Header header;
+	header.magic = MAGIC;
+	header.version = LevelCache::VERSION;
+	header.voxelDataSize = sizeof(VoxelData);
+	header.width = static_cast<uint32_t>(voxelGrid.getWidth());
+	header.height = static_cast<uint32_t>(voxelGrid.getHeight());
+	header.depth = static_cast<uint32_t>(voxelGrid.getDepth());
+	header.voxelDataCount = static_cast<uint32_t>(voxelGrid.getVoxelDataCount());
+	header.unused = 0;
+	header.key = key;
+
+	// Write to a temporary file first so a half-written file is never read.
+	const std::string filename = LevelCache::getFilename(key);
+	const std::string tempFilename = filename + ".tmp";
+	{
+		std::ofstream ofs(tempFilename, std::ios::binary);
+		if (!ofs.is_open())
+		{
+			DebugLogWarning("Could not open \"" + tempFilename + "\" for writing.");
+			return;
+		}
+
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (uint32_t i = 0; i < header.voxelDataCount; i++)
+		{
+			const VoxelData &voxelData = voxelGrid.getVoxelData(static_cast<uint16_t>(i));
+			ofs.write(reinterpret_cast<const char*>(&voxelData), sizeof(voxelData));
+		}
+
+		const int voxelCount = voxelGrid.getWidth() * voxelGrid.getHeight() * voxelGrid.getDepth();
+		ofs.write(reinterpret_cast<const char*>(voxelGrid.getVoxels()),
+			voxelCount * sizeof(uint16_t));
+
+		if (!ofs.good())
+		{
+			DebugLogWarning("Could not write level cache file \"" + tempFilename + "\".");
+			ofs.close();
+			std::remove(tempFilename.c_str());
+			return;
+		}
+	}
+
+	std::remove(filename.c_str());
+	if (std::rename(tempFilename.c_str(), filename.c_str()) != 0)
+	{
+		DebugLogWarning("Could not rename \"" + tempFilename + "\" to \"" + filename + "\".");
+		std::remove(tempFilename.c_str());
+	}
+}
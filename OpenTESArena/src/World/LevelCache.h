@@ -0,0 +1,51 @@
+#ifndef LEVEL_CACHE_H
+#define LEVEL_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Opt-in on-disk cache of built voxel grids, so loading a level that was built before is one
+// file read instead of decoding its FLOR, MAP1, and ceiling voxels again. Each file is named
+// by a key hashed from everything that decides how the level is built (its source voxels,
+// .INF contents, dungeon seed, etc.), so a changed source just misses the cache.
+
+// The file is the voxel data list and voxel IDs as they are in memory. Only the grid's
+// derived data (category bits, empty block counts) is rebuilt after reading.
+
+class VoxelGrid;
+
+class LevelCache
+{
+private:
+	// Incremented whenever the file layout or the voxel decoding changes.
+	static const uint32_t VERSION;
+
+	// Folder the cache files are in. Empty if the cache is off.
+	static std::string folder;
+
+	static std::string getFilename(uint64_t key);
+public:
+	// Starting value for hashing a key.
+	static const uint64_t EMPTY_KEY;
+
+	// Sets the folder for cache files, creating it if needed. An empty folder turns the cache
+	// off. Should be set once before any levels are loaded.
+	static void setFolder(const std::string &folder);
+
+	static bool isEnabled();
+
+	// Mixes some bytes into a key.
+	static uint64_t hash(const void *data, size_t size, uint64_t key);
+	static uint64_t hash(const std::string &str, uint64_t key);
+	static uint64_t hash(int value, uint64_t key);
+
+	// Tries to fill an empty voxel grid from the cache file for the key. Returns false and
+	// leaves the grid untouched if there is no usable file.
+	static bool tryRead(uint64_t key, VoxelGrid &voxelGrid);
+
+	// Writes a voxel grid to the cache file for the key. Failures are only logged.
+	static void write(uint64_t key, const VoxelGrid &voxelGrid);
+};
+
+#endif
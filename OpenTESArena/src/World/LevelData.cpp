@@ -1,5 +1,4 @@
 #include <algorithm>
-#include <functional>
 
 #include "LevelData.h"
 #include "VoxelData.h"
@@ -8,13 +7,18 @@
 #include "../Assets/INFFile.h"
 #include "../Math/Constants.h"
 #include "../Math/Random.h"
+#include "../Media/PaletteFile.h"
+#include "../Media/PaletteName.h"
 #include "../Media/TextureManager.h"
 #include "../Rendering/Renderer.h"
 #include "../Utilities/Bytes.h"
 #include "../Utilities/Debug.h"
+#include "../Utilities/Profiler.h"
 #include "../Utilities/String.h"
 #include "../World/WorldType.h"
 
+#include "components/vfs/manager.hpp"
+
 LevelData::Lock::Lock(const Int2 &position, int lockLevel)
 	: position(position)
 {
@@ -79,6 +83,11 @@ double LevelData::DoorState::getPercentOpen() const
 	return this->percentOpen;
 }
 
+LevelData::DoorState::Direction LevelData::DoorState::getDirection() const
+{
+	return this->direction;
+}
+
 bool LevelData::DoorState::isClosing() const
 {
 	return this->direction == Direction::Closing;
@@ -120,14 +129,89 @@ void LevelData::DoorState::update(double dt)
 	}
 }
 
+const std::vector<LevelData::DoorState> &LevelData::OpenDoors::getDoors() const
+{
+	return this->doors;
+}
+
+int LevelData::OpenDoors::getCount() const
+{
+	return static_cast<int>(this->doors.size());
+}
+
+LevelData::DoorState &LevelData::OpenDoors::get(int index)
+{
+	return this->doors.at(index);
+}
+
+LevelData::DoorState *LevelData::OpenDoors::find(const Int2 &voxel)
+{
+	const auto iter = this->indices.find(voxel);
+	return (iter != this->indices.end()) ? &this->doors[iter->second] : nullptr;
+}
+
+const LevelData::DoorState *LevelData::OpenDoors::find(const Int2 &voxel) const
+{
+	const auto iter = this->indices.find(voxel);
+	return (iter != this->indices.end()) ? &this->doors[iter->second] : nullptr;
+}
+
+void LevelData::OpenDoors::add(const Int2 &voxel)
+{
+	this->add(DoorState(voxel));
+}
+
+void LevelData::OpenDoors::add(const DoorState &door)
+{
+	DebugAssert(this->indices.find(door.getVoxel()) == this->indices.end());
+	this->indices.insert(std::make_pair(door.getVoxel(), static_cast<int>(this->doors.size())));
+	this->doors.push_back(door);
+}
+
+void LevelData::OpenDoors::remove(const Int2 &voxel)
+{
+	const auto iter = this->indices.find(voxel);
+	DebugAssert(iter != this->indices.end());
+
+	// Move the last door into the removed door's place.
+	const int index = iter->second;
+	const int lastIndex = static_cast<int>(this->doors.size()) - 1;
+	this->indices.erase(iter);
+
+	if (index != lastIndex)
+	{
+		this->doors[index] = this->doors[lastIndex];
+		this->indices[this->doors[index].getVoxel()] = index;
+	}
+
+	this->doors.pop_back();
+}
+
+void LevelData::OpenDoors::clear()
+{
+	this->doors.clear();
+	this->indices.clear();
+}
+
+const uint8_t LevelData::VOXEL_LOCK = 1 << 0;
+const uint8_t LevelData::VOXEL_TEXT_TRIGGER = 1 << 1;
+const uint8_t LevelData::VOXEL_SOUND_TRIGGER = 1 << 2;
+const uint8_t LevelData::VOXEL_DOOR = 1 << 3;
+const uint8_t LevelData::VOXEL_MENU = 1 << 4;
+
 LevelData::LevelData(int gridWidth, int gridHeight, int gridDepth, const std::string &infName,
 	const std::string &name)
 	: voxelGrid(gridWidth, gridHeight, gridDepth), name(name)
 {
+	this->voxelFlags = std::vector<uint8_t>(gridWidth * gridDepth, 0);
+	this->voxelChangeCount = this->voxelGrid.getChangeCount();
+
 	if (!this->inf.init(infName.c_str()))
 	{
 		DebugCrash("Could not init .INF file \"" + infName + "\".");
 	}
+
+	this->prefetchFiles();
 }
 
 LevelData::~LevelData()
@@ -145,12 +229,12 @@ double LevelData::getCeilingHeight() const
 	return static_cast<double>(this->inf.getCeiling().height) / MIFFile::ARENA_UNITS;
 }
 
-std::vector<LevelData::DoorState> &LevelData::getOpenDoors()
+LevelData::OpenDoors &LevelData::getOpenDoors()
 {
 	return this->openDoors;
 }
 
-const std::vector<LevelData::DoorState> &LevelData::getOpenDoors() const
+const LevelData::OpenDoors &LevelData::getOpenDoors() const
 {
 	return this->openDoors;
 }
@@ -160,6 +244,11 @@ const INFFile &LevelData::getInfFile() const
 	return this->inf;
 }
 
+Automap &LevelData::getAutomap()
+{
+	return this->automap;
+}
+
 VoxelGrid &LevelData::getVoxelGrid()
 {
 	return this->voxelGrid;
@@ -172,16 +261,108 @@ const VoxelGrid &LevelData::getVoxelGrid() const
 
 const LevelData::Lock *LevelData::getLock(const Int2 &voxel) const
 {
+	if ((this->getVoxelFlags(voxel) & LevelData::VOXEL_LOCK) == 0)
+	{
+		return nullptr;
+	}
+
 	const auto lockIter = this->locks.find(voxel);
 	return (lockIter != this->locks.end()) ? &lockIter->second : nullptr;
 }
 
+uint8_t LevelData::getVoxelFlags(const Int2 &voxel) const
+{
+	const int width = this->voxelGrid.getWidth();
+	const int depth = this->voxelGrid.getDepth();
+	if ((voxel.x < 0) || (voxel.x >= width) || (voxel.y < 0) || (voxel.y >= depth))
+	{
+		return 0;
+	}
+
+	return this->voxelFlags[voxel.x + (voxel.y * width)];
+}
+
+void LevelData::addVoxelFlags(const Int2 &voxel, uint8_t flags)
+{
+	DebugAssert((voxel.x >= 0) && (voxel.x < this->voxelGrid.getWidth()));
+	DebugAssert((voxel.y >= 0) && (voxel.y < this->voxelGrid.getDepth()));
+	this->voxelFlags[voxel.x + (voxel.y * this->voxelGrid.getWidth())] |= flags;
+}
+
+void LevelData::updateVoxelFlags(int x, int z)
+{
+	const VoxelData &voxelData = this->voxelGrid.getVoxelData(this->voxelGrid.getVoxel(x, 1, z));
+	const uint8_t flags = [&voxelData]() -> uint8_t
+	{
+		if (voxelData.dataType == VoxelDataType::Door)
+		{
+			return LevelData::VOXEL_DOOR;
+		}
+		else if ((voxelData.dataType == VoxelDataType::Wall) && voxelData.wall.isMenu())
+		{
+			return LevelData::VOXEL_MENU;
+		}
+		else
+		{
+			return 0;
+		}
+	}();
+
+	uint8_t &voxelFlags = this->voxelFlags[x + (z * this->voxelGrid.getWidth())];
+	voxelFlags = static_cast<uint8_t>(
+		(voxelFlags & ~(LevelData::VOXEL_DOOR | LevelData::VOXEL_MENU)) | flags);
+}
+
+void LevelData::updateVoxelFlags()
+{
+	for (int z = 0; z < this->voxelGrid.getDepth(); z++)
+	{
+		for (int x = 0; x < this->voxelGrid.getWidth(); x++)
+		{
+			this->updateVoxelFlags(x, z);
+		}
+	}
+}
+
+void LevelData::updateVoxelChanges()
+{
+	const Int3 *changedVoxels;
+	int changedVoxelCount;
+	if (this->voxelGrid.getChangedVoxels(this->voxelChangeCount, &changedVoxels,
+		&changedVoxelCount))
+	{
+		// Only the main floor has door and menu bits.
+		for (int i = 0; i < changedVoxelCount; i++)
+		{
+			const Int3 &voxel = changedVoxels[i];
+			if (voxel.y == 1)
+			{
+				this->updateVoxelFlags(voxel.x, voxel.z);
+			}
+		}
+	}
+	else
+	{
+		this->updateVoxelFlags();
+	}
+
+	this->voxelChangeCount = this->voxelGrid.getChangeCount();
+}
+
 void LevelData::setVoxel(int x, int y, int z, uint16_t id)
 {
+	// The automap and renderer pick up the change from the voxel grid when they next use it.
 	this->voxelGrid.setVoxel(x, y, z, id);
+	this->updateVoxelChanges();
 }
 
 void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth, int gridDepth)
+{
+	this->readFLOR(flor, inf, gridWidth, gridDepth, Int2(0, 0), Int2(gridWidth, gridDepth));
+}
+
+void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth, int gridDepth,
+	const Int2 &voxelMin, const Int2 &voxelMax)
 {
 	// Lambda for obtaining a two-byte FLOR voxel.
 	auto getFlorVoxel = [flor, gridWidth, gridDepth](int x, int z)
@@ -192,10 +373,15 @@ void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth
 		return voxel;
 	};
 
+	// Floors come in long runs of the same voxel, so the last one's data index is kept to
+	// skip the mapping lookup.
+	int lastFlorVoxel = -1;
+	int lastFloorDataIndex = 0;
+
 	// Write the voxel IDs into the voxel grid.
-	for (int x = 0; x < gridWidth; x++)
+	for (int x = voxelMin.x; x < voxelMax.x; x++)
 	{
-		for (int z = 0; z < gridDepth; z++)
+		for (int z = voxelMin.y; z < voxelMax.y; z++)
 		{
 			auto getFloorTextureID = [](uint16_t voxel)
 			{
@@ -217,7 +403,7 @@ void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth
 			{
 				// Get the voxel data index associated with the floor value, or add it
 				// if it doesn't exist yet.
-				const int dataIndex = [this, florVoxel, floorTextureID]()
+				auto getFloorDataIndex = [this, florVoxel, floorTextureID]()
 				{
 					const auto floorIter = this->floorDataMappings.find(florVoxel);
 					if (floorIter != this->floorDataMappings.end())
@@ -226,14 +412,20 @@ void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth
 					}
 					else
 					{
-						const int index = this->voxelGrid.addVoxelData(
+						const int index = this->voxelGrid.findOrAdd(
 							VoxelData::makeFloor(floorTextureID));
 						return this->floorDataMappings.insert(
 							std::make_pair(florVoxel, index)).first->second;
 					}
-				}();
+				};
 
-				this->setVoxel(x, 0, z, dataIndex);
+				if (florVoxel != lastFlorVoxel)
+				{
+					lastFloorDataIndex = getFloorDataIndex();
+					lastFlorVoxel = florVoxel;
+				}
+
+				this->setVoxel(x, 0, z, lastFloorDataIndex);
 			}
 			else
 			{
@@ -256,7 +448,7 @@ void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth
 				// inserting it into the chasm data mappings if it hasn't been already. The
 				// function parameter decodes the voxel and returns the created VoxelData.
 				auto getChasmDataIndex = [this, &inf, florVoxel, &adjacentFaces](
-					const std::function<VoxelData(void)> &function)
+					const auto &function)
 				{
 					const auto chasmPair = std::make_pair(florVoxel, adjacentFaces);
 					const auto chasmIter = this->chasmDataMappings.find(chasmPair);
@@ -266,7 +458,7 @@ void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth
 					}
 					else
 					{
-						const int index = this->voxelGrid.addVoxelData(function());
+						const int index = this->voxelGrid.findOrAdd(function());
 						return this->chasmDataMappings.insert(
 							std::make_pair(chasmPair, index)).first->second;
 					}
@@ -369,6 +561,14 @@ void LevelData::readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth
 
 void LevelData::readMAP1(const uint16_t *map1, const INFFile &inf, WorldType worldType,
 	int gridWidth, int gridDepth, const ExeData &exeData)
+{
+	this->readMAP1(map1, inf, worldType, gridWidth, gridDepth, exeData,
+		Int2(0, 0), Int2(gridWidth, gridDepth));
+}
+
+void LevelData::readMAP1(const uint16_t *map1, const INFFile &inf, WorldType worldType,
+	int gridWidth, int gridDepth, const ExeData &exeData, const Int2 &voxelMin,
+	const Int2 &voxelMax)
 {
 	// Lambda for obtaining a two-byte MAP1 voxel.
 	auto getMap1Voxel = [map1, gridWidth, gridDepth](int x, int z)
@@ -379,29 +579,42 @@ void LevelData::readMAP1(const uint16_t *map1, const INFFile &inf, WorldType wor
 		return voxel;
 	};
 
+	// Walls come in runs of the same voxel, so the last one's data index is kept to skip the
+	// mapping lookup.
+	int lastMap1Voxel = -1;
+	int lastDataIndex = 0;
+
 	// Write the voxel IDs into the voxel grid.
-	for (int x = 0; x < gridWidth; x++)
+	for (int x = voxelMin.x; x < voxelMax.x; x++)
 	{
-		for (int z = 0; z < gridDepth; z++)
+		for (int z = voxelMin.y; z < voxelMax.y; z++)
 		{
 			const uint16_t map1Voxel = getMap1Voxel(x, z);
 
 			// Lambda for obtaining the index of a newly-added VoxelData object, and inserting
 			// it into the data mappings if it hasn't been already. The function parameter
 			// decodes the voxel and returns the created VoxelData.
-			auto getDataIndex = [this, map1Voxel](const std::function<VoxelData(void)> &function)
+			auto getDataIndex = [this, map1Voxel, &lastMap1Voxel, &lastDataIndex](
+				const auto &function)
 			{
+				if (map1Voxel == lastMap1Voxel)
+				{
+					return lastDataIndex;
+				}
+
 				const auto wallIter = this->wallDataMappings.find(map1Voxel);
 				if (wallIter != this->wallDataMappings.end())
 				{
-					return wallIter->second;
+					lastDataIndex = wallIter->second;
 				}
 				else
 				{
-					const int index = this->voxelGrid.addVoxelData(function());
-					return this->wallDataMappings.insert(
-						std::make_pair(map1Voxel, index)).first->second;
+					lastDataIndex = this->voxelGrid.findOrAdd(function());
+					this->wallDataMappings.insert(std::make_pair(map1Voxel, lastDataIndex));
 				}
+
+				lastMap1Voxel = map1Voxel;
+				return lastDataIndex;
 			};
 
 			if ((map1Voxel & 0x8000) == 0)
@@ -527,7 +740,7 @@ void LevelData::readMAP1(const uint16_t *map1, const INFFile &inf, WorldType wor
 								}
 							}();
 
-							const auto &wallHeightTables = exeData.wallHeightTables;
+							const auto &wallHeightTables = exeData.getWallHeightTables();
 							const int heightIndex = mostSigByte & 0x07;
 							const int thicknessIndex = (mostSigByte & 0x78) >> 3;
 							int baseOffset, baseSize;
@@ -727,6 +940,12 @@ void LevelData::readMAP1(const uint16_t *map1, const INFFile &inf, WorldType wor
 }
 
 void LevelData::readMAP2(const uint16_t *map2, const INFFile &inf, int gridWidth, int gridDepth)
+{
+	this->readMAP2(map2, inf, gridWidth, gridDepth, Int2(0, 0), Int2(gridWidth, gridDepth));
+}
+
+void LevelData::readMAP2(const uint16_t *map2, const INFFile &inf, int gridWidth, int gridDepth,
+	const Int2 &voxelMin, const Int2 &voxelMax)
 {
 	// Lambda for obtaining a two-byte MAP2 voxel.
 	auto getMap2Voxel = [map2, gridWidth, gridDepth](int x, int z)
@@ -737,10 +956,14 @@ void LevelData::readMAP2(const uint16_t *map2, const INFFile &inf, int gridWidth
 		return voxel;
 	};
 
+	// Same as MAP1, the last voxel's data index is kept to skip the mapping lookup.
+	int lastMap2Voxel = -1;
+	int lastDataIndex = 0;
+
 	// Write the voxel IDs into the voxel grid.
-	for (int x = 0; x < gridWidth; x++)
+	for (int x = voxelMin.x; x < voxelMax.x; x++)
 	{
-		for (int z = 0; z < gridDepth; z++)
+		for (int z = voxelMin.y; z < voxelMax.y; z++)
 		{
 			const uint16_t map2Voxel = getMap2Voxel(x, z);
 
@@ -767,7 +990,7 @@ void LevelData::readMAP2(const uint16_t *map2, const INFFile &inf, int gridWidth
 					}
 				}();
 
-				const int dataIndex = [this, &inf, map2Voxel, height]()
+				auto getDataIndex = [this, &inf, map2Voxel, height]()
 				{
 					const auto map2Iter = this->map2DataMappings.find(map2Voxel);
 					if (map2Iter != this->map2DataMappings.end())
@@ -778,23 +1001,56 @@ void LevelData::readMAP2(const uint16_t *map2, const INFFile &inf, int gridWidth
 					{
 						const int textureIndex = (map2Voxel & 0x007F) - 1;
 						const int *menuID = nullptr;
-						const int index = this->voxelGrid.addVoxelData(VoxelData::makeWall(
+						const int index = this->voxelGrid.findOrAdd(VoxelData::makeWall(
 							textureIndex, textureIndex, textureIndex, menuID,
 							VoxelData::WallData::Type::Solid));
 						return this->map2DataMappings.insert(
 							std::make_pair(map2Voxel, index)).first->second;
 					}
-				}();
+				};
+
+				if (map2Voxel != lastMap2Voxel)
+				{
+					lastDataIndex = getDataIndex();
+					lastMap2Voxel = map2Voxel;
+				}
 
 				for (int y = 2; y < (height + 2); y++)
 				{
-					this->setVoxel(x, y, z, dataIndex);
+					this->setVoxel(x, y, z, lastDataIndex);
 				}
 			}
 		}
 	}
 }
 
+void LevelData::clearVoxels(const Int2 &voxelMin, const Int2 &voxelMax)
+{
+	for (int x = voxelMin.x; x < voxelMax.x; x++)
+	{
+		for (int y = 0; y < this->voxelGrid.getHeight(); y++)
+		{
+			for (int z = voxelMin.y; z < voxelMax.y; z++)
+			{
+				if (this->voxelGrid.getVoxel(x, y, z) != 0)
+				{
+					this->setVoxel(x, y, z, 0);
+				}
+			}
+		}
+	}
+
+	for (int i = this->openDoors.getCount() - 1; i >= 0; i--)
+	{
+		const Int2 voxel = this->openDoors.get(i).getVoxel();
+		if ((voxel.x >= voxelMin.x) && (voxel.x < voxelMax.x) &&
+			(voxel.y >= voxelMin.y) && (voxel.y < voxelMax.y))
+		{
+			this->openDoors.remove(voxel);
+		}
+	}
+}
+
 void LevelData::readCeiling(const INFFile &inf, int width, int depth)
 {
 	const INFFile::CeilingData &ceiling = inf.getCeiling();
@@ -808,7 +1064,7 @@ void LevelData::readCeiling(const INFFile &inf, int width, int depth)
 	}();
 
 	// Define the ceiling voxel data.
-	const int index = this->voxelGrid.addVoxelData(
+	const int index = this->voxelGrid.findOrAdd(
 		VoxelData::makeCeiling(ceilingIndex));
 
 	// Set all the ceiling voxels.
@@ -829,11 +1085,14 @@ void LevelData::readLocks(const std::vector<ArenaTypes::MIFLock> &locks, int wid
 			Int2(lock.x, lock.y), width, depth);
 		this->locks.insert(std::make_pair(
 			lockPosition, LevelData::Lock(lockPosition, lock.lockLevel)));
+		this->addVoxelFlags(lockPosition, LevelData::VOXEL_LOCK);
 	}
 }
 
 void LevelData::setActive(TextureManager &textureManager, Renderer &renderer)
 {
+	ProfilerZone("Activate level");
+
 	// Clear all entities.
 	// @todo: entities.
 	/*for (const auto *entity : this->entityManager.getAllEntities())
@@ -845,9 +1104,21 @@ void LevelData::setActive(TextureManager &textureManager, Renderer &renderer)
 	// Clear renderer textures and distant sky.
 	renderer.clearTextures();
 	renderer.clearDistantSky();
-
-	// Load .INF voxel textures into the renderer.
+	renderer.clearVisibilityRegions();
+	renderer.setScanlinePlanes(false);
+
+	// Give the renderer the palette that voxel and flat textures are made from, for
+	// palette mode.
+	const Surface &paletteSurface = textureManager.getSurface(
+		PaletteFile::fromName(PaletteName::Default));
+	renderer.setTexturePalette(static_cast<const uint32_t*>(paletteSurface.getPixels()),
+		paletteSurface.getWidth() * paletteSurface.getHeight());
+
+	// Load .INF voxel textures into the renderer. The surfaces are found first, then the
+	// renderer converts them all at once (the texture manager only evicts surfaces between
+	// frames, so their pixels stay valid until then).
 	const int voxelTextureCount = static_cast<int>(this->inf.getVoxelTextures().size());
+	std::vector<const uint32_t*> voxelTexels(voxelTextureCount, nullptr);
 	for (int i = 0; i < voxelTextureCount; i++)
 	{
 		const auto &textureData = this->inf.getVoxelTextures().at(i);
@@ -864,12 +1135,12 @@ void LevelData::setActive(TextureManager &textureManager, Renderer &renderer)
 			// Use the texture data's .SET index to obtain the correct surface.
 			const auto &surfaces = textureManager.getSurfaces(textureName);
 			const Surface &surface = surfaces.at(textureData.setIndex.value());
-			renderer.setVoxelTexture(i, static_cast<const uint32_t*>(surface.getPixels()));
+			voxelTexels[i] = static_cast<const uint32_t*>(surface.getPixels());
 		}
 		else if (isIMG)
 		{
 			const Surface &surface = textureManager.getSurface(textureName);
-			renderer.setVoxelTexture(i, static_cast<const uint32_t*>(surface.getPixels()));
+			voxelTexels[i] = static_cast<const uint32_t*>(surface.getPixels());
 		}
 		else if (noExtension)
 		{
@@ -883,6 +1154,8 @@ void LevelData::setActive(TextureManager &textureManager, Renderer &renderer)
 		}
 	}
 
+	renderer.setVoxelTextures(voxelTexels);
+
 	// Load .INF flat textures into the renderer.
 	// - @todo: maybe turn this into a while loop, so the index variable can be incremented
 	//   by the size of each .DFA. It's incorrect as-is.
@@ -899,12 +1172,16 @@ void LevelData::setActive(TextureManager &textureManager, Renderer &renderer)
 		{
 			// @todo: creatures don't have .DFA files (although they're referenced in the .INF
 			// files), so I think the extension needs to be .CFA instead for them.
+			// - All of an animation's frames go in one flat texture, and flats select one
+			//   with their frame index.
 			//const auto &surfaces = textureManager.getSurfaces(textureName);
-			//for (const auto *surface : surfaces)
+			//std::vector<const uint32_t*> frames;
+			//for (const auto &surface : surfaces)
 			//{
-			//renderer.addTexture(static_cast<const uint32_t*>(surface->pixels),
-			//surface->w, surface->h);
+			//frames.push_back(static_cast<const uint32_t*>(surface.getPixels()));
 			//}
+			//renderer.setFlatTextureFrames(i, frames, surfaces.front().getWidth(),
+			//surfaces.front().getHeight());
 		}
 		else if (isIMG)
 		{
@@ -923,6 +1200,58 @@ void LevelData::setActive(TextureManager &textureManager, Renderer &renderer)
 			DebugCrash("Unrecognized texture extension \"" + extension + "\".");
 		}
 	}*/
+
+	// Bake the level's lights in the background so they don't need to be evaluated each frame.
+	renderer.bakeLights(this->voxelGrid, this->getCeilingHeight());
+}
+
+void LevelData::prefetchFiles() const
+{
+	std::vector<std::string> filenames;
+	for (const auto &textureData : this->inf.getVoxelTextures())
+	{
+		filenames.push_back(textureData.filename);
+	}
+
+	for (const auto &textureData : this->inf.getFlatTextures())
+	{
+		filenames.push_back(textureData.filename);
+	}
+
+	for (const auto &pair : this->inf.getSounds())
+	{
+		filenames.push_back(pair.second);
+	}
+
+	// Texture names without an extension aren't files, and the archive just skips them.
+	std::sort(filenames.begin(), filenames.end());
+	filenames.erase(std::unique(filenames.begin(), filenames.end()), filenames.end());
+	VFS::Manager::get().prefetch(filenames);
+}
+
+void LevelData::prefetchTextures(TextureManager &textureManager) const
+{
+	for (const auto &textureData : this->inf.getVoxelTextures())
+	{
+		const std::string textureName = String::toUppercase(textureData.filename);
+		const std::string extension = String::getExtension(textureName);
+		if ((extension == "SET") || (extension == "IMG"))
+		{
+			textureManager.requestImageDataAsync(textureName, extension == "SET");
+		}
+	}
+}
+
+void LevelData::updateResidentChunks(const Int2 &playerVoxel, int chunkDistance)
+{
+	// Do nothing by default.
+	static_cast<void>(playerVoxel);
+	static_cast<void>(chunkDistance);
+}
+
+void LevelData::waitForChunks()
+{
+	// Do nothing by default.
 }
 
 void LevelData::tick(double dt)
@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "Automap.h"
 #include "VoxelGrid.h"
 #include "../Assets/ArenaTypes.h"
 #include "../Assets/INFFile.h"
@@ -101,6 +102,7 @@ public:
 
 		const Int2 &getVoxel() const;
 		double getPercentOpen() const;
+		DoorState::Direction getDirection() const;
 
 		// Returns whether the door's current direction is closing. This is used to make
 		// sure that sounds are only played once when a door begins closing.
@@ -113,29 +115,102 @@ public:
 		void setDirection(DoorState::Direction direction);
 		void update(double dt);
 	};
+
+	// The open doors in a level with an index by voxel, so checking whether a door voxel is
+	// open (once per door voxel a ray touches when rendering) is constant time.
+	class OpenDoors
+	{
+	private:
+		std::vector<DoorState> doors;
+		std::unordered_map<Int2, int> indices; // Index of each voxel's door in the list.
+	public:
+		const std::vector<DoorState> &getDoors() const;
+		int getCount() const;
+
+		// Gets a door by its index in the list. Doors can be updated in place.
+		DoorState &get(int index);
+
+		// Gets the open door in a voxel, or null if the door there is closed.
+		DoorState *find(const Int2 &voxel);
+		const DoorState *find(const Int2 &voxel) const;
+
+		// Adds a door that just started opening. The voxel must not have an open door.
+		void add(const Int2 &voxel);
+
+		// Adds a door in the given state (i.e., from a saved game). The voxel must not have
+		// an open door.
+		void add(const DoorState &door);
+
+		// Removes the door in a voxel. The last door in the list takes its place, so removing
+		// while looping backwards over the list visits every door once.
+		void remove(const Int2 &voxel);
+
+		void clear();
+	};
+	// Bits for what else is in a voxel column besides its voxel data, so per-voxel checks
+	// like triggers are an array read and only voxels that have something do a lookup. Door
+	// and menu bits follow the main floor (Y=1) voxel.
+	static const uint8_t VOXEL_LOCK;
+	static const uint8_t VOXEL_TEXT_TRIGGER;
+	static const uint8_t VOXEL_SOUND_TRIGGER;
+	static const uint8_t VOXEL_DOOR;
+	static const uint8_t VOXEL_MENU;
 private:
 	std::unordered_map<Int2, Lock> locks;
 
-	// Mappings of IDs to voxel data indices. Chasms are treated separately since their voxel
-	// data index is also a function of the four adjacent voxels. These maps are stored here
-	// because they might be shared between multiple calls to read{FLOR,MAP1,MAP2}().
+	// Voxel bits for each XZ column.
+	std::vector<uint8_t> voxelFlags;
+
+	// Mappings of IDs to voxel data indices, so each ID is only decoded once. Chasms are
+	// treated separately since their voxel data index is also a function of the four adjacent
+	// voxels. These maps are stored here because they might be shared between multiple calls
+	// to read{FLOR,MAP1,MAP2}(). Different IDs that decode to the same voxel data share an
+	// index through VoxelGrid::findOrAdd().
 	std::unordered_map<uint16_t, int> wallDataMappings, floorDataMappings, map2DataMappings;
 	std::unordered_map<std::pair<uint16_t, std::array<bool, 4>>, int> chasmDataMappings;
 
 	VoxelGrid voxelGrid;
 	INFFile inf;
-	std::vector<DoorState> openDoors;
+	OpenDoors openDoors;
+	Automap automap;
 	std::string name;
+	uint32_t voxelChangeCount; // Voxel grid change count the voxel flags are up to date with.
+
+	// Hints to the file system that the .INF's textures and sounds will be read soon, so
+	// they're read ahead in one pass over the archive instead of one small read at a time.
+	void prefetchFiles() const;
 protected:
 	// Used by derived LevelData load methods.
 	LevelData(int gridWidth, int gridHeight, int gridDepth, const std::string &infName,
 		const std::string &name);
 
 	void setVoxel(int x, int y, int z, uint16_t id);
+
+	// Sets the given bits in a voxel column.
+	void addVoxelFlags(const Int2 &voxel, uint8_t flags);
+
+	// Makes the door and menu bits of a voxel column match its main floor voxel. Needed
+	// after voxels are written straight into the voxel grid (i.e., from the level cache).
+	void updateVoxelFlags(int x, int z);
+	void updateVoxelFlags();
 	void readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth, int gridDepth);
 	void readMAP1(const uint16_t *map1, const INFFile &inf, WorldType worldType,
 		int gridWidth, int gridDepth, const ExeData &exeData);
 	void readMAP2(const uint16_t *map2, const INFFile &inf, int gridWidth, int gridDepth);
+
+	// Region versions of the above, for only reading the voxels from the min XZ voxel up to
+	// but not including the max XZ voxel. Used when a chunk is brought back into the grid.
+	void readFLOR(const uint16_t *flor, const INFFile &inf, int gridWidth, int gridDepth,
+		const Int2 &voxelMin, const Int2 &voxelMax);
+	void readMAP1(const uint16_t *map1, const INFFile &inf, WorldType worldType,
+		int gridWidth, int gridDepth, const ExeData &exeData, const Int2 &voxelMin,
+		const Int2 &voxelMax);
+	void readMAP2(const uint16_t *map2, const INFFile &inf, int gridWidth, int gridDepth,
+		const Int2 &voxelMin, const Int2 &voxelMax);
+
+	// Sets every voxel from the min XZ voxel up to but not including the max XZ voxel to air,
+	// and forgets any open doors there.
+	void clearVoxels(const Int2 &voxelMin, const Int2 &voxelMax);
 	void readCeiling(const INFFile &inf, int width, int depth);
 	void readLocks(const std::vector<ArenaTypes::MIFLock> &locks, int width, int depth);
 public:
@@ -144,15 +219,24 @@ public:
 
 	const std::string &getName() const;
 	double getCeilingHeight() const;
-	std::vector<DoorState> &getOpenDoors();
-	const std::vector<DoorState> &getOpenDoors() const;
+	OpenDoors &getOpenDoors();
+	const OpenDoors &getOpenDoors() const;
 	const INFFile &getInfFile() const;
+	Automap &getAutomap();
 	VoxelGrid &getVoxelGrid();
 	const VoxelGrid &getVoxelGrid() const;
 
 	// Returns a pointer to some lock if the given voxel has a lock, or null if it doesn't.
 	const Lock *getLock(const Int2 &voxel) const;
 
+	// Gets the voxel bits of an XZ column, or zero if it's outside the grid.
+	uint8_t getVoxelFlags(const Int2 &voxel) const;
+
+	// Brings the voxel bits up to date with the main floor voxels set since they were last
+	// updated, including ones written straight into the voxel grid (i.e., from the level
+	// cache or a snapshot).
+	void updateVoxelChanges();
+
 	// Returns whether a level is considered an outdoor dungeon. Only true for some interiors.
 	virtual bool isOutdoorDungeon() const = 0;
 
@@ -160,6 +244,18 @@ public:
 	// do some extra work (like set interior sky colors in the renderer).
 	virtual void setActive(TextureManager &textureManager, Renderer &renderer);
 
+	// Starts decoding the level's voxel textures in the background, so activating it later
+	// (i.e., when taking stairs to it) doesn't have to wait on decoding them.
+	void prefetchTextures(TextureManager &textureManager) const;
+
+	// Brings chunks within the chunk distance (in voxels) of the player into the voxel grid
+	// and takes far away ones out. Does nothing by default.
+	virtual void updateResidentChunks(const Int2 &playerVoxel, int chunkDistance);
+
+	// Blocks until every chunk being generated in the background is in the level. For when
+	// placeholder chunks can't be shown, like benchmarks. Does nothing by default.
+	virtual void waitForChunks();
+
 	// Ticks the level data by delta time. Does nothing by default.
 	virtual void tick(double dt);
 };
@@ -146,7 +146,7 @@ const std::string &Location::getName(const CityDataFile &cityData, const ExeData
 	{
 		if (this->specialCaseType == Location::SpecialCaseType::StartDungeon)
 		{
-			return exeData.locations.startDungeonName;
+			return exeData.getLocations().startDungeonName;
 		}
 		else if (this->specialCaseType == Location::SpecialCaseType::WildDungeon)
 		{
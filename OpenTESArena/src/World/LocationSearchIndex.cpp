@@ -0,0 +1,202 @@
+#include <algorithm>
+
+#include "LocationSearchIndex.h"
+#include "../Assets/CityDataFile.h"
+#include "../Utilities/String.h"
+
+namespace
+{
+	// Locations in each province (cities, towns, villages, and dungeons).
+	const int LocationCount = 48;
+}
+
+std::vector<uint32_t> LocationSearchIndex::getTrigrams(const std::string &text)
+{
+	std::vector<uint32_t> trigrams;
+	for (size_t i = 0; (i + 3) <= text.size(); i++)
+	{
+		const uint32_t trigram = static_cast<uint8_t>(text[i]) |
+			(static_cast<uint8_t>(text[i + 1]) << 8) |
+			(static_cast<uint8_t>(text[i + 2]) << 16);
+		trigrams.push_back(trigram);
+	}
+
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+	return trigrams;
+}
+
+void LocationSearchIndex::init(const CityDataFile &cityData)
+{
+	for (int provinceID = 0; provinceID < static_cast<int>(this->provinces.size()); provinceID++)
+	{
+		const auto &provinceData = cityData.getProvinceData(provinceID);
+		ProvinceIndex &province = this->provinces[provinceID];
+
+		// Same order as the search list has always used (by the name as written).
+		std::vector<int> locationIDs(LocationCount);
+		for (int i = 0; i < LocationCount; i++)
+		{
+			locationIDs[i] = i;
+		}
+
+		std::stable_sort(locationIDs.begin(), locationIDs.end(),
+			[&provinceData](int a, int b)
+		{
+			const std::string &aName = provinceData.getLocationData(a).name;
+			const std::string &bName = provinceData.getLocationData(b).name;
+			return aName.compare(bName) < 0;
+		});
+
+		province.entries.clear();
+		province.trigrams.clear();
+		for (const int locationID : locationIDs)
+		{
+			Entry entry;
+			entry.name = String::toLowercase(provinceData.getLocationData(locationID).name);
+			entry.locationID = locationID;
+
+			const int entryIndex = static_cast<int>(province.entries.size());
+			for (const uint32_t trigram : LocationSearchIndex::getTrigrams(entry.name))
+			{
+				province.trigrams[trigram].push_back(entryIndex);
+			}
+
+			province.entries.push_back(std::move(entry));
+		}
+
+		province.exactOrder.resize(province.entries.size());
+		for (size_t i = 0; i < province.exactOrder.size(); i++)
+		{
+			province.exactOrder[i] = static_cast<int>(i);
+		}
+
+		std::sort(province.exactOrder.begin(), province.exactOrder.end(),
+			[&province](int a, int b)
+		{
+			return province.entries[a].name < province.entries[b].name;
+		});
+	}
+}
+
+int LocationSearchIndex::findExact(const std::string &name, int provinceID) const
+{
+	const ProvinceIndex &province = this->provinces.at(provinceID);
+	const std::string lowerName = String::toLowercase(name);
+
+	const auto iter = std::lower_bound(province.exactOrder.begin(),
+		province.exactOrder.end(), lowerName, [&province](int index, const std::string &value)
+	{
+		return province.entries[index].name < value;
+	});
+
+	if ((iter == province.exactOrder.end()) || (province.entries[*iter].name != lowerName))
+	{
+		return -1;
+	}
+
+	return province.entries[*iter].locationID;
+}
+
+std::vector<int> LocationSearchIndex::findContaining(const std::string &text,
+	int provinceID) const
+{
+	const ProvinceIndex &province = this->provinces.at(provinceID);
+	const std::string lowerText = String::toLowercase(text);
+
+	// Text long enough to have trigrams only has to be checked against the names with its
+	// rarest one. Shorter text is checked against every name.
+	const std::vector<int> *candidates = nullptr;
+	for (const uint32_t trigram : LocationSearchIndex::getTrigrams(lowerText))
+	{
+		const auto iter = province.trigrams.find(trigram);
+		if (iter == province.trigrams.end())
+		{
+			return std::vector<int>();
+		}
+
+		if ((candidates == nullptr) || (iter->second.size() < candidates->size()))
+		{
+			candidates = &iter->second;
+		}
+	}
+
+	std::vector<int> locationIDs;
+	auto tryAdd = [&province, &lowerText, &locationIDs](int entryIndex)
+	{
+		const Entry &entry = province.entries[entryIndex];
+		if (entry.name.find(lowerText) != std::string::npos)
+		{
+			locationIDs.push_back(entry.locationID);
+		}
+	};
+
+	if (candidates != nullptr)
+	{
+		for (const int entryIndex : *candidates)
+		{
+			tryAdd(entryIndex);
+		}
+	}
+	else
+	{
+		for (int i = 0; i < static_cast<int>(province.entries.size()); i++)
+		{
+			tryAdd(i);
+		}
+	}
+
+	return locationIDs;
+}
+
+std::vector<int> LocationSearchIndex::findSimilar(const std::string &text,
+	int provinceID) const
+{
+	const ProvinceIndex &province = this->provinces.at(provinceID);
+	const std::vector<uint32_t> trigrams =
+		LocationSearchIndex::getTrigrams(String::toLowercase(text));
+
+	if (trigrams.empty())
+	{
+		return std::vector<int>();
+	}
+
+	std::vector<int> sharedCounts(province.entries.size(), 0);
+	for (const uint32_t trigram : trigrams)
+	{
+		const auto iter = province.trigrams.find(trigram);
+		if (iter != province.trigrams.end())
+		{
+			for (const int entryIndex : iter->second)
+			{
+				sharedCounts[entryIndex]++;
+			}
+		}
+	}
+
+	const int minSharedCount = static_cast<int>(trigrams.size() + 1) / 2;
+	std::vector<int> locationIDs;
+	for (size_t i = 0; i < sharedCounts.size(); i++)
+	{
+		if (sharedCounts[i] >= minSharedCount)
+		{
+			locationIDs.push_back(province.entries[i].locationID);
+		}
+	}
+
+	return locationIDs;
+}
+
+std::vector<int> LocationSearchIndex::getAll(int provinceID) const
+{
+	const ProvinceIndex &province = this->provinces.at(provinceID);
+
+	std::vector<int> locationIDs;
+	locationIDs.reserve(province.entries.size());
+	for (const Entry &entry : province.entries)
+	{
+		locationIDs.push_back(entry.locationID);
+	}
+
+	return locationIDs;
+}
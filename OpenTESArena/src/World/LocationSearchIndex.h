@@ -0,0 +1,54 @@
+#ifndef LOCATION_SEARCH_INDEX_H
+#define LOCATION_SEARCH_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lookup tables over the location names of each province, for the province map's location
+// search. Names never change during a game, so the index is made once from the city data
+// file. Visibility does change, so it's left to the caller to filter results by.
+
+class CityDataFile;
+
+class LocationSearchIndex
+{
+private:
+	struct Entry
+	{
+		std::string name; // Lowercase.
+		int locationID;
+	};
+
+	struct ProvinceIndex
+	{
+		std::vector<Entry> entries; // In alphabetical order like the search list.
+		std::vector<int> exactOrder; // Entry indices sorted by lowercase name.
+		std::unordered_map<uint32_t, std::vector<int>> trigrams; // Entry indices per trigram.
+	};
+
+	std::array<ProvinceIndex, 9> provinces;
+
+	// Gets the trigrams of some lowercase text, without duplicates.
+	static std::vector<uint32_t> getTrigrams(const std::string &text);
+public:
+	void init(const CityDataFile &cityData);
+
+	// Gets the location with the given name (case-insensitive), or -1 if there isn't one.
+	int findExact(const std::string &name, int provinceID) const;
+
+	// Gets the locations whose name contains the given text (case-insensitive), in
+	// alphabetical order.
+	std::vector<int> findContaining(const std::string &text, int provinceID) const;
+
+	// Gets the locations that share at least half of the given text's trigrams, for
+	// misspelled names, in alphabetical order.
+	std::vector<int> findSimilar(const std::string &text, int provinceID) const;
+
+	// Gets every location in the province in alphabetical order.
+	std::vector<int> getAll(int provinceID) const;
+};
+
+#endif
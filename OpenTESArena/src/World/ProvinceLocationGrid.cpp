@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "ProvinceLocationGrid.h"
+#include "../Rendering/Renderer.h"
+
+const int ProvinceLocationGrid::CELL_SIZE = 16;
+const int ProvinceLocationGrid::WIDTH = (Renderer::ORIGINAL_WIDTH +
+	ProvinceLocationGrid::CELL_SIZE - 1) / ProvinceLocationGrid::CELL_SIZE;
+const int ProvinceLocationGrid::HEIGHT = (Renderer::ORIGINAL_HEIGHT +
+	ProvinceLocationGrid::CELL_SIZE - 1) / ProvinceLocationGrid::CELL_SIZE;
+
+ProvinceLocationGrid::ProvinceLocationGrid()
+{
+	this->count = 0;
+}
+
+Int2 ProvinceLocationGrid::getCell(const Int2 &position)
+{
+	const int x = position.x / ProvinceLocationGrid::CELL_SIZE;
+	const int y = position.y / ProvinceLocationGrid::CELL_SIZE;
+	return Int2(std::clamp(x, 0, ProvinceLocationGrid::WIDTH - 1),
+		std::clamp(y, 0, ProvinceLocationGrid::HEIGHT - 1));
+}
+
+void ProvinceLocationGrid::init(const CityDataFile::ProvinceData &provinceData)
+{
+	this->cells.clear();
+	this->cells.resize(ProvinceLocationGrid::WIDTH * ProvinceLocationGrid::HEIGHT);
+	this->count = 0;
+
+	for (int i = 0; i < 48; i++)
+	{
+		const auto &locationData = provinceData.getLocationData(i);
+		if (locationData.isVisible())
+		{
+			Point point;
+			point.position = Int2(locationData.x, locationData.y);
+			point.locationID = i;
+
+			const Int2 cell = ProvinceLocationGrid::getCell(point.position);
+			this->cells[cell.x + (cell.y * ProvinceLocationGrid::WIDTH)].push_back(point);
+			this->count++;
+		}
+	}
+}
+
+int ProvinceLocationGrid::getClosestLocationID(const Int2 &point) const
+{
+	if (this->count == 0)
+	{
+		return -1;
+	}
+
+	// Look at rings of cells around the point's cell. Anything in the next ring out is at
+	// least the current ring's radius away, so once the closest location is nearer than
+	// that, no other ring can have a closer one.
+	const Int2 center = ProvinceLocationGrid::getCell(point);
+	const int maxRadius = std::max(ProvinceLocationGrid::WIDTH, ProvinceLocationGrid::HEIGHT);
+	int closestID = -1;
+	int closestDistanceSqr = 0;
+
+	for (int radius = 0; radius < maxRadius; radius++)
+	{
+		for (int y = center.y - radius; y <= center.y + radius; y++)
+		{
+			if ((y < 0) || (y >= ProvinceLocationGrid::HEIGHT))
+			{
+				continue;
+			}
+
+			// Only the edges of the ring are new cells.
+			const bool isEdgeRow = (y == (center.y - radius)) || (y == (center.y + radius));
+			const int xStep = (isEdgeRow || (radius == 0)) ? 1 : (radius * 2);
+			for (int x = center.x - radius; x <= center.x + radius; x += xStep)
+			{
+				if ((x < 0) || (x >= ProvinceLocationGrid::WIDTH))
+				{
+					continue;
+				}
+
+				for (const Point &cellPoint : this->cells[x + (y * ProvinceLocationGrid::WIDTH)])
+				{
+					const Int2 diff = cellPoint.position - point;
+					const int distanceSqr = (diff.x * diff.x) + (diff.y * diff.y);
+					const bool isCloser = (closestID < 0) ||
+						(distanceSqr < closestDistanceSqr) ||
+						((distanceSqr == closestDistanceSqr) && (cellPoint.locationID < closestID));
+
+					if (isCloser)
+					{
+						closestID = cellPoint.locationID;
+						closestDistanceSqr = distanceSqr;
+					}
+				}
+			}
+		}
+
+		const int ringDistance = radius * ProvinceLocationGrid::CELL_SIZE;
+		if ((closestID >= 0) && (closestDistanceSqr < (ringDistance * ringDistance)))
+		{
+			break;
+		}
+	}
+
+	return closestID;
+}
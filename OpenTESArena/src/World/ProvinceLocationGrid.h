@@ -0,0 +1,44 @@
+#ifndef PROVINCE_LOCATION_GRID_H
+#define PROVINCE_LOCATION_GRID_H
+
+#include <array>
+#include <vector>
+
+#include "../Assets/CityDataFile.h"
+#include "../Math/Vector2.h"
+
+// Buckets a province's visible locations by their position on the province map, so the
+// location closest to the mouse can be found by looking at a few nearby cells instead of
+// every location. Positions are in 320x200 space.
+
+class ProvinceLocationGrid
+{
+private:
+	static const int CELL_SIZE;
+	static const int WIDTH; // In cells.
+	static const int HEIGHT;
+
+	struct Point
+	{
+		Int2 position;
+		int locationID;
+	};
+
+	std::vector<std::vector<Point>> cells;
+	int count;
+
+	// Gets the cell coordinate of some position, clamped to the grid.
+	static Int2 getCell(const Int2 &position);
+public:
+	ProvinceLocationGrid();
+
+	// Adds the visible locations of the province. Visibility can't change while the grid is
+	// in use.
+	void init(const CityDataFile::ProvinceData &provinceData);
+
+	// Gets the ID of the location closest to the given point, or -1 if there are none. Ties
+	// go to the lowest location ID.
+	int getClosestLocationID(const Int2 &point) const;
+};
+
+#endif
@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <array>
+
+#include "VisibilityRegions.h"
+#include "VoxelDataType.h"
+#include "VoxelGrid.h"
+#include "../Utilities/Debug.h"
+
+namespace
+{
+	// Region value for door voxels while building.
+	const int DoorRegion = -2;
+
+	const std::array<Int2, 4> NeighborOffsets =
+	{
+		Int2(1, 0), Int2(-1, 0), Int2(0, 1), Int2(0, -1)
+	};
+}
+
+const int VisibilityRegions::NO_REGION = -1;
+
+VisibilityRegions::VisibilityRegions()
+{
+	this->width = 0;
+	this->depth = 0;
+	this->changeCount = 0;
+	this->inited = false;
+}
+
+bool VisibilityRegions::isInited() const
+{
+	return this->inited;
+}
+
+int VisibilityRegions::getRegionCount() const
+{
+	return static_cast<int>(this->regionDoors.size());
+}
+
+int VisibilityRegions::getRegion(int x, int z) const
+{
+	if ((x < 0) || (x >= this->width) || (z < 0) || (z >= this->depth))
+	{
+		return VisibilityRegions::NO_REGION;
+	}
+
+	const int region = this->voxelRegions[x + (z * this->width)];
+	return (region >= 0) ? region : VisibilityRegions::NO_REGION;
+}
+
+void VisibilityRegions::init(const VoxelGrid &voxelGrid)
+{
+	this->clear();
+	this->width = voxelGrid.getWidth();
+	this->depth = voxelGrid.getDepth();
+	this->changeCount = voxelGrid.getChangeCount();
+	this->inited = true;
+
+	const int voxelY = 1;
+	if (voxelY >= voxelGrid.getHeight())
+	{
+		// No main floor, so every voxel is outside any region.
+		this->voxelRegions = std::vector<int>(this->width * this->depth,
+			VisibilityRegions::NO_REGION);
+		return;
+	}
+
+	// Opaque walls bound regions, doors are portals, and anything else can be seen through
+	// (raised platforms, diagonals, and transparent walls only hide part of a voxel).
+	const int unassigned = this->width * this->depth;
+	this->voxelRegions = std::vector<int>(this->width * this->depth, unassigned);
+	for (int z = 0; z < this->depth; z++)
+	{
+		for (int x = 0; x < this->width; x++)
+		{
+			const VoxelData &voxelData = voxelGrid.getVoxelData(voxelGrid.getVoxel(x, voxelY, z));
+			const int index = x + (z * this->width);
+			if (voxelData.dataType == VoxelDataType::Wall)
+			{
+				this->voxelRegions[index] = VisibilityRegions::NO_REGION;
+			}
+			else if (voxelData.dataType == VoxelDataType::Door)
+			{
+				this->voxelRegions[index] = DoorRegion;
+				this->doorIndices.insert(std::make_pair(Int2(x, z),
+					static_cast<int>(this->doors.size())));
+
+				Door door;
+				door.voxel = Int2(x, z);
+				this->doors.push_back(std::move(door));
+			}
+		}
+	}
+
+	// Flood fill each region.
+	std::vector<Int2> stack;
+	for (int z = 0; z < this->depth; z++)
+	{
+		for (int x = 0; x < this->width; x++)
+		{
+			if (this->voxelRegions[x + (z * this->width)] != unassigned)
+			{
+				continue;
+			}
+
+			const int region = static_cast<int>(this->regionDoors.size());
+			this->regionDoors.push_back(std::vector<int>());
+			this->voxelRegions[x + (z * this->width)] = region;
+			stack.push_back(Int2(x, z));
+
+			while (stack.size() > 0)
+			{
+				const Int2 voxel = stack.back();
+				stack.pop_back();
+
+				for (const Int2 &offset : NeighborOffsets)
+				{
+					const Int2 neighbor = voxel + offset;
+					if ((neighbor.x < 0) || (neighbor.x >= this->width) ||
+						(neighbor.y < 0) || (neighbor.y >= this->depth))
+					{
+						continue;
+					}
+
+					int &neighborRegion = this->voxelRegions[neighbor.x + (neighbor.y * this->width)];
+					if (neighborRegion == unassigned)
+					{
+						neighborRegion = region;
+						stack.push_back(neighbor);
+					}
+				}
+			}
+		}
+	}
+
+	// Connect each door to the regions and doors around it.
+	for (int i = 0; i < static_cast<int>(this->doors.size()); i++)
+	{
+		Door &door = this->doors[i];
+		for (const Int2 &offset : NeighborOffsets)
+		{
+			const Int2 neighbor = door.voxel + offset;
+			const int neighborRegion = this->getRegion(neighbor.x, neighbor.y);
+			if (neighborRegion != VisibilityRegions::NO_REGION)
+			{
+				auto &regions = door.regions;
+				if (std::find(regions.begin(), regions.end(), neighborRegion) == regions.end())
+				{
+					regions.push_back(neighborRegion);
+					this->regionDoors[neighborRegion].push_back(i);
+				}
+			}
+			else
+			{
+				const auto iter = this->doorIndices.find(neighbor);
+				if (iter != this->doorIndices.end())
+				{
+					door.doors.push_back(iter->second);
+				}
+			}
+		}
+	}
+}
+
+void VisibilityRegions::update(const VoxelGrid &voxelGrid)
+{
+	DebugAssert(this->inited);
+
+	const Int3 *changedVoxels;
+	int changedVoxelCount;
+	if (!voxelGrid.getChangedVoxels(this->changeCount, &changedVoxels, &changedVoxelCount))
+	{
+		this->init(voxelGrid);
+		return;
+	}
+
+	// A main floor voxel can join or split regions, which isn't worth patching up since
+	// it's rare.
+	const auto changedVoxelsEnd = changedVoxels + changedVoxelCount;
+	const bool mainFloorChanged = std::any_of(changedVoxels, changedVoxelsEnd,
+		[](const Int3 &voxel) { return voxel.y == 1; });
+	if (mainFloorChanged)
+	{
+		this->init(voxelGrid);
+	}
+	else
+	{
+		this->changeCount = voxelGrid.getChangeCount();
+	}
+}
+
+bool VisibilityRegions::getVisibleRegions(const Int2 &eyeVoxel,
+	const LevelData::OpenDoors &openDoors, std::vector<bool> &visible) const
+{
+	DebugAssert(this->inited);
+
+	visible.assign(this->regionDoors.size(), false);
+
+	std::vector<int> regionStack, doorStack;
+	std::vector<bool> visitedDoors(this->doors.size(), false);
+
+	// Lambda for reaching a door, whose other side can only be seen if it's open (or if the
+	// eye is in it).
+	auto visitDoor = [this, &openDoors, &doorStack, &visitedDoors](int doorIndex, bool force)
+	{
+		const Door &door = this->doors[doorIndex];
+		if (!visitedDoors[doorIndex] && (force || (openDoors.find(door.voxel) != nullptr)))
+		{
+			visitedDoors[doorIndex] = true;
+			doorStack.push_back(doorIndex);
+		}
+	};
+
+	auto visitRegion = [&visible, &regionStack](int region)
+	{
+		if (!visible[region])
+		{
+			visible[region] = true;
+			regionStack.push_back(region);
+		}
+	};
+
+	const int eyeRegion = this->getRegion(eyeVoxel.x, eyeVoxel.y);
+	if (eyeRegion != VisibilityRegions::NO_REGION)
+	{
+		visitRegion(eyeRegion);
+	}
+	else
+	{
+		const auto iter = this->doorIndices.find(eyeVoxel);
+		if (iter == this->doorIndices.end())
+		{
+			return false;
+		}
+
+		visitDoor(iter->second, true);
+	}
+
+	while ((regionStack.size() > 0) || (doorStack.size() > 0))
+	{
+		if (regionStack.size() > 0)
+		{
+			const int region = regionStack.back();
+			regionStack.pop_back();
+
+			for (const int doorIndex : this->regionDoors[region])
+			{
+				visitDoor(doorIndex, false);
+			}
+		}
+		else
+		{
+			const int doorIndex = doorStack.back();
+			doorStack.pop_back();
+
+			const Door &door = this->doors[doorIndex];
+			for (const int region : door.regions)
+			{
+				visitRegion(region);
+			}
+
+			for (const int neighborIndex : door.doors)
+			{
+				visitDoor(neighborIndex, false);
+			}
+		}
+	}
+
+	return true;
+}
+
+void VisibilityRegions::clear()
+{
+	this->voxelRegions.clear();
+	this->regionDoors.clear();
+	this->doors.clear();
+	this->doorIndices.clear();
+	this->width = 0;
+	this->depth = 0;
+	this->changeCount = 0;
+	this->inited = false;
+}
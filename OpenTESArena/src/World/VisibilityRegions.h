@@ -0,0 +1,68 @@
+#ifndef VISIBILITY_REGIONS_H
+#define VISIBILITY_REGIONS_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "LevelData.h"
+#include "../Math/Vector2.h"
+
+// Potentially visible sets for a level's main floor (Y=1) voxels. Voxels that can be seen
+// through are grouped into regions bounded by opaque walls and doors, and doors are the
+// portals between regions. Nothing in one region can be seen from another unless there's a
+// chain of open doors between them, so everything in the regions that aren't reachable through
+// open doors from the eye's region is hidden.
+
+// Regions are built once when a level is loaded (they only depend on the voxel grid), and the
+// visible set for the eye is found each frame from whichever doors are open. They're rebuilt
+// if a main floor voxel is set afterwards.
+
+class VoxelGrid;
+
+class VisibilityRegions
+{
+public:
+	// Region of voxels that aren't in one (opaque, door, or outside the grid).
+	static const int NO_REGION;
+private:
+	struct Door
+	{
+		Int2 voxel;
+		std::vector<int> regions; // Regions next to the door.
+		std::vector<int> doors; // Doors next to the door (i.e., double doors).
+	};
+
+	std::vector<int> voxelRegions; // Region of each XZ voxel, x + (z * width).
+	std::vector<std::vector<int>> regionDoors; // Indices of the doors around each region.
+	std::vector<Door> doors;
+	std::unordered_map<Int2, int> doorIndices; // Index of each door voxel's door.
+	int width, depth;
+	uint32_t changeCount; // Voxel grid change count the regions are up to date with.
+	bool inited;
+public:
+	VisibilityRegions();
+
+	bool isInited() const;
+	int getRegionCount() const;
+
+	// Gets the region of a voxel, or NO_REGION if it's not in one.
+	int getRegion(int x, int z) const;
+
+	// Groups the main floor voxels of the grid into regions.
+	void init(const VoxelGrid &voxelGrid);
+
+	// Rebuilds the regions if any main floor voxel was set since they were last built or
+	// updated. Voxels set on other floors don't change them.
+	void update(const VoxelGrid &voxelGrid);
+
+	// Marks each region that can be seen from the eye's voxel, given which doors are open.
+	// Returns false if the eye isn't somewhere regions can tell (i.e., in a wall or outside
+	// the grid), in which case any region might be visible.
+	bool getVisibleRegions(const Int2 &eyeVoxel, const LevelData::OpenDoors &openDoors,
+		std::vector<bool> &visible) const;
+
+	void clear();
+};
+
+#endif
@@ -8,6 +8,16 @@
 #include "../Assets/MIFFile.h"
 #include "../Utilities/Debug.h"
 
+namespace
+{
+	// Mixes a value's hash into a running hash.
+	template <typename T>
+	void combineHash(size_t &seed, const T &value)
+	{
+		seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+}
+
 bool VoxelData::WallData::isMenu() const
 {
 	if (this->type == WallData::Type::Menu)
@@ -147,6 +157,11 @@ bool VoxelData::ChasmData::faceIsVisible(VoxelData::Facing facing) const
 	}
 }
 
+bool VoxelData::ChasmData::hasVisibleFaces() const
+{
+	return this->north || this->east || this->south || this->west;
+}
+
 int VoxelData::DoorData::getOpenSoundIndex() const
 {
 	if (this->type == DoorData::Type::Swinging)
@@ -397,6 +412,79 @@ VoxelData VoxelData::makeDoor(int id, DoorData::Type type)
 	return data;
 }
 
+bool VoxelData::operator==(const VoxelData &other) const
+{
+	if (this->dataType != other.dataType)
+	{
+		return false;
+	}
+
+	if (this->dataType == VoxelDataType::None)
+	{
+		return true;
+	}
+	else if (this->dataType == VoxelDataType::Wall)
+	{
+		const WallData &a = this->wall;
+		const WallData &b = other.wall;
+		return (a.sideID == b.sideID) && (a.floorID == b.floorID) &&
+			(a.ceilingID == b.ceilingID) && (a.menuID == b.menuID) && (a.type == b.type);
+	}
+	else if (this->dataType == VoxelDataType::Floor)
+	{
+		return this->floor.id == other.floor.id;
+	}
+	else if (this->dataType == VoxelDataType::Ceiling)
+	{
+		return this->ceiling.id == other.ceiling.id;
+	}
+	else if (this->dataType == VoxelDataType::Raised)
+	{
+		const RaisedData &a = this->raised;
+		const RaisedData &b = other.raised;
+		return (a.sideID == b.sideID) && (a.floorID == b.floorID) &&
+			(a.ceilingID == b.ceilingID) && (a.yOffset == b.yOffset) &&
+			(a.ySize == b.ySize) && (a.vTop == b.vTop) && (a.vBottom == b.vBottom);
+	}
+	else if (this->dataType == VoxelDataType::Diagonal)
+	{
+		return (this->diagonal.id == other.diagonal.id) &&
+			(this->diagonal.type1 == other.diagonal.type1);
+	}
+	else if (this->dataType == VoxelDataType::TransparentWall)
+	{
+		return (this->transparentWall.id == other.transparentWall.id) &&
+			(this->transparentWall.collider == other.transparentWall.collider);
+	}
+	else if (this->dataType == VoxelDataType::Edge)
+	{
+		const EdgeData &a = this->edge;
+		const EdgeData &b = other.edge;
+		return (a.id == b.id) && (a.yOffset == b.yOffset) && (a.collider == b.collider) &&
+			(a.flipped == b.flipped) && (a.facing == b.facing);
+	}
+	else if (this->dataType == VoxelDataType::Chasm)
+	{
+		const ChasmData &a = this->chasm;
+		const ChasmData &b = other.chasm;
+		return (a.id == b.id) && (a.north == b.north) && (a.east == b.east) &&
+			(a.south == b.south) && (a.west == b.west) && (a.type == b.type);
+	}
+	else if (this->dataType == VoxelDataType::Door)
+	{
+		return (this->door.id == other.door.id) && (this->door.type == other.door.type);
+	}
+	else
+	{
+		DebugUnhandledReturnMsg(bool, std::to_string(static_cast<int>(this->dataType)));
+	}
+}
+
+bool VoxelData::operator!=(const VoxelData &other) const
+{
+	return !(*this == other);
+}
+
 Double3 VoxelData::getNormal(VoxelData::Facing facing)
 {
 	// Decide what the normal is, based on the facing.
@@ -417,3 +505,74 @@ Double3 VoxelData::getNormal(VoxelData::Facing facing)
 		return -Double3::UnitZ;
 	}
 }
+
+size_t std::hash<VoxelData>::operator()(const VoxelData &voxelData) const
+{
+	// Only hash the members compared by operator==.
+	size_t seed = static_cast<size_t>(voxelData.dataType);
+
+	if (voxelData.dataType == VoxelDataType::Wall)
+	{
+		const VoxelData::WallData &wall = voxelData.wall;
+		combineHash(seed, wall.sideID);
+		combineHash(seed, wall.floorID);
+		combineHash(seed, wall.ceilingID);
+		combineHash(seed, wall.menuID);
+		combineHash(seed, static_cast<int>(wall.type));
+	}
+	else if (voxelData.dataType == VoxelDataType::Floor)
+	{
+		combineHash(seed, voxelData.floor.id);
+	}
+	else if (voxelData.dataType == VoxelDataType::Ceiling)
+	{
+		combineHash(seed, voxelData.ceiling.id);
+	}
+	else if (voxelData.dataType == VoxelDataType::Raised)
+	{
+		const VoxelData::RaisedData &raised = voxelData.raised;
+		combineHash(seed, raised.sideID);
+		combineHash(seed, raised.floorID);
+		combineHash(seed, raised.ceilingID);
+		combineHash(seed, raised.yOffset);
+		combineHash(seed, raised.ySize);
+		combineHash(seed, raised.vTop);
+		combineHash(seed, raised.vBottom);
+	}
+	else if (voxelData.dataType == VoxelDataType::Diagonal)
+	{
+		combineHash(seed, voxelData.diagonal.id);
+		combineHash(seed, voxelData.diagonal.type1);
+	}
+	else if (voxelData.dataType == VoxelDataType::TransparentWall)
+	{
+		combineHash(seed, voxelData.transparentWall.id);
+		combineHash(seed, voxelData.transparentWall.collider);
+	}
+	else if (voxelData.dataType == VoxelDataType::Edge)
+	{
+		const VoxelData::EdgeData &edge = voxelData.edge;
+		combineHash(seed, edge.id);
+		combineHash(seed, edge.yOffset);
+		combineHash(seed, edge.collider);
+		combineHash(seed, edge.flipped);
+		combineHash(seed, static_cast<int>(edge.facing));
+	}
+	else if (voxelData.dataType == VoxelDataType::Chasm)
+	{
+		const VoxelData::ChasmData &chasm = voxelData.chasm;
+		combineHash(seed, chasm.id);
+		combineHash(seed, chasm.north);
+		combineHash(seed, chasm.east);
+		combineHash(seed, chasm.south);
+		combineHash(seed, chasm.west);
+		combineHash(seed, static_cast<int>(chasm.type));
+	}
+	else if (voxelData.dataType == VoxelDataType::Door)
+	{
+		combineHash(seed, voxelData.door.id);
+		combineHash(seed, static_cast<int>(voxelData.door.type));
+	}
+
+	return seed;
+}
@@ -1,6 +1,9 @@
 #ifndef VOXEL_DATA_H
 #define VOXEL_DATA_H
 
+#include <cstddef>
+#include <functional>
+
 #include "../Math/Vector3.h"
 
 // Voxel data is the definition of a voxel that a voxel ID points to. Since there will 
@@ -127,6 +130,10 @@ public:
 		Type type;
 
 		bool faceIsVisible(VoxelData::Facing facing) const;
+
+		// Returns whether any face is visible. Chasms in the middle of a larger chasm area
+		// (i.e., most of a lake) have none.
+		bool hasVisibleFaces() const;
 	};
 
 	struct DoorData
@@ -185,8 +192,23 @@ public:
 		ChasmData::Type type);
 	static VoxelData makeDoor(int id, DoorData::Type type);
 
+	// Returns whether two voxel data objects define the same voxel. Only the members of the
+	// active data type are compared.
+	bool operator==(const VoxelData &other) const;
+	bool operator!=(const VoxelData &other) const;
+
 	// Gets the normal associated with a voxel facing.
 	static Double3 getNormal(VoxelData::Facing facing);
 };
 
+// Hash specialization for interning voxel data in the voxel grid.
+namespace std
+{
+	template <>
+	struct hash<VoxelData>
+	{
+		size_t operator()(const VoxelData &voxelData) const;
+	};
+}
+
 #endif
@@ -0,0 +1,63 @@
+#include <limits>
+
+#include "VoxelDataRegistry.h"
+#include "../Utilities/Debug.h"
+
+int VoxelDataRegistry::getCount() const
+{
+	return static_cast<int>(this->voxelDataIDs.size());
+}
+
+const VoxelData &VoxelDataRegistry::get(uint16_t id) const
+{
+	DebugAssertIndex(this->voxelData, id);
+	DebugAssert(this->refCounts[id] > 0);
+	return this->voxelData[id];
+}
+
+uint16_t VoxelDataRegistry::acquire(const VoxelData &voxelData)
+{
+	const auto iter = this->voxelDataIDs.find(voxelData);
+	if (iter != this->voxelDataIDs.end())
+	{
+		const uint16_t id = iter->second;
+		this->refCounts[id]++;
+		return id;
+	}
+
+	// Reuse a freed ID if there is one.
+	uint16_t id;
+	if (!this->freeIDs.empty())
+	{
+		id = this->freeIDs.back();
+		this->freeIDs.pop_back();
+		this->voxelData[id] = voxelData;
+	}
+	else
+	{
+		// If we ever hit this, registry IDs need more bits.
+		DebugAssert(this->voxelData.size() < std::numeric_limits<uint16_t>::max());
+		id = static_cast<uint16_t>(this->voxelData.size());
+		this->voxelData.push_back(voxelData);
+		this->refCounts.push_back(0);
+	}
+
+	this->refCounts[id] = 1;
+	this->voxelDataIDs.emplace(voxelData, id);
+	return id;
+}
+
+void VoxelDataRegistry::release(uint16_t id)
+{
+	DebugAssertIndex(this->refCounts, id);
+	DebugAssert(this->refCounts[id] > 0);
+
+	int &refCount = this->refCounts[id];
+	refCount--;
+	if (refCount == 0)
+	{
+		this->voxelDataIDs.erase(this->voxelData[id]);
+		this->voxelData[id] = VoxelData();
+		this->freeIDs.push_back(id);
+	}
+}
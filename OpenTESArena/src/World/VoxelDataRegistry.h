@@ -0,0 +1,39 @@
+#ifndef VOXEL_DATA_REGISTRY_H
+#define VOXEL_DATA_REGISTRY_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "VoxelData.h"
+
+// Level-wide set of distinct voxel data definitions shared by chunks. Most chunks in a level
+// use the same handful of wall and floor definitions, so each chunk only maps its own voxel
+// IDs to registry IDs instead of storing the definitions itself.
+
+// Definitions are reference counted. Once nothing uses one, its registry ID can be reused.
+
+class VoxelDataRegistry
+{
+private:
+	std::vector<VoxelData> voxelData;
+	std::vector<int> refCounts;
+	std::vector<uint16_t> freeIDs;
+
+	// IDs of each distinct voxel data definition in use.
+	std::unordered_map<VoxelData, uint16_t> voxelDataIDs;
+public:
+	// Gets the number of definitions in use.
+	int getCount() const;
+
+	// Gets the voxel data associated with a registry ID. The ID must be in use.
+	const VoxelData &get(uint16_t id) const;
+
+	// Gets the ID of an identical definition, or adds it, and adds a reference to it.
+	uint16_t acquire(const VoxelData &voxelData);
+
+	// Removes a reference to a definition. The last reference frees its ID.
+	void release(uint16_t id);
+};
+
+#endif
@@ -1,22 +1,100 @@
 #include <algorithm>
+#include <string>
 
+#include "VoxelDataType.h"
 #include "VoxelGrid.h"
+#include "../Utilities/Debug.h"
+
+const uint8_t VoxelGrid::MASK_WALL = 1 << 0;
+const uint8_t VoxelGrid::MASK_FLOOR = 1 << 1;
+const uint8_t VoxelGrid::MASK_CEILING = 1 << 2;
+const uint8_t VoxelGrid::MASK_RAISED = 1 << 3;
+const uint8_t VoxelGrid::MASK_DIAGONAL = 1 << 4;
+const uint8_t VoxelGrid::MASK_TRANSPARENT = 1 << 5;
+const uint8_t VoxelGrid::MASK_CHASM = 1 << 6;
+const uint8_t VoxelGrid::MASK_DOOR = 1 << 7;
+
+const int VoxelGrid::SMALL_BLOCK_DIM = 4;
+const int VoxelGrid::LARGE_BLOCK_DIM = 16;
+
+// Enough for a few wilderness chunks coming back into the grid at once.
+const int VoxelGrid::MAX_CHANGED_VOXELS = 32768;
 
 VoxelGrid::VoxelGrid(int width, int height, int depth)
 {
 	const int voxelCount = width * height * depth;
 	this->voxels = std::vector<uint16_t>(voxelCount, 0);
+	this->voxelMasks = std::vector<uint8_t>(voxelCount, 0);
 
 	this->width = width;
 	this->height = height;
 	this->depth = depth;
+
+	// Partial blocks on the far edges of the grid are counted like whole ones.
+	this->smallBlockWidth = (width + VoxelGrid::SMALL_BLOCK_DIM - 1) / VoxelGrid::SMALL_BLOCK_DIM;
+	this->largeBlockWidth = (width + VoxelGrid::LARGE_BLOCK_DIM - 1) / VoxelGrid::LARGE_BLOCK_DIM;
+	const int smallBlockDepth = (depth + VoxelGrid::SMALL_BLOCK_DIM - 1) / VoxelGrid::SMALL_BLOCK_DIM;
+	const int largeBlockDepth = (depth + VoxelGrid::LARGE_BLOCK_DIM - 1) / VoxelGrid::LARGE_BLOCK_DIM;
+
+	this->smallBlocksPerLayer = this->smallBlockWidth * smallBlockDepth;
+	this->largeBlocksPerLayer = this->largeBlockWidth * largeBlockDepth;
+
+	this->columnCounts = std::vector<uint16_t>(width * depth, 0);
+	this->smallBlockCounts = std::vector<uint16_t>(this->smallBlocksPerLayer, 0);
+	this->largeBlockCounts = std::vector<uint16_t>(this->largeBlocksPerLayer, 0);
+	this->layerSmallBlockCounts = std::vector<uint16_t>(this->smallBlocksPerLayer * height, 0);
+	this->layerLargeBlockCounts = std::vector<uint16_t>(this->largeBlocksPerLayer * height, 0);
+	this->revision = 0;
+	this->changeCount = 0;
 }
 
 int VoxelGrid::getIndex(int x, int y, int z) const
 {
+	DebugValidate((x >= 0) && (x < this->width) && (y >= 0) && (y < this->height) &&
+		(z >= 0) && (z < this->depth));
 	return x + (y * this->width) + (z * this->width * this->height);
 }
 
+int VoxelGrid::getSmallBlockIndex(int x, int z) const
+{
+	return (x / VoxelGrid::SMALL_BLOCK_DIM) +
+		((z / VoxelGrid::SMALL_BLOCK_DIM) * this->smallBlockWidth);
+}
+
+int VoxelGrid::getLargeBlockIndex(int x, int z) const
+{
+	return (x / VoxelGrid::LARGE_BLOCK_DIM) +
+		((z / VoxelGrid::LARGE_BLOCK_DIM) * this->largeBlockWidth);
+}
+
+uint8_t VoxelGrid::getMask(VoxelDataType dataType)
+{
+	switch (dataType)
+	{
+	case VoxelDataType::None:
+		return 0;
+	case VoxelDataType::Wall:
+		return VoxelGrid::MASK_WALL;
+	case VoxelDataType::Floor:
+		return VoxelGrid::MASK_FLOOR;
+	case VoxelDataType::Ceiling:
+		return VoxelGrid::MASK_CEILING;
+	case VoxelDataType::Raised:
+		return VoxelGrid::MASK_RAISED;
+	case VoxelDataType::Diagonal:
+		return VoxelGrid::MASK_DIAGONAL;
+	case VoxelDataType::TransparentWall:
+	case VoxelDataType::Edge:
+		return VoxelGrid::MASK_TRANSPARENT;
+	case VoxelDataType::Chasm:
+		return VoxelGrid::MASK_CHASM;
+	case VoxelDataType::Door:
+		return VoxelGrid::MASK_DOOR;
+	default:
+		DebugUnhandledReturnMsg(uint8_t, std::to_string(static_cast<int>(dataType)));
+	}
+}
+
 Int2 VoxelGrid::getTransformedCoordinate(const Int2 &voxel, int gridWidth, int gridDepth)
 {
 	// These have a -1 whereas the Double2 version does not since all .MIF start points
@@ -65,25 +143,186 @@ uint16_t VoxelGrid::getVoxel(int x, int y, int z) const
 	return this->voxels.data()[index];
 }
 
+uint8_t VoxelGrid::getVoxelMask(int x, int y, int z) const
+{
+	const int index = this->getIndex(x, y, z);
+	return this->voxelMasks.data()[index];
+}
+
+int VoxelGrid::getEmptyColumnSpan(int x, int z) const
+{
+	if (this->largeBlockCounts[this->getLargeBlockIndex(x, z)] == 0)
+	{
+		return VoxelGrid::LARGE_BLOCK_DIM;
+	}
+	else if (this->smallBlockCounts[this->getSmallBlockIndex(x, z)] == 0)
+	{
+		return VoxelGrid::SMALL_BLOCK_DIM;
+	}
+	else if (this->columnCounts[x + (z * this->width)] == 0)
+	{
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+int VoxelGrid::getEmptyLayerSpan(int x, int y, int z) const
+{
+	DebugAssert((y >= 0) && (y < this->height));
+
+	// Smallest to largest, so crowded places stop after the first lookups.
+	if (this->getVoxelMask(x, y, z) != 0)
+	{
+		return 0;
+	}
+	else if (this->layerSmallBlockCounts[this->getSmallBlockIndex(x, z) +
+		(y * this->smallBlocksPerLayer)] != 0)
+	{
+		return 1;
+	}
+	else if (this->layerLargeBlockCounts[this->getLargeBlockIndex(x, z) +
+		(y * this->largeBlocksPerLayer)] != 0)
+	{
+		return VoxelGrid::SMALL_BLOCK_DIM;
+	}
+	else
+	{
+		return VoxelGrid::LARGE_BLOCK_DIM;
+	}
+}
+
+uint32_t VoxelGrid::getRevision() const
+{
+	return this->revision;
+}
+
+uint32_t VoxelGrid::getChangeCount() const
+{
+	return this->changeCount;
+}
+
+bool VoxelGrid::getChangedVoxels(uint32_t changeCount, const Int3 **outVoxels,
+	int *outVoxelCount) const
+{
+	// Unsigned differences so the counts can wrap around.
+	const uint32_t newChangeCount = this->changeCount - changeCount;
+	if (newChangeCount > static_cast<uint32_t>(this->changedVoxels.size()))
+	{
+		return false;
+	}
+
+	*outVoxelCount = static_cast<int>(newChangeCount);
+	*outVoxels = this->changedVoxels.data() + (this->changedVoxels.size() - newChangeCount);
+	return true;
+}
+
+size_t VoxelGrid::getByteCount() const
+{
+	const size_t countBytes = (this->columnCounts.capacity() + this->smallBlockCounts.capacity() +
+		this->largeBlockCounts.capacity() + this->layerSmallBlockCounts.capacity() +
+		this->layerLargeBlockCounts.capacity()) * sizeof(uint16_t);
+
+	return (this->voxels.capacity() * sizeof(uint16_t)) + this->voxelMasks.capacity() +
+		(this->voxelData.capacity() * sizeof(VoxelData)) + countBytes +
+		(this->changedVoxels.capacity() * sizeof(Int3));
+}
+
+int VoxelGrid::getVoxelDataCount() const
+{
+	return static_cast<int>(this->voxelData.size());
+}
+
 VoxelData &VoxelGrid::getVoxelData(uint16_t id)
 {
-	return this->voxelData.at(id);
+	DebugValidateIndex(this->voxelData, id);
+	return this->voxelData[id];
 }
 
 const VoxelData &VoxelGrid::getVoxelData(uint16_t id) const
 {
-	return this->voxelData.at(id);
+	DebugValidateIndex(this->voxelData, id);
+	return this->voxelData[id];
 }
 
 uint16_t VoxelGrid::addVoxelData(const VoxelData &voxelData)
 {
+	DebugAssertMsg(this->voxelData.size() <= UINT16_MAX, "Too many voxel data definitions.");
+
+	const uint16_t id = static_cast<uint16_t>(this->voxelData.size());
 	this->voxelData.push_back(voxelData);
 
-	return static_cast<uint16_t>(this->voxelData.size() - 1);
+	// Keep the first ID of a definition so findOrAdd() stays stable.
+	this->voxelDataIDs.emplace(voxelData, id);
+	this->revision++;
+
+	return id;
+}
+
+uint16_t VoxelGrid::findOrAdd(const VoxelData &voxelData)
+{
+	const auto iter = this->voxelDataIDs.find(voxelData);
+	if (iter != this->voxelDataIDs.end())
+	{
+		return iter->second;
+	}
+	else
+	{
+		return this->addVoxelData(voxelData);
+	}
 }
 
 void VoxelGrid::setVoxel(int x, int y, int z, uint16_t id)
 {
 	const int index = this->getIndex(x, y, z);
 	this->voxels.data()[index] = id;
+	this->revision++;
+
+	// Drop the older half of the kept changes when full, so they're only moved once in a
+	// while instead of on every set.
+	if (static_cast<int>(this->changedVoxels.size()) == VoxelGrid::MAX_CHANGED_VOXELS)
+	{
+		this->changedVoxels.erase(this->changedVoxels.begin(),
+			this->changedVoxels.begin() + (VoxelGrid::MAX_CHANGED_VOXELS / 2));
+	}
+
+	this->changedVoxels.push_back(Int3(x, y, z));
+	this->changeCount++;
+
+	const uint8_t oldMask = this->voxelMasks[index];
+	const uint8_t newMask = VoxelGrid::getMask(this->getVoxelData(id).dataType);
+	this->voxelMasks[index] = newMask;
+
+	// Update the non-empty counts if the voxel changed between empty and non-empty.
+	const bool wasEmpty = oldMask == 0;
+	const bool isEmpty = newMask == 0;
+	if (wasEmpty != isEmpty)
+	{
+		uint16_t &columnCount = this->columnCounts[x + (z * this->width)];
+		uint16_t &smallBlockCount = this->smallBlockCounts[this->getSmallBlockIndex(x, z)];
+		uint16_t &largeBlockCount = this->largeBlockCounts[this->getLargeBlockIndex(x, z)];
+		uint16_t &layerSmallBlockCount = this->layerSmallBlockCounts[
+			this->getSmallBlockIndex(x, z) + (y * this->smallBlocksPerLayer)];
+		uint16_t &layerLargeBlockCount = this->layerLargeBlockCounts[
+			this->getLargeBlockIndex(x, z) + (y * this->largeBlocksPerLayer)];
+
+		if (isEmpty)
+		{
+			columnCount--;
+			smallBlockCount--;
+			largeBlockCount--;
+			layerSmallBlockCount--;
+			layerLargeBlockCount--;
+		}
+		else
+		{
+			columnCount++;
+			smallBlockCount++;
+			largeBlockCount++;
+			layerSmallBlockCount++;
+			layerLargeBlockCount++;
+		}
+	}
 }
@@ -2,10 +2,12 @@
 #define VOXEL_GRID_H
 
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 #include "VoxelData.h"
 #include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
 
 // A voxel grid is a 3D array of voxel IDs with their associated voxel definitions.
 
@@ -13,18 +15,71 @@
 // there are over a few hundred unique voxel data definitions, which mandates that the voxel
 // type itself be at least unsigned 16-bit.
 
+// Alongside the IDs, the grid keeps a byte of category bits per voxel and counts of non-empty
+// voxels per XZ column and per aligned block of columns, so ray casts can step over empty
+// space without looking up voxel data.
+
+// The most recently set voxels are kept in order too, so caches built from the grid (the
+// automap, visibility regions, level voxel flags) can update from just the voxels that
+// changed since they last looked instead of going over the whole grid again.
+
 class VoxelGrid
 {
 private:
 	std::vector<uint16_t> voxels;
+	std::vector<uint8_t> voxelMasks;
 	std::vector<VoxelData> voxelData;
+
+	// IDs of each distinct voxel data definition, for reusing identical ones.
+	std::unordered_map<VoxelData, uint16_t> voxelDataIDs;
+
+	// Non-empty voxel counts for each XZ column and each aligned small and large block of
+	// XZ columns.
+	std::vector<uint16_t> columnCounts, smallBlockCounts, largeBlockCounts;
+
+	// Non-empty voxel counts for each aligned small and large block of XZ columns at each
+	// height, for rays that stay at one height.
+	std::vector<uint16_t> layerSmallBlockCounts, layerLargeBlockCounts;
 	int width, height, depth;
+	int smallBlockWidth, largeBlockWidth, smallBlocksPerLayer, largeBlocksPerLayer;
+
+	// Incremented whenever a voxel is set or voxel data is added.
+	uint32_t revision;
+
+	// Most recently set voxels, oldest first. Only the newest ones are kept, so a cache that
+	// falls too far behind has to rebuild from the whole grid.
+	std::vector<Int3> changedVoxels;
+	uint32_t changeCount; // Number of voxels ever set, including ones no longer kept.
 
 	// Converts XYZ coordinate to index.
 	int getIndex(int x, int y, int z) const;
+
+	// Converts XZ coordinate to an index into the small or large block counts.
+	int getSmallBlockIndex(int x, int z) const;
+	int getLargeBlockIndex(int x, int z) const;
 public:
+	// Category bits for each kind of voxel data. An empty voxel has no bits set.
+	static const uint8_t MASK_WALL;
+	static const uint8_t MASK_FLOOR;
+	static const uint8_t MASK_CEILING;
+	static const uint8_t MASK_RAISED;
+	static const uint8_t MASK_DIAGONAL;
+	static const uint8_t MASK_TRANSPARENT; // Transparent walls and edges.
+	static const uint8_t MASK_CHASM;
+	static const uint8_t MASK_DOOR;
+
+	// Widths in voxels of the aligned XZ blocks used for skipping empty space.
+	static const int SMALL_BLOCK_DIM;
+	static const int LARGE_BLOCK_DIM;
+
+	// Most set voxels kept for caches to update from.
+	static const int MAX_CHANGED_VOXELS;
+
 	VoxelGrid(int width, int height, int depth);
 
+	// Gets the category bit associated with a voxel data type.
+	static uint8_t getMask(VoxelDataType dataType);
+
 	// Transformation methods for converting voxel coordinates between Arena's format
 	// (+X west, +Z south) and the new format (+X north, +Z east). This is a bi-directional
 	// conversion (i.e., it works both ways. Not exactly sure why).
@@ -43,14 +98,53 @@ public:
 	// Convenience method for getting a voxel's ID.
 	uint16_t getVoxel(int x, int y, int z) const;
 
+	// Gets the category bits of a voxel's data type. Zero if the voxel is empty.
+	uint8_t getVoxelMask(int x, int y, int z) const;
+
+	// Gets the width of the largest aligned XZ block around the given column that is empty
+	// at every height (the large block width, the small block width, or 1), or 0 if the
+	// column has anything in it.
+	int getEmptyColumnSpan(int x, int z) const;
+
+	// Same as getEmptyColumnSpan() but only for voxels at the given height, or 0 if the voxel
+	// itself isn't empty.
+	int getEmptyLayerSpan(int x, int y, int z) const;
+
+	// Gets a number that changes whenever a voxel is set or voxel data is added, so users of
+	// the grid can tell it hasn't changed since they last looked. Writes through the non-const
+	// getters aren't counted.
+	uint32_t getRevision() const;
+
+	// Gets the number of voxels set so far, for caches to remember which changes they've seen.
+	// Writes through the non-const getters aren't counted.
+	uint32_t getChangeCount() const;
+
+	// Gets the voxels set since the given change count, oldest first (a voxel is in the list
+	// again each time it's set). Returns false if some of them aren't kept anymore, in which
+	// case the caller has to rebuild from the whole grid.
+	bool getChangedVoxels(uint32_t changeCount, const Int3 **outVoxels,
+		int *outVoxelCount) const;
+
+	// Gets the heap bytes held by the voxels, their data, and the empty space counts.
+	size_t getByteCount() const;
+
+	// Gets the number of voxel data definitions. IDs go from 0 to one less than this.
+	int getVoxelDataCount() const;
+
 	// Gets the voxel data associated with an ID.
 	VoxelData &getVoxelData(uint16_t id);
 	const VoxelData &getVoxelData(uint16_t id) const;
 
-	// Adds a voxel data object and returns its assigned ID.
+	// Adds a voxel data object and returns its assigned ID. The ID is always new, even if an
+	// identical definition already exists.
 	uint16_t addVoxelData(const VoxelData &voxelData);
 
-	// Convenience method for setting a voxel's ID.
+	// Gets the ID of an identical voxel data definition if there is one, otherwise adds it.
+	// Level loaders should prefer this so the voxel data list has no duplicates.
+	uint16_t findOrAdd(const VoxelData &voxelData);
+
+	// Convenience method for setting a voxel's ID. The voxel data for the ID must already
+	// exist so the voxel's category bits can be updated.
 	void setVoxel(int x, int y, int z, uint16_t id);
 };
 
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "WildernessChunkLoader.h"
+#include "../Utilities/Debug.h"
+#include "../Utilities/JobSystem.h"
+
+WildernessChunkLoader::WildernessChunkLoader()
+{
+	this->priorityVoxel = Int2(0, 0);
+	this->busyCount = 0;
+	this->reading = false;
+	this->stop = false;
+}
+
+WildernessChunkLoader::~WildernessChunkLoader()
+{
+	// Blocks not read yet are dropped.
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->stop = true;
+	lock.unlock();
+
+	if (this->readJob.valid())
+	{
+		this->readJob.wait();
+	}
+}
+
+void WildernessChunkLoader::readQueued()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		if (this->stop || this->jobs.empty())
+		{
+			// The next block queued starts another read job.
+			this->reading = false;
+			break;
+		}
+
+		// Take the job nearest to the priority voxel.
+		const Int2 voxel = this->priorityVoxel;
+		const auto iter = std::min_element(this->jobs.begin(), this->jobs.end(),
+			[&voxel](const Job &a, const Job &b)
+		{
+			auto getDistSqr = [&voxel](const Job &job)
+			{
+				const int diffX = std::max(std::max(job.voxelMin.x - voxel.x,
+					voxel.x - (job.voxelMax.x - 1)), 0);
+				const int diffZ = std::max(std::max(job.voxelMin.y - voxel.y,
+					voxel.y - (job.voxelMax.y - 1)), 0);
+				return (diffX * diffX) + (diffZ * diffZ);
+			};
+
+			return getDistSqr(a) < getDistSqr(b);
+		});
+
+		const Job job = *iter;
+		this->jobs.erase(iter);
+		this->busyCount++;
+		lock.unlock();
+
+		const std::string rmdName = [&job]()
+		{
+			std::stringstream ss;
+			ss << std::setw(3) << std::setfill('0') << job.rmdID;
+			return "WILD" + ss.str() + ".RMD";
+		}();
+
+		Result result;
+		result.chunk = job.chunk;
+		if (!result.rmd.init(rmdName.c_str()))
+		{
+			DebugCrash("Could not init .RMD file \"" + rmdName + "\".");
+		}
+
+		lock.lock();
+		this->results.push_back(std::move(result));
+		this->busyCount--;
+		lock.unlock();
+		this->resultCondVar.notify_one();
+	}
+}
+
+void WildernessChunkLoader::init()
+{
+	// Blocks are read by a job that's only submitted once there are blocks queued.
+	std::lock_guard<std::mutex> lock(this->mutex);
+	DebugAssert(this->jobs.empty() && !this->reading);
+}
+
+void WildernessChunkLoader::add(const Int2 &chunk, const Int2 &voxelMin, const Int2 &voxelMax,
+	int rmdID)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	Job job;
+	job.chunk = chunk;
+	job.voxelMin = voxelMin;
+	job.voxelMax = voxelMax;
+	job.rmdID = rmdID;
+	this->jobs.push_back(job);
+
+	// It's submitted unlocked since it runs right away if the job system is shut down.
+	const bool startReading = !this->reading;
+	this->reading = true;
+	lock.unlock();
+
+	if (startReading)
+	{
+		this->readJob = JobSystem::submit(JobSystem::Priority::Streaming,
+			[this]() { this->readQueued(); });
+	}
+}
+
+void WildernessChunkLoader::setPriorityVoxel(const Int2 &voxel)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->priorityVoxel = voxel;
+}
+
+bool WildernessChunkLoader::hasPendingChunks() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return !this->jobs.empty() || (this->busyCount > 0) || !this->results.empty();
+}
+
+std::vector<WildernessChunkLoader::Result> WildernessChunkLoader::takeResults(bool wait)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	if (wait)
+	{
+		this->resultCondVar.wait(lock, [this]()
+		{
+			return this->jobs.empty() && (this->busyCount == 0);
+		});
+	}
+
+	std::vector<Result> finishedResults = std::move(this->results);
+	this->results.clear();
+	return finishedResults;
+}
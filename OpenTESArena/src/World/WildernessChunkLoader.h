@@ -0,0 +1,68 @@
+#ifndef WILDERNESS_CHUNK_LOADER_H
+#define WILDERNESS_CHUNK_LOADER_H
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "../Assets/RMDFile.h"
+#include "../Math/Vector2.h"
+
+// Reads wilderness .RMD blocks with a streaming job so leaving a city doesn't freeze the
+// game. The block closest to the player is always read next. Finished blocks are picked up
+// by the main thread, which writes them into the level.
+
+class WildernessChunkLoader
+{
+public:
+	struct Result
+	{
+		Int2 chunk; // Chunk coordinates in the voxel grid.
+		RMDFile rmd;
+	};
+private:
+	struct Job
+	{
+		Int2 chunk, voxelMin, voxelMax;
+		int rmdID;
+	};
+
+	std::vector<Job> jobs;
+	std::vector<Result> results;
+	mutable std::mutex mutex;
+	std::condition_variable resultCondVar;
+	std::future<void> readJob; // Reads queued blocks until there are none left.
+	Int2 priorityVoxel;
+	int busyCount; // Jobs taken by the read job but not yet in the results.
+	bool reading; // Whether the read job is taking blocks from the queue.
+	bool stop;
+
+	// Reads jobs until the queue is empty or told to stop.
+	void readQueued();
+public:
+	WildernessChunkLoader();
+	WildernessChunkLoader(const WildernessChunkLoader&) = delete;
+	~WildernessChunkLoader();
+
+	WildernessChunkLoader &operator=(const WildernessChunkLoader&) = delete;
+
+	// Gets the loader ready to take blocks.
+	void init();
+
+	// Queues an .RMD block to be read for the chunk covering the given XZ voxels (max is
+	// exclusive).
+	void add(const Int2 &chunk, const Int2 &voxelMin, const Int2 &voxelMax, int rmdID);
+
+	// Sets the voxel whose closest queued chunk is read next.
+	void setPriorityVoxel(const Int2 &voxel);
+
+	// Returns whether any chunk is queued, being read, or waiting to be taken.
+	bool hasPendingChunks() const;
+
+	// Gets the chunks finished since the last call. If wait is true, blocks until every
+	// queued chunk is done.
+	std::vector<Result> takeResults(bool wait);
+};
+
+#endif
@@ -30,6 +30,20 @@ inline uint16_t read_le16(std::istream &stream)
     return ((uint16_t(buf[0]   )&0x00ff) | (uint16_t(buf[1]<<8)&0xff00));
 }
 
+// Gets the key a file name is looked up by, so lookups ignore case and either slash.
+inline std::string foldName(const char *name)
+{
+    std::string folded(name);
+    for(char &c : folded)
+    {
+        if(c == '\\')
+            c = '/';
+        else if(c >= 'a' && c <= 'z')
+            c = static_cast<char>(c - 'a' + 'A');
+    }
+    return folded;
+}
+
 
 class ConstrainedFileStreamBuf : public std::streambuf {
     std::streamsize mStart, mEnd;
@@ -62,6 +76,28 @@ public:
 };
 
 
+// Read-only stream buffer over bytes already in memory (i.e., a memory-mapped archive entry),
+// so reads are copies out of the mapping instead of file reads.
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const char *data, std::streamsize size);
+
+    virtual pos_type seekoff(off_type offset, std::ios_base::seekdir whence, std::ios_base::openmode mode);
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode mode);
+};
+
+class MemoryStream : public std::istream {
+    MemoryStreamBuf mBuffer;
+
+public:
+    MemoryStream(const char *data, std::streamsize size)
+        : std::istream(nullptr), mBuffer(data, size)
+    {
+        rdbuf(&mBuffer);
+    }
+};
+
+
 class Archive {
 public:
     virtual ~Archive() { }
@@ -5,10 +5,112 @@
 #include <sstream>
 #include <fstream>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 namespace Archives
 {
 
+BsaArchive::BsaArchive()
+  : mHash(0), mMappedData(nullptr), mMappedSize(0)
+#ifdef _WIN32
+  , mFileHandle(nullptr), mMappingHandle(nullptr)
+#endif
+{
+}
+
+BsaArchive::~BsaArchive()
+{
+    unmap();
+}
+
+void BsaArchive::map()
+{
+    unmap();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(mFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping == nullptr)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(view == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return;
+    }
+
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mMappedData = static_cast<const char*>(view);
+    mMappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(mFilename.c_str(), O_RDONLY);
+    if(fd < 0)
+        return;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file alive, so the descriptor isn't needed anymore.
+    close(fd);
+    if(view == MAP_FAILED)
+        return;
+
+    mMappedData = static_cast<const char*>(view);
+    mMappedSize = static_cast<size_t>(st.st_size);
+#endif
+}
+
+void BsaArchive::unmap()
+{
+    if(mMappedData == nullptr)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mMappedData);
+    CloseHandle(mMappingHandle);
+    CloseHandle(mFileHandle);
+    mFileHandle = nullptr;
+    mMappingHandle = nullptr;
+#else
+    munmap(const_cast<char*>(mMappedData), mMappedSize);
+#endif
+
+    mMappedData = nullptr;
+    mMappedSize = 0;
+}
+
 void BsaArchive::loadNamed(size_t count, std::istream& stream)
 {
     std::vector<std::string> names; names.reserve(count);
@@ -39,19 +141,29 @@ void BsaArchive::loadNamed(size_t count, std::istream& stream)
     if(!stream.good())
         throw std::runtime_error("Failed reading archive footer");
 
-    for(const std::string &name : names)
+    uint64_t hash = 14695981039346656037ULL;
+    auto hashByte = [&hash](uint8_t byte) { hash = (hash ^ byte) * 1099511628211ULL; };
+    for(size_t i = 0;i < count;++i)
     {
-        auto iter = std::lower_bound(mLookupName.begin(), mLookupName.end(), name);
-        if(iter == mLookupName.end() || *iter != name)
-            mLookupName.insert(iter, name);
+        for(char c : names[i])
+            hashByte(static_cast<uint8_t>(c));
+
+        const uint64_t size = static_cast<uint64_t>(entries[i].mEnd - entries[i].mStart);
+        for(int shift = 0;shift < 64;shift += 8)
+            hashByte(static_cast<uint8_t>(size >> shift));
     }
+    mHash = hash;
 
-    mEntries.resize(mLookupName.size());
+    // Later entries with the same name replace earlier ones.
+    mEntries = std::move(entries);
+    mIndex.clear();
+    mIndex.reserve(count);
     for(size_t i = 0;i < count;++i)
-    {
-        auto iter = std::find(mLookupName.cbegin(), mLookupName.cend(), names[i]);
-        mEntries[std::distance(mLookupName.cbegin(), iter)] = entries[i];
-    }
+        mIndex[foldName(names[i].c_str())] = i;
+
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    mLookupName = std::move(names);
 }
 
 void BsaArchive::load(const std::string &fname)
@@ -64,12 +176,95 @@ void BsaArchive::load(const std::string &fname)
 
     size_t count = read_le16(stream);
 
-    mEntries.reserve(count);
     loadNamed(count, stream);
+
+    // Entries are handed out straight from a mapping of the archive when possible. If any
+    // entry runs past the end of the file, the stream path's bounds checks are used instead.
+    map();
+    const bool entriesInBounds = std::all_of(mEntries.begin(), mEntries.end(),
+        [this](const Entry &entry) { return (entry.mEnd >= entry.mStart) &&
+            (static_cast<size_t>(entry.mEnd) <= mMappedSize); });
+    if(!entriesInBounds)
+        unmap();
+}
+
+const BsaArchive::Entry *BsaArchive::find(const char *name) const
+{
+    auto iter = mIndex.find(foldName(name));
+    return (iter != mIndex.end()) ? &mEntries[iter->second] : nullptr;
+}
+
+void BsaArchive::prefetch(const std::vector<std::string> &names) const
+{
+    // Gaps smaller than this are read along with the entries around them, since one larger
+    // read is cheaper than two seeks on a hard drive or a network share.
+    const std::streamsize maxGap = 64 * 1024;
+
+    std::vector<Entry> ranges;
+    ranges.reserve(names.size());
+    for(const std::string &name : names)
+    {
+        const Entry *entry = find(name.c_str());
+        if(entry != nullptr && entry->mEnd > entry->mStart)
+            ranges.push_back(*entry);
+    }
+
+    if(ranges.empty())
+        return;
+
+    std::sort(ranges.begin(), ranges.end(),
+        [](const Entry &a, const Entry &b) { return a.mStart < b.mStart; });
+
+    std::vector<Entry> merged;
+    merged.push_back(ranges.front());
+    for(size_t i = 1;i < ranges.size();++i)
+    {
+        Entry &last = merged.back();
+        if(ranges[i].mStart <= last.mEnd + maxGap)
+            last.mEnd = std::max(last.mEnd, ranges[i].mEnd);
+        else
+            merged.push_back(ranges[i]);
+    }
+
+#ifndef _WIN32
+    if(mMappedData != nullptr)
+    {
+        // madvise() needs a page-aligned start.
+        const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        for(const Entry &range : merged)
+        {
+            const uintptr_t start = reinterpret_cast<uintptr_t>(mMappedData + range.mStart);
+            const uintptr_t end = reinterpret_cast<uintptr_t>(mMappedData + range.mEnd);
+            const uintptr_t alignedStart = start & ~(pageSize - 1);
+            madvise(reinterpret_cast<void*>(alignedStart), end - alignedStart, MADV_WILLNEED);
+        }
+    }
+#if defined(POSIX_FADV_WILLNEED)
+    else
+    {
+        // Entries are streamed from the file, so the hint goes to its page cache instead.
+        // The advice outlives the descriptor.
+        const int fd = ::open(mFilename.c_str(), O_RDONLY);
+        if(fd < 0)
+            return;
+
+        for(const Entry &range : merged)
+            posix_fadvise(fd, range.mStart, range.mEnd - range.mStart, POSIX_FADV_WILLNEED);
+
+        close(fd);
+    }
+#endif
+#else
+    // No hint is given on Windows yet.
+    static_cast<void>(merged);
+#endif
 }
 
 IStreamPtr BsaArchive::open(const Entry &entry)
 {
+    if(mMappedData != nullptr)
+        return IStreamPtr(new MemoryStream(mMappedData + entry.mStart, entry.mEnd - entry.mStart));
+
     std::unique_ptr<std::istream> stream(new std::ifstream(mFilename, std::ios::binary));
     if(!stream->seekg(entry.mStart))
         return IStreamPtr(nullptr);
@@ -78,15 +273,29 @@ IStreamPtr BsaArchive::open(const Entry &entry)
 
 IStreamPtr BsaArchive::open(const char *name)
 {
-    auto iter = std::lower_bound(mLookupName.begin(), mLookupName.end(), name);
-    if(iter == mLookupName.end() || *iter != name)
+    const Entry *entry = find(name);
+    if(entry == nullptr)
         return IStreamPtr(nullptr);
-    return open(mEntries[std::distance(mLookupName.begin(), iter)]);
+    return open(*entry);
+}
+
+bool BsaArchive::getData(const char *name, const char **data, size_t *size) const
+{
+    if(mMappedData == nullptr)
+        return false;
+
+    const Entry *entry = find(name);
+    if(entry == nullptr)
+        return false;
+
+    *data = mMappedData + entry->mStart;
+    *size = static_cast<size_t>(entry->mEnd - entry->mStart);
+    return true;
 }
 
 bool BsaArchive::exists(const char *name) const
 {
-    return std::binary_search(mLookupName.begin(), mLookupName.end(), name);
+    return find(name) != nullptr;
 }
 
 } // namespace Archives
@@ -1,10 +1,11 @@
 #ifndef COMPONENTS_ARCHIVES_BSAARCHIVE_HPP
 #define COMPONENTS_ARCHIVES_BSAARCHIVE_HPP
 
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <set>
 
 #include "archive.hpp"
 
@@ -13,6 +14,7 @@ namespace Archives
 {
 
 class BsaArchive : public Archive {
+    // Entry names sorted, for list().
     std::vector<std::string> mLookupName;
 
     struct Entry {
@@ -21,15 +23,57 @@ class BsaArchive : public Archive {
     };
     std::vector<Entry> mEntries;
 
+    // Index into mEntries of each case-folded entry name, built once at load.
+    std::unordered_map<std::string, size_t> mIndex;
+
     std::string mFilename;
 
+    // FNV-1a of the entry names and sizes, for telling whether data made from the archive
+    // came from this copy of it.
+    uint64_t mHash;
+
+    // The whole archive file mapped read-only into memory, or null if it couldn't be mapped
+    // (entries are then streamed from the file instead).
+    const char *mMappedData;
+    size_t mMappedSize;
+#ifdef _WIN32
+    void *mFileHandle;
+    void *mMappingHandle;
+#endif
+
     void loadNamed(size_t count, std::istream &stream);
 
+    void map();
+    void unmap();
+
+    // Gets the entry with the given name, ignoring case, or null if there isn't one.
+    const Entry *find(const char *name) const;
+
     IStreamPtr open(const Entry &entry);
 
 public:
+    BsaArchive();
+    BsaArchive(const BsaArchive&) = delete;
+    ~BsaArchive();
+
+    BsaArchive& operator=(const BsaArchive&) = delete;
+
     void load(const std::string &fname);
 
+    bool isMapped() const { return mMappedData != nullptr; }
+
+    uint64_t getHash() const { return mHash; }
+
+    // Tells the OS that the given entries will be read soon, so it can read them ahead in
+    // archive order. Entries close to each other are hinted as one range. Names that aren't
+    // in the archive are ignored.
+    void prefetch(const std::vector<std::string> &names) const;
+
+    // Gets an entry's bytes in the mapped archive without copying them. They stay valid
+    // until the archive is loaded again or destroyed. Returns false if there's no such entry
+    // or the archive isn't mapped.
+    bool getData(const char *name, const char **data, size_t *size) const;
+
     virtual IStreamPtr open(const char *name) override;
     virtual bool exists(const char *name) const override;
     virtual const std::vector<std::string> &list() const override final { return mLookupName; }
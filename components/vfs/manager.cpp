@@ -5,8 +5,10 @@
 #include "../misc/fnmatch.h"
 #else
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <fnmatch.h>
+#include <unistd.h>
 #endif
 
 #include <algorithm>
@@ -15,19 +17,35 @@
 #include <cstring>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 #include "../archives/bsaarchive.hpp"
 
 namespace
 {
-	std::vector<std::string> gRootPaths;
+	std::vector<std::vector<std::string>> gRootPathFiles; // Relative names of each path's files.
+	std::unordered_map<std::string, std::string> gLooseFiles; // Case-folded name -> path.
 	Archives::BsaArchive gGlobalBsa;
 }
 
 namespace VFS
 {
 
+void FileView::setOwned(std::unique_ptr<std::byte[]> data, size_t size)
+{
+	mOwned = std::move(data);
+	mData = mOwned.get();
+	mSize = size;
+}
+
+void FileView::setMapped(const std::byte *data, size_t size)
+{
+	mOwned = nullptr;
+	mData = data;
+	mSize = size;
+}
+
 Manager::Manager()
 {
 }
@@ -39,8 +57,11 @@ void Manager::initialize(std::string&& rootPath)
 	else if ((rootPath.back() != '/') && (rootPath.back() != '\\'))
 		rootPath += '/';
 
-	gGlobalBsa.load(rootPath + "GLOBAL.BSA");
-	gRootPaths.push_back(std::move(rootPath));
+	// The archive's casing differs between copies of the game too, so it's found through the
+	// index like any other file.
+	Manager::addLooseFiles(rootPath);
+	const std::string *bsaPath = Manager::findLooseFile("GLOBAL.BSA");
+	gGlobalBsa.load((bsaPath != nullptr) ? *bsaPath : (rootPath + "GLOBAL.BSA"));
 }
 
 void Manager::addDataPath(std::string&& path)
@@ -50,7 +71,25 @@ void Manager::addDataPath(std::string&& path)
 	else if ((path.back() != '/') && (path.back() != '\\'))
 		path += '/';
 
-	gRootPaths.push_back(std::move(path));
+	Manager::addLooseFiles(path);
+}
+
+void Manager::addLooseFiles(const std::string &rootPath)
+{
+	std::vector<std::string> names;
+	Manager::addDir(rootPath + '.', std::string(), nullptr, names);
+
+	// Newer paths take precedence.
+	for (const std::string &name : names)
+		gLooseFiles[Archives::foldName(name.c_str())] = rootPath + name;
+
+	gRootPathFiles.push_back(std::move(names));
+}
+
+const std::string *Manager::findLooseFile(const char *name)
+{
+	const auto iter = gLooseFiles.find(Archives::foldName(name));
+	return (iter != gLooseFiles.end()) ? &iter->second : nullptr;
 }
 
 IStreamPtr Manager::open(const char *name, bool *inGlobalBSA)
@@ -58,26 +97,19 @@ IStreamPtr Manager::open(const char *name, bool *inGlobalBSA)
 	assert(name != nullptr);
 	assert(inGlobalBSA != nullptr);
 
-	std::unique_ptr<std::ifstream> stream(new std::ifstream());
-
-	// Search in reverse, so newer paths take precedence.
-	const auto iter = std::find_if(gRootPaths.rbegin(), gRootPaths.rend(),
-		[name, &stream](const std::string &rootPath)
+	const std::string *path = Manager::findLooseFile(name);
+	if (path != nullptr)
 	{
-		stream->open(rootPath + name, std::ios::binary);
-		return stream->good();
-	});
-
-	if (iter != gRootPaths.rend())
-	{
-		*inGlobalBSA = false;
-		return IStreamPtr(std::move(stream));
-	}
-	else
-	{
-		*inGlobalBSA = true;
-		return gGlobalBsa.open(name);
+		std::unique_ptr<std::ifstream> stream(new std::ifstream(*path, std::ios::binary));
+		if (stream->good())
+		{
+			*inGlobalBSA = false;
+			return IStreamPtr(std::move(stream));
+		}
 	}
+
+	*inGlobalBSA = true;
+	return gGlobalBsa.open(name);
 }
 
 IStreamPtr Manager::open(const char *name)
@@ -88,34 +120,7 @@ IStreamPtr Manager::open(const char *name)
 
 IStreamPtr Manager::openCaseInsensitive(const char *name, bool *inGlobalBSA)
 {
-	// Since the given filename is assumed to be unique in its directory, we only need to
-	// worry about filenames just like it but with different casing.
-	std::string newName = name;
-
-	// Case 1: upper first character, lower rest.
-	newName.front() = std::toupper(newName.front());
-	std::for_each(newName.begin() + 1, newName.end(),
-		[](char &c) { c = std::tolower(c); });
-
-	IStreamPtr stream = this->open(newName.c_str(), inGlobalBSA);
-
-	if (stream != nullptr)
-	{
-		return stream;
-	}
-	else
-	{
-		// Case 2: all uppercase.
-		for (char &c : newName)
-		{
-			c = std::toupper(c);
-		}
-
-		stream = this->open(newName.c_str(), inGlobalBSA);
-
-		// The caller does error checking to see if this is null.
-		return stream;
-	}
+	return this->open(name, inGlobalBSA);
 }
 
 IStreamPtr Manager::openCaseInsensitive(const char *name)
@@ -154,45 +159,65 @@ bool Manager::read(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *
 
 bool Manager::readCaseInsensitive(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize,
 	bool *inGlobalBSA)
+{
+	return this->read(name, dst, dstSize, inGlobalBSA);
+}
+
+bool Manager::readCaseInsensitive(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize)
+{
+	bool dummy;
+	return this->readCaseInsensitive(name, dst, dstSize, &dummy);
+}
+
+bool Manager::read(const char *name, FileView *dst, bool *inGlobalBSA)
 {
 	assert(name != nullptr);
 	assert(dst != nullptr);
-	assert(dstSize != nullptr);
+	assert(inGlobalBSA != nullptr);
 
-	IStreamPtr stream = this->openCaseInsensitive(name, inGlobalBSA);
-	if (stream == nullptr)
+	// Loose files take precedence over GLOBAL.BSA, the same as open().
+	const bool isLooseFile = Manager::findLooseFile(name) != nullptr;
+
+	const char *data;
+	size_t size;
+	if (!isLooseFile && gGlobalBsa.getData(name, &data, &size))
+	{
+		*inGlobalBSA = true;
+		dst->setMapped(reinterpret_cast<const std::byte*>(data), size);
+		return true;
+	}
+
+	// Copy the file instead.
+	std::unique_ptr<std::byte[]> owned;
+	if (!this->read(name, &owned, &size, inGlobalBSA))
 	{
-		// @todo: use Debug logging.
-		std::cerr << "Could not open \"" << name << "\"." << '\n';
 		return false;
 	}
 
-	stream->seekg(0, std::ios::end);
-	*dstSize = stream->tellg();
-	*dst = std::make_unique<std::byte[]>(*dstSize);
-	stream->seekg(0, std::ios::beg);
-	stream->read(reinterpret_cast<char*>(dst->get()), *dstSize);
+	dst->setOwned(std::move(owned), size);
 	return true;
 }
 
-bool Manager::readCaseInsensitive(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize)
+bool Manager::read(const char *name, FileView *dst)
 {
 	bool dummy;
-	return this->readCaseInsensitive(name, dst, dstSize, &dummy);
+	return this->read(name, dst, &dummy);
 }
 
 bool Manager::exists(const char *name)
 {
-	std::ifstream file;
-	const auto iter = std::find_if(gRootPaths.begin(), gRootPaths.end(),
-		[name, &file](const std::string &rootPath)
-	{
-		file.open(rootPath + name, std::ios::binary);
-		return file.is_open();
-	});
-
 	// If not in the root paths, then check inside GLOBAL.BSA.
-	return (iter != gRootPaths.end()) || gGlobalBsa.exists(name);
+	return (Manager::findLooseFile(name) != nullptr) || gGlobalBsa.exists(name);
+}
+
+bool Manager::isInGlobalBSA(const char *name) const
+{
+	return (Manager::findLooseFile(name) == nullptr) && gGlobalBsa.exists(name);
+}
+
+uint64_t Manager::getGlobalBSAHash() const
+{
+	return gGlobalBsa.getHash();
 }
 
 void Manager::addDir(const std::string &path, const std::string &pre, const char *pattern,
@@ -208,7 +233,7 @@ void Manager::addDir(const std::string &path, const std::string &pre, const char
 			(std::strcmp(ent->d_name, "..") == 0))
 			continue;
 
-		if (!S_ISDIR(ent->d_type))
+		if (ent->d_type != DT_DIR)
 		{
 			std::string fname = pre + ent->d_name;
 			if ((pattern == nullptr) || (fnmatch(pattern, fname.c_str(), 0) == 0))
@@ -225,14 +250,44 @@ void Manager::addDir(const std::string &path, const std::string &pre, const char
 	closedir(dir);
 }
 
+void Manager::prefetch(const std::vector<std::string> &names) const
+{
+	std::vector<std::string> bsaNames;
+	bsaNames.reserve(names.size());
+	for (const std::string &name : names)
+	{
+		const std::string *loosePath = Manager::findLooseFile(name.c_str());
+		if (loosePath == nullptr)
+		{
+			bsaNames.push_back(name);
+			continue;
+		}
+
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+		const int fd = ::open(loosePath->c_str(), O_RDONLY);
+		if (fd >= 0)
+		{
+			posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+			close(fd);
+		}
+#endif
+	}
+
+	gGlobalBsa.prefetch(bsaNames);
+}
+
 std::vector<std::string> Manager::list(const char *pattern) const
 {
 	std::vector<std::string> files;
 
-	std::for_each(gRootPaths.rbegin(), gRootPaths.rend(),
-		[pattern, &files](const std::string &rootPath)
+	std::for_each(gRootPathFiles.rbegin(), gRootPathFiles.rend(),
+		[pattern, &files](const std::vector<std::string> &rootPathFiles)
 	{
-		Manager::addDir(rootPath + '.', std::string(), pattern, files);
+		std::copy_if(rootPathFiles.begin(), rootPathFiles.end(), std::back_inserter(files),
+			[pattern](const std::string &name)
+		{
+			return (pattern == nullptr) || (fnmatch(pattern, name.c_str(), 0) == 0);
+		});
 	});
 
 	const std::vector<std::string> &bsaList = gGlobalBsa.list();
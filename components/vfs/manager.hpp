@@ -3,6 +3,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -30,6 +31,24 @@ inline uint16_t read_le16(std::istream &stream)
 	return ((uint16_t(buf[0]) & 0x00ff) | (uint16_t(buf[1] << 8) & 0xff00));
 }
 
+// A file's bytes, either pointing straight into the memory-mapped GLOBAL.BSA or owned (for
+// loose files, or if the archive couldn't be mapped). The bytes are read-only either way, and
+// mapped ones stay valid for as long as the manager.
+class FileView {
+	std::unique_ptr<std::byte[]> mOwned;
+	const std::byte *mData;
+	size_t mSize;
+
+public:
+	FileView() : mData(nullptr), mSize(0) { }
+
+	const std::byte *data() const { return mData; }
+	size_t size() const { return mSize; }
+
+	void setOwned(std::unique_ptr<std::byte[]> data, size_t size);
+	void setMapped(const std::byte *data, size_t size);
+};
+
 class Manager {
 	Manager(const Manager&) = delete;
 	Manager& operator=(const Manager&) = delete;
@@ -37,32 +56,57 @@ class Manager {
 	static void addDir(const std::string &path, const std::string &pre, const char *pattern,
 		std::vector<std::string> &names);
 
+	// Lists the files under a data path and adds them to the loose file index.
+	static void addLooseFiles(const std::string &rootPath);
+
+	// Gets the path of the loose file with the given name, ignoring case, or null if there
+	// isn't one.
+	static const std::string *findLooseFile(const char *name);
+
 	Manager();
 
 public:
 	void initialize(std::string&& rootPath = std::string());
 	void addDataPath(std::string&& path);
 
+	// Files are looked up ignoring case, which matters on Unix systems since the Arena floppy
+	// and CD versions don't have consistent casing for some files (like SPELLSG.65). Loose files
+	// are indexed when their data path is added, so files created afterwards aren't found.
 	IStreamPtr open(const char *name, bool *inGlobalBSA);
 	IStreamPtr open(const char *name);
 
-	// Special open method intended for Unix systems since the Arena floppy and CD versions don't
-	// have consistent casing for some files (like SPELLSG.65). This method is specific to Arena's
-	// files and is not a general solution for case-insensitive file loading.
-	// - To do: replace with something using std::filesystem::equivalent() (C++17)?
+	// Same as open() and read(), since lookups already ignore case. Each one is a hash lookup
+	// and at most one file open, instead of probing the file system with different casings.
 	IStreamPtr openCaseInsensitive(const char *name, bool *inGlobalBSA);
 	IStreamPtr openCaseInsensitive(const char *name);
+	bool readCaseInsensitive(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize,
+		bool *inGlobalBSA);
+	bool readCaseInsensitive(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize);
 
 	// Convenience functions for opening and reading a file into the output parameters.
 	bool read(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize, bool *inGlobalBSA);
 	bool read(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize);
-	bool readCaseInsensitive(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize,
-		bool *inGlobalBSA);
-	bool readCaseInsensitive(const char *name, std::unique_ptr<std::byte[]> *dst, size_t *dstSize);
+
+	// Same as read() but without copying files that are in GLOBAL.BSA, if it's memory-mapped.
+	bool read(const char *name, FileView *dst, bool *inGlobalBSA);
+	bool read(const char *name, FileView *dst);
 
 	bool exists(const char *name);
+
+	// Whether the file would be read from GLOBAL.BSA, i.e., it's in the archive and no loose
+	// file replaces it.
+	bool isInGlobalBSA(const char *name) const;
+
+	// Gets a hash of GLOBAL.BSA's entry table, for keying data made from the archive.
+	uint64_t getGlobalBSAHash() const;
+
 	std::vector<std::string> list(const char *pattern = nullptr) const;
 
+	// Tells the OS that the given files will be read soon, for loading a level's textures and
+	// sounds. Ones in GLOBAL.BSA are sorted by their place in the archive and hinted in as few
+	// ranges as possible, so they're read ahead mostly sequentially. Missing files are ignored.
+	void prefetch(const std::vector<std::string> &names) const;
+
 	static Manager &get()
 	{
 		static Manager manager;